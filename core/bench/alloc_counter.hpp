@@ -0,0 +1,50 @@
+#pragma once
+
+/// @file alloc_counter.hpp
+/// @brief Heap allocations made by the benchmark process.
+///
+/// exeray_bench links exeray_alloc_hook, which replaces the global operator
+/// new, so every allocation of the parsers (std::string, std::vector, ...)
+/// is counted (see alloc_tracking.hpp).
+
+#include <benchmark/benchmark.h>
+
+#include "exeray/alloc_tracking.hpp"
+
+#include <cstdint>
+
+namespace exeray::bench {
+
+/// @brief Allocations since process start.
+[[nodiscard]] inline std::uint64_t allocations() noexcept {
+    return alloc::process_allocations().allocations;
+}
+
+/// @brief Report allocations/event over a benchmark's iterations.
+///
+/// Construct before the timing loop; the destructor adds the counter.
+class AllocationCounter {
+public:
+    AllocationCounter(benchmark::State& state, std::uint64_t events_per_iteration = 1)
+        : state_(state), events_(events_per_iteration), start_(allocations()) {}
+
+    ~AllocationCounter() {
+        const double events = static_cast<double>(state_.iterations()) *
+                              static_cast<double>(events_);
+        state_.counters["allocs/event"] =
+            events > 0 ? static_cast<double>(allocations() - start_) / events : 0.0;
+        state_.counters["ns/event"] = benchmark::Counter(
+            static_cast<double>(events_),
+            benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+    }
+
+    AllocationCounter(const AllocationCounter&) = delete;
+    AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+private:
+    benchmark::State& state_;
+    std::uint64_t events_;
+    std::uint64_t start_;
+};
+
+}  // namespace exeray::bench
@@ -0,0 +1,452 @@
+/// @file bench_compare.cpp
+/// @brief Compare exeray_bench JSON results with a baseline (bench_gate).
+///
+/// Usage: exeray_bench_compare BASELINE RESULTS [--tolerance F] [--sigma K]
+///
+/// Both files are Google Benchmark JSON (--benchmark_out_format=json). Each
+/// run is reduced to the median of its repetitions for every gated metric:
+///
+/// - real_time: ns per iteration, lower is better (ns/event for the
+///   single-event benchmarks such as Dispatch/...)
+/// - items_per_second: events/s, higher is better
+/// - bytes/event: memory per stored event, lower is better
+///
+/// Repetitions make the comparison noise-aware: a metric regresses only if
+/// it is worse than the baseline by more than the tolerance and by more
+/// than K times the combined coefficient of variation of both runs, so a
+/// noisy benchmark needs a larger change to fail. Runs missing on either
+/// side are listed, not failed. Without a baseline file the results become
+/// the baseline.
+///
+/// Exit status: 0 = no regression, 1 = regression, 2 = unreadable input.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/// @brief A parsed JSON value (numbers as double).
+struct Value {
+    enum class Kind { Null, Bool, Number, String, Array, Object };
+
+    Kind kind = Kind::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string text;
+    std::vector<Value> items;
+    std::vector<std::pair<std::string, Value>> members;
+
+    [[nodiscard]] const Value* find(std::string_view key) const {
+        for (const auto& [name, value] : members) {
+            if (name == key) {
+                return &value;
+            }
+        }
+        return nullptr;
+    }
+};
+
+/// @brief Recursive-descent JSON reader; nullopt on malformed input.
+class Reader {
+public:
+    explicit Reader(std::string_view text) noexcept : text_(text) {}
+
+    std::optional<Value> document() {
+        Value value;
+        if (!parse(value, 0)) {
+            return std::nullopt;
+        }
+        skip_space();
+        return pos_ == text_.size() ? std::optional<Value>(std::move(value)) : std::nullopt;
+    }
+
+private:
+    static constexpr int kMaxDepth = 64;
+
+    void skip_space() noexcept {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' ||
+                text_[pos_] == '\r')) {
+            ++pos_;
+        }
+    }
+
+    bool literal(std::string_view word) noexcept {
+        if (text_.substr(pos_, word.size()) != word) {
+            return false;
+        }
+        pos_ += word.size();
+        return true;
+    }
+
+    bool parse(Value& out, int depth) {
+        skip_space();
+        if (pos_ == text_.size() || depth > kMaxDepth) {
+            return false;
+        }
+        switch (text_[pos_]) {
+            case '{':
+                return parse_object(out, depth);
+            case '[':
+                return parse_array(out, depth);
+            case '"':
+                out.kind = Value::Kind::String;
+                return parse_string(out.text);
+            case 't':
+                out.kind = Value::Kind::Bool;
+                out.boolean = true;
+                return literal("true");
+            case 'f':
+                out.kind = Value::Kind::Bool;
+                return literal("false");
+            case 'n':
+                return literal("null");
+            default:
+                return parse_number(out);
+        }
+    }
+
+    bool parse_object(Value& out, int depth) {
+        out.kind = Value::Kind::Object;
+        ++pos_;
+        skip_space();
+        if (pos_ < text_.size() && text_[pos_] == '}') {
+            ++pos_;
+            return true;
+        }
+        for (;;) {
+            skip_space();
+            std::string key;
+            if (pos_ == text_.size() || text_[pos_] != '"' || !parse_string(key)) {
+                return false;
+            }
+            skip_space();
+            if (pos_ == text_.size() || text_[pos_++] != ':') {
+                return false;
+            }
+            Value value;
+            if (!parse(value, depth + 1)) {
+                return false;
+            }
+            out.members.emplace_back(std::move(key), std::move(value));
+            skip_space();
+            if (pos_ == text_.size()) {
+                return false;
+            }
+            const char next = text_[pos_++];
+            if (next == '}') {
+                return true;
+            }
+            if (next != ',') {
+                return false;
+            }
+        }
+    }
+
+    bool parse_array(Value& out, int depth) {
+        out.kind = Value::Kind::Array;
+        ++pos_;
+        skip_space();
+        if (pos_ < text_.size() && text_[pos_] == ']') {
+            ++pos_;
+            return true;
+        }
+        for (;;) {
+            Value item;
+            if (!parse(item, depth + 1)) {
+                return false;
+            }
+            out.items.push_back(std::move(item));
+            skip_space();
+            if (pos_ == text_.size()) {
+                return false;
+            }
+            const char next = text_[pos_++];
+            if (next == ']') {
+                return true;
+            }
+            if (next != ',') {
+                return false;
+            }
+        }
+    }
+
+    /// Escapes other than \" and \\ only appear in names nobody gates on,
+    /// so \uXXXX is kept as '?'.
+    bool parse_string(std::string& out) {
+        ++pos_;
+        while (pos_ < text_.size()) {
+            const char c = text_[pos_++];
+            if (c == '"') {
+                return true;
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos_ == text_.size()) {
+                return false;
+            }
+            const char escaped = text_[pos_++];
+            switch (escaped) {
+                case 'n':
+                    out += '\n';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'r':
+                case 'b':
+                case 'f':
+                    break;
+                case 'u':
+                    if (pos_ + 4 > text_.size()) {
+                        return false;
+                    }
+                    pos_ += 4;
+                    out += '?';
+                    break;
+                default:
+                    out += escaped;  // \" \\ \/
+                    break;
+            }
+        }
+        return false;
+    }
+
+    bool parse_number(Value& out) {
+        const std::size_t start = pos_;
+        while (pos_ < text_.size() &&
+               std::string_view("+-0123456789.eE").find(text_[pos_]) != std::string_view::npos) {
+            ++pos_;
+        }
+        if (pos_ == start) {
+            return false;
+        }
+        const std::string digits(text_.substr(start, pos_ - start));
+        char* end = nullptr;
+        out.kind = Value::Kind::Number;
+        out.number = std::strtod(digits.c_str(), &end);
+        return end == digits.c_str() + digits.size();
+    }
+
+    std::string_view text_;
+    std::size_t pos_ = 0;
+};
+
+/// @brief A gated metric and the direction that is better.
+struct Metric {
+    const char* name;
+    bool higher_is_better;
+};
+
+constexpr Metric kMetrics[] = {
+    {"real_time", false},
+    {"items_per_second", true},
+    {"bytes/event", false},
+};
+
+/// @brief Repetition values per metric of one run.
+using Samples = std::map<std::string, std::vector<double>>;
+
+/// @brief Runs in file order, each with its samples.
+struct Results {
+    std::vector<std::string> order;
+    std::map<std::string, Samples> runs;
+};
+
+double to_ns(double value, std::string_view unit) noexcept {
+    if (unit == "us") {
+        return value * 1e3;
+    }
+    if (unit == "ms") {
+        return value * 1e6;
+    }
+    if (unit == "s") {
+        return value * 1e9;
+    }
+    return value;
+}
+
+std::optional<Results> load(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::fprintf(stderr, "bench_compare: cannot open %s\n", path.string().c_str());
+        return std::nullopt;
+    }
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    const std::string text = buffer.str();
+    const auto document = Reader(text).document();
+    const Value* benchmarks = document ? document->find("benchmarks") : nullptr;
+    if (benchmarks == nullptr || benchmarks->kind != Value::Kind::Array) {
+        std::fprintf(stderr, "bench_compare: %s is not benchmark JSON\n",
+                     path.string().c_str());
+        return std::nullopt;
+    }
+
+    Results results;
+    for (const Value& entry : benchmarks->items) {
+        const Value* run_type = entry.find("run_type");
+        const Value* error = entry.find("error_occurred");
+        if ((run_type != nullptr && run_type->text != "iteration") ||
+            (error != nullptr && error->boolean)) {
+            continue;  // Aggregates are recomputed; failed runs have no numbers
+        }
+        const Value* run_name = entry.find("run_name");
+        const Value* name = run_name != nullptr ? run_name : entry.find("name");
+        if (name == nullptr) {
+            continue;
+        }
+        auto [run, inserted] = results.runs.try_emplace(name->text);
+        if (inserted) {
+            results.order.push_back(name->text);
+        }
+        const Value* unit = entry.find("time_unit");
+        for (const Metric& metric : kMetrics) {
+            const Value* value = entry.find(metric.name);
+            if (value == nullptr || value->kind != Value::Kind::Number) {
+                continue;
+            }
+            const bool time = std::string_view(metric.name) == "real_time";
+            run->second[metric.name].push_back(
+                time ? to_ns(value->number, unit != nullptr ? unit->text : "ns")
+                     : value->number);
+        }
+    }
+    return results;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    const std::size_t mid = values.size() / 2;
+    return values.size() % 2 != 0 ? values[mid] : (values[mid - 1] + values[mid]) / 2.0;
+}
+
+/// @brief Sample standard deviation over mean (0 for fewer than two).
+double variation(const std::vector<double>& values) {
+    if (values.size() < 2) {
+        return 0.0;
+    }
+    double mean = 0.0;
+    for (const double value : values) {
+        mean += value;
+    }
+    mean /= static_cast<double>(values.size());
+    double squares = 0.0;
+    for (const double value : values) {
+        squares += (value - mean) * (value - mean);
+    }
+    const double deviation = std::sqrt(squares / static_cast<double>(values.size() - 1));
+    return mean != 0.0 ? deviation / std::fabs(mean) : 0.0;
+}
+
+int usage() {
+    std::fprintf(stderr,
+                 "usage: exeray_bench_compare BASELINE RESULTS [--tolerance F] [--sigma K]\n");
+    return 2;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string_view> args(argv + 1, argv + argc);
+    double tolerance = 0.05;
+    double sigma = 3.0;
+    std::vector<std::string_view> files;
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        if ((args[i] == "--tolerance" || args[i] == "--sigma") && i + 1 < args.size()) {
+            const double value = std::strtod(std::string(args[i + 1]).c_str(), nullptr);
+            (args[i] == "--tolerance" ? tolerance : sigma) = value;
+            ++i;
+        } else {
+            files.push_back(args[i]);
+        }
+    }
+    if (files.size() != 2 || tolerance < 0.0 || sigma < 0.0) {
+        return usage();
+    }
+
+    const std::filesystem::path baseline_path(files[0]);
+    const std::filesystem::path results_path(files[1]);
+    const auto current = load(results_path);
+    if (!current) {
+        return 2;
+    }
+    std::error_code error;
+    if (!std::filesystem::exists(baseline_path, error)) {
+        if (baseline_path.has_parent_path()) {
+            std::filesystem::create_directories(baseline_path.parent_path(), error);
+        }
+        if (!std::filesystem::copy_file(results_path, baseline_path, error)) {
+            std::fprintf(stderr, "bench_compare: cannot write %s\n",
+                         baseline_path.string().c_str());
+            return 2;
+        }
+        std::printf("No baseline yet: recorded %zu runs as %s\n", current->order.size(),
+                    baseline_path.string().c_str());
+        return 0;
+    }
+    const auto baseline = load(baseline_path);
+    if (!baseline) {
+        return 2;
+    }
+
+    std::size_t regressions = 0;
+    std::printf("%-66s %-17s %12s %12s %8s %8s\n", "Benchmark", "Metric", "Baseline",
+                "Current", "Change", "Allowed");
+    for (const std::string& name : baseline->order) {
+        const auto found = current->runs.find(name);
+        if (found == current->runs.end()) {
+            std::printf("%-66s not run\n", name.c_str());
+            continue;
+        }
+        const Samples& before = baseline->runs.at(name);
+        for (const Metric& metric : kMetrics) {
+            const auto old_values = before.find(metric.name);
+            const auto new_values = found->second.find(metric.name);
+            if (old_values == before.end() || new_values == found->second.end()) {
+                continue;
+            }
+            const double old_median = median(old_values->second);
+            const double new_median = median(new_values->second);
+            if (old_median == 0.0) {
+                continue;
+            }
+            const double change = (new_median - old_median) / old_median;
+            const double worse = metric.higher_is_better ? -change : change;
+            const double noise = std::hypot(variation(old_values->second),
+                                            variation(new_values->second));
+            const double allowed = (std::max)(tolerance, sigma * noise);
+            const char* verdict = worse > allowed ? "REGRESSION" : -worse > allowed ? "faster" : "";
+            regressions += worse > allowed ? 1 : 0;
+            std::printf("%-66s %-17s %12.4g %12.4g %+7.1f%% %7.1f%% %s\n", name.c_str(),
+                        metric.name, old_median, new_median, change * 100.0, allowed * 100.0,
+                        verdict);
+        }
+    }
+    for (const std::string& name : current->order) {
+        if (baseline->runs.find(name) == baseline->runs.end()) {
+            std::printf("%-66s not in baseline\n", name.c_str());
+        }
+    }
+
+    if (regressions != 0) {
+        std::printf("%zu metric(s) regressed against %s\n", regressions,
+                    baseline_path.string().c_str());
+        return 1;
+    }
+    std::printf("No regressions against %s\n", baseline_path.string().c_str());
+    return 0;
+}
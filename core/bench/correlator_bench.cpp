@@ -0,0 +1,104 @@
+/// @file correlator_bench.cpp
+/// @brief Correlator lookups under contention (platform independent).
+///
+/// kProcesses processes are registered up front; every benchmark thread
+/// then resolves events of random processes against the same Correlator,
+/// as the ETW sessions of a system-wide run do. FindParent/... is the
+/// single-event lookup; ResolveBatch/... resolves batches of kBatch events
+/// with Arg process creates per 1000 events, each of which turns the rest
+/// of its batch into an exclusive-lock resolve.
+
+#include <benchmark/benchmark.h>
+
+#include "exeray/event/correlator.hpp"
+#include "exeray/event/graph.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace exeray::event {
+namespace {
+
+constexpr std::uint32_t kProcesses = 2000;
+constexpr std::size_t kBatch = 64;
+
+struct Host {
+    Correlator correlator;
+    std::atomic<Timestamp> clock{kProcesses + 1};
+
+    Host() {
+        for (std::uint32_t i = 1; i <= kProcesses; ++i) {
+            correlator.register_process(4 * i, i, i);
+        }
+    }
+};
+
+std::unique_ptr<Host> g_host;
+
+std::uint32_t next(std::uint32_t& x) noexcept {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+void BM_Correlator_FindParent(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_host = std::make_unique<Host>();
+    }
+    std::uint32_t x = static_cast<std::uint32_t>(state.thread_index()) * 2654435761u | 1u;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            g_host->correlator.find_operation_parent(4 * (next(x) % kProcesses + 1)));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        g_host.reset();
+    }
+}
+BENCHMARK(BM_Correlator_FindParent)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_Correlator_ResolveBatch(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_host = std::make_unique<Host>();
+    }
+    const auto creates = static_cast<std::uint32_t>(state.range(0));
+    std::uint32_t x = static_cast<std::uint32_t>(state.thread_index()) * 2654435761u | 1u;
+    std::vector<PendingEvent> batch(kBatch);
+
+    for (auto _ : state) {
+        const Timestamp base = g_host->clock.fetch_add(kBatch, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < kBatch; ++i) {
+            PendingEvent& pending = batch[i];
+            pending = PendingEvent{};
+            pending.pid = 4 * (next(x) % kProcesses + 1);
+            pending.status = Status::Success;
+            pending.parent = INVALID_EVENT;
+            pending.timestamp = base + i;
+            if (x % 1000 < creates) {
+                // The PID starts a new life under another process
+                pending.category = Category::Process;
+                pending.operation = static_cast<std::uint8_t>(ProcessOp::Create);
+                pending.payload.process.pid = pending.pid;
+                pending.payload.process.parent_pid = 4 * (x / 1000 % kProcesses + 1);
+            } else {
+                pending.category = Category::FileSystem;
+            }
+            pending.payload.category = pending.category;
+        }
+        g_host->correlator.resolve_batch(batch);
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * kBatch));
+    if (state.thread_index() == 0) {
+        g_host.reset();
+    }
+}
+BENCHMARK(BM_Correlator_ResolveBatch)->Arg(0)->Arg(10)->ThreadRange(1, 8)->UseRealTime();
+
+}  // namespace
+}  // namespace exeray::event
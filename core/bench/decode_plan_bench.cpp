@@ -0,0 +1,102 @@
+/// @file decode_plan_bench.cpp
+/// @brief Benchmarks of compiled TDH decode plans (platform independent).
+
+#include <benchmark/benchmark.h>
+
+#include "alloc_counter.hpp"
+#include "exeray/etw/tdh/decode_plan.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace exeray::etw::tdh {
+namespace {
+
+PropertySchema prop(const wchar_t* name, InType type, std::uint16_t length = 0) {
+    PropertySchema schema;
+    schema.name = name;
+    schema.in_type = static_cast<std::uint16_t>(type);
+    schema.length = length;
+    return schema;
+}
+
+template <typename T>
+void put(std::vector<std::uint8_t>& data, T value) {
+    const auto* p = reinterpret_cast<const std::uint8_t*>(&value);
+    data.insert(data.end(), p, p + sizeof(T));
+}
+
+void put_utf16(std::vector<std::uint8_t>& data, const char* text) {
+    for (; *text != '\0'; ++text) {
+        put<std::uint16_t>(data, static_cast<std::uint8_t>(*text));
+    }
+    put<std::uint16_t>(data, 0);
+}
+
+/// Shape of a Kernel-File Create event: fixed prefix, then a path.
+void BM_DecodePlan_FixedPrefixAndPath(benchmark::State& state) {
+    const std::vector<PropertySchema> schema = {
+        prop(L"Irp", InType::Pointer),
+        prop(L"FileObject", InType::Pointer),
+        prop(L"IssuingThreadId", InType::UInt32),
+        prop(L"CreateOptions", InType::UInt32),
+        prop(L"CreateAttributes", InType::UInt32),
+        prop(L"ShareAccess", InType::UInt32),
+        prop(L"FileName", InType::UnicodeString),
+    };
+    const auto plan = DecodePlan::compile(schema);
+    if (!plan) {
+        state.SkipWithError("plan did not compile");
+        return;
+    }
+
+    std::vector<std::uint8_t> data;
+    put<std::uint64_t>(data, 0xFFFF800012340000ULL);
+    put<std::uint64_t>(data, 0xFFFF800056780000ULL);
+    put<std::uint32_t>(data, 4242);
+    put<std::uint32_t>(data, 0x00000020);
+    put<std::uint32_t>(data, 0x80);
+    put<std::uint32_t>(data, 0x7);
+    put_utf16(data, "\\Device\\HarddiskVolume3\\Windows\\System32\\kernel32.dll");
+
+    bench::AllocationCounter counter(state);
+    for (auto _ : state) {
+        TdhParsedEvent event;
+        benchmark::DoNotOptimize(plan->decode(data, 8, event));
+        benchmark::DoNotOptimize(event.size());
+    }
+}
+BENCHMARK(BM_DecodePlan_FixedPrefixAndPath);
+
+/// Counted array after its count: the variable-offset path.
+void BM_DecodePlan_CountedArray(benchmark::State& state) {
+    std::vector<PropertySchema> schema = {
+        prop(L"Count", InType::UInt16),
+        prop(L"Values", InType::UInt32),
+    };
+    schema[1].count_property = 0;
+    const auto plan = DecodePlan::compile(schema);
+    if (!plan) {
+        state.SkipWithError("plan did not compile");
+        return;
+    }
+
+    std::vector<std::uint8_t> data;
+    put<std::uint16_t>(data, 16);
+    for (std::uint32_t i = 0; i < 16; ++i) {
+        put<std::uint32_t>(data, i);
+    }
+
+    bench::AllocationCounter counter(state);
+    for (auto _ : state) {
+        TdhParsedEvent event;
+        benchmark::DoNotOptimize(plan->decode(data, 8, event));
+        benchmark::DoNotOptimize(event.size());
+    }
+}
+BENCHMARK(BM_DecodePlan_CountedArray);
+
+}  // namespace
+}  // namespace exeray::etw::tdh
@@ -0,0 +1,91 @@
+/// @file end_to_end_bench.cpp
+/// @brief Throughput and latency of the whole ingest path (platform
+/// independent).
+///
+/// Engine::run_synthetic() feeds generated events through what follows the
+/// parsers in a live session: flows, interning, detection, I/O coalescing,
+/// batched correlation and the graph, with EngineConfig::system_wide().
+/// Throughput/... runs as fast as it can with Args {churn per 1000 events,
+/// distinct strings}; "bytes/event" is the graph and string memory per
+/// stored event. Paced/... delivers kTargetRate events per second for half
+/// a second and reports the p50/p99/p999 age of events when they become
+/// visible in the graph, which grows once the pipeline falls behind.
+
+#include <benchmark/benchmark.h>
+
+#include "exeray/engine.hpp"
+#include "exeray/etw/synthetic_source.hpp"
+
+#include <cstdint>
+
+namespace exeray {
+namespace {
+
+/// Sustained whole-host rate the pipeline must keep up with.
+constexpr double kTargetRate = 200'000.0;
+
+constexpr std::size_t kArenaSize = std::size_t{512} << 20;
+constexpr std::uint64_t kEvents = std::uint64_t{1} << 18;
+
+void report_latency(benchmark::State& state, const Engine& engine) {
+    const etw::LatencySummary visible = engine.ingest_latency(etw::LatencyStage::Visible);
+    state.counters["p50_us"] = static_cast<double>(visible.p50) / 1000.0;
+    state.counters["p99_us"] = static_cast<double>(visible.p99) / 1000.0;
+    state.counters["p999_us"] = static_cast<double>(visible.p999) / 1000.0;
+}
+
+void BM_EndToEnd_Throughput(benchmark::State& state) {
+    Engine engine{EngineConfig::system_wide(kArenaSize, 2)};
+    etw::SyntheticConfig load;
+    load.churn = static_cast<std::uint32_t>(state.range(0));
+    load.strings = static_cast<std::uint32_t>(state.range(1));
+
+    std::uint64_t stored = 0;
+    for (auto _ : state) {
+        load.seed = static_cast<std::uint64_t>(state.iterations()) + 1;
+        const auto stats = engine.run_synthetic(load, kEvents);
+        if (!stats) {
+            state.SkipWithError("run_synthetic failed");
+            return;
+        }
+        stored += stats->events;
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * kEvents));
+    const MemoryStats memory = engine.memory_stats();
+    if (memory.event_count > 0) {
+        state.counters["bytes/event"] =
+            static_cast<double>(memory.event_bytes + memory.string_bytes) /
+            static_cast<double>(memory.event_count);
+    }
+    state.counters["stored"] =
+        static_cast<double>(stored) / static_cast<double>(state.iterations() * kEvents);
+    report_latency(state, engine);
+}
+BENCHMARK(BM_EndToEnd_Throughput)
+    ->Args({2, 10'000})
+    ->Args({20, 10'000})
+    ->Args({2, 1'000'000})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+void BM_EndToEnd_Paced(benchmark::State& state) {
+    Engine engine{EngineConfig::system_wide(kArenaSize, 2)};
+    etw::SyntheticConfig load;
+    load.rate = kTargetRate;
+    const auto events = static_cast<std::uint64_t>(kTargetRate / 2);
+
+    for (auto _ : state) {
+        if (!engine.run_synthetic(load, events)) {
+            state.SkipWithError("run_synthetic failed");
+            return;
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * events));
+    report_latency(state, engine);
+}
+BENCHMARK(BM_EndToEnd_Paced)->Iterations(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}  // namespace
+}  // namespace exeray
@@ -0,0 +1,153 @@
+/// @file event_graph_bench.cpp
+/// @brief EventGraph push throughput by thread count and read bandwidth
+/// (platform independent).
+///
+/// Push/... writes into a ring-retention graph shared by the benchmark
+/// threads, so it measures steady-state recycling, not a graph filling up.
+/// ForEach/... and Scan/... read a graph of kReadEvents events built once;
+/// "bytes/s" counts sizeof(EventNode) per event visited.
+
+#include <benchmark/benchmark.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/event/columns.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/string_pool.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace exeray::event {
+namespace {
+
+constexpr std::size_t kArenaSize = std::size_t{1} << 30;
+constexpr std::size_t kRingEvents = std::size_t{1} << 20;
+constexpr std::size_t kReadEvents = std::size_t{1} << 20;
+constexpr std::size_t kBatch = 256;
+
+/// Arena, pool and graph shared by the threads of one run.
+struct Store {
+    explicit Store(std::size_t capacity, Retention retention)
+        : graph(arena, strings, capacity, retention) {}
+
+    Arena arena{kArenaSize, ArenaOptions{.lazy_commit = true}};
+    StringPool strings{arena};
+    EventGraph graph;
+};
+
+std::unique_ptr<Store> g_store;
+
+EventPayload file_payload(std::uint32_t x) {
+    EventPayload payload{};
+    payload.category = Category::FileSystem;
+    payload.file.size = x & 0xFFFF;
+    return payload;
+}
+
+std::uint32_t next(std::uint32_t& x) noexcept {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+void BM_EventGraph_Push(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_store = std::make_unique<Store>(kRingEvents, Retention::Ring);
+    }
+    std::uint32_t x = static_cast<std::uint32_t>(state.thread_index()) * 2654435761u | 1u;
+    Timestamp clock = 1;
+
+    for (auto _ : state) {
+        const EventPayload payload = file_payload(next(x));
+        benchmark::DoNotOptimize(g_store->graph.push(Category::FileSystem, 0, Status::Success,
+                                                     INVALID_EVENT, 0, payload, ++clock));
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    if (state.thread_index() == 0) {
+        g_store.reset();
+    }
+}
+BENCHMARK(BM_EventGraph_Push)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_EventGraph_PushBatch(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_store = std::make_unique<Store>(kRingEvents, Retention::Ring);
+    }
+    std::uint32_t x = static_cast<std::uint32_t>(state.thread_index()) * 2654435761u | 1u;
+    std::vector<PendingEvent> batch(kBatch);
+    Timestamp clock = 1;
+
+    for (auto _ : state) {
+        for (PendingEvent& pending : batch) {
+            pending = PendingEvent{};
+            pending.category = Category::FileSystem;
+            pending.status = Status::Success;
+            pending.parent = INVALID_EVENT;
+            pending.payload = file_payload(next(x));
+            pending.timestamp = ++clock;
+        }
+        benchmark::DoNotOptimize(g_store->graph.push_batch(batch));
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * kBatch));
+    if (state.thread_index() == 0) {
+        g_store.reset();
+    }
+}
+BENCHMARK(BM_EventGraph_PushBatch)->ThreadRange(1, 8)->UseRealTime();
+
+/// @brief Graph of kReadEvents file, registry and network events with
+/// operations 0-7.
+std::unique_ptr<Store> make_read_store(bool columnar) {
+    auto store = std::make_unique<Store>(kReadEvents, Retention::Append);
+    store->graph.set_columnar(columnar);
+    std::uint32_t x = 1;
+    for (std::size_t i = 0; i < kReadEvents; ++i) {
+        EventPayload payload = file_payload(next(x));
+        const Category category = x % 3 == 0   ? Category::FileSystem
+                                  : x % 3 == 1 ? Category::Registry
+                                               : Category::Network;
+        payload.category = category;
+        store->graph.push(category, static_cast<std::uint8_t>(x % 8), Status::Success,
+                          INVALID_EVENT, 0, payload, i + 1);
+    }
+    store->graph.seal_segments();
+    return store;
+}
+
+void BM_EventGraph_ForEach(benchmark::State& state) {
+    const auto store = make_read_store(false);
+    for (auto _ : state) {
+        std::uint64_t sum = 0;
+        store->graph.for_each([&sum](EventView event) { sum += event.timestamp(); });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * kReadEvents));
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * kReadEvents * sizeof(EventNode)));
+}
+BENCHMARK(BM_EventGraph_ForEach)->Unit(benchmark::kMillisecond);
+
+/// Arg: columnar segments (0 = scan the nodes).
+void BM_EventGraph_Scan(benchmark::State& state) {
+    const auto store = make_read_store(state.range(0) != 0);
+    FilterSpec spec;
+    spec.with_category(Category::FileSystem);
+    spec.operation = 3;
+    std::vector<EventId> out;
+    for (auto _ : state) {
+        out.clear();
+        benchmark::DoNotOptimize(store->graph.scan(spec, out));
+    }
+    state.counters["matches"] = static_cast<double>(out.size());
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * kReadEvents));
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * kReadEvents * sizeof(EventNode)));
+}
+BENCHMARK(BM_EventGraph_Scan)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace exeray::event
@@ -0,0 +1,93 @@
+/// @file fuzz_corpus_bench.cpp
+/// @brief Parse throughput over the corpus of exeray_parser_fuzz.
+///
+/// Setting EXERAY_FUZZ_CORPUS to a corpus directory (see fuzz/) adds
+/// Corpus/Fuzz, which dispatches every input of it per iteration. The
+/// corpus is mostly malformed UserData, so this times the bounds checks
+/// and early rejects that the synthetic Dispatch/ cases never reach.
+
+#ifdef _WIN32
+
+#include <benchmark/benchmark.h>
+
+#include "alloc_counter.hpp"
+#include "fuzz_record.hpp"
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/parser.hpp"
+#include "exeray/event/string_pool.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace exeray::fuzz {
+namespace {
+
+/// @brief Inputs of a corpus directory and the records viewing them.
+class FuzzCorpus {
+public:
+    /// @brief Load every file of dir; empty if it cannot be read.
+    explicit FuzzCorpus(const std::filesystem::path& dir) {
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(dir, error)) {
+            std::ifstream in(entry.path(), std::ios::binary);
+            inputs_.emplace_back(std::istreambuf_iterator<char>(in),
+                                 std::istreambuf_iterator<char>());
+        }
+        // Records view inputs_, which has stopped growing
+        for (const std::vector<std::uint8_t>& input : inputs_) {
+            if (const auto record = make_record(input)) {
+                records_.push_back(*record);
+            }
+        }
+    }
+
+    [[nodiscard]] const std::vector<EVENT_RECORD>& records() const noexcept { return records_; }
+
+private:
+    std::vector<std::vector<std::uint8_t>> inputs_;
+    std::vector<EVENT_RECORD> records_;
+};
+
+void BM_FuzzCorpus(benchmark::State& state, const FuzzCorpus* corpus) {
+    auto arena = std::make_unique<Arena>(64 * 1024 * 1024);
+    event::StringPool strings(*arena);
+    const auto& records = corpus->records();
+
+    std::uint64_t valid = 0;
+    bench::AllocationCounter counter(state, records.size());
+    for (auto _ : state) {
+        for (const EVENT_RECORD& record : records) {
+            etw::ParsedEvent event = etw::dispatch_event(&record, &strings);
+            valid += event.valid ? 1 : 0;
+            benchmark::DoNotOptimize(event);
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * records.size()));
+    state.counters["valid"] = static_cast<double>(valid) /
+                              static_cast<double>(state.iterations() * records.size());
+}
+
+/// @brief Register Corpus/Fuzz when EXERAY_FUZZ_CORPUS names a directory.
+const bool corpus_registered = [] {
+    const wchar_t* dir = _wgetenv(L"EXERAY_FUZZ_CORPUS");
+    if (dir == nullptr || *dir == L'\0') {
+        return false;
+    }
+    static const FuzzCorpus corpus(dir);
+    if (corpus.records().empty()) {
+        return false;
+    }
+    benchmark::RegisterBenchmark("Corpus/Fuzz", BM_FuzzCorpus, &corpus);
+    return true;
+}();
+
+}  // namespace
+}  // namespace exeray::fuzz
+
+#endif  // _WIN32
@@ -0,0 +1,145 @@
+/// @file parser_bench.cpp
+/// @brief Benchmarks of the ETW parsers over synthetic and recorded events.
+///
+/// Synthetic records are the cases of etw/parser_cases_common.hpp, built
+/// with the parser unit test fixtures, so a benchmark measures exactly the
+/// layouts the tests check. Each case is run through its parse_*_event() (Parse/...)
+/// and through dispatch_event() (Dispatch/...), which adds the provider
+/// lookup and the parse metrics.
+///
+/// Setting EXERAY_BENCH_CORPUS to an .etl file adds Corpus/Dispatch, which
+/// replays every record of the file per iteration.
+
+#ifdef _WIN32
+
+#include <benchmark/benchmark.h>
+
+#include "alloc_counter.hpp"
+#include "exeray/etw/session.hpp"
+
+#include "etw/parser_cases_common.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace exeray::etw {
+namespace {
+
+using namespace cases;
+
+template <typename Case>
+void run(benchmark::State& state, ParseFn parse) {
+    const Case input;
+    bench::AllocationCounter counter(state);
+    for (auto _ : state) {
+        ParsedEvent event = parse(input.record(), input.pool());
+        benchmark::DoNotOptimize(event);
+    }
+}
+
+template <typename Case, ParseFn Parse>
+void BM_Parse(benchmark::State& state) {
+    run<Case>(state, Parse);
+}
+
+template <typename Case>
+void BM_Dispatch(benchmark::State& state) {
+    run<Case>(state, &dispatch_event);
+}
+
+#define EXERAY_PARSER_BENCH(name, parse)                                         \
+    BENCHMARK_TEMPLATE(BM_Parse, name, parse)->Name("Parse/" #name);             \
+    BENCHMARK_TEMPLATE(BM_Dispatch, name)->Name("Dispatch/" #name)
+
+EXERAY_PARSER_BENCH(ProcessStart, parse_process_event);
+EXERAY_PARSER_BENCH(FileCreate, parse_file_event);
+EXERAY_PARSER_BENCH(FileRead, parse_file_event);
+EXERAY_PARSER_BENCH(TcpConnect, parse_network_event);
+EXERAY_PARSER_BENCH(RegistrySetValue, parse_registry_event);
+EXERAY_PARSER_BENCH(ImageLoad, parse_image_event);
+EXERAY_PARSER_BENCH(ThreadStart, parse_thread_event);
+EXERAY_PARSER_BENCH(MemoryAlloc, parse_memory_event);
+EXERAY_PARSER_BENCH(ScriptBlock, parse_powershell_event);
+EXERAY_PARSER_BENCH(AmsiScan, parse_amsi_event);
+EXERAY_PARSER_BENCH(DnsQuery, parse_dns_event);
+
+#undef EXERAY_PARSER_BENCH
+
+// ---------------------------------------------------------------------------
+// Recorded corpus
+// ---------------------------------------------------------------------------
+
+/// @brief Records of an .etl file, copied out of ProcessTrace's buffers.
+///
+/// Extended data items are dropped; the parsers read only the header and
+/// UserData.
+class Corpus {
+public:
+    /// @brief Load every record of path; empty if it cannot be opened.
+    explicit Corpus(const std::wstring& path) {
+        auto session = Session::open_file(path, &Corpus::on_event, this);
+        if (session == nullptr) {
+            return;
+        }
+        TRACEHANDLE handle = session->trace_handle();
+        ProcessTrace(&handle, 1, nullptr, nullptr);
+
+        // Point the copies at their data only now that data_ stopped growing
+        for (std::size_t i = 0; i < records_.size(); ++i) {
+            records_[i].UserData = data_[i].empty() ? nullptr : data_[i].data();
+        }
+    }
+
+    [[nodiscard]] const std::vector<EVENT_RECORD>& records() const noexcept { return records_; }
+
+private:
+    static void WINAPI on_event(PEVENT_RECORD record) {
+        auto* self = static_cast<Corpus*>(record->UserContext);
+        EVENT_RECORD copy = *record;
+        copy.ExtendedDataCount = 0;
+        copy.ExtendedData = nullptr;
+        copy.UserContext = nullptr;
+        const auto* user_data = static_cast<const uint8_t*>(record->UserData);
+        self->data_.emplace_back(user_data, user_data + record->UserDataLength);
+        self->records_.push_back(copy);
+    }
+
+    std::vector<EVENT_RECORD> records_;
+    std::vector<std::vector<uint8_t>> data_;
+};
+
+void BM_CorpusDispatch(benchmark::State& state, const Corpus* corpus) {
+    auto arena = std::make_unique<Arena>(64 * 1024 * 1024);
+    event::StringPool strings(*arena);
+    const auto& records = corpus->records();
+
+    bench::AllocationCounter counter(state, records.size());
+    for (auto _ : state) {
+        for (const EVENT_RECORD& record : records) {
+            ParsedEvent event = dispatch_event(&record, &strings);
+            benchmark::DoNotOptimize(event);
+        }
+    }
+}
+
+/// @brief Register Corpus/Dispatch when EXERAY_BENCH_CORPUS names a trace.
+const bool corpus_registered = [] {
+    const wchar_t* path = _wgetenv(L"EXERAY_BENCH_CORPUS");
+    if (path == nullptr || *path == L'\0') {
+        return false;
+    }
+    static const Corpus corpus(path);
+    if (corpus.records().empty()) {
+        return false;
+    }
+    benchmark::RegisterBenchmark("Corpus/Dispatch", BM_CorpusDispatch, &corpus);
+    return true;
+}();
+
+}  // namespace
+}  // namespace exeray::etw
+
+#endif  // _WIN32
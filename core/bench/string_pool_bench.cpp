@@ -0,0 +1,152 @@
+/// @file string_pool_bench.cpp
+/// @brief StringPool intern cost by hit rate and thread count (platform
+/// independent).
+///
+/// Paths follow what a host produces: common directories (System32, Program
+/// Files, user profiles, temp folders) and file names drawn with a
+/// Zipf(1) skew, so a handful of files make up most lookups. The Arg is the
+/// hit rate in percent; a miss interns a name never seen before. Each
+/// thread runs a fixed kIterations so the arena is sized for the misses.
+
+#include <benchmark/benchmark.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/event/string_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace exeray::event {
+namespace {
+
+constexpr std::int64_t kIterations = std::int64_t{1} << 19;
+constexpr std::size_t kDistinct = 20000;
+constexpr std::size_t kArenaSize = std::size_t{2} << 30;
+
+const char* const kDirectories[] = {
+    "C:\\Windows\\System32\\",
+    "C:\\Windows\\SysWOW64\\",
+    "C:\\Windows\\WinSxS\\amd64_microsoft.windows.common-controls_6595b64144ccf1df\\",
+    "C:\\Windows\\System32\\drivers\\",
+    "C:\\Windows\\Microsoft.NET\\Framework64\\v4.0.30319\\",
+    "C:\\Program Files\\Common Files\\microsoft shared\\ClickToRun\\",
+    "C:\\Program Files\\Google\\Chrome\\Application\\",
+    "C:\\Program Files (x86)\\Microsoft\\Edge\\Application\\",
+    "C:\\ProgramData\\Microsoft\\Windows Defender\\Platform\\",
+    "C:\\Users\\alice\\AppData\\Local\\Temp\\",
+    "C:\\Users\\alice\\AppData\\Roaming\\Microsoft\\Windows\\Recent\\",
+    "C:\\Users\\alice\\Documents\\",
+    "C:\\Users\\bob\\AppData\\Local\\Packages\\",
+    "C:\\Users\\bob\\Downloads\\",
+};
+
+/// @brief kDistinct host paths, most frequent first.
+std::vector<std::string> make_paths() {
+    const char* const extensions[] = {".dll", ".exe", ".sys", ".tmp", ".log", ".dat"};
+    std::vector<std::string> paths;
+    paths.reserve(kDistinct);
+    std::uint32_t x = 7;
+    for (std::size_t i = 0; i < kDistinct; ++i) {
+        x = x * 1664525u + 1013904223u;
+        std::string path = kDirectories[(x >> 8) % std::size(kDirectories)];
+        path += "file" + std::to_string(i) + extensions[(x >> 20) % std::size(extensions)];
+        paths.push_back(std::move(path));
+    }
+    return paths;
+}
+
+/// @brief Cumulative Zipf(1) weights of the ranks, for inverse sampling.
+std::vector<double> make_zipf() {
+    std::vector<double> cdf(kDistinct);
+    double sum = 0.0;
+    for (std::size_t i = 0; i < kDistinct; ++i) {
+        sum += 1.0 / static_cast<double>(i + 1);
+        cdf[i] = sum;
+    }
+    for (double& weight : cdf) {
+        weight /= sum;
+    }
+    return cdf;
+}
+
+struct Host {
+    Arena arena{kArenaSize, ArenaOptions{.lazy_commit = true}};
+    StringPool strings{arena};
+    std::vector<std::string> paths = make_paths();
+    std::vector<double> zipf = make_zipf();
+};
+
+std::unique_ptr<Host> g_host;
+
+/// @brief Intern paths with state.range(0)% hits; plain or as path nodes.
+template <bool Path>
+void intern_mix(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_host = std::make_unique<Host>();
+        for (const std::string& path : g_host->paths) {
+            if constexpr (Path) {
+                g_host->strings.intern_path(path);
+            } else {
+                g_host->strings.intern(path);
+            }
+        }
+    }
+    const auto hit_rate = static_cast<std::uint32_t>(state.range(0));
+    std::uint64_t x =
+        static_cast<std::uint64_t>(state.thread_index()) * 0x9E3779B97F4A7C15ULL | 1;
+    std::string miss;
+    std::uint64_t misses = 0;
+
+    for (auto _ : state) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        const Host& host = *g_host;
+        const double u = static_cast<double>(x >> 11) * 0x1.0p-53;
+        const std::size_t rank = static_cast<std::size_t>(
+            std::lower_bound(host.zipf.begin(), host.zipf.end(), u) - host.zipf.begin());
+        std::string_view text = host.paths[(std::min)(rank, kDistinct - 1)];
+        if (x % 100 >= hit_rate) {
+            // A new name in the same directory
+            miss.assign(text.substr(0, text.rfind('\\') + 1));
+            miss += "new" + std::to_string(state.thread_index()) + "_" +
+                    std::to_string(misses++) + ".tmp";
+            text = miss;
+        }
+        benchmark::DoNotOptimize(Path ? g_host->strings.intern_path(text)
+                                      : g_host->strings.intern(text));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        state.counters["strings"] = static_cast<double>(g_host->strings.count());
+        state.counters["bytes/string"] = static_cast<double>(g_host->strings.bytes_used()) /
+                                         static_cast<double>(g_host->strings.count());
+        g_host.reset();
+    }
+}
+
+void BM_StringPool_Intern(benchmark::State& state) {
+    intern_mix<false>(state);
+}
+BENCHMARK(BM_StringPool_Intern)
+    ->Arg(100)->Arg(90)->Arg(50)
+    ->ThreadRange(1, 8)
+    ->Iterations(kIterations)
+    ->UseRealTime();
+
+void BM_StringPool_InternPath(benchmark::State& state) {
+    intern_mix<true>(state);
+}
+BENCHMARK(BM_StringPool_InternPath)
+    ->Arg(100)->Arg(90)->Arg(50)
+    ->ThreadRange(1, 8)
+    ->Iterations(kIterations)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace exeray::event
@@ -0,0 +1,129 @@
+/// @file system_wide_bench.cpp
+/// @brief Sustained ingest of whole-host event mixes (platform independent).
+///
+/// Feeds parsed events through what follows the parsers in a live session:
+/// per-batch correlation, risk and process tree counts, then the shard
+/// merger into a ring-retention graph sized by EngineConfig::system_wide().
+/// Each benchmark thread is one ETW session, so Threads(4) matches its four
+/// sessions. "vs_target" is the rate divided by kTargetRate (1.0 = exactly
+/// on target); parsing itself is covered by parser_bench.cpp.
+
+#include <benchmark/benchmark.h>
+
+#include "exeray/engine.hpp"
+#include "exeray/etw/shard_merger.hpp"
+#include "exeray/event/correlator.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace exeray {
+namespace {
+
+/// Sustained whole-host rate the pipeline must keep up with.
+constexpr double kTargetRate = 200'000.0;
+
+/// Records a session delivers per buffer callback, about one 1 MB buffer.
+constexpr std::size_t kBatch = 256;
+
+/// Processes the synthetic host runs.
+constexpr std::uint32_t kProcesses = 2000;
+
+constexpr std::size_t kArenaSize = std::size_t{512} << 20;
+constexpr std::size_t kSessions = 4;
+
+/// Engine, correlator and merger shared by the benchmark threads.
+struct Host {
+    Engine engine{EngineConfig::system_wide(kArenaSize, kSessions + 1)};
+    event::Correlator correlator;
+    etw::ShardMerger merger{engine.graph(), kSessions};
+    std::atomic<event::Timestamp> clock{1};
+
+    Host() {
+        // Every process exists before the measured events refer to it
+        for (std::uint32_t pid = 4; pid < 4 * (kProcesses + 1); pid += 4) {
+            event::EventPayload payload{};
+            payload.category = event::Category::Process;
+            payload.process = {pid, 4, event::INVALID_STRING, event::INVALID_STRING};
+            const event::EventId id = engine.graph().push(
+                event::Category::Process, static_cast<std::uint8_t>(event::ProcessOp::Create),
+                event::Status::Success, event::INVALID_EVENT, 0, payload, 1);
+            correlator.register_process(pid, id, 1, event::INVALID_EVENT);
+        }
+    }
+};
+
+std::unique_ptr<Host> g_host;
+
+/// @brief One session's events: file and registry I/O, network transfers
+/// and image loads spread over the host's processes.
+std::vector<event::PendingEvent> make_batch(std::size_t session) {
+    std::vector<event::PendingEvent> batch(kBatch);
+    std::uint32_t x = static_cast<std::uint32_t>(session) * 2654435761u | 1u;
+    for (auto& pending : batch) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        pending.pid = 4 * (x % kProcesses + 1);
+        pending.status = event::Status::Success;
+        pending.parent = event::INVALID_EVENT;
+        pending.correlation_id = 0;
+        pending.payload = {};
+        switch (session) {
+            case 1:
+                pending.category = x & 1 ? event::Category::FileSystem : event::Category::Registry;
+                break;
+            case 2:
+                pending.category = event::Category::Network;
+                pending.payload.network.bytes = x & 0xFFFF;
+                break;
+            case 3:
+                pending.category = event::Category::Script;
+                break;
+            default:
+                pending.category = event::Category::Image;
+                break;
+        }
+        pending.payload.category = pending.category;
+        pending.operation = 0;
+    }
+    return batch;
+}
+
+void BM_SystemWide_Ingest(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_host = std::make_unique<Host>();
+    }
+    const std::size_t session = static_cast<std::size_t>(state.thread_index()) % kSessions;
+    std::vector<event::PendingEvent> batch = make_batch(session);
+
+    for (auto _ : state) {
+        Host& host = *g_host;
+        // Each session's clock runs forward, the sessions interleave
+        const event::Timestamp base = host.clock.fetch_add(kBatch, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            batch[i].timestamp = base + i;
+            batch[i].parent = event::INVALID_EVENT;
+        }
+        host.correlator.resolve_batch(batch);
+        host.correlator.add_risk_batch(batch);
+        host.correlator.process_tree().count(batch);
+        host.merger.submit(session, batch);
+    }
+
+    const auto events = static_cast<double>(state.iterations() * kBatch);
+    state.SetItemsProcessed(static_cast<std::int64_t>(events));
+    state.counters["vs_target"] =
+        benchmark::Counter(events / kTargetRate, benchmark::Counter::kIsRate);
+    if (state.thread_index() == 0) {
+        g_host->merger.flush();
+        state.counters["graph_events"] = static_cast<double>(g_host->engine.graph().count());
+        g_host.reset();
+    }
+}
+BENCHMARK(BM_SystemWide_Ingest)->Threads(1)->Threads(kSessions)->UseRealTime();
+
+}  // namespace
+}  // namespace exeray
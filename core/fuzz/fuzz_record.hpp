@@ -0,0 +1,99 @@
+#pragma once
+
+/// @file fuzz_record.hpp
+/// @brief Fuzz inputs as EVENT_RECORDs for dispatch_event().
+///
+/// Shared by the fuzzer (parser_fuzz.cpp), its seed writer
+/// (write_seeds.cpp) and the corpus benchmark (bench/fuzz_corpus_bench.cpp),
+/// so the corpus the fuzzer grows is the one the benchmark times.
+///
+/// Input layout:
+///   byte 0     provider, index into kProviders (modulo its size)
+///   bytes 1-2  EventDescriptor.Id (little-endian)
+///   byte 3     EventDescriptor.Version
+///   byte 4     bit 0: 64-bit header (8-byte pointers in UserData)
+///   rest       UserData (at most 65535 bytes)
+
+#ifdef _WIN32
+
+#include "exeray/etw/providers/guids.hpp"
+
+#include <windows.h>
+#include <evntcons.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace exeray::fuzz {
+
+/// Providers dispatch_event() has a parser for; others take the TDH path
+inline const GUID* const kProviders[] = {
+    &etw::providers::KERNEL_PROCESS, &etw::providers::KERNEL_FILE,
+    &etw::providers::KERNEL_REGISTRY, &etw::providers::KERNEL_NETWORK,
+    &etw::providers::KERNEL_IMAGE, &etw::providers::KERNEL_THREAD,
+    &etw::providers::KERNEL_MEMORY, &etw::providers::POWERSHELL,
+    &etw::providers::AMSI, &etw::providers::DNS_CLIENT,
+    &etw::providers::SECURITY_AUDITING, &etw::providers::WMI_ACTIVITY,
+    &etw::providers::CLR_RUNTIME,
+};
+
+constexpr std::size_t kHeaderSize = 5;
+constexpr std::size_t kMaxUserData = 0xFFFF;
+
+/**
+ * @brief Record for a fuzz input; UserData views input.
+ * @return nullopt if input is shorter than the header or its UserData
+ *         does not fit UserDataLength.
+ */
+[[nodiscard]] inline std::optional<EVENT_RECORD> make_record(
+    std::span<const std::uint8_t> input) {
+    if (input.size() < kHeaderSize || input.size() - kHeaderSize > kMaxUserData) {
+        return std::nullopt;
+    }
+    EVENT_RECORD record{};
+    record.EventHeader.ProviderId = *kProviders[input[0] % std::size(kProviders)];
+    record.EventHeader.EventDescriptor.Id =
+        static_cast<USHORT>(input[1] | (static_cast<unsigned>(input[2]) << 8));
+    record.EventHeader.EventDescriptor.Version = input[3];
+    record.EventHeader.Flags =
+        (input[4] & 1) != 0 ? EVENT_HEADER_FLAG_64_BIT_HEADER : EVENT_HEADER_FLAG_32_BIT_HEADER;
+    record.EventHeader.ProcessId = 4242;
+    record.EventHeader.ThreadId = 4243;
+    record.EventHeader.TimeStamp.QuadPart = 0x01DA000000000000LL;
+    const std::size_t length = input.size() - kHeaderSize;
+    record.UserData =
+        length != 0 ? const_cast<std::uint8_t*>(input.data() + kHeaderSize) : nullptr;
+    record.UserDataLength = static_cast<USHORT>(length);
+    return record;
+}
+
+/**
+ * @brief Fuzz input that make_record() turns back into record.
+ * @return Empty if the provider is not one of kProviders.
+ */
+[[nodiscard]] inline std::vector<std::uint8_t> encode(const EVENT_RECORD& record) {
+    std::vector<std::uint8_t> input;
+    for (std::size_t p = 0; p < std::size(kProviders); ++p) {
+        if (IsEqualGUID(record.EventHeader.ProviderId, *kProviders[p])) {
+            const USHORT id = record.EventHeader.EventDescriptor.Id;
+            const bool wide = (record.EventHeader.Flags & EVENT_HEADER_FLAG_64_BIT_HEADER) != 0;
+            input = {static_cast<std::uint8_t>(p), static_cast<std::uint8_t>(id & 0xFF),
+                     static_cast<std::uint8_t>(id >> 8),
+                     record.EventHeader.EventDescriptor.Version,
+                     static_cast<std::uint8_t>(wide ? 1 : 0)};
+            const auto* data = static_cast<const std::uint8_t*>(record.UserData);
+            input.insert(input.end(), data, data + (data != nullptr ? record.UserDataLength : 0));
+            break;
+        }
+    }
+    return input;
+}
+
+}  // namespace exeray::fuzz
+
+#endif  // _WIN32
@@ -0,0 +1,60 @@
+/// @file parser_fuzz.cpp
+/// @brief libFuzzer target: dispatch_event() on arbitrary UserData.
+///
+/// Every input becomes one record (see fuzz_record.hpp) routed to a
+/// built-in parser; deferred strings are then interned as the consumer
+/// does. The parsers must neither read outside UserData nor crash on any
+/// length; build with -fsanitize=fuzzer,address to have overreads caught.
+///
+///   exeray_parser_fuzz corpus/ seeds/
+///
+/// seeds/ is written by exeray_fuzz_seeds.
+
+#include "fuzz_record.hpp"
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/parser.hpp"
+#include "exeray/event/string_pool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace {
+
+/// @brief String pool of the run, started over before its arena fills up.
+class Pool {
+public:
+    Pool() { strings_.emplace(arena_); }
+
+    exeray::event::StringPool& get() {
+        if (arena_.used() > arena_.capacity() / 4 * 3) {
+            strings_.reset();
+            arena_.reset();
+            strings_.emplace(arena_);
+        }
+        return *strings_;
+    }
+
+private:
+    exeray::Arena arena_{64 * 1024 * 1024};
+    std::optional<exeray::event::StringPool> strings_;
+};
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+    static Pool pool;
+
+    // libFuzzer's buffer ends right after the input, so ASan flags any overread
+    const auto record = exeray::fuzz::make_record({data, size});
+    if (!record) {
+        return -1;  // Not added to the corpus
+    }
+    exeray::event::StringPool& strings = pool.get();
+    exeray::etw::ParsedEvent parsed = exeray::etw::dispatch_event(&*record, &strings);
+    if (parsed.valid) {
+        parsed.deferred.commit(parsed.payload, strings);
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+/// @file write_seeds.cpp
+/// @brief Writes the seed corpus of exeray_parser_fuzz.
+///
+/// One file per case of parser_cases_common.hpp, the records the parser
+/// tests check, so fuzzing starts from valid layouts of every parser:
+///
+///   exeray_fuzz_seeds seeds/
+
+#include "fuzz_record.hpp"
+
+#include "etw/parser_cases_common.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace exeray::etw::cases;
+
+template <typename Case>
+bool write_seed(const std::filesystem::path& dir, const char* name) {
+    const Case input;
+    const std::vector<std::uint8_t> bytes = exeray::fuzz::encode(*input.record());
+    std::ofstream out(dir / name, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(bytes.data()),
+              static_cast<std::streamsize>(bytes.size()));
+    return !bytes.empty() && static_cast<bool>(out);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s <seed directory>\n", argv[0]);
+        return 2;
+    }
+    const std::filesystem::path dir = argv[1];
+    std::error_code error;
+    std::filesystem::create_directories(dir, error);
+
+    const bool written = write_seed<ProcessStart>(dir, "process_start") &&
+                         write_seed<FileCreate>(dir, "file_create") &&
+                         write_seed<FileRead>(dir, "file_read") &&
+                         write_seed<TcpConnect>(dir, "tcp_connect") &&
+                         write_seed<RegistrySetValue>(dir, "registry_set_value") &&
+                         write_seed<ImageLoad>(dir, "image_load") &&
+                         write_seed<ThreadStart>(dir, "thread_start") &&
+                         write_seed<MemoryAlloc>(dir, "memory_alloc") &&
+                         write_seed<ScriptBlock>(dir, "script_block") &&
+                         write_seed<AmsiScan>(dir, "amsi_scan") &&
+                         write_seed<DnsQuery>(dir, "dns_query");
+    if (!written) {
+        std::fprintf(stderr, "cannot write seeds to %s\n", dir.string().c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+/// @file alloc_tracking.hpp
+/// @brief Heap allocation counters for zero-allocation checks of the event path.
+///
+/// The steady-state ingest path is meant not to touch the heap. Counting is
+/// done by a replacement of the global operator new in src/alloc_hook.cpp,
+/// which only the unit tests and benchmarks link (CMake target
+/// exeray_alloc_hook, option EXERAY_TRACK_ALLOCATIONS); the library and
+/// the application keep the default allocator. Without the hook every
+/// count stays zero and hooked() is false.
+///
+/// Counts are kept per thread, so an AllocationScope sees the allocations
+/// of the code it wraps and not those of workers running meanwhile.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace exeray::alloc {
+
+/// @brief Allocations and the bytes requested by them.
+struct AllocationCount {
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+
+    friend AllocationCount operator-(AllocationCount a, AllocationCount b) noexcept {
+        return {a.allocations - b.allocations, a.bytes - b.bytes};
+    }
+};
+
+/// @brief Whether the counting operator new is linked into the process.
+[[nodiscard]] bool hooked() noexcept;
+
+/// @brief Allocations of the calling thread since it started.
+[[nodiscard]] AllocationCount thread_allocations() noexcept;
+
+/// @brief Allocations of all threads since process start.
+[[nodiscard]] AllocationCount process_allocations() noexcept;
+
+/**
+ * @brief Allocations of the calling thread within a scope.
+ *
+ * @code
+ * alloc::AllocationScope scope;
+ * consumer.on_event(record);
+ * EXPECT_EQ(scope.count().allocations, 0U);
+ * @endcode
+ */
+class AllocationScope {
+public:
+    AllocationScope() noexcept : start_(thread_allocations()) {}
+
+    /// @brief Allocations since construction (or the last restart()).
+    [[nodiscard]] AllocationCount count() const noexcept { return thread_allocations() - start_; }
+
+    void restart() noexcept { start_ = thread_allocations(); }
+
+private:
+    AllocationCount start_;
+};
+
+namespace detail {
+
+/// @brief Count one allocation of size bytes (called by the hook).
+void record(std::size_t size) noexcept;
+
+/// @brief Called once by the hook when it is linked in.
+void mark_hooked() noexcept;
+
+}  // namespace detail
+
+}  // namespace exeray::alloc
@@ -4,25 +4,102 @@
 #include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <new>
+#include <string>
 
 namespace exeray {
 
+/// @brief Memory backing an Arena actually obtained.
+enum class ArenaBackend : std::uint8_t {
+    Heap,       ///< Aligned operator new, committed up front
+    Virtual,    ///< Reserved address range (VirtualAlloc / mmap)
+    LargePages, ///< Large/huge pages, committed and locked up front
+    File        ///< Shared mapping of a scratch file (ArenaOptions::backing_file)
+};
+
+/// @brief Allocation backend preferences for an Arena.
+///
+/// Every preference degrades gracefully: a failed large-page allocation
+/// (e.g. missing SeLockMemoryPrivilege) falls back to a virtual range, and a
+/// failed reservation falls back to the heap. Arena::backend() reports the
+/// outcome.
+struct ArenaOptions {
+    bool large_pages = false;  ///< Try large pages (TLB-friendly, never swapped)
+    bool lazy_commit = false;  ///< Reserve up front, commit as allocations grow
+    int numa_node = -1;        ///< Preferred NUMA node (-1 = no preference)
+
+    /// Bytes a background thread keeps committed and faulted in ahead of the
+    /// bump offset (0 = none). Needs a virtual range; first touches of fresh
+    /// memory then happen off the allocating threads.
+    std::size_t prefault = 0;
+
+    /// Growth ceiling in bytes (0 = fixed). When larger than the initial
+    /// capacity, this much address space is reserved and the arena grows
+    /// into it on demand; growth takes precedence over large pages.
+    std::size_t max_capacity = 0;
+
+    /// Scratch file to map instead of anonymous memory (empty = none). It
+    /// is created (replacing any file of that name) and sized to the
+    /// ceiling; its name is removed once mapped (on Windows, with the
+    /// arena). The OS writes cold pages back to it under pressure instead
+    /// of to swap, so the arena can outgrow RAM. Takes precedence over
+    /// large pages and prefault; falls back like a failed reservation.
+    std::string backing_file{};
+};
+
+/// @brief Point-in-time usage of one Arena (see Arena::stats()).
+struct ArenaStats {
+    std::size_t used = 0;        ///< Bytes handed out (bump offset)
+    std::size_t committed = 0;   ///< Bytes backed by memory
+    std::size_t reserved = 0;    ///< Address space held from the OS or heap
+    std::size_t capacity = 0;    ///< Bytes allocate() can hand out
+    std::size_t high_water = 0;  ///< Largest used() since construction
+    std::size_t padding = 0;     ///< Bytes lost to alignment and buffer tails
+                                 ///< since the last reset()
+    std::uint64_t failures = 0;  ///< Allocations refused (full or commit failed)
+};
+
 /// @brief A simple bump allocator for fast, contiguous memory allocation.
-/// 
+///
 /// @note Thread-safe. Uses atomic compare-exchange for lock-free allocation.
-///       For bulk allocations, consider reserving slots atomically before 
+///       For bulk allocations, consider reserving slots atomically before
 ///       writing (see EventGraph::push).
+///
+/// With lazy commit the whole capacity is reserved as address space but
+/// only committed in kCommitChunk steps as the bump offset crosses it; the
+/// commit itself is the only locked path and runs once per chunk.
+///
+/// With ArenaOptions::prefault a background thread commits and touches the
+/// pages ahead of the offset, a window at a time, so allocating threads find
+/// them resident; the hot path only checks one mark per allocation.
+///
+/// A growable arena (ArenaOptions::max_capacity) reserves its ceiling as one
+/// contiguous range and commits past the initial capacity the same way, so
+/// pointers stay stable and offsets from base() (StringId) stay valid. If
+/// the reservation fails the arena stays fixed at the initial capacity.
+///
+/// A file-backed arena (ArenaOptions::backing_file) maps the whole ceiling
+/// at once: the file is sparse, so disk blocks are only used for pages
+/// written, and page_out() lets the OS drop pages that will not be read
+/// again soon.
+///
+/// allocate_local() serves small objects from a per-thread buffer: a thread
+/// claims kLocalBlock bytes with a single CAS and bump-allocates privately
+/// inside it, at the type's own alignment.
 class Arena {
 public:
-    explicit Arena(std::size_t capacity)
-        : base_(static_cast<std::uint8_t*>(
-              ::operator new(capacity, std::align_val_t{64}))),
-          capacity_(capacity) {}
+    /// Granularity of lazy commits (one 2 MiB large page on x64).
+    static constexpr std::size_t kCommitChunk = std::size_t{2} << 20;
 
-    ~Arena() {
-        ::operator delete(base_, std::align_val_t{64});
-    }
+    /// Size of the block a thread claims for allocate_local() (capped at
+    /// capacity / 64 so small arenas are shared fairly between threads).
+    static constexpr std::size_t kLocalBlock = std::size_t{64} << 10;
+
+    explicit Arena(std::size_t capacity, const ArenaOptions& options = {});
+
+    ~Arena();
 
     Arena(const Arena&) = delete;
     Arena& operator=(const Arena&) = delete;
@@ -33,12 +110,90 @@ public:
     T* allocate(std::size_t count = 1) {
         // Overflow check: ensure sizeof(T) * count won't overflow
         if (count > (std::numeric_limits<std::size_t>::max)() / sizeof(T)) {
+            counted(nullptr);
             return nullptr;
         }
 
         constexpr auto align = alignof(T) < 64 ? 64 : alignof(T);
-        const std::size_t size = sizeof(T) * count;
+        return reinterpret_cast<T*>(counted(bump(sizeof(T) * count, align)));
+    }
+
+    /**
+     * @brief Allocate from the calling thread's private buffer.
+     *
+     * Alignment is alignof(T) instead of allocate()'s 64-byte minimum, so a
+     * 10-byte string costs 10 bytes rather than a cache line. Requests above
+     * an eighth of a block bypass the buffer, and once the arena cannot
+     * supply a whole block the request is served exactly from the shared
+     * offset.
+     *
+     * @note Each thread keeps its unused block tail, so used() counts claimed
+     *       blocks, not bytes handed out. Objects from different threads
+     *       never share a block (no false sharing between writers).
+     */
+    template<typename T>
+    T* allocate_local(std::size_t count = 1) {
+        if (count > (std::numeric_limits<std::size_t>::max)() / sizeof(T)) {
+            counted(nullptr);
+            return nullptr;
+        }
+        return reinterpret_cast<T*>(
+            counted(allocate_local_bytes(sizeof(T) * count, alignof(T))));
+    }
+
+    /// @brief Rewind the arena. Not safe concurrently with allocation;
+    /// outstanding thread buffers are dropped.
+    void reset() {
+        generation_.store(next_generation(), std::memory_order_release);
+        const auto used = offset_.exchange(0, std::memory_order_acq_rel);
+        if (used > high_water_.load(std::memory_order_relaxed)) {
+            high_water_.store(used, std::memory_order_relaxed);
+        }
+        padding_.store(0, std::memory_order_relaxed);
+    }
+    std::size_t used() const { return offset_.load(std::memory_order_acquire); }
+    /// @brief Bytes allocate() can hand out (the ceiling when growable).
+    std::size_t capacity() const { return capacity_; }
+    const std::uint8_t* base() const { return base_; }
+
+    /// @brief Bytes currently backed by memory (capacity unless lazy or growable).
+    std::size_t committed() const { return committed_.load(std::memory_order_acquire); }
 
+    /// @brief Backend that was actually obtained.
+    ArenaBackend backend() const { return backend_; }
+
+    /**
+     * @brief Whether memory from p on was never handed out since it was
+     * mapped, and so still reads as zero.
+     *
+     * True for fresh pages of a virtual or large-page range (the OS zeroes
+     * them) beyond anything allocated before the last reset(); callers can
+     * skip clearing such memory and leave its pages untouched until used.
+     */
+    bool zeroed(const void* p) const {
+        const auto* byte = static_cast<const std::uint8_t*>(p);
+        const auto offset = static_cast<std::size_t>(byte - base_);
+        return backend_ != ArenaBackend::Heap &&
+               offset >= high_water_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Hint that [p, p + size) will not be read again soon.
+     *
+     * File-backed pages are written back and leave RAM first when memory is
+     * short, then fault in again on access. No-op for other backends.
+     */
+    void page_out(const void* p, std::size_t size) const noexcept;
+
+    /// @brief NUMA node the memory was bound to (-1 = none applied).
+    int numa_node() const { return numa_node_; }
+
+    /// @brief Usage counters; each read atomically, not as one snapshot.
+    ArenaStats stats() const;
+
+private:
+    /// @brief Claim size bytes at align from the shared offset (lock-free).
+    std::uint8_t* bump(std::size_t size, std::size_t align) {
         std::size_t current = offset_.load(std::memory_order_relaxed);
         std::size_t aligned_offset;
         std::size_t new_offset;
@@ -54,18 +209,71 @@ public:
                                                  std::memory_order_release,
                                                  std::memory_order_relaxed));
 
-        return reinterpret_cast<T*>(base_ + aligned_offset);
+        if (aligned_offset != current) {
+            padding_.fetch_add(aligned_offset - current, std::memory_order_relaxed);
+        }
+        if (new_offset > committed_.load(std::memory_order_acquire) && !commit(new_offset))
+            [[unlikely]] {
+            return nullptr;
+        }
+        if (new_offset > prefault_mark_.load(std::memory_order_relaxed)) [[unlikely]] {
+            request_prefault(new_offset);
+        }
+        return base_ + aligned_offset;
     }
 
-    void reset() { offset_.store(0, std::memory_order_release); }
-    std::size_t used() const { return offset_.load(std::memory_order_acquire); }
-    std::size_t capacity() const { return capacity_; }
-    const std::uint8_t* base() const { return base_; }
+    /// @brief Count a refused allocation; passes the result through.
+    std::uint8_t* counted(std::uint8_t* result) noexcept {
+        if (result == nullptr) [[unlikely]] {
+            failures_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return result;
+    }
 
-private:
-    std::uint8_t* base_;
+    /// @brief Thread-buffer path behind allocate_local().
+    std::uint8_t* allocate_local_bytes(std::size_t size, std::size_t align);
+
+    /// @brief Process-unique generation; tags thread buffers to one arena
+    /// lifetime so a new arena at a reused address never sees stale blocks.
+    static std::uint64_t next_generation() noexcept;
+
+    /// @brief Commit the reservation up to at least end (slow path).
+    /// @return false if the OS refused to commit.
+    bool commit(std::size_t end);
+
+    /// @brief Release the backing memory according to backend_.
+    void release() noexcept;
+
+    /// @brief Map options.backing_file over size bytes (sets base_ on success).
+    void map_file(const std::string& path, std::size_t size);
+
+    /// @brief Background thread state behind ArenaOptions::prefault.
+    struct Prefaulter;
+
+    /// @brief Start the prefault thread on a virtual range (window 0 = none).
+    void start_prefault(std::size_t window);
+
+    /// @brief Ask the prefault thread to fault a window past offset.
+    void request_prefault(std::size_t offset);
+
+    /// @brief Body of the prefault thread.
+    void prefault_loop();
+
+    std::uint8_t* base_ = nullptr;
     std::atomic<std::size_t> offset_ = 0;
+    std::atomic<std::size_t> padding_{0};  ///< Next to offset_: same cache line
+    std::atomic<std::size_t> high_water_{0};  ///< Largest offset before a reset
+    std::atomic<std::uint64_t> failures_{0};
     std::size_t capacity_;
+    std::atomic<std::size_t> committed_ = 0;
+    /// Offset whose crossing wakes the prefault thread (max = not waiting)
+    std::atomic<std::size_t> prefault_mark_{(std::numeric_limits<std::size_t>::max)()};
+    std::size_t mapped_ = 0;  ///< Bytes reserved from the OS (rounded capacity)
+    ArenaBackend backend_ = ArenaBackend::Heap;
+    int numa_node_ = -1;
+    std::mutex commit_mutex_;
+    std::atomic<std::uint64_t> generation_{next_generation()};
+    std::unique_ptr<Prefaulter> prefaulter_;
 };
 
 }
@@ -0,0 +1,247 @@
+#pragma once
+
+/// @file async_task.hpp
+/// @brief C++20 coroutine task type for asynchronous engine operations.
+///
+/// AsyncTask<T> is lazy: its body starts only when the task is awaited
+/// (from another coroutine), waited on with get(), or handed to
+/// to_handle(). `co_await resume_on(pool)` moves the rest of a coroutine
+/// onto a pool worker, so a blocking body never runs on the caller's
+/// thread. Completion resumes the awaiting coroutine directly (symmetric
+/// transfer), so long chains of awaits do not grow the stack.
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "exeray/task_graph.hpp"
+#include "exeray/thread_pool.hpp"
+
+namespace exeray {
+
+template <typename T = void>
+class AsyncTask;
+
+namespace detail {
+
+/// @brief Signalled by a task that get() started; lives on the waiter's stack.
+struct BlockingWait {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+
+    void signal() {
+        // Notify under the lock: the waiter cannot return and free us before we unlock
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        cv.notify_all();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this] { return done; });
+    }
+};
+
+/// @brief Promise parts shared by every result type.
+class AsyncPromiseBase {
+public:
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> self) noexcept {
+            AsyncPromiseBase& promise = self.promise();
+            if (promise.continuation_) {
+                return promise.continuation_;
+            }
+            if (promise.blocking_ != nullptr) {
+                promise.blocking_->signal();
+            }
+            return std::noop_coroutine();
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    /// Engine operations report failure through their results, never by throwing.
+    void unhandled_exception() noexcept { std::terminate(); }
+
+    void set_continuation(std::coroutine_handle<> continuation) noexcept {
+        continuation_ = continuation;
+    }
+
+    void set_blocking(BlockingWait* blocking) noexcept { blocking_ = blocking; }
+
+private:
+    std::coroutine_handle<> continuation_;
+    BlockingWait* blocking_ = nullptr;
+};
+
+template <typename T>
+class AsyncPromise : public AsyncPromiseBase {
+public:
+    AsyncTask<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U&& value) {
+        value_.emplace(std::forward<U>(value));
+    }
+
+    T take() { return std::move(*value_); }
+
+private:
+    std::optional<T> value_;
+};
+
+template <>
+class AsyncPromise<void> : public AsyncPromiseBase {
+public:
+    AsyncTask<void> get_return_object() noexcept;
+
+    void return_void() noexcept {}
+
+    void take() noexcept {}
+};
+
+}  // namespace detail
+
+/**
+ * @brief Lazily started coroutine producing a T.
+ *
+ * Move-only. A task is consumed by exactly one of `co_await`, get() or
+ * to_handle(). Destroying a task that never started leaves its body unrun;
+ * destroying one that is still running is not allowed.
+ */
+template <typename T>
+class [[nodiscard]] AsyncTask {
+public:
+    using promise_type = detail::AsyncPromise<T>;
+
+    AsyncTask(AsyncTask&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    AsyncTask& operator=(AsyncTask&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    AsyncTask(const AsyncTask&) = delete;
+    AsyncTask& operator=(const AsyncTask&) = delete;
+
+    ~AsyncTask() { destroy(); }
+
+    bool await_ready() const noexcept { return false; }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().set_continuation(awaiting);
+        return handle_;
+    }
+
+    T await_resume() { return handle_.promise().take(); }
+
+    /// @brief Run the task to completion, blocking the calling thread.
+    ///
+    /// Not for a pool worker whose pool the task needs.
+    T get() && {
+        detail::BlockingWait blocking;
+        handle_.promise().set_blocking(&blocking);
+        handle_.resume();
+        blocking.wait();
+        return handle_.promise().take();
+    }
+
+private:
+    friend class detail::AsyncPromise<T>;
+
+    explicit AsyncTask(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+    void destroy() noexcept {
+        if (handle_) {
+            std::exchange(handle_, {}).destroy();
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+template <typename T>
+AsyncTask<T> AsyncPromise<T>::get_return_object() noexcept {
+    return AsyncTask<T>(std::coroutine_handle<AsyncPromise<T>>::from_promise(*this));
+}
+
+inline AsyncTask<void> AsyncPromise<void>::get_return_object() noexcept {
+    return AsyncTask<void>(std::coroutine_handle<AsyncPromise<void>>::from_promise(*this));
+}
+
+/// @brief Eagerly started, self-destroying coroutine driving to_handle().
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+template <typename T>
+Detached drive(AsyncTask<T> task, TaskPromise<T> promise) {
+    if constexpr (std::is_void_v<T>) {
+        co_await std::move(task);
+        promise.set_value();
+    } else {
+        promise.set_value(co_await std::move(task));
+    }
+}
+
+}  // namespace detail
+
+/// @brief Awaitable continuing the awaiting coroutine on a worker of pool.
+class ResumeOn {
+public:
+    explicit ResumeOn(ThreadPool& pool) noexcept : pool_(pool) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> awaiting) {
+        pool_.submit([awaiting] { awaiting.resume(); });
+    }
+
+    void await_resume() const noexcept {}
+
+private:
+    ThreadPool& pool_;
+};
+
+/// @brief `co_await resume_on(pool)`: continue on a pool worker.
+[[nodiscard]] inline ResumeOn resume_on(ThreadPool& pool) noexcept {
+    return ResumeOn(pool);
+}
+
+/**
+ * @brief Start task now and return a handle that finishes with it.
+ *
+ * Bridges to TaskHandle for callers that are not coroutines: poll ready(),
+ * chain with then() or wait(). The task runs on the calling thread until
+ * its first suspension (typically resume_on()).
+ */
+template <typename T>
+TaskHandle<T> to_handle(AsyncTask<T> task) {
+    TaskPromise<T> promise;
+    TaskHandle<T> handle = promise.handle();
+    detail::drive(std::move(task), std::move(promise));
+    return handle;
+}
+
+}  // namespace exeray
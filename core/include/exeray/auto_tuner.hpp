@@ -0,0 +1,113 @@
+#pragma once
+
+/// @file auto_tuner.hpp
+/// @brief Moves ingest parameters within bounds as the host and load change.
+///
+/// The batch size, detection worker count and shedding thresholds that
+/// suit a laptop starve a 128-core server, and the other way round. The
+/// AutoTuner reads the signals the engine already publishes in its
+/// MetricsRegistry (ETW loss, record ring overflows, detection backlog,
+/// ingest latency, process CPU time) once per interval and nudges one
+/// step at a time: loss makes batches larger and shedding earlier, a
+/// backlog adds detection workers, high latency makes batches smaller,
+/// a CPU budget overrun sheds and removes workers, and a run of quiet
+/// intervals walks everything back toward the configured values.
+///
+/// The tuner itself is a pure state machine so policies can be tested
+/// with synthetic signals; Engine runs it on a controller thread and
+/// applies and logs what it returns.
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "exeray/metrics.hpp"
+
+namespace exeray {
+
+/// @brief Bounds and targets of the auto-tuner (see EngineConfig::auto_tune).
+struct AutoTuneConfig {
+    bool enabled = false;               ///< Run the controller while monitoring
+    std::uint32_t interval_ms = 2000;   ///< Between two adjustments
+    std::uint32_t min_batch = 64;       ///< Fewest events per pushed batch
+    std::uint32_t max_batch = 8192;     ///< Most events per pushed batch
+    std::size_t min_workers = 1;        ///< Fewest detection workers
+    std::size_t max_workers = 0;        ///< Most detection workers (0 = pool size)
+    std::uint8_t min_sample_percent = 20;  ///< Earliest shedding may start
+    std::uint32_t latency_target_ms = 500;  ///< p99 event age at graph visibility
+    std::uint8_t cpu_budget_percent = 0;    ///< Of all processors (0 = no budget)
+    std::uint32_t quiet_intervals = 5;      ///< Quiet intervals before relaxing a step
+};
+
+/// @brief Parameters the tuner moves.
+struct TuningState {
+    std::uint32_t batch = 512;         ///< Pending events that trigger a push
+    std::size_t workers = 0;           ///< Detection workers (0 = detection inline)
+    std::uint8_t sample_percent = 50;  ///< Shedding sample threshold
+    std::uint8_t drop_percent = 80;    ///< Shedding drop threshold
+
+    bool operator==(const TuningState&) const = default;
+};
+
+/// @brief What the tuner reads from a metrics snapshot.
+struct TuningSignals {
+    double lost = 0.0;         ///< ETW events and buffers lost plus ring overflows (cumulative)
+    double backlog = 0.0;      ///< Stored events waiting for detection
+    double latency_s = 0.0;    ///< p99 event age at graph visibility
+    double cpu_seconds = 0.0;  ///< Process CPU time (cumulative)
+
+    /// @brief Extract the signals from an Engine metrics snapshot.
+    [[nodiscard]] static TuningSignals from(const std::vector<MetricSample>& samples);
+};
+
+/**
+ * @brief Feedback controller over TuningState.
+ *
+ * Thread-safety: none; one controller thread calls step().
+ */
+class AutoTuner {
+public:
+    /// Backlog per worker above which another worker is added.
+    static constexpr double kBacklogPerWorker = 4096.0;
+    /// Shedding thresholds move this many percent per step.
+    static constexpr std::uint8_t kShedStep = 10;
+
+    /**
+     * @param config Bounds and targets.
+     * @param initial State the session started with; relaxing returns to it.
+     * @param processors Logical processors, for the CPU budget.
+     */
+    AutoTuner(const AutoTuneConfig& config, const TuningState& initial, unsigned processors);
+
+    /**
+     * @brief Compare signals with the previous interval and move one step.
+     *
+     * The first call only records the baseline.
+     *
+     * @param elapsed_s Wall time since the previous call.
+     * @return The state to apply (unchanged if nothing called for a move).
+     */
+    const TuningState& step(const TuningSignals& signals, double elapsed_s);
+
+    /// @brief Current state.
+    [[nodiscard]] const TuningState& state() const noexcept { return state_; }
+
+    /// @brief Why the last step changed the state (empty if it did not).
+    [[nodiscard]] std::string_view reason() const noexcept { return reason_; }
+
+private:
+    /// @brief Shed earlier by one step.
+    void shed_more() noexcept;
+
+    AutoTuneConfig config_;
+    TuningState initial_;
+    TuningState state_;
+    unsigned processors_;
+    TuningSignals previous_{};
+    bool primed_ = false;
+    std::uint32_t quiet_ = 0;  ///< Consecutive quiet intervals
+    std::string_view reason_;
+};
+
+}  // namespace exeray
@@ -0,0 +1,79 @@
+#pragma once
+
+/**
+ * @file checkpoint.hpp
+ * @brief Engine state kept on disk so a restarted agent correlates at once.
+ *
+ * An agent restarted for an upgrade or after a crash starts with an empty
+ * Correlator: every process already running has lost its correlation ID,
+ * its risk score, its loaded modules and its executable allocations until
+ * it happens to be seen again. A checkpoint carries them over. It holds no
+ * EventIds or StringIds, which name events and strings of the previous
+ * run: module paths are stored as text and interned again on restore.
+ *
+ * Layout (native byte order): a 32-byte header {magic, format, written,
+ * strings, FNV-1a of the body}, then the body: next correlation ID (u32),
+ * pad, risk time (u64), the five record counts (u32 each) and pad, then
+ * the records in that order: lives {pid, correlation ID, start, stop},
+ * process and chain risk scores {key, pad, events, last, score}, memory
+ * regions {pid, allocator pid, base, size, allocated, flags, pad} and
+ * modules {pid, path length, base, size, path padded to 8}.
+ */
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "exeray/etw/memory_regions.hpp"
+#include "exeray/event/correlator.hpp"
+
+namespace exeray {
+
+/// @brief One loaded module, with its path as text.
+struct CheckpointModule {
+    std::uint32_t pid = 0;
+    std::uint64_t base = 0;
+    std::uint64_t size = 0;
+    std::string path;
+};
+
+/// @brief Everything a checkpoint file carries.
+struct Checkpoint {
+    std::uint64_t written = 0;  ///< Wall clock, nanoseconds since the Unix epoch
+    std::uint64_t strings = 0;  ///< StringPool::count() when written
+    event::CorrelatorState correlator;
+    std::vector<std::pair<std::uint32_t, etw::MemoryRegion>> regions;  ///< By PID
+    std::vector<CheckpointModule> modules;
+};
+
+/// @brief "EXRC" in the first four bytes of a checkpoint file.
+inline constexpr std::uint32_t kCheckpointMagic = 0x43525845;
+
+/// @brief Bumped whenever the layout changes.
+inline constexpr std::uint32_t kCheckpointFormat = 1;
+
+/// @brief Longest module path accepted from a file.
+inline constexpr std::uint32_t kMaxCheckpointPath = 32768;
+
+/// @brief Serialize a checkpoint.
+[[nodiscard]] std::vector<std::uint8_t> encode_checkpoint(const Checkpoint& checkpoint);
+
+/**
+ * @brief Parse what encode_checkpoint() produced.
+ * @return nullopt if the data is truncated, corrupt or of another format.
+ */
+[[nodiscard]] std::optional<Checkpoint> decode_checkpoint(std::span<const std::uint8_t> bytes);
+
+/// @brief Write a checkpoint file, replacing the old one only once complete,
+/// so a crash while writing leaves the previous checkpoint intact.
+/// @return false if the file could not be written.
+bool write_checkpoint_file(const std::filesystem::path& path, const Checkpoint& checkpoint);
+
+/// @brief Map and decode a checkpoint file; nullopt if missing or unusable.
+[[nodiscard]] std::optional<Checkpoint> read_checkpoint_file(const std::filesystem::path& path);
+
+}  // namespace exeray
@@ -9,19 +9,60 @@
 /// - Thread-safe event storage in EventGraph
 
 #include "exeray/arena.hpp"
+#include "exeray/async_task.hpp"
+#include "exeray/auto_tuner.hpp"
 #include "exeray/event/correlator.hpp"
+#include "exeray/event/device_paths.hpp"
+#include "exeray/event/extensions.hpp"
 #include "exeray/event/graph.hpp"
+#include "exeray/event/stack_table.hpp"
 #include "exeray/event/string_pool.hpp"
+#include "exeray/event/wall_clock.hpp"
+#include "exeray/etw/behavior_profiles.hpp"
 #include "exeray/etw/consumer.hpp"
+#include "exeray/etw/record_ring.hpp"
+#include "exeray/etw/session_buffers.hpp"
+#include "exeray/etw/session_stats.hpp"
+#include "exeray/etw/shard_merger.hpp"
+#include "exeray/etw/ingest_latency.hpp"
+#include "exeray/etw/jit_aggregator.hpp"
+#include "exeray/etw/logon_sessions.hpp"
+#include "exeray/etw/manifest_providers.hpp"
+#include "exeray/etw/memory_capture.hpp"
+#include "exeray/etw/wmi_aggregator.hpp"
+#include "exeray/etw/parse_metrics.hpp"
+#include "exeray/etw/sampler.hpp"
+#include "exeray/etw/shed_policy.hpp"
+#include "exeray/etw/stack_symbolizer.hpp"
+#include "exeray/etw/detection_rules.hpp"
+#include "exeray/etw/detection_stage.hpp"
+#include "exeray/etw/content_scanner.hpp"
+#include "exeray/etw/image_verifier.hpp"
+#include "exeray/etw/domain_map.hpp"
+#include "exeray/etw/flow_table.hpp"
+#include "exeray/etw/ioc_matcher.hpp"
+#include "exeray/etw/module_map.hpp"
+#include "exeray/etw/provider_presets.hpp"
+#include "exeray/etw/rate_monitor.hpp"
 #include "exeray/etw/session.hpp"
+#include "exeray/etw/synthetic_source.hpp"
+#include "exeray/etw/target_set.hpp"
+#include "exeray/metrics.hpp"
+#include "exeray/platform/thread.hpp"
 #include "exeray/process/controller.hpp"
+#include "exeray/sampling_profiler.hpp"
 #include "exeray/thread_pool.hpp"
 #include "exeray/types.hpp"
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <coroutine>
 #include <cstdint>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <string>
 #include <string_view>
 #include <thread>
 #include <unordered_map>
@@ -29,23 +70,475 @@
 
 namespace exeray {
 
+struct Checkpoint;
+
 /// @brief Configuration for a single ETW provider.
 struct ProviderConfig {
     bool enabled = true;           ///< Whether the provider is enabled.
     uint8_t level = 4;             ///< Trace level (4 = TRACE_LEVEL_INFORMATION).
     uint64_t keywords = 0;         ///< Keyword bitmask (0 = all keywords).
+    uint8_t session = 0;           ///< ETW session group (see EngineConfig::providers).
+
+    /// @brief Event IDs to deliver (empty = all), filtered in the kernel.
+    ///
+    /// At most 64 IDs are used; ignored by providers without a manifest.
+    std::vector<uint16_t> event_ids;
+
+    /// @brief Event IDs captured with their call stack when
+    /// EngineConfig::capture_stacks is set (empty = the preset's).
+    std::vector<uint16_t> stack_event_ids{};
+
+    /// @brief Curated level, keywords and event IDs (etw/provider_presets.hpp).
+    ///
+    /// Anything but Custom replaces level and keywords; event_ids, if set,
+    /// still take precedence over the preset's IDs.
+    etw::ProviderPreset preset = etw::ProviderPreset::Custom;
+};
+
+/// @brief Level, keywords (0 = all) and event IDs a provider is enabled with.
+[[nodiscard]] etw::PresetSettings provider_settings(std::string_view provider,
+                                                   const ProviderConfig& cfg);
+
+/// @brief Capacity and backing of one engine arena.
+struct ArenaConfig {
+    std::size_t size = 0;      ///< Initial capacity in bytes (0 = not used).
+    ArenaOptions options{};    ///< Backend and growth policy.
 };
 
 /// @brief Engine configuration parameters.
 struct EngineConfig {
-    std::size_t arena_size = 0;   ///< Size of the memory arena in bytes.
-    std::size_t num_threads = 0;  ///< Number of worker threads.
+    /// Default ArenaOptions::prefault of the event arena (two commit chunks).
+    static constexpr std::size_t kDefaultPrefault = 2 * Arena::kCommitChunk;
+
+    std::size_t arena_size = 0;   ///< Size of the event arena in bytes.
+    std::size_t num_threads = 0;  ///< Number of worker threads (0 = per pool_placement).
     int log_level = 2;            ///< Log level: 0=trace, 1=debug, 2=info, 3=warn, 4=error.
     std::string log_file;         ///< Optional log file path (empty = stderr only).
 
     /// @brief Provider configurations (name → config).
+    ///
+    /// Providers with the same ProviderConfig::session share one ETW
+    /// session. Every session has its own ProcessTrace thread, so splitting
+    /// busy providers (e.g. File/Registry on 1, Network/DNS on 2,
+    /// PowerShell/AMSI/CLR on 3) spreads parsing over several cores; their
+    /// events are merged by timestamp before insertion (etw::ShardMerger).
+    /// Keep Process with Image and Thread so parents resolve in order.
     std::unordered_map<std::string, ProviderConfig> providers;
 
+    /// @brief Providers without a parser, decoded from their manifest.
+    ///
+    /// Their events become Category::Manifest events holding the
+    /// properties each registration projects (etw/manifest_providers.hpp);
+    /// see Engine::register_provider(). Each is enabled with a default
+    /// ProviderConfig unless providers above names it.
+    std::vector<etw::ManifestProviderConfig> manifest_providers{};
+
+    /// @brief Maximum number of events kept in the EventGraph.
+    ///
+    /// Graph storage is allocated from the arena one segment at a time, so a
+    /// large limit costs nothing until events actually arrive.
+    std::size_t max_events = std::size_t{1} << 20;
+
+    /// @brief Optional byte budget for event storage (0 = max_events only).
+    ///
+    /// When set, the graph holds at most max_event_bytes / sizeof(EventNode)
+    /// events, whichever of the two limits is smaller.
+    std::size_t max_event_bytes = 0;
+
+    /// @brief What the graph does once its budget is reached.
+    ///
+    /// Retention::Ring recycles the oldest events for 24/7 monitoring;
+    /// Retention::Append keeps everything and drops new events.
+    event::Retention retention = event::Retention::Append;
+
+    /// @brief Seal full graph segments into columnar storage.
+    ///
+    /// Speeds up filtered scans at the cost of a column copy per segment.
+    bool columnar_segments = false;
+
+    /// @brief Compress graph segments in RAM once they leave the hot window.
+    ///
+    /// Cold nodes are delta-encoded and LZ-compressed and decoded on access
+    /// into a small LRU (EventGraph::set_compression()); queries see no
+    /// difference. Append retention only. Ratio and decode cost are in
+    /// MemoryStats::compression.
+    event::CompressionConfig compression{};
+
+    /// @brief Arena that graph segments move to once they leave the hot
+    /// window (size 0 = kept in the event arena).
+    ///
+    /// Give it ArenaOptions::backing_file so long captures outgrow RAM:
+    /// the OS pages cold nodes out to that file and faults them back in
+    /// when a query reads them (EventGraph::set_spill()). Append retention
+    /// only, and ignored with compression on. Recycled with every session.
+    ArenaConfig spill_arena{};
+
+    /// @brief Newest full segments kept in the event arena when spilling.
+    std::size_t spill_hot_segments = 4;
+
+    /// @brief Long-term store for what ring retention evicts.
+    ///
+    /// Evicted events that are Suspicious or tagged, or belong to a
+    /// correlation chain or process with such an event, are copied into a
+    /// fixed-size store (Engine::retained()); the rest are reduced to
+    /// counts per category, status and process. Ring retention only.
+    event::RetainedConfig retained{};
+
+    /// @brief String fields to index by StringId, as "Category.field"
+    /// (e.g. "FileSystem.path", "Dns.domain").
+    ///
+    /// Lets EventGraph::for_each_with_string() pivot on a path or domain
+    /// without scanning; each indexed string costs a posting per event.
+    std::vector<std::string> indexed_strings{};
+
+    /// @brief Index interned strings by trigram for substring search.
+    ///
+    /// Engine::string_search() then finds "paths containing \\temp\\"
+    /// without reading the whole pool, at a few postings per string byte.
+    bool string_search = false;
+
+    /// @brief Seconds of per-second event counts kept by the graph
+    /// (EventGraph::timeline(); 0 = none).
+    ///
+    /// The timeline view reads these instead of scanning the graph; each
+    /// second costs 128 bytes.
+    std::size_t timeline_seconds = event::EventTimeline::kDefaultSeconds;
+
+    /// @brief Keys kept per heavy-hitter table of EventGraph::sketches()
+    /// (0 = no sketches).
+    ///
+    /// Tracks the most frequent files, remote addresses, domains and
+    /// processes and their distinct counts in fixed memory (about 150 KiB),
+    /// published as exeray_sketch_* metrics.
+    std::size_t sketch_top = 20;
+
+    /// @brief Alerts held by Engine::alerts() until they are popped
+    /// (0 = no alert queue).
+    ///
+    /// Every event published as or marked Suspicious is queued there as it
+    /// happens, so a UI or integration learns of it without scanning the
+    /// graph; a full queue drops new alerts (exeray_alerts_dropped_total).
+    std::size_t alert_capacity = event::AlertQueue::kDefaultCapacity;
+
+    /// @brief Backing store preferences for the event arena (large pages,
+    /// NUMA node, lazy commit, prefault, growth ceiling). The backend
+    /// obtained is in Engine::diagnostics().
+    ///
+    /// By default the arena is only reserved, so construction takes the same
+    /// time whatever arena_size is, and a background thread faults in
+    /// kDefaultPrefault bytes ahead of the events being written.
+    ArenaOptions arena_options{.lazy_commit = true, .prefault = kDefaultPrefault};
+
+    /// @brief Dedicated arena for interned strings.
+    ///
+    /// With size 0 strings share the event arena, so a burst of unique paths
+    /// competes with event storage. A separate arena gets its own budget and
+    /// growth policy, and with ArenaOptions::backing_file pages out to disk
+    /// like spill_arena.
+    ArenaConfig string_arena{};
+
+    /// @brief Where interned strings are kept.
+    ///
+    /// Arena storage never frees a string, so an agent that runs for weeks
+    /// with retention on still grows with every unique path and command
+    /// line it has seen. Generational storage keeps strings in heap blocks
+    /// that Engine::compact_strings() releases once no retained event,
+    /// loaded module or open file or key names them and they went unused
+    /// for a generation; see event::StringPool::compact().
+    event::StringStorage string_storage = event::StringStorage::Arena;
+
+    /// @brief How often compact_strings() runs while monitoring with
+    /// generational string storage (0 = only when called).
+    std::uint32_t string_compaction_ms = 60000;
+
+    /// @brief Per-session scratch arena for detectors and analyses.
+    ///
+    /// Exposed as Engine::scratch_arena() and recycled with every session.
+    ArenaConfig scratch_arena{};
+
+    /// @brief Recycle all arenas when start_monitoring() begins a session.
+    ///
+    /// Without it events accumulate across sessions until the event budget
+    /// runs out; see Engine::reset_session().
+    bool recycle_on_start = false;
+
+    /// @brief Store File/Image/Registry device paths in DOS form.
+    ///
+    /// "\\Device\\HarddiskVolume3\\x.dll" is interned as "C:\\x.dll" using a
+    /// volume map loaded at construction and refreshed when an unknown
+    /// volume appears; see event::DevicePathMap.
+    bool normalize_device_paths = true;
+
+    /// @brief Keep the events of every process a target starts, transitively.
+    ///
+    /// Children are added as their ProcessStart arrives, so the
+    /// Kernel-Process provider must be enabled. ETW's own PID filter cannot
+    /// learn new processes, so it is not used while following; the callback
+    /// filters alone.
+    bool follow_children = true;
+
+    /// @brief Keep the ETW sessions running between targets.
+    ///
+    /// stop_monitoring() then leaves the sessions, their providers, the
+    /// consumer threads and the async workers running with an empty target
+    /// set, whose callback filter drops every event. The next
+    /// start_monitoring() or attach() only adds the new PIDs to that set,
+    /// which takes microseconds instead of creating, enabling and starting
+    /// every session; Engine::prepare_monitoring() does that ahead of the
+    /// first target. ETW's own PID filter is not used, as with
+    /// follow_children. Trackers (flows, modules, domains...) carry over
+    /// between targets, and recycle_on_start waits for the sessions to
+    /// close (Engine::close_standby()). Not for monitor_system().
+    bool standby_session = false;
+
+    /// @brief Size of the ring between the ETW callback and parsing (0 = off).
+    ///
+    /// With a ring the ProcessTrace callback only copies each record; a pool
+    /// worker parses and inserts it, so slow parsing no longer makes ETW
+    /// drop buffers. Records that do not fit are counted in
+    /// IngestStats::overflows. Needs num_threads >= 2, since the drain
+    /// occupies one worker for the whole session; otherwise records are
+    /// parsed inside the callback.
+    std::size_t ingest_ring_bytes = std::size_t{16} << 20;
+
+    /// @brief ETW session buffer size, count and flush timer.
+    ///
+    /// Fields left at 0 are sized from the enabled providers and the core
+    /// count (see etw::resolve_buffers()). Lower flush_timer_ms for latency,
+    /// raise buffer_kb/max_buffers for throughput. The values ETW applied
+    /// are in EngineDiagnostics::etw_buffers.
+    etw::SessionBuffers etw_buffers{};
+
+    /// @brief Also write the raw ETW stream to an .etl file (empty path = off).
+    ///
+    /// The live session logs its own buffers, so preserving the stream costs
+    /// no second kernel session. Circular mode keeps the last max_mb; with
+    /// several sessions, session n writes etw::log_path_for(path, n). Feed
+    /// the file to Engine::replay() to parse it again.
+    etw::SessionLog etw_log{};
+
+    /// @brief Cores and priority of the ProcessTrace threads.
+    ///
+    /// Pin them away from the UI and raise them (TimeCritical, or the MMCSS
+    /// "Capture" class) so a CPU spike on the host does not starve the
+    /// consumer into buffer loss.
+    platform::ThreadPlacement etw_threads{};
+
+    /// @brief Cores and priority of the record ring drain workers.
+    ///
+    /// With no cores given but etw_threads pinned, drains run on the cores
+    /// sharing an L2 cache with the ETW cores (excluding them), so staged
+    /// records are still cache-hot when parsed; without such neighbours, on
+    /// the other cores of the ETW cores' sockets. Applied for the session
+    /// only; the pool worker is restored afterwards.
+    platform::ThreadPlacement ingest_threads{};
+
+    /// @brief How the worker threads are spread over the processors.
+    ///
+    /// On multi-socket machines and Windows hosts with several processor
+    /// groups an unpinned pool lands wherever the scheduler puts it. Compact
+    /// keeps the workers on as few sockets as possible, Scatter spreads them
+    /// for memory bandwidth, OnePerCore leaves SMT siblings idle and Group
+    /// keeps the pool inside one processor group.
+    platform::PoolPlacement pool_placement = platform::PoolPlacement::None;
+
+    /// @brief How often ETW loss counters are sampled while monitoring.
+    std::uint32_t stats_interval_ms = 1000;
+
+    /// @brief Longest events of one session wait for the others to be merged.
+    std::uint32_t merge_lag_ms = 2000;
+
+    /// @brief Longest stop_monitoring() waits for events still in ETW buffers.
+    ///
+    /// The sessions are flushed and the consumers given this long to read
+    /// every buffer written before the sessions stop, so the tail of a run
+    /// is kept. 0 detaches at once and drops what is buffered; how the last
+    /// stop went is in Engine::last_stop().
+    std::uint32_t stop_drain_ms = 2000;
+
+    /// @brief Load shedding while the consumer falls behind.
+    ///
+    /// Pressure is the fill of the ETW buffers (sampled every
+    /// stats_interval_ms) or of the record ring, whichever is higher. Shed
+    /// events are counted in Engine::shed_stats().
+    etw::ShedConfig shedding{};
+
+    /// @brief Deterministic per-category sampling at any load.
+    ///
+    /// Applied to parsed events after interning, unless they are already
+    /// Suspicious or a rate spike. A process whose risk score reaches
+    /// promote_score keeps all of its later events. Decisions are counted
+    /// in Engine::sampling_stats().
+    etw::SamplingConfig sampling{};
+
+    /// @brief Adjust the batch size, detection workers and shedding
+    /// thresholds while monitoring.
+    ///
+    /// A controller thread reads ETW loss, ring overflows, detection
+    /// backlog, ingest latency and process CPU time from the metrics every
+    /// interval_ms and moves the parameters one step within the bounds,
+    /// logging each change; see exeray/auto_tuner.hpp. The values above
+    /// are the starting point and are restored when monitoring stops.
+    AutoTuneConfig auto_tune{};
+
+    /// @brief Aggregation of TCP and UDP transfers into per-flow records.
+    ///
+    /// Only connects, closes, the first transfer of each flow and direction
+    /// and periodic summaries reach the graph; exact counters are in
+    /// Engine::network_flows() and what was folded in Engine::flow_stats().
+    etw::FlowConfig flows{};
+
+    /// @brief Domains of the addresses DNS resolved, given to the IPv4
+    /// network events that connect to them (NetworkPayload::remote_domain).
+    ///
+    /// Needs the DNS provider; resolution counts and query-to-response
+    /// pairing are in Engine::domain_stats().
+    etw::DomainMapConfig domains{};
+
+    /// @brief Aggregation of CLR JIT events into per-module summaries.
+    ///
+    /// Only the first compilation of each module, periodic summaries and
+    /// the compilations of in-memory modules reach the graph; exact counts
+    /// are in Engine::jit_modules() and what was folded in
+    /// Engine::jit_stats().
+    etw::JitConfig jit{};
+
+    /// @brief Logon sessions opened by Security 4624 events.
+    ///
+    /// Process-audit and token events are given the user and logon type of
+    /// the session they name; open sessions are in Engine::logon_sessions().
+    etw::LogonConfig logons{};
+
+    /// @brief Aggregation of repeated WMI operations into per-client summaries.
+    ///
+    /// The first occurrence of each (client, operation, namespace, query,
+    /// host) and periodic counted summaries reach the graph; totals are in
+    /// Engine::wmi_operations().
+    etw::WmiConfig wmi{};
+
+    /// @brief Per-process, per-category event rate baselines.
+    ///
+    /// An event that takes its process past factor times the usual rate of
+    /// its category is marked Suspicious; the windows flagged are in
+    /// Engine::rate_anomalies().
+    etw::RateConfig rates{};
+
+    /// @brief Window in which consecutive reads or writes of one open file
+    /// are stored as one event (0 = store every I/O).
+    ///
+    /// The merged event sums the bytes and counts the I/Os in
+    /// FilePayload::ops; it is stored before the next other operation on the
+    /// file, so a cleanup still follows the I/O it closes.
+    std::uint32_t file_coalesce_ms = 100;
+
+    /// @brief Detection rules applied to every kept event (see
+    /// etw::parse_detection_rules() for the text form).
+    ///
+    /// An event any rule fires on is stored as Status::Suspicious; per-rule
+    /// counts are in Engine::detection_stats(). The built-in injection
+    /// sequences are evaluated too unless detection.builtin_rules is false.
+    etw::DetectionConfig detection{};
+
+    /// @brief Indicator lists matched against domains, paths and addresses.
+    ///
+    /// The lists are loaded when the engine is constructed. An event with a
+    /// listed indicator is stored as Status::Suspicious; hits per list are
+    /// in Engine::ioc_stats().
+    etw::IocConfig ioc{};
+
+    /// @brief Pool workers testing detection rules and IOC lists after the
+    /// push (0 = inline in the consumer).
+    ///
+    /// Off the ingest path parse and insert latency no longer depend on
+    /// detection cost; an event is marked Suspicious once a worker reaches
+    /// it, see Engine::detection_stage_stats(). Only the workers left free
+    /// by the ingest drains are used; with none, detection stays inline.
+    std::size_t detection_workers = 1;
+
+    /// @brief Time every parse per provider and event ID (see Engine::parse_metrics()).
+    ///
+    /// Costs two cycle-counter reads and a few stores per event.
+    bool parse_metrics = true;
+
+    /// @brief Sample event ages at delivery and graph visibility (see
+    /// Engine::ingest_latency()). Costs a clock read per sampled record
+    /// and per pushed batch. Not applied to replayed files.
+    bool ingest_latency = true;
+
+    /// @brief Sample the stage of the consumer, ingest and detector threads
+    /// this often, in microseconds (0 = off; see Engine::dump_profile()).
+    /// One watchdog thread; the markers themselves are always in place.
+    std::uint32_t profile_interval_us = 0;
+
+    /// @brief File keeping resolved TDH schemas across runs (empty = off).
+    ///
+    /// Loaded at construction and rewritten on destruction, so events taking
+    /// the TDH fallback skip TdhGetEventInformation from the first one on.
+    /// A file written on another OS build is ignored (see etw/tdh/schema_file.hpp).
+    std::wstring tdh_schema_file{};
+
+    /// @brief Resolve the manifests of all enabled providers while the
+    /// target is still suspended, instead of on their first events.
+    bool prewarm_schemas = false;
+
+    /// @brief File carrying correlation state across restarts (empty = off).
+    ///
+    /// Read at construction, rewritten every checkpoint_interval_ms while
+    /// monitoring and when monitoring stops. A restarted agent (upgrade,
+    /// crash) keeps the correlation IDs and risk scores of processes that
+    /// were already running, and has their modules and executable
+    /// allocations back when its first session starts, instead of
+    /// relearning them event by event. See exeray/checkpoint.hpp.
+    std::wstring checkpoint_file{};
+
+    /// @brief How often checkpoint_file is rewritten while monitoring
+    /// (0 = only when monitoring stops).
+    std::uint32_t checkpoint_interval_ms = 30000;
+
+    /// @brief Oldest checkpoint restored; PIDs freed since may have been
+    /// reused by other processes.
+    std::uint32_t checkpoint_max_age_s = 600;
+
+    /// @brief Per-executable behavior profiles: what each image usually
+    /// does, learned across runs, and events it has never done flagged.
+    etw::ProfileConfig profiles{};
+
+    /// @brief File the profiles are loaded from at construction and saved to
+    /// when monitoring stops (empty = learn in memory only). Files of other
+    /// hosts can be folded in with Engine::merge_profiles().
+    std::wstring profile_file{};
+
+    /// @brief SHA-256 and Authenticode verdicts of loaded images, computed
+    /// on pool workers and attached as ImageVerdict extension records.
+    etw::ImageVerifyConfig images{};
+
+    /// @brief File the image verdict cache is loaded from at construction
+    /// and saved to when monitoring stops (empty = cache in memory only).
+    std::wstring image_cache_file{};
+
+    /// @brief Signatures matched against AMSI and script-block content on
+    /// pool workers; verdicts are attached as ContentVerdict extension
+    /// records and matching events marked Suspicious.
+    etw::ContentScanConfig content_scan{};
+
+    /// @brief Read the RWX region a thread of a monitored process starts
+    /// in, on pool workers under a global bytes-per-second budget; the
+    /// bytes are kept once per SHA-256 in a size-capped store and the
+    /// thread events get a MemoryCapture extension record. Live sessions
+    /// only: replayed and synthetic processes cannot be read.
+    etw::MemoryCaptureConfig memory_capture{};
+
+    /// @brief Capture the call stacks of the events each provider names in
+    /// ProviderConfig::stack_event_ids (or its preset), stored deduplicated
+    /// as Stack extension records. Stack walks are costly for ETW, so only
+    /// a few event IDs should ask for them.
+    bool capture_stacks = false;
+
+    /// @brief Job limits of every launched target, applied before it is
+    /// resumed, so a sample cannot starve the ETW consumer of CPU or disk.
+    /// Attached targets have no job and are not limited.
+    process::ResourceLimits target_limits{};
+
     /// @brief Create configuration with default provider settings.
     ///
     /// Default enables core providers (Process, File, Registry, Network, Image,
@@ -57,13 +550,103 @@ struct EngineConfig {
     /// @return Configured EngineConfig with default providers.
     [[nodiscard]] static EngineConfig with_defaults(std::size_t arena_size,
                                                      std::size_t num_threads);
+
+    /// @brief Configuration for Engine::monitor_system(): every process on
+    /// the host rather than a few targets.
+    ///
+    /// Starts from with_defaults() and turns on what whole-host volume
+    /// needs together: four ETW sessions (process/image, file/registry,
+    /// network, scripting), the record ring with 1 MB ETW buffers, file
+    /// and flow coalescing, load shedding, and ring retention with half
+    /// the arena for events and a quarter for a dedicated string arena.
+    /// Give it num_threads of at least five, one drain per session plus
+    /// one worker; bench/system_wide_bench.cpp measures the sustained rate.
+    ///
+    /// @param arena_size Size of the event arena in bytes.
+    /// @param num_threads Number of worker threads.
+    [[nodiscard]] static EngineConfig system_wide(std::size_t arena_size,
+                                                   std::size_t num_threads);
+};
+
+/// @brief Runtime facts about how the engine obtained its resources.
+struct EngineDiagnostics {
+    ArenaBackend arena_backend = ArenaBackend::Heap;  ///< Arena backend in use
+    int arena_numa_node = -1;         ///< NUMA node applied (-1 = none)
+    std::size_t arena_capacity = 0;   ///< Allocatable bytes (ceiling if growable)
+    std::size_t arena_committed = 0;  ///< Bytes backed by memory
+    std::size_t arena_used = 0;       ///< Bytes handed out
+    etw::SessionBuffers etw_buffers{};  ///< ETW buffers of the last session (0 = none yet)
+    std::size_t etw_sessions = 0;       ///< ETW sessions of the last monitoring run
+};
+
+/// @brief Counters of the record rings used by the last monitoring session
+/// (summed over its ETW sessions).
+struct IngestStats {
+    std::size_t ring_bytes = 0;   ///< Ring capacity (0 = records parsed inline)
+    std::uint64_t staged = 0;     ///< Records copied into the ring
+    std::uint64_t overflows = 0;  ///< Records dropped because the ring was full
+};
+
+/// @brief Phases of the last Engine::stop_monitoring().
+struct StopReport {
+    std::chrono::nanoseconds flush{0};   ///< Flushing the ETW sessions
+    std::chrono::nanoseconds drain{0};   ///< Consumers reading the flushed buffers
+    std::chrono::nanoseconds stop{0};    ///< Stopping the sessions, joining their threads
+    std::chrono::nanoseconds finish{0};  ///< Record rings, merger and async workers
+    std::chrono::nanoseconds total{0};
+    bool drained = false;   ///< Every buffer written was read before the deadline
+    bool detached = false;  ///< Stopped without draining (deadline 0)
+    bool standby = false;   ///< Sessions left running (EngineConfig::standby_session)
+};
+
+/// @brief How Engine::replay() consumes a trace file.
+struct ReplayOptions {
+    /// Pacing relative to the capture (0 = as fast as possible, 1 = as
+    /// recorded, 2 = twice as fast).
+    double speed = 0.0;
+
+    /// Keep only events of this process (0 = all), and of its descendants
+    /// with EngineConfig::follow_children.
+    std::uint32_t pid = 0;
+};
+
+/// @brief Outcome of one Engine::replay() run.
+struct ReplayStats {
+    std::uint64_t buffers = 0;       ///< ETW buffers read from the file
+    std::size_t events = 0;          ///< Events added to the graph
+    std::chrono::nanoseconds elapsed{0};  ///< Wall time of the run
+};
+
+/// @brief Memory usage of every engine arena and what occupies it.
+///
+/// Cheap enough to poll once per UI frame. Headroom is capacity - used of
+/// the events arena; push() starts dropping events when it cannot fit
+/// another segment, or when event_count reaches event_capacity in append
+/// mode.
+struct MemoryStats {
+    ArenaStats events;             ///< Event arena
+    ArenaStats strings;            ///< String arena (same as events when shared)
+    ArenaStats scratch;            ///< Per-session scratch arena
+    bool strings_shared = true;    ///< Strings are stored in the event arena
+    std::size_t event_bytes = 0;   ///< Graph nodes, links, indexes and columns
+    std::size_t string_bytes = 0;  ///< Interned string bytes incl. length prefixes
+    std::size_t string_count = 0;  ///< Unique interned strings
+    std::size_t event_count = 0;   ///< Live events
+    std::size_t event_capacity = 0;  ///< Event budget of the graph
+    std::size_t unlinked_events = 0;  ///< Chain links dropped on a full head table
+    event::CompressionStats compression;  ///< Cold segments held compressed
+    ArenaStats spill;                     ///< Spill arena (EngineConfig::spill_arena)
+    std::size_t spilled_segments = 0;     ///< Graph segments moved to it
+    event::RetainedStats retained;        ///< Long-term store (EngineConfig::retained)
 };
 
 /// @brief Core engine integrating ETW tracing and process control.
 ///
 /// Thread-safety model:
-/// - EventGraph access is thread-safe (atomic push, shared mutex for iteration)
-/// - target_pid_ and monitoring_ are atomic for cross-thread access
+/// - EventGraph access is thread-safe (lock-free push and iteration; long
+///   analyses should iterate an event::GraphSnapshot)
+/// - target_pid_ and monitoring_ are atomic for cross-thread access; the
+///   target PID set is lock-free, the launched targets are under a mutex
 /// - ETW thread joins gracefully on stop_monitoring()
 class Engine {
 public:
@@ -84,38 +667,219 @@ public:
     ///
     /// Launches the executable in suspended mode, creates an ETW session,
     /// enables kernel providers, starts the ETW consumer thread, then resumes
-    /// the target process.
+    /// the target process. With sessions standing by (see
+    /// EngineConfig::standby_session) only the PID is added to their
+    /// target set before the target is resumed.
     ///
     /// @param exe_path Path to the executable to launch and monitor.
     /// @return true if monitoring started successfully, false on failure.
     bool start_monitoring(std::wstring_view exe_path);
 
-    /// @brief Stop monitoring and terminate the target process.
+    /// @brief Start monitoring a process that is already running.
+    ///
+    /// Nothing is launched or suspended: the sessions start on pid (and,
+    /// with with_tree, on the descendants it has now), then Kernel-Process
+    /// is asked for a rundown so each target gets a process node for its
+    /// events to correlate to. stop_monitoring() leaves attached targets
+    /// running.
+    ///
+    /// @return false if already monitoring, the process cannot be opened,
+    ///         or the session could not start.
+    bool attach(std::uint32_t pid, bool with_tree = true);
+
+    /// @brief Start monitoring every process on the host.
+    ///
+    /// Nothing is launched and no PID filter is applied, in the sessions or
+    /// in the callback. Meant for EngineConfig::system_wide(); with a
+    /// target-sized configuration the graph fills in seconds.
+    ///
+    /// @return false if already monitoring or a session could not start.
+    bool monitor_system();
+
+    /// @brief Start the sessions of EngineConfig::standby_session before any target.
+    ///
+    /// Schemas are prewarmed, providers enabled and consumers started now,
+    /// so the first start_monitoring() or attach() is as quick as the later
+    /// ones.
     ///
-    /// Stops the ETW session (unblocks ProcessTrace), joins the consumer
-    /// thread, and terminates the target process if still running.
+    /// @return true if sessions stand by; false without standby_session,
+    ///         while monitoring, or if a session could not start.
+    bool prepare_monitoring();
+
+    /// @brief Stop the sessions standing by for the next target (if any).
+    void close_standby();
+
+    /// @brief Whether sessions are running without a target, waiting for one.
+    [[nodiscard]] bool standing_by() const noexcept {
+        return standby_.load(std::memory_order_acquire);
+    }
+
+    /// @brief Launch another target into the running session.
+    ///
+    /// The sessions are shared: the new process is added to the PID filter
+    /// (with its descendants under EngineConfig::follow_children) and
+    /// resumed. Stopped and terminated with the first target.
+    ///
+    /// @return false if not monitoring or the launch failed.
+    bool add_target(std::wstring_view exe_path);
+
+    /// @brief Stop monitoring and terminate the launched target processes.
+    ///
+    /// Drains the ETW sessions for up to EngineConfig::stop_drain_ms, stops
+    /// them (unblocks ProcessTrace), joins the consumer threads, and
+    /// terminates the launched targets if still running. With
+    /// EngineConfig::standby_session the sessions are drained but left
+    /// running for the next target instead.
     void stop_monitoring();
 
+    /**
+     * @brief stop_monitoring() with its own drain deadline.
+     *
+     * Each session is flushed, then given until drain passes for its
+     * consumer to read every buffer the session wrote; stopping a session
+     * with its consumer still open delivers the rest. A zero deadline
+     * detaches at once: the consumers are closed first and whatever ETW
+     * still buffers is dropped. Records already staged are kept either way.
+     */
+    void stop_monitoring(std::chrono::milliseconds drain);
+
+    /// @brief Timings of the last stop_monitoring() (all zero before one).
+    [[nodiscard]] StopReport last_stop() const;
+
     /// @brief Check if currently monitoring a process.
     [[nodiscard]] bool is_monitoring() const noexcept;
 
+    /// @brief Feed a recorded trace (.etl) through the ETW pipeline.
+    ///
+    /// Blocks until the whole file is consumed. Records go through the
+    /// same callbacks, parsers, correlator and graph as a live session, but
+    /// are parsed on the calling thread (no record ring, no load shedding)
+    /// so that a run is reproducible. Timestamps are anchored so the first
+    /// record of the file lands at the time of the call.
+    ///
+    /// @param path Path of the trace file.
+    /// @param options Pacing and PID filter.
+    /// @return Counters of the run, or nullopt if the file could not be
+    ///         opened or monitoring is active.
+    [[nodiscard]] std::optional<ReplayStats> replay(std::wstring_view path,
+                                                    const ReplayOptions& options = {});
+
+    /**
+     * @brief Feed generated events through the pipeline (any platform).
+     *
+     * Events from an etw::SyntheticSource take the path of a live
+     * session's records after the parser: flows, interning, detection
+     * (inline or on the detection stage), I/O coalescing, batched
+     * correlation and the graph, on the calling thread. Blocks until
+     * count events were delivered; with a rate that takes count / rate
+     * seconds. Ages are sampled into ingest_latency() when
+     * EngineConfig::ingest_latency is set.
+     *
+     * @param config Shape and rate of the stream.
+     * @param count Events to generate.
+     * @return Counters of the run (buffers = batches delivered), or nullopt
+     *         if monitoring is active.
+     */
+    [[nodiscard]] std::optional<ReplayStats> run_synthetic(const etw::SyntheticConfig& config,
+                                                           std::uint64_t count);
+
+    /// @brief Discard all events and strings and recycle arena memory.
+    ///
+    /// Rebuilds the string pool, event graph and correlator in place (the
+    /// objects keep their addresses) and rewinds every arena. EventIds,
+    /// EventViews, StringIds and snapshots of the previous session become
+    /// invalid, so readers must not hold any across the call.
+    ///
+    /// Sessions standing by are closed first.
+    ///
+    /// @return false if monitoring is active (nothing is reset).
+    bool reset_session();
+
+    /// @brief Number of sessions recycled by reset_session() so far.
+    [[nodiscard]] std::uint64_t session() const noexcept {
+        return session_.load(std::memory_order_acquire);
+    }
+
+    // -------------------------------------------------------------------------
+    // Asynchronous Control
+    // -------------------------------------------------------------------------
+
+    /// @brief Awaitable resuming once events newer than a generation exist.
+    ///
+    /// The generation is an EventId, as returned by EventGraph::newest_id()
+    /// or a previous await. The awaiting coroutine resumes on a pool worker
+    /// with the newest ID, or at once (with the same ID if nothing is new)
+    /// when no session or replay is feeding the graph, so consumers can
+    /// sleep instead of polling the event count.
+    class EventsAfter {
+    public:
+        EventsAfter(Engine& engine, event::EventId seen) noexcept
+            : engine_(engine), seen_(seen) {}
+
+        [[nodiscard]] bool await_ready() const noexcept;
+        void await_suspend(std::coroutine_handle<> awaiting);
+        [[nodiscard]] event::EventId await_resume() const noexcept;
+
+    private:
+        Engine& engine_;
+        event::EventId seen_;
+    };
+
+    /// @brief start_monitoring() on a pool worker.
+    AsyncTask<bool> start_monitoring_async(std::wstring exe_path);
+
+    /// @brief stop_monitoring() on a pool worker: the record rings drain and
+    /// the ETW threads join without blocking the caller.
+    AsyncTask<void> drain_async();
+
+    /// @brief replay() on a pool worker.
+    AsyncTask<std::optional<ReplayStats>> replay_async(std::wstring path,
+                                                       ReplayOptions options = {});
+
+    /// @brief `co_await engine.events_after(seen)`: wait for events newer than seen.
+    [[nodiscard]] EventsAfter events_after(event::EventId seen) noexcept {
+        return EventsAfter(*this, seen);
+    }
+
+    /**
+     * @brief Block the calling thread until events newer than seen exist.
+     *
+     * events_after() for threads that are not coroutines, such as a UI
+     * loop: returns at once if there are, otherwise when one is published,
+     * a session stops, or timeout passes. Waiters share one graph watcher,
+     * so waiting again every frame adds nothing while no event comes.
+     *
+     * @return Newest EventId; not above seen if nothing arrived in time.
+     */
+    event::EventId wait_for_events(event::EventId seen, std::chrono::milliseconds timeout);
+
     // -------------------------------------------------------------------------
     // Process Control (forwarded to Controller)
     // -------------------------------------------------------------------------
 
-    /// @brief Freeze (suspend) the target process.
+    /// @brief Freeze (suspend) every target process.
     void freeze_target();
 
-    /// @brief Unfreeze (resume) the target process.
+    /// @brief Unfreeze (resume) every target process.
     void unfreeze_target();
 
-    /// @brief Terminate the target process.
+    /// @brief Terminate every target process.
     void kill_target();
 
-    /// @brief Get the target process ID.
+    /// @brief CPU time, I/O and peak memory of the launched targets' jobs.
+    ///
+    /// Summed over the targets (peaks are the highest); queried from the
+    /// jobs on each call, cheap enough to poll. All zero if none.
+    [[nodiscard]] process::JobAccounting target_usage() const;
+
+    /// @brief Get the first target's process ID.
     /// @return PID of the target, or 0 if not monitoring.
     [[nodiscard]] uint32_t target_pid() const noexcept;
 
+    /// @brief Processes whose events are kept: the targets and the
+    /// descendants followed so far, sorted. Empty if not filtering.
+    [[nodiscard]] std::vector<uint32_t> target_pids() const;
+
     // -------------------------------------------------------------------------
     // Legacy Task API (for compatibility)
     // -------------------------------------------------------------------------
@@ -138,14 +902,263 @@ public:
     /// @brief Get const reference to the event graph.
     [[nodiscard]] const event::EventGraph& graph() const { return graph_; }
 
+    /// @brief Get the string pool that resolves payload StringIds.
+    event::StringPool& strings() { return strings_; }
+
+    /// @brief Get const reference to the string pool.
+    [[nodiscard]] const event::StringPool& strings() const { return strings_; }
+
+    /// @brief Release the strings nothing refers to any more.
+    ///
+    /// Marks the strings of retained events, loaded modules and open file
+    /// and key objects, then compacts the pool (a no-op with arena storage).
+    /// Interns wait while it runs.
+    event::StringPool::CompactStats compact_strings();
+
+    /// @brief Trigram index of strings(), or nullptr without
+    /// EngineConfig::string_search. Rebuilt with the pool each session.
+    [[nodiscard]] const event::TrigramIndex* string_search() const noexcept {
+        return trigrams_.get();
+    }
+
+    /// @brief Extension records referenced by EventPayload::extension.
+    [[nodiscard]] const event::ExtensionStore& extensions() const { return extensions_; }
+
+    /// @brief Mapping of graph() timestamps to Unix-epoch time, anchored
+    /// when the current session started (invalid before the first one).
+    /// Replayed trace files map to the time they were recorded.
+    [[nodiscard]] event::WallClock wall_clock() const noexcept { return wall_clock_; }
+
+    /// @brief Events turning Suspicious, queued apart from the bulk stream
+    /// (see EngineConfig::alert_capacity). Outlives reset_session(), so a
+    /// consumer may keep waiting on it across sessions.
+    event::AlertQueue& alerts() noexcept { return alerts_; }
+
+    /// @brief Evicted events kept for their detections, and counts of the
+    /// rest (see EngineConfig::retained). Emptied by reset_session().
+    [[nodiscard]] const event::RetainedEvents& retained() const noexcept { return retained_; }
+
+    /// @brief Volume map applied to interned device paths.
+    event::DevicePathMap& device_paths() noexcept { return device_paths_; }
+
+    /// @brief Report how the engine's memory is backed.
+    [[nodiscard]] EngineDiagnostics diagnostics() const;
+
+    /// @brief Report per-arena usage and what the memory belongs to.
+    [[nodiscard]] MemoryStats memory_stats() const;
+
+    /// @brief Report ETW loss and buffer counters of the current or last session.
+    ///
+    /// Sampled every EngineConfig::stats_interval_ms and once more when
+    /// monitoring stops; buffers_read is live. Summed over all sessions.
+    [[nodiscard]] etw::SessionStats session_stats() const;
+
+    /// @brief Report record ring counters of the current or last session.
+    ///
+    /// Call from the thread that starts and stops monitoring.
+    [[nodiscard]] IngestStats ingest_stats() const;
+
+    /// @brief Events dropped by load shedding in the current or last session.
+    [[nodiscard]] etw::ShedStats shed_stats() const noexcept;
+
+    /// @brief Events kept and dropped by sampling in the current or last session.
+    [[nodiscard]] etw::SamplingStats sampling_stats() const noexcept;
+
+    /// @brief Parameters in effect, as last set by the auto-tuner.
+    [[nodiscard]] TuningState tuning() const;
+
+    /// @brief Open network flows of pid (0 = every process) in the current or
+    /// last session; empty when flows.enabled is false.
+    [[nodiscard]] std::vector<etw::FlowRecord> network_flows(std::uint32_t pid = 0) const;
+
+    /// @brief Transfers folded into flows in the current or last session.
+    [[nodiscard]] etw::FlowStats flow_stats() const noexcept;
+
+    /// @brief Most recent rate spikes of the current or last session,
+    /// oldest first; empty when rates.enabled is false.
+    [[nodiscard]] std::vector<etw::RateAnomaly> rate_anomalies() const;
+
+    /// @brief Events counted and spikes found by rate detection.
+    [[nodiscard]] etw::RateStats rate_stats() const;
+
+    /// @brief Resolutions recorded and network events given a domain in the
+    /// current or last session.
+    [[nodiscard]] etw::DomainMapStats domain_stats() const;
+
+    /// @brief CLR modules of pid (0 = every process) with JIT activity in the
+    /// current or last session; empty when jit.enabled is false.
+    [[nodiscard]] std::vector<etw::JitModuleRecord> jit_modules(std::uint32_t pid = 0) const;
+
+    /// @brief JIT events folded into modules and stored as summaries.
+    [[nodiscard]] etw::JitStats jit_stats() const noexcept;
+
+    /// @brief Logon sessions open at the end of the current or last session;
+    /// empty when logons.enabled is false.
+    [[nodiscard]] std::vector<etw::LogonSession> logon_sessions() const;
+
+    /// @brief Sessions opened and closed and Security events attributed.
+    [[nodiscard]] etw::LogonStats logon_stats() const;
+
+    /// @brief WMI operations of pid (0 = every process) in the current or
+    /// last session; empty when wmi.enabled is false.
+    [[nodiscard]] std::vector<etw::WmiOperationRecord> wmi_operations(std::uint32_t pid = 0) const;
+
+    /// @brief WMI events folded into operations and stored as summaries.
+    [[nodiscard]] etw::WmiStats wmi_stats() const noexcept;
+
+    /// @brief Write the loaded and learned behavior profiles to
+    /// EngineConfig::profile_file. Call while not monitoring.
+    bool save_profiles();
+
+    /// @brief Fold the profiles of another host's file into the learned ones,
+    /// saved with them by save_profiles(). Call while not monitoring.
+    bool merge_profiles(const std::wstring& path) { return profiles_.merge(path); }
+
+    /// @brief Behavior profiles of the engine.
+    [[nodiscard]] const etw::BehaviorProfiles& behavior_profiles() const noexcept {
+        return profiles_;
+    }
+
+    /// @brief Events checked and found novel by the behavior profiles.
+    [[nodiscard]] etw::ProfileStats profile_stats() const;
+
+    /// @brief Write the image verdict cache to EngineConfig::image_cache_file.
+    bool save_image_cache();
+
+    /// @brief Images hashed, cached and attached by image verification.
+    [[nodiscard]] etw::ImageVerifyStats image_verify_stats() const noexcept {
+        return images_.stats();
+    }
+
+    /// @brief Contents scanned, matched and skipped by content scanning.
+    [[nodiscard]] etw::ContentScanStats content_scan_stats() const noexcept {
+        return scanner_.stats();
+    }
+
+    /// @brief Regions read, throttled and stored by memory capture.
+    [[nodiscard]] etw::MemoryCaptureStats memory_capture_stats() const noexcept {
+        return captures_.stats();
+    }
+
+    /// @brief Captures in the memory capture store, without their bytes, oldest first.
+    [[nodiscard]] std::vector<etw::MemoryCaptureRecord> memory_captures() const {
+        return captures_.captures();
+    }
+
+    /// @brief Captured bytes with this SHA-256, if still in the store.
+    [[nodiscard]] std::optional<etw::MemoryCaptureRecord> memory_capture(
+        const std::array<std::uint8_t, 32>& sha256) const {
+        return captures_.capture(sha256);
+    }
+
+    /// @brief Stacks attached, stored and orphaned this session.
+    [[nodiscard]] event::StackTableStats stack_stats() const noexcept { return stacks_.stats(); }
+
+    /// @brief Return addresses of a Stack extension record (empty if it is none).
+    [[nodiscard]] std::vector<std::uint64_t> stack_frames(event::ExtensionId stack) const {
+        return stacks_.frames(stack);
+    }
+
+    /**
+     * @brief Resolve a stack to modules and exports (reads image files).
+     * @param stack EventPayload::extension of an event with a stack.
+     * @param pid Process the event was captured in.
+     */
+    [[nodiscard]] std::vector<etw::StackFrame> symbolize_stack(event::ExtensionId stack,
+                                                               std::uint32_t pid);
+
+    /// @brief symbolize_stack() on a pool worker.
+    AsyncTask<std::vector<etw::StackFrame>> symbolize_stack_async(event::ExtensionId stack,
+                                                                  std::uint32_t pid);
+
+    /// @brief Matches and firings per detection rule in the current or last session.
+    [[nodiscard]] std::vector<etw::RuleStats> detection_stats() const;
+
+    /// @brief Loaded indicators and hits per IOC list in the current or last session.
+    [[nodiscard]] std::vector<etw::IocStats> ioc_stats() const;
+
+    /// @brief Events tested and waiting off the ingest path in the current or
+    /// last session (all zero with inline detection).
+    [[nodiscard]] etw::DetectionStageStats detection_stage_stats() const;
+
+    /// @brief Modules loaded in pid as seen by the Image parser, sorted by base.
+    ///
+    /// Paths resolve through strings(). Covers the current or last session;
+    /// empty for a process that has exited or whose loads were never seen.
+    [[nodiscard]] std::vector<etw::ModuleInfo> modules(std::uint32_t pid) const;
+
+    /// @brief Module of pid containing address, nullopt if it is not image-backed.
+    [[nodiscard]] std::optional<etw::ModuleInfo> module_at(std::uint32_t pid,
+                                                           std::uint64_t address) const;
+
+    /// @brief Parse counts, failures and cost per provider and event ID.
+    ///
+    /// Covers the current or last session (live or replayed). The counters
+    /// are process-wide, so engines monitoring at the same time share them.
+    [[nodiscard]] etw::ParseMetricsSnapshot parse_metrics() const;
+
+    /**
+     * @brief Write the recent hot-path spans as a Chrome trace (see trace_spans.hpp).
+     *
+     * Holds up to SpanTrace::kRingRecords spans of every thread since
+     * the current or last session started; empty unless built with
+     * EXERAY_ENABLE_SPANS. Open the file in Perfetto or chrome://tracing.
+     *
+     * @return false if the file cannot be written.
+     */
+    bool dump_spans(std::wstring_view path) const;
+
+    /**
+     * @brief Write the stage samples of the current or last session as
+     * folded stacks ("consumer;correlate 412" per line).
+     *
+     * Empty unless sampling ran (EngineConfig::profile_interval_us or
+     * set_profiling()). Feed the file to flamegraph.pl, inferno-flamegraph
+     * or speedscope.
+     *
+     * @return false if the file cannot be written.
+     */
+    bool dump_profile(std::wstring_view path) const;
+
+    /// @brief Start, restart or (with 0) stop stage sampling at runtime.
+    /// @param interval_us Sampling interval in microseconds; samples are kept.
+    /// @return Whether sampling runs afterwards.
+    bool set_profiling(std::uint32_t interval_us);
+
+    /// @brief Stage sampler of this engine (see EngineConfig::profile_interval_us).
+    [[nodiscard]] const SamplingProfiler& profiler() const noexcept { return profiler_; }
+
+    /// @brief Counters, gauges and histograms of this engine (see metrics.hpp).
+    ///
+    /// Publishes the graph, ETW session, record ring, shedding, flow,
+    /// arena, parse, detection and ingest latency stats above, plus the
+    /// consumer's batch counters. Embedders may register their own.
+    MetricsRegistry& metrics() noexcept { return metrics_; }
+
+    /// @brief Const overload of metrics().
+    [[nodiscard]] const MetricsRegistry& metrics() const noexcept { return metrics_; }
+
+    /**
+     * @brief Age percentiles of the current or last live session.
+     * @param stage Delivered (at the ETW callback) or Visible (in the graph).
+     * @param category Event category, or Category::Count for all.
+     */
+    [[nodiscard]] etw::LatencySummary ingest_latency(
+        etw::LatencyStage stage,
+        event::Category category = event::Category::Count) const noexcept;
+
+    /// @brief Arena for per-session analysis data (recycled by reset_session()).
+    Arena& scratch_arena() noexcept { return scratch_arena_; }
+
     // -------------------------------------------------------------------------
     // Event Correlation API
     // -------------------------------------------------------------------------
 
     /// @brief Get process tree (ancestors) for a PID.
     ///
-    /// Walks up the parent chain from the most recent ProcessCreate event
-    /// for the given PID, collecting all ancestor process events.
+    /// Reads the ancestors of the most recent ProcessCreate event for the
+    /// given PID from process_tree(), stopping at the first event the graph
+    /// no longer holds.
     ///
     /// @param pid Process ID to start from.
     /// @return Vector of EventViews representing the process ancestry.
@@ -160,22 +1173,69 @@ public:
     /// @return Vector of EventViews matching the correlation ID.
     [[nodiscard]] std::vector<event::EventView> get_event_chain(uint32_t correlation_id);
 
+    /// @brief Every process incarnation of the session, with children,
+    /// descendants, subtree event counts and common ancestors.
+    ///
+    /// Nodes are keyed by ProcessCreate event; see get_process_tree() for
+    /// the event views of one ancestry.
+    [[nodiscard]] const event::ProcessTree& process_tree() const noexcept {
+        return correlator_.process_tree();
+    }
+
+    /// @brief Processes with the highest decaying risk scores.
+    ///
+    /// Every Suspicious event adds to the score of its process; scores halve
+    /// every event::RiskTable::kDefaultHalfLife and are decayed to the newest
+    /// scored event. Covers the current session since the last reset.
+    ///
+    /// @param k Most entries to return.
+    /// @return Scores keyed by PID, riskiest first.
+    [[nodiscard]] std::vector<event::RiskScore> riskiest_processes(std::size_t k) const;
+
+    /// @brief Correlation chains with the highest risk scores, as riskiest_processes().
+    /// @return Scores keyed by correlation ID (see get_event_chain()).
+    [[nodiscard]] std::vector<event::RiskScore> riskiest_chains(std::size_t k) const;
+
+    // -------------------------------------------------------------------------
+    // Checkpoints
+    // -------------------------------------------------------------------------
+
+    /// @brief Write EngineConfig::checkpoint_file now.
+    ///
+    /// Before the first session the trackers still hold nothing, so the
+    /// restored ones not yet applied are written back instead. Call from
+    /// the thread that starts and stops monitoring.
+    ///
+    /// @return false if no file is configured or it could not be written.
+    bool save_checkpoint() const;
+
+    /// @brief Whether construction restored EngineConfig::checkpoint_file.
+    [[nodiscard]] bool restored_checkpoint() const noexcept { return restored_; }
+
     // -------------------------------------------------------------------------
     // Provider Configuration API
     // -------------------------------------------------------------------------
 
     /// @brief Enable a provider by name.
     ///
-    /// The change takes effect on the next start_monitoring() call.
-    /// Unknown provider names are ignored with a warning.
+    /// While monitoring, the provider is enabled on the running session of
+    /// its ProviderConfig::session group (the first session if that group
+    /// is not running), and Process and File ask for a rundown so state
+    /// from before is known; the graph and correlation state are kept.
+    /// Otherwise the change takes effect on the next start_monitoring().
+    /// Unknown provider names are ignored with a warning. Call from the
+    /// thread that starts and stops monitoring.
     ///
     /// @param name Provider name (e.g., "Process", "File", "DNS").
     void enable_provider(std::string_view name);
 
     /// @brief Disable a provider by name.
     ///
-    /// The change takes effect on the next start_monitoring() call.
-    /// Unknown provider names are ignored with a warning.
+    /// While monitoring, the provider is disabled on its session at once;
+    /// its records still buffered by ETW are dropped before parsing, so
+    /// detection sees none after this returns. Unknown provider names are
+    /// ignored with a warning. Call from the thread that starts and stops
+    /// monitoring.
     ///
     /// @param name Provider name (e.g., "Process", "File", "DNS").
     void disable_provider(std::string_view name);
@@ -186,18 +1246,148 @@ public:
     /// @return true if the provider exists and is enabled, false otherwise.
     [[nodiscard]] bool is_provider_enabled(std::string_view name) const;
 
+    /// @brief Register a provider to decode from its manifest.
+    ///
+    /// Its records are decoded through the TDH schema cache into
+    /// Category::Manifest events carrying the projected properties, and
+    /// its name works with the calls above. Unless EngineConfig::providers
+    /// already names it, it is added there enabled at level 4 with every
+    /// keyword; the change takes effect on the next start_monitoring().
+    /// Refused while monitoring or standing by, and for registrations
+    /// ManifestProviders::add() rejects (logged as a warning).
+    ///
+    /// @return true if registered.
+    bool register_provider(const etw::ManifestProviderConfig& provider);
+
+    /// @brief Providers registered with register_provider() or
+    /// EngineConfig::manifest_providers; ManifestPayload::provider indexes them.
+    [[nodiscard]] const etw::ManifestProviders& manifest_providers() const noexcept {
+        return manifests_;
+    }
+
 private:
     /// @brief Legacy background processing task.
     void process();
 
+    /// @brief One ETW session with its consumer thread and parse state.
+    struct EtwShard {
+        std::unique_ptr<etw::Session> session;
+        etw::StatsPoller stats;  ///< Samples session; declared after it
+        std::thread thread;
+        etw::ConsumerContext ctx;
+        std::unique_ptr<etw::RecordRing> ring;  ///< Kept until the next session
+        std::atomic<bool> draining{false};      ///< The drain task is running
+        std::vector<std::string> providers;     ///< Enabled on session
+    };
+
+    /// @brief GUID of a built-in or registered provider name.
+    [[nodiscard]] std::optional<GUID> provider_guid(std::string_view name) const;
+
+    /// @brief Enabled provider names grouped by ProviderConfig::session.
+    [[nodiscard]] std::vector<std::vector<std::string>> provider_groups() const;
+
+    /// @brief Buffer settings for a session carrying the given providers.
+    [[nodiscard]] etw::SessionBuffers session_buffers(
+        const std::vector<std::string>& providers) const;
+
+    /// @brief Placement of the drain workers (see EngineConfig::ingest_threads).
+    [[nodiscard]] platform::ThreadPlacement ingest_placement() const;
+
+    /// @brief Record target (plus descendants) and start every session;
+    /// without a target the sessions keep every process.
+    /// @return false if a session could not be created (monitoring stopped).
+    bool start_session(std::unique_ptr<process::Controller> target,
+                       const std::vector<std::uint32_t>& descendants);
+
+    /// @brief Hand a target to the sessions standing by: only the target
+    /// set changes, plus a rundown for an attached process.
+    void resume_standby(std::unique_ptr<process::Controller> target,
+                        const std::vector<std::uint32_t>& descendants);
+
+    /// @brief Stop the sessions and join their threads, then drain the
+    /// record rings and stop the async workers (stop and finish phases).
+    void close_sessions(bool detached, StopReport& report);
+
+    /// @brief Ask the shard's Kernel-Process and Kernel-File providers (or
+    /// only the one named) for a rundown of the processes, threads, modules
+    /// and files that exist.
+    void request_rundown(EtwShard& shard, std::string_view only = {});
+
+    /// @brief Create, configure and start one session (ETW thread included).
+    /// @return false if the session could not be created.
+    bool start_shard(EtwShard& shard, std::size_t index,
+                     const std::vector<std::string>& providers);
+
+    /// @brief (Re-)enable the shard's providers, with the ETW-side PID
+    /// filter on the current targets unless children are followed.
+    void enable_providers(EtwShard& shard, std::size_t index);
+
+    /// @brief enable_providers() for one provider; providers_mutex_ held.
+    void enable_on(EtwShard& shard, std::size_t index, const std::string& provider);
+
+    /// @brief Turn a provider on or off on the running sessions.
+    void switch_provider(const std::string& name, bool enabled);
+
+    /// @brief Read and age-check EngineConfig::checkpoint_file (nullptr = none).
+    [[nodiscard]] static std::unique_ptr<Checkpoint> load_checkpoint(
+        const EngineConfig& config);
+
+    /// @brief Put the restored modules and memory regions into the trackers
+    /// once the first session has cleared them.
+    void restore_trackers();
+
+    /// @brief Start rewriting the checkpoint every checkpoint_interval_ms.
+    void start_checkpoints();
+
+    /// @brief Stop the periodic writes and write a final checkpoint.
+    void stop_checkpoints();
+
+    /// @brief Start compact_strings() every string_compaction_ms.
+    void start_string_compaction();
+
+    /// @brief Stop the periodic compactions.
+    void stop_string_compaction();
+
+    /// @brief Start the auto-tuner over the session just set up.
+    void start_auto_tuner();
+
+    /// @brief Stop the auto-tuner and restore the configured parameters.
+    void stop_auto_tuner();
+
+    /// @brief Hand a tuned state to the shards, detection and shedding.
+    void apply_tuning(const TuningState& state);
+
     /// @brief ETW consumer thread function.
     ///
     /// Calls start_trace_processing() which blocks until the session is stopped.
-    void etw_thread_func();
+    void etw_thread_func(EtwShard* shard);
+
+    /// @brief Register the collectors and consumer counters of metrics_.
+    void register_metrics();
+
+    /// @brief Arena backing the string pool (shared or dedicated).
+    [[nodiscard]] Arena& string_storage() noexcept {
+        return config_.string_arena.size > 0 ? string_arena_ : arena_;
+    }
+
+    /// @brief Const overload of string_storage().
+    [[nodiscard]] const Arena& string_storage() const noexcept {
+        return config_.string_arena.size > 0 ? string_arena_ : arena_;
+    }
 
     // Core components
+    std::unique_ptr<Checkpoint> checkpoint_;  ///< Restored; sizes strings_, trackers pending
+    bool restored_ = false;
     Arena arena_;
+    Arena string_arena_;
+    Arena scratch_arena_;
+    Arena spill_arena_;  ///< Cold graph segments (EngineConfig::spill_arena)
+    event::DevicePathMap device_paths_{true};
+    std::unique_ptr<event::TrigramIndex> trigrams_;  ///< Fed by strings_, outlives it
     event::StringPool strings_;
+    event::ExtensionStore extensions_;  ///< In the string arena, beside strings_
+    event::AlertQueue alerts_;          ///< Fed by graph_
+    event::RetainedEvents retained_;   ///< Fed by graph_ as it evicts
     event::EventGraph graph_;
     event::Correlator correlator_;
     ThreadPool pool_;
@@ -208,16 +1398,71 @@ private:
     std::atomic<float> progress_{0.0f};
 
     // ETW monitoring state
-    std::unique_ptr<etw::Session> etw_session_;
-    std::unique_ptr<process::Controller> target_;
-    std::thread etw_thread_;
+    std::vector<std::unique_ptr<process::Controller>> targets_;  ///< Under targets_mutex_
+    mutable std::mutex targets_mutex_;
+    etw::TargetSet target_set_;  ///< Shared by all shards
     std::atomic<bool> monitoring_{false};
+    std::atomic<bool> standby_{false};    ///< Sessions run with no target (standby_session)
+    std::atomic<bool> ingesting_{false};  ///< A session or replay feeds the graph
+    std::mutex wake_mutex_;               ///< Guards wake_armed_ for wait_for_events()
+    std::condition_variable wake_cv_;
+    bool wake_armed_ = false;  ///< A graph watcher will notify wake_cv_
     std::atomic<uint32_t> target_pid_{0};
-    etw::ConsumerContext consumer_ctx_;
+    std::atomic<std::uint64_t> session_{0};
+    std::vector<std::unique_ptr<EtwShard>> shards_;  ///< Kept until the next start
+    std::unique_ptr<etw::ShardMerger> merger_;       ///< Only with several shards
+    etw::DomainMap domains_;                         ///< Shared by all shards
+    etw::FlowTable flows_;                           ///< Shared by all shards
+    etw::JitAggregator jit_;                         ///< Shared by all shards
+    etw::LogonSessions logons_;                      ///< Shared by all shards
+    etw::WmiAggregator wmi_;                         ///< Shared by all shards
+    etw::RateMonitor rates_;                         ///< Shared by all shards
+    etw::BehaviorProfiles profiles_;                 ///< Shared by all shards
+    etw::ShedPolicy shed_;                           ///< Shared by all shards
+    etw::Sampler sampler_;                           ///< Shared by all shards
+    etw::RuleEngine rules_;                          ///< Shared by all shards
+    etw::IocMatcher iocs_;                           ///< Shared by all shards
+    std::unique_ptr<etw::IngestLatency> latency_;    ///< Shared by all shards
+    etw::DetectionStage detection_;                  ///< Fed by all shards
+    etw::ImageVerifier images_;                      ///< Fed by all shards
+    etw::ContentScanner scanner_;                    ///< Fed by all shards
+    etw::MemoryCapture captures_;                    ///< Fed by all shards
+    event::StackTable stacks_;                       ///< Over extensions_
+    etw::StackSymbolizer symbolizer_;                ///< Export tables by module path
+    etw::SessionBuffers etw_buffers_{};  ///< As applied by ETW to the first session
+    event::WallClock wall_clock_{};      ///< Clock anchor of the current session
+    StopReport last_stop_{};             ///< Guarded by stop_mutex_
+    mutable std::mutex stop_mutex_;
+
+    // Metrics (collectors read the members above)
+    MetricsRegistry metrics_;
+    etw::ConsumerMetrics consumer_metrics_{};  ///< Copied into every ConsumerContext
+    SamplingProfiler profiler_;
+
+    // Checkpoint writer (see EngineConfig::checkpoint_file)
+    std::thread checkpoint_thread_;
+    std::mutex checkpoint_mutex_;
+    std::condition_variable checkpoint_cv_;
+    bool checkpoint_stop_ = false;  ///< Under checkpoint_mutex_
+
+    // String compaction (see EngineConfig::string_storage)
+    std::thread compaction_thread_;
+    std::mutex compaction_mutex_;
+    std::condition_variable compaction_cv_;
+    bool compaction_stop_ = false;  ///< Under compaction_mutex_
+
+    // Auto-tuner (see EngineConfig::auto_tune)
+    std::thread tuner_thread_;
+    std::mutex tuner_mutex_;
+    std::condition_variable tuner_cv_;
+    bool tuner_stop_ = false;  ///< Under tuner_mutex_
+    TuningState tuning_{};     ///< Under tuning_mutex_
+    mutable std::mutex tuning_mutex_;
 
     // Provider configuration
     EngineConfig config_;
     mutable std::mutex providers_mutex_;
+    etw::ManifestProviders manifests_;  ///< Changed only while no session runs
 };
 
 }  // namespace exeray
@@ -0,0 +1,184 @@
+#pragma once
+
+/// @file behavior_profiles.hpp
+/// @brief Per-executable behavior baselines learned across runs.
+///
+/// Most hosts run the same binaries every day, and what they do rarely
+/// changes: the same operations, the same directories, ports and modules.
+/// BehaviorProfiles learns, per executable path, a compact profile of that
+/// behavior and, once a profile from earlier runs is loaded, flags the
+/// events of a process that its profile has never seen.
+///
+/// A profile is a fixed-size record: one bit per (category, operation) and
+/// Bloom filters over the hashed parent directories of files touched, the
+/// remote ports connected to and the modules loaded. Records are keyed by a
+/// hash of the lowercased executable path, not a StringId, so they stay
+/// valid across sessions and hosts. Merging two profiles ORs their bits, so
+/// the files of several hosts combine into one (merge()).
+///
+/// The profile file is a header and the records sorted by key. load() maps
+/// it and binary searches the mapping, once per process; the check of an
+/// event is a few bit tests against the record the process resolved to.
+/// What a session learns goes into a separate in-memory table, written
+/// back together with the loaded profiles by save().
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+#include "exeray/event/payload.hpp"
+#include "exeray/event/types.hpp"
+#include "exeray/platform/mapped_file.hpp"
+
+namespace exeray::event {
+class StringPool;
+}  // namespace exeray::event
+
+namespace exeray::etw {
+
+/// @brief "EXBP" in the first four bytes of a profile file.
+inline constexpr std::uint32_t kProfileMagic = 0x50425845;
+
+/// @brief Bumped whenever the record layout changes.
+inline constexpr std::uint32_t kProfileFormat = 1;
+
+/// @brief Profile settings.
+struct ProfileConfig {
+    bool enabled = false;             ///< Learn and check profiles at all
+    bool learn = true;                ///< Add this session's behavior to the profiles
+    bool flag_novel = true;           ///< Mark behavior new to a mature profile Suspicious
+    std::uint64_t min_events = 1000;  ///< Events a loaded profile needs before it flags
+};
+
+/// @brief Behavior of one executable, as stored in the profile file.
+struct ProfileRecord {
+    static constexpr std::size_t kCategoryCount = static_cast<std::size_t>(event::Category::Count);
+    static constexpr std::size_t kDirectoryBits = 2048;
+    static constexpr std::size_t kPortBits = 512;
+    static constexpr std::size_t kModuleBits = 1024;
+
+    std::uint64_t image = 0;   ///< BehaviorProfiles::image_key() of the executable
+    std::uint64_t events = 0;  ///< Events learned
+    std::array<std::uint64_t, kCategoryCount> operations{};  ///< Bit op & 63 per category
+    std::array<std::uint64_t, kDirectoryBits / 64> directories{};
+    std::array<std::uint64_t, kPortBits / 64> ports{};
+    std::array<std::uint64_t, kModuleBits / 64> modules{};
+
+    /// @brief OR other into this record and add its events.
+    void merge(const ProfileRecord& other) noexcept;
+};
+
+static_assert(std::is_trivially_copyable_v<ProfileRecord>);
+
+/// @brief What the profiles did in the current or last session.
+struct ProfileStats {
+    std::uint64_t loaded = 0;   ///< Profiles mapped by load()
+    std::uint64_t learned = 0;  ///< Executables with behavior learned since
+    std::uint64_t checked = 0;  ///< Events compared against a mature profile
+    std::uint64_t novel = 0;    ///< Events their profile had never seen
+};
+
+/**
+ * @brief Learned and loaded behavior profiles.
+ *
+ * Thread-safety: observe() and stats() from any thread (process and
+ * profile lookups are sharded, each shard with its own mutex; record bits
+ * are set atomically); load(), merge(), save() and forget_processes()
+ * between sessions.
+ */
+class BehaviorProfiles {
+public:
+    static constexpr std::size_t kShards = 16;
+
+    explicit BehaviorProfiles(const ProfileConfig& config = {});
+
+    BehaviorProfiles(const BehaviorProfiles&) = delete;
+    BehaviorProfiles& operator=(const BehaviorProfiles&) = delete;
+
+    /// @brief Key of an executable path: FNV-1a of its ASCII-lowercased text.
+    [[nodiscard]] static std::uint64_t image_key(std::string_view path) noexcept;
+
+    /**
+     * @brief Map a profile file as the baseline events are checked against.
+     * @return false if the file is missing or not a profile file; the
+     *         previous baseline is dropped either way.
+     */
+    bool load(const std::filesystem::path& path);
+
+    /// @brief OR every profile of a file (another host's) into the learned ones.
+    bool merge(const std::filesystem::path& path);
+
+    /// @brief Write the loaded and the learned profiles, merged, to path.
+    bool save(const std::filesystem::path& path);
+
+    /**
+     * @brief Learn one event and check it against its process's profile.
+     *
+     * Process creates and rundowns tell which executable each pid runs;
+     * events of a pid never seen that way are ignored.
+     *
+     * @param pid Process the event belongs to.
+     * @param payload Parsed payload with its strings interned.
+     * @param operation Category-specific operation code.
+     * @param strings Pool the payload's StringIds come from.
+     * @return true if a mature loaded profile has never seen this behavior.
+     */
+    bool observe(std::uint32_t pid, const event::EventPayload& payload, std::uint8_t operation,
+                 const event::StringPool& strings);
+
+    /// @brief Forget which executable each pid runs (start of a session).
+    void forget_processes();
+
+    /// @brief Loaded profile of an executable key (nullptr = none).
+    [[nodiscard]] const ProfileRecord* loaded(std::uint64_t image) const noexcept;
+
+    /// @brief Copy of the behavior learned for an executable key (events 0 = none).
+    [[nodiscard]] ProfileRecord learned(std::uint64_t image) const;
+
+    [[nodiscard]] ProfileStats stats() const;
+
+private:
+    /// @brief The profiles one process feeds and is checked against.
+    struct Process {
+        ProfileRecord* learned = nullptr;
+        const ProfileRecord* loaded = nullptr;
+    };
+
+    struct alignas(64) ProcessShard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::uint32_t, Process> processes;
+    };
+
+    struct alignas(64) ProfileShard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::uint64_t, std::unique_ptr<ProfileRecord>> records;
+    };
+
+    static constexpr std::size_t kHashCache = 4096;
+
+    ProfileRecord* learned_record(std::uint64_t image);
+    void start_process(std::uint32_t pid, event::StringId image, const event::StringPool& strings);
+    std::uint32_t text_hash(event::StringId id, const event::StringPool& strings);
+
+    ProfileConfig config_;
+    platform::MappedFile file_;
+    std::filesystem::path path_;             ///< Of file_
+    std::span<const ProfileRecord> loaded_;  ///< Sorted by image
+    std::array<ProcessShard, kShards> processes_;
+    std::array<ProfileShard, kShards> profiles_;
+    /// Direct-mapped StringId -> text hash: (id << 32) | hash, 0 = empty
+    std::array<std::atomic<std::uint64_t>, kHashCache> hashes_{};
+    std::atomic<std::uint64_t> learned_count_{0};
+    std::atomic<std::uint64_t> checked_{0};
+    std::atomic<std::uint64_t> novel_{0};
+};
+
+}  // namespace exeray::etw
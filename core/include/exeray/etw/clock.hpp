@@ -0,0 +1,119 @@
+#pragma once
+
+/// @file clock.hpp
+/// @brief Conversion of ETW record timestamps into the EventGraph clock.
+///
+/// Real-time sessions log with the QPC clock (Wnode.ClientContext = 1) and
+/// are consumed with PROCESS_TRACE_MODE_RAW_TIMESTAMP, so every
+/// EVENT_HEADER::TimeStamp reaches the callback as raw QPC ticks instead of
+/// being converted to system time by ETW. Trace files are consumed without
+/// that flag and deliver system time in 100-ns FILETIME units. EventGraph
+/// timestamps are steady_clock nanoseconds. ClockDomain pairs the clocks
+/// once, keeps the tick rate (TRACE_LOGFILE_HEADER::PerfFreq) as a
+/// fixed-point ns-per-tick factor and maps every record with multiplies,
+/// shifts and adds, replacing a clock read or a division per event.
+
+#include <chrono>
+#include <cstdint>
+
+#include "exeray/event/types.hpp"
+#include "exeray/event/wall_clock.hpp"
+
+namespace exeray::etw {
+
+/// @brief One-time anchor between the ETW and the EventGraph clock domains.
+struct ClockDomain {
+    /// FILETIME of the Unix epoch (100-ns intervals since 1601-01-01).
+    static constexpr std::uint64_t kUnixEpochFiletime = 116444736000000000ULL;
+
+    /// Nanoseconds per FILETIME tick.
+    static constexpr std::uint64_t kNsPerTick = 100;
+
+    /// Fraction bits of tick_frac.
+    static constexpr unsigned kFracBits = 32;
+
+    std::uint64_t etw_anchor = 0;       ///< ETW timestamp at the anchor point
+    event::Timestamp graph_anchor = 0;  ///< steady_clock ns at the anchor point
+    std::uint64_t unix_anchor = 0;      ///< Unix-epoch ns at the anchor point (0 = unknown)
+    std::uint64_t tick_ns = kNsPerTick; ///< Whole nanoseconds per ETW tick
+    std::uint64_t tick_frac = 0;        ///< Fraction of a nanosecond per tick, 0.32 fixed point
+
+    /// @brief Anchor both clocks at the current instant, in FILETIME ticks.
+    [[nodiscard]] static ClockDomain capture() noexcept {
+        const auto system = std::chrono::system_clock::now().time_since_epoch();
+        const auto steady = std::chrono::steady_clock::now().time_since_epoch();
+        const auto unix_ns = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(system).count());
+        ClockDomain domain;
+        domain.etw_anchor = kUnixEpochFiletime + unix_ns / kNsPerTick;
+        domain.graph_anchor = static_cast<event::Timestamp>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(steady).count());
+        domain.unix_anchor = unix_ns;
+        return domain;
+    }
+
+    /**
+     * @brief Anchor both clocks at the current instant, in counter ticks.
+     * @param counter Counter read just before the call (QueryPerformanceCounter).
+     * @param frequency Counter ticks per second.
+     */
+    [[nodiscard]] static ClockDomain capture(std::uint64_t counter,
+                                             std::uint64_t frequency) noexcept {
+        ClockDomain domain = capture();
+        domain.etw_anchor = counter;
+        domain.set_frequency(frequency);
+        return domain;
+    }
+
+    /**
+     * @brief Anchor the start of a trace file to the current instant.
+     *
+     * Replayed events keep their recorded spacing on the graph clock and
+     * their recorded wall time.
+     * @param start_time TRACE_LOGFILE_HEADER::StartTime (FILETIME).
+     */
+    [[nodiscard]] static ClockDomain replay(std::uint64_t start_time) noexcept {
+        ClockDomain domain = capture();
+        domain.etw_anchor = start_time;
+        domain.unix_anchor = start_time > kUnixEpochFiletime
+                                 ? (start_time - kUnixEpochFiletime) * kNsPerTick
+                                 : 0;
+        return domain;
+    }
+
+    /// @brief Set the ETW tick rate (TRACE_LOGFILE_HEADER::PerfFreq); 0 is ignored.
+    constexpr void set_frequency(std::uint64_t frequency) noexcept {
+        if (frequency == 0) {
+            return;
+        }
+        constexpr std::uint64_t kNsPerSecond = 1'000'000'000;
+        tick_ns = kNsPerSecond / frequency;
+        tick_frac = ((kNsPerSecond % frequency) << kFracBits) / frequency;
+    }
+
+    /// @brief Convert a tick count to nanoseconds, without a division.
+    [[nodiscard]] constexpr std::uint64_t ticks_to_ns(std::uint64_t ticks) const noexcept {
+        // tick_frac < 2^32, so neither partial product overflows
+        return ticks * tick_ns + (ticks >> kFracBits) * tick_frac +
+               (((ticks & 0xFFFFFFFFULL) * tick_frac) >> kFracBits);
+    }
+
+    /// @brief Convert an ETW record timestamp to EventGraph nanoseconds.
+    ///
+    /// Records older than the anchor (buffered before capture) map below
+    /// graph_anchor; results clamp at 0 rather than wrapping.
+    [[nodiscard]] event::Timestamp to_graph(std::uint64_t etw_timestamp) const noexcept {
+        if (etw_timestamp >= etw_anchor) {
+            return graph_anchor + ticks_to_ns(etw_timestamp - etw_anchor);
+        }
+        const auto behind = ticks_to_ns(etw_anchor - etw_timestamp);
+        return behind < graph_anchor ? graph_anchor - behind : 0;
+    }
+
+    /// @brief Mapping of the graph timestamps this domain produces to wall time.
+    [[nodiscard]] constexpr event::WallClock wall() const noexcept {
+        return {graph_anchor, unix_anchor};
+    }
+};
+
+}  // namespace exeray::etw
@@ -6,6 +6,22 @@
 /// Provides the context structure and callback declarations for ETW event
 /// processing. The callback is invoked by ProcessTrace for each event.
 
+#include "exeray/metrics.hpp"
+
+namespace exeray::etw {
+
+/// @brief Engine metrics updated by flush_pending() (registry nullptr = none).
+struct ConsumerMetrics {
+    MetricsRegistry* registry = nullptr;
+    MetricsRegistry::Id batches = MetricsRegistry::kInvalid;       ///< Counter: batches pushed
+    MetricsRegistry::Id batch_events = MetricsRegistry::kInvalid;  ///< Histogram: batch sizes
+    MetricsRegistry::Id dropped = MetricsRegistry::kInvalid;  ///< Counter: events not stored
+    MetricsRegistry::Id batch_cycles = MetricsRegistry::kInvalid;  ///< Histogram: batch cost
+    MetricsRegistry::Id dns_latency = MetricsRegistry::kInvalid;   ///< Histogram: query to response
+};
+
+}  // namespace exeray::etw
+
 #ifdef _WIN32
 
 #ifndef WIN32_LEAN_AND_MEAN
@@ -16,44 +32,224 @@
 #include <evntcons.h>
 
 #include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <span>
+#include <vector>
+
+#include "exeray/etw/clock.hpp"
+#include "exeray/etw/content_cache.hpp"
+#include "exeray/etw/deferred_strings.hpp"
+#include "exeray/etw/io_coalescer.hpp"
+#include "exeray/etw/script_assembly.hpp"
+#include "exeray/etw/target_set.hpp"
+#include "exeray/event/graph.hpp"
 
 namespace exeray {
 namespace event {
-class EventGraph;  // Forward declaration
 class StringPool;  // Forward declaration
+class ExtensionStore;  // Forward declaration
+class StackTable;  // Forward declaration
 class Correlator;  // Forward declaration
 }  // namespace event
 
 namespace etw {
 
+class BehaviorProfiles;
+class ContentScanner;
+class DetectionStage;
+class DomainMap;
+class ImageVerifier;
+class FlowTable;
+class IngestLatency;
+class JitAggregator;
+class LogonSessions;
+class ManifestProviders;
+class MemoryCapture;
+class RateMonitor;
+class RecordRing;
+class ReplayPacer;
+class ShardMerger;
+class IocMatcher;
+class RuleEngine;
+class Sampler;
+class ShedPolicy;
+class WmiAggregator;
+
 /// @brief Context passed to ETW callback via EVENT_TRACE_LOGFILE::Context.
 ///
 /// This structure is stored in the UserContext field and provides the callback
-/// with access to the event graph, correlator, and target PID filter.
+/// with access to the event graph, correlator, and target process filter.
 struct ConsumerContext {
+    /// @brief Default of batch_limit.
+    static constexpr std::size_t kMaxPendingEvents = 512;
+
+    /// @brief Flush the pending batch once it holds this many events
+    /// (moved by the auto-tuner while the session runs).
+    std::atomic<std::uint32_t> batch_limit{kMaxPendingEvents};
+
     /// @brief Pointer to the event graph for pushing parsed events.
     event::EventGraph* graph = nullptr;
     
-    /// @brief Atomic target PID for filtering (0 = no filter).
-    std::atomic<uint32_t>* target_pid = nullptr;
+    /// @brief Keep only events of these processes (nullptr = all).
+    TargetSet* targets = nullptr;
+
+    /// @brief Add the processes members start to targets, and drop members
+    /// that exit, so a target's descendants are kept too.
+    bool follow_children = false;
 
     /// @brief Pointer to the string pool for interning paths/strings.
     event::StringPool* strings = nullptr;
 
+    /// @brief Store for the extension records of kept events (nullptr = drop them).
+    event::ExtensionStore* extensions = nullptr;
+
     /// @brief Pointer to the correlator for building event chains.
     event::Correlator* correlator = nullptr;
+
+    /// @brief Providers decoded from their manifest, registered at runtime
+    /// (nullptr = their records are dropped like any unknown provider's).
+    const ManifestProviders* manifests = nullptr;
+
+    /// @brief Maps record timestamps into the graph clock (set per session).
+    ClockDomain clock{};
+
+    /// @brief When set, the callback only copies records here and
+    /// drain_records() parses them on another thread.
+    RecordRing* ring = nullptr;
+
+    /// @brief ETW buffers delivered so far (counted by buffer_callback).
+    std::atomic<std::uint64_t> buffers_read{0};
+
+    /// @brief With several sessions, batches go through the merger (as
+    /// shard) instead of straight into graph.
+    ShardMerger* merger = nullptr;
+    std::size_t shard = 0;
+
+    /// @brief Addresses resolved by DNS events, given to the network events
+    /// that connect to them (nullptr = no domains).
+    DomainMap* domains = nullptr;
+
+    /// @brief Folds network transfers into flows before shedding (nullptr =
+    /// store every transfer).
+    FlowTable* flows = nullptr;
+
+    /// @brief Folds CLR JIT events into per-module summaries once their
+    /// strings are interned (nullptr = store every JIT event).
+    JitAggregator* jit = nullptr;
+
+    /// @brief Logon sessions opened by Security events, which give later
+    /// ones their user and logon type (nullptr = no attribution).
+    LogonSessions* logons = nullptr;
+
+    /// @brief Folds repeated WMI operations into per-client summaries once
+    /// their strings are interned (nullptr = store every WMI event).
+    WmiAggregator* wmi = nullptr;
+
+    /// @brief Per-process rate baselines; the event that exceeds one is
+    /// marked Suspicious (nullptr = no rate detection).
+    RateMonitor* rates = nullptr;
+
+    /// @brief Load shedding applied to parsed events (nullptr = keep all).
+    ShedPolicy* shed = nullptr;
+
+    /// @brief Deterministic sampling of parsed events (nullptr = keep all).
+    Sampler* sampler = nullptr;
+
+    /// @brief Detection rules applied to kept events (nullptr = none).
+    RuleEngine* rules = nullptr;
+
+    /// @brief IOC lists matched against kept events (nullptr = none).
+    IocMatcher* iocs = nullptr;
+
+    /// @brief Per-executable behavior profiles kept events feed and are
+    /// checked against (nullptr = none).
+    BehaviorProfiles* profiles = nullptr;
+
+    /// @brief Hashes and verifies loaded images off the ingest path
+    /// (nullptr = off).
+    ImageVerifier* images = nullptr;
+
+    /// @brief Matches AMSI and script content against signatures off the
+    /// ingest path (nullptr = off).
+    ContentScanner* scanner = nullptr;
+
+    /// @brief Reads the RWX regions threads start in off the ingest path
+    /// (nullptr = off).
+    MemoryCapture* captures = nullptr;
+
+    /// @brief Interns the call stacks of kept events into extensions
+    /// (nullptr = stacks are dropped).
+    event::StackTable* stacks = nullptr;
+
+    /// @brief Tests pushed events off the ingest path instead of rules and
+    /// iocs above; told after every push (nullptr = detection is inline).
+    DetectionStage* detection = nullptr;
+
+    /// @brief Fill of the session's ETW buffers in percent, updated by the
+    /// stats poller; drain_records() also accounts for the ring fill.
+    std::atomic<std::uint8_t> pressure{0};
+
+    /// @brief Providers disabled while the session runs, one bit per
+    /// MetricProvider; their records still in ETW's buffers are dropped
+    /// before parsing, so neither the graph nor detection sees them.
+    std::atomic<std::uint32_t> muted{0};
+
+    /// @brief Holds records back to their recorded spacing (file replay only).
+    ReplayPacer* pacer = nullptr;
+
+    /// @brief Samples event ages (nullptr = off). Without a merger the
+    /// Visible stage is recorded here, otherwise by the merger.
+    IngestLatency* latency = nullptr;
+    std::uint32_t delivered_tick = 0;  ///< Sampling counter of the callback
+    std::uint32_t visible_tick = 0;    ///< Sampling counter of flush_pending()
+
+    /// @brief Batch counters in the engine's MetricsRegistry.
+    ConsumerMetrics metrics{};
+
+    /// @brief Last strings interned by this context's parsing thread.
+    RecentStrings recent_strings;
+
+    /// @brief Script and AMSI contents parsed before, with their verdicts.
+    ContentCache content;
+
+    /// @brief Multi-part script blocks waiting for their remaining parts.
+    ScriptAssembler scripts;
+
+    /// @brief Reads and writes held to be merged (off until given a window).
+    IoCoalescer io;
+
+    /// @brief Events parsed from the current ETW buffer, not yet pushed.
+    ///
+    /// Only touched from the ProcessTrace thread, or from the drain thread
+    /// when ring is set.
+    std::vector<event::PendingEvent> pending;
 };
 
 /// @brief ETW event record callback function.
 ///
 /// This function is called by ProcessTrace for each event record.
-/// It filters by target PID, parses the event, and pushes to the EventGraph.
+/// It filters by target process, parses the event, and pushes to the EventGraph.
 ///
 /// @param record Pointer to the ETW event record.
 /// @note Must remain compatible with PEVENT_RECORD_CALLBACK signature.
 void WINAPI event_record_callback(PEVENT_RECORD record);
 
+/// @brief ETW buffer callback: pushes the events batched from one buffer.
+///
+/// Called by ProcessTrace after all events of a buffer were delivered.
+///
+/// @param logfile Trace being consumed; Context holds the ConsumerContext.
+/// @return TRUE to continue processing.
+ULONG WINAPI buffer_callback(PEVENT_TRACE_LOGFILEW logfile);
+
+/// @brief Parse and push records staged in ctx.ring (blocking call).
+///
+/// Returns once the ring is closed and drained. Run on exactly one thread.
+///
+/// @param ctx Consumer context with ring set.
+void drain_records(ConsumerContext& ctx);
+
 /// @brief Start processing trace events (blocking call).
 ///
 /// Calls ProcessTrace which blocks until the session is stopped via CloseTrace
@@ -70,27 +266,102 @@ ULONG start_trace_processing(TRACEHANDLE trace_handle);
 
 // Stub declarations for non-Windows platforms
 #include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <span>
+#include <vector>
+
+#include "exeray/etw/clock.hpp"
+#include "exeray/etw/content_cache.hpp"
+#include "exeray/etw/deferred_strings.hpp"
+#include "exeray/etw/io_coalescer.hpp"
+#include "exeray/etw/script_assembly.hpp"
+#include "exeray/etw/target_set.hpp"
+#include "exeray/event/graph.hpp"
 
 namespace exeray {
 namespace event {
-class EventGraph;
 class StringPool;
+class ExtensionStore;
+class StackTable;
 class Correlator;
 }  // namespace event
 
 namespace etw {
 
+class BehaviorProfiles;
+class ContentScanner;
+class DetectionStage;
+class DomainMap;
+class ImageVerifier;
+class FlowTable;
+class IngestLatency;
+class JitAggregator;
+class LogonSessions;
+class ManifestProviders;
+class MemoryCapture;
+class RateMonitor;
+class RecordRing;
+class ReplayPacer;
+class ShardMerger;
+class IocMatcher;
+class RuleEngine;
+class Sampler;
+class ShedPolicy;
+class WmiAggregator;
+
 struct ConsumerContext {
+    static constexpr std::size_t kMaxPendingEvents = 512;
+
+    std::atomic<std::uint32_t> batch_limit{kMaxPendingEvents};
     event::EventGraph* graph = nullptr;
-    std::atomic<uint32_t>* target_pid = nullptr;
+    TargetSet* targets = nullptr;
+    bool follow_children = false;
     event::StringPool* strings = nullptr;
+    event::ExtensionStore* extensions = nullptr;
     event::Correlator* correlator = nullptr;
+    const ManifestProviders* manifests = nullptr;
+    ClockDomain clock{};
+    RecordRing* ring = nullptr;
+    std::atomic<std::uint64_t> buffers_read{0};
+    ShardMerger* merger = nullptr;
+    std::size_t shard = 0;
+    DomainMap* domains = nullptr;
+    FlowTable* flows = nullptr;
+    JitAggregator* jit = nullptr;
+    LogonSessions* logons = nullptr;
+    WmiAggregator* wmi = nullptr;
+    RateMonitor* rates = nullptr;
+    ShedPolicy* shed = nullptr;
+    Sampler* sampler = nullptr;
+    RuleEngine* rules = nullptr;
+    IocMatcher* iocs = nullptr;
+    BehaviorProfiles* profiles = nullptr;
+    ImageVerifier* images = nullptr;
+    ContentScanner* scanner = nullptr;
+    MemoryCapture* captures = nullptr;
+    event::StackTable* stacks = nullptr;
+    DetectionStage* detection = nullptr;
+    std::atomic<std::uint8_t> pressure{0};
+    std::atomic<std::uint32_t> muted{0};
+    ReplayPacer* pacer = nullptr;
+    IngestLatency* latency = nullptr;
+    std::uint32_t delivered_tick = 0;
+    std::uint32_t visible_tick = 0;
+    ConsumerMetrics metrics{};
+    RecentStrings recent_strings;
+    ContentCache content;
+    ScriptAssembler scripts;
+    IoCoalescer io;
+    std::vector<event::PendingEvent> pending;
 };
 
 /// @brief Stub callback for non-Windows.
 void event_record_callback(void* record);
 
+/// @brief Stub drain for non-Windows; returns immediately.
+void drain_records(ConsumerContext& ctx);
+
 /// @brief Stub trace processing for non-Windows.
 /// @return Always returns 0.
 unsigned long start_trace_processing(uint64_t trace_handle);
@@ -99,3 +370,57 @@ unsigned long start_trace_processing(uint64_t trace_handle);
 }  // namespace exeray
 
 #endif  // _WIN32
+
+// Everything after the parser, on every platform (see SyntheticSource)
+namespace exeray::etw {
+
+struct ParsedEvent;
+
+/**
+ * @brief Filter, score and batch one parsed event, as the record callback does.
+ *
+ * Applies flow folding, load shedding, string interning, inline
+ * detection and I/O coalescing, then queues the event in ctx.pending, or
+ * pushes it at once if it registers a process.
+ *
+ * @param thread_id Thread that logged the event; names the process when
+ *                  the event is attributed to System or Idle.
+ * @param pressure Current pressure in percent, for load shedding.
+ * @param received Delivery time if sampled for latency, else 0.
+ */
+void consume_parsed(ConsumerContext& ctx, ParsedEvent& parsed, std::uint32_t thread_id,
+                    std::uint8_t pressure, event::Timestamp received);
+
+/// Pending events consume_stack() looks back through.
+inline constexpr std::size_t kStackLookback = 16;
+
+/**
+ * @brief Attach a stack delivered as its own event to the event it belongs to.
+ *
+ * The classic kernel providers log a StackWalk event right after the event
+ * it was captured for, stamped with that event's time. The stack goes to
+ * the newest of the last kStackLookback pending events with that time;
+ * if the event was shed, coalesced or already pushed, it is counted as
+ * orphaned in ctx.stacks.
+ *
+ * @param timestamp Time of the event the stack belongs to, in the units
+ *                  of ParsedEvent::timestamp.
+ * @return true if the stack was attached.
+ */
+bool consume_stack(ConsumerContext& ctx, std::uint64_t timestamp,
+                   std::span<const std::uint64_t> frames);
+
+/// @brief Push all pending events of a context as one batch.
+///
+/// Resolves the batch's parents and correlation IDs in one Correlator pass
+/// first, so per-event work in the callback stays lock-free.
+///
+/// @param ctx Consumer context whose pending events are flushed.
+void flush_pending(ConsumerContext& ctx);
+
+/// @brief Release the I/O runs ctx.io still holds, then flush_pending().
+///
+/// Call once the context receives no more records (end of a session).
+void finish_pending(ConsumerContext& ctx);
+
+}  // namespace exeray::etw
@@ -0,0 +1,113 @@
+#pragma once
+
+/// @file content_cache.hpp
+/// @brief Recognition of script and AMSI buffers seen before.
+///
+/// Loaders resubmit the same script blocks and scan buffers over and over.
+/// The parsers hash each buffer with content_hash() on arrival and look it
+/// up in the consumer thread's ContentCache: a repeat takes the verdict of
+/// its first scan and the StringId of its first interning instead of being
+/// scanned and interned again. The cache is bound to the thread with
+/// ContentCache::Scope, the way DeferredStrings defers, so parsers called
+/// outside a consumer simply scan everything.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "exeray/event/types.hpp"
+
+namespace exeray::etw {
+
+/**
+ * @brief 64-bit hash of a buffer, in the manner of XXH3.
+ *
+ * Long inputs are consumed in 64-byte stripes by eight independent lanes,
+ * each a 32x32->64 multiply of the data with a key, which compilers turn
+ * into packed multiplies; short inputs take a scalar path. Not suitable
+ * against adversarial collisions.
+ */
+[[nodiscard]] std::uint64_t content_hash(const void* data, std::size_t size) noexcept;
+
+/**
+ * @brief Bounded LRU of content hashes with their first scan's outcome.
+ *
+ * Fixed node pool with an intrusive recency list and chained buckets, so
+ * lookups and evictions never allocate. Contents are identified by hash
+ * and size.
+ *
+ * Thread-safety: none; one per consumer thread (ConsumerContext).
+ */
+class ContentCache {
+public:
+    static constexpr std::size_t kCapacity = 1024;
+
+    struct Entry {
+        std::uint64_t hash = 0;
+        std::uint32_t size = 0;      ///< Content bytes
+        std::uint32_t repeats = 0;   ///< Times seen after the first
+        std::uint64_t verdict = 0;   ///< Parser-defined outcome of the first scan
+        event::StringId content = event::INVALID_STRING;  ///< Set once interned for a repeat
+    };
+
+    /// @brief While alive, ContentCache::current() on this thread is cache.
+    class Scope {
+    public:
+        explicit Scope(ContentCache* cache) noexcept;
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        ContentCache* previous_;
+    };
+
+    ContentCache() noexcept;
+
+    /// @brief Cache bound by the innermost Scope on this thread, else nullptr.
+    [[nodiscard]] static ContentCache* current() noexcept;
+
+    /// @brief Entry of a content seen before, now the most recently used
+    /// with its repeat counted; nullptr if unseen.
+    Entry* find(std::uint64_t hash, std::uint32_t size) noexcept;
+
+    /// @brief Record a first occurrence, evicting the least recently used
+    /// entry when full.
+    Entry& insert(std::uint64_t hash, std::uint32_t size, std::uint64_t verdict) noexcept;
+
+    /// @brief Forget every entry (their StringIds belong to an old pool).
+    void clear() noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept { return used_; }
+    [[nodiscard]] std::uint64_t hits() const noexcept { return hits_; }
+    [[nodiscard]] std::uint64_t misses() const noexcept { return misses_; }
+
+private:
+    static constexpr std::size_t kBuckets = 2 * kCapacity;
+    static constexpr std::uint16_t kNil = 0xFFFF;
+
+    struct Node {
+        Entry entry;
+        std::uint16_t newer = kNil;  ///< Recency list, towards head_
+        std::uint16_t older = kNil;
+        std::uint16_t chain = kNil;  ///< Next node in the same bucket
+    };
+
+    [[nodiscard]] static std::size_t bucket_of(std::uint64_t hash) noexcept {
+        return static_cast<std::size_t>(hash >> 32) % kBuckets;
+    }
+
+    void unlink(std::uint16_t node) noexcept;
+    void push_front(std::uint16_t node) noexcept;
+    void unchain(std::uint16_t node) noexcept;
+
+    std::array<Node, kCapacity> nodes_{};
+    std::array<std::uint16_t, kBuckets> buckets_{};
+    std::uint16_t head_ = kNil;  ///< Most recently used
+    std::uint16_t tail_ = kNil;  ///< Least recently used
+    std::size_t used_ = 0;
+    std::uint64_t hits_ = 0;
+    std::uint64_t misses_ = 0;
+};
+
+}  // namespace exeray::etw
@@ -0,0 +1,228 @@
+#pragma once
+
+/// @file content_scanner.hpp
+/// @brief Our own signatures over AMSI and script-block content, off the ingest path.
+///
+/// AMSI events report the verdict of the antimalware provider, and script
+/// blocks none at all. ContentScanner matches their content against the
+/// configured signatures on pool workers, the way ImageVerifier hashes
+/// images: the consumer only calls attach(), which hands over the content's
+/// StringId. Content already scanned this session gets its verdict record
+/// on the spot. New content is queued unless the queued bytes would exceed
+/// the memory budget, and the ETW thread never reads it. A worker scans
+/// it with one pass of a SignatureSet, stores one ContentVerdictExtension
+/// per content and backfills the events pushed meanwhile, marking those
+/// that matched Suspicious.
+///
+/// Content is deduplicated by hash: ContentCache already gives repeated
+/// buffers their first StringId, and the verdicts of each (hash, size)
+/// outlive the session, so a loader resubmitting the same script across
+/// sessions is scanned once.
+///
+/// Signatures are YARA-like: a name, a set of text strings matched
+/// ignoring ASCII case, and how many of them must occur.
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "exeray/event/extensions.hpp"
+#include "exeray/event/types.hpp"
+
+namespace exeray::event {
+class EventGraph;
+struct EventPayload;
+class StringPool;
+}  // namespace exeray::event
+
+namespace exeray::etw {
+
+/// @brief One signature: matches when at least min_matches of its strings occur.
+struct ContentSignature {
+    std::string name;
+    std::vector<std::string> strings;  ///< Matched ignoring ASCII case; empty ones are ignored
+    std::size_t min_matches = 0;       ///< 0 = all of them
+};
+
+/**
+ * @brief Signatures compiled into one Aho-Corasick automaton.
+ *
+ * Each distinct string is one pattern of the automaton, whatever the
+ * number of signatures sharing it, so content is scanned once per
+ * match() for the whole set.
+ *
+ * Thread-safety: immutable once built; match() from any thread.
+ */
+class SignatureSet {
+public:
+    SignatureSet() = default;
+    explicit SignatureSet(const std::vector<ContentSignature>& signatures);
+
+    [[nodiscard]] bool empty() const noexcept { return required_.empty(); }
+    [[nodiscard]] std::size_t size() const noexcept { return required_.size(); }
+
+    /// @brief Indices of the signatures text matches, in ascending order.
+    [[nodiscard]] std::vector<std::uint32_t> match(std::string_view text) const;
+
+private:
+    static constexpr std::uint32_t kNone = UINT32_MAX;
+
+    std::array<std::uint16_t, 256> class_of_{};  ///< 0 = no pattern has the byte
+    std::size_t classes_ = 1;
+    std::vector<std::uint32_t> next_;      ///< States x classes, failures folded in
+    std::vector<std::uint32_t> pattern_;   ///< Pattern ending at a state (kNone = none)
+    std::vector<std::uint32_t> output_;    ///< Nearest proper suffix state ending a pattern
+    std::vector<std::vector<std::uint32_t>> users_;  ///< Signatures of each pattern
+    std::vector<std::uint32_t> required_;  ///< Distinct patterns each signature needs
+};
+
+/// @brief Content scanning settings.
+struct ContentScanConfig {
+    bool enabled = false;                     ///< Scan AMSI and script content at all
+    std::vector<ContentSignature> signatures;
+    std::size_t workers = 1;                  ///< Pool tasks scanning at once
+    std::size_t memory_budget = 64ULL << 20;  ///< Content bytes queued at once; more is skipped
+};
+
+/// @brief What the scanner did in the current or last session.
+struct ContentScanStats {
+    std::uint64_t contents = 0;    ///< Distinct contents seen
+    std::uint64_t scanned = 0;     ///< Contents scanned
+    std::uint64_t cached = 0;      ///< Contents answered by a verdict of the same hash
+    std::uint64_t matched = 0;     ///< Contents matching a signature
+    std::uint64_t skipped = 0;     ///< Contents not queued for lack of budget
+    std::uint64_t attached = 0;    ///< Events given their verdict at ingest
+    std::uint64_t backfilled = 0;  ///< Events given their verdict after the push
+};
+
+/**
+ * @brief Scans each distinct AMSI or script content once, on pool workers.
+ *
+ * Thread-safety: attach() and stats() from any thread (content lookups
+ * are sharded, each shard with its own mutex); start() and stop() from
+ * the thread controlling the session.
+ */
+class ContentScanner {
+public:
+    /// @brief Runs a task on a pool worker.
+    using Submit = std::function<void(std::function<void()>)>;
+
+    static constexpr std::size_t kShards = 16;
+
+    /// Queued contents a worker scans before it backfills their events.
+    static constexpr std::size_t kBatch = 32;
+
+    /// Verdicts kept by hash across sessions; the table restarts when full.
+    static constexpr std::size_t kMaxVerdicts = 65536;
+
+    explicit ContentScanner(const ContentScanConfig& config = {});
+    ~ContentScanner();
+
+    ContentScanner(const ContentScanner&) = delete;
+    ContentScanner& operator=(const ContentScanner&) = delete;
+
+    /**
+     * @brief Begin scanning the content of the events pushed from now on.
+     * @param graph Graph the events are pushed to.
+     * @param strings Pool holding the contents; must outlive stop().
+     * @param extensions Store the verdict records go to; must outlive stop().
+     * @param submit Hands a task to the pool.
+     */
+    void start(event::EventGraph& graph, const event::StringPool& strings,
+               event::ExtensionStore& extensions, Submit submit);
+
+    /// @brief Whether start() was called without a matching stop().
+    [[nodiscard]] bool running() const noexcept {
+        return running_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Give an AMSI or script event its verdict, or queue its content.
+     *
+     * Called by the consumer before the push; never reads the content.
+     * Events of content still queued are pushed without a verdict and
+     * backfilled by the worker.
+     *
+     * @return true if the content is known to match a signature (the
+     *         caller marks the event Suspicious).
+     */
+    bool attach(event::EventPayload& payload);
+
+    /// @brief Wait for the workers, scan what is left on this thread and
+    /// backfill every event still without its verdict.
+    void stop();
+
+    /// @brief Verdict record of a content this session (NO_EXTENSION = none yet).
+    [[nodiscard]] event::ExtensionId verdict(event::StringId content) const;
+
+    [[nodiscard]] ContentScanStats stats() const noexcept;
+
+private:
+    struct Known {
+        event::ExtensionId extension = event::NO_EXTENSION;  ///< NO_EXTENSION if the store is full
+        bool scanned = false;                                ///< false while queued
+        bool matched = false;
+    };
+
+    struct Queued {
+        event::StringId content = event::INVALID_STRING;
+        std::size_t size = 0;  ///< Bytes, counted against the budget
+    };
+
+    struct alignas(64) ContentShard {
+        mutable std::mutex mutex;
+        std::unordered_map<event::StringId, Known> contents;
+    };
+
+    /// @brief Claim and scan batches until the queue is empty (pool worker).
+    void run();
+
+    /// @brief Scan up to kBatch queued contents; false if the queue was empty.
+    bool scan_batch();
+
+    /// @brief Verdict of one content, from the hash table or a scan.
+    [[nodiscard]] event::ContentVerdictExtension scan(std::string_view text);
+
+    /// @brief Point the events of the scanned contents that lack a verdict
+    /// at it, and mark those that matched.
+    void backfill(const std::unordered_map<event::StringId, Known>& resolved);
+
+    ContentScanConfig config_;
+    SignatureSet signatures_;
+    event::EventGraph* graph_ = nullptr;
+    const event::StringPool* strings_ = nullptr;
+    event::ExtensionStore* extensions_ = nullptr;
+    Submit submit_;
+
+    std::array<ContentShard, kShards> contents_;
+
+    mutable std::mutex verdicts_mutex_;
+    /// Keyed by content_hash() mixed with the size
+    std::unordered_map<std::uint64_t, event::ContentVerdictExtension> verdicts_;
+
+    std::atomic<bool> running_{false};
+    std::mutex mutex_;
+    std::condition_variable idle_;
+    std::deque<Queued> queue_;      ///< Contents waiting for a worker (mutex_)
+    std::size_t queued_bytes_ = 0;  ///< Their total size (mutex_)
+    std::size_t active_ = 0;        ///< Tasks submitted and not finished (mutex_)
+
+    std::atomic<std::uint64_t> seen_{0};
+    std::atomic<std::uint64_t> scanned_{0};
+    std::atomic<std::uint64_t> cached_{0};
+    std::atomic<std::uint64_t> matched_{0};
+    std::atomic<std::uint64_t> skipped_{0};
+    std::atomic<std::uint64_t> attached_{0};
+    std::atomic<std::uint64_t> backfilled_{0};
+};
+
+}  // namespace exeray::etw
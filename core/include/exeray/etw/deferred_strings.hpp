@@ -0,0 +1,130 @@
+#pragma once
+
+/// @file deferred_strings.hpp
+/// @brief String fields of a parsed event, interned only once it is kept.
+///
+/// Parsers find their strings as views into the record's UserData.
+/// Interning each one right away costs a hash and a table probe (and for
+/// paths a walk over every component) even for events that load shedding
+/// gives up a moment later. Inside a DeferredStrings::Scope the parsers
+/// record the views instead, and the consumer interns them with commit()
+/// after deciding to keep the event, while the record is still alive.
+/// RecentStrings short-circuits the strings that repeat back to back, such
+/// as the same DLL loaded by many threads.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "exeray/event/payload.hpp"
+#include "exeray/event/types.hpp"
+
+namespace exeray::event {
+class StringPool;
+}
+
+namespace exeray::etw {
+
+/// @brief How a string is interned.
+enum class StringKind : std::uint8_t {
+    Utf8,      ///< StringPool::intern()
+    Wide,      ///< StringPool::intern_wide()
+    WidePath,  ///< StringPool::intern_path_wide()
+};
+
+/**
+ * @brief Per-thread cache of the last strings interned.
+ *
+ * A few slots replaced round-robin, each keeping a copy of the string and
+ * its StringId. Bound to one pool: handing it another clears it.
+ *
+ * Thread-safety: none; one per consumer thread.
+ */
+class RecentStrings {
+public:
+    static constexpr std::size_t kSlots = 8;
+
+    /// @brief StringId of a string, from the cache or interned into pool.
+    /// @param length Characters (wchar_t for the wide kinds).
+    event::StringId intern(event::StringPool& pool, StringKind kind, const void* data,
+                           std::size_t length);
+
+    [[nodiscard]] std::uint64_t hits() const noexcept { return hits_; }
+    [[nodiscard]] std::uint64_t misses() const noexcept { return misses_; }
+
+private:
+    struct Slot {
+        std::uint64_t hash = 0;
+        StringKind kind = StringKind::Utf8;
+        event::StringId id = event::INVALID_STRING;
+        std::string bytes;  ///< Raw characters
+    };
+
+    event::StringPool* pool_ = nullptr;
+    std::array<Slot, kSlots> slots_{};
+    std::size_t next_ = 0;
+    std::uint64_t hits_ = 0;
+    std::uint64_t misses_ = 0;
+};
+
+/**
+ * @brief Views of an event's strings and the payload fields they go to.
+ *
+ * Fields are identified by their offset in the EventPayload, so the views
+ * survive the ParsedEvent being copied or returned.
+ */
+class DeferredStrings {
+public:
+    static constexpr std::size_t kMaxStrings = 4;
+
+    /// @brief While alive, parsers on this thread defer their strings.
+    class Scope {
+    public:
+        Scope() noexcept;
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        bool previous_;
+    };
+
+    /// @brief Whether a Scope is alive on this thread.
+    [[nodiscard]] static bool active() noexcept;
+
+    /// @brief Record a string for field, a StringId inside payload.
+    /// @return false if full or field is not part of payload.
+    bool add(const event::EventPayload& payload, const event::StringId& field,
+             StringKind kind, const void* data, std::size_t length) noexcept;
+
+    bool add(const event::EventPayload& payload, const event::StringId& field,
+             std::wstring_view text, StringKind kind = StringKind::Wide) noexcept {
+        return add(payload, field, kind, text.data(), text.size());
+    }
+
+    bool add(const event::EventPayload& payload, const event::StringId& field,
+             std::string_view text) noexcept {
+        return add(payload, field, StringKind::Utf8, text.data(), text.size());
+    }
+
+    /// @brief Intern every recorded string into its field, then forget them.
+    void commit(event::EventPayload& payload, event::StringPool& pool,
+                RecentStrings* recent = nullptr);
+
+    [[nodiscard]] std::size_t size() const noexcept { return count_; }
+
+private:
+    struct Entry {
+        const void* data = nullptr;
+        std::uint32_t length = 0;
+        std::uint16_t offset = 0;  ///< Byte offset of the StringId in EventPayload
+        StringKind kind = StringKind::Utf8;
+    };
+
+    std::array<Entry, kMaxStrings> entries_{};
+    std::uint8_t count_ = 0;
+};
+
+}  // namespace exeray::etw
@@ -0,0 +1,233 @@
+#pragma once
+
+/// @file detection_rules.hpp
+/// @brief Configurable detection rules over parsed events.
+///
+/// The parsers flag what they can judge from one event's raw data (RWX
+/// allocations, DGA-like domains, script patterns). Everything else an
+/// analyst wants to flag, e.g. "cmd.exe started with /c whoami" or "five
+/// DNS failures from one process within ten seconds", is a DetectionRule:
+/// predicates over payload fields and strings, optionally with a count
+/// threshold in a time window. A rule can also be a sequence of steps
+/// taken against one target process, e.g. an RWX allocation followed by a
+/// remote thread start in the same process within two seconds; each
+/// target's progress is a small state kept in a bounded, expiring table,
+/// so a sequence costs O(1) per event and the graph is never re-scanned.
+/// RuleEngine compiles the rules once into a table indexed by category and
+/// operation, so each event is tested only against the rules (and
+/// sequence steps) that can match it, numeric predicates first.
+///
+/// Rules can be written as text, one per line:
+/// @code
+/// # '#' starts a comment
+/// rule whoami tag T1033: Process/0 where command_line contains "whoami"
+/// rule dns_failures: Dns where result_code != 0 count 5 within 10s by domain
+/// rule injection: Memory/0 where is_suspicious == 1 then Thread/0 where is_remote == 1 within 2s
+/// rule encoded: Process/0 where command_line matches "-e(nc|ncodedcommand)? +[a-z0-9+/=]{40}"
+/// @endcode
+///
+/// `matches` tests a string field against a regular expression (see
+/// regex_dfa.hpp). Interned strings repeat, so each predicate remembers its
+/// verdict per StringId: the expression runs once per distinct string, and
+/// an event whose strings were all seen before costs a table lookup.
+///
+/// A rule's tag (its name unless given) is attached to the events it fires
+/// on with EventGraph::add_tags(), so "every event tagged T1055" is a
+/// for_each_tagged() walk rather than a re-run of the rules.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "exeray/event/payload.hpp"
+#include "exeray/event/types.hpp"
+
+namespace exeray::event {
+class StringPool;
+}  // namespace exeray::event
+
+namespace exeray::etw {
+
+class RegexDfa;
+
+/// @brief Comparison of a payload field with a rule operand.
+enum class RuleOp : std::uint8_t {
+    Equal,         ///< ==; strings compare ignoring ASCII case
+    NotEqual,      ///< !=
+    Less,          ///< <, numeric fields only
+    LessEqual,     ///< <=
+    Greater,       ///< >
+    GreaterEqual,  ///< >=
+    Contains,      ///< String fields only, ignoring ASCII case
+    StartsWith,
+    EndsWith,
+    Matches        ///< String fields only: regular expression (see RegexDfa)
+};
+
+/// @brief One condition on a payload field.
+struct RulePredicate {
+    std::string field;         ///< Payload member name, e.g. "command_line"
+    RuleOp op = RuleOp::Equal;
+    std::uint64_t number = 0;  ///< Operand of a numeric field
+    std::string text;          ///< Operand of a string field (UTF-8)
+
+    /// Matches: text compiled by parse_detection_rules(), reused by
+    /// RuleEngine (compiled there if null). Shared by copies of the rule;
+    /// RegexDfa::search() is thread-safe.
+    std::shared_ptr<RegexDfa> regex = nullptr;
+};
+
+/// @brief A later step of a sequence rule.
+struct RuleStep {
+    event::Category category = event::Category::Thread;
+    std::uint16_t operation = 0x100;        ///< Operation code or DetectionRule::kAnyOperation
+    std::vector<RulePredicate> predicates;  ///< All must hold
+};
+
+/// @brief A named rule: all predicates hold, threshold times within a window.
+///
+/// With then steps the rule is a sequence instead: it fires on the event
+/// completing the last step, once the first step and every later one
+/// matched in order for the same target process, all within window_ns.
+/// Only the completing event is marked; those before it are already
+/// stored.
+struct DetectionRule {
+    /// Matches every operation of the category.
+    static constexpr std::uint16_t kAnyOperation = 0x100;
+
+    std::string name;
+    std::string tag;  ///< Tag of the events it fires on (empty = name)
+    event::Category category = event::Category::Process;
+    std::uint16_t operation = kAnyOperation;  ///< Operation code or kAnyOperation
+    std::vector<RulePredicate> predicates;    ///< All must hold (none: every event)
+
+    /// Matching events needed before the rule fires; the count restarts
+    /// after each firing.
+    std::uint32_t threshold = 1;
+    std::uint64_t window_ns = 0;  ///< Matches older than this expire (0 = never)
+    std::string group_by;         ///< Field whose value keys the count (empty = one count)
+
+    /// Steps after the first for a sequence (threshold must then be 1).
+    /// Every step's category needs a target process field: pid for
+    /// Process, process_id for Image, Thread, Memory and Security.
+    std::vector<RuleStep> then;
+};
+
+/// @brief Detection rules and their bookkeeping limits.
+struct DetectionConfig {
+    bool enabled = true;              ///< Turn rule evaluation off entirely
+    bool builtin_rules = true;        ///< Evaluate builtin_detection_rules() before rules
+    std::vector<DetectionRule> rules; ///< See parse_detection_rules()
+    std::size_t max_groups = 4096;    ///< Counted group_by values (or targets) per rule
+};
+
+/// @brief Matches and firings of one rule.
+struct RuleStats {
+    std::string name;
+    std::uint64_t matched = 0;  ///< Events for which all predicates held
+    std::uint64_t fired = 0;    ///< Times the threshold was reached
+    event::EventTags tag = 0;   ///< Bit the rule sets on events it fires on (0 = none)
+};
+
+/**
+ * @brief Parse rules written in the text form shown in the file comment.
+ *
+ * Grammar of a line:
+ * `rule <name> [tag <tag>]: <step> [count <n> within <duration> [by <field>]]`
+ * or `rule <name> [tag <tag>]: <step> then <step> [then ...] [within <duration>]`, where
+ * a step is `<Category>[/<operation>] [where <field> <op> <operand>
+ * [and ...]]`, with op one of
+ * `== != < <= > >= contains startswith endswith matches`, a number
+ * (decimal or 0x hex) or a double-quoted string as operand, and a duration
+ * in ms, s or m. Category names are those of event::Category, in any case.
+ * A backslash in a quoted string escapes the next character, so a regex
+ * writes `\\d` as "\\\\d".
+ *
+ * @param error Receives "line N: reason" for the first invalid line.
+ * @return The rules in order, or nullopt if a line is invalid or names a
+ *         field its category does not have.
+ */
+[[nodiscard]] std::optional<std::vector<DetectionRule>> parse_detection_rules(
+    std::string_view text, std::string* error = nullptr);
+
+/// @brief Rules shipped with the engine: the injection sequences.
+[[nodiscard]] std::vector<DetectionRule> builtin_detection_rules();
+
+/**
+ * @brief Evaluates compiled detection rules against parsed events.
+ *
+ * Rules naming an unknown field or comparing a field the wrong way are
+ * skipped with a warning at construction.
+ *
+ * Thread-safety: configured at construction; evaluate() and stats() may be
+ * called from any number of consumer threads. Windowed counts and
+ * sequences take a per-rule lock, plain rules take none.
+ */
+class RuleEngine {
+public:
+    explicit RuleEngine(const DetectionConfig& config = {});
+    ~RuleEngine();
+
+    RuleEngine(const RuleEngine&) = delete;
+    RuleEngine& operator=(const RuleEngine&) = delete;
+
+    /// @brief Whether no rule was compiled (evaluate() is then a no-op).
+    [[nodiscard]] bool empty() const noexcept { return rules_.empty(); }
+
+    /// @brief Number of compiled rules.
+    [[nodiscard]] std::size_t size() const noexcept { return rules_.size(); }
+
+    /**
+     * @brief Test one event against the rules of its category and operation.
+     * @param payload Event payload with interned strings.
+     * @param operation Category-specific operation code.
+     * @param timestamp Event time in nanoseconds, for windowed rules.
+     * @param strings Pool resolving the payload's string IDs.
+     * @param tags Receives the tag bits of the rules that fired (nullptr = skip).
+     * @return true if at least one rule fired.
+     */
+    bool evaluate(const event::EventPayload& payload, std::uint8_t operation,
+                  event::Timestamp timestamp, const event::StringPool& strings,
+                  event::EventTags* tags = nullptr);
+
+    /// @brief Distinct rule tags; the tag at position i is bit 1 << i.
+    [[nodiscard]] const std::vector<std::string>& tags() const noexcept { return tags_; }
+
+    /// @brief Bit of a tag (0 if no rule has it).
+    [[nodiscard]] event::EventTags tag_bit(std::string_view tag) const noexcept;
+
+    /// @brief Per-rule counters since construction or the last reset(), in rule order.
+    [[nodiscard]] std::vector<RuleStats> stats() const;
+
+    /// @brief Zero the counters and forget windowed matches (start of a session).
+    void reset();
+
+private:
+    static constexpr std::size_t kCategories = static_cast<std::size_t>(event::Category::Count);
+
+    struct Rule;
+
+    /// @brief A rule, or one step of a sequence rule, to test.
+    struct Entry {
+        std::uint32_t rule = 0;
+        std::uint32_t step = 0;
+    };
+
+    /// @brief Entries of one category and operation, as a range of order_.
+    struct Slice {
+        std::uint32_t begin = 0;
+        std::uint32_t count = 0;
+    };
+
+    std::vector<std::unique_ptr<Rule>> rules_;
+    std::vector<std::string> tags_;  ///< At most 64, one per EventTags bit
+    std::vector<Entry> order_;  ///< Grouped by slice
+    std::array<std::array<Slice, 256>, kCategories> index_{};
+};
+
+}  // namespace exeray::etw
@@ -0,0 +1,139 @@
+#pragma once
+
+/// @file detection_stage.hpp
+/// @brief Detection rules and IOC lists run after the push, on pool workers.
+///
+/// Inline, every rule and indicator lookup adds to the time a record spends
+/// between ETW and the graph. DetectionStage instead follows the graph:
+/// consumers only tell it that events were pushed, and pool workers test
+/// what is stored, in chunks claimed with one atomic step, and raise the
+/// status of the events that match with EventGraph::set_status() (and score
+/// them with the Correlator, which sees the pushed status only). Parse and
+/// insert latency no longer depend on detection cost; the price is that a
+/// verdict appears detection lag after the event (see stats() and
+/// LatencyStage::Detected).
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+#include "exeray/event/graph.hpp"
+#include "exeray/event/types.hpp"
+
+namespace exeray::event {
+class Correlator;
+class StringPool;
+}  // namespace exeray::event
+
+namespace exeray::etw {
+
+class IngestLatency;
+class IocMatcher;
+class RuleEngine;
+
+/// @brief Progress of the detection stage in the current or last session.
+struct DetectionStageStats {
+    std::uint64_t tested = 0;       ///< Events checked against rules and indicators
+    std::uint64_t flagged = 0;      ///< Events raised to Status::Suspicious
+    std::uint64_t missed = 0;       ///< Evicted before a worker reached them
+    std::uint64_t backlog = 0;      ///< Stored events no worker has claimed yet
+    std::uint64_t max_backlog = 0;  ///< Largest backlog a worker found
+};
+
+/**
+ * @brief Tests stored events on a bounded number of pool workers.
+ *
+ * Each event pushed while the stage runs is tested exactly once, in ID
+ * order within a chunk but with chunks spread over the workers.
+ *
+ * Thread-safety: notify() and stats() from any thread; start() and stop()
+ * from the thread controlling the session.
+ */
+class DetectionStage {
+public:
+    /// @brief Runs a task on a pool worker.
+    using Submit = std::function<void(std::function<void()>)>;
+
+    /// Events a worker claims at a time.
+    static constexpr std::size_t kChunk = 512;
+
+    explicit DetectionStage(event::EventGraph& graph) noexcept;
+    ~DetectionStage();
+
+    DetectionStage(const DetectionStage&) = delete;
+    DetectionStage& operator=(const DetectionStage&) = delete;
+
+    /**
+     * @brief Begin testing the events pushed from now on.
+     * @param rules Rules to evaluate (nullptr = none).
+     * @param iocs Indicator lists to match (nullptr = none).
+     * @param strings Pool resolving payload strings; must outlive stop().
+     * @param latency Samples LatencyStage::Detected (nullptr = off).
+     * @param correlator Scores flagged events (nullptr = off).
+     * @param workers Most tasks running at once (at least 1).
+     * @param submit Hands a task to the pool.
+     */
+    void start(RuleEngine* rules, IocMatcher* iocs, const event::StringPool* strings,
+               IngestLatency* latency, event::Correlator* correlator, std::size_t workers,
+               Submit submit);
+
+    /// @brief Whether start() was called without a matching stop().
+    [[nodiscard]] bool running() const noexcept {
+        return running_.load(std::memory_order_acquire);
+    }
+
+    /// @brief Change the most tasks running at once (at least 1); takes
+    /// effect as tasks are submitted or finish.
+    void set_workers(std::size_t workers);
+
+    /// @brief Most tasks running at once.
+    [[nodiscard]] std::size_t workers() const;
+
+    /// @brief Events were pushed: wake a worker if one is free.
+    void notify();
+
+    /// @brief Wait for the workers, then test what is left on this thread.
+    void stop();
+
+    [[nodiscard]] DetectionStageStats stats() const noexcept;
+
+private:
+    /// @brief Claim and test chunks until none is left (pool worker).
+    void run();
+
+    /// @brief Claim [begin, end) of at most kChunk events; false if caught up.
+    bool claim(event::EventId& begin, event::EventId& end) noexcept;
+
+    /// @brief Test the events in [begin, end).
+    void test(event::EventId begin, event::EventId end);
+
+    /// @brief One past the newest published event ID.
+    [[nodiscard]] event::EventId watermark() const noexcept {
+        return graph_.oldest_id() + graph_.count();
+    }
+
+    event::EventGraph& graph_;
+    RuleEngine* rules_ = nullptr;
+    IocMatcher* iocs_ = nullptr;
+    const event::StringPool* strings_ = nullptr;
+    IngestLatency* latency_ = nullptr;
+    event::Correlator* correlator_ = nullptr;
+    Submit submit_;
+    std::size_t workers_ = 0;  ///< Under mutex_ while running
+
+    std::atomic<bool> running_{false};
+    std::atomic<event::EventId> next_{1};  ///< First event not claimed yet
+    std::atomic<std::uint64_t> tested_{0};
+    std::atomic<std::uint64_t> flagged_{0};
+    std::atomic<std::uint64_t> missed_{0};
+    std::atomic<std::uint64_t> max_backlog_{0};
+
+    mutable std::mutex mutex_;
+    std::condition_variable idle_;
+    std::size_t active_ = 0;  ///< Tasks submitted and not finished (mutex_)
+};
+
+}  // namespace exeray::etw
@@ -0,0 +1,75 @@
+#pragma once
+
+/// @file dga_model.hpp
+/// @brief Scoring of domain names for DGA (Domain Generation Algorithm) output.
+///
+/// Names people choose are made of pronounceable fragments; generated ones
+/// are not. label_surprise() measures how unlikely a label's character
+/// transitions are under a bigram model of benign names: the table of
+/// transition costs is built at compile time from a word list, so scoring
+/// is one lookup per character. DgaVerdictCache remembers the verdict per
+/// name, so a chatty host querying the same few names is not rescored.
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace exeray::etw {
+
+/// @brief Mean cost in bits of the character transitions of one label.
+///
+/// The label's start and end count as transitions, case is ignored, and
+/// characters other than letters, digits and '-' all cost the same (high)
+/// amount. Benign labels of eight characters or more score below about
+/// 4.5; random strings above 5.
+///
+/// @return 0 for an empty label.
+[[nodiscard]] float label_surprise(std::wstring_view label) noexcept;
+
+/**
+ * @brief Whether a domain name looks algorithmically generated.
+ *
+ * Every label but the top-level one is checked: longer than 20
+ * characters, more than 30% digits (over five characters), or at least
+ * eight characters with a label_surprise() above 4.7. Punycode labels
+ * (xn--) are only checked for length.
+ */
+[[nodiscard]] bool looks_generated(std::wstring_view domain) noexcept;
+
+/**
+ * @brief Fixed-size cache of looks_generated() verdicts.
+ *
+ * Direct-mapped on a hash of the case-folded name; a colliding name
+ * replaces the cached one. Each slot is one atomic word holding the hash
+ * and the verdict, so lookups and stores are lock-free.
+ *
+ * Thread-safety: check(), find() and store() from any thread.
+ */
+class DgaVerdictCache {
+public:
+    static constexpr std::size_t kSlots = 4096;
+
+    /// @brief Cache key of a domain (ASCII case-insensitive).
+    [[nodiscard]] static std::uint64_t key(std::wstring_view domain) noexcept;
+
+    /// @brief Cached verdict for key, if any.
+    [[nodiscard]] std::optional<bool> find(std::uint64_t key) const noexcept;
+
+    void store(std::uint64_t key, bool generated) noexcept;
+
+    /// @brief looks_generated(domain), scoring each name only once.
+    [[nodiscard]] bool check(std::wstring_view domain) noexcept;
+
+private:
+    /// @brief Slot word: key with bit 0 replaced by the verdict, bit 1 set.
+    static constexpr std::uint64_t entry(std::uint64_t key, bool generated) noexcept {
+        return (key & ~std::uint64_t{1}) | 2 | (generated ? 1 : 0);
+    }
+
+    std::array<std::atomic<std::uint64_t>, kSlots> slots_{};  ///< 0 = empty
+};
+
+}  // namespace exeray::etw
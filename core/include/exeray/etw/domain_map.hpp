@@ -0,0 +1,148 @@
+#pragma once
+
+/// @file domain_map.hpp
+/// @brief Addresses resolved by DNS, and the domains they were resolved from.
+///
+/// A connection to 93.184.216.34 says little; one to example.com, looked up
+/// a moment before by the same process, says what it is for. DomainMap
+/// keeps what DNS responses resolved to, keyed by (process, address) and
+/// by address alone (pid 0) for connections made by another process than
+/// the one that asked, such as a service resolving on a client's behalf.
+/// The consumer gives each IPv4 network event the domain of its remote
+/// address with one lookup, the process's own resolution first.
+///
+/// Entries live in a fixed table like RateMonitor's: a key is found in a
+/// bounded probe of its bucket, and a new one reuses a free or expired
+/// entry or evicts the one that expires first. An entry is used for ttl_s
+/// after its response; ETW reports no record TTL, so one configured
+/// lifetime stands for all.
+///
+/// Queries are paired with their response in a second, smaller table keyed
+/// by (process, domain, type), so resolution latency costs a probe rather
+/// than a scan of recent events.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include "exeray/event/types.hpp"
+
+namespace exeray::etw {
+
+/// @brief Domain tracking settings.
+struct DomainMapConfig {
+    bool enabled = false;            ///< Track resolutions and enrich network events
+    std::size_t capacity = 16384;    ///< (process, address) resolutions kept
+    std::uint32_t ttl_s = 300;       ///< How long a resolution is used after its response
+    std::size_t max_pending = 4096;  ///< Queries awaiting their response
+};
+
+/// @brief What the map did in the current or last session.
+struct DomainMapStats {
+    std::uint64_t resolutions = 0;  ///< Addresses recorded from responses
+    std::uint64_t enriched = 0;     ///< Network events given a domain
+    std::uint64_t missed = 0;       ///< IPv4 network events no resolution matched
+    std::uint64_t evicted = 0;      ///< Unexpired resolutions pushed out by new ones
+    std::uint64_t paired = 0;       ///< Responses matched to their query
+    std::uint64_t unpaired = 0;     ///< Responses with no query seen
+    std::uint64_t tracked = 0;      ///< Resolutions in the table (expired ones until reused)
+};
+
+/**
+ * @brief Fixed-size table of resolved addresses with query/response pairing.
+ *
+ * Thread-safety: every member from any thread (both tables are sharded,
+ * each shard with its own mutex); clear() between sessions.
+ */
+class DomainMap {
+public:
+    static constexpr std::size_t kShards = 16;
+    static constexpr std::size_t kProbe = 8;  ///< Entries searched per key
+
+    explicit DomainMap(const DomainMapConfig& config = {});
+
+    DomainMap(const DomainMap&) = delete;
+    DomainMap& operator=(const DomainMap&) = delete;
+
+    /**
+     * @brief Note a query leaving, to be paired with its response.
+     * @param pid Process asking.
+     * @param domain Name queried.
+     * @param type DNS query type.
+     * @param at Event time (graph clock).
+     */
+    void query(std::uint32_t pid, event::StringId domain, std::uint16_t type,
+               event::Timestamp at);
+
+    /**
+     * @brief Record a response or failure.
+     * @param pid Process that asked.
+     * @param domain Name queried.
+     * @param type DNS query type.
+     * @param address Resolved IPv4 address in network byte order (0 = none).
+     * @param at Event time (graph clock).
+     * @return Time since the matching query (nullopt if none was seen).
+     */
+    std::optional<event::Timestamp> resolve(std::uint32_t pid, event::StringId domain,
+                                            std::uint16_t type, std::uint32_t address,
+                                            event::Timestamp at);
+
+    /**
+     * @brief Domain an IPv4 address was resolved from, for a process.
+     * @param pid Process connecting (its own resolution wins).
+     * @param address IPv4 address in network byte order.
+     * @param at Event time (graph clock); expired resolutions do not match.
+     * @return The domain, or INVALID_STRING (counted as missed).
+     */
+    [[nodiscard]] event::StringId lookup(std::uint32_t pid, std::uint32_t address,
+                                         event::Timestamp at);
+
+    [[nodiscard]] DomainMapStats stats() const;
+
+    /// @brief Forget every resolution and pending query (start of a session).
+    void clear();
+
+private:
+    struct Entry {
+        std::uint64_t key = 0;  ///< (pid << 32) | address; 0 = free
+        event::StringId domain = event::INVALID_STRING;
+        event::Timestamp expires = 0;
+    };
+
+    struct Pending {
+        std::uint32_t pid = 0;
+        event::StringId domain = event::INVALID_STRING;  ///< INVALID_STRING = free
+        std::uint16_t type = 0;
+        event::Timestamp at = 0;
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unique_ptr<Entry[]> entries;
+        std::unique_ptr<Pending[]> pending;
+        std::uint64_t resolutions = 0;
+        std::uint64_t enriched = 0;
+        std::uint64_t missed = 0;
+        std::uint64_t evicted = 0;
+        std::uint64_t paired = 0;
+        std::uint64_t unpaired = 0;
+    };
+
+    /// @brief Pending query of (pid, domain, type), or the entry to reuse for it.
+    Pending& pending(Shard& shard, std::uint32_t pid, event::StringId domain,
+                     std::uint16_t type) const;
+
+    void record(Shard& shard, std::uint64_t key, event::StringId domain, event::Timestamp at);
+    [[nodiscard]] event::StringId find(const Shard& shard, std::uint64_t key,
+                                       event::Timestamp at) const;
+
+    event::Timestamp ttl_;      ///< ns
+    std::size_t shard_size_;    ///< Entries per shard (multiple of kProbe)
+    std::size_t pending_size_;  ///< Pending queries per shard (multiple of kProbe)
+    std::array<Shard, kShards> shards_;
+};
+
+}  // namespace exeray::etw
@@ -15,6 +15,7 @@ namespace process {
     constexpr uint16_t START = 1;       ///< ProcessStart
     constexpr uint16_t STOP = 2;        ///< ProcessStop
     constexpr uint16_t IMAGE_LOAD = 5;  ///< ImageLoad
+    constexpr uint16_t RUNDOWN = 15;    ///< ProcessRundown (answer to a capture-state request)
 }  // namespace process
 
 /// Event IDs from Microsoft-Windows-Kernel-File provider.
@@ -28,8 +29,9 @@ namespace file {
 
 /// Event IDs from NT Kernel Logger Image class.
 namespace image {
-    constexpr uint16_t UNLOAD = 2;  ///< Image unloaded from process
-    constexpr uint16_t LOAD = 10;   ///< Image loaded into process
+    constexpr uint16_t UNLOAD = 2;    ///< Image unloaded from process
+    constexpr uint16_t DC_START = 3;  ///< Loaded image enumeration at start
+    constexpr uint16_t LOAD = 10;     ///< Image loaded into process
 }  // namespace image
 
 /// Event IDs from Microsoft-Windows-Kernel-Registry provider.
@@ -38,16 +40,21 @@ namespace registry {
     constexpr uint16_t OPEN_KEY = 2;      ///< OpenKey
     constexpr uint16_t SET_VALUE = 5;     ///< SetValue
     constexpr uint16_t VALUE_DELETE = 6;  ///< DeleteValue
+    constexpr uint16_t CLOSE_KEY = 13;    ///< CloseKey
 }  // namespace registry
 
 /// Event IDs from Microsoft-Windows-Kernel-Network provider.
 namespace network {
     constexpr uint16_t TCP_CONNECT = 10;   ///< TCP connect
     constexpr uint16_t TCP_ACCEPT = 11;    ///< TCP accept
+    constexpr uint16_t TCP_DISCONNECT = 13;  ///< TCP connection closed
     constexpr uint16_t TCP_SEND = 14;      ///< TCP send
     constexpr uint16_t TCP_RECEIVE = 15;   ///< TCP receive
     constexpr uint16_t UDP_SEND = 18;      ///< UDP send
     constexpr uint16_t UDP_RECEIVE = 19;   ///< UDP receive
+    constexpr uint16_t TCP_SEND_V6 = 26;        ///< TCP send over IPv6
+    constexpr uint16_t TCP_RECEIVE_V6 = 27;     ///< TCP receive over IPv6
+    constexpr uint16_t TCP_DISCONNECT_V6 = 29;  ///< TCP IPv6 connection closed
 }  // namespace network
 
 /// Event IDs from Thread_TypeGroup1 class.
@@ -87,6 +94,7 @@ namespace wmi {
 namespace security {
     constexpr uint16_t LOGON_SUCCESS = 4624;       ///< Successful logon
     constexpr uint16_t LOGON_FAILED = 4625;        ///< Failed logon attempt
+    constexpr uint16_t LOGOFF = 4634;              ///< Logon session ended
     constexpr uint16_t PROCESS_CREATE = 4688;      ///< New process created
     constexpr uint16_t PROCESS_EXIT = 4689;       ///< Process terminated
     constexpr uint16_t SERVICE_INSTALLED = 4697;  ///< Service installed
@@ -95,6 +103,7 @@ namespace security {
 
 /// Event IDs from Microsoft-Windows-DotNETRuntime provider.
 namespace clr {
+    constexpr uint16_t MODULE_LOAD = 151;          ///< Module loaded into an app domain
     constexpr uint16_t ASSEMBLY_LOAD_START = 152;  ///< Assembly load started
     constexpr uint16_t ASSEMBLY_LOAD_STOP = 153;   ///< Assembly load completed
     constexpr uint16_t ASSEMBLY_UNLOAD = 154;      ///< Assembly unloaded
@@ -105,6 +114,7 @@ namespace clr {
 namespace dns {
     constexpr uint16_t QUERY_COMPLETED = 3006;  ///< DNS query completed
     constexpr uint16_t QUERY_FAILED = 3008;     ///< DNS query failed
+    constexpr uint16_t QUERY_SENT = 3009;       ///< DNS query sent to the servers
 }  // namespace dns
 
 }  // namespace exeray::etw::ids
@@ -0,0 +1,137 @@
+/// @file event_layouts.hpp
+/// @brief Per-version UserData layouts of the events with hand-written parsers.
+///
+/// Each table lists the versions of one event whose fixed fields the fast
+/// parser reads, with their offsets. The parser selects the layout by the
+/// event's version at runtime; a version no table entry covers goes to the
+/// TDH path (a compiled DecodePlan) instead of being read at wrong offsets.
+///
+/// Supporting a new Windows build means adding an entry with the offsets
+/// from its manifest (`wevtutil gp <provider> /ge /gm` lists them).
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace exeray::etw::layouts {
+
+/// @brief Offset of a field: the pointers before it plus fixed bytes.
+struct FieldOffset {
+    std::uint8_t pointers = 0;
+    std::uint16_t bytes = 0;
+
+    [[nodiscard]] constexpr std::size_t at(std::size_t pointer_size) const noexcept {
+        return pointers * pointer_size + bytes;
+    }
+};
+
+/// @brief Fields of one layout, valid for versions [min_version, max_version].
+template <typename Fields>
+struct Versioned {
+    std::uint8_t min_version;
+    std::uint8_t max_version;
+    Fields fields;
+};
+
+/// @brief Layout for an event version, nullptr if no entry covers it.
+template <typename Fields, std::size_t N>
+[[nodiscard]] constexpr const Fields* select(const std::array<Versioned<Fields>, N>& table,
+                                             std::uint8_t version) noexcept {
+    for (const auto& entry : table) {
+        if (version >= entry.min_version && version <= entry.max_version) {
+            return &entry.fields;
+        }
+    }
+    return nullptr;
+}
+
+/// @brief Kernel-Process ProcessStart (event 1).
+///
+/// UniqueProcessKey: PVOID, ProcessId, ParentId, SessionId: UINT32,
+/// ExitStatus: INT32, DirectoryTableBase: PVOID, Flags: UINT32, then
+/// UserSID, ImageFileName (ANSI) and CommandLine (UTF-16).
+struct ProcessStart {
+    FieldOffset process_id;
+    FieldOffset parent_id;
+    FieldOffset user_sid;  ///< First variable-length field
+};
+
+inline constexpr std::array<Versioned<ProcessStart>, 1> kProcessStart = {{
+    {0, 0xFF, {{1, 0}, {1, 4}, {2, 20}}},
+}};
+
+/// @brief Kernel-Process ProcessRundown (event 15).
+///
+/// ProcessID: UINT32, CreateTime: FILETIME, ParentProcessID, SessionID,
+/// Flags: UINT32, then ImageName (UTF-16).
+struct ProcessRundown {
+    FieldOffset process_id;
+    FieldOffset parent_id;
+    FieldOffset image_name;  ///< First variable-length field
+};
+
+inline constexpr std::array<Versioned<ProcessRundown>, 1> kProcessRundown = {{
+    {0, 0xFF, {{0, 0}, {0, 12}, {0, 24}}},
+}};
+
+/// @brief Kernel-File Create (event 10).
+///
+/// Irp, FileObject: PVOID, TTID, CreateOptions, FileAttributes,
+/// ShareAccess: UINT32, then OpenPath (UTF-16).
+struct FileCreate {
+    FieldOffset attributes;
+    FieldOffset open_path;  ///< First variable-length field
+};
+
+inline constexpr std::array<Versioned<FileCreate>, 1> kFileCreate = {{
+    {0, 0xFF, {{2, 8}, {2, 16}}},
+}};
+
+/// @brief Kernel-Network TCP connect and accept (events 10, 11), IPv4.
+///
+/// ProcessId: UINT32, AddressFamily: UINT16, LocalAddr: 4 bytes,
+/// LocalPort: UINT16, RemoteAddr: 4 bytes, RemotePort: UINT16.
+struct TcpConnect {
+    FieldOffset process_id;
+    FieldOffset address_family;
+    FieldOffset local_addr;
+    FieldOffset local_port;
+    FieldOffset remote_addr;
+    FieldOffset remote_port;
+    std::uint16_t size;  ///< Bytes up to the end of RemotePort
+};
+
+inline constexpr std::array<Versioned<TcpConnect>, 1> kTcpConnect = {{
+    {0, 0xFF, {{0, 0}, {0, 4}, {0, 6}, {0, 10}, {0, 12}, {0, 16}, 18}},
+}};
+
+/// @brief The same events with AddressFamily AF_INET6: 16-byte addresses.
+inline constexpr std::array<Versioned<TcpConnect>, 1> kTcpConnect6 = {{
+    {0, 0xFF, {{0, 0}, {0, 4}, {0, 6}, {0, 22}, {0, 24}, {0, 40}, 42}},
+}};
+
+/// @brief Kernel-Network TCP send, receive and disconnect (events 13-15), IPv4.
+///
+/// PID, size: UINT32, daddr, saddr: 4 bytes, dport, sport: UINT16, then
+/// fields no parser reads.
+struct TcpTransfer {
+    FieldOffset bytes;
+    FieldOffset remote_addr;
+    FieldOffset local_addr;
+    FieldOffset remote_port;
+    FieldOffset local_port;
+    std::uint16_t size;  ///< Bytes up to the end of sport
+};
+
+inline constexpr std::array<Versioned<TcpTransfer>, 1> kTcpTransfer = {{
+    {0, 0xFF, {{0, 4}, {0, 8}, {0, 12}, {0, 16}, {0, 18}, 20}},
+}};
+
+/// @brief IPv6 send, receive and disconnect (events 26, 27, 29): 16-byte addresses.
+inline constexpr std::array<Versioned<TcpTransfer>, 1> kTcpTransfer6 = {{
+    {0, 0xFF, {{0, 4}, {0, 8}, {0, 24}, {0, 40}, {0, 42}, 44}},
+}};
+
+}  // namespace exeray::etw::layouts
@@ -0,0 +1,117 @@
+#pragma once
+
+/// @file file_map.hpp
+/// @brief Path and opener of every open file object, for file I/O events.
+///
+/// Kernel file Read, Write and Cleanup events name the file by its
+/// FileObject pointer only. The File parser records the path node and the
+/// opening process of each object created here, and the I/O events that
+/// follow take both from one lookup; Cleanup drops the object.
+///
+/// Like KeyMap, the table is fixed-size and set-associative, but a slot
+/// holds the full object pointer next to the packed path and PID, so a hit
+/// is exact. Lookups are wait-free, at most kWays slots of one cache line;
+/// a full bucket evicts a slot, and a miss leaves the event unnamed.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "exeray/event/types.hpp"
+
+namespace exeray::etw {
+
+/**
+ * @brief Bounded FileObject -> (path, PID) cache.
+ *
+ * Thread-safety: every member but clear() may run concurrently; racing
+ * writers of one bucket may drop an entry, which only costs a miss.
+ * clear() must not run alongside any other member.
+ */
+class FileMap {
+public:
+    static constexpr std::size_t kWays = 4;  ///< Slots per bucket (one cache line)
+    static constexpr std::size_t kBuckets = 16384;
+
+    /// @brief What an open file object refers to.
+    struct Entry {
+        event::StringId path = event::INVALID_STRING;  ///< INVALID_STRING = unknown object
+        std::uint32_t pid = 0;                          ///< Process that opened it
+    };
+
+    FileMap();
+    FileMap(const FileMap&) = delete;
+    FileMap& operator=(const FileMap&) = delete;
+
+    /// @brief file_object was opened as path by pid (replaces an older entry).
+    void insert(std::uint64_t file_object, event::StringId path, std::uint32_t pid);
+
+    /// @brief file_object was cleaned up.
+    void erase(std::uint64_t file_object);
+
+    /// @brief Entry of file_object (wait-free); path INVALID_STRING if unknown.
+    [[nodiscard]] Entry find(std::uint64_t file_object) const noexcept {
+        if (file_object == 0) {
+            return {};
+        }
+        const Bucket& bucket = buckets_[index(file_object)];
+        for (const Slot& slot : bucket.slots) {
+            if (slot.object.load(std::memory_order_acquire) != file_object) {
+                continue;
+            }
+            const std::uint64_t value = slot.value.load(std::memory_order_acquire);
+            // Re-check: the slot may have been handed to another object
+            if (slot.object.load(std::memory_order_acquire) == file_object) {
+                return {static_cast<event::StringId>(value >> 32),
+                        static_cast<std::uint32_t>(value)};
+            }
+        }
+        return {};
+    }
+
+    /// @brief Call fn(StringId) with the path of every mapped object, e.g.
+    /// to keep them through a string compaction.
+    template <typename F>
+    void for_each_path(F&& fn) const {
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            for (const Slot& slot : buckets_[i].slots) {
+                const std::uint64_t value = slot.value.load(std::memory_order_acquire);
+                if (value != 0) {
+                    fn(static_cast<event::StringId>(value >> 32));
+                }
+            }
+        }
+    }
+
+    /// @brief Objects currently mapped.
+    [[nodiscard]] std::size_t size() const noexcept {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    void clear();
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> object{0};  ///< 0 = empty
+        std::atomic<std::uint64_t> value{0};   ///< path << 32 | pid, 0 while being written
+    };
+
+    struct alignas(64) Bucket {
+        Slot slots[kWays];
+    };
+
+    static constexpr std::size_t index(std::uint64_t object) noexcept {
+        // File objects are 16-byte aligned; fold the high bits down
+        object *= 0x9E3779B97F4A7C15ULL;
+        return static_cast<std::size_t>(object >> 40) % kBuckets;
+    }
+
+    std::unique_ptr<Bucket[]> buckets_;
+    std::atomic<std::size_t> size_{0};
+};
+
+/// @brief Map fed and read by the File parser.
+FileMap& file_map();
+
+}  // namespace exeray::etw
@@ -0,0 +1,131 @@
+#pragma once
+
+/// @file flow_table.hpp
+/// @brief Per-connection aggregation of network transfers.
+///
+/// Every TCP send and receive is its own ETW event, and for a download they
+/// outnumber everything else the target does. FlowTable folds them into one
+/// record per flow (5-tuple and process) and lets the consumer store only
+/// what the graph needs: connects and closes, the first transfer of a flow
+/// in each direction, and a summary per direction once every
+/// summary_interval_ms carrying the bytes absorbed since the last one. The
+/// bytes of a flow's stored events therefore still add up to its total, and
+/// the exact per-flow counters are available from flows().
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "exeray/event/payload.hpp"
+#include "exeray/event/types.hpp"
+
+namespace exeray::etw {
+
+/// @brief Aggregation settings.
+struct FlowConfig {
+    bool enabled = true;                     ///< Store every transfer individually if false
+    std::uint32_t summary_interval_ms = 1000;  ///< 0 = summaries only on close
+};
+
+/// @brief Process and 5-tuple of one flow, addresses as NetworkPayload has them.
+struct FlowKey {
+    std::uint32_t pid = 0;
+    std::uint32_t local_addr = 0;
+    std::uint32_t remote_addr = 0;
+    std::uint16_t local_port = 0;
+    std::uint16_t remote_port = 0;
+    std::uint8_t protocol = 0;
+    std::uint8_t family = 0;  ///< NetworkPayload::family
+
+    bool operator==(const FlowKey&) const = default;
+};
+
+/// @brief Counters of one open flow.
+struct FlowRecord {
+    FlowKey key;
+    std::uint64_t bytes_sent = 0;
+    std::uint64_t bytes_received = 0;
+    std::uint64_t packets_sent = 0;
+    std::uint64_t packets_received = 0;
+    event::Timestamp first_seen = 0;
+    event::Timestamp last_seen = 0;
+};
+
+/// @brief What the table did with the transfers it saw.
+struct FlowStats {
+    std::uint64_t flows = 0;       ///< Flows open now
+    std::uint64_t absorbed = 0;    ///< Transfers folded into a flow, not stored
+    std::uint64_t summaries = 0;   ///< Transfers stored as a periodic summary
+    std::uint64_t overflowed = 0;  ///< Transfers stored as is because the table was full
+};
+
+/**
+ * @brief Flow table shared by the consumer shards.
+ *
+ * Bounded to kMaxFlows open flows; transfers of flows beyond that are kept
+ * unaggregated. A flow ends at its close event or at clear().
+ *
+ * Thread-safety: admit(), flows() and stats() from any thread (the flows
+ * are sharded by key, each shard with its own mutex); clear() between
+ * sessions.
+ */
+class FlowTable {
+public:
+    static constexpr std::size_t kShards = 16;
+    static constexpr std::size_t kMaxFlows = 65536;
+
+    explicit FlowTable(const FlowConfig& config = {});
+
+    FlowTable(const FlowTable&) = delete;
+    FlowTable& operator=(const FlowTable&) = delete;
+
+    /**
+     * @brief Account one parsed event and decide whether it is stored.
+     * @param pid Process the event belongs to.
+     * @param payload Event payload; for a summary or a close, bytes is
+     *        rewritten to the bytes absorbed since the last stored event.
+     * @param operation NetworkOp code.
+     * @param at Event time (graph clock).
+     * @return false if the event was absorbed into its flow.
+     */
+    [[nodiscard]] bool admit(std::uint32_t pid, event::EventPayload& payload,
+                             std::uint8_t operation, event::Timestamp at);
+
+    /// @brief Open flows of pid (0 = every process), in no particular order.
+    [[nodiscard]] std::vector<FlowRecord> flows(std::uint32_t pid = 0) const;
+
+    [[nodiscard]] FlowStats stats() const noexcept;
+
+    /// @brief Forget every flow and zero the counters (start of a session).
+    void clear();
+
+private:
+    struct KeyHash {
+        std::size_t operator()(const FlowKey& key) const noexcept;
+    };
+
+    struct Flow {
+        FlowRecord record;
+        std::array<std::uint64_t, 2> unreported{};      ///< Bytes since the last stored event
+        std::array<event::Timestamp, 2> reported_at{};  ///< Last stored event; 0 = none yet
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<FlowKey, Flow, KeyHash> flows;
+    };
+
+    static constexpr std::size_t kMaxFlowsPerShard = kMaxFlows / kShards;
+
+    event::Timestamp interval_;  ///< Summary interval in ns; 0 = off
+    std::array<Shard, kShards> shards_;
+    std::atomic<std::uint64_t> absorbed_{0};
+    std::atomic<std::uint64_t> summaries_{0};
+    std::atomic<std::uint64_t> overflowed_{0};
+};
+
+}  // namespace exeray::etw
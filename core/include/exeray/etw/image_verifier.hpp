@@ -0,0 +1,195 @@
+#pragma once
+
+/// @file image_verifier.hpp
+/// @brief SHA-256 and Authenticode verdicts for loaded images, off the ingest path.
+///
+/// Image load events carry only a path. Hashing and verifying the file on
+/// the consumer thread would stall ETW delivery, so the consumer only asks
+/// ImageVerifier::attach(): an image already resolved this session gets its
+/// verdict record's ExtensionId on the spot, one never seen is queued for
+/// pool workers. A worker opens the file, checks the persistent cache by
+/// (path, file ID, last write time) and hashes and verifies it only on a
+/// miss, then stores one ImageVerdictExtension per image and points the
+/// events pushed meanwhile at it with EventGraph::set_extension().
+///
+/// The persistent cache is keyed by the path's text rather than its
+/// StringId, which is only valid within a session; load() and save() carry
+/// it across runs, so hot system DLLs are hashed once per file version.
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+
+#include "exeray/event/extensions.hpp"
+#include "exeray/event/types.hpp"
+
+namespace exeray::event {
+class EventGraph;
+struct EventPayload;
+class StringPool;
+}  // namespace exeray::event
+
+namespace exeray::etw {
+
+/// @brief "EXIV" in the first four bytes of an image cache file.
+inline constexpr std::uint32_t kImageCacheMagic = 0x56495845;
+
+/// @brief Bumped whenever the cache record layout changes.
+inline constexpr std::uint32_t kImageCacheFormat = 1;
+
+/// @brief Filesystem path of an image path as events carry it; NT device
+/// paths open through the object manager root on Windows.
+[[nodiscard]] std::filesystem::path image_file_path(std::string_view text);
+
+/// @brief SHA-256 digest of a buffer.
+[[nodiscard]] std::array<std::uint8_t, 32> sha256(std::span<const std::uint8_t> data) noexcept;
+
+/// @brief Image verification settings.
+struct ImageVerifyConfig {
+    bool enabled = false;                            ///< Hash loaded images at all
+    bool signatures = true;                          ///< Check Authenticode (Windows only)
+    std::size_t workers = 1;                         ///< Pool tasks hashing at once
+    std::uint64_t max_bytes = 256ULL * 1024 * 1024;  ///< Larger files are not hashed
+};
+
+/// @brief What the verifier did in the current or last session.
+struct ImageVerifyStats {
+    std::uint64_t images = 0;      ///< Distinct image paths seen
+    std::uint64_t hashed = 0;      ///< Files hashed (cache misses)
+    std::uint64_t cached = 0;      ///< Files answered by the persistent cache
+    std::uint64_t unreadable = 0;  ///< Files that could not be opened or were too large
+    std::uint64_t attached = 0;    ///< Events given their verdict at ingest
+    std::uint64_t backfilled = 0;  ///< Events given their verdict after the push
+};
+
+/**
+ * @brief Resolves each distinct image path once per session, on pool workers.
+ *
+ * Thread-safety: attach() and stats() from any thread (path lookups are
+ * sharded, each shard with its own mutex); start(), stop(), load() and
+ * save() from the thread controlling the session.
+ */
+class ImageVerifier {
+public:
+    /// @brief Runs a task on a pool worker.
+    using Submit = std::function<void(std::function<void()>)>;
+
+    static constexpr std::size_t kShards = 16;
+
+    /// Queued images a worker resolves before it backfills their events.
+    static constexpr std::size_t kBatch = 64;
+
+    explicit ImageVerifier(const ImageVerifyConfig& config = {});
+    ~ImageVerifier();
+
+    ImageVerifier(const ImageVerifier&) = delete;
+    ImageVerifier& operator=(const ImageVerifier&) = delete;
+
+    /// @brief Read the persistent cache of an earlier run (false if missing or invalid).
+    bool load(const std::filesystem::path& path);
+
+    /// @brief Write the persistent cache, including what this session hashed.
+    bool save(const std::filesystem::path& path) const;
+
+    /**
+     * @brief Begin resolving the images of the events pushed from now on.
+     * @param graph Graph the events are pushed to.
+     * @param strings Pool resolving image paths; must outlive stop().
+     * @param extensions Store the verdict records go to; must outlive stop().
+     * @param submit Hands a task to the pool.
+     */
+    void start(event::EventGraph& graph, const event::StringPool& strings,
+               event::ExtensionStore& extensions, Submit submit);
+
+    /// @brief Whether start() was called without a matching stop().
+    [[nodiscard]] bool running() const noexcept {
+        return running_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Give an image load event its verdict, or queue its image.
+     *
+     * Called by the consumer before the push. Events of an image still
+     * queued are pushed without a verdict and backfilled by the worker.
+     */
+    void attach(event::EventPayload& payload);
+
+    /// @brief Wait for the workers, resolve what is left on this thread and
+    /// backfill every event still without its verdict.
+    void stop();
+
+    /// @brief Verdict record of an image path this session (NO_EXTENSION = none yet).
+    [[nodiscard]] event::ExtensionId verdict(event::StringId path) const;
+
+    [[nodiscard]] ImageVerifyStats stats() const noexcept;
+
+private:
+    /// @brief Identity of one version of a file on disk.
+    struct FileKey {
+        std::uint64_t path = 0;     ///< Hash of the lowercased path text
+        std::uint64_t file_id = 0;  ///< Volume and file index
+        std::int64_t written = 0;   ///< Last write time (platform ticks)
+
+        bool operator==(const FileKey&) const = default;
+    };
+
+    struct FileKeyHash {
+        std::size_t operator()(const FileKey& key) const noexcept {
+            return static_cast<std::size_t>(key.path ^ (key.file_id * 0x9E3779B97F4A7C15ULL) ^
+                                            static_cast<std::uint64_t>(key.written));
+        }
+    };
+
+    struct alignas(64) PathShard {
+        mutable std::mutex mutex;
+        /// NO_EXTENSION while queued
+        std::unordered_map<event::StringId, event::ExtensionId> paths;
+    };
+
+    /// @brief Claim and resolve batches until the queue is empty (pool worker).
+    void run();
+
+    /// @brief Resolve up to kBatch queued images; false if the queue was empty.
+    bool resolve_batch();
+
+    /// @brief Hash and verify one image, or take it from the cache.
+    [[nodiscard]] event::ImageVerdictExtension resolve(event::StringId path);
+
+    /// @brief Point the events of the resolved paths that lack a verdict at it.
+    void backfill(const std::unordered_map<event::StringId, event::ExtensionId>& resolved);
+
+    ImageVerifyConfig config_;
+    event::EventGraph* graph_ = nullptr;
+    const event::StringPool* strings_ = nullptr;
+    event::ExtensionStore* extensions_ = nullptr;
+    Submit submit_;
+
+    std::array<PathShard, kShards> paths_;
+
+    mutable std::mutex cache_mutex_;
+    std::unordered_map<FileKey, event::ImageVerdictExtension, FileKeyHash> cache_;
+
+    std::atomic<bool> running_{false};
+    std::mutex mutex_;
+    std::condition_variable idle_;
+    std::deque<event::StringId> queue_;  ///< Paths waiting for a worker (mutex_)
+    std::size_t active_ = 0;             ///< Tasks submitted and not finished (mutex_)
+
+    std::atomic<std::uint64_t> images_{0};
+    std::atomic<std::uint64_t> hashed_{0};
+    std::atomic<std::uint64_t> cached_{0};
+    std::atomic<std::uint64_t> unreadable_{0};
+    std::atomic<std::uint64_t> attached_{0};
+    std::atomic<std::uint64_t> backfilled_{0};
+};
+
+}  // namespace exeray::etw
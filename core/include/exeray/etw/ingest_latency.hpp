@@ -0,0 +1,146 @@
+#pragma once
+
+/// @file ingest_latency.hpp
+/// @brief Age of events when they reach the consumer and the graph.
+///
+/// Shows how stale the data on screen is. An event is as old as the
+/// graph-clock time since its EVENT_HEADER::TimeStamp. Its age is
+/// sampled twice: at callback entry (ETW buffering and delivery) and
+/// when the push that makes it visible in the EventGraph returns (adds the
+/// record ring, parsing, batching and the shard merger). With detection
+/// off the ingest path (see DetectionStage) a third age is taken when an
+/// event's rules and indicators have been checked. Ages go into
+/// log-linear histograms per stage and category: 16 sub-buckets per power
+/// of two, so a percentile is exact to 1/16 of its value.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "exeray/event/graph.hpp"
+#include "exeray/event/types.hpp"
+
+namespace exeray::etw {
+
+/// @brief Where along the ingest path an event's age is taken.
+enum class LatencyStage : std::uint8_t {
+    Delivered,  ///< ETW timestamp -> record callback entry
+    Visible,    ///< ETW timestamp -> EventGraph push returned
+    Detected,   ///< ETW timestamp -> DetectionStage verdict stored
+
+    Count  ///< Sentinel (not a stage)
+};
+
+/// @brief Number of LatencyStage values.
+inline constexpr std::size_t kLatencyStages = static_cast<std::size_t>(LatencyStage::Count);
+
+/// @brief Percentiles of one histogram, in nanoseconds.
+struct LatencySummary {
+    std::uint64_t count = 0;
+    std::uint64_t p50 = 0;
+    std::uint64_t p99 = 0;
+    std::uint64_t p999 = 0;
+    std::uint64_t max = 0;  ///< Upper bound of the highest bucket in use
+};
+
+/**
+ * @brief Log-linear histogram of nanosecond durations.
+ *
+ * Values below 16 ns are counted exactly. Above that each power of two is
+ * split into 16 buckets, up to 2^40 ns (about 18 minutes). Larger values
+ * go in the last bucket.
+ *
+ * Thread-safety: record() from any number of threads (relaxed atomics);
+ * readers may miss in-flight records.
+ */
+class LatencyHistogram {
+public:
+    static constexpr unsigned kSubBits = 4;
+    static constexpr std::size_t kSubBuckets = std::size_t{1} << kSubBits;
+    static constexpr unsigned kMaxMagnitude = 40;
+    static constexpr std::size_t kBuckets =
+        kSubBuckets + (kMaxMagnitude - kSubBits + 1) * kSubBuckets;
+
+    void record(std::uint64_t ns) noexcept {
+        buckets_[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// @brief Add another histogram's counts (e.g. across categories).
+    void merge(const LatencyHistogram& other) noexcept;
+
+    [[nodiscard]] std::uint64_t count() const noexcept;
+
+    /**
+     * @brief Smallest value that at least a fraction of all samples is at or below.
+     * @param quantile Fraction in [0, 1] (0.99 = p99).
+     * @return Upper bound of the bucket reached, 0 if empty.
+     */
+    [[nodiscard]] std::uint64_t percentile(double quantile) const noexcept;
+
+    /// @brief p50, p99, p999 and max in one pass.
+    [[nodiscard]] LatencySummary summary() const noexcept;
+
+    void reset() noexcept;
+
+    [[nodiscard]] static std::size_t bucket_of(std::uint64_t ns) noexcept;
+
+    /// @brief Largest value counted in a bucket.
+    [[nodiscard]] static std::uint64_t upper_bound(std::size_t bucket) noexcept;
+
+private:
+    std::array<std::atomic<std::uint64_t>, kBuckets> buckets_{};
+};
+
+/**
+ * @brief Age histograms per stage and category, plus every-N sampling.
+ *
+ * Callers keep a tick counter per thread. Only every kSampleEvery-th event
+ * per counter is recorded, which keeps the cost to a clock read per
+ * sampled record or per pushed batch.
+ *
+ * Thread-safety: as LatencyHistogram; reset() while nothing records.
+ */
+class IngestLatency {
+public:
+    /// Record one event in this many.
+    static constexpr std::uint32_t kSampleEvery = 8;
+
+    /// @brief Current graph time (steady_clock ns), the clock ages are taken in.
+    [[nodiscard]] static event::Timestamp now() noexcept {
+        return static_cast<event::Timestamp>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /// @brief Advance a tick counter; true for the events to sample.
+    [[nodiscard]] static bool due(std::uint32_t& tick) noexcept {
+        return tick++ % kSampleEvery == 0;
+    }
+
+    /**
+     * @brief Record the age of one event.
+     * @param timestamp Event time (graph clock).
+     * @param now Time at the stage (graph clock); earlier times count as 0.
+     */
+    void record(LatencyStage stage, event::Category category, event::Timestamp timestamp,
+                event::Timestamp now) noexcept;
+
+    /// @brief Record the sampled events of a batch that became visible at now.
+    void record_visible(std::span<const event::PendingEvent> events, event::Timestamp now,
+                        std::uint32_t& tick) noexcept;
+
+    /// @param category Category, or Category::Count for all categories.
+    [[nodiscard]] LatencySummary summary(LatencyStage stage, event::Category category) const noexcept;
+
+    void reset() noexcept;
+
+private:
+    static constexpr std::size_t kCategories = static_cast<std::size_t>(event::Category::Count);
+
+    std::array<std::array<LatencyHistogram, kCategories>, kLatencyStages> histograms_{};
+};
+
+}  // namespace exeray::etw
@@ -0,0 +1,80 @@
+#pragma once
+
+/// @file io_coalescer.hpp
+/// @brief Merging of consecutive reads or writes of one open file.
+///
+/// A process streaming a file issues one ETW read or write per I/O, and each
+/// would become its own near-identical node. The consumer offers every file
+/// event to its IoCoalescer: a read or write opens a run for its process
+/// and file object, and the following ones of the same kind within the
+/// window are added to it (FilePayload::size summed, FilePayload::ops
+/// counted) instead of being stored. The run is released as one event, with
+/// the time of its first I/O, when another operation on the same file
+/// object arrives (the cleanup of its handle in particular, so the close
+/// still follows the I/O), when the window has passed, or at session end.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "exeray/event/graph.hpp"
+#include "exeray/event/types.hpp"
+
+namespace exeray::etw {
+
+/**
+ * @brief Open runs of file I/O of one consumer.
+ *
+ * Bounded to kMaxRuns runs; starting another releases the oldest. Events
+ * flagged Suspicious are never merged.
+ *
+ * Thread-safety: none; one per consumer thread (ConsumerContext).
+ */
+class IoCoalescer {
+public:
+    static constexpr std::size_t kMaxRuns = 256;
+
+    /// @brief Longest a run may span (ns); 0 turns coalescing off.
+    void set_window(event::Timestamp window) noexcept { window_ = window; }
+
+    [[nodiscard]] bool enabled() const noexcept { return window_ != 0; }
+
+    /**
+     * @brief Take a file event into a run, or release what must precede it.
+     * @param event Event as it would be stored.
+     * @param object Kernel FileObject of the event (0 = unknown).
+     * @param out Receives released runs, in the order they must be stored.
+     * @return true if the event was taken; false if the caller stores it
+     *         (after what was appended to out).
+     */
+    bool offer(const event::PendingEvent& event, std::uint64_t object,
+               std::vector<event::PendingEvent>& out);
+
+    /// @brief Release runs that started more than the window before now.
+    void expire(event::Timestamp now, std::vector<event::PendingEvent>& out);
+
+    /// @brief Release every run (end of the session).
+    void release_all(std::vector<event::PendingEvent>& out);
+
+    /// @brief Runs currently held.
+    [[nodiscard]] std::size_t held() const noexcept { return runs_.size(); }
+
+    /// @brief I/O operations added to a run instead of being stored.
+    [[nodiscard]] std::uint64_t merged() const noexcept { return merged_; }
+
+private:
+    struct Run {
+        std::uint32_t pid;
+        std::uint64_t object;
+        event::PendingEvent event;
+    };
+
+    /// @brief Append runs_[index] to out and drop it.
+    void release(std::size_t index, std::vector<event::PendingEvent>& out);
+
+    event::Timestamp window_ = 0;
+    std::vector<Run> runs_;  ///< Oldest first
+    std::uint64_t merged_ = 0;
+};
+
+}  // namespace exeray::etw
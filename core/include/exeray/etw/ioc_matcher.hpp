@@ -0,0 +1,184 @@
+#pragma once
+
+/// @file ioc_matcher.hpp
+/// @brief Matching of events against threat-intelligence indicator lists.
+///
+/// Indicator (IOC) lists run to millions of domains, paths and addresses,
+/// nearly all of which an event does not match. Each list kind is loaded
+/// once into an immutable IocSet: a cache-line-blocked Bloom filter in front
+/// rejects a miss with one memory access, and an open-addressed table of
+/// 64-bit fingerprints behind it confirms a hit and names the list. Both are
+/// read without locks. IocMatcher further remembers the verdict per
+/// interned string, so a path seen on every file event is tested once.
+///
+/// List files are text, one indicator per line:
+/// @code
+/// # '#' starts a comment line
+/// evil.example.com        (Domain: also matches its subdomains)
+/// C:\Users\Public\x.exe   (Path: the whole path, ignoring case)
+/// mimikatz.exe            (Path without a separator: any file of that name)
+/// 203.0.113.7             (Address: dotted IPv4)
+/// 2001:DB8::7             (Address: IPv6 in any text form)
+/// @endcode
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "exeray/event/payload.hpp"
+#include "exeray/event/types.hpp"
+
+namespace exeray::event {
+class StringPool;
+}  // namespace exeray::event
+
+namespace exeray::etw {
+
+/// @brief What the indicators of a list are matched against.
+enum class IocKind : std::uint8_t {
+    Domain,   ///< DNS query names
+    Path,     ///< File, image and process executable paths
+    Address,  ///< Network remote addresses and resolved DNS addresses
+    Count
+};
+
+/// @brief One indicator list; entries and the file are both loaded.
+struct IocList {
+    std::string name;              ///< Reported in IocStats
+    IocKind kind = IocKind::Domain;
+    std::vector<std::string> entries;
+    std::string file;              ///< Text file, one indicator per line (empty = none)
+};
+
+struct IocConfig {
+    bool enabled = false;
+    std::vector<IocList> lists;
+};
+
+/// @brief Indicators loaded and events matched for one list.
+struct IocStats {
+    std::string name;
+    IocKind kind = IocKind::Domain;
+    std::uint64_t entries = 0;  ///< Indicators loaded (duplicates included)
+    std::uint64_t rejected = 0; ///< Lines that are not a valid indicator
+    std::uint64_t hits = 0;     ///< Events matched since the last reset()
+};
+
+/**
+ * @brief Immutable set of indicator fingerprints, each tagged with its list.
+ *
+ * Fingerprints are 64-bit hashes of the normalized indicator, so a match
+ * is exact up to hash collisions (about one in 2^64 per lookup). An
+ * indicator in several lists is reported for the first one.
+ */
+class IocSet {
+public:
+    /// @brief Source of the fingerprints and list indices to load.
+    struct Item {
+        std::uint64_t key = 0;
+        std::uint32_t list = 0;
+    };
+
+    IocSet() = default;
+    explicit IocSet(const std::vector<Item>& items);
+
+    [[nodiscard]] bool empty() const noexcept { return table_.empty(); }
+
+    /// @brief List of the indicator with this fingerprint, if loaded.
+    [[nodiscard]] std::optional<std::uint32_t> find(std::uint64_t key) const noexcept;
+
+private:
+    struct Slot {
+        std::uint64_t key = 0;  ///< 0 = empty
+        std::uint32_t list = 0;
+    };
+
+    struct alignas(64) Block {
+        std::array<std::uint64_t, 8> bits{};
+    };
+
+    [[nodiscard]] bool may_contain(std::uint64_t key) const noexcept;
+
+    std::vector<Block> filter_;  ///< Size a power of two
+    std::vector<Slot> table_;    ///< Size a power of two, at most half full
+};
+
+/**
+ * @brief Matches event payloads against the configured IOC lists.
+ *
+ * Thread-safety: match() and the match_* functions from any thread once
+ * constructed; reset() only while no thread is matching.
+ */
+class IocMatcher {
+public:
+    /// @brief Loads every list; an unreadable file is logged and skipped.
+    explicit IocMatcher(const IocConfig& config = {});
+    ~IocMatcher();
+
+    IocMatcher(const IocMatcher&) = delete;
+    IocMatcher& operator=(const IocMatcher&) = delete;
+
+    /// @brief Whether no indicator was loaded (match() then never hits).
+    [[nodiscard]] bool empty() const noexcept;
+
+    /// @brief Fingerprint of an indicator as stored in the lists of kind.
+    [[nodiscard]] static std::uint64_t key(IocKind kind, std::string_view indicator) noexcept;
+
+    /// @brief Dotted IPv4 as the payloads store it: first octet in the lowest byte.
+    [[nodiscard]] static std::optional<std::uint32_t> parse_address(std::string_view text) noexcept;
+
+    /// @brief List containing the domain or one of its parent domains.
+    [[nodiscard]] std::optional<std::size_t> match_domain(std::string_view domain) const noexcept;
+
+    /// @brief List containing the path, or its file name as a bare name.
+    [[nodiscard]] std::optional<std::size_t> match_path(std::string_view path) const noexcept;
+
+    [[nodiscard]] std::optional<std::size_t> match_address(std::uint32_t address) const noexcept;
+
+    /// @brief List containing an IPv6 address given in canonical text
+    /// (format_ipv6(), as the network payloads intern it).
+    [[nodiscard]] std::optional<std::size_t> match_ipv6(std::string_view canonical) const noexcept;
+
+    /**
+     * @brief Test the domain, path or address fields of one event.
+     *
+     * String verdicts are remembered per StringId, so the pool must be the
+     * one of the current session (see reset()). A hit is counted for its list.
+     *
+     * @return Index of the matching list in IocConfig::lists.
+     */
+    std::optional<std::size_t> match(const event::EventPayload& payload,
+                                     const event::StringPool& strings) noexcept;
+
+    /// @brief Per-list counters, in list order.
+    [[nodiscard]] std::vector<IocStats> stats() const;
+
+    /// @brief Zero the hit counters and forget remembered verdicts (start of a session).
+    void reset() noexcept;
+
+private:
+    static constexpr std::size_t kMemoSlots = 8192;
+
+    /// @brief Remembered verdicts of one string kind; slot word is
+    /// (StringId << 32) | (list + 1), or 0 in the low half for no match.
+    using Memo = std::array<std::atomic<std::uint64_t>, kMemoSlots>;
+
+    std::optional<std::size_t> match_string(IocKind kind, event::StringId id,
+                                            const event::StringPool& strings) noexcept;
+
+    std::optional<std::size_t> hit(std::optional<std::size_t> list) noexcept;
+
+    std::vector<IocStats> lists_;
+    std::array<IocSet, static_cast<std::size_t>(IocKind::Count)> sets_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> hits_;
+    std::unique_ptr<Memo> domains_;
+    std::unique_ptr<Memo> paths_;
+};
+
+}  // namespace exeray::etw
@@ -0,0 +1,47 @@
+#pragma once
+
+/// @file ip_address.hpp
+/// @brief IPv6 addresses as the network payloads store them.
+///
+/// NetworkPayload has room for an IPv4 address only, and EventNode stays a
+/// cache line. An IPv6 address is therefore interned in the StringPool in
+/// its canonical text form (RFC 5952) and the payload keeps the StringId,
+/// marked by NetworkPayload::family. Repeated addresses, the common case
+/// for a flow, dedupe to one pool entry; IOC lists compare the same text.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "exeray/event/types.hpp"
+
+namespace exeray::event {
+class StringPool;
+}  // namespace exeray::event
+
+namespace exeray::etw {
+
+/// @brief Address in network byte order.
+using Ipv6Address = std::array<std::uint8_t, 16>;
+
+/// @brief Longest canonical text ("ffff:...:ffff" or an IPv4-mapped form).
+inline constexpr std::size_t kMaxIpv6Text = 45;
+
+/**
+ * @brief Canonical text of an address: lowercase hex without leading
+ * zeros, the longest run of two or more zero groups as "::" and IPv4-mapped
+ * addresses as ::ffff:a.b.c.d.
+ * @param out Buffer the returned view points into.
+ */
+[[nodiscard]] std::string_view format_ipv6(const Ipv6Address& address,
+                                           std::array<char, kMaxIpv6Text + 1>& out) noexcept;
+
+/// @brief Address from any RFC 4291 text form; nullopt if malformed.
+[[nodiscard]] std::optional<Ipv6Address> parse_ipv6(std::string_view text) noexcept;
+
+/// @brief Intern the canonical text of an address (INVALID_STRING if strings is null).
+[[nodiscard]] event::StringId intern_ipv6(const Ipv6Address& address, event::StringPool* strings);
+
+}  // namespace exeray::etw
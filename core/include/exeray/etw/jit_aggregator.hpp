@@ -0,0 +1,138 @@
+#pragma once
+
+/// @file jit_aggregator.hpp
+/// @brief Per-module aggregation of CLR JIT events.
+///
+/// The CLR reports every method it compiles, and a .NET application
+/// compiles tens of thousands of them while it starts, far more events
+/// than anything else the process does. JitAggregator folds them into one
+/// record per (process, module) the way FlowTable folds transfers: the
+/// first compilation of a module is stored, then one summary per
+/// summary_interval_ms whose ClrPayload::methods counts the compilations
+/// since the last stored one, so the stored counts still add up.
+///
+/// Compilations worth looking at one by one are never folded: those of a
+/// dynamic or in-memory module and those the parser found suspicious
+/// (obfuscated names). Modules are named by their ModuleLoad event; the
+/// table keeps that StringId, so each JIT event gets its assembly without
+/// interning it again.
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "exeray/event/payload.hpp"
+#include "exeray/event/types.hpp"
+
+namespace exeray::etw {
+
+/// @brief Aggregation settings.
+struct JitConfig {
+    bool enabled = true;                       ///< Store every JIT event individually if false
+    std::uint32_t summary_interval_ms = 1000;  ///< 0 = only the first event of a module
+};
+
+/// @brief Compilations of one module of one process.
+struct JitModuleRecord {
+    std::uint32_t pid = 0;
+    std::uint64_t module_id = 0;                       ///< CLR ModuleID
+    event::StringId assembly = event::INVALID_STRING;  ///< Module path (INVALID = load not seen)
+    bool dynamic = false;                              ///< Loaded from memory
+    std::uint64_t methods = 0;                         ///< Methods compiled
+    event::Timestamp first_seen = 0;
+    event::Timestamp last_seen = 0;
+};
+
+/// @brief What the aggregator did with the JIT events it saw.
+struct JitStats {
+    std::uint64_t modules = 0;     ///< Modules tracked now
+    std::uint64_t absorbed = 0;    ///< JIT events folded into their module, not stored
+    std::uint64_t summaries = 0;   ///< JIT events stored as a periodic summary
+    std::uint64_t flagged = 0;     ///< JIT events stored individually as suspicious
+    std::uint64_t overflowed = 0;  ///< JIT events stored as is because the table was full
+};
+
+/**
+ * @brief Module table shared by the consumer shards.
+ *
+ * Bounded to kMaxModules modules; JIT events of modules beyond that are
+ * kept unaggregated. Modules are forgotten at clear().
+ *
+ * Thread-safety: admit(), modules() and stats() from any thread (the
+ * modules are sharded by key, each shard with its own mutex); clear()
+ * between sessions.
+ */
+class JitAggregator {
+public:
+    static constexpr std::size_t kShards = 16;
+    static constexpr std::size_t kMaxModules = 16384;
+
+    explicit JitAggregator(const JitConfig& config = {});
+
+    JitAggregator(const JitAggregator&) = delete;
+    JitAggregator& operator=(const JitAggregator&) = delete;
+
+    /**
+     * @brief Account one CLR event and decide whether it is stored.
+     *
+     * A ModuleLoad names its module. A MethodJit gets the assembly and
+     * dynamic flag of its module (marking it suspicious if dynamic); a
+     * stored summary has methods rewritten to the compilations it stands
+     * for. Call once the event's strings are interned.
+     *
+     * @param pid Process the event belongs to.
+     * @param payload Event payload (ClrPayload::load_address is the ModuleID).
+     * @param operation ClrOp code.
+     * @param at Event time (graph clock).
+     * @return false if the event was absorbed into its module.
+     */
+    [[nodiscard]] bool admit(std::uint32_t pid, event::EventPayload& payload,
+                             std::uint8_t operation, event::Timestamp at);
+
+    /// @brief Modules of pid (0 = every process), in no particular order.
+    [[nodiscard]] std::vector<JitModuleRecord> modules(std::uint32_t pid = 0) const;
+
+    [[nodiscard]] JitStats stats() const noexcept;
+
+    /// @brief Forget every module and zero the counters (start of a session).
+    void clear();
+
+private:
+    struct Key {
+        std::uint32_t pid = 0;
+        std::uint64_t module_id = 0;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const noexcept;
+    };
+
+    struct Module {
+        JitModuleRecord record;
+        std::uint32_t unreported = 0;  ///< Compilations since the last stored event
+        event::Timestamp reported_at = 0;
+        bool reported = false;  ///< A compilation of it was stored
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<Key, Module, KeyHash> modules;
+    };
+
+    static constexpr std::size_t kMaxModulesPerShard = kMaxModules / kShards;
+
+    event::Timestamp interval_;  ///< Summary interval in ns; 0 = off
+    std::array<Shard, kShards> shards_;
+    std::atomic<std::uint64_t> absorbed_{0};
+    std::atomic<std::uint64_t> summaries_{0};
+    std::atomic<std::uint64_t> flagged_{0};
+    std::atomic<std::uint64_t> overflowed_{0};
+};
+
+}  // namespace exeray::etw
@@ -0,0 +1,106 @@
+#pragma once
+
+/// @file key_map.hpp
+/// @brief Full path of every open registry key object, for value events.
+///
+/// Kernel registry events name a key by its KeyObject pointer plus a name
+/// relative to it. The Registry parser records the path node of each key
+/// created or opened here, and SetValue/DeleteValue events resolve their
+/// key with one lookup instead of building a path from the event strings.
+///
+/// The table is fixed-size and set-associative: a key hashes to one bucket
+/// of kWays slots, and each slot packs a hash tag with the StringId into a
+/// single atomic word. Lookups are wait-free, at most kWays loads of one
+/// cache line. A full bucket evicts a slot, so a miss is always possible;
+/// callers fall back to the names carried by the event.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "exeray/event/types.hpp"
+
+namespace exeray::etw {
+
+/**
+ * @brief Bounded KeyObject -> key path (StringPool path node) cache.
+ *
+ * Thread-safety: every member but clear() may run concurrently; racing
+ * writers of one bucket may drop an entry, which only costs a miss.
+ * clear() must not run alongside any other member.
+ */
+class KeyMap {
+public:
+    static constexpr std::size_t kWays = 8;  ///< Slots per bucket (one cache line)
+    static constexpr std::size_t kBuckets = 8192;
+
+    KeyMap();
+    KeyMap(const KeyMap&) = delete;
+    KeyMap& operator=(const KeyMap&) = delete;
+
+    /// @brief key_object now names path (replaces an older mapping).
+    void insert(std::uint64_t key_object, event::StringId path);
+
+    /// @brief key_object was closed or its key deleted.
+    void erase(std::uint64_t key_object);
+
+    /// @brief Path of key_object (wait-free); INVALID_STRING if unknown.
+    [[nodiscard]] event::StringId find(std::uint64_t key_object) const noexcept {
+        const std::uint64_t hash = mix(key_object);
+        const Bucket& bucket = buckets_[hash % kBuckets];
+        const std::uint32_t tag = tag_of(hash);
+        for (const auto& slot : bucket.slots) {
+            const std::uint64_t entry = slot.load(std::memory_order_acquire);
+            if (static_cast<std::uint32_t>(entry >> 32) == tag) {
+                return static_cast<event::StringId>(entry);
+            }
+        }
+        return event::INVALID_STRING;
+    }
+
+    /// @brief Call fn(StringId) with the path of every mapped key, e.g. to
+    /// keep them through a string compaction.
+    template <typename F>
+    void for_each_path(F&& fn) const {
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            for (const auto& slot : buckets_[i].slots) {
+                const std::uint64_t entry = slot.load(std::memory_order_acquire);
+                if (entry != 0) {
+                    fn(static_cast<event::StringId>(entry));
+                }
+            }
+        }
+    }
+
+    /// @brief Keys currently mapped.
+    [[nodiscard]] std::size_t size() const noexcept {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    void clear();
+
+private:
+    struct alignas(64) Bucket {
+        std::atomic<std::uint64_t> slots[kWays] = {};  ///< tag << 32 | path, 0 = empty
+    };
+
+    static constexpr std::uint64_t mix(std::uint64_t key) noexcept {
+        // Kernel objects are 16-byte aligned; fold the high bits down
+        key *= 0x9E3779B97F4A7C15ULL;
+        return key ^ key >> 29;
+    }
+
+    /// Nonzero, so that an empty slot never matches.
+    static constexpr std::uint32_t tag_of(std::uint64_t hash) noexcept {
+        return static_cast<std::uint32_t>(hash >> 32) | 1U;
+    }
+
+    std::unique_ptr<Bucket[]> buckets_;
+    std::atomic<std::size_t> size_{0};
+};
+
+/// @brief Map fed and read by the Registry parser.
+KeyMap& key_map();
+
+}  // namespace exeray::etw
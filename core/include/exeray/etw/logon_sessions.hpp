@@ -0,0 +1,116 @@
+#pragma once
+
+/// @file logon_sessions.hpp
+/// @brief Logon sessions opened by Security audit events.
+///
+/// A 4688 process creation or 4703 token adjustment names the logon
+/// session it ran in, not who that is or how they got in; tying it to the
+/// 4624 that opened the session would mean scanning back through the
+/// logons. LogonSessions keeps each open session keyed by its logon ID,
+/// with the user, logon type, source address and start time of its logon,
+/// so the consumer attributes a later Security event with one lookup.
+/// The StringIds are those interned for the logon, shared by every event
+/// of the session.
+///
+/// Sessions live in a fixed table like DomainMap's: an ID is found in a
+/// bounded probe of its bucket. A 4634 logoff frees its session; one whose
+/// logoff was missed is evicted, oldest first, when its bucket fills, so
+/// the table stays the same size however many users log on.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "exeray/event/payload.hpp"
+#include "exeray/event/types.hpp"
+
+namespace exeray::etw {
+
+/// @brief Session tracking settings.
+struct LogonConfig {
+    bool enabled = true;           ///< Track sessions and attribute Security events
+    std::size_t capacity = 16384;  ///< Open sessions kept
+};
+
+/// @brief One open logon session.
+struct LogonSession {
+    std::uint64_t logon_id = 0;                      ///< LSA logon ID (LUID)
+    event::StringId user = event::INVALID_STRING;    ///< Account logged on
+    std::uint32_t logon_type = 0;                    ///< 2=Interactive, 3=Network, 10=Remote
+    event::StringId source = event::INVALID_STRING;  ///< Network address it came from
+    event::Timestamp start = 0;                      ///< Logon time (graph clock)
+};
+
+/// @brief What the table did in the current or last session.
+struct LogonStats {
+    std::uint64_t logons = 0;        ///< Sessions opened
+    std::uint64_t logoffs = 0;       ///< Sessions closed by their logoff
+    std::uint64_t attributed = 0;    ///< Events given their session's user and type
+    std::uint64_t unattributed = 0;  ///< Events whose session was not seen opening
+    std::uint64_t evicted = 0;       ///< Open sessions pushed out by new ones
+    std::uint64_t tracked = 0;       ///< Sessions in the table
+};
+
+/**
+ * @brief Fixed-size table of open logon sessions.
+ *
+ * Thread-safety: every member from any thread (the table is sharded by
+ * logon ID, each shard with its own mutex); clear() between sessions.
+ */
+class LogonSessions {
+public:
+    static constexpr std::size_t kShards = 16;
+    static constexpr std::size_t kProbe = 8;  ///< Entries searched per logon ID
+
+    explicit LogonSessions(const LogonConfig& config = {});
+
+    LogonSessions(const LogonSessions&) = delete;
+    LogonSessions& operator=(const LogonSessions&) = delete;
+
+    /// @brief Open (or reopen) session.logon_id; ID 0 is ignored.
+    void logon(const LogonSession& session);
+
+    /**
+     * @brief Give a Security event the user and logon type of its session.
+     *
+     * Fills target_user if the event has none and logon_type if 0, so the
+     * parser's own values win.
+     *
+     * @param logon_id Session the event names.
+     * @param payload Security payload to fill.
+     * @param close The event is the session's logoff: free it.
+     * @return false if the session is not open (counted as unattributed).
+     */
+    bool attribute(std::uint64_t logon_id, event::SecurityPayload& payload, bool close = false);
+
+    /// @brief Open session logon_id, if any.
+    [[nodiscard]] std::optional<LogonSession> find(std::uint64_t logon_id) const;
+
+    /// @brief Every open session, in no particular order.
+    [[nodiscard]] std::vector<LogonSession> sessions() const;
+
+    [[nodiscard]] LogonStats stats() const;
+
+    /// @brief Forget every session and zero the counters (start of a session).
+    void clear();
+
+private:
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unique_ptr<LogonSession[]> entries;  ///< logon_id 0 = free
+        std::uint64_t logons = 0;
+        std::uint64_t logoffs = 0;
+        std::uint64_t attributed = 0;
+        std::uint64_t unattributed = 0;
+        std::uint64_t evicted = 0;
+    };
+
+    std::size_t shard_size_;  ///< Entries per shard (multiple of kProbe)
+    std::array<Shard, kShards> shards_;
+};
+
+}  // namespace exeray::etw
@@ -0,0 +1,160 @@
+#pragma once
+
+/// @file manifest_providers.hpp
+/// @brief Providers registered at runtime and decoded from their manifest.
+///
+/// dispatch_event() hands the records of the built-in providers to their
+/// parsers and drops everything else. A provider registered here
+/// (EngineConfig::manifest_providers, Engine::register_provider()) needs no
+/// parser: its records are decoded through the TDH schema cache, whose
+/// compiled DecodePlan reads properties at precomputed offsets, and the
+/// properties its registration projects are copied into a ManifestPayload
+/// and a ManifestValuesExtension by the FieldTable copy loop. Property
+/// names are resolved to schema ordinals once per schema and thread, as
+/// for the converters, so an event costs one decode and one pass over the
+/// projected fields.
+///
+/// Strings are interned as the event is parsed: unlike the built-in
+/// parsers' strings they may view the decoder's own text storage, which
+/// does not outlive the parse, so they cannot be deferred until the event
+/// is kept.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "exeray/etw/provider_table.hpp"
+#include "exeray/etw/tdh/field_table.hpp"
+#include "exeray/event/extensions.hpp"
+#include "exeray/event/payload.hpp"
+#include "exeray/platform/guid.hpp"
+
+namespace exeray::etw {
+
+/// @brief Where a projected property is stored.
+enum class ManifestSlot : std::uint8_t {
+    Text,    ///< ManifestPayload::text (string)
+    Detail,  ///< ManifestPayload::detail (string)
+    Value,   ///< ManifestPayload::value (integer truncated to 32 bits)
+    Extra0,  ///< ManifestValuesExtension::values[0] (integer)
+    Extra1,  ///< ManifestValuesExtension::values[1]
+    Extra2,  ///< ManifestValuesExtension::values[2]
+    Extra3,  ///< ManifestValuesExtension::values[3]
+};
+
+/// @brief One projection: a manifest property and the slot it fills.
+struct ManifestField {
+    std::string property;                    ///< Property name in the manifest
+    ManifestSlot slot = ManifestSlot::Text;
+    bool path = false;  ///< Intern a string as a path (StringPool::intern_path_wide)
+};
+
+/// @brief A provider to decode without a parser.
+struct ManifestProviderConfig {
+    /// Name used in EngineConfig::providers and the engine's provider calls;
+    /// must not be a built-in provider's
+    std::string name;
+
+    /// Provider GUID, "{XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX}" (braces optional)
+    std::string guid;
+
+    /// Properties kept, in order. Several fields on one slot are
+    /// alternatives: the first present with a non-zero integer or
+    /// non-empty string fills it, as in a FieldTable.
+    std::vector<ManifestField> fields;
+};
+
+/// @brief GUID from its registry form, nullopt if malformed.
+[[nodiscard]] std::optional<GUID> parse_guid(std::string_view text) noexcept;
+
+/**
+ * @brief Runtime registrations of manifest providers.
+ *
+ * Indexes are assigned in registration order and stored in
+ * ManifestPayload::provider.
+ *
+ * Thread-safety: add() must not run while events are dispatched (the
+ * engine registers only while no session runs); everything else may run
+ * from any thread.
+ */
+class ManifestProviders {
+public:
+    static constexpr std::size_t kMaxProviders = 32;
+    static constexpr std::size_t kMaxFields = 16;  ///< Projections per provider
+
+    /// @brief A registered provider.
+    struct Provider {
+        std::string name;
+        GUID guid{};
+        std::vector<ManifestField> fields;
+    };
+
+    ManifestProviders() = default;
+    ManifestProviders(const ManifestProviders&) = delete;
+    ManifestProviders& operator=(const ManifestProviders&) = delete;
+
+    /**
+     * @brief Register a provider.
+     * @param error Receives the reason it was refused.
+     * @return Its index, or nullopt if the name or GUID is malformed, taken
+     *         or a built-in provider's, a field has no property name, there
+     *         are more than kMaxFields fields or kMaxProviders providers.
+     */
+    std::optional<std::uint16_t> add(const ManifestProviderConfig& config,
+                                     std::string* error = nullptr);
+
+    /// @brief Index of a registered GUID, nullptr if absent.
+    [[nodiscard]] const std::uint16_t* find(const GUID& guid) const noexcept {
+        return table_.find(guid);
+    }
+
+    /// @brief GUID of a registered name.
+    [[nodiscard]] std::optional<GUID> guid(std::string_view name) const noexcept;
+
+    /// @brief Registration at an index, nullptr if out of range.
+    [[nodiscard]] const Provider* provider(std::size_t index) const noexcept {
+        return index < entries_.size() ? &entries_[index].provider : nullptr;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return entries_.size(); }
+
+    /**
+     * @brief Fill a Manifest payload from a decoded event.
+     *
+     * Sets every ManifestPayload member; projected slots without a value
+     * stay INVALID_STRING or 0. The extension is set only if an Extra slot
+     * got a value.
+     *
+     * @param index Registration of the event's provider.
+     * @param pid Process that logged the event.
+     * @param strings Pool for string slots (nullptr leaves them empty).
+     */
+    void project(std::uint16_t index, const TdhParsedEvent& event, std::uint32_t pid,
+                 event::StringPool* strings, event::EventPayload& payload,
+                 event::PendingExtension& extension) const;
+
+private:
+    /// @brief What project() writes, in one block for the row offsets.
+    struct Target {
+        event::ManifestPayload payload;
+        event::ManifestValuesExtension values;
+    };
+
+    struct Entry {
+        Provider provider;
+        std::uint64_t serial = 0;  ///< Unique per process, keys the ordinal caches
+        std::array<std::wstring, kMaxFields> names{};  ///< Viewed by rows
+        std::vector<tdh::FieldDescriptor> rows;
+        std::vector<std::uint8_t> alternatives;
+    };
+
+    std::deque<Entry> entries_;  ///< Never relocated: rows view their names
+    ProviderTable<std::uint16_t> table_;
+};
+
+}  // namespace exeray::etw
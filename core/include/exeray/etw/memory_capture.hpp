@@ -0,0 +1,238 @@
+#pragma once
+
+/// @file memory_capture.hpp
+/// @brief Snapshots of RWX regions that a monitored thread starts in, off the ingest path.
+///
+/// An RWX allocation alone is a hint; the bytes a thread later runs from
+/// it are the evidence. When a Thread Start event of a kept process lands
+/// in a writable executable region that MemoryRegionTracker knows, the
+/// consumer asks MemoryCapture::attach() to queue that region. A pool
+/// worker reads it with ReadProcessMemory, hashes it with SHA-256, stores
+/// the bytes once per hash in a size-capped store and records one
+/// MemoryCaptureExtension per region, backfilled onto the thread events
+/// pushed meanwhile.
+///
+/// Reads are held to a global bytes-per-second budget (a token bucket).
+/// A region the bucket cannot pay for is not read; a later thread start
+/// in it asks again.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "exeray/event/extensions.hpp"
+#include "exeray/event/types.hpp"
+
+namespace exeray::event {
+class EventGraph;
+struct EventPayload;
+}  // namespace exeray::event
+
+namespace exeray::etw {
+
+/// @brief Read up to out.size() bytes at address in pid; the bytes read
+/// (a prefix, up to the first unreadable page; 0 off Windows).
+std::size_t read_process_memory(std::uint32_t pid, std::uint64_t address,
+                                std::span<std::uint8_t> out);
+
+/// @brief Memory capture settings.
+struct MemoryCaptureConfig {
+    bool enabled = false;                         ///< Capture RWX regions at all
+    std::size_t workers = 1;                      ///< Pool tasks reading at once
+    std::uint64_t max_region = 4ULL << 20;        ///< Bytes read from one region at most
+    std::uint64_t store_bytes = 64ULL << 20;      ///< Captured bytes kept; oldest go first
+    std::uint64_t bytes_per_second = 8ULL << 20;  ///< Read budget over all regions
+};
+
+/// @brief What the capture stage did in the current or last session.
+struct MemoryCaptureStats {
+    std::uint64_t requested = 0;   ///< Distinct regions queued
+    std::uint64_t captured = 0;    ///< Regions read
+    std::uint64_t duplicates = 0;  ///< Regions whose bytes were already stored
+    std::uint64_t unreadable = 0;  ///< Regions that could not be read
+    std::uint64_t throttled = 0;   ///< Regions not read for lack of budget
+    std::uint64_t evicted = 0;     ///< Captures dropped to stay within store_bytes
+    std::uint64_t stored = 0;      ///< Bytes in the store now
+    std::uint64_t attached = 0;    ///< Events given their capture at ingest
+    std::uint64_t backfilled = 0;  ///< Events given their capture after the push
+};
+
+/// @brief One stored capture (bytes shared by every region that held them).
+struct MemoryCaptureRecord {
+    std::array<std::uint8_t, 32> sha256{};
+    std::uint32_t pid = 0;   ///< Process of the first region captured
+    std::uint64_t base = 0;  ///< Its base address
+    std::vector<std::uint8_t> bytes;
+};
+
+/**
+ * @brief Captures each RWX thread start region once per session, on pool workers.
+ *
+ * Thread-safety: attach(), stats(), captures() and capture() from any
+ * thread (regions are sharded by process, each shard with its own mutex);
+ * start() and stop() from the thread controlling the session.
+ */
+class MemoryCapture {
+public:
+    /// @brief Runs a task on a pool worker.
+    using Submit = std::function<void(std::function<void()>)>;
+
+    /// @brief Reads process memory; read_process_memory() unless a test substitutes one.
+    using Reader = std::function<std::size_t(std::uint32_t, std::uint64_t,
+                                             std::span<std::uint8_t>)>;
+
+    static constexpr std::size_t kShards = 16;
+
+    /// Queued regions a worker reads before it backfills their events.
+    static constexpr std::size_t kBatch = 16;
+
+    explicit MemoryCapture(const MemoryCaptureConfig& config = {},
+                           Reader reader = read_process_memory);
+    ~MemoryCapture();
+
+    MemoryCapture(const MemoryCapture&) = delete;
+    MemoryCapture& operator=(const MemoryCapture&) = delete;
+
+    /**
+     * @brief Begin capturing for the events pushed from now on.
+     * @param graph Graph the events are pushed to.
+     * @param extensions Store the capture records go to; must outlive stop().
+     * @param submit Hands a task to the pool.
+     */
+    void start(event::EventGraph& graph, event::ExtensionStore& extensions, Submit submit);
+
+    /// @brief Whether start() was called without a matching stop().
+    [[nodiscard]] bool running() const noexcept {
+        return running_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Give a thread start its region's capture, or queue the region.
+     *
+     * Called by the consumer before the push for every kept event; only
+     * Thread Start events starting in a tracked RWX region (see
+     * memory_regions()) are looked at.
+     */
+    void attach(std::uint8_t operation, event::EventPayload& payload);
+
+    /// @brief Wait for the workers, read what is left on this thread and
+    /// backfill every event still without its capture.
+    void stop();
+
+    /// @brief Capture record of the region at base in pid this session
+    /// (NO_EXTENSION = none yet).
+    [[nodiscard]] event::ExtensionId capture_of(std::uint32_t pid, std::uint64_t base) const;
+
+    /// @brief Stored captures without their bytes, oldest first.
+    [[nodiscard]] std::vector<MemoryCaptureRecord> captures() const;
+
+    /// @brief Stored capture with these bytes' hash, if still kept.
+    [[nodiscard]] std::optional<MemoryCaptureRecord> capture(
+        const std::array<std::uint8_t, 32>& sha256) const;
+
+    [[nodiscard]] MemoryCaptureStats stats() const noexcept;
+
+private:
+    struct Region {
+        std::uint32_t pid = 0;
+        std::uint64_t base = 0;
+        std::uint64_t size = 0;
+    };
+
+    struct Known {
+        event::ExtensionId extension = event::NO_EXTENSION;  ///< NO_EXTENSION if the store is full
+        std::uint64_t end = 0;                               ///< Region end address
+        bool captured = false;                               ///< false while queued
+    };
+
+    struct RegionKey {
+        std::uint32_t pid = 0;
+        std::uint64_t base = 0;
+
+        bool operator==(const RegionKey&) const = default;
+    };
+
+    struct RegionKeyHash {
+        std::size_t operator()(const RegionKey& key) const noexcept {
+            return static_cast<std::size_t>((key.base ^ key.pid) * 0x9E3779B97F4A7C15ULL);
+        }
+    };
+
+    struct alignas(64) RegionShard {
+        mutable std::mutex mutex;
+        std::unordered_map<RegionKey, Known, RegionKeyHash> regions;
+    };
+
+    struct DigestHash {
+        std::size_t operator()(const std::array<std::uint8_t, 32>& digest) const noexcept;
+    };
+
+    [[nodiscard]] RegionShard& shard_of(std::uint32_t pid) noexcept {
+        return regions_[(pid >> 2) % kShards];  // PIDs are multiples of four
+    }
+    [[nodiscard]] const RegionShard& shard_of(std::uint32_t pid) const noexcept {
+        return regions_[(pid >> 2) % kShards];
+    }
+
+    /// @brief Claim and read batches until the queue is empty (pool worker).
+    void run();
+
+    /// @brief Read up to kBatch queued regions; false if the queue was empty.
+    bool capture_batch();
+
+    /// @brief Take bytes from the budget; false if it cannot pay for them now.
+    bool spend(std::uint64_t bytes);
+
+    /// @brief Keep bytes under their hash, evicting the oldest beyond store_bytes.
+    void store(const Region& region, const std::array<std::uint8_t, 32>& digest,
+               std::vector<std::uint8_t> bytes);
+
+    /// @brief Point the thread starts in the captured regions that lack a
+    /// capture record at it.
+    void backfill(const std::vector<std::pair<Region, Known>>& resolved);
+
+    MemoryCaptureConfig config_;
+    Reader reader_;
+    event::EventGraph* graph_ = nullptr;
+    event::ExtensionStore* extensions_ = nullptr;
+    Submit submit_;
+
+    std::array<RegionShard, kShards> regions_;
+
+    std::mutex budget_mutex_;
+    double tokens_ = 0;  ///< Bytes the budget can pay for now
+    std::chrono::steady_clock::time_point refilled_{};
+
+    mutable std::mutex store_mutex_;
+    std::unordered_map<std::array<std::uint8_t, 32>, MemoryCaptureRecord, DigestHash> store_;
+    std::deque<std::array<std::uint8_t, 32>> order_;  ///< Stored hashes, oldest first
+    std::uint64_t stored_ = 0;                        ///< Bytes in store_
+
+    std::atomic<bool> running_{false};
+    std::mutex mutex_;
+    std::condition_variable idle_;
+    std::deque<Region> queue_;  ///< Regions waiting for a worker (mutex_)
+    std::size_t active_ = 0;    ///< Tasks submitted and not finished (mutex_)
+
+    std::atomic<std::uint64_t> requested_{0};
+    std::atomic<std::uint64_t> captured_{0};
+    std::atomic<std::uint64_t> duplicates_{0};
+    std::atomic<std::uint64_t> unreadable_{0};
+    std::atomic<std::uint64_t> throttled_{0};
+    std::atomic<std::uint64_t> evicted_{0};
+    std::atomic<std::uint64_t> attached_{0};
+    std::atomic<std::uint64_t> backfilled_{0};
+};
+
+}  // namespace exeray::etw
@@ -0,0 +1,121 @@
+#pragma once
+
+/// @file memory_regions.hpp
+/// @brief Live executable allocations per process, for injection detection.
+///
+/// A single Memory event says little; what matters is whether a thread
+/// later starts inside memory someone allocated by hand. The memory parser
+/// records every executable allocation here as it is parsed and removes
+/// freed ranges, and the thread parser asks which allocation, if any, holds
+/// a new thread's start address. Each process keeps its regions sorted by
+/// base address, so a lookup is a binary search.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace exeray::etw {
+
+/// @brief What is known about a tracked allocation (bit set).
+enum RegionFlags : std::uint8_t {
+    kRegionExecutable = 1,  ///< Always set: only executable allocations are tracked
+    kRegionWritable = 2,    ///< Writable and executable at once (RWX)
+    kRegionRemote = 4,      ///< Allocated by another process
+};
+
+struct MemoryRegion {
+    std::uint64_t base = 0;
+    std::uint64_t size = 0;
+    std::uint64_t allocated = 0;      ///< Event timestamp of the allocation
+    std::uint32_t allocator_pid = 0;  ///< Process that made the allocation
+    std::uint8_t flags = 0;           ///< RegionFlags
+
+    [[nodiscard]] std::uint64_t end() const noexcept { return base + size; }
+};
+
+/**
+ * @brief Sorted range map of executable allocations for every process.
+ *
+ * Processes are spread over kShards independently locked shards. Memory is
+ * bounded: freed ranges are removed right away, a terminated process is
+ * forgotten, and beyond kMaxRegions per process (kMaxProcesses per shard)
+ * the oldest allocation (the least recently active process) is evicted.
+ *
+ * Thread-safety: all members from any thread.
+ */
+class MemoryRegionTracker {
+public:
+    static constexpr std::size_t kShards = 16;
+    static constexpr std::size_t kMaxRegions = 1024;
+    static constexpr std::size_t kMaxProcesses = 256;
+
+    /// @brief Whether an allocation with these PAGE_* flags is tracked.
+    [[nodiscard]] static bool tracked(std::uint32_t protection) noexcept;
+
+    /**
+     * @brief Record an allocation in pid, replacing any overlapped regions.
+     * @param allocator_pid Process that issued it (remote if not pid).
+     * @param protection PAGE_* flags; non-executable allocations are ignored.
+     */
+    void allocate(std::uint32_t pid, std::uint64_t base, std::uint64_t size,
+                  std::uint32_t allocator_pid, std::uint32_t protection,
+                  std::uint64_t timestamp);
+
+    /// @brief Remove [base, base + size); size 0 releases the whole region at base.
+    void free(std::uint32_t pid, std::uint64_t base, std::uint64_t size);
+
+    /// @brief Drop every region of a terminated process.
+    void forget(std::uint32_t pid);
+
+    /// @brief Tracked allocation of pid containing address.
+    [[nodiscard]] std::optional<MemoryRegion> find(std::uint32_t pid,
+                                                   std::uint64_t address) const;
+
+    /// @brief Every tracked region with its process, e.g. for a checkpoint.
+    [[nodiscard]] std::vector<std::pair<std::uint32_t, MemoryRegion>> regions() const;
+
+    /// @brief Put back a region from regions(), replacing any it overlaps.
+    void restore(std::uint32_t pid, const MemoryRegion& region);
+
+    /// @brief Regions tracked over all processes.
+    [[nodiscard]] std::size_t size() const;
+
+    void clear();
+
+private:
+    struct Process {
+        std::vector<MemoryRegion> regions;  ///< Sorted by base, disjoint
+        std::uint64_t last_active = 0;      ///< Timestamp of the last allocation
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::uint32_t, Process> processes;
+    };
+
+    /// @brief Add region to pid, evicting as allocate() documents.
+    void insert(std::uint32_t pid, const MemoryRegion& region);
+
+    /// @brief Remove [begin, end) from regions, trimming or splitting partial overlaps.
+    static void carve(std::vector<MemoryRegion>& regions, std::uint64_t begin,
+                      std::uint64_t end);
+
+    [[nodiscard]] Shard& shard_of(std::uint32_t pid) noexcept {
+        return shards_[(pid >> 2) % kShards];  // PIDs are multiples of four
+    }
+    [[nodiscard]] const Shard& shard_of(std::uint32_t pid) const noexcept {
+        return shards_[(pid >> 2) % kShards];
+    }
+
+    std::array<Shard, kShards> shards_;
+};
+
+/// @brief Tracker fed by the Memory and Process parsers and read by the Thread parser.
+MemoryRegionTracker& memory_regions();
+
+}  // namespace exeray::etw
@@ -0,0 +1,154 @@
+#pragma once
+
+/// @file module_map.hpp
+/// @brief Loaded images per process, for "is this address image-backed?".
+///
+/// The Image parser records every loaded module here and removes unloaded
+/// ones; the Thread parser and the TUI's process view ask which module, if
+/// any, holds an address. A thread that starts outside every known module
+/// of its process runs code that was never mapped from a file.
+///
+/// Lookups never take a lock: each process keeps its modules in a sorted
+/// table guarded by a sequence counter that readers validate, and tables
+/// outgrown by a process stay alive until clear().
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "exeray/event/types.hpp"
+
+namespace exeray::etw {
+
+struct ModuleInfo {
+    std::uint64_t base = 0;
+    std::uint64_t size = 0;
+    event::StringId path = event::INVALID_STRING;  ///< Image path node
+
+    [[nodiscard]] std::uint64_t end() const noexcept { return base + size; }
+};
+
+/**
+ * @brief Sorted module map for every process.
+ *
+ * Bounded: at most kMaxProcesses processes and kMaxModules modules each;
+ * loads beyond that are dropped. A terminated process is forgotten and its
+ * slot and tables are reused by the next one.
+ *
+ * Thread-safety: find() and count() are lock-free and may run alongside
+ * writers; the other members serialize on one mutex. clear() must not run
+ * concurrently with readers.
+ */
+class ModuleMap {
+public:
+    static constexpr std::size_t kMaxProcesses = 4096;
+    static constexpr std::size_t kMaxModules = 4096;
+
+    ModuleMap();
+    ~ModuleMap();
+    ModuleMap(const ModuleMap&) = delete;
+    ModuleMap& operator=(const ModuleMap&) = delete;
+
+    /// @brief Record a module of pid, replacing any it overlaps.
+    void load(std::uint32_t pid, std::uint64_t base, std::uint64_t size, event::StringId path);
+
+    /**
+     * @brief Queue a module of a rundown for one batched load per process.
+     *
+     * A capture-state rundown lists every module of every running process;
+     * load() copies the table of the process for each of them. Staged
+     * modules are kept per calling thread and merged with one copy per
+     * process by flush_staged(), which load(), unload() and forget() run
+     * first. Lookups do not see them until then.
+     */
+    void stage(std::uint32_t pid, std::uint64_t base, std::uint64_t size, event::StringId path);
+
+    /// @brief Load what the calling thread staged (cheap if nothing).
+    void flush_staged();
+
+    /// @brief Remove the module loaded at base.
+    void unload(std::uint32_t pid, std::uint64_t base);
+
+    /// @brief Drop every module of a terminated process.
+    void forget(std::uint32_t pid);
+
+    /// @brief Module of pid containing address (lock-free).
+    [[nodiscard]] std::optional<ModuleInfo> find(std::uint32_t pid, std::uint64_t address) const;
+
+    /// @brief Modules known for pid (lock-free); 0 if the process was never seen.
+    [[nodiscard]] std::size_t count(std::uint32_t pid) const;
+
+    /// @brief Copy of the modules of pid, sorted by base.
+    [[nodiscard]] std::vector<ModuleInfo> modules(std::uint32_t pid) const;
+
+    /// @brief Every module with its process, e.g. for a checkpoint.
+    [[nodiscard]] std::vector<std::pair<std::uint32_t, ModuleInfo>> all() const;
+
+    /// @brief Modules over all processes.
+    [[nodiscard]] std::size_t size() const;
+
+    void clear();
+
+private:
+    struct Entry {
+        std::atomic<std::uint64_t> base{0};
+        std::atomic<std::uint64_t> end{0};
+        std::atomic<event::StringId> path{event::INVALID_STRING};
+    };
+
+    struct Table {
+        explicit Table(std::size_t n) : entries(std::make_unique<Entry[]>(n)), capacity(n) {}
+        std::unique_ptr<Entry[]> entries;
+        std::size_t capacity;
+    };
+
+    struct alignas(64) Process {
+        std::atomic<std::uint32_t> pid{0};    ///< 0 = never used, kForgotten = reusable
+        std::atomic<std::uint32_t> seq{0};    ///< Odd while a writer is changing the table
+        std::atomic<Table*> table{nullptr};
+        std::atomic<std::uint32_t> count{0};
+        std::vector<std::unique_ptr<Table>> tables;  ///< Every generation; writer only
+    };
+
+    static constexpr std::uint32_t kForgotten = 0xFFFFFFFF;
+
+    [[nodiscard]] const Process* lookup(std::uint32_t pid) const noexcept;
+    [[nodiscard]] Process* lookup(std::uint32_t pid) noexcept {
+        return const_cast<Process*>(std::as_const(*this).lookup(pid));
+    }
+    [[nodiscard]] Process* lookup_or_claim(std::uint32_t pid) noexcept;
+
+    /**
+     * @brief Run visit(entries, count) on a consistent view of the table of pid.
+     *
+     * visit may run more than once if a writer gets in the way and must only
+     * fill its own results. Returns false if process no longer holds pid.
+     */
+    template <typename Visit>
+    static bool read(const Process& process, std::uint32_t pid, Visit&& visit);
+
+    /// @brief Writer side: current modules of process, and publishing new ones.
+    static std::vector<ModuleInfo> snapshot(const Process& process);
+    static void publish(Process& process, const std::vector<ModuleInfo>& modules);
+
+    /// @brief Add module to the sorted modules, replacing any it overlaps.
+    /// @return false if the process is full.
+    static bool insert(std::vector<ModuleInfo>& modules, const ModuleInfo& module);
+
+    /// @brief load() of a batch of (pid, module), in order (mutex_ held).
+    void load_locked(std::span<const std::pair<std::uint32_t, ModuleInfo>> batch);
+
+    std::unique_ptr<Process[]> processes_;
+    mutable std::mutex mutex_;
+};
+
+/// @brief Map fed by the Image and Process parsers and read by the Thread parser.
+ModuleMap& module_map();
+
+}  // namespace exeray::etw
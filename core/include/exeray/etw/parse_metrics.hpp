@@ -0,0 +1,170 @@
+#pragma once
+
+/// @file parse_metrics.hpp
+/// @brief Per-provider and per-event-ID parse counters and cost histograms.
+///
+/// Shows which provider and which event IDs cost the consumer its CPU.
+/// dispatch_event() times every parse in CPU cycles (TSC on x86, nanoseconds
+/// elsewhere) and records it in a table owned by the calling thread, so
+/// the hot path is a handful of uncontended relaxed stores. snapshot()
+/// sums the tables of all threads.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace exeray::etw {
+
+/// @brief Providers tracked by ParseMetrics (one per dispatch table entry).
+enum class MetricProvider : std::uint8_t {
+    Process,
+    File,
+    Registry,
+    Network,
+    Image,
+    Thread,
+    Memory,
+    PowerShell,
+    Amsi,
+    Dns,
+    Security,
+    Wmi,
+    Clr,
+    Manifest,  ///< Providers registered at runtime (etw/manifest_providers.hpp)
+    Unknown,   ///< Records from providers without a parser
+
+    Count  ///< Sentinel (not a provider)
+};
+
+/// @brief Number of MetricProvider values.
+inline constexpr std::size_t kMetricProviders = static_cast<std::size_t>(MetricProvider::Count);
+
+/// @brief Provider name as used in EngineConfig::providers ("Unknown" otherwise).
+[[nodiscard]] std::string_view provider_name(MetricProvider provider) noexcept;
+
+/// @brief Cheap monotonically increasing cycle counter.
+[[nodiscard]] inline std::uint64_t read_cycles() noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/// @brief Totals of one provider.
+struct ProviderMetrics {
+    /// Histogram bucket b counts parses of [2^(b-1), 2^b) cycles (bucket 0: 0).
+    static constexpr std::size_t kCycleBuckets = 32;
+
+    std::uint64_t events = 0;    ///< Records dispatched
+    std::uint64_t failures = 0;  ///< Records the parser rejected (valid == false)
+    std::uint64_t cycles = 0;    ///< Parse time summed
+    std::array<std::uint64_t, kCycleBuckets> histogram{};
+};
+
+/// @brief Totals of one event ID of one provider.
+struct EventMetrics {
+    MetricProvider provider = MetricProvider::Unknown;
+    std::uint16_t event_id = 0;  ///< EventDescriptor.Id
+    std::uint64_t events = 0;
+    std::uint64_t failures = 0;
+    std::uint64_t cycles = 0;
+};
+
+/// @brief Aggregate over all threads.
+struct ParseMetricsSnapshot {
+    std::array<ProviderMetrics, kMetricProviders> providers{};  ///< By MetricProvider
+    std::vector<EventMetrics> events;  ///< Most expensive first
+    std::uint64_t untracked = 0;       ///< Records counted per provider only (table full)
+
+    [[nodiscard]] const ProviderMetrics& of(MetricProvider provider) const noexcept {
+        return providers[static_cast<std::size_t>(provider)];
+    }
+};
+
+/**
+ * @brief Process-wide parse counters in per-thread tables.
+ *
+ * Every thread that records gets a table the first time; when it exits
+ * the table (and its counts) is handed to the next new thread. Each
+ * thread tracks up to kEventSlots distinct event IDs; beyond that records
+ * still count for their provider and in untracked.
+ *
+ * Thread-safety: record() from any thread without locks; snapshot() from
+ * any thread (may miss in-flight records); reset() while nothing records.
+ */
+class ParseMetrics {
+public:
+    /// Distinct (provider, event ID) pairs per thread.
+    static constexpr std::size_t kEventSlots = 512;
+
+    /// @brief The process-wide instance used by dispatch_event().
+    [[nodiscard]] static ParseMetrics& global() noexcept;
+
+    ParseMetrics(const ParseMetrics&) = delete;
+    ParseMetrics& operator=(const ParseMetrics&) = delete;
+
+    /// @brief Whether dispatch_event() records (on by default).
+    [[nodiscard]] bool enabled() const noexcept {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    void set_enabled(bool enabled) noexcept {
+        enabled_.store(enabled, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Count one parsed record.
+     * @param provider Provider of the record.
+     * @param event_id EventDescriptor.Id.
+     * @param valid Whether the parser accepted it.
+     * @param cycles Parse time from read_cycles().
+     */
+    void record(MetricProvider provider, std::uint16_t event_id, bool valid,
+                std::uint64_t cycles) noexcept;
+
+    /// @brief Sum the tables of all threads.
+    [[nodiscard]] ParseMetricsSnapshot snapshot() const;
+
+    /// @brief Zero all counters (start of a monitoring session).
+    void reset() noexcept;
+
+    /// @brief Histogram bucket of a parse time.
+    [[nodiscard]] static std::size_t bucket_of(std::uint64_t cycles) noexcept;
+
+private:
+    struct ThreadTable;
+
+    ParseMetrics() = default;
+    ~ParseMetrics();
+
+    friend struct ThreadLease;
+
+    /// @brief Table of the calling thread (allocated on first use).
+    ThreadTable& local();
+
+    /// @brief Hand a table over to future threads.
+    void release(ThreadTable* table) noexcept;
+
+    std::atomic<bool> enabled_{true};
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadTable>> tables_;  ///< Guarded by mutex_
+    std::vector<ThreadTable*> free_;                     ///< Guarded by mutex_
+};
+
+}  // namespace exeray::etw
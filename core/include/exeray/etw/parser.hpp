@@ -6,6 +6,7 @@
 #ifdef _WIN32
 
 #include <cstdint>
+#include <span>
 
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
@@ -14,8 +15,10 @@
 #include <evntrace.h>
 #include <evntcons.h>
 
+#include "exeray/event/extensions.hpp"
 #include "exeray/event/types.hpp"
 #include "exeray/event/payload.hpp"
+#include "exeray/etw/deferred_strings.hpp"
 
 namespace exeray::event {
 class StringPool;  // Forward declaration
@@ -23,11 +26,14 @@ class StringPool;  // Forward declaration
 
 namespace exeray::etw {
 
+class ManifestProviders;
+
 /// @brief Result of parsing an ETW event.
 ///
 /// Contains the extracted event data in a normalized format suitable for
 /// storage in the EventGraph. The `valid` flag indicates whether parsing
-/// succeeded.
+/// succeeded. Inside a DeferredStrings::Scope some string fields of the
+/// payload stay INVALID_STRING until deferred.commit() interns them.
 struct ParsedEvent {
     event::Category category;   ///< Event category (FileSystem, Process, etc.)
     uint8_t operation;          ///< Category-specific operation enum value
@@ -36,6 +42,12 @@ struct ParsedEvent {
     uint64_t timestamp;         ///< Timestamp in 100-ns intervals
     event::EventPayload payload; ///< Category-specific payload data
     bool valid;                 ///< True if parsing succeeded
+    uint64_t object = 0;        ///< Kernel object acted on (FileObject of file events; 0 = none)
+    DeferredStrings deferred{}; ///< Strings viewing the record, not yet interned
+    event::PendingExtension extension{}; ///< Side record, stored only if the event is kept
+    std::span<const std::uint64_t> stack{}; ///< Call stack of the record's extended data
+    uint64_t logon_id = 0;      ///< Logon session of a Security event (0 = none)
+    event::StringId logon_source = event::INVALID_STRING; ///< Source address of a logon
 };
 
 /// @brief Parse a Microsoft-Windows-Kernel-Process event.
@@ -46,6 +58,7 @@ struct ParsedEvent {
 /// - Event ID 1: ProcessStart → ProcessOp::Create
 /// - Event ID 2: ProcessStop → ProcessOp::Terminate
 /// - Event ID 5: ImageLoad → ProcessOp::LoadLibrary
+/// - Event ID 15: ProcessRundown → ProcessOp::Rundown
 ParsedEvent parse_process_event(const EVENT_RECORD* record, event::StringPool* strings);
 
 /// @brief Parse a Microsoft-Windows-Kernel-File event.
@@ -120,6 +133,11 @@ ParsedEvent parse_powershell_event(const EVENT_RECORD* record, event::StringPool
 
 /// @brief Dispatch an ETW event to the appropriate parser based on provider.
 /// @param record Pointer to the raw ETW event record.
+/// @param muted Providers whose records are dropped unparsed, one bit per
+///              MetricProvider (see ConsumerContext::muted).
+/// @param manifests Providers registered at runtime; their records are
+///              decoded from the manifest into Category::Manifest events
+///              (nullptr = none).
 /// @return ParsedEvent from the matching parser, or invalid if unrecognized.
 ///
 /// Routes events by comparing the provider GUID to known kernel providers:
@@ -135,7 +153,10 @@ ParsedEvent parse_powershell_event(const EVENT_RECORD* record, event::StringPool
 /// - DNS_CLIENT → parse_dns_event
 /// - SECURITY_AUDITING → parse_security_event
 /// - WMI_ACTIVITY → parse_wmi_event
-ParsedEvent dispatch_event(const EVENT_RECORD* record, event::StringPool* strings);
+/// - a GUID in manifests → its registration's projection
+ParsedEvent dispatch_event(const EVENT_RECORD* record, event::StringPool* strings,
+                           std::uint32_t muted = 0,
+                           const ManifestProviders* manifests = nullptr);
 
 /// @brief Parse a Microsoft-Antimalware-Scan-Interface event.
 /// @param record Pointer to the raw ETW event record.
@@ -153,6 +174,7 @@ ParsedEvent parse_amsi_event(const EVENT_RECORD* record, event::StringPool* stri
 /// Handles:
 /// - Event ID 3006: Query Completed → DnsOp::Response
 /// - Event ID 3008: Query Failed → DnsOp::Failure
+/// - Event ID 3009: Query Sent → DnsOp::Query
 /// Detects DGA-like suspicious domains using entropy analysis.
 ParsedEvent parse_dns_event(const EVENT_RECORD* record, event::StringPool* strings);
 
@@ -163,6 +185,7 @@ ParsedEvent parse_dns_event(const EVENT_RECORD* record, event::StringPool* strin
 /// Handles:
 /// - Event ID 4624: Logon Success → SecurityOp::Logon
 /// - Event ID 4625: Logon Failed → SecurityOp::LogonFailed (brute force detection)
+/// - Event ID 4634: Logoff → SecurityOp::Logoff (ends the logon session)
 /// - Event ID 4688: Process Create → SecurityOp::ProcessCreate (with command line)
 /// - Event ID 4689: Process Terminate → SecurityOp::ProcessTerminate
 /// - Event ID 4697: Service Install → ServiceOp::Install (AUTO_START = suspicious)
@@ -186,6 +209,7 @@ ParsedEvent parse_wmi_event(const EVENT_RECORD* record, event::StringPool* strin
 /// @return ParsedEvent with CLR operation details.
 ///
 /// Handles:
+/// - Event ID 151: ModuleLoad → ClrOp::ModuleLoad (names the JIT events' module)
 /// - Event ID 152/153: AssemblyLoad → ClrOp::AssemblyLoad
 /// - Event ID 154: AssemblyUnload → ClrOp::AssemblyUnload
 /// - Event ID 155: MethodJit → ClrOp::MethodJit
@@ -198,8 +222,11 @@ ParsedEvent parse_clr_event(const EVENT_RECORD* record, event::StringPool* strin
 
 // Stub declarations for non-Windows platforms
 #include <cstdint>
+#include <span>
+#include "exeray/event/extensions.hpp"
 #include "exeray/event/types.hpp"
 #include "exeray/event/payload.hpp"
+#include "exeray/etw/deferred_strings.hpp"
 
 namespace exeray::event {
 class StringPool;  // Forward declaration
@@ -207,14 +234,22 @@ class StringPool;  // Forward declaration
 
 namespace exeray::etw {
 
+class ManifestProviders;
+
 struct ParsedEvent {
-    event::Category category;
-    uint8_t operation;
-    event::Status status;
-    uint32_t pid;
-    uint64_t timestamp;
-    event::EventPayload payload;
-    bool valid;
+    event::Category category{};
+    uint8_t operation = 0;
+    event::Status status{};
+    uint32_t pid = 0;
+    uint64_t timestamp = 0;
+    event::EventPayload payload{};
+    bool valid = false;
+    uint64_t object = 0;
+    DeferredStrings deferred{};
+    event::PendingExtension extension{};
+    std::span<const std::uint64_t> stack{};
+    uint64_t logon_id = 0;
+    event::StringId logon_source = event::INVALID_STRING;
 };
 
 // Stub function declarations - return invalid events on non-Windows
@@ -272,7 +307,9 @@ inline ParsedEvent parse_clr_event(const EVENT_RECORD* /*record*/, event::String
     return ParsedEvent{.valid = false};
 }
 
-inline ParsedEvent dispatch_event(const EVENT_RECORD* /*record*/, event::StringPool* /*strings*/) {
+inline ParsedEvent dispatch_event(const EVENT_RECORD* /*record*/, event::StringPool* /*strings*/,
+                                  std::uint32_t /*muted*/ = 0,
+                                  const ManifestProviders* /*manifests*/ = nullptr) {
     return ParsedEvent{.valid = false};
 }
 
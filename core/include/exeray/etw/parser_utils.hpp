@@ -16,11 +16,16 @@
 #include <cstring>
 #include <string_view>
 
+#include "exeray/event/string_pool.hpp"
 #include "exeray/event/types.hpp"
 #include "exeray/etw/parser.hpp"
 
 namespace exeray::etw {
 
+/// @brief Warnings per second a parser call site may log about suspicious
+/// events (EXERAY_WARN_LIMITED); the events themselves are always stored.
+inline constexpr std::uint32_t kSuspiciousLogsPerSecond = 10;
+
 /// @brief Extract common fields from EVENT_RECORD header.
 /// @param record Pointer to the raw ETW event record.
 /// @param out Output ParsedEvent to populate.
@@ -62,6 +67,37 @@ inline std::wstring_view extract_wstring(const uint8_t* data, size_t max_len) {
     return {wdata, len};
 }
 
+/// @brief Set a UTF-16 string field of out.payload from a view into UserData.
+///
+/// Inside a DeferredStrings::Scope the view is recorded for the consumer
+/// to intern once the event is kept; otherwise it is interned now. Empty
+/// text or a null pool leave the field INVALID_STRING.
+inline void set_wstring(ParsedEvent& out, event::StringId& field, std::wstring_view text,
+                        event::StringPool* strings, StringKind kind = StringKind::Wide) {
+    field = event::INVALID_STRING;
+    if (text.empty() || strings == nullptr) {
+        return;
+    }
+    if (DeferredStrings::active() && out.deferred.add(out.payload, field, text, kind)) {
+        return;
+    }
+    field = kind == StringKind::WidePath ? strings->intern_path_wide(text)
+                                         : strings->intern_wide(text);
+}
+
+/// @brief set_wstring() of 8-bit text.
+inline void set_string(ParsedEvent& out, event::StringId& field, std::string_view text,
+                       event::StringPool* strings) {
+    field = event::INVALID_STRING;
+    if (text.empty() || strings == nullptr) {
+        return;
+    }
+    if (DeferredStrings::active() && out.deferred.add(out.payload, field, text)) {
+        return;
+    }
+    field = strings->intern(text);
+}
+
 }  // namespace exeray::etw
 
 #else  // !_WIN32
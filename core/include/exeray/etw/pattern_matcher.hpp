@@ -0,0 +1,210 @@
+#pragma once
+
+/// @file pattern_matcher.hpp
+/// @brief Case-insensitive multi-pattern matching in one pass (Aho-Corasick).
+///
+/// Script blocks can be many kilobytes, and searching them once per pattern
+/// stalls the ETW callback. PatternMatcher compiles a fixed pattern set into
+/// a DFA at compile time: each text character costs one class lookup and
+/// one transition, whatever the number of patterns. ASCII case folding is
+/// part of the character classes, so the text is neither copied nor
+/// lowercased.
+///
+/// @code
+/// constexpr auto kMatcher = make_pattern_matcher([] {
+///     return std::array<std::string_view, 2>{"iex", "bypass"};
+/// });
+/// const PatternMask found = kMatcher.match(script);  // Bit i: pattern i
+/// @endcode
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace exeray::etw {
+
+/// @brief Set of matched patterns, bit i for pattern i.
+using PatternMask = std::uint64_t;
+
+namespace pattern_detail {
+
+constexpr std::size_t kAscii = 128;
+
+constexpr char fold(char c) noexcept {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+/// @brief Trie nodes for the patterns, the root included.
+template <std::size_t N>
+consteval std::size_t count_states(const std::array<std::string_view, N>& patterns) {
+    std::size_t states = 1;
+    for (std::size_t i = 0; i < N; ++i) {
+        for (std::size_t length = 1; length <= patterns[i].size(); ++length) {
+            bool seen = false;  // Prefix shared with an earlier pattern
+            for (std::size_t j = 0; j < i && !seen; ++j) {
+                if (patterns[j].size() < length) {
+                    continue;
+                }
+                seen = true;
+                for (std::size_t k = 0; k < length; ++k) {
+                    if (fold(patterns[j][k]) != fold(patterns[i][k])) {
+                        seen = false;
+                        break;
+                    }
+                }
+            }
+            states += seen ? 0 : 1;
+        }
+    }
+    return states;
+}
+
+/// @brief Distinct (folded) characters of the patterns, plus one for the rest.
+template <std::size_t N>
+consteval std::size_t count_classes(const std::array<std::string_view, N>& patterns) {
+    std::array<bool, kAscii> used{};
+    std::size_t classes = 1;
+    for (const std::string_view pattern : patterns) {
+        for (const char c : pattern) {
+            const auto folded = static_cast<unsigned char>(fold(c));
+            if (folded < kAscii && !used[folded]) {
+                used[folded] = true;
+                ++classes;
+            }
+        }
+    }
+    return classes;
+}
+
+}  // namespace pattern_detail
+
+/**
+ * @brief Aho-Corasick automaton over Patterns fixed ASCII patterns.
+ *
+ * Text characters outside ASCII are skipped, as if absent from the text.
+ * Build it with make_pattern_matcher(), which sizes the tables.
+ *
+ * Thread-safety: immutable; match() from any thread.
+ */
+template <std::size_t Patterns, std::size_t States, std::size_t Classes>
+class PatternMatcher {
+    static_assert(Patterns >= 1 && Patterns <= 64, "PatternMask has 64 bits");
+    static_assert(States <= UINT16_MAX, "states are 16-bit");
+    static_assert(Classes <= UINT8_MAX, "classes are 8-bit");
+
+public:
+    consteval explicit PatternMatcher(const std::array<std::string_view, Patterns>& patterns) {
+        // Character classes: 0 for characters no pattern contains
+        std::uint8_t next_class = 1;
+        for (const std::string_view pattern : patterns) {
+            for (const char c : pattern) {
+                const auto folded = static_cast<unsigned char>(pattern_detail::fold(c));
+                if (folded >= pattern_detail::kAscii) {
+                    throw "patterns must be ASCII";  // Not a constant expression
+                }
+                if (class_of_[folded] == 0) {
+                    class_of_[folded] = next_class++;
+                }
+            }
+        }
+        for (char c = 'A'; c <= 'Z'; ++c) {
+            class_of_[static_cast<unsigned char>(c)] =
+                class_of_[static_cast<unsigned char>(pattern_detail::fold(c))];
+        }
+
+        // Trie; a 0 transition means none yet (the root is nobody's child)
+        std::uint16_t next_state = 1;
+        for (std::size_t i = 0; i < Patterns; ++i) {
+            if (patterns[i].empty()) {
+                throw "patterns must not be empty";
+            }
+            std::uint16_t state = 0;
+            for (const char c : patterns[i]) {
+                const std::uint8_t cls = class_of_[static_cast<unsigned char>(c)];
+                if (next_[state][cls] == 0) {
+                    next_[state][cls] = next_state++;
+                }
+                state = next_[state][cls];
+            }
+            output_[state] |= PatternMask{1} << i;
+        }
+
+        // Failure links in breadth-first order, folded into the transitions
+        std::array<std::uint16_t, States> fail{};
+        std::array<std::uint16_t, States> queue{};
+        std::size_t head = 0;
+        std::size_t tail = 0;
+        for (std::size_t cls = 0; cls < Classes; ++cls) {
+            if (next_[0][cls] != 0) {
+                queue[tail++] = next_[0][cls];
+            }
+        }
+        while (head < tail) {
+            const std::uint16_t state = queue[head++];
+            output_[state] |= output_[fail[state]];
+            for (std::size_t cls = 0; cls < Classes; ++cls) {
+                const std::uint16_t child = next_[state][cls];
+                if (child != 0) {
+                    fail[child] = next_[fail[state]][cls];
+                    queue[tail++] = child;
+                } else {
+                    next_[state][cls] = next_[fail[state]][cls];
+                }
+            }
+        }
+    }
+
+    /// @brief Every pattern that occurs in text.
+    template <typename Char>
+    [[nodiscard]] constexpr PatternMask match(std::basic_string_view<Char> text) const noexcept {
+        PatternMask found = 0;
+        std::uint16_t state = 0;
+        for (const Char c : text) {
+            const auto code = static_cast<std::make_unsigned_t<Char>>(c);
+            if (code >= pattern_detail::kAscii) {
+                continue;
+            }
+            state = next_[state][class_of_[code]];
+            found |= output_[state];
+        }
+        return found;
+    }
+
+    [[nodiscard]] constexpr PatternMask match(std::string_view text) const noexcept {
+        return match<char>(text);
+    }
+
+    [[nodiscard]] constexpr PatternMask match(std::wstring_view text) const noexcept {
+        return match<wchar_t>(text);
+    }
+
+    /// @brief Index of the first pattern in found (Patterns if none).
+    [[nodiscard]] static constexpr std::size_t first(PatternMask found) noexcept {
+        return found == 0 ? Patterns : static_cast<std::size_t>(std::countr_zero(found));
+    }
+
+    [[nodiscard]] static constexpr std::size_t pattern_count() noexcept { return Patterns; }
+    [[nodiscard]] static constexpr std::size_t state_count() noexcept { return States; }
+
+private:
+    std::array<std::uint8_t, pattern_detail::kAscii> class_of_{};
+    std::array<std::array<std::uint16_t, Classes>, States> next_{};
+    std::array<PatternMask, States> output_{};
+};
+
+/**
+ * @brief Build a PatternMatcher at compile time.
+ * @param source Captureless lambda returning a std::array<std::string_view, N>
+ *        of non-empty ASCII patterns (matched case-insensitively).
+ */
+template <typename Source>
+consteval auto make_pattern_matcher(Source /*source*/) {
+    constexpr auto patterns = Source{}();
+    return PatternMatcher<patterns.size(), pattern_detail::count_states(patterns),
+                          pattern_detail::count_classes(patterns)>(patterns);
+}
+
+}  // namespace exeray::etw
@@ -0,0 +1,65 @@
+#pragma once
+
+/// @file provider_presets.hpp
+/// @brief Curated level, keyword and event ID sets per provider.
+///
+/// Enabling a provider with every keyword pulls in events no parser reads
+/// (every registry query, every file read), and each one costs a
+/// buffer slot, a callback and a parse. A preset enables only what the
+/// parsers and detectors use, filtered by ETW before anything is buffered:
+///
+/// | Preset   | Keeps                                              | Volume      |
+/// |----------|----------------------------------------------------|-------------|
+/// | Minimal  | Process lifetime, image loads, file create/delete, | lowest      |
+/// |          | registry writes, TCP connects, script blocks       |             |
+/// | Security | Minimal plus threads, file writes and cleanup,     | moderate    |
+/// |          | key opens/closes, UDP, cmdlet logging, DNS failures|             |
+/// | Full     | Every keyword (the ProviderConfig::keywords = 0    | everything  |
+/// |          | behaviour); memory at VERBOSE                      |             |
+///
+/// File reads and TCP/UDP transfers dominate host-wide volume; Security
+/// drops file reads, Minimal also drops writes and transfers. Compare the
+/// events/s of a workload per preset with Engine::parse_metrics().
+///
+/// Security and Full also name the events worth a call stack: thread
+/// starts, virtual allocations and AMSI scans, the usual marks of injected
+/// code. Stacks are only captured with EngineConfig::capture_stacks.
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace exeray::etw {
+
+/// @brief Named provider settings; Custom uses the ProviderConfig fields.
+enum class ProviderPreset : std::uint8_t {
+    Custom = 0,
+    Minimal,
+    Security,
+    Full,
+};
+
+/// @brief What a preset enables for one provider.
+struct PresetSettings {
+    std::uint8_t level = 4;                   ///< TRACE_LEVEL_*
+    std::uint64_t keywords = 0;               ///< 0 = all keywords
+    std::span<const std::uint16_t> event_ids; ///< Empty = all events
+    /// Events captured with their call stack (EngineConfig::capture_stacks)
+    std::span<const std::uint16_t> stack_event_ids{};
+};
+
+/**
+ * @brief Settings of preset for a provider name of EngineConfig::providers.
+ * @return nullopt for ProviderPreset::Custom or an unknown provider.
+ */
+[[nodiscard]] std::optional<PresetSettings> provider_preset(std::string_view provider,
+                                                            ProviderPreset preset);
+
+/// @brief "minimal", "security", "full" or "custom" (case-sensitive).
+[[nodiscard]] std::optional<ProviderPreset> parse_provider_preset(std::string_view name);
+
+/// @brief Lower-case name of a preset.
+[[nodiscard]] std::string_view preset_name(ProviderPreset preset);
+
+}  // namespace exeray::etw
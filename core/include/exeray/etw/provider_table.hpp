@@ -0,0 +1,101 @@
+#pragma once
+
+/// @file provider_table.hpp
+/// @brief Flat open-addressing table keyed on provider GUIDs.
+///
+/// Event dispatch looks up the provider of every record. With about a dozen
+/// providers a node-based hash map costs a full GUID hash and a pointer
+/// chase per event; ProviderTable keeps the entries in one small array,
+/// indexes it with the low bits of Data1 and confirms the hit with one
+/// 16-byte compare. For the known providers the low six bits of Data1 are
+/// all distinct, so with 64 slots every lookup is a direct hit.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "exeray/platform/guid.hpp"
+
+namespace exeray::etw {
+
+/**
+ * @brief Fixed-capacity GUID -> value map with linear probing.
+ *
+ * @tparam T Value type (typically a function pointer).
+ * @tparam Slots Number of slots, a power of two; keep it well above the
+ *               number of entries so probes stay short.
+ *
+ * Thread-safety: fill once, then find() from any thread.
+ */
+template <typename T, std::size_t Slots = 64>
+class ProviderTable {
+    static_assert(Slots >= 2 && (Slots & (Slots - 1)) == 0, "Slots must be a power of two");
+
+public:
+    /**
+     * @brief Add an entry.
+     * @return false if the GUID is already present or the table is full.
+     */
+    bool insert(const GUID& key, T value) noexcept {
+        for (std::size_t i = 0, slot = home(key); i < Slots; ++i, slot = (slot + 1) & kMask) {
+            Entry& entry = entries_[slot];
+            if (!entry.used) {
+                entry = Entry{key, value, true};
+                return true;
+            }
+            if (same(entry.key, key)) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    /// @brief Value for a GUID, nullptr if absent.
+    [[nodiscard]] const T* find(const GUID& key) const noexcept {
+        for (std::size_t i = 0, slot = home(key); i < Slots; ++i, slot = (slot + 1) & kMask) {
+            const Entry& entry = entries_[slot];
+            if (!entry.used) {
+                return nullptr;
+            }
+            if (same(entry.key, key)) {
+                return &entry.value;
+            }
+        }
+        return nullptr;
+    }
+
+    /// @brief Slots probed before find() resolves a GUID (1 = direct hit).
+    [[nodiscard]] std::size_t probes(const GUID& key) const noexcept {
+        std::size_t count = 1;
+        for (std::size_t slot = home(key); count <= Slots; ++count, slot = (slot + 1) & kMask) {
+            const Entry& entry = entries_[slot];
+            if (!entry.used || same(entry.key, key)) {
+                break;
+            }
+        }
+        return count;
+    }
+
+private:
+    static constexpr std::size_t kMask = Slots - 1;
+
+    struct Entry {
+        GUID key{};
+        T value{};
+        bool used = false;
+    };
+
+    /// @brief Home slot: Data1 is random enough to use its low bits as is.
+    static std::size_t home(const GUID& key) noexcept {
+        return static_cast<std::size_t>(key.Data1) & kMask;
+    }
+
+    static bool same(const GUID& a, const GUID& b) noexcept {
+        return std::memcmp(&a, &b, sizeof(GUID)) == 0;
+    }
+
+    std::array<Entry, Slots> entries_{};
+};
+
+}  // namespace exeray::etw
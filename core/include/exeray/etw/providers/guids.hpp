@@ -29,6 +29,9 @@ extern const GUID KERNEL_THREAD;
 /// Virtual memory events provider (PageFault)
 extern const GUID KERNEL_MEMORY;
 
+/// Stack walk events of the classic kernel providers (StackWalk_Event)
+extern const GUID KERNEL_STACK_WALK;
+
 /// Microsoft-Windows-PowerShell provider
 extern const GUID POWERSHELL;
 
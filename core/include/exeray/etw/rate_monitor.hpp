@@ -0,0 +1,127 @@
+#pragma once
+
+/// @file rate_monitor.hpp
+/// @brief Per-process event rate baselines and spike detection.
+///
+/// Ransomware and exfiltration show up as a sudden burst of file writes or
+/// network sends from one process rather than as any single bad event.
+/// RateMonitor counts each (process, category) pair per window, keeps an
+/// exponentially weighted moving average of the per-window rate as its
+/// baseline, and reports the event that takes the current window past
+/// factor times that baseline. The consumer marks that event Suspicious.
+///
+/// Entries live in a fixed table: a pair is found in a bounded probe of its
+/// bucket, and a new pair reuses an idle entry or evicts the least recently
+/// seen one of the probe, so both the cost per event and the memory are
+/// constant however many processes come and go.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "exeray/event/types.hpp"
+
+namespace exeray::etw {
+
+/// @brief Rate detection settings.
+struct RateConfig {
+    bool enabled = false;              ///< Track rates at all
+    double factor = 10.0;              ///< Flag a window above factor x baseline
+    double min_rate = 100.0;           ///< Events/s never flagged, whatever the baseline
+    double alpha = 0.1;                ///< EWMA weight of the newest window
+    std::uint32_t window_ms = 1000;    ///< Rate measurement window
+    std::uint32_t warmup_windows = 5;  ///< Windows a pair is watched before flagging
+    std::uint32_t idle_ms = 60000;     ///< An entry this long unused may be reused
+    std::size_t capacity = 4096;       ///< (process, category) pairs tracked
+};
+
+/// @brief One window in which a process exceeded its baseline.
+struct RateAnomaly {
+    std::uint32_t pid = 0;
+    event::Category category = event::Category::Count;
+    double rate = 0.0;        ///< Events/s implied by the window so far
+    double baseline = 0.0;    ///< Events/s the EWMA expected
+    event::Timestamp at = 0;  ///< Time of the event that crossed the threshold
+};
+
+/// @brief What the monitor did in the current or last session.
+struct RateStats {
+    std::uint64_t observed = 0;   ///< Events counted
+    std::uint64_t anomalies = 0;  ///< Windows flagged
+    std::uint64_t evicted = 0;    ///< Active pairs pushed out by a new one
+    std::uint64_t tracked = 0;    ///< Pairs in the table now
+};
+
+/**
+ * @brief Fixed-size table of (process, category) rate baselines.
+ *
+ * Thread-safety: observe(), anomalies() and stats() from any thread (the
+ * table is sharded by pid, each shard with its own mutex); clear() between
+ * sessions.
+ */
+class RateMonitor {
+public:
+    static constexpr std::size_t kShards = 16;
+    static constexpr std::size_t kProbe = 8;           ///< Entries searched per pair
+    static constexpr std::size_t kMaxAnomalies = 256;  ///< Most recent kept
+
+    explicit RateMonitor(const RateConfig& config = {});
+
+    RateMonitor(const RateMonitor&) = delete;
+    RateMonitor& operator=(const RateMonitor&) = delete;
+
+    /**
+     * @brief Count one event.
+     * @param pid Process it belongs to (0 is not tracked).
+     * @param category Event category.
+     * @param at Event time (graph clock).
+     * @return true for the event that takes its window past the threshold.
+     */
+    bool observe(std::uint32_t pid, event::Category category, event::Timestamp at);
+
+    /// @brief Most recent anomalies, oldest first (at most kMaxAnomalies).
+    [[nodiscard]] std::vector<RateAnomaly> anomalies() const;
+
+    [[nodiscard]] RateStats stats() const;
+
+    /// @brief Forget every baseline and anomaly (start of a session).
+    void clear();
+
+private:
+    struct Entry {
+        std::uint32_t pid = 0;  ///< 0 = free
+        event::Category category = event::Category::Count;
+        bool flagged = false;       ///< Current window already reported
+        std::uint32_t windows = 0;  ///< Windows since first seen
+        std::uint32_t count = 0;    ///< Events in the current window
+        event::Timestamp window_start = 0;
+        event::Timestamp last_seen = 0;
+        double baseline = 0.0;  ///< EWMA of events per window
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unique_ptr<Entry[]> entries;
+        std::uint64_t observed = 0;
+        std::uint64_t evicted = 0;
+    };
+
+    Entry& find(Shard& shard, std::uint32_t pid, event::Category category, event::Timestamp at);
+    void roll(Entry& entry, event::Timestamp at) const noexcept;
+
+    RateConfig config_;
+    event::Timestamp window_;  ///< ns
+    event::Timestamp idle_;    ///< ns
+    std::size_t shard_size_;   ///< Entries per shard (multiple of kProbe)
+    std::array<Shard, kShards> shards_;
+
+    mutable std::mutex anomaly_mutex_;
+    std::vector<RateAnomaly> anomalies_;  ///< Ring of kMaxAnomalies
+    std::size_t next_anomaly_ = 0;
+    std::uint64_t anomaly_count_ = 0;
+};
+
+}  // namespace exeray::etw
@@ -0,0 +1,182 @@
+#pragma once
+
+/// @file record_ring.hpp
+/// @brief Lock-free single-producer/single-consumer ring of raw ETW records.
+///
+/// The ProcessTrace callback must return quickly or ETW drops buffers. With
+/// a ring the callback only copies the record (header, extended data and
+/// UserData) into pre-allocated memory; parsing, correlation and graph
+/// insertion run on a worker that drains the ring.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+
+namespace exeray::etw {
+
+/**
+ * @brief Byte ring of variable-length records, one producer, one consumer.
+ *
+ * Records are 8-byte aligned and never wrap: a record that does not fit in
+ * the space left before the end is written at the start, after a skip
+ * marker. A record that does not fit at all is dropped and counted in
+ * overflows(); the producer never blocks.
+ *
+ * Thread-safety: begin_write()/commit_write() from one thread, front()/
+ * pop()/wait() from one other thread; counters and close() from any.
+ */
+class RecordRing {
+public:
+    /// Record alignment and length prefix size.
+    static constexpr std::size_t kAlign = 8;
+
+    /// @param capacity Ring size in bytes (rounded up to a power of two, at
+    ///                 least 4 KiB).
+    explicit RecordRing(std::size_t capacity);
+
+    RecordRing(const RecordRing&) = delete;
+    RecordRing& operator=(const RecordRing&) = delete;
+
+    /**
+     * @brief Reserve a record of size bytes (producer).
+     * @param size Record size, greater than 0 (front() is empty only when
+     *             the ring is).
+     * @return Where to write the record, nullptr if the ring is full.
+     */
+    std::uint8_t* begin_write(std::size_t size) noexcept {
+        const auto need = record_bytes(size);
+        const auto offset = static_cast<std::size_t>(head_ & mask_);
+        const auto contiguous = capacity_ - offset;
+        const auto total = need <= contiguous ? need : contiguous + need;
+        if (need > capacity_ || head_ + total - cached_tail_ > capacity_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (need > capacity_ || head_ + total - cached_tail_ > capacity_) {
+                overflows_.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+        std::uint8_t* record = buffer_.get() + offset;
+        if (need > contiguous) {
+            store_length(record, kSkip);
+            head_ += contiguous;
+            record = buffer_.get();
+        }
+        store_length(record, static_cast<std::uint32_t>(size));
+        pending_ = need;
+        return record + kAlign;
+    }
+
+    /// @brief Publish the record reserved by begin_write() (producer).
+    void commit_write() noexcept {
+        head_ += pending_;
+        published_.store(head_, std::memory_order_release);
+        pushed_.fetch_add(1, std::memory_order_relaxed);
+        // Pairs with wait(): either it sees the record or we see it asleep
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping_.load(std::memory_order_relaxed)) {
+            wake();
+        }
+    }
+
+    /**
+     * @brief Oldest unconsumed record (consumer).
+     * @return The record, empty if the ring is empty.
+     */
+    std::span<const std::uint8_t> front() noexcept {
+        if (tail_local_ == cached_head_) {
+            cached_head_ = published_.load(std::memory_order_acquire);
+            if (tail_local_ == cached_head_) {
+                return {};
+            }
+        }
+        auto offset = static_cast<std::size_t>(tail_local_ & mask_);
+        if (load_length(buffer_.get() + offset) == kSkip) {
+            tail_local_ += capacity_ - offset;
+            offset = 0;
+        }
+        const std::uint8_t* record = buffer_.get() + offset;
+        return {record + kAlign, load_length(record)};
+    }
+
+    /// @brief Release the record returned by front() (consumer).
+    void pop() noexcept {
+        const auto offset = static_cast<std::size_t>(tail_local_ & mask_);
+        tail_local_ += record_bytes(load_length(buffer_.get() + offset));
+        tail_.store(tail_local_, std::memory_order_release);
+    }
+
+    /**
+     * @brief Block until a record is available or the ring is closed.
+     * @return false once the ring is closed and drained.
+     */
+    bool wait() noexcept;
+
+    /// @brief Wake the consumer for good; records already pushed stay readable.
+    void close() noexcept;
+
+    /// @brief Ring size in bytes.
+    [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+
+    /// @brief Bytes published but not yet popped (approximate from any thread).
+    [[nodiscard]] std::size_t used() const noexcept {
+        const auto tail = tail_.load(std::memory_order_acquire);
+        const auto head = published_.load(std::memory_order_acquire);
+        return head > tail ? static_cast<std::size_t>(head - tail) : 0;
+    }
+
+    /// @brief Records accepted so far.
+    [[nodiscard]] std::uint64_t pushed() const noexcept {
+        return pushed_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Records dropped because the ring was full.
+    [[nodiscard]] std::uint64_t overflows() const noexcept {
+        return overflows_.load(std::memory_order_relaxed);
+    }
+
+private:
+    /// Length prefix of a skip marker (rest of the buffer is unused).
+    static constexpr std::uint32_t kSkip = 0xFFFFFFFFU;
+
+    static constexpr std::size_t record_bytes(std::size_t size) noexcept {
+        return kAlign + ((size + kAlign - 1) & ~(kAlign - 1));
+    }
+
+    static void store_length(std::uint8_t* at, std::uint32_t length) noexcept {
+        std::memcpy(at, &length, sizeof(length));
+    }
+
+    static std::uint32_t load_length(const std::uint8_t* at) noexcept {
+        std::uint32_t length;
+        std::memcpy(&length, at, sizeof(length));
+        return length;
+    }
+
+    void wake() noexcept;
+
+    std::size_t capacity_;
+    std::size_t mask_;
+    std::unique_ptr<std::uint8_t[]> buffer_;
+
+    // Producer side
+    alignas(64) std::uint64_t head_ = 0;  ///< Write position (producer only)
+    std::uint64_t cached_tail_ = 0;
+    std::size_t pending_ = 0;
+    std::atomic<std::uint64_t> published_{0};  ///< head_ as seen by the consumer
+
+    // Consumer side
+    alignas(64) std::uint64_t tail_local_ = 0;  ///< Read position (consumer only)
+    std::uint64_t cached_head_ = 0;
+    std::atomic<std::uint64_t> tail_{0};  ///< tail_local_ as seen by the producer
+
+    alignas(64) std::atomic<bool> sleeping_{false};
+    std::atomic<std::uint32_t> signal_{0};
+    std::atomic<bool> closed_{false};
+    std::atomic<std::uint64_t> pushed_{0};
+    std::atomic<std::uint64_t> overflows_{0};
+};
+
+}  // namespace exeray::etw
@@ -0,0 +1,154 @@
+#pragma once
+
+/// @file regex_dfa.hpp
+/// @brief Regular expression search by a lazily built DFA.
+///
+/// Detection rules can test a string field against a regular expression
+/// (RuleOp::Matches). A backtracking engine costs exponential time on
+/// hostile input, and a DFA built up front can have exponentially many
+/// states. RegexDfa compiles the pattern to an NFA and builds DFA states
+/// only as the text reaches them, one transition per byte class, caching at
+/// most a fixed number of states: when the cache is full it is flushed and
+/// the search goes on from the current state. Each byte costs one table
+/// load once its transition is cached, and the cache can never grow past
+/// its bound whatever the pattern or text.
+///
+/// Before running the DFA, search() looks for the literals the pattern
+/// requires (e.g. "powershell" in `power(shell|_ise)\.exe`) with
+/// contains_icase(); text containing none of them is rejected without a DFA
+/// step.
+///
+/// Syntax: literals, `.`, `[...]` and `[^...]` classes with ranges, the
+/// escapes `\d \D \w \W \s \S \t \n \r \xHH` and escaped punctuation,
+/// groups `(...)` and `(?:...)`, `|`, and the quantifiers `* + ? {m} {m,}
+/// {m,n}` (a trailing `?` is accepted and ignored). `^` may start and `$`
+/// may end the pattern; without them, the pattern may match anywhere in
+/// the text. Matching ignores ASCII case, as the other string comparisons
+/// of the rules do; other bytes compare exactly, and `.` matches any byte
+/// but '\n'.
+///
+/// @code
+/// const char* reason = nullptr;
+/// auto regex = RegexDfa::compile(R"(\\(temp|appdata)\\[^\\]+\.exe$)", &reason);
+/// if (regex && regex->search(path)) { ... }
+/// @endcode
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace exeray::etw {
+
+namespace regex_detail {
+
+/// @brief One NFA instruction.
+struct Inst {
+    enum class Op : std::uint8_t { Byte, Split, Jump, Match } op = Op::Match;
+    std::uint32_t set = 0;  ///< Byte: index of the byte set
+    std::uint32_t x = 0;    ///< Byte, Jump and Split: next instruction
+    std::uint32_t y = 0;    ///< Split: alternative next instruction
+};
+
+}  // namespace regex_detail
+
+/**
+ * @brief A compiled regular expression and its DFA state cache.
+ *
+ * Thread-safety: search() may be called from any thread; the cache is
+ * guarded by a mutex held for the whole search.
+ */
+class RegexDfa {
+public:
+    static constexpr std::size_t kDefaultMaxStates = 256;
+
+    /**
+     * @brief Compile a pattern written in the syntax of the file comment.
+     * @param reason Receives why the pattern was rejected.
+     * @param max_states DFA states cached before a flush (at least 4).
+     * @return nullptr if the pattern is invalid or too large.
+     */
+    [[nodiscard]] static std::unique_ptr<RegexDfa> compile(
+        std::string_view pattern, const char** reason = nullptr,
+        std::size_t max_states = kDefaultMaxStates);
+
+    RegexDfa(const RegexDfa&) = delete;
+    RegexDfa& operator=(const RegexDfa&) = delete;
+
+    /// @brief Whether the pattern matches text (anywhere, unless anchored).
+    /// @throws std::bad_alloc if a new DFA state cannot be cached; the
+    ///         cache is flushed first, so later searches still work.
+    [[nodiscard]] bool search(std::string_view text);
+
+    /// @brief Literals of which every match contains at least one, in
+    /// lowercase (empty: no prefilter).
+    [[nodiscard]] const std::vector<std::string>& literals() const noexcept {
+        return literals_;
+    }
+
+    /// @brief DFA states currently cached.
+    [[nodiscard]] std::size_t cached_states() const;
+
+    /// @brief Times the state cache was full and flushed.
+    [[nodiscard]] std::uint64_t flushes() const;
+
+private:
+    using Inst = regex_detail::Inst;
+
+    /// @brief A cached DFA state: the NFA byte and match instructions it stands for.
+    struct State {
+        std::vector<std::uint32_t> insts;  ///< Sorted
+        bool match = false;
+    };
+
+    struct StateHash {
+        std::size_t operator()(const std::vector<std::uint32_t>& insts) const noexcept;
+    };
+
+    static constexpr std::int32_t kUnknown = -1;
+
+    RegexDfa() = default;
+
+    /// @brief Index of the state for an instruction set, adding it (and
+    /// flushing a full cache first) if needed.
+    std::int32_t state_for(std::vector<std::uint32_t>& insts);
+
+    /// @brief Add an instruction, and those reachable from it without
+    /// consuming a byte, to work_ (byte and match instructions only).
+    void close(std::uint32_t pc);
+
+    /// @brief Reset the scratch of close() for a new instruction set.
+    void begin_closure();
+
+    /// @brief Transition of state s on byte class c, computing it if needed.
+    std::int32_t step(std::int32_t s, std::uint8_t c);
+
+    void flush();
+
+    std::vector<Inst> program_;
+    std::vector<std::bitset<256>> sets_;    ///< Bytes each Byte instruction accepts
+    std::uint8_t classes_[256] = {};        ///< Byte class of each byte
+    std::vector<std::uint8_t> class_byte_;  ///< A byte of each class
+    std::uint32_t start_ = 0;
+    bool anchored_start_ = false;
+    bool anchored_end_ = false;
+    std::vector<std::string> literals_;
+    std::size_t max_states_ = kDefaultMaxStates;
+
+    mutable std::mutex mutex_;  ///< Guards the cache below
+    std::vector<State> states_;
+    std::unordered_map<std::vector<std::uint32_t>, std::int32_t, StateHash> index_;
+    std::vector<std::int32_t> next_;  ///< states_ x byte classes, kUnknown if not computed
+    std::int32_t start_state_ = kUnknown;
+    std::uint64_t flushes_ = 0;
+    std::vector<std::uint32_t> work_;   ///< Instruction set being built
+    std::vector<std::uint8_t> seen_;    ///< Instructions already in work_'s closure
+    std::vector<std::uint32_t> stack_;  ///< Pending instructions of close()
+};
+
+}  // namespace exeray::etw
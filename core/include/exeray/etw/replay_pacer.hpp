@@ -0,0 +1,75 @@
+#pragma once
+
+/// @file replay_pacer.hpp
+/// @brief Wall-clock pacing of records replayed from a trace file.
+///
+/// A trace file is consumed as fast as ProcessTrace can read it, which is
+/// what a throughput benchmark wants. To reproduce a capture's timing (for
+/// detectors with time windows, or a live-looking UI) ReplayPacer holds
+/// each record back until as much wall time has passed since the first
+/// record as the capture recorded between them, divided by the speed.
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace exeray::etw {
+
+/**
+ * @brief Delays records so that replay follows their recorded spacing.
+ *
+ * Timestamps are ETW FILETIME ticks (100 ns), as delivered to the record
+ * callback. The first record anchors the schedule; records stamped before
+ * it are never delayed.
+ *
+ * Thread-safety: one instance per consuming thread.
+ */
+class ReplayPacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// @param speed Replay speed (1 = as recorded, 2 = twice as fast).
+    explicit ReplayPacer(double speed = 1.0) noexcept
+        : speed_(speed > 0.0 ? speed : 1.0) {}
+
+    /**
+     * @brief Wall time to hold back a record stamped etw_timestamp.
+     * @param etw_timestamp Record timestamp (FILETIME ticks).
+     * @param now Current time; the first call anchors the schedule.
+     * @return Time to wait (zero if the record is already due).
+     */
+    [[nodiscard]] std::chrono::nanoseconds delay(std::uint64_t etw_timestamp,
+                                                 Clock::time_point now) noexcept {
+        if (!anchored_) {
+            anchored_ = true;
+            first_timestamp_ = etw_timestamp;
+            start_ = now;
+            return std::chrono::nanoseconds{0};
+        }
+        if (etw_timestamp <= first_timestamp_) {
+            return std::chrono::nanoseconds{0};
+        }
+        const double recorded_ns = static_cast<double>(etw_timestamp - first_timestamp_) * 100.0;
+        const auto due = start_ + std::chrono::nanoseconds(
+                                      static_cast<std::int64_t>(recorded_ns / speed_));
+        return due > now ? std::chrono::duration_cast<std::chrono::nanoseconds>(due - now)
+                         : std::chrono::nanoseconds{0};
+    }
+
+    /// @brief Sleep until a record stamped etw_timestamp is due.
+    void pace(std::uint64_t etw_timestamp) {
+        const auto wait = delay(etw_timestamp, Clock::now());
+        // Shorter waits are below sleep granularity; they even out later
+        if (wait >= std::chrono::milliseconds(1)) {
+            std::this_thread::sleep_for(wait);
+        }
+    }
+
+private:
+    double speed_;
+    bool anchored_ = false;
+    std::uint64_t first_timestamp_ = 0;
+    Clock::time_point start_{};
+};
+
+}  // namespace exeray::etw
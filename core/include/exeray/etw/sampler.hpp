@@ -0,0 +1,150 @@
+#pragma once
+
+/// @file sampler.hpp
+/// @brief Deterministic per-category sampling of ingested events.
+///
+/// System-wide monitoring cannot store every file read of every process.
+/// Sampler keeps a configured fraction of a category or operation at any
+/// load (ShedPolicy only acts under pressure). Whether an event is kept is
+/// decided by a hash of the process incarnation and the event's subject
+/// (the path of a file event, the key of a registry event, ...), not by a
+/// counter or a random draw. A process reading the same file a thousand
+/// times therefore keeps all of those reads or none, and a rerun of the
+/// same workload keeps the same events. A process whose risk score reaches
+/// SamplingConfig::promote_score is promoted to keep everything for the
+/// rest of its incarnation.
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "exeray/event/payload.hpp"
+#include "exeray/event/types.hpp"
+
+namespace exeray::etw {
+
+/// @brief Fraction of one category, or of one of its operations, to keep.
+struct SampleRule {
+    /// Matches every operation of the category.
+    static constexpr std::uint16_t kAnyOperation = 0x100;
+
+    event::Category category = event::Category::FileSystem;
+    std::uint16_t operation = kAnyOperation;  ///< Operation code or kAnyOperation
+    double rate = 1.0;                        ///< Kept fraction, 0 to 1
+};
+
+/// @brief Sampling rates and process promotion.
+struct SamplingConfig {
+    bool enabled = false;  ///< Sample while monitoring, replaying and generating
+
+    /// Applied in order; events without a rule are all kept.
+    std::vector<SampleRule> rules;
+
+    /// Process risk score (see Correlator::process_risk()) from which all
+    /// of a process's events are kept; 1 is its first detection, 0 never
+    /// promotes.
+    double promote_score = 1.0;
+};
+
+/// @brief Sampling decisions so far, per category.
+struct SamplingStats {
+    static constexpr std::size_t kCategories = static_cast<std::size_t>(event::Category::Count);
+
+    std::array<std::uint64_t, kCategories> kept{};     ///< Sampled events kept by their hash
+    std::array<std::uint64_t, kCategories> dropped{};  ///< Sampled events dropped
+    std::uint64_t promoted_kept = 0;  ///< Events the hash dropped but promotion kept
+    std::uint64_t promotions = 0;     ///< Processes promoted
+
+    [[nodiscard]] std::uint64_t dropped_total() const noexcept {
+        std::uint64_t total = 0;
+        for (const std::uint64_t count : dropped) {
+            total += count;
+        }
+        return total;
+    }
+};
+
+/**
+ * @brief Keeps a deterministic subset of each sampled category.
+ *
+ * Incarnations and promotions are kept in a direct-mapped table of
+ * kProcessSlots entries indexed by PID. A PID sharing a slot with a live
+ * one evicts it, which only costs that process its promotion and resets
+ * its incarnation count.
+ *
+ * Thread-safety: configured at construction; admit(), process_started()
+ * and promote() may be called from any number of threads.
+ */
+class Sampler {
+public:
+    static constexpr std::size_t kProcessSlots = 16384;
+    /// Threshold of a category kept whole (above every 32-bit hash).
+    static constexpr std::uint64_t kKeepAll = std::uint64_t{1} << 32;
+
+    explicit Sampler(const SamplingConfig& config = {});
+
+    Sampler(const Sampler&) = delete;
+    Sampler& operator=(const Sampler&) = delete;
+
+    /**
+     * @brief Keep or drop one event.
+     * @param pid Process the event is attributed to.
+     * @return false if the event is sampled out (counted in stats()).
+     */
+    [[nodiscard]] bool admit(std::uint32_t pid, const event::EventPayload& payload,
+                             std::uint8_t operation) noexcept {
+        const auto category = static_cast<std::size_t>(payload.category);
+        if (category >= kCategories ||
+            threshold_[category][operation] == kKeepAll) {
+            return true;
+        }
+        return sample(pid, payload, category, threshold_[category][operation]);
+    }
+
+    /// @brief A process started: later events of pid are a new incarnation.
+    void process_started(std::uint32_t pid) noexcept;
+
+    /// @brief Keep every later event of pid's current incarnation.
+    void promote(std::uint32_t pid) noexcept;
+
+    /// @brief Whether pid's current incarnation is promoted.
+    [[nodiscard]] bool promoted(std::uint32_t pid) const noexcept;
+
+    /// @brief Kept fraction of an operation.
+    [[nodiscard]] double rate(event::Category category, std::uint8_t operation) const noexcept;
+
+    /// @brief Hash an event is sampled by (kept if below the threshold).
+    [[nodiscard]] static std::uint32_t key(std::uint32_t pid, std::uint32_t incarnation,
+                                           const event::EventPayload& payload) noexcept;
+
+    [[nodiscard]] SamplingStats stats() const noexcept;
+
+    /// @brief Forget incarnations and promotions and zero the counters
+    /// (start of a session).
+    void reset() noexcept;
+
+private:
+    static constexpr std::size_t kCategories = SamplingStats::kCategories;
+    static constexpr std::uint64_t kPromoted = std::uint64_t{1} << 63;
+
+    /// @brief The hashing path of admit().
+    bool sample(std::uint32_t pid, const event::EventPayload& payload, std::size_t category,
+                std::uint64_t threshold) noexcept;
+
+    [[nodiscard]] static std::size_t slot(std::uint32_t pid) noexcept {
+        // Windows PIDs are multiples of 4
+        return (pid >> 2) % kProcessSlots;
+    }
+
+    std::array<std::array<std::uint64_t, 256>, kCategories> threshold_{};
+    /// PID in the low half, incarnation in bits 32-62, kPromoted
+    std::array<std::atomic<std::uint64_t>, kProcessSlots> processes_{};
+    std::array<std::atomic<std::uint64_t>, kCategories> kept_{};
+    std::array<std::atomic<std::uint64_t>, kCategories> dropped_{};
+    std::atomic<std::uint64_t> promoted_kept_{0};
+    std::atomic<std::uint64_t> promotions_{0};
+};
+
+}  // namespace exeray::etw
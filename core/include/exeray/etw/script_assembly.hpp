@@ -0,0 +1,199 @@
+#pragma once
+
+/// @file script_assembly.hpp
+/// @brief Reassembly of PowerShell script blocks logged in several parts.
+///
+/// PowerShell splits a large script block across several 4104 events
+/// (MessageNumber of MessageTotal, same ScriptBlockId). Scanned part by
+/// part, a pattern cut at a part boundary is missed, and every part pays
+/// for its own scan. The script block parser hands each part of a
+/// multi-part block to the consumer thread's ScriptAssembler instead,
+/// which appends it to the block's buffer; the matcher then runs once, on
+/// the whole script, when the last part arrives. A block whose parts stop
+/// coming, arrive out of order or outgrow its buffer is handed back as it
+/// stands, so what arrived is still scanned once.
+///
+/// Buffers come from an arena: a block reserves room for all its parts
+/// when its first part arrives (parts are of equal size but the last), so
+/// appending a part never reallocates, and the arena is rewound whenever no
+/// block is open. Like ContentCache, the assembler is bound to the thread
+/// with ScriptAssembler::Scope; parsers called outside a consumer scan each
+/// part by itself.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "exeray/arena.hpp"
+
+namespace exeray::etw {
+
+/**
+ * @brief Bounded set of script blocks being reassembled.
+ *
+ * At most kMaxBlocks blocks are open at once; opening another hands the
+ * least recently extended one back unfinished.
+ *
+ * Thread-safety: none; one per consumer thread (ConsumerContext).
+ */
+class ScriptAssembler {
+public:
+    static constexpr std::size_t kMaxBlocks = 16;
+
+    /// Arena bytes for the open blocks' text (reserved, committed as used).
+    static constexpr std::size_t kArenaBytes = std::size_t{8} << 20;
+
+    /// Characters a single block may grow to.
+    static constexpr std::size_t kMaxScriptChars = std::size_t{1} << 20;
+
+    /// Default time a block may wait for its next part: 10 s in the 100 ns
+    /// units of ETW record timestamps.
+    static constexpr std::uint64_t kDefaultTimeout = 100'000'000;
+
+    /// @brief ScriptBlockId (GUID bytes).
+    using BlockId = std::array<std::uint8_t, 16>;
+
+    /// @brief What the caller scans after add().
+    enum class Part : std::uint8_t {
+        Alone,    ///< Not buffered: scan the part by itself
+        Pending,  ///< Buffered: nothing to scan yet
+        Complete  ///< Last part: scan the whole script
+    };
+
+    /// @brief While alive, ScriptAssembler::current() on this thread is assembler.
+    class Scope {
+    public:
+        explicit Scope(ScriptAssembler* assembler) noexcept;
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        ScriptAssembler* previous_;
+    };
+
+    /// @param timeout Time after its last part at which a block is handed
+    ///        back unfinished, in the unit of the times given to add().
+    explicit ScriptAssembler(std::uint64_t timeout = kDefaultTimeout);
+
+    ScriptAssembler(const ScriptAssembler&) = delete;
+    ScriptAssembler& operator=(const ScriptAssembler&) = delete;
+
+    /// @brief Assembler bound by the innermost Scope on this thread, else nullptr.
+    [[nodiscard]] static ScriptAssembler* current() noexcept;
+
+    /**
+     * @brief Add part number (1-based) of total of block id.
+     *
+     * Blocks released unfinished, whether timed out by now, evicted, or
+     * broken by this part, are first passed to on_unfinished(std::wstring_view,
+     * std::uint32_t pid) with the text they gathered and the process that
+     * logged them; the view is only valid during the call.
+     *
+     * @param pid Process logging the block, handed back with it.
+     * @param script Receives the whole script on Part::Complete, valid
+     *        until the next add().
+     */
+    template <typename F>
+    Part add(const BlockId& id, std::uint32_t number, std::uint32_t total,
+             std::wstring_view text, std::uint64_t now, std::uint32_t pid,
+             std::wstring_view& script, F&& on_unfinished);
+
+    /// @brief Drop every open block (the arena is rewound).
+    void clear() noexcept;
+
+    [[nodiscard]] std::size_t open_blocks() const noexcept { return open_; }
+    [[nodiscard]] std::uint64_t completed() const noexcept { return completed_; }
+    [[nodiscard]] std::uint64_t unfinished() const noexcept { return unfinished_; }
+
+private:
+    struct Block {
+        BlockId id{};
+        wchar_t* text = nullptr;
+        std::size_t length = 0;
+        std::size_t capacity = 0;
+        std::uint32_t next = 0;   ///< Part expected next (0 = slot free)
+        std::uint32_t total = 0;
+        std::uint32_t pid = 0;
+        std::uint64_t last = 0;   ///< Time of the latest part
+    };
+
+    [[nodiscard]] static std::wstring_view view(const Block& block) noexcept {
+        return {block.text, block.length};
+    }
+
+    [[nodiscard]] bool stale(const Block& block, std::uint64_t now) const noexcept {
+        return now > block.last && now - block.last > timeout_;
+    }
+
+    /// @brief Open block of id, else nullptr.
+    Block* find(const BlockId& id) noexcept;
+
+    /// @brief Free slot, else the least recently extended block.
+    Block& victim() noexcept;
+
+    /// @brief Reserve the buffer of a new block in slot; false if the arena is full.
+    bool open(Block& slot, const BlockId& id, std::uint32_t total, std::size_t part_chars,
+              std::uint64_t now, std::uint32_t pid);
+
+    /// @brief Free a slot, rewinding the arena once none is open.
+    void release(Block& block) noexcept;
+
+    Arena arena_;
+    std::array<Block, kMaxBlocks> blocks_{};
+    std::size_t open_ = 0;
+    std::uint64_t timeout_;
+    std::uint64_t completed_ = 0;
+    std::uint64_t unfinished_ = 0;
+};
+
+template <typename F>
+ScriptAssembler::Part ScriptAssembler::add(const BlockId& id, std::uint32_t number,
+                                           std::uint32_t total, std::wstring_view text,
+                                           std::uint64_t now, std::uint32_t pid,
+                                           std::wstring_view& script, F&& on_unfinished) {
+    const auto give_up = [&](Block& block) {
+        on_unfinished(view(block), block.pid);
+        ++unfinished_;
+        release(block);
+    };
+    for (Block& block : blocks_) {
+        if (block.next != 0 && stale(block, now)) {
+            give_up(block);
+        }
+    }
+
+    Block* block = find(id);
+    if (block != nullptr &&
+        (number != block->next || total != block->total ||
+         text.size() > block->capacity - block->length)) {
+        give_up(*block);
+        block = nullptr;
+    }
+    if (block == nullptr) {
+        if (number != 1 || total < 2) {
+            return Part::Alone;
+        }
+        block = &victim();
+        if (block->next != 0) {
+            give_up(*block);
+        }
+        if (!open(*block, id, total, text.size(), now, pid)) {
+            return Part::Alone;
+        }
+    }
+
+    text.copy(block->text + block->length, text.size());
+    block->length += text.size();
+    block->last = now;
+    if (++block->next <= block->total) {
+        return Part::Pending;
+    }
+    script = view(*block);
+    ++completed_;
+    release(*block);  // The text stays readable until the arena is used again
+    return Part::Complete;
+}
+
+}  // namespace exeray::etw
@@ -5,10 +5,13 @@
 
 #ifdef _WIN32
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
 // Windows headers - minimal includes
 #ifndef WIN32_LEAN_AND_MEAN
@@ -17,10 +20,27 @@
 #include <windows.h>
 #include <evntrace.h>
 #include <evntcons.h>
+#include "exeray/etw/session_buffers.hpp"
+#include "exeray/etw/session_log.hpp"
+#include "exeray/etw/session_stats.hpp"
 #include "exeray/platform/guid.hpp"
 
 namespace exeray::etw {
 
+/// @brief Scope filters ETW applies before events reach the session buffers.
+///
+/// Only manifest-based and TraceLogging providers honour them; for others
+/// enable_provider() falls back to enabling without filters, so consumers
+/// must still filter in the callback.
+struct ProviderFilter {
+    /// Maximum PIDs per provider (MAX_EVENT_FILTER_PID_COUNT).
+    static constexpr std::size_t kMaxPids = 8;
+
+    std::span<const uint32_t> pids;       ///< Only events of these processes (empty = all)
+    std::span<const uint16_t> event_ids;  ///< Only these event IDs (empty = all)
+    std::span<const uint16_t> stack_event_ids;  ///< Capture the call stack of these IDs
+};
+
 /// @brief Manages an ETW tracing session for real-time event collection.
 ///
 /// The Session class wraps Windows ETW APIs to create and manage event tracing
@@ -32,7 +52,7 @@ namespace exeray::etw {
 /// Usage:
 /// @code
 ///     void WINAPI my_callback(PEVENT_RECORD record) { ... }
-///     ConsumerContext ctx{&graph, &target_pid};
+///     ConsumerContext ctx{&graph, &targets};
 ///     auto session = Session::create(L"MyAppTrace", my_callback, &ctx);
 ///     if (session) {
 ///         session->enable_provider(providers::KERNEL_FILE, TRACE_LEVEL_INFORMATION, 0);
@@ -44,15 +64,42 @@ public:
     /// @brief Callback type for event records.
     using EventCallback = void(WINAPI*)(PEVENT_RECORD);
 
+    /// @brief Callback type invoked after each consumed buffer.
+    using BufferCallback = ULONG(WINAPI*)(PEVENT_TRACE_LOGFILEW);
+
     /// @brief Create a new ETW session with callback for event consumption.
     /// @param session_name Unique name for the session (max 1024 chars).
     /// @param callback Event callback function invoked for each event.
     /// @param context User context passed to callback via EVENT_RECORD::UserContext.
+    /// @param buffer_callback Optional callback after each buffer (nullptr = none).
+    /// @param buffers Buffer sizing and flush timer (0 fields = ETW defaults).
+    /// @param log Also write the buffers to this .etl file (empty path = off).
     /// @return Unique pointer to the session, or nullptr on failure.
     static std::unique_ptr<Session> create(
         std::wstring_view session_name,
         EventCallback callback,
-        void* context
+        void* context,
+        BufferCallback buffer_callback = nullptr,
+        const SessionBuffers& buffers = {},
+        const SessionLog& log = {}
+    );
+
+    /// @brief Open a trace file (.etl) for consumption instead of a live session.
+    ///
+    /// ProcessTrace on the returned handle delivers the file's records
+    /// through the same callbacks and returns at the end of the file. There
+    /// is no controller, so enable_provider() and query_stats() fail.
+    ///
+    /// @param path Path of the .etl file.
+    /// @param callback Event callback function invoked for each event.
+    /// @param context User context passed to callback via EVENT_RECORD::UserContext.
+    /// @param buffer_callback Optional callback after each buffer (nullptr = none).
+    /// @return Unique pointer to the session, or nullptr on failure.
+    static std::unique_ptr<Session> open_file(
+        std::wstring_view path,
+        EventCallback callback,
+        void* context,
+        BufferCallback buffer_callback = nullptr
     );
 
     /// @brief Destructor - stops the trace session and releases resources.
@@ -62,13 +109,42 @@ public:
     /// @param provider_guid GUID of the provider to enable.
     /// @param level Maximum event level (TRACE_LEVEL_*).
     /// @param keywords Keyword bitmask for event filtering.
+    /// @param filter PID and event ID filters applied by the kernel, and
+    ///        the event IDs whose call stacks are captured. Manifest
+    ///        providers attach the stack to the event itself; for classic
+    ///        kernel providers the session asks for StackWalk events.
     /// @return true if the provider was enabled successfully.
-    bool enable_provider(const GUID& provider_guid, uint8_t level, uint64_t keywords);
+    bool enable_provider(const GUID& provider_guid, uint8_t level, uint64_t keywords,
+                         const ProviderFilter& filter = {});
 
     /// @brief Disable an event provider.
     /// @param provider_guid GUID of the provider to disable.
     void disable_provider(const GUID& provider_guid);
 
+    /// @brief Ask an enabled provider for a rundown of its current state.
+    ///
+    /// Kernel-Process answers with a ProcessRundown per running process
+    /// (and thread and image rundowns), Kernel-File with the open files,
+    /// so a session learns the state that predates it.
+    /// @return true if the request was accepted.
+    bool capture_state(const GUID& provider_guid, uint64_t keywords);
+
+    /**
+     * @brief Hand the partly filled buffers to the consumer now
+     * (EVENT_TRACE_CONTROL_FLUSH) instead of at the next flush timer.
+     * @return false for trace files or if ETW refused.
+     */
+    bool flush();
+
+    /**
+     * @brief Stop the session but keep consuming.
+     *
+     * ETW delivers what the session still buffers, then ProcessTrace
+     * returns; destroying the Session instead closes the consumer first and
+     * drops those buffers. Idempotent.
+     */
+    void stop();
+
     /// @brief Get the trace handle for use with ProcessTrace.
     /// @return The consumer trace handle.
     [[nodiscard]] TRACEHANDLE trace_handle() const noexcept { return trace_handle_; }
@@ -81,6 +157,22 @@ public:
     /// @return The session name.
     [[nodiscard]] const std::wstring& session_name() const noexcept { return session_name_; }
 
+    /// @brief Buffer settings in effect, as adjusted by ETW.
+    [[nodiscard]] const SessionBuffers& buffers() const noexcept { return buffers_; }
+
+    /// @brief Start of a trace file as FILETIME (0 for real-time sessions).
+    [[nodiscard]] std::uint64_t start_time() const noexcept { return start_time_; }
+
+    /// @brief Ticks per second of the record timestamps
+    /// (TRACE_LOGFILE_HEADER::PerfFreq for real-time sessions, which deliver
+    /// raw QPC ticks; FILETIME's 10 MHz for trace files).
+    [[nodiscard]] std::uint64_t timer_frequency() const noexcept { return timer_frequency_; }
+
+    /// @brief Read loss and buffer counters (ControlTraceW query).
+    /// @param out Filled on success; buffers_read and samples are left as is.
+    /// @return false if the query failed.
+    bool query_stats(SessionStats& out) const;
+
     // Non-copyable
     Session(const Session&) = delete;
     Session& operator=(const Session&) = delete;
@@ -92,11 +184,22 @@ public:
 private:
     /// @brief Private constructor - use create() factory method.
     explicit Session(TRACEHANDLE session_handle, TRACEHANDLE trace_handle,
-                     std::wstring session_name);
+                     std::wstring session_name, SessionBuffers buffers,
+                     std::uint64_t start_time = 0,
+                     std::uint64_t timer_frequency = 10'000'000);
+
+    /// @brief Add a classic provider's event types (opcodes) to the stack walks.
+    void enable_classic_stacks(const GUID& provider_guid, std::span<const uint16_t> ids);
 
-    TRACEHANDLE session_handle_ = 0;
+    TRACEHANDLE session_handle_ = 0;  ///< 0 for trace files
     TRACEHANDLE trace_handle_ = INVALID_PROCESSTRACE_HANDLE;
-    std::wstring session_name_;
+    std::wstring session_name_;       ///< Session name, or file path
+    SessionBuffers buffers_;
+    std::uint64_t start_time_ = 0;
+    std::uint64_t timer_frequency_ = 10'000'000;
+    /// Classic events with stack walks; TraceSetInformation replaces the
+    /// whole list, so each provider adds to it
+    std::vector<CLASSIC_EVENT_ID> classic_stacks_;
 };
 
 }  // namespace exeray::etw
@@ -107,38 +210,70 @@ private:
 #else  // !_WIN32
 
 // Stub declarations for non-Windows platforms
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
 #include <string_view>
+#include "exeray/etw/session_buffers.hpp"
+#include "exeray/etw/session_log.hpp"
+#include "exeray/etw/session_stats.hpp"
 #include "exeray/platform/guid.hpp"
 
 namespace exeray::etw {
 
+struct ProviderFilter {
+    static constexpr std::size_t kMaxPids = 8;
+
+    std::span<const uint32_t> pids;
+    std::span<const uint16_t> event_ids;
+    std::span<const uint16_t> stack_event_ids;
+};
+
 using TRACEHANDLE = uint64_t;
 constexpr TRACEHANDLE INVALID_PROCESSTRACE_HANDLE = static_cast<TRACEHANDLE>(-1);
 
 class Session {
 public:
     using EventCallback = void(*)(void*);
+    using BufferCallback = unsigned long(*)(void*);
 
     static std::unique_ptr<Session> create(
         std::wstring_view /*session_name*/,
         EventCallback /*callback*/ = nullptr,
-        void* /*context*/ = nullptr
+        void* /*context*/ = nullptr,
+        BufferCallback /*buffer_callback*/ = nullptr,
+        const SessionBuffers& /*buffers*/ = {},
+        const SessionLog& /*log*/ = {}
     ) {
         return nullptr;  // ETW not available on non-Windows
     }
 
+    static std::unique_ptr<Session> open_file(
+        std::wstring_view /*path*/,
+        EventCallback /*callback*/ = nullptr,
+        void* /*context*/ = nullptr,
+        BufferCallback /*buffer_callback*/ = nullptr
+    ) {
+        return nullptr;
+    }
+
     ~Session() = default;
 
     bool enable_provider(const GUID& /*provider_guid*/, uint8_t /*level*/,
-                         uint64_t /*keywords*/) {
+                         uint64_t /*keywords*/, const ProviderFilter& /*filter*/ = {}) {
         return false;
     }
 
     void disable_provider(const GUID& /*provider_guid*/) {}
 
+    bool capture_state(const GUID& /*provider_guid*/, uint64_t /*keywords*/) { return false; }
+
+    bool flush() { return false; }
+
+    void stop() {}
+
     [[nodiscard]] TRACEHANDLE trace_handle() const noexcept {
         return INVALID_PROCESSTRACE_HANDLE;
     }
@@ -149,12 +284,21 @@ public:
         return session_name_;
     }
 
+    [[nodiscard]] const SessionBuffers& buffers() const noexcept { return buffers_; }
+
+    [[nodiscard]] std::uint64_t start_time() const noexcept { return 0; }
+
+    [[nodiscard]] std::uint64_t timer_frequency() const noexcept { return 10'000'000; }
+
+    bool query_stats(SessionStats& /*out*/) const { return false; }
+
     Session(const Session&) = delete;
     Session& operator=(const Session&) = delete;
 
 private:
     Session() = default;
     std::wstring session_name_;
+    SessionBuffers buffers_;
 };
 
 }  // namespace exeray::etw
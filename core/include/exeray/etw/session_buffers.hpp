@@ -0,0 +1,50 @@
+#pragma once
+
+/// @file session_buffers.hpp
+/// @brief ETW session buffer sizing and flush timer.
+///
+/// Windows defaults (a few 64 KB buffers, one-second flush) overflow within
+/// milliseconds once File, Registry and Network providers run at full rate,
+/// and ETW drops whole buffers. SessionBuffers carries the four
+/// EVENT_TRACE_PROPERTIES knobs; resolve_buffers() fills the ones left at 0
+/// from the enabled providers and the core count.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace exeray::etw {
+
+/// @brief EVENT_TRACE_PROPERTIES buffer settings (0 = choose automatically).
+struct SessionBuffers {
+    /// Largest buffer ETW accepts, in KB.
+    static constexpr std::uint32_t kMaxBufferKb = 1024;
+
+    /// Upper bound of automatic sizing: buffer_kb * max_buffers.
+    static constexpr std::size_t kAutoBudgetKb = 256 * 1024;
+
+    std::uint32_t buffer_kb = 0;       ///< Size of one buffer in KB
+    std::uint32_t min_buffers = 0;     ///< Buffers allocated up front
+    std::uint32_t max_buffers = 0;     ///< Buffers ETW may grow to
+    std::uint32_t flush_timer_ms = 0;  ///< Flush partly filled buffers this often
+
+    bool operator==(const SessionBuffers&) const = default;
+};
+
+/**
+ * @brief Fill unset fields of a buffer request and clamp the rest.
+ *
+ * High-rate providers (File, Registry, Network) get 256 KB buffers, others
+ * 64 KB. min_buffers is two per core, max_buffers grows with the provider
+ * mix up to kAutoBudgetKb. The flush timer defaults to one second; pick a
+ * lower one for latency, larger buffers for throughput.
+ *
+ * @param requested Explicit settings; fields at 0 are chosen here.
+ * @param providers Number of enabled providers.
+ * @param high_rate How many of them are high-rate.
+ * @param cores Logical processors (0 = query the system).
+ * @return Settings to pass to StartTraceW, every field non-zero.
+ */
+[[nodiscard]] SessionBuffers resolve_buffers(SessionBuffers requested, std::size_t providers,
+                                             std::size_t high_rate, unsigned cores = 0);
+
+}  // namespace exeray::etw
@@ -0,0 +1,48 @@
+#pragma once
+
+/// @file session_log.hpp
+/// @brief ETL file written by the live session itself.
+///
+/// A second logging session for the same providers doubles the kernel-side
+/// cost. Instead the real-time session can also write its buffers to an
+/// .etl file (EVENT_TRACE_REAL_TIME_MODE plus a file mode), so the raw
+/// stream is preserved for incident response and can be re-parsed later
+/// with Engine::replay().
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace exeray::etw {
+
+/// @brief How the session file behaves once it reaches max_mb.
+enum class LogFileMode : std::uint8_t {
+    Circular,   ///< Overwrite the oldest buffers (keeps the most recent max_mb)
+    Sequential  ///< Stop writing the file (max_mb 0 = no limit)
+};
+
+/// @brief File logging next to real-time delivery (empty path = off).
+struct SessionLog {
+    /// Longest path accepted, in characters.
+    static constexpr std::size_t kMaxPath = 1023;
+
+    std::wstring path;                         ///< .etl file to write
+    LogFileMode mode = LogFileMode::Circular;  ///< Behaviour at the size cap
+    std::uint32_t max_mb = 256;                ///< File size cap in MB
+
+    [[nodiscard]] bool enabled() const noexcept { return !path.empty(); }
+};
+
+/**
+ * @brief File path of one of several sessions logging under one name.
+ *
+ * Session 0 uses path as is; session n inserts ".n" before the extension
+ * ("trace.etl" -> "trace.2.etl"), or appends it if there is none.
+ *
+ * @param path Configured path.
+ * @param index Session index.
+ * @return Path for that session.
+ */
+[[nodiscard]] std::wstring log_path_for(const std::wstring& path, std::size_t index);
+
+}  // namespace exeray::etw
@@ -0,0 +1,77 @@
+#pragma once
+
+/// @file session_stats.hpp
+/// @brief ETW session loss and buffer counters, polled in the background.
+///
+/// ETW drops events silently when the consumer falls behind or buffers run
+/// out. ControlTraceW(EVENT_TRACE_CONTROL_QUERY) reports how many were lost;
+/// StatsPoller samples it periodically so the numbers are known while the
+/// session runs and after it stops.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace exeray::etw {
+
+/// @brief Counters of one ETW session (cumulative since it started).
+struct SessionStats {
+    std::uint64_t events_lost = 0;      ///< Events ETW could not buffer
+    std::uint64_t buffers_lost = 0;     ///< Real-time buffers dropped before delivery
+    std::uint64_t buffers_written = 0;  ///< Buffers filled by the session
+    std::uint64_t buffers_read = 0;     ///< Buffers delivered to the consumer
+    std::uint32_t free_buffers = 0;     ///< Buffers currently unused
+    std::uint32_t buffers = 0;          ///< Buffers currently allocated
+    std::uint64_t samples = 0;          ///< Successful queries so far
+
+    bool operator==(const SessionStats&) const = default;
+};
+
+/**
+ * @brief Background thread sampling session counters at a fixed interval.
+ *
+ * The query source is a callable so the poller stays independent of the
+ * ETW handle type; Engine binds it to Session::query_stats().
+ *
+ * Thread-safety: start()/stop() from one thread; latest() from any.
+ */
+class StatsPoller {
+public:
+    /// @brief Fills the counters, false if the query failed.
+    using Query = std::function<bool(SessionStats&)>;
+
+    StatsPoller() = default;
+    ~StatsPoller();
+
+    StatsPoller(const StatsPoller&) = delete;
+    StatsPoller& operator=(const StatsPoller&) = delete;
+
+    /**
+     * @brief Sample once now, then every interval until stop().
+     *
+     * Restarts the poller if it was running; latest() is reset.
+     */
+    void start(Query query, std::chrono::milliseconds interval);
+
+    /// @brief Take a final sample and stop the thread; latest() is kept.
+    void stop();
+
+    /// @brief Most recent successful sample.
+    [[nodiscard]] SessionStats latest() const;
+
+private:
+    void sample();
+    void run(std::chrono::milliseconds interval);
+
+    Query query_;
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;  ///< Guarded by mutex_
+    SessionStats latest_;    ///< Guarded by mutex_
+};
+
+}  // namespace exeray::etw
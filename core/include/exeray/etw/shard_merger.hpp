@@ -0,0 +1,111 @@
+#pragma once
+
+/// @file shard_merger.hpp
+/// @brief Timestamp-ordered insertion of events from several ETW sessions.
+///
+/// With providers split across sessions, every session has its own
+/// ProcessTrace thread and its buffers arrive with their own delay. Pushing
+/// each batch as it comes would interleave the sessions by delivery time,
+/// while EventGraph's time index expects push order to follow timestamps.
+/// ShardMerger holds each session's events until every session has moved
+/// past them (or they are older than max_lag) and pushes them merged by
+/// timestamp.
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "exeray/event/graph.hpp"
+
+namespace exeray::etw {
+
+class IngestLatency;
+
+/**
+ * @brief K-way merge of per-session event batches into one EventGraph.
+ *
+ * Each shard's watermark is the newest timestamp it submitted. Events at
+ * or below the smallest watermark are released, and so is anything older
+ * than now - max_lag, so an idle session cannot hold the others back.
+ * An event that arrives after its time was released is pushed with the
+ * next release: order is exact within max_lag of the slowest session.
+ *
+ * Thread-safety: all methods are safe to call concurrently; each shard is
+ * expected to submit from one thread in delivery order.
+ */
+class ShardMerger {
+public:
+    /// @brief Source of the current graph time (steady_clock ns).
+    using Clock = std::function<event::Timestamp()>;
+
+    /// Default hold-back bound: two ETW flush periods.
+    static constexpr event::Timestamp kDefaultMaxLag = 2'000'000'000;
+
+    /**
+     * @param graph Destination graph.
+     * @param shards Number of sessions feeding the merger.
+     * @param max_lag Longest an event is held back, in nanoseconds.
+     * @param clock Current time (nullptr = steady_clock).
+     */
+    ShardMerger(event::EventGraph& graph, std::size_t shards,
+                event::Timestamp max_lag = kDefaultMaxLag, Clock clock = nullptr);
+
+    ShardMerger(const ShardMerger&) = delete;
+    ShardMerger& operator=(const ShardMerger&) = delete;
+
+    /**
+     * @brief Queue one shard's events and push whatever became ready.
+     * @param shard Shard index.
+     * @param events Events in the shard's delivery order.
+     */
+    void submit(std::size_t shard, std::span<const event::PendingEvent> events);
+
+    /**
+     * @brief Push one event right away and return its ID.
+     *
+     * For events whose ID is needed at once (process creates registered
+     * with the correlator). Queued events up to its timestamp go first.
+     *
+     * @return EventId, or INVALID_EVENT if the graph refused it.
+     */
+    event::EventId push_now(std::size_t shard, const event::PendingEvent& event);
+
+    /// @brief Push every queued event regardless of watermarks.
+    void flush();
+
+    /// @brief Events queued but not pushed yet.
+    [[nodiscard]] std::size_t pending() const;
+
+    /// @brief Sample the Visible age of pushed events (set before submitting).
+    void set_latency(IngestLatency* latency) noexcept { latency_ = latency; }
+
+private:
+    struct Shard {
+        std::deque<event::PendingEvent> queue;
+        event::Timestamp watermark = 0;
+    };
+
+    /// @brief Push queued events with timestamps <= bound (mutex_ held).
+    void release(event::Timestamp bound);
+
+    /// @brief Smallest watermark, or the lag bound if that is later.
+    [[nodiscard]] event::Timestamp ready_bound() const;
+
+    /// @brief Sample the age of events just pushed (mutex_ held).
+    void record_visible(std::span<const event::PendingEvent> events);
+
+    event::EventGraph& graph_;
+    event::Timestamp max_lag_;
+    Clock clock_;
+    mutable std::mutex mutex_;
+    std::vector<Shard> shards_;               ///< Guarded by mutex_
+    std::vector<event::PendingEvent> merged_;  ///< Release scratch (mutex_)
+    IngestLatency* latency_ = nullptr;
+    std::uint32_t latency_tick_ = 0;           ///< Guarded by mutex_
+};
+
+}  // namespace exeray::etw
@@ -0,0 +1,140 @@
+#pragma once
+
+/// @file shed_policy.hpp
+/// @brief Priority-based load shedding for the ETW consumer.
+///
+/// When the consumer falls behind, ETW drops whole buffers without looking
+/// at what is in them, so a rare process create or AMSI scan is as likely
+/// to be lost as a file read. ShedPolicy lets the consumer give up
+/// low-value, high-volume events first while it is under pressure: they
+/// are sampled once the pressure passes one threshold and dropped past a
+/// second one, at which point ordinary events are sampled too. Critical
+/// events are always kept, and every shed event is counted.
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "exeray/event/payload.hpp"
+#include "exeray/event/types.hpp"
+
+namespace exeray::etw {
+
+/// @brief How readily an event is given up under pressure.
+enum class ShedPriority : std::uint8_t {
+    Low,      ///< Sampled first, then dropped (file read/write, send/recv)
+    Normal,   ///< Sampled only under heavy pressure
+    Critical  ///< Never shed
+};
+
+/// @brief Priority override for one category or one of its operations.
+struct ShedRule {
+    /// Matches every operation of the category.
+    static constexpr std::uint16_t kAnyOperation = 0x100;
+
+    event::Category category = event::Category::FileSystem;
+    std::uint16_t operation = kAnyOperation;  ///< Operation code or kAnyOperation
+    ShedPriority priority = ShedPriority::Normal;
+};
+
+/// @brief Shedding thresholds and priority overrides.
+///
+/// Pressure is a percentage: how full the ETW buffers or the record ring
+/// are, whichever is higher.
+struct ShedConfig {
+    bool enabled = true;               ///< Turn shedding off entirely
+    std::uint8_t sample_percent = 50;  ///< From here Low events are sampled
+    std::uint8_t drop_percent = 80;    ///< From here Low are dropped, Normal sampled
+    std::uint32_t sample_every = 8;    ///< Keep one in N sampled events
+
+    /// Applied in order over the defaults: Low for File Read/Write and
+    /// Network Send/Receive; Critical for Process, AMSI, Script and remote
+    /// thread starts; Normal for the rest.
+    std::vector<ShedRule> rules;
+};
+
+/// @brief Events shed so far, per category.
+struct ShedStats {
+    std::array<std::uint64_t, static_cast<std::size_t>(event::Category::Count)> by_category{};
+    std::uint64_t total = 0;
+
+    [[nodiscard]] std::uint64_t of(event::Category category) const noexcept {
+        return by_category[static_cast<std::size_t>(category)];
+    }
+};
+
+/// @brief Pressure in percent from a fill level (0 if capacity is 0).
+[[nodiscard]] constexpr std::uint8_t pressure_percent(std::size_t used,
+                                                      std::size_t capacity) noexcept {
+    if (capacity == 0) {
+        return 0;
+    }
+    return static_cast<std::uint8_t>(used >= capacity ? 100 : used * 100 / capacity);
+}
+
+/**
+ * @brief Decides per event whether it is kept under the current pressure.
+ *
+ * Thread-safety: configured at construction; admit() and stats() may be
+ * called from any number of consumer threads, and set_thresholds() from
+ * any thread while they run.
+ */
+class ShedPolicy {
+public:
+    explicit ShedPolicy(const ShedConfig& config = {});
+
+    ShedPolicy(const ShedPolicy&) = delete;
+    ShedPolicy& operator=(const ShedPolicy&) = delete;
+
+    /// @brief Priority of an event (remote thread starts are Critical).
+    [[nodiscard]] ShedPriority priority(const event::EventPayload& payload,
+                                        std::uint8_t operation) const noexcept;
+
+    /**
+     * @brief Keep or shed one parsed event.
+     * @param payload Event payload (category and remote-thread flag).
+     * @param operation Category-specific operation code.
+     * @param pressure Current pressure in percent.
+     * @return false if the event should be dropped (counted in stats()).
+     */
+    [[nodiscard]] bool admit(const event::EventPayload& payload, std::uint8_t operation,
+                             std::uint8_t pressure) noexcept;
+
+    /// @brief Move the sample and drop thresholds (e.g. from the auto-tuner).
+    ///
+    /// drop is raised to sample if below it; both are capped at 100.
+    void set_thresholds(std::uint8_t sample_percent, std::uint8_t drop_percent) noexcept;
+
+    /// @brief Pressure from which Low events are sampled.
+    [[nodiscard]] std::uint8_t sample_percent() const noexcept {
+        return sample_percent_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Pressure from which Low events are dropped and Normal sampled.
+    [[nodiscard]] std::uint8_t drop_percent() const noexcept {
+        return drop_percent_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Events shed since construction or the last reset_stats().
+    [[nodiscard]] ShedStats stats() const noexcept;
+
+    /// @brief Zero the shed counters (start of a monitoring session).
+    void reset_stats() noexcept;
+
+private:
+    static constexpr std::size_t kCategories = static_cast<std::size_t>(event::Category::Count);
+
+    /// @brief Sample: keep every sample_every-th event of a category.
+    bool sample(std::size_t category) noexcept;
+
+    std::array<std::array<ShedPriority, 256>, kCategories> table_{};
+    std::atomic<std::uint8_t> sample_percent_;
+    std::atomic<std::uint8_t> drop_percent_;
+    std::uint32_t sample_every_;
+    std::array<std::atomic<std::uint64_t>, kCategories> sampled_{};
+    std::array<std::atomic<std::uint64_t>, kCategories> shed_{};
+};
+
+}  // namespace exeray::etw
@@ -0,0 +1,113 @@
+#pragma once
+
+/// @file stack_symbolizer.hpp
+/// @brief Module and export names for the return addresses of captured stacks.
+///
+/// Stacks are stored as raw addresses (event::StackTable); naming them
+/// costs file reads, so it happens only when a reader asks, on a pool
+/// worker (Engine::symbolize_stack_async()). Each frame resolves to the
+/// module holding it through the ModuleMap, then to the nearest export of
+/// that module at or below it. Export tables are parsed from the image on
+/// disk once per module path and cached until clear(); stacks of the same
+/// few system DLLs hit the cache after the first.
+///
+/// Exports are what a shipped binary names without symbol files, so a
+/// frame inside a non-exported function shows as the preceding export
+/// plus a displacement. A frame outside every known module is left with
+/// its address only: on a user-mode stack that is code never mapped from
+/// a file.
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "exeray/event/types.hpp"
+
+namespace exeray::event {
+class StringPool;
+}  // namespace exeray::event
+
+namespace exeray::etw {
+
+class ModuleMap;
+
+/// @brief One named export of a PE image.
+struct ExportSymbol {
+    std::uint32_t rva = 0;  ///< Address relative to the image base
+    std::string name;
+};
+
+/**
+ * @brief Named exports of a PE image file, sorted by RVA.
+ *
+ * Forwarded exports (whose RVA points into the export directory) have no
+ * code in the image and are skipped. Returns empty for anything that is
+ * not a well-formed PE32 or PE32+ image with an export directory.
+ */
+[[nodiscard]] std::vector<ExportSymbol> parse_pe_exports(std::span<const std::uint8_t> image);
+
+/// @brief One return address, resolved.
+struct StackFrame {
+    std::uint64_t address = 0;
+    event::StringId module = event::INVALID_STRING;  ///< Image holding it (INVALID = none known)
+    std::uint64_t offset = 0;                        ///< From the module base
+    std::string function;                            ///< Nearest export (empty = none)
+    std::uint64_t displacement = 0;                  ///< From that export
+    bool kernel = false;                             ///< Kernel-mode address
+};
+
+/**
+ * @brief Resolves stacks against the ModuleMap with a per-module export cache.
+ *
+ * Thread-safety: symbolize() from any thread (the cache has one mutex,
+ * held only to find or insert a module's table); clear() between
+ * sessions, when module path StringIds change meaning.
+ */
+class StackSymbolizer {
+public:
+    /// Kernel-mode addresses on x64 start here.
+    static constexpr std::uint64_t kKernelBase = 0xFFFF800000000000ULL;
+
+    /// Images larger than this are not read for exports.
+    static constexpr std::uint64_t kMaxImageBytes = 256ULL * 1024 * 1024;
+
+    /// @param modules Module map the addresses are looked up in.
+    /// @param strings Pool resolving module paths.
+    StackSymbolizer(const ModuleMap& modules, const event::StringPool& strings);
+
+    StackSymbolizer(const StackSymbolizer&) = delete;
+    StackSymbolizer& operator=(const StackSymbolizer&) = delete;
+
+    /**
+     * @brief Resolve the frames of a stack captured in a process.
+     *
+     * Kernel addresses are looked up among the modules of the System
+     * process (4) and the idle process (0), where kernel images load.
+     */
+    [[nodiscard]] std::vector<StackFrame> symbolize(std::uint32_t pid,
+                                                    std::span<const std::uint64_t> frames);
+
+    /// @brief Drop the cached export tables.
+    void clear();
+
+    /// @brief Modules whose exports are cached.
+    [[nodiscard]] std::size_t cached_modules() const;
+
+private:
+    using Exports = std::vector<ExportSymbol>;
+
+    /// @brief Export table of a module path, read on first use.
+    std::shared_ptr<const Exports> exports(event::StringId path);
+
+    const ModuleMap& modules_;
+    const event::StringPool& strings_;
+    mutable std::mutex mutex_;
+    std::unordered_map<event::StringId, std::shared_ptr<const Exports>> cache_;
+};
+
+}  // namespace exeray::etw
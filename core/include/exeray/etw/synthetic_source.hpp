@@ -0,0 +1,133 @@
+#pragma once
+
+/// @file synthetic_source.hpp
+/// @brief Generated ParsedEvent streams for load tests on any platform.
+///
+/// ETW records only exist on Windows, so elsewhere nothing exercises what
+/// follows the parsers. SyntheticSource produces what a busy host's parsers
+/// would: a weighted mix of categories over a population of processes that
+/// keep exiting and being replaced (PID churn), with paths, keys and domains
+/// drawn with a Zipf(1) skew from a bounded number of distinct strings, so
+/// the string pool sees the hit rate of a real host. Strings are handed over
+/// as DeferredStrings views, as the parsers do, and feed() delivers the
+/// events through consume_parsed() and flush_pending() in buffer-sized
+/// batches, the path of event_record_callback() and buffer_callback().
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "exeray/etw/deferred_strings.hpp"
+#include "exeray/event/types.hpp"
+
+namespace exeray::etw {
+
+struct ConsumerContext;
+struct ParsedEvent;
+
+/// @brief Number of event::Category values.
+inline constexpr std::size_t kSyntheticCategories =
+    static_cast<std::size_t>(event::Category::Count);
+
+/// @brief Shape of a synthetic event stream.
+struct SyntheticConfig {
+    /// Relative weight per category. FileSystem, Registry, Network, Image,
+    /// Thread, Memory, Script and Dns are generated; Process events come
+    /// from churn and the other weights are ignored.
+    std::array<std::uint32_t, kSyntheticCategories> mix = default_mix();
+
+    double rate = 0.0;                    ///< Events per second (0 = as fast as possible)
+    std::uint32_t processes = 500;        ///< Processes running at any time (max 32768)
+    std::uint32_t churn = 2;              ///< Processes replaced per 1000 events
+    std::uint32_t strings = 10000;        ///< Distinct strings per kind (paths, keys...)
+    std::size_t buffer_events = 256;      ///< Events per delivered buffer
+    std::uint64_t seed = 1;               ///< Same seed, same stream
+
+    /// @brief Mix of a busy workstation: mostly file and registry I/O.
+    [[nodiscard]] static std::array<std::uint32_t, kSyntheticCategories> default_mix() noexcept;
+};
+
+/**
+ * @brief Deterministic generator of ParsedEvents.
+ *
+ * The first config().processes events are the rundown of the initial processes,
+ * as a session start delivers them. After that, every event is either one
+ * of the mix or part of churn: a running process terminates and a new one,
+ * started by another running process, takes its place. New PIDs count up
+ * and wrap, so long runs reuse PIDs as Windows does.
+ *
+ * Thread-safety: none; one source per feeding thread.
+ */
+class SyntheticSource {
+public:
+    explicit SyntheticSource(const SyntheticConfig& config = {});
+
+    /**
+     * @brief Next event, stamped with timestamp (ETW ticks).
+     *
+     * String fields are INVALID_STRING with the text in parsed.deferred;
+     * the views stay valid until the next call.
+     */
+    [[nodiscard]] ParsedEvent next(std::uint64_t timestamp);
+
+    /// @brief Thread that logged the last event returned by next().
+    [[nodiscard]] std::uint32_t thread_id() const noexcept { return thread_id_; }
+
+    /**
+     * @brief Deliver count events into ctx, as a session would.
+     *
+     * Events go through consume_parsed() at pressure 0, with ctx.pending
+     * flushed every buffer_events (ctx.buffers_read counts them) and
+     * finish_pending() at the end. Without a rate each event is stamped with the time
+     * it is generated; with one, events are stamped on the rate's schedule
+     * and held back until due (see ReplayPacer), so latency includes the
+     * time the pipeline falls behind. ctx.targets is not applied.
+     *
+     * @return Events delivered.
+     */
+    std::uint64_t feed(ConsumerContext& ctx, std::uint64_t count);
+
+    [[nodiscard]] std::uint64_t produced() const noexcept { return produced_; }
+
+    /// @brief Processes started by churn so far (rundowns not included).
+    [[nodiscard]] std::uint64_t started() const noexcept { return started_; }
+
+    [[nodiscard]] const SyntheticConfig& config() const noexcept { return config_; }
+
+private:
+    struct Process {
+        std::uint32_t pid = 0;
+        std::uint32_t parent = 0;
+    };
+
+    std::uint64_t random() noexcept;
+
+    /// @brief Zipf(1) rank in [0, config_.strings).
+    std::uint32_t rank() noexcept;
+
+    /// @brief Emptied buffer for the slot-th string of the event.
+    std::wstring& text(std::size_t slot) noexcept;
+
+    /// @brief Next unused PID.
+    std::uint32_t new_pid() noexcept;
+
+    void make_process(ParsedEvent& parsed, const Process& process, std::uint8_t operation);
+    void make_event(ParsedEvent& parsed, event::Category category, std::uint32_t pid);
+
+    SyntheticConfig config_;
+    std::array<std::uint32_t, kSyntheticCategories> cumulative_{};  ///< Running mix totals
+    std::vector<Process> running_;
+    std::uint64_t state_;
+    std::uint64_t produced_ = 0;
+    std::uint64_t started_ = 0;
+    std::uint32_t next_pid_;
+    std::uint32_t thread_id_ = 0;
+    std::size_t rundown_ = 0;      ///< Initial processes announced so far
+    std::size_t replacing_ = 0;    ///< Slot whose new process is due (+1; 0 = none)
+    bool wrapped_ = false;         ///< PIDs have started over
+    std::array<std::wstring, DeferredStrings::kMaxStrings> texts_;
+};
+
+}  // namespace exeray::etw
@@ -0,0 +1,112 @@
+#pragma once
+
+/// @file target_set.hpp
+/// @brief Processes whose events the consumer keeps.
+///
+/// The ETW callback asks contains() for every record, so membership is
+/// wait-free: a PID that is a multiple of four (every Windows PID) and
+/// below kBitmapPids is one bit of a fixed bitmap; any other goes to a
+/// small open-addressed table of atomics. The consumer adds the child of
+/// every member that starts a process, so the descendants of the targets
+/// are kept too, and drops members as they exit.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace exeray::etw {
+
+/**
+ * @brief Lock-free set of process IDs.
+ *
+ * PID 0 and 0xFFFFFFFF (the "unknown" PIDs of some providers) are never
+ * members. The table keeps at most kTableSlots large or odd PIDs; erased
+ * slots are only reused after clear().
+ *
+ * Thread-safety: every member but clear() may run concurrently; clear()
+ * must not run alongside any other member.
+ */
+class TargetSet {
+public:
+    /// PIDs below this that are multiples of four live in the bitmap (32 KiB).
+    static constexpr std::uint32_t kBitmapPids = 1U << 20;
+    static constexpr std::size_t kTableSlots = 1024;
+
+    TargetSet();
+    TargetSet(const TargetSet&) = delete;
+    TargetSet& operator=(const TargetSet&) = delete;
+
+    /// @brief Add pid; false if it cannot be a member or the table is full.
+    bool insert(std::uint32_t pid);
+
+    /// @brief Remove pid if present.
+    void erase(std::uint32_t pid);
+
+    /// @brief A process started: add child if parent is a member.
+    /// @return true if child was added (or already a member).
+    bool adopt(std::uint32_t parent, std::uint32_t child) {
+        return parent != child && contains(parent) && insert(child);
+    }
+
+    /// @brief Whether pid is a member (wait-free).
+    ///
+    /// For Windows PIDs below kBitmapPids: a range test, one load and a bit test.
+    [[nodiscard]] bool contains(std::uint32_t pid) const noexcept {
+        if (in_bitmap(pid)) [[likely]] {
+            const std::uint32_t bit = pid >> 2;
+            return ((bits_[bit / 64].load(std::memory_order_acquire) >> (bit % 64)) & 1U) != 0;
+        }
+        if (table_size_.load(std::memory_order_acquire) == 0 || !valid(pid)) {
+            return false;
+        }
+        for (std::size_t i = 0, slot = home(pid); i < kTableSlots;
+             ++i, slot = (slot + 1) % kTableSlots) {
+            const std::uint32_t held = slots_[slot].load(std::memory_order_acquire);
+            if (held == pid) {
+                return true;
+            }
+            if (held == kEmpty) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    /// @brief Members right now.
+    [[nodiscard]] std::size_t size() const noexcept {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+    /// @brief Snapshot of the members, sorted.
+    [[nodiscard]] std::vector<std::uint32_t> pids() const;
+
+    void clear();
+
+private:
+    static constexpr std::uint32_t kEmpty = 0;
+    static constexpr std::uint32_t kErased = 0xFFFFFFFFU;
+    static constexpr std::size_t kBitmapWords = kBitmapPids / 4 / 64;
+
+    [[nodiscard]] static constexpr bool valid(std::uint32_t pid) noexcept {
+        return pid != kEmpty && pid != kErased;
+    }
+
+    [[nodiscard]] static constexpr bool in_bitmap(std::uint32_t pid) noexcept {
+        return (pid & 3U) == 0 && pid < kBitmapPids;
+    }
+
+    [[nodiscard]] static constexpr std::size_t home(std::uint32_t pid) noexcept {
+        return static_cast<std::size_t>((pid * 2654435761U) >> 22) % kTableSlots;
+    }
+
+    std::unique_ptr<std::atomic<std::uint64_t>[]> bits_;
+    std::unique_ptr<std::atomic<std::uint32_t>[]> slots_;
+    std::atomic<std::size_t> size_{0};
+    std::atomic<std::size_t> table_size_{0};  ///< Members held in slots_
+};
+
+}  // namespace exeray::etw
@@ -0,0 +1,346 @@
+/// @file decode_plan.hpp
+/// @brief Compiled TDH layouts: decode event properties without TDH calls.
+///
+/// Formatting every property with TdhFormatProperty (twice, to size the
+/// buffer) and keying them by freshly allocated names dominates the TDH
+/// fallback. A DecodePlan is compiled once per cached schema. Fields up to
+/// the first variable-length one get precomputed offsets; after that
+/// strings, SIDs and binary blobs are sized by their length rule. Later
+/// events of the same (provider, id, version) are decoded from UserData in
+/// one loop. Structs decode their members in place; arrays, fixed or
+/// counted by an earlier property, are viewed as a whole.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <forward_list>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace exeray::etw {
+
+/// @brief Array property: count elements viewed in UserData.
+struct TdhArray {
+    std::span<const uint8_t> bytes;  ///< All elements
+    uint32_t count = 0;
+    uint16_t element_size = 0;       ///< Bytes per element, 0 if they vary in size
+    uint16_t in_type = 0;            ///< TDH_INTYPE_* of scalar elements (0 for structs)
+
+    /// @brief Bytes of element i (fixed-size elements only, else empty).
+    [[nodiscard]] std::span<const uint8_t> element(std::size_t i) const noexcept {
+        if (element_size == 0 || i >= count) {
+            return {};
+        }
+        return bytes.subspan(i * element_size, element_size);
+    }
+};
+
+/**
+ * @brief Property value types that TDH can extract.
+ *
+ * Strings and binary data are views: into UserData where the bytes can be
+ * used as they are, otherwise into the text storage of the TdhParsedEvent.
+ * A struct is the span of its bytes, its members are properties of their
+ * own. monostate marks a property of the schema that could not be decoded
+ * (or a member of an array element), so that ordinals stay the schema's
+ * property indices.
+ */
+using TdhPropertyValue = std::variant<
+    std::monostate,
+    uint64_t,
+    uint32_t,
+    int32_t,
+    std::wstring_view,
+    std::span<const uint8_t>,
+    TdhArray
+>;
+
+/// @brief One decoded property; name points into the cached schema.
+struct TdhProperty {
+    std::wstring_view name;
+    TdhPropertyValue value;
+};
+
+/**
+ * @brief TDH-parsed event as name-value pairs in schema order.
+ *
+ * Meant to live on the parsing thread's stack: properties and formatted
+ * text (GUIDs, SIDs, widened ANSI and unaligned UTF-16) are stored inline,
+ * so decoding allocates only for text beyond kTextChars. Values view the
+ * record's UserData and this object, which is therefore neither copyable
+ * nor movable; both must outlive the values read from it.
+ */
+struct TdhParsedEvent {
+    static constexpr std::size_t kMaxProperties = 64;  ///< Later properties are dropped
+    static constexpr std::size_t kTextChars = 1024;    ///< Inline text storage
+
+    uint16_t event_id{0};
+    uint8_t event_version{0};
+    uint64_t schema{0};  ///< Identity of the cached layout (0 = none, see PropertyKeys)
+
+    TdhParsedEvent() = default;
+    TdhParsedEvent(const TdhParsedEvent&) = delete;
+    TdhParsedEvent& operator=(const TdhParsedEvent&) = delete;
+
+    /// @brief Decoded properties; index i is the schema's property i.
+    [[nodiscard]] std::span<const TdhProperty> properties() const noexcept {
+        return {properties_.data(), count_};
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return count_; }
+
+    /// @brief Append a property; false once kMaxProperties are stored.
+    bool push(std::wstring_view name, TdhPropertyValue value) noexcept {
+        if (count_ == kMaxProperties) {
+            return false;
+        }
+        properties_[count_++] = {name, value};
+        return true;
+    }
+
+    /// @brief Replace the value at an ordinal (ignored if out of range).
+    void set(std::size_t ordinal, TdhPropertyValue value) noexcept {
+        if (ordinal < count_) {
+            properties_[ordinal].value = value;
+        }
+    }
+
+    /// @brief Value at a schema ordinal, nullptr if not decoded.
+    [[nodiscard]] const TdhPropertyValue* at(std::size_t ordinal) const noexcept {
+        return ordinal < count_ ? &properties_[ordinal].value : nullptr;
+    }
+
+    /// @brief Value of a property, nullptr if absent.
+    [[nodiscard]] const TdhPropertyValue* find(std::wstring_view name) const noexcept {
+        for (std::size_t i = 0; i < count_; ++i) {
+            if (properties_[i].name == name) {
+                return &properties_[i].value;
+            }
+        }
+        return nullptr;
+    }
+
+    /// @brief Writable text storage of chars characters, owned by this event.
+    [[nodiscard]] std::span<wchar_t> text(std::size_t chars);
+
+private:
+    std::array<TdhProperty, kMaxProperties> properties_{};
+    std::size_t count_ = 0;
+    std::array<wchar_t, kTextChars> text_{};
+    std::size_t text_used_ = 0;
+    std::forward_list<std::wstring> overflow_;  ///< Text beyond kTextChars
+};
+
+namespace tdh {
+
+/// @brief TDH_INTYPE values (tdh.h) a plan can decode.
+enum class InType : std::uint16_t {
+    UnicodeString = 1,
+    AnsiString = 2,
+    Int8 = 3,
+    UInt8 = 4,
+    Int16 = 5,
+    UInt16 = 6,
+    Int32 = 7,
+    UInt32 = 8,
+    Int64 = 9,
+    UInt64 = 10,
+    Float = 11,
+    Double = 12,
+    Boolean = 13,
+    Binary = 14,
+    Guid = 15,
+    Pointer = 16,
+    FileTime = 17,
+    SystemTime = 18,
+    Sid = 19,
+    HexInt32 = 20,
+    HexInt64 = 21,
+    CountedString = 300,
+    WbemSid = 310,
+};
+
+/// @brief One property (top-level or struct member) as described by TRACE_EVENT_INFO.
+struct PropertySchema {
+    static constexpr std::uint16_t kNoProperty = 0xFFFF;
+
+    std::wstring name;
+    std::uint16_t in_type = 0;  ///< TDH_INTYPE_* (unused for structs)
+    std::uint16_t length = 0;   ///< Fixed length (characters for strings, else bytes)
+    std::uint16_t length_property = kNoProperty;  ///< PropertyParamLength source
+    std::uint16_t count = 1;    ///< Elements; anything but 1 makes an array
+    std::uint16_t count_property = kNoProperty;   ///< PropertyParamCount source
+    std::uint16_t struct_start = 0;    ///< Index of the first member (structs)
+    std::uint16_t struct_members = 0;  ///< Member count (0 = not a struct)
+};
+
+/**
+ * @brief Ordinals of the properties a converter reads, resolved per schema.
+ *
+ * Looking a property up by name compares strings against every property
+ * of the event. A converter keeps one of these per thread instead: the
+ * first event of a schema resolves every name once, and later events of
+ * that schema index their properties directly. Events without a schema
+ * identity are resolved every time.
+ */
+template <std::size_t N>
+class PropertyKeys {
+public:
+    static constexpr std::uint16_t kAbsent = 0xFFFF;  ///< Property not in the schema
+
+    explicit PropertyKeys(const std::array<std::wstring_view, N>& names) : names_(names) {}
+
+    /// @brief Ordinal of every name in the event's schema (kAbsent if missing).
+    [[nodiscard]] const std::array<std::uint16_t, N>& resolve(const TdhParsedEvent& event) {
+        Slot& slot = slots_[event.schema % kSlots];
+        if (event.schema != 0 && slot.schema == event.schema) {
+            return slot.ordinals;
+        }
+        const auto properties = event.properties();
+        for (std::size_t k = 0; k < N; ++k) {
+            slot.ordinals[k] = kAbsent;
+            for (std::size_t i = 0; i < properties.size(); ++i) {
+                if (properties[i].name == names_[k]) {
+                    slot.ordinals[k] = static_cast<std::uint16_t>(i);
+                    break;
+                }
+            }
+        }
+        slot.schema = event.schema;
+        return slot.ordinals;
+    }
+
+private:
+    static constexpr std::size_t kSlots = 8;  ///< Schemas remembered (direct mapped)
+
+    struct Slot {
+        std::uint64_t schema = 0;
+        std::array<std::uint16_t, N> ordinals{};
+    };
+
+    std::array<std::wstring_view, N> names_;
+    std::array<Slot, kSlots> slots_{};
+};
+
+/**
+ * @brief Decoder for one event layout.
+ *
+ * Values come out as the fast parsers read them: signed integers up to 32
+ * bits as int32_t, unsigned ones and booleans as uint32_t, 64-bit integers,
+ * pointers and FILETIMEs as uint64_t. Strings, GUIDs and SIDs (as
+ * "S-1-5-...") become std::wstring_view. Floats, SYSTEMTIMEs and binary
+ * data are kept as raw bytes.
+ *
+ * Thread-safety: immutable after compile(); decode() from any thread.
+ */
+class DecodePlan {
+public:
+    /**
+     * @brief Compile a layout; nullopt if a property needs the TDH path.
+     * @param properties All properties, struct members after the top level.
+     * @param top_level Leading properties that make up the event (the rest
+     *        are struct members).
+     */
+    [[nodiscard]] static std::optional<DecodePlan> compile(
+        std::span<const PropertySchema> properties, std::size_t top_level = SIZE_MAX);
+
+    /**
+     * @brief Decode one event's UserData.
+     * @param data UserData of the record.
+     * @param pointer_size 4 or 8 (EVENT_HEADER_FLAG_32/64_BIT_HEADER).
+     * @param out Receives the properties in schema order (appended).
+     *            Strings and binary values may view data.
+     * @return false if data ended early; the properties before are kept,
+     *         the rest are monostate.
+     */
+    bool decode(std::span<const std::uint8_t> data, unsigned pointer_size,
+                TdhParsedEvent& out) const;
+
+    /// @brief Number of properties decoded per event (struct members included).
+    [[nodiscard]] std::size_t size() const noexcept { return fields_.size(); }
+
+    /// @brief Leading top-level properties read at precomputed offsets.
+    [[nodiscard]] std::size_t fixed_fields() const noexcept { return fixed_fields_; }
+
+    /// @brief Bytes covered by the leading fixed fields.
+    [[nodiscard]] std::size_t fixed_size(unsigned pointer_size) const noexcept {
+        return fixed_size_[pointer_size == 4 ? 0 : 1];
+    }
+
+private:
+    /// @brief How a field's size is found.
+    enum class Rule : std::uint8_t {
+        Fixed,      ///< size bytes
+        Pointer,    ///< Pointer size
+        Utf16Z,     ///< NUL-terminated UTF-16
+        AnsiZ,      ///< NUL-terminated 8-bit
+        Counted,    ///< 16-bit byte count, then UTF-16
+        Sid,        ///< SID, sized by its sub-authority count
+        WbemSid,    ///< TOKEN_USER (two pointers), then SID
+        FromField,  ///< Count from an earlier integer property
+        Struct,     ///< Its members, one after the other
+    };
+
+    /// Element size that depends on the data.
+    static constexpr std::uint16_t kVariable = 0xFFFF;
+
+    struct Field {
+        std::wstring name;
+        InType type = InType::UInt32;
+        Rule rule = Rule::Fixed;
+        std::uint16_t size = 0;        ///< Bytes (Fixed)
+        std::uint16_t length_of = 0;   ///< Source property (FromField)
+        std::uint16_t count = 1;       ///< Elements (without count_of)
+        std::uint16_t count_of = PropertySchema::kNoProperty;  ///< Source of the count
+        std::uint16_t first_member = 0;  ///< Struct members are fields_[first_member, +members)
+        std::uint16_t members = 0;
+        std::array<std::uint16_t, 2> element{};  ///< Element bytes per pointer size (kVariable)
+        std::array<std::uint16_t, 2> offset{};  ///< Pointer size 4, 8 (fixed fields)
+
+        [[nodiscard]] bool array() const noexcept {
+            return count != 1 || count_of != PropertySchema::kNoProperty;
+        }
+    };
+
+    /// @brief Bytes of a whole field with fixed size, kVariable otherwise.
+    [[nodiscard]] std::size_t total_size(const Field& field, std::size_t ps) const noexcept;
+
+    /// @brief Decode field index at pos (all its elements); false if data ended.
+    bool read(std::size_t index, std::span<const std::uint8_t> data, std::size_t& pos,
+              std::size_t ps, std::size_t base, TdhParsedEvent& out, bool store) const;
+
+    /// @brief Decode one element of field index at pos.
+    bool read_element(std::size_t index, std::span<const std::uint8_t> data,
+                      std::size_t& pos, std::size_t ps, std::size_t base,
+                      TdhParsedEvent& out, bool store) const;
+
+    std::vector<Field> fields_;  ///< One per schema property, in schema order
+    std::size_t top_level_ = 0;
+    std::size_t fixed_fields_ = 0;
+    std::array<std::size_t, 2> fixed_size_{};
+};
+
+/**
+ * @brief Decode one scalar value from the front of data, as DecodePlan does.
+ *
+ * For the TDH path of events without a plan: integers, pointers, FILETIMEs,
+ * GUIDs, SIDs and strings are read from UserData instead of being
+ * formatted by TdhFormatProperty and parsed back.
+ *
+ * @param length Characters (strings) or bytes (binary); 0 for the natural
+ *        size or a NUL-terminated string.
+ * @param consumed Receives the bytes read.
+ * @return nullopt if the type is not decoded natively or data ends early.
+ */
+[[nodiscard]] std::optional<TdhPropertyValue> decode_value(
+    InType type, std::size_t length, unsigned pointer_size,
+    std::span<const std::uint8_t> data, TdhParsedEvent& out, std::size_t& consumed);
+
+}  // namespace tdh
+}  // namespace exeray::etw
@@ -0,0 +1,151 @@
+/// @file field_table.hpp
+/// @brief Descriptor tables that copy TDH properties into payload fields.
+///
+/// A TDH converter is a list of "property X goes to field Y as Z". Spelling
+/// that out as getter calls and fallback branches per field made every
+/// converter its own little parser. A FieldTable states it as constexpr
+/// rows of (property name, byte offset in the target, transform) instead.
+/// A FieldMapper resolves the names to schema ordinals once per schema
+/// (through PropertyKeys) and converts each event in one loop over the
+/// rows, copying integers and interning strings, without lookups by name.
+///
+/// Rows that write the same offset are alternatives, tried in table order:
+/// the first property present with a non-zero integer or non-empty string
+/// fills the field and the rest are skipped.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include "exeray/etw/tdh/decode_plan.hpp"
+
+namespace exeray::event {
+class StringPool;
+}
+
+namespace exeray::etw::tdh {
+
+/// @brief How a property value becomes a field.
+enum class Transform : std::uint8_t {
+    U16,       ///< Integer truncated to 16 bits
+    U32,       ///< Integer truncated to 32 bits
+    U64,       ///< Integer
+    String,    ///< Interned StringId (StringPool::intern_wide)
+    Path,      ///< Interned path StringId (StringPool::intern_path_wide)
+    LogString, ///< As String, but the event log's "-" placeholder reads as missing
+};
+
+/// @brief Bytes a transform writes.
+[[nodiscard]] constexpr std::size_t transform_size(Transform transform) noexcept {
+    switch (transform) {
+        case Transform::U16: return 2;
+        case Transform::U64: return 8;
+        default: return 4;  // U32 and StringIds
+    }
+}
+
+/// @brief One row: which property fills which field, and how.
+struct FieldDescriptor {
+    std::wstring_view property;
+    std::uint16_t offset = 0;  ///< Byte offset in the target (offsetof)
+    Transform transform = Transform::U32;
+};
+
+/**
+ * @brief Copy the rows' properties into target.
+ *
+ * @param ordinals Schema ordinal per row (out of range = missing).
+ * @param alternative Per row, the first row writing the same offset.
+ * @param strings Pool for string transforms; nullptr leaves string fields
+ *        as they are.
+ */
+void copy_fields(std::span<const FieldDescriptor> rows,
+                 std::span<const std::uint16_t> ordinals,
+                 std::span<const std::uint8_t> alternative, const TdhParsedEvent& event,
+                 std::byte* target, event::StringPool* strings);
+
+/**
+ * @brief Rows converting TDH events into a T, checked at compile time.
+ *
+ * Build one with field_table<T>({...}); a row that does not fit in T
+ * fails to compile.
+ */
+template <typename T, std::size_t N>
+class FieldTable {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "Fields are written as bytes");
+    static_assert(N > 0 && N <= 64, "Alternatives are tracked in a 64-bit mask");
+
+    consteval explicit FieldTable(const std::array<FieldDescriptor, N>& rows) : rows_(rows) {
+        for (std::size_t i = 0; i < N; ++i) {
+            if (rows[i].offset + transform_size(rows[i].transform) > sizeof(T)) {
+                throw std::out_of_range("FieldTable row outside its target");
+            }
+            names_[i] = rows[i].property;
+            alternative_[i] = static_cast<std::uint8_t>(i);
+            for (std::size_t j = 0; j < i; ++j) {
+                if (rows[j].offset == rows[i].offset) {
+                    if (rows[j].transform != rows[i].transform) {
+                        throw std::logic_error("FieldTable alternatives differ in transform");
+                    }
+                    alternative_[i] = alternative_[j];
+                    break;
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] constexpr const std::array<FieldDescriptor, N>& rows() const noexcept {
+        return rows_;
+    }
+    [[nodiscard]] constexpr const std::array<std::wstring_view, N>& names() const noexcept {
+        return names_;
+    }
+    [[nodiscard]] constexpr const std::array<std::uint8_t, N>& alternatives() const noexcept {
+        return alternative_;
+    }
+
+private:
+    std::array<FieldDescriptor, N> rows_;
+    std::array<std::wstring_view, N> names_{};
+    std::array<std::uint8_t, N> alternative_{};
+};
+
+/// @brief Table of rows targeting a T (N deduced from the rows).
+template <typename T, std::size_t N>
+consteval FieldTable<T, N> field_table(const FieldDescriptor (&rows)[N]) {
+    std::array<FieldDescriptor, N> copy{};
+    for (std::size_t i = 0; i < N; ++i) {
+        copy[i] = rows[i];
+    }
+    return FieldTable<T, N>(copy);
+}
+
+/**
+ * @brief A FieldTable with its ordinals resolved per schema.
+ *
+ * Keep one per thread, like PropertyKeys.
+ */
+template <typename T, std::size_t N>
+class FieldMapper {
+public:
+    explicit FieldMapper(const FieldTable<T, N>& table) : table_(table), keys_(table.names()) {}
+
+    /// @brief Fill target's fields from event (fields without a value are left as they are).
+    void apply(const TdhParsedEvent& event, T& target, event::StringPool* strings) {
+        copy_fields(table_.rows(), keys_.resolve(event), table_.alternatives(), event,
+                    reinterpret_cast<std::byte*>(&target), strings);
+    }
+
+private:
+    FieldTable<T, N> table_;
+    PropertyKeys<N> keys_;
+};
+
+}  // namespace exeray::etw::tdh
@@ -13,15 +13,15 @@
 #include <evntcons.h>
 #include <tdh.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <string>
-#include <unordered_map>
-#include <variant>
-#include <vector>
+#include <string_view>
 
 #include "exeray/event/types.hpp"
 #include "exeray/etw/parser.hpp"
+#include "exeray/etw/tdh/decode_plan.hpp"
 
 namespace exeray::event {
 class StringPool;
@@ -29,29 +29,13 @@ class StringPool;
 
 namespace exeray::etw {
 
-/// @brief Property value types that TDH can extract.
-using TdhPropertyValue = std::variant<
-    uint64_t,
-    uint32_t,
-    int32_t,
-    std::wstring,
-    std::vector<uint8_t>
->;
-
-/// @brief TDH-parsed event as key-value pairs.
-struct TdhParsedEvent {
-    std::unordered_map<std::wstring, TdhPropertyValue> properties;
-    uint16_t event_id{0};
-    uint8_t event_version{0};
-};
-
 namespace tdh::detail {
 
 /// @brief Get pointer size from event header flags.
 ULONG get_pointer_size(const EVENT_RECORD* record);
 
-/// @brief Extract property name from TRACE_EVENT_INFO.
-std::wstring get_property_name(PTRACE_EVENT_INFO info, ULONG property_index);
+/// @brief Property name from TRACE_EVENT_INFO (points into info).
+std::wstring_view get_property_name(PTRACE_EVENT_INFO info, ULONG property_index);
 
 /// @brief Get property size from event info.
 ULONG get_property_size(
@@ -61,22 +45,28 @@ ULONG get_property_size(
 );
 
 /// @brief Extract a single property value from event data.
+///
+/// Formatted text is stored in event, which the returned value may view.
 std::optional<TdhPropertyValue> extract_property(
     PTRACE_EVENT_INFO info,
     const EVENT_RECORD* record,
     ULONG property_index,
     PBYTE& user_data,
-    ULONG& user_data_length
+    ULONG& user_data_length,
+    TdhParsedEvent& event
 );
 
-/// @brief Get wide string property or empty.
-std::wstring get_wstring_prop(const TdhParsedEvent& event, const std::wstring& name);
+// Getters take ordinals from a tdh::PropertyKeys; out-of-range ordinals
+// (PropertyKeys::kAbsent) read as missing.
+
+/// @brief Get wide string property or empty (views the event or its record).
+std::wstring_view get_wstring_prop(const TdhParsedEvent& event, std::size_t ordinal);
 
 /// @brief Get uint32 property or 0.
-uint32_t get_uint32_prop(const TdhParsedEvent& event, const std::wstring& name);
+uint32_t get_uint32_prop(const TdhParsedEvent& event, std::size_t ordinal);
 
 /// @brief Get uint64 property or 0.
-uint64_t get_uint64_prop(const TdhParsedEvent& event, const std::wstring& name);
+uint64_t get_uint64_prop(const TdhParsedEvent& event, std::size_t ordinal);
 
 }  // namespace tdh::detail
 }  // namespace exeray::etw
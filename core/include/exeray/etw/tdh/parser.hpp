@@ -12,16 +12,17 @@
 #include <evntrace.h>
 #include <evntcons.h>
 
-#include <optional>
-
 #include "exeray/etw/tdh/internal.hpp"
 #include "exeray/etw/tdh/schema_cache.hpp"
 
 namespace exeray::etw {
 
 /// @brief Parse an event using TDH API.
-std::optional<TdhParsedEvent> parse_with_tdh(
+/// @param out Receives the properties; its values may view record's UserData.
+/// @return false if the event has no schema.
+bool parse_with_tdh(
     const EVENT_RECORD* record,
+    TdhParsedEvent& out,
     TdhSchemaCache* cache = nullptr
 );
 
@@ -32,18 +33,17 @@ TdhSchemaCache& global_tdh_cache();
 
 #else  // !_WIN32
 
-#include <optional>
+#include "exeray/etw/tdh/decode_plan.hpp"
 #include "exeray/etw/tdh/schema_cache.hpp"
 
 namespace exeray::etw {
 
-struct TdhParsedEvent {};
-
-inline std::optional<TdhParsedEvent> parse_with_tdh(
+inline bool parse_with_tdh(
     const void* /*record*/,
+    TdhParsedEvent& /*out*/,
     TdhSchemaCache* /*cache*/ = nullptr
 ) {
-    return std::nullopt;
+    return false;
 }
 
 inline TdhSchemaCache& global_tdh_cache() {
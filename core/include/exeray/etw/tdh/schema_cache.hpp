@@ -13,16 +13,58 @@
 #include <evntcons.h>
 #include <tdh.h>
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <filesystem>
+#include <memory>
 #include <mutex>
-#include <unordered_map>
+#include <optional>
 #include <vector>
 
+#include "exeray/etw/tdh/decode_plan.hpp"
+
 namespace exeray::etw {
 
-/// @brief Cache for event schemas to avoid repeated TdhGetEventInformation calls.
+/// @brief A cached TRACE_EVENT_INFO and the decode plan compiled from it.
+struct TdhSchema {
+    std::vector<BYTE> buffer;               ///< TRACE_EVENT_INFO storage
+    std::optional<tdh::DecodePlan> plan;    ///< Empty if the layout needs TDH
+    std::uint64_t id = 0;                   ///< Never reused (TdhParsedEvent::schema)
+
+    [[nodiscard]] PTRACE_EVENT_INFO info() const noexcept {
+        return reinterpret_cast<PTRACE_EVENT_INFO>(const_cast<BYTE*>(buffer.data()));
+    }
+};
+
+/**
+ * @brief Cache for event schemas to avoid repeated TdhGetEventInformation calls.
+ *
+ * After warmup the cache is read-only, so lookups take no lock: they probe
+ * an open-addressing table of atomic entry pointers. A miss fetches the
+ * schema and compiles its plan outside any lock, then inserts it unless
+ * another thread got there first. Inserts are serialized by a mutex and
+ * publish each entry with one release store; a full table is replaced by
+ * a larger copy while the old one stays readable.
+ *
+ * Entries are never moved once inserted, so the schema, its plan and the
+ * property names they hand out stay valid until clear(), which must not
+ * run while events are parsed.
+ *
+ * load() and save() carry the schemas across runs (see schema_file.hpp);
+ * prewarm() resolves a provider's whole manifest up front.
+ */
 class TdhSchemaCache {
 public:
+    TdhSchemaCache();
+    ~TdhSchemaCache();
+
+    TdhSchemaCache(const TdhSchemaCache&) = delete;
+    TdhSchemaCache& operator=(const TdhSchemaCache&) = delete;
+
+    /// @brief Get or fetch the schema and plan of an event, nullptr on failure.
+    const TdhSchema* get(const EVENT_RECORD* record);
+
     /// @brief Get or fetch schema for an event.
     PTRACE_EVENT_INFO get_schema(const EVENT_RECORD* record);
 
@@ -32,6 +74,18 @@ public:
     /// @brief Get number of cached schemas.
     size_t size() const;
 
+    /// @brief Add the schemas of a file written for this OS build.
+    /// @return Schemas added (0 if the file is missing or stale).
+    std::size_t load(const std::filesystem::path& path);
+
+    /// @brief Write all cached schemas to a file.
+    /// @return false if the file could not be written.
+    bool save(const std::filesystem::path& path);
+
+    /// @brief Fetch every event schema of a manifest provider.
+    /// @return Schemas added (0 for providers without a manifest).
+    std::size_t prewarm(const GUID& provider);
+
 private:
     struct EventKey {
         GUID provider_guid;
@@ -44,20 +98,59 @@ private:
         size_t operator()(const EventKey& key) const;
     };
 
-    mutable std::mutex mutex_;
-    std::unordered_map<EventKey, std::vector<BYTE>, EventKeyHash> cache_;
+    struct Entry {
+        EventKey key;
+        TdhSchema schema;
+    };
+
+    struct Table {
+        explicit Table(std::size_t slot_count);
+        std::size_t mask;
+        std::unique_ptr<std::atomic<const Entry*>[]> slots;  ///< nullptr = empty
+    };
+
+    /// @brief Lock-free probe of the current table.
+    [[nodiscard]] const Entry* find(const EventKey& key) const noexcept;
+
+    /// @brief Fetch a schema from TDH and compile its plan (no lock held).
+    [[nodiscard]] static std::unique_ptr<Entry> fetch(const EVENT_RECORD* record,
+                                                      const EventKey& key);
+
+    /// @brief Wrap a TRACE_EVENT_INFO and compile its plan (no lock held).
+    [[nodiscard]] static std::unique_ptr<Entry> make_entry(const EventKey& key,
+                                                           std::vector<BYTE> buffer);
+
+    /// @brief Insert unless the key is present; returns the entry kept.
+    const Entry* insert(std::unique_ptr<Entry> fresh);
+
+    /// @brief Publish an entry into a table with room for it (mutex_ held).
+    static void place(Table& table, const Entry* entry) noexcept;
+
+    std::atomic<Table*> table_{nullptr};
+    std::atomic<std::size_t> count_{0};
+    std::mutex mutex_;                             ///< Serializes inserts and clear()
+    std::vector<std::unique_ptr<Table>> tables_;   ///< Every generation (mutex_)
+    std::vector<std::unique_ptr<Entry>> entries_;  ///< Owned entries (mutex_)
 };
 
 }  // namespace exeray::etw
 
 #else  // !_WIN32
 
+#include <cstddef>
+#include <filesystem>
+
+#include "exeray/platform/guid.hpp"
+
 namespace exeray::etw {
 
 class TdhSchemaCache {
 public:
     void clear() {}
     size_t size() const { return 0; }
+    std::size_t load(const std::filesystem::path& /*path*/) { return 0; }
+    bool save(const std::filesystem::path& /*path*/) { return false; }
+    std::size_t prewarm(const GUID& /*provider*/) { return 0; }
 };
 
 }  // namespace exeray::etw
@@ -0,0 +1,74 @@
+/// @file schema_file.hpp
+/// @brief On-disk form of the TDH schema cache.
+///
+/// Resolving a schema with TdhGetEventInformation costs a trip through the
+/// manifest store on the first event of every (provider, id, version), so
+/// the first seconds of a session are slow and spiky. The cache is written
+/// to a file on shutdown and read back at startup. Manifests change with OS
+/// updates, so the file carries a fingerprint of the build and is ignored
+/// when it does not match.
+///
+/// Layout (native byte order): a 32-byte header {magic, format, fingerprint,
+/// count, reserved, FNV-1a of the records}, then per record the provider
+/// GUID, id (u16), version (u8), one pad byte, the size (u32) and that many
+/// TRACE_EVENT_INFO bytes, padded to 8.
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "exeray/platform/guid.hpp"
+
+namespace exeray::etw::tdh {
+
+/// @brief One cached schema: its key and the raw TRACE_EVENT_INFO.
+struct SchemaRecord {
+    GUID provider{};
+    std::uint16_t event_id = 0;
+    std::uint8_t event_version = 0;
+    std::vector<std::uint8_t> info;
+};
+
+/// @brief "EXRS" in the first four bytes of a schema file.
+inline constexpr std::uint32_t kSchemaFileMagic = 0x53525845;
+
+/// @brief Bumped whenever the layout changes.
+inline constexpr std::uint32_t kSchemaFileFormat = 1;
+
+/// @brief Largest TRACE_EVENT_INFO accepted from a file.
+inline constexpr std::uint32_t kMaxSchemaBytes = 1U << 20;
+
+/// @brief Serialize schemas for the given OS fingerprint.
+[[nodiscard]] std::vector<std::uint8_t> encode_schemas(std::span<const SchemaRecord> records,
+                                                       std::uint64_t fingerprint);
+
+/**
+ * @brief Parse what encode_schemas() produced.
+ * @return nullopt if the data is truncated, corrupt, of another format or
+ *         written for another fingerprint.
+ */
+[[nodiscard]] std::optional<std::vector<SchemaRecord>> decode_schemas(
+    std::span<const std::uint8_t> bytes, std::uint64_t fingerprint);
+
+/// @brief Write a schema file, replacing the old one only once complete.
+/// @return false if the file could not be written.
+bool write_schema_file(const std::filesystem::path& path,
+                       std::span<const SchemaRecord> records, std::uint64_t fingerprint);
+
+/// @brief Read a schema file; nullopt if missing or unusable (see decode_schemas()).
+[[nodiscard]] std::optional<std::vector<SchemaRecord>> read_schema_file(
+    const std::filesystem::path& path, std::uint64_t fingerprint);
+
+/**
+ * @brief Identity of the installed event manifests.
+ *
+ * Windows version, build and update revision (UBR), which changes with
+ * every cumulative update. 0 on other platforms.
+ */
+[[nodiscard]] std::uint64_t os_fingerprint();
+
+}  // namespace exeray::etw::tdh
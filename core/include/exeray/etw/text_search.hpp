@@ -0,0 +1,123 @@
+#pragma once
+
+/// @file text_search.hpp
+/// @brief Case-insensitive substring search shared by the event detectors.
+///
+/// The detectors look for short ASCII needles (paths, class names, tool
+/// names) in the UTF-16 strings of an event. find_icase() locates the
+/// candidate positions with SSE2 (AVX2 with EXERAY_ENABLE_AVX2): one
+/// comparison against the needle's first character and one against its
+/// last, both case-folded, for 8 or 16 positions at a time. Only the
+/// positions where both match are compared in full. IcaseNeedles searches
+/// for a whole set of needles in one pass, so a detector does not walk the
+/// same string once per needle.
+///
+/// Case folding is ASCII only (A-Z), as in the detectors it replaces. The
+/// UTF-8 overloads run the same kernel a byte per lane, for searches over
+/// interned strings.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string_view>
+
+namespace exeray::etw {
+
+/// @brief Position of needle in haystack, ignoring ASCII case.
+/// @return Index of the first occurrence, or npos if absent or needle is empty.
+[[nodiscard]] std::size_t find_icase(std::wstring_view haystack,
+                                     std::wstring_view needle) noexcept;
+
+/// @brief Whether needle occurs in haystack, ignoring ASCII case.
+[[nodiscard]] inline bool contains_icase(std::wstring_view haystack,
+                                         std::wstring_view needle) noexcept {
+    return find_icase(haystack, needle) != std::wstring_view::npos;
+}
+
+/// @brief find_icase() over UTF-8 (bytes beyond ASCII compare exactly).
+[[nodiscard]] std::size_t find_icase(std::string_view haystack,
+                                     std::string_view needle) noexcept;
+
+/// @brief contains_icase() over UTF-8.
+[[nodiscard]] inline bool contains_icase(std::string_view haystack,
+                                         std::string_view needle) noexcept {
+    return find_icase(haystack, needle) != std::string_view::npos;
+}
+
+/**
+ * @brief A fixed set of needles searched for together.
+ *
+ * Needles are bucketed by their case-folded first character, so each
+ * haystack position is compared only against the needles that can start
+ * there. The needles are viewed, not copied: they are meant to be string
+ * literals.
+ *
+ * Thread-safety: immutable after construction; match() from any thread.
+ */
+class IcaseNeedles {
+public:
+    static constexpr std::size_t kMaxNeedles = 64;  ///< Bits of the match mask
+
+    /// @brief Empty needles never match; those past kMaxNeedles are ignored.
+    constexpr IcaseNeedles(std::initializer_list<std::wstring_view> needles) noexcept {
+        for (const std::wstring_view needle : needles) {
+            add(needle);
+        }
+    }
+
+    template <std::size_t N>
+    constexpr explicit IcaseNeedles(const wchar_t* const (&needles)[N]) noexcept {
+        for (const wchar_t* needle : needles) {
+            add(needle);
+        }
+    }
+
+    /// @brief Needles found in haystack, bit i for the i-th needle.
+    [[nodiscard]] std::uint64_t match(std::wstring_view haystack) const noexcept {
+        return scan(haystack, false);
+    }
+
+    /// @brief Whether any needle occurs in haystack (stops at the first).
+    [[nodiscard]] bool any(std::wstring_view haystack) const noexcept {
+        return scan(haystack, true) != 0;
+    }
+
+    [[nodiscard]] constexpr std::size_t size() const noexcept { return count_; }
+
+private:
+    static constexpr std::size_t kAscii = 128;
+
+    static constexpr wchar_t fold(wchar_t c) noexcept {
+        return (c >= L'A' && c <= L'Z') ? static_cast<wchar_t>(c - L'A' + L'a') : c;
+    }
+
+    constexpr void add(std::wstring_view needle) noexcept {
+        if (count_ == kMaxNeedles) {
+            return;
+        }
+        const std::size_t index = count_++;
+        needles_[index] = needle;
+        if (needle.empty()) {
+            return;
+        }
+        const wchar_t first = fold(needle.front());
+        const std::uint64_t bit = std::uint64_t{1} << index;
+        all_ |= bit;
+        if (static_cast<std::size_t>(first) < kAscii) {
+            by_first_[static_cast<std::size_t>(first)] |= bit;
+        } else {
+            other_first_ |= bit;
+        }
+    }
+
+    std::uint64_t scan(std::wstring_view haystack, bool stop_at_first) const noexcept;
+
+    std::array<std::wstring_view, kMaxNeedles> needles_{};
+    std::array<std::uint64_t, kAscii> by_first_{};  ///< Needles by folded first character
+    std::uint64_t other_first_ = 0;                 ///< Needles starting beyond ASCII
+    std::uint64_t all_ = 0;                         ///< Every non-empty needle
+    std::size_t count_ = 0;
+};
+
+}  // namespace exeray::etw
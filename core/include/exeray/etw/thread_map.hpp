@@ -0,0 +1,82 @@
+#pragma once
+
+/// @file thread_map.hpp
+/// @brief Owning process of every live thread, for events without a PID.
+///
+/// Some providers stamp events with ProcessId 0, 4 or -1 while the thread ID
+/// in the header is right. The Thread parser records each started thread
+/// here (live ones too, through the DCStart rundown) and the consumer asks
+/// for the owner of such events. The Correlator then picks the process
+/// incarnation from the event time, so only the PID is kept.
+///
+/// Lookups are wait-free, two acquire loads: thread IDs are multiples of
+/// four, so the table is indexed directly by tid / 4 in pages allocated on
+/// first use and kept until clear().
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace exeray::etw {
+
+/**
+ * @brief Direct-indexed TID -> PID table.
+ *
+ * Holds thread IDs below kMaxThreadId; others, and IDs that are not a
+ * multiple of four, are not tracked.
+ *
+ * Thread-safety: every member but clear() may run concurrently; clear()
+ * must not run alongside any other member.
+ */
+class ThreadMap {
+public:
+    /// Slots per page (4 KiB of PIDs).
+    static constexpr std::size_t kPageSize = 1024;
+    static constexpr std::size_t kPages = 4096;
+    static constexpr std::uint64_t kMaxThreadId = 4ULL * kPageSize * kPages;
+
+    ThreadMap();
+    ~ThreadMap();
+    ThreadMap(const ThreadMap&) = delete;
+    ThreadMap& operator=(const ThreadMap&) = delete;
+
+    /// @brief A thread of pid started (or was found running).
+    void start(std::uint32_t tid, std::uint32_t pid);
+
+    /// @brief A thread ended; ignored if tid was reused by another process.
+    void end(std::uint32_t tid, std::uint32_t pid);
+
+    /// @brief Owner of tid (wait-free); 0 if unknown.
+    [[nodiscard]] std::uint32_t find(std::uint32_t tid) const noexcept {
+        if ((tid & 3U) != 0 || tid >= kMaxThreadId) {
+            return 0;
+        }
+        const std::size_t slot = tid >> 2;
+        const Page* page = pages_[slot / kPageSize].load(std::memory_order_acquire);
+        return page != nullptr ? page->pids[slot % kPageSize].load(std::memory_order_acquire) : 0;
+    }
+
+    /// @brief Threads currently mapped.
+    [[nodiscard]] std::size_t size() const noexcept {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    void clear();
+
+private:
+    struct Page {
+        std::atomic<std::uint32_t> pids[kPageSize] = {};
+    };
+
+    /// @brief Slot of tid, allocating its page; nullptr if untracked.
+    std::atomic<std::uint32_t>* slot(std::uint32_t tid);
+
+    std::unique_ptr<std::atomic<Page*>[]> pages_;
+    std::atomic<std::size_t> size_{0};
+};
+
+/// @brief Map fed by the Thread parser and read by the consumer.
+ThreadMap& thread_map();
+
+}  // namespace exeray::etw
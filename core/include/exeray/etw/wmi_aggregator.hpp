@@ -0,0 +1,135 @@
+#pragma once
+
+/// @file wmi_aggregator.hpp
+/// @brief Per-client aggregation of repeated WMI operations.
+///
+/// Management agents (SCCM, monitoring, inventory) run the same WQL query
+/// against the same namespace every few seconds, so on a managed fleet
+/// nearly every WMI event repeats one seen moments before. WmiAggregator
+/// keys each operation by (client process, operation, namespace, query,
+/// target host) and stores its first occurrence, then one summary per
+/// summary_interval_ms whose WmiPayload::count is the occurrences since
+/// the last stored one.
+///
+/// Repeats are folded whatever their verdict: it depends only on the
+/// namespace, query and host, so the first occurrence already carries it.
+/// A new query, a new client or a new target host is stored at once.
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "exeray/event/payload.hpp"
+#include "exeray/event/types.hpp"
+
+namespace exeray::etw {
+
+/// @brief Aggregation settings.
+struct WmiConfig {
+    bool enabled = true;                       ///< Store every WMI operation if false
+    std::uint32_t summary_interval_ms = 5000;  ///< 0 = only the first occurrence
+};
+
+/// @brief Occurrences of one operation of one client process.
+struct WmiOperationRecord {
+    std::uint32_t pid = 0;
+    std::uint8_t operation = 0;  ///< WmiOp
+    event::StringId wmi_namespace = event::INVALID_STRING;
+    event::StringId query = event::INVALID_STRING;
+    event::StringId target_host = event::INVALID_STRING;
+    std::uint64_t count = 0;  ///< Occurrences
+    event::Timestamp first_seen = 0;
+    event::Timestamp last_seen = 0;
+};
+
+/// @brief What the aggregator did with the WMI events it saw.
+struct WmiStats {
+    std::uint64_t operations = 0;  ///< Distinct operations tracked now
+    std::uint64_t absorbed = 0;    ///< WMI events folded into their operation, not stored
+    std::uint64_t summaries = 0;   ///< WMI events stored as a periodic summary
+    std::uint64_t overflowed = 0;  ///< WMI events stored as is because the table was full
+};
+
+/**
+ * @brief Operation table shared by the consumer shards.
+ *
+ * Bounded to kMaxOperations operations; WMI events of operations beyond
+ * that are kept unaggregated. Operations are forgotten at clear().
+ *
+ * Thread-safety: admit(), operations() and stats() from any thread (the
+ * operations are sharded by key, each shard with its own mutex); clear()
+ * between sessions.
+ */
+class WmiAggregator {
+public:
+    static constexpr std::size_t kShards = 16;
+    static constexpr std::size_t kMaxOperations = 16384;
+
+    explicit WmiAggregator(const WmiConfig& config = {});
+
+    WmiAggregator(const WmiAggregator&) = delete;
+    WmiAggregator& operator=(const WmiAggregator&) = delete;
+
+    /**
+     * @brief Account one WMI event and decide whether it is stored.
+     *
+     * A stored event has count rewritten to the occurrences it stands for.
+     * Call once the event's strings are interned.
+     *
+     * @param pid Client process.
+     * @param payload Event payload.
+     * @param operation WmiOp code.
+     * @param at Event time (graph clock).
+     * @return false if the event was absorbed into its operation.
+     */
+    [[nodiscard]] bool admit(std::uint32_t pid, event::EventPayload& payload,
+                             std::uint8_t operation, event::Timestamp at);
+
+    /// @brief Operations of pid (0 = every process), in no particular order.
+    [[nodiscard]] std::vector<WmiOperationRecord> operations(std::uint32_t pid = 0) const;
+
+    [[nodiscard]] WmiStats stats() const noexcept;
+
+    /// @brief Forget every operation and zero the counters (start of a session).
+    void clear();
+
+private:
+    struct Key {
+        std::uint32_t pid = 0;
+        std::uint8_t operation = 0;
+        event::StringId wmi_namespace = event::INVALID_STRING;
+        event::StringId query = event::INVALID_STRING;
+        event::StringId target_host = event::INVALID_STRING;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const noexcept;
+    };
+
+    struct Operation {
+        WmiOperationRecord record;
+        std::uint32_t unreported = 0;  ///< Occurrences since the last stored event
+        event::Timestamp reported_at = 0;
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<Key, Operation, KeyHash> operations;
+    };
+
+    static constexpr std::size_t kMaxOperationsPerShard = kMaxOperations / kShards;
+
+    event::Timestamp interval_;  ///< Summary interval in ns; 0 = off
+    std::array<Shard, kShards> shards_;
+    std::atomic<std::uint64_t> absorbed_{0};
+    std::atomic<std::uint64_t> summaries_{0};
+    std::atomic<std::uint64_t> overflowed_{0};
+};
+
+}  // namespace exeray::etw
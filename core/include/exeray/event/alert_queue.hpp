@@ -0,0 +1,108 @@
+#pragma once
+
+/**
+ * @file alert_queue.hpp
+ * @brief Queue of events turning Suspicious, apart from the bulk event stream.
+ *
+ * A Suspicious event is otherwise only found by scanning statuses, and a
+ * UI polling the graph sees it a frame or a batch late. EventGraph pushes
+ * an Alert here the moment it publishes an event with Status::Suspicious,
+ * or set_status() marks one, whichever detector did it. Producers never
+ * block: the queue is a bounded lock-free ring, and a full ring drops the
+ * alert and counts it. A consumer sleeping in wait() is woken by the push;
+ * producers touch the mutex only while someone waits.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+
+#include "types.hpp"
+
+namespace exeray::event {
+
+/// @brief One event that turned Suspicious; mirrored by exeray_ffi::AlertRecord.
+struct Alert {
+    EventId id = INVALID_EVENT;
+    Timestamp timestamp = 0;
+    std::uint32_t pid = 0;
+    Category category = Category::FileSystem;
+    std::uint8_t operation = 0;
+    std::uint8_t late = 0;  ///< 1 if marked after its push (set_status())
+    std::uint8_t reserved = 0;
+};
+static_assert(sizeof(Alert) == 24, "Alert layout is shared with Rust");
+
+/// @brief Alerts taken and lost so far.
+struct AlertStats {
+    std::uint64_t pushed = 0;   ///< Alerts queued
+    std::uint64_t dropped = 0;  ///< Alerts lost to a full queue
+};
+
+/**
+ * @brief Bounded multi-producer, single-consumer alert ring.
+ *
+ * Thread-safety: push() from any thread, lock-free; pop() and wait() from
+ * one consumer thread at a time; wake() and stats() from any thread.
+ */
+class AlertQueue {
+public:
+    static constexpr std::size_t kDefaultCapacity = 4096;
+
+    /// @param capacity Alerts held before pushes are dropped (rounded up to
+    ///        a power of two, at least 2).
+    explicit AlertQueue(std::size_t capacity = kDefaultCapacity);
+
+    AlertQueue(const AlertQueue&) = delete;
+    AlertQueue& operator=(const AlertQueue&) = delete;
+
+    /// @brief Queue an alert and wake the waiting consumer; false if full.
+    bool push(const Alert& alert) noexcept;
+
+    /// @brief Move the oldest alerts into out; the number written.
+    std::size_t pop(std::span<Alert> out) noexcept;
+
+    /**
+     * @brief Block until an alert is queued, wake() is called or timeout passes.
+     * @return true if alerts are waiting to be popped.
+     */
+    bool wait(std::chrono::milliseconds timeout);
+
+    /// @brief Release a consumer blocked in wait(), e.g. when a session stops.
+    void wake();
+
+    /// @brief Whether no alert is waiting to be popped.
+    [[nodiscard]] bool empty() const noexcept;
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return mask_ + 1; }
+
+    [[nodiscard]] AlertStats stats() const noexcept;
+
+private:
+    struct alignas(64) Slot {
+        /// Position the slot is free for (== it) or filled for (== it + 1)
+        std::atomic<std::uint64_t> sequence{0};
+        Alert alert;
+    };
+
+    /// @brief Notify a consumer inside wait(), if any.
+    void notify();
+
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t mask_;
+    alignas(64) std::atomic<std::uint64_t> tail_{0};  ///< Next position to fill
+    alignas(64) std::atomic<std::uint64_t> head_{0};  ///< Next position to pop
+    std::atomic<std::uint64_t> dropped_{0};
+
+    std::atomic<std::uint32_t> waiters_{0};
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    bool woken_ = false;  ///< Set by wake() (mutex_)
+};
+
+}  // namespace exeray::event
@@ -0,0 +1,69 @@
+#pragma once
+
+/**
+ * @file arrow_export.hpp
+ * @brief Export of an EventGraph to Apache Arrow IPC files, per category.
+ *
+ * Each category has its own columns, so each gets its own file,
+ * "<dir>/<Category>.arrow", in the Arrow IPC file format (Feather v2),
+ * which pyarrow, polars, DuckDB and Spark read directly and convert to
+ * Parquet. Columns are the node fields (id, parent_id, timestamp as
+ * nanoseconds, correlation_id, status, operation) followed by the
+ * category's payload members (payload_fields.hpp), unsigned integers of
+ * their own width. IPv6 network addresses add local_addr6/remote_addr6.
+ *
+ * String members become dictionary-encoded columns: int32 indices into a
+ * dictionary of UTF-8 values. The pool already stores every text once, so
+ * the dictionary is keyed by StringId: building it hashes 32-bit IDs, never
+ * the strings, and each text is resolved from the pool once per file.
+ * INVALID_STRING is a null.
+ *
+ * Batches are built in parallel, one per category and EventGraph segment
+ * (see EventGraph::parallel_reduce()), oldest first; files are then encoded
+ * and written in parallel too. The columns of the whole export are held in
+ * memory until written.
+ *
+ * Usage example:
+ * @code
+ * ThreadPool pool;
+ * if (auto done = export_arrow(graph, pool_strings, "out/", pool)) {
+ *     // out/Process.arrow, out/FileSystem.arrow, ...
+ * }
+ * @endcode
+ */
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+
+#include "graph.hpp"
+
+namespace exeray {
+class ThreadPool;
+}  // namespace exeray
+
+namespace exeray::event {
+
+/// @brief What export_arrow() wrote.
+struct ArrowExport {
+    std::size_t files = 0;    ///< Categories with events, one file each
+    std::size_t rows = 0;     ///< Events written
+    std::size_t batches = 0;  ///< Record batches over all files
+};
+
+/**
+ * @brief Write the graph's events as one Arrow IPC file per category.
+ *
+ * Existing files of the same names are replaced; categories without
+ * events get no file.
+ *
+ * @param strings Pool the graph's StringIds belong to.
+ * @param dir Directory of the files; created if missing.
+ * @return nullopt if the directory or a file could not be written.
+ */
+[[nodiscard]] std::optional<ArrowExport> export_arrow(const EventGraph& graph,
+                                                      const StringPool& strings,
+                                                      const std::filesystem::path& dir,
+                                                      ThreadPool& pool);
+
+}  // namespace exeray::event
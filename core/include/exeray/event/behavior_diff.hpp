@@ -0,0 +1,204 @@
+#pragma once
+
+/**
+ * @file behavior_diff.hpp
+ * @brief What a program did in one session and not in another.
+ *
+ * Running a binary twice (before and after an update, in a clean and a
+ * suspect environment) and comparing event lists drowns the difference in
+ * noise: IDs, timestamps, temp file names and version directories all
+ * change. BehaviorSet reduces a session to the set of distinct things it
+ * touched, as normalized features:
+ *
+ * - File: paths of file events
+ * - Registry: registry key paths
+ * - Domain: DNS names queried or connected to
+ * - RemotePort: remote ports of network events
+ * - Module: images loaded
+ *
+ * Paths are folded to lower case with '\\' separators, the component
+ * after "\\users\\" becomes '*', and every run of hex characters holding
+ * a digit (numbers, versions, GUID parts, random temp names) becomes '#':
+ * "C:\\Users\\bob\\AppData\\Local\\Temp\\tmp4A1F.tmp" and the temp file
+ * of the next run are one feature, and so are "app\\1.2.3\\x.dll" and
+ * "app\\1.2.4\\x.dll". Domains are folded to lower case.
+ *
+ * A feature is a 64-bit hash of its kind and normalized text, so a set is
+ * a sorted vector of integers: diffs are linear merges and sets from a
+ * live graph (StringPool IDs) and from a saved log (the log's own IDs)
+ * compare directly. Each set also keeps the normalized text per feature
+ * for display.
+ *
+ * Usage example:
+ * @code
+ * MappedEventLog clean;
+ * clean.open("clean.exrl");
+ * const BehaviorSet before = BehaviorSet::from_log(clean);
+ * const BehaviorSet after = BehaviorSet::from_graph(graph, strings);
+ * for (const std::uint64_t feature : diff_behavior(before, after).added) {
+ *     show(feature_kind(feature), after.describe(feature));
+ * }
+ * @endcode
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "columns.hpp"
+#include "graph.hpp"
+#include "mapped_log.hpp"
+#include "string_pool.hpp"
+
+namespace exeray::event {
+
+/// @brief Kind of a behavior feature (the top four bits of its hash).
+enum class FeatureKind : std::uint8_t {
+    File,
+    Registry,
+    Domain,
+    RemotePort,
+    Module
+};
+
+/// @brief Kind of a feature hash.
+[[nodiscard]] constexpr FeatureKind feature_kind(std::uint64_t feature) noexcept {
+    return static_cast<FeatureKind>(feature >> 60);
+}
+
+/**
+ * @brief Normalize a file, registry or module path as features compare it.
+ * @return Lower case, '\\'-separated, with user names and hex runs holding
+ *         digits collapsed.
+ */
+[[nodiscard]] std::string normalize_behavior_path(std::string_view path);
+
+/**
+ * @brief Distinct normalized behavior features of one session.
+ *
+ * Build it with from_graph() or from_log(), or add() events one by one and
+ * then seal(). Thread-safety: none while building; const methods from any
+ * thread once sealed.
+ */
+class BehaviorSet {
+public:
+    /**
+     * @brief Features of the events of a live graph that match scope.
+     * @param strings The graph's string pool.
+     * @param scope Events to consider (e.g. a time range or a PID; default all).
+     */
+    [[nodiscard]] static BehaviorSet from_graph(const EventGraph& graph,
+                                                const StringPool& strings,
+                                                const FilterSpec& scope = {});
+
+    /// @brief Features of the events of a saved log that match scope.
+    [[nodiscard]] static BehaviorSet from_log(const MappedEventLog& log,
+                                              const FilterSpec& scope = {});
+
+    /**
+     * @brief Add the features of one event.
+     * @param resolve Text of the event's StringIds.
+     */
+    template <typename Resolve>
+    void add(const EventView& event, const Resolve& resolve);
+
+    /// @brief Sort the features added so far.
+    void seal();
+
+    /// @brief Feature hashes, ascending (after seal()).
+    [[nodiscard]] std::span<const std::uint64_t> features() const noexcept {
+        return features_;
+    }
+
+    /// @brief Number of distinct features (after seal()).
+    [[nodiscard]] std::size_t size() const noexcept { return features_.size(); }
+
+    /// @brief Whether the set holds a feature (after seal()).
+    [[nodiscard]] bool contains(std::uint64_t feature) const noexcept;
+
+    /// @brief Normalized text of a feature of this set (empty if not in it).
+    [[nodiscard]] std::string_view describe(std::uint64_t feature) const noexcept;
+
+private:
+    /// @brief Normalize text for its kind and add the feature (once); its hash.
+    std::uint64_t add_text(FeatureKind kind, std::string_view text);
+
+    /// @brief Add the feature of a string, normalized once per StringId.
+    template <typename Resolve>
+    void add_string(FeatureKind kind, StringId id, const Resolve& resolve);
+
+    std::vector<std::uint64_t> features_;
+    std::unordered_map<std::uint64_t, std::string> names_;
+    /// Feature of each (kind, StringId) seen so far
+    std::unordered_map<std::uint64_t, std::uint64_t> by_string_;
+};
+
+/// @brief Features two sessions do not share.
+struct BehaviorDiff {
+    std::vector<std::uint64_t> added;    ///< Only in the second set, ascending
+    std::vector<std::uint64_t> removed;  ///< Only in the first set, ascending
+    std::size_t shared = 0;              ///< In both
+
+    /// @brief Jaccard similarity of the two sets (1 if both are empty).
+    [[nodiscard]] double similarity() const noexcept {
+        const std::size_t all = shared + added.size() + removed.size();
+        return all == 0 ? 1.0 : static_cast<double>(shared) / static_cast<double>(all);
+    }
+};
+
+/// @brief Compare the features of two sealed sets (before, after).
+[[nodiscard]] BehaviorDiff diff_behavior(const BehaviorSet& before, const BehaviorSet& after);
+
+// =============================================================================
+// Template Implementation
+// =============================================================================
+
+template <typename Resolve>
+void BehaviorSet::add_string(FeatureKind kind, StringId id, const Resolve& resolve) {
+    if (id == INVALID_STRING) {
+        return;
+    }
+    const std::uint64_t key = (static_cast<std::uint64_t>(kind) << 32) | id;
+    if (by_string_.contains(key)) {
+        return;  // Already added
+    }
+    const std::string_view text = resolve(id);
+    if (!text.empty()) {
+        by_string_.emplace(key, add_text(kind, text));
+    }
+}
+
+template <typename Resolve>
+void BehaviorSet::add(const EventView& event, const Resolve& resolve) {
+    const EventPayload& payload = event.payload();
+    switch (payload.category) {
+        case Category::FileSystem:
+            add_string(FeatureKind::File, payload.file.path, resolve);
+            break;
+        case Category::Registry:
+            add_string(FeatureKind::Registry, payload.registry.key_path, resolve);
+            break;
+        case Category::Image:
+            add_string(FeatureKind::Module, payload.image.image_path, resolve);
+            break;
+        case Category::Dns:
+            add_string(FeatureKind::Domain, payload.dns.domain, resolve);
+            break;
+        case Category::Network:
+            if (payload.network.remote_port != 0) {
+                add_text(FeatureKind::RemotePort, std::to_string(payload.network.remote_port));
+            }
+            if (payload.network.family != kAddressIPv6) {
+                add_string(FeatureKind::Domain, payload.network.remote_domain, resolve);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+}  // namespace exeray::event
@@ -0,0 +1,279 @@
+#pragma once
+
+/**
+ * @file columns.hpp
+ * @brief Columnar (structure-of-arrays) storage for sealed EventGraph segments.
+ *
+ * A segment is sealed once every one of its slots is published; from then on
+ * its nodes never change. Sealing copies the fields that filters look at into
+ * dense per-field arrays so a scan only touches the columns it needs. The
+ * 64-byte nodes stay in place, so EventView and get() are unaffected.
+ *
+ * Sealing also groups the rows by category, status and correlation ID
+ * (SegmentBitmaps), so a filter on those fields ORs and ANDs row sets
+ * instead of reading their columns, and skips a segment outright when the
+ * combination selects nothing.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "node.hpp"
+#include "payload_visit.hpp"
+
+namespace exeray::event {
+
+/**
+ * @brief Extract the process ID an event is attributed to.
+ * @param payload Event payload.
+ * @return Process ID for categories that carry one, 0 otherwise.
+ */
+[[nodiscard]] inline uint32_t event_pid(const EventPayload& payload) noexcept {
+    uint32_t pid = 0;
+    visit(payload, [&pid](const auto& p) {
+        using T = std::remove_cvref_t<decltype(p)>;
+        if constexpr (payload_has_pid<T>) {
+            pid = p.*PayloadTraits<T>::pid;
+        }
+    });
+    return pid;
+}
+
+/**
+ * @brief Whether any string field of a payload holds id.
+ * @param payload Event payload.
+ * @param id Interned string (INVALID_STRING never matches).
+ */
+[[nodiscard]] inline bool carries_string(const EventPayload& payload, StringId id) noexcept {
+    bool found = false;
+    for_each_string(payload, [id, &found](StringId value) { found |= value == id; });
+    return found && id != INVALID_STRING;
+}
+
+/**
+ * @brief Extract the remote port of a network event.
+ * @param payload Event payload.
+ * @return Remote port for Network events, 0 otherwise.
+ */
+[[nodiscard]] inline uint16_t event_remote_port(const EventPayload& payload) noexcept {
+    return payload.category == Category::Network ? payload.network.remote_port : 0;
+}
+
+/**
+ * @brief Column arrays of one sealed segment (kSegmentSize rows each).
+ *
+ * Row i describes the node at the same offset in the segment.
+ */
+struct SegmentColumns {
+    Timestamp* timestamps;      ///< EventNode::timestamp
+    uint32_t* correlation_ids;  ///< EventNode::correlation_id
+    uint32_t* pids;             ///< event_pid() of the payload
+    uint16_t* remote_ports;     ///< event_remote_port() of the payload
+    Category* categories;       ///< EventPayload::category
+    uint8_t* operations;        ///< EventNode::operation
+    Status* statuses;           ///< EventNode::status
+};
+
+/**
+ * @brief Rows of a sealed segment grouped by the value of one column.
+ *
+ * Roaring-style containers: each distinct key owns a sorted list of row
+ * numbers, and a key with at least kDenseRows rows also gets a bitmap of
+ * the segment, which is smaller than its list and ORs a word at a time.
+ * Built once by store_bitmaps() and immutable while the segment is sealed.
+ */
+struct RowGroups {
+    /// Rows from which a bitmap (rows / 8 bytes) beats a row list (2 bytes per row).
+    static constexpr std::size_t kDenseRows = 256;
+    /// Most rows per segment (row numbers are 16-bit).
+    static constexpr std::size_t kMaxRows = std::size_t{1} << 16;
+
+    std::uint32_t* keys;      ///< Distinct keys, ascending (key_count entries)
+    std::uint32_t* offsets;   ///< Rows of keys[k] are rows[offsets[k], offsets[k + 1])
+    std::uint16_t* rows;      ///< Row numbers grouped by key, ascending within a key
+    std::int16_t* dense;      ///< Bitmap slot of keys[k] (-1 = row list only)
+    std::uint64_t* bitmaps;   ///< rows / kDenseRows bitmaps of rows / 64 words
+    std::uint32_t key_count;  ///< Distinct keys in the segment
+};
+
+/// @brief Row groups of one sealed segment, per filterable key column.
+struct SegmentBitmaps {
+    RowGroups categories;
+    RowGroups statuses;
+    RowGroups correlations;
+    /// Cleared when a sealed event changes status; filters then read the
+    /// status column instead of the stale groups
+    std::atomic<bool> statuses_current{false};
+};
+
+/**
+ * @brief Simple conjunctive predicate over the indexed event fields.
+ *
+ * Every field defaults to "any". Evaluated against a node for hot segments
+ * and against column rows for sealed segments, with identical results.
+ * string_id has no column: it is checked against the payload, by the node
+ * and view overloads of matches() and by filter_nodes().
+ */
+struct FilterSpec {
+    uint32_t categories = 0;   ///< Bitmask of 1u << Category (0 = any)
+    uint32_t statuses = 0;     ///< Bitmask of 1u << Status (0 = any)
+    int16_t operation = -1;    ///< Operation code (-1 = any)
+    uint32_t pid = 0;          ///< event_pid() to match (0 = any)
+    uint16_t remote_port = 0;  ///< Network remote port (0 = any)
+    uint32_t correlation_id = 0;  ///< Correlation ID (0 = any)
+    StringId string_id = INVALID_STRING;  ///< String some payload field holds (0 = any)
+    Timestamp from = 0;        ///< Inclusive lower time bound
+    Timestamp to = std::numeric_limits<Timestamp>::max();  ///< Inclusive upper bound
+
+    /// @brief Add a category to the category set.
+    FilterSpec& with_category(Category cat) noexcept {
+        categories |= 1u << static_cast<uint32_t>(cat);
+        return *this;
+    }
+
+    /// @brief Add a status to the status set.
+    FilterSpec& with_status(Status status) noexcept {
+        statuses |= 1u << static_cast<uint32_t>(status);
+        return *this;
+    }
+
+    /// @brief Evaluate against individual field values.
+    [[nodiscard]] bool matches(Timestamp ts, Category cat, uint8_t op, Status st,
+                               uint32_t event_pid_value, uint16_t port,
+                               uint32_t correlation) const noexcept {
+        return ts >= from && ts <= to &&
+               (categories == 0 ||
+                (categories & (1u << static_cast<uint32_t>(cat))) != 0) &&
+               (statuses == 0 || (statuses & (1u << static_cast<uint32_t>(st))) != 0) &&
+               (operation < 0 || op == static_cast<uint8_t>(operation)) &&
+               (pid == 0 || event_pid_value == pid) &&
+               (remote_port == 0 || port == remote_port) &&
+               (correlation_id == 0 || correlation == correlation_id);
+    }
+
+    /// @brief Evaluate against a node (hot, row-oriented segments).
+    [[nodiscard]] bool matches(const EventNode& node) const noexcept {
+        return matches(node.timestamp, node.payload.category, node.operation,
+                       node.status, event_pid(node.payload),
+                       event_remote_port(node.payload), node.correlation_id) &&
+               (string_id == INVALID_STRING || carries_string(node.payload, string_id));
+    }
+
+    /// @brief Evaluate against a view (index-driven plans).
+    [[nodiscard]] bool matches(const EventView& view) const noexcept {
+        return matches(view.timestamp(), view.category(), view.operation(),
+                       view.status(), event_pid(view.payload()),
+                       event_remote_port(view.payload()), view.correlation_id()) &&
+               (string_id == INVALID_STRING || carries_string(view.payload(), string_id));
+    }
+};
+
+/**
+ * @brief Zone map of one sealed segment: what its events can hold.
+ *
+ * A filter whose category, status, PID or string the segment provably
+ * lacks skips it without reading a row. The Bloom filters (two bits per
+ * key) answer "maybe" or "no"; false positives only cost the scan.
+ */
+struct SegmentZone {
+    static constexpr std::size_t kPidWords = 16;      ///< 1024 bits
+    static constexpr std::size_t kStringWords = 256;  ///< 16384 bits
+
+    uint32_t categories = 0;                ///< 1u << Category of every event
+    std::atomic<uint32_t> statuses{0};      ///< 1u << Status, widened by status changes
+    std::array<uint64_t, kPidWords> pids{};        ///< Bloom filter of event_pid()
+    std::array<uint64_t, kStringWords> strings{};  ///< Bloom filter of payload StringIds
+
+    /// @brief Whether some event of the segment may match spec.
+    [[nodiscard]] bool may_match(const FilterSpec& spec) const noexcept;
+};
+
+/// @brief Add a PID to a zone map's PID Bloom filter (SegmentZone::pids).
+void zone_add_pid(std::array<uint64_t, SegmentZone::kPidWords>& bloom, uint32_t pid) noexcept;
+
+/// @brief Whether a zone map's PID Bloom filter may hold pid.
+[[nodiscard]] bool zone_may_hold_pid(const std::array<uint64_t, SegmentZone::kPidWords>& bloom,
+                                     uint32_t pid) noexcept;
+
+/**
+ * @brief Summarise a sealed segment.
+ * @param zone Destination (overwritten).
+ * @param columns Columns already filled by store_columns().
+ * @param nodes The segment's nodes, for their string fields.
+ * @param rows Number of rows.
+ */
+void store_zone(SegmentZone& zone, const SegmentColumns& columns, const EventNode* nodes,
+                std::size_t rows) noexcept;
+
+/**
+ * @brief Fill a SegmentColumns row from a node.
+ * @param columns Destination columns.
+ * @param i Row index.
+ * @param node Source node.
+ */
+void store_columns(const SegmentColumns& columns, std::size_t i,
+                   const EventNode& node) noexcept;
+
+/**
+ * @brief Evaluate a filter over sealed columns, one column at a time.
+ *
+ * Each active predicate makes one pass over its own column and clears the
+ * bits of rejected rows, so inactive fields are never read. The loops are
+ * branch-free per row and auto-vectorize. string_id has no column and is
+ * left to the caller.
+ *
+ * @param columns Sealed segment columns.
+ * @param rows Number of rows (a multiple of 64).
+ * @param spec Filter to evaluate.
+ * @param mask Output bitmask, rows / 64 words; bit i set if row i matches.
+ */
+void filter_columns(const SegmentColumns& columns, std::size_t rows,
+                    const FilterSpec& spec, std::uint64_t* mask) noexcept;
+
+/**
+ * @brief Group sealed columns into row sets.
+ * @param bitmaps Destination; arrays sized for rows (see RowGroups).
+ * @param columns Columns already filled by store_columns().
+ * @param rows Number of rows (a multiple of 64, at most RowGroups::kMaxRows).
+ */
+void store_bitmaps(SegmentBitmaps& bitmaps, const SegmentColumns& columns,
+                   std::size_t rows);
+
+/**
+ * @brief filter_columns() answering category, status and correlation
+ *        predicates from the row groups.
+ *
+ * Those predicates become unions and intersections of row sets; only the
+ * remaining ones (time, operation, pid, port) read columns, and none do
+ * when the row sets are already empty.
+ *
+ * @param bitmaps Row groups of the segment (nullptr = filter_columns()).
+ * @return false if no row matches (mask is then all zero).
+ */
+bool filter_sealed(const SegmentColumns& columns, const SegmentBitmaps* bitmaps,
+                   std::size_t rows, const FilterSpec& spec, std::uint64_t* mask) noexcept;
+
+/**
+ * @brief Evaluate a filter over row-oriented nodes.
+ *
+ * Category, status, operation, correlation and time predicates run over
+ * fixed node offsets: with EXERAY_ENABLE_AVX2 as gather-and-compare over 8
+ * nodes at a time, otherwise with a scalar loop. pid, port and string_id
+ * depend on the payload layout and refine the surviving rows one by one.
+ *
+ * @param nodes First node.
+ * @param rows Number of nodes.
+ * @param spec Filter to evaluate.
+ * @param mask Output bitmask, (rows + 63) / 64 words; bits past rows are 0.
+ */
+void filter_nodes(const EventNode* nodes, std::size_t rows, const FilterSpec& spec,
+                  std::uint64_t* mask) noexcept;
+
+/// @brief True when filter_nodes() was built with the AVX2 kernel.
+[[nodiscard]] bool filter_kernels_vectorized() noexcept;
+
+}  // namespace exeray::event
@@ -4,29 +4,88 @@
 /// @brief Event Correlation Engine for linking events into parent-child chains.
 ///
 /// Provides O(1) lookups for parent events and correlation IDs to enable
-/// attack analysis through process trees and event chains.
+/// attack analysis through process trees and event chains, and keeps the
+/// decaying risk score of every process and chain (see risk_table.hpp).
+///
+/// PIDs are reused, so process state is kept per incarnation: a PID maps to
+/// its last few lives, each with its start time, its ProcessCreate event and
+/// its correlation ID. An event resolves to the incarnation that had started
+/// at its timestamp, so a late event of a dead process still joins the right
+/// tree, and a new process never inherits the correlation ID of the dead one
+/// that held its PID. Each incarnation is also a node of the materialized
+/// ProcessTree (see process_tree()).
 
+#include <array>
 #include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <shared_mutex>
+#include <span>
 #include <unordered_map>
+#include <vector>
 
 #include "node.hpp"
+#include "process_tree.hpp"
+#include "risk_table.hpp"
 #include "types.hpp"
 
 namespace exeray::event {
 
+struct PendingEvent;
+
+/// @brief Parent event and correlation ID of one event.
+struct Correlation {
+    EventId parent = INVALID_EVENT;
+    uint32_t correlation_id = 0;
+};
+
+/// @brief One process incarnation as carried across restarts.
+struct ProcessLife {
+    uint32_t pid = 0;
+    uint32_t correlation_id = 0;
+    Timestamp start = 0;  ///< 0 = before anything seen
+    Timestamp stop = 0;   ///< 0 = running
+};
+
+/// @brief What a Correlator knows that outlives its session's events.
+///
+/// EventIds are left out: they name events of a graph that does not
+/// survive a restart, so restored processes have no create event until a
+/// ProcessRundown of the next session supplies one.
+struct CorrelatorState {
+    std::vector<ProcessLife> lives;  ///< Oldest first within each PID
+    uint32_t next_correlation = 1;
+    Timestamp risk_time = 0;              ///< Time the risk scores are decayed to
+    std::vector<RiskScore> process_risk;  ///< Keyed by PID
+    std::vector<RiskScore> chain_risk;    ///< Keyed by correlation ID
+};
+
 /// @brief Thread-safe event correlator for building event chains.
 ///
 /// Maintains mappings from process IDs to their most recent events,
 /// enabling O(1) parent lookups during ETW event processing.
 ///
 /// Thread-safety model:
-/// - All methods are thread-safe (shared_mutex for read/write)
-/// - Designed for concurrent ETW callbacks from multiple providers
+/// - All methods are thread-safe
+/// - Process state is split into kShards shards by PID, each with its own
+///   cache-line-padded shared_mutex, so consumers working on different
+///   processes do not meet on one lock; calls touching several shards
+///   lock them in ascending order
 /// - Atomic counter for correlation ID generation
 class Correlator {
 public:
+    /// Number of PID shards (power of two).
+    static constexpr std::size_t kShards = 16;
+
+    /// Incarnations remembered per PID; older ones are forgotten.
+    static constexpr std::size_t kHistory = 4;
+
+    /// PIDs per shard before terminated processes are forgotten.
+    static constexpr std::size_t kMaxPidsPerShard = 4096;
+
     Correlator() = default;
     ~Correlator() = default;
 
@@ -42,8 +101,9 @@ public:
 
     /// @brief Find parent event for a child process.
     /// @param parent_pid Parent process ID from ProcessPayload.
+    /// @param at Event time choosing the incarnation (0 = newest).
     /// @return EventId of the parent's ProcessCreate event, or INVALID_EVENT.
-    [[nodiscard]] EventId find_process_parent(uint32_t parent_pid);
+    [[nodiscard]] EventId find_process_parent(uint32_t parent_pid, Timestamp at = 0);
 
     /// @brief Find parent event for a thread (owning process).
     /// @param pid Process ID that owns the thread.
@@ -61,8 +121,8 @@ public:
 
     /// @brief Get or create a correlation ID for a process tree.
     ///
-    /// If the PID already has a correlation ID, returns it.
-    /// Otherwise, generates a new one and associates it with the PID.
+    /// If the PID's newest incarnation already has a correlation ID, returns
+    /// it. Otherwise, generates a new one and associates it with the PID.
     /// Child processes inherit their parent's correlation ID.
     ///
     /// @param pid Process ID to correlate.
@@ -70,6 +130,32 @@ public:
     /// @return Correlation ID for the process tree.
     [[nodiscard]] uint32_t get_correlation_id(uint32_t pid, uint32_t parent_pid = 0);
 
+    // -------------------------------------------------------------------------
+    // Batches
+    // -------------------------------------------------------------------------
+
+    /// @brief Parent event and correlation ID of one event in a single call.
+    ///
+    /// Same as resolve_batch() on a batch of one.
+    [[nodiscard]] Correlation resolve(const PendingEvent& event);
+
+    /// @brief Fill parent and correlation_id of a batch of events.
+    ///
+    /// Each event resolves against the incarnations of its pid and parent
+    /// pid that had started at its timestamp. Events of every category
+    /// take part: those whose payload names no process use the event
+    /// header's PID (PendingEvent::pid), and a run of events from one
+    /// process is resolved with one lookup. A ProcessCreate starts a new
+    /// incarnation of its pid (inheriting the parent's correlation ID) and
+    /// a ProcessTerminate ends one. The shards the batch touches are
+    /// locked shared once; if an event needs to change state, the rest of
+    /// the batch is resolved under one exclusive lock, in order, so that a
+    /// child inherits from a parent first seen earlier in the same batch.
+    ///
+    /// @param events Events in push order; parent and correlation_id are
+    ///               overwritten.
+    void resolve_batch(std::span<PendingEvent> events);
+
     // -------------------------------------------------------------------------
     // Event Registration
     // -------------------------------------------------------------------------
@@ -77,7 +163,9 @@ public:
     /// @brief Register an event for future parent lookups.
     ///
     /// Must be called after pushing to EventGraph to enable correlation.
-    /// For ProcessCreate events, updates the PID -> EventId mapping.
+    /// For ProcessCreate events, updates the PID -> EventId mapping. A
+    /// ProcessRundown (a process running before the session) registers with
+    /// an unknown start, so the PID's newest incarnation stays current.
     ///
     /// @param node The event node that was just pushed to the graph.
     void register_event(const EventNode& node);
@@ -85,19 +173,160 @@ public:
     /// @brief Register a process creation event explicitly.
     /// @param pid Process ID.
     /// @param event_id EventId of the ProcessCreate event.
-    void register_process(uint32_t pid, EventId event_id);
+    /// @param start Timestamp of the ProcessCreate event (0 = newest incarnation).
+    /// @param parent Parent event of the ProcessCreate (its place in process_tree()).
+    void register_process(uint32_t pid, EventId event_id, Timestamp start = 0,
+                          EventId parent = INVALID_EVENT);
+
+    /// @brief Tree of the registered processes; terminations are recorded by
+    /// resolve_batch(), event counts by the consumer through count().
+    [[nodiscard]] ProcessTree& process_tree() noexcept { return tree_; }
+    [[nodiscard]] const ProcessTree& process_tree() const noexcept { return tree_; }
+
+    // -------------------------------------------------------------------------
+    // Risk Scores
+    // -------------------------------------------------------------------------
+
+    /// @brief Count one Suspicious event for its process and chain.
+    /// @param pid event_pid() of the payload (0 = no process score).
+    /// @param correlation_id Chain of the event (0 = no chain score).
+    /// @param timestamp Event time in nanoseconds.
+    /// @param weight Score added before decay.
+    void add_risk(uint32_t pid, uint32_t correlation_id, Timestamp timestamp,
+                  double weight = 1.0);
+
+    /// @brief add_risk() for every Suspicious event of a resolved batch.
+    ///
+    /// Takes the risk lock only if the batch holds a Suspicious event.
+    void add_risk_batch(std::span<const PendingEvent> events);
+
+    /// @brief Called with a PID each time its score is raised to threshold or more.
+    using RiskHook = std::function<void(uint32_t)>;
+
+    /**
+     * @brief Watch process scores (one hook; set before events are scored).
+     *
+     * The hook runs under the risk lock and must not call back into the
+     * correlator.
+     */
+    void on_process_risk(double threshold, RiskHook hook);
+
+    /// @brief Decayed score of a process (now: 0 = newest event scored).
+    [[nodiscard]] double process_risk(uint32_t pid, Timestamp now = 0) const;
+
+    /**
+     * @brief Riskiest processes, O(K log N) at most.
+     * @param out Destination for the top out.size() processes (key = PID).
+     * @param now Time the scores are decayed to (0 = newest event scored).
+     * @return Number written, by descending score.
+     */
+    std::size_t top_processes(std::span<RiskScore> out, Timestamp now = 0) const;
+
+    /// @brief Riskiest correlation chains, as top_processes() (key = correlation ID).
+    std::size_t top_chains(std::span<RiskScore> out, Timestamp now = 0) const;
+
+    // -------------------------------------------------------------------------
+    // Checkpoints
+    // -------------------------------------------------------------------------
+
+    /// @brief Copy of the incarnations, correlation counter and risk scores.
+    [[nodiscard]] CorrelatorState state() const;
+
+    /**
+     * @brief Merge a state saved by state(), e.g. by a previous run.
+     *
+     * Each saved life is opened as if its ProcessCreate had been seen, with
+     * its correlation ID and stop time, so the events of processes started
+     * before a restart keep joining their chains; the next correlation ID
+     * continues past every restored one. The process tree is not restored.
+     */
+    void restore(const CorrelatorState& state);
 
 private:
-    mutable std::shared_mutex mutex_;
+    static_assert((kShards & (kShards - 1)) == 0 && kShards <= 32,
+                  "kShards must be a power of two that fits a 32-bit mask");
+
+    /// @brief One life of a PID.
+    struct Incarnation {
+        Timestamp start = 0;  ///< ProcessCreate time (0 = before anything seen)
+        Timestamp stop = 0;   ///< ProcessTerminate time (0 = running)
+        EventId create = INVALID_EVENT;  ///< ProcessCreate event
+        uint32_t correlation_id = 0;     ///< 0 = not assigned yet
+    };
+
+    /// @brief Lives of one PID, oldest first.
+    struct History {
+        std::array<Incarnation, kHistory> lives{};
+        std::size_t count = 0;
+    };
 
-    /// Maps PID -> EventId of most recent ProcessCreate event
-    std::unordered_map<uint32_t, EventId> process_events_;
+    /// @brief The state of the PIDs hashing to one shard.
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
 
-    /// Maps PID -> correlation_id for process tree grouping
-    std::unordered_map<uint32_t, uint32_t> pid_correlations_;
+        /// Maps PID -> its incarnations
+        std::unordered_map<uint32_t, History> processes;
+
+        /// Terminated PIDs, oldest first, forgotten when the shard is full
+        std::deque<uint32_t> retired;
+    };
+
+    template <bool Exclusive>
+    class ShardLock;
+
+    static std::size_t shard_index(uint32_t pid) noexcept {
+        return (pid >> 2) & (kShards - 1);  // PIDs are multiples of four
+    }
+
+    /// @brief Bit of the shard of pid in a lock mask (0 for pid 0).
+    static uint32_t shard_bit(uint32_t pid) noexcept {
+        return pid == 0 ? 0 : uint32_t{1} << shard_index(pid);
+    }
+
+    Shard& shard(uint32_t pid) noexcept { return shards_[shard_index(pid)]; }
+    const Shard& shard(uint32_t pid) const noexcept { return shards_[shard_index(pid)]; }
+
+    /// @brief Incarnation of pid started at time at (0 = newest), or nullptr.
+    Incarnation* find(uint32_t pid, Timestamp at) noexcept;
+    const Incarnation* find(uint32_t pid, Timestamp at) const noexcept;
+
+    /// @brief Start an incarnation of pid at start. Caller holds the shard
+    /// exclusively.
+    Incarnation& open(uint32_t pid, Timestamp start);
+
+    /// @brief Give life a correlation ID if it has none, inherited from the
+    /// incarnation of parent_pid at time at. Caller holds both shards
+    /// exclusively.
+    uint32_t assign_correlation(Incarnation& life, uint32_t parent_pid, Timestamp at);
+
+    /// @brief Resolution of the last non-process event of a batch, reused
+    /// for the next events of the same PID (pid 0 = none).
+    struct Burst {
+        uint32_t pid = 0;
+        Timestamp from = 0;  ///< Start of the incarnation, the newest one
+        EventId parent = INVALID_EVENT;
+        uint32_t correlation_id = 0;
+    };
+
+    /// @brief Resolve one event; without Write, returns false instead of
+    /// changing state. Caller holds the shards of its pids.
+    template <bool Write>
+    bool resolve_event(PendingEvent& event, Burst& burst);
+
+    std::array<Shard, kShards> shards_;
+
+    ProcessTree tree_;
 
     /// Atomic counter for generating new correlation IDs
     std::atomic<uint32_t> next_correlation_{1};
+
+    /// Guards the risk tables; separate from mutex_ so that scoring never
+    /// holds up parent lookups
+    mutable std::mutex risk_mutex_;
+    RiskTable process_risk_;
+    RiskTable chain_risk_;
+    double risk_threshold_ = 0.0;
+    RiskHook risk_hook_;
 };
 
 }  // namespace exeray::event
@@ -0,0 +1,164 @@
+#pragma once
+
+/**
+ * @file counters.hpp
+ * @brief Incremental event counters maintained by EventGraph at push time.
+ *
+ * Dashboards ask for counts per category, per status and per process on
+ * every refresh. Instead of iterating the graph, EventGraph updates these
+ * counters as events are stored and subtracts them again when ring mode
+ * recycles a segment, so a snapshot costs O(categories x statuses).
+ *
+ * Category x status cells are sharded: each pushing thread updates its own
+ * cache-line-aligned shard with relaxed atomics, and snapshot() sums the
+ * shards. Decrements may land in a different shard than the increments, so
+ * individual cells wrap; sums are taken modulo 2^64 and come out exact.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include "types.hpp"
+
+namespace exeray::event {
+
+/// Number of Status values (Status has no Count sentinel).
+inline constexpr std::size_t kStatusCount = static_cast<std::size_t>(Status::Suspicious) + 1;
+
+/// @brief Live event count of one process.
+struct PidCount {
+    uint32_t pid;
+    std::uint64_t count;
+};
+
+/// @brief Point-in-time sum of the category x status counters.
+struct CounterSnapshot {
+    static constexpr std::size_t kCategoryCount = static_cast<std::size_t>(Category::Count);
+
+    /// cells[category][status] = live events
+    std::array<std::array<std::uint64_t, kStatusCount>, kCategoryCount> cells{};
+
+    /// pushed[category] = events ever stored; never decreases, so the
+    /// difference of two snapshots is the ingest rate
+    std::array<std::uint64_t, kCategoryCount> pushed{};
+
+    /// Events ever stored as or later marked Suspicious; never decreases
+    std::uint64_t flagged = 0;
+
+    /// @brief Live events of one category and status.
+    [[nodiscard]] std::uint64_t at(Category cat, Status status) const noexcept {
+        return cells[static_cast<std::size_t>(cat)][static_cast<std::size_t>(status)];
+    }
+
+    /// @brief Live events of one category, any status.
+    [[nodiscard]] std::uint64_t category(Category cat) const noexcept;
+
+    /// @brief Live events with one status, any category.
+    [[nodiscard]] std::uint64_t status(Status st) const noexcept;
+
+    /// @brief Live events overall.
+    [[nodiscard]] std::uint64_t total() const noexcept;
+};
+
+/**
+ * @brief Sharded category x status counters plus a bounded per-pid table.
+ *
+ * Thread-safety: add(), remove() and restatus() are lock-free and may run
+ * concurrently with each other and with every reader. Readers see each cell
+ * atomically but not all cells at one instant; a snapshot taken during
+ * pushes is off by at most the events in flight.
+ */
+class EventCounters {
+public:
+    /// Number of counter shards (threads are assigned round-robin).
+    static constexpr std::size_t kShards = 16;
+
+    /// Slots in the per-pid table; further pids count as untracked.
+    static constexpr std::size_t kPidSlots = 4096;
+
+    EventCounters();
+
+    EventCounters(const EventCounters&) = delete;
+    EventCounters& operator=(const EventCounters&) = delete;
+
+    /**
+     * @brief Count one stored event.
+     * @param cat Event category.
+     * @param status Event status.
+     * @param pid event_pid() of the payload (0 = not attributed).
+     */
+    void add(Category cat, Status status, uint32_t pid) noexcept {
+        update(cat, status, pid, 1);
+    }
+
+    /**
+     * @brief Uncount one evicted event (ring mode).
+     * @param cat Event category.
+     * @param status Event status.
+     * @param pid event_pid() of the payload (0 = not attributed).
+     */
+    void remove(Category cat, Status status, uint32_t pid) noexcept {
+        update(cat, status, pid, ~std::uint64_t{0});
+    }
+
+    /**
+     * @brief Move one stored event from status from to status to.
+     * @param cat Event category.
+     * @param from Previous status.
+     * @param to New status.
+     */
+    void restatus(Category cat, Status from, Status to) noexcept;
+
+    /// @brief Sum all shards.
+    [[nodiscard]] CounterSnapshot snapshot() const noexcept;
+
+    /**
+     * @brief Live events attributed to a process.
+     * @param pid Process ID.
+     * @return Count, 0 if unknown (or untracked because the table is full).
+     */
+    [[nodiscard]] std::uint64_t pid_count(uint32_t pid) const noexcept;
+
+    /**
+     * @brief Processes with the most live events.
+     * @param out Destination for the top out.size() processes.
+     * @return Number written, sorted by descending count, ties by pid.
+     */
+    std::size_t top_pids(std::span<PidCount> out) const;
+
+    /// @brief Live attributed events whose pid did not fit in the table.
+    [[nodiscard]] std::uint64_t untracked_pids() const noexcept {
+        return untracked_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr std::size_t kCells = CounterSnapshot::kCategoryCount * kStatusCount;
+
+    /// @brief One thread group's cells, padded to whole cache lines.
+    struct alignas(64) Shard {
+        std::array<std::atomic<std::uint64_t>, kCells> cells{};
+        std::array<std::atomic<std::uint64_t>, CounterSnapshot::kCategoryCount> pushed{};
+        std::atomic<std::uint64_t> flagged{0};
+    };
+
+    /// @brief Per-pid table entry (pids are never removed once claimed).
+    struct PidSlot {
+        std::atomic<uint32_t> pid{0};
+        std::atomic<std::uint64_t> count{0};
+    };
+
+    void update(Category cat, Status status, uint32_t pid, std::uint64_t delta) noexcept;
+
+    /// @brief Find (or with create, claim) the table slot of a pid.
+    PidSlot* find_pid(uint32_t pid, bool create) const noexcept;
+
+    std::unique_ptr<Shard[]> shards_;
+    std::unique_ptr<PidSlot[]> pids_;
+    std::atomic<std::uint64_t> untracked_{0};
+};
+
+}  // namespace exeray::event
@@ -0,0 +1,104 @@
+#pragma once
+
+/**
+ * @file device_paths.hpp
+ * @brief NT device path to DOS path translation for interned paths.
+ *
+ * Kernel File and Image events name files as
+ * "\\Device\\HarddiskVolume3\\Windows\\notepad.exe". DevicePathMap keeps the
+ * volume-to-drive table ("\\Device\\HarddiskVolume3" -> "C:") so that
+ * StringPool::intern_path() can store "C:\\Windows\\notepad.exe" once, and
+ * UI rendering, rule matching and exports never translate again.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace exeray::event {
+
+/**
+ * @brief Volume map from NT device names to DOS drive prefixes.
+ *
+ * Lookups read an immutable snapshot through one atomic pointer. refresh()
+ * and set() publish a new snapshot under a mutex; old snapshots are retired,
+ * not freed, so views returned by match() stay valid for the map's lifetime.
+ *
+ * With auto refresh, a path under "\\Device\\" that no entry covers (a
+ * volume that arrived after the last refresh) triggers refresh(), at most
+ * once per kRefreshInterval.
+ *
+ * Thread-safety: all methods are safe to call concurrently.
+ */
+class DevicePathMap {
+public:
+    /// Minimum time between refreshes triggered by unknown volumes.
+    static constexpr std::chrono::milliseconds kRefreshInterval{1000};
+
+    /// @param auto_refresh Reload from the OS when an unknown volume shows up.
+    explicit DevicePathMap(bool auto_refresh = false);
+
+    DevicePathMap(const DevicePathMap&) = delete;
+    DevicePathMap& operator=(const DevicePathMap&) = delete;
+
+    /**
+     * @brief Reload the drive letters from the OS (QueryDosDeviceW).
+     *
+     * Entries added with set() are kept. No-op off Windows.
+     */
+    void refresh();
+
+    /**
+     * @brief Add or replace one mapping.
+     * @param device NT device name, e.g. "\\Device\\HarddiskVolume3".
+     * @param dos Replacement prefix, e.g. "C:".
+     */
+    void set(std::string_view device, std::string_view dos);
+
+    /**
+     * @brief Find the mapping that covers a path.
+     *
+     * A device matches only up to a separator or the end of the path, so
+     * "\\Device\\HarddiskVolume1" does not match "\\Device\\HarddiskVolume10".
+     * Device names compare ASCII case-insensitively.
+     *
+     * @param path Path to translate.
+     * @param dos Set to the replacement prefix on a match.
+     * @return Length of the matched device prefix, 0 if none.
+     */
+    std::size_t match(std::string_view path, std::string_view& dos);
+
+    /// @brief Number of mappings.
+    [[nodiscard]] std::size_t size() const noexcept;
+
+private:
+    struct Entry {
+        std::string device;
+        std::string dos;
+        bool from_os = false;  ///< Replaced by refresh()
+
+        bool operator==(const Entry&) const = default;
+    };
+    using Snapshot = std::vector<Entry>;
+
+    /// @brief Publish entries as the current snapshot unless unchanged
+    /// (mutex_ held).
+    void publish(Snapshot entries);
+
+    /// @brief refresh() for an unknown volume, rate-limited.
+    void refresh_on_miss();
+
+    std::atomic<const Snapshot*> current_{nullptr};
+    std::vector<std::unique_ptr<Snapshot>> snapshots_;  ///< Every generation (mutex_)
+    std::mutex mutex_;
+    bool auto_refresh_;
+    std::atomic<std::int64_t> last_refresh_{0};  ///< steady_clock ticks
+};
+
+}  // namespace exeray::event
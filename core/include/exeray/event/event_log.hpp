@@ -0,0 +1,265 @@
+#pragma once
+
+/**
+ * @file event_log.hpp
+ * @brief Append-only binary log of an EventGraph, and replay from it.
+ *
+ * The graph and its strings live only in the arena. EventLogWriter appends
+ * published nodes to a file from a background thread, so a capture can be
+ * reloaded after exit. Each flush is built in memory and appended in large
+ * sequential writes: a block of the strings that are new since the last
+ * flush, then the events in blocks of at most a segment, in the nodes'
+ * native layout. replay_event_log() pushes them into another graph and pool.
+ *
+ * Layout (native byte order): a 64-byte header {magic, format, node size,
+ * segment size, reserved}, then blocks. Each block has a 64-byte header
+ * {kind, count, payload bytes, FNV-1a of the payload, reserved}. A strings
+ * block holds per entry the StringId (u32), kLogPathString | length (u32)
+ * and that many bytes, padded to 8; the payload is padded to 64. An events
+ * block holds count EventNodes. Every block therefore starts 64-byte
+ * aligned, so a mapped log can be read in place (see MappedEventLog).
+ * Every StringId in an event refers to an entry of an earlier strings
+ * block. Extension records are not logged, so EventPayload::extension of
+ * a logged node means nothing; replay clears it. A crash can leave a
+ * partial last block; it is ignored on replay.
+ *
+ * With set_compression(), the writer stores packed blocks instead: the
+ * same payload run through pack_bytes() (strings) or pack_events()
+ * (events, see log_codec.hpp), padded to 64, with the unpacked size in
+ * the block header after the checksum. Each block is packed on its own,
+ * on a ThreadPool if one is given, and stays readable on its own.
+ *
+ * Usage example:
+ * @code
+ * EventLogWriter log(graph, strings);
+ * if (log.open("capture.exrl")) {
+ *     log.start(std::chrono::milliseconds(250));
+ * }
+ * ...
+ * log.stop();  // Writes what is left
+ *
+ * EventGraph copy(arena, pool, capacity);
+ * auto replay = read_event_log("capture.exrl", copy, pool);
+ * @endcode
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "graph.hpp"
+
+namespace exeray {
+class ThreadPool;
+}  // namespace exeray
+
+namespace exeray::event {
+
+/// @brief "EXRL" in the first four bytes of an event log.
+inline constexpr std::uint32_t kEventLogMagic = 0x4C525845;
+
+/// @brief Bumped whenever the layout changes.
+inline constexpr std::uint32_t kEventLogFormat = 3;
+
+/// @brief Bytes of the file header and of every block header.
+inline constexpr std::size_t kLogHeaderSize = 64;
+
+/// @brief Kind of a log block.
+enum class LogBlock : std::uint32_t {
+    Strings = 1,        ///< New strings, by the writer's StringId
+    Events = 2,         ///< EventNodes, oldest first
+    PackedStrings = 3,  ///< A Strings payload, compressed
+    PackedEvents = 4    ///< An Events payload, compressed
+};
+
+/// @brief Set in a string entry's length word: replay with intern_path().
+inline constexpr std::uint32_t kLogPathString = 0x80000000U;
+
+/// @brief Largest string accepted from a log.
+inline constexpr std::uint32_t kMaxLogString = 1U << 24;
+
+/**
+ * @brief Background writer appending a graph's events to a log file.
+ *
+ * Events are written once they are published; a later set_status() is not
+ * recorded. In ring mode, events evicted before a flush reached them are
+ * skipped and counted by lost().
+ *
+ * Thread-safety: open()/start()/stop() from one thread; flush() and the
+ * counters from any.
+ */
+class EventLogWriter {
+public:
+    /// @param graph Graph to log; must outlive the writer.
+    /// @param strings Pool the graph's StringIds belong to.
+    EventLogWriter(const EventGraph& graph, const StringPool& strings) noexcept;
+    ~EventLogWriter();
+
+    EventLogWriter(const EventLogWriter&) = delete;
+    EventLogWriter& operator=(const EventLogWriter&) = delete;
+
+    /**
+     * @brief Create or replace the log file and write its header.
+     *
+     * Logging starts at the oldest live event.
+     * @return false if the file could not be written.
+     */
+    bool open(const std::filesystem::path& path);
+
+    /**
+     * @brief Write packed blocks from the next flush on.
+     *
+     * A capture then takes several times less disk, for CPU time on the
+     * flushing thread, or on pool's workers if given.
+     * @param pool Packs the blocks of a flush in parallel; must outlive
+     *        the writer (nullptr = pack on the flushing thread).
+     */
+    void set_compression(bool enabled, ThreadPool* pool = nullptr);
+
+    /// @brief Flush every interval on a background thread until stop().
+    void start(std::chrono::milliseconds interval);
+
+    /// @brief Stop the thread, flush what is left and close the file.
+    void stop();
+
+    /**
+     * @brief Append the events published since the last flush.
+     * @return Events written (0 if closed or the write failed).
+     */
+    std::size_t flush();
+
+    /// @brief Events written so far.
+    [[nodiscard]] std::uint64_t events_written() const noexcept {
+        return events_written_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief File bytes written so far, header included.
+    [[nodiscard]] std::uint64_t bytes_written() const noexcept {
+        return bytes_written_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Events evicted from a ring before they could be written.
+    [[nodiscard]] std::uint64_t lost() const noexcept {
+        return lost_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief true once a write failed; nothing more is written.
+    [[nodiscard]] bool failed() const noexcept {
+        return failed_.load(std::memory_order_relaxed);
+    }
+
+private:
+    /// @brief Queue an events block for the span's nodes and a strings
+    /// entry for each StringId they hold that is not written yet.
+    /// @return false (nothing queued) if the ring recycled the span meanwhile.
+    bool encode_span(const EventGraph::SegmentSpan& span);
+
+    /// @brief Append the queued blocks to the file and clear them.
+    bool write_queued();
+
+    /// @brief Pack the queued blocks, events blocks in parallel on pool_.
+    [[nodiscard]] std::vector<std::uint8_t> pack_queued();
+
+    /// @brief Add a string entry unless id was already written.
+    void note_string(StringId id);
+
+    void run(std::chrono::milliseconds interval);
+
+    const EventGraph& graph_;
+    const StringPool& strings_;
+
+    std::mutex flush_mutex_;
+    std::ofstream file_;                     ///< Guarded by flush_mutex_
+    std::size_t next_ = 0;                   ///< Index of the next event to write
+    std::unordered_set<StringId> written_;   ///< StringIds already in the file
+    std::vector<std::uint8_t> strings_out_;  ///< Strings block payload of a flush
+    std::vector<std::uint8_t> events_out_;   ///< Events blocks of a flush
+    std::uint32_t string_count_ = 0;         ///< Entries in strings_out_
+    bool compress_ = false;                  ///< Guarded by flush_mutex_
+    ThreadPool* pool_ = nullptr;             ///< Guarded by flush_mutex_
+
+    std::thread thread_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;  ///< Guarded by wake_mutex_
+
+    std::atomic<std::uint64_t> events_written_{0};
+    std::atomic<std::uint64_t> bytes_written_{0};
+    std::atomic<std::uint64_t> lost_{0};
+    std::atomic<bool> failed_{false};
+};
+
+/// @brief FNV-1a of a block payload as stored (packed, if packed).
+[[nodiscard]] std::uint64_t log_checksum(std::span<const std::uint8_t> payload) noexcept;
+
+/// @brief One entry of a strings block.
+struct LogString {
+    StringId id = INVALID_STRING;  ///< As the events of the log refer to it
+    std::string_view text;
+    bool path = false;  ///< Replayed with intern_path()
+};
+
+/// @brief Append the file header every event log starts with.
+void encode_log_header(std::vector<std::uint8_t>& out);
+
+/// @brief Append a strings block of entries (nothing if empty).
+/// @param compress Write a packed block (see set_compression()).
+void encode_strings_block(std::span<const LogString> entries, bool compress,
+                          std::vector<std::uint8_t>& out);
+
+/// @brief Append an events block of at most a segment of nodes (nothing if empty).
+/// @param compress Write a packed block (see set_compression()).
+void encode_events_block(std::span<const EventNode> nodes, bool compress,
+                         std::vector<std::uint8_t>& out);
+
+/**
+ * @brief Append nodes as a complete log: the file header, a strings block
+ * with every string they refer to, then their events blocks.
+ *
+ * Unlike a file written by EventLogWriter, the result stands on its own,
+ * so it can be shipped and replayed with replay_event_log() by itself.
+ *
+ * @param compress Write packed blocks (see set_compression()).
+ */
+void encode_event_log(std::span<const EventNode> nodes, const StringPool& strings,
+                      bool compress, std::vector<std::uint8_t>& out);
+
+/// @brief What replay_event_log() restored.
+struct LogReplay {
+    std::size_t events = 0;   ///< Events pushed into the graph
+    std::size_t strings = 0;  ///< String entries interned
+    bool complete = true;     ///< false if a partial or corrupt block, or a
+                              ///< full graph, stopped the replay early
+};
+
+/**
+ * @brief Push the events of a log into a graph.
+ *
+ * Strings are interned into strings and every StringId is rewritten to the
+ * new one. Into an empty graph, a log that starts at the first event and
+ * lost nothing rebuilds the same event IDs, parents, timestamps, statuses
+ * and payloads. Otherwise IDs are renumbered in order and parents that are
+ * not in the log become INVALID_EVENT.
+ *
+ * @param strings Pool of graph (the one passed to its constructor).
+ * @return nullopt if bytes is not an event log of this format and layout.
+ */
+[[nodiscard]] std::optional<LogReplay> replay_event_log(std::span<const std::uint8_t> bytes,
+                                                        EventGraph& graph, StringPool& strings);
+
+/// @brief replay_event_log() of a file; nullopt if missing or unusable.
+[[nodiscard]] std::optional<LogReplay> read_event_log(const std::filesystem::path& path,
+                                                      EventGraph& graph, StringPool& strings);
+
+}  // namespace exeray::event
@@ -0,0 +1,177 @@
+#pragma once
+
+/**
+ * @file extensions.hpp
+ * @brief Variable-length side records for events that outgrow the payload.
+ *
+ * EventPayload is fixed at 32 bytes so that a node stays one cache line.
+ * The rare event that carries more, such as the binary IPv6 tuple of a
+ * connection, stores the rest as an extension record and keeps only its
+ * ExtensionId in EventPayload::extension. Hot scans never touch the
+ * records; a reader pays for one only when it asks for it.
+ *
+ * Records are appended to arena memory as [size:u32][kind:u16][0:u16]
+ * followed by the bytes, 4-byte aligned. Like a StringId, an ExtensionId is
+ * the record's offset from the arena base + 1, so lookups need no table.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#include "../arena.hpp"
+#include "types.hpp"
+
+namespace exeray::event {
+
+/// @brief What an extension record holds.
+enum class ExtensionKind : std::uint16_t {
+    None = 0,
+    Ipv6Tuple,       ///< Ipv6TupleExtension
+    ImageVerdict,    ///< ImageVerdictExtension
+    Stack,           ///< Return addresses, innermost first (see StackTable)
+    ContentVerdict,  ///< ContentVerdictExtension
+    MemoryCapture,   ///< MemoryCaptureExtension
+    ManifestValues,  ///< ManifestValuesExtension
+};
+
+/// @brief Binary addresses of an IPv6 network event (the payload keeps
+/// their text as StringIds).
+struct Ipv6TupleExtension {
+    std::uint8_t local_addr[16];
+    std::uint8_t remote_addr[16];
+};
+
+/// @brief Authenticode outcome of a loaded image.
+enum class ImageSignature : std::uint8_t {
+    Unchecked = 0,  ///< Not verified (disabled, or not on Windows)
+    Signed,         ///< Valid embedded or catalog signature
+    Unsigned,       ///< No signature found
+    Untrusted,      ///< Signature present but invalid or not trusted
+    Unreadable,     ///< File could not be opened or was too large to hash
+};
+
+/// @brief Hash and signature verdict of an image file, shared by every load
+/// of it (see etw::ImageVerifier).
+struct ImageVerdictExtension {
+    std::uint8_t sha256[32];   ///< All zero if the file was unreadable
+    ImageSignature signature;
+    std::uint8_t _pad[3];
+};
+
+/// @brief Signatures an AMSI or script content matched, shared by every
+/// event of it (see etw::ContentScanner).
+struct ContentVerdictExtension {
+    std::uint64_t hash;        ///< content_hash() of the content
+    std::uint32_t matches;     ///< Signatures matched (0 = clean)
+    std::uint32_t first;       ///< Index of the first one matched (UINT32_MAX = none)
+    std::uint64_t signatures;  ///< Bit i: signature i matched (the first 64 only)
+};
+
+/// @brief Bytes read from the RWX region a thread started in, shared by
+/// every thread start in it (see etw::MemoryCapture).
+struct MemoryCaptureExtension {
+    std::uint8_t sha256[32];  ///< Of the bytes read; all zero if unreadable
+    std::uint64_t base;       ///< Region base address
+    std::uint64_t size;       ///< Bytes read (0 = unreadable)
+};
+
+/// @brief Integers a manifest provider's registration projects beyond
+/// ManifestPayload::value (etw::ManifestSlot::Extra0 to Extra3; 0 = none).
+struct ManifestValuesExtension {
+    std::uint64_t values[4];
+};
+
+/// @brief One record read back from an ExtensionStore.
+struct Extension {
+    ExtensionKind kind = ExtensionKind::None;
+    std::span<const std::uint8_t> bytes;
+
+    /// @brief The record as T if it has exactly T's size, else false.
+    template <typename T>
+    bool read(T& out) const noexcept {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (bytes.size() != sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&out, bytes.data(), sizeof(T));
+        return true;
+    }
+};
+
+/**
+ * @brief Extension of a parsed event, stored only once the event is kept.
+ *
+ * Parsers fill it from the record; the consumer appends it to the store
+ * after load shedding, like the deferred strings.
+ */
+struct PendingExtension {
+    static constexpr std::size_t kMaxBytes = 32;  ///< Largest value set() takes
+
+    ExtensionKind kind = ExtensionKind::None;
+    std::uint8_t size = 0;
+    std::array<std::uint8_t, kMaxBytes> bytes{};
+
+    template <typename T>
+    void set(ExtensionKind record_kind, const T& value) noexcept {
+        static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= kMaxBytes);
+        kind = record_kind;
+        size = static_cast<std::uint8_t>(sizeof(T));
+        std::memcpy(bytes.data(), &value, sizeof(T));
+    }
+
+    [[nodiscard]] std::span<const std::uint8_t> view() const noexcept {
+        return {bytes.data(), size};
+    }
+};
+
+/**
+ * @brief Append-only, arena-backed store of extension records.
+ *
+ * Thread-safety: append() and get() may run concurrently; a record is
+ * complete before its ID is returned. Records are never freed, like the
+ * strings of a StringPool sharing the same arena.
+ */
+class ExtensionStore {
+public:
+    /// Largest record append() accepts.
+    static constexpr std::size_t kMaxBytes = 4096;
+
+    explicit ExtensionStore(Arena& arena) : arena_(arena) {}
+
+    ExtensionStore(const ExtensionStore&) = delete;
+    ExtensionStore& operator=(const ExtensionStore&) = delete;
+
+    /// @brief Store a record.
+    /// @return Its ID, or NO_EXTENSION if it is empty, too large or the
+    ///         arena is full.
+    ExtensionId append(ExtensionKind kind, std::span<const std::uint8_t> bytes);
+
+    /// @brief Store a trivially copyable value as a record.
+    template <typename T>
+    ExtensionId append(ExtensionKind kind, const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return append(kind, std::span(reinterpret_cast<const std::uint8_t*>(&value),
+                                      sizeof(T)));
+    }
+
+    /// @brief Record of an ID returned by append() (kind None for NO_EXTENSION).
+    [[nodiscard]] Extension get(ExtensionId id) const noexcept;
+
+    /// @brief Records stored so far.
+    [[nodiscard]] std::size_t count() const noexcept {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr std::size_t kHeaderSize = 8;
+
+    Arena& arena_;
+    std::atomic<std::size_t> count_{0};
+};
+
+}  // namespace exeray::event
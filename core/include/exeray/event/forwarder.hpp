@@ -0,0 +1,210 @@
+#pragma once
+
+/**
+ * @file forwarder.hpp
+ * @brief Background shipping of an EventGraph's events to a remote collector.
+ *
+ * EventForwarder tails the graph like EventLogWriter does: a thread wakes
+ * every interval and copies the segments published since its last pass,
+ * reading the graph lock-free, so the ETW thread never waits on it. The
+ * copied events are cut into batches, each encoded as a complete event log
+ * (encode_event_log(), packed by default) that the collector replays on
+ * its own with replay_event_log().
+ *
+ * A second thread sends the batches over TCP or a pipe, oldest first, and
+ * reconnects with exponential backoff when the connection fails. A batch
+ * whose send failed is sent again after reconnecting; the collector may
+ * then see it twice if the failure came after the bytes left. While the
+ * collector is unreachable or slow, batches queue up to max_buffered_bytes;
+ * past that the oldest queued batches are dropped and counted, so the
+ * forwarder never falls behind the graph by more than its buffer.
+ *
+ * Wire format: per batch a 16-byte frame header {kForwardFrameMagic (u32),
+ * kEventLogFormat (u32), length (u64)}, native byte order, then length
+ * bytes of event log.
+ *
+ * Usage example:
+ * @code
+ * ForwarderConfig config;
+ * config.host = "collector.corp";
+ * config.port = 9140;
+ * EventForwarder forwarder(graph, strings, config);
+ * forwarder.start();
+ * ...
+ * forwarder.stop();  // Sends what is left, while the collector is reachable
+ * @endcode
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "exeray/platform/connection.hpp"
+#include "graph.hpp"
+
+namespace exeray::event {
+
+/// @brief "EXRF" at the start of every forwarded frame.
+inline constexpr std::uint32_t kForwardFrameMagic = 0x46525845;
+
+/// @brief Bytes of a frame header.
+inline constexpr std::size_t kForwardFrameHeaderSize = 16;
+
+/// @brief Where and how EventForwarder ships events.
+struct ForwarderConfig {
+    enum class Transport : std::uint8_t {
+        Tcp,  ///< host:port
+        Pipe  ///< pipe: a Windows named pipe, or a Unix domain socket path
+    };
+
+    Transport transport = Transport::Tcp;
+    std::string host = "127.0.0.1";
+    std::uint16_t port = 0;
+    std::string pipe;
+
+    std::chrono::milliseconds interval{250};                 ///< Between tailing passes
+    std::size_t batch_events = 16384;                        ///< Most events per batch
+    std::size_t max_buffered_bytes = std::size_t{64} << 20;  ///< Bytes of queued batches
+    bool compress = true;                                    ///< Packed log blocks
+    std::chrono::milliseconds reconnect_min{100};            ///< First retry delay
+    std::chrono::milliseconds reconnect_max{10000};          ///< Backoff ceiling
+    std::chrono::milliseconds send_timeout{5000};            ///< A stalled send fails
+};
+
+/**
+ * @brief Forwarder of a graph's published events to a collector.
+ *
+ * Like EventLogWriter, events are forwarded once published; a later
+ * set_status() is not. Events evicted from a ring before a pass reached
+ * them are counted by lost().
+ *
+ * Thread-safety: start()/stop() from one thread; poll() and the counters
+ * from any.
+ */
+class EventForwarder {
+public:
+    /// @param graph Graph to forward; must outlive the forwarder.
+    /// @param strings Pool the graph's StringIds belong to.
+    EventForwarder(const EventGraph& graph, const StringPool& strings,
+                   ForwarderConfig config);
+    ~EventForwarder();
+
+    EventForwarder(const EventForwarder&) = delete;
+    EventForwarder& operator=(const EventForwarder&) = delete;
+
+    /// @brief Start tailing and sending. Forwarding starts at the oldest
+    /// live event.
+    void start();
+
+    /**
+     * @brief Stop tailing, queue what is left and send the queue.
+     *
+     * Sending stops at the first failure; the batches still queued are
+     * dropped and counted.
+     */
+    void stop();
+
+    /**
+     * @brief Queue batches of the events published since the last pass.
+     * @return Events queued.
+     */
+    std::size_t poll();
+
+    /// @brief Batches the collector received.
+    [[nodiscard]] std::uint64_t batches_sent() const noexcept {
+        return batches_sent_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Events of the batches the collector received.
+    [[nodiscard]] std::uint64_t events_sent() const noexcept {
+        return events_sent_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Bytes sent, frame headers included.
+    [[nodiscard]] std::uint64_t bytes_sent() const noexcept {
+        return bytes_sent_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Batches dropped because the buffer was full or at stop().
+    [[nodiscard]] std::uint64_t batches_dropped() const noexcept {
+        return batches_dropped_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Events of the dropped batches.
+    [[nodiscard]] std::uint64_t events_dropped() const noexcept {
+        return events_dropped_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Events evicted from a ring before they could be copied.
+    [[nodiscard]] std::uint64_t lost() const noexcept {
+        return lost_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Connections made after the first.
+    [[nodiscard]] std::uint64_t reconnects() const noexcept {
+        return reconnects_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Bytes of the batches waiting to be sent.
+    [[nodiscard]] std::size_t buffered_bytes() const;
+
+private:
+    /// @brief An encoded batch: frame header and event log.
+    struct Batch {
+        std::vector<std::uint8_t> bytes;
+        std::size_t events = 0;
+    };
+
+    /// @brief Encode copied events as a batch and queue it.
+    void queue_batch(std::span<const EventNode> nodes);
+
+    /// @brief Drop the oldest batches until bytes more fit.
+    void make_room(std::size_t bytes);
+
+    void drop(const Batch& batch);
+
+    /// @brief Connect unless connected; counts reconnects.
+    bool connect();
+
+    void run_tail();
+    void run_send();
+
+    const EventGraph& graph_;
+    const StringPool& strings_;
+    const ForwarderConfig config_;
+
+    std::mutex poll_mutex_;
+    std::size_t next_ = 0;            ///< Guarded by poll_mutex_
+    std::vector<EventNode> pending_;  ///< Copies of a pass; guarded by poll_mutex_
+
+    mutable std::mutex queue_mutex_;
+    std::condition_variable queue_ready_;
+    std::deque<Batch> queue_;   ///< Guarded by queue_mutex_
+    std::size_t buffered_ = 0;  ///< Bytes queued or being sent; guarded by queue_mutex_
+    bool stopping_ = false;     ///< Tailing ends; guarded by queue_mutex_
+    bool draining_ = false;     ///< Send the rest, then exit; guarded by queue_mutex_
+
+    platform::Connection connection_;  ///< Used by the sending thread only
+    bool connected_once_ = false;      ///< Used by the sending thread only
+
+    std::thread tail_thread_;
+    std::thread send_thread_;
+
+    std::atomic<std::uint64_t> batches_sent_{0};
+    std::atomic<std::uint64_t> events_sent_{0};
+    std::atomic<std::uint64_t> bytes_sent_{0};
+    std::atomic<std::uint64_t> batches_dropped_{0};
+    std::atomic<std::uint64_t> events_dropped_{0};
+    std::atomic<std::uint64_t> lost_{0};
+    std::atomic<std::uint64_t> reconnects_{0};
+};
+
+}  // namespace exeray::event
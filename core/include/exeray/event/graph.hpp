@@ -4,34 +4,159 @@
  * @file graph.hpp
  * @brief Thread-safe Event Graph container for event storage and traversal.
  *
- * Provides a contiguous, arena-allocated storage for events with support for
+ * Provides segmented, arena-allocated storage for events with support for
  * concurrent push operations and thread-safe iteration.
  */
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <bit>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <mutex>
-#include <shared_mutex>
-#include <unordered_map>
+#include <span>
 #include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "../arena.hpp"
+#include "../thread_pool.hpp"
+#include "alert_queue.hpp"
+#include "columns.hpp"
+#include "counters.hpp"
 #include "node.hpp"
+#include "retained_events.hpp"
+#include "sketches.hpp"
+#include "string_index.hpp"
 #include "string_pool.hpp"
+#include "timeline.hpp"
 
 namespace exeray::event {
 
+/**
+ * @brief Storage retention policy for EventGraph.
+ */
+enum class Retention : std::uint8_t {
+    Append,  ///< Append-only; push fails once capacity is reached
+    Ring     ///< Recycle the oldest segment once capacity is reached
+};
+
+/**
+ * @brief In-memory compression of cold segments (EventGraph::set_compression()).
+ */
+struct CompressionConfig {
+    bool enabled = false;
+
+    /// Newest full segments kept as plain nodes
+    std::size_t hot_segments = 4;
+
+    /// Decoded cold segments kept for reads; the least recently used one
+    /// is dropped for the next (kSegmentSize nodes each)
+    std::size_t cache_segments = 8;
+};
+
+/// @brief Compressed storage and decode cost (EventGraph::compression_stats()).
+struct CompressionStats {
+    std::size_t segments = 0;        ///< Segments held compressed
+    std::uint64_t raw_bytes = 0;     ///< Node bytes of those segments
+    std::uint64_t packed_bytes = 0;  ///< Their compressed size
+    std::uint64_t decodes = 0;       ///< Cold segments decoded on access
+    std::uint64_t decode_ns = 0;     ///< Time spent decoding
+    std::uint64_t cache_hits = 0;    ///< Cold reads served by a decoded copy
+    std::uint64_t repacks = 0;       ///< Copies compressed again after a late update
+
+    /// @brief raw_bytes per packed byte (0 while nothing is compressed).
+    [[nodiscard]] double ratio() const noexcept {
+        return packed_bytes != 0
+                   ? static_cast<double>(raw_bytes) / static_cast<double>(packed_bytes)
+                   : 0.0;
+    }
+};
+
+/**
+ * @brief One event queued for EventGraph::push_batch().
+ */
+struct PendingEvent {
+    Category category;           ///< Event category
+    std::uint8_t operation;      ///< Category-specific operation code
+    Status status;               ///< Operation result status
+    EventId parent;              ///< Parent event ID (INVALID_EVENT for roots)
+    uint32_t correlation_id;     ///< Correlation ID (0 = none)
+    EventPayload payload;        ///< Category-specific payload data
+    Timestamp timestamp;         ///< Event time in steady_clock nanoseconds
+    uint32_t pid = 0;            ///< Source process from the event header (0 = unknown)
+    EventTags tags = 0;          ///< Detection tags set when pushed (see add_tags())
+};
+
 /**
  * @brief Thread-safe container for event nodes.
  *
- * Events are stored in a contiguous, arena-allocated array for cache-friendly
- * access. Supports concurrent push operations using atomic counters and
- * provides thread-safe iteration using a shared mutex.
+ * Events are stored in fixed-size segments of cache-aligned nodes that are
+ * allocated from the arena on demand. A segment directory maps an event index
+ * to its segment in O(1), so the graph grows without relocating existing
+ * nodes and EventView pointers stay valid for the lifetime of the graph
+ * (unless set_compression() or set_spill() is on, see there).
+ * Supports concurrent push operations using atomic counters and lock-free
+ * iteration over published slots.
+ *
+ * In Retention::Ring mode the directory is a ring: once capacity is reached
+ * the oldest segment is recycled for new events. IDs keep increasing, the
+ * evicted range is reported through oldest_id(), and epoch() is bumped on
+ * every eviction so holders of an EventId or EventView can tell that their
+ * event may be gone and re-check exists().
+ *
+ * Parent and correlation lookups use intrusive links stored in a side array
+ * beside each segment: every node records its next older sibling and next
+ * older event with the same correlation ID. Child chains start at the
+ * parent's own link slot; correlation chains start in a lock-free,
+ * open-addressed head table. Both are updated with a CAS and walked without
+ * any lock.
+ *
+ * Each category also keeps an append-only index of its event indexes, stored
+ * in segments like the nodes themselves, so category iteration only touches
+ * matching events and category_count() is O(1). Category x status and
+ * per-process totals are kept in sharded EventCounters (see counters()).
+ *
+ * Every segment also records the minimum and maximum timestamp pushed into
+ * it. Push order is nearly monotonic in time, so this sparse time index lets
+ * for_each_in_range() binary search to the first relevant segment.
+ *
+ * With set_columnar(true), every segment whose slots are all published is
+ * sealed into a columnar copy (see SegmentColumns). for_each_where() and
+ * scan() then filter sealed segments column by column and run the node
+ * kernel over the hot tail, so callers never see which layout answered.
+ *
+ * With set_compression(), full segments older than a hot window are packed
+ * in RAM (see pack_events()) and their node storage is reused by new
+ * segments. Reads decode a cold segment into a small LRU of decoded
+ * copies, so every query and EventView works on cold events unchanged.
+ * set_spill() instead moves cold segments into another arena, typically
+ * file-backed, so the OS pages them out and the graph can outgrow RAM.
+ *
+ * An EventId is its reserved slot index + 1, claimed with a single atomic
+ * add. Writers mark their slot when the node is complete and advance a
+ * published watermark over every contiguous completed slot; count() and
+ * iteration stop at that watermark, so readers never reach a slot that is
+ * still being filled. The publish flag doubles as a sequence check in ring
+ * mode: a recycled slot no longer carries its old index, so readers skip it
+ * without taking a lock and eviction never waits for readers.
  *
  * Thread-safety model:
- * - push(): Lock-free using atomic operations
- * - get()/exists(): Lock-free reads
- * - for_each*(): Acquires shared lock for consistent iteration
+ * - push(): Lock-free using atomic operations (a short mutex is taken only
+ *   when a new segment has to be allocated, once per kSegmentSize events)
+ * - get()/exists(): Lock-free reads through the segment directory
+ * - for_each_child()/for_each_correlation()/for_each_process(): Lock-free
+ *   chain traversal
+ * - for_each()/for_each_category()/for_each_in_range(): Lock-free; they
+ *   visit published slots only. In ring mode a view handed to a callback
+ *   is valid until its segment is recycled (epoch() changes), as for get().
+ *
+ * Every for_each*() visitor may return bool instead of void; returning false
+ * stops the iteration, so bounded queries do not pay for a full walk.
  *
  * Usage example:
  * @code
@@ -52,14 +177,42 @@ namespace exeray::event {
  */
 class EventGraph {
 public:
+    /// log2 of the number of nodes per storage segment.
+    static constexpr std::size_t kSegmentShift = 12;
+
+    /// Number of nodes per storage segment (4096 nodes = 256 KiB).
+    static constexpr std::size_t kSegmentSize = std::size_t{1} << kSegmentShift;
+
+#if defined(EXERAY_COMPACT_INDEX)
+    /// Index links, chain heads and category entries hold 32-bit node
+    /// indexes (CMake option EXERAY_COMPACT_INDEX).
+    static constexpr bool kCompactIndex = true;
+#else
+    static constexpr bool kCompactIndex = false;
+#endif
+
+    /// Most events a graph ever reserves: 2^32 - 1 with compact indexes
+    /// (later pushes are rejected as if the graph were full, ring mode
+    /// included), else unbounded. Event IDs stay 64-bit either way.
+    static constexpr std::size_t kMaxEvents =
+        kCompactIndex ? std::size_t{0xFFFFFFFF} : ~std::size_t{0};
+
     /**
      * @brief Construct an event graph with specified capacity.
+     *
+     * No node storage is allocated up front; segments are carved from the
+     * arena as events arrive, so capacity only bounds the directory size.
+     * In ring mode capacity is rounded up to at least two whole segments so
+     * that evicting one segment never empties the graph.
+     *
      * @param arena Arena for memory allocation.
      * @param strings String pool for string resolution.
      * @param capacity Maximum number of events (default: 65536).
+     * @param retention Behaviour once capacity is reached.
      */
     explicit EventGraph(Arena& arena, StringPool& strings,
-                        std::size_t capacity = 65536);
+                        std::size_t capacity = 65536,
+                        Retention retention = Retention::Append);
 
     // Non-copyable, non-movable
     EventGraph(const EventGraph&) = delete;
@@ -67,6 +220,8 @@ public:
     EventGraph(EventGraph&&) = delete;
     EventGraph& operator=(EventGraph&&) = delete;
 
+    ~EventGraph();
+
     // -------------------------------------------------------------------------
     // Event Operations
     // -------------------------------------------------------------------------
@@ -79,14 +234,83 @@ public:
      * @param parent Parent event ID (INVALID_EVENT for root events).
      * @param correlation_id Correlation ID for grouping related events.
      * @param payload Category-specific payload data.
-     * @return Unique event ID, or INVALID_EVENT if capacity exceeded.
+     * @return Unique event ID, or INVALID_EVENT if capacity exceeded (append
+     *         mode) or the arena cannot supply another segment.
      */
     EventId push(Category cat, std::uint8_t op, Status status,
                  EventId parent, uint32_t correlation_id,
                  const EventPayload& payload);
 
+    /**
+     * @brief Add an event with a caller-supplied timestamp (thread-safe).
+     *
+     * Used by producers that already know when the event happened, such as
+     * the ETW consumer, so push order does not have to match event time.
+     *
+     * @param timestamp Event time in steady_clock nanoseconds.
+     * @return Same as push() without a timestamp.
+     */
+    EventId push(Category cat, std::uint8_t op, Status status,
+                 EventId parent, uint32_t correlation_id,
+                 const EventPayload& payload, Timestamp timestamp);
+
+    /// @brief A claimed node that readers cannot see until commit().
+    struct Reservation {
+        EventNode* node = nullptr;  ///< Fill timestamp, status, operation and payload
+        std::size_t index = 0;      ///< Slot index (EventId - 1)
+
+        [[nodiscard]] explicit operator bool() const noexcept { return node != nullptr; }
+    };
+
+    /**
+     * @brief Claim the next slot to write an event in place (thread-safe).
+     *
+     * The caller fills the node's timestamp, status, operation and payload
+     * directly, then publishes it with commit(); no PendingEvent is built
+     * and copied. The slot holds back the published watermark until it is
+     * committed, and it cannot be given back once later slots are claimed
+     * (readers of segment_span() would see the hole), so decide whether an
+     * event is kept before reserving and commit right after filling it.
+     *
+     * @return Empty reservation when push() would return INVALID_EVENT.
+     */
+    [[nodiscard]] Reservation reserve();
+
+    /**
+     * @brief Link, index and publish a node filled after reserve() (thread-safe).
+     * @param slot Non-empty reservation, committed once.
+     * @param parent Parent event ID (INVALID_EVENT for root events).
+     * @param correlation_id Correlation ID for grouping related events.
+     * @param pid Source process from the event header, indexed when the
+     *        payload names no process (see for_each_process()).
+     * @return The event's ID.
+     */
+    EventId commit(const Reservation& slot, EventId parent, uint32_t correlation_id,
+                   uint32_t pid = 0);
+
+    /**
+     * @brief Add a batch of events (thread-safe).
+     *
+     * Reserves all slots with a single atomic add, writes the nodes
+     * contiguously and updates the category and time indexes once per
+     * segment run instead of once per event. Parent and correlation links
+     * are still set per event, so a parent must be pushed before the batch
+     * that references it.
+     *
+     * @param events Events to add, in order.
+     * @param ids Optional output, one EventId per event (empty to skip).
+     * @return Number of leading events stored; fewer than events.size()
+     *         only when append-mode capacity or the arena runs out.
+     */
+    std::size_t push_batch(std::span<const PendingEvent> events,
+                           std::span<EventId> ids = {});
+
     /**
      * @brief Get event view by ID (thread-safe read).
+     *
+     * In ring mode the view stays valid until its segment is recycled,
+     * which is signalled by a change of epoch().
+     *
      * @param id Event identifier.
      * @return EventView for the event. Undefined behavior if ID is invalid.
      * @pre exists(id) must be true.
@@ -96,16 +320,382 @@ public:
     /**
      * @brief Check if an event exists.
      * @param id Event identifier to check.
-     * @return true if event exists, false otherwise.
+     * @return true if event exists (was pushed and not evicted), false otherwise.
      */
     [[nodiscard]] bool exists(EventId id) const noexcept;
 
+    /**
+     * @brief Change the status of a stored event (thread-safe).
+     *
+     * For verdicts reached after the push, e.g. by detection running off
+     * the ingest path. The node, the counters and a sealed columnar copy
+     * are updated; readers see either the old or the new status. In ring
+     * mode a segment recycled during the call can take the new status.
+     *
+     * @param id Event identifier.
+     * @param status New status.
+     * @return true if the event is live and its status changed.
+     */
+    bool set_status(EventId id, Status status);
+
+    /**
+     * @brief Give a stored event an extension record it was pushed without
+     * (thread-safe).
+     *
+     * For side records produced after the push, e.g. the verdict of an
+     * image hashed off the ingest path. Only an event without an extension
+     * takes one; columnar copies hold no extensions, so only the node changes.
+     *
+     * @param id Event identifier.
+     * @param extension Record from the ExtensionStore of this graph's session.
+     * @return true if the event is live and took the record.
+     */
+    bool set_extension(EventId id, ExtensionId extension);
+
+    /**
+     * @brief Attach detection tags to a stored event (thread-safe).
+     *
+     * The tag set lives beside the node, so the node stays 64 bytes; the
+     * caller decides what each bit means (RuleEngine maps rule tags to
+     * bits). Bits are only ever added. Each segment keeps the union of its
+     * events' tags, so for_each_tagged() skips segments without a match.
+     * In ring mode a segment recycled during the call can take the tags.
+     *
+     * @param id Event identifier.
+     * @param tags Bits to add.
+     * @return true if the event is live.
+     */
+    bool add_tags(EventId id, EventTags tags);
+
+    /// @brief Tags of an event (0 if it has none or is not live).
+    [[nodiscard]] EventTags tags(EventId id) const noexcept;
+
     /**
      * @brief Get current event count.
-     * @return Number of events in the graph.
+     *
+     * Counts up to the published watermark, so every counted node is fully
+     * written; slots still being filled by in-flight pushes are excluded.
+     *
+     * @return Number of live (non-evicted) events in the graph.
      */
     [[nodiscard]] std::size_t count() const noexcept;
 
+    /**
+     * @brief Get the ID of the oldest live event.
+     *
+     * Always 1 in append mode. Live IDs are [oldest_id(), oldest_id() + count()).
+     *
+     * @return Oldest live EventId.
+     */
+    [[nodiscard]] EventId oldest_id() const noexcept;
+
+    /**
+     * @brief Get the ID of the newest published event.
+     *
+     * Unlike count() it keeps growing as ring mode evicts, so it serves as
+     * a generation: every event pushed after a call gets a larger ID.
+     *
+     * @return Newest EventId, or INVALID_EVENT before the first push.
+     */
+    [[nodiscard]] EventId newest_id() const noexcept;
+
+    /**
+     * @brief Run fn once an event newer than after is published.
+     *
+     * Runs fn right away if there already is one. Otherwise fn runs on the
+     * thread whose push publishes it, or in release_watchers(), so it must
+     * be quick (e.g. hand a coroutine to a pool). A push only pays for one
+     * extra load while no watcher waits.
+     */
+    void when_published(EventId after, Task fn);
+
+    /// @brief Run every waiting when_published() callback now (e.g. the
+    /// session ended and no event will come).
+    void release_watchers();
+
+    /// @brief Published nodes of one segment, readable in place (or the
+    /// decoded copy of a compressed segment, held by the calling thread).
+    struct SegmentSpan {
+        const EventNode* nodes = nullptr;  ///< Node at absolute index first
+        std::size_t first = 0;             ///< Absolute index (EventId - 1) of nodes[0]
+        std::size_t length = 0;            ///< Contiguously published nodes (0 = none)
+        std::uint64_t epoch = 0;           ///< epoch() read before the span was taken
+    };
+
+    /**
+     * @brief Borrow the published nodes from index to the end of its segment.
+     *
+     * The nodes stay in place: no copy, no per-event lookup. An index below
+     * the oldest live event starts at the oldest. Append-mode nodes never
+     * change once published; in ring mode the segment may be recycled, so
+     * read what is needed and then confirm epoch() still equals span.epoch
+     * (eviction bumps it before any node is overwritten).
+     *
+     * @param index Zero-based absolute index (EventId - 1).
+     * @return Span with length 0 if nothing is published at or after index.
+     */
+    [[nodiscard]] SegmentSpan segment_span(std::size_t index) const noexcept;
+
+    /**
+     * @brief Get the eviction epoch.
+     *
+     * Incremented every time a segment is recycled or compressed. Readers
+     * that cached IDs or views can compare epochs to detect that eviction
+     * happened.
+     *
+     * @return Number of segment evictions and compressions so far.
+     */
+    [[nodiscard]] std::uint64_t epoch() const noexcept;
+
+    /**
+     * @brief Check if an event was pushed but has since been evicted.
+     * @param id Event identifier to check.
+     * @return true if id is older than oldest_id().
+     */
+    [[nodiscard]] bool is_evicted(EventId id) const noexcept;
+
+    /**
+     * @brief Get the configured retention policy.
+     * @return Retention mode passed at construction.
+     */
+    [[nodiscard]] Retention retention() const noexcept { return retention_; }
+
+    /**
+     * @brief Get the maximum number of events the graph can hold.
+     * @return Capacity passed at construction.
+     */
+    [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+
+    /**
+     * @brief Get the number of storage segments allocated so far.
+     * @return Allocated segment count (grows by one every kSegmentSize events).
+     */
+    [[nodiscard]] std::size_t segment_count() const noexcept;
+
+    /**
+     * @brief Get the arena bytes requested for event storage so far.
+     * @return Node, link, category index and column bytes (no padding).
+     */
+    [[nodiscard]] std::size_t storage_bytes() const noexcept {
+        return storage_bytes_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the number of live events in a category (O(1)).
+     *
+     * In ring mode evicted events are subtracted a whole segment at a time,
+     * so the value is exact once all in-flight pushes have completed.
+     *
+     * @param cat Category to count.
+     * @return Number of live events in the category, 0 for Category::Count.
+     */
+    [[nodiscard]] std::size_t category_count(Category cat) const noexcept;
+
+    /**
+     * @brief Live event counters by category x status and by process.
+     *
+     * Updated by every push and, in ring mode, by eviction. A writer lapped
+     * while storing into a recycled segment can leave its event counted.
+     *
+     * @return Counters; take snapshot() for a dashboard refresh.
+     */
+    [[nodiscard]] const EventCounters& counters() const noexcept { return counters_; }
+
+    /**
+     * @brief Events left out of a correlation or process chain.
+     *
+     * Chain heads live in fixed tables sized from the capacity; an event
+     * whose ID finds no free entry within the probe limit is stored but not
+     * reachable through for_each_correlation() or for_each_process().
+     *
+     * @return Links dropped since construction.
+     */
+    [[nodiscard]] std::size_t unlinked_count() const noexcept {
+        return unlinked_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Upper bound on the live events with timestamps in [from, to].
+     *
+     * Sums the live slots of every segment whose time bounds overlap the
+     * range without reading any node, so it costs one step per segment.
+     *
+     * @param from Inclusive lower bound.
+     * @param to Inclusive upper bound.
+     * @return Events a time-bounded scan would have to examine.
+     */
+    [[nodiscard]] std::size_t estimate_in_range(Timestamp from, Timestamp to) const noexcept;
+
+    /**
+     * @brief Seal full segments into columnar storage as they complete.
+     *
+     * Costs one extra column copy per segment (about 86 KiB from the arena).
+     * Segments completed before enabling are sealed by seal_segments().
+     *
+     * @param enabled true to seal automatically.
+     */
+    void set_columnar(bool enabled) noexcept {
+        columnar_.store(enabled, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Index the given string fields of every event pushed from now on.
+     *
+     * Each push then posts the event under the StringIds of those fields
+     * (see StringIndex), which for_each_with_string() reads. Events pushed
+     * before are not indexed. Not thread-safe against pushes: call before
+     * the first one.
+     *
+     * @param fields Payload string fields (empty = no index).
+     */
+    void set_string_index(std::span<const PayloadField> fields);
+
+    /// @brief The string index, or nullptr if set_string_index() set none.
+    [[nodiscard]] const StringIndex* string_index() const noexcept {
+        return string_index_.get();
+    }
+
+    /**
+     * @brief Keep a per-second histogram of the events pushed from now on.
+     *
+     * Every push then increments its second's bucket (see EventTimeline),
+     * and set_status() counts events turning Suspicious. Not thread-safe
+     * against pushes: call before the first one.
+     *
+     * @param seconds Window in one-second buckets (0 = no timeline).
+     */
+    void set_timeline(std::size_t seconds);
+
+    /// @brief The timeline, or nullptr if set_timeline() set none.
+    [[nodiscard]] const EventTimeline* timeline() const noexcept { return timeline_.get(); }
+
+    /**
+     * @brief Track heavy hitters and distinct counts of the events pushed
+     * from now on (see EventSketches).
+     *
+     * Not thread-safe against pushes: call before the first one.
+     *
+     * @param top Keys kept per heavy-hitter table (0 = no sketches).
+     */
+    void set_sketches(std::size_t top);
+
+    /// @brief The sketches, or nullptr if set_sketches() set none.
+    [[nodiscard]] const EventSketches* sketches() const noexcept { return sketches_.get(); }
+
+    /**
+     * @brief Queue an Alert for every event published as Suspicious, or
+     * marked so by set_status(), from now on.
+     *
+     * The queue is not owned and must outlive the graph's pushes. Not
+     * thread-safe against pushes: call before the first one.
+     *
+     * @param alerts Queue to push to (nullptr = no alerts).
+     */
+    void set_alerts(AlertQueue* alerts) noexcept { alerts_ = alerts; }
+
+    /// @brief The alert queue, or nullptr if set_alerts() set none.
+    [[nodiscard]] AlertQueue* alerts() const noexcept { return alerts_; }
+
+    /**
+     * @brief Sort each segment ring mode evicts into a long-term store.
+     *
+     * Before a segment is recycled, its Suspicious and tagged events and
+     * the events of chains and processes that had one are copied into
+     * store, the rest only counted there (see RetainedEvents). Every push,
+     * set_status() or add_tags() that flags an event marks its correlation
+     * chain and process in store from now on.
+     *
+     * The store is not owned and must outlive the graph's pushes. Ring
+     * mode only; append mode never evicts. Not thread-safe against pushes:
+     * call before the first one.
+     *
+     * @param store Store to fill (nullptr = evicted events are dropped).
+     * @return false if a store was given in append mode.
+     */
+    bool set_retained(RetainedEvents* store) noexcept;
+
+    /// @brief The long-term store, or nullptr if set_retained() set none.
+    [[nodiscard]] RetainedEvents* retained() const noexcept { return retained_; }
+
+    /**
+     * @brief Compress full segments in RAM once they leave the hot window.
+     *
+     * When a segment completes, the one hot_segments older is delta-encoded
+     * and LZ-compressed with pack_events() and its node storage is handed
+     * to the next segment allocated, so node memory stays near hot_segments
+     * plus cache_segments segments however many events are kept. Links,
+     * indexes and columnar copies are not compressed; sealed cold segments
+     * are still filtered over their columns and only decoded for matches.
+     *
+     * A decoded copy stays alive while the thread that read it holds it
+     * (the last few cold segments it touched), so an EventView of a cold
+     * event is valid until its thread has read several other cold segments.
+     * Compressing a segment bumps epoch() like ring eviction: holders of
+     * views of hot events re-check them. set_status() and set_extension()
+     * on cold events update the decoded copy, which is compressed again
+     * when it leaves the cache.
+     *
+     * Append mode only; ring mode already bounds its storage. Not
+     * thread-safe against pushes: call before the first one.
+     *
+     * @return false if compression was requested in ring mode.
+     */
+    bool set_compression(const CompressionConfig& config);
+
+    /**
+     * @brief Compress every full segment outside the hot window not yet compressed.
+     * @return Number of segments compressed by this call.
+     */
+    std::size_t compress_segments();
+
+    /// @brief Compressed bytes, ratio and decode cost.
+    [[nodiscard]] CompressionStats compression_stats() const noexcept;
+
+    /**
+     * @brief Move cold segments into separate storage.
+     *
+     * When a segment completes, the nodes of the one hot_segments older are
+     * copied into storage and its node block is handed to the next segment
+     * allocated, as with compression. With a file-backed storage arena
+     * (ArenaOptions::backing_file) the OS writes spilled nodes back to the
+     * file and faults them in again when read, so the graph can keep more
+     * events than fit in RAM. Links, indexes and columnar copies stay in
+     * memory: sealed segments that their summaries rule out are never
+     * touched, and filters fault in only the pages of matching events.
+     *
+     * Spilling a segment bumps epoch() like ring eviction. Once storage is
+     * full, later segments stay where they are. Append mode only, and not
+     * combined with set_compression(), which already frees the nodes. Not
+     * thread-safe against pushes: call before the first one.
+     *
+     * @param storage Arena to spill into (nullptr = off); outlives the graph.
+     * @return false in ring mode or with compression on.
+     */
+    bool set_spill(Arena* storage, std::size_t hot_segments = 4);
+
+    /**
+     * @brief Spill every full segment outside the hot window not yet spilled.
+     * @return Number of segments spilled by this call.
+     */
+    std::size_t spill_segments();
+
+    /// @brief Segments moved to the spill arena.
+    [[nodiscard]] std::size_t spilled_count() const noexcept {
+        return spilled_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Seal every full, published, live segment not yet sealed.
+     * @return Number of segments sealed by this call.
+     */
+    std::size_t seal_segments();
+
+    /**
+     * @brief Get the number of live segments with a columnar copy.
+     * @return Sealed segment count.
+     */
+    [[nodiscard]] std::size_t sealed_count() const noexcept;
+
     // -------------------------------------------------------------------------
     // Iteration
     // -------------------------------------------------------------------------
@@ -119,7 +709,41 @@ public:
     void for_each(F&& fn) const;
 
     /**
-     * @brief Iterate over events of a specific category.
+     * @brief Visit the run of consecutive events starting at index begin.
+     *
+     * Stops at the first slot not yet published, at the newest event, or
+     * after limit events; a begin below the oldest live event starts at
+     * the oldest. Walks segment by segment with one liveness check each,
+     * so bulk readers (the FFI export) pay no per-event lookup.
+     *
+     * @tparam F Callable taking const EventNode&.
+     * @param begin Zero-based absolute index (EventId - 1).
+     * @param limit Most events to visit.
+     * @return Number of events visited.
+     */
+    template <typename F>
+    std::size_t for_each_run(std::size_t begin, std::size_t limit, F&& fn) const;
+
+    /**
+     * @brief Iterate over all events as runs of contiguous nodes.
+     *
+     * Hands out each run of published nodes within a segment in place, so
+     * bulk consumers loop over plain nodes with no per-event wrapper or
+     * callback. Same visiting order and liveness rules as for_each(); in
+     * ring mode a span may be recycled once fn returns, see segment_span().
+     *
+     * @tparam F Callable taking std::span<const EventNode> (may return bool).
+     * @param fn Function to call for each run.
+     */
+    template <typename F>
+    void for_each_span(F&& fn) const;
+
+    /**
+     * @brief Iterate over events of a specific category (oldest first).
+     *
+     * Walks the per-category index, so the cost is proportional to the
+     * number of matching events rather than the size of the graph.
+     *
      * @tparam F Callable taking EventView.
      * @param cat Category to filter by.
      * @param fn Function to call for each matching event.
@@ -128,7 +752,55 @@ public:
     void for_each_category(Category cat, F&& fn) const;
 
     /**
-     * @brief Iterate over direct children of a parent event.
+     * @brief Iterate over events with timestamps in [from, to] (oldest first).
+     *
+     * Binary searches the per-segment time index for the first segment that
+     * can hold a match and stops at the first segment that starts after to,
+     * so only segments overlapping the range are scanned.
+     *
+     * @tparam F Callable taking EventView.
+     * @param from Inclusive lower bound (ns, same clock as push()).
+     * @param to Inclusive upper bound.
+     * @param fn Function to call for each matching event.
+     */
+    template <typename F>
+    void for_each_in_range(Timestamp from, Timestamp to, F&& fn) const;
+
+    /**
+     * @brief Iterate over events matching a filter (oldest first).
+     *
+     * Segments outside the filter's time range are skipped by their time
+     * bounds. Sealed segments are evaluated over their columns; hot segments
+     * by filter_nodes() over fixed node offsets.
+     *
+     * @tparam F Callable taking EventView.
+     * @param spec Filter to evaluate.
+     * @param fn Function to call for each matching event.
+     */
+    template <typename F>
+    void for_each_where(const FilterSpec& spec, F&& fn) const;
+
+    /**
+     * @brief Collect the IDs of all events matching a filter (oldest first).
+     *
+     * Bulk form of for_each_where(): matches are produced as 64-bit masks
+     * per block of nodes and appended without a callback per event. Hot
+     * segments go through filter_nodes() (AVX2 when built with
+     * EXERAY_ENABLE_AVX2), sealed segments through filter_sealed(), which
+     * answers category, status and correlation predicates from row groups.
+     *
+     * @param spec Filter to evaluate.
+     * @param out Receives matching IDs; existing contents are kept.
+     * @return Number of IDs appended.
+     */
+    std::size_t scan(const FilterSpec& spec, std::vector<EventId>& out) const;
+
+    /**
+     * @brief Iterate over direct children of a parent event (newest first).
+     *
+     * Children are only linked while the parent is live; once the parent is
+     * evicted in ring mode it has no children.
+     *
      * @tparam F Callable taking EventView.
      * @param parent Parent event ID.
      * @param fn Function to call for each child event.
@@ -137,7 +809,7 @@ public:
     void for_each_child(EventId parent, F&& fn) const;
 
     /**
-     * @brief Iterate over events with a specific correlation ID.
+     * @brief Iterate over events with a specific correlation ID (newest first).
      * @tparam F Callable taking EventView.
      * @param correlation_id Correlation ID to filter by.
      * @param fn Function to call for each matching event.
@@ -145,6 +817,103 @@ public:
     template <typename F>
     void for_each_correlation(uint32_t correlation_id, F&& fn) const;
 
+    /**
+     * @brief Iterate over what the current incarnation of a process did
+     *        (newest first).
+     *
+     * Every event is indexed at push time under the process it is
+     * attributed to: event_pid() of the payload, else the header PID of
+     * the PendingEvent (or commit()). The walk ends with the incarnation's
+     * Process Create or Rundown event, so events of an earlier process
+     * that had the same PID are not visited; without a stored start event
+     * it runs to the oldest live event of the PID.
+     *
+     * @tparam F Callable taking EventView.
+     * @param pid Process ID.
+     * @param fn Function to call for each event of the process.
+     */
+    template <typename F>
+    void for_each_process(uint32_t pid, F&& fn) const;
+
+    /**
+     * @brief Iterate over live events holding a string in an indexed field
+     *        (oldest first, approximately: concurrent pushes can interleave).
+     *
+     * Reads the posting list of id, so the cost follows the number of
+     * matches. Visits nothing without set_string_index().
+     *
+     * @tparam F Callable taking EventView.
+     * @param id Interned string.
+     * @param fn Function to call for each matching event.
+     */
+    template <typename F>
+    void for_each_with_string(StringId id, F&& fn) const;
+
+    /**
+     * @brief Iterate over events carrying any of the given tags (oldest first).
+     *
+     * Only segments whose tag union intersects tags are walked, so the
+     * cost follows the number of tagged segments, not the graph size.
+     *
+     * @tparam F Callable taking EventView.
+     * @param tags Tag bits to look for.
+     * @param fn Function to call for each matching event.
+     */
+    template <typename F>
+    void for_each_tagged(EventTags tags, F&& fn) const;
+
+    // -------------------------------------------------------------------------
+    // Parallel Iteration
+    // -------------------------------------------------------------------------
+    //
+    // The live range is split into one chunk per segment (kSegmentSize
+    // events, the unit that is sealed into columns). The calling thread and
+    // up to pool.size() pool tasks claim chunks with one atomic step each;
+    // the call returns once every chunk is done. The caller may itself be a
+    // pool worker.
+
+    /**
+     * @brief Visit every event on the pool, in no particular order.
+     *
+     * fn runs concurrently and must be safe to call from several threads.
+     * Returning false stops the claiming of further chunks; chunks already
+     * running finish.
+     *
+     * @tparam F Callable taking EventView.
+     */
+    template <typename F>
+    void parallel_for_each(F&& fn, ThreadPool& pool) const;
+
+    /// @brief for_each_where() on the pool, in no particular order.
+    template <typename F>
+    void parallel_for_each_where(const FilterSpec& spec, F&& fn, ThreadPool& pool) const;
+
+    /**
+     * @brief Fold every event on the pool with a deterministic result.
+     *
+     * Each chunk folds its events oldest first into a copy of identity;
+     * chunk results are then combined on the calling thread oldest chunk
+     * first. The result is therefore the same as a sequential fold whenever
+     * combine is associative, even if it is not commutative.
+     *
+     * @param identity Starting value of every chunk.
+     * @param fold Called as fold(T& acc, EventView) (concurrently across chunks).
+     * @param combine Called as combine(T& acc, T&& chunk) to merge chunk results.
+     */
+    template <typename T, typename Fold, typename Combine>
+    T parallel_reduce(T identity, Fold&& fold, Combine&& combine, ThreadPool& pool) const;
+
+    /**
+     * @brief scan() on the pool.
+     *
+     * Each chunk collects its matches separately; they are appended oldest
+     * chunk first, so out ends up exactly as scan() would leave it.
+     *
+     * @return Number of IDs appended.
+     */
+    std::size_t parallel_scan(const FilterSpec& spec, std::vector<EventId>& out,
+                              ThreadPool& pool) const;
+
     // -------------------------------------------------------------------------
     // String Convenience Methods
     // -------------------------------------------------------------------------
@@ -164,58 +933,782 @@ public:
     StringId intern_string(std::string_view str);
 
 private:
+    friend class GraphSnapshot;
+
+    /// @brief Event index + 1 as stored by the internal indexes (0 = none).
+    ///
+    /// 32-bit with compact indexes: kMaxEvents keeps every index + 1 in range.
+    using Link = std::conditional_t<kCompactIndex, std::uint32_t, std::uint64_t>;
+
+    /// @brief Convert an event index to its link.
+    [[nodiscard]] static constexpr Link link_of(std::size_t index) noexcept {
+        return static_cast<Link>(index + 1);
+    }
+
+    /// @brief Intrusive index links kept beside each node (same slot index).
+    ///
+    /// Links hold an event index + 1 so that 0 terminates a chain (32 bytes
+    /// per node with compact indexes, 48 otherwise).
+    struct NodeLinks {
+        std::atomic<Link> first_child{0};      ///< Newest child
+        std::atomic<Link> next_sibling{0};     ///< Next older sibling
+        std::atomic<Link> next_correlated{0};  ///< Next older same-correlation event
+        std::atomic<Link> next_in_process{0};  ///< Next older event of the same PID
+        std::atomic<Link> published{0};        ///< Index + 1 once the node is written
+        std::atomic<EventTags> tags{0};        ///< Detection tags (add_tags())
+    };
+
+    /// @brief Head table entry for one correlation ID or PID chain.
+    struct ChainHead {
+        std::atomic<uint32_t> key{0};  ///< Correlation ID or PID (0 = free)
+        std::atomic<Link> head{0};     ///< Newest event index + 1
+    };
+
+    static constexpr std::size_t kCategoryCount =
+        static_cast<std::size_t>(Category::Count);
+
+    /// Empty-segment value of Segment::min_timestamp.
+    static constexpr Timestamp kNoTimestamp = ~Timestamp{0};
+
+    /// @brief Directory slot holding one storage segment.
+    struct Segment {
+        std::atomic<EventNode*> nodes{nullptr};  ///< Segment storage
+        std::atomic<NodeLinks*> links{nullptr};  ///< Index links beside nodes
+        std::atomic<std::uint64_t> tag{0};       ///< Segment number + 1 (0 = empty)
+        /// Events per category in this segment, subtracted on eviction
+        std::array<std::atomic<std::uint32_t>, kCategoryCount> category_counts{};
+        /// Time bounds of the events pushed into this segment
+        std::atomic<Timestamp> min_timestamp{kNoTimestamp};
+        std::atomic<Timestamp> max_timestamp{0};
+        /// Union of the tags of the events in this segment
+        std::atomic<EventTags> tags{0};
+        /// Columnar copy, valid while sealed == tag
+        std::atomic<const SegmentColumns*> columns{nullptr};
+        /// Row groups of the columns, valid while sealed == tag
+        std::atomic<SegmentBitmaps*> bitmaps{nullptr};
+        /// Zone map, valid while sealed == tag
+        std::atomic<SegmentZone*> zone{nullptr};
+        std::atomic<std::uint64_t> sealed{0};
+    };
+
+    /// @brief Directory slot holding one segment of a category index.
+    ///
+    /// Entries hold an event index + 1; 0 marks a reserved entry whose push
+    /// has not published yet.
+    struct CategorySegment {
+        std::atomic<std::atomic<Link>*> entries{nullptr};
+        std::atomic<std::uint64_t> tag{0};  ///< Segment number + 1 (0 = empty)
+    };
+
+    /// @brief Append-only index of the events in one category.
+    struct CategoryIndex {
+        std::atomic<std::size_t> total{0};    ///< Entries ever reserved
+        std::atomic<std::size_t> evicted{0};  ///< Entries whose events were evicted
+        std::unique_ptr<CategorySegment[]> segments;
+    };
+
+    /// @brief Map a segment number to its directory slot.
+    [[nodiscard]] std::size_t slot_of(std::size_t segment) const noexcept {
+        return segment < max_segments_ ? segment : segment % max_segments_;
+    }
+
+    /// @brief Decoded nodes of a compressed segment, shared by the cache and
+    /// the readers holding them.
+    using DecodedNodes = std::shared_ptr<EventNode[]>;
+
+    /// @brief Compressed segments and their decoded copies (graph.cpp).
+    struct ColdStore;
+
+    /// @brief Nodes of a live segment, decoded if it is compressed; the
+    /// decoded copy is held by the calling thread.
+    [[nodiscard]] const EventNode* segment_nodes(std::size_t segment) const noexcept {
+        const EventNode* nodes =
+            segments_[slot_of(segment)].nodes.load(std::memory_order_acquire);
+        return nodes != nullptr ? nodes : cold_nodes(segment, nullptr);
+    }
+
+    /// @brief segment_nodes() holding a decoded copy in pin instead.
+    [[nodiscard]] const EventNode* segment_nodes(std::size_t segment,
+                                                 DecodedNodes& pin) const noexcept {
+        const EventNode* nodes =
+            segments_[slot_of(segment)].nodes.load(std::memory_order_acquire);
+        return nodes != nullptr ? nodes : cold_nodes(segment, &pin);
+    }
+
+    /// @brief Find or decode the copy of a compressed segment.
+    /// @param pin Receives the copy (nullptr = held by the calling thread).
+    const EventNode* cold_nodes(std::size_t segment, DecodedNodes* pin) const noexcept;
+
+    /// @brief Compress one full segment (takes segment_mutex_).
+    /// @return true if this call compressed it.
+    bool compress_segment(std::size_t segment);
+
+    /// @brief Move one full segment to spill_ (takes segment_mutex_).
+    /// @return true if this call moved it.
+    bool spill_segment(std::size_t segment);
+
+    /// @brief Apply a late update to the decoded copy of a compressed
+    /// segment (caller holds segment_mutex_).
+    template <typename Update>
+    void update_cold(std::size_t index, Update&& update);
+
+    /// @brief Resolve a zero-based event index to its node.
+    /// @pre The segment containing index is live.
+    [[nodiscard]] const EventNode* node_at(std::size_t index) const noexcept {
+        return segment_nodes(index >> kSegmentShift) + (index & (kSegmentSize - 1));
+    }
+
+    /// @brief Resolve a zero-based event index to its index links.
+    /// @pre The segment containing index is live.
+    [[nodiscard]] NodeLinks& links_at(std::size_t index) const noexcept {
+        return segments_[slot_of(index >> kSegmentShift)].links.load(
+                   std::memory_order_acquire)[index & (kSegmentSize - 1)];
+    }
+
+    /// @brief Check whether a chain link (index + 1) points at a live event.
+    [[nodiscard]] bool link_live(Link link) const noexcept {
+        if (link == 0) {
+            return false;
+        }
+        const auto index = static_cast<std::size_t>(link - 1);
+        return index >= first_index_.load(std::memory_order_acquire) &&
+               segment_live(index >> kSegmentShift);
+    }
+
+    /// @brief Find the entry for key in a head table (correlation or process).
+    /// @param create Claim a free (or fully evicted) entry if none matches.
+    /// @return Entry pointer, or nullptr if absent / the table is full.
+    ChainHead* find_head(ChainHead* heads, uint32_t key, bool create) const;
+
+    /// @brief Link an event into the child, correlation and process chains.
+    /// @param pid Process the event is attributed to (0 = none).
+    void link_event(std::size_t index, EventId parent, uint32_t correlation_id,
+                    uint32_t pid);
+
+    /// @brief PID an event is indexed under: the payload's, else the header's.
+    [[nodiscard]] static uint32_t process_key(const EventPayload& payload,
+                                              uint32_t header_pid) noexcept {
+        const uint32_t pid = event_pid(payload);
+        return pid != 0 ? pid : header_pid;
+    }
+
+    /// @brief Walk a chain starting at head, following next(links).
+    template <typename Next, typename F>
+    void walk_chain(Link head, Next next, F&& fn) const;
+
+    /// @brief Call a visitor; false if it returned false (stop), else true.
+    template <typename F, typename... Args>
+    static bool visit(F& fn, Args&&... args) {
+        if constexpr (std::is_same_v<std::invoke_result_t<F&, Args...>, bool>) {
+            return fn(std::forward<Args>(args)...);
+        } else {
+            fn(std::forward<Args>(args)...);
+            return true;
+        }
+    }
+
+    /// @brief Check that the slot for a segment currently holds that segment.
+    [[nodiscard]] bool segment_live(std::size_t segment) const noexcept {
+        return segments_[slot_of(segment)].tag.load(std::memory_order_acquire) ==
+               segment + 1;
+    }
+
+    /// @brief Get the segment for a reserved index, allocating or recycling it.
+    /// @return Segment base pointer, or nullptr if the arena is exhausted or
+    ///         the segment was already recycled past this index.
+    EventNode* acquire_segment(std::size_t segment);
+
+    /// @brief Drop the segment in a ring slot (caller holds segment_mutex_).
+    void evict_slot(std::size_t slot, std::uint64_t old_tag);
+
+    /// @brief Map a category index segment number to its directory slot.
+    [[nodiscard]] std::size_t category_slot_of(std::size_t segment) const noexcept {
+        return segment < category_segments_ ? segment : segment % category_segments_;
+    }
+
+    /// @brief Get a category index segment, allocating or recycling it.
+    /// @return Entry array, or nullptr if the arena is exhausted.
+    std::atomic<Link>* acquire_category_segment(CategoryIndex& index, std::size_t segment);
+
+    /// @brief Check that the node at index is fully written.
+    /// @pre The segment containing index is live.
+    [[nodiscard]] bool slot_published(std::size_t index) const noexcept {
+        return links_at(index).published.load(std::memory_order_acquire) == link_of(index);
+    }
+
+    /// @brief Mark the node at index as fully written.
+    void publish(std::size_t index) noexcept;
+
+    /// @brief Move the published watermark over every contiguous written slot.
+    void advance_published() noexcept;
+
+    /// @brief Run the when_published() callbacks waiting for IDs below mark.
+    void notify_watchers(std::size_t mark);
+
+    /// @brief Copy a fully published segment into its columnar form.
+    /// @return true if this call sealed the segment.
+    bool seal_segment(std::size_t segment);
+
+    /// @brief Append an event index to its category index.
+    void index_category(Category cat, std::size_t index);
+
+    /// @brief Widen the time bounds of the segment holding index.
+    void index_timestamp(std::size_t index, Timestamp low, Timestamp high);
+
+    /// @brief Publish an event index at a reserved category index position.
+    void store_category_entry(CategoryIndex& category, std::size_t pos,
+                              std::size_t index);
+
+    /// @brief Write an event into its reserved node.
+    static void store_node(EventNode& node, EventId id, const PendingEvent& event);
+
+    /// @brief Visit published nodes [begin, end) segment by segment.
+    ///
+    /// Segments and slots recycled while the scan runs (ring mode) are
+    /// skipped; they now hold events newer than end.
+    ///
+    /// @return false if fn returned false and stopped the scan.
+    template <typename F>
+    bool scan_nodes(std::size_t begin, std::size_t end, F&& fn) const;
+
+    /// @brief Visit (index, node) of published events in [begin, end)
+    /// matching spec.
+    ///
+    /// Shared driver of for_each_where() and scan(): picks the columnar or
+    /// the node kernel per segment and walks the resulting bitmasks until
+    /// fn returns false.
+    template <typename F>
+    void match_where(std::size_t begin, std::size_t end, const FilterSpec& spec,
+                     F&& fn) const;
+
+    /// @brief for_each_category() over index positions below total_limit
+    /// and event indexes below index_end.
+    template <typename F>
+    void walk_category(Category cat, std::size_t total_limit, std::size_t index_end,
+                       F&& fn) const;
+
+    /// @brief Whether the summaries of a live segment (time bounds,
+    /// category counts, zone map once sealed) admit a match of spec.
+    [[nodiscard]] bool segment_may_match(std::size_t segment,
+                                         const FilterSpec& spec) const noexcept;
+
+    /// @brief for_each_in_range() over event indexes [begin, end).
+    template <typename F>
+    void walk_range(std::size_t begin, std::size_t end, Timestamp from, Timestamp to,
+                    F&& fn) const;
+
+    /// @brief Segment-sized chunks covering event indexes [begin, end).
+    [[nodiscard]] static std::size_t chunk_count(std::size_t begin, std::size_t end) noexcept {
+        return begin < end ? ((end - 1) >> kSegmentShift) - (begin >> kSegmentShift) + 1 : 0;
+    }
+
+    /// @brief Run chunk(i, first, last) for every chunk i of [begin, end), on
+    /// the calling thread and the pool.
+    ///
+    /// chunk returns false to stop the claiming of further chunks.
+    template <typename Chunk>
+    static void run_chunks(std::size_t begin, std::size_t end, ThreadPool& pool, Chunk&& chunk);
+
     Arena& arena_;
     StringPool& strings_;
-    EventNode* nodes_;
+    Retention retention_;
     std::size_t capacity_;
-    std::atomic<std::size_t> count_{0};
-    std::atomic<EventId> next_id_{1};
-    mutable std::shared_mutex mutex_;
+    std::size_t max_segments_;
+    std::unique_ptr<Segment[]> segments_;
+    std::atomic<std::size_t> segments_allocated_{0};
+    std::atomic<std::size_t> storage_bytes_{0};
+    std::mutex segment_mutex_;
+    std::atomic<std::size_t> count_{0};      ///< Slots reserved (EventId = index + 1)
+    std::atomic<std::size_t> published_{0};  ///< Every slot below is fully written
+    std::atomic<std::size_t> first_index_{0};
+    std::atomic<std::uint64_t> epoch_{0};
+    std::atomic<bool> columnar_{false};
+    std::unique_ptr<ColdStore> cold_;  ///< nullptr = no compression
+    Arena* spill_ = nullptr;           ///< nullptr = no spilling
+    std::size_t spill_hot_ = 0;
+    std::size_t spill_next_ = 0;  ///< Oldest segment not yet spilled (segment_mutex_)
+    std::atomic<std::size_t> spilled_{0};
+    /// Node blocks freed by compression or spilling (segment_mutex_)
+    std::vector<EventNode*> spare_nodes_;
+    std::unique_ptr<StringIndex> string_index_;
+    std::unique_ptr<EventTimeline> timeline_;
+    std::unique_ptr<EventSketches> sketches_;
+    AlertQueue* alerts_ = nullptr;
+    RetainedEvents* retained_ = nullptr;
+    EventCounters counters_;
+
+    // when_published() callbacks
+    struct Watcher {
+        std::size_t after;  ///< Fires once published_ > after
+        Task fn;
+    };
+    std::mutex watch_mutex_;
+    std::vector<Watcher> watchers_;
+    std::atomic<std::size_t> watching_{0};  ///< watchers_.size(), read on push
+
+    // Correlation and process chain heads (power-of-two open-addressed
+    // tables of the same size)
+    std::size_t correlation_mask_;
+    std::unique_ptr<ChainHead[]> correlation_heads_;
+    std::unique_ptr<ChainHead[]> process_heads_;
+    std::atomic<std::size_t> unlinked_{0};  ///< Links dropped on a full head table
 
-    // Indexes for O(1) lookup
-    std::unordered_multimap<EventId, std::size_t> parent_index_;
-    std::unordered_multimap<uint32_t, std::size_t> correlation_index_;
+    // Per-category event indexes (directory slots per category)
+    std::size_t category_segments_;
+    std::array<CategoryIndex, kCategoryCount> categories_;
 };
 
 // =============================================================================
 // Template Implementation
 // =============================================================================
 
+template <typename F>
+bool EventGraph::scan_nodes(std::size_t begin, std::size_t end, F&& fn) const {
+    std::size_t index = begin;
+    while (index < end) {
+        const auto segment = index >> kSegmentShift;
+        const auto segment_end = (std::min)(end, (segment + 1) << kSegmentShift);
+        if (!segment_live(segment)) {
+            index = segment_end;
+            continue;
+        }
+        DecodedNodes pin;
+        const EventNode* nodes = segment_nodes(segment, pin);
+        for (; index < segment_end; ++index) {
+            if (slot_published(index) && !fn(nodes[index & (kSegmentSize - 1)])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <typename Next, typename F>
+void EventGraph::walk_chain(Link head, Next next, F&& fn) const {
+    // Chains run newest to oldest, so the first evicted link ends the walk
+    for (auto link = head; link_live(link);) {
+        const auto index = static_cast<std::size_t>(link - 1);
+        if (!visit(fn, EventView(*node_at(index)))) {
+            return;
+        }
+        link = next(links_at(index)).load(std::memory_order_acquire);
+    }
+}
+
 template <typename F>
 void EventGraph::for_each(F&& fn) const {
-    std::shared_lock lock(mutex_);
-    const auto current_count = count_.load(std::memory_order_acquire);
-    for (std::size_t i = 0; i < current_count; ++i) {
-        fn(EventView(&nodes_[i]));
+    const auto begin = first_index_.load(std::memory_order_acquire);
+    scan_nodes(begin, begin + count(), [&fn](const EventNode& node) {
+        return visit(fn, EventView(node));
+    });
+}
+
+template <typename F>
+void EventGraph::for_each_span(F&& fn) const {
+    const auto begin = first_index_.load(std::memory_order_acquire);
+    const auto end = begin + count();
+    std::size_t index = begin;
+    while (index < end) {
+        const auto segment = index >> kSegmentShift;
+        const auto segment_end = (std::min)(end, (segment + 1) << kSegmentShift);
+        if (!segment_live(segment)) {
+            index = segment_end;
+            continue;
+        }
+        DecodedNodes pin;
+        const EventNode* nodes = segment_nodes(segment, pin);
+        while (index < segment_end) {
+            if (!slot_published(index)) {
+                ++index;
+                continue;
+            }
+            const auto run = index;
+            while (index < segment_end && slot_published(index)) {
+                ++index;
+            }
+            const std::span<const EventNode> span(nodes + (run & (kSegmentSize - 1)),
+                                                  index - run);
+            if (!visit(fn, span)) {
+                return;
+            }
+        }
+    }
+}
+
+template <typename F>
+std::size_t EventGraph::for_each_run(std::size_t begin, std::size_t limit, F&& fn) const {
+    const auto first = first_index_.load(std::memory_order_acquire);
+    std::size_t index = (std::max)(begin, first);
+    const std::size_t end = (std::min)(first + count(), index + (std::min)(limit, capacity_));
+    std::size_t visited = 0;
+    while (index < end) {
+        const auto segment = index >> kSegmentShift;
+        const auto segment_end = (std::min)(end, (segment + 1) << kSegmentShift);
+        if (!segment_live(segment)) {
+            break;  // Recycled since count() was read
+        }
+        DecodedNodes pin;
+        const EventNode* nodes = segment_nodes(segment, pin);
+        for (; index < segment_end; ++index, ++visited) {
+            if (!slot_published(index)) {
+                return visited;
+            }
+            fn(nodes[index & (kSegmentSize - 1)]);
+        }
     }
+    return visited;
 }
 
 template <typename F>
 void EventGraph::for_each_category(Category cat, F&& fn) const {
-    std::shared_lock lock(mutex_);
-    const auto current_count = count_.load(std::memory_order_acquire);
-    for (std::size_t i = 0; i < current_count; ++i) {
-        if (nodes_[i].payload.category == cat) {
-            fn(EventView(&nodes_[i]));
+    walk_category(cat, std::numeric_limits<std::size_t>::max(),
+                  std::numeric_limits<std::size_t>::max(), fn);
+}
+
+template <typename F>
+void EventGraph::walk_category(Category cat, std::size_t total_limit,
+                               std::size_t index_end, F&& fn) const {
+    const auto c = static_cast<std::size_t>(cat);
+    if (c >= kCategoryCount) {
+        return;
+    }
+    const CategoryIndex& index = categories_[c];
+    const auto total = (std::min)(total_limit, index.total.load(std::memory_order_acquire));
+    const auto window = category_segments_ << kSegmentShift;
+    const auto window_begin = total > window ? total - window : 0;
+
+    const auto entry_at = [this, &index](std::size_t pos) -> Link {
+        const auto segment = pos >> kSegmentShift;
+        const CategorySegment& slot = index.segments[category_slot_of(segment)];
+        if (slot.tag.load(std::memory_order_acquire) != segment + 1) {
+            return 0;
+        }
+        const auto entry =
+            slot.entries.load(std::memory_order_acquire)[pos & (kSegmentSize - 1)]
+                .load(std::memory_order_acquire);
+        // Sequence check: the segment may have been recycled under us
+        return slot.tag.load(std::memory_order_acquire) == segment + 1 ? entry : 0;
+    };
+
+    // Evicted entries are counted per segment; concurrent pushers can leave
+    // a few live entries just below that mark, so back up over them.
+    auto pos = (std::max)(window_begin, index.evicted.load(std::memory_order_acquire));
+    while (pos > window_begin && link_live(entry_at(pos - 1))) {
+        --pos;
+    }
+    for (; pos < total; ++pos) {
+        const auto entry = entry_at(pos);
+        if (link_live(entry) && entry <= index_end &&
+            !visit(fn, EventView(*node_at(static_cast<std::size_t>(entry - 1))))) {
+            return;
         }
     }
 }
 
+template <typename F>
+void EventGraph::for_each_in_range(Timestamp from, Timestamp to, F&& fn) const {
+    const auto begin = first_index_.load(std::memory_order_acquire);
+    walk_range(begin, begin + count(), from, to, fn);
+}
+
+template <typename F>
+void EventGraph::walk_range(std::size_t begin, std::size_t end, Timestamp from,
+                            Timestamp to, F&& fn) const {
+    if (from > to || begin >= end) {
+        return;
+    }
+
+    const auto segment_at = [this](std::size_t segment) -> const Segment& {
+        return segments_[slot_of(segment)];
+    };
+
+    // First segment whose newest event is not older than from. Segment
+    // maxima are nondecreasing up to the jitter between concurrent pushers.
+    auto lo = begin >> kSegmentShift;
+    auto hi = ((end - 1) >> kSegmentShift) + 1;
+    while (lo < hi) {
+        const auto mid = lo + (hi - lo) / 2;
+        if (segment_at(mid).max_timestamp.load(std::memory_order_acquire) < from) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    for (auto segment = lo; (segment << kSegmentShift) < end; ++segment) {
+        if (segment_at(segment).min_timestamp.load(std::memory_order_acquire) > to) {
+            break;
+        }
+        const auto first = (std::max)(begin, segment << kSegmentShift);
+        const auto last = (std::min)(end, (segment + 1) << kSegmentShift);
+        const bool more = scan_nodes(first, last, [from, to, &fn](const EventNode& node) {
+            return node.timestamp < from || node.timestamp > to ||
+                   visit(fn, EventView(node));
+        });
+        if (!more) {
+            return;
+        }
+    }
+}
+
+template <typename F>
+void EventGraph::for_each_where(const FilterSpec& spec, F&& fn) const {
+    const auto begin = first_index_.load(std::memory_order_acquire);
+    match_where(begin, begin + count(), spec, [&fn](std::size_t, const EventNode& node) {
+        return visit(fn, EventView(node));
+    });
+}
+
+template <typename F>
+void EventGraph::match_where(std::size_t begin, std::size_t end, const FilterSpec& spec,
+                             F&& fn) const {
+    if (begin >= end) {
+        return;
+    }
+    std::uint64_t mask[kSegmentSize / 64];
+    DecodedNodes pin;
+
+    for (auto segment = begin >> kSegmentShift; (segment << kSegmentShift) < end;
+         ++segment) {
+        const Segment& slot = segments_[slot_of(segment)];
+        if (!segment_live(segment) || !segment_may_match(segment, spec)) {
+            continue;
+        }
+        const auto first = (std::max)(begin, segment << kSegmentShift);
+        const auto last = (std::min)(end, (segment + 1) << kSegmentShift);
+        // A compressed segment is only decoded once a row matches
+        const EventNode* nodes = slot.nodes.load(std::memory_order_acquire);
+
+        // Mask bit i refers to index origin + i
+        std::size_t origin = 0;
+        const SegmentColumns* columns = slot.columns.load(std::memory_order_acquire);
+        const bool sealed =
+            columns != nullptr && slot.sealed.load(std::memory_order_acquire) == segment + 1;
+        if (sealed) {
+            if (!filter_sealed(*columns, slot.bitmaps.load(std::memory_order_acquire),
+                               kSegmentSize, spec, mask)) {
+                continue;  // The row groups rule out the whole segment
+            }
+            origin = segment << kSegmentShift;
+        } else {
+            // Unsealed segment: only [first, last) is below the watermark
+            if (nodes == nullptr) {
+                nodes = segment_nodes(segment, pin);
+            }
+            filter_nodes(nodes + (first & (kSegmentSize - 1)), last - first, spec, mask);
+            origin = first;
+        }
+
+        for (std::size_t word = (first - origin) / 64; word <= (last - 1 - origin) / 64;
+             ++word) {
+            for (auto bits = mask[word]; bits != 0; bits &= bits - 1) {
+                const auto index = origin + word * 64 +
+                                   static_cast<std::size_t>(std::countr_zero(bits));
+                if (index < first || index >= last || !slot_published(index)) {
+                    continue;
+                }
+                if (nodes == nullptr) {
+                    nodes = segment_nodes(segment, pin);
+                }
+                const EventNode& node = nodes[index & (kSegmentSize - 1)];
+                // Columns hold no strings; filter_nodes() already checked hot rows
+                if (sealed && spec.string_id != INVALID_STRING &&
+                    !carries_string(node.payload, spec.string_id)) {
+                    continue;
+                }
+                if (!fn(index, node)) {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+template <typename Chunk>
+void EventGraph::run_chunks(std::size_t begin, std::size_t end, ThreadPool& pool,
+                            Chunk&& chunk) {
+    const auto chunks = chunk_count(begin, end);
+    if (chunks == 0) {
+        return;
+    }
+    const auto first_segment = begin >> kSegmentShift;
+
+    // Tasks that start after the last chunk was claimed only touch this
+    // state, which they keep alive; chunk is only called while we wait
+    struct Shared {
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> done{0};
+        std::atomic<bool> stopped{false};
+    };
+    const auto shared = std::make_shared<Shared>();
+    const auto work = [shared, chunks, begin, end, first_segment, &chunk] {
+        for (;;) {
+            const auto i = shared->next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= chunks) {
+                return;
+            }
+            const auto segment = first_segment + i;
+            if (!shared->stopped.load(std::memory_order_relaxed) &&
+                !chunk(i, (std::max)(begin, segment << kSegmentShift),
+                       (std::min)(end, (segment + 1) << kSegmentShift))) {
+                shared->stopped.store(true, std::memory_order_relaxed);
+            }
+            if (shared->done.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks) {
+                shared->done.notify_all();
+            }
+        }
+    };
+
+    const auto helpers = (std::min)(pool.size(), chunks - 1);
+    for (std::size_t i = 0; i < helpers; ++i) {
+        pool.submit(work);
+    }
+    work();
+    for (auto done = shared->done.load(std::memory_order_acquire); done < chunks;
+         done = shared->done.load(std::memory_order_acquire)) {
+        shared->done.wait(done, std::memory_order_acquire);
+    }
+}
+
+template <typename F>
+void EventGraph::parallel_for_each(F&& fn, ThreadPool& pool) const {
+    const auto begin = first_index_.load(std::memory_order_acquire);
+    run_chunks(begin, begin + count(), pool,
+               [this, &fn](std::size_t, std::size_t first, std::size_t last) {
+        return scan_nodes(first, last, [&fn](const EventNode& node) {
+            return visit(fn, EventView(node));
+        });
+    });
+}
+
+template <typename F>
+void EventGraph::parallel_for_each_where(const FilterSpec& spec, F&& fn,
+                                         ThreadPool& pool) const {
+    const auto begin = first_index_.load(std::memory_order_acquire);
+    run_chunks(begin, begin + count(), pool,
+               [this, &spec, &fn](std::size_t, std::size_t first, std::size_t last) {
+        bool more = true;
+        match_where(first, last, spec, [&fn, &more](std::size_t, const EventNode& node) {
+            more = visit(fn, EventView(node));
+            return more;
+        });
+        return more;
+    });
+}
+
+template <typename T, typename Fold, typename Combine>
+T EventGraph::parallel_reduce(T identity, Fold&& fold, Combine&& combine,
+                              ThreadPool& pool) const {
+    const auto begin = first_index_.load(std::memory_order_acquire);
+    const auto end = begin + count();
+    std::vector<T> partial(chunk_count(begin, end), identity);
+    run_chunks(begin, end, pool, [this, &fold, &partial](std::size_t i, std::size_t first,
+                                                         std::size_t last) {
+        T& acc = partial[i];
+        return scan_nodes(first, last, [&fold, &acc](const EventNode& node) {
+            fold(acc, EventView(node));
+            return true;
+        });
+    });
+    T result = std::move(identity);
+    for (T& chunk : partial) {
+        combine(result, std::move(chunk));
+    }
+    return result;
+}
+
 template <typename F>
 void EventGraph::for_each_child(EventId parent, F&& fn) const {
-    std::shared_lock lock(mutex_);
-    auto [first, last] = parent_index_.equal_range(parent);
-    for (auto it = first; it != last; ++it) {
-        fn(EventView(&nodes_[it->second]));
+    if (!exists(parent)) {
+        return;
     }
+    const auto head = links_at(static_cast<std::size_t>(parent - 1))
+                          .first_child.load(std::memory_order_acquire);
+    walk_chain(head, [](NodeLinks& l) -> auto& { return l.next_sibling; }, fn);
 }
 
 template <typename F>
 void EventGraph::for_each_correlation(uint32_t correlation_id, F&& fn) const {
-    std::shared_lock lock(mutex_);
-    auto [first, last] = correlation_index_.equal_range(correlation_id);
-    for (auto it = first; it != last; ++it) {
-        fn(EventView(&nodes_[it->second]));
+    if (correlation_id == 0) {
+        return;
+    }
+    const ChainHead* entry = find_head(correlation_heads_.get(), correlation_id, false);
+    if (entry == nullptr) {
+        return;
+    }
+    // A reclaimed head entry can briefly chain foreign events; filter them
+    walk_chain(entry->head.load(std::memory_order_acquire),
+               [](NodeLinks& l) -> auto& { return l.next_correlated; },
+               [correlation_id, &fn](EventView view) {
+                   return view.correlation_id() != correlation_id || visit(fn, view);
+               });
+}
+
+template <typename F>
+void EventGraph::for_each_process(uint32_t pid, F&& fn) const {
+    if (pid == 0) {
+        return;
+    }
+    const ChainHead* entry = find_head(process_heads_.get(), pid, false);
+    if (entry == nullptr) {
+        return;
+    }
+    walk_chain(entry->head.load(std::memory_order_acquire),
+               [](NodeLinks& l) -> auto& { return l.next_in_process; },
+               [pid, &fn](EventView view) {
+                   // A reclaimed head entry can briefly chain foreign events
+                   const uint32_t owner = event_pid(view.payload());
+                   if (owner != 0 && owner != pid) {
+                       return true;
+                   }
+                   const bool start =
+                       view.category() == Category::Process &&
+                       (view.operation() == static_cast<uint8_t>(ProcessOp::Create) ||
+                        view.operation() == static_cast<uint8_t>(ProcessOp::Rundown));
+                   return visit(fn, view) && !start;
+               });
+}
+
+template <typename F>
+void EventGraph::for_each_with_string(StringId id, F&& fn) const {
+    if (string_index_ == nullptr || id == INVALID_STRING) {
+        return;
+    }
+    std::vector<std::size_t> postings;
+    string_index_->collect(id, postings);
+    for (const std::size_t index : postings) {
+        const auto event = static_cast<EventId>(index) + 1;
+        if (!exists(event)) {
+            continue;
+        }
+        const EventNode& node = *node_at(index);
+        if (node.id == event && !visit(fn, EventView(node))) {
+            return;
+        }
+    }
+}
+
+template <typename F>
+void EventGraph::for_each_tagged(EventTags tags, F&& fn) const {
+    if (tags == 0) {
+        return;
+    }
+    const auto begin = first_index_.load(std::memory_order_acquire);
+    const auto end = begin + count();
+    for (auto segment = begin >> kSegmentShift; (segment << kSegmentShift) < end; ++segment) {
+        if ((segments_[slot_of(segment)].tags.load(std::memory_order_acquire) & tags) == 0) {
+            continue;
+        }
+        const auto first = (std::max)(begin, segment << kSegmentShift);
+        const auto last = (std::min)(end, (segment + 1) << kSegmentShift);
+        const bool more = scan_nodes(first, last, [this, tags, &fn](const EventNode& node) {
+            const auto index = static_cast<std::size_t>(node.id - 1);
+            return (links_at(index).tags.load(std::memory_order_acquire) & tags) == 0 ||
+                   visit(fn, EventView(node));
+        });
+        if (!more) {
+            return;
+        }
     }
 }
 
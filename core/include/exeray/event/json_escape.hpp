@@ -0,0 +1,38 @@
+#pragma once
+
+/**
+ * @file json_escape.hpp
+ * @brief JSON string escaping kernels.
+ *
+ * Event text is mostly free of the characters JSON must escape ('"', '\\'
+ * and control characters), including long script blocks. The kernels find
+ * the next such character 16 bytes at a time with SSE2 (32 with
+ * EXERAY_ENABLE_AVX2), so clean runs are copied whole and only the rare
+ * escapes go through the scalar path.
+ *
+ * Input is taken as UTF-8, as the string pool stores it; bytes of 0x80 and
+ * above are copied as they are.
+ */
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace exeray::event {
+
+/// Most bytes the escaped form of one input byte takes ("\u001f").
+inline constexpr std::size_t kMaxJsonEscape = 6;
+
+/**
+ * @brief Length of the prefix of text that needs no escaping.
+ * @return text.size() when nothing in text needs escaping.
+ */
+[[nodiscard]] std::size_t json_plain_prefix(std::string_view text) noexcept;
+
+/// @brief Append text as a JSON string literal, quotes included.
+void append_json_string(std::string& out, std::string_view text);
+
+/// @brief True when the scan runs on AVX2, not SSE2/scalar.
+[[nodiscard]] bool json_kernels_vectorized() noexcept;
+
+}  // namespace exeray::event
@@ -0,0 +1,111 @@
+#pragma once
+
+/**
+ * @file json_export.hpp
+ * @brief NDJSON rendering of events, one JSON object per line, for SIEMs.
+ *
+ * Every line has the node fields, then the category's payload members by
+ * their payload_fields.hpp names:
+ * @code
+ * {"id":7,"parent_id":3,"timestamp":1700000000000000000,"correlation_id":0,
+ *  "category":"FileSystem","operation":1,"status":"Success",
+ *  "path":"C:\\data\\a.txt","size":4096}
+ * @endcode
+ * With set_wall_clock(), "timestamp" is followed by "wall_time", the event
+ * time in Unix-epoch nanoseconds.
+ * String members are JSON strings (null for INVALID_STRING). Network
+ * addresses are "a.b.c.d", or the IPv6 text when family is kAddressIPv6.
+ *
+ * NdjsonExporter renders into a caller's std::string that keeps its
+ * capacity, so rendering allocates nothing once the buffer and the cache
+ * are warm. Paths, images and command lines repeat from event to event:
+ * each StringId is escaped once and its JSON literal kept in a cache, keyed
+ * by the ID, never by the text. Texts longer than kMaxCachedJsonString,
+ * such as script blocks, are escaped on every use by the SIMD kernels of
+ * json_escape.hpp instead of filling the cache.
+ *
+ * Usage example:
+ * @code
+ * NdjsonExporter json(strings);
+ * std::ofstream file("events.ndjson", std::ios::binary);
+ * json.write(graph, file);
+ * @endcode
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "graph.hpp"
+#include "payload_fields.hpp"
+#include "wall_clock.hpp"
+
+namespace exeray::event {
+
+/// @brief Longest text, in input bytes, whose escaped form is cached.
+inline constexpr std::size_t kMaxCachedJsonString = 1024;
+
+/**
+ * @brief Renderer of events as NDJSON lines, with an escaped string cache.
+ *
+ * Thread-safety: none; use one exporter per thread.
+ */
+class NdjsonExporter {
+public:
+    /**
+     * @param strings Pool the rendered events' StringIds belong to.
+     * @param cache_bytes Most bytes of escaped text cached; once full, new
+     *        strings are escaped on every use.
+     */
+    explicit NdjsonExporter(const StringPool& strings,
+                            std::size_t cache_bytes = std::size_t{16} << 20);
+
+    /// @brief Also render "wall_time" through clock (e.g. Engine::wall_clock());
+    /// an invalid clock turns it off again.
+    void set_wall_clock(WallClock clock) noexcept { wall_clock_ = clock; }
+
+    /// @brief Append event as one line, newline included.
+    void append(EventView event, std::string& out);
+
+    /**
+     * @brief Write every event of graph, oldest first, in large writes.
+     * @return Events written.
+     */
+    std::size_t write(const EventGraph& graph, std::ostream& out);
+
+    /// @brief Strings escaped and kept in the cache.
+    [[nodiscard]] std::size_t cached_strings() const noexcept { return cache_.size(); }
+
+    /// @brief Empty the cache, e.g. after the pool was cleared.
+    void clear_cache();
+
+private:
+    /// @brief A member and its key, '"name":' with the leading comma.
+    struct Member {
+        PayloadField field;
+        std::string key;
+        bool address = false;  ///< Network local_addr/remote_addr
+    };
+
+    struct Cached {
+        std::uint32_t offset;  ///< In cache_text_
+        std::uint32_t length;
+    };
+
+    /// @brief Append the JSON literal of a StringId.
+    void append_string(std::string& out, StringId id);
+
+    const StringPool& strings_;
+    const std::size_t cache_bytes_;
+    WallClock wall_clock_{};
+    std::array<std::vector<Member>, static_cast<std::size_t>(Category::Count)> members_;
+    std::unordered_map<StringId, Cached> cache_;
+    std::string cache_text_;  ///< Escaped literals, quotes included
+};
+
+}  // namespace exeray::event
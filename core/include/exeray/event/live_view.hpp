@@ -0,0 +1,103 @@
+#pragma once
+
+/**
+ * @file live_view.hpp
+ * @brief Filtered, sorted and paged event list maintained as events arrive.
+ *
+ * A LiveView keeps the IDs of the events matching a FilterSpec in sort
+ * order. refresh() tests only the events published since the previous
+ * refresh, so a UI can keep "suspicious network events by time" open and
+ * ask for one page of it per frame without rescanning the graph.
+ *
+ * Usage example:
+ * @code
+ * FilterSpec filter;
+ * filter.with_category(Category::Network).with_status(Status::Suspicious);
+ * LiveView view(graph, filter, {ViewSort::Timestamp, true, 25});
+ * view.refresh();
+ * std::array<QueryRow, 25> rows;
+ * std::size_t n = view.page(2, rows);  // Third page, newest first
+ * @endcode
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "graph.hpp"
+#include "query.hpp"
+
+namespace exeray::event {
+
+/// @brief Key a LiveView is sorted by (ties in EventId order).
+enum class ViewSort : uint8_t {
+    Id,         ///< Arrival order
+    Timestamp,  ///< Event time
+    Pid,        ///< event_pid() of the payload
+};
+
+/// @brief Sort order and page size of a LiveView.
+struct ViewOptions {
+    ViewSort sort = ViewSort::Timestamp;
+    bool descending = false;     ///< Largest key first
+    std::size_t page_size = 50;  ///< Rows per page (0 is treated as 1)
+};
+
+/**
+ * @brief Incrementally maintained query result over one graph.
+ *
+ * Not thread-safe: one thread refreshes and pages a view, while others
+ * push to the graph. Events evicted in ring retention mode leave the view
+ * on the next refresh; after a session reset the view starts over.
+ */
+class LiveView {
+public:
+    LiveView(const EventGraph& graph, const FilterSpec& filter, ViewOptions options = {});
+
+    /// @brief Test the events published since the last refresh.
+    /// @return Number of matches added.
+    std::size_t refresh();
+
+    /// @brief Number of matching events.
+    [[nodiscard]] std::size_t size() const noexcept { return entries_.size(); }
+
+    /// @brief Number of pages (0 if nothing matches).
+    [[nodiscard]] std::size_t pages() const noexcept;
+
+    /**
+     * @brief Project one page of matches, in view order.
+     * @param index Zero-based page number.
+     * @param out Destination; at most page_size rows are written.
+     * @return Number of rows written (0 past the last page).
+     */
+    std::size_t page(std::size_t index, std::span<QueryRow> out) const;
+
+    [[nodiscard]] const FilterSpec& filter() const noexcept { return filter_; }
+    [[nodiscard]] const ViewOptions& options() const noexcept { return options_; }
+
+private:
+    struct Entry {
+        uint64_t key;
+        EventId id;
+
+        friend bool operator<(const Entry& a, const Entry& b) noexcept {
+            return a.key != b.key ? a.key < b.key : a.id < b.id;
+        }
+    };
+
+    /// @brief Sort key of a node under options_.sort.
+    [[nodiscard]] uint64_t key_of(const EventNode& node) const noexcept;
+
+    /// @brief Insert in order; events mostly arrive at the end.
+    void insert(const Entry& entry);
+
+    const EventGraph& graph_;
+    FilterSpec filter_;
+    ViewOptions options_;
+    std::vector<Entry> entries_;  ///< Ascending by (key, id)
+    std::size_t next_ = 0;        ///< Absolute index refresh() resumes at
+    uint64_t epoch_ = 0;          ///< graph_.epoch() when entries_ was last pruned
+};
+
+}  // namespace exeray::event
@@ -0,0 +1,65 @@
+#pragma once
+
+/**
+ * @file log_codec.hpp
+ * @brief Compression of event log blocks.
+ *
+ * Consecutive EventNodes differ in few bytes: IDs step by one, parents are
+ * close to their children, timestamps are near each other and categories,
+ * operations and StringIds repeat. pack_events() turns IDs, parents and
+ * timestamps into deltas from the previous node, then groups byte i of
+ * every node together (byte shuffle), so the repetition is contiguous,
+ * and compresses the result with pack_bytes().
+ *
+ * pack_bytes() is an LZ77 coder in the LZ4 block layout: sequences of
+ * {token, literals, 16-bit match offset, extra match length}, the last one
+ * literals only. It favours speed over ratio, like LZ4: one hash probe per
+ * position, so it keeps up with the writer on one core.
+ *
+ * Packed data does not record its unpacked size; the caller stores it
+ * (the log's block header does) and passes an output of exactly that size.
+ * Unpacking checks every length and offset, so a corrupt block fails
+ * instead of reading or writing out of bounds.
+ */
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "node.hpp"
+
+namespace exeray::event {
+
+/// @brief Upper bound of what packed bytes can unpack to, to reject a
+/// corrupt unpacked size before allocating it.
+[[nodiscard]] constexpr std::uint64_t max_unpacked_size(std::uint64_t packed) noexcept {
+    return packed * 255 + 64;  // A byte of a length run adds at most 255
+}
+
+/// @brief Append the LZ-compressed bytes of data to out.
+void pack_bytes(std::span<const std::uint8_t> data, std::vector<std::uint8_t>& out);
+
+/**
+ * @brief Decompress what pack_bytes() wrote.
+ * @param packed Packed bytes; anything after the last sequence is ignored.
+ * @param out Filled completely; its size is the unpacked size.
+ * @return false if packed is corrupt or does not fill out exactly.
+ */
+[[nodiscard]] bool unpack_bytes(std::span<const std::uint8_t> packed,
+                                std::span<std::uint8_t> out) noexcept;
+
+/**
+ * @brief Append the delta-encoded, shuffled and compressed nodes to out.
+ * @param nodes Bytes of whole EventNodes, at any alignment.
+ */
+void pack_events(std::span<const std::uint8_t> nodes, std::vector<std::uint8_t>& out);
+
+/**
+ * @brief Restore the nodes packed by pack_events().
+ * @param out Filled completely; its size is the node count packed.
+ * @return false if packed is corrupt.
+ */
+[[nodiscard]] bool unpack_events(std::span<const std::uint8_t> packed,
+                                 std::span<EventNode> out);
+
+}  // namespace exeray::event
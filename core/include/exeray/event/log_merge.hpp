@@ -0,0 +1,90 @@
+#pragma once
+
+/**
+ * @file log_merge.hpp
+ * @brief One timeline from the event logs of many hosts.
+ *
+ * merge_event_logs() maps every input with MappedEventLog and writes a
+ * single log holding all their events in timestamp order, read back like
+ * any other log (MappedEventLog, replay_event_log()).
+ *
+ * - Events: a streaming k-way merge over the inputs, a heap of one cursor
+ *   per input. Each input is taken in its own order, so the output is
+ *   as ordered as its inputs (a writer's logs are, up to the merge lag of
+ *   its sessions); ties go to the earlier input. Events are renumbered
+ *   1..N in output order and parents are remapped within their input; a
+ *   parent the input does not hold becomes INVALID_EVENT.
+ * - Strings: every input's entries are folded into one table keyed by
+ *   their text (a hash map over the mapped bytes, nothing copied), and
+ *   each event's StringIds rewritten to the shared IDs.
+ * - Parallelism: the time span is cut into partitions of about equal event
+ *   counts (from the inputs' block directories). Each partition is merged
+ *   on its own, once to number its events and once to write them to a
+ *   part file beside the output; the parts are then appended in order.
+ *
+ * Events are never copied whole: a partition reads only the blocks it
+ * overlaps, in place (packed ones as MappedEventLog unpacks them). The
+ * renumbering keeps 8 bytes per input event until the merge ends.
+ *
+ * PIDs, correlation IDs and timestamps are kept as logged, so they stay
+ * host-local; merge logs of one clock domain (or shift them first) for a
+ * meaningful order.
+ *
+ * Usage example:
+ * @code
+ * ThreadPool pool(8);
+ * const std::vector<std::filesystem::path> hosts = {"a.exrl", "b.exrl"};
+ * auto merged = merge_event_logs(hosts, "fleet.exrl", {.pool = &pool});
+ * @endcode
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+
+namespace exeray {
+class ThreadPool;
+}  // namespace exeray
+
+namespace exeray::event {
+
+/// @brief How merge_event_logs() splits and writes the merge.
+struct LogMergeOptions {
+    /// Merges the time partitions in parallel (nullptr = on the caller).
+    ThreadPool* pool = nullptr;
+
+    /// Time partitions (0 = four per pool worker, or one without a pool).
+    std::size_t partitions = 0;
+
+    /// Write packed blocks (see EventLogWriter::set_compression()).
+    bool compress = false;
+};
+
+/// @brief What merge_event_logs() wrote.
+struct LogMergeStats {
+    std::size_t inputs = 0;             ///< Logs merged
+    std::size_t events = 0;             ///< Events written
+    std::size_t strings = 0;            ///< Entries of the shared string table
+    std::size_t duplicate_strings = 0;  ///< Input entries folded into an equal one
+    std::size_t orphans = 0;            ///< Parents not in their input, now INVALID_EVENT
+    std::size_t partitions = 0;         ///< Time partitions merged
+    std::uint64_t bytes = 0;            ///< Size of the merged log
+};
+
+/**
+ * @brief Merge event logs by timestamp into a new log.
+ *
+ * The output (and its part files, "<output>.part<N>") is replaced. Inputs
+ * ending in a partial block are merged up to it.
+ *
+ * @return nullopt if an input is not an event log of this format and node
+ *         layout, or the output could not be written (nothing is left
+ *         behind then).
+ */
+[[nodiscard]] std::optional<LogMergeStats> merge_event_logs(
+    std::span<const std::filesystem::path> inputs, const std::filesystem::path& output,
+    const LogMergeOptions& options = {});
+
+}  // namespace exeray::event
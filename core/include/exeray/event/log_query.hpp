@@ -0,0 +1,150 @@
+#pragma once
+
+/**
+ * @file log_query.hpp
+ * @brief Queries over many saved event logs at once, on a ThreadPool.
+ *
+ * run_query() and top_counts() answer over one live EventGraph. A week of
+ * captures is hundreds of logs instead; LogQueryExecutor keeps them mapped
+ * (MappedEventLog) and runs a Query over all of them:
+ *
+ * - Planning checks every events block's zone map (Block::may_match():
+ *   time bounds, categories, statuses, PIDs) and drops the blocks that
+ *   cannot match without reading them, and whole logs whose string table
+ *   lacks the text a query requires.
+ * - The surviving blocks are cut into tasks of a few blocks each, spread
+ *   over the pool; each filters its nodes in place and keeps a partial
+ *   result: a count, per-group counts, or its best rows up to the limit.
+ * - The partial results are then merged: counts summed, groups summed and
+ *   ranked, rows merged in order and cut to the limit.
+ *
+ * Tasks share nothing but the read-only logs, so a scan scales with the
+ * pool until the disk stops keeping up.
+ *
+ * StringIds are per log, so a query's FilterSpec::string_id is ignored;
+ * LogQuery::carries names the string by its text and each log resolves it
+ * in its own table. Rows are ordered by timestamp (then log, then ID),
+ * the one order shared by logs of one clock domain.
+ *
+ * Usage example:
+ * @code
+ * LogQueryExecutor logs(&pool);
+ * for (const auto& path : week) {
+ *     logs.add(path);
+ * }
+ * LogQuery query;
+ * query.query.category(Category::Network).remote_port(4444).newest_first().take(100);
+ * const std::vector<LogRow> latest = logs.rows(query);
+ * @endcode
+ *
+ * Thread-safety: add() before querying; the const queries may then run
+ * concurrently.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "mapped_log.hpp"
+#include "query.hpp"
+
+namespace exeray {
+class ThreadPool;
+}  // namespace exeray
+
+namespace exeray::event {
+
+/// @brief A Query over many logs.
+struct LogQuery {
+    Query query;          ///< Filter, order and limit (filter.string_id is ignored)
+    std::string carries;  ///< Require a payload string with this text (empty = any)
+};
+
+/// @brief One result row: the log it came from and its indexed fields.
+struct LogRow {
+    std::uint32_t log = 0;  ///< Index of the log in the executor (add() order)
+    QueryRow row;           ///< IDs and strings are the log's own
+};
+
+/// @brief What a query read and skipped.
+struct LogQueryStats {
+    std::size_t logs_skipped = 0;    ///< Logs without the carried text
+    std::size_t blocks = 0;          ///< Events blocks scanned
+    std::size_t blocks_skipped = 0;  ///< Events blocks their zone map ruled out
+    std::size_t tasks = 0;           ///< Scan tasks run
+    std::uint64_t events = 0;        ///< Events filtered
+};
+
+/**
+ * @brief Parallel executor of queries over a set of saved logs.
+ */
+class LogQueryExecutor {
+public:
+    /// Events blocks per scan task (of up to EventGraph::kSegmentSize events).
+    static constexpr std::size_t kBlocksPerTask = 4;
+
+    /// @param pool Runs the scan tasks (nullptr = on the caller).
+    explicit LogQueryExecutor(ThreadPool* pool = nullptr) noexcept : pool_(pool) {}
+
+    LogQueryExecutor(const LogQueryExecutor&) = delete;
+    LogQueryExecutor& operator=(const LogQueryExecutor&) = delete;
+
+    /**
+     * @brief Map one more log.
+     * @return false if it is not an event log of this format (not added).
+     */
+    bool add(const std::filesystem::path& path);
+
+    /// @brief Number of logs added.
+    [[nodiscard]] std::size_t size() const noexcept { return logs_.size(); }
+
+    /// @brief A log, by its index in add() order (resolve a row's strings here).
+    [[nodiscard]] const MappedEventLog& log(std::size_t index) const { return *logs_[index]; }
+
+    /**
+     * @brief Count all matches (order and limit are ignored).
+     * @param stats Receives what was read and skipped (optional).
+     */
+    [[nodiscard]] std::uint64_t count(const LogQuery& query,
+                                      LogQueryStats* stats = nullptr) const;
+
+    /**
+     * @brief Matching rows in timestamp order (the query's order), up to its limit.
+     * @param stats Receives what was read and skipped (optional).
+     */
+    [[nodiscard]] std::vector<LogRow> rows(const LogQuery& query,
+                                           LogQueryStats* stats = nullptr) const;
+
+    /**
+     * @brief Count matches per group over every log; top_counts() semantics.
+     *
+     * Group values are taken as logged, so a PID or correlation group sums
+     * the hosts that used the same value.
+     *
+     * @param out Destination for the top out.size() groups.
+     * @param stats Receives what was read and skipped (optional).
+     * @return Number of groups written.
+     */
+    std::size_t top_counts(const LogQuery& query, GroupKey key, std::span<GroupCount> out,
+                           LogQueryStats* stats = nullptr) const;
+
+private:
+    /// @brief A run of matching-candidate blocks of one log.
+    struct Task {
+        std::uint32_t log = 0;
+        FilterSpec spec;  ///< The query's filter, string_id resolved for the log
+        std::vector<const MappedEventLog::Block*> blocks;
+    };
+
+    /// @brief Zone-map the blocks of every log and cut the survivors into tasks.
+    [[nodiscard]] std::vector<Task> plan(const LogQuery& query, LogQueryStats& stats) const;
+
+    ThreadPool* pool_;
+    std::vector<std::unique_ptr<MappedEventLog>> logs_;
+};
+
+}  // namespace exeray::event
@@ -0,0 +1,339 @@
+#pragma once
+
+/**
+ * @file mapped_log.hpp
+ * @brief Read-only EventGraph-style access to a saved event log, in place.
+ *
+ * replay_event_log() copies every event into a fresh arena, which takes
+ * seconds for a multi-GB capture. MappedEventLog maps the file instead and
+ * hands out EventViews that point straight into the mapped pages (the log
+ * keeps nodes 64-byte aligned for this). open() only checks the header, so
+ * it returns in milliseconds whatever the file size.
+ *
+ * Indexes are built on first use. The block directory records per events
+ * block its first ID, time bounds and per-category counts, the same sparse
+ * index EventGraph keeps per segment, plus a zone map of its statuses and
+ * PIDs; get() binary searches it, for_each_category()/for_each_in_range()
+ * skip blocks that cannot match, and Block::may_match() answers for a
+ * whole FilterSpec.
+ * Building it reads the log once, so it is saved beside the log as
+ * "<log>.exri" and loaded from there while the log keeps its size. The
+ * string table and the parent and correlation indexes are built in memory
+ * when first needed.
+ *
+ * A compressed log (EventLogWriter::set_compression()) is read the same
+ * way, one block at a time: a packed block is unpacked when first
+ * touched, and kept for the log's lifetime, so get() of one event costs
+ * one block, never the whole log.
+ *
+ * StringIds in the views are the writer's; resolve them with
+ * resolve_string(), not with any live StringPool.
+ *
+ * Usage example:
+ * @code
+ * MappedEventLog log;
+ * if (log.open("capture.exrl")) {
+ *     log.for_each_category(Category::Process, [&](EventView view) {
+ *         show(log.resolve_string(view.payload().process.image_path));
+ *     });
+ * }
+ * @endcode
+ *
+ * Thread-safety: after open(), every const method is safe to call
+ * concurrently; each lazy index is built once.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../platform/mapped_file.hpp"
+#include "columns.hpp"
+#include "event_log.hpp"
+#include "node.hpp"
+
+namespace exeray::event {
+
+/// @brief "EXRI" in the first four bytes of a saved log index.
+inline constexpr std::uint32_t kLogIndexMagic = 0x49525845;
+
+/// @brief Bumped whenever the index layout changes.
+inline constexpr std::uint32_t kLogIndexFormat = 3;
+
+class MappedEventLog {
+public:
+    static constexpr std::size_t kCategoryCount = static_cast<std::size_t>(Category::Count);
+
+    /// @brief One block of the log, as saved in the index file.
+    struct Block {
+        std::uint64_t offset = 0;    ///< File offset of the payload
+        std::uint64_t first_id = 0;  ///< Events: ID of the first node
+        Timestamp low = 0;           ///< Events: smallest timestamp
+        Timestamp high = 0;          ///< Events: largest timestamp
+        LogBlock kind = LogBlock::Events;
+        std::uint32_t count = 0;     ///< Nodes or string entries
+        std::array<std::uint32_t, kCategoryCount> categories{};  ///< Events per category
+        std::uint32_t statuses = 0;  ///< Events: 1u << Status of every event
+        /// Events: Bloom filter of event_pid(), as in SegmentZone
+        std::array<std::uint64_t, SegmentZone::kPidWords> pids{};
+
+        /// @brief Whether some event of the block may match spec (its zone
+        /// map: time bounds, categories, statuses and PIDs).
+        [[nodiscard]] bool may_match(const FilterSpec& spec) const noexcept;
+    };
+
+    MappedEventLog() = default;
+
+    MappedEventLog(const MappedEventLog&) = delete;
+    MappedEventLog& operator=(const MappedEventLog&) = delete;
+
+    /**
+     * @brief Map a log written by EventLogWriter (once per object).
+     * @return false if the file is missing, not an event log of this
+     *         format and node layout, or a log is already open.
+     */
+    bool open(const std::filesystem::path& path);
+
+    /// @brief Number of events in the log.
+    [[nodiscard]] std::size_t count() const;
+
+    /// @brief ID of the first event (INVALID_EVENT if none).
+    [[nodiscard]] EventId oldest_id() const;
+
+    /// @brief ID of the last event (INVALID_EVENT if none).
+    [[nodiscard]] EventId newest_id() const;
+
+    /// @brief Check whether the log holds an event (IDs can have gaps
+    /// where a ring lapped the writer).
+    [[nodiscard]] bool exists(EventId id) const;
+
+    /**
+     * @brief View of an event, in place in the mapping.
+     *
+     * Valid for the lifetime of the log.
+     * @throws std::logic_error if !exists(id), as EventView does for a
+     *         missing node.
+     */
+    [[nodiscard]] EventView get(EventId id) const;
+
+    /// @brief Text of a StringId of this log (empty if unknown).
+    [[nodiscard]] std::string_view resolve_string(StringId id) const;
+
+    /// @brief Visit every string entry of the log as a LogString (in no
+    /// particular order); fn may return false to stop.
+    template <typename F>
+    void for_each_string(F&& fn) const;
+
+    /// @brief Events blocks in ID order, for splitting work over the log.
+    [[nodiscard]] std::span<const Block> event_blocks() const;
+
+    /// @brief Events of one block of event_blocks(), oldest first (empty if
+    /// a packed block is corrupt).
+    [[nodiscard]] std::span<const EventNode> block_events(const Block& block) const;
+
+    /**
+     * @brief Iterate over all events (oldest first).
+     * @tparam F Callable taking EventView; may return false to stop.
+     */
+    template <typename F>
+    void for_each(F&& fn) const;
+
+    /// @brief Iterate over the events of one category (oldest first),
+    /// skipping blocks without any.
+    template <typename F>
+    void for_each_category(Category cat, F&& fn) const;
+
+    /// @brief Iterate over events with timestamps in [from, to] (oldest
+    /// first), skipping blocks outside the range.
+    template <typename F>
+    void for_each_in_range(Timestamp from, Timestamp to, F&& fn) const;
+
+    /// @brief Iterate over direct children of a parent event (newest first).
+    template <typename F>
+    void for_each_child(EventId parent, F&& fn) const;
+
+    /// @brief Iterate over events with a correlation ID (newest first).
+    template <typename F>
+    void for_each_correlation(uint32_t correlation_id, F&& fn) const;
+
+    /// @brief false if the log ends in a partial block (e.g. the writer crashed).
+    [[nodiscard]] bool complete() const;
+
+    /// @brief true if the block directory was loaded from "<log>.exri".
+    [[nodiscard]] bool index_loaded() const;
+
+    /// @brief Check every block's checksum; reads the whole log.
+    [[nodiscard]] bool verify() const;
+
+    /// @brief Mapped bytes of the log.
+    [[nodiscard]] std::size_t size_bytes() const noexcept { return file_.bytes().size(); }
+
+private:
+    /// @brief Events blocks, string blocks and what scanning found.
+    struct Directory {
+        std::vector<Block> events;   ///< Ascending first_id
+        std::vector<Block> strings;
+        std::size_t count = 0;
+        bool complete = true;
+        bool loaded = false;         ///< Read from the index file
+    };
+
+    /// @brief (key, EventId) pairs sorted by key, then ID.
+    using Links = std::vector<std::pair<std::uint64_t, EventId>>;
+
+    [[nodiscard]] const Directory& directory() const;
+
+    /// @brief Node of an event in the mapping (nullptr if not in the log).
+    [[nodiscard]] const EventNode* find(EventId id) const;
+    [[nodiscard]] const Links& children() const;
+    [[nodiscard]] const Links& correlations() const;
+    [[nodiscard]] const std::unordered_map<StringId, LogString>& strings() const;
+
+    /// @brief Scan the log's block headers and events blocks.
+    void scan(Directory& dir) const;
+
+    /// @brief Load the saved index; false if missing or stale.
+    bool load_index(Directory& dir) const;
+
+    /// @brief Save the index (ignored if the directory is not writable).
+    void save_index(const Directory& dir) const;
+
+    void build_links() const;
+
+    /// @brief First node of an events block: in the mapping, or unpacked
+    /// (nullptr if a packed block is corrupt).
+    [[nodiscard]] const EventNode* nodes(const Block& block) const;
+
+    /// @brief Call a visitor; false if it returned false (stop), else true.
+    template <typename F>
+    static bool visit(F& fn, EventView view) {
+        if constexpr (std::is_same_v<std::invoke_result_t<F&, EventView>, bool>) {
+            return fn(view);
+        } else {
+            fn(view);
+            return true;
+        }
+    }
+
+    /// @brief Visit the events of each linked ID of key, newest first.
+    template <typename F>
+    void walk_links(const Links& links, std::uint64_t key, F& fn) const;
+
+    platform::MappedFile file_;
+    std::filesystem::path index_path_;
+
+    mutable std::once_flag directory_once_;
+    mutable Directory directory_;
+    mutable std::once_flag strings_once_;
+    mutable std::unordered_map<StringId, LogString> strings_;
+    mutable std::once_flag links_once_;
+    mutable Links children_;
+    mutable Links correlations_;
+    mutable std::mutex unpacked_mutex_;
+    /// Packed blocks unpacked so far, by payload offset
+    mutable std::unordered_map<std::uint64_t, std::unique_ptr<EventNode[]>> unpacked_;
+    /// Packed strings blocks, unpacked; strings_ views point into them
+    mutable std::vector<std::vector<std::uint8_t>> unpacked_strings_;
+};
+
+// ---------------------------------------------------------------------------
+// Template implementations
+// ---------------------------------------------------------------------------
+
+template <typename F>
+void MappedEventLog::for_each(F&& fn) const {
+    for (const Block& block : directory().events) {
+        const EventNode* first = nodes(block);
+        for (std::uint32_t i = 0; first != nullptr && i < block.count; ++i) {
+            if (!visit(fn, EventView(first[i]))) {
+                return;
+            }
+        }
+    }
+}
+
+template <typename F>
+void MappedEventLog::for_each_string(F&& fn) const {
+    for (const auto& [id, entry] : strings()) {
+        if constexpr (std::is_same_v<std::invoke_result_t<F&, const LogString&>, bool>) {
+            if (!fn(entry)) {
+                return;
+            }
+        } else {
+            fn(entry);
+        }
+    }
+}
+
+template <typename F>
+void MappedEventLog::for_each_category(Category cat, F&& fn) const {
+    const auto c = static_cast<std::size_t>(cat);
+    if (c >= kCategoryCount) {
+        return;
+    }
+    for (const Block& block : directory().events) {
+        if (block.categories[c] == 0) {
+            continue;
+        }
+        const EventNode* first = nodes(block);
+        for (std::uint32_t i = 0; first != nullptr && i < block.count; ++i) {
+            if (first[i].payload.category == cat && !visit(fn, EventView(first[i]))) {
+                return;
+            }
+        }
+    }
+}
+
+template <typename F>
+void MappedEventLog::for_each_in_range(Timestamp from, Timestamp to, F&& fn) const {
+    for (const Block& block : directory().events) {
+        if (block.high < from || block.low > to) {
+            continue;
+        }
+        const EventNode* first = nodes(block);
+        for (std::uint32_t i = 0; first != nullptr && i < block.count; ++i) {
+            const Timestamp t = first[i].timestamp;
+            if (t >= from && t <= to && !visit(fn, EventView(first[i]))) {
+                return;
+            }
+        }
+    }
+}
+
+template <typename F>
+void MappedEventLog::walk_links(const Links& links, std::uint64_t key, F& fn) const {
+    auto begin = std::lower_bound(links.begin(), links.end(), std::pair{key, EventId{0}});
+    auto end = std::upper_bound(begin, links.end(), std::pair{key, ~EventId{0}});
+    while (end != begin) {
+        --end;
+        if (!visit(fn, get(end->second))) {
+            return;
+        }
+    }
+}
+
+template <typename F>
+void MappedEventLog::for_each_child(EventId parent, F&& fn) const {
+    if (parent != INVALID_EVENT) {
+        walk_links(children(), parent, fn);
+    }
+}
+
+template <typename F>
+void MappedEventLog::for_each_correlation(uint32_t correlation_id, F&& fn) const {
+    if (correlation_id != 0) {
+        walk_links(correlations(), correlation_id, fn);
+    }
+}
+
+}  // namespace exeray::event
@@ -88,6 +88,7 @@ public:
     /**
      * @brief Construct a view from an EventNode pointer.
      * @param node Pointer to the event node (must not be null).
+     * @throws std::logic_error if node is null.
      */
     explicit EventView(const EventNode* node)
         : node_(node) {
@@ -96,6 +97,14 @@ public:
         }
     }
 
+    /**
+     * @brief Construct a view of a node the caller already holds.
+     *
+     * Unchecked and noexcept: the graph's iteration builds one view per
+     * visited node and every one of them exists.
+     */
+    explicit EventView(const EventNode& node) noexcept : node_(&node) {}
+
     /// @name Core Accessors
     /// @{
 
@@ -122,6 +131,9 @@ public:
     /// Get the correlation ID for event grouping.
     [[nodiscard]] uint32_t correlation_id() const noexcept { return node_->correlation_id; }
 
+    /// Get the raw payload union (discriminated by category()).
+    [[nodiscard]] const EventPayload& payload() const noexcept { return node_->payload; }
+
     /// @}
 
     /// @name Typed Operation Accessors
@@ -332,6 +344,14 @@ public:
         return node_->payload.clr;
     }
 
+    /// Get manifest provider payload reference (throws on invalid category).
+    [[nodiscard]] const ManifestPayload& as_manifest() const {
+        if (category() != Category::Manifest) [[unlikely]] {
+            throw std::logic_error("Invalid category for as_manifest");
+        }
+        return node_->payload.manifest;
+    }
+
     /// @}
 
     /// @name Utility
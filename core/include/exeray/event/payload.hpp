@@ -8,6 +8,7 @@
  * for efficient, type-safe event data storage.
  */
 
+#include <cstddef>
 #include <cstdint>
 #include <type_traits>
 
@@ -24,7 +25,8 @@ namespace exeray::event {
  * @brief Tagged union for all event payloads.
  *
  * Uses Category as the discriminator tag. Total size is fixed at 32 bytes
- * for cache efficiency and predictable memory layout.
+ * for cache efficiency and predictable memory layout; the rare event with
+ * more data refers to an extension record (see extensions.hpp).
  *
  * Usage example:
  * @code
@@ -36,7 +38,8 @@ namespace exeray::event {
  */
 struct EventPayload {
     Category category;     ///< Discriminator tag indicating active union member
-    uint8_t _pad[7];       ///< Explicit padding to align union at 8 bytes
+    uint8_t _pad[3];       ///< Explicit padding
+    ExtensionId extension; ///< Side record with what does not fit (NO_EXTENSION = none)
 
     union {
         FilePayload file;           ///< Active when category == FileSystem
@@ -55,6 +58,7 @@ struct EventPayload {
         ServicePayload service;     ///< Active when category == Service
         WmiPayload wmi;             ///< Active when category == Wmi
         ClrPayload clr;             ///< Active when category == Clr
+        ManifestPayload manifest;   ///< Active when category == Manifest
     };
 };
 
@@ -66,8 +70,8 @@ static_assert(sizeof(FilePayload) == 24,
               "FilePayload must be 24 bytes");
 static_assert(sizeof(RegistryPayload) == 16,
               "RegistryPayload must be 16 bytes");
-static_assert(sizeof(NetworkPayload) == 20,
-              "NetworkPayload must be 20 bytes");
+static_assert(sizeof(NetworkPayload) == 24,
+              "NetworkPayload must be 24 bytes");
 static_assert(sizeof(ProcessPayload) == 16,
               "ProcessPayload must be 16 bytes");
 static_assert(sizeof(SchedulerPayload) == 16,
@@ -90,13 +94,17 @@ static_assert(sizeof(SecurityPayload) == 24,
               "SecurityPayload must be 24 bytes");
 static_assert(sizeof(ServicePayload) == 20,
               "ServicePayload must be 20 bytes");
-static_assert(sizeof(WmiPayload) == 16,
-              "WmiPayload must be 16 bytes");
+static_assert(sizeof(WmiPayload) == 20,
+              "WmiPayload must be 20 bytes");
 static_assert(sizeof(ClrPayload) == 24,
               "ClrPayload must be 24 bytes");
+static_assert(sizeof(ManifestPayload) == 24,
+              "ManifestPayload must be 24 bytes");
 
 static_assert(sizeof(EventPayload) == 32,
               "EventPayload must be exactly 32 bytes");
+static_assert(offsetof(EventPayload, file) == 8,
+              "The union must stay 8-byte aligned after the extension ID");
 
 // ---------------------------------------------------------------------------
 // Static Assertions - Trivially Copyable
@@ -134,6 +142,8 @@ static_assert(std::is_trivially_copyable_v<WmiPayload>,
               "WmiPayload must be trivially copyable");
 static_assert(std::is_trivially_copyable_v<ClrPayload>,
               "ClrPayload must be trivially copyable");
+static_assert(std::is_trivially_copyable_v<ManifestPayload>,
+              "ManifestPayload must be trivially copyable");
 static_assert(std::is_trivially_copyable_v<EventPayload>,
               "EventPayload must be trivially copyable");
 
@@ -0,0 +1,37 @@
+#pragma once
+
+/**
+ * @file payload_fields.hpp
+ * @brief Names, offsets and kinds of the payload members, by category.
+ *
+ * One table for everything that addresses payload members by name or
+ * flattens them into columns (detection rules, columnar export), so a
+ * member added to a payload is added here once.
+ */
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "payload.hpp"
+
+namespace exeray::event {
+
+/// @brief A payload member, as rules and exports name it.
+struct PayloadField {
+    Category category;
+    std::string_view name;
+    std::uint16_t offset;  ///< From the start of EventPayload
+    std::uint8_t size;     ///< Bytes of an unsigned integer, or of a StringId
+    bool is_string;        ///< StringId resolved through the pool
+};
+
+/// @brief Every member of every payload, grouped by category in
+/// declaration order (padding excluded).
+[[nodiscard]] std::span<const PayloadField> payload_fields() noexcept;
+
+/// @brief Name of a category as rules and exports spell it ("FileSystem";
+/// empty for Count and beyond).
+[[nodiscard]] std::string_view category_name(Category category) noexcept;
+
+}  // namespace exeray::event
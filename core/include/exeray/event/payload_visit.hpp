@@ -0,0 +1,270 @@
+#pragma once
+
+/**
+ * @file payload_visit.hpp
+ * @brief Compile-time dispatch over the payload union by category.
+ *
+ * Each payload struct has a PayloadTraits specialisation naming its
+ * category, its union member, the member holding the attributed process
+ * ID and its StringId members. visit() calls a generic callable with the
+ * active member, so code that handles every category (string collection,
+ * PID extraction, exports) is written once and stays in step with the
+ * payloads:
+ *
+ * @code
+ * visit(payload, [](auto& p) {
+ *     using Traits = PayloadTraits<std::remove_cvref_t<decltype(p)>>;
+ *     ...
+ * });
+ * @endcode
+ *
+ * Adding a payload means a union member, a Category, a PayloadTypes entry
+ * and a PayloadTraits specialisation; the static_asserts below and in
+ * payload_fields.cpp reject a mismatch.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "payload.hpp"
+
+namespace exeray::event {
+
+/// @brief Payload structs in Category order.
+using PayloadTypes =
+    std::tuple<FilePayload, RegistryPayload, NetworkPayload, ProcessPayload, SchedulerPayload,
+               InputPayload, ImagePayload, ThreadPayload, MemoryPayload, ScriptPayload,
+               AmsiPayload, DnsPayload, SecurityPayload, ServicePayload, WmiPayload, ClrPayload,
+               ManifestPayload>;
+
+static_assert(std::tuple_size_v<PayloadTypes> == static_cast<std::size_t>(Category::Count),
+              "PayloadTypes must list one struct per Category");
+
+/// @brief Payload struct of a category.
+template <Category C>
+using PayloadType = std::tuple_element_t<static_cast<std::size_t>(C), PayloadTypes>;
+
+/**
+ * @brief Per-payload facts for generic code.
+ *
+ * Every specialisation provides:
+ * - `category`: the Category tag of the struct;
+ * - `get(payload)`: the union member (const follows the argument);
+ * - `pid`: member pointer to the attributed process ID, or nullptr;
+ * - `strings`: tuple of member pointers to StringId members;
+ * - `string_count(p)`: how many leading members of `strings` hold
+ *   StringIds for this event.
+ */
+template <typename T>
+struct PayloadTraits;
+
+namespace detail {
+
+/// @brief Defaults of PayloadTraits: no PID, strings always valid.
+struct PayloadTraitsBase {
+    static constexpr std::nullptr_t pid = nullptr;
+
+    template <typename T>
+    static constexpr std::size_t string_count(const T&) noexcept {
+        return SIZE_MAX;
+    }
+};
+
+}  // namespace detail
+
+#define EXERAY_PAYLOAD_TRAITS(cat, member)              \
+    static constexpr Category category = Category::cat; \
+    template <typename P>                               \
+    static constexpr auto& get(P& payload) noexcept {   \
+        return payload.member;                          \
+    }
+
+template <>
+struct PayloadTraits<FilePayload> : detail::PayloadTraitsBase {
+    EXERAY_PAYLOAD_TRAITS(FileSystem, file)
+    static constexpr std::tuple strings{&FilePayload::path};
+};
+
+template <>
+struct PayloadTraits<RegistryPayload> : detail::PayloadTraitsBase {
+    EXERAY_PAYLOAD_TRAITS(Registry, registry)
+    static constexpr std::tuple strings{&RegistryPayload::key_path, &RegistryPayload::value_name};
+};
+
+template <>
+struct PayloadTraits<NetworkPayload> : detail::PayloadTraitsBase {
+    EXERAY_PAYLOAD_TRAITS(Network, network)
+    static constexpr std::tuple strings{&NetworkPayload::remote_domain,
+                                        &NetworkPayload::local_addr,
+                                        &NetworkPayload::remote_addr};
+
+    /// Addresses are StringIds only for IPv6 (IPv4 is stored inline).
+    static constexpr std::size_t string_count(const NetworkPayload& p) noexcept {
+        return p.family == kAddressIPv6 ? 3 : 1;
+    }
+};
+
+template <>
+struct PayloadTraits<ProcessPayload> : detail::PayloadTraitsBase {
+    EXERAY_PAYLOAD_TRAITS(Process, process)
+    static constexpr auto pid = &ProcessPayload::pid;
+    static constexpr std::tuple strings{&ProcessPayload::image_path,
+                                        &ProcessPayload::command_line};
+};
+
+template <>
+struct PayloadTraits<SchedulerPayload> : detail::PayloadTraitsBase {
+    EXERAY_PAYLOAD_TRAITS(Scheduler, scheduler)
+    static constexpr std::tuple strings{&SchedulerPayload::task_name, &SchedulerPayload::action};
+};
+
+template <>
+struct PayloadTraits<InputPayload> : detail::PayloadTraitsBase {
+    EXERAY_PAYLOAD_TRAITS(Input, input)
+    static constexpr std::tuple<> strings{};
+};
+
+template <>
+struct PayloadTraits<ImagePayload> : detail::PayloadTraitsBase {
+    EXERAY_PAYLOAD_TRAITS(Image, image)
+    static constexpr auto pid = &ImagePayload::process_id;
+    static constexpr std::tuple strings{&ImagePayload::image_path};
+};
+
+template <>
+struct PayloadTraits<ThreadPayload> : detail::PayloadTraitsBase {
+    EXERAY_PAYLOAD_TRAITS(Thread, thread)
+    static constexpr auto pid = &ThreadPayload::process_id;
+    static constexpr std::tuple<> strings{};
+};
+
+template <>
+struct PayloadTraits<MemoryPayload> : detail::PayloadTraitsBase {
+    EXERAY_PAYLOAD_TRAITS(Memory, memory)
+    static constexpr auto pid = &MemoryPayload::process_id;
+    static constexpr std::tuple<> strings{};
+};
+
+template <>
+struct PayloadTraits<ScriptPayload> : detail::PayloadTraitsBase {
+    EXERAY_PAYLOAD_TRAITS(Script, script)
+    static constexpr std::tuple strings{&ScriptPayload::script_block, &ScriptPayload::context};
+};
+
+template <>
+struct PayloadTraits<AmsiPayload> : detail::PayloadTraitsBase {
+    EXERAY_PAYLOAD_TRAITS(Amsi, amsi)
+    static constexpr std::tuple strings{&AmsiPayload::content, &AmsiPayload::app_name};
+};
+
+template <>
+struct PayloadTraits<DnsPayload> : detail::PayloadTraitsBase {
+    EXERAY_PAYLOAD_TRAITS(Dns, dns)
+    static constexpr std::tuple strings{&DnsPayload::domain};
+};
+
+template <>
+struct PayloadTraits<SecurityPayload> : detail::PayloadTraitsBase {
+    EXERAY_PAYLOAD_TRAITS(Security, security)
+    static constexpr auto pid = &SecurityPayload::process_id;
+    static constexpr std::tuple strings{&SecurityPayload::subject_user,
+                                        &SecurityPayload::target_user,
+                                        &SecurityPayload::command_line};
+};
+
+template <>
+struct PayloadTraits<ServicePayload> : detail::PayloadTraitsBase {
+    EXERAY_PAYLOAD_TRAITS(Service, service)
+    static constexpr std::tuple strings{&ServicePayload::service_name,
+                                        &ServicePayload::service_path};
+};
+
+template <>
+struct PayloadTraits<WmiPayload> : detail::PayloadTraitsBase {
+    EXERAY_PAYLOAD_TRAITS(Wmi, wmi)
+    static constexpr std::tuple strings{&WmiPayload::wmi_namespace, &WmiPayload::query,
+                                        &WmiPayload::target_host};
+};
+
+template <>
+struct PayloadTraits<ClrPayload> : detail::PayloadTraitsBase {
+    EXERAY_PAYLOAD_TRAITS(Clr, clr)
+    static constexpr std::tuple strings{&ClrPayload::assembly_name, &ClrPayload::method_name};
+};
+
+template <>
+struct PayloadTraits<ManifestPayload> : detail::PayloadTraitsBase {
+    EXERAY_PAYLOAD_TRAITS(Manifest, manifest)
+    static constexpr auto pid = &ManifestPayload::process_id;
+    static constexpr std::tuple strings{&ManifestPayload::text, &ManifestPayload::detail};
+};
+
+#undef EXERAY_PAYLOAD_TRAITS
+
+namespace detail {
+
+template <std::size_t... I>
+constexpr bool traits_in_order(std::index_sequence<I...>) noexcept {
+    return ((PayloadTraits<std::tuple_element_t<I, PayloadTypes>>::category ==
+             static_cast<Category>(I)) &&
+            ...);
+}
+
+static_assert(traits_in_order(std::make_index_sequence<std::tuple_size_v<PayloadTypes>>{}),
+              "PayloadTraits<T>::category must match the position of T in PayloadTypes");
+
+template <typename P, typename F, std::size_t... I>
+constexpr bool visit_payload(P& payload, F& fn, std::index_sequence<I...>) {
+    const auto index = static_cast<std::size_t>(payload.category);
+    return ((index == I &&
+             (fn(PayloadTraits<std::tuple_element_t<I, PayloadTypes>>::get(payload)), true)) ||
+            ...);
+}
+
+}  // namespace detail
+
+/**
+ * @brief Call fn with the active union member of payload.
+ * @param payload EventPayload, const or not.
+ * @param fn Callable accepting every payload struct (typically a generic lambda).
+ * @return false without calling fn if the category is out of range.
+ */
+template <typename P, typename F>
+    requires std::is_same_v<std::remove_const_t<P>, EventPayload>
+constexpr bool visit(P& payload, F&& fn) {
+    return detail::visit_payload(payload, fn,
+                                 std::make_index_sequence<std::tuple_size_v<PayloadTypes>>{});
+}
+
+/**
+ * @brief Call fn on every StringId member of a payload.
+ *
+ * fn receives a StringId& (const for a const payload). Members that hold
+ * no StringId for this event (IPv4 network addresses) are skipped.
+ */
+template <typename P, typename F>
+    requires std::is_same_v<std::remove_const_t<P>, EventPayload>
+constexpr void for_each_string(P& payload, F&& fn) {
+    visit(payload, [&fn](auto& p) {
+        using Traits = PayloadTraits<std::remove_cvref_t<decltype(p)>>;
+        const std::size_t count = Traits::string_count(p);
+        std::size_t index = 0;
+        std::apply([&](auto... member) { ((index++ < count && (fn(p.*member), true)), ...); },
+                   Traits::strings);
+    });
+}
+
+/// @brief Whether a payload struct carries the PID of the process it is attributed to.
+template <typename T>
+inline constexpr bool payload_has_pid =
+    !std::is_null_pointer_v<std::remove_const_t<decltype(PayloadTraits<T>::pid)>>;
+
+/// @brief Number of StringId members of a payload struct.
+template <typename T>
+inline constexpr std::size_t payload_string_count =
+    std::tuple_size_v<std::remove_const_t<decltype(PayloadTraits<T>::strings)>>;
+
+}  // namespace exeray::event
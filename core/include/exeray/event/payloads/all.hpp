@@ -21,3 +21,4 @@
 #include "service.hpp"
 #include "wmi.hpp"
 #include "clr.hpp"
+#include "manifest.hpp"
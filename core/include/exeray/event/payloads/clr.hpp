@@ -15,14 +15,17 @@ namespace exeray::event {
  *
  * Contains .NET assembly and method info for malware detection.
  * Used for detecting in-memory assembly loading and obfuscated methods.
+ * JIT events of one module are folded into periodic summaries (see
+ * etw/jit_aggregator.hpp); methods counts the compilations one stands for.
  */
 struct ClrPayload {
-    StringId assembly_name;  ///< Full assembly name (interned)
+    StringId assembly_name;  ///< Full assembly name, or module path (interned)
     StringId method_name;    ///< Method name for JIT events (interned)
-    uint64_t load_address;   ///< Base load address in process
+    uint64_t load_address;   ///< Base load address; CLR ModuleID for module and JIT events
     uint8_t is_dynamic;      ///< 1 if loaded from memory (no file!)
     uint8_t is_suspicious;   ///< 1 if suspicious pattern detected
     uint8_t _pad[2];         ///< Explicit padding for alignment
+    uint32_t methods;        ///< Methods JIT-compiled (MethodJit: 1, or a summary's count)
 };
 
 }  // namespace exeray::event
@@ -16,10 +16,10 @@ namespace exeray::event {
  * Contains file path, size, and attributes for file/directory events.
  */
 struct FilePayload {
-    StringId path;         ///< Interned file/directory path
+    StringId path;         ///< Interned file/directory path (path node)
     uint64_t size;         ///< File size in bytes
     uint32_t attributes;   ///< File attributes (platform-specific)
-    uint32_t _pad;         ///< Explicit padding for 8-byte alignment
+    uint32_t ops;          ///< Reads or writes merged into the event (0 or 1 = one)
 };
 
 }  // namespace exeray::event
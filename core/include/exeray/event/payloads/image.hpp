@@ -17,7 +17,7 @@ namespace exeray::event {
  * Used for detecting process injection via LoadLibrary/LdrLoadDll.
  */
 struct ImagePayload {
-    StringId image_path;     ///< Interned DLL/EXE path
+    StringId image_path;     ///< Interned DLL/EXE path (path node)
     uint32_t process_id;     ///< Target process ID
     uint64_t base_address;   ///< Load address in target process
     uint32_t size;           ///< Image size in bytes (max 4GB)
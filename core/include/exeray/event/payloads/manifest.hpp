@@ -0,0 +1,33 @@
+#pragma once
+
+/**
+ * @file manifest.hpp
+ * @brief Payload of events from runtime-registered manifest providers.
+ */
+
+#include <cstdint>
+#include "../types.hpp"
+
+namespace exeray::event {
+
+/**
+ * @brief Payload for events of a provider registered at runtime.
+ *
+ * Providers without a parser of their own (see etw/manifest_providers.hpp)
+ * are decoded from their manifest; the properties their registration
+ * projects land in text, detail and value, and up to four more integers
+ * in a ManifestValuesExtension record. ParsedEvent::operation carries the
+ * record's opcode.
+ */
+struct ManifestPayload {
+    StringId text;         ///< ManifestSlot::Text (interned, INVALID_STRING = none)
+    StringId detail;       ///< ManifestSlot::Detail (interned, INVALID_STRING = none)
+    uint32_t process_id;   ///< Process that logged the event
+    uint32_t value;        ///< ManifestSlot::Value (0 = none)
+    uint16_t provider;     ///< Registration index (etw::ManifestProviders)
+    uint16_t event_id;     ///< EventDescriptor.Id
+    uint8_t version;       ///< EventDescriptor.Version
+    uint8_t _pad[3];       ///< Explicit padding for alignment
+};
+
+}  // namespace exeray::event
@@ -13,16 +13,26 @@ namespace exeray::event {
 /**
  * @brief Payload for network operations.
  *
- * Contains local/remote addresses, ports, byte count, and protocol.
+ * Contains local/remote addresses, ports, byte count, and protocol. IPv6
+ * addresses do not fit: with family == kAddressIPv6 the address fields hold
+ * the StringId of their canonical text instead (see etw/ip_address.hpp).
+ * remote_domain is the name the process looked up before connecting to an
+ * IPv4 remote_addr, filled in at ingest from DNS responses (etw/domain_map.hpp).
  */
 struct NetworkPayload {
-    uint32_t local_addr;   ///< Local IPv4 address
-    uint32_t remote_addr;  ///< Remote IPv4 address
-    uint16_t local_port;   ///< Local port number
-    uint16_t remote_port;  ///< Remote port number
-    uint32_t bytes;        ///< Number of bytes transferred
-    uint8_t protocol;      ///< Protocol type (TCP=6, UDP=17)
-    uint8_t _pad[3];       ///< Explicit padding for 4-byte alignment
+    uint32_t local_addr;     ///< Local IPv4 address, or IPv6 text StringId
+    uint32_t remote_addr;    ///< Remote IPv4 address, or IPv6 text StringId
+    uint16_t local_port;     ///< Local port number
+    uint16_t remote_port;    ///< Remote port number
+    uint32_t bytes;          ///< Number of bytes transferred
+    uint8_t protocol;        ///< Protocol type (TCP=6, UDP=17)
+    uint8_t family;          ///< kAddressIPv4 (or 0, unknown) or kAddressIPv6
+    uint8_t _pad[2];         ///< Explicit padding for 4-byte alignment
+    StringId remote_domain;  ///< Domain remote_addr was resolved from (INVALID_STRING = none)
 };
 
+/// NetworkPayload::family values (the Windows AF_* constants).
+inline constexpr uint8_t kAddressIPv4 = 2;
+inline constexpr uint8_t kAddressIPv6 = 23;
+
 }  // namespace exeray::event
@@ -16,7 +16,7 @@ namespace exeray::event {
  * Contains registry key path, value name, type, and data size.
  */
 struct RegistryPayload {
-    StringId key_path;     ///< Interned registry key path
+    StringId key_path;     ///< Interned registry key path (path node)
     StringId value_name;   ///< Interned value name
     uint32_t value_type;   ///< Registry value type (REG_SZ, REG_DWORD, etc.)
     uint32_t data_size;    ///< Size of value data in bytes
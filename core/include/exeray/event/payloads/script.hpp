@@ -21,7 +21,9 @@ struct ScriptPayload {
     StringId context;        ///< Host application, RunspaceId
     uint32_t sequence;       ///< Sequence number for multi-part scripts
     uint8_t is_suspicious;   ///< 1 if dangerous patterns detected
-    uint8_t _pad[3];         ///< Explicit padding for alignment
+    uint8_t is_repeat;       ///< 1 if the content was logged before; script_block
+                             ///< is then the first occurrence's string
+    uint8_t _pad[2];         ///< Explicit padding for alignment
 };
 
 }  // namespace exeray::event
@@ -22,7 +22,11 @@ struct ThreadPayload {
     uint64_t start_address;  ///< Thread entry point address
     uint32_t creator_pid;    ///< Creator process ID (who created the thread)
     uint8_t is_remote;       ///< 1 if remote thread injection detected
-    uint8_t _pad[3];         ///< Explicit padding for alignment
+    uint8_t start_region;    ///< etw::RegionFlags of the tracked allocation
+                             ///< holding start_address (0 = none)
+    uint8_t start_unbacked;  ///< 1 if start_address lies outside every known
+                             ///< module of the process
+    uint8_t _pad[1];         ///< Explicit padding for alignment
 };
 
 }  // namespace exeray::event
@@ -16,6 +16,10 @@ namespace exeray::event {
  * Contains WMI activity details for attack detection including
  * lateral movement, persistence via Event Subscriptions, and
  * fileless execution via Win32_Process.Create.
+ *
+ * Management agents repeat the same operation every few seconds; the
+ * repeats of one client are counted into a summary by WmiAggregator
+ * (etw/wmi_aggregator.hpp).
  */
 struct WmiPayload {
     StringId wmi_namespace;  ///< root\cimv2, etc.
@@ -24,6 +28,7 @@ struct WmiPayload {
     uint8_t is_remote;       ///< 1 if not localhost
     uint8_t is_suspicious;   ///< 1 if dangerous pattern
     uint8_t _pad[2];         ///< Explicit padding
+    uint32_t count;          ///< Operations it stands for (1, or a summary's count)
 };
 
 }  // namespace exeray::event
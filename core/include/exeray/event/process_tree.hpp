@@ -0,0 +1,149 @@
+#pragma once
+
+/// @file process_tree.hpp
+/// @brief Materialized process tree keyed by process incarnation.
+///
+/// Walking parent_id through the graph answers "who started this process"
+/// one event at a time and cannot answer "what did it start". ProcessTree
+/// keeps the tree itself: one node per incarnation, identified by its
+/// ProcessCreate event (unique even when the PID is reused), with child
+/// and sibling links, a binary-lifting table for common-ancestor queries,
+/// and event counts that are added along the ancestor path as events are
+/// pushed, so a subtree's count is one read.
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "types.hpp"
+
+namespace exeray::event {
+
+struct PendingEvent;
+
+/// @brief One process incarnation and its counts.
+struct ProcessTreeNode {
+    EventId create = INVALID_EVENT;  ///< ProcessCreate event (node key)
+    EventId parent = INVALID_EVENT;  ///< Parent's create event (INVALID_EVENT = root)
+    uint32_t pid = 0;
+    uint32_t depth = 0;               ///< 0 for roots
+    Timestamp start = 0;
+    Timestamp stop = 0;               ///< 0 = still running
+    std::uint64_t events = 0;         ///< Correlated events of this process
+    std::uint64_t subtree_events = 0; ///< events of this process and all descendants
+};
+
+/**
+ * @brief Parent/child adjacency of every process seen in a session.
+ *
+ * Costs: add() and stop() O(1); count() O(depth) per run of
+ * events of one process; node(), subtree_events() O(1);
+ * common_ancestor() O(log depth); ancestors(), children() and
+ * descendants() linear in what they return.
+ *
+ * Bounded: at most kMaxNodes nodes; later creates are not added and their
+ * events count nowhere.
+ *
+ * Thread-safety: add() takes an exclusive lock; everything else takes the
+ * shared lock, count() and stop() update atomics under it.
+ */
+class ProcessTree {
+public:
+    static constexpr std::size_t kMaxNodes = std::size_t{1} << 20;
+
+    ProcessTree() = default;
+    ProcessTree(const ProcessTree&) = delete;
+    ProcessTree& operator=(const ProcessTree&) = delete;
+
+    /**
+     * @brief Add a process incarnation.
+     * @param create Its ProcessCreate event.
+     * @param parent Parent's ProcessCreate event; unknown parents make a root.
+     * @param pid Process ID.
+     * @param start Create timestamp.
+     */
+    void add(EventId create, EventId parent, uint32_t pid, Timestamp start);
+
+    /// @brief Mark a process as terminated at time at.
+    void stop(EventId create, Timestamp at);
+
+    /**
+     * @brief Count resolved events against the process each belongs to.
+     *
+     * An event belongs to the process whose create event is its parent
+     * (for process events, the creating parent).
+     */
+    void count(std::span<const PendingEvent> events);
+
+    [[nodiscard]] std::optional<ProcessTreeNode> node(EventId create) const;
+
+    /// @brief Parent first, then up to the root.
+    [[nodiscard]] std::vector<ProcessTreeNode> ancestors(EventId create) const;
+
+    /// @brief Direct children in creation order.
+    [[nodiscard]] std::vector<ProcessTreeNode> children(EventId create) const;
+
+    /**
+     * @brief The subtree below create in pre-order (parents before children).
+     * @param create Subtree root, excluded; INVALID_EVENT = the whole forest.
+     * @param max_nodes Most nodes to return.
+     */
+    [[nodiscard]] std::vector<ProcessTreeNode> descendants(
+        EventId create, std::size_t max_nodes = kMaxNodes) const;
+
+    /// @brief Events of create and all its descendants (0 if unknown).
+    [[nodiscard]] std::uint64_t subtree_events(EventId create) const;
+
+    /// @brief Deepest process that is an ancestor of (or equal to) both;
+    /// INVALID_EVENT if they are in different trees or unknown.
+    [[nodiscard]] EventId common_ancestor(EventId a, EventId b) const;
+
+    [[nodiscard]] std::size_t size() const;
+
+    void clear();
+
+private:
+    static constexpr uint32_t kNone = 0xFFFFFFFF;
+
+    /// Binary-lifting levels: depths up to 2^kJumps - 1 are exact.
+    static constexpr std::size_t kJumps = 16;
+
+    struct Node {
+        EventId create = INVALID_EVENT;
+        uint32_t pid = 0;
+        uint32_t parent = kNone;
+        uint32_t first_child = kNone;
+        uint32_t last_child = kNone;
+        uint32_t next_sibling = kNone;
+        uint32_t depth = 0;
+        Timestamp start = 0;
+        std::atomic<Timestamp> stop{0};
+        std::atomic<std::uint64_t> events{0};
+        std::atomic<std::uint64_t> subtree{0};
+        std::array<uint32_t, kJumps> up{};  ///< up[k] = 2^k-th ancestor or kNone
+    };
+
+    [[nodiscard]] uint32_t index_of(EventId create) const noexcept;
+    [[nodiscard]] ProcessTreeNode view(uint32_t index) const;
+
+    /// @brief Ancestor of index depth levels up (kNone past the root).
+    [[nodiscard]] uint32_t lift(uint32_t index, uint32_t levels) const noexcept;
+
+    /// @brief Add n events to index and every ancestor.
+    void add_events(uint32_t index, std::uint64_t n) noexcept;
+
+    mutable std::shared_mutex mutex_;
+    std::deque<Node> nodes_;  ///< Never relocated, so readers can keep indexes
+    std::unordered_map<EventId, uint32_t> index_;
+    uint32_t first_root_ = kNone;
+    uint32_t last_root_ = kNone;
+};
+
+}  // namespace exeray::event
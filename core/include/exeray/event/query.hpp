@@ -0,0 +1,318 @@
+#pragma once
+
+/**
+ * @file query.hpp
+ * @brief Composable, index-aware queries over an EventGraph.
+ *
+ * A Query is a FilterSpec plus a result order and a limit. Execution picks
+ * one access path per query (the correlation chain, the per-category index
+ * or a time-pruned filter scan), pushes the remaining predicates down into
+ * it and stops as soon as the limit is reached. Results stream into a
+ * caller-provided buffer, so repeated queries (e.g. on every UI refresh)
+ * allocate nothing beyond what NewestFirst ordering needs.
+ *
+ * Usage example:
+ * @code
+ * // Files written by one execution chain in the last minute, newest first
+ * Query q = Query{}
+ *               .category(Category::FileSystem)
+ *               .operation(static_cast<uint8_t>(FileOp::Write))
+ *               .correlation(correlation_id)
+ *               .since(now - 60'000'000'000ULL)
+ *               .newest_first();
+ * std::array<QueryRow, 64> rows;
+ * std::size_t n = run_query(graph, q, rows);
+ * @endcode
+ */
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "columns.hpp"
+#include "graph.hpp"
+
+namespace exeray::event {
+
+/// @brief Result order of a query.
+enum class QueryOrder : uint8_t {
+    OldestFirst,  ///< Ascending EventId
+    NewestFirst   ///< Descending EventId
+};
+
+/// @brief Access path chosen for a query.
+enum class QueryPlan : uint8_t {
+    Empty,        ///< Provably no results (empty time range or zero limit)
+    Correlation,  ///< Walk the correlation chain
+    Category,     ///< Walk the per-category index
+    Scan          ///< Filter scan over segments overlapping the time range
+};
+
+/**
+ * @brief Declarative event query.
+ *
+ * Builders narrow the filter; every field left untouched matches anything.
+ */
+struct Query {
+    FilterSpec filter;
+    QueryOrder order = QueryOrder::OldestFirst;
+    std::size_t limit = std::numeric_limits<std::size_t>::max();
+
+    /// @brief Add a category to the accepted set.
+    Query& category(Category cat) noexcept {
+        filter.with_category(cat);
+        return *this;
+    }
+
+    /// @brief Require an operation code.
+    Query& operation(uint8_t op) noexcept {
+        filter.operation = op;
+        return *this;
+    }
+
+    /// @brief Add a status to the accepted set.
+    Query& status(Status st) noexcept {
+        filter.with_status(st);
+        return *this;
+    }
+
+    /// @brief Require a process ID (see event_pid()).
+    Query& pid(uint32_t value) noexcept {
+        filter.pid = value;
+        return *this;
+    }
+
+    /// @brief Require a network remote port.
+    Query& remote_port(uint16_t port) noexcept {
+        filter.remote_port = port;
+        return *this;
+    }
+
+    /// @brief Require a correlation ID.
+    Query& correlation(uint32_t id) noexcept {
+        filter.correlation_id = id;
+        return *this;
+    }
+
+    /// @brief Require a payload string field holding id (see carries_string()).
+    Query& carries(StringId id) noexcept {
+        filter.string_id = id;
+        return *this;
+    }
+
+    /// @brief Restrict timestamps to [from, to].
+    Query& between(Timestamp from, Timestamp to) noexcept {
+        filter.from = from;
+        filter.to = to;
+        return *this;
+    }
+
+    /// @brief Restrict timestamps to [from, +inf).
+    Query& since(Timestamp from) noexcept {
+        filter.from = from;
+        return *this;
+    }
+
+    /// @brief Return the newest matches first.
+    Query& newest_first() noexcept {
+        order = QueryOrder::NewestFirst;
+        return *this;
+    }
+
+    /// @brief Return at most n matches.
+    Query& take(std::size_t n) noexcept {
+        limit = n;
+        return *this;
+    }
+};
+
+/// @brief Projection of the indexed fields of one event.
+struct QueryRow {
+    EventId id;
+    Timestamp timestamp;
+    uint32_t pid;             ///< event_pid() of the payload
+    uint32_t correlation_id;
+    uint16_t remote_port;     ///< event_remote_port() of the payload
+    Category category;
+    uint8_t operation;
+    Status status;
+};
+
+/// @brief Field an aggregation groups by.
+enum class GroupKey : uint8_t {
+    Pid,          ///< event_pid()
+    RemotePort,   ///< event_remote_port()
+    Category,
+    Operation,
+    Correlation
+};
+
+/// @brief One group of an aggregation result.
+struct GroupCount {
+    uint32_t key;        ///< Group value (enum keys cast to uint32_t)
+    std::size_t count;   ///< Matching events in the group
+};
+
+/**
+ * @brief Project a view onto the indexed fields.
+ * @param view Event to project.
+ * @return Row with the same field values.
+ */
+[[nodiscard]] QueryRow project(const EventView& view) noexcept;
+
+/**
+ * @brief Value of a group key for one event.
+ * @return The key's value, 0 if the event has none.
+ */
+[[nodiscard]] uint32_t group_value(const EventView& view, GroupKey key) noexcept;
+
+/// @brief Whether events without a value for key (0) still form a group.
+[[nodiscard]] bool group_counts_zero(GroupKey key) noexcept;
+
+/**
+ * @brief Choose the access path for a query.
+ *
+ * A correlation predicate always wins: chains hold only matching events.
+ * A single-category filter uses the category index unless the time range
+ * prunes the scan to fewer candidates, weighted for the index's random
+ * node accesses. Everything else is a filter scan.
+ *
+ * @param graph Graph to plan against (reads index sizes only).
+ * @param query Query to plan.
+ * @return Chosen plan.
+ */
+[[nodiscard]] QueryPlan plan_query(const EventGraph& graph, const Query& query) noexcept;
+
+/**
+ * @brief Visit matching events in query order until the limit.
+ *
+ * @tparam F Callable taking EventView; may return false to stop early.
+ * @param graph Graph to query.
+ * @param query Query to run.
+ * @param fn Function to call for each result.
+ * @return Number of events visited.
+ */
+template <typename F>
+std::size_t for_each_match(const EventGraph& graph, const Query& query, F&& fn);
+
+/**
+ * @brief Run a query into a caller-provided ID buffer.
+ * @param graph Graph to query.
+ * @param query Query to run; out.size() further caps its limit.
+ * @param out Destination buffer.
+ * @return Number of IDs written.
+ */
+std::size_t run_query(const EventGraph& graph, const Query& query,
+                      std::span<EventId> out);
+
+/**
+ * @brief Run a query into a caller-provided row buffer.
+ * @param graph Graph to query.
+ * @param query Query to run; out.size() further caps its limit.
+ * @param out Destination buffer.
+ * @return Number of rows written.
+ */
+std::size_t run_query(const EventGraph& graph, const Query& query,
+                      std::span<QueryRow> out);
+
+/**
+ * @brief Count matches per group and return the largest groups.
+ *
+ * Order and limit of the query are ignored; every match is counted. Groups
+ * are sorted by descending count, ties by ascending key. Events without a
+ * value for the key (pid, port or correlation 0) are not counted.
+ *
+ * @param graph Graph to query.
+ * @param query Query selecting the events to aggregate.
+ * @param key Field to group by.
+ * @param out Destination for the top out.size() groups.
+ * @return Number of groups written.
+ */
+std::size_t top_counts(const EventGraph& graph, const Query& query, GroupKey key,
+                       std::span<GroupCount> out);
+
+// =============================================================================
+// Template Implementation
+// =============================================================================
+
+template <typename F>
+std::size_t for_each_match(const EventGraph& graph, const Query& query, F&& fn) {
+    const QueryPlan plan = plan_query(graph, query);
+    if (plan == QueryPlan::Empty) {
+        return 0;
+    }
+    const FilterSpec& spec = query.filter;
+    const std::size_t limit = query.limit;
+    std::size_t emitted = 0;
+
+    const auto emit = [&fn, &emitted, limit](const EventView& view) {
+        ++emitted;
+        if constexpr (std::is_same_v<std::invoke_result_t<F&, EventView>, bool>) {
+            return fn(view) && emitted < limit;
+        } else {
+            fn(view);
+            return emitted < limit;
+        }
+    };
+
+    if (plan == QueryPlan::Correlation) {
+        // Chains run newest first
+        if (query.order == QueryOrder::NewestFirst) {
+            graph.for_each_correlation(spec.correlation_id, [&](EventView view) {
+                return !spec.matches(view) || emit(view);
+            });
+            return emitted;
+        }
+        std::vector<EventView> chain;
+        graph.for_each_correlation(spec.correlation_id, [&](EventView view) {
+            if (spec.matches(view)) {
+                chain.push_back(view);
+            }
+        });
+        // The oldest limit matches are at the back
+        for (auto it = chain.rbegin(); it != chain.rend() && emit(*it); ++it) {
+        }
+        return emitted;
+    }
+
+    const auto walk = [&](auto&& visitor) {
+        if (plan == QueryPlan::Category) {
+            graph.for_each_category(
+                static_cast<Category>(std::countr_zero(spec.categories)),
+                [&](EventView view) { return !spec.matches(view) || visitor(view); });
+        } else {
+            graph.for_each_where(spec, visitor);
+        }
+    };
+
+    if (query.order == QueryOrder::OldestFirst) {
+        walk(emit);
+        return emitted;
+    }
+
+    // NewestFirst over oldest-first access paths: keep the last limit
+    // matches in a ring, then emit them backwards
+    std::vector<EventView> ring;
+    std::size_t seen = 0;
+    walk([&](EventView view) {
+        if (ring.size() < limit) {
+            ring.push_back(view);
+        } else {
+            ring[seen % limit] = view;
+        }
+        ++seen;
+        return true;
+    });
+    for (std::size_t i = 0; i < ring.size(); ++i) {
+        if (!emit(ring[(seen - 1 - i) % ring.size()])) {
+            break;
+        }
+    }
+    return emitted;
+}
+
+}  // namespace exeray::event
@@ -0,0 +1,199 @@
+#pragma once
+
+/**
+ * @file retained_events.hpp
+ * @brief Long-term tier of a ring-mode graph: evicted events worth keeping.
+ *
+ * Ring retention recycles the oldest segment whatever it holds, so the
+ * events leading up to an old detection go out with the noise around
+ * them. With a RetainedEvents store attached (EventGraph::set_retained()),
+ * every event of an evicted segment is sorted before its storage is reused:
+ *
+ * - events that are Suspicious or carry detection tags, and events of a
+ *   correlation chain or process that had such an event, are copied into
+ *   a fixed-size ring of nodes here;
+ * - everything else is only counted, per category, status and process
+ *   (see dropped()), and its time span recorded.
+ *
+ * The graph marks a chain and a process as it flags one of their events
+ * (push, set_status() or add_tags()), so events evicted before the
+ * detection happened are only kept if the detection came first; a chain
+ * flagged after its oldest events left the graph keeps what was still
+ * live. Marks live in a bounded table that forgets the oldest mark when
+ * full, and the store overwrites its oldest events, so its memory is fixed
+ * by RetainedConfig however long the graph runs.
+ *
+ * Retained nodes still name interned strings, which the pool keeps while
+ * the store does (Engine::compact_strings() marks them).
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include "columns.hpp"
+#include "counters.hpp"
+#include "node.hpp"
+
+namespace exeray::event {
+
+/// @brief Size of the long-term store (EventGraph::set_retained()).
+struct RetainedConfig {
+    bool enabled = false;
+
+    /// Evicted events kept (72 bytes each); the oldest is overwritten
+    std::size_t capacity = 65536;
+
+    /// Flagged correlation IDs and PIDs remembered (16 bytes each)
+    std::size_t marks = 4096;
+};
+
+/// @brief What eviction kept and dropped (RetainedEvents::stats()).
+struct RetainedStats {
+    std::size_t events = 0;         ///< Events held
+    std::size_t marks = 0;          ///< Chains and processes marked
+    std::uint64_t kept = 0;         ///< Evicted events copied into the store
+    std::uint64_t dropped = 0;      ///< Evicted events reduced to counts
+    std::uint64_t overwritten = 0;  ///< Kept events lost to a full store
+    Timestamp dropped_from = 0;     ///< Time span of the dropped events
+    Timestamp dropped_to = 0;
+};
+
+/**
+ * @brief Bounded store of evicted events that belong to a detection.
+ *
+ * Thread-safety: mark() and the readers may run from any thread, and take
+ * a short lock; a Batch holds it for one evicted segment. dropped() is
+ * lock-free.
+ */
+class RetainedEvents {
+public:
+    /// @brief Sorts the events of one evicted segment, under the store's lock.
+    class Batch {
+    public:
+        explicit Batch(RetainedEvents& store) : store_(store), lock_(store.mutex_) {}
+
+        /// @brief Keep the event if it is flagged or marked, else count it.
+        void add(const EventNode& node, EventTags tags);
+
+    private:
+        RetainedEvents& store_;
+        std::lock_guard<std::mutex> lock_;
+    };
+
+    explicit RetainedEvents(const RetainedConfig& config = {});
+
+    RetainedEvents(const RetainedEvents&) = delete;
+    RetainedEvents& operator=(const RetainedEvents&) = delete;
+
+    /**
+     * @brief Keep the events of a correlation chain and a process from now on.
+     * @param correlation_id Chain to keep (0 = none).
+     * @param pid Process to keep (0 = none).
+     */
+    void mark(uint32_t correlation_id, uint32_t pid);
+
+    /// @brief Whether events of the chain are kept.
+    [[nodiscard]] bool marked_correlation(uint32_t correlation_id) const;
+
+    /// @brief Whether events of the process are kept.
+    [[nodiscard]] bool marked_process(uint32_t pid) const;
+
+    /**
+     * @brief Visit the retained events, oldest first.
+     * @tparam F Callable taking (EventView, EventTags); may return bool,
+     *         false stops. Runs under the lock: it must not call back.
+     */
+    template <typename F>
+    void for_each(F&& fn) const;
+
+    /// @brief for_each() over the events of one correlation chain.
+    template <typename F>
+    void for_each_correlation(uint32_t correlation_id, F&& fn) const;
+
+    /// @brief for_each() over the events attributed to one process (event_pid()).
+    template <typename F>
+    void for_each_process(uint32_t pid, F&& fn) const;
+
+    /// @brief Dropped events by category, status and process.
+    [[nodiscard]] const EventCounters& dropped() const noexcept { return dropped_; }
+
+    [[nodiscard]] RetainedStats stats() const;
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return nodes_.size(); }
+
+private:
+    /// @brief Mark table entry: kind << 32 | id (0 = free), and its age.
+    struct Mark {
+        std::uint64_t key = 0;
+        std::uint64_t tick = 0;
+    };
+
+    static constexpr std::uint64_t kCorrelation = std::uint64_t{1} << 32;
+    static constexpr std::uint64_t kProcess = std::uint64_t{2} << 32;
+
+    /// Probes before the oldest mark of the window is replaced.
+    static constexpr std::size_t kMaxProbe = 16;
+
+    void insert_mark(std::uint64_t key);
+    [[nodiscard]] bool has_mark(std::uint64_t key) const noexcept;
+
+    /// @brief Call a visitor; false if it returned false.
+    template <typename F>
+    static bool call(F& fn, EventView view, EventTags tags);
+
+    mutable std::mutex mutex_;
+    std::vector<EventNode> nodes_;  ///< Ring of kept events
+    std::vector<EventTags> tags_;   ///< Their tags, same slots
+    std::size_t next_ = 0;          ///< Slot written next
+    std::size_t size_ = 0;          ///< Slots holding an event
+    std::vector<Mark> marks_;       ///< Power-of-two open-addressed table
+    std::size_t mark_count_ = 0;
+    std::uint64_t tick_ = 0;
+    std::uint64_t kept_ = 0;
+    std::uint64_t dropped_count_ = 0;
+    std::uint64_t overwritten_ = 0;
+    Timestamp dropped_from_ = 0;
+    Timestamp dropped_to_ = 0;
+    EventCounters dropped_;
+};
+
+template <typename F>
+bool RetainedEvents::call(F& fn, EventView view, EventTags tags) {
+    if constexpr (std::is_same_v<std::invoke_result_t<F&, EventView, EventTags>, bool>) {
+        return fn(view, tags);
+    } else {
+        fn(view, tags);
+        return true;
+    }
+}
+
+template <typename F>
+void RetainedEvents::for_each(F&& fn) const {
+    std::lock_guard lock(mutex_);
+    const std::size_t first = size_ < nodes_.size() ? 0 : next_;
+    for (std::size_t i = 0; i < size_; ++i) {
+        const std::size_t slot = (first + i) % nodes_.size();
+        if (!call(fn, EventView(nodes_[slot]), tags_[slot])) {
+            return;
+        }
+    }
+}
+
+template <typename F>
+void RetainedEvents::for_each_correlation(uint32_t correlation_id, F&& fn) const {
+    for_each([&fn, correlation_id](EventView view, EventTags tags) {
+        return view.correlation_id() != correlation_id || call(fn, view, tags);
+    });
+}
+
+template <typename F>
+void RetainedEvents::for_each_process(uint32_t pid, F&& fn) const {
+    for_each([&fn, pid](EventView view, EventTags tags) {
+        return event_pid(view.payload()) != pid || call(fn, view, tags);
+    });
+}
+
+}  // namespace exeray::event
@@ -0,0 +1,103 @@
+#pragma once
+
+/// @file risk_table.hpp
+/// @brief Decaying risk scores with a cheap "riskiest first" query.
+///
+/// Each Suspicious event adds its weight to the score of a key (a PID or a
+/// correlation ID), and every score halves each half-life. Scores are kept
+/// as log2 of the weights scaled back to a common origin,
+/// log2(sum w * 2^(t / half_life)), so that decay moves them all by the same
+/// amount: the order never changes with time, an update is one re-insert in
+/// an ordered index and the top K are read off its end. Events may arrive
+/// out of timestamp order; the sum does not depend on it.
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <span>
+#include <unordered_map>
+#include <utility>
+
+#include "types.hpp"
+
+namespace exeray::event {
+
+/// @brief One key's risk as seen at a query time.
+struct RiskScore {
+    uint32_t key = 0;          ///< PID or correlation ID
+    double score = 0.0;        ///< Decayed sum of weights
+    std::uint64_t events = 0;  ///< Suspicious events counted
+    Timestamp last = 0;        ///< Newest event timestamp
+};
+
+/**
+ * @brief Bounded table of decaying scores.
+ *
+ * Holds at most kMaxEntries keys; a new key arriving when full replaces the
+ * lowest score if it would rank above it, and is dropped otherwise.
+ *
+ * Thread-safety: none; the Correlator serializes access.
+ */
+class RiskTable {
+public:
+    static constexpr std::size_t kMaxEntries = 4096;
+
+    /// Default half-life: five minutes.
+    static constexpr Timestamp kDefaultHalfLife = 300'000'000'000ULL;
+
+    explicit RiskTable(Timestamp half_life = kDefaultHalfLife) noexcept;
+
+    /**
+     * @brief Add weight to key at time timestamp.
+     * @param key PID or correlation ID (0 is ignored).
+     * @param timestamp Event time in nanoseconds.
+     * @param weight Amount added before decay (ignored unless positive).
+     */
+    void add(uint32_t key, Timestamp timestamp, double weight = 1.0);
+
+    /// @brief Score of key decayed to now (0 = newest timestamp added).
+    [[nodiscard]] double score(uint32_t key, Timestamp now = 0) const;
+
+    /**
+     * @brief Keys with the highest scores. O(K) after O(log N) updates.
+     * @param out Destination for the top out.size() keys.
+     * @param now Time the scores are decayed to (0 = newest timestamp added).
+     * @return Number written, by descending score.
+     */
+    std::size_t top(std::span<RiskScore> out, Timestamp now = 0) const;
+
+    /**
+     * @brief Re-enter scores read with top() from another table.
+     * @param scores Scores decayed to now; keys already present are summed.
+     * @param now Time the scores were decayed to (see newest()).
+     */
+    void restore(std::span<const RiskScore> scores, Timestamp now);
+
+    /// @brief Newest timestamp added (0 = none), which now = 0 stands for.
+    [[nodiscard]] Timestamp newest() const noexcept { return newest_; }
+
+    [[nodiscard]] std::size_t size() const noexcept { return entries_.size(); }
+
+    void clear() noexcept;
+
+private:
+    struct Entry {
+        double level = 0.0;  ///< log2 of the weights scaled to origin_
+        std::uint64_t events = 0;
+        Timestamp last = 0;
+    };
+
+    /// @brief Half-lives (possibly negative) from origin_ to timestamp.
+    [[nodiscard]] double half_lives(Timestamp timestamp) const noexcept;
+
+    /// @brief Decay a level to now.
+    [[nodiscard]] double decayed(double level, Timestamp now) const noexcept;
+
+    double half_life_;
+    Timestamp origin_ = 0;  ///< First timestamp added, keeps levels small
+    Timestamp newest_ = 0;
+    std::unordered_map<uint32_t, Entry> entries_;
+    std::set<std::pair<double, uint32_t>> order_;  ///< (level, key), lowest first
+};
+
+}  // namespace exeray::event
@@ -0,0 +1,292 @@
+#pragma once
+
+/**
+ * @file shared_export.hpp
+ * @brief Read-only export of an EventGraph to other processes through a
+ * named shared-memory section.
+ *
+ * Local agents that want ExeRay's events without linking the library map
+ * the section and read events in place: no socket, no pipe and no system
+ * call per event. SharedGraphExport tails the graph like EventLogWriter
+ * does, from a background thread, and copies every published segment into
+ * a ring of nodes in the section, together with the strings those nodes
+ * refer to. The graph's writers never wait on it, and it never waits on
+ * readers: a reader that falls a whole ring behind loses the oldest events
+ * (SharedGraphReader::missed()), never the exporter's time.
+ *
+ * Layout (native byte order, all offsets from the start of the section):
+ * - SharedExportHeader, 128 bytes. The second cache line holds the 64-bit
+ *   counters the exporter updates; readers load them atomically.
+ * - At nodes_offset, node_slots EventNodes (node_size bytes each, 64-byte
+ *   aligned). Export sequence n (0, 1, ... in publish order) is in slot
+ *   n & (node_slots - 1); the node's own id is its EventId.
+ * - At strings_offset, strings_capacity bytes of string entries, each a
+ *   StringId (u32), a length (u32) and that many bytes, padded to 8.
+ *   Entries are appended once per StringId and never moved.
+ *
+ * Protocol: events below published and string entries below strings_used
+ * are complete; both are stored with release order after the data, and
+ * every string an event refers to is published before the event. Before
+ * overwriting slots, the exporter raises claimed past them, so after
+ * reading export sequence n a reader checks (acquire) that
+ * claimed <= n + node_slots; otherwise the slot was overwritten meanwhile.
+ * A reader less than node_slots - EventGraph::kSegmentSize events behind
+ * is never overwritten. When the string area is full, later strings are
+ * counted in strings_dropped and their StringIds resolve to nothing.
+ *
+ * Usage example:
+ * @code
+ * SharedGraphExport exporter(graph, strings);
+ * if (exporter.open({.name = "exeray-events"})) {
+ *     exporter.start(std::chrono::milliseconds(50));
+ * }
+ *
+ * // In another process
+ * SharedGraphReader reader;
+ * if (reader.open("exeray-events")) {
+ *     reader.read([&](const EventNode& node) {
+ *         show(node.id, reader.resolve(node.payload.process.image_path));
+ *     });
+ * }
+ * @endcode
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "../platform/shared_memory.hpp"
+#include "graph.hpp"
+
+namespace exeray::event {
+
+/// @brief "EXSM" in the first four bytes of an export section.
+inline constexpr std::uint32_t kSharedExportMagic = 0x4D535845;
+
+/// @brief Bumped whenever the layout changes.
+inline constexpr std::uint32_t kSharedExportFormat = 1;
+
+/// @brief First 128 bytes of an export section.
+struct SharedExportHeader {
+    // Written once by open()
+    std::uint32_t magic = kSharedExportMagic;
+    std::uint32_t format = kSharedExportFormat;
+    std::uint32_t header_size = 0;       ///< sizeof(SharedExportHeader)
+    std::uint32_t node_size = 0;         ///< sizeof(EventNode)
+    std::uint64_t node_slots = 0;        ///< Ring size in nodes, a power of two
+    std::uint64_t nodes_offset = 0;      ///< 64-byte aligned
+    std::uint64_t strings_offset = 0;    ///< 8-byte aligned
+    std::uint64_t strings_capacity = 0;  ///< Bytes of the string area
+    std::uint64_t reserved0[2] = {};
+
+    // Updated by the exporter (atomic 64-bit words, own cache line)
+    std::uint64_t claimed = 0;          ///< Slots of sequences below may be rewritten
+    std::uint64_t published = 0;        ///< Sequences below are complete
+    std::uint64_t strings_used = 0;     ///< Bytes of complete string entries
+    std::uint64_t strings_dropped = 0;  ///< Strings that did not fit
+    std::uint64_t lost = 0;             ///< Events evicted from the graph before export
+    std::uint64_t reserved1[3] = {};
+};
+static_assert(sizeof(SharedExportHeader) == 128);
+static_assert(offsetof(SharedExportHeader, claimed) == 64);
+
+/// @brief Name and size of an export section.
+struct SharedExportConfig {
+    std::string name;  ///< Section name (see platform::SharedMemory::create())
+    /// Events kept for readers (rounded up to a power of two of at least
+    /// two segments)
+    std::size_t node_slots = std::size_t{1} << 16;
+    std::size_t string_bytes = std::size_t{16} << 20;  ///< String area
+};
+
+/**
+ * @brief Background exporter copying a graph's events into a section.
+ *
+ * Events are exported once they are published; a later set_status() is
+ * not. In ring mode, events evicted before a flush reached them are
+ * skipped and counted in lost().
+ *
+ * Thread-safety: open()/start()/stop() from one thread; flush() and the
+ * counters from any.
+ */
+class SharedGraphExport {
+public:
+    /// @param graph Graph to export; must outlive the exporter.
+    /// @param strings Pool the graph's StringIds belong to.
+    SharedGraphExport(const EventGraph& graph, const StringPool& strings) noexcept;
+    ~SharedGraphExport();
+
+    SharedGraphExport(const SharedGraphExport&) = delete;
+    SharedGraphExport& operator=(const SharedGraphExport&) = delete;
+
+    /**
+     * @brief Create the section and write its header.
+     *
+     * Export starts at the oldest live event.
+     * @return false if the section could not be created.
+     */
+    bool open(const SharedExportConfig& config);
+
+    /// @brief Flush every interval on a background thread until stop().
+    void start(std::chrono::milliseconds interval);
+
+    /// @brief Stop the thread, flush what is left and remove the section.
+    void stop();
+
+    /**
+     * @brief Export the events published since the last flush.
+     * @return Events exported.
+     */
+    std::size_t flush();
+
+    /// @brief Events exported so far.
+    [[nodiscard]] std::uint64_t events_exported() const noexcept {
+        return exported_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Events evicted from a ring before they could be exported.
+    [[nodiscard]] std::uint64_t lost() const noexcept {
+        return lost_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Strings that no longer fit in the string area.
+    [[nodiscard]] std::uint64_t strings_dropped() const noexcept {
+        return strings_dropped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    /// @brief Copy a span into the ring and its new strings into the
+    /// string area, then publish both.
+    /// @return false (nothing published) if the ring recycled the span meanwhile.
+    bool export_span(const EventGraph::SegmentSpan& span);
+
+    /// @brief Append the entry of id unless it is already in the section.
+    void note_string(StringId id);
+
+    void run(std::chrono::milliseconds interval);
+
+    const EventGraph& graph_;
+    const StringPool& strings_;
+
+    std::mutex flush_mutex_;
+    platform::SharedMemory section_;         ///< Guarded by flush_mutex_
+    SharedExportHeader* header_ = nullptr;   ///< In section_
+    EventNode* nodes_ = nullptr;             ///< In section_
+    std::uint8_t* string_area_ = nullptr;    ///< In section_
+    std::size_t next_ = 0;                   ///< Index of the next event to export
+    std::uint64_t sequence_ = 0;             ///< Export sequence of the next event
+    std::uint64_t strings_used_ = 0;         ///< Bytes of the string area written
+    std::unordered_set<StringId> written_;   ///< StringIds in the string area
+
+    std::thread thread_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;  ///< Guarded by wake_mutex_
+
+    std::atomic<std::uint64_t> exported_{0};
+    std::atomic<std::uint64_t> lost_{0};
+    std::atomic<std::uint64_t> strings_dropped_{0};
+};
+
+/**
+ * @brief Reader of an export section, for processes that link the library.
+ *
+ * Other readers follow the layout in this file's description; this class
+ * is its reference implementation.
+ *
+ * Thread-safety: none; one thread reads and resolves.
+ */
+class SharedGraphReader {
+public:
+    /**
+     * @brief Map a section read-only and check its header.
+     *
+     * Reading starts at the oldest event still in the ring.
+     * @return false if there is no such section, or it is of another
+     *         format or node layout.
+     */
+    bool open(std::string_view name);
+
+    /**
+     * @brief Call fn(const EventNode&) for each event exported since the
+     * last read(), oldest first, at most max events.
+     *
+     * fn sees the node in the section itself. Events overwritten before
+     * they were reached are skipped and counted in missed(). If the
+     * exporter overwrote a node while fn was looking at it, read() stops
+     * right after fn returns, sets overrun() and counts the event as
+     * missed; a reader that keeps up never sees this.
+     *
+     * @return Number of events handed to fn (overrun one included).
+     */
+    template <typename F>
+    std::size_t read(F&& fn, std::size_t max = SIZE_MAX);
+
+    /// @brief Text of a StringId in the exported events ("" if unknown).
+    [[nodiscard]] std::string_view resolve(StringId id);
+
+    /// @brief Export sequence of the next event read() hands out.
+    [[nodiscard]] std::uint64_t cursor() const noexcept { return cursor_; }
+
+    /// @brief Events overwritten before this reader got to them.
+    [[nodiscard]] std::uint64_t missed() const noexcept { return missed_; }
+
+    /// @brief Whether the last read() ended on a node that was overwritten.
+    [[nodiscard]] bool overrun() const noexcept { return overrun_; }
+
+    [[nodiscard]] const SharedExportHeader* header() const noexcept { return header_; }
+
+private:
+    [[nodiscard]] std::uint64_t load(const std::uint64_t& word) const noexcept {
+        return std::atomic_ref(const_cast<std::uint64_t&>(word)).load(std::memory_order_acquire);
+    }
+
+    platform::SharedMemory section_;
+    const SharedExportHeader* header_ = nullptr;
+    const EventNode* nodes_ = nullptr;
+    const std::uint8_t* string_area_ = nullptr;
+    std::uint64_t cursor_ = 0;
+    std::uint64_t missed_ = 0;
+    bool overrun_ = false;
+    std::uint64_t strings_read_ = 0;  ///< Bytes of the string area indexed
+    std::unordered_map<StringId, std::string_view> index_;
+};
+
+template <typename F>
+std::size_t SharedGraphReader::read(F&& fn, std::size_t max) {
+    overrun_ = false;
+    if (header_ == nullptr) {
+        return 0;
+    }
+    const std::uint64_t slots = header_->node_slots;
+    const std::uint64_t end = load(header_->published);
+    // Sequences whose slots the exporter has claimed since are gone
+    if (const std::uint64_t claimed = load(header_->claimed); claimed > cursor_ + slots) {
+        missed_ += claimed - slots - cursor_;
+        cursor_ = claimed - slots;
+    }
+    std::size_t handed = 0;
+    for (; cursor_ < end && handed < max; ++cursor_) {
+        fn(nodes_[cursor_ & (slots - 1)]);
+        ++handed;
+        // Orders fn's reads before the check, as a seqlock reader does
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (load(header_->claimed) > cursor_ + slots) {
+            overrun_ = true;
+            ++missed_;
+            ++cursor_;
+            break;
+        }
+    }
+    return handed;
+}
+
+}  // namespace exeray::event
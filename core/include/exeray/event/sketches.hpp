@@ -0,0 +1,180 @@
+#pragma once
+
+/**
+ * @file sketches.hpp
+ * @brief Fixed-memory heavy-hitter and cardinality estimates of ingested events.
+ *
+ * "Top 20 most-accessed files", "unique remote IPs" and "unique domains"
+ * would need a map per key that grows with the traffic. EventSketches
+ * keeps, per kind of key, a Count-Min sketch with a small table of its
+ * largest entries and a HyperLogLog, updated by EventGraph at push time.
+ * Memory is fixed (about 36 KiB per kind) whatever the number of keys.
+ *
+ * Counts are of pushes; ring mode eviction does not subtract from them.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "payload.hpp"
+#include "types.hpp"
+
+namespace exeray::event {
+
+/**
+ * @brief Distinct keys estimated by HyperLogLog.
+ *
+ * 4096 one-byte registers: about 1.6% standard error.
+ * Thread-safety: add() and estimate() from any thread without locks.
+ */
+class CardinalitySketch {
+public:
+    static constexpr std::size_t kPrecision = 12;
+    static constexpr std::size_t kRegisters = std::size_t{1} << kPrecision;
+
+    /// @brief Count one occurrence of key.
+    void add(std::uint64_t key) noexcept;
+
+    /// @brief Estimated number of distinct keys added.
+    [[nodiscard]] double estimate() const noexcept;
+
+private:
+    std::array<std::atomic<std::uint8_t>, kRegisters> registers_{};
+};
+
+/// @brief One key of a heavy-hitter table.
+struct HeavyHitter {
+    std::uint64_t key = 0;
+    std::uint64_t count = 0;  ///< Count-Min estimate: never below the true count
+};
+
+/**
+ * @brief Most frequent keys, estimated by Count-Min plus a top-k table.
+ *
+ * Every add() increments one counter per row and takes the minimum as the
+ * key's estimate. Keys already tracked and keys estimated below the
+ * smallest tracked one return after a scan of the table; only a key
+ * entering the table takes the mutex, so the ingest path stays lock-free
+ * once the heavy hitters settle. Counts are read from the sketch by top().
+ *
+ * Thread-safety: add() and top() from any thread.
+ */
+class HeavyHitters {
+public:
+    static constexpr std::size_t kDepth = 4;
+    static constexpr std::size_t kWidth = 2048;
+
+    /// @param capacity Keys kept in the table (at least 1).
+    explicit HeavyHitters(std::size_t capacity = 20);
+
+    HeavyHitters(const HeavyHitters&) = delete;
+    HeavyHitters& operator=(const HeavyHitters&) = delete;
+
+    /// @brief Count one occurrence of key.
+    void add(std::uint64_t key) noexcept;
+
+    /// @brief Count-Min estimate for any key, tracked or not.
+    [[nodiscard]] std::uint64_t estimate(std::uint64_t key) const noexcept;
+
+    /// @brief Tracked keys, most frequent first.
+    [[nodiscard]] std::vector<HeavyHitter> top() const;
+
+    /// @brief Keys kept in the table.
+    [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+
+private:
+    static constexpr std::uint64_t kNoKey = ~std::uint64_t{0};
+
+    std::array<std::array<std::atomic<std::uint32_t>, kWidth>, kDepth> counts_{};
+    std::size_t capacity_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> keys_;  ///< Tracked keys (kNoKey = free)
+    std::atomic<std::uint64_t> floor_{0};  ///< Smallest tracked estimate once full
+    std::mutex mutex_;                     ///< Serializes changes to keys_
+};
+
+/// @brief Key kinds tracked by EventSketches.
+enum class SketchKind : std::uint8_t {
+    Files,            ///< FileSystem.path StringId
+    RemoteAddresses,  ///< Network remote address (see address_key())
+    Domains,          ///< Dns.domain StringId
+    Processes,        ///< event_pid() of every event
+    Count
+};
+
+inline constexpr std::size_t kSketchKinds = static_cast<std::size_t>(SketchKind::Count);
+
+/// @brief Label of a kind ("files", "remote_addresses", ...).
+[[nodiscard]] std::string_view sketch_kind_name(SketchKind kind) noexcept;
+
+/**
+ * @brief Key of a network remote address: the IPv4 address in network
+ * byte order, or (1 << 32) | StringId for an interned IPv6 address.
+ */
+[[nodiscard]] constexpr std::uint64_t address_key(const NetworkPayload& network) noexcept {
+    return network.family == kAddressIPv6
+               ? (std::uint64_t{1} << 32) | network.remote_addr
+               : std::uint64_t{network.remote_addr};
+}
+
+/// @brief Estimates of one kind.
+struct SketchSummary {
+    double unique = 0.0;           ///< Distinct keys
+    std::vector<HeavyHitter> top;  ///< Most frequent first
+};
+
+/// @brief Point-in-time copy of every kind.
+struct SketchSnapshot {
+    std::array<SketchSummary, kSketchKinds> kinds;
+
+    [[nodiscard]] const SketchSummary& operator[](SketchKind kind) const noexcept {
+        return kinds[static_cast<std::size_t>(kind)];
+    }
+};
+
+/**
+ * @brief Heavy hitters and cardinality of files, remote addresses, domains
+ * and processes.
+ *
+ * Thread-safety: add() and snapshot() from any thread.
+ */
+class EventSketches {
+public:
+    /// @param top Keys kept per heavy-hitter table.
+    explicit EventSketches(std::size_t top = 20);
+
+    EventSketches(const EventSketches&) = delete;
+    EventSketches& operator=(const EventSketches&) = delete;
+
+    /// @brief Count the keys of one event.
+    void add(const EventPayload& payload, std::uint32_t pid) noexcept;
+
+    /// @brief Count one key of a kind directly.
+    void add(SketchKind kind, std::uint64_t key) noexcept;
+
+    [[nodiscard]] const HeavyHitters& heavy_hitters(SketchKind kind) const noexcept {
+        return sketches_[static_cast<std::size_t>(kind)].hitters;
+    }
+
+    [[nodiscard]] const CardinalitySketch& cardinality(SketchKind kind) const noexcept {
+        return sketches_[static_cast<std::size_t>(kind)].unique;
+    }
+
+    [[nodiscard]] SketchSnapshot snapshot() const;
+
+private:
+    struct Sketch {
+        explicit Sketch(std::size_t top) : hitters(top) {}
+        HeavyHitters hitters;
+        CardinalitySketch unique;
+    };
+
+    std::array<Sketch, kSketchKinds> sketches_;
+};
+
+}  // namespace exeray::event
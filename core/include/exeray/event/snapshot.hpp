@@ -0,0 +1,153 @@
+#pragma once
+
+/**
+ * @file snapshot.hpp
+ * @brief Consistent, lock-free point-in-time view of an EventGraph.
+ *
+ * A GraphSnapshot pins the published watermark and the per-category index
+ * totals at construction. Iterating it visits exactly the events that were
+ * published at that instant, however long the iteration takes and however
+ * many events are pushed meanwhile, so exports and tree reconstruction see
+ * one stable population. Nothing is copied and no lock is held: writers
+ * never wait for a snapshot.
+ *
+ * In ring mode the graph may still recycle the oldest segments of a
+ * long-held snapshot. Those events are skipped and intact() turns false;
+ * hold snapshots for less than one ring lap when completeness matters.
+ *
+ * Usage example:
+ * @code
+ * GraphSnapshot snap(graph);
+ * snap.for_each_category(Category::Process, [&](EventView view) {
+ *     export_row(view);  // may take arbitrarily long
+ * });
+ * if (!snap.intact()) { ... }  // ring lapped the export
+ * @endcode
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "graph.hpp"
+
+namespace exeray::event {
+
+class GraphSnapshot {
+public:
+    /**
+     * @brief Pin the current state of a graph.
+     * @param graph Graph to observe; must outlive the snapshot.
+     */
+    explicit GraphSnapshot(const EventGraph& graph) noexcept;
+
+    /// @brief Number of events published when the snapshot was taken.
+    [[nodiscard]] std::size_t count() const noexcept { return end_ - begin_; }
+
+    /// @brief Graph epoch when the snapshot was taken.
+    [[nodiscard]] std::uint64_t epoch() const noexcept { return epoch_; }
+
+    /**
+     * @brief Check whether an event is part of the snapshot and still live.
+     * @param id Event ID.
+     * @return true if published before the snapshot and not evicted since.
+     */
+    [[nodiscard]] bool contains(EventId id) const noexcept {
+        return id > begin_ && id <= end_ && graph_->exists(id);
+    }
+
+    /// @brief true while no event of the snapshot has been evicted.
+    [[nodiscard]] bool intact() const noexcept {
+        return graph_->oldest_id() <= static_cast<EventId>(begin_) + 1;
+    }
+
+    /**
+     * @brief Iterate over the snapshot's events (oldest first).
+     * @tparam F Callable taking EventView; may return false to stop.
+     * @param fn Function to call for each event.
+     */
+    template <typename F>
+    void for_each(F&& fn) const;
+
+    /**
+     * @brief Iterate over the snapshot's events of one category (oldest first).
+     * @tparam F Callable taking EventView; may return false to stop.
+     * @param cat Category to filter by.
+     * @param fn Function to call for each matching event.
+     */
+    template <typename F>
+    void for_each_category(Category cat, F&& fn) const;
+
+    /**
+     * @brief Iterate over the snapshot's events with timestamps in [from, to].
+     * @tparam F Callable taking EventView; may return false to stop.
+     * @param from Inclusive lower bound.
+     * @param to Inclusive upper bound.
+     * @param fn Function to call for each matching event.
+     */
+    template <typename F>
+    void for_each_in_range(Timestamp from, Timestamp to, F&& fn) const;
+
+    /**
+     * @brief Iterate over the snapshot's events matching a filter.
+     * @tparam F Callable taking EventView; may return false to stop.
+     * @param spec Filter to evaluate.
+     * @param fn Function to call for each matching event.
+     */
+    template <typename F>
+    void for_each_where(const FilterSpec& spec, F&& fn) const;
+
+    /**
+     * @brief Collect the IDs of the snapshot's events matching a filter.
+     * @param spec Filter to evaluate.
+     * @param out Receives matching IDs; existing contents are kept.
+     * @return Number of IDs appended.
+     */
+    std::size_t scan(const FilterSpec& spec, std::vector<EventId>& out) const;
+
+private:
+    /// @brief First pinned index still live (ring mode may have moved on).
+    [[nodiscard]] std::size_t live_begin() const noexcept;
+
+    const EventGraph* graph_;
+    std::size_t begin_;  ///< First event index at construction
+    std::size_t end_;    ///< Published watermark at construction
+    std::uint64_t epoch_;
+    std::array<std::size_t, EventGraph::kCategoryCount> category_totals_{};
+};
+
+// =============================================================================
+// Template Implementation
+// =============================================================================
+
+template <typename F>
+void GraphSnapshot::for_each(F&& fn) const {
+    graph_->scan_nodes(live_begin(), end_, [&fn](const EventNode& node) {
+        return EventGraph::visit(fn, EventView(node));
+    });
+}
+
+template <typename F>
+void GraphSnapshot::for_each_category(Category cat, F&& fn) const {
+    const auto c = static_cast<std::size_t>(cat);
+    if (c >= EventGraph::kCategoryCount) {
+        return;
+    }
+    graph_->walk_category(cat, category_totals_[c], end_, fn);
+}
+
+template <typename F>
+void GraphSnapshot::for_each_in_range(Timestamp from, Timestamp to, F&& fn) const {
+    graph_->walk_range(live_begin(), end_, from, to, fn);
+}
+
+template <typename F>
+void GraphSnapshot::for_each_where(const FilterSpec& spec, F&& fn) const {
+    graph_->match_where(live_begin(), end_, spec,
+                        [&fn](std::size_t, const EventNode& node) {
+                            return EventGraph::visit(fn, EventView(node));
+                        });
+}
+
+}  // namespace exeray::event
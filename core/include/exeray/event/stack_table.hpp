@@ -0,0 +1,86 @@
+#pragma once
+
+/**
+ * @file stack_table.hpp
+ * @brief Deduplicated call stacks, stored once as extension records.
+ *
+ * A thread creation or an allocation captured with its kernel stack
+ * carries up to 192 return addresses, and the same few code paths produce
+ * most of them. StackTable stores each distinct stack once, as an
+ * ExtensionKind::Stack record in the session's ExtensionStore, and hands
+ * out that record's ExtensionId as the stack ID: every event with the same
+ * stack points at the same record through EventPayload::extension.
+ *
+ * Lookups hash the frames into one of kShards maps, each with its own
+ * mutex; a hash hit is confirmed against the stored frames, so a collision
+ * costs a second record rather than a wrong stack.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "extensions.hpp"
+#include "types.hpp"
+
+namespace exeray::event {
+
+/// @brief What the table did in the current or last session.
+struct StackTableStats {
+    std::uint64_t interned = 0;  ///< Stacks passed to intern()
+    std::uint64_t distinct = 0;  ///< Records stored
+    std::uint64_t orphaned = 0;  ///< Stacks whose event was not found
+};
+
+/**
+ * @brief Interns call stacks into an ExtensionStore.
+ *
+ * Thread-safety: intern(), frames() and stats() from any thread; clear()
+ * between sessions, together with the store it refers to.
+ */
+class StackTable {
+public:
+    /// Deepest stack stored; deeper ones keep their innermost frames.
+    static constexpr std::size_t kMaxFrames = 192;
+
+    static constexpr std::size_t kShards = 16;
+
+    explicit StackTable(ExtensionStore& store) : store_(store) {}
+
+    StackTable(const StackTable&) = delete;
+    StackTable& operator=(const StackTable&) = delete;
+
+    /// @brief ID of the record holding these frames, storing it if new.
+    /// @return NO_EXTENSION if frames is empty or the arena is full.
+    ExtensionId intern(std::span<const std::uint64_t> frames);
+
+    /// @brief Frames of a stack record (empty if id is not one).
+    [[nodiscard]] std::vector<std::uint64_t> frames(ExtensionId id) const;
+
+    /// @brief Count a stack that arrived after its event was gone.
+    void orphan() noexcept { orphaned_.fetch_add(1, std::memory_order_relaxed); }
+
+    /// @brief Forget every stack (the store was cleared).
+    void clear();
+
+    [[nodiscard]] StackTableStats stats() const noexcept;
+
+private:
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::unordered_multimap<std::uint64_t, ExtensionId> stacks;
+    };
+
+    ExtensionStore& store_;
+    std::array<Shard, kShards> shards_;
+    std::atomic<std::uint64_t> interned_{0};
+    std::atomic<std::uint64_t> distinct_{0};
+    std::atomic<std::uint64_t> orphaned_{0};
+};
+
+}  // namespace exeray::event
@@ -0,0 +1,102 @@
+#pragma once
+
+/**
+ * @file string_index.hpp
+ * @brief Inverted index from interned strings to the events that carry them.
+ *
+ * "Which processes touched this file" or "who resolved this domain" would
+ * otherwise scan every File or DNS event for one StringId. StringIndex
+ * keeps, for each StringId seen in a selected payload field, the posting
+ * list of the events holding it, so a pivot costs the size of its result.
+ *
+ * Postings are event indexes (EventId - 1) in push order, stored as
+ * zigzag varint deltas: consecutive events of one path are usually close,
+ * so most postings take one or two bytes. Concurrent pushers can append
+ * slightly out of order, hence the signed deltas. In ring mode a list is
+ * re-encoded without its evicted postings whenever it has doubled since
+ * it was last compacted.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "payload_fields.hpp"
+#include "types.hpp"
+
+namespace exeray::event {
+
+/**
+ * @brief StringId -> posting list of event indexes for selected fields.
+ *
+ * Thread-safety: add() and collect() may run concurrently; lists are
+ * sharded by StringId, each shard behind its own mutex.
+ */
+class StringIndex {
+public:
+    /// @param fields String fields to index (non-string entries are ignored).
+    explicit StringIndex(std::span<const PayloadField> fields);
+
+    StringIndex(const StringIndex&) = delete;
+    StringIndex& operator=(const StringIndex&) = delete;
+
+    /// @brief Whether any field of category is indexed.
+    [[nodiscard]] bool indexes(Category category) const noexcept {
+        const auto c = static_cast<std::size_t>(category);
+        return c < offsets_.size() && !offsets_[c].empty();
+    }
+
+    /**
+     * @brief Post the event at index under each indexed string it carries.
+     * @param first_live Oldest live event index; compaction drops postings below it.
+     */
+    void add(std::size_t index, const EventPayload& payload, std::size_t first_live);
+
+    /**
+     * @brief Append the postings of id to out, oldest push first.
+     * @return Number of postings appended (evicted ones included; the
+     *         caller checks liveness).
+     */
+    std::size_t collect(StringId id, std::vector<std::size_t>& out) const;
+
+    /// @brief Distinct strings with a posting list.
+    [[nodiscard]] std::size_t lists() const;
+
+    /// @brief Bytes of encoded postings.
+    [[nodiscard]] std::size_t bytes() const;
+
+private:
+    struct Postings {
+        std::vector<std::uint8_t> bytes;  ///< Zigzag varint deltas
+        std::uint64_t last = 0;           ///< Index of the last posting
+        std::size_t compacted = 0;        ///< bytes.size() after the last compaction
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<StringId, Postings> lists;
+    };
+
+    static constexpr std::size_t kShards = 16;
+
+    static void append(Postings& postings, std::uint64_t index);
+    static void compact(Postings& postings, std::size_t first_live);
+
+    std::array<std::vector<std::uint16_t>, static_cast<std::size_t>(Category::Count)> offsets_;
+    std::array<Shard, kShards> shards_;
+};
+
+/**
+ * @brief Resolve "Category.field" names (e.g. "FileSystem.path", "Dns.domain").
+ * @param unknown Receives names that are not a string field (nullptr = skip).
+ * @return The payload fields found, in the order given.
+ */
+[[nodiscard]] std::vector<PayloadField> find_string_fields(
+    std::span<const std::string> names, std::vector<std::string>* unknown = nullptr);
+
+}  // namespace exeray::event
@@ -8,18 +8,65 @@
  * contiguous memory arena and returning stable StringId handles.
  */
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
-#include <shared_mutex>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <string>
 #include <string_view>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "../arena.hpp"
+#include "device_paths.hpp"
+#include "trigram_index.hpp"
 #include "types.hpp"
 
 namespace exeray::event {
 
+/// @brief Where a StringPool keeps its strings.
+enum class StringStorage : std::uint8_t {
+    Arena,         ///< Bump-allocated in the arena and never freed; IDs are offsets
+    Generational,  ///< Generation blocks released by compact(); IDs are handles
+};
+
+/**
+ * @brief Strings a compaction must keep (see StringPool::compact()).
+ *
+ * A bitmap over the IDs the pool had handed out when it was made; IDs
+ * interned later are kept by the pool itself and ignored here.
+ */
+class StringMarks {
+public:
+    /// @brief Keep id.
+    void mark(StringId id) noexcept {
+        const std::size_t bit = static_cast<std::size_t>(id) - 1;
+        if (id != INVALID_STRING && bit < size_) {
+            bits_[bit / 64] |= std::uint64_t{1} << (bit % 64);
+        }
+    }
+
+    /// @brief Whether id was marked.
+    [[nodiscard]] bool marked(StringId id) const noexcept {
+        const std::size_t bit = static_cast<std::size_t>(id) - 1;
+        return id != INVALID_STRING && bit < size_ &&
+               (bits_[bit / 64] >> (bit % 64) & 1) != 0;
+    }
+
+    /// @brief Number of IDs covered.
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+private:
+    friend class StringPool;
+
+    explicit StringMarks(std::size_t size) : bits_((size + 63) / 64), size_(size) {}
+
+    std::vector<std::uint64_t> bits_;
+    std::size_t size_;
+};
+
 /**
  * @brief Thread-safe string interning pool.
  *
@@ -28,27 +75,193 @@ namespace exeray::event {
  *
  * StringId is the offset + 1 from arena base (so INVALID_STRING = 0 is never returned).
  *
- * Thread-safety: std::shared_mutex (multiple readers, exclusive writer).
+ * The index is an open-addressing table of atomic slots, each holding a
+ * 32-bit hash tag and the StringId. Lookups take no lock; a miss stores the
+ * string in the arena and publishes it with a CAS on the first empty slot,
+ * so racing interns of the same string agree on one ID. At half load the
+ * table doubles: new inserts briefly wait while the entries are copied,
+ * lookups continue on the old table.
+ *
+ * Paths interned with intern_path() are stored as a tree of nodes, each a
+ * (parent StringId, leaf component StringId) pair deduplicated in the same
+ * table, so "\\Device\\HarddiskVolume3\\Windows\\System32\\" is stored
+ * once for every file below it. get() concatenates a node's components on
+ * first use and caches the full string in the node. folded() maps any
+ * entry to its case-folded counterpart. With a TrigramIndex set, every
+ * new string and path node is also indexed for substring search.
+ *
+ * With StringStorage::Generational, entries go to heap blocks of the
+ * current generation instead, and a StringId indexes a handle table that
+ * points at the entry, so get() stays one load and a few adds. compact()
+ * closes the generation: entries that are marked (referenced from retained
+ * events), were looked up or interned during the closing generation, or
+ * belong to such a path node are copied forward and keep their ID; the
+ * others are released, their IDs resolve to "" from then on and are never
+ * handed out again. Blocks emptied by a compaction are freed when the next
+ * one returns. Interns wait while a compaction runs; get() and read() never
+ * do. Lookups also stamp the entry's handle with the generation, one extra
+ * store the first time a string is seen in a generation.
+ *
+ * Thread-safety: all methods are safe to call concurrently. With
+ * generational storage, a string_view from get() or read() stays valid
+ * until the next compact() returns; keep IDs, not views.
  */
 class StringPool {
 public:
-    explicit StringPool(Arena& arena, std::size_t initial_capacity = 4096);
+    /// @brief Outcome of a compact().
+    struct CompactStats {
+        std::size_t kept = 0;            ///< Entries copied forward
+        std::size_t released = 0;        ///< Entries released
+        std::size_t bytes_kept = 0;      ///< Bytes copied forward
+        std::size_t blocks_freed = 0;    ///< Blocks freed (emptied by the previous compaction)
+        std::uint32_t generation = 0;    ///< Generation opened by the compaction
+    };
+
+    /// Bytes per generation block (a longer entry gets a block of its own).
+    static constexpr std::size_t kBlockSize = std::size_t{256} << 10;
+
+    /**
+     * @param arena Storage of StringStorage::Arena entries.
+     * @param initial_capacity Expected unique strings before the first growth.
+     * @param storage Where entries are kept.
+     */
+    explicit StringPool(Arena& arena, std::size_t initial_capacity = 4096,
+                        StringStorage storage = StringStorage::Arena);
+
+    ~StringPool();
 
     /// Intern string, return existing ID if present, or allocate new.
     StringId intern(std::string_view str);
 
     /// Intern wide string by converting to UTF-8.
+    ///
+    /// Transcoding uses the vectorized kernels of utf8.hpp. Strings up to
+    /// a path's length are transcoded onto the stack; longer ones are
+    /// hashed and compared chunk by chunk, and only a new string is
+    /// transcoded in full, directly into arena memory.
     /// @param wstr Wide string view (e.g., from ETW event data).
     /// @return StringId for the interned UTF-8 string.
     StringId intern_wide(std::wstring_view wstr);
 
-    /// Get string by ID. Returns empty view for INVALID_STRING.
+    /**
+     * @brief Intern a file or registry path as shared prefix nodes.
+     *
+     * The path is split after every '\\' or '/'; each component keeps its
+     * trailing separator, so get() returns exactly the input. Directories
+     * are named with their trailing separator ("C:\\Windows\\").
+     *
+     * With a DevicePathMap set, an NT device path is stored in its DOS form
+     * ("\\Device\\HarddiskVolume3\\x" becomes "C:\\x"); paths on unknown
+     * devices are kept as given.
+     *
+     * @param path Full path.
+     * @return ID of the last component's node (a plain string if empty).
+     */
+    StringId intern_path(std::string_view path);
+
+    /// @brief intern_path() of a wide path (e.g., from ETW event data).
+    StringId intern_path_wide(std::wstring_view wpath);
+
+    /**
+     * @brief Intern dir + '\\' + relative as nodes below dir.
+     *
+     * Only the components of relative are interned; dir is never resolved,
+     * so a registry key opened relative to a known key costs one node per
+     * new component. Leading separators of relative are skipped.
+     *
+     * @param dir Path node (intern_path() of relative if it is not one).
+     * @param relative Path relative to dir.
+     * @return ID of the last component's node (dir for an empty relative).
+     */
+    StringId intern_path_below(StringId dir, std::string_view relative);
+
+    /// @brief intern_path_below() of a wide relative path.
+    StringId intern_path_below(StringId dir, std::wstring_view relative);
+
+    /// @brief Translate device paths in intern_path() through devices
+    /// (nullptr = off). The map must outlive the pool.
+    void set_device_paths(DevicePathMap* devices) noexcept;
+
+    /// @brief Index every string and path node interned from now on into
+    /// index (nullptr = off). The index must outlive the pool.
+    void set_trigram_index(TrigramIndex* index) noexcept;
+
+    /// @brief Node of the enclosing directory (INVALID_STRING for the first
+    /// component or a plain string).
+    [[nodiscard]] StringId path_parent(StringId id) const noexcept;
+
+    /// @brief Last component of a path node (id itself for a plain string).
+    [[nodiscard]] StringId path_leaf(StringId id) const noexcept;
+
+    /**
+     * @brief Whether path is dir or lies below it.
+     * @param path Path node from intern_path().
+     * @param dir Directory node, e.g. intern_path("C:\\Windows\\").
+     * @return false if either is not a path node.
+     */
+    [[nodiscard]] bool is_under(StringId path, StringId dir) const noexcept;
+
+    /**
+     * @brief ID of the ASCII case-folded form of a string.
+     *
+     * Computed once per ID and cached in a lock-free side map, so detectors
+     * and queries can compare and hash case-insensitively by integer ID
+     * instead of lowering text on every event. A string without ASCII
+     * uppercase is its own folded form; a path node folds component by
+     * component into another path node, without being resolved.
+     *
+     * @return Folded ID (INVALID_STRING for INVALID_STRING or when the
+     *         arena is exhausted).
+     */
+    StringId folded(StringId id);
+
+    /// @brief ASCII case-insensitive equality: folded(a) == folded(b).
+    bool equals_icase(StringId a, StringId b);
+
+    /// Get string by ID. Returns empty view for INVALID_STRING. A path node
+    /// is resolved on first use (empty view if the arena is exhausted).
     [[nodiscard]] std::string_view get(StringId id) const noexcept;
 
-    /// Number of unique strings interned.
+    /// @brief get() without caching: an unresolved path node is assembled
+    /// into buffer, so scanning many nodes costs no arena memory.
+    [[nodiscard]] std::string_view read(StringId id, std::string& buffer) const;
+
+    /// @brief Whether id and the entry it heads lie inside the claimed
+    /// storage. A bounds check for IDs from untrusted callers (the FFI),
+    /// not proof that intern() returned id.
+    [[nodiscard]] bool in_range(StringId id) const noexcept;
+
+    /// Number of unique strings and path nodes interned (and not released).
     [[nodiscard]] std::size_t count() const noexcept;
 
-    /// Bytes used for string storage (length prefixes + data).
+    /// @brief Where entries are kept.
+    [[nodiscard]] StringStorage storage() const noexcept {
+        return generations_ != nullptr ? StringStorage::Generational : StringStorage::Arena;
+    }
+
+    /// @brief Current generation (1 until the first compact(); 0 for arena storage).
+    [[nodiscard]] std::uint32_t generation() const noexcept;
+
+    /// @brief Empty marks covering every ID handed out so far.
+    [[nodiscard]] StringMarks marks() const;
+
+    /**
+     * @brief Release the entries no longer needed and free old blocks.
+     *
+     * Besides live, an entry is kept if it was looked up or interned since
+     * the previous compaction, or is the parent, leaf or cached full path
+     * of a kept path node. So an ID a caller holds for less than a
+     * generation survives even before it is stored anywhere. Cached
+     * folded() results are dropped and recomputed on demand. Interns wait
+     * for the compaction; compactions run one at a time. A no-op with
+     * arena storage.
+     *
+     * @param live Entries referenced by the caller (e.g. retained events).
+     */
+    CompactStats compact(const StringMarks& live);
+
+    /// Bytes used for string storage (length prefixes + data, path nodes
+    /// and resolved paths).
     [[nodiscard]] std::size_t bytes_used() const noexcept;
 
     // Non-copyable, non-movable
@@ -58,10 +271,160 @@ public:
     StringPool& operator=(StringPool&&) = delete;
 
 private:
+    /// @brief One generation of the index (power-of-two slot count).
+    struct Table {
+        explicit Table(std::size_t slot_count);
+
+        std::size_t mask;
+        std::unique_ptr<std::atomic<std::uint64_t>[]> slots;  ///< tag << 32 | id, 0 = empty
+    };
+
+    /// @brief Current table plus what growing it needs.
+    struct Index {
+        explicit Index(std::size_t capacity);
+
+        std::atomic<Table*> table{nullptr};
+        std::vector<std::unique_ptr<Table>> tables;  ///< Every generation (grow_mutex)
+        std::mutex grow_mutex;
+        std::atomic<bool> growing{false};
+        std::atomic<std::uint32_t> writers{0};  ///< Inserts in flight
+        std::atomic<std::size_t> count{0};
+    };
+
+    /// @brief Find a string in a table; equals compares a stored candidate.
+    template <typename Eq>
+    [[nodiscard]] StringId find(const Table& table, std::uint32_t tag, Eq&& equals) const;
+
+    /// @brief Publish id under tag unless an equal string wins the slot.
+    /// @return The ID now stored for the string and whether it is id.
+    template <typename Eq>
+    std::pair<StringId, bool> insert(Table& table, std::uint32_t tag, StringId id,
+                                     Eq&& equals);
+
+    /// Top bit of the length prefix: the entry is a PathNode.
+    static constexpr std::uint32_t kPathNode = 0x80000000U;
+
+    /// @brief Path component entry; header is kPathNode | full path length.
+    struct PathNode {
+        PathNode(std::uint32_t header_, StringId parent_, StringId leaf_) noexcept
+            : header(header_), parent(parent_), leaf(leaf_) {}
+
+        std::uint32_t header;
+        StringId parent;
+        StringId leaf;
+        mutable std::atomic<StringId> resolved{INVALID_STRING};  ///< Cached full path
+    };
+
+    /// @brief Allocate [len][chars] for size bytes; sets id.
+    /// @return Where the chars go, nullptr if the arena is exhausted.
+    std::uint8_t* allocate_string(std::size_t size, StringId& id) const;
+
+    /// @brief StringId of an arena allocation (INVALID_STRING if unaddressable).
+    [[nodiscard]] StringId id_at(const std::uint8_t* storage) const noexcept;
+
+    /// @brief Generational storage: one block of entries.
+    struct Block {
+        explicit Block(std::size_t capacity_)
+            : data(new (std::nothrow) std::uint8_t[capacity_]), capacity(capacity_) {}
+
+        std::unique_ptr<std::uint8_t[]> data;
+        std::size_t capacity;
+        std::atomic<std::size_t> used{0};
+    };
+
+    /// @brief Generational storage: where an ID's entry is.
+    struct Handle {
+        std::atomic<const std::uint8_t*> entry{nullptr};  ///< nullptr until sealed
+        std::atomic<std::uint32_t> touched{0};            ///< Last generation it was used in
+    };
+
+    static constexpr unsigned kHandleShift = 16;
+    static constexpr std::size_t kHandlesPerChunk = std::size_t{1} << kHandleShift;
+    /// Chunks needed for every 32-bit ID.
+    static constexpr std::size_t kHandleChunks = std::size_t{1} << (32 - kHandleShift);
+
+    /// @brief Generational storage: blocks, handles and the compaction gate.
+    struct Generations {
+        Generations();
+
+        std::unique_ptr<std::atomic<Handle*>[]> chunks;  ///< kHandleChunks, filled lazily
+        std::vector<std::unique_ptr<Handle[]>> owned;    ///< Chunks allocated (mutex)
+        std::atomic<std::uint64_t> next_handle{0};
+        std::atomic<Block*> current{nullptr};
+        std::vector<std::unique_ptr<Block>> blocks;   ///< Filled since the last compaction (mutex)
+        std::vector<std::unique_ptr<Block>> retired;  ///< Emptied by the last compaction
+        std::mutex mutex;                             ///< blocks, owned
+        std::atomic<std::uint32_t> generation{1};
+        std::atomic<std::uint32_t> interns{0};        ///< Interns in flight
+        std::atomic<bool> compacting{false};
+        std::mutex compact_mutex;                     ///< Held for a whole compaction
+    };
+
+    /// @brief Registers an intern with the compaction gate (see compact()).
+    class InternScope;
+
+    /// @brief Allocate bytes of block storage (4-byte aligned) and a handle.
+    /// @return Storage, nullptr if out of memory or IDs; seal() it once written.
+    std::uint8_t* allocate_block(std::size_t bytes, StringId& id) const;
+
+    /// @brief Bump-allocate bytes (a multiple of 4) in the current block.
+    std::uint8_t* allocate_bytes(std::size_t bytes) const;
+
+    /// @brief Make a written entry reachable through its handle (no-op in
+    /// arena storage).
+    void seal(StringId id, const std::uint8_t* storage) const noexcept;
+
+    /// @brief Handle of id, nullptr if its chunk was never allocated.
+    [[nodiscard]] Handle* handle(StringId id) const noexcept;
+
+    /// @brief Stamp id as used in the current generation.
+    void touch(StringId id) const noexcept;
+
+    /// @brief Storage of an entry: [len][chars] or a PathNode.
+    [[nodiscard]] const std::uint8_t* entry(StringId id) const noexcept;
+
+    /// @brief Bytes an entry takes in a block.
+    [[nodiscard]] std::size_t entry_size(const std::uint8_t* storage) const noexcept;
+
+    /// @brief Publish a fully written entry, deduplicating against racing
+    /// interns of an equal one.
+    template <typename Eq>
+    StringId publish(Index& index, std::uint32_t tag, StringId id, std::size_t total_size,
+                     Eq&& equals);
+
+    /// @brief intern_path() after device translation.
+    StringId intern_components(std::string_view path);
+
+    /// @brief Intern the components of path below node, whose full path is
+    /// length bytes long (INVALID_STRING and 0 for a root).
+    StringId append_components(StringId node, std::size_t length, std::string_view path);
+
+    /// @brief Find or add the node for leaf under parent.
+    StringId intern_node(StringId parent, StringId leaf, std::size_t length);
+
+    [[nodiscard]] bool is_path(StringId id) const noexcept;
+    [[nodiscard]] std::uint32_t header(StringId id) const noexcept;
+    /// @brief Bytes of a plain string entry.
+    [[nodiscard]] std::string_view raw(StringId id) const noexcept;
+    [[nodiscard]] const PathNode& node_at(StringId id) const noexcept;
+    /// @brief Full string of a path node, built on first use.
+    [[nodiscard]] std::string_view resolve(StringId id) const noexcept;
+    /// @brief Copy the full path of a node into chars[0, length).
+    void assemble(StringId id, char* chars, std::size_t length) const noexcept;
+
+    /// @brief Feed a newly published entry to the trigram index, if any.
+    void index_new(StringId id);
+
+    /// @brief Replace a table that reached half load with one twice the size.
+    static void grow(Index& index, const Table* full);
+
     Arena& arena_;
-    std::unordered_map<std::string_view, StringId> strings_;
-    mutable std::shared_mutex mutex_;
-    std::size_t bytes_used_ = 0;
+    std::unique_ptr<Generations> generations_;  ///< nullptr for arena storage
+    Index index_;  ///< Strings and path nodes by content
+    Index folds_;  ///< StringId -> folded StringId, filled by folded()
+    std::atomic<DevicePathMap*> devices_{nullptr};
+    std::atomic<TrigramIndex*> trigrams_{nullptr};
+    mutable std::atomic<std::size_t> bytes_used_{0};  ///< Also counts resolves
 };
 
 }  // namespace exeray::event
@@ -0,0 +1,112 @@
+#pragma once
+
+/**
+ * @file timeline.hpp
+ * @brief Per-second event histogram maintained by EventGraph at push time.
+ *
+ * The timeline view and rate alerts want events per second per category.
+ * Counting them from the graph is a full scan; EventTimeline instead keeps
+ * a ring of one-second buckets that every push increments with relaxed
+ * atomics, so reading the last hour is a copy of a few hundred kilobytes.
+ *
+ * Buckets are keyed by the event timestamp, not by arrival: a bucket is
+ * recycled for a later second once the window has moved past it, and an
+ * event older than the window is not counted. Counts are of pushes; ring
+ * mode eviction does not subtract from them.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include "types.hpp"
+
+namespace exeray::event {
+
+/// @brief Events of one second.
+struct TimelineBucket {
+    static constexpr std::size_t kCategoryCount = static_cast<std::size_t>(Category::Count);
+
+    Timestamp start = 0;                                 ///< First nanosecond of the second
+    std::array<std::uint32_t, kCategoryCount> counts{};  ///< Events per category
+    std::uint32_t suspicious = 0;  ///< Events pushed as or later marked Suspicious
+
+    /// @brief Events of every category.
+    [[nodiscard]] std::uint64_t total() const noexcept {
+        std::uint64_t sum = 0;
+        for (const std::uint32_t count : counts) {
+            sum += count;
+        }
+        return sum;
+    }
+};
+
+/**
+ * @brief Ring of one-second buckets x categories.
+ *
+ * Thread-safety: add() and flag() are lock-free and may run concurrently
+ * with each other and with read(). A bucket is claimed for a new second
+ * by one thread; the others wait the few stores it takes to clear it.
+ */
+class EventTimeline {
+public:
+    /// Nanoseconds per bucket.
+    static constexpr Timestamp kBucketNs = 1'000'000'000;
+
+    /// Default window: one hour.
+    static constexpr std::size_t kDefaultSeconds = 3600;
+
+    /// @param seconds Buckets kept (at least 1).
+    explicit EventTimeline(std::size_t seconds = kDefaultSeconds);
+
+    EventTimeline(const EventTimeline&) = delete;
+    EventTimeline& operator=(const EventTimeline&) = delete;
+
+    /**
+     * @brief Count one event.
+     * @param ts Event time in nanoseconds.
+     * @param cat Event category.
+     * @param suspicious Whether it was pushed with Status::Suspicious.
+     */
+    void add(Timestamp ts, Category cat, bool suspicious) noexcept;
+
+    /// @brief Count an event at ts that became Suspicious after its push.
+    void flag(Timestamp ts) noexcept;
+
+    /**
+     * @brief Copy the most recent seconds, oldest first.
+     *
+     * The last bucket is the newest second any event was counted in;
+     * seconds without events come out with zero counts.
+     *
+     * @param out Receives up to (std::min)(out.size(), seconds()) buckets.
+     * @return Number of buckets written (0 before the first event).
+     */
+    std::size_t read(std::span<TimelineBucket> out) const noexcept;
+
+    /// @brief Buckets kept.
+    [[nodiscard]] std::size_t seconds() const noexcept { return size_; }
+
+private:
+    static constexpr std::uint64_t kEmpty = ~std::uint64_t{0};
+    static constexpr std::uint64_t kClearing = kEmpty - 1;
+
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> second{kEmpty};  ///< Second counted here, or a sentinel
+        std::array<std::atomic<std::uint32_t>, TimelineBucket::kCategoryCount> counts{};
+        std::atomic<std::uint32_t> suspicious{0};
+    };
+
+    /// @brief Slot counting second, cleared if it held an older one.
+    /// @return nullptr if the slot already belongs to a later second.
+    Slot* claim(std::uint64_t second) noexcept;
+
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t size_;
+    std::atomic<std::uint64_t> latest_{kEmpty};  ///< Newest second counted
+};
+
+}  // namespace exeray::event
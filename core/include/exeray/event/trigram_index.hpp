@@ -0,0 +1,91 @@
+#pragma once
+
+/**
+ * @file trigram_index.hpp
+ * @brief Substring search over interned strings.
+ *
+ * "Paths containing \\temp\\" or "domains containing ngrok" would
+ * otherwise read every string of the pool. TrigramIndex keeps, for each
+ * ASCII case-folded 3-byte sequence, the StringIds whose text contains it.
+ * A query intersects the lists of its own trigrams, smallest first, and
+ * verifies the survivors with find_icase() (text_search.hpp), so the cost
+ * follows the candidates rather than the pool.
+ *
+ * StringPool::set_trigram_index() feeds the index on intern misses, so
+ * each unique string and path node is indexed exactly once. A path node
+ * is indexed by its full path: a query spanning components still matches.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "types.hpp"
+
+namespace exeray::event {
+
+class StringPool;
+
+/**
+ * @brief Trigram -> StringId lists over indexed strings.
+ *
+ * Thread-safety: add() and queries may run concurrently; lists are
+ * sharded by trigram, each shard behind its own mutex.
+ */
+class TrigramIndex {
+public:
+    TrigramIndex() = default;
+
+    TrigramIndex(const TrigramIndex&) = delete;
+    TrigramIndex& operator=(const TrigramIndex&) = delete;
+
+    /// @brief Index id under the trigrams of text. Call once per id.
+    void add(StringId id, std::string_view text);
+
+    /**
+     * @brief IDs whose text may contain needle (ascending).
+     *
+     * Exact for the trigrams of needle, not for their order: verify with
+     * search(). A needle under 3 bytes returns every indexed string.
+     */
+    [[nodiscard]] std::vector<StringId> candidates(std::string_view needle) const;
+
+    /**
+     * @brief Append the IDs whose text contains needle, ignoring ASCII case.
+     * @param pool Pool the IDs come from (path nodes are not resolved).
+     * @param limit Most IDs appended.
+     * @return Number of IDs appended.
+     */
+    std::size_t search(const StringPool& pool, std::string_view needle,
+                       std::vector<StringId>& out,
+                       std::size_t limit = (std::numeric_limits<std::size_t>::max)()) const;
+
+    /// @brief Strings indexed.
+    [[nodiscard]] std::size_t size() const;
+
+    /// @brief (trigram, StringId) entries over all lists.
+    [[nodiscard]] std::size_t postings() const noexcept {
+        return postings_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::uint32_t, std::vector<StringId>> lists;
+    };
+
+    static constexpr std::size_t kShards = 16;
+
+    std::array<Shard, kShards> shards_;
+    mutable std::mutex all_mutex_;
+    std::vector<StringId> all_;  ///< Every indexed ID, for needles under 3 bytes
+    std::atomic<std::size_t> postings_{0};
+};
+
+}  // namespace exeray::event
@@ -15,6 +15,12 @@ using EventId = std::uint64_t;
 /// Interned string identifier for zero-copy string storage.
 using StringId = std::uint32_t;
 
+/// Extension record of an event (see extensions.hpp).
+using ExtensionId = std::uint32_t;
+
+/// Detection tags of an event, one bit each (see EventGraph::add_tags()).
+using EventTags = std::uint64_t;
+
 /// High-resolution timestamp in nanoseconds since epoch.
 using Timestamp = std::uint64_t;
 
@@ -24,4 +30,7 @@ constexpr EventId INVALID_EVENT = 0;
 /// Invalid string identifier sentinel.
 constexpr StringId INVALID_STRING = 0;
 
+/// No extension record sentinel.
+constexpr ExtensionId NO_EXTENSION = 0;
+
 }  // namespace exeray::event
@@ -32,6 +32,7 @@ enum class Category : std::uint8_t {
     Service,      ///< Windows service operations
     Wmi,          ///< WMI operations
     Clr,          ///< .NET CLR runtime operations
+    Manifest,     ///< Events of providers registered at runtime
 
     Count         ///< Sentinel for iteration (not a valid category)
 };
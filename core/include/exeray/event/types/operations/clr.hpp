@@ -17,7 +17,8 @@ namespace exeray::event {
 enum class ClrOp : std::uint8_t {
     AssemblyLoad,    ///< Assembly loaded (Event 152/153)
     AssemblyUnload,  ///< Assembly unloaded (Event 154)
-    MethodJit        ///< Method JIT compiled (Event 155)
+    MethodJit,       ///< Method JIT compiled (Event 155)
+    ModuleLoad       ///< Module loaded into an app domain (Event 151)
 };
 
 }  // namespace exeray::event
@@ -17,7 +17,8 @@ enum class NetworkOp : std::uint8_t {
     Listen,    ///< Start listening on port
     Send,      ///< Send data
     Receive,   ///< Receive data
-    DnsQuery   ///< DNS resolution query
+    DnsQuery,  ///< DNS resolution query
+    Close      ///< Connection closed
 };
 
 }  // namespace exeray::event
@@ -15,8 +15,9 @@ namespace exeray::event {
 enum class ProcessOp : std::uint8_t {
     Create,      ///< Create child process
     Terminate,   ///< Terminate process
-    Inject,      ///< Inject code/memory into process
-    LoadLibrary  ///< Load DLL/module
+    Inject,       ///< Inject code/memory into process
+    LoadLibrary,  ///< Load DLL/module
+    Rundown       ///< Already running when the session started
 };
 
 }  // namespace exeray::event
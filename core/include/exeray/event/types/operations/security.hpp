@@ -20,7 +20,8 @@ enum class SecurityOp : std::uint8_t {
     LogonFailed,      ///< Failed logon attempt (Event 4625)
     PrivilegeAdjust,  ///< Token rights adjusted (Event 4703)
     ProcessCreate,    ///< New process created (Event 4688)
-    ProcessTerminate  ///< Process terminated (Event 4689)
+    ProcessTerminate, ///< Process terminated (Event 4689)
+    Logoff            ///< Logon session ended (Event 4634)
 };
 
 }  // namespace exeray::event
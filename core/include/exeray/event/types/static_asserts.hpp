@@ -103,7 +103,8 @@ static_assert(static_cast<int>(Category::Security) == 12, "Category::Security mu
 static_assert(static_cast<int>(Category::Service) == 13, "Category::Service must be 13");
 static_assert(static_cast<int>(Category::Wmi) == 14, "Category::Wmi must be 14");
 static_assert(static_cast<int>(Category::Clr) == 15, "Category::Clr must be 15");
-static_assert(static_cast<int>(Category::Count) == 16, "Category::Count must be 16 (total categories)");
+static_assert(static_cast<int>(Category::Manifest) == 16, "Category::Manifest must be 16");
+static_assert(static_cast<int>(Category::Count) == 17, "Category::Count must be 17 (total categories)");
 
 // ---------------------------------------------------------------------------
 // Static Assertions - Status enum values are sequential (0..N-1)
@@ -145,6 +146,7 @@ static_assert(static_cast<int>(NetworkOp::Listen) == 1, "NetworkOp::Listen must
 static_assert(static_cast<int>(NetworkOp::Send) == 2, "NetworkOp::Send must be 2");
 static_assert(static_cast<int>(NetworkOp::Receive) == 3, "NetworkOp::Receive must be 3");
 static_assert(static_cast<int>(NetworkOp::DnsQuery) == 4, "NetworkOp::DnsQuery must be 4");
+static_assert(static_cast<int>(NetworkOp::Close) == 5, "NetworkOp::Close must be 5");
 
 // ---------------------------------------------------------------------------
 // Static Assertions - ProcessOp enum values are sequential (0..N-1)
@@ -154,6 +156,7 @@ static_assert(static_cast<int>(ProcessOp::Create) == 0, "ProcessOp::Create must
 static_assert(static_cast<int>(ProcessOp::Terminate) == 1, "ProcessOp::Terminate must be 1");
 static_assert(static_cast<int>(ProcessOp::Inject) == 2, "ProcessOp::Inject must be 2");
 static_assert(static_cast<int>(ProcessOp::LoadLibrary) == 3, "ProcessOp::LoadLibrary must be 3");
+static_assert(static_cast<int>(ProcessOp::Rundown) == 4, "ProcessOp::Rundown must be 4");
 
 // ---------------------------------------------------------------------------
 // Static Assertions - SchedulerOp enum values are sequential (0..N-1)
@@ -226,6 +229,7 @@ static_assert(static_cast<int>(SecurityOp::LogonFailed) == 1, "SecurityOp::Logon
 static_assert(static_cast<int>(SecurityOp::PrivilegeAdjust) == 2, "SecurityOp::PrivilegeAdjust must be 2");
 static_assert(static_cast<int>(SecurityOp::ProcessCreate) == 3, "SecurityOp::ProcessCreate must be 3");
 static_assert(static_cast<int>(SecurityOp::ProcessTerminate) == 4, "SecurityOp::ProcessTerminate must be 4");
+static_assert(static_cast<int>(SecurityOp::Logoff) == 5, "SecurityOp::Logoff must be 5");
 
 // ---------------------------------------------------------------------------
 // Static Assertions - ServiceOp enum values are sequential (0..N-1)
@@ -252,5 +256,6 @@ static_assert(static_cast<int>(WmiOp::Connect) == 3, "WmiOp::Connect must be 3")
 static_assert(static_cast<int>(ClrOp::AssemblyLoad) == 0, "ClrOp::AssemblyLoad must be 0");
 static_assert(static_cast<int>(ClrOp::AssemblyUnload) == 1, "ClrOp::AssemblyUnload must be 1");
 static_assert(static_cast<int>(ClrOp::MethodJit) == 2, "ClrOp::MethodJit must be 2");
+static_assert(static_cast<int>(ClrOp::ModuleLoad) == 3, "ClrOp::ModuleLoad must be 3");
 
 }  // namespace exeray::event
@@ -0,0 +1,48 @@
+#pragma once
+
+/**
+ * @file utf8.hpp
+ * @brief Wide string (UTF-16) to UTF-8 transcoding kernels.
+ *
+ * Almost every string ETW hands us (paths, registry keys, command lines) is
+ * pure ASCII. The kernels narrow all-ASCII blocks of 16 code units at once
+ * with SSE2 (32 with EXERAY_ENABLE_AVX2) and fall back to a scalar encoder
+ * only for the non-ASCII runs in between.
+ *
+ * Conversion rules, shared by every caller: surrogate pairs become 4-byte
+ * sequences, unpaired surrogates become U+FFFD, and every other code unit
+ * is encoded as a BMP code point.
+ */
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace exeray::event {
+
+/// Most UTF-8 bytes one wide code unit can encode to.
+inline constexpr std::size_t kMaxUtf8PerUnit = 3;
+
+/**
+ * @brief Bytes the UTF-8 form of a wide string takes.
+ * @param wstr Wide string.
+ * @return Exact encode_utf8() output size.
+ */
+[[nodiscard]] std::size_t utf8_length(std::wstring_view wstr) noexcept;
+
+/**
+ * @brief Transcode a wide string to UTF-8.
+ * @param wstr Wide string.
+ * @param out Destination with room for utf8_length(wstr) bytes (at most
+ *            kMaxUtf8PerUnit * wstr.size()); not null-terminated.
+ * @return Bytes written.
+ */
+std::size_t encode_utf8(std::wstring_view wstr, char* out) noexcept;
+
+/// @brief Transcode a wide string into a new std::string.
+[[nodiscard]] std::string to_utf8(std::wstring_view wstr);
+
+/// @brief True when the ASCII blocks are narrowed with AVX2, not SSE2/scalar.
+[[nodiscard]] bool utf8_kernels_vectorized() noexcept;
+
+}  // namespace exeray::event
@@ -0,0 +1,44 @@
+#pragma once
+
+/**
+ * @file wall_clock.hpp
+ * @brief Mapping of EventGraph timestamps to wall-clock time.
+ *
+ * EventGraph timestamps are steady_clock nanoseconds, which never jump but
+ * have no calendar meaning. The ingest clock (etw::ClockDomain) pairs that
+ * clock with the session's wall clock once, so rendering an event's wall
+ * time is one add per event and the pairing lives in one place:
+ * @code
+ * const WallClock wall = engine.wall_clock();
+ * const std::uint64_t unix_ns = wall.to_unix(event.timestamp());
+ * @endcode
+ */
+
+#include <cstdint>
+
+#include "types.hpp"
+
+namespace exeray::event {
+
+/// @brief Anchor between the EventGraph clock and the Unix epoch.
+struct WallClock {
+    Timestamp graph_anchor = 0;     ///< EventGraph timestamp at the anchor point
+    std::uint64_t unix_anchor = 0;  ///< Unix-epoch ns at the anchor point (0 = unknown)
+
+    /// @brief Whether the anchor was captured.
+    [[nodiscard]] constexpr bool valid() const noexcept { return unix_anchor != 0; }
+
+    /// @brief Convert an EventGraph timestamp to Unix-epoch nanoseconds.
+    ///
+    /// Returns 0 while the anchor is unknown; results clamp at 0 rather
+    /// than wrapping.
+    [[nodiscard]] constexpr std::uint64_t to_unix(Timestamp at) const noexcept {
+        if (at >= graph_anchor) {
+            return unix_anchor != 0 ? unix_anchor + (at - graph_anchor) : 0;
+        }
+        const auto behind = graph_anchor - at;
+        return behind < unix_anchor ? unix_anchor - behind : 0;
+    }
+};
+
+}  // namespace exeray::event
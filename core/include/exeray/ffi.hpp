@@ -1,9 +1,21 @@
 #pragma once
 
 #include "exeray/engine.hpp"
+#include "exeray/event/live_view.hpp"
+#include "exeray/event/query.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
 #include <memory>
 #include <optional>
+#include <span>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -49,6 +61,132 @@ inline std::wstring utf8_to_wstring(const std::string& s) {
     return utf8_to_wstring(s.data(), s.size());
 }
 
+/// @brief Header fields of one event, copied in bulk to Rust.
+///
+/// Mirrored by exeray_ffi::EventRecord (#[repr(C)]); the layout is fixed
+/// so a slice of them crosses the bridge as plain memory.
+struct EventRecord {
+    std::uint64_t id;
+    std::uint64_t parent_id;
+    std::uint64_t timestamp;
+    std::uint8_t category;
+    std::uint8_t status;
+    std::uint8_t operation;
+    std::uint8_t reserved[5];
+};
+static_assert(sizeof(EventRecord) == 32, "EventRecord layout is shared with Rust");
+
+/// @brief Nodes of one graph segment, borrowed in place by Rust.
+///
+/// Mirrored by exeray_ffi::EventSpan, whose nodes are exeray_ffi::EventNode;
+/// the offsets below are checked on the Rust side as well.
+using EventSpan = event::EventGraph::SegmentSpan;
+static_assert(std::is_standard_layout_v<event::EventNode> &&
+                  std::is_trivially_copyable_v<event::EventNode>,
+              "EventNode is read in place by Rust");
+static_assert(offsetof(event::EventNode, parent_id) == 8 &&
+                  offsetof(event::EventNode, timestamp) == 16 &&
+                  offsetof(event::EventNode, correlation_id) == 24 &&
+                  offsetof(event::EventNode, status) == 28 &&
+                  offsetof(event::EventNode, operation) == 29 &&
+                  offsetof(event::EventNode, payload) == 32,
+              "EventNode layout is shared with Rust");
+static_assert(sizeof(EventSpan) == 32, "EventSpan layout is shared with Rust");
+
+/// @brief Anchor mapping graph timestamps to Unix-epoch ns.
+///
+/// Mirrored by exeray_ffi::WallClock, which converts on the Rust side
+/// without a call per event.
+using WallClock = event::WallClock;
+static_assert(sizeof(WallClock) == 16 && offsetof(WallClock, unix_anchor) == 8,
+              "WallClock layout is shared with Rust");
+
+/// @brief Filter, order and time range of a query built on the Rust side.
+///
+/// Mirrored by exeray_ffi::QuerySpec; fields as in event::FilterSpec. The
+/// result buffer's length is the limit.
+struct QuerySpec {
+    std::uint64_t from;
+    std::uint64_t to;
+    std::uint32_t categories;
+    std::uint32_t statuses;
+    std::uint32_t pid;
+    std::uint32_t correlation_id;
+    std::int16_t operation;
+    std::uint16_t remote_port;
+    std::uint8_t newest_first;
+    std::uint8_t reserved[3];
+};
+static_assert(sizeof(QuerySpec) == 40, "QuerySpec layout is shared with Rust");
+
+namespace detail {
+
+/// @brief Private helper to turn a QuerySpec into the filter it describes.
+inline event::FilterSpec filter_of(const QuerySpec& spec) {
+    event::FilterSpec filter;
+    filter.categories = spec.categories;
+    filter.statuses = spec.statuses;
+    filter.operation = spec.operation;
+    filter.pid = spec.pid;
+    filter.remote_port = spec.remote_port;
+    filter.correlation_id = spec.correlation_id;
+    filter.from = spec.from;
+    filter.to = spec.to;
+    return filter;
+}
+
+} // namespace detail
+
+/// @brief One query result; mirrored by exeray_ffi::QueryRow.
+using QueryRow = event::QueryRow;
+static_assert(std::is_trivially_copyable_v<QueryRow> && sizeof(QueryRow) == 32 &&
+                  offsetof(QueryRow, pid) == 16 && offsetof(QueryRow, remote_port) == 24 &&
+                  offsetof(QueryRow, status) == 28,
+              "QueryRow layout is shared with Rust");
+
+/// @brief One event turning Suspicious; mirrored by exeray_ffi::AlertRecord.
+using AlertRecord = event::Alert;
+static_assert(std::is_trivially_copyable_v<AlertRecord> && offsetof(AlertRecord, pid) == 16 &&
+                  offsetof(AlertRecord, category) == 20 && offsetof(AlertRecord, late) == 22,
+              "AlertRecord layout is shared with Rust");
+
+/// @brief Dashboard counters in one crossing; mirrored by exeray_ffi::StatsSnapshot.
+///
+/// Read from the push-time counters and session metrics, never from a
+/// graph scan, so polling it does not slow ingest. Cumulative fields never
+/// decrease: rates are the difference of two snapshots over taken_ns.
+struct StatsSnapshot {
+    static constexpr std::size_t kCategories = static_cast<std::size_t>(event::Category::Count);
+    static constexpr std::size_t kTopPids = 8;
+
+    std::uint64_t taken_ns;                 ///< Steady clock when taken
+    std::uint64_t pushed[kCategories];      ///< Events stored per category, cumulative
+    std::uint64_t live[kCategories];        ///< Live events per category
+    std::uint64_t flagged;                  ///< Events marked Suspicious, cumulative
+    std::uint64_t live_suspicious;          ///< Live events with Status::Suspicious
+    std::uint64_t events_lost;              ///< ETW could not buffer (current session)
+    std::uint64_t buffers_lost;             ///< Real-time buffers dropped
+    std::uint64_t ring_overflows;           ///< Records dropped by a full record ring
+    std::uint64_t shed;                     ///< Events dropped by load shedding
+    std::uint32_t top_pids[kTopPids];       ///< Processes with the most live events
+    std::uint64_t top_counts[kTopPids];     ///< Their live events
+    std::uint32_t top_len;                  ///< Valid entries of top_pids
+    std::uint32_t reserved;
+};
+static_assert(std::is_trivially_copyable_v<StatsSnapshot> && sizeof(StatsSnapshot) == 432 &&
+                  offsetof(StatsSnapshot, top_counts) == 360,
+              "StatsSnapshot layout is shared with Rust");
+
+/// @brief UTF-8 bytes of one interned string, in place in arena memory.
+///
+/// Mirrored by exeray_ffi::StringRef. Stays valid until the session is
+/// reset, so Rust borrows it for as long as it borrows the engine.
+struct StringRef {
+    const char* data;
+    std::size_t length;
+};
+static_assert(sizeof(StringRef) == 16, "StringRef layout is shared with Rust");
+
 // Log levels: 0=trace, 1=debug, 2=info, 3=warn, 4=error
 constexpr int kDefaultLogLevel = 2;  // info level
 
@@ -71,6 +209,242 @@ public:
     event::EventGraph& graph() { return engine_.graph(); }
     const event::EventGraph& graph() const { return engine_.graph(); }
 
+    /// @brief Wall-clock anchor of the current session; see Engine::wall_clock().
+    WallClock wall_clock() const { return engine_.wall_clock(); }
+
+    /// @brief Block until events newer than seen exist or timeout_ms passes.
+    /// @return Newest EventId; see Engine::wait_for_events().
+    std::uint64_t wait_for_events(std::uint64_t seen, std::uint32_t timeout_ms) {
+        return engine_.wait_for_events(seen, std::chrono::milliseconds(timeout_ms));
+    }
+
+    /// @brief Block until an alert is queued or timeout_ms passes.
+    /// @return Whether alerts are waiting; see Engine::alerts().
+    bool wait_for_alerts(std::uint32_t timeout_ms) {
+        return engine_.alerts().wait(std::chrono::milliseconds(timeout_ms));
+    }
+
+    /// @brief Move the oldest queued alerts into out; the alert queue has
+    /// one consumer, so only one thread may pop.
+    /// @return Number of alerts written.
+    std::size_t pop_alerts(AlertRecord* out, std::size_t count) {
+        return engine_.alerts().pop(std::span<AlertRecord>(out, count));
+    }
+
+#ifdef EXERAY_HAS_CXX
+    /// @brief pop_alerts() into a Rust slice.
+    std::size_t pop_alerts(rust::Slice<AlertRecord> out) {
+        return pop_alerts(out.data(), out.size());
+    }
+#endif
+
+    // Memory statistics
+    MemoryStats memory_stats() const { return engine_.memory_stats(); }
+
+    // ETW session loss counters
+    etw::SessionStats session_stats() const { return engine_.session_stats(); }
+
+    /// @brief Counters for a live dashboard; cheap enough to poll at 10 Hz.
+    StatsSnapshot stats_snapshot() const {
+        StatsSnapshot stats{};
+        stats.taken_ns = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch())
+                .count());
+        const event::EventCounters& counters = graph().counters();
+        const event::CounterSnapshot cells = counters.snapshot();
+        for (std::size_t c = 0; c < StatsSnapshot::kCategories; ++c) {
+            stats.pushed[c] = cells.pushed[c];
+            stats.live[c] = cells.category(static_cast<event::Category>(c));
+        }
+        stats.flagged = cells.flagged;
+        stats.live_suspicious = cells.status(event::Status::Suspicious);
+
+        const etw::SessionStats session = engine_.session_stats();
+        stats.events_lost = session.events_lost;
+        stats.buffers_lost = session.buffers_lost;
+        stats.ring_overflows = engine_.ingest_stats().overflows;
+        stats.shed = engine_.shed_stats().total;
+
+        std::array<event::PidCount, StatsSnapshot::kTopPids> top{};
+        stats.top_len = static_cast<std::uint32_t>(counters.top_pids(top));
+        for (std::size_t i = 0; i < stats.top_len; ++i) {
+            stats.top_pids[i] = top[i].pid;
+            stats.top_counts[i] = top[i].count;
+        }
+        return stats;
+    }
+
+    /// @brief Take a new parse metrics snapshot for the parse_* accessors.
+    /// @return Number of event ID rows in the snapshot.
+    std::size_t refresh_parse_metrics() {
+        parse_metrics_ = engine_.parse_metrics();
+        return parse_metrics_.events.size();
+    }
+
+    /// @brief Snapshot taken by the last refresh_parse_metrics().
+    const etw::ParseMetricsSnapshot& parse_metrics() const noexcept { return parse_metrics_; }
+
+#ifdef EXERAY_HAS_CXX
+    /// @brief Write the recent hot-path spans as a Chrome trace (FFI version).
+    /// @param path UTF-8 encoded path from Rust &str.
+    bool dump_spans(rust::Str path) const {
+        return engine_.dump_spans(utf8_to_wstring(path.data(), path.length()));
+    }
+#endif
+
+    /// @brief Write the recent hot-path spans as a Chrome trace.
+    /// @param path UTF-8 encoded output path.
+    bool dump_spans(const std::string& path) const {
+        return engine_.dump_spans(utf8_to_wstring(path));
+    }
+
+    /// @brief Start, restart or (with 0) stop stage sampling.
+    bool set_profiling(std::uint32_t interval_us) { return engine_.set_profiling(interval_us); }
+
+#ifdef EXERAY_HAS_CXX
+    /// @brief Write the stage samples as folded stacks (FFI version).
+    /// @param path UTF-8 encoded path from Rust &str.
+    bool dump_profile(rust::Str path) const {
+        return engine_.dump_profile(utf8_to_wstring(path.data(), path.length()));
+    }
+#endif
+
+    /// @brief Write the stage samples as folded stacks.
+    /// @param path UTF-8 encoded output path.
+    bool dump_profile(const std::string& path) const {
+        return engine_.dump_profile(utf8_to_wstring(path));
+    }
+
+    /// @brief Take a metrics snapshot for the metric_* accessors.
+    /// @return Number of samples, sorted by name.
+    std::size_t refresh_metrics() {
+        metrics_ = engine_.metrics().snapshot();
+        return metrics_.size();
+    }
+
+    /// @brief Snapshot taken by the last refresh_metrics().
+    const std::vector<MetricSample>& metrics() const noexcept { return metrics_; }
+
+#ifdef EXERAY_HAS_CXX
+    /// @brief Current metrics as Prometheus or OpenMetrics text (FFI version).
+    rust::String metrics_text(bool open_metrics) const {
+        const std::string text = metrics_string(open_metrics);
+        return rust::String(text.data(), text.size());
+    }
+#endif
+
+    /// @brief Current metrics as Prometheus or OpenMetrics text.
+    std::string metrics_string(bool open_metrics) const {
+        std::ostringstream out;
+        engine_.metrics().write(out, open_metrics ? MetricsFormat::OpenMetrics
+                                                  : MetricsFormat::Prometheus);
+        return out.str();
+    }
+
+    /// @brief Take a snapshot of the modules of pid for the module_* accessors.
+    /// @return Number of modules, sorted by base.
+    std::size_t refresh_modules(std::uint32_t pid) {
+        modules_ = engine_.modules(pid);
+        return modules_.size();
+    }
+
+    /// @brief Snapshot taken by the last refresh_modules().
+    const std::vector<etw::ModuleInfo>& modules() const noexcept { return modules_; }
+
+    /// @brief Take a snapshot of the k riskiest processes (or chains) for the risk_* accessors.
+    /// @return Number of rows, riskiest first.
+    std::size_t refresh_risk(bool chains, std::size_t k) {
+        risk_ = chains ? engine_.riskiest_chains(k) : engine_.riskiest_processes(k);
+        return risk_.size();
+    }
+
+    /// @brief Snapshot taken by the last refresh_risk().
+    const std::vector<event::RiskScore>& risk() const noexcept { return risk_; }
+
+    /// @brief Take a pre-order snapshot of the process tree below root for the
+    /// process_* accessors (root 0 = every tree; at most max_nodes rows).
+    /// @return Number of rows.
+    std::size_t refresh_process_tree(std::uint64_t root, std::size_t max_nodes) {
+        process_tree_ = engine_.process_tree().descendants(root, max_nodes);
+        return process_tree_.size();
+    }
+
+    /// @brief Snapshot taken by the last refresh_process_tree().
+    const std::vector<event::ProcessTreeNode>& process_tree() const noexcept {
+        return process_tree_;
+    }
+
+    /// @brief The engine's string pool.
+    const event::StringPool& strings() const { return engine_.strings(); }
+
+    /// @brief Text of an interned string (empty if invalid).
+    std::string_view string(event::StringId id) const { return engine_.strings().get(id); }
+
+    // Ingest latency percentiles
+    etw::LatencySummary ingest_latency(etw::LatencyStage stage, event::Category category) const {
+        return engine_.ingest_latency(stage, category);
+    }
+
+    // -------------------------------------------------------------------------
+    // Live Views
+    // -------------------------------------------------------------------------
+
+    /// @brief Open a filtered, sorted view kept up to date by view_refresh().
+    /// @param spec Filter; newest_first sorts descending.
+    /// @param sort event::ViewSort (0 = id, 1 = timestamp, 2 = pid).
+    /// @param page_size Rows per page.
+    /// @return View ID for the other view_* calls.
+    std::size_t view_open(const QuerySpec& spec, std::uint8_t sort, std::size_t page_size) {
+        const event::ViewOptions options{
+            sort <= static_cast<std::uint8_t>(event::ViewSort::Pid)
+                ? static_cast<event::ViewSort>(sort)
+                : event::ViewSort::Id,
+            spec.newest_first != 0, page_size};
+        views_.push_back(
+            std::make_unique<event::LiveView>(graph(), detail::filter_of(spec), options));
+        return views_.size() - 1;
+    }
+
+    /// @brief Test the events published since the last refresh against view.
+    /// @return Number of matches in the view (0 if view is not open).
+    std::size_t view_refresh(std::size_t view) {
+        event::LiveView* live = find_view(view);
+        if (live == nullptr) {
+            return 0;
+        }
+        live->refresh();
+        return live->size();
+    }
+
+    /// @brief Number of pages of view as of its last refresh.
+    std::size_t view_pages(std::size_t view) const {
+        const event::LiveView* live = find_view(view);
+        return live != nullptr ? live->pages() : 0;
+    }
+
+    /// @brief Copy one page of view into out.
+    /// @return Number of rows written.
+    std::size_t view_page(std::size_t view, std::size_t page, QueryRow* out,
+                          std::size_t count) const {
+        const event::LiveView* live = find_view(view);
+        return live != nullptr ? live->page(page, std::span<QueryRow>(out, count)) : 0;
+    }
+
+#ifdef EXERAY_HAS_CXX
+    /// @brief view_page() into a Rust slice.
+    std::size_t view_page(std::size_t view, std::size_t page, rust::Slice<QueryRow> out) const {
+        return view_page(view, page, out.data(), out.size());
+    }
+#endif
+
+    /// @brief Close view; its ID is not reused.
+    void view_close(std::size_t view) {
+        if (view < views_.size()) {
+            views_[view].reset();
+        }
+    }
+
     // -------------------------------------------------------------------------
     // Monitoring Control
     // -------------------------------------------------------------------------
@@ -91,9 +465,19 @@ public:
         return engine_.start_monitoring(utf8_to_wstring(exe_path));
     }
 
-    /// @brief Stop monitoring and terminate the target process.
+    /// @brief Start monitoring an already running process without relaunching it.
+    /// @param pid Process to attach to.
+    /// @param with_tree Also monitor the descendants it has now.
+    /// @return true if monitoring started successfully.
+    bool attach(uint32_t pid, bool with_tree) { return engine_.attach(pid, with_tree); }
+
+    /// @brief Stop monitoring and terminate the target process, draining the
+    /// events ETW still buffers (up to EngineConfig::stop_drain_ms).
     void stop_monitoring() { engine_.stop_monitoring(); }
 
+    /// @brief Stop monitoring at once, dropping what ETW still buffers.
+    void detach_monitoring() { engine_.stop_monitoring(std::chrono::milliseconds(0)); }
+
     // -------------------------------------------------------------------------
     // Target Process Control
     // -------------------------------------------------------------------------
@@ -119,8 +503,25 @@ public:
     /// @return true if monitoring and target is running.
     bool target_running() const noexcept { return engine_.is_monitoring(); }
 
+    /// @brief Query the targets' jobs for the target_usage_* accessors.
+    void refresh_target_usage() { target_usage_ = engine_.target_usage(); }
+
+    /// @brief Snapshot taken by the last refresh_target_usage().
+    const process::JobAccounting& target_usage() const noexcept { return target_usage_; }
+
 private:
+    event::LiveView* find_view(std::size_t view) const {
+        return view < views_.size() ? views_[view].get() : nullptr;
+    }
+
     Engine engine_;
+    process::JobAccounting target_usage_;
+    etw::ParseMetricsSnapshot parse_metrics_;
+    std::vector<MetricSample> metrics_;
+    std::vector<etw::ModuleInfo> modules_;
+    std::vector<event::RiskScore> risk_;
+    std::vector<event::ProcessTreeNode> process_tree_;
+    std::vector<std::unique_ptr<event::LiveView>> views_;  ///< Closed views are null
 };
 
 inline std::unique_ptr<Handle> create(std::size_t arena_mb, std::size_t threads) {
@@ -128,20 +529,453 @@ inline std::unique_ptr<Handle> create(std::size_t arena_mb, std::size_t threads)
 }
 
 // Event accessor functions for FFI
+//
+// Event indexes are absolute (index = EventId - 1). In ring retention mode the
+// oldest events are evicted, so live indexes are
+// [event_first_index, event_first_index + event_count).
+
+/// @brief Number of live events in the graph.
 inline std::size_t event_count(const Handle& h) {
     return h.graph().count();
 }
 
+/// @brief Index of the oldest live event (0 unless events were evicted).
+inline std::size_t event_first_index(const Handle& h) {
+    return static_cast<std::size_t>(h.graph().oldest_id() - 1);
+}
+
+/// @brief Eviction epoch; changes whenever older events are recycled.
+inline std::uint64_t event_epoch(const Handle& h) {
+    return h.graph().epoch();
+}
+
+/// @brief Check whether an absolute event index is live.
+inline bool event_exists(const Handle& h, std::size_t index) {
+    return h.graph().exists(static_cast<event::EventId>(index + 1));
+}
+
+// Memory statistics for FFI
+//
+// Arena selector: 0 = events, 1 = strings, 2 = scratch. With a shared string
+// arena selector 1 reports the events arena. Each call reads fresh counters.
+
+/// @brief Arena selector values for the memory_arena_* accessors.
+enum class MemoryArena : std::uint8_t { Events = 0, Strings = 1, Scratch = 2 };
+
+namespace detail {
+
+/// @brief Private helper to select one arena's counters.
+inline ArenaStats arena_stats(const Handle& h, std::uint8_t arena) {
+    const MemoryStats stats = h.memory_stats();
+    switch (static_cast<MemoryArena>(arena)) {
+        case MemoryArena::Events: return stats.events;
+        case MemoryArena::Strings: return stats.strings;
+        case MemoryArena::Scratch: return stats.scratch;
+    }
+    return {};
+}
+
+} // namespace detail
+
+inline std::size_t memory_arena_used(const Handle& h, std::uint8_t arena) {
+    return detail::arena_stats(h, arena).used;
+}
+
+inline std::size_t memory_arena_committed(const Handle& h, std::uint8_t arena) {
+    return detail::arena_stats(h, arena).committed;
+}
+
+inline std::size_t memory_arena_reserved(const Handle& h, std::uint8_t arena) {
+    return detail::arena_stats(h, arena).reserved;
+}
+
+inline std::size_t memory_arena_capacity(const Handle& h, std::uint8_t arena) {
+    return detail::arena_stats(h, arena).capacity;
+}
+
+inline std::size_t memory_arena_high_water(const Handle& h, std::uint8_t arena) {
+    return detail::arena_stats(h, arena).high_water;
+}
+
+inline std::size_t memory_arena_padding(const Handle& h, std::uint8_t arena) {
+    return detail::arena_stats(h, arena).padding;
+}
+
+inline std::uint64_t memory_arena_failures(const Handle& h, std::uint8_t arena) {
+    return detail::arena_stats(h, arena).failures;
+}
+
+/// @brief Whether strings share the events arena.
+inline bool memory_strings_shared(const Handle& h) {
+    return h.memory_stats().strings_shared;
+}
+
+/// @brief Arena bytes holding event nodes, links, indexes and columns.
+inline std::size_t memory_event_bytes(const Handle& h) {
+    return h.memory_stats().event_bytes;
+}
+
+/// @brief Arena bytes holding interned strings.
+inline std::size_t memory_string_bytes(const Handle& h) {
+    return h.memory_stats().string_bytes;
+}
+
+/// @brief Number of unique interned strings.
+inline std::size_t memory_string_count(const Handle& h) {
+    return h.memory_stats().string_count;
+}
+
+// ETW session statistics for FFI
+//
+// Cumulative counters of the current or last monitoring session, sampled
+// periodically; all zero before the first session.
+
+/// @brief Events ETW dropped because no buffer was free.
+inline std::uint64_t session_events_lost(const Handle& h) {
+    return h.session_stats().events_lost;
+}
+
+/// @brief Real-time buffers ETW dropped before delivering them.
+inline std::uint64_t session_buffers_lost(const Handle& h) {
+    return h.session_stats().buffers_lost;
+}
+
+/// @brief Buffers filled by the session.
+inline std::uint64_t session_buffers_written(const Handle& h) {
+    return h.session_stats().buffers_written;
+}
+
+/// @brief Buffers delivered to the consumer.
+inline std::uint64_t session_buffers_read(const Handle& h) {
+    return h.session_stats().buffers_read;
+}
+
+/// @brief Buffers currently unused by the session.
+inline std::uint32_t session_free_buffers(const Handle& h) {
+    return h.session_stats().free_buffers;
+}
+
+/// @brief Buffers currently allocated by the session.
+inline std::uint32_t session_buffer_count(const Handle& h) {
+    return h.session_stats().buffers;
+}
+
+// Target job accounting for FFI
+//
+// Read from the snapshot of the last refresh_target_usage(); summed over the
+// launched targets, all zero without one.
+
+/// @brief CPU time the targets spent in user mode.
+inline std::uint64_t target_usage_user_ns(const Handle& h) {
+    return h.target_usage().user_time_ns;
+}
+
+/// @brief CPU time the targets spent in kernel mode.
+inline std::uint64_t target_usage_kernel_ns(const Handle& h) {
+    return h.target_usage().kernel_time_ns;
+}
+
+/// @brief Bytes the targets read.
+inline std::uint64_t target_usage_read_bytes(const Handle& h) {
+    return h.target_usage().read_bytes;
+}
+
+/// @brief Bytes the targets wrote.
+inline std::uint64_t target_usage_write_bytes(const Handle& h) {
+    return h.target_usage().write_bytes;
+}
+
+/// @brief Bytes of other I/O (device control...).
+inline std::uint64_t target_usage_other_bytes(const Handle& h) {
+    return h.target_usage().other_bytes;
+}
+
+/// @brief Highest committed memory of one target process.
+inline std::uint64_t target_usage_peak_process_memory(const Handle& h) {
+    return h.target_usage().peak_process_memory;
+}
+
+/// @brief Highest committed memory of one target's whole job.
+inline std::uint64_t target_usage_peak_job_memory(const Handle& h) {
+    return h.target_usage().peak_job_memory;
+}
+
+/// @brief Processes still running in the targets' jobs.
+inline std::uint32_t target_usage_active_processes(const Handle& h) {
+    return h.target_usage().active_processes;
+}
+
+// Parse metrics for FFI
+//
+// Read from the snapshot of the last refresh_parse_metrics(); providers are
+// indexed by etw::MetricProvider, event rows are most expensive first.
+// Out-of-range indexes read as zero.
+
+namespace detail {
+
+/// @brief Private helper to select one provider's totals.
+inline etw::ProviderMetrics parse_provider(const Handle& h, std::uint8_t provider) {
+    if (provider >= etw::kMetricProviders) {
+        return {};
+    }
+    return h.parse_metrics().providers[provider];
+}
+
+/// @brief Private helper to select one event ID row.
+inline etw::EventMetrics parse_event(const Handle& h, std::size_t row) {
+    const auto& events = h.parse_metrics().events;
+    return row < events.size() ? events[row] : etw::EventMetrics{};
+}
+
+} // namespace detail
+
+/// @brief Records of a provider dispatched to its parser.
+inline std::uint64_t parse_provider_events(const Handle& h, std::uint8_t provider) {
+    return detail::parse_provider(h, provider).events;
+}
+
+/// @brief Records of a provider its parser rejected.
+inline std::uint64_t parse_provider_failures(const Handle& h, std::uint8_t provider) {
+    return detail::parse_provider(h, provider).failures;
+}
+
+/// @brief Cycles spent parsing a provider's records.
+inline std::uint64_t parse_provider_cycles(const Handle& h, std::uint8_t provider) {
+    return detail::parse_provider(h, provider).cycles;
+}
+
+/// @brief Parses of a provider in one log2 cycle histogram bucket.
+inline std::uint64_t parse_provider_bucket(const Handle& h, std::uint8_t provider,
+                                           std::size_t bucket) {
+    const auto histogram = detail::parse_provider(h, provider).histogram;
+    return bucket < histogram.size() ? histogram[bucket] : 0;
+}
+
+/// @brief Provider (etw::MetricProvider) of an event ID row.
+inline std::uint8_t parse_event_provider(const Handle& h, std::size_t row) {
+    return static_cast<std::uint8_t>(detail::parse_event(h, row).provider);
+}
+
+/// @brief EventDescriptor.Id of an event ID row.
+inline std::uint16_t parse_event_id(const Handle& h, std::size_t row) {
+    return detail::parse_event(h, row).event_id;
+}
+
+inline std::uint64_t parse_event_events(const Handle& h, std::size_t row) {
+    return detail::parse_event(h, row).events;
+}
+
+inline std::uint64_t parse_event_failures(const Handle& h, std::size_t row) {
+    return detail::parse_event(h, row).failures;
+}
+
+inline std::uint64_t parse_event_cycles(const Handle& h, std::size_t row) {
+    return detail::parse_event(h, row).cycles;
+}
+
+/// @brief Records counted per provider only (per-thread event tables full).
+inline std::uint64_t parse_untracked(const Handle& h) {
+    return h.parse_metrics().untracked;
+}
+
+// Engine metrics for FFI
+//
+// Read from the snapshot of the last refresh_metrics(); out-of-range rows
+// read as zero or empty.
+
+namespace detail {
+
+/// @brief Private helper to select one sample.
+inline const MetricSample& metric_row(const Handle& h, std::size_t row) {
+    static const MetricSample empty{};
+    const auto& metrics = h.metrics();
+    return row < metrics.size() ? metrics[row] : empty;
+}
+
+} // namespace detail
+
+/// @brief MetricType of the sample.
+inline std::uint8_t metric_type(const Handle& h, std::size_t row) {
+    return static_cast<std::uint8_t>(detail::metric_row(h, row).type);
+}
+
+/// @brief Counter or gauge value; sum of observations for histograms.
+inline double metric_value(const Handle& h, std::size_t row) {
+    return detail::metric_row(h, row).value;
+}
+
+/// @brief Observations of a histogram.
+inline std::uint64_t metric_count(const Handle& h, std::size_t row) {
+    return detail::metric_row(h, row).count;
+}
+
+/// @brief Observations of a histogram in one log2 bucket (not cumulative).
+inline std::uint64_t metric_bucket(const Handle& h, std::size_t row, std::size_t bucket) {
+    const auto& buckets = detail::metric_row(h, row).buckets;
+    return bucket < buckets.size() ? buckets[bucket] : 0;
+}
+
+#ifdef EXERAY_HAS_CXX
+inline rust::String metric_name(const Handle& h, std::size_t row) {
+    const std::string& name = detail::metric_row(h, row).name;
+    return rust::String(name.data(), name.size());
+}
+inline rust::String metric_help(const Handle& h, std::size_t row) {
+    const std::string& help = detail::metric_row(h, row).help;
+    return rust::String(help.data(), help.size());
+}
+/// @brief Rendered label pairs, e.g. provider="File".
+inline rust::String metric_labels(const Handle& h, std::size_t row) {
+    const std::string& labels = detail::metric_row(h, row).labels;
+    return rust::String(labels.data(), labels.size());
+}
+#endif
+
+// Loaded modules for FFI
+//
+// Read from the snapshot of the last refresh_modules(); out-of-range rows
+// read as zero or empty.
+
+namespace detail {
+
+/// @brief Private helper to select one module row.
+inline etw::ModuleInfo module_row(const Handle& h, std::size_t row) {
+    const auto& modules = h.modules();
+    return row < modules.size() ? modules[row] : etw::ModuleInfo{};
+}
+
+} // namespace detail
+
+inline std::uint64_t module_base(const Handle& h, std::size_t row) {
+    return detail::module_row(h, row).base;
+}
+inline std::uint64_t module_size(const Handle& h, std::size_t row) {
+    return detail::module_row(h, row).size;
+}
+
+#ifdef EXERAY_HAS_CXX
+inline rust::String module_path(const Handle& h, std::size_t row) {
+    const std::string_view path = h.string(detail::module_row(h, row).path);
+    return rust::String(path.data(), path.size());
+}
+#endif
+
+// Risk scores for FFI
+//
+// Read from the snapshot of the last refresh_risk(); out-of-range rows read
+// as zero.
+
+namespace detail {
+
+/// @brief Private helper to select one risk row.
+inline event::RiskScore risk_row(const Handle& h, std::size_t row) {
+    const auto& risk = h.risk();
+    return row < risk.size() ? risk[row] : event::RiskScore{};
+}
+
+} // namespace detail
+
+/// @brief PID or correlation ID of the row.
+inline std::uint32_t risk_key(const Handle& h, std::size_t row) {
+    return detail::risk_row(h, row).key;
+}
+inline double risk_score(const Handle& h, std::size_t row) {
+    return detail::risk_row(h, row).score;
+}
+inline std::uint64_t risk_events(const Handle& h, std::size_t row) {
+    return detail::risk_row(h, row).events;
+}
+
+// Process tree for FFI
+//
+// Read from the snapshot of the last refresh_process_tree(); out-of-range
+// rows read as zero.
+
+namespace detail {
+
+/// @brief Private helper to select one tree row.
+inline event::ProcessTreeNode process_row(const Handle& h, std::size_t row) {
+    const auto& nodes = h.process_tree();
+    return row < nodes.size() ? nodes[row] : event::ProcessTreeNode{};
+}
+
+} // namespace detail
+
+/// @brief ProcessCreate event of the row (its key; 0 past the end).
+inline std::uint64_t process_create(const Handle& h, std::size_t row) {
+    return detail::process_row(h, row).create;
+}
+/// @brief Parent's ProcessCreate event (0 for roots).
+inline std::uint64_t process_parent(const Handle& h, std::size_t row) {
+    return detail::process_row(h, row).parent;
+}
+inline std::uint32_t process_pid(const Handle& h, std::size_t row) {
+    return detail::process_row(h, row).pid;
+}
+inline std::uint32_t process_depth(const Handle& h, std::size_t row) {
+    return detail::process_row(h, row).depth;
+}
+/// @brief Whether the process has terminated.
+inline bool process_stopped(const Handle& h, std::size_t row) {
+    return detail::process_row(h, row).stop != 0;
+}
+inline std::uint64_t process_events(const Handle& h, std::size_t row) {
+    return detail::process_row(h, row).events;
+}
+inline std::uint64_t process_subtree_events(const Handle& h, std::size_t row) {
+    return detail::process_row(h, row).subtree_events;
+}
+
+// Ingest latency for FFI (stage: 0 = delivered, 1 = visible, 2 = detected; category:
+// event::Category, Category::Count = all). Nanoseconds; all zero before the first session.
+
+namespace detail {
+
+/// @brief Private helper to select one stage and category.
+inline etw::LatencySummary latency(const Handle& h, std::uint8_t stage, std::uint8_t category) {
+    return h.ingest_latency(static_cast<etw::LatencyStage>(stage),
+                            static_cast<event::Category>(category));
+}
+
+} // namespace detail
+
+/// @brief Events sampled.
+inline std::uint64_t latency_count(const Handle& h, std::uint8_t stage, std::uint8_t category) {
+    return detail::latency(h, stage, category).count;
+}
+
+inline std::uint64_t latency_p50(const Handle& h, std::uint8_t stage, std::uint8_t category) {
+    return detail::latency(h, stage, category).p50;
+}
+
+inline std::uint64_t latency_p99(const Handle& h, std::uint8_t stage, std::uint8_t category) {
+    return detail::latency(h, stage, category).p99;
+}
+
+inline std::uint64_t latency_p999(const Handle& h, std::uint8_t stage, std::uint8_t category) {
+    return detail::latency(h, stage, category).p999;
+}
+
+inline std::uint64_t latency_max(const Handle& h, std::uint8_t stage, std::uint8_t category) {
+    return detail::latency(h, stage, category).max;
+}
+
+/// @brief Event budget of the graph (events beyond it are dropped or evicted).
+inline std::size_t event_capacity(const Handle& h) {
+    return h.graph().capacity();
+}
+
 namespace detail {
 
 /// @brief Private helper to get EventView by index with bounds checking.
 /// @param h Handle reference.
-/// @param index Zero-based event index.
-/// @return Optional EventView, empty if index is out of bounds.
+/// @param index Zero-based absolute event index.
+/// @return Optional EventView, empty if index is out of bounds or evicted.
 inline std::optional<event::EventView> get_event_view(const Handle& h, std::size_t index) {
-    if (index >= h.graph().count()) return std::nullopt;
     // IDs are 1-indexed, so we need id = index + 1
-    return h.graph().get(static_cast<event::EventId>(index + 1));
+    const auto id = static_cast<event::EventId>(index + 1);
+    if (!h.graph().exists(id)) return std::nullopt;
+    return h.graph().get(id);
 }
 
 } // namespace detail
@@ -161,6 +995,12 @@ inline std::uint64_t event_get_timestamp(const Handle& h, std::size_t index) {
     return ev ? ev->timestamp() : 0;
 }
 
+/// @brief Event time as Unix-epoch ns (0 if unknown).
+inline std::uint64_t event_get_wall_time(const Handle& h, std::size_t index) {
+    auto ev = detail::get_event_view(h, index);
+    return ev ? h.wall_clock().to_unix(ev->timestamp()) : 0;
+}
+
 inline std::uint8_t event_get_category(const Handle& h, std::size_t index) {
     auto ev = detail::get_event_view(h, index);
     return ev ? static_cast<std::uint8_t>(ev->category()) : 0;
@@ -176,5 +1016,83 @@ inline std::uint8_t event_get_operation(const Handle& h, std::size_t index) {
     return ev ? ev->operation() : 0;
 }
 
+/// @brief Copy the run of events starting at index into out.
+///
+/// One crossing for up to count events instead of six per event. Stops
+/// early at an event not yet published or the newest one; an index below
+/// the oldest live event starts at the oldest, so check the copied IDs.
+/// @return Number of records written.
+inline std::size_t event_copy_run(const Handle& h, std::size_t index, EventRecord* out,
+                                  std::size_t count) {
+    std::size_t written = 0;
+    h.graph().for_each_run(index, count, [out, &written](const event::EventNode& node) {
+        EventRecord& record = out[written++];
+        record.id = node.id;
+        record.parent_id = node.parent_id;
+        record.timestamp = node.timestamp;
+        record.category = static_cast<std::uint8_t>(node.payload.category);
+        record.status = static_cast<std::uint8_t>(node.status);
+        record.operation = node.operation;
+        std::memset(record.reserved, 0, sizeof(record.reserved));
+    });
+    return written;
+}
+
+/// @brief Borrow the published nodes from index to the end of their segment.
+///
+/// Zero-copy counterpart of event_copy_run(); see EventGraph::segment_span()
+/// for when the nodes may be recycled.
+inline EventSpan event_segment_span(const Handle& h, std::size_t index) {
+    return h.graph().segment_span(index);
+}
+
+/// @brief Run a query in the engine and copy up to count matching rows.
+///
+/// The filter runs in C++ over the indexes the planner picks, so only the
+/// matches cross the bridge.
+/// @return Number of rows written.
+inline std::size_t query_rows(const Handle& h, const QuerySpec& spec, QueryRow* out,
+                              std::size_t count) {
+    event::Query query;
+    query.filter = detail::filter_of(spec);
+    if (spec.newest_first != 0) {
+        query.newest_first();
+    }
+    return event::run_query(h.graph(), query, std::span<QueryRow>(out, count));
+}
+
+/// @brief Resolve count string IDs into out in one call.
+///
+/// An ID outside the pool's storage, invalid or unresolvable gives an
+/// empty string.
+inline void strings_resolve(const Handle& h, const event::StringId* ids, StringRef* out,
+                            std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::string_view text =
+            h.strings().in_range(ids[i]) ? h.string(ids[i]) : std::string_view{};
+        out[i] = {text.data(), text.size()};
+    }
+}
+
+#ifdef EXERAY_HAS_CXX
+/// @brief query_rows() into a Rust slice.
+inline std::size_t query_rows(const Handle& h, const QuerySpec& spec,
+                              rust::Slice<QueryRow> out) {
+    return query_rows(h, spec, out.data(), out.size());
+}
+
+/// @brief strings_resolve() between Rust slices (as many as both hold).
+inline void strings_resolve(const Handle& h, rust::Slice<const event::StringId> ids,
+                            rust::Slice<StringRef> out) {
+    strings_resolve(h, ids.data(), out.data(), std::min(ids.size(), out.size()));
+}
+
+/// @brief event_copy_run() into a Rust slice.
+inline std::size_t event_copy_run(const Handle& h, std::size_t index,
+                                  rust::Slice<EventRecord> out) {
+    return event_copy_run(h, index, out.data(), out.size());
+}
+#endif
+
 }
 
@@ -3,14 +3,46 @@
 ///
 /// Provides production-ready logging with:
 /// - Async logging (non-blocking for ETW hot path)
+/// - Flood filter in front of the async queue (rate limit and "repeated
+///   N times" deduplication)
 /// - Console and optional rotating file sinks
 /// - Configurable log levels
 /// - Automatic flush on error/critical
+/// - Compile-time minimum level (EXERAY_ACTIVE_LEVEL): calls below it are
+///   removed, arguments included
+/// - Per call site rate limits for messages logged per event
 
 #pragma once
 
 #include <spdlog/spdlog.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
+
+/// @name Log levels for EXERAY_ACTIVE_LEVEL (same order as spdlog's)
+/// @{
+#define EXERAY_LEVEL_TRACE 0
+#define EXERAY_LEVEL_DEBUG 1
+#define EXERAY_LEVEL_INFO 2
+#define EXERAY_LEVEL_WARN 3
+#define EXERAY_LEVEL_ERROR 4
+#define EXERAY_LEVEL_CRITICAL 5
+#define EXERAY_LEVEL_OFF 6
+/// @}
+
+/// @brief Lowest level compiled in (CMake option EXERAY_LOG_LEVEL).
+///
+/// Trace calls sit in per-event parser paths, so they are compiled out
+/// unless asked for; the runtime level of init() filters what remains.
+#ifndef EXERAY_ACTIVE_LEVEL
+#define EXERAY_ACTIVE_LEVEL EXERAY_LEVEL_DEBUG
+#endif
 
 namespace exeray::log {
 
@@ -32,38 +64,196 @@ void init(spdlog::level::level_enum level = spdlog::level::info,
 /// @return Reference to the exeray logger.
 spdlog::logger& get();
 
+/// @brief Messages held back by the logger's FloodFilter so far.
+struct FloodStats {
+    std::uint64_t dropped = 0;   ///< Over the rate limit
+    std::uint64_t repeated = 0;  ///< Copies of a message within its repeat window
+};
+
+/// @brief FloodFilter counters of the logger returned by get().
+[[nodiscard]] FloodStats flood_stats() noexcept;
+
+/// @brief Discard the held-back repeats, rate state and counters of the
+/// logger's FloodFilter, so tests do not see each other's messages.
+void reset_flood_filter();
+
 /// @brief Shutdown the logging system.
 ///
 /// Flushes all pending messages and releases resources.
 /// Should be called before program exit.
 void shutdown();
 
+/**
+ * @brief Allows a call site at most a number of messages per second.
+ *
+ * Keeps a flood of per-event messages (one suspicious DNS query per
+ * packet, say) from filling the async queue and blocking the ETW thread.
+ * Counts what it drops so the next allowed message can report it. The
+ * windows are approximate under contention: a few messages more may pass
+ * at a window boundary.
+ *
+ * Thread-safety: acquire() from any thread without locks.
+ */
+class RateLimit {
+public:
+    explicit constexpr RateLimit(std::uint32_t per_second) noexcept
+        : per_second_(per_second) {}
+
+    RateLimit(const RateLimit&) = delete;
+    RateLimit& operator=(const RateLimit&) = delete;
+
+    /// @brief Take a slot of the current one-second window.
+    /// @return 0 if the message must be dropped, otherwise 1 plus the
+    ///         messages dropped since the last one allowed.
+    [[nodiscard]] std::uint64_t acquire() noexcept;
+
+private:
+    std::uint32_t per_second_;
+    std::atomic<std::int64_t> window_{-1};  ///< steady_clock seconds
+    std::atomic<std::uint32_t> used_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+};
+
+/**
+ * @brief Token bucket and deduplication in front of the logger's queue.
+ *
+ * A misbehaving provider can raise the same warning thousands of times a
+ * second (a missing TDH schema, a malformed record). The logger passes
+ * every message through check() before queueing it, so a storm costs a
+ * hash and a table probe per message instead of a queue slot:
+ *
+ * - A message identical (level and text) to one logged less than
+ *   repeat_window ago is counted, not logged. The count is reported as
+ *   "repeated N times" when the message next appears after the window,
+ *   when its slot is taken by another message, or at flush_repeats().
+ * - Messages beyond per_second (with bursts up to burst) are dropped; the
+ *   number is reported before the next message that passes.
+ *
+ * Critical messages always pass. Not thread-safe (the logger serializes
+ * calls).
+ */
+class FloodFilter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Limits {
+        double per_second = 1000.0;  ///< Sustained messages per second
+        double burst = 2000.0;       ///< Messages that may pass at once
+        Clock::duration repeat_window = std::chrono::seconds(1);
+    };
+
+    /// @brief Copies of one message that were held back.
+    struct Repeat {
+        spdlog::level::level_enum level = spdlog::level::info;
+        std::string message;
+        std::uint64_t count = 0;
+    };
+
+    /// @brief What to do with one message.
+    struct Verdict {
+        bool emit = false;            ///< Log the message
+        std::uint64_t dropped = 0;    ///< When emit: messages dropped before it
+        std::optional<Repeat> repeat; ///< Log this summary first (emit or not)
+    };
+
+    /// Distinct messages tracked at once (direct-mapped by hash).
+    static constexpr std::size_t kSlots = 256;
+
+    FloodFilter() : FloodFilter(Limits{}) {}
+    explicit FloodFilter(const Limits& limits);
+
+    [[nodiscard]] Verdict check(spdlog::level::level_enum level, std::string_view message,
+                                Clock::time_point now);
+
+    /// @brief Summaries of every message with copies held back; resets them.
+    [[nodiscard]] std::vector<Repeat> flush_repeats();
+
+    [[nodiscard]] FloodStats stats() const noexcept { return stats_; }
+
+private:
+    struct Slot {
+        std::uint64_t hash = 0;
+        spdlog::level::level_enum level = spdlog::level::off;  ///< off = empty
+        std::string message;
+        Clock::time_point logged{};
+        std::uint64_t repeats = 0;
+    };
+
+    [[nodiscard]] static std::optional<Repeat> take_repeats(Slot& slot);
+
+    Limits limits_;
+    double tokens_;
+    Clock::time_point refilled_{};
+    std::uint64_t dropped_ = 0;  ///< Since the last message that passed
+    FloodStats stats_;
+    std::array<Slot, kSlots> slots_{};
+};
+
 }  // namespace exeray::log
 
 // =============================================================================
 // Convenience Macros
 // =============================================================================
+//
+// Arguments are evaluated only when the level is compiled in and enabled at
+// runtime, so they may convert or format freely.
+
+/// @brief Log at a level if compiled in and enabled (use the macros below).
+#define EXERAY_LOG_(exeray_level, spdlog_level, ...)                           \
+    do {                                                                       \
+        if constexpr (EXERAY_LEVEL_##exeray_level >= EXERAY_ACTIVE_LEVEL) {    \
+            auto& exeray_logger_ = ::exeray::log::get();                       \
+            if (exeray_logger_.should_log(::spdlog::level::spdlog_level)) {    \
+                exeray_logger_.log(::spdlog::level::spdlog_level, __VA_ARGS__); \
+            }                                                                  \
+        }                                                                      \
+    } while (false)
 
 /// @brief Log trace-level message (verbose debug).
 /// @param ... Format string and arguments using fmt syntax.
-#define EXERAY_TRACE(...) ::exeray::log::get().trace(__VA_ARGS__)
+#define EXERAY_TRACE(...) EXERAY_LOG_(TRACE, trace, __VA_ARGS__)
 
 /// @brief Log debug-level message.
 /// @param ... Format string and arguments using fmt syntax.
-#define EXERAY_DEBUG(...) ::exeray::log::get().debug(__VA_ARGS__)
+#define EXERAY_DEBUG(...) EXERAY_LOG_(DEBUG, debug, __VA_ARGS__)
 
 /// @brief Log info-level message.
 /// @param ... Format string and arguments using fmt syntax.
-#define EXERAY_INFO(...)  ::exeray::log::get().info(__VA_ARGS__)
+#define EXERAY_INFO(...) EXERAY_LOG_(INFO, info, __VA_ARGS__)
 
 /// @brief Log warning-level message.
 /// @param ... Format string and arguments using fmt syntax.
-#define EXERAY_WARN(...)  ::exeray::log::get().warn(__VA_ARGS__)
+#define EXERAY_WARN(...) EXERAY_LOG_(WARN, warn, __VA_ARGS__)
 
 /// @brief Log error-level message.
 /// @param ... Format string and arguments using fmt syntax.
-#define EXERAY_ERROR(...) ::exeray::log::get().error(__VA_ARGS__)
+#define EXERAY_ERROR(...) EXERAY_LOG_(ERROR, err, __VA_ARGS__)
 
 /// @brief Log critical-level message.
 /// @param ... Format string and arguments using fmt syntax.
-#define EXERAY_CRITICAL(...) ::exeray::log::get().critical(__VA_ARGS__)
+#define EXERAY_CRITICAL(...) EXERAY_LOG_(CRITICAL, critical, __VA_ARGS__)
+
+/// @brief Log a warning at most per_second times a second from this call site.
+///
+/// For messages logged per event. The first message after a drop is
+/// preceded by the number of messages dropped.
+///
+/// @param per_second Messages allowed per second.
+/// @param ... Format string and arguments using fmt syntax.
+#define EXERAY_WARN_LIMITED(per_second, ...)                                   \
+    do {                                                                       \
+        if constexpr (EXERAY_LEVEL_WARN >= EXERAY_ACTIVE_LEVEL) {              \
+            static ::exeray::log::RateLimit exeray_limit_{per_second};         \
+            auto& exeray_logger_ = ::exeray::log::get();                       \
+            if (exeray_logger_.should_log(::spdlog::level::warn)) {            \
+                const std::uint64_t exeray_n_ = exeray_limit_.acquire();      \
+                if (exeray_n_ > 1) {                                           \
+                    exeray_logger_.warn("({} similar messages dropped)",      \
+                                        exeray_n_ - 1);                        \
+                }                                                              \
+                if (exeray_n_ != 0) {                                          \
+                    exeray_logger_.warn(__VA_ARGS__);                          \
+                }                                                              \
+            }                                                                  \
+        }                                                                      \
+    } while (false)
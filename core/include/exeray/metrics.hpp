@@ -0,0 +1,152 @@
+#pragma once
+
+/// @file metrics.hpp
+/// @brief Counters, gauges and histograms with one snapshot and text dump.
+///
+/// Gives every component one place to publish numbers that the TUI, an
+/// external agent or a Prometheus scraper can read. Counters and
+/// histograms are summed from shards owned by the recording threads, so
+/// add() and observe() are a few uncontended relaxed stores; gauges are
+/// single atomics. Numbers a component already keeps in its own stats
+/// struct are published by a collector that reads them at snapshot time
+/// instead of being counted twice.
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace exeray {
+
+/// @brief Kind of a metric, as in the Prometheus exposition format.
+enum class MetricType : std::uint8_t {
+    Counter,    ///< Only increases (name ends in _total)
+    Gauge,      ///< Current value
+    Histogram,  ///< Distribution in power-of-two buckets
+};
+
+/// @brief Text format written by MetricsRegistry::write().
+enum class MetricsFormat : std::uint8_t {
+    Prometheus,   ///< Text exposition format 0.0.4
+    OpenMetrics,  ///< OpenMetrics 1.0 text (ends with # EOF)
+};
+
+/// @brief One labelled value of a snapshot.
+struct MetricSample {
+    std::string name;    ///< Prometheus name; counters end in _total
+    std::string help;    ///< One line of description
+    std::string labels;  ///< Rendered pairs, e.g. provider="File" (empty = none)
+    MetricType type = MetricType::Gauge;
+    double value = 0.0;  ///< Counter or gauge value; histograms: sum of observations
+    std::uint64_t count = 0;  ///< Histograms: number of observations
+    /// Histograms: observations in [2^(b-1), 2^b) per bucket b (bucket 0: 0),
+    /// not cumulative; empty for other types.
+    std::vector<std::uint64_t> buckets;
+};
+
+/// @brief Render one label pair with the value escaped (key="value").
+[[nodiscard]] std::string metric_label(std::string_view key, std::string_view value);
+
+/**
+ * @brief Metrics of one Engine.
+ *
+ * Metrics are registered once, by name and labels, and updated through
+ * the returned Id; registering the same pair again returns the same Id.
+ * Updates through kInvalid (a full table) are ignored. Every thread that
+ * updates a counter or histogram gets a shard on first use; when it exits
+ * the shard, counts included, is handed to the next new thread.
+ *
+ * Thread-safety: add(), set(), adjust() and observe() from any thread
+ * without locks; registration, add_collector() and snapshot() from any
+ * thread (snapshots may miss in-flight updates). Collectors run on the
+ * snapshotting thread.
+ */
+class MetricsRegistry {
+public:
+    using Id = std::uint32_t;
+
+    /// @brief Fills samples at snapshot time.
+    using Collector = std::function<void(std::vector<MetricSample>&)>;
+
+    static constexpr Id kInvalid = ~Id{0};
+    static constexpr std::size_t kMaxCounters = 256;
+    static constexpr std::size_t kMaxGauges = 256;
+    static constexpr std::size_t kMaxHistograms = 32;
+    /// Bucket b holds [2^(b-1), 2^b); the last one everything above.
+    static constexpr std::size_t kHistogramBuckets = 48;
+
+    MetricsRegistry();
+    ~MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    /// @brief Register a counter (name should end in _total).
+    Id counter(std::string_view name, std::string_view help, std::string_view labels = {});
+
+    /// @brief Register a gauge.
+    Id gauge(std::string_view name, std::string_view help, std::string_view labels = {});
+
+    /// @brief Register a histogram of non-negative integers (e.g. ns, bytes).
+    Id histogram(std::string_view name, std::string_view help, std::string_view labels = {});
+
+    /// @brief Publish samples computed at snapshot time.
+    void add_collector(Collector collector);
+
+    void add(Id counter, std::uint64_t n = 1) noexcept;
+    void set(Id gauge, std::int64_t value) noexcept;
+    void adjust(Id gauge, std::int64_t delta) noexcept;
+    void observe(Id histogram, std::uint64_t value) noexcept;
+
+    /// @brief Registered metrics summed over all shards, then collected
+    /// samples, sorted by name (stable, so labels keep their order).
+    [[nodiscard]] std::vector<MetricSample> snapshot() const;
+
+    /// @brief Write snapshot() as text.
+    /// @return Whether the stream is still good.
+    bool write(std::ostream& out, MetricsFormat format = MetricsFormat::Prometheus) const;
+
+    /// @brief Write samples (grouped by name as snapshot() sorts them) as text.
+    static bool write(std::ostream& out, const std::vector<MetricSample>& samples,
+                      MetricsFormat format);
+
+    /// @brief Histogram bucket of a value.
+    [[nodiscard]] static std::size_t bucket_of(std::uint64_t value) noexcept;
+
+private:
+    struct Shard;
+    struct Shards;
+
+    friend struct MetricsThreadCache;
+
+    struct Descriptor {
+        std::string name;
+        std::string help;
+        std::string labels;
+    };
+
+    /// @brief Shard of the calling thread (allocated on first use); nullptr if out of memory.
+    Shard* local() noexcept;
+
+    Id add_descriptor(std::vector<Descriptor>& table, std::size_t limit, std::string_view name,
+                      std::string_view help, std::string_view labels);
+
+    const std::uint64_t serial_;  ///< Tells registries apart in the thread caches
+    std::shared_ptr<Shards> shards_;
+    std::array<std::atomic<std::int64_t>, kMaxGauges> gauges_{};
+
+    mutable std::mutex mutex_;
+    std::vector<Descriptor> counters_;    ///< Guarded by mutex_
+    std::vector<Descriptor> gauge_info_;  ///< Guarded by mutex_
+    std::vector<Descriptor> histograms_;  ///< Guarded by mutex_
+    std::vector<Collector> collectors_;   ///< Guarded by mutex_
+};
+
+}  // namespace exeray
@@ -0,0 +1,423 @@
+#pragma once
+
+/// @file pipeline.hpp
+/// @brief Stages on the thread pool connected by bounded queues.
+///
+/// A Pipeline is a chain of stages (say parse -> correlate -> detect ->
+/// export) in which every stage runs on the pool as items reach it, and
+/// each stage reads from a bounded queue of its own. A stage runs at most
+/// one pass at a time, so it sees its items in order and needs no locking
+/// of its own state. When the next queue is full, the stage holds its
+/// result and ends its pass instead of blocking a worker; the next stage
+/// reschedules it as soon as it takes an item. Only the producer blocks,
+/// in push(), once the first queue is full.
+///
+/// @code
+///   auto pipeline = PipelineBuilder<Record>(pool, 1024)
+///                       .stage([](Record&& r) { return parse(r); })
+///                       .stage([](Parsed&& p) -> std::optional<Parsed> { ... })
+///                       .sink([](Parsed&& p) { export_event(p); });
+///   pipeline.push(record);
+///   pipeline.close();
+///   pipeline.done().wait();
+/// @endcode
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "exeray/task_graph.hpp"
+#include "exeray/thread_pool.hpp"
+
+namespace exeray {
+
+template <typename In>
+class Pipeline;
+
+template <typename Head, typename Tail>
+class PipelineBuilder;
+
+namespace detail {
+
+template <typename T>
+struct IsOptional : std::false_type {};
+
+template <typename T>
+struct IsOptional<std::optional<T>> : std::true_type {};
+
+/// @brief Item type a stage function produces (std::optional<T> filters, giving T).
+template <typename R>
+using StageOutput =
+    typename std::conditional_t<IsOptional<R>::value, R, std::optional<R>>::value_type;
+
+/// @brief Passes in flight over every stage of one pipeline; outlives it.
+struct PipelineShared {
+    std::atomic<std::size_t> passes{0};
+};
+
+/// @brief Scheduling of a stage: at most one pass at a time on the pool.
+class StageBase {
+public:
+    StageBase(ThreadPool& pool, std::shared_ptr<PipelineShared> shared)
+        : pool_(pool), shared_(std::move(shared)) {}
+    virtual ~StageBase() = default;
+
+    StageBase(const StageBase&) = delete;
+    StageBase& operator=(const StageBase&) = delete;
+
+    /// @brief Submit a pass unless one is already queued or running.
+    void schedule() {
+        if (scheduled_.exchange(true, std::memory_order_seq_cst)) {
+            return;
+        }
+        shared_->passes.fetch_add(1, std::memory_order_relaxed);
+        pool_.submit([this, shared = shared_] {
+            run();
+            scheduled_.store(false, std::memory_order_seq_cst);
+            // Anything that arrived during the pass found it still scheduled
+            if (runnable()) {
+                schedule();
+            }
+            if (shared->passes.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                shared->passes.notify_all();
+            }
+        });
+    }
+
+protected:
+    /// Items a pass handles before it yields the worker.
+    static constexpr std::size_t kBatch = 256;
+
+    /// @brief Move items along until blocked, empty or kBatch items were handled.
+    virtual void run() = 0;
+
+    /// @brief A new pass would make progress.
+    [[nodiscard]] virtual bool runnable() = 0;
+
+private:
+    ThreadPool& pool_;
+    std::shared_ptr<PipelineShared> shared_;
+    std::atomic<bool> scheduled_{false};
+};
+
+/// @brief Input side of a stage: its bounded queue.
+template <typename T>
+class StageInput : public StageBase {
+public:
+    StageInput(ThreadPool& pool, std::shared_ptr<PipelineShared> shared, std::size_t capacity)
+        : StageBase(pool, std::move(shared)), capacity_(capacity > 0 ? capacity : 1) {}
+
+    /// @brief Queue item if there is room; false (item untouched) if full or closed.
+    bool offer(T& item) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_ || queue_.size() >= capacity_) {
+                return false;
+            }
+            queue_.push_back(std::move(item));
+        }
+        schedule();
+        return true;
+    }
+
+    /// @brief Queue item, waiting for room; false if closed.
+    bool push(T& item) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            space_.wait(lock, [this] { return closed_ || queue_.size() < capacity_; });
+            if (closed_) {
+                return false;
+            }
+            queue_.push_back(std::move(item));
+        }
+        schedule();
+        return true;
+    }
+
+    /// @brief No more items will come; the stage finishes once drained.
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        space_.notify_all();
+        schedule();
+    }
+
+    [[nodiscard]] bool full() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.size() >= capacity_;
+    }
+
+    [[nodiscard]] std::size_t depth() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.size();
+    }
+
+    /// @brief Stage feeding this one, rescheduled when room is made.
+    void set_upstream(StageBase* upstream) noexcept { upstream_ = upstream; }
+
+protected:
+    /// @brief Take the oldest queued item.
+    std::optional<T> pop() {
+        std::optional<T> item;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queue_.empty()) {
+                return item;
+            }
+            item.emplace(std::move(queue_.front()));
+            queue_.pop_front();
+        }
+        space_.notify_one();
+        if (upstream_ != nullptr) {
+            upstream_->schedule();
+        }
+        return item;
+    }
+
+    /// @brief Closed with nothing left queued.
+    [[nodiscard]] bool drained() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return closed_ && queue_.empty();
+    }
+
+    [[nodiscard]] bool empty() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.empty();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable space_;
+    std::deque<T> queue_;
+    std::size_t capacity_;
+    bool closed_ = false;
+    StageBase* upstream_ = nullptr;
+};
+
+/// @brief Stage turning each In into at most one Out for the next stage.
+template <typename In, typename Out, typename F>
+class Stage final : public StageInput<In> {
+public:
+    Stage(ThreadPool& pool, std::shared_ptr<PipelineShared> shared, std::size_t capacity, F fn)
+        : StageInput<In>(pool, std::move(shared), capacity), fn_(std::move(fn)) {}
+
+    void connect(StageInput<Out>* next) noexcept {
+        next_ = next;
+        next_->set_upstream(this);
+    }
+
+private:
+    void run() override {
+        for (std::size_t handled = 0; handled < StageBase::kBatch; ++handled) {
+            if (held_.has_value()) {
+                if (!next_->offer(*held_)) {
+                    return;  // Next queue full: it reschedules us when it takes an item
+                }
+                held_.reset();
+            }
+            std::optional<In> item = this->pop();
+            if (!item.has_value()) {
+                break;
+            }
+            if constexpr (IsOptional<std::invoke_result_t<F&, In&&>>::value) {
+                held_ = fn_(std::move(*item));
+            } else {
+                held_.emplace(fn_(std::move(*item)));
+            }
+        }
+        if (!held_.has_value() && !closed_next_ && this->drained()) {
+            closed_next_ = true;
+            next_->close();
+        }
+    }
+
+    bool runnable() override {
+        if (held_.has_value()) {
+            return !next_->full();
+        }
+        return !this->empty() || (!closed_next_ && this->drained());
+    }
+
+    F fn_;
+    StageInput<Out>* next_ = nullptr;
+    std::optional<Out> held_;  ///< Result waiting for room in the next queue
+    bool closed_next_ = false;
+};
+
+/// @brief Last stage: consumes items and completes the pipeline once drained.
+template <typename In, typename F>
+class SinkStage final : public StageInput<In> {
+public:
+    SinkStage(ThreadPool& pool, std::shared_ptr<PipelineShared> shared, std::size_t capacity,
+              F fn, TaskPromise<void> done)
+        : StageInput<In>(pool, std::move(shared), capacity),
+          fn_(std::move(fn)),
+          done_(std::move(done)) {}
+
+private:
+    void run() override {
+        for (std::size_t handled = 0; handled < StageBase::kBatch; ++handled) {
+            std::optional<In> item = this->pop();
+            if (!item.has_value()) {
+                break;
+            }
+            fn_(std::move(*item));
+        }
+        if (!finished_ && this->drained()) {
+            finished_ = true;
+            done_.set_value();
+        }
+    }
+
+    bool runnable() override { return !this->empty() || (!finished_ && this->drained()); }
+
+    F fn_;
+    TaskPromise<void> done_;
+    bool finished_ = false;
+};
+
+}  // namespace detail
+
+/**
+ * @brief Running chain of stages fed through push().
+ *
+ * Built by PipelineBuilder::sink(). The destructor closes the pipeline and
+ * waits until every queued item has passed the sink.
+ *
+ * Thread-safety: push(), try_push() and close() from any thread; a stage
+ * function is never called concurrently with itself.
+ */
+template <typename In>
+class Pipeline {
+public:
+    Pipeline(Pipeline&& other) noexcept
+        : stages_(std::move(other.stages_)),
+          head_(std::exchange(other.head_, nullptr)),
+          shared_(std::move(other.shared_)),
+          done_(std::move(other.done_)) {}
+    Pipeline& operator=(Pipeline&&) = delete;
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    ~Pipeline() {
+        if (head_ == nullptr) {
+            return;  // Moved from
+        }
+        close();
+        done_.wait();
+        for (auto passes = shared_->passes.load(std::memory_order_acquire); passes != 0;
+             passes = shared_->passes.load(std::memory_order_acquire)) {
+            shared_->passes.wait(passes, std::memory_order_acquire);
+        }
+    }
+
+    /// @brief Feed an item, waiting while the first queue is full; false once closed.
+    bool push(In item) { return head_->push(item); }
+
+    /// @brief Feed an item if the first queue has room; false (item untouched) otherwise.
+    bool try_push(In& item) { return head_->offer(item); }
+
+    /// @brief No more items: stages finish in turn once their queues drain.
+    void close() { head_->close(); }
+
+    /// @brief Finishes when the sink has consumed every item after close().
+    [[nodiscard]] const TaskHandle<void>& done() const noexcept { return done_; }
+
+    /// @brief Items queued in front of the first stage.
+    [[nodiscard]] std::size_t depth() const { return head_->depth(); }
+
+private:
+    template <typename, typename>
+    friend class PipelineBuilder;
+
+    Pipeline(std::vector<std::unique_ptr<detail::StageBase>> stages,
+             detail::StageInput<In>* head, std::shared_ptr<detail::PipelineShared> shared,
+             TaskHandle<void> done)
+        : stages_(std::move(stages)),
+          head_(head),
+          shared_(std::move(shared)),
+          done_(std::move(done)) {}
+
+    std::vector<std::unique_ptr<detail::StageBase>> stages_;
+    detail::StageInput<In>* head_ = nullptr;
+    std::shared_ptr<detail::PipelineShared> shared_;
+    TaskHandle<void> done_;
+};
+
+/**
+ * @brief Adds stages to a pipeline taking Head, whose last stage yields Tail.
+ *
+ * stage(fn) appends fn(Tail&&) -> Out; returning std::optional<Out> drops
+ * the items for which it returns std::nullopt. sink(fn) ends the chain
+ * with fn(Tail&&) and starts it.
+ */
+template <typename Head, typename Tail = Head>
+class PipelineBuilder {
+public:
+    /// @param capacity Default queue length in front of each stage.
+    PipelineBuilder(ThreadPool& pool, std::size_t capacity)
+        : pool_(&pool), capacity_(capacity), shared_(std::make_shared<detail::PipelineShared>()) {}
+
+    /// @brief Append a stage; capacity 0 uses the builder's default.
+    template <typename F>
+    auto stage(F fn, std::size_t capacity = 0) && {
+        using Out = detail::StageOutput<std::invoke_result_t<F&, Tail&&>>;
+        using S = detail::Stage<Tail, Out, F>;
+        auto next = std::make_unique<S>(*pool_, shared_, capacity > 0 ? capacity : capacity_,
+                                        std::move(fn));
+        S* added = next.get();
+        attach(std::move(next));
+
+        PipelineBuilder<Head, Out> result(*pool_, capacity_);
+        result.shared_ = std::move(shared_);
+        result.stages_ = std::move(stages_);
+        result.head_ = head_;
+        result.connect_tail_ = [added](detail::StageInput<Out>* input) { added->connect(input); };
+        return result;
+    }
+
+    /// @brief End the chain with fn and return the running pipeline.
+    template <typename F>
+    Pipeline<Head> sink(F fn, std::size_t capacity = 0) && {
+        TaskPromise<void> done;
+        auto handle = done.handle();
+        attach(std::make_unique<detail::SinkStage<Tail, F>>(
+            *pool_, shared_, capacity > 0 ? capacity : capacity_, std::move(fn), std::move(done)));
+        return Pipeline<Head>(std::move(stages_), head_, std::move(shared_), std::move(handle));
+    }
+
+private:
+    template <typename, typename>
+    friend class PipelineBuilder;
+
+    /// @brief Make stage the new tail, fed by the previous one (or by push()).
+    void attach(std::unique_ptr<detail::StageInput<Tail>> stage) {
+        if (head_ == nullptr) {
+            if constexpr (std::is_same_v<Head, Tail>) {
+                head_ = stage.get();
+            }
+        } else {
+            connect_tail_(stage.get());
+        }
+        stages_.push_back(std::move(stage));
+    }
+
+    ThreadPool* pool_;
+    std::size_t capacity_;
+    std::shared_ptr<detail::PipelineShared> shared_;
+    std::vector<std::unique_ptr<detail::StageBase>> stages_;
+    detail::StageInput<Head>* head_ = nullptr;
+    std::function<void(detail::StageInput<Tail>*)> connect_tail_;  ///< Feeds a new tail
+};
+
+}  // namespace exeray
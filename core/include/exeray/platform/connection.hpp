@@ -0,0 +1,57 @@
+/// @file platform/connection.hpp
+/// @brief Outgoing byte stream over TCP or a local pipe.
+///
+/// A pipe is a Windows named pipe ("\\.\pipe\name") or, elsewhere, a Unix
+/// domain socket at a path. Sends block until every byte is handed to the
+/// OS. On sockets that takes at most the send timeout, so a stalled peer
+/// fails the send instead of hanging its thread; a Windows pipe write waits
+/// for the server to read.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace exeray::platform {
+
+/// @brief Connected stream, closed when the object dies.
+class Connection {
+public:
+    Connection() noexcept = default;
+    ~Connection();
+
+    Connection(Connection&& other) noexcept;
+    Connection& operator=(Connection&& other) noexcept;
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    /**
+     * @brief Connect to host:port, replacing any previous connection.
+     * @param host Name or numeric IPv4/IPv6 address.
+     * @return false if no address of host accepted the connection.
+     */
+    bool open_tcp(const std::string& host, std::uint16_t port,
+                  std::chrono::milliseconds send_timeout = std::chrono::seconds(5));
+
+    /// @brief Connect to a named pipe or Unix domain socket.
+    bool open_pipe(const std::string& path,
+                   std::chrono::milliseconds send_timeout = std::chrono::seconds(5));
+
+    /// @brief Send all bytes; on failure the connection is closed.
+    bool send(std::span<const std::uint8_t> bytes);
+
+    void close() noexcept;
+
+    [[nodiscard]] bool is_open() const noexcept { return handle_ != kClosed; }
+
+private:
+    static constexpr std::intptr_t kClosed = -1;
+
+    std::intptr_t handle_ = kClosed;  ///< Socket, or pipe HANDLE on Windows
+    bool pipe_ = false;               ///< handle_ is a Windows pipe HANDLE
+};
+
+}  // namespace exeray::platform
@@ -0,0 +1,52 @@
+/// @file platform/mapped_file.hpp
+/// @brief Read-only memory mapping of a whole file.
+///
+/// Mapping costs a few system calls whatever the file size: pages are read
+/// from disk when first touched, and stay in the page cache for the next
+/// open. The mapping starts page aligned, so data aligned in the file is
+/// equally aligned in memory.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace exeray::platform {
+
+/// @brief Whole file mapped read-only for the object's lifetime.
+class MappedFile {
+public:
+    MappedFile() noexcept = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Map a file, replacing any previous mapping.
+     * @return false if the file is missing, empty or cannot be mapped.
+     */
+    bool open(const std::filesystem::path& path);
+
+    /// @brief Unmap the file; bytes() becomes empty.
+    void close() noexcept;
+
+    /// @brief Hint that the bytes will be read from start to end.
+    void advise_sequential() const noexcept;
+
+    [[nodiscard]] std::span<const std::uint8_t> bytes() const noexcept {
+        return {data_, size_};
+    }
+
+    [[nodiscard]] bool is_open() const noexcept { return data_ != nullptr; }
+
+private:
+    const std::uint8_t* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+}  // namespace exeray::platform
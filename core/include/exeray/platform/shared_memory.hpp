@@ -0,0 +1,61 @@
+/// @file platform/shared_memory.hpp
+/// @brief Named shared-memory section that other processes can map.
+///
+/// The creator owns the name: it creates the section (replacing a stale one
+/// left by a crash on POSIX) and removes the name again when closed. Other
+/// processes open it by name, read-only. The mapping starts page aligned
+/// and reads as zero until written.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace exeray::platform {
+
+/// @brief One mapping of a named shared-memory section.
+class SharedMemory {
+public:
+    SharedMemory() noexcept = default;
+    ~SharedMemory();
+
+    SharedMemory(SharedMemory&& other) noexcept;
+    SharedMemory& operator=(SharedMemory&& other) noexcept;
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    /**
+     * @brief Create the section name of size bytes and map it read-write.
+     *
+     * name is a plain identifier: "/" is prepended for shm_open(), and on
+     * Windows it names a Local\ (session) file mapping backed by the page
+     * file.
+     * @return false if the section cannot be created or mapped.
+     */
+    bool create(std::string_view name, std::size_t size);
+
+    /**
+     * @brief Map an existing section read-only, whatever its size.
+     * @return false if no section of that name exists.
+     */
+    bool open(std::string_view name);
+
+    /// @brief Unmap, and remove the name if this mapping created it.
+    void close() noexcept;
+
+    /// @brief The mapping (writable only after create()).
+    [[nodiscard]] std::span<std::uint8_t> bytes() const noexcept { return {data_, size_}; }
+
+    [[nodiscard]] bool is_open() const noexcept { return data_ != nullptr; }
+
+private:
+    std::uint8_t* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::string owned_;  ///< Name to remove on close (creator only)
+    void* handle_ = nullptr;  ///< Windows section handle (creator only)
+};
+
+}  // namespace exeray::platform
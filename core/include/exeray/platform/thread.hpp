@@ -0,0 +1,135 @@
+#pragma once
+
+/// @file platform/thread.hpp
+/// @brief CPU affinity, scheduling priority and processor topology.
+///
+/// The ETW consumer competes with the UI and whatever the monitored host is
+/// running; when it is descheduled during a CPU spike, ETW runs out of
+/// buffers and drops them. ScopedPlacement pins the calling thread to chosen
+/// cores and raises its priority for as long as it lives, then restores the
+/// previous settings so that pool workers can be borrowed for a session.
+///
+/// Logical processors are numbered as the OS does on Linux; on Windows
+/// processor k of group g is g * 64 + k, so ids stay unique on machines
+/// with more than one processor group.
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace exeray::platform {
+
+/// @brief Scheduling priority of a placed thread.
+enum class ThreadPriority : std::uint8_t {
+    Normal,        ///< Leave the priority as it is
+    High,          ///< THREAD_PRIORITY_HIGHEST
+    TimeCritical,  ///< THREAD_PRIORITY_TIME_CRITICAL
+    Capture        ///< MMCSS "Capture" task (falls back to TimeCritical)
+};
+
+/// @brief Where and how urgently a thread runs.
+struct ThreadPlacement {
+    std::vector<unsigned> cores;  ///< Logical processors allowed (empty = any)
+    ThreadPriority priority = ThreadPriority::Normal;
+
+    [[nodiscard]] bool empty() const noexcept {
+        return cores.empty() && priority == ThreadPriority::Normal;
+    }
+};
+
+/**
+ * @brief Applies a placement to the calling thread until destroyed.
+ *
+ * On Windows a thread runs in one processor group: the group of the first
+ * listed core, with cores of other groups ignored. Priorities are only
+ * applied on Windows. Must be destroyed on the thread that created it.
+ */
+class ScopedPlacement {
+public:
+    explicit ScopedPlacement(const ThreadPlacement& placement);
+    ~ScopedPlacement();
+
+    ScopedPlacement(const ScopedPlacement&) = delete;
+    ScopedPlacement& operator=(const ScopedPlacement&) = delete;
+
+    /// @brief Affinity was requested and applied.
+    [[nodiscard]] bool pinned() const noexcept { return pinned_; }
+
+    /// @brief A priority was requested and applied.
+    [[nodiscard]] bool raised() const noexcept { return raised_; }
+
+private:
+    bool pinned_ = false;
+    bool raised_ = false;
+    std::vector<unsigned> previous_cores_;  ///< Affinity before pinning
+    int previous_priority_ = 0;             ///< Priority before raising
+    void* mmcss_ = nullptr;                 ///< MMCSS task handle
+};
+
+/// @brief Parse a Linux CPU list such as "0-3,8,10-11".
+/// @return The listed CPUs in order; empty on malformed input.
+[[nodiscard]] std::vector<unsigned> parse_cpu_list(std::string_view list);
+
+/**
+ * @brief Logical processors sharing an L2 cache with a core (itself included).
+ * @return Sorted list; just {core} if the topology is unknown.
+ */
+[[nodiscard]] std::vector<unsigned> l2_siblings(unsigned core);
+
+/// @brief One logical processor and where it sits in the machine.
+struct LogicalCpu {
+    unsigned id = 0;       ///< Logical processor, as used in ThreadPlacement::cores
+    unsigned core = 0;     ///< Physical core, dense over the machine (SMT siblings share it)
+    unsigned package = 0;  ///< Socket
+    unsigned group = 0;    ///< Windows processor group (0 elsewhere)
+    unsigned node = 0;     ///< NUMA node
+};
+
+/// @brief Logical processors available to the process.
+struct CpuTopology {
+    std::vector<LogicalCpu> cpus;  ///< Sorted by id
+
+    /// @return The processor with this id, or nullptr.
+    [[nodiscard]] const LogicalCpu* find(unsigned id) const noexcept;
+
+    /// @return Ids of the processors in package, sorted.
+    [[nodiscard]] std::vector<unsigned> package_cpus(unsigned package) const;
+};
+
+/**
+ * @brief Discover the processors the calling thread may run on.
+ *
+ * Uses GetLogicalProcessorInformationEx on Windows and sysfs on Linux.
+ * If the topology cannot be read, every hardware thread is reported as
+ * its own core on package 0.
+ */
+[[nodiscard]] CpuTopology cpu_topology();
+
+/// @brief CPU time, user plus kernel, the process has used so far in
+/// seconds (0 if unknown).
+[[nodiscard]] double process_cpu_seconds() noexcept;
+
+/// @brief How a ThreadPool spreads its workers over the processors.
+enum class PoolPlacement : std::uint8_t {
+    None,        ///< Unpinned; the OS scheduler decides
+    Compact,     ///< One logical processor each, filling a socket (SMT siblings first)
+    Scatter,     ///< One logical processor each, alternating sockets, physical cores first
+    OnePerCore,  ///< One physical core each (all its SMT siblings)
+    Group        ///< Any processor of the first processor group
+};
+
+/**
+ * @brief Cores each worker of a pool is pinned to.
+ *
+ * With count 0 the number of workers follows the policy: one per physical
+ * core for OnePerCore, one per processor of the group for Group, one per
+ * logical processor otherwise. Workers beyond that wrap around.
+ *
+ * @return One core list per worker; lists are empty for None.
+ */
+[[nodiscard]] std::vector<std::vector<unsigned>> place_workers(const CpuTopology& topology,
+                                                               PoolPlacement placement,
+                                                               std::size_t count);
+
+}  // namespace exeray::platform
@@ -9,15 +9,42 @@
 #include <cstdint>
 #include <memory>
 #include <string_view>
+#include <vector>
 
 namespace exeray::process {
 
+/// @brief Limits applied to the job of a launched process (0 = none).
+struct ResourceLimits {
+    std::size_t memory_bytes = 0;            ///< Committed memory per process
+    std::uint32_t cpu_percent = 0;           ///< Hard cap on the job's CPU share (1-100)
+    std::uint64_t io_bytes_per_second = 0;   ///< Disk bandwidth of the whole job
+    std::uint64_t io_ops_per_second = 0;     ///< Disk operations of the whole job
+};
+
+/// @brief Resource use of a launched process and everything in its job.
+struct JobAccounting {
+    std::uint64_t user_time_ns = 0;
+    std::uint64_t kernel_time_ns = 0;
+    std::uint64_t read_bytes = 0;
+    std::uint64_t write_bytes = 0;
+    std::uint64_t other_bytes = 0;          ///< Neither read nor write (device control...)
+    std::uint64_t read_ops = 0;
+    std::uint64_t write_ops = 0;
+    std::uint64_t peak_process_memory = 0;  ///< Highest commit of one process
+    std::uint64_t peak_job_memory = 0;      ///< Highest commit of the whole job
+    std::uint32_t active_processes = 0;
+    std::uint32_t total_processes = 0;      ///< Including those that exited
+};
+
 /// @brief Controls a launched process with suspend/resume/terminate capabilities.
 ///
 /// Processes are launched in suspended mode and must be explicitly resumed.
-/// Job Objects provide resource isolation and limits.
+/// Job Objects provide resource isolation and limits. A process that was
+/// already running can be attached to instead; it is neither suspended nor
+/// put in a job, and is left running when the Controller is destroyed.
 ///
-/// @note This class is Windows-specific. On other platforms, launch() returns nullptr.
+/// @note This class is Windows-specific. On other platforms, launch() and
+/// attach() return nullptr.
 class Controller {
 public:
     /// @brief Launch a process in suspended mode.
@@ -31,7 +58,12 @@ public:
         std::wstring_view working_dir = L""
     );
 
-    /// @brief Destructor terminates process and closes handles.
+    /// @brief Take control of a running process.
+    /// @param pid Process to attach to.
+    /// @return Unique pointer to Controller, or nullptr if it cannot be opened.
+    [[nodiscard]] static std::unique_ptr<Controller> attach(std::uint32_t pid);
+
+    /// @brief Destructor terminates a launched process and closes handles.
     ~Controller();
 
     // Non-copyable, non-movable (handle ownership)
@@ -44,10 +76,12 @@ public:
     // Process Control
     // -------------------------------------------------------------------------
 
-    /// @brief Resume the primary thread (start execution).
+    /// @brief Resume the primary thread (start execution); every thread
+    /// of an attached process.
     void resume();
 
-    /// @brief Suspend the primary thread (pause execution).
+    /// @brief Suspend the primary thread (pause execution); every thread
+    /// of an attached process.
     void suspend();
 
     /// @brief Terminate the process.
@@ -61,6 +95,9 @@ public:
     /// @brief Get the process ID.
     [[nodiscard]] std::uint32_t pid() const noexcept { return pid_; }
 
+    /// @brief Started by launch() (false if attached).
+    [[nodiscard]] bool launched() const noexcept { return launched_; }
+
     /// @brief Check if the process is still running.
     [[nodiscard]] bool is_running() const;
 
@@ -79,9 +116,23 @@ public:
     /// @param percent CPU rate limit (1-100).
     void set_cpu_limit(std::uint32_t percent);
 
+    /// @brief Limit the job's disk I/O on every volume.
+    /// @param bytes_per_second Bandwidth cap (0 = none).
+    /// @param ops_per_second Operation cap (0 = none).
+    void set_io_limit(std::uint64_t bytes_per_second, std::uint64_t ops_per_second = 0);
+
+    /// @brief Apply every non-zero limit of limits.
+    void apply(const ResourceLimits& limits);
+
     /// @brief Deny the process from creating child processes.
     void deny_child_processes();
 
+    /// @brief Read the job's CPU time, I/O and peak memory counters.
+    ///
+    /// Two QueryInformationJobObject calls, cheap enough to poll.
+    /// @return false for an attached process (no job) or off Windows.
+    bool query_accounting(JobAccounting& out) const;
+
 private:
     /// @brief Private constructor, use launch() factory.
     Controller() = default;
@@ -94,6 +145,11 @@ private:
     void* job_handle_{nullptr};
 #endif
     std::uint32_t pid_{0};
+    bool launched_{false};
 };
 
+/// @brief Running processes descended from pid (children, grandchildren...).
+/// @return Their PIDs from a process snapshot; empty on failure or off Windows.
+[[nodiscard]] std::vector<std::uint32_t> running_descendants(std::uint32_t pid);
+
 }  // namespace exeray::process
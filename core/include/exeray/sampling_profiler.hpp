@@ -0,0 +1,157 @@
+#pragma once
+
+/// @file sampling_profiler.hpp
+/// @brief In-process sampling of the pipeline stage each worker thread is in.
+///
+/// Gives field profiles where attaching a profiler is not allowed. The
+/// consumer, ingest and detector threads declare their role with
+/// ProfiledThread; EXERAY_SPAN() (see trace_spans.hpp) marks the stage on a
+/// small per-thread stack whether or not span recording is compiled in.
+/// SamplingProfiler wakes at a fixed interval, reads every stack and
+/// counts it as a folded stack ("consumer;correlate"), the input format of
+/// flamegraph.pl, inferno and speedscope.
+///
+/// A marker costs two relaxed stores on a thread that declared a role and
+/// a thread-local load elsewhere.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace exeray {
+
+/// @brief Stage stack of one thread with a role.
+struct StageSlot {
+    /// Innermost stage in the low nibble, each as SpanKind + 1; 0 = none
+    std::atomic<std::uint32_t> stack{0};
+    std::atomic<const char*> role{nullptr};  ///< nullptr = slot unused
+    std::uint32_t depth = 0;                 ///< Owner only; may exceed kMaxDepth
+    static constexpr std::uint32_t kMaxDepth = 8;
+};
+
+namespace detail {
+
+/// Slot of the calling thread while it runs under a ProfiledThread.
+inline thread_local StageSlot* stage_slot = nullptr;
+
+}  // namespace detail
+
+/**
+ * @brief Declares the calling thread's role for the scope.
+ *
+ * Slots come from a process-wide table and are reused once the scope
+ * ends, so a pool worker may be "ingest" for one task and "detector" for
+ * the next. Scopes nest: the inner role applies until it ends.
+ */
+class ProfiledThread {
+public:
+    /// @param role Static string naming the thread in folded stacks.
+    explicit ProfiledThread(const char* role);
+    ~ProfiledThread();
+
+    ProfiledThread(const ProfiledThread&) = delete;
+    ProfiledThread& operator=(const ProfiledThread&) = delete;
+
+private:
+    StageSlot* slot_;
+    StageSlot* previous_;
+};
+
+/// @brief Marks a stage of the calling thread for the scope (use EXERAY_SPAN()).
+class StageScope {
+public:
+    explicit StageScope(std::uint8_t kind) noexcept : slot_(detail::stage_slot) {
+        if (slot_ == nullptr) {
+            return;
+        }
+        if (slot_->depth++ < StageSlot::kMaxDepth) {
+            const std::uint32_t stack = slot_->stack.load(std::memory_order_relaxed);
+            slot_->stack.store((stack << 4) | (kind + 1U), std::memory_order_relaxed);
+            pushed_ = true;
+        }
+    }
+
+    ~StageScope() {
+        if (slot_ == nullptr) {
+            return;
+        }
+        --slot_->depth;
+        if (pushed_) {
+            const std::uint32_t stack = slot_->stack.load(std::memory_order_relaxed);
+            slot_->stack.store(stack >> 4, std::memory_order_relaxed);
+        }
+    }
+
+    StageScope(const StageScope&) = delete;
+    StageScope& operator=(const StageScope&) = delete;
+
+private:
+    StageSlot* slot_;
+    bool pushed_ = false;
+};
+
+/**
+ * @brief Watchdog thread counting the stages of all ProfiledThreads.
+ *
+ * Threads of every engine in the process are sampled, as the stage table
+ * is process-wide. A thread with no stage marked is counted under its role
+ * alone (waiting, or work outside the marked stages).
+ *
+ * Thread-safety: all methods from any thread.
+ */
+class SamplingProfiler {
+public:
+    SamplingProfiler() = default;
+    ~SamplingProfiler();
+
+    SamplingProfiler(const SamplingProfiler&) = delete;
+    SamplingProfiler& operator=(const SamplingProfiler&) = delete;
+
+    /// @brief Start sampling every interval.
+    /// @return false if already running or interval is zero.
+    bool start(std::chrono::microseconds interval);
+
+    /// @brief Stop the watchdog thread (samples are kept).
+    void stop();
+
+    [[nodiscard]] bool running() const;
+
+    /// @brief Take one sample of every thread now (what the watchdog does).
+    void sample();
+
+    /// @brief Folded stacks with their sample counts, sorted by stack.
+    [[nodiscard]] std::vector<std::pair<std::string, std::uint64_t>> folded() const;
+
+    /// @brief Samples taken since the last reset (one per thread per tick).
+    [[nodiscard]] std::uint64_t samples() const;
+
+    /// @brief Write folded() as "stack count" lines.
+    /// @return Whether the stream is still good.
+    bool write_folded(std::ostream& out) const;
+
+    /// @brief Drop all samples (start of a session).
+    void reset();
+
+private:
+    void run(std::chrono::microseconds interval);
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::thread thread_;
+    bool stop_ = false;  ///< Guarded by mutex_
+    /// (role, stack) -> samples; roles are static strings. Guarded by mutex_
+    std::map<std::pair<const char*, std::uint32_t>, std::uint64_t> counts_;
+    std::uint64_t samples_ = 0;  ///< Guarded by mutex_
+};
+
+}  // namespace exeray
@@ -0,0 +1,270 @@
+#pragma once
+
+/// @file task_graph.hpp
+/// @brief Handles to pool tasks: waiting, continuations and when_all().
+///
+/// ThreadPool::submit() is fire-and-forget. spawn() returns a TaskHandle
+/// instead, which can be waited on or chained with then(); a continuation
+/// is submitted to the pool once its predecessor has finished, so chains
+/// never block a worker. when_all() joins handles into one.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "exeray/thread_pool.hpp"
+
+namespace exeray {
+
+template <typename T>
+class TaskHandle;
+
+template <typename T>
+class TaskPromise;
+
+namespace detail {
+
+/// @brief Result slot shared by a promise and its handles.
+template <typename T>
+class TaskState {
+public:
+    using Value = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    /// @brief Store the result and run the continuations; only the first call counts.
+    template <typename... Args>
+    void complete(Args&&... args) {
+        std::vector<Task> continuations;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (ready_.load(std::memory_order_relaxed)) {
+                return;
+            }
+            value_.emplace(std::forward<Args>(args)...);
+            ready_.store(true, std::memory_order_release);
+            continuations.swap(continuations_);
+        }
+        done_.notify_all();
+        for (Task& continuation : continuations) {
+            continuation();
+        }
+    }
+
+    /// @brief Run fn once the result is stored (right away if it already is).
+    void on_complete(Task fn) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!ready_.load(std::memory_order_relaxed)) {
+                continuations_.push_back(std::move(fn));
+                return;
+            }
+        }
+        fn();
+    }
+
+    [[nodiscard]] bool ready() const noexcept { return ready_.load(std::memory_order_acquire); }
+
+    Value& wait() {
+        if (!ready()) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_.wait(lock, [this] { return ready_.load(std::memory_order_relaxed); });
+        }
+        return *value_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable done_;
+    std::atomic<bool> ready_{false};
+    std::optional<Value> value_;
+    std::vector<Task> continuations_;
+};
+
+/// @brief Call fn with the value of a predecessor (nothing for void).
+template <typename F, typename T>
+decltype(auto) invoke_with(F& fn, T& value) {
+    if constexpr (std::is_same_v<T, std::monostate>) {
+        return fn();
+    } else {
+        return fn(value);
+    }
+}
+
+/// @brief Run fn and store its result (or completion) in state.
+template <typename R, typename F>
+void fulfil(TaskState<R>& state, F&& fn) {
+    if constexpr (std::is_void_v<R>) {
+        fn();
+        state.complete();
+    } else {
+        state.complete(fn());
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Shared handle to the result of a pool task.
+ *
+ * Copies refer to the same result. A default-constructed handle is empty
+ * (valid() is false) and must not be waited on.
+ *
+ * Thread-safety: every member may be called from any thread. wait() and
+ * get() block, so a pool worker should chain with then() rather than wait
+ * for tasks that may need its own pool.
+ */
+template <typename T>
+class TaskHandle {
+public:
+    using Value = typename detail::TaskState<T>::Value;
+
+    TaskHandle() = default;
+
+    [[nodiscard]] bool valid() const noexcept { return state_ != nullptr; }
+
+    /// @brief The task has finished.
+    [[nodiscard]] bool ready() const noexcept { return state_->ready(); }
+
+    /// @brief Block until the task has finished.
+    void wait() const { state_->wait(); }
+
+    /// @brief Block until the task has finished and return its result.
+    template <typename U = T>
+        requires(!std::is_void_v<U>)
+    [[nodiscard]] U& get() const {
+        return state_->wait();
+    }
+
+    /**
+     * @brief Run fn on the pool once this task has finished.
+     * @param fn Called with the result (as T&), or without arguments for void.
+     * @return Handle to the result of fn.
+     */
+    template <typename F>
+    auto then(ThreadPool& pool, F&& fn) const {
+        using R = std::decay_t<decltype(detail::invoke_with(fn, std::declval<Value&>()))>;
+        auto next = std::make_shared<detail::TaskState<R>>();
+        std::shared_ptr<detail::TaskState<T>> self = state_;
+        state_->on_complete([&pool, self, next, fn = std::forward<F>(fn)]() mutable {
+            pool.submit([self = std::move(self), next = std::move(next),
+                         fn = std::move(fn)]() mutable {
+                Value& value = self->wait();
+                detail::fulfil(*next, [&fn, &value] { return detail::invoke_with(fn, value); });
+            });
+        });
+        return TaskHandle<R>(std::move(next));
+    }
+
+private:
+    template <typename>
+    friend class TaskHandle;
+    template <typename>
+    friend class TaskPromise;
+    template <typename R, typename F>
+    friend TaskHandle<R> spawn_as(ThreadPool& pool, F&& fn);
+    template <typename U>
+    friend TaskHandle<void> when_all(const std::vector<TaskHandle<U>>& handles);
+    template <typename... Ts>
+    friend TaskHandle<void> when_all(const TaskHandle<Ts>&... handles);
+
+    explicit TaskHandle(std::shared_ptr<detail::TaskState<T>> state) : state_(std::move(state)) {}
+
+    /// @brief Run fn inline once finished (when_all() bookkeeping).
+    void on_complete(Task fn) const { state_->on_complete(std::move(fn)); }
+
+    std::shared_ptr<detail::TaskState<T>> state_;
+};
+
+/**
+ * @brief Result set by hand rather than by a task.
+ *
+ * The first set_value() wins; later ones are ignored.
+ */
+template <typename T>
+class TaskPromise {
+public:
+    TaskPromise() : state_(std::make_shared<detail::TaskState<T>>()) {}
+
+    [[nodiscard]] TaskHandle<T> handle() const { return TaskHandle<T>(state_); }
+
+    template <typename... Args>
+    void set_value(Args&&... args) {
+        state_->complete(std::forward<Args>(args)...);
+    }
+
+private:
+    std::shared_ptr<detail::TaskState<T>> state_;
+};
+
+/// @brief Run fn on the pool; the handle holds what it returns.
+template <typename R, typename F>
+TaskHandle<R> spawn_as(ThreadPool& pool, F&& fn) {
+    auto state = std::make_shared<detail::TaskState<R>>();
+    pool.submit([state, fn = std::forward<F>(fn)]() mutable { detail::fulfil(*state, fn); });
+    return TaskHandle<R>(std::move(state));
+}
+
+/// @brief Run fn on the pool and return a handle to its result.
+template <typename F>
+auto spawn(ThreadPool& pool, F&& fn) {
+    return spawn_as<std::invoke_result_t<std::decay_t<F>&>>(pool, std::forward<F>(fn));
+}
+
+namespace detail {
+
+/// @brief Completes a when_all() state once every joined handle has finished.
+class Join {
+public:
+    /// @param handles Number of handles to wait for.
+    explicit Join(std::size_t handles)
+        : state_(std::make_shared<TaskState<void>>()),
+          // One extra count keeps the join open until every handle is registered
+          pending_(std::make_shared<std::atomic<std::size_t>>(handles + 1)) {}
+
+    /// @brief One handle (or the registration itself) has finished.
+    void arrive() const {
+        if (pending_->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            state_->complete();
+        }
+    }
+
+    [[nodiscard]] const std::shared_ptr<TaskState<void>>& state() const noexcept { return state_; }
+
+private:
+    std::shared_ptr<TaskState<void>> state_;
+    std::shared_ptr<std::atomic<std::size_t>> pending_;
+};
+
+}  // namespace detail
+
+/**
+ * @brief Handle that finishes once every handle in handles has.
+ *
+ * Results stay in the original handles. An empty list is finished at once.
+ */
+template <typename T>
+TaskHandle<void> when_all(const std::vector<TaskHandle<T>>& handles) {
+    const detail::Join join(handles.size());
+    for (const auto& handle : handles) {
+        handle.on_complete([join] { join.arrive(); });
+    }
+    join.arrive();
+    return TaskHandle<void>(join.state());
+}
+
+/// @brief when_all() over handles of different result types.
+template <typename... Ts>
+TaskHandle<void> when_all(const TaskHandle<Ts>&... handles) {
+    const detail::Join join(sizeof...(Ts));
+    (handles.on_complete([join] { join.arrive(); }), ...);
+    join.arrive();
+    return TaskHandle<void>(join.state());
+}
+
+}  // namespace exeray
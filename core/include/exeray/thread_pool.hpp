@@ -1,72 +1,175 @@
 #pragma once
 
-#include <condition_variable>
-#include <functional>
-#include <mutex>
-#include <queue>
+/// @file thread_pool.hpp
+/// @brief Work-stealing pool running the engine's parallel stages.
+///
+/// Every worker owns a bounded Chase-Lev deque: tasks a worker submits go
+/// to the bottom of its own deque without a lock, and idle workers steal
+/// from the top of the others'. Tasks from outside the pool are spread
+/// over small per-worker inboxes. Idle workers spin briefly, then sleep on
+/// an eventcount, so a submit wakes nobody while every worker is busy.
+/// A placement policy pins each worker to processors chosen from the
+/// machine's topology (see platform::place_workers()).
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
 #include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "exeray/platform/thread.hpp"
+
 namespace exeray {
 
-class ThreadPool {
+/**
+ * @brief Move-only callable with room for small captures.
+ *
+ * Callables of up to kInline bytes that move without throwing are stored
+ * in place; larger ones are allocated. A std::function is accepted like
+ * any other callable.
+ */
+class Task {
 public:
-    using Task = std::function<void()>;
+    static constexpr std::size_t kInline = 48;
 
-    explicit ThreadPool(std::size_t num_threads = 0) : running_(true) {
-        auto count = num_threads > 0 ? num_threads : std::thread::hardware_concurrency();
-        workers_.reserve(count);
-        for (std::size_t i = 0; i < count; ++i) {
-            workers_.emplace_back([this] { run(); });
+    Task() noexcept = default;
+
+    template <typename F>
+        requires(!std::is_same_v<std::decay_t<F>, Task> && std::is_invocable_v<std::decay_t<F>&>)
+    Task(F&& fn) {  // NOLINT(google-explicit-constructor): submit() takes lambdas
+        using Fn = std::decay_t<F>;
+        if constexpr (kFitsInline<Fn>) {
+            ::new (static_cast<void*>(storage_)) Fn(std::forward<F>(fn));
+            ops_ = &kInlineOps<Fn>;
+        } else {
+            ::new (static_cast<void*>(storage_)) Fn*(new Fn(std::forward<F>(fn)));
+            ops_ = &kHeapOps<Fn>;
         }
     }
 
-    ~ThreadPool() {
-        {
-            std::lock_guard lock(mutex_);
-            running_ = false;
+    Task(Task&& other) noexcept { take(other); }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            take(other);
         }
-        cv_.notify_all();
-        for (auto& w : workers_) {
-            if (w.joinable()) w.join();
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { reset(); }
+
+    [[nodiscard]] explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+    void operator()() { ops_->invoke(storage_); }
+
+private:
+    struct Ops {
+        void (*invoke)(void* fn);
+        void (*move)(void* dst, void* src) noexcept;  ///< Also destroys src
+        void (*destroy)(void* fn) noexcept;
+    };
+
+    template <typename Fn>
+    static constexpr bool kFitsInline = sizeof(Fn) <= kInline &&
+                                        alignof(Fn) <= alignof(std::max_align_t) &&
+                                        std::is_nothrow_move_constructible_v<Fn>;
+
+    template <typename Fn>
+    static constexpr Ops kInlineOps{
+        [](void* fn) { (*static_cast<Fn*>(fn))(); },
+        [](void* dst, void* src) noexcept {
+            ::new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+            static_cast<Fn*>(src)->~Fn();
+        },
+        [](void* fn) noexcept { static_cast<Fn*>(fn)->~Fn(); }};
+
+    template <typename Fn>
+    static constexpr Ops kHeapOps{
+        [](void* fn) { (**static_cast<Fn**>(fn))(); },
+        [](void* dst, void* src) noexcept { ::new (dst) Fn*(*static_cast<Fn**>(src)); },
+        [](void* fn) noexcept { delete *static_cast<Fn**>(fn); }};
+
+    void take(Task& other) noexcept {
+        if (other.ops_ != nullptr) {
+            other.ops_->move(storage_, other.storage_);
+            ops_ = std::exchange(other.ops_, nullptr);
         }
     }
 
+    void reset() noexcept {
+        if (ops_ != nullptr) {
+            std::exchange(ops_, nullptr)->destroy(storage_);
+        }
+    }
+
+    alignas(std::max_align_t) std::byte storage_[kInline];
+    const Ops* ops_ = nullptr;
+};
+
+/**
+ * @brief Fixed set of workers sharing tasks by stealing.
+ *
+ * Tasks run in no particular order. The destructor runs every task
+ * submitted before it, including those they submit in turn, then joins.
+ *
+ * Thread-safety: submit() from any thread, pool workers included.
+ */
+class ThreadPool {
+public:
+    using Task = exeray::Task;
+
+    /// Tasks a worker's deque holds before its submits go to its inbox.
+    static constexpr std::size_t kDequeCapacity = 1024;
+
+    /// @param num_threads Workers (0 = as many as placement has slots,
+    ///        one per hardware thread when unpinned).
+    /// @param placement How workers are pinned to processors.
+    explicit ThreadPool(std::size_t num_threads = 0,
+                        platform::PoolPlacement placement = platform::PoolPlacement::None);
+    ~ThreadPool();
+
     ThreadPool(const ThreadPool&) = delete;
     ThreadPool& operator=(const ThreadPool&) = delete;
     ThreadPool(ThreadPool&&) = delete;
     ThreadPool& operator=(ThreadPool&&) = delete;
 
-    void submit(Task task) {
-        {
-            std::lock_guard lock(mutex_);
-            tasks_.push(std::move(task));
-        }
-        cv_.notify_one();
-    }
+    /// @brief Run task on a worker; an empty task is ignored.
+    void submit(Task task);
+
+    [[nodiscard]] std::size_t size() const noexcept { return threads_.size(); }
 
-    std::size_t size() const { return workers_.size(); }
+    /// @brief Processors worker index is pinned to (empty = unpinned).
+    [[nodiscard]] const std::vector<unsigned>& worker_cores(std::size_t index) const noexcept;
 
 private:
-    void run() {
-        while (true) {
-            Task task;
-            {
-                std::unique_lock lock(mutex_);
-                cv_.wait(lock, [this] { return !running_ || !tasks_.empty(); });
-                if (!running_ && tasks_.empty()) return;
-                task = std::move(tasks_.front());
-                tasks_.pop();
-            }
-            task();
-        }
-    }
+    struct Worker;
+
+    /// @brief Worker loop of workers_[index].
+    void run(std::size_t index);
+
+    /// @brief Take a task: own deque, own inbox, then the other workers'.
+    bool find(std::size_t index, Task& task);
+
+    /// @brief Index of the calling thread among the workers, or size().
+    [[nodiscard]] std::size_t current() const noexcept;
+
+    /// @brief Wake one sleeping worker, if any.
+    void wake_one() noexcept;
 
-    std::vector<std::thread> workers_;
-    std::queue<Task> tasks_;
-    std::mutex mutex_;
-    std::condition_variable cv_;
-    bool running_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<std::size_t> next_{0};           ///< Inbox of the next outside submit
+    std::atomic<std::uint32_t> epoch_{0};        ///< Eventcount: bumped to wake sleepers
+    std::atomic<std::uint32_t> sleepers_{0};     ///< Eventcount: workers about to sleep
+    std::atomic<bool> stopping_{false};
 };
 
-}
+}  // namespace exeray
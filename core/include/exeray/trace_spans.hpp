@@ -0,0 +1,166 @@
+#pragma once
+
+/// @file trace_spans.hpp
+/// @brief Scoped timing spans of the ingest hot path (self-instrumentation).
+///
+/// Shows where time goes inside the consumer: EXERAY_SPAN(Parse) and its
+/// siblings time the enclosing scope in cycles (TSC on x86) and append it
+/// to a ring owned by the calling thread, so SpanTrace holds the most
+/// recent spans of every thread. On Windows each span is also
+/// written to the "ExeRay.Spans" TraceLogging provider for WPA.
+///
+/// Spans are compiled in only with EXERAY_SPANS defined (CMake option
+/// EXERAY_ENABLE_SPANS); otherwise the trace stays empty and EXERAY_SPAN()
+/// only marks the stage for SamplingProfiler (see sampling_profiler.hpp).
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+#include "exeray/etw/parse_metrics.hpp"
+#include "exeray/sampling_profiler.hpp"
+
+namespace exeray {
+
+/// @brief Hot-path stages timed by EXERAY_SPAN().
+enum class SpanKind : std::uint8_t {
+    Parse,      ///< dispatch_event(): record to ParsedEvent
+    Intern,     ///< Deferred strings of one event into the StringPool
+    Detect,     ///< Rules and indicators of one event
+    Correlate,  ///< Parent and correlation ID resolution of a batch
+    Push,       ///< Batch into the EventGraph or the shard merger
+
+    Count  ///< Sentinel (not a span)
+};
+
+/// @brief Number of SpanKind values.
+inline constexpr std::size_t kSpanKinds = static_cast<std::size_t>(SpanKind::Count);
+
+/// @brief Lower-case name of a span ("parse", ...).
+[[nodiscard]] std::string_view span_name(SpanKind kind) noexcept;
+
+/// @brief Whether EXERAY_SPAN() records in this build.
+#if defined(EXERAY_SPANS)
+inline constexpr bool kSpansEnabled = true;
+#else
+inline constexpr bool kSpansEnabled = false;
+#endif
+
+/// @brief One finished span.
+struct SpanRecord {
+    std::uint64_t start = 0;   ///< etw::read_cycles() at scope entry
+    std::uint64_t cycles = 0;  ///< Duration
+    std::uint32_t thread = 0;  ///< Index of the recording ring (stable per thread)
+    SpanKind kind = SpanKind::Count;
+};
+
+/**
+ * @brief Process-wide flight recorder of spans in per-thread rings.
+ *
+ * Every thread that records gets a ring the first time; when it exits the
+ * ring is handed to the next new thread. A full ring overwrites its oldest
+ * spans.
+ *
+ * Thread-safety: record() from any thread without locks; snapshot() and
+ * write_chrome_trace() from any thread (skip spans overwritten while they
+ * copy); reset() while nothing records.
+ */
+class SpanTrace {
+public:
+    /// Ring slots per thread (power of two); snapshot() returns up to one
+    /// less, as the oldest slot may be under the owner's next write.
+    static constexpr std::size_t kRingRecords = 16384;
+
+    /// @brief The process-wide instance used by EXERAY_SPAN().
+    [[nodiscard]] static SpanTrace& global() noexcept;
+
+    SpanTrace(const SpanTrace&) = delete;
+    SpanTrace& operator=(const SpanTrace&) = delete;
+
+    /// @brief Append a span to the calling thread's ring.
+    void record(SpanKind kind, std::uint64_t start, std::uint64_t cycles) noexcept;
+
+    /// @brief Spans of all rings, oldest first.
+    [[nodiscard]] std::vector<SpanRecord> snapshot() const;
+
+    /// @brief Spans recorded since the last reset (including overwritten ones).
+    [[nodiscard]] std::uint64_t recorded() const;
+
+    /**
+     * @brief Write the snapshot in the Chrome trace event format.
+     *
+     * One complete ("X") event per span with microsecond times relative to
+     * the oldest span, one track per ring; opens in Perfetto or
+     * chrome://tracing.
+     *
+     * @return Whether the stream is still good.
+     */
+    bool write_chrome_trace(std::ostream& out) const;
+
+    /// @brief Drop all spans (start of a monitoring session).
+    void reset() noexcept;
+
+    /// @brief Cycle counter ticks per microsecond, measured since construction.
+    [[nodiscard]] double cycles_per_us() const noexcept;
+
+private:
+    struct Ring;
+
+    SpanTrace();
+    ~SpanTrace();
+
+    friend struct SpanLease;
+
+    /// @brief Ring of the calling thread (allocated on first use).
+    Ring& local();
+
+    /// @brief Hand a ring over to future threads.
+    void release(Ring* ring) noexcept;
+
+    std::uint64_t epoch_cycles_;  ///< read_cycles() at construction
+    std::int64_t epoch_ns_;       ///< steady_clock at construction
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Ring>> rings_;  ///< Guarded by mutex_
+    std::vector<Ring*> free_;                   ///< Guarded by mutex_
+};
+
+/// @brief Times its scope into SpanTrace::global() (use EXERAY_SPAN()).
+class Span {
+public:
+    explicit Span(SpanKind kind) noexcept
+        : stage_(static_cast<std::uint8_t>(kind)), kind_(kind), start_(etw::read_cycles()) {}
+
+    ~Span() { SpanTrace::global().record(kind_, start_, etw::read_cycles() - start_); }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    StageScope stage_;
+    SpanKind kind_;
+    std::uint64_t start_;
+};
+
+}  // namespace exeray
+
+#define EXERAY_SPAN_CONCAT_(a, b) a##b
+#define EXERAY_SPAN_VAR_(line) EXERAY_SPAN_CONCAT_(exeray_span_, line)
+
+/// @brief Time the rest of the enclosing scope as a SpanKind (and mark it
+/// as the thread's stage).
+/// @param kind SpanKind enumerator name (Parse, Intern, Detect, Correlate, Push).
+#if defined(EXERAY_SPANS)
+#define EXERAY_SPAN(kind) \
+    const ::exeray::Span EXERAY_SPAN_VAR_(__LINE__) { ::exeray::SpanKind::kind }
+#else
+#define EXERAY_SPAN(kind)                                   \
+    const ::exeray::StageScope EXERAY_SPAN_VAR_(__LINE__) { \
+        static_cast<std::uint8_t>(::exeray::SpanKind::kind) \
+    }
+#endif
@@ -0,0 +1,50 @@
+/// @file alloc_tracking.cpp
+/// @brief Per-thread and process-wide allocation counters.
+
+#include "exeray/alloc_tracking.hpp"
+
+#include <atomic>
+
+namespace exeray::alloc {
+
+namespace {
+
+// Trivial types only: operator new may run before and after the
+// thread's dynamic thread_locals exist
+constinit thread_local AllocationCount t_count{};
+
+constinit std::atomic<std::uint64_t> g_allocations{0};
+constinit std::atomic<std::uint64_t> g_bytes{0};
+constinit std::atomic<bool> g_hooked{false};
+
+}  // namespace
+
+bool hooked() noexcept {
+    return g_hooked.load(std::memory_order_relaxed);
+}
+
+AllocationCount thread_allocations() noexcept {
+    return t_count;
+}
+
+AllocationCount process_allocations() noexcept {
+    return {g_allocations.load(std::memory_order_relaxed),
+            g_bytes.load(std::memory_order_relaxed)};
+}
+
+namespace detail {
+
+void record(std::size_t size) noexcept {
+    ++t_count.allocations;
+    t_count.bytes += size;
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void mark_hooked() noexcept {
+    g_hooked.store(true, std::memory_order_relaxed);
+}
+
+}  // namespace detail
+
+}  // namespace exeray::alloc
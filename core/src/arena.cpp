@@ -0,0 +1,452 @@
+/// @file arena.cpp
+/// @brief Arena backing store: heap, reserved virtual range or large pages.
+
+#include "exeray/arena.hpp"
+#include "exeray/logging.hpp"
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <filesystem>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace exeray {
+
+namespace {
+
+std::size_t round_up(std::size_t value, std::size_t granularity) {
+    return (value + granularity - 1) / granularity * granularity;
+}
+
+#ifdef _WIN32
+
+/// @brief Log Windows error with function context.
+void log_error(const char* function) {
+    DWORD error = GetLastError();
+    EXERAY_WARN("[exeray::arena] {} failed with error {}", function, error);
+}
+
+/// @brief Enable SeLockMemoryPrivilege, required for MEM_LARGE_PAGES.
+bool enable_lock_memory_privilege() {
+    HANDLE token = nullptr;
+    if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY,
+                          &token)) {
+        log_error("OpenProcessToken");
+        return false;
+    }
+    TOKEN_PRIVILEGES privileges{};
+    privileges.PrivilegeCount = 1;
+    privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+    bool enabled = LookupPrivilegeValueW(nullptr, L"SeLockMemoryPrivilege",
+                                         &privileges.Privileges[0].Luid) &&
+                   AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr);
+    // AdjustTokenPrivileges succeeds without assigning a privilege the
+    // account does not hold; that case is reported through GetLastError()
+    enabled = enabled && GetLastError() == ERROR_SUCCESS;
+    if (!enabled) {
+        log_error("AdjustTokenPrivileges(SeLockMemoryPrivilege)");
+    }
+    CloseHandle(token);
+    return enabled;
+}
+
+/// @brief VirtualAlloc with an optional NUMA node preference.
+void* os_alloc(void* address, std::size_t size, DWORD type, int node) {
+    if (node >= 0) {
+        return VirtualAllocExNuma(GetCurrentProcess(), address, size, type,
+                                  PAGE_READWRITE, static_cast<DWORD>(node));
+    }
+    return VirtualAlloc(address, size, type, PAGE_READWRITE);
+}
+
+#endif  // _WIN32
+
+/// @brief One thread's current block in one arena.
+struct LocalBlock {
+    const Arena* arena = nullptr;
+    std::uint64_t generation = 0;
+    std::uint8_t* cursor = nullptr;
+    std::uint8_t* end = nullptr;
+};
+
+/// Arenas a thread buffers at once (engines rarely share threads).
+constexpr std::size_t kLocalSlots = 4;
+
+/// Below this block size thread buffers are not worth it.
+constexpr std::size_t kMinLocalBlock = 256;
+
+thread_local std::array<LocalBlock, kLocalSlots> t_blocks{};
+thread_local std::size_t t_next_slot = 0;
+
+/// Stride of prefault touches (the smallest page size in use).
+constexpr std::size_t kPage = 4096;
+
+/// @brief Fault in committed pages that allocating threads may already own.
+void populate(std::uint8_t* begin, std::size_t size) {
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(begin, size, MADV_POPULATE_WRITE) == 0) {
+        return;
+    }
+#endif
+    // An atomic no-op write faults a page in without clobbering a writer
+    // that was handed it meanwhile
+    for (std::size_t at = 0; at < size; at += kPage) {
+        std::atomic_ref(begin[at]).fetch_or(0, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace
+
+struct Arena::Prefaulter {
+    std::size_t window = 0;  ///< Bytes kept faulted past the offset
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::size_t wanted = 0;  ///< Offset to fault up to (mutex)
+    bool stop = false;       ///< Set by the destructor (mutex)
+    std::thread thread;
+};
+
+std::uint64_t Arena::next_generation() noexcept {
+    static std::atomic<std::uint64_t> counter{1};
+    return counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::uint8_t* Arena::allocate_local_bytes(std::size_t size, std::size_t align) {
+    // Small arenas get small blocks so one thread cannot claim all of it
+    const std::size_t block_size = (std::min)(kLocalBlock, capacity_ / 64 & ~std::size_t{63});
+    // Large requests would waste most of a block's tail
+    if (align > 64 || block_size < kMinLocalBlock || size > block_size / 8) {
+        return bump(size, align);
+    }
+    const auto generation = generation_.load(std::memory_order_acquire);
+    LocalBlock* block = nullptr;
+    for (auto& candidate : t_blocks) {
+        if (candidate.arena == this && candidate.generation == generation) {
+            block = &candidate;
+            break;
+        }
+    }
+    if (block != nullptr) {
+        const auto cursor = reinterpret_cast<std::uintptr_t>(block->cursor);
+        auto* aligned = block->cursor + (((cursor + align - 1) & ~(align - 1)) - cursor);
+        if (aligned <= block->end && size <= static_cast<std::size_t>(block->end - aligned)) {
+            block->cursor = aligned + size;
+            return aligned;
+        }
+    }
+    std::uint8_t* fresh = bump(block_size, 64);
+    if (fresh == nullptr) {
+        return bump(size, align);
+    }
+    if (block == nullptr) {
+        block = &t_blocks[t_next_slot++ % kLocalSlots];
+    } else {
+        // The old block's tail is never handed out
+        padding_.fetch_add(static_cast<std::size_t>(block->end - block->cursor),
+                           std::memory_order_relaxed);
+    }
+    *block = LocalBlock{this, generation, fresh + size, fresh + block_size};
+    return fresh;
+}
+
+Arena::Arena(std::size_t capacity, const ArenaOptions& options)
+    : capacity_(capacity) {
+    const bool growable = options.max_capacity > capacity;
+    const auto reserve = growable ? options.max_capacity : capacity;
+    const bool want_virtual = growable || options.lazy_commit || options.large_pages ||
+                              options.numa_node >= 0 || options.prefault > 0;
+    if (!options.backing_file.empty() && reserve > 0) {
+        map_file(options.backing_file, round_up(reserve, kCommitChunk));
+    }
+#ifdef _WIN32
+    if (base_ == nullptr && options.large_pages && !growable && capacity > 0) {
+        const SIZE_T page = GetLargePageMinimum();
+        if (page != 0 && enable_lock_memory_privilege()) {
+            const auto size = round_up(capacity, page);
+            void* memory = os_alloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                                    options.numa_node);
+            if (memory != nullptr) {
+                base_ = static_cast<std::uint8_t*>(memory);
+                mapped_ = size;
+                backend_ = ArenaBackend::LargePages;
+                numa_node_ = options.numa_node;
+            } else {
+                log_error("VirtualAlloc(MEM_LARGE_PAGES)");
+            }
+        }
+    }
+    if (base_ == nullptr && reserve > 0 && want_virtual) {
+        const auto size = round_up(reserve, kCommitChunk);
+        void* memory = os_alloc(nullptr, size, MEM_RESERVE, options.numa_node);
+        if (memory != nullptr) {
+            base_ = static_cast<std::uint8_t*>(memory);
+            mapped_ = size;
+            backend_ = ArenaBackend::Virtual;
+            numa_node_ = options.numa_node;
+        } else {
+            log_error("VirtualAlloc(MEM_RESERVE)");
+        }
+    }
+#elif defined(__unix__) || defined(__APPLE__)
+#ifdef MAP_HUGETLB
+    if (base_ == nullptr && options.large_pages && !growable && capacity > 0) {
+        const auto size = round_up(capacity, kCommitChunk);
+        void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED) {
+            base_ = static_cast<std::uint8_t*>(memory);
+            mapped_ = size;
+            backend_ = ArenaBackend::LargePages;
+        } else {
+            EXERAY_WARN("[exeray::arena] no huge pages reserved, using normal pages");
+        }
+    }
+#endif
+    if (base_ == nullptr && reserve > 0 && want_virtual) {
+        // Reserve inaccessible address space; commit() makes it writable
+        const auto size = round_up(reserve, kCommitChunk);
+        void* memory = mmap(nullptr, size, PROT_NONE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (memory != MAP_FAILED) {
+            base_ = static_cast<std::uint8_t*>(memory);
+            mapped_ = size;
+            backend_ = ArenaBackend::Virtual;
+#ifdef MADV_HUGEPAGE
+            if (options.large_pages) {
+                // Transparent huge pages are the closest fallback
+                madvise(memory, size, MADV_HUGEPAGE);
+            }
+#endif
+        }
+    }
+    // NUMA binding needs libnuma here; the preference is not applied
+#endif
+
+    if (backend_ == ArenaBackend::File) {
+        // Sparse file: committed as a whole, disk used as pages are written
+        capacity_ = reserve;
+    }
+    if (base_ != nullptr && backend_ == ArenaBackend::Virtual) {
+        capacity_ = reserve;
+        // Without lazy commit only the initial capacity is committed up front
+        if (options.lazy_commit || commit(capacity)) {
+            start_prefault(options.prefault);
+            return;
+        }
+        release();
+        base_ = nullptr;
+        capacity_ = capacity;
+    }
+    if (base_ == nullptr) {
+        if (!options.backing_file.empty()) {
+            EXERAY_WARN("[exeray::arena] cannot map {}, using anonymous memory",
+                        options.backing_file);
+        }
+        if (growable) {
+            EXERAY_WARN("[exeray::arena] cannot reserve {} bytes, arena stays fixed at {}",
+                        reserve, capacity);
+        }
+        base_ = static_cast<std::uint8_t*>(::operator new(capacity, std::align_val_t{64}));
+        backend_ = ArenaBackend::Heap;
+        numa_node_ = -1;
+    }
+    committed_.store(capacity_, std::memory_order_relaxed);
+}
+
+ArenaStats Arena::stats() const {
+    ArenaStats stats;
+    stats.used = used();
+    stats.committed = committed();
+    stats.reserved = backend_ == ArenaBackend::Heap ? capacity_ : mapped_;
+    stats.capacity = capacity_;
+    stats.high_water = (std::max)(stats.used, high_water_.load(std::memory_order_relaxed));
+    stats.padding = padding_.load(std::memory_order_relaxed);
+    stats.failures = failures_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+Arena::~Arena() {
+    if (prefaulter_ != nullptr) {
+        {
+            const std::lock_guard lock(prefaulter_->mutex);
+            prefaulter_->stop = true;
+        }
+        prefaulter_->wake.notify_one();
+        prefaulter_->thread.join();
+    }
+    release();
+}
+
+void Arena::start_prefault(std::size_t window) {
+    if (window == 0) {
+        return;
+    }
+    prefaulter_ = std::make_unique<Prefaulter>();
+    prefaulter_->window = round_up(window, kCommitChunk);
+    prefaulter_->wanted = (std::min)(capacity_, prefaulter_->window);
+    prefaulter_->thread = std::thread([this] { prefault_loop(); });
+}
+
+void Arena::request_prefault(std::size_t offset) {
+    // Only the allocation that takes the mark wakes the thread
+    if (prefault_mark_.exchange((std::numeric_limits<std::size_t>::max)(),
+                                std::memory_order_relaxed) ==
+        (std::numeric_limits<std::size_t>::max)()) {
+        return;
+    }
+    {
+        const std::lock_guard lock(prefaulter_->mutex);
+        prefaulter_->wanted = (std::min)(capacity_, round_up(offset + prefaulter_->window,
+                                                             kCommitChunk));
+    }
+    prefaulter_->wake.notify_one();
+}
+
+void Arena::prefault_loop() {
+    Prefaulter& state = *prefaulter_;
+    std::size_t faulted = 0;
+    for (;;) {
+        std::size_t target = 0;
+        {
+            std::unique_lock lock(state.mutex);
+            state.wake.wait(lock, [&] { return state.stop || state.wanted > faulted; });
+            if (state.stop) {
+                return;
+            }
+            target = state.wanted;
+        }
+        if (target < capacity_) {
+            // Asked again once half the window is used
+            prefault_mark_.store(target - state.window / 2, std::memory_order_relaxed);
+        }
+        if (!commit(target)) {
+            return;  // The allocating path reports the failure
+        }
+        populate(base_ + faulted, target - faulted);
+        faulted = target;
+    }
+}
+
+void Arena::map_file(const std::string& path, std::size_t size) {
+#ifdef _WIN32
+    HANDLE file = CreateFileW(std::filesystem::path(path).c_str(), GENERIC_READ | GENERIC_WRITE,
+                              0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        log_error("CreateFileW");
+        return;
+    }
+    const auto length = static_cast<std::uint64_t>(size);
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(length >> 32),
+                                        static_cast<DWORD>(length), nullptr);
+    void* view = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size)
+                                    : nullptr;
+    if (view == nullptr) {
+        log_error(mapping == nullptr ? "CreateFileMappingW" : "MapViewOfFile");
+    }
+    // The view holds the file open; it is deleted once unmapped
+    if (mapping != nullptr) {
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+    if (view == nullptr) {
+        return;
+    }
+    base_ = static_cast<std::uint8_t*>(view);
+#elif defined(__unix__) || defined(__APPLE__)
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return;
+    }
+    void* memory = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    // The mapping keeps the file's blocks; only its name goes
+    ::unlink(path.c_str());
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        return;
+    }
+    base_ = static_cast<std::uint8_t*>(memory);
+#else
+    (void)path;
+    (void)size;
+    return;
+#endif
+    mapped_ = size;
+    backend_ = ArenaBackend::File;
+}
+
+void Arena::page_out(const void* p, std::size_t size) const noexcept {
+    if (backend_ != ArenaBackend::File) {
+        return;
+    }
+    // Only whole pages inside the range
+    const auto begin = round_up(reinterpret_cast<std::uintptr_t>(p), kPage);
+    const auto end = (reinterpret_cast<std::uintptr_t>(p) + size) / kPage * kPage;
+    if (end <= begin) {
+        return;
+    }
+#ifdef _WIN32
+    // Unlocking pages that are not locked trims them from the working set
+    VirtualUnlock(reinterpret_cast<void*>(begin), end - begin);
+#elif defined(MADV_COLD)
+    madvise(reinterpret_cast<void*>(begin), end - begin, MADV_COLD);
+#endif
+}
+
+void Arena::release() noexcept {
+    if (backend_ == ArenaBackend::Heap) {
+        ::operator delete(base_, std::align_val_t{64});
+        return;
+    }
+#ifdef _WIN32
+    if (backend_ == ArenaBackend::File) {
+        UnmapViewOfFile(base_);
+        return;
+    }
+    VirtualFree(base_, 0, MEM_RELEASE);
+#elif defined(__unix__) || defined(__APPLE__)
+    munmap(base_, mapped_);
+#endif
+}
+
+bool Arena::commit(std::size_t end) {
+    std::lock_guard lock(commit_mutex_);
+    const auto current = committed_.load(std::memory_order_relaxed);
+    if (end <= current) {
+        return true;
+    }
+    // Chunks are reservation-aligned; only the last one is cut at capacity
+    const auto target = (std::min)(capacity_, round_up(end, kCommitChunk));
+#ifdef _WIN32
+    if (os_alloc(base_ + current, target - current, MEM_COMMIT, numa_node_) == nullptr) {
+        log_error("VirtualAlloc(MEM_COMMIT)");
+        return false;
+    }
+#elif defined(__unix__) || defined(__APPLE__)
+    if (mprotect(base_ + current, target - current, PROT_READ | PROT_WRITE) != 0) {
+        EXERAY_WARN("[exeray::arena] commit of {} bytes failed", target - current);
+        return false;
+    }
+#else
+    return false;
+#endif
+    committed_.store(target, std::memory_order_release);
+    return true;
+}
+
+}  // namespace exeray
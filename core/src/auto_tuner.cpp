@@ -0,0 +1,135 @@
+/// @file auto_tuner.cpp
+/// @brief AutoTuner policy and signal extraction.
+
+#include "exeray/auto_tuner.hpp"
+
+#include <algorithm>
+#include <string>
+
+namespace exeray {
+
+TuningSignals TuningSignals::from(const std::vector<MetricSample>& samples) {
+    const std::string visible_p99 =
+        metric_label("stage", "visible") + "," + metric_label("quantile", "0.99");
+    TuningSignals signals;
+    for (const MetricSample& sample : samples) {
+        if (sample.name == "exeray_etw_events_lost_total" ||
+            sample.name == "exeray_etw_buffers_lost_total" ||
+            sample.name == "exeray_ring_overflows_total") {
+            signals.lost += sample.value;
+        } else if (sample.name == "exeray_detection_backlog") {
+            signals.backlog = sample.value;
+        } else if (sample.name == "exeray_ingest_latency_seconds" &&
+                   sample.labels == visible_p99) {
+            signals.latency_s = sample.value;
+        } else if (sample.name == "exeray_process_cpu_seconds_total") {
+            signals.cpu_seconds = sample.value;
+        }
+    }
+    return signals;
+}
+
+AutoTuner::AutoTuner(const AutoTuneConfig& config, const TuningState& initial,
+                     unsigned processors)
+    : config_(config), initial_(initial), state_(initial), processors_(processors) {
+    config_.min_batch = (std::max)(config_.min_batch, 1U);
+    config_.max_batch = (std::max)(config_.max_batch, config_.min_batch);
+    config_.min_workers = (std::max)(config_.min_workers, std::size_t{1});
+    if (config_.max_workers == 0) {
+        config_.max_workers = initial.workers;
+    }
+    config_.max_workers = (std::max)(config_.max_workers, config_.min_workers);
+    config_.min_sample_percent = (std::min)(config_.min_sample_percent, initial.sample_percent);
+}
+
+const TuningState& AutoTuner::step(const TuningSignals& signals, double elapsed_s) {
+    reason_ = {};
+    if (!primed_) {
+        previous_ = signals;
+        primed_ = true;
+        return state_;
+    }
+    const double lost = signals.lost - previous_.lost;
+    const double cpu_percent =
+        elapsed_s > 0.0 && processors_ > 0
+            ? (signals.cpu_seconds - previous_.cpu_seconds) / elapsed_s / processors_ * 100.0
+            : 0.0;
+    previous_ = signals;
+
+    // Detection workers are only moved while the stage runs
+    const bool detecting = state_.workers > 0;
+    const bool backlogged =
+        detecting && signals.backlog > kBacklogPerWorker * static_cast<double>(state_.workers);
+    const bool over_cpu =
+        config_.cpu_budget_percent > 0 && cpu_percent > config_.cpu_budget_percent;
+    const bool slow = config_.latency_target_ms > 0 &&
+                      signals.latency_s * 1000.0 > config_.latency_target_ms;
+    const auto add_worker = [this] {
+        state_.workers = (std::min)(state_.workers + 1, config_.max_workers);
+    };
+    const auto remove_worker = [this] {
+        state_.workers = (std::max)(state_.workers - 1, config_.min_workers);
+    };
+
+    const TuningState before = state_;
+    if (lost > 0.0 || over_cpu || backlogged || slow) {
+        quiet_ = 0;
+    }
+    if (lost > 0.0) {
+        // Fewer, larger pushes and earlier shedding both free the consumer
+        state_.batch = (std::min)(state_.batch * 2, config_.max_batch);
+        shed_more();
+        if (backlogged && !over_cpu) {
+            add_worker();
+        }
+        reason_ = "events lost";
+    } else if (over_cpu) {
+        shed_more();
+        if (detecting) {
+            remove_worker();
+        }
+        reason_ = "CPU over budget";
+    } else if (backlogged) {
+        add_worker();
+        reason_ = "detection backlog";
+    } else if (slow) {
+        state_.batch = (std::max)(state_.batch / 2, config_.min_batch);
+        reason_ = "latency above target";
+    } else if (++quiet_ >= config_.quiet_intervals) {
+        // Walk one step back toward the configured values
+        quiet_ = 0;
+        if (state_.batch > initial_.batch) {
+            state_.batch = (std::max)(state_.batch / 2, initial_.batch);
+        } else if (state_.batch < initial_.batch) {
+            state_.batch = (std::min)(state_.batch * 2, initial_.batch);
+        }
+        const auto delta = static_cast<std::uint8_t>(
+            (std::min)(kShedStep, static_cast<std::uint8_t>(initial_.sample_percent -
+                                                            state_.sample_percent)));
+        state_.sample_percent = static_cast<std::uint8_t>(state_.sample_percent + delta);
+        state_.drop_percent = static_cast<std::uint8_t>(state_.drop_percent + delta);
+        if (detecting && state_.workers > initial_.workers && signals.backlog == 0.0) {
+            remove_worker();
+        } else if (detecting && state_.workers < initial_.workers) {
+            add_worker();
+        }
+        reason_ = "quiet";
+    }
+    if (state_ == before) {
+        reason_ = {};
+    }
+    return state_;
+}
+
+void AutoTuner::shed_more() noexcept {
+    if (state_.sample_percent <= config_.min_sample_percent) {
+        return;
+    }
+    const auto delta = static_cast<std::uint8_t>(
+        (std::min)(kShedStep,
+                   static_cast<std::uint8_t>(state_.sample_percent - config_.min_sample_percent)));
+    state_.sample_percent = static_cast<std::uint8_t>(state_.sample_percent - delta);
+    state_.drop_percent = static_cast<std::uint8_t>(state_.drop_percent - delta);
+}
+
+}  // namespace exeray
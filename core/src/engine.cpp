@@ -6,25 +6,61 @@
 
 #include "exeray/engine.hpp"
 
+#include <initializer_list>
+
 exeray::EngineConfig exeray::EngineConfig::with_defaults(std::size_t arena_size,
                                                   std::size_t num_threads) {
     EngineConfig cfg;
     cfg.arena_size = arena_size;
     cfg.num_threads = num_threads;
     cfg.providers = {
-        {"Process", {true, 4, 0}},
-        {"File", {true, 4, 0}},
-        {"Registry", {true, 4, 0}},
-        {"Network", {true, 4, 0}},
-        {"Image", {true, 4, 0}},
-        {"Thread", {true, 4, 0}},
-        {"Memory", {true, 5, 0}},       // VERBOSE for detailed info
-        {"PowerShell", {true, 5, 0}},
-        {"AMSI", {true, 4, 0}},
-        {"DNS", {false, 4, 0}},         // Disabled by default
-        {"WMI", {false, 4, 0}},
-        {"CLR", {false, 4, 0}},
-        {"Security", {false, 4, 0}},
+        {"Process", {true, 4, 0, 0, {}}},
+        {"File", {true, 4, 0, 0, {}}},
+        {"Registry", {true, 4, 0, 0, {}}},
+        {"Network", {true, 4, 0, 0, {}}},
+        {"Image", {true, 4, 0, 0, {}}},
+        {"Thread", {true, 4, 0, 0, {}}},
+        {"Memory", {true, 5, 0, 0, {}}},       // VERBOSE for detailed info
+        {"PowerShell", {true, 5, 0, 0, {}}},
+        {"AMSI", {true, 4, 0, 0, {}}},
+        {"DNS", {false, 4, 0, 0, {}}},      // Disabled by default
+        {"WMI", {false, 4, 0, 0, {}}},
+        {"CLR", {false, 4, 0, 0, {}}},
+        {"Security", {false, 4, 0, 0, {}}},
+    };
+    return cfg;
+}
+
+exeray::EngineConfig exeray::EngineConfig::system_wide(std::size_t arena_size,
+                                                std::size_t num_threads) {
+    EngineConfig cfg = with_defaults(arena_size, num_threads);
+
+    // One ProcessTrace thread per busy group; Process stays with Image,
+    // Thread and Memory so parents resolve in order
+    const auto assign = [&cfg](std::uint8_t session, std::initializer_list<const char*> names) {
+        for (const char* name : names) {
+            cfg.providers.at(name).session = session;
+        }
     };
+    assign(0, {"Process", "Image", "Thread", "Memory"});
+    assign(1, {"File", "Registry"});
+    assign(2, {"Network", "DNS"});
+    assign(3, {"PowerShell", "AMSI", "CLR", "WMI", "Security"});
+    cfg.providers.at("Memory").level = 4;  // VERBOSE host-wide is mostly noise
+
+    // Keep the newest events instead of filling up, strings on their own
+    // budget so a burst of paths cannot evict events
+    cfg.retention = event::Retention::Ring;
+    cfg.max_event_bytes = arena_size / 2;
+    cfg.string_arena.size = arena_size / 4;
+
+    // Parse off the callback, with room for a few seconds of backlog
+    cfg.ingest_ring_bytes = std::size_t{64} << 20;
+    cfg.etw_buffers.buffer_kb = etw::SessionBuffers::kMaxBufferKb;
+    cfg.file_coalesce_ms = 250;
+    cfg.flows.enabled = true;
+    cfg.shedding.enabled = true;
+    cfg.follow_children = false;
+    cfg.prewarm_schemas = true;  // No target waits for the sessions
     return cfg;
 }
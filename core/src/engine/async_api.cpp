@@ -0,0 +1,77 @@
+/// @file engine/async_api.cpp
+/// @brief Coroutine variants of the blocking control calls, events_after()
+/// and wait_for_events().
+
+#include "exeray/engine.hpp"
+
+#include <utility>
+
+namespace exeray {
+
+AsyncTask<bool> Engine::start_monitoring_async(std::wstring exe_path) {
+    co_await resume_on(pool_);
+    co_return start_monitoring(exe_path);
+}
+
+AsyncTask<void> Engine::drain_async() {
+    co_await resume_on(pool_);
+    stop_monitoring();
+}
+
+AsyncTask<std::optional<ReplayStats>> Engine::replay_async(std::wstring path,
+                                                         ReplayOptions options) {
+    co_await resume_on(pool_);
+    co_return replay(path, options);
+}
+
+AsyncTask<std::vector<etw::StackFrame>> Engine::symbolize_stack_async(event::ExtensionId stack,
+                                                                      std::uint32_t pid) {
+    co_await resume_on(pool_);
+    co_return symbolize_stack(stack, pid);
+}
+
+bool Engine::EventsAfter::await_ready() const noexcept {
+    return engine_.graph_.newest_id() > seen_ ||
+           !engine_.ingesting_.load(std::memory_order_seq_cst);
+}
+
+void Engine::EventsAfter::await_suspend(std::coroutine_handle<> awaiting) {
+    Engine& engine = engine_;
+    engine.graph_.when_published(seen_, [&engine, awaiting] {
+        engine.pool_.submit([awaiting] { awaiting.resume(); });
+    });
+    // A stop between await_ready() and registering released the watchers
+    // before ours was added; release again so that we are not left waiting
+    if (!engine.ingesting_.load(std::memory_order_seq_cst)) {
+        engine.graph_.release_watchers();
+    }
+}
+
+event::EventId Engine::EventsAfter::await_resume() const noexcept {
+    return engine_.graph_.newest_id();
+}
+
+event::EventId Engine::wait_for_events(event::EventId seen, std::chrono::milliseconds timeout) {
+    if (graph_.newest_id() > seen) {
+        return graph_.newest_id();
+    }
+    std::unique_lock lock(wake_mutex_);
+    if (!wake_armed_) {
+        wake_armed_ = true;
+        lock.unlock();
+        // May run right here, on a pushing thread, or in release_watchers()
+        graph_.when_published(seen, [this] {
+            {
+                std::lock_guard guard(wake_mutex_);
+                wake_armed_ = false;
+            }
+            wake_cv_.notify_all();
+        });
+        lock.lock();
+    }
+    wake_cv_.wait_for(lock, timeout,
+                      [this, seen] { return !wake_armed_ || graph_.newest_id() > seen; });
+    return graph_.newest_id();
+}
+
+}  // namespace exeray
@@ -0,0 +1,96 @@
+/// @file engine/auto_tune.cpp
+/// @brief The Engine's auto-tuner thread and how tuned values are applied.
+
+#include "exeray/engine.hpp"
+#include "exeray/logging.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace exeray {
+
+TuningState Engine::tuning() const {
+    std::lock_guard lock(tuning_mutex_);
+    return tuning_;
+}
+
+void Engine::apply_tuning(const TuningState& state) {
+    for (const auto& shard : shards_) {
+        shard->ctx.batch_limit.store(state.batch, std::memory_order_relaxed);
+    }
+    if (state.workers > 0 && detection_.running()) {
+        detection_.set_workers(state.workers);
+    }
+    shed_.set_thresholds(state.sample_percent, state.drop_percent);
+    std::lock_guard lock(tuning_mutex_);
+    tuning_ = state;
+}
+
+void Engine::start_auto_tuner() {
+    const TuningState initial{
+        .batch = static_cast<std::uint32_t>(etw::ConsumerContext::kMaxPendingEvents),
+        .workers = detection_.running() ? detection_.workers() : 0,
+        .sample_percent = shed_.sample_percent(),
+        .drop_percent = shed_.drop_percent()};
+    {
+        std::lock_guard lock(tuning_mutex_);
+        tuning_ = initial;
+    }
+    if (!config_.auto_tune.enabled || config_.auto_tune.interval_ms == 0 ||
+        tuner_thread_.joinable()) {
+        return;
+    }
+    // Detection may grow into the pool workers the drains leave free
+    AutoTuneConfig bounds = config_.auto_tune;
+    if (bounds.max_workers == 0) {
+        const bool drains = config_.ingest_ring_bytes > 0 && pool_.size() > shards_.size();
+        bounds.max_workers = pool_.size() - (drains ? shards_.size() : 0);
+    }
+    {
+        std::lock_guard lock(tuner_mutex_);
+        tuner_stop_ = false;
+    }
+    tuner_thread_ = std::thread([this, bounds, initial] {
+        using Clock = std::chrono::steady_clock;
+        AutoTuner tuner(bounds, initial, (std::max)(std::thread::hardware_concurrency(), 1U));
+        const auto interval = std::chrono::milliseconds(bounds.interval_ms);
+        auto last = Clock::now();
+        std::unique_lock lock(tuner_mutex_);
+        do {
+            lock.unlock();
+            const auto now = Clock::now();
+            const TuningState before = tuner.state();
+            const TuningState& after =
+                tuner.step(TuningSignals::from(metrics_.snapshot()),
+                           std::chrono::duration<double>(now - last).count());
+            last = now;
+            if (!(after == before)) {
+                EXERAY_INFO("Engine: Auto-tune ({}): batch {} -> {}, detection workers {} -> {}, "
+                            "shedding {}%/{}% -> {}%/{}%",
+                            tuner.reason(), before.batch, after.batch, before.workers,
+                            after.workers, before.sample_percent, before.drop_percent,
+                            after.sample_percent, after.drop_percent);
+                apply_tuning(after);
+            }
+            lock.lock();
+        } while (!tuner_cv_.wait_for(lock, interval, [this] { return tuner_stop_; }));
+    });
+}
+
+void Engine::stop_auto_tuner() {
+    if (tuner_thread_.joinable()) {
+        {
+            std::lock_guard lock(tuner_mutex_);
+            tuner_stop_ = true;
+        }
+        tuner_cv_.notify_all();
+        tuner_thread_.join();
+    }
+    // Tuned values are for the session that produced them
+    shed_.set_thresholds(config_.shedding.sample_percent, config_.shedding.drop_percent);
+    std::lock_guard lock(tuning_mutex_);
+    tuning_.sample_percent = shed_.sample_percent();
+    tuning_.drop_percent = shed_.drop_percent();
+}
+
+}  // namespace exeray
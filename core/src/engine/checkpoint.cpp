@@ -0,0 +1,350 @@
+/// @file engine/checkpoint.cpp
+/// @brief Checkpoint encoding and the Engine's checkpoint save and restore.
+
+#include "exeray/checkpoint.hpp"
+#include "exeray/engine.hpp"
+#include "exeray/etw/memory_regions.hpp"
+#include "exeray/etw/module_map.hpp"
+#include "exeray/logging.hpp"
+#include "exeray/platform/mapped_file.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+namespace exeray {
+
+namespace {
+
+constexpr std::size_t kHeaderSize = 32;
+constexpr std::size_t kCountsSize = 40;  ///< Body fields before the records
+constexpr std::size_t kLifeSize = 24;
+constexpr std::size_t kRiskSize = 32;
+constexpr std::size_t kRegionSize = 40;
+constexpr std::size_t kModuleSize = 24;  ///< Without the path
+
+std::size_t padded(std::size_t size) {
+    return (size + 7) & ~std::size_t{7};
+}
+
+std::uint64_t fnv1a(std::span<const std::uint8_t> bytes) {
+    std::uint64_t hash = 0xCBF29CE484222325ULL;
+    for (const std::uint8_t byte : bytes) {
+        hash = (hash ^ byte) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+template <typename T>
+void put(std::vector<std::uint8_t>& out, std::size_t offset, const T& value) {
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+T get(std::span<const std::uint8_t> bytes, std::size_t offset) {
+    T value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    return value;
+}
+
+std::uint64_t now_ns() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+void put_risk(std::vector<std::uint8_t>& out, std::size_t& offset,
+              const std::vector<event::RiskScore>& scores) {
+    for (const event::RiskScore& score : scores) {
+        put(out, offset, score.key);
+        put(out, offset + 8, score.events);
+        put(out, offset + 16, score.last);
+        put(out, offset + 24, score.score);
+        offset += kRiskSize;
+    }
+}
+
+void get_risk(std::span<const std::uint8_t> bytes, std::size_t& offset, std::uint32_t count,
+              std::vector<event::RiskScore>& scores) {
+    scores.resize(count);
+    for (event::RiskScore& score : scores) {
+        score.key = get<std::uint32_t>(bytes, offset);
+        score.events = get<std::uint64_t>(bytes, offset + 8);
+        score.last = get<event::Timestamp>(bytes, offset + 16);
+        score.score = get<double>(bytes, offset + 24);
+        offset += kRiskSize;
+    }
+}
+
+}  // namespace
+
+std::vector<std::uint8_t> encode_checkpoint(const Checkpoint& checkpoint) {
+    const event::CorrelatorState& correlator = checkpoint.correlator;
+    std::size_t total = kHeaderSize + kCountsSize + correlator.lives.size() * kLifeSize +
+                        (correlator.process_risk.size() + correlator.chain_risk.size()) *
+                            kRiskSize +
+                        checkpoint.regions.size() * kRegionSize;
+    for (const CheckpointModule& module : checkpoint.modules) {
+        total += kModuleSize + padded(module.path.size());
+    }
+
+    std::vector<std::uint8_t> out(total, 0);
+    std::size_t offset = kHeaderSize;
+    put(out, offset, correlator.next_correlation);
+    put(out, offset + 8, correlator.risk_time);
+    put(out, offset + 16, static_cast<std::uint32_t>(correlator.lives.size()));
+    put(out, offset + 20, static_cast<std::uint32_t>(correlator.process_risk.size()));
+    put(out, offset + 24, static_cast<std::uint32_t>(correlator.chain_risk.size()));
+    put(out, offset + 28, static_cast<std::uint32_t>(checkpoint.regions.size()));
+    put(out, offset + 32, static_cast<std::uint32_t>(checkpoint.modules.size()));
+    offset += kCountsSize;
+
+    for (const event::ProcessLife& life : correlator.lives) {
+        put(out, offset, life.pid);
+        put(out, offset + 4, life.correlation_id);
+        put(out, offset + 8, life.start);
+        put(out, offset + 16, life.stop);
+        offset += kLifeSize;
+    }
+    put_risk(out, offset, correlator.process_risk);
+    put_risk(out, offset, correlator.chain_risk);
+    for (const auto& [pid, region] : checkpoint.regions) {
+        put(out, offset, pid);
+        put(out, offset + 4, region.allocator_pid);
+        put(out, offset + 8, region.base);
+        put(out, offset + 16, region.size);
+        put(out, offset + 24, region.allocated);
+        put(out, offset + 32, region.flags);
+        offset += kRegionSize;
+    }
+    for (const CheckpointModule& module : checkpoint.modules) {
+        put(out, offset, module.pid);
+        put(out, offset + 4, static_cast<std::uint32_t>(module.path.size()));
+        put(out, offset + 8, module.base);
+        put(out, offset + 16, module.size);
+        offset += kModuleSize;
+        if (!module.path.empty()) {
+            std::memcpy(out.data() + offset, module.path.data(), module.path.size());
+        }
+        offset += padded(module.path.size());
+    }
+
+    put(out, 0, kCheckpointMagic);
+    put(out, 4, kCheckpointFormat);
+    put(out, 8, checkpoint.written);
+    put(out, 16, checkpoint.strings);
+    put(out, 24, fnv1a(std::span(out).subspan(kHeaderSize)));
+    return out;
+}
+
+std::optional<Checkpoint> decode_checkpoint(std::span<const std::uint8_t> bytes) {
+    if (bytes.size() < kHeaderSize + kCountsSize ||
+        get<std::uint32_t>(bytes, 0) != kCheckpointMagic ||
+        get<std::uint32_t>(bytes, 4) != kCheckpointFormat ||
+        get<std::uint64_t>(bytes, 24) != fnv1a(bytes.subspan(kHeaderSize))) {
+        return std::nullopt;
+    }
+
+    Checkpoint checkpoint;
+    checkpoint.written = get<std::uint64_t>(bytes, 8);
+    checkpoint.strings = get<std::uint64_t>(bytes, 16);
+    event::CorrelatorState& correlator = checkpoint.correlator;
+    std::size_t offset = kHeaderSize;
+    correlator.next_correlation = get<std::uint32_t>(bytes, offset);
+    correlator.risk_time = get<event::Timestamp>(bytes, offset + 8);
+    const auto lives = get<std::uint32_t>(bytes, offset + 16);
+    const auto process_risk = get<std::uint32_t>(bytes, offset + 20);
+    const auto chain_risk = get<std::uint32_t>(bytes, offset + 24);
+    const auto regions = get<std::uint32_t>(bytes, offset + 28);
+    const auto modules = get<std::uint32_t>(bytes, offset + 32);
+    offset += kCountsSize;
+
+    // Fixed-size records first: checked in one go, before anything is allocated
+    const std::size_t fixed = std::size_t{lives} * kLifeSize +
+                              (std::size_t{process_risk} + chain_risk) * kRiskSize +
+                              std::size_t{regions} * kRegionSize;
+    if (bytes.size() - offset < fixed) {
+        return std::nullopt;
+    }
+    correlator.lives.resize(lives);
+    for (event::ProcessLife& life : correlator.lives) {
+        life.pid = get<std::uint32_t>(bytes, offset);
+        life.correlation_id = get<std::uint32_t>(bytes, offset + 4);
+        life.start = get<event::Timestamp>(bytes, offset + 8);
+        life.stop = get<event::Timestamp>(bytes, offset + 16);
+        offset += kLifeSize;
+    }
+    get_risk(bytes, offset, process_risk, correlator.process_risk);
+    get_risk(bytes, offset, chain_risk, correlator.chain_risk);
+    checkpoint.regions.resize(regions);
+    for (auto& [pid, region] : checkpoint.regions) {
+        pid = get<std::uint32_t>(bytes, offset);
+        region.allocator_pid = get<std::uint32_t>(bytes, offset + 4);
+        region.base = get<std::uint64_t>(bytes, offset + 8);
+        region.size = get<std::uint64_t>(bytes, offset + 16);
+        region.allocated = get<std::uint64_t>(bytes, offset + 24);
+        region.flags = get<std::uint8_t>(bytes, offset + 32);
+        offset += kRegionSize;
+    }
+
+    for (std::uint32_t i = 0; i < modules; ++i) {
+        if (bytes.size() - offset < kModuleSize) {
+            return std::nullopt;
+        }
+        CheckpointModule module;
+        module.pid = get<std::uint32_t>(bytes, offset);
+        const auto length = get<std::uint32_t>(bytes, offset + 4);
+        module.base = get<std::uint64_t>(bytes, offset + 8);
+        module.size = get<std::uint64_t>(bytes, offset + 16);
+        offset += kModuleSize;
+        if (length > kMaxCheckpointPath || bytes.size() - offset < padded(length)) {
+            return std::nullopt;
+        }
+        module.path.assign(reinterpret_cast<const char*>(bytes.data() + offset), length);
+        offset += padded(length);
+        checkpoint.modules.push_back(std::move(module));
+    }
+    if (offset != bytes.size()) {
+        return std::nullopt;  // Trailing data: not what we wrote
+    }
+    return checkpoint;
+}
+
+bool write_checkpoint_file(const std::filesystem::path& path, const Checkpoint& checkpoint) {
+    const std::vector<std::uint8_t> bytes = encode_checkpoint(checkpoint);
+    std::filesystem::path temp = path;
+    temp += ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(bytes.data()),
+                   static_cast<std::streamsize>(bytes.size()));
+        file.flush();
+        if (!file) {
+            file.close();
+            std::error_code ignored;
+            std::filesystem::remove(temp, ignored);
+            return false;
+        }
+    }
+    // Readers see either the old file or the complete new one
+    std::error_code error;
+    std::filesystem::rename(temp, path, error);
+    if (error) {
+        std::filesystem::remove(temp, error);
+        return false;
+    }
+    return true;
+}
+
+std::optional<Checkpoint> read_checkpoint_file(const std::filesystem::path& path) {
+    platform::MappedFile file;
+    if (!file.open(path)) {
+        return std::nullopt;
+    }
+    file.advise_sequential();
+    return decode_checkpoint(file.bytes());
+}
+
+// =============================================================================
+// Engine
+// =============================================================================
+
+std::unique_ptr<Checkpoint> Engine::load_checkpoint(const EngineConfig& config) {
+    if (config.checkpoint_file.empty()) {
+        return nullptr;
+    }
+    std::optional<Checkpoint> checkpoint = read_checkpoint_file(config.checkpoint_file);
+    if (!checkpoint) {
+        return nullptr;
+    }
+    // PIDs freed while the agent was down may belong to other processes by now
+    const std::uint64_t now = now_ns();
+    if (checkpoint->written > now ||
+        now - checkpoint->written > std::uint64_t{config.checkpoint_max_age_s} * 1'000'000'000) {
+        EXERAY_DEBUG("Engine: Ignored a checkpoint written {} s ago",
+                     (now - checkpoint->written) / 1'000'000'000);
+        return nullptr;
+    }
+    return std::make_unique<Checkpoint>(std::move(*checkpoint));
+}
+
+bool Engine::save_checkpoint() const {
+    if (config_.checkpoint_file.empty()) {
+        return false;
+    }
+    Checkpoint checkpoint;
+    checkpoint.written = now_ns();
+    checkpoint.strings = strings_.count();
+    checkpoint.correlator = correlator_.state();
+    if (checkpoint_) {
+        checkpoint.regions = checkpoint_->regions;
+        checkpoint.modules = checkpoint_->modules;
+    } else {
+        checkpoint.regions = etw::memory_regions().regions();
+        for (const auto& [pid, module] : etw::module_map().all()) {
+            checkpoint.modules.push_back(
+                {pid, module.base, module.size, std::string(strings_.get(module.path))});
+        }
+    }
+    if (!write_checkpoint_file(config_.checkpoint_file, checkpoint)) {
+        EXERAY_WARN("Engine: Failed to write checkpoint");
+        return false;
+    }
+    return true;
+}
+
+void Engine::restore_trackers() {
+    if (!checkpoint_) {
+        return;
+    }
+    for (const auto& [pid, region] : checkpoint_->regions) {
+        etw::memory_regions().restore(pid, region);
+    }
+    for (const CheckpointModule& module : checkpoint_->modules) {
+        etw::module_map().stage(module.pid, module.base, module.size,
+                                strings_.intern_path(module.path));
+    }
+    etw::module_map().flush_staged();
+    EXERAY_DEBUG("Engine: Restored {} memory regions and {} modules",
+                 checkpoint_->regions.size(), checkpoint_->modules.size());
+    checkpoint_.reset();
+}
+
+void Engine::start_checkpoints() {
+    if (config_.checkpoint_file.empty() || config_.checkpoint_interval_ms == 0 ||
+        checkpoint_thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard lock(checkpoint_mutex_);
+        checkpoint_stop_ = false;
+    }
+    checkpoint_thread_ = std::thread([this] {
+        const auto interval = std::chrono::milliseconds(config_.checkpoint_interval_ms);
+        std::unique_lock lock(checkpoint_mutex_);
+        while (!checkpoint_cv_.wait_for(lock, interval, [this] { return checkpoint_stop_; })) {
+            lock.unlock();
+            save_checkpoint();
+            lock.lock();
+        }
+    });
+}
+
+void Engine::stop_checkpoints() {
+    if (checkpoint_thread_.joinable()) {
+        {
+            std::lock_guard lock(checkpoint_mutex_);
+            checkpoint_stop_ = true;
+        }
+        checkpoint_cv_.notify_all();
+        checkpoint_thread_.join();
+    }
+    if (!config_.checkpoint_file.empty()) {
+        save_checkpoint();
+    }
+}
+
+}  // namespace exeray
@@ -1,23 +1,219 @@
 /// @file engine/constructor.cpp
-/// @brief Engine constructor and destructor implementation.
+/// @brief Engine constructor, destructor and session recycling.
 
 #include "exeray/engine.hpp"
+#include "exeray/checkpoint.hpp"
+#include "exeray/etw/tdh/parser.hpp"
 #include "exeray/logging.hpp"
 
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace exeray {
 
+namespace {
+
+/// @brief Resolve the event and byte budgets into a graph capacity.
+std::size_t graph_capacity(const EngineConfig& config) {
+    if (config.max_event_bytes == 0) {
+        return config.max_events;
+    }
+    return (std::min)(config.max_events,
+                      config.max_event_bytes / sizeof(event::EventNode));
+}
+
+/// Most strings a checkpoint presizes the pool's index for.
+constexpr std::size_t kMaxPresizedStrings = std::size_t{1} << 22;
+
+/// @brief Initial index size of the pool: the last run's high-water mark.
+std::size_t string_capacity(const Checkpoint* checkpoint) {
+    constexpr std::size_t kDefault = 4096;
+    if (checkpoint == nullptr) {
+        return kDefault;
+    }
+    return std::clamp(static_cast<std::size_t>(checkpoint->strings), kDefault,
+                      kMaxPresizedStrings);
+}
+
+/// @brief Apply the storage options of config to a freshly built graph.
+void configure_graph(event::EventGraph& graph, const EngineConfig& config,
+                     event::AlertQueue& alerts, event::RetainedEvents& retained, Arena& spill) {
+    graph.set_columnar(config.columnar_segments);
+    if (!graph.set_compression(config.compression)) {
+        EXERAY_WARN("Engine: Segment compression needs append retention, disabled");
+    }
+    if (config.spill_arena.size > 0 &&
+        !graph.set_spill(&spill, config.spill_hot_segments)) {
+        EXERAY_WARN("Engine: Segment spilling needs append retention and no compression, "
+                    "disabled");
+    }
+    graph.set_timeline(config.timeline_seconds);
+    graph.set_sketches(config.sketch_top);
+    graph.set_alerts(config.alert_capacity > 0 ? &alerts : nullptr);
+    if (config.retained.enabled && !graph.set_retained(&retained)) {
+        EXERAY_WARN("Engine: Long-term retention needs ring retention, disabled");
+    }
+    if (config.indexed_strings.empty()) {
+        return;
+    }
+    std::vector<std::string> unknown;
+    const auto fields = event::find_string_fields(config.indexed_strings, &unknown);
+    for (const std::string& name : unknown) {
+        EXERAY_WARN("Engine: Unknown indexed string field '{}'", name);
+    }
+    graph.set_string_index(fields);
+}
+
+}  // namespace
+
 Engine::Engine(EngineConfig config)
-    : arena_(config.arena_size),
-      strings_(arena_),
-      graph_(arena_, strings_),
+    : checkpoint_(load_checkpoint(config)),
+      restored_(checkpoint_ != nullptr),
+      arena_(config.arena_size, config.arena_options),
+      string_arena_(config.string_arena.size, config.string_arena.options),
+      scratch_arena_(config.scratch_arena.size, config.scratch_arena.options),
+      spill_arena_(config.spill_arena.size, config.spill_arena.options),
+      strings_(config.string_arena.size > 0 ? string_arena_ : arena_,
+               string_capacity(checkpoint_.get()), config.string_storage),
+      extensions_(config.string_arena.size > 0 ? string_arena_ : arena_),
+      alerts_(config.alert_capacity),
+      retained_(config.retained),
+      graph_(arena_, strings_, graph_capacity(config), config.retention),
       correlator_(),
-      pool_(config.num_threads),
+      pool_(config.num_threads, config.pool_placement),
+      domains_(config.domains),
+      flows_(config.flows),
+      jit_(config.jit),
+      logons_(config.logons),
+      wmi_(config.wmi),
+      rates_(config.rates),
+      profiles_(config.profiles),
+      shed_(config.shedding),
+      sampler_(config.sampling),
+      rules_(config.detection),
+      iocs_(config.ioc),
+      latency_(std::make_unique<etw::IngestLatency>()),
+      detection_(graph_),
+      images_(config.images),
+      scanner_(config.content_scan),
+      captures_(config.memory_capture),
+      stacks_(extensions_),
+      symbolizer_(etw::module_map(), strings_),
       config_(std::move(config)) {
-    // Initialize consumer context with graph, correlator, and target_pid
-    consumer_ctx_.graph = &graph_;
-    consumer_ctx_.target_pid = &target_pid_;
-    consumer_ctx_.strings = &strings_;
-    consumer_ctx_.correlator = &correlator_;
+    configure_graph(graph_, config_, alerts_, retained_, spill_arena_);
+    for (const etw::ManifestProviderConfig& provider : config_.manifest_providers) {
+        register_provider(provider);
+    }
+    if (config_.profiles.enabled && !config_.profile_file.empty() &&
+        !profiles_.load(config_.profile_file)) {
+        EXERAY_DEBUG("Engine: No behavior profiles loaded, learning from scratch");
+    }
+    if (config_.images.enabled && !config_.image_cache_file.empty() &&
+        !images_.load(config_.image_cache_file)) {
+        EXERAY_DEBUG("Engine: No image verdict cache loaded");
+    }
+    if (config_.string_search) {
+        trigrams_ = std::make_unique<event::TrigramIndex>();
+        strings_.set_trigram_index(trigrams_.get());
+    }
+    if (config_.sampling.enabled && config_.sampling.promote_score > 0.0) {
+        correlator_.on_process_risk(config_.sampling.promote_score,
+                                    [this](std::uint32_t pid) { sampler_.promote(pid); });
+    }
+    tuning_.sample_percent = shed_.sample_percent();
+    tuning_.drop_percent = shed_.drop_percent();
+    register_metrics();
+    if (config_.profile_interval_us > 0) {
+        profiler_.start(std::chrono::microseconds(config_.profile_interval_us));
+    }
+    etw::ParseMetrics::global().set_enabled(config_.parse_metrics);
+    if (config_.normalize_device_paths) {
+        device_paths_.refresh();
+        strings_.set_device_paths(&device_paths_);
+    }
+    if (!config_.tdh_schema_file.empty()) {
+        const std::size_t loaded = etw::global_tdh_cache().load(config_.tdh_schema_file);
+        EXERAY_DEBUG("Engine: Loaded {} TDH schemas", loaded);
+    }
+    if (checkpoint_) {
+        correlator_.restore(checkpoint_->correlator);
+        EXERAY_DEBUG("Engine: Restored {} process incarnations",
+                     checkpoint_->correlator.lives.size());
+    }
+}
+
+EngineDiagnostics Engine::diagnostics() const {
+    EngineDiagnostics diag;
+    diag.arena_backend = arena_.backend();
+    diag.arena_numa_node = arena_.numa_node();
+    diag.arena_capacity = arena_.capacity();
+    diag.arena_committed = arena_.committed();
+    diag.arena_used = arena_.used();
+    diag.etw_buffers = etw_buffers_;
+    diag.etw_sessions = shards_.size();
+    return diag;
+}
+
+MemoryStats Engine::memory_stats() const {
+    MemoryStats stats;
+    stats.events = arena_.stats();
+    stats.strings = string_storage().stats();
+    stats.scratch = scratch_arena_.stats();
+    stats.strings_shared = &string_storage() == &arena_;
+    stats.event_bytes = graph_.storage_bytes();
+    stats.string_bytes = strings_.bytes_used();
+    stats.string_count = strings_.count();
+    stats.event_count = graph_.count();
+    stats.event_capacity = graph_.capacity();
+    stats.unlinked_events = graph_.unlinked_count();
+    stats.compression = graph_.compression_stats();
+    stats.spill = spill_arena_.stats();
+    stats.spilled_segments = graph_.spilled_count();
+    stats.retained = retained_.stats();
+    return stats;
+}
+
+bool Engine::reset_session() {
+    if (monitoring_.load(std::memory_order_acquire)) {
+        EXERAY_WARN("Engine: Cannot reset session while monitoring");
+        return false;
+    }
+    close_standby();  // Its consumers hold the graph
+
+    // Tear down in reverse dependency order before rewinding the arenas;
+    // the graph references the pool, both reference arena memory
+    std::destroy_at(&correlator_);
+    std::destroy_at(&graph_);
+    std::destroy_at(&retained_);
+    std::destroy_at(&extensions_);
+    std::destroy_at(&strings_);
+    arena_.reset();
+    string_arena_.reset();
+    scratch_arena_.reset();
+    spill_arena_.reset();
+
+    std::construct_at(&strings_, string_storage(), string_capacity(nullptr),
+                      config_.string_storage);
+    if (config_.normalize_device_paths) {
+        strings_.set_device_paths(&device_paths_);
+    }
+    if (trigrams_ != nullptr) {
+        trigrams_ = std::make_unique<event::TrigramIndex>();
+        strings_.set_trigram_index(trigrams_.get());
+    }
+    std::construct_at(&extensions_, string_storage());
+    stacks_.clear();
+    symbolizer_.clear();
+    std::construct_at(&retained_, config_.retained);
+    std::construct_at(&graph_, arena_, strings_, graph_capacity(config_), config_.retention);
+    std::construct_at(&correlator_);
+    configure_graph(graph_, config_, alerts_, retained_, spill_arena_);
+
+    session_.fetch_add(1, std::memory_order_acq_rel);
+    EXERAY_DEBUG("Engine: Session {} recycled", session());
+    return true;
 }
 
 Engine::~Engine() {
@@ -25,6 +221,11 @@ Engine::~Engine() {
     if (monitoring_.load(std::memory_order_acquire)) {
         stop_monitoring();
     }
+    close_standby();
+    if (!config_.tdh_schema_file.empty() &&
+        !etw::global_tdh_cache().save(config_.tdh_schema_file)) {
+        EXERAY_WARN("Engine: Failed to save TDH schemas");
+    }
 }
 
 }  // namespace exeray
@@ -1,30 +1,67 @@
 /// @file engine/control.cpp
-/// @brief Process control: freeze, unfreeze, kill, target_pid.
+/// @brief Process control: freeze, unfreeze, kill, job usage, target PIDs.
 
 #include "exeray/engine.hpp"
 
+#include <algorithm>
+
 namespace exeray {
 
 void Engine::freeze_target() {
-    if (target_ && target_->is_running()) {
-        target_->suspend();
+    std::lock_guard lock(targets_mutex_);
+    for (const auto& target : targets_) {
+        if (target->is_running()) {
+            target->suspend();
+        }
     }
 }
 
 void Engine::unfreeze_target() {
-    if (target_ && target_->is_running()) {
-        target_->resume();
+    std::lock_guard lock(targets_mutex_);
+    for (const auto& target : targets_) {
+        if (target->is_running()) {
+            target->resume();
+        }
     }
 }
 
 void Engine::kill_target() {
-    if (target_) {
-        target_->terminate();
+    std::lock_guard lock(targets_mutex_);
+    for (const auto& target : targets_) {
+        target->terminate();
+    }
+}
+
+process::JobAccounting Engine::target_usage() const {
+    process::JobAccounting total;
+    std::lock_guard lock(targets_mutex_);
+    for (const auto& target : targets_) {
+        process::JobAccounting job;
+        if (!target->query_accounting(job)) {
+            continue;
+        }
+        total.user_time_ns += job.user_time_ns;
+        total.kernel_time_ns += job.kernel_time_ns;
+        total.read_bytes += job.read_bytes;
+        total.write_bytes += job.write_bytes;
+        total.other_bytes += job.other_bytes;
+        total.read_ops += job.read_ops;
+        total.write_ops += job.write_ops;
+        total.peak_process_memory = (std::max)(total.peak_process_memory,
+                                               job.peak_process_memory);
+        total.peak_job_memory = (std::max)(total.peak_job_memory, job.peak_job_memory);
+        total.active_processes += job.active_processes;
+        total.total_processes += job.total_processes;
     }
+    return total;
 }
 
 uint32_t Engine::target_pid() const noexcept {
     return target_pid_.load(std::memory_order_acquire);
 }
 
+std::vector<uint32_t> Engine::target_pids() const {
+    return target_set_.pids();
+}
+
 }  // namespace exeray
@@ -1,7 +1,8 @@
 /// @file engine/correlation.cpp
-/// @brief Event correlation API: get_process_tree, get_event_chain.
+/// @brief Event correlation API: get_process_tree, get_event_chain, risk scores.
 
 #include "exeray/engine.hpp"
+#include "exeray/event/query.hpp"
 
 namespace exeray {
 
@@ -9,26 +10,18 @@ std::vector<event::EventView> Engine::get_process_tree(uint32_t pid) {
     std::vector<event::EventView> result;
 
     // Find the process's most recent ProcessCreate event
-    event::EventId current_id = correlator_.find_thread_parent(pid);
-    if (current_id == event::INVALID_EVENT) {
+    const event::EventId create = correlator_.find_thread_parent(pid);
+    if (create == event::INVALID_EVENT || !graph_.exists(create)) {
         return result;
     }
+    result.push_back(graph_.get(create));
 
-    // Walk up the parent chain, collecting process events
-    constexpr std::size_t max_depth = 100;  // Prevent infinite loops
-    std::size_t depth = 0;
-
-    while (current_id != event::INVALID_EVENT && depth < max_depth) {
-        if (!graph_.exists(current_id)) {
+    // Ancestors come from the materialized tree, not a walk over events
+    for (const event::ProcessTreeNode& node : correlator_.process_tree().ancestors(create)) {
+        if (!graph_.exists(node.create)) {
             break;
         }
-
-        auto view = graph_.get(current_id);
-        result.push_back(view);
-
-        // Move to parent
-        current_id = view.parent_id();
-        ++depth;
+        result.push_back(graph_.get(node.create));
     }
 
     return result;
@@ -41,11 +34,22 @@ std::vector<event::EventView> Engine::get_event_chain(uint32_t correlation_id) {
         return result;
     }
 
-    // Collect all events with matching correlation ID
-    graph_.for_each_correlation(correlation_id, [&result](event::EventView view) {
-        result.push_back(view);
-    });
+    // Collect all events with matching correlation ID (chain order, newest first)
+    event::for_each_match(graph_, event::Query{}.correlation(correlation_id).newest_first(),
+                          [&result](event::EventView view) { result.push_back(view); });
+
+    return result;
+}
+
+std::vector<event::RiskScore> Engine::riskiest_processes(std::size_t k) const {
+    std::vector<event::RiskScore> result(k);
+    result.resize(correlator_.top_processes(result));
+    return result;
+}
 
+std::vector<event::RiskScore> Engine::riskiest_chains(std::size_t k) const {
+    std::vector<event::RiskScore> result(k);
+    result.resize(correlator_.top_chains(result));
     return result;
 }
 
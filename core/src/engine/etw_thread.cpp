@@ -18,12 +18,16 @@ void Engine::process() {
     flags_.store(StatusFlags::COMPLETE | StatusFlags::READY, std::memory_order_release);
 }
 
-void Engine::etw_thread_func() {
+void Engine::etw_thread_func(EtwShard* shard) {
 #ifdef _WIN32
-    if (etw_session_) {
+    if (shard->session) {
+        const platform::ScopedPlacement placement(config_.etw_threads);
+        const ProfiledThread role("consumer");
         // ProcessTrace blocks until session is stopped
-        etw::start_trace_processing(etw_session_->trace_handle());
+        etw::start_trace_processing(shard->session->trace_handle());
     }
+#else
+    (void)shard;
 #endif
 }
 
@@ -0,0 +1,409 @@
+/// @file engine/metrics.cpp
+/// @brief The Engine's entries in its MetricsRegistry.
+
+#include "exeray/engine.hpp"
+#include "exeray/event/payload_fields.hpp"
+
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace exeray {
+
+namespace {
+
+/// @brief Appends samples of one collector.
+class Samples {
+public:
+    explicit Samples(std::vector<MetricSample>& out) noexcept : out_(out) {}
+
+    void counter(const char* name, const char* help, std::uint64_t value,
+                 std::string labels = {}) {
+        add(name, help, MetricType::Counter, static_cast<double>(value), std::move(labels));
+    }
+
+    /// @brief Counter of a fractional quantity (seconds).
+    void total(const char* name, const char* help, double value, std::string labels = {}) {
+        add(name, help, MetricType::Counter, value, std::move(labels));
+    }
+
+    void gauge(const char* name, const char* help, double value, std::string labels = {}) {
+        add(name, help, MetricType::Gauge, value, std::move(labels));
+    }
+
+private:
+    void add(const char* name, const char* help, MetricType type, double value,
+             std::string labels) {
+        MetricSample& sample = out_.emplace_back();
+        sample.name = name;
+        sample.help = help;
+        sample.labels = std::move(labels);
+        sample.type = type;
+        sample.value = value;
+    }
+
+    std::vector<MetricSample>& out_;
+};
+
+std::string category_label(std::size_t category) {
+    return metric_label("category", event::category_name(static_cast<event::Category>(category)));
+}
+
+void arena_samples(Samples& samples, const char* arena, const ArenaStats& stats) {
+    const std::string label = metric_label("arena", arena);
+    samples.gauge("exeray_arena_used_bytes", "Bytes handed out by the arena",
+                  static_cast<double>(stats.used), label);
+    samples.gauge("exeray_arena_committed_bytes", "Arena bytes backed by memory",
+                  static_cast<double>(stats.committed), label);
+    samples.gauge("exeray_arena_capacity_bytes", "Bytes the arena can hand out",
+                  static_cast<double>(stats.capacity), label);
+    samples.counter("exeray_arena_failures_total", "Arena allocations refused", stats.failures,
+                    label);
+}
+
+/// @brief Label text of a heavy-hitter key: the string, address or pid.
+std::string sketch_key(event::SketchKind kind, std::uint64_t key,
+                       const event::StringPool& strings) {
+    std::string buffer;
+    if (kind == event::SketchKind::Processes) {
+        return std::to_string(key);
+    }
+    if (kind == event::SketchKind::RemoteAddresses && (key >> 32) == 0) {
+        std::uint8_t bytes[4];
+        const auto address = static_cast<std::uint32_t>(key);
+        std::memcpy(bytes, &address, sizeof(bytes));
+        for (std::size_t i = 0; i < 4; ++i) {
+            if (i != 0) {
+                buffer += '.';
+            }
+            buffer += std::to_string(bytes[i]);
+        }
+        return buffer;
+    }
+    return std::string(strings.read(static_cast<event::StringId>(key), buffer));
+}
+
+}  // namespace
+
+void Engine::register_metrics() {
+    consumer_metrics_.registry = &metrics_;
+    consumer_metrics_.batches =
+        metrics_.counter("exeray_batches_total", "Event batches pushed by the consumers");
+    consumer_metrics_.batch_events =
+        metrics_.histogram("exeray_batch_events", "Events per pushed batch");
+    consumer_metrics_.batch_cycles = metrics_.histogram(
+        "exeray_batch_cycles", "Cycles to correlate and store one batch (TSC on x86)");
+    consumer_metrics_.dns_latency = metrics_.histogram(
+        "exeray_dns_resolution_us", "Microseconds from a DNS query to its response");
+    consumer_metrics_.dropped = metrics_.counter(
+        "exeray_pushes_dropped_total", "Events the graph refused (capacity or arena exhausted)");
+
+    // Graph and session counters, as the dashboard shows them
+    metrics_.add_collector([this](std::vector<MetricSample>& out) {
+        Samples samples(out);
+        const event::CounterSnapshot cells = graph_.counters().snapshot();
+        for (std::size_t c = 0; c < cells.pushed.size(); ++c) {
+            samples.counter("exeray_events_pushed_total", "Events stored", cells.pushed[c],
+                            category_label(c));
+        }
+        for (std::size_t c = 0; c < cells.pushed.size(); ++c) {
+            samples.gauge("exeray_events_live", "Events held by the graph",
+                          static_cast<double>(cells.category(static_cast<event::Category>(c))),
+                          category_label(c));
+        }
+        samples.counter("exeray_events_flagged_total", "Events marked suspicious", cells.flagged);
+        const event::AlertStats alerts = alerts_.stats();
+        samples.counter("exeray_alerts_total", "Suspicious events queued as alerts",
+                        alerts.pushed);
+        samples.counter("exeray_alerts_dropped_total", "Alerts lost to a full alert queue",
+                        alerts.dropped);
+        samples.gauge("exeray_monitoring", "1 while a monitoring session runs",
+                      is_monitoring() ? 1.0 : 0.0);
+        samples.total("exeray_process_cpu_seconds_total", "CPU time used by the process",
+                      platform::process_cpu_seconds());
+        const TuningState tuned = tuning();
+        samples.gauge("exeray_tuned_batch_events", "Pending events that trigger a push",
+                      tuned.batch);
+        samples.gauge("exeray_tuned_detection_workers", "Detection workers allowed",
+                      static_cast<double>(tuned.workers));
+        samples.gauge("exeray_tuned_shed_percent", "Pressure at which shedding starts",
+                      tuned.sample_percent, metric_label("level", "sample"));
+        samples.gauge("exeray_tuned_shed_percent", "Pressure at which shedding starts",
+                      tuned.drop_percent, metric_label("level", "drop"));
+
+        const etw::SessionStats session = session_stats();
+        samples.counter("exeray_etw_events_lost_total", "Events ETW could not buffer",
+                        session.events_lost);
+        samples.counter("exeray_etw_buffers_lost_total", "Real-time buffers dropped",
+                        session.buffers_lost);
+        samples.counter("exeray_etw_buffers_written_total", "Buffers filled by the sessions",
+                        session.buffers_written);
+        samples.counter("exeray_etw_buffers_read_total", "Buffers delivered to the consumers",
+                        session.buffers_read);
+        samples.gauge("exeray_etw_buffers", "Buffers allocated by the sessions", session.buffers);
+        samples.gauge("exeray_etw_free_buffers", "Buffers currently unused",
+                      session.free_buffers);
+        const StopReport stop = last_stop();
+        const std::pair<const char*, std::chrono::nanoseconds> phases[] = {
+            {"flush", stop.flush}, {"drain", stop.drain}, {"stop", stop.stop},
+            {"finish", stop.finish}, {"total", stop.total}};
+        for (const auto& [phase, elapsed] : phases) {
+            samples.gauge("exeray_stop_seconds", "Phases of the last stop_monitoring()",
+                          std::chrono::duration<double>(elapsed).count(),
+                          metric_label("phase", phase));
+        }
+        samples.gauge("exeray_stop_drained", "1 if the last stop read every ETW buffer",
+                      stop.drained ? 1.0 : 0.0);
+
+        const IngestStats ingest = ingest_stats();
+        samples.counter("exeray_ring_staged_total", "Records copied into a record ring",
+                        ingest.staged);
+        samples.counter("exeray_ring_overflows_total", "Records dropped by a full record ring",
+                        ingest.overflows);
+        samples.gauge("exeray_ring_bytes", "Record ring capacity (0 = parsed inline)",
+                      static_cast<double>(ingest.ring_bytes));
+
+        const etw::ShedStats shed = shed_stats();
+        for (std::size_t c = 0; c < shed.by_category.size(); ++c) {
+            samples.counter("exeray_shed_events_total", "Events dropped by load shedding",
+                            shed.by_category[c], category_label(c));
+        }
+        const etw::SamplingStats sampling = sampling_stats();
+        for (std::size_t c = 0; c < sampling.kept.size(); ++c) {
+            samples.counter("exeray_sampled_kept_total", "Sampled events kept by their hash",
+                            sampling.kept[c], category_label(c));
+            samples.counter("exeray_sampled_dropped_total", "Events dropped by sampling",
+                            sampling.dropped[c], category_label(c));
+        }
+        samples.counter("exeray_sampling_promoted_kept_total",
+                        "Events kept only because their process was promoted",
+                        sampling.promoted_kept);
+        samples.counter("exeray_sampling_promotions_total",
+                        "Processes promoted to keep every event", sampling.promotions);
+
+        const etw::FlowStats flows = flow_stats();
+        samples.gauge("exeray_flows_open", "Network flows open", static_cast<double>(flows.flows));
+        samples.counter("exeray_flow_transfers_absorbed_total", "Transfers folded into a flow",
+                        flows.absorbed);
+        samples.counter("exeray_flow_summaries_total", "Transfers stored as a flow summary",
+                        flows.summaries);
+        samples.counter("exeray_flow_overflowed_total", "Transfers stored as the table was full",
+                        flows.overflowed);
+
+        const etw::JitStats jit = jit_stats();
+        samples.gauge("exeray_jit_modules", "CLR modules with JIT activity tracked",
+                      static_cast<double>(jit.modules));
+        samples.counter("exeray_jit_absorbed_total", "JIT events folded into their module",
+                        jit.absorbed);
+        samples.counter("exeray_jit_summaries_total", "JIT events stored as a module summary",
+                        jit.summaries);
+        samples.counter("exeray_jit_flagged_total", "JIT events stored individually as suspicious",
+                        jit.flagged);
+
+        const etw::LogonStats logons = logon_stats();
+        samples.gauge("exeray_logon_sessions", "Logon sessions open",
+                      static_cast<double>(logons.tracked));
+        samples.counter("exeray_logon_attributed_total",
+                        "Security events given their logon session", logons.attributed);
+        samples.counter("exeray_logon_unattributed_total",
+                        "Security events whose logon session was not seen", logons.unattributed);
+        samples.counter("exeray_logon_evicted_total", "Open logon sessions evicted by new ones",
+                        logons.evicted);
+
+        const etw::WmiStats wmi = wmi_stats();
+        samples.gauge("exeray_wmi_operations", "Distinct WMI operations tracked",
+                      static_cast<double>(wmi.operations));
+        samples.counter("exeray_wmi_absorbed_total", "WMI events folded into their operation",
+                        wmi.absorbed);
+        samples.counter("exeray_wmi_summaries_total", "WMI events stored as an operation summary",
+                        wmi.summaries);
+
+        const etw::DomainMapStats domains = domain_stats();
+        samples.counter("exeray_dns_resolutions_total", "Addresses recorded from DNS responses",
+                        domains.resolutions);
+        samples.counter("exeray_network_domains_total", "Network events given a domain",
+                        domains.enriched);
+        samples.counter("exeray_network_domains_missed_total",
+                        "IPv4 network events no DNS resolution matched", domains.missed);
+        samples.gauge("exeray_dns_resolutions", "DNS resolutions held for enrichment",
+                      static_cast<double>(domains.tracked));
+
+        const etw::RateStats rates = rate_stats();
+        samples.counter("exeray_rate_anomalies_total", "Process event rates flagged as spikes",
+                        rates.anomalies);
+        samples.gauge("exeray_rate_pairs", "Process and category rates tracked",
+                      static_cast<double>(rates.tracked));
+
+        const etw::ProfileStats profiles = profile_stats();
+        samples.counter("exeray_profile_checked_total", "Events checked against a behavior profile",
+                        profiles.checked);
+        samples.counter("exeray_profile_novel_total",
+                        "Events their behavior profile had never seen", profiles.novel);
+        samples.gauge("exeray_profiles_loaded", "Behavior profiles loaded from the profile file",
+                      static_cast<double>(profiles.loaded));
+
+        const etw::ImageVerifyStats images = image_verify_stats();
+        samples.counter("exeray_images_hashed_total", "Image files hashed and verified",
+                        images.hashed);
+        samples.counter("exeray_images_cached_total", "Image verdicts taken from the cache",
+                        images.cached);
+        samples.counter("exeray_images_unreadable_total", "Image files that could not be hashed",
+                        images.unreadable);
+
+        const etw::ContentScanStats scans = content_scan_stats();
+        samples.counter("exeray_content_scanned_total", "AMSI and script contents scanned",
+                        scans.scanned);
+        samples.counter("exeray_content_matched_total", "Contents matching a signature",
+                        scans.matched);
+        samples.counter("exeray_content_skipped_total", "Contents not scanned for lack of budget",
+                        scans.skipped);
+
+        const etw::MemoryCaptureStats captures = memory_capture_stats();
+        samples.counter("exeray_memory_captured_total", "RWX thread start regions read",
+                        captures.captured);
+        samples.counter("exeray_memory_throttled_total",
+                        "RWX regions not read for lack of read budget", captures.throttled);
+        samples.gauge("exeray_memory_capture_bytes", "Bytes in the memory capture store",
+                      static_cast<double>(captures.stored));
+
+        const event::StackTableStats stacks = stack_stats();
+        samples.counter("exeray_stacks_interned_total", "Call stacks attached to events",
+                        stacks.interned);
+        samples.gauge("exeray_stacks_distinct", "Distinct call stacks stored",
+                      static_cast<double>(stacks.distinct));
+        samples.counter("exeray_stacks_orphaned_total",
+                        "Stack walk events whose event was not found", stacks.orphaned);
+    });
+
+    // Heavy hitters and distinct keys
+    metrics_.add_collector([this](std::vector<MetricSample>& out) {
+        const event::EventSketches* sketches = graph_.sketches();
+        if (sketches == nullptr) {
+            return;
+        }
+        Samples samples(out);
+        const event::SketchSnapshot snap = sketches->snapshot();
+        for (std::size_t k = 0; k < event::kSketchKinds; ++k) {
+            const auto kind = static_cast<event::SketchKind>(k);
+            const std::string label = metric_label("kind", event::sketch_kind_name(kind));
+            samples.gauge("exeray_sketch_unique", "Distinct keys pushed (HyperLogLog estimate)",
+                          snap.kinds[k].unique, label);
+            for (const event::HeavyHitter& hitter : snap.kinds[k].top) {
+                samples.gauge("exeray_sketch_top_events",
+                              "Events of a most frequent key (Count-Min estimate)",
+                              static_cast<double>(hitter.count),
+                              label + "," + metric_label("key", sketch_key(kind, hitter.key,
+                                                                            strings_)));
+            }
+        }
+    });
+
+    // Memory
+    metrics_.add_collector([this](std::vector<MetricSample>& out) {
+        Samples samples(out);
+        const MemoryStats memory = memory_stats();
+        arena_samples(samples, "events", memory.events);
+        if (!memory.strings_shared) {
+            arena_samples(samples, "strings", memory.strings);
+        }
+        arena_samples(samples, "scratch", memory.scratch);
+        if (memory.spill.capacity > 0) {
+            arena_samples(samples, "spill", memory.spill);
+            samples.gauge("exeray_spilled_segments", "Graph segments moved to the spill arena",
+                          static_cast<double>(memory.spilled_segments));
+        }
+        if (retained_.capacity() > 0) {
+            samples.gauge("exeray_retained_events", "Evicted events held for their detections",
+                          static_cast<double>(memory.retained.events));
+            samples.counter("exeray_retained_kept_total",
+                            "Evicted events copied into the long-term store",
+                            memory.retained.kept);
+            samples.counter("exeray_retained_dropped_total",
+                            "Evicted events reduced to counts", memory.retained.dropped);
+            samples.counter("exeray_retained_overwritten_total",
+                            "Kept events lost to a full long-term store",
+                            memory.retained.overwritten);
+        }
+        samples.gauge("exeray_event_bytes", "Bytes of graph nodes, links, indexes and columns",
+                      static_cast<double>(memory.event_bytes));
+        samples.gauge("exeray_string_bytes", "Bytes of interned strings",
+                      static_cast<double>(memory.string_bytes));
+        samples.gauge("exeray_strings", "Unique interned strings",
+                      static_cast<double>(memory.string_count));
+        samples.gauge("exeray_event_capacity", "Event budget of the graph",
+                      static_cast<double>(memory.event_capacity));
+        samples.counter("exeray_unlinked_events_total",
+                        "Chain links dropped on a full correlation or process head table",
+                        memory.unlinked_events);
+        const event::CompressionStats& cold = memory.compression;
+        samples.gauge("exeray_compressed_segments", "Graph segments held compressed",
+                      static_cast<double>(cold.segments));
+        samples.gauge("exeray_compressed_bytes", "Bytes of compressed graph segments",
+                      static_cast<double>(cold.packed_bytes));
+        samples.gauge("exeray_compression_ratio", "Node bytes per compressed byte",
+                      cold.ratio());
+        samples.counter("exeray_segment_decodes_total", "Compressed segments decoded on access",
+                        cold.decodes);
+        samples.total("exeray_segment_decode_seconds_total", "Time spent decoding segments",
+                      static_cast<double>(cold.decode_ns) / 1e9);
+        samples.counter("exeray_segment_cache_hits_total",
+                        "Cold reads served by a decoded segment", cold.cache_hits);
+    });
+
+    // Parsing, detection and latency
+    metrics_.add_collector([this](std::vector<MetricSample>& out) {
+        Samples samples(out);
+        const etw::ParseMetricsSnapshot parse = parse_metrics();
+        for (std::size_t p = 0; p < etw::kMetricProviders; ++p) {
+            const etw::ProviderMetrics& provider = parse.providers[p];
+            const std::string label = metric_label(
+                "provider", etw::provider_name(static_cast<etw::MetricProvider>(p)));
+            samples.counter("exeray_parse_events_total", "Records dispatched to a parser",
+                            provider.events, label);
+            samples.counter("exeray_parse_failures_total", "Records a parser rejected",
+                            provider.failures, label);
+            samples.counter("exeray_parse_cycles_total", "Cycles spent parsing",
+                            provider.cycles, label);
+        }
+
+        for (const etw::RuleStats& rule : detection_stats()) {
+            const std::string label = metric_label("rule", rule.name);
+            samples.counter("exeray_rule_matched_total", "Events matching all predicates of a rule",
+                            rule.matched, label);
+            samples.counter("exeray_rule_fired_total", "Times a rule reached its threshold",
+                            rule.fired, label);
+        }
+        for (const etw::IocStats& list : ioc_stats()) {
+            samples.counter("exeray_ioc_hits_total", "Events matching an indicator list",
+                            list.hits, metric_label("list", list.name));
+        }
+        const etw::DetectionStageStats stage = detection_stage_stats();
+        samples.counter("exeray_detection_tested_total", "Events tested off the ingest path",
+                        stage.tested);
+        samples.counter("exeray_detection_flagged_total", "Events flagged off the ingest path",
+                        stage.flagged);
+        samples.counter("exeray_detection_missed_total", "Events evicted before being tested",
+                        stage.missed);
+        samples.gauge("exeray_detection_backlog", "Stored events waiting for detection",
+                      static_cast<double>(stage.backlog));
+        samples.gauge("exeray_detection_max_backlog", "Largest backlog a worker found",
+                      static_cast<double>(stage.max_backlog));
+
+        constexpr const char* kStages[] = {"delivered", "visible", "detected"};
+        for (std::size_t s = 0; s < etw::kLatencyStages; ++s) {
+            const etw::LatencySummary summary =
+                ingest_latency(static_cast<etw::LatencyStage>(s));
+            const std::string stage_label = metric_label("stage", kStages[s]);
+            const std::pair<const char*, std::uint64_t> quantiles[] = {
+                {"0.5", summary.p50}, {"0.99", summary.p99}, {"0.999", summary.p999}};
+            for (const auto& [quantile, ns] : quantiles) {
+                samples.gauge("exeray_ingest_latency_seconds", "Age of events at a stage",
+                              static_cast<double>(ns) / 1e9,
+                              stage_label + "," + metric_label("quantile", quantile));
+            }
+        }
+    });
+}
+
+}  // namespace exeray
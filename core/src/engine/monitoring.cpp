@@ -2,13 +2,45 @@
 /// @brief Process monitoring implementation: start, stop, status.
 
 #include "exeray/engine.hpp"
+#include "exeray/etw/file_map.hpp"
+#include "exeray/etw/key_map.hpp"
+#include "exeray/etw/memory_regions.hpp"
 #include "exeray/etw/provider_mapping.hpp"
+#include "exeray/etw/provider_presets.hpp"
+#include "exeray/etw/providers/guids.hpp"
 #include "exeray/etw/session.hpp"
+#include "exeray/etw/tdh/parser.hpp"
+#include "exeray/etw/thread_map.hpp"
 #include "exeray/logging.hpp"
 #include "exeray/process/controller.hpp"
+#include "exeray/trace_spans.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <string>
+#include <thread>
 
 namespace exeray {
 
+etw::PresetSettings provider_settings(std::string_view provider, const ProviderConfig& cfg) {
+    etw::PresetSettings settings{cfg.level, cfg.keywords, cfg.event_ids, cfg.stack_event_ids};
+    if (const auto preset = etw::provider_preset(provider, cfg.preset)) {
+        settings.level = preset->level;
+        settings.keywords = preset->keywords;
+        if (cfg.event_ids.empty()) {
+            settings.event_ids = preset->event_ids;
+        }
+        if (cfg.stack_event_ids.empty()) {
+            settings.stack_event_ids = preset->stack_event_ids;
+        }
+    }
+    return settings;
+}
+
 bool Engine::start_monitoring(std::wstring_view exe_path) {
     // Don't start if already monitoring
     if (monitoring_.load(std::memory_order_acquire)) {
@@ -18,96 +50,850 @@ bool Engine::start_monitoring(std::wstring_view exe_path) {
 
 #ifdef _WIN32
     // Step 1: Launch target process in suspended mode
-    target_ = process::Controller::launch(exe_path);
-    if (!target_) {
+    auto target = process::Controller::launch(exe_path);
+    if (!target) {
         EXERAY_ERROR("Engine: Failed to launch target process");
         return false;
     }
+    target->apply(config_.target_limits);
+    if (standby_.load(std::memory_order_acquire)) {
+        resume_standby(std::move(target), {});
+    } else if (!start_session(std::move(target), {})) {
+        return false;
+    }
 
-    // Store target PID for event filtering
-    target_pid_.store(target_->pid(), std::memory_order_release);
+    // Step 6: Resume the target process to start execution
+    {
+        std::lock_guard lock(targets_mutex_);
+        targets_.front()->resume();
+    }
+    return true;
+#else
+    // ETW not available on non-Windows platforms
+    (void)exe_path;
+    EXERAY_ERROR("Engine: ETW monitoring not available on this platform");
+    return false;
+#endif
+}
 
-    // Step 2: Create ETW session with callback and context
-    etw_session_ = etw::Session::create(
-        L"ExeRayMonitor",
-        etw::event_record_callback,
-        &consumer_ctx_
-    );
-    if (!etw_session_) {
-        EXERAY_ERROR("Engine: Failed to create ETW session");
-        target_.reset();
-        target_pid_.store(0, std::memory_order_release);
+bool Engine::attach(std::uint32_t pid, bool with_tree) {
+    if (monitoring_.load(std::memory_order_acquire)) {
+        EXERAY_ERROR("Engine: Already monitoring a process");
+        return false;
+    }
+
+#ifdef _WIN32
+    auto target = process::Controller::attach(pid);
+    if (!target) {
+        EXERAY_ERROR("Engine: Failed to attach to process {}", pid);
+        return false;
+    }
+    std::vector<std::uint32_t> tree;
+    if (with_tree) {
+        tree = process::running_descendants(pid);
+    }
+    if (standby_.load(std::memory_order_acquire)) {
+        resume_standby(std::move(target), tree);
+        return true;
+    }
+    return start_session(std::move(target), tree);
+#else
+    (void)pid;
+    (void)with_tree;
+    EXERAY_ERROR("Engine: ETW monitoring not available on this platform");
+    return false;
+#endif
+}
+
+bool Engine::monitor_system() {
+    if (monitoring_.load(std::memory_order_acquire)) {
+        EXERAY_ERROR("Engine: Already monitoring a process");
+        return false;
+    }
+
+    if (config_.standby_session) {
+        EXERAY_ERROR("Engine: Standby sessions filter by target; monitor_system() needs "
+                     "standby_session off");
+        return false;
+    }
+
+#ifdef _WIN32
+    return start_session(nullptr, {});
+#else
+    EXERAY_ERROR("Engine: ETW monitoring not available on this platform");
+    return false;
+#endif
+}
+
+bool Engine::prepare_monitoring() {
+    if (!config_.standby_session || monitoring_.load(std::memory_order_acquire)) {
+        EXERAY_ERROR("Engine: prepare_monitoring() needs standby_session and no running "
+                     "session");
         return false;
     }
+    if (standby_.load(std::memory_order_acquire)) {
+        return true;
+    }
 
-    // Step 3: Enable providers based on configuration
+#ifdef _WIN32
+    // An empty target set keeps nothing; stopping leaves the sessions up
+    if (!start_session(nullptr, {})) {
+        return false;
+    }
+    stop_monitoring();
+    return standby_.load(std::memory_order_acquire);
+#else
+    EXERAY_ERROR("Engine: ETW monitoring not available on this platform");
+    return false;
+#endif
+}
+
+void Engine::close_standby() {
+    if (!standby_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+#ifdef _WIN32
+    StopReport report;
+    close_sessions(false, report);
+#endif
+    EXERAY_DEBUG("Engine: Closed the standby sessions");
+}
+
+#ifdef _WIN32
+void Engine::resume_standby(std::unique_ptr<process::Controller> target,
+                            const std::vector<std::uint32_t>& descendants) {
+    // Providers, consumers and schemas are live: once the PIDs are in the
+    // set, the callbacks keep the target's events. A launched target is
+    // still suspended, so none of them is missed.
+    standby_.store(false, std::memory_order_release);
+    monitoring_.store(true, std::memory_order_release);
+    ingesting_.store(true, std::memory_order_seq_cst);
+    target_set_.insert(target->pid());
+    for (const std::uint32_t pid : descendants) {
+        target_set_.insert(pid);
+    }
+    target_pid_.store(target->pid(), std::memory_order_release);
+    const bool attached = !target->launched();
     {
-        std::lock_guard lock(providers_mutex_);
-        for (const auto& [name, cfg] : config_.providers) {
-            if (!cfg.enabled) {
-                EXERAY_DEBUG("Provider {} is disabled, skipping", name);
-                continue;
+        std::lock_guard lock(targets_mutex_);
+        targets_.push_back(std::move(target));
+    }
+    start_checkpoints();
+    start_string_compaction();
+    start_auto_tuner();
+
+    // A running process was started before the sessions saw it
+    if (attached) {
+        for (const auto& shard : shards_) {
+            request_rundown(*shard);
+        }
+    }
+}
+
+bool Engine::start_session(std::unique_ptr<process::Controller> target,
+                           const std::vector<std::uint32_t>& descendants) {
+    if (config_.recycle_on_start && graph_.count() > 0) {
+        reset_session();
+    }
+    if (config_.normalize_device_paths) {
+        device_paths_.refresh();  // Volumes mounted since the last session
+    }
+
+    // Store target PIDs for event filtering; none keeps every process
+    target_set_.clear();
+    if (target) {
+        target_set_.insert(target->pid());
+        for (const std::uint32_t pid : descendants) {
+            target_set_.insert(pid);
+        }
+        target_pid_.store(target->pid(), std::memory_order_release);
+        std::lock_guard lock(targets_mutex_);
+        targets_.push_back(std::move(target));
+    }
+
+    // Step 2: Create one ETW session per provider group. Anchor the record
+    // clock first so callbacks never read a clock per event; all sessions
+    // share it so their timestamps merge.
+    const auto groups = provider_groups();
+    if (config_.prewarm_schemas) {
+        // A launched target is still suspended, so this delays none of its events
+        std::size_t warmed = 0;
+        for (const auto& group : groups) {
+            for (const auto& provider : group) {
+                if (const auto guid = provider_guid(provider)) {
+                    warmed += etw::global_tdh_cache().prewarm(*guid);
+                }
             }
+        }
+        EXERAY_DEBUG("Engine: Prewarmed {} TDH schemas", warmed);
+    }
+    shards_.clear();
+    merger_.reset();
+    domains_.clear();
+    flows_.clear();
+    jit_.clear();
+    logons_.clear();
+    wmi_.clear();
+    rates_.clear();
+    profiles_.forget_processes();
+    shed_.reset_stats();
+    sampler_.reset();
+    rules_.reset();
+    etw::memory_regions().clear();
+    etw::module_map().clear();
+    etw::thread_map().clear();
+    etw::file_map().clear();
+    etw::key_map().clear();
+    restore_trackers();
+    iocs_.reset();
+    etw::ParseMetrics::global().reset();
+    SpanTrace::global().reset();
+    profiler_.reset();
+    latency_->reset();
+    etw::IngestLatency* latency = config_.ingest_latency ? latency_.get() : nullptr;
+    if (groups.size() > 1) {
+        merger_ = std::make_unique<etw::ShardMerger>(
+            graph_, groups.size(),
+            static_cast<event::Timestamp>(config_.merge_lag_ms) * 1'000'000);
+        merger_->set_latency(latency);
+    }
+    // Detection runs on the pool workers the drains leave free
+    etw::RuleEngine* rules = config_.detection.enabled && !rules_.empty() ? &rules_ : nullptr;
+    etw::IocMatcher* iocs = config_.ioc.enabled && !iocs_.empty() ? &iocs_ : nullptr;
+    const bool drains = config_.ingest_ring_bytes > 0 && pool_.size() > groups.size();
+    const std::size_t workers = (std::min)(config_.detection_workers,
+                                           pool_.size() - (drains ? groups.size() : 0));
+    if (workers > 0 && (rules != nullptr || iocs != nullptr)) {
+        detection_.start(rules, iocs, &strings_, latency, &correlator_, workers,
+                         [this](std::function<void()> task) { pool_.submit(std::move(task)); });
+        rules = nullptr;
+        iocs = nullptr;
+    }
+    if (config_.images.enabled) {
+        images_.start(graph_, strings_, extensions_,
+                      [this](std::function<void()> task) { pool_.submit(std::move(task)); });
+    }
+    if (config_.content_scan.enabled) {
+        scanner_.start(graph_, strings_, extensions_,
+                       [this](std::function<void()> task) { pool_.submit(std::move(task)); });
+    }
+    if (config_.memory_capture.enabled) {
+        captures_.start(graph_, extensions_,
+                        [this](std::function<void()> task) { pool_.submit(std::move(task)); });
+    }
+    // Real-time sessions deliver raw QPC ticks (see etw/clock.hpp)
+    LARGE_INTEGER counter{};
+    LARGE_INTEGER frequency{};
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    const auto clock = etw::ClockDomain::capture(static_cast<std::uint64_t>(counter.QuadPart),
+                                                 static_cast<std::uint64_t>(frequency.QuadPart));
+    wall_clock_ = clock.wall();
+    for (std::size_t i = 0; i < groups.size(); ++i) {
+        auto shard = std::make_unique<EtwShard>();
+        shard->ctx.clock = clock;
+        shard->ctx.merger = merger_.get();
+        shard->ctx.shard = i;
+        shard->ctx.domains = config_.domains.enabled ? &domains_ : nullptr;
+        shard->ctx.flows = config_.flows.enabled ? &flows_ : nullptr;
+        shard->ctx.jit = config_.jit.enabled ? &jit_ : nullptr;
+        shard->ctx.logons = config_.logons.enabled ? &logons_ : nullptr;
+        shard->ctx.wmi = config_.wmi.enabled ? &wmi_ : nullptr;
+        shard->ctx.rates = config_.rates.enabled ? &rates_ : nullptr;
+        shard->ctx.profiles = config_.profiles.enabled ? &profiles_ : nullptr;
+        shard->ctx.io.set_window(static_cast<event::Timestamp>(config_.file_coalesce_ms) *
+                                 1'000'000);
+        shard->ctx.shed = config_.shedding.enabled ? &shed_ : nullptr;
+        shard->ctx.sampler = config_.sampling.enabled ? &sampler_ : nullptr;
+        shard->ctx.rules = rules;
+        shard->ctx.iocs = iocs;
+        shard->ctx.detection = detection_.running() ? &detection_ : nullptr;
+        shard->ctx.images = images_.running() ? &images_ : nullptr;
+        shard->ctx.scanner = scanner_.running() ? &scanner_ : nullptr;
+        shard->ctx.captures = captures_.running() ? &captures_ : nullptr;
+        shard->ctx.latency = latency;
+        shard->ctx.metrics = consumer_metrics_;
+        shards_.push_back(std::move(shard));
+    }
+
+    // Step 3: Set monitoring flag before starting threads
+    monitoring_.store(true, std::memory_order_release);
+    ingesting_.store(true, std::memory_order_seq_cst);
+    start_checkpoints();
+    start_string_compaction();
+    start_auto_tuner();
+
+    // Steps 4-5: Enable providers and start each session's consumer thread
+    for (std::size_t i = 0; i < groups.size(); ++i) {
+        if (!start_shard(*shards_[i], i, groups[i])) {
+            EXERAY_ERROR("Engine: Failed to create ETW session");
+            stop_monitoring();
+            return false;
+        }
+    }
+    if (!shards_.empty()) {
+        etw_buffers_ = shards_.front()->session->buffers();
+    }
+
+    // Whatever ran before the sessions is listed once, so early events
+    // find their process, thread owner, module and file
+    for (const auto& shard : shards_) {
+        request_rundown(*shard);
+    }
+    return true;
+}
+
+void Engine::close_sessions(bool detached, StopReport& report) {
+    auto phase_end = std::chrono::steady_clock::now();
+    const auto lap = [&phase_end](std::chrono::nanoseconds& phase) {
+        const auto now = std::chrono::steady_clock::now();
+        phase = now - phase_end;
+        phase_end = now;
+    };
+
+    // Step 2: Stop the ETW sessions - this will cause ProcessTrace to
+    // return. Stopped with the consumer open, a session delivers what it
+    // still buffers first; destroying it closes the consumer and drops
+    // that (detach). Take the final loss counters while the sessions
+    // still exist.
+    for (auto& shard : shards_) {
+        shard->stats.stop();
+        if (detached) {
+            shard->session.reset();
+        } else if (shard->session) {
+            shard->session->stop();
+        }
+    }
+
+    // Step 3: Wait for the ETW threads to finish
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+        shard->session.reset();
+    }
+    lap(report.stop);
+
+    // Step 4: Let the drain workers finish the records still in the rings,
+    // then push what the merger still holds back
+    for (auto& shard : shards_) {
+        if (shard->ctx.ring != nullptr) {
+            shard->ctx.ring->close();
+            shard->draining.wait(true, std::memory_order_acquire);
+            shard->ctx.ring = nullptr;
+        }
+        etw::finish_pending(shard->ctx);
+    }
+    if (merger_) {
+        merger_->flush();
+    }
+    detection_.stop();
+    images_.stop();
+    scanner_.stop();
+    captures_.stop();
+    lap(report.finish);
+}
 
-            auto guid = etw::get_provider_guid(name);
-            if (!guid) {
-                EXERAY_WARN("Unknown provider: {}", name);
-                continue;
+void Engine::request_rundown(EtwShard& shard, std::string_view only) {
+    // Kernel-Process answers with process, thread and image rundowns,
+    // Kernel-File with the files open at the time
+    static const GUID* const kRundownProviders[] = {&etw::providers::KERNEL_PROCESS,
+                                                   &etw::providers::KERNEL_FILE};
+    std::lock_guard lock(providers_mutex_);
+    for (const auto& provider : shard.providers) {
+        if (!only.empty() && provider != only) {
+            continue;
+        }
+        const auto guid = etw::get_provider_guid(provider);
+        if (!guid || std::none_of(std::begin(kRundownProviders), std::end(kRundownProviders),
+                                  [&](const GUID* g) { return IsEqualGUID(*guid, *g); })) {
+            continue;
+        }
+        const auto settings = provider_settings(provider, config_.providers.at(provider));
+        const uint64_t keywords =
+            (settings.keywords == 0) ? 0xFFFFFFFFFFFFFFFF : settings.keywords;
+        if (!shard.session->capture_state(*guid, keywords)) {
+            EXERAY_WARN("Engine: Rundown request to {} failed; state from before the "
+                        "session is unknown", provider);
+        }
+    }
+}
+#endif
+
+void Engine::stop_monitoring() {
+    stop_monitoring(std::chrono::milliseconds(config_.stop_drain_ms));
+}
+
+void Engine::stop_monitoring(std::chrono::milliseconds drain) {
+    if (!monitoring_.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    // Clear monitoring flag first
+    monitoring_.store(false, std::memory_order_release);
+    stop_auto_tuner();
+
+    using Clock = std::chrono::steady_clock;
+    const auto begin = Clock::now();
+    StopReport report;
+    report.detached = drain.count() <= 0;
+
+#ifdef _WIN32
+    auto phase_end = begin;
+    const auto lap = [&phase_end](std::chrono::nanoseconds& phase) {
+        const auto now = Clock::now();
+        phase = now - phase_end;
+        phase_end = now;
+    };
+    if (!report.detached) {
+        // Step 1: Hand the partly filled buffers to the consumers now, then
+        // wait for them to read every buffer their session wrote
+        // A shard whose session failed to start has none
+        for (auto& shard : shards_) {
+            if (shard->session) {
+                shard->session->flush();
+            }
+        }
+        lap(report.flush);
+        const auto deadline = Clock::now() + drain;
+        for (;;) {
+            report.drained = std::all_of(shards_.begin(), shards_.end(), [](const auto& shard) {
+                etw::SessionStats stats;
+                return !shard->session || !shard->session->query_stats(stats) ||
+                       shard->ctx.buffers_read.load(std::memory_order_relaxed) >=
+                           stats.buffers_written;
+            });
+            if (report.drained || Clock::now() >= deadline) {
+                break;
             }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        lap(report.drain);
+    }
+
+    // Standing by, the sessions keep running; once the targets leave the
+    // set below their callbacks drop every event until the next target
+    report.standby = config_.standby_session && !report.detached && !shards_.empty() &&
+                     shards_.front()->ctx.targets != nullptr &&
+                     std::all_of(shards_.begin(), shards_.end(),
+                                 [](const auto& shard) { return shard->session != nullptr; });
+    if (report.standby) {
+        standby_.store(true, std::memory_order_release);
+    } else {
+        close_sessions(report.detached, report);
+    }
+    // Every alert of the session is queued: let a waiting consumer drain them
+    alerts_.wake();
 
-            // Use configured keywords, or all keywords if 0
-            uint64_t keywords = (cfg.keywords == 0) ? 0xFFFFFFFFFFFFFFFF : cfg.keywords;
-            etw_session_->enable_provider(*guid, cfg.level, keywords);
-            EXERAY_DEBUG("Enabled provider {} (level={}, keywords=0x{:x})",
-                         name, cfg.level, keywords);
+    // Step 5: Terminate the launched targets if still running; attached
+    // ones were running before the session and outlive it
+    {
+        std::lock_guard lock(targets_mutex_);
+        for (const auto& target : targets_) {
+            if (target->launched() && target->is_running()) {
+                target->terminate();
+            }
         }
+        targets_.clear();
     }
+#endif
 
-    // Step 4: Set monitoring flag before starting thread
-    monitoring_.store(true, std::memory_order_release);
+    // Clear target PIDs; callbacks of standby sessions now drop everything
+    target_pid_.store(0, std::memory_order_release);
+    target_set_.clear();
 
-    // Step 5: Start ETW consumer thread
-    etw_thread_ = std::thread(&Engine::etw_thread_func, this);
+    // Nothing more will be pushed: wake whoever awaits events_after()
+    ingesting_.store(false, std::memory_order_seq_cst);
+    graph_.release_watchers();
+    stop_string_compaction();
+    stop_checkpoints();
+    if (config_.profiles.enabled && config_.profiles.learn) {
+        save_profiles();
+    }
+    if (config_.images.enabled) {
+        save_image_cache();
+    }
 
-    // Step 6: Resume the target process to start execution
-    target_->resume();
+    report.total = Clock::now() - begin;
+    {
+        const std::lock_guard lock(stop_mutex_);
+        last_stop_ = report;
+    }
+    EXERAY_INFO("Engine: Stopped in {} ms (flush {} ms, drain {} ms{}, stop {} ms, finish {} ms)",
+                std::chrono::duration_cast<std::chrono::milliseconds>(report.total).count(),
+                std::chrono::duration_cast<std::chrono::milliseconds>(report.flush).count(),
+                std::chrono::duration_cast<std::chrono::milliseconds>(report.drain).count(),
+                report.detached  ? ", detached"
+                : report.drained ? (report.standby ? ", standing by" : "")
+                                 : ", deadline passed",
+                std::chrono::duration_cast<std::chrono::milliseconds>(report.stop).count(),
+                std::chrono::duration_cast<std::chrono::milliseconds>(report.finish).count());
+}
 
+StopReport Engine::last_stop() const {
+    const std::lock_guard lock(stop_mutex_);
+    return last_stop_;
+}
+
+bool Engine::add_target(std::wstring_view exe_path) {
+    if (!monitoring_.load(std::memory_order_acquire)) {
+        EXERAY_ERROR("Engine: Not monitoring; start_monitoring() launches the first target");
+        return false;
+    }
+#ifdef _WIN32
+    if (shards_.empty() || shards_.front()->ctx.targets == nullptr) {
+        EXERAY_ERROR("Engine: A system-wide session already sees every process");
+        return false;
+    }
+    auto target = process::Controller::launch(exe_path);
+    if (!target) {
+        EXERAY_ERROR("Engine: Failed to launch target process");
+        return false;
+    }
+    target->apply(config_.target_limits);
+    if (!target_set_.insert(target->pid())) {
+        EXERAY_ERROR("Engine: Target set is full");
+        return false;
+    }
+    if (!config_.follow_children && !config_.standby_session) {
+        // Widen ETW's PID filter; enabling again replaces it
+        for (std::size_t i = 0; i < shards_.size(); ++i) {
+            enable_providers(*shards_[i], i);
+        }
+    }
+    std::lock_guard lock(targets_mutex_);
+    targets_.push_back(std::move(target));
+    targets_.back()->resume();
     return true;
 #else
-    // ETW not available on non-Windows platforms
     (void)exe_path;
     EXERAY_ERROR("Engine: ETW monitoring not available on this platform");
     return false;
 #endif
 }
 
-void Engine::stop_monitoring() {
-    if (!monitoring_.load(std::memory_order_acquire)) {
-        return;
+std::vector<std::vector<std::string>> Engine::provider_groups() const {
+    std::map<std::uint8_t, std::vector<std::string>> groups;
+    {
+        std::lock_guard lock(providers_mutex_);
+        for (const auto& [name, cfg] : config_.providers) {
+            if (cfg.enabled) {
+                groups[cfg.session].push_back(name);
+            }
+        }
     }
+    std::vector<std::vector<std::string>> out;
+    for (auto& [session, names] : groups) {
+        out.push_back(std::move(names));
+    }
+    if (out.empty()) {
+        out.emplace_back();  // One session even with nothing enabled
+    }
+    return out;
+}
 
-    // Clear monitoring flag first
-    monitoring_.store(false, std::memory_order_release);
+etw::SessionBuffers Engine::session_buffers(const std::vector<std::string>& providers) const {
+    std::size_t high_rate = 0;
+    for (const auto& name : providers) {
+        if (name == "File" || name == "Registry" || name == "Network") {
+            ++high_rate;
+        }
+    }
+    return etw::resolve_buffers(config_.etw_buffers, providers.size(), high_rate);
+}
+
+platform::ThreadPlacement Engine::ingest_placement() const {
+    platform::ThreadPlacement placement = config_.ingest_threads;
+    if (!placement.cores.empty() || config_.etw_threads.cores.empty()) {
+        return placement;
+    }
+    // Neighbours of the ETW cores on the same L2, else on the same socket,
+    // the ETW cores themselves excluded; stay unpinned if there are none
+    const auto& etw_cores = config_.etw_threads.cores;
+    const auto add = [&](const std::vector<unsigned>& cores) {
+        for (const unsigned core : cores) {
+            if (std::find(etw_cores.begin(), etw_cores.end(), core) == etw_cores.end() &&
+                std::find(placement.cores.begin(), placement.cores.end(), core) ==
+                    placement.cores.end()) {
+                placement.cores.push_back(core);
+            }
+        }
+    };
+    for (const unsigned core : etw_cores) {
+        add(platform::l2_siblings(core));
+    }
+    if (placement.cores.empty()) {
+        const platform::CpuTopology topology = platform::cpu_topology();
+        for (const unsigned core : etw_cores) {
+            if (const platform::LogicalCpu* cpu = topology.find(core)) {
+                add(topology.package_cpus(cpu->package));
+            }
+        }
+    }
+    return placement;
+}
 
 #ifdef _WIN32
-    // Step 1: Stop ETW session - this will cause ProcessTrace to return
-    // The Session destructor handles StopTrace/CloseTrace
-    etw_session_.reset();
+void Engine::enable_providers(EtwShard& shard, std::size_t index) {
+    std::lock_guard lock(providers_mutex_);
+    for (const auto& provider : shard.providers) {
+        enable_on(shard, index, provider);
+    }
+}
 
-    // Step 2: Wait for ETW thread to finish
-    if (etw_thread_.joinable()) {
-        etw_thread_.join();
+void Engine::enable_on(EtwShard& shard, std::size_t index, const std::string& provider) {
+    // The PID filter makes ETW drop other processes' events before they
+    // are buffered; the callback still filters for providers that ignore
+    // it. It holds a few fixed PIDs, so children cannot be followed with it,
+    // and standby sessions would have to enable every provider again.
+    std::vector<uint32_t> pids;
+    if (!config_.follow_children && !config_.standby_session) {
+        pids = target_set_.pids();
+        if (pids.size() > etw::ProviderFilter::kMaxPids) {
+            pids.clear();
+        }
+    }
+    const ProviderConfig& cfg = config_.providers.at(provider);
+    auto guid = provider_guid(provider);
+    if (!guid) {
+        EXERAY_WARN("Unknown provider: {}", provider);
+        return;
     }
 
-    // Step 3: Terminate target process if still running
-    if (target_ && target_->is_running()) {
-        target_->terminate();
+    // Use configured (or preset) keywords, or all keywords if 0
+    const auto settings = provider_settings(provider, cfg);
+    uint64_t keywords = (settings.keywords == 0) ? 0xFFFFFFFFFFFFFFFF : settings.keywords;
+    const etw::ProviderFilter filter{
+        pids, settings.event_ids,
+        config_.capture_stacks ? settings.stack_event_ids : std::span<const uint16_t>{}};
+    shard.session->enable_provider(*guid, settings.level, keywords, filter);
+    EXERAY_DEBUG("Enabled provider {} on session {} (preset={}, level={}, keywords=0x{:x})",
+                 provider, index, etw::preset_name(cfg.preset), settings.level, keywords);
+}
+
+bool Engine::start_shard(EtwShard& shard, std::size_t index,
+                         const std::vector<std::string>& providers) {
+    etw::ConsumerContext& ctx = shard.ctx;
+    ctx.graph = &graph_;
+    ctx.targets = target_set_.empty() && !config_.standby_session ? nullptr : &target_set_;
+    ctx.follow_children = config_.follow_children;
+    ctx.strings = &strings_;
+    ctx.extensions = &extensions_;
+    ctx.stacks = config_.capture_stacks ? &stacks_ : nullptr;
+    ctx.correlator = &correlator_;
+    ctx.manifests = &manifests_;
+
+    const std::wstring name =
+        index == 0 ? std::wstring(L"ExeRayMonitor") : L"ExeRayMonitor" + std::to_wstring(index);
+    etw::SessionLog log = config_.etw_log;
+    log.path = etw::log_path_for(log.path, index);
+    shard.session = etw::Session::create(
+        name,
+        etw::event_record_callback,
+        &ctx,
+        etw::buffer_callback,
+        session_buffers(providers),
+        log
+    );
+    if (!shard.session) {
+        return false;
+    }
+    // The header's PerfFreq is authoritative for the session's timestamps
+    ctx.clock.set_frequency(shard.session->timer_frequency());
+    const auto& buffers = shard.session->buffers();
+    EXERAY_DEBUG("ETW session {}: {} x {} KB (min {}), flush {} ms", index,
+                 buffers.max_buffers, buffers.buffer_kb, buffers.min_buffers,
+                 buffers.flush_timer_ms);
+    shard.stats.start(
+        [session = shard.session.get(), &ctx](etw::SessionStats& out) {
+            if (!session->query_stats(out)) {
+                return false;
+            }
+            // Buffers in use out of the most the session may allocate
+            const std::uint32_t in_use =
+                out.buffers > out.free_buffers ? out.buffers - out.free_buffers : 0;
+            ctx.pressure.store(etw::pressure_percent(in_use, session->buffers().max_buffers),
+                               std::memory_order_relaxed);
+            return true;
+        },
+        std::chrono::milliseconds(config_.stats_interval_ms));
+
+    shard.providers = providers;
+    enable_providers(shard, index);
+
+    // Parse on a pool worker so the callback only copies records. One
+    // drain per session keeps its records in delivery order, which the
+    // correlator needs; leave at least one worker for other tasks.
+    if (config_.ingest_ring_bytes > 0 && pool_.size() > shards_.size()) {
+        shard.ring = std::make_unique<etw::RecordRing>(config_.ingest_ring_bytes);
+        ctx.ring = shard.ring.get();
+        shard.draining.store(true, std::memory_order_release);
+        pool_.submit([&shard, placement = ingest_placement()] {
+            const platform::ScopedPlacement pinned(placement);
+            const ProfiledThread role("ingest");
+            etw::drain_records(shard.ctx);
+            shard.draining.store(false, std::memory_order_release);
+            shard.draining.notify_all();
+        });
     }
-    target_.reset();
+
+    shard.thread = std::thread(&Engine::etw_thread_func, this, &shard);
+    return true;
+}
 #endif
 
-    // Clear target PID
-    target_pid_.store(0, std::memory_order_release);
+etw::SessionStats Engine::session_stats() const {
+    etw::SessionStats total;
+    for (const auto& shard : shards_) {
+        const etw::SessionStats stats = shard->stats.latest();
+        total.events_lost += stats.events_lost;
+        total.buffers_lost += stats.buffers_lost;
+        total.buffers_written += stats.buffers_written;
+        total.buffers_read += shard->ctx.buffers_read.load(std::memory_order_relaxed);
+        total.free_buffers += stats.free_buffers;
+        total.buffers += stats.buffers;
+        total.samples += stats.samples;
+    }
+    return total;
+}
+
+IngestStats Engine::ingest_stats() const {
+    IngestStats stats;
+    for (const auto& shard : shards_) {
+        if (shard->ring) {
+            stats.ring_bytes += shard->ring->capacity();
+            stats.staged += shard->ring->pushed();
+            stats.overflows += shard->ring->overflows();
+        }
+    }
+    return stats;
+}
+
+etw::ShedStats Engine::shed_stats() const noexcept {
+    return shed_.stats();
+}
+
+etw::SamplingStats Engine::sampling_stats() const noexcept {
+    return sampler_.stats();
+}
+
+std::vector<etw::FlowRecord> Engine::network_flows(std::uint32_t pid) const {
+    return flows_.flows(pid);
+}
+
+etw::FlowStats Engine::flow_stats() const noexcept {
+    return flows_.stats();
+}
+
+std::vector<etw::RateAnomaly> Engine::rate_anomalies() const {
+    return rates_.anomalies();
+}
+
+etw::RateStats Engine::rate_stats() const {
+    return rates_.stats();
+}
+
+etw::DomainMapStats Engine::domain_stats() const {
+    return domains_.stats();
+}
+
+std::vector<etw::JitModuleRecord> Engine::jit_modules(std::uint32_t pid) const {
+    return jit_.modules(pid);
+}
+
+etw::JitStats Engine::jit_stats() const noexcept {
+    return jit_.stats();
+}
+
+std::vector<etw::LogonSession> Engine::logon_sessions() const {
+    return logons_.sessions();
+}
+
+etw::LogonStats Engine::logon_stats() const {
+    return logons_.stats();
+}
+
+std::vector<etw::WmiOperationRecord> Engine::wmi_operations(std::uint32_t pid) const {
+    return wmi_.operations(pid);
+}
+
+etw::WmiStats Engine::wmi_stats() const noexcept {
+    return wmi_.stats();
+}
+
+bool Engine::save_profiles() {
+    if (config_.profile_file.empty()) {
+        return false;
+    }
+    if (!profiles_.save(config_.profile_file)) {
+        EXERAY_WARN("Engine: Failed to write behavior profiles");
+        return false;
+    }
+    return true;
+}
+
+etw::ProfileStats Engine::profile_stats() const {
+    return profiles_.stats();
+}
+
+bool Engine::save_image_cache() {
+    if (config_.image_cache_file.empty()) {
+        return false;
+    }
+    if (!images_.save(config_.image_cache_file)) {
+        EXERAY_WARN("Engine: Failed to write the image verdict cache");
+        return false;
+    }
+    return true;
+}
+
+std::vector<etw::StackFrame> Engine::symbolize_stack(event::ExtensionId stack,
+                                                     std::uint32_t pid) {
+    return symbolizer_.symbolize(pid, stacks_.frames(stack));
+}
+
+std::vector<etw::RuleStats> Engine::detection_stats() const {
+    return rules_.stats();
+}
+
+std::vector<etw::IocStats> Engine::ioc_stats() const {
+    return iocs_.stats();
+}
+
+etw::DetectionStageStats Engine::detection_stage_stats() const {
+    return detection_.stats();
+}
+
+std::vector<etw::ModuleInfo> Engine::modules(std::uint32_t pid) const {
+    return etw::module_map().modules(pid);
+}
+
+std::optional<etw::ModuleInfo> Engine::module_at(std::uint32_t pid, std::uint64_t address) const {
+    return etw::module_map().find(pid, address);
+}
+
+etw::ParseMetricsSnapshot Engine::parse_metrics() const {
+    return etw::ParseMetrics::global().snapshot();
+}
+
+bool Engine::dump_spans(std::wstring_view path) const {
+    std::ofstream file(std::filesystem::path(path), std::ios::binary | std::ios::trunc);
+    return file && SpanTrace::global().write_chrome_trace(file);
+}
+
+bool Engine::set_profiling(std::uint32_t interval_us) {
+    profiler_.stop();
+    return interval_us > 0 && profiler_.start(std::chrono::microseconds(interval_us));
+}
+
+bool Engine::dump_profile(std::wstring_view path) const {
+    std::ofstream file(std::filesystem::path(path), std::ios::binary | std::ios::trunc);
+    return file && profiler_.write_folded(file);
+}
+
+etw::LatencySummary Engine::ingest_latency(etw::LatencyStage stage,
+                                           event::Category category) const noexcept {
+    return latency_->summary(stage, category);
 }
 
 bool Engine::is_monitoring() const noexcept {
@@ -1,32 +1,63 @@
 /// @file engine/provider_config.cpp
-/// @brief Provider configuration API: enable_provider, disable_provider, is_provider_enabled.
+/// @brief Provider configuration API: enable_provider, disable_provider,
+/// is_provider_enabled, register_provider.
 
 #include "exeray/engine.hpp"
+#include "exeray/etw/parse_metrics.hpp"
+#include "exeray/etw/provider_mapping.hpp"
 #include "exeray/logging.hpp"
 
+#include <algorithm>
+
 namespace exeray {
 
+namespace {
+
+/// @brief ConsumerContext::muted bit of a provider name (0 if it has no parser).
+[[maybe_unused]] std::uint32_t muted_bit(std::string_view name) {
+    for (std::size_t i = 0; i < etw::kMetricProviders; ++i) {
+        if (etw::provider_name(static_cast<etw::MetricProvider>(i)) == name) {
+            return std::uint32_t{1} << i;
+        }
+    }
+    return 0;
+}
+
+}  // namespace
+
 void Engine::enable_provider(std::string_view name) {
-    std::lock_guard lock(providers_mutex_);
     std::string key(name);
-    auto it = config_.providers.find(key);
-    if (it != config_.providers.end()) {
+    {
+        std::lock_guard lock(providers_mutex_);
+        auto it = config_.providers.find(key);
+        if (it == config_.providers.end()) {
+            EXERAY_WARN("enable_provider: Unknown provider '{}'", name);
+            return;
+        }
         it->second.enabled = true;
-        EXERAY_DEBUG("Provider {} enabled (takes effect on next start_monitoring)", name);
+    }
+    if (monitoring_.load(std::memory_order_acquire) || standing_by()) {
+        switch_provider(key, true);
     } else {
-        EXERAY_WARN("enable_provider: Unknown provider '{}'", name);
+        EXERAY_DEBUG("Provider {} enabled (takes effect on next start_monitoring)", name);
     }
 }
 
 void Engine::disable_provider(std::string_view name) {
-    std::lock_guard lock(providers_mutex_);
     std::string key(name);
-    auto it = config_.providers.find(key);
-    if (it != config_.providers.end()) {
+    {
+        std::lock_guard lock(providers_mutex_);
+        auto it = config_.providers.find(key);
+        if (it == config_.providers.end()) {
+            EXERAY_WARN("disable_provider: Unknown provider '{}'", name);
+            return;
+        }
         it->second.enabled = false;
-        EXERAY_DEBUG("Provider {} disabled (takes effect on next start_monitoring)", name);
+    }
+    if (monitoring_.load(std::memory_order_acquire) || standing_by()) {
+        switch_provider(key, false);
     } else {
-        EXERAY_WARN("disable_provider: Unknown provider '{}'", name);
+        EXERAY_DEBUG("Provider {} disabled (takes effect on next start_monitoring)", name);
     }
 }
 
@@ -40,4 +71,89 @@ bool Engine::is_provider_enabled(std::string_view name) const {
     return false;
 }
 
+bool Engine::register_provider(const etw::ManifestProviderConfig& provider) {
+    if (monitoring_.load(std::memory_order_acquire) || standing_by()) {
+        EXERAY_WARN("register_provider: Refused for '{}' while sessions run", provider.name);
+        return false;
+    }
+    std::string error;
+    const auto index = manifests_.add(provider, &error);
+    if (!index) {
+        EXERAY_WARN("register_provider: '{}' refused: {}", provider.name, error);
+        return false;
+    }
+    {
+        std::lock_guard lock(providers_mutex_);
+        config_.providers.try_emplace(provider.name);
+    }
+    EXERAY_DEBUG("Registered manifest provider {} ({} fields) as #{}", provider.name,
+                 provider.fields.size(), *index);
+    return true;
+}
+
+std::optional<GUID> Engine::provider_guid(std::string_view name) const {
+    if (auto guid = manifests_.guid(name)) {
+        return guid;
+    }
+    return etw::get_provider_guid(name);
+}
+
+#ifdef _WIN32
+void Engine::switch_provider(const std::string& name, bool enabled) {
+    const auto guid = provider_guid(name);
+    if (!guid || shards_.empty()) {
+        return;
+    }
+    const std::uint32_t bit = muted_bit(name);
+    const auto runs_on = [&](const EtwShard& shard) {
+        return std::find(shard.providers.begin(), shard.providers.end(), name) !=
+               shard.providers.end();
+    };
+
+    if (!enabled) {
+        std::lock_guard lock(providers_mutex_);
+        for (auto& shard : shards_) {
+            // Mute first: whatever ETW delivers from here on is dropped
+            shard->ctx.muted.fetch_or(bit, std::memory_order_relaxed);
+            if (runs_on(*shard)) {
+                shard->session->disable_provider(*guid);
+                std::erase(shard->providers, name);
+            }
+        }
+        EXERAY_DEBUG("Provider {} disabled on the running session", name);
+        return;
+    }
+
+    std::size_t index = 0;
+    {
+        std::lock_guard lock(providers_mutex_);
+        // The session of the provider's group, else the first one
+        const std::uint8_t group = config_.providers.at(name).session;
+        for (std::size_t i = 0; i < shards_.size(); ++i) {
+            const auto& providers = shards_[i]->providers;
+            if (runs_on(*shards_[i]) ||
+                std::any_of(providers.begin(), providers.end(), [&](const std::string& p) {
+                    return config_.providers.at(p).session == group;
+                })) {
+                index = i;
+                break;
+            }
+        }
+        EtwShard& shard = *shards_[index];
+        for (auto& other : shards_) {
+            other->ctx.muted.fetch_and(~bit, std::memory_order_relaxed);
+        }
+        if (!runs_on(shard)) {
+            shard.providers.push_back(name);
+        }
+        // Enabling again also applies a changed level, keywords or preset
+        enable_on(shard, index, name);
+    }
+    request_rundown(*shards_[index], name);
+    EXERAY_DEBUG("Provider {} enabled on running session {}", name, index);
+}
+#else
+void Engine::switch_provider(const std::string& /*name*/, bool /*enabled*/) {}
+#endif
+
 }  // namespace exeray
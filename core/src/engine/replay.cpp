@@ -0,0 +1,166 @@
+/// @file engine/replay.cpp
+/// @brief Offline consumption of recorded trace files.
+
+#include "exeray/engine.hpp"
+#include "exeray/etw/file_map.hpp"
+#include "exeray/etw/key_map.hpp"
+#include "exeray/etw/memory_regions.hpp"
+#include "exeray/etw/module_map.hpp"
+#include "exeray/etw/replay_pacer.hpp"
+#include "exeray/etw/session.hpp"
+#include "exeray/etw/thread_map.hpp"
+#include "exeray/logging.hpp"
+#include "exeray/trace_spans.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+namespace exeray {
+
+std::optional<ReplayStats> Engine::replay(std::wstring_view path, const ReplayOptions& options) {
+    if (monitoring_.load(std::memory_order_acquire)) {
+        EXERAY_ERROR("Engine: Cannot replay while monitoring a process");
+        return std::nullopt;
+    }
+    close_standby();  // Its shards are replaced
+
+    if (config_.recycle_on_start && graph_.count() > 0) {
+        reset_session();
+    }
+
+#ifdef _WIN32
+    shards_.clear();
+    merger_.reset();
+    domains_.clear();
+    flows_.clear();
+    jit_.clear();
+    logons_.clear();
+    wmi_.clear();
+    rates_.clear();
+    profiles_.forget_processes();
+    shed_.reset_stats();
+    sampler_.reset();
+    rules_.reset();
+    etw::memory_regions().clear();
+    etw::module_map().clear();
+    etw::thread_map().clear();
+    etw::file_map().clear();
+    etw::key_map().clear();
+    iocs_.reset();
+    etw::ParseMetrics::global().reset();
+    SpanTrace::global().reset();
+    profiler_.reset();
+
+    auto shard = std::make_unique<EtwShard>();
+    etw::ConsumerContext& ctx = shard->ctx;
+    ctx.graph = &graph_;
+    target_set_.clear();
+    if (options.pid != 0) {
+        target_set_.insert(options.pid);
+        ctx.targets = &target_set_;
+        ctx.follow_children = config_.follow_children;
+    }
+    ctx.strings = &strings_;
+    ctx.extensions = &extensions_;
+    ctx.stacks = config_.capture_stacks ? &stacks_ : nullptr;
+    ctx.correlator = &correlator_;
+    ctx.manifests = &manifests_;
+    ctx.domains = config_.domains.enabled ? &domains_ : nullptr;
+    ctx.flows = config_.flows.enabled ? &flows_ : nullptr;
+    ctx.jit = config_.jit.enabled ? &jit_ : nullptr;
+    ctx.logons = config_.logons.enabled ? &logons_ : nullptr;
+    ctx.wmi = config_.wmi.enabled ? &wmi_ : nullptr;
+    ctx.rates = config_.rates.enabled ? &rates_ : nullptr;
+    ctx.sampler = config_.sampling.enabled ? &sampler_ : nullptr;
+    ctx.profiles = config_.profiles.enabled ? &profiles_ : nullptr;
+    ctx.io.set_window(static_cast<event::Timestamp>(config_.file_coalesce_ms) * 1'000'000);
+    ctx.rules = config_.detection.enabled && !rules_.empty() ? &rules_ : nullptr;
+    ctx.iocs = config_.ioc.enabled && !iocs_.empty() ? &iocs_ : nullptr;
+    ctx.metrics = consumer_metrics_;
+    if (config_.detection_workers > 0 && (ctx.rules != nullptr || ctx.iocs != nullptr)) {
+        detection_.start(ctx.rules, ctx.iocs, &strings_, nullptr, &correlator_,
+                         (std::min)(config_.detection_workers, pool_.size()),
+                         [this](std::function<void()> task) { pool_.submit(std::move(task)); });
+        ctx.rules = nullptr;
+        ctx.iocs = nullptr;
+        ctx.detection = &detection_;
+    }
+    if (config_.images.enabled) {
+        images_.start(graph_, strings_, extensions_,
+                      [this](std::function<void()> task) { pool_.submit(std::move(task)); });
+        ctx.images = &images_;
+    }
+    if (config_.content_scan.enabled) {
+        scanner_.start(graph_, strings_, extensions_,
+                       [this](std::function<void()> task) { pool_.submit(std::move(task)); });
+        ctx.scanner = &scanner_;
+    }
+
+    shard->session = etw::Session::open_file(
+        path,
+        etw::event_record_callback,
+        &ctx,
+        etw::buffer_callback
+    );
+    if (!shard->session) {
+        EXERAY_ERROR("Engine: Failed to open trace file");
+        detection_.stop();
+        images_.stop();
+        scanner_.stop();
+        return std::nullopt;
+    }
+    etw_buffers_ = shard->session->buffers();
+
+    // Anchor the file's start, not the current ETW time, to now
+    const auto started = std::chrono::steady_clock::now();
+    ctx.clock = etw::ClockDomain::replay(shard->session->start_time());
+    ctx.clock.set_frequency(shard->session->timer_frequency());
+    wall_clock_ = ctx.clock.wall();
+
+    etw::ReplayPacer pacer(options.speed);
+    if (options.speed > 0.0) {
+        ctx.pacer = &pacer;
+    }
+
+    target_pid_.store(options.pid, std::memory_order_release);
+    // Next ID to be assigned; unlike count() it is not reduced by eviction
+    const auto before = graph_.oldest_id() + graph_.count();
+    ingesting_.store(true, std::memory_order_seq_cst);
+    {
+        const ProfiledThread role("consumer");
+        etw::start_trace_processing(shard->session->trace_handle());
+        etw::finish_pending(ctx);
+    }
+    detection_.stop();
+    images_.stop();
+    scanner_.stop();
+    target_pid_.store(0, std::memory_order_release);
+    target_set_.clear();
+    ingesting_.store(false, std::memory_order_seq_cst);
+    graph_.release_watchers();
+
+    ReplayStats stats;
+    stats.buffers = ctx.buffers_read.load(std::memory_order_relaxed);
+    stats.events = static_cast<std::size_t>(graph_.oldest_id() + graph_.count() - before);
+    stats.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - started);
+    EXERAY_INFO("Engine: Replayed {} events from {} buffers in {} ms", stats.events,
+                stats.buffers,
+                std::chrono::duration_cast<std::chrono::milliseconds>(stats.elapsed).count());
+
+    ctx.pacer = nullptr;
+    shard->session.reset();
+    shards_.push_back(std::move(shard));
+    return stats;
+#else
+    // ETW not available on non-Windows platforms
+    (void)path;
+    (void)options;
+    EXERAY_ERROR("Engine: ETW replay not available on this platform");
+    return std::nullopt;
+#endif
+}
+
+}  // namespace exeray
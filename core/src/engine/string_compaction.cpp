@@ -0,0 +1,97 @@
+/// @file engine/string_compaction.cpp
+/// @brief Engine string compaction: marking what refers to interned strings.
+
+#include "exeray/engine.hpp"
+#include "exeray/etw/file_map.hpp"
+#include "exeray/etw/key_map.hpp"
+#include "exeray/etw/module_map.hpp"
+#include "exeray/event/payload_fields.hpp"
+#include "exeray/logging.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+namespace exeray {
+
+event::StringPool::CompactStats Engine::compact_strings() {
+    if (strings_.storage() != event::StringStorage::Generational) {
+        return {};
+    }
+    event::StringMarks marks = strings_.marks();
+
+    // String members of each category's payload, by offset
+    std::array<std::vector<std::uint16_t>, static_cast<std::size_t>(event::Category::Count)>
+        offsets;
+    for (const event::PayloadField& field : event::payload_fields()) {
+        if (field.is_string && field.category < event::Category::Count) {
+            offsets[static_cast<std::size_t>(field.category)].push_back(field.offset);
+        }
+    }
+    const auto mark_payload = [&](const event::EventPayload& payload) {
+        const auto category = static_cast<std::size_t>(payload.category);
+        if (category >= offsets.size()) {
+            return;
+        }
+        const auto* bytes = reinterpret_cast<const std::uint8_t*>(&payload);
+        for (const std::uint16_t offset : offsets[category]) {
+            event::StringId id = event::INVALID_STRING;
+            std::memcpy(&id, bytes + offset, sizeof(id));
+            marks.mark(id);
+        }
+    };
+    graph_.for_each_span([&](std::span<const event::EventNode> nodes) {
+        for (const event::EventNode& node : nodes) {
+            mark_payload(node.payload);
+        }
+    });
+    retained_.for_each(
+        [&](event::EventView view, event::EventTags) { mark_payload(view.payload()); });
+    for (const auto& [pid, module] : etw::module_map().all()) {
+        marks.mark(module.path);
+    }
+    const auto mark = [&marks](event::StringId id) { marks.mark(id); };
+    etw::file_map().for_each_path(mark);
+    etw::key_map().for_each_path(mark);
+
+    const event::StringPool::CompactStats stats = strings_.compact(marks);
+    EXERAY_DEBUG("Engine: String generation {}: kept {} ({} bytes), released {}, freed {} blocks",
+                 stats.generation, stats.kept, stats.bytes_kept, stats.released,
+                 stats.blocks_freed);
+    return stats;
+}
+
+void Engine::start_string_compaction() {
+    if (strings_.storage() != event::StringStorage::Generational ||
+        config_.string_compaction_ms == 0 || compaction_thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard lock(compaction_mutex_);
+        compaction_stop_ = false;
+    }
+    compaction_thread_ = std::thread([this] {
+        const auto interval = std::chrono::milliseconds(config_.string_compaction_ms);
+        std::unique_lock lock(compaction_mutex_);
+        while (!compaction_cv_.wait_for(lock, interval, [this] { return compaction_stop_; })) {
+            lock.unlock();
+            compact_strings();
+            lock.lock();
+        }
+    });
+}
+
+void Engine::stop_string_compaction() {
+    if (!compaction_thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard lock(compaction_mutex_);
+        compaction_stop_ = true;
+    }
+    compaction_cv_.notify_all();
+    compaction_thread_.join();
+}
+
+}  // namespace exeray
@@ -0,0 +1,123 @@
+/// @file engine/synthetic.cpp
+/// @brief Generated event streams fed through the ingest pipeline.
+
+#include "exeray/engine.hpp"
+#include "exeray/etw/file_map.hpp"
+#include "exeray/etw/key_map.hpp"
+#include "exeray/etw/memory_regions.hpp"
+#include "exeray/etw/module_map.hpp"
+#include "exeray/etw/thread_map.hpp"
+#include "exeray/logging.hpp"
+#include "exeray/trace_spans.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+namespace exeray {
+
+std::optional<ReplayStats> Engine::run_synthetic(const etw::SyntheticConfig& config,
+                                                 std::uint64_t count) {
+    if (monitoring_.load(std::memory_order_acquire)) {
+        EXERAY_ERROR("Engine: Cannot run a synthetic load while monitoring a process");
+        return std::nullopt;
+    }
+    close_standby();  // Its shards are replaced
+
+    if (config_.recycle_on_start && graph_.count() > 0) {
+        reset_session();
+    }
+
+    shards_.clear();
+    merger_.reset();
+    domains_.clear();
+    flows_.clear();
+    jit_.clear();
+    logons_.clear();
+    wmi_.clear();
+    rates_.clear();
+    profiles_.forget_processes();
+    shed_.reset_stats();
+    sampler_.reset();
+    rules_.reset();
+    etw::memory_regions().clear();
+    etw::module_map().clear();
+    etw::thread_map().clear();
+    etw::file_map().clear();
+    etw::key_map().clear();
+    iocs_.reset();
+    SpanTrace::global().reset();
+    profiler_.reset();
+    latency_->reset();
+    etw::IngestLatency* latency = config_.ingest_latency ? latency_.get() : nullptr;
+
+    auto shard = std::make_unique<EtwShard>();
+    etw::ConsumerContext& ctx = shard->ctx;
+    ctx.graph = &graph_;
+    ctx.strings = &strings_;
+    ctx.extensions = &extensions_;
+    ctx.stacks = config_.capture_stacks ? &stacks_ : nullptr;
+    ctx.correlator = &correlator_;
+    ctx.clock = etw::ClockDomain::capture();
+    wall_clock_ = ctx.clock.wall();
+    ctx.domains = config_.domains.enabled ? &domains_ : nullptr;
+    ctx.flows = config_.flows.enabled ? &flows_ : nullptr;
+    ctx.jit = config_.jit.enabled ? &jit_ : nullptr;
+    ctx.logons = config_.logons.enabled ? &logons_ : nullptr;
+    ctx.wmi = config_.wmi.enabled ? &wmi_ : nullptr;
+    ctx.rates = config_.rates.enabled ? &rates_ : nullptr;
+    ctx.sampler = config_.sampling.enabled ? &sampler_ : nullptr;
+    ctx.profiles = config_.profiles.enabled ? &profiles_ : nullptr;
+    ctx.io.set_window(static_cast<event::Timestamp>(config_.file_coalesce_ms) * 1'000'000);
+    ctx.rules = config_.detection.enabled && !rules_.empty() ? &rules_ : nullptr;
+    ctx.iocs = config_.ioc.enabled && !iocs_.empty() ? &iocs_ : nullptr;
+    ctx.latency = latency;
+    ctx.metrics = consumer_metrics_;
+    if (config_.detection_workers > 0 && (ctx.rules != nullptr || ctx.iocs != nullptr)) {
+        detection_.start(ctx.rules, ctx.iocs, &strings_, latency, &correlator_,
+                         (std::min)(config_.detection_workers, pool_.size()),
+                         [this](std::function<void()> task) { pool_.submit(std::move(task)); });
+        ctx.rules = nullptr;
+        ctx.iocs = nullptr;
+        ctx.detection = &detection_;
+    }
+    if (config_.images.enabled) {
+        images_.start(graph_, strings_, extensions_,
+                      [this](std::function<void()> task) { pool_.submit(std::move(task)); });
+        ctx.images = &images_;
+    }
+    if (config_.content_scan.enabled) {
+        scanner_.start(graph_, strings_, extensions_,
+                       [this](std::function<void()> task) { pool_.submit(std::move(task)); });
+        ctx.scanner = &scanner_;
+    }
+
+    // Next ID to be assigned; unlike count() it is not reduced by eviction
+    const auto before = graph_.oldest_id() + graph_.count();
+    const auto started = std::chrono::steady_clock::now();
+    ingesting_.store(true, std::memory_order_seq_cst);
+    etw::SyntheticSource source(config);
+    {
+        const ProfiledThread role("consumer");
+        source.feed(ctx, count);
+    }
+    detection_.stop();
+    images_.stop();
+    scanner_.stop();
+    ingesting_.store(false, std::memory_order_seq_cst);
+    graph_.release_watchers();
+
+    ReplayStats stats;
+    stats.buffers = ctx.buffers_read.load(std::memory_order_relaxed);
+    stats.events = static_cast<std::size_t>(graph_.oldest_id() + graph_.count() - before);
+    stats.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - started);
+    EXERAY_DEBUG("Engine: Generated {} events ({} stored) in {} ms", count, stats.events,
+                 std::chrono::duration_cast<std::chrono::milliseconds>(stats.elapsed).count());
+
+    shards_.push_back(std::move(shard));
+    return stats;
+}
+
+}  // namespace exeray
@@ -0,0 +1,351 @@
+/// @file behavior_profiles.cpp
+/// @brief Per-executable behavior baselines (platform independent).
+
+#include "exeray/etw/behavior_profiles.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "exeray/event/string_pool.hpp"
+
+namespace exeray::etw {
+
+namespace {
+
+constexpr std::size_t kHeaderSize = 32;
+
+/// @brief Bloom filter positions of a hash: bits 0-15 and 16-31 select one bit each.
+template <std::size_t N>
+std::pair<std::size_t, std::size_t> bloom_bits(std::uint32_t hash) noexcept {
+    constexpr std::size_t kMask = N * 64 - 1;
+    static_assert((N * 64 & kMask) == 0, "Bloom filters are a power of two bits");
+    return {hash & kMask, (hash >> 16) & kMask};
+}
+
+template <std::size_t N>
+void bloom_add(std::array<std::uint64_t, N>& words, std::uint32_t hash) noexcept {
+    const auto [a, b] = bloom_bits<N>(hash);
+    std::atomic_ref(words[a / 64]).fetch_or(std::uint64_t{1} << (a % 64),
+                                            std::memory_order_relaxed);
+    std::atomic_ref(words[b / 64]).fetch_or(std::uint64_t{1} << (b % 64),
+                                            std::memory_order_relaxed);
+}
+
+template <std::size_t N>
+bool bloom_has(const std::array<std::uint64_t, N>& words, std::uint32_t hash) noexcept {
+    const auto [a, b] = bloom_bits<N>(hash);
+    return (words[a / 64] >> (a % 64) & 1) != 0 && (words[b / 64] >> (b % 64) & 1) != 0;
+}
+
+std::uint32_t port_hash(std::uint16_t port) noexcept {
+    const std::uint32_t h = port * 0x9E3779B1U;
+    return h ^ (h >> 15);
+}
+
+/// @brief Records of a mapped profile file; nullopt if it is not one.
+std::optional<std::span<const ProfileRecord>> records_of(const platform::MappedFile& file) {
+    const auto bytes = file.bytes();
+    if (bytes.size() < kHeaderSize) {
+        return std::nullopt;
+    }
+    std::uint32_t header[4];
+    std::memcpy(header, bytes.data(), sizeof(header));
+    if (header[0] != kProfileMagic || header[1] != kProfileFormat ||
+        header[2] != sizeof(ProfileRecord) ||
+        bytes.size() != kHeaderSize + std::size_t{header[3]} * sizeof(ProfileRecord)) {
+        return std::nullopt;
+    }
+    // The mapping is page aligned and the header a multiple of 8 bytes
+    const std::span records(reinterpret_cast<const ProfileRecord*>(bytes.data() + kHeaderSize),
+                            header[3]);
+    const auto by_image = [](const ProfileRecord& a, const ProfileRecord& b) {
+        return a.image < b.image;
+    };
+    if (!std::is_sorted(records.begin(), records.end(), by_image)) {
+        return std::nullopt;
+    }
+    return records;
+}
+
+}  // namespace
+
+void ProfileRecord::merge(const ProfileRecord& other) noexcept {
+    events += other.events;
+    for (std::size_t i = 0; i < operations.size(); ++i) {
+        operations[i] |= other.operations[i];
+    }
+    for (std::size_t i = 0; i < directories.size(); ++i) {
+        directories[i] |= other.directories[i];
+    }
+    for (std::size_t i = 0; i < ports.size(); ++i) {
+        ports[i] |= other.ports[i];
+    }
+    for (std::size_t i = 0; i < modules.size(); ++i) {
+        modules[i] |= other.modules[i];
+    }
+}
+
+BehaviorProfiles::BehaviorProfiles(const ProfileConfig& config) : config_(config) {}
+
+std::uint64_t BehaviorProfiles::image_key(std::string_view path) noexcept {
+    std::uint64_t hash = 0xCBF29CE484222325ULL;
+    for (const char c : path) {
+        const auto byte = static_cast<std::uint8_t>(c);
+        hash ^= (byte >= 'A' && byte <= 'Z') ? byte - 'A' + 'a' : byte;
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+bool BehaviorProfiles::load(const std::filesystem::path& path) {
+    forget_processes();
+    loaded_ = {};
+    if (!file_.open(path)) {
+        return false;
+    }
+    const auto records = records_of(file_);
+    if (!records) {
+        file_.close();
+        return false;
+    }
+    loaded_ = *records;
+    path_ = path;
+    return true;
+}
+
+bool BehaviorProfiles::merge(const std::filesystem::path& path) {
+    platform::MappedFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+    const auto records = records_of(file);
+    if (!records) {
+        return false;
+    }
+    for (const ProfileRecord& record : *records) {
+        learned_record(record.image)->merge(record);
+    }
+    return true;
+}
+
+bool BehaviorProfiles::save(const std::filesystem::path& path) {
+    std::map<std::uint64_t, ProfileRecord> merged;
+    for (const ProfileRecord& record : loaded_) {
+        merged[record.image] = record;
+    }
+    for (const ProfileShard& shard : profiles_) {
+        const std::lock_guard lock(shard.mutex);
+        for (const auto& [image, record] : shard.records) {
+            auto [it, inserted] = merged.try_emplace(image, *record);
+            if (!inserted) {
+                it->second.merge(*record);
+            }
+        }
+    }
+
+    std::vector<std::uint8_t> bytes(kHeaderSize, 0);
+    const std::uint32_t header[4] = {kProfileMagic, kProfileFormat, sizeof(ProfileRecord),
+                                     static_cast<std::uint32_t>(merged.size())};
+    std::memcpy(bytes.data(), header, sizeof(header));
+    bytes.reserve(kHeaderSize + merged.size() * sizeof(ProfileRecord));
+    for (const auto& [image, record] : merged) {
+        const auto* data = reinterpret_cast<const std::uint8_t*>(&record);
+        bytes.insert(bytes.end(), data, data + sizeof(record));
+    }
+
+    // Written beside and renamed, so a reader never sees half a file
+    std::filesystem::path temp = path;
+    temp += ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()),
+                   static_cast<std::streamsize>(bytes.size()));
+        if (!file) {
+            file.close();
+            std::error_code error;
+            std::filesystem::remove(temp, error);
+            return false;
+        }
+    }
+
+    // A mapped file cannot be replaced on Windows: map the new one instead
+    std::error_code error;
+    const bool remap = file_.is_open() && std::filesystem::equivalent(path, path_, error);
+    if (remap) {
+        forget_processes();
+        loaded_ = {};
+        file_.close();
+    }
+    std::filesystem::rename(temp, path, error);
+    if (error) {
+        std::filesystem::remove(temp, error);
+    }
+    if (remap) {
+        load(path);
+    }
+    return !error;
+}
+
+ProfileRecord* BehaviorProfiles::learned_record(std::uint64_t image) {
+    ProfileShard& shard = profiles_[image % kShards];
+    const std::lock_guard lock(shard.mutex);
+    auto& record = shard.records[image];
+    if (record == nullptr) {
+        record = std::make_unique<ProfileRecord>();
+        record->image = image;
+        learned_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return record.get();
+}
+
+const ProfileRecord* BehaviorProfiles::loaded(std::uint64_t image) const noexcept {
+    const auto it = std::lower_bound(
+        loaded_.begin(), loaded_.end(), image,
+        [](const ProfileRecord& record, std::uint64_t key) { return record.image < key; });
+    return it != loaded_.end() && it->image == image ? &*it : nullptr;
+}
+
+ProfileRecord BehaviorProfiles::learned(std::uint64_t image) const {
+    const ProfileShard& shard = profiles_[image % kShards];
+    const std::lock_guard lock(shard.mutex);
+    const auto it = shard.records.find(image);
+    return it != shard.records.end() ? *it->second : ProfileRecord{};
+}
+
+void BehaviorProfiles::start_process(std::uint32_t pid, event::StringId image,
+                                     const event::StringPool& strings) {
+    if (pid == 0 || image == event::INVALID_STRING) {
+        return;
+    }
+    std::string buffer;
+    const std::uint64_t key = image_key(strings.read(image, buffer));
+    const Process process{config_.learn ? learned_record(key) : nullptr, loaded(key)};
+
+    ProcessShard& shard = processes_[pid % kShards];
+    const std::lock_guard lock(shard.mutex);
+    shard.processes[pid] = process;
+}
+
+std::uint32_t BehaviorProfiles::text_hash(event::StringId id, const event::StringPool& strings) {
+    std::atomic<std::uint64_t>& slot = hashes_[id % kHashCache];
+    const std::uint64_t cached = slot.load(std::memory_order_relaxed);
+    if (cached >> 32 == id) {
+        return static_cast<std::uint32_t>(cached);
+    }
+    std::string buffer;
+    const std::uint64_t key = image_key(strings.read(id, buffer));
+    const auto hash = static_cast<std::uint32_t>(key ^ (key >> 32));
+    slot.store(std::uint64_t{id} << 32 | hash, std::memory_order_relaxed);
+    return hash;
+}
+
+bool BehaviorProfiles::observe(std::uint32_t pid, const event::EventPayload& payload,
+                               std::uint8_t operation, const event::StringPool& strings) {
+    const auto c = static_cast<std::size_t>(payload.category);
+    if (c >= ProfileRecord::kCategoryCount) {
+        return false;
+    }
+    const bool is_process = payload.category == event::Category::Process;
+    if (is_process && (operation == static_cast<std::uint8_t>(event::ProcessOp::Create) ||
+                       operation == static_cast<std::uint8_t>(event::ProcessOp::Rundown))) {
+        start_process(payload.process.pid, payload.process.image_path, strings);
+    }
+
+    Process process;
+    {
+        ProcessShard& shard = processes_[pid % kShards];
+        const std::lock_guard lock(shard.mutex);
+        const auto it = shard.processes.find(pid);
+        if (it == shard.processes.end()) {
+            return false;
+        }
+        process = it->second;
+    }
+
+    // The one set-valued feature of the event, if any
+    enum class Feature : std::uint8_t { None, Directory, Port, Module };
+    Feature feature = Feature::None;
+    std::uint32_t hash = 0;
+    switch (payload.category) {
+        case event::Category::FileSystem:
+            if (const event::StringId dir = strings.path_parent(payload.file.path);
+                dir != event::INVALID_STRING) {
+                feature = Feature::Directory;
+                hash = text_hash(dir, strings);
+            }
+            break;
+        case event::Category::Network:
+            if (payload.network.remote_port != 0) {
+                feature = Feature::Port;
+                hash = port_hash(payload.network.remote_port);
+            }
+            break;
+        case event::Category::Image:
+            if (payload.image.image_path != event::INVALID_STRING) {
+                feature = Feature::Module;
+                hash = text_hash(payload.image.image_path, strings);
+            }
+            break;
+        default:
+            break;
+    }
+    const std::uint64_t op_bit = std::uint64_t{1} << (operation & 63);
+
+    if (ProfileRecord* learned = process.learned) {
+        std::atomic_ref(learned->operations[c]).fetch_or(op_bit, std::memory_order_relaxed);
+        switch (feature) {
+            case Feature::Directory: bloom_add(learned->directories, hash); break;
+            case Feature::Port: bloom_add(learned->ports, hash); break;
+            case Feature::Module: bloom_add(learned->modules, hash); break;
+            case Feature::None: break;
+        }
+        std::atomic_ref(learned->events).fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool novel = false;
+    const ProfileRecord* loaded = process.loaded;
+    if (config_.flag_novel && loaded != nullptr && loaded->events >= config_.min_events) {
+        checked_.fetch_add(1, std::memory_order_relaxed);
+        novel = (loaded->operations[c] & op_bit) == 0;
+        switch (feature) {
+            case Feature::Directory: novel |= !bloom_has(loaded->directories, hash); break;
+            case Feature::Port: novel |= !bloom_has(loaded->ports, hash); break;
+            case Feature::Module: novel |= !bloom_has(loaded->modules, hash); break;
+            case Feature::None: break;
+        }
+        if (novel) {
+            novel_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    if (is_process && operation == static_cast<std::uint8_t>(event::ProcessOp::Terminate)) {
+        ProcessShard& shard = processes_[payload.process.pid % kShards];
+        const std::lock_guard lock(shard.mutex);
+        shard.processes.erase(payload.process.pid);
+    }
+    return novel;
+}
+
+void BehaviorProfiles::forget_processes() {
+    for (ProcessShard& shard : processes_) {
+        const std::lock_guard lock(shard.mutex);
+        shard.processes.clear();
+    }
+}
+
+ProfileStats BehaviorProfiles::stats() const {
+    ProfileStats stats;
+    stats.loaded = loaded_.size();
+    stats.learned = learned_count_.load(std::memory_order_relaxed);
+    stats.checked = checked_.load(std::memory_order_relaxed);
+    stats.novel = novel_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}  // namespace exeray::etw
@@ -3,6 +3,371 @@
 ///
 /// Provides the callback function invoked by ProcessTrace for each ETW event,
 /// along with the consumer context structure for passing state to the callback.
+/// What follows the parser (consume_parsed() and the batch flush) is built
+/// on every platform, so synthetic events take the same path.
+
+#include "exeray/etw/consumer.hpp"
+#include "exeray/etw/behavior_profiles.hpp"
+#include "exeray/etw/content_cache.hpp"
+#include "exeray/etw/content_scanner.hpp"
+#include "exeray/etw/detection_rules.hpp"
+#include "exeray/etw/detection_stage.hpp"
+#include "exeray/etw/domain_map.hpp"
+#include "exeray/etw/image_verifier.hpp"
+#include "exeray/etw/flow_table.hpp"
+#include "exeray/etw/ingest_latency.hpp"
+#include "exeray/etw/ioc_matcher.hpp"
+#include "exeray/etw/jit_aggregator.hpp"
+#include "exeray/etw/logon_sessions.hpp"
+#include "exeray/etw/memory_capture.hpp"
+#include "exeray/etw/module_map.hpp"
+#include "exeray/etw/parser.hpp"
+#include "exeray/etw/rate_monitor.hpp"
+#include "exeray/etw/sampler.hpp"
+#include "exeray/etw/shard_merger.hpp"
+#include "exeray/etw/shed_policy.hpp"
+#include "exeray/etw/thread_map.hpp"
+#include "exeray/etw/wmi_aggregator.hpp"
+#include "exeray/event/correlator.hpp"
+#include "exeray/event/extensions.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/stack_table.hpp"
+#include "exeray/event/types.hpp"
+#include "exeray/trace_spans.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace exeray::etw {
+
+namespace {
+
+/// @brief Feed a DNS event to the domain map: queries wait for their
+/// response, responses record their address and resolution latency.
+void observe_dns(ConsumerContext& ctx, std::uint32_t pid, const event::DnsPayload& dns,
+                 std::uint8_t operation, event::Timestamp at) {
+    if (operation == static_cast<std::uint8_t>(event::DnsOp::Query)) {
+        ctx.domains->query(pid, dns.domain, dns.query_type, at);
+        return;
+    }
+    // resolved_ip holds the first octet in its top byte; network payloads
+    // keep addresses in wire order
+    const std::uint8_t octets[4] = {
+        static_cast<std::uint8_t>(dns.resolved_ip >> 24),
+        static_cast<std::uint8_t>(dns.resolved_ip >> 16),
+        static_cast<std::uint8_t>(dns.resolved_ip >> 8),
+        static_cast<std::uint8_t>(dns.resolved_ip)};
+    std::uint32_t address = 0;
+    std::memcpy(&address, octets, sizeof(address));
+    const auto latency = ctx.domains->resolve(pid, dns.domain, dns.query_type, address, at);
+    if (latency && ctx.metrics.registry != nullptr) {
+        ctx.metrics.registry->observe(ctx.metrics.dns_latency, *latency / 1000);
+    }
+}
+
+/// @brief Open or close the logon session a Security event names, or give
+/// the event the user and logon type of that session.
+void observe_logon(ConsumerContext& ctx, ParsedEvent& parsed, event::Timestamp at) {
+    event::SecurityPayload& security = parsed.payload.security;
+    switch (static_cast<event::SecurityOp>(parsed.operation)) {
+        case event::SecurityOp::Logon:
+            ctx.logons->logon({parsed.logon_id, security.target_user, security.logon_type,
+                               parsed.logon_source, at});
+            break;
+        case event::SecurityOp::Logoff:
+            ctx.logons->attribute(parsed.logon_id, security, true);
+            break;
+        case event::SecurityOp::ProcessCreate:
+        case event::SecurityOp::ProcessTerminate:
+        case event::SecurityOp::PrivilegeAdjust:
+            ctx.logons->attribute(parsed.logon_id, security);
+            break;
+        case event::SecurityOp::LogonFailed:
+            break;
+    }
+}
+
+}  // namespace
+
+void consume_parsed(ConsumerContext& ctx, ParsedEvent& parsed, std::uint32_t thread_id,
+                    std::uint8_t pressure, event::Timestamp received) {
+    // Some providers report the System, Idle or no process for work done on
+    // a thread of another one; the thread says who it belongs to
+    std::uint32_t pid = parsed.pid;
+    if (pid == 0 || pid == 4 || pid == 0xFFFFFFFF) {
+        if (const std::uint32_t owner = thread_map().find(thread_id)) {
+            pid = owner;
+        }
+    }
+
+    // Rates count every event, including the transfers folded and the
+    // events shed below; a spike is still recorded if its event is not kept
+    const event::Timestamp at = ctx.clock.to_graph(parsed.timestamp);
+    const bool spike = ctx.rates != nullptr && ctx.rates->observe(pid, parsed.category, at);
+
+    // Connections carry the domain their address was looked up as; set
+    // before flows so that flow summaries keep it
+    if (ctx.domains != nullptr && parsed.category == event::Category::Network &&
+        parsed.payload.network.family != event::kAddressIPv6) {
+        parsed.payload.network.remote_domain =
+            ctx.domains->lookup(pid, parsed.payload.network.remote_addr, at);
+    }
+
+    // Transfers are folded into their flow; only connects, closes and
+    // periodic summaries are stored
+    if (ctx.flows != nullptr && !ctx.flows->admit(pid, parsed.payload, parsed.operation, at)) {
+        return;
+    }
+
+    // Under pressure give up low-value events before ETW drops buffers
+    if (ctx.shed != nullptr && !ctx.shed->admit(parsed.payload, parsed.operation, pressure)) {
+        return;
+    }
+    if (ctx.strings != nullptr) {
+        EXERAY_SPAN(Intern);
+        parsed.deferred.commit(parsed.payload, *ctx.strings, &ctx.recent_strings);
+    }
+    if (ctx.domains != nullptr && parsed.category == event::Category::Dns) {
+        observe_dns(ctx, pid, parsed.payload.dns, parsed.operation, at);
+    }
+    if (ctx.logons != nullptr && parsed.category == event::Category::Security &&
+        parsed.logon_id != 0) {
+        observe_logon(ctx, parsed, at);
+    }
+
+    // JIT events are folded per module, which names them; those of
+    // in-memory modules are kept one by one and flagged
+    if (ctx.jit != nullptr && parsed.category == event::Category::Clr) {
+        if (!ctx.jit->admit(pid, parsed.payload, parsed.operation, at)) {
+            return;
+        }
+        if (parsed.payload.clr.is_suspicious != 0) {
+            parsed.status = event::Status::Suspicious;
+        }
+    }
+    if (ctx.wmi != nullptr && parsed.category == event::Category::Wmi &&
+        !ctx.wmi->admit(pid, parsed.payload, parsed.operation, at)) {
+        return;
+    }
+
+    // Sampling keys on the interned subject, so it follows the commit; a
+    // new process starts a new incarnation before its create is sampled
+    if (ctx.sampler != nullptr) {
+        if (parsed.category == event::Category::Process &&
+            parsed.operation == static_cast<uint8_t>(event::ProcessOp::Create)) {
+            ctx.sampler->process_started(parsed.payload.process.pid);
+        }
+        if (!spike && parsed.status != event::Status::Suspicious &&
+            !ctx.sampler->admit(pid, parsed.payload, parsed.operation)) {
+            return;
+        }
+    }
+    if (ctx.extensions != nullptr && parsed.extension.kind != event::ExtensionKind::None) {
+        parsed.payload.extension =
+            ctx.extensions->append(parsed.extension.kind, parsed.extension.view());
+    }
+    if (ctx.images != nullptr && parsed.category == event::Category::Image) {
+        ctx.images->attach(parsed.payload);
+    }
+    if (ctx.scanner != nullptr &&
+        (parsed.category == event::Category::Amsi || parsed.category == event::Category::Script) &&
+        ctx.scanner->attach(parsed.payload)) {
+        parsed.status = event::Status::Suspicious;
+    }
+    if (ctx.captures != nullptr && parsed.category == event::Category::Thread) {
+        ctx.captures->attach(parsed.operation, parsed.payload);
+    }
+    if (ctx.stacks != nullptr && !parsed.stack.empty() &&
+        parsed.payload.extension == event::NO_EXTENSION) {
+        parsed.payload.extension = ctx.stacks->intern(parsed.stack);
+    }
+
+    // Stamp with the record's own time so that late-delivered buffers keep
+    // their original ordering. Parent and correlation ID are resolved for
+    // the whole batch in flush_pending().
+    event::PendingEvent pending{
+        parsed.category,
+        parsed.operation,
+        parsed.status,
+        event::INVALID_EVENT,
+        0,
+        parsed.payload,
+        at,
+        pid
+    };
+
+    // Configured rules see the interned strings and the graph time
+    if ((ctx.rules != nullptr || ctx.iocs != nullptr) && ctx.strings != nullptr) {
+        EXERAY_SPAN(Detect);
+        if (ctx.rules != nullptr &&
+            ctx.rules->evaluate(pending.payload, pending.operation, pending.timestamp,
+                                *ctx.strings, &pending.tags)) {
+            pending.status = event::Status::Suspicious;
+        }
+        if (ctx.iocs != nullptr && ctx.iocs->match(pending.payload, *ctx.strings)) {
+            pending.status = event::Status::Suspicious;
+        }
+    }
+    if (spike) {
+        pending.status = event::Status::Suspicious;
+    }
+    if (ctx.profiles != nullptr && ctx.strings != nullptr &&
+        ctx.profiles->observe(pid, pending.payload, pending.operation, *ctx.strings)) {
+        pending.status = event::Status::Suspicious;
+    }
+    if (received != 0 && ctx.latency != nullptr) {
+        ctx.latency->record(LatencyStage::Delivered, pending.category, pending.timestamp,
+                             received);
+    }
+
+    // Consecutive reads or writes of one file become one event; whatever
+    // else touches the file releases them first, keeping their order
+    if (parsed.category == event::Category::FileSystem &&
+        ctx.io.offer(pending, parsed.object, ctx.pending)) {
+        if (ctx.pending.size() >= ctx.batch_limit.load(std::memory_order_relaxed)) {
+            flush_pending(ctx);
+        }
+        return;
+    }
+
+    // Process creates need their EventId right away so that later events in
+    // the same buffer can find them as a parent; everything else is batched
+    // until the end of the buffer.
+    const bool rundown = parsed.operation == static_cast<uint8_t>(event::ProcessOp::Rundown);
+    const bool registers_process =
+        ctx.correlator != nullptr &&
+        parsed.category == event::Category::Process &&
+        (parsed.operation == static_cast<uint8_t>(event::ProcessOp::Create) || rundown);
+    if (!registers_process) {
+        ctx.pending.push_back(pending);
+        if (ctx.pending.size() >= ctx.batch_limit.load(std::memory_order_relaxed)) {
+            flush_pending(ctx);
+        }
+        return;
+    }
+
+    // Keep graph order equal to delivery order
+    flush_pending(ctx);
+    {
+        EXERAY_SPAN(Correlate);
+        const event::Correlation correlation = ctx.correlator->resolve(pending);
+        pending.parent = correlation.parent;
+        pending.correlation_id = correlation.correlation_id;
+        ctx.correlator->add_risk_batch(std::span(&pending, 1));
+        ctx.correlator->process_tree().count(std::span(&pending, 1));
+    }
+    event::EventId event_id = event::INVALID_EVENT;
+    if (ctx.merger != nullptr) {
+        EXERAY_SPAN(Push);
+        event_id = ctx.merger->push_now(ctx.shard, pending);
+    } else {
+        // Written straight into its node: the event is known to be kept
+        EXERAY_SPAN(Push);
+        if (const auto slot = ctx.graph->reserve()) {
+            slot.node->timestamp = pending.timestamp;
+            slot.node->status = pending.status;
+            slot.node->operation = pending.operation;
+            slot.node->payload = pending.payload;
+            event_id =
+                ctx.graph->commit(slot, pending.parent, pending.correlation_id, pending.pid);
+            if (pending.tags != 0) {
+                ctx.graph->add_tags(event_id, pending.tags);
+            }
+        }
+        if (event_id == event::INVALID_EVENT && ctx.metrics.registry != nullptr) {
+            ctx.metrics.registry->add(ctx.metrics.dropped);
+        }
+        if (ctx.latency != nullptr) {
+            ctx.latency->record_visible(std::span(&pending, 1), IngestLatency::now(),
+                                         ctx.visible_tick);
+        }
+    }
+    if (ctx.detection != nullptr) {
+        ctx.detection->notify();
+    }
+
+    // Register the new process for future correlation lookups; a rundown's
+    // start is unknown, so it joins the newest incarnation
+    if (event_id != event::INVALID_EVENT) {
+        ctx.correlator->register_process(parsed.payload.process.pid, event_id,
+                                          rundown ? 0 : pending.timestamp, pending.parent);
+    }
+}
+
+bool consume_stack(ConsumerContext& ctx, std::uint64_t timestamp,
+                   std::span<const std::uint64_t> frames) {
+    if (ctx.stacks == nullptr || frames.empty()) {
+        return false;
+    }
+    const event::Timestamp at = ctx.clock.to_graph(timestamp);
+    const std::size_t oldest =
+        ctx.pending.size() - (std::min)(ctx.pending.size(), kStackLookback);
+    for (std::size_t i = ctx.pending.size(); i-- > oldest;) {
+        event::PendingEvent& pending = ctx.pending[i];
+        if (pending.timestamp != at) {
+            continue;
+        }
+        if (pending.payload.extension != event::NO_EXTENSION) {
+            break;  // Has a side record of its own
+        }
+        pending.payload.extension = ctx.stacks->intern(frames);
+        return true;
+    }
+    ctx.stacks->orphan();
+    return false;
+}
+
+void flush_pending(ConsumerContext& ctx) {
+    // Rundown modules parsed for this batch become visible with it
+    module_map().flush_staged();
+    if (ctx.pending.empty()) {
+        return;
+    }
+    const std::uint64_t started = read_cycles();
+    // Runs the batch has outlived go with it
+    ctx.io.expire(ctx.pending.back().timestamp, ctx.pending);
+    // One correlator pass per batch instead of several locks per event
+    if (ctx.correlator != nullptr) {
+        EXERAY_SPAN(Correlate);
+        ctx.correlator->resolve_batch(ctx.pending);
+        ctx.correlator->add_risk_batch(ctx.pending);
+        ctx.correlator->process_tree().count(ctx.pending);
+    }
+    MetricsRegistry* metrics = ctx.metrics.registry;
+    if (metrics != nullptr) {
+        metrics->add(ctx.metrics.batches);
+        metrics->observe(ctx.metrics.batch_events, ctx.pending.size());
+    }
+    if (ctx.merger != nullptr) {
+        EXERAY_SPAN(Push);
+        ctx.merger->submit(ctx.shard, ctx.pending);
+    } else {
+        EXERAY_SPAN(Push);
+        const std::size_t stored = ctx.graph->push_batch(ctx.pending);
+        if (metrics != nullptr && stored < ctx.pending.size()) {
+            metrics->add(ctx.metrics.dropped, ctx.pending.size() - stored);
+        }
+        if (ctx.latency != nullptr) {
+            ctx.latency->record_visible(ctx.pending, IngestLatency::now(), ctx.visible_tick);
+        }
+    }
+    if (metrics != nullptr) {
+        metrics->observe(ctx.metrics.batch_cycles, read_cycles() - started);
+    }
+    if (ctx.detection != nullptr) {
+        ctx.detection->notify();
+    }
+    ctx.pending.clear();
+}
+
+void finish_pending(ConsumerContext& ctx) {
+    ctx.io.release_all(ctx.pending);
+    flush_pending(ctx);
+}
+
+}  // namespace exeray::etw
 
 #ifdef _WIN32
 
@@ -13,74 +378,215 @@
 #include <evntrace.h>
 #include <evntcons.h>
 
-#include "exeray/etw/consumer.hpp"
-#include "exeray/etw/parser.hpp"
-#include "exeray/event/correlator.hpp"
-#include "exeray/event/graph.hpp"
-#include "exeray/event/types.hpp"
+#include "exeray/etw/event_ids.hpp"
+#include "exeray/etw/event_layouts.hpp"
+#include "exeray/etw/providers/guids.hpp"
+#include "exeray/etw/record_ring.hpp"
+#include "exeray/etw/replay_pacer.hpp"
 
+#include <algorithm>
+#include <array>
 #include <atomic>
-#include <cstdint>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
 
 namespace exeray::etw {
 
 namespace {
 
-/// @brief Get parent event ID based on event category.
-event::EventId get_parent_event(event::Correlator* correlator,
-                                 const ParsedEvent& parsed) {
-    if (correlator == nullptr) {
-        return event::INVALID_EVENT;
+constexpr std::size_t align8(std::size_t size) noexcept {
+    return (size + 7) & ~std::size_t{7};
+}
+
+/// @brief Bytes a record takes in the ring, every part 8-byte aligned.
+std::size_t staged_size(const EVENT_RECORD* record) {
+    std::size_t size = sizeof(event::Timestamp) + sizeof(EVENT_RECORD) +
+                       record->ExtendedDataCount * sizeof(EVENT_HEADER_EXTENDED_DATA_ITEM);
+    for (USHORT i = 0; i < record->ExtendedDataCount; ++i) {
+        size += align8(record->ExtendedData[i].DataSize);
     }
+    return size + record->UserDataLength;
+}
 
-    switch (parsed.category) {
-        case event::Category::Process:
-            // For process events, parent is the parent process's create event
-            return correlator->find_process_parent(parsed.payload.process.parent_pid);
+/**
+ * @brief Copy a record into the ring (ProcessTrace thread).
+ *
+ * Layout: [received][EVENT_RECORD][extended items][extended data...]
+ * [UserData]. The copied pointers are rewritten to point into the ring, so
+ * the consumer hands the staged bytes to the parsers as an EVENT_RECORD
+ * unchanged.
+ *
+ * @param received Callback entry time if sampled for latency, else 0.
+ */
+void stage_record(RecordRing& ring, const EVENT_RECORD* record, event::Timestamp received) {
+    auto* out = ring.begin_write(staged_size(record));
+    if (out == nullptr) {
+        return;  // Counted in RecordRing::overflows()
+    }
+    std::memcpy(out, &received, sizeof(received));
+    out += sizeof(received);
+    auto* staged = reinterpret_cast<EVENT_RECORD*>(out);
+    std::memcpy(staged, record, sizeof(EVENT_RECORD));
+
+    auto* items = reinterpret_cast<EVENT_HEADER_EXTENDED_DATA_ITEM*>(out + sizeof(EVENT_RECORD));
+    auto* data = reinterpret_cast<std::uint8_t*>(items + record->ExtendedDataCount);
+    for (USHORT i = 0; i < record->ExtendedDataCount; ++i) {
+        const auto& item = record->ExtendedData[i];
+        items[i] = item;
+        items[i].DataPtr = reinterpret_cast<ULONGLONG>(data);
+        std::memcpy(data, reinterpret_cast<const void*>(item.DataPtr), item.DataSize);
+        data += align8(item.DataSize);
+    }
+    staged->ExtendedData = record->ExtendedDataCount != 0 ? items : nullptr;
+    if (record->UserDataLength != 0) {
+        std::memcpy(data, record->UserData, record->UserDataLength);
+    }
+    staged->UserData = data;
+    ring.commit_write();
+}
 
-        case event::Category::Thread:
-            // For thread events, parent is the owning process
-            return correlator->find_thread_parent(parsed.payload.thread.process_id);
+/// @brief StackWalk_Event: EventTimeStamp, StackProcess and StackThread,
+/// then the return addresses, pointer-sized.
+constexpr std::size_t kStackWalkHeader = 16;
 
-        case event::Category::Memory:
-            // For memory events, parent is the process doing the allocation
-            return correlator->find_operation_parent(parsed.payload.memory.process_id);
+/// @brief Whether record is a classic kernel StackWalk event.
+bool is_stack_walk(const EVENT_RECORD* record) noexcept {
+    return IsEqualGUID(record->EventHeader.ProviderId, providers::KERNEL_STACK_WALK) &&
+           record->UserDataLength >= kStackWalkHeader;
+}
 
-        case event::Category::Image:
-            // For image load events, parent is the target process
-            return correlator->find_operation_parent(parsed.payload.image.process_id);
+/// @brief Process a StackWalk event was captured in (its header carries none).
+std::uint32_t stack_walk_process(const EVENT_RECORD* record) noexcept {
+    std::uint32_t pid = 0;
+    std::memcpy(&pid, static_cast<const std::uint8_t*>(record->UserData) + 8, sizeof(pid));
+    return pid;
+}
 
-        default:
-            return event::INVALID_EVENT;
+/// @brief Hand the frames of a StackWalk event to consume_stack().
+void process_stack_walk(ConsumerContext& ctx, const EVENT_RECORD* record) {
+    const auto* data = static_cast<const std::uint8_t*>(record->UserData);
+    std::uint64_t timestamp = 0;
+    std::memcpy(&timestamp, data, sizeof(timestamp));
+    const bool is64bit = (record->EventHeader.Flags & EVENT_HEADER_FLAG_64_BIT_HEADER) != 0;
+    const std::size_t ptr_size = is64bit ? 8 : 4;
+    const std::size_t count = (std::min)(
+        (record->UserDataLength - kStackWalkHeader) / ptr_size, event::StackTable::kMaxFrames);
+
+    std::array<std::uint64_t, event::StackTable::kMaxFrames> frames;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::uint64_t frame = 0;
+        std::memcpy(&frame, data + kStackWalkHeader + i * ptr_size, ptr_size);
+        frames[i] = frame;
     }
+    consume_stack(ctx, timestamp, std::span(frames.data(), count));
 }
 
-/// @brief Get PID and parent PID from parsed event for correlation.
-void get_correlation_pids(const ParsedEvent& parsed,
-                          uint32_t& pid, uint32_t& parent_pid) {
-    switch (parsed.category) {
-        case event::Category::Process:
-            pid = parsed.payload.process.pid;
-            parent_pid = parsed.payload.process.parent_pid;
-            break;
-        case event::Category::Thread:
-            pid = parsed.payload.thread.process_id;
-            parent_pid = 0;
-            break;
-        case event::Category::Memory:
-            pid = parsed.payload.memory.process_id;
-            parent_pid = 0;
-            break;
-        case event::Category::Image:
-            pid = parsed.payload.image.process_id;
-            parent_pid = 0;
-            break;
-        default:
-            pid = 0;
-            parent_pid = 0;
-            break;
+/// @brief Frames of the stack trace a manifest provider attached to the
+/// record (EVENT_ENABLE_PROPERTY_STACK_TRACE), empty if none.
+std::span<const std::uint64_t> record_stack(const EVENT_RECORD* record) noexcept {
+    for (USHORT i = 0; i < record->ExtendedDataCount; ++i) {
+        const auto& item = record->ExtendedData[i];
+        if (item.ExtType != EVENT_HEADER_EXT_TYPE_STACK_TRACE64 ||
+            item.DataSize < sizeof(EVENT_EXTENDED_ITEM_STACK_TRACE64)) {
+            continue;
+        }
+        const auto* trace =
+            reinterpret_cast<const EVENT_EXTENDED_ITEM_STACK_TRACE64*>(item.DataPtr);
+        const std::size_t count =
+            (item.DataSize - offsetof(EVENT_EXTENDED_ITEM_STACK_TRACE64, Address)) /
+            sizeof(ULONG64);
+        return {reinterpret_cast<const std::uint64_t*>(trace->Address), count};
+    }
+    return {};
+}
+
+/// @brief Parse, correlate and store one record.
+/// @param pressure Current pressure in percent, for load shedding.
+/// @param received Callback entry time if sampled for latency, else 0.
+void process_record(ConsumerContext* ctx, const EVENT_RECORD* record, std::uint8_t pressure,
+                    event::Timestamp received) {
+    if (is_stack_walk(record)) {
+        if (ctx->stacks != nullptr) {
+            process_stack_walk(*ctx, record);
+        }
+        return;
+    }
+
+    // Parse the event using the dispatcher; its strings still view the
+    // record and are interned only if the event is kept, and repeated
+    // script content is recognized by the context's cache; multi-part
+    // script blocks are gathered by its assembler. The result is returned
+    // straight into parsed (guaranteed elision), not assigned.
+    ParsedEvent parsed = [&] {
+        const DeferredStrings::Scope defer;
+        const ContentCache::Scope repeats(&ctx->content);
+        const ScriptAssembler::Scope parts(&ctx->scripts);
+        return dispatch_event(record, ctx->strings, ctx->muted.load(std::memory_order_relaxed),
+                              ctx->manifests);
+    }();
+    if (!parsed.valid) {
+        return;
+    }
+    if (ctx->stacks != nullptr && record->ExtendedDataCount != 0) {
+        parsed.stack = record_stack(record);
+    }
+    consume_parsed(*ctx, parsed, record->EventHeader.ThreadId, pressure, received);
+}
+
+/// @brief Whether record is a Kernel-Process start or stop; the event ID
+/// is compared first, so other records cost one compare.
+bool is_process_lifetime(const EVENT_RECORD* record) noexcept {
+    const auto id = record->EventHeader.EventDescriptor.Id;
+    return (id == ids::process::START || id == ids::process::STOP) &&
+           IsEqualGUID(record->EventHeader.ProviderId, providers::KERNEL_PROCESS);
+}
+
+/// @brief Add the process a member starts to the targets; drop members that exit.
+void follow_process(const EVENT_RECORD* record, TargetSet& targets) {
+    const auto id = record->EventHeader.EventDescriptor.Id;
+    const auto* layout =
+        layouts::select(layouts::kProcessStart, record->EventHeader.EventDescriptor.Version);
+    const auto* data = static_cast<const std::uint8_t*>(record->UserData);
+    const bool is64bit = (record->EventHeader.Flags & EVENT_HEADER_FLAG_64_BIT_HEADER) != 0;
+    const std::size_t ptr_size = is64bit ? 8 : 4;
+    if (layout == nullptr || data == nullptr ||
+        layout->parent_id.at(ptr_size) + sizeof(std::uint32_t) > record->UserDataLength) {
+        return;
+    }
+    // ProcessStop shares the leading UniqueProcessKey and ProcessId
+    std::uint32_t pid = 0;
+    std::memcpy(&pid, data + layout->process_id.at(ptr_size), sizeof(pid));
+    if (id == ids::process::STOP) {
+        targets.erase(pid);
+        return;
+    }
+    std::uint32_t parent = 0;
+    std::memcpy(&parent, data + layout->parent_id.at(ptr_size), sizeof(parent));
+    targets.adopt(parent, pid);
+}
+
+/// @brief Whether record is a Kernel-Process rundown of a target.
+///
+/// Rundowns are logged by the system on request, so the header carries
+/// the logger's PID; the process described is in the payload.
+bool is_target_rundown(const EVENT_RECORD* record, const TargetSet& targets) noexcept {
+    if (record->EventHeader.EventDescriptor.Id != ids::process::RUNDOWN ||
+        !IsEqualGUID(record->EventHeader.ProviderId, providers::KERNEL_PROCESS)) {
+        return false;
     }
+    const auto* layout =
+        layouts::select(layouts::kProcessRundown, record->EventHeader.EventDescriptor.Version);
+    const auto* data = static_cast<const std::uint8_t*>(record->UserData);
+    const bool is64bit = (record->EventHeader.Flags & EVENT_HEADER_FLAG_64_BIT_HEADER) != 0;
+    const std::size_t offset = layout != nullptr ? layout->process_id.at(is64bit ? 8 : 4) : 0;
+    if (layout == nullptr || data == nullptr ||
+        offset + sizeof(std::uint32_t) > record->UserDataLength) {
+        return false;
+    }
+    std::uint32_t pid = 0;
+    std::memcpy(&pid, data + offset, sizeof(pid));
+    return targets.contains(pid);
 }
 
 }  // anonymous namespace
@@ -92,52 +598,73 @@ void WINAPI event_record_callback(PEVENT_RECORD record) {
 
     auto* ctx = static_cast<ConsumerContext*>(record->UserContext);
 
-    // PID filter - only process events from target process
-    const uint32_t event_pid = record->EventHeader.ProcessId;
-    const uint32_t target = ctx->target_pid->load(std::memory_order_acquire);
-    
-    // If target_pid is 0, accept all events (no filter)
-    // Otherwise, only accept events from the target process
-    if (target != 0 && event_pid != target) {
-        return;
+    // PID filter - only events of the targets (and, when followed, their
+    // descendants); without a target set every event is kept. Membership is
+    // decided before following, so a member's own stop event is kept.
+    if (TargetSet* targets = ctx->targets) {
+        const bool member = targets->contains(
+            is_stack_walk(record) ? stack_walk_process(record) : record->EventHeader.ProcessId);
+        if (ctx->follow_children && is_process_lifetime(record)) [[unlikely]] {
+            // Before the child's first event, so none of it is dropped
+            follow_process(record, *targets);
+        }
+        if (!member && !is_target_rundown(record, *targets)) {
+            return;
+        }
     }
 
-    // Parse the event using the dispatcher
-    auto parsed = dispatch_event(record, ctx->strings);
-    if (!parsed.valid) {
-        return;
+    if (ctx->pacer != nullptr) {
+        ctx->pacer->pace(static_cast<std::uint64_t>(record->EventHeader.TimeStamp.QuadPart));
     }
 
-    // Determine parent event and correlation ID
-    event::EventId parent_event = event::INVALID_EVENT;
-    uint32_t correlation_id = 0;
+    event::Timestamp received = 0;
+    if (ctx->latency != nullptr && IngestLatency::due(ctx->delivered_tick)) {
+        received = IngestLatency::now();
+    }
 
-    if (ctx->correlator != nullptr) {
-        parent_event = get_parent_event(ctx->correlator, parsed);
+    // With a ring, only copy here; drain_records() does the rest
+    if (ctx->ring != nullptr) {
+        stage_record(*ctx->ring, record, received);
+        return;
+    }
+    process_record(ctx, record, ctx->pressure.load(std::memory_order_relaxed), received);
+}
 
-        uint32_t pid = 0;
-        uint32_t parent_pid = 0;
-        get_correlation_pids(parsed, pid, parent_pid);
-        correlation_id = ctx->correlator->get_correlation_id(pid, parent_pid);
+ULONG WINAPI buffer_callback(PEVENT_TRACE_LOGFILEW logfile) {
+    if (logfile != nullptr && logfile->Context != nullptr) {
+        auto& ctx = *static_cast<ConsumerContext*>(logfile->Context);
+        ctx.buffers_read.fetch_add(1, std::memory_order_relaxed);
+        // With a ring the pending batch belongs to the drain worker
+        if (ctx.ring == nullptr) {
+            flush_pending(ctx);
+        }
     }
+    return TRUE;
+}
 
-    // Push to the event graph
-    event::EventId event_id = ctx->graph->push(
-        parsed.category,
-        parsed.operation,
-        parsed.status,
-        parent_event,
-        correlation_id,
-        parsed.payload
-    );
-
-    // Register the event for future correlation lookups
-    if (ctx->correlator != nullptr && event_id != event::INVALID_EVENT) {
-        // For process create events, register the new process
-        if (parsed.category == event::Category::Process &&
-            parsed.operation == static_cast<uint8_t>(event::ProcessOp::Create)) {
-            ctx->correlator->register_process(parsed.payload.process.pid, event_id);
+void drain_records(ConsumerContext& ctx) {
+    // Records between pressure updates; the ring fill moves slowly
+    constexpr std::uint32_t kPressureInterval = 64;
+
+    RecordRing& ring = *ctx.ring;
+    std::uint32_t until_update = 0;
+    std::uint8_t pressure = 0;
+    while (ring.wait()) {
+        for (auto staged = ring.front(); !staged.empty(); staged = ring.front()) {
+            if (until_update-- == 0) {
+                pressure = (std::max)(ctx.pressure.load(std::memory_order_relaxed),
+                                      pressure_percent(ring.used(), ring.capacity()));
+                until_update = kPressureInterval - 1;
+            }
+            event::Timestamp received = 0;
+            std::memcpy(&received, staged.data(), sizeof(received));
+            process_record(&ctx,
+                           reinterpret_cast<const EVENT_RECORD*>(staged.data() + sizeof(received)),
+                           pressure, received);
+            ring.pop();
         }
+        // Caught up with ETW: publish the batch instead of waiting for more
+        flush_pending(ctx);
     }
 }
 
@@ -157,14 +684,16 @@ ULONG start_trace_processing(TRACEHANDLE trace_handle) {
 #else  // !_WIN32
 
 // Stub implementations for non-Windows platforms
-#include "exeray/etw/consumer.hpp"
-
 namespace exeray::etw {
 
 void event_record_callback(void* /*record*/) {
     // No-op on non-Windows
 }
 
+void drain_records(ConsumerContext& /*ctx*/) {
+    // No records are staged on non-Windows
+}
+
 unsigned long start_trace_processing(uint64_t /*trace_handle*/) {
     // Not supported on non-Windows
     return 0;
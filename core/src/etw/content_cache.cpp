@@ -0,0 +1,197 @@
+/// @file content_cache.cpp
+/// @brief Content hashing and the repeat cache (platform independent).
+
+#include "exeray/etw/content_cache.hpp"
+
+#include <bit>
+#include <cstring>
+
+namespace exeray::etw {
+
+namespace {
+
+thread_local ContentCache* active = nullptr;
+
+constexpr std::uint64_t kPrime32_1 = 0x9E3779B1ULL;
+constexpr std::uint64_t kPrime64_1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr std::uint64_t kPrime64_3 = 0x165667B19E3779F9ULL;
+
+/// Per-lane keys; any fixed values with well-mixed halves would do.
+constexpr std::array<std::uint64_t, 8> kKeys = {
+    0xBE4BA423396CFEB8ULL, 0x1CAD21F72C81017CULL, 0xDB979083E96DD4DEULL,
+    0x1F67B3B7A4A44072ULL, 0x78E5C0CC4EE679CBULL, 0x2172FFCC7DD05A82ULL,
+    0x8E2443F7744608B8ULL, 0x4C263A81E69035E0ULL,
+};
+
+constexpr std::size_t kStripe = 64;
+constexpr std::size_t kStripesPerScramble = 16;
+
+std::uint64_t read64(const std::uint8_t* p) noexcept {
+    std::uint64_t value = 0;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+std::uint64_t fold_word(std::uint64_t hash, std::uint64_t word, std::uint64_t key) noexcept {
+    const std::uint64_t keyed = word ^ key;
+    hash ^= (keyed & 0xFFFFFFFFULL) * (keyed >> 32) + word;
+    return std::rotl(hash, 27) * kPrime64_1 + kPrime64_3;
+}
+
+std::uint64_t avalanche(std::uint64_t hash) noexcept {
+    hash ^= hash >> 37;
+    hash *= 0x165667919E3779F9ULL;
+    return hash ^ (hash >> 32);
+}
+
+/// @brief One stripe into the eight lanes; written lane-parallel so that it
+/// compiles to packed 32x32->64 multiplies.
+void accumulate(std::array<std::uint64_t, 8>& acc, const std::uint8_t* stripe) noexcept {
+    for (std::size_t i = 0; i < 8; ++i) {
+        const std::uint64_t lane = read64(stripe + 8 * i);
+        const std::uint64_t keyed = lane ^ kKeys[i];
+        acc[i ^ 1] += lane;
+        acc[i] += (keyed & 0xFFFFFFFFULL) * (keyed >> 32);
+    }
+}
+
+void scramble(std::array<std::uint64_t, 8>& acc) noexcept {
+    for (std::size_t i = 0; i < 8; ++i) {
+        acc[i] = (acc[i] ^ (acc[i] >> 47) ^ kKeys[i]) * kPrime32_1;
+    }
+}
+
+std::uint64_t hash_short(const std::uint8_t* p, std::size_t size) noexcept {
+    std::uint64_t hash = size * kPrime64_1;
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        hash = fold_word(hash, read64(p + i), kKeys[(i / 8) % 8]);
+    }
+    if (i < size) {
+        std::uint64_t tail = 0;
+        std::memcpy(&tail, p + i, size - i);
+        hash = fold_word(hash, tail, kKeys[7] ^ (size - i));
+    }
+    return avalanche(hash);
+}
+
+}  // namespace
+
+std::uint64_t content_hash(const void* data, std::size_t size) noexcept {
+    const auto* p = static_cast<const std::uint8_t*>(data);
+    if (size < kStripe) {
+        return hash_short(p, size);
+    }
+
+    std::array<std::uint64_t, 8> acc = {kPrime32_1, kPrime64_1, kPrime64_2, kPrime64_3,
+                                        kPrime64_1 ^ kPrime64_2, kPrime32_1 << 32,
+                                        kPrime64_3 ^ kPrime64_1, kPrime64_2 >> 1};
+    const std::size_t stripes = size / kStripe;
+    for (std::size_t s = 0; s < stripes; ++s) {
+        accumulate(acc, p + s * kStripe);
+        if ((s + 1) % kStripesPerScramble == 0) {
+            scramble(acc);
+        }
+    }
+    if (size % kStripe != 0) {
+        accumulate(acc, p + size - kStripe);  // Overlaps the last full stripe
+    }
+
+    std::uint64_t hash = size * kPrime64_1;
+    for (std::size_t i = 0; i < 8; ++i) {
+        hash = fold_word(hash, acc[i], kKeys[(i + 1) % 8]);
+    }
+    return avalanche(hash);
+}
+
+ContentCache::Scope::Scope(ContentCache* cache) noexcept : previous_(active) {
+    active = cache;
+}
+
+ContentCache::Scope::~Scope() {
+    active = previous_;
+}
+
+ContentCache::ContentCache() noexcept {
+    buckets_.fill(kNil);
+}
+
+ContentCache* ContentCache::current() noexcept {
+    return active;
+}
+
+ContentCache::Entry* ContentCache::find(std::uint64_t hash, std::uint32_t size) noexcept {
+    for (std::uint16_t node = buckets_[bucket_of(hash)]; node != kNil; node = nodes_[node].chain) {
+        Entry& entry = nodes_[node].entry;
+        if (entry.hash == hash && entry.size == size) {
+            unlink(node);
+            push_front(node);
+            ++entry.repeats;
+            ++hits_;
+            return &entry;
+        }
+    }
+    ++misses_;
+    return nullptr;
+}
+
+ContentCache::Entry& ContentCache::insert(std::uint64_t hash, std::uint32_t size,
+                                          std::uint64_t verdict) noexcept {
+    std::uint16_t node = kNil;
+    if (used_ < kCapacity) {
+        node = static_cast<std::uint16_t>(used_++);
+    } else {
+        node = tail_;
+        unlink(node);
+        unchain(node);
+    }
+
+    Node& slot = nodes_[node];
+    slot.entry = Entry{hash, size, 0, verdict, event::INVALID_STRING};
+    std::uint16_t& bucket = buckets_[bucket_of(hash)];
+    slot.chain = bucket;
+    bucket = node;
+    push_front(node);
+    return slot.entry;
+}
+
+void ContentCache::clear() noexcept {
+    buckets_.fill(kNil);
+    head_ = kNil;
+    tail_ = kNil;
+    used_ = 0;
+    hits_ = 0;
+    misses_ = 0;
+}
+
+void ContentCache::unlink(std::uint16_t node) noexcept {
+    Node& n = nodes_[node];
+    (n.newer != kNil ? nodes_[n.newer].older : head_) = n.older;
+    (n.older != kNil ? nodes_[n.older].newer : tail_) = n.newer;
+    n.newer = kNil;
+    n.older = kNil;
+}
+
+void ContentCache::push_front(std::uint16_t node) noexcept {
+    Node& n = nodes_[node];
+    n.newer = kNil;
+    n.older = head_;
+    if (head_ != kNil) {
+        nodes_[head_].newer = node;
+    }
+    head_ = node;
+    if (tail_ == kNil) {
+        tail_ = node;
+    }
+}
+
+void ContentCache::unchain(std::uint16_t node) noexcept {
+    std::uint16_t* link = &buckets_[bucket_of(nodes_[node].entry.hash)];
+    while (*link != node) {
+        link = &nodes_[*link].chain;
+    }
+    *link = nodes_[node].chain;
+}
+
+}  // namespace exeray::etw
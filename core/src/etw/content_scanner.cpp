@@ -0,0 +1,393 @@
+/// @file content_scanner.cpp
+/// @brief Signature scanning of AMSI and script content off the ingest path.
+
+#include "exeray/etw/content_scanner.hpp"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "exeray/etw/content_cache.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/string_pool.hpp"
+
+namespace exeray::etw {
+
+namespace {
+
+std::uint8_t fold(std::uint8_t byte) noexcept {
+    return (byte >= 'A' && byte <= 'Z') ? static_cast<std::uint8_t>(byte - 'A' + 'a') : byte;
+}
+
+/// @brief Content of an AMSI or script event (INVALID_STRING for others).
+event::StringId content_of(const event::EventPayload& payload) noexcept {
+    switch (payload.category) {
+        case event::Category::Amsi:
+            return payload.amsi.content;
+        case event::Category::Script:
+            return payload.script.script_block;
+        default:
+            return event::INVALID_STRING;
+    }
+}
+
+}  // namespace
+
+// ============================================================================
+// SignatureSet
+// ============================================================================
+
+SignatureSet::SignatureSet(const std::vector<ContentSignature>& signatures) {
+    // Distinct folded strings, each one pattern shared by its signatures
+    std::unordered_map<std::string, std::uint32_t> ids;
+    std::vector<std::string> patterns;
+    for (std::size_t s = 0; s < signatures.size(); ++s) {
+        std::vector<std::uint32_t> own;
+        for (const std::string& text : signatures[s].strings) {
+            if (text.empty()) {
+                continue;
+            }
+            std::string folded(text);
+            for (char& c : folded) {
+                c = static_cast<char>(fold(static_cast<std::uint8_t>(c)));
+            }
+            const auto [it, inserted] =
+                ids.try_emplace(folded, static_cast<std::uint32_t>(patterns.size()));
+            if (inserted) {
+                patterns.push_back(std::move(folded));
+                users_.emplace_back();
+            }
+            if (std::find(own.begin(), own.end(), it->second) == own.end()) {
+                own.push_back(it->second);
+                users_[it->second].push_back(static_cast<std::uint32_t>(s));
+            }
+        }
+        const std::size_t wanted = signatures[s].min_matches == 0
+                                       ? own.size()
+                                       : (std::min)(signatures[s].min_matches, own.size());
+        // A signature without strings never matches
+        required_.push_back(own.empty() ? kNone : static_cast<std::uint32_t>(wanted));
+    }
+
+    // Character classes: 0 for bytes no pattern contains, upper case
+    // sharing the class of lower case
+    std::array<std::uint16_t, 256> classes{};
+    for (const std::string& pattern : patterns) {
+        for (const char c : pattern) {
+            const auto byte = static_cast<std::uint8_t>(c);
+            if (classes[byte] == 0) {
+                classes[byte] = static_cast<std::uint16_t>(classes_++);
+            }
+        }
+    }
+    for (std::size_t byte = 0; byte < classes.size(); ++byte) {
+        class_of_[byte] = classes[fold(static_cast<std::uint8_t>(byte))];
+    }
+
+    // Trie; a 0 transition means none yet (the root is nobody's child)
+    next_.assign(classes_, 0);
+    pattern_.assign(1, kNone);
+    for (std::uint32_t id = 0; id < patterns.size(); ++id) {
+        std::uint32_t state = 0;
+        for (const char c : patterns[id]) {
+            const std::size_t slot = state * classes_ + class_of_[static_cast<std::uint8_t>(c)];
+            if (next_[slot] == 0) {
+                next_[slot] = static_cast<std::uint32_t>(pattern_.size());
+                next_.resize(next_.size() + classes_, 0);
+                pattern_.push_back(kNone);
+            }
+            state = next_[slot];
+        }
+        pattern_[state] = id;
+    }
+
+    // Failure links in breadth-first order, folded into the transitions;
+    // output_ chains the suffixes that end a pattern
+    const std::size_t states = pattern_.size();
+    std::vector<std::uint32_t> fail(states, 0);
+    output_.assign(states, 0);
+    std::vector<std::uint32_t> queue;
+    queue.reserve(states);
+    for (std::size_t cls = 0; cls < classes_; ++cls) {
+        if (next_[cls] != 0) {
+            queue.push_back(next_[cls]);
+        }
+    }
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        const std::uint32_t state = queue[head];
+        for (std::size_t cls = 0; cls < classes_; ++cls) {
+            std::uint32_t& target = next_[state * classes_ + cls];
+            const std::uint32_t fallback = next_[fail[state] * classes_ + cls];
+            if (target == 0) {
+                target = fallback;
+                continue;
+            }
+            fail[target] = fallback;
+            output_[target] = pattern_[fallback] != kNone ? fallback : output_[fallback];
+            queue.push_back(target);
+        }
+    }
+}
+
+std::vector<std::uint32_t> SignatureSet::match(std::string_view text) const {
+    std::vector<std::uint32_t> result;
+    if (empty()) {
+        return result;
+    }
+    std::vector<bool> seen(users_.size(), false);
+    std::vector<std::uint32_t> hits(required_.size(), 0);
+    std::uint32_t state = 0;
+    for (const char c : text) {
+        state = next_[state * classes_ + class_of_[static_cast<std::uint8_t>(c)]];
+        std::uint32_t ending = pattern_[state] != kNone ? state : output_[state];
+        for (; ending != 0; ending = output_[ending]) {
+            const std::uint32_t pattern = pattern_[ending];
+            if (seen[pattern]) {
+                continue;
+            }
+            seen[pattern] = true;
+            for (const std::uint32_t signature : users_[pattern]) {
+                ++hits[signature];
+            }
+        }
+    }
+    for (std::uint32_t s = 0; s < required_.size(); ++s) {
+        if (hits[s] >= required_[s]) {
+            result.push_back(s);
+        }
+    }
+    return result;
+}
+
+// ============================================================================
+// ContentScanner
+// ============================================================================
+
+ContentScanner::ContentScanner(const ContentScanConfig& config)
+    : config_(config), signatures_(config.signatures) {}
+
+ContentScanner::~ContentScanner() {
+    stop();
+}
+
+void ContentScanner::start(event::EventGraph& graph, const event::StringPool& strings,
+                           event::ExtensionStore& extensions, Submit submit) {
+    stop();
+    graph_ = &graph;
+    strings_ = &strings;
+    extensions_ = &extensions;
+    submit_ = std::move(submit);
+    // StringIds and ExtensionIds belong to the session's pools; verdicts
+    // by hash stay
+    for (ContentShard& shard : contents_) {
+        const std::lock_guard lock(shard.mutex);
+        shard.contents.clear();
+    }
+    seen_.store(0, std::memory_order_relaxed);
+    scanned_.store(0, std::memory_order_relaxed);
+    cached_.store(0, std::memory_order_relaxed);
+    matched_.store(0, std::memory_order_relaxed);
+    skipped_.store(0, std::memory_order_relaxed);
+    attached_.store(0, std::memory_order_relaxed);
+    backfilled_.store(0, std::memory_order_relaxed);
+    running_.store(true, std::memory_order_release);
+}
+
+bool ContentScanner::attach(event::EventPayload& payload) {
+    const event::StringId content = content_of(payload);
+    if (!running() || signatures_.empty() || content == event::INVALID_STRING) {
+        return false;
+    }
+    ContentShard& shard = contents_[content % kShards];
+    {
+        const std::lock_guard lock(shard.mutex);
+        const auto [it, inserted] = shard.contents.try_emplace(content);
+        if (!inserted) {
+            const Known& known = it->second;
+            if (known.scanned && known.extension != event::NO_EXTENSION &&
+                payload.extension == event::NO_EXTENSION) {
+                payload.extension = known.extension;
+                attached_.fetch_add(1, std::memory_order_relaxed);
+            }
+            return known.matched;
+        }
+    }
+    seen_.fetch_add(1, std::memory_order_relaxed);
+
+    // The length prefix only: the content itself is read by the worker
+    const std::size_t size = strings_->get(content).size();
+    {
+        const std::lock_guard lock(mutex_);
+        if (queued_bytes_ + size <= config_.memory_budget) {
+            queue_.push_back({content, size});
+            queued_bytes_ += size;
+            if (active_ < (std::max)(config_.workers, std::size_t{1})) {
+                ++active_;
+                submit_([this] { run(); });
+            }
+            return false;
+        }
+    }
+    // Over budget: forgotten, so a later event of it may be queued
+    skipped_.fetch_add(1, std::memory_order_relaxed);
+    const std::lock_guard lock(shard.mutex);
+    shard.contents.erase(content);
+    return false;
+}
+
+void ContentScanner::run() {
+    for (;;) {
+        while (scan_batch()) {
+        }
+        // Re-checked under the lock attach() queues under, so no content
+        // queued before the worker leaves is left behind
+        const std::lock_guard lock(mutex_);
+        if (queue_.empty()) {
+            --active_;
+            idle_.notify_all();
+            return;
+        }
+    }
+}
+
+bool ContentScanner::scan_batch() {
+    std::vector<Queued> batch;
+    {
+        const std::lock_guard lock(mutex_);
+        const std::size_t n = (std::min)(queue_.size(), kBatch);
+        batch.assign(queue_.begin(), queue_.begin() + static_cast<std::ptrdiff_t>(n));
+        queue_.erase(queue_.begin(), queue_.begin() + static_cast<std::ptrdiff_t>(n));
+    }
+    if (batch.empty()) {
+        return false;
+    }
+
+    std::unordered_map<event::StringId, Known> resolved;
+    std::string buffer;
+    for (const Queued& queued : batch) {
+        const event::ContentVerdictExtension verdict =
+            scan(strings_->read(queued.content, buffer));
+        Known known;
+        known.extension = extensions_->append(event::ExtensionKind::ContentVerdict, verdict);
+        known.scanned = true;
+        known.matched = verdict.matches != 0;
+        if (known.matched) {
+            matched_.fetch_add(1, std::memory_order_relaxed);
+        }
+        {
+            ContentShard& shard = contents_[queued.content % kShards];
+            const std::lock_guard lock(shard.mutex);
+            shard.contents[queued.content] = known;
+        }
+        resolved.emplace(queued.content, known);
+    }
+    {
+        const std::lock_guard lock(mutex_);
+        for (const Queued& queued : batch) {
+            queued_bytes_ -= queued.size;
+        }
+    }
+    backfill(resolved);
+    return true;
+}
+
+event::ContentVerdictExtension ContentScanner::scan(std::string_view text) {
+    const std::uint64_t hash = content_hash(text.data(), text.size());
+    const std::uint64_t key = hash ^ (text.size() * 0x9E3779B97F4A7C15ULL);
+    {
+        const std::lock_guard lock(verdicts_mutex_);
+        if (const auto it = verdicts_.find(key); it != verdicts_.end()) {
+            cached_.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+
+    const std::vector<std::uint32_t> matches = signatures_.match(text);
+    event::ContentVerdictExtension verdict{};
+    verdict.hash = hash;
+    verdict.matches = static_cast<std::uint32_t>(matches.size());
+    verdict.first = matches.empty() ? UINT32_MAX : matches.front();
+    for (const std::uint32_t signature : matches) {
+        if (signature < 64) {
+            verdict.signatures |= std::uint64_t{1} << signature;
+        }
+    }
+    scanned_.fetch_add(1, std::memory_order_relaxed);
+
+    const std::lock_guard lock(verdicts_mutex_);
+    if (verdicts_.size() >= kMaxVerdicts) {
+        verdicts_.clear();
+    }
+    verdicts_[key] = verdict;
+    return verdict;
+}
+
+void ContentScanner::backfill(const std::unordered_map<event::StringId, Known>& resolved) {
+    if (resolved.empty()) {
+        return;
+    }
+    std::uint64_t backfilled = 0;
+    const auto visit = [&](event::EventView view) {
+        const event::EventPayload payload = view.payload();
+        const auto it = resolved.find(content_of(payload));
+        if (it == resolved.end()) {
+            return;
+        }
+        if (it->second.matched && view.status() != event::Status::Suspicious) {
+            graph_->set_status(view.id(), event::Status::Suspicious);
+        }
+        if (payload.extension == event::NO_EXTENSION &&
+            it->second.extension != event::NO_EXTENSION &&
+            graph_->set_extension(view.id(), it->second.extension)) {
+            ++backfilled;
+        }
+    };
+    graph_->for_each_category(event::Category::Amsi, visit);
+    graph_->for_each_category(event::Category::Script, visit);
+    backfilled_.fetch_add(backfilled, std::memory_order_relaxed);
+}
+
+void ContentScanner::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    {
+        std::unique_lock lock(mutex_);
+        idle_.wait(lock, [this] { return active_ == 0; });
+    }
+    while (scan_batch()) {
+    }
+
+    // Events pushed after their content's batch was backfilled
+    std::unordered_map<event::StringId, Known> resolved;
+    for (const ContentShard& shard : contents_) {
+        const std::lock_guard lock(shard.mutex);
+        for (const auto& [content, known] : shard.contents) {
+            if (known.scanned) {
+                resolved.emplace(content, known);
+            }
+        }
+    }
+    backfill(resolved);
+}
+
+event::ExtensionId ContentScanner::verdict(event::StringId content) const {
+    const ContentShard& shard = contents_[content % kShards];
+    const std::lock_guard lock(shard.mutex);
+    const auto it = shard.contents.find(content);
+    return it != shard.contents.end() ? it->second.extension : event::NO_EXTENSION;
+}
+
+ContentScanStats ContentScanner::stats() const noexcept {
+    ContentScanStats stats;
+    stats.contents = seen_.load(std::memory_order_relaxed);
+    stats.scanned = scanned_.load(std::memory_order_relaxed);
+    stats.cached = cached_.load(std::memory_order_relaxed);
+    stats.matched = matched_.load(std::memory_order_relaxed);
+    stats.skipped = skipped_.load(std::memory_order_relaxed);
+    stats.attached = attached_.load(std::memory_order_relaxed);
+    stats.backfilled = backfilled_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}  // namespace exeray::etw
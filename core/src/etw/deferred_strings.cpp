@@ -0,0 +1,103 @@
+/// @file deferred_strings.cpp
+/// @brief DeferredStrings and RecentStrings implementation (platform independent).
+
+#include "exeray/etw/deferred_strings.hpp"
+
+#include <cstring>
+#include <functional>
+
+#include "exeray/event/string_pool.hpp"
+
+namespace exeray::etw {
+
+namespace {
+
+thread_local bool deferring = false;
+
+std::size_t char_size(StringKind kind) noexcept {
+    return kind == StringKind::Utf8 ? sizeof(char) : sizeof(wchar_t);
+}
+
+event::StringId intern_now(event::StringPool& pool, StringKind kind, const void* data,
+                           std::size_t length) {
+    switch (kind) {
+        case StringKind::Utf8:
+            return pool.intern({static_cast<const char*>(data), length});
+        case StringKind::Wide:
+            return pool.intern_wide({static_cast<const wchar_t*>(data), length});
+        case StringKind::WidePath:
+            return pool.intern_path_wide({static_cast<const wchar_t*>(data), length});
+    }
+    return event::INVALID_STRING;
+}
+
+}  // namespace
+
+event::StringId RecentStrings::intern(event::StringPool& pool, StringKind kind,
+                                      const void* data, std::size_t length) {
+    if (pool_ != &pool) {
+        slots_ = {};
+        pool_ = &pool;
+    }
+    const std::string_view bytes(static_cast<const char*>(data), length * char_size(kind));
+    const std::uint64_t hash = std::hash<std::string_view>{}(bytes);
+    for (const Slot& slot : slots_) {
+        if (slot.id != event::INVALID_STRING && slot.hash == hash && slot.kind == kind &&
+            slot.bytes == bytes) {
+            ++hits_;
+            return slot.id;
+        }
+    }
+
+    ++misses_;
+    const event::StringId id = intern_now(pool, kind, data, length);
+    if (id != event::INVALID_STRING) {
+        Slot& slot = slots_[next_];
+        next_ = (next_ + 1) % kSlots;
+        slot.hash = hash;
+        slot.kind = kind;
+        slot.id = id;
+        slot.bytes.assign(bytes);  // Reuses the slot's capacity
+    }
+    return id;
+}
+
+DeferredStrings::Scope::Scope() noexcept : previous_(deferring) {
+    deferring = true;
+}
+
+DeferredStrings::Scope::~Scope() {
+    deferring = previous_;
+}
+
+bool DeferredStrings::active() noexcept {
+    return deferring;
+}
+
+bool DeferredStrings::add(const event::EventPayload& payload, const event::StringId& field,
+                          StringKind kind, const void* data, std::size_t length) noexcept {
+    const auto* base = reinterpret_cast<const std::byte*>(&payload);
+    const auto* at = reinterpret_cast<const std::byte*>(&field);
+    if (count_ == kMaxStrings || at < base ||
+        at + sizeof(event::StringId) > base + sizeof(event::EventPayload) ||
+        length > UINT32_MAX) {
+        return false;
+    }
+    entries_[count_++] = {data, static_cast<std::uint32_t>(length),
+                          static_cast<std::uint16_t>(at - base), kind};
+    return true;
+}
+
+void DeferredStrings::commit(event::EventPayload& payload, event::StringPool& pool,
+                             RecentStrings* recent) {
+    for (std::size_t i = 0; i < count_; ++i) {
+        const Entry& entry = entries_[i];
+        const event::StringId id = recent != nullptr
+            ? recent->intern(pool, entry.kind, entry.data, entry.length)
+            : intern_now(pool, entry.kind, entry.data, entry.length);
+        std::memcpy(reinterpret_cast<std::byte*>(&payload) + entry.offset, &id, sizeof(id));
+    }
+    count_ = 0;
+}
+
+}  // namespace exeray::etw
@@ -0,0 +1,930 @@
+/// @file detection_rules.cpp
+/// @brief Detection rule parsing and evaluation (platform independent).
+
+#include "exeray/etw/detection_rules.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "exeray/etw/regex_dfa.hpp"
+#include "exeray/etw/text_search.hpp"
+#include "exeray/event/payload_fields.hpp"
+#include "exeray/event/string_pool.hpp"
+#include "exeray/logging.hpp"
+
+namespace exeray::etw {
+
+namespace {
+
+using event::Category;
+using event::EventPayload;
+
+using Field = event::PayloadField;
+
+constexpr char fold(char c) noexcept {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool equal_icase(std::string_view a, std::string_view b) noexcept {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(),
+                      [](char x, char y) { return fold(x) == fold(y); });
+}
+
+const Field* find_field(Category category, std::string_view name) noexcept {
+    for (const Field& field : event::payload_fields()) {
+        if (field.category == category && field.name == name) {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+/// @brief Field of the process an event acts on, which keys sequences.
+const Field* target_field(Category category) noexcept {
+    switch (category) {
+    case Category::Process:
+        return find_field(category, "pid");
+    case Category::Image:
+    case Category::Thread:
+    case Category::Memory:
+    case Category::Security:
+        return find_field(category, "process_id");
+    default:
+        return nullptr;
+    }
+}
+
+std::optional<Category> find_category(std::string_view name) noexcept {
+    for (std::size_t i = 0; i < static_cast<std::size_t>(Category::Count); ++i) {
+        if (equal_icase(event::category_name(static_cast<Category>(i)), name)) {
+            return static_cast<Category>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+/// @brief Why a predicate cannot apply to a field (nullptr if it can).
+const char* check_predicate(const Field& field, RuleOp op) noexcept {
+    const bool ordering = op == RuleOp::Less || op == RuleOp::LessEqual ||
+                          op == RuleOp::Greater || op == RuleOp::GreaterEqual;
+    const bool textual = op == RuleOp::Contains || op == RuleOp::StartsWith ||
+                         op == RuleOp::EndsWith || op == RuleOp::Matches;
+    if (field.is_string && ordering) {
+        return "string fields support == != contains startswith endswith matches";
+    }
+    if (!field.is_string && textual) {
+        return "numeric fields support == != < <= > >=";
+    }
+    return nullptr;
+}
+
+std::uint64_t read_number(const EventPayload& payload, const Field& field) noexcept {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(&payload) + field.offset;
+    switch (field.size) {
+    case 1:
+        return *bytes;
+    case 2: {
+        std::uint16_t value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+    case 4: {
+        std::uint32_t value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+    default: {
+        std::uint64_t value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+    }
+}
+
+std::string_view read_string(const EventPayload& payload, const Field& field,
+                             const event::StringPool& strings) noexcept {
+    return strings.get(static_cast<event::StringId>(read_number(payload, field)));
+}
+
+/// @brief Count key of a group_by value: the number, or a hash of the folded string.
+std::uint64_t group_key(const EventPayload& payload, const Field& field,
+                        const event::StringPool& strings) noexcept {
+    if (!field.is_string) {
+        return read_number(payload, field);
+    }
+    std::uint64_t hash = 14695981039346656037ULL;  // FNV-1a
+    for (const char c : read_string(payload, field, strings)) {
+        hash = (hash ^ static_cast<unsigned char>(fold(c))) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// ---------------------------------------------------------------------------
+// Text form
+// ---------------------------------------------------------------------------
+
+struct Token {
+    enum class Kind : std::uint8_t { End, Word, Quoted, Symbol } kind = Kind::End;
+    std::string text;
+};
+
+/// @brief Splits one line into words, quoted strings and operator symbols.
+class Lexer {
+public:
+    explicit Lexer(std::string_view line) noexcept : line_(line) {}
+
+    /// @return false on an unterminated string.
+    bool next(Token& token) {
+        token = Token{};
+        while (pos_ < line_.size() && (line_[pos_] == ' ' || line_[pos_] == '\t')) {
+            ++pos_;
+        }
+        if (pos_ == line_.size() || line_[pos_] == '#') {
+            return true;
+        }
+        const char c = line_[pos_];
+        if (c == '"') {
+            token.kind = Token::Kind::Quoted;
+            for (++pos_; pos_ < line_.size(); ++pos_) {
+                if (line_[pos_] == '"') {
+                    ++pos_;
+                    return true;
+                }
+                if (line_[pos_] == '\\' && pos_ + 1 < line_.size()) {
+                    ++pos_;
+                }
+                token.text += line_[pos_];
+            }
+            return false;
+        }
+        if (is_symbol(c)) {
+            token.kind = Token::Kind::Symbol;
+            token.text += line_[pos_++];
+            // Two-character operators: == != <= >=
+            if (pos_ < line_.size() && line_[pos_] == '=' && c != ':' && c != '/') {
+                token.text += line_[pos_++];
+            }
+            return true;
+        }
+        token.kind = Token::Kind::Word;
+        while (pos_ < line_.size() && line_[pos_] != ' ' && line_[pos_] != '\t' &&
+               line_[pos_] != '"' && line_[pos_] != '#' && !is_symbol(line_[pos_])) {
+            token.text += line_[pos_++];
+        }
+        return true;
+    }
+
+private:
+    static constexpr bool is_symbol(char c) noexcept {
+        return c == ':' || c == '/' || c == '=' || c == '!' || c == '<' || c == '>';
+    }
+
+    std::string_view line_;
+    std::size_t pos_ = 0;
+};
+
+std::optional<std::uint64_t> parse_number(std::string_view text) noexcept {
+    int base = 10;
+    if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        text.remove_prefix(2);
+        base = 16;
+    }
+    std::uint64_t value = 0;
+    const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value, base);
+    if (ec != std::errc{} || end != text.data() + text.size() || text.empty()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::optional<std::uint64_t> parse_duration_ns(std::string_view text) noexcept {
+    std::uint64_t unit = 0;
+    if (text.ends_with("ms")) {
+        unit = 1'000'000;
+        text.remove_suffix(2);
+    } else if (text.ends_with("s")) {
+        unit = 1'000'000'000;
+        text.remove_suffix(1);
+    } else if (text.ends_with("m")) {
+        unit = 60'000'000'000;
+        text.remove_suffix(1);
+    } else {
+        return std::nullopt;
+    }
+    const auto value = parse_number(text);
+    if (!value || *value > UINT64_MAX / unit) {
+        return std::nullopt;
+    }
+    return *value * unit;
+}
+
+std::optional<RuleOp> parse_op(const Token& token) noexcept {
+    constexpr std::pair<std::string_view, RuleOp> kOps[] = {
+        {"==", RuleOp::Equal},        {"!=", RuleOp::NotEqual},
+        {"<", RuleOp::Less},          {"<=", RuleOp::LessEqual},
+        {">", RuleOp::Greater},       {">=", RuleOp::GreaterEqual},
+        {"contains", RuleOp::Contains}, {"startswith", RuleOp::StartsWith},
+        {"endswith", RuleOp::EndsWith}, {"matches", RuleOp::Matches},
+    };
+    if (token.kind != Token::Kind::Symbol && token.kind != Token::Kind::Word) {
+        return std::nullopt;
+    }
+    for (const auto& [text, op] : kOps) {
+        if (token.text == text) {
+            return op;
+        }
+    }
+    return std::nullopt;
+}
+
+/// @brief Recursive-descent parser of one rule line.
+class RuleParser {
+public:
+    explicit RuleParser(std::string_view line) noexcept : lexer_(line) {}
+
+    /// @brief Parse the line into rule.
+    /// @return nullptr on success, else the reason.
+    const char* parse(DetectionRule& rule) {
+        if (!advance() || !is_word("rule")) {
+            return "expected 'rule'";
+        }
+        if (!advance() || token_.kind != Token::Kind::Word) {
+            return "expected a rule name";
+        }
+        rule.name = token_.text;
+        if (!advance()) {
+            return "unterminated string";
+        }
+        if (is_word("tag")) {
+            if (!advance() || token_.kind != Token::Kind::Word) {
+                return "expected a tag after 'tag'";
+            }
+            rule.tag = token_.text;
+            if (!advance()) {
+                return "unterminated string";
+            }
+        }
+        if (!is_symbol(":")) {
+            return "expected ':' after the rule name";
+        }
+        if (!advance()) {
+            return "unterminated string";
+        }
+        if (const char* reason = step(rule.category, rule.operation, rule.predicates)) {
+            return reason;
+        }
+
+        while (is_word("then")) {
+            RuleStep next;
+            if (!advance()) {
+                return "unterminated string";
+            }
+            if (const char* reason = step(next.category, next.operation, next.predicates)) {
+                return reason;
+            }
+            if (target_field(rule.category) == nullptr || target_field(next.category) == nullptr) {
+                return "sequence steps need a category with a process ID";
+            }
+            rule.then.push_back(std::move(next));
+        }
+        if (!rule.then.empty()) {
+            if (is_word("within")) {
+                if (const char* reason = duration(rule.window_ns)) {
+                    return reason;
+                }
+            }
+        } else if (is_word("count")) {
+            if (const char* reason = count(rule)) {
+                return reason;
+            }
+        }
+
+        if (token_.kind != Token::Kind::End) {
+            return "unexpected text at the end of the rule";
+        }
+        return nullptr;
+    }
+
+private:
+    bool advance() { return lexer_.next(token_); }
+
+    [[nodiscard]] bool is_word(std::string_view word) const noexcept {
+        return token_.kind == Token::Kind::Word && token_.text == word;
+    }
+
+    [[nodiscard]] bool is_symbol(std::string_view symbol) const noexcept {
+        return token_.kind == Token::Kind::Symbol && token_.text == symbol;
+    }
+
+    /// @brief `<Category>[/<operation>] [where <predicate> [and ...]]`
+    const char* step(Category& category, std::uint16_t& operation,
+                     std::vector<RulePredicate>& predicates) {
+        if (token_.kind != Token::Kind::Word) {
+            return "expected a category";
+        }
+        const auto found = find_category(token_.text);
+        if (!found) {
+            return "unknown category";
+        }
+        category = *found;
+        if (!advance()) {
+            return "unterminated string";
+        }
+        if (is_symbol("/")) {
+            const auto code = advance() && token_.kind == Token::Kind::Word
+                ? parse_number(token_.text) : std::nullopt;
+            if (!code || *code > 0xFF) {
+                return "expected an operation code from 0 to 255";
+            }
+            operation = static_cast<std::uint16_t>(*code);
+            if (!advance()) {
+                return "unterminated string";
+            }
+        }
+        if (!is_word("where")) {
+            return nullptr;
+        }
+        do {
+            if (const char* reason = predicate(category, predicates.emplace_back())) {
+                return reason;
+            }
+        } while (is_word("and"));
+        return nullptr;
+    }
+
+    /// @brief `<field> <op> <operand>`, leaving the next token current.
+    const char* predicate(Category category, RulePredicate& predicate) {
+        if (!advance() || token_.kind != Token::Kind::Word) {
+            return "expected a field name";
+        }
+        const Field* field = find_field(category, token_.text);
+        if (field == nullptr) {
+            return "unknown field for this category";
+        }
+        predicate.field = token_.text;
+        const auto op = advance() ? parse_op(token_) : std::nullopt;
+        if (!op) {
+            return "expected a comparison";
+        }
+        if (const char* reason = check_predicate(*field, *op)) {
+            return reason;
+        }
+        predicate.op = *op;
+        if (!advance()) {
+            return "unterminated string";
+        }
+        if (field->is_string) {
+            if (token_.kind != Token::Kind::Quoted) {
+                return "expected a quoted string";
+            }
+            predicate.text = token_.text;
+            if (predicate.op == RuleOp::Matches) {
+                const char* reason = nullptr;
+                predicate.regex = RegexDfa::compile(predicate.text, &reason);
+                if (!predicate.regex) {
+                    return reason;
+                }
+            }
+        } else {
+            const auto number = token_.kind == Token::Kind::Word
+                ? parse_number(token_.text) : std::nullopt;
+            if (!number) {
+                return "expected a number";
+            }
+            predicate.number = *number;
+        }
+        return advance() ? nullptr : "unterminated string";
+    }
+
+    /// @brief `count <n> within <duration> [by <field>]`
+    const char* count(DetectionRule& rule) {
+        const auto threshold = advance() && token_.kind == Token::Kind::Word
+            ? parse_number(token_.text) : std::nullopt;
+        if (!threshold || *threshold == 0 || *threshold > UINT32_MAX) {
+            return "expected a positive count";
+        }
+        rule.threshold = static_cast<std::uint32_t>(*threshold);
+        if (!advance() || !is_word("within")) {
+            return "expected 'within' after the count";
+        }
+        if (const char* reason = duration(rule.window_ns)) {
+            return reason;
+        }
+        if (is_word("by")) {
+            if (!advance() || token_.kind != Token::Kind::Word ||
+                find_field(rule.category, token_.text) == nullptr) {
+                return "expected a field of this category after 'by'";
+            }
+            rule.group_by = token_.text;
+            if (!advance()) {
+                return "unterminated string";
+            }
+        }
+        return nullptr;
+    }
+
+    /// @brief The duration after 'within', leaving the next token current.
+    const char* duration(std::uint64_t& window_ns) {
+        const auto window = advance() && token_.kind == Token::Kind::Word
+            ? parse_duration_ns(token_.text) : std::nullopt;
+        if (!window) {
+            return "expected a duration such as 500ms, 10s or 5m";
+        }
+        window_ns = *window;
+        return advance() ? nullptr : "unterminated string";
+    }
+
+    Lexer lexer_;
+    Token token_;
+};
+
+}  // namespace
+
+std::optional<std::vector<DetectionRule>> parse_detection_rules(std::string_view text,
+                                                                std::string* error) {
+    std::vector<DetectionRule> rules;
+    std::size_t line_number = 0;
+    while (!text.empty()) {
+        const std::size_t end = text.find('\n');
+        std::string_view line = text.substr(0, end);
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+        ++line_number;
+        if (line.ends_with('\r')) {
+            line.remove_suffix(1);
+        }
+
+        Lexer probe(line);
+        Token first;
+        if (probe.next(first) && first.kind == Token::Kind::End) {
+            continue;  // Blank or comment
+        }
+        DetectionRule rule;
+        if (const char* reason = RuleParser(line).parse(rule)) {
+            if (error != nullptr) {
+                *error = "line " + std::to_string(line_number) + ": " + reason;
+            }
+            return std::nullopt;
+        }
+        rules.push_back(std::move(rule));
+    }
+    return rules;
+}
+
+// ---------------------------------------------------------------------------
+// RuleEngine
+// ---------------------------------------------------------------------------
+
+namespace {
+
+constexpr std::string_view kBuiltinRules =
+    // Code written into another process and started there: an RWX region
+    // allocated in a target, then a thread created in it by someone else
+    "rule rwx_then_remote_thread tag T1055: Memory/0 where is_suspicious == 1 "
+    "then Thread/0 where is_remote == 1 within 2s\n";
+
+}  // namespace
+
+std::vector<DetectionRule> builtin_detection_rules() {
+    return parse_detection_rules(kBuiltinRules).value_or(std::vector<DetectionRule>{});
+}
+
+struct RuleEngine::Rule {
+    /// @brief A `matches` operand and its verdict on each string seen.
+    ///
+    /// The memo is direct mapped and lock-free: a slot holds a StringId,
+    /// a valid bit and the verdict, and a colliding string overwrites it.
+    /// IDs are never reused within a session, so a verdict holds until
+    /// reset() clears it.
+    struct Pattern {
+        static constexpr std::size_t kMemoSlots = 4096;
+
+        explicit Pattern(std::shared_ptr<RegexDfa> compiled) noexcept
+            : regex(std::move(compiled)) {}
+
+        bool test(event::StringId id, const event::StringPool& strings) noexcept {
+            std::atomic<std::uint64_t>& slot =
+                memo[(id * 0x9E3779B1U) >> 20 & (kMemoSlots - 1)];
+            const std::uint64_t entry = slot.load(std::memory_order_relaxed);
+            if ((entry >> 2) == id && (entry & 2) != 0) {
+                return (entry & 1) != 0;
+            }
+            bool match = false;
+            try {
+                match = regex->search(strings.get(id));
+            } catch (const std::exception&) {
+                return false;  // No memory for a DFA state: no match, not remembered
+            }
+            slot.store(std::uint64_t{id} << 2 | 2 | static_cast<std::uint64_t>(match),
+                       std::memory_order_relaxed);
+            return match;
+        }
+
+        void clear() noexcept {
+            for (auto& slot : memo) {
+                slot.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        std::shared_ptr<RegexDfa> regex;
+        std::array<std::atomic<std::uint64_t>, kMemoSlots> memo{};
+    };
+
+    struct Predicate {
+        const Field* field;
+        RuleOp op;
+        std::uint64_t number;
+        std::string text;
+        std::unique_ptr<Pattern> pattern;  ///< Matches only
+    };
+
+    struct Step {
+        Category category = Category::Process;
+        std::uint16_t operation = DetectionRule::kAnyOperation;
+        std::vector<Predicate> predicates;  ///< Numeric ones first
+        const Field* target = nullptr;      ///< Sequence key (sequences only)
+    };
+
+    /// @brief How far one target process got through a sequence.
+    struct Progress {
+        std::uint32_t next = 0;            ///< Step expected next
+        event::Timestamp started = 0;      ///< Time of the first step
+    };
+
+    /// @brief Outcome of one event for a sequence.
+    enum class Advance : std::uint8_t { None, Moved, Completed };
+
+    std::string name;
+    event::EventTags tag = 0;  ///< Bit set on the events the rule fires on
+    std::vector<Step> steps;  ///< One, or the steps of a sequence in order
+    std::uint32_t threshold = 1;
+    std::uint64_t window_ns = 0;
+    const Field* group = nullptr;
+    std::size_t max_groups = 1;
+
+    std::atomic<std::uint64_t> matched{0};
+    std::atomic<std::uint64_t> fired{0};
+
+    std::mutex mutex;  ///< Guards windows and sequences
+    std::unordered_map<std::uint64_t, std::vector<event::Timestamp>> windows;
+    std::unordered_map<std::uint64_t, Progress> sequences;
+
+    [[nodiscard]] bool is_sequence() const noexcept { return steps.size() > 1; }
+
+    /// @brief Resolve a step's predicates against the field table.
+    /// @return nullptr on success, else the reason.
+    static const char* compile(Category category, std::uint16_t operation,
+                               const std::vector<RulePredicate>& predicates,
+                               std::vector<Predicate>& out) {
+        if (static_cast<std::size_t>(category) >= static_cast<std::size_t>(Category::Count) ||
+            operation > DetectionRule::kAnyOperation) {
+            return "invalid category or operation";
+        }
+        for (const RulePredicate& predicate : predicates) {
+            const Field* field = find_field(category, predicate.field);
+            if (field == nullptr) {
+                return "unknown field";
+            }
+            if (const char* reason = check_predicate(*field, predicate.op)) {
+                return reason;
+            }
+            std::unique_ptr<Pattern> pattern;
+            if (predicate.op == RuleOp::Matches) {
+                std::shared_ptr<RegexDfa> regex = predicate.regex;
+                const char* reason = nullptr;
+                if (!regex && !(regex = RegexDfa::compile(predicate.text, &reason))) {
+                    return reason;
+                }
+                pattern = std::make_unique<Pattern>(std::move(regex));
+            }
+            out.push_back(
+                {field, predicate.op, predicate.number, predicate.text, std::move(pattern)});
+        }
+        // Integer compares first: they reject most events without a pool lookup
+        std::stable_partition(out.begin(), out.end(),
+                              [](const Predicate& p) { return !p.field->is_string; });
+        return nullptr;
+    }
+
+    [[nodiscard]] static bool holds(const Step& step, const EventPayload& payload,
+                                    const event::StringPool& strings) noexcept {
+        for (const Predicate& predicate : step.predicates) {
+            if (!test(predicate, payload, strings)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool test(const Predicate& predicate, const EventPayload& payload,
+                     const event::StringPool& strings) noexcept {
+        if (predicate.op == RuleOp::Matches) {
+            return predicate.pattern->test(
+                static_cast<event::StringId>(read_number(payload, *predicate.field)), strings);
+        }
+        if (predicate.field->is_string) {
+            const std::string_view value = read_string(payload, *predicate.field, strings);
+            const std::string_view operand = predicate.text;
+            switch (predicate.op) {
+            case RuleOp::Equal:
+                return equal_icase(value, operand);
+            case RuleOp::NotEqual:
+                return !equal_icase(value, operand);
+            case RuleOp::Contains:
+                return operand.empty() || contains_icase(value, operand);
+            case RuleOp::StartsWith:
+                return value.size() >= operand.size() &&
+                       equal_icase(value.substr(0, operand.size()), operand);
+            case RuleOp::EndsWith:
+                return value.size() >= operand.size() &&
+                       equal_icase(value.substr(value.size() - operand.size()), operand);
+            default:
+                return false;
+            }
+        }
+        const std::uint64_t value = read_number(payload, *predicate.field);
+        switch (predicate.op) {
+        case RuleOp::Equal:
+            return value == predicate.number;
+        case RuleOp::NotEqual:
+            return value != predicate.number;
+        case RuleOp::Less:
+            return value < predicate.number;
+        case RuleOp::LessEqual:
+            return value <= predicate.number;
+        case RuleOp::Greater:
+            return value > predicate.number;
+        case RuleOp::GreaterEqual:
+            return value >= predicate.number;
+        default:
+            return false;
+        }
+    }
+
+    /// @brief Count one match; true once threshold matches fall in the window.
+    bool count(std::uint64_t key, event::Timestamp now) {
+        const std::lock_guard lock(mutex);
+        auto it = windows.find(key);
+        if (it == windows.end()) {
+            if (windows.size() >= max_groups) {
+                evict_windows(now);
+            }
+            it = windows.try_emplace(key).first;
+        }
+        std::vector<event::Timestamp>& times = it->second;
+        if (window_ns != 0) {
+            std::erase_if(times, [&](event::Timestamp t) { return expired(t, now); });
+        }
+        times.push_back(now);
+        if (times.size() < threshold) {
+            return false;
+        }
+        times.clear();
+        return true;
+    }
+
+    /**
+     * @brief Move the target's sequence on by one event matching a step.
+     *
+     * A first step (re)starts the sequence unless it is already past its
+     * second step in time; a later step counts only when it is the one
+     * expected. A sequence that outlives the window starts over.
+     */
+    Advance advance(std::uint32_t step, std::uint64_t target, event::Timestamp now) {
+        const std::lock_guard lock(mutex);
+        auto it = sequences.find(target);
+        if (step == 0) {
+            if (it != sequences.end() && it->second.next > 1 &&
+                !expired(it->second.started, now)) {
+                return Advance::None;
+            }
+            if (it == sequences.end()) {
+                if (sequences.size() >= max_groups) {
+                    evict_sequences(now);
+                }
+                it = sequences.try_emplace(target).first;
+            }
+            it->second = Progress{1, now};
+            return Advance::Moved;
+        }
+        if (it == sequences.end() || it->second.next != step) {
+            return Advance::None;
+        }
+        if (expired(it->second.started, now)) {
+            sequences.erase(it);
+            return Advance::None;
+        }
+        if (step + 1 < steps.size()) {
+            it->second.next = step + 1;
+            return Advance::Moved;
+        }
+        sequences.erase(it);
+        return Advance::Completed;
+    }
+
+    [[nodiscard]] bool expired(event::Timestamp t, event::Timestamp now) const noexcept {
+        return window_ns != 0 && now > t && now - t > window_ns;
+    }
+
+    /// @brief Make room for a new key: drop expired keys, else the stalest one.
+    void evict_windows(event::Timestamp now) {
+        std::erase_if(windows, [&](const auto& entry) {
+            return entry.second.empty() || expired(entry.second.back(), now);
+        });
+        if (windows.size() < max_groups) {
+            return;
+        }
+        windows.erase(std::min_element(
+            windows.begin(), windows.end(),
+            [](const auto& a, const auto& b) { return a.second.back() < b.second.back(); }));
+    }
+
+    void evict_sequences(event::Timestamp now) {
+        std::erase_if(sequences,
+                      [&](const auto& entry) { return expired(entry.second.started, now); });
+        if (sequences.size() < max_groups) {
+            return;
+        }
+        sequences.erase(std::min_element(
+            sequences.begin(), sequences.end(),
+            [](const auto& a, const auto& b) { return a.second.started < b.second.started; }));
+    }
+};
+
+RuleEngine::RuleEngine(const DetectionConfig& config) {
+    std::vector<DetectionRule> sources;
+    if (config.builtin_rules) {
+        sources = builtin_detection_rules();
+    }
+    sources.insert(sources.end(), config.rules.begin(), config.rules.end());
+
+    for (const DetectionRule& source : sources) {
+        auto rule = std::make_unique<Rule>();
+        rule->name = source.name;
+        rule->threshold = source.threshold == 0 ? 1 : source.threshold;
+        rule->window_ns = source.window_ns;
+        rule->max_groups = config.max_groups == 0 ? 1 : config.max_groups;
+
+        Rule::Step& first = rule->steps.emplace_back();
+        first.category = source.category;
+        first.operation = source.operation;
+        const char* reason =
+            Rule::compile(source.category, source.operation, source.predicates, first.predicates);
+        for (const RuleStep& then : source.then) {
+            if (reason != nullptr) {
+                break;
+            }
+            Rule::Step& step = rule->steps.emplace_back();
+            step.category = then.category;
+            step.operation = then.operation;
+            reason = Rule::compile(then.category, then.operation, then.predicates, step.predicates);
+        }
+        if (reason == nullptr && rule->is_sequence()) {
+            for (Rule::Step& step : rule->steps) {
+                step.target = target_field(step.category);
+                if (step.target == nullptr) {
+                    reason = "sequence step without a process ID";
+                }
+            }
+            if (rule->threshold > 1) {
+                reason = "sequences cannot have a count";
+            }
+        }
+        if (reason == nullptr && !source.group_by.empty()) {
+            rule->group = find_field(source.category, source.group_by);
+            if (rule->group == nullptr) {
+                reason = "unknown group_by field";
+            }
+        }
+        if (reason != nullptr) {
+            EXERAY_WARN("Detection rule '{}' skipped: {}", source.name, reason);
+            continue;
+        }
+        const std::string& tag = source.tag.empty() ? source.name : source.tag;
+        const auto known = std::find(tags_.begin(), tags_.end(), tag);
+        if (known != tags_.end()) {
+            rule->tag = event::EventTags{1} << (known - tags_.begin());
+        } else if (tags_.size() < 64) {
+            rule->tag = event::EventTags{1} << tags_.size();
+            tags_.push_back(tag);
+        } else {
+            EXERAY_WARN("Detection rule '{}' left untagged: more than 64 tags", source.name);
+        }
+        rules_.push_back(std::move(rule));
+    }
+
+    // One slice per category and operation: rules in configuration order,
+    // the steps of a sequence last first, so that one event cannot both
+    // complete a step and the one after it
+    for (std::size_t category = 0; category < kCategories; ++category) {
+        for (std::size_t operation = 0; operation < 256; ++operation) {
+            Slice& slice = index_[category][operation];
+            slice.begin = static_cast<std::uint32_t>(order_.size());
+            for (std::size_t i = 0; i < rules_.size(); ++i) {
+                const auto& steps = rules_[i]->steps;
+                for (std::size_t s = steps.size(); s-- > 0;) {
+                    if (static_cast<std::size_t>(steps[s].category) == category &&
+                        (steps[s].operation == DetectionRule::kAnyOperation ||
+                         steps[s].operation == operation)) {
+                        order_.push_back({static_cast<std::uint32_t>(i),
+                                          static_cast<std::uint32_t>(s)});
+                    }
+                }
+            }
+            slice.count = static_cast<std::uint32_t>(order_.size()) - slice.begin;
+        }
+    }
+}
+
+RuleEngine::~RuleEngine() = default;
+
+bool RuleEngine::evaluate(const EventPayload& payload, std::uint8_t operation,
+                          event::Timestamp timestamp, const event::StringPool& strings,
+                          event::EventTags* tags) {
+    const auto category = static_cast<std::size_t>(payload.category);
+    if (category >= kCategories) {
+        return false;
+    }
+    const Slice slice = index_[category][operation];
+    bool fired = false;
+    std::uint32_t moved = UINT32_MAX;  // Sequence this event already advanced
+    for (std::uint32_t i = slice.begin; i < slice.begin + slice.count; ++i) {
+        const Entry entry = order_[i];
+        Rule& rule = *rules_[entry.rule];
+        const Rule::Step& step = rule.steps[entry.step];
+        if (entry.rule == moved || !Rule::holds(step, payload, strings)) {
+            continue;
+        }
+        if (rule.is_sequence()) {
+            const auto result =
+                rule.advance(entry.step, read_number(payload, *step.target), timestamp);
+            if (result == Rule::Advance::None) {
+                continue;
+            }
+            moved = entry.rule;
+            rule.matched.fetch_add(1, std::memory_order_relaxed);
+            if (result != Rule::Advance::Completed) {
+                continue;
+            }
+        } else {
+            rule.matched.fetch_add(1, std::memory_order_relaxed);
+            if (rule.threshold > 1) {
+                const std::uint64_t key =
+                    rule.group != nullptr ? group_key(payload, *rule.group, strings) : 0;
+                if (!rule.count(key, timestamp)) {
+                    continue;
+                }
+            }
+        }
+        rule.fired.fetch_add(1, std::memory_order_relaxed);
+        // Counted in RuleStats; a rule on a common event fires per event
+        EXERAY_DEBUG("Detection rule '{}' fired", rule.name);
+        if (tags != nullptr) {
+            *tags |= rule.tag;
+        }
+        fired = true;
+    }
+    return fired;
+}
+
+std::vector<RuleStats> RuleEngine::stats() const {
+    std::vector<RuleStats> result;
+    result.reserve(rules_.size());
+    for (const auto& rule : rules_) {
+        result.push_back({rule->name, rule->matched.load(std::memory_order_relaxed),
+                          rule->fired.load(std::memory_order_relaxed), rule->tag});
+    }
+    return result;
+}
+
+event::EventTags RuleEngine::tag_bit(std::string_view tag) const noexcept {
+    const auto known = std::find(tags_.begin(), tags_.end(), tag);
+    return known != tags_.end() ? event::EventTags{1} << (known - tags_.begin()) : 0;
+}
+
+void RuleEngine::reset() {
+    for (const auto& rule : rules_) {
+        rule->matched.store(0, std::memory_order_relaxed);
+        rule->fired.store(0, std::memory_order_relaxed);
+        const std::lock_guard lock(rule->mutex);
+        rule->windows.clear();
+        rule->sequences.clear();
+        for (Rule::Step& step : rule->steps) {
+            for (Rule::Predicate& predicate : step.predicates) {
+                if (predicate.pattern) {
+                    predicate.pattern->clear();  // The next session reuses StringIds
+                }
+            }
+        }
+    }
+}
+
+}  // namespace exeray::etw
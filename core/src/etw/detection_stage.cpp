@@ -0,0 +1,184 @@
+/// @file detection_stage.cpp
+/// @brief Detection off the ingest path (platform independent).
+
+#include "exeray/etw/detection_stage.hpp"
+
+#include "exeray/etw/detection_rules.hpp"
+#include "exeray/etw/ingest_latency.hpp"
+#include "exeray/etw/ioc_matcher.hpp"
+#include "exeray/event/columns.hpp"
+#include "exeray/event/correlator.hpp"
+#include "exeray/event/string_pool.hpp"
+#include "exeray/trace_spans.hpp"
+
+#include <algorithm>
+
+namespace exeray::etw {
+
+DetectionStage::DetectionStage(event::EventGraph& graph) noexcept : graph_(graph) {}
+
+DetectionStage::~DetectionStage() {
+    stop();
+}
+
+void DetectionStage::start(RuleEngine* rules, IocMatcher* iocs, const event::StringPool* strings,
+                           IngestLatency* latency, event::Correlator* correlator,
+                           std::size_t workers, Submit submit) {
+    stop();
+    rules_ = rules;
+    iocs_ = iocs;
+    strings_ = strings;
+    latency_ = latency;
+    correlator_ = correlator;
+    workers_ = std::max<std::size_t>(workers, 1);
+    submit_ = std::move(submit);
+    tested_.store(0, std::memory_order_relaxed);
+    flagged_.store(0, std::memory_order_relaxed);
+    missed_.store(0, std::memory_order_relaxed);
+    max_backlog_.store(0, std::memory_order_relaxed);
+    next_.store(watermark(), std::memory_order_relaxed);
+    running_.store(true, std::memory_order_release);
+}
+
+void DetectionStage::set_workers(std::size_t workers) {
+    {
+        std::lock_guard lock(mutex_);
+        workers_ = std::max<std::size_t>(workers, 1);
+    }
+    notify();
+}
+
+std::size_t DetectionStage::workers() const {
+    std::lock_guard lock(mutex_);
+    return workers_;
+}
+
+void DetectionStage::notify() {
+    if (!running() || next_.load(std::memory_order_acquire) >= watermark()) {
+        return;
+    }
+    // A worker leaving re-checks for work under the same lock, so no event
+    // pushed before this call is left behind
+    std::lock_guard lock(mutex_);
+    if (active_ >= workers_) {
+        return;
+    }
+    ++active_;
+    submit_([this] { run(); });
+}
+
+void DetectionStage::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    {
+        std::unique_lock lock(mutex_);
+        idle_.wait(lock, [this] { return active_ == 0; });
+    }
+    event::EventId begin = 0;
+    event::EventId end = 0;
+    while (claim(begin, end)) {
+        test(begin, end);
+    }
+}
+
+DetectionStageStats DetectionStage::stats() const noexcept {
+    DetectionStageStats stats;
+    stats.tested = tested_.load(std::memory_order_relaxed);
+    stats.flagged = flagged_.load(std::memory_order_relaxed);
+    stats.missed = missed_.load(std::memory_order_relaxed);
+    stats.max_backlog = max_backlog_.load(std::memory_order_relaxed);
+    if (running()) {
+        const event::EventId next = next_.load(std::memory_order_relaxed);
+        const event::EventId limit = watermark();
+        stats.backlog = limit > next ? limit - next : 0;
+    }
+    return stats;
+}
+
+void DetectionStage::run() {
+    const ProfiledThread role("detector");
+    for (;;) {
+        event::EventId begin = 0;
+        event::EventId end = 0;
+        while (claim(begin, end)) {
+            test(begin, end);
+        }
+        std::lock_guard lock(mutex_);
+        if (next_.load(std::memory_order_acquire) < watermark()) {
+            continue;  // Pushed while leaving
+        }
+        --active_;
+        idle_.notify_all();
+        return;
+    }
+}
+
+bool DetectionStage::claim(event::EventId& begin, event::EventId& end) noexcept {
+    begin = next_.load(std::memory_order_relaxed);
+    for (;;) {
+        const event::EventId limit = watermark();
+        if (begin >= limit) {
+            return false;
+        }
+        end = std::min<event::EventId>(begin + kChunk, limit);
+        if (next_.compare_exchange_weak(begin, end, std::memory_order_acq_rel,
+                                        std::memory_order_relaxed)) {
+            const std::uint64_t backlog = limit - begin;
+            std::uint64_t seen = max_backlog_.load(std::memory_order_relaxed);
+            while (backlog > seen &&
+                   !max_backlog_.compare_exchange_weak(seen, backlog, std::memory_order_relaxed)) {
+            }
+            return true;
+        }
+    }
+}
+
+void DetectionStage::test(event::EventId begin, event::EventId end) {
+    std::uint64_t tested = 0;
+    std::uint64_t flagged = 0;
+    std::uint64_t missed = 0;
+    for (event::EventId id = begin; id < end; ++id) {
+        if (!graph_.exists(id)) {
+            ++missed;
+            continue;
+        }
+        // Copy out: in ring mode the slot can be recycled under us
+        const event::EventView view = graph_.get(id);
+        const event::EventPayload payload = view.payload();
+        const std::uint8_t operation = view.operation();
+        const event::Timestamp timestamp = view.timestamp();
+
+        bool hit = false;
+        event::EventTags tags = 0;
+        if (strings_ != nullptr) {
+            EXERAY_SPAN(Detect);
+            if (rules_ != nullptr &&
+                rules_->evaluate(payload, operation, timestamp, *strings_, &tags)) {
+                hit = true;
+            }
+            if (iocs_ != nullptr && iocs_->match(payload, *strings_)) {
+                hit = true;
+            }
+        }
+        if (tags != 0) {
+            graph_.add_tags(id, tags);
+        }
+        if (hit && graph_.set_status(id, event::Status::Suspicious)) {
+            ++flagged;
+            if (correlator_ != nullptr) {
+                correlator_->add_risk(event::event_pid(payload), view.correlation_id(), timestamp);
+            }
+        }
+        if (latency_ != nullptr && id % IngestLatency::kSampleEvery == 0) {
+            latency_->record(LatencyStage::Detected, payload.category, timestamp,
+                             IngestLatency::now());
+        }
+        ++tested;
+    }
+    tested_.fetch_add(tested, std::memory_order_relaxed);
+    flagged_.fetch_add(flagged, std::memory_order_relaxed);
+    missed_.fetch_add(missed, std::memory_order_relaxed);
+}
+
+}  // namespace exeray::etw
@@ -0,0 +1,226 @@
+/// @file dga_model.cpp
+/// @brief Bigram model of benign domain labels (platform independent).
+
+#include "exeray/etw/dga_model.hpp"
+
+namespace exeray::etw {
+
+namespace {
+
+/// Words and labels the transition statistics are taken from.
+constexpr std::string_view kCorpus =
+    "google facebook youtube amazon wikipedia twitter instagram linkedin microsoft apple "
+    "netflix yahoo bing live office outlook windows update download support account login "
+    "secure service services cloud online store shop market news weather sports music video "
+    "games mail email calendar drive docs photos maps search images translate cdn static "
+    "assets media content delivery analytics tracking telemetry events metrics api gateway "
+    "portal admin dashboard server client network internet system software hardware computer "
+    "security antivirus defender protection firewall bank banking finance payment paypal "
+    "checkout cart order orders product products customer home house garden travel hotel "
+    "booking flights airline train ticket tickets school college university library research "
+    "science health medical doctor hospital pharmacy insurance company business enterprise "
+    "corporate office global international national local city state government public "
+    "private social media community forum blog blogs wiki help center developer developers "
+    "github gitlab stackoverflow ubuntu debian redhat mozilla firefox chrome adobe oracle "
+    "intel nvidia samsung sony dell lenovo cisco vmware salesforce dropbox slack zoom spotify "
+    "pinterest reddit tumblr wordpress blogger medium quora ebay walmart target costco example "
+    "test sample demo staging production development internal corp intranet extranet mysite "
+    "website webmail smtp imap exchange autodiscover time ntp proxy vpn remote desktop connect "
+    "connection share shared storage backup archive files file data database sql learning "
+    "education training course courses video stream streaming live player radio television "
+    "channel channels program programs project projects solutions solution group digital "
+    "marketing design studio creative agency media press magazine journal daily weekly "
+    "application applications mobile phone phones tablet device devices smart home assistant "
+    "weather forecast traffic local events calendar today tomorrow morning evening night world "
+    "information technology management consulting partners partner network networks systems "
+    "microsoftonline windowsupdate googleapis googleusercontent gstatic akamai akamaiedge "
+    "cloudflare cloudfront azure azureedge amazonaws doubleclick googlesyndication the and "
+    "for with from that this have will your about more what when where which their there "
+    "other some time people year years work first after because these would could should "
+    "good great best free new old high low big small long short right left north south east "
+    "west water fire earth light power energy green blue black white red orange yellow purple "
+    "silver gold diamond star moon sun sky ocean river mountain valley forest island park "
+    "lake bay";
+
+// Classes: label boundary, a-z, 0-9, '-', anything else
+constexpr std::size_t kBoundary = 0;
+constexpr std::size_t kDigits = 27;
+constexpr std::size_t kHyphen = 37;
+constexpr std::size_t kOther = 38;
+constexpr std::size_t kClasses = 39;
+
+/// Costs are stored in 1/16 bit.
+constexpr float kCostScale = 16.0f;
+
+constexpr std::size_t class_of(wchar_t c) noexcept {
+    if (c >= L'a' && c <= L'z') {
+        return 1 + static_cast<std::size_t>(c - L'a');
+    }
+    if (c >= L'A' && c <= L'Z') {
+        return 1 + static_cast<std::size_t>(c - L'A');
+    }
+    if (c >= L'0' && c <= L'9') {
+        return kDigits + static_cast<std::size_t>(c - L'0');
+    }
+    return c == L'-' ? kHyphen : kOther;
+}
+
+/// @brief log2 for x > 0, usable in constant expressions.
+constexpr double log2_constexpr(double x) noexcept {
+    int exponent = 0;
+    while (x >= 2.0) {
+        x /= 2.0;
+        ++exponent;
+    }
+    while (x < 1.0) {
+        x *= 2.0;
+        --exponent;
+    }
+    // ln(x) = 2 atanh((x - 1) / (x + 1)), converging fast on [1, 2)
+    const double y = (x - 1.0) / (x + 1.0);
+    double term = y;
+    double sum = 0.0;
+    for (int k = 1; k < 40; k += 2) {
+        sum += term / k;
+        term *= y * y;
+    }
+    return exponent + 2.0 * sum / 0.6931471805599453;
+}
+
+using CostTable = std::array<std::array<std::uint8_t, kClasses>, kClasses>;
+
+/// @brief -log2 P(next | previous) over the corpus, add-one smoothed.
+constexpr CostTable build_costs() {
+    std::array<std::array<std::uint32_t, kClasses>, kClasses> counts{};
+    for (auto& row : counts) {
+        row.fill(1);
+    }
+    std::size_t previous = kBoundary;
+    for (const char c : kCorpus) {
+        const std::size_t current = c == ' ' ? kBoundary : class_of(static_cast<wchar_t>(c));
+        if (current != kBoundary || previous != kBoundary) {
+            ++counts[previous][current];
+        }
+        previous = current;
+    }
+    ++counts[previous][kBoundary];
+
+    CostTable costs{};
+    for (std::size_t from = 0; from < kClasses; ++from) {
+        std::uint32_t total = 0;
+        for (const std::uint32_t n : counts[from]) {
+            total += n;
+        }
+        for (std::size_t to = 0; to < kClasses; ++to) {
+            const double bits = log2_constexpr(total) - log2_constexpr(counts[from][to]);
+            const double scaled = bits * kCostScale + 0.5;
+            costs[from][to] = static_cast<std::uint8_t>(scaled > 255.0 ? 255.0 : scaled);
+        }
+    }
+    return costs;
+}
+
+constexpr CostTable kCosts = build_costs();
+
+constexpr std::size_t kMaxLabel = 20;        ///< Longer labels are suspicious outright
+constexpr std::size_t kMinModelLabel = 8;    ///< Shorter labels are too noisy to score
+constexpr float kMaxSurprise = 4.7f;         ///< Bits per transition
+
+constexpr wchar_t fold(wchar_t c) noexcept {
+    return (c >= L'A' && c <= L'Z') ? static_cast<wchar_t>(c - L'A' + L'a') : c;
+}
+
+/// @brief Sum of transition costs (1/16 bit) and the digit count, in one pass.
+struct LabelScan {
+    std::uint32_t cost = 0;
+    std::size_t digits = 0;
+};
+
+LabelScan scan(std::wstring_view label) noexcept {
+    LabelScan result;
+    std::size_t previous = kBoundary;
+    for (const wchar_t c : label) {
+        const std::size_t current = class_of(c);
+        result.cost += kCosts[previous][current];
+        result.digits += (current >= kDigits && current < kHyphen) ? 1 : 0;
+        previous = current;
+    }
+    result.cost += kCosts[previous][kBoundary];
+    return result;
+}
+
+bool label_generated(std::wstring_view label) noexcept {
+    if (label.size() > kMaxLabel) {
+        return true;
+    }
+    if (label.size() >= 4 && fold(label[0]) == L'x' && fold(label[1]) == L'n' &&
+        label[2] == L'-' && label[3] == L'-') {
+        return false;  // Punycode: encoded Unicode is random-looking by design
+    }
+    const LabelScan result = scan(label);
+    if (label.size() > 5 && result.digits * 10 > label.size() * 3) {
+        return true;
+    }
+    return label.size() >= kMinModelLabel &&
+           static_cast<float>(result.cost) >
+               kMaxSurprise * kCostScale * static_cast<float>(label.size() + 1);
+}
+
+}  // namespace
+
+float label_surprise(std::wstring_view label) noexcept {
+    if (label.empty()) {
+        return 0.0f;
+    }
+    const LabelScan result = scan(label);
+    return static_cast<float>(result.cost) /
+           (kCostScale * static_cast<float>(label.size() + 1));
+}
+
+bool looks_generated(std::wstring_view domain) noexcept {
+    // The top-level label is registry-chosen and not scored
+    const std::size_t tld = domain.rfind(L'.');
+    if (tld != std::wstring_view::npos) {
+        domain = domain.substr(0, tld);
+    }
+    while (!domain.empty()) {
+        const std::size_t dot = domain.find(L'.');
+        if (label_generated(domain.substr(0, dot))) {
+            return true;
+        }
+        domain.remove_prefix(dot == std::wstring_view::npos ? domain.size() : dot + 1);
+    }
+    return false;
+}
+
+std::uint64_t DgaVerdictCache::key(std::wstring_view domain) noexcept {
+    std::uint64_t hash = 14695981039346656037ULL;  // FNV-1a
+    for (const wchar_t c : domain) {
+        hash = (hash ^ static_cast<std::uint16_t>(fold(c))) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::optional<bool> DgaVerdictCache::find(std::uint64_t key) const noexcept {
+    const std::uint64_t word = slots_[(key >> 32) % kSlots].load(std::memory_order_relaxed);
+    if ((word & ~std::uint64_t{1}) != (entry(key, false) & ~std::uint64_t{1})) {
+        return std::nullopt;
+    }
+    return (word & 1) != 0;
+}
+
+void DgaVerdictCache::store(std::uint64_t key, bool generated) noexcept {
+    slots_[(key >> 32) % kSlots].store(entry(key, generated), std::memory_order_relaxed);
+}
+
+bool DgaVerdictCache::check(std::wstring_view domain) noexcept {
+    const std::uint64_t k = key(domain);
+    if (const auto cached = find(k)) {
+        return *cached;
+    }
+    const bool generated = looks_generated(domain);
+    store(k, generated);
+    return generated;
+}
+
+}  // namespace exeray::etw
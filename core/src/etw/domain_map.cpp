@@ -0,0 +1,189 @@
+/// @file domain_map.cpp
+/// @brief Addresses resolved by DNS (platform independent).
+
+#include "exeray/etw/domain_map.hpp"
+
+#include <algorithm>
+
+namespace exeray::etw {
+
+namespace {
+
+std::size_t shard_index(std::uint32_t value) noexcept {
+    return (value * 0x9E3779B1U) >> 28;
+}
+
+std::size_t set_of(std::uint64_t key, std::size_t sets) noexcept {
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33;
+    return static_cast<std::size_t>(key % sets);
+}
+
+std::uint64_t address_key(std::uint32_t pid, std::uint32_t address) noexcept {
+    return (std::uint64_t{pid} << 32) | address;
+}
+
+std::size_t rounded(std::size_t capacity, std::size_t shards, std::size_t probe) noexcept {
+    return (std::max)((capacity / shards + probe - 1) / probe, std::size_t{1}) * probe;
+}
+
+}  // namespace
+
+DomainMap::DomainMap(const DomainMapConfig& config)
+    : ttl_(static_cast<event::Timestamp>(config.ttl_s) * 1'000'000'000),
+      shard_size_(rounded(config.capacity, kShards, kProbe)),
+      pending_size_(rounded(config.max_pending, kShards, kProbe)) {
+    for (Shard& shard : shards_) {
+        shard.entries = std::make_unique<Entry[]>(shard_size_);
+        shard.pending = std::make_unique<Pending[]>(pending_size_);
+    }
+}
+
+void DomainMap::record(Shard& shard, std::uint64_t key, event::StringId domain,
+                       event::Timestamp at) {
+    Entry* set = &shard.entries[set_of(key, shard_size_ / kProbe) * kProbe];
+    // Replace the same key, else a free entry, else an expired one, else
+    // the one closest to expiring
+    const auto rank = [at](const Entry& entry) {
+        return entry.key == 0 ? 0 : entry.expires <= at ? 1 : 2;
+    };
+    Entry* victim = set;
+    for (std::size_t i = 0; i < kProbe; ++i) {
+        Entry& entry = set[i];
+        if (entry.key == key) {
+            victim = &entry;
+            break;
+        }
+        const int r = rank(entry);
+        const int best = rank(*victim);
+        if (r < best || (r == best && entry.expires < victim->expires)) {
+            victim = &entry;
+        }
+    }
+    if (victim->key != key && rank(*victim) == 2) {
+        ++shard.evicted;
+    }
+    *victim = {key, domain, at + ttl_};
+}
+
+event::StringId DomainMap::find(const Shard& shard, std::uint64_t key,
+                                event::Timestamp at) const {
+    const Entry* set = &shard.entries[set_of(key, shard_size_ / kProbe) * kProbe];
+    for (std::size_t i = 0; i < kProbe; ++i) {
+        if (set[i].key == key) {
+            return set[i].expires > at ? set[i].domain : event::INVALID_STRING;
+        }
+    }
+    return event::INVALID_STRING;
+}
+
+DomainMap::Pending& DomainMap::pending(Shard& shard, std::uint32_t pid, event::StringId domain,
+                                       std::uint16_t type) const {
+    const std::uint64_t key =
+        (std::uint64_t{pid} << 32 | domain) * 0x9E3779B97F4A7C15ULL + type;
+    Pending* set = &shard.pending[set_of(key, pending_size_ / kProbe) * kProbe];
+    // The query itself, else a free entry, else the oldest (its response
+    // is the least likely to still come)
+    Pending* victim = set;
+    for (std::size_t i = 0; i < kProbe; ++i) {
+        Pending& entry = set[i];
+        if (entry.pid == pid && entry.domain == domain && entry.type == type) {
+            return entry;
+        }
+        const bool free = entry.domain == event::INVALID_STRING;
+        const bool victim_free = victim->domain == event::INVALID_STRING;
+        if (!victim_free && (free || entry.at < victim->at)) {
+            victim = &entry;
+        }
+    }
+    return *victim;
+}
+
+void DomainMap::query(std::uint32_t pid, event::StringId domain, std::uint16_t type,
+                      event::Timestamp at) {
+    if (domain == event::INVALID_STRING) {
+        return;
+    }
+    Shard& shard = shards_[shard_index(pid)];
+    const std::lock_guard lock(shard.mutex);
+    pending(shard, pid, domain, type) = {pid, domain, type, at};
+}
+
+std::optional<event::Timestamp> DomainMap::resolve(std::uint32_t pid, event::StringId domain,
+                                                   std::uint16_t type, std::uint32_t address,
+                                                   event::Timestamp at) {
+    if (domain == event::INVALID_STRING) {
+        return std::nullopt;
+    }
+    if (address != 0) {
+        Shard& shard = shards_[shard_index(address)];
+        const std::lock_guard lock(shard.mutex);
+        ++shard.resolutions;
+        if (pid != 0) {
+            record(shard, address_key(pid, address), domain, at);
+        }
+        record(shard, address_key(0, address), domain, at);
+    }
+
+    Shard& shard = shards_[shard_index(pid)];
+    const std::lock_guard lock(shard.mutex);
+    Pending& entry = pending(shard, pid, domain, type);
+    if (entry.pid != pid || entry.domain != domain || entry.type != type) {
+        ++shard.unpaired;
+        return std::nullopt;
+    }
+    const event::Timestamp latency = at >= entry.at ? at - entry.at : 0;
+    entry = Pending{};
+    ++shard.paired;
+    return latency;
+}
+
+event::StringId DomainMap::lookup(std::uint32_t pid, std::uint32_t address,
+                                  event::Timestamp at) {
+    if (address == 0) {
+        return event::INVALID_STRING;
+    }
+    Shard& shard = shards_[shard_index(address)];
+    const std::lock_guard lock(shard.mutex);
+    event::StringId domain =
+        pid != 0 ? find(shard, address_key(pid, address), at) : event::INVALID_STRING;
+    if (domain == event::INVALID_STRING) {
+        domain = find(shard, address_key(0, address), at);
+    }
+    ++(domain != event::INVALID_STRING ? shard.enriched : shard.missed);
+    return domain;
+}
+
+DomainMapStats DomainMap::stats() const {
+    DomainMapStats stats;
+    for (const Shard& shard : shards_) {
+        const std::lock_guard lock(shard.mutex);
+        stats.resolutions += shard.resolutions;
+        stats.enriched += shard.enriched;
+        stats.missed += shard.missed;
+        stats.evicted += shard.evicted;
+        stats.paired += shard.paired;
+        stats.unpaired += shard.unpaired;
+        for (std::size_t i = 0; i < shard_size_; ++i) {
+            stats.tracked += shard.entries[i].key != 0 ? 1 : 0;
+        }
+    }
+    return stats;
+}
+
+void DomainMap::clear() {
+    for (Shard& shard : shards_) {
+        const std::lock_guard lock(shard.mutex);
+        std::fill_n(shard.entries.get(), shard_size_, Entry{});
+        std::fill_n(shard.pending.get(), pending_size_, Pending{});
+        shard.resolutions = 0;
+        shard.enriched = 0;
+        shard.missed = 0;
+        shard.evicted = 0;
+        shard.paired = 0;
+        shard.unpaired = 0;
+    }
+}
+
+}  // namespace exeray::etw
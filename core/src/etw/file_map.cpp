@@ -0,0 +1,77 @@
+/// @file file_map.cpp
+/// @brief File object to path and opener cache (platform independent).
+
+#include "exeray/etw/file_map.hpp"
+
+namespace exeray::etw {
+
+FileMap::FileMap() : buckets_(std::make_unique<Bucket[]>(kBuckets)) {}
+
+void FileMap::insert(std::uint64_t file_object, event::StringId path, std::uint32_t pid) {
+    if (file_object == 0 || path == event::INVALID_STRING) {
+        return;
+    }
+    Bucket& bucket = buckets_[index(file_object)];
+    const std::uint64_t value = static_cast<std::uint64_t>(path) << 32 | pid;
+
+    // Reused object: overwrite in place
+    for (Slot& slot : bucket.slots) {
+        if (slot.object.load(std::memory_order_relaxed) == file_object) {
+            slot.value.store(value, std::memory_order_release);
+            return;
+        }
+    }
+    for (Slot& slot : bucket.slots) {
+        std::uint64_t empty = 0;
+        if (slot.object.compare_exchange_strong(empty, file_object, std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
+            slot.value.store(value, std::memory_order_release);
+            size_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    // Full bucket: evict the slot picked by the object's low bits. Readers
+    // of the old object see an empty value in between, i.e. a miss
+    Slot& victim = bucket.slots[(file_object >> 4) % kWays];
+    victim.value.store(0, std::memory_order_release);
+    victim.object.store(file_object, std::memory_order_release);
+    victim.value.store(value, std::memory_order_release);
+}
+
+void FileMap::erase(std::uint64_t file_object) {
+    if (file_object == 0) {
+        return;
+    }
+    Bucket& bucket = buckets_[index(file_object)];
+    for (Slot& slot : bucket.slots) {
+        std::uint64_t current = file_object;
+        if (slot.object.load(std::memory_order_relaxed) != file_object) {
+            continue;
+        }
+        slot.value.store(0, std::memory_order_release);
+        if (slot.object.compare_exchange_strong(current, 0, std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
+            size_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+}
+
+void FileMap::clear() {
+    for (std::size_t b = 0; b < kBuckets; ++b) {
+        for (Slot& slot : buckets_[b].slots) {
+            slot.object.store(0, std::memory_order_relaxed);
+            slot.value.store(0, std::memory_order_relaxed);
+        }
+    }
+    size_.store(0, std::memory_order_relaxed);
+}
+
+/// Global file map instance.
+static FileMap g_file_map;
+
+FileMap& file_map() {
+    return g_file_map;
+}
+
+}  // namespace exeray::etw
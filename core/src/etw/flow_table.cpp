@@ -0,0 +1,150 @@
+/// @file flow_table.cpp
+/// @brief FlowTable implementation (platform independent).
+
+#include "exeray/etw/flow_table.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace exeray::etw {
+
+namespace {
+
+constexpr std::size_t kSent = 0;
+constexpr std::size_t kReceived = 1;
+
+static_assert(FlowTable::kShards == 16, "the shard is the top four bits of the hash");
+
+std::uint32_t saturate(std::uint64_t bytes) noexcept {
+    return static_cast<std::uint32_t>(
+        (std::min)(bytes, std::uint64_t{std::numeric_limits<std::uint32_t>::max()}));
+}
+
+}  // namespace
+
+std::size_t FlowTable::KeyHash::operator()(const FlowKey& key) const noexcept {
+    // 64-bit mix of the fields; the shard takes the top bits, the map the rest
+    std::uint64_t h = (static_cast<std::uint64_t>(key.pid) << 32) ^ key.remote_addr;
+    h ^= (static_cast<std::uint64_t>(key.local_addr) << 24) ^
+         (static_cast<std::uint64_t>(key.local_port) << 8) ^
+         (static_cast<std::uint64_t>(key.remote_port) << 40) ^ key.protocol ^
+         (static_cast<std::uint64_t>(key.family) << 56);
+    h *= 0x9E3779B97F4A7C15ULL;
+    return static_cast<std::size_t>(h ^ (h >> 29));
+}
+
+FlowTable::FlowTable(const FlowConfig& config)
+    : interval_(static_cast<event::Timestamp>(config.summary_interval_ms) * 1'000'000) {}
+
+bool FlowTable::admit(std::uint32_t pid, event::EventPayload& payload, std::uint8_t operation,
+                      event::Timestamp at) {
+    if (payload.category != event::Category::Network) {
+        return true;
+    }
+    const auto op = static_cast<event::NetworkOp>(operation);
+    if (op != event::NetworkOp::Connect && op != event::NetworkOp::Send &&
+        op != event::NetworkOp::Receive && op != event::NetworkOp::Close) {
+        return true;
+    }
+
+    event::NetworkPayload& network = payload.network;
+    const FlowKey key{pid, network.local_addr, network.remote_addr, network.local_port,
+                      network.remote_port, network.protocol, network.family};
+    const std::size_t hash = KeyHash{}(key);
+    Shard& shard = shards_[hash >> (std::numeric_limits<std::size_t>::digits - 4)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (op == event::NetworkOp::Close) {
+        // The close carries what no stored event has reported yet
+        const auto it = shard.flows.find(key);
+        if (it != shard.flows.end()) {
+            network.bytes = saturate(it->second.unreported[kSent] + it->second.unreported[kReceived]);
+            shard.flows.erase(it);
+        }
+        return true;
+    }
+
+    auto it = shard.flows.find(key);
+    if (it == shard.flows.end()) {
+        if (shard.flows.size() >= kMaxFlowsPerShard) {
+            if (op != event::NetworkOp::Connect) {
+                overflowed_.fetch_add(1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+        it = shard.flows.try_emplace(key).first;
+        it->second.record.key = key;
+        it->second.record.first_seen = at;
+    } else if (op == event::NetworkOp::Connect) {
+        it->second = Flow{};  // Tuple reused by a new connection
+        it->second.record.key = key;
+        it->second.record.first_seen = at;
+    }
+    Flow& flow = it->second;
+    flow.record.last_seen = (std::max)(flow.record.last_seen, at);
+    if (op == event::NetworkOp::Connect) {
+        return true;
+    }
+
+    const std::size_t direction = op == event::NetworkOp::Send ? kSent : kReceived;
+    if (direction == kSent) {
+        flow.record.bytes_sent += network.bytes;
+        ++flow.record.packets_sent;
+    } else {
+        flow.record.bytes_received += network.bytes;
+        ++flow.record.packets_received;
+    }
+
+    // The first transfer each way shows the flow in the graph
+    if (flow.reported_at[direction] == 0) {
+        flow.reported_at[direction] = (std::max)(at, event::Timestamp{1});
+        return true;
+    }
+    flow.unreported[direction] += network.bytes;
+    if (interval_ != 0 && at >= flow.reported_at[direction] + interval_) {
+        network.bytes = saturate(flow.unreported[direction]);
+        flow.unreported[direction] = 0;
+        flow.reported_at[direction] = at;
+        summaries_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    absorbed_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+std::vector<FlowRecord> FlowTable::flows(std::uint32_t pid) const {
+    std::vector<FlowRecord> result;
+    for (const Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& [key, flow] : shard.flows) {
+            if (pid == 0 || key.pid == pid) {
+                result.push_back(flow.record);
+            }
+        }
+    }
+    return result;
+}
+
+FlowStats FlowTable::stats() const noexcept {
+    FlowStats stats;
+    for (const Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.flows += shard.flows.size();
+    }
+    stats.absorbed = absorbed_.load(std::memory_order_relaxed);
+    stats.summaries = summaries_.load(std::memory_order_relaxed);
+    stats.overflowed = overflowed_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void FlowTable::clear() {
+    for (Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.flows.clear();
+    }
+    absorbed_.store(0, std::memory_order_relaxed);
+    summaries_.store(0, std::memory_order_relaxed);
+    overflowed_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace exeray::etw
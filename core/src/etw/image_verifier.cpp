@@ -0,0 +1,562 @@
+/// @file image_verifier.cpp
+/// @brief Image hashing and signature verification off the ingest path.
+
+#include "exeray/etw/image_verifier.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "exeray/event/graph.hpp"
+#include "exeray/event/string_pool.hpp"
+#include "exeray/platform/mapped_file.hpp"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <bcrypt.h>
+#include <mscat.h>
+#include <softpub.h>
+#include <wintrust.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#endif
+
+namespace exeray::etw {
+
+namespace {
+
+// ============================================================================
+// SHA-256 (FIPS 180-4)
+// ============================================================================
+
+constexpr std::array<std::uint32_t, 64> kRound = {
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4,
+    0xAB1C5ED5, 0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE,
+    0x9BDC06A7, 0xC19BF174, 0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F,
+    0x4A7484AA, 0x5CB0A9DC, 0x76F988DA, 0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+    0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967, 0x27B70A85, 0x2E1B2138, 0x4D2C6DFC,
+    0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85, 0xA2BFE8A1, 0xA81A664B,
+    0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070, 0x19A4C116,
+    0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7,
+    0xC67178F2};
+
+void sha256_block(std::array<std::uint32_t, 8>& state, const std::uint8_t* block) noexcept {
+    std::array<std::uint32_t, 64> w;
+    for (std::size_t i = 0; i < 16; ++i) {
+        w[i] = std::uint32_t{block[4 * i]} << 24 | std::uint32_t{block[4 * i + 1]} << 16 |
+               std::uint32_t{block[4 * i + 2]} << 8 | std::uint32_t{block[4 * i + 3]};
+    }
+    for (std::size_t i = 16; i < 64; ++i) {
+        const std::uint32_t s0 =
+            std::rotr(w[i - 15], 7) ^ std::rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const std::uint32_t s1 =
+            std::rotr(w[i - 2], 17) ^ std::rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    auto [a, b, c, d, e, f, g, h] = state;
+    for (std::size_t i = 0; i < 64; ++i) {
+        const std::uint32_t t1 = h + (std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25)) +
+                                 ((e & f) ^ (~e & g)) + kRound[i] + w[i];
+        const std::uint32_t t2 = (std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22)) +
+                                 ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    const std::array<std::uint32_t, 8> out = {a, b, c, d, e, f, g, h};
+    for (std::size_t i = 0; i < 8; ++i) {
+        state[i] += out[i];
+    }
+}
+
+// ============================================================================
+// Files
+// ============================================================================
+
+constexpr std::size_t kCacheHeaderSize = 16;
+
+/// @brief One persistent cache entry as stored in the file.
+struct CacheRecord {
+    std::uint64_t path;
+    std::uint64_t file_id;
+    std::int64_t written;
+    event::ImageVerdictExtension verdict;
+    std::uint8_t _pad[4];
+};
+
+static_assert(sizeof(CacheRecord) == 64);
+
+/// @brief FNV-1a of the ASCII-lowercased path: stable across sessions.
+std::uint64_t path_key(std::string_view path) noexcept {
+    std::uint64_t hash = 0xCBF29CE484222325ULL;
+    for (const char c : path) {
+        const auto byte = static_cast<std::uint8_t>(c);
+        hash ^= (byte >= 'A' && byte <= 'Z') ? byte - 'A' + 'a' : byte;
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+/// @brief File ID and last write time of a file; false if it cannot be read.
+bool identify(const std::filesystem::path& path, std::uint64_t& file_id,
+              std::int64_t& written) {
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), FILE_READ_ATTRIBUTES,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    BY_HANDLE_FILE_INFORMATION info{};
+    const bool ok = GetFileInformationByHandle(file, &info) != 0;
+    CloseHandle(file);
+    if (!ok) {
+        return false;
+    }
+    file_id = (std::uint64_t{info.nFileIndexHigh} << 32 | info.nFileIndexLow) ^
+              (std::uint64_t{info.dwVolumeSerialNumber} << 48);
+    written = static_cast<std::int64_t>(std::uint64_t{info.ftLastWriteTime.dwHighDateTime} << 32 |
+                                        info.ftLastWriteTime.dwLowDateTime);
+    return true;
+#elif defined(__unix__) || defined(__APPLE__)
+    struct stat info {};
+    if (::stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) {
+        return false;
+    }
+    file_id = static_cast<std::uint64_t>(info.st_ino) ^
+              (static_cast<std::uint64_t>(info.st_dev) << 48);
+    std::error_code error;
+    written = static_cast<std::int64_t>(
+        std::filesystem::last_write_time(path, error).time_since_epoch().count());
+    return !error;
+#else
+    (void)path;
+    (void)file_id;
+    (void)written;
+    return false;
+#endif
+}
+
+#ifdef _WIN32
+
+LONG verify_trust(WINTRUST_DATA& data) {
+    GUID action = WINTRUST_ACTION_GENERIC_VERIFY_V2;
+    data.cbStruct = sizeof(data);
+    data.dwUIChoice = WTD_UI_NONE;
+    data.fdwRevocationChecks = WTD_REVOKE_NONE;
+    data.dwStateAction = WTD_STATEACTION_VERIFY;
+    data.dwProvFlags = WTD_CACHE_ONLY_URL_RETRIEVAL;
+    const auto window = static_cast<HWND>(INVALID_HANDLE_VALUE);
+    const LONG status = WinVerifyTrust(window, &action, &data);
+    data.dwStateAction = WTD_STATEACTION_CLOSE;
+    WinVerifyTrust(window, &action, &data);
+    return status;
+}
+
+/// @brief Look the file's hash up in the system catalogs (most OS binaries
+/// are signed there rather than embedded).
+event::ImageSignature catalog_signature(HANDLE file, const wchar_t* path) {
+    HCATADMIN admin = nullptr;
+    if (!CryptCATAdminAcquireContext2(&admin, nullptr, BCRYPT_SHA256_ALGORITHM, nullptr, 0)) {
+        return event::ImageSignature::Unsigned;
+    }
+    event::ImageSignature result = event::ImageSignature::Unsigned;
+    DWORD size = 0;
+    CryptCATAdminCalcHashFromFileHandle2(admin, file, &size, nullptr, 0);
+    std::vector<BYTE> hash(size);
+    if (size != 0 && CryptCATAdminCalcHashFromFileHandle2(admin, file, &size, hash.data(), 0)) {
+        HCATINFO info = CryptCATAdminEnumCatalogFromHash(admin, hash.data(), size, 0, nullptr);
+        if (info != nullptr) {
+            CATALOG_INFO catalog{};
+            catalog.cbStruct = sizeof(catalog);
+            if (CryptCATCatalogInfoFromContext(info, &catalog, 0)) {
+                // Catalog members are tagged with their hash in upper-case hex
+                std::wstring tag;
+                constexpr wchar_t kHex[] = L"0123456789ABCDEF";
+                for (const BYTE byte : hash) {
+                    tag += kHex[byte >> 4];
+                    tag += kHex[byte & 15];
+                }
+                WINTRUST_CATALOG_INFO member{};
+                member.cbStruct = sizeof(member);
+                member.pcwszCatalogFilePath = catalog.wszCatalogFile;
+                member.pcwszMemberFilePath = path;
+                member.hMemberFile = file;
+                member.pcwszMemberTag = tag.c_str();
+                member.pbCalculatedFileHash = hash.data();
+                member.cbCalculatedFileHash = size;
+                member.hCatAdmin = admin;
+                WINTRUST_DATA data{};
+                data.dwUnionChoice = WTD_CHOICE_CATALOG;
+                data.pCatalog = &member;
+                result = verify_trust(data) == ERROR_SUCCESS ? event::ImageSignature::Signed
+                                                             : event::ImageSignature::Untrusted;
+            }
+            CryptCATAdminReleaseCatalogContext(admin, info, 0);
+        }
+    }
+    CryptCATAdminReleaseContext(admin, 0);
+    return result;
+}
+
+#endif
+
+/// @brief Authenticode status of a file: embedded signature, then catalogs.
+event::ImageSignature verify_signature(const std::filesystem::path& path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return event::ImageSignature::Unreadable;
+    }
+    WINTRUST_FILE_INFO info{};
+    info.cbStruct = sizeof(info);
+    info.pcwszFilePath = path.c_str();
+    info.hFile = file;
+    WINTRUST_DATA data{};
+    data.dwUnionChoice = WTD_CHOICE_FILE;
+    data.pFile = &info;
+    const LONG status = verify_trust(data);
+    event::ImageSignature result = event::ImageSignature::Untrusted;
+    if (status == ERROR_SUCCESS) {
+        result = event::ImageSignature::Signed;
+    } else if (status == TRUST_E_NOSIGNATURE || status == TRUST_E_SUBJECT_FORM_UNKNOWN ||
+               status == TRUST_E_PROVIDER_UNKNOWN) {
+        result = catalog_signature(file, path.c_str());
+    }
+    CloseHandle(file);
+    return result;
+#else
+    (void)path;
+    return event::ImageSignature::Unchecked;
+#endif
+}
+
+}  // namespace
+
+std::filesystem::path image_file_path(std::string_view text) {
+    std::u8string utf8(text.begin(), text.end());
+#ifdef _WIN32
+    // Paths left in NT form open through the object manager root
+    if (text.starts_with("\\Device\\")) {
+        utf8.insert(0, u8"\\\\?\\GLOBALROOT");
+    }
+#endif
+    return std::filesystem::path(utf8);
+}
+
+std::array<std::uint8_t, 32> sha256(std::span<const std::uint8_t> data) noexcept {
+    std::array<std::uint32_t, 8> state = {0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+                                          0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19};
+    std::size_t offset = 0;
+    for (; offset + 64 <= data.size(); offset += 64) {
+        sha256_block(state, data.data() + offset);
+    }
+
+    // Padding: 0x80, zeros, then the length in bits, in one or two blocks
+    std::array<std::uint8_t, 128> tail{};
+    const std::size_t rest = data.size() - offset;
+    if (rest != 0) {
+        std::memcpy(tail.data(), data.data() + offset, rest);
+    }
+    tail[rest] = 0x80;
+    const std::size_t blocks = rest < 56 ? 1 : 2;
+    const std::uint64_t bits = static_cast<std::uint64_t>(data.size()) * 8;
+    for (std::size_t i = 0; i < 8; ++i) {
+        tail[blocks * 64 - 1 - i] = static_cast<std::uint8_t>(bits >> (8 * i));
+    }
+    for (std::size_t b = 0; b < blocks; ++b) {
+        sha256_block(state, tail.data() + b * 64);
+    }
+
+    std::array<std::uint8_t, 32> digest{};
+    for (std::size_t i = 0; i < 8; ++i) {
+        digest[4 * i] = static_cast<std::uint8_t>(state[i] >> 24);
+        digest[4 * i + 1] = static_cast<std::uint8_t>(state[i] >> 16);
+        digest[4 * i + 2] = static_cast<std::uint8_t>(state[i] >> 8);
+        digest[4 * i + 3] = static_cast<std::uint8_t>(state[i]);
+    }
+    return digest;
+}
+
+ImageVerifier::ImageVerifier(const ImageVerifyConfig& config) : config_(config) {}
+
+ImageVerifier::~ImageVerifier() {
+    stop();
+}
+
+bool ImageVerifier::load(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::uint32_t header[4] = {};
+    if (!file.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+        header[0] != kImageCacheMagic || header[1] != kImageCacheFormat ||
+        header[2] != sizeof(CacheRecord)) {
+        return false;
+    }
+    // A corrupt or truncated count must not size the allocation
+    std::error_code error;
+    const std::uintmax_t size = std::filesystem::file_size(path, error);
+    if (error || size - sizeof(header) < std::uintmax_t{header[3]} * sizeof(CacheRecord)) {
+        return false;
+    }
+    std::vector<CacheRecord> records(header[3]);
+    if (!file.read(reinterpret_cast<char*>(records.data()),
+                   static_cast<std::streamsize>(records.size() * sizeof(CacheRecord)))) {
+        return false;
+    }
+    const std::lock_guard lock(cache_mutex_);
+    for (const CacheRecord& record : records) {
+        cache_[FileKey{record.path, record.file_id, record.written}] = record.verdict;
+    }
+    return true;
+}
+
+bool ImageVerifier::save(const std::filesystem::path& path) const {
+    std::vector<CacheRecord> records;
+    {
+        const std::lock_guard lock(cache_mutex_);
+        records.reserve(cache_.size());
+        for (const auto& [key, verdict] : cache_) {
+            records.push_back({key.path, key.file_id, key.written, verdict, {}});
+        }
+    }
+    const std::uint32_t header[4] = {kImageCacheMagic, kImageCacheFormat, sizeof(CacheRecord),
+                                     static_cast<std::uint32_t>(records.size())};
+    static_assert(sizeof(header) == kCacheHeaderSize);
+
+    // Written beside and renamed, so a reader never sees half a file
+    std::filesystem::path temp = path;
+    temp += ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(records.data()),
+                   static_cast<std::streamsize>(records.size() * sizeof(CacheRecord)));
+        if (!file) {
+            file.close();
+            std::error_code error;
+            std::filesystem::remove(temp, error);
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temp, path, error);
+    if (error) {
+        std::filesystem::remove(temp, error);
+        return false;
+    }
+    return true;
+}
+
+void ImageVerifier::start(event::EventGraph& graph, const event::StringPool& strings,
+                          event::ExtensionStore& extensions, Submit submit) {
+    stop();
+    graph_ = &graph;
+    strings_ = &strings;
+    extensions_ = &extensions;
+    submit_ = std::move(submit);
+    // StringIds and ExtensionIds belong to the session's pools
+    for (PathShard& shard : paths_) {
+        const std::lock_guard lock(shard.mutex);
+        shard.paths.clear();
+    }
+    images_.store(0, std::memory_order_relaxed);
+    hashed_.store(0, std::memory_order_relaxed);
+    cached_.store(0, std::memory_order_relaxed);
+    unreadable_.store(0, std::memory_order_relaxed);
+    attached_.store(0, std::memory_order_relaxed);
+    backfilled_.store(0, std::memory_order_relaxed);
+    running_.store(true, std::memory_order_release);
+}
+
+void ImageVerifier::attach(event::EventPayload& payload) {
+    if (!running() || payload.category != event::Category::Image ||
+        payload.image.image_path == event::INVALID_STRING ||
+        payload.extension != event::NO_EXTENSION) {
+        return;
+    }
+    const event::StringId path = payload.image.image_path;
+    {
+        PathShard& shard = paths_[path % kShards];
+        const std::lock_guard lock(shard.mutex);
+        const auto [it, inserted] = shard.paths.try_emplace(path, event::NO_EXTENSION);
+        if (!inserted) {
+            if (it->second != event::NO_EXTENSION) {
+                payload.extension = it->second;
+                attached_.fetch_add(1, std::memory_order_relaxed);
+            }
+            return;
+        }
+    }
+    images_.fetch_add(1, std::memory_order_relaxed);
+
+    const std::lock_guard lock(mutex_);
+    queue_.push_back(path);
+    if (active_ < (std::max)(config_.workers, std::size_t{1})) {
+        ++active_;
+        submit_([this] { run(); });
+    }
+}
+
+void ImageVerifier::run() {
+    for (;;) {
+        while (resolve_batch()) {
+        }
+        // Re-checked under the lock attach() queues under, so no image
+        // queued before the worker leaves is left behind
+        const std::lock_guard lock(mutex_);
+        if (queue_.empty()) {
+            --active_;
+            idle_.notify_all();
+            return;
+        }
+    }
+}
+
+bool ImageVerifier::resolve_batch() {
+    std::vector<event::StringId> batch;
+    {
+        const std::lock_guard lock(mutex_);
+        const std::size_t n = (std::min)(queue_.size(), kBatch);
+        batch.assign(queue_.begin(), queue_.begin() + static_cast<std::ptrdiff_t>(n));
+        queue_.erase(queue_.begin(), queue_.begin() + static_cast<std::ptrdiff_t>(n));
+    }
+    if (batch.empty()) {
+        return false;
+    }
+
+    std::unordered_map<event::StringId, event::ExtensionId> resolved;
+    for (const event::StringId path : batch) {
+        const event::ExtensionId id =
+            extensions_->append(event::ExtensionKind::ImageVerdict, resolve(path));
+        if (id == event::NO_EXTENSION) {
+            continue;  // Store full: the image stays without a verdict
+        }
+        {
+            PathShard& shard = paths_[path % kShards];
+            const std::lock_guard lock(shard.mutex);
+            shard.paths[path] = id;
+        }
+        resolved.emplace(path, id);
+    }
+    backfill(resolved);
+    return true;
+}
+
+event::ImageVerdictExtension ImageVerifier::resolve(event::StringId path) {
+    event::ImageVerdictExtension verdict{};
+    verdict.signature = event::ImageSignature::Unreadable;
+
+    std::string buffer;
+    const std::string_view text = strings_->read(path, buffer);
+    const std::filesystem::path file = image_file_path(text);
+    FileKey key{path_key(text), 0, 0};
+    if (!identify(file, key.file_id, key.written)) {
+        unreadable_.fetch_add(1, std::memory_order_relaxed);
+        return verdict;
+    }
+    {
+        const std::lock_guard lock(cache_mutex_);
+        if (const auto it = cache_.find(key); it != cache_.end()) {
+            cached_.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+
+    std::error_code error;
+    const auto size = std::filesystem::file_size(file, error);
+    platform::MappedFile mapped;
+    if (error || size > config_.max_bytes || !mapped.open(file)) {
+        unreadable_.fetch_add(1, std::memory_order_relaxed);
+        return verdict;
+    }
+    mapped.advise_sequential();
+    const auto digest = sha256(mapped.bytes());
+    std::memcpy(verdict.sha256, digest.data(), digest.size());
+    mapped.close();
+    verdict.signature =
+        config_.signatures ? verify_signature(file) : event::ImageSignature::Unchecked;
+    hashed_.fetch_add(1, std::memory_order_relaxed);
+
+    const std::lock_guard lock(cache_mutex_);
+    cache_[key] = verdict;
+    return verdict;
+}
+
+void ImageVerifier::backfill(
+    const std::unordered_map<event::StringId, event::ExtensionId>& resolved) {
+    if (resolved.empty()) {
+        return;
+    }
+    std::uint64_t backfilled = 0;
+    graph_->for_each_category(event::Category::Image, [&](event::EventView view) {
+        const event::EventPayload payload = view.payload();
+        if (payload.extension != event::NO_EXTENSION) {
+            return;
+        }
+        const auto it = resolved.find(payload.image.image_path);
+        if (it != resolved.end() && graph_->set_extension(view.id(), it->second)) {
+            ++backfilled;
+        }
+    });
+    backfilled_.fetch_add(backfilled, std::memory_order_relaxed);
+}
+
+void ImageVerifier::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    {
+        std::unique_lock lock(mutex_);
+        idle_.wait(lock, [this] { return active_ == 0; });
+    }
+    while (resolve_batch()) {
+    }
+
+    // Events pushed after their image's batch was backfilled
+    std::unordered_map<event::StringId, event::ExtensionId> resolved;
+    for (const PathShard& shard : paths_) {
+        const std::lock_guard lock(shard.mutex);
+        for (const auto& [path, id] : shard.paths) {
+            if (id != event::NO_EXTENSION) {
+                resolved.emplace(path, id);
+            }
+        }
+    }
+    backfill(resolved);
+}
+
+event::ExtensionId ImageVerifier::verdict(event::StringId path) const {
+    const PathShard& shard = paths_[path % kShards];
+    const std::lock_guard lock(shard.mutex);
+    const auto it = shard.paths.find(path);
+    return it != shard.paths.end() ? it->second : event::NO_EXTENSION;
+}
+
+ImageVerifyStats ImageVerifier::stats() const noexcept {
+    ImageVerifyStats stats;
+    stats.images = images_.load(std::memory_order_relaxed);
+    stats.hashed = hashed_.load(std::memory_order_relaxed);
+    stats.cached = cached_.load(std::memory_order_relaxed);
+    stats.unreadable = unreadable_.load(std::memory_order_relaxed);
+    stats.attached = attached_.load(std::memory_order_relaxed);
+    stats.backfilled = backfilled_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}  // namespace exeray::etw
@@ -0,0 +1,163 @@
+/// @file ingest_latency.cpp
+/// @brief LatencyHistogram and IngestLatency implementation (platform independent).
+
+#include "exeray/etw/ingest_latency.hpp"
+
+#include <bit>
+#include <cmath>
+
+namespace exeray::etw {
+
+namespace {
+
+/// @brief Number of samples a quantile has to cover (at least 1).
+std::uint64_t rank_of(double quantile, std::uint64_t count) noexcept {
+    const double clamped = quantile < 0.0 ? 0.0 : (quantile > 1.0 ? 1.0 : quantile);
+    const auto rank = static_cast<std::uint64_t>(std::ceil(clamped * static_cast<double>(count)));
+    return rank == 0 ? 1 : rank;
+}
+
+}  // namespace
+
+std::size_t LatencyHistogram::bucket_of(std::uint64_t ns) noexcept {
+    if (ns < kSubBuckets) {
+        return static_cast<std::size_t>(ns);
+    }
+    const unsigned magnitude = static_cast<unsigned>(std::bit_width(ns)) - 1;
+    if (magnitude > kMaxMagnitude) {
+        return kBuckets - 1;
+    }
+    const unsigned shift = magnitude - kSubBits;
+    const auto sub = static_cast<std::size_t>(ns >> shift) - kSubBuckets;
+    return kSubBuckets + shift * kSubBuckets + sub;
+}
+
+std::uint64_t LatencyHistogram::upper_bound(std::size_t bucket) noexcept {
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+    const std::size_t shift = (bucket - kSubBuckets) / kSubBuckets;
+    const std::size_t sub = (bucket - kSubBuckets) % kSubBuckets;
+    const std::uint64_t lower = static_cast<std::uint64_t>(kSubBuckets + sub) << shift;
+    return lower + (std::uint64_t{1} << shift) - 1;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) noexcept {
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+        buckets_[i].fetch_add(other.buckets_[i].load(std::memory_order_relaxed),
+                              std::memory_order_relaxed);
+    }
+}
+
+std::uint64_t LatencyHistogram::count() const noexcept {
+    std::uint64_t total = 0;
+    for (const auto& bucket : buckets_) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::uint64_t LatencyHistogram::percentile(double quantile) const noexcept {
+    const std::uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    const std::uint64_t rank = rank_of(quantile, total);
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return upper_bound(i);
+        }
+    }
+    return upper_bound(kBuckets - 1);  // Records raced with count()
+}
+
+LatencySummary LatencyHistogram::summary() const noexcept {
+    // One consistent copy so that the percentiles agree with the count
+    std::array<std::uint64_t, kBuckets> counts{};
+    LatencySummary result;
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+        counts[i] = buckets_[i].load(std::memory_order_relaxed);
+        result.count += counts[i];
+    }
+    if (result.count == 0) {
+        return result;
+    }
+
+    const std::uint64_t p50 = rank_of(0.50, result.count);
+    const std::uint64_t p99 = rank_of(0.99, result.count);
+    const std::uint64_t p999 = rank_of(0.999, result.count);
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+        if (counts[i] == 0) {
+            continue;
+        }
+        const std::uint64_t before = seen;
+        seen += counts[i];
+        const std::uint64_t bound = upper_bound(i);
+        if (before < p50 && seen >= p50) {
+            result.p50 = bound;
+        }
+        if (before < p99 && seen >= p99) {
+            result.p99 = bound;
+        }
+        if (before < p999 && seen >= p999) {
+            result.p999 = bound;
+        }
+        result.max = bound;
+    }
+    return result;
+}
+
+void LatencyHistogram::reset() noexcept {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void IngestLatency::record(LatencyStage stage, event::Category category,
+                           event::Timestamp timestamp, event::Timestamp now) noexcept {
+    const auto s = static_cast<std::size_t>(stage);
+    const auto c = static_cast<std::size_t>(category);
+    if (s >= kLatencyStages || c >= kCategories) {
+        return;
+    }
+    histograms_[s][c].record(now > timestamp ? now - timestamp : 0);
+}
+
+void IngestLatency::record_visible(std::span<const event::PendingEvent> events,
+                                   event::Timestamp now, std::uint32_t& tick) noexcept {
+    for (const event::PendingEvent& event : events) {
+        if (due(tick)) {
+            record(LatencyStage::Visible, event.category, event.timestamp, now);
+        }
+    }
+}
+
+LatencySummary IngestLatency::summary(LatencyStage stage,
+                                      event::Category category) const noexcept {
+    const auto s = static_cast<std::size_t>(stage);
+    if (s >= kLatencyStages) {
+        return {};
+    }
+    const auto c = static_cast<std::size_t>(category);
+    if (c < kCategories) {
+        return histograms_[s][c].summary();
+    }
+    LatencyHistogram all;
+    for (const LatencyHistogram& histogram : histograms_[s]) {
+        all.merge(histogram);
+    }
+    return all.summary();
+}
+
+void IngestLatency::reset() noexcept {
+    for (auto& stage : histograms_) {
+        for (LatencyHistogram& histogram : stage) {
+            histogram.reset();
+        }
+    }
+}
+
+}  // namespace exeray::etw
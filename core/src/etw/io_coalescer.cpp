@@ -0,0 +1,82 @@
+/// @file io_coalescer.cpp
+/// @brief IoCoalescer implementation (platform independent).
+
+#include "exeray/etw/io_coalescer.hpp"
+
+#include <algorithm>
+
+namespace exeray::etw {
+
+namespace {
+
+bool is_io(const event::PendingEvent& event) noexcept {
+    return event.category == event::Category::FileSystem &&
+           (event.operation == static_cast<std::uint8_t>(event::FileOp::Read) ||
+            event.operation == static_cast<std::uint8_t>(event::FileOp::Write));
+}
+
+std::uint32_t ops_of(const event::FilePayload& file) noexcept {
+    return (std::max)(file.ops, std::uint32_t{1});
+}
+
+}  // namespace
+
+void IoCoalescer::release(std::size_t index, std::vector<event::PendingEvent>& out) {
+    out.push_back(runs_[index].event);
+    runs_.erase(runs_.begin() + static_cast<std::ptrdiff_t>(index));
+}
+
+bool IoCoalescer::offer(const event::PendingEvent& event, std::uint64_t object,
+                        std::vector<event::PendingEvent>& out) {
+    if (window_ == 0 || event.category != event::Category::FileSystem) {
+        return false;
+    }
+    expire(event.timestamp, out);
+    if (object == 0) {
+        return false;
+    }
+
+    const std::uint32_t pid = event.pid;
+    const auto run = std::find_if(runs_.begin(), runs_.end(), [pid, object](const Run& r) {
+        return r.pid == pid && r.object == object;
+    });
+    const bool mergeable = is_io(event) && event.status != event::Status::Suspicious;
+    if (run != runs_.end()) {
+        event::PendingEvent& held = run->event;
+        if (mergeable && held.operation == event.operation &&
+            event.timestamp - held.timestamp <= window_) {
+            held.payload.file.size += event.payload.file.size;
+            held.payload.file.ops = ops_of(held.payload.file) + ops_of(event.payload.file);
+            ++merged_;
+            return true;
+        }
+        // Anything else on the file ends the run before it
+        release(static_cast<std::size_t>(run - runs_.begin()), out);
+    }
+    if (!mergeable) {
+        return false;
+    }
+
+    if (runs_.size() >= kMaxRuns) {
+        release(0, out);
+    }
+    runs_.push_back({pid, object, event});
+    runs_.back().event.payload.file.ops = ops_of(event.payload.file);
+    return true;
+}
+
+void IoCoalescer::expire(event::Timestamp now, std::vector<event::PendingEvent>& out) {
+    // Runs are oldest first, and a run never outlives its window
+    while (!runs_.empty() && now > runs_.front().event.timestamp + window_) {
+        release(0, out);
+    }
+}
+
+void IoCoalescer::release_all(std::vector<event::PendingEvent>& out) {
+    for (const Run& run : runs_) {
+        out.push_back(run.event);
+    }
+    runs_.clear();
+}
+
+}  // namespace exeray::etw
@@ -0,0 +1,361 @@
+/// @file ioc_matcher.cpp
+/// @brief IOC list loading and matching (platform independent).
+
+#include "exeray/etw/ioc_matcher.hpp"
+
+#include "exeray/etw/ip_address.hpp"
+#include "exeray/event/string_pool.hpp"
+#include "exeray/logging.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+
+namespace exeray::etw {
+
+namespace {
+
+constexpr std::size_t kEntriesPerBlock = 32;  ///< About 16 filter bits per indicator
+constexpr std::size_t kProbeBits = 6;         ///< Bits set per indicator, all in one block
+
+/// @brief splitmix64 finalizer.
+constexpr std::uint64_t mix(std::uint64_t x) noexcept {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+constexpr char fold(char c, IocKind kind) noexcept {
+    if (c >= 'A' && c <= 'Z') {
+        return static_cast<char>(c - 'A' + 'a');
+    }
+    return (kind == IocKind::Path && c == '/') ? '\\' : c;
+}
+
+/// @brief FNV-1a of the normalized text; never 0 (the empty-slot key).
+std::uint64_t text_key(IocKind kind, std::string_view text) noexcept {
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (const char c : text) {
+        hash = (hash ^ static_cast<std::uint8_t>(fold(c, kind))) * 1099511628211ULL;
+    }
+    return hash == 0 ? 1 : hash;
+}
+
+std::uint64_t address_key(std::uint32_t address) noexcept {
+    return mix(address | (std::uint64_t{1} << 32));
+}
+
+std::string_view trim(std::string_view text) noexcept {
+    constexpr std::string_view kSpace = " \t\r\n";
+    const std::size_t first = text.find_first_not_of(kSpace);
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    return text.substr(first, text.find_last_not_of(kSpace) - first + 1);
+}
+
+/// @brief Normalized indicator as it is looked up; empty if unusable.
+std::string_view normalize(IocKind kind, std::string_view text) noexcept {
+    text = trim(text);
+    if (kind == IocKind::Domain && !text.empty() && text.back() == '.') {
+        text.remove_suffix(1);  // Fully qualified form
+    }
+    return text;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// IocSet
+// ---------------------------------------------------------------------------
+
+IocSet::IocSet(const std::vector<Item>& items) {
+    if (items.empty()) {
+        return;
+    }
+    filter_.resize(std::bit_ceil((std::max)(std::size_t{1}, items.size() / kEntriesPerBlock)));
+    table_.resize(std::bit_ceil((std::max)(std::size_t{16}, items.size() * 2)));
+
+    for (const Item& item : items) {
+        const std::uint64_t key = item.key == 0 ? 1 : item.key;
+        const std::uint64_t spread = mix(key);
+        for (std::size_t i = (spread & (table_.size() - 1));; i = (i + 1) & (table_.size() - 1)) {
+            if (table_[i].key == key) {
+                break;  // Already listed; the first list keeps it
+            }
+            if (table_[i].key == 0) {
+                table_[i] = Slot{key, item.list};
+                break;
+            }
+        }
+
+        Block& block = filter_[(spread >> 32) & (filter_.size() - 1)];
+        const std::uint64_t bits = mix(key ^ 0x9E3779B97F4A7C15ULL);
+        for (std::size_t probe = 0; probe < kProbeBits; ++probe) {
+            const std::uint64_t bit = (bits >> (9 * probe)) & 511;
+            block.bits[bit / 64] |= std::uint64_t{1} << (bit % 64);
+        }
+    }
+}
+
+bool IocSet::may_contain(std::uint64_t key) const noexcept {
+    const Block& block = filter_[(mix(key) >> 32) & (filter_.size() - 1)];
+    const std::uint64_t bits = mix(key ^ 0x9E3779B97F4A7C15ULL);
+    for (std::size_t probe = 0; probe < kProbeBits; ++probe) {
+        const std::uint64_t bit = (bits >> (9 * probe)) & 511;
+        if ((block.bits[bit / 64] & (std::uint64_t{1} << (bit % 64))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::optional<std::uint32_t> IocSet::find(std::uint64_t key) const noexcept {
+    key = key == 0 ? 1 : key;
+    if (table_.empty() || !may_contain(key)) {
+        return std::nullopt;
+    }
+    for (std::size_t i = (mix(key) & (table_.size() - 1));; i = (i + 1) & (table_.size() - 1)) {
+        if (table_[i].key == key) {
+            return table_[i].list;
+        }
+        if (table_[i].key == 0) {
+            return std::nullopt;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// IocMatcher
+// ---------------------------------------------------------------------------
+
+IocMatcher::IocMatcher(const IocConfig& config)
+    : hits_(std::make_unique<std::atomic<std::uint64_t>[]>(config.lists.size())),
+      domains_(std::make_unique<Memo>()),
+      paths_(std::make_unique<Memo>()) {
+    std::array<std::vector<IocSet::Item>, static_cast<std::size_t>(IocKind::Count)> items;
+
+    for (std::size_t index = 0; index < config.lists.size(); ++index) {
+        const IocList& list = config.lists[index];
+        IocStats& stats = lists_.emplace_back();
+        stats.name = list.name;
+        stats.kind = list.kind;
+
+        auto& kind_items = items[static_cast<std::size_t>(list.kind)];
+        const auto add = [&](std::string_view line) {
+            line = normalize(list.kind, line);
+            if (line.empty() || line.front() == '#') {
+                return;
+            }
+            const std::uint64_t fingerprint = key(list.kind, line);
+            if (fingerprint == 0) {
+                ++stats.rejected;
+                return;
+            }
+            kind_items.push_back(IocSet::Item{fingerprint, static_cast<std::uint32_t>(index)});
+            ++stats.entries;
+        };
+
+        for (const std::string& entry : list.entries) {
+            add(entry);
+        }
+        if (!list.file.empty()) {
+            std::ifstream file(list.file);
+            if (!file) {
+                EXERAY_WARN("IocMatcher: Cannot read list '{}' from {}", list.name, list.file);
+                continue;
+            }
+            for (std::string line; std::getline(file, line);) {
+                add(line);
+            }
+        }
+        if (stats.rejected != 0) {
+            EXERAY_WARN("IocMatcher: Skipped {} invalid entries of list '{}'", stats.rejected,
+                        list.name);
+        }
+    }
+
+    for (std::size_t kind = 0; kind < items.size(); ++kind) {
+        sets_[kind] = IocSet(items[kind]);
+    }
+}
+
+IocMatcher::~IocMatcher() = default;
+
+bool IocMatcher::empty() const noexcept {
+    return std::all_of(sets_.begin(), sets_.end(), [](const IocSet& set) { return set.empty(); });
+}
+
+std::uint64_t IocMatcher::key(IocKind kind, std::string_view indicator) noexcept {
+    indicator = normalize(kind, indicator);
+    if (kind == IocKind::Address) {
+        if (const auto address = parse_address(indicator)) {
+            return address_key(*address);
+        }
+        // IPv6 is compared in the canonical text the payloads intern
+        const auto address6 = parse_ipv6(indicator);
+        std::array<char, kMaxIpv6Text + 1> text{};
+        return address6 ? text_key(kind, format_ipv6(*address6, text)) : 0;
+    }
+    return text_key(kind, indicator);
+}
+
+std::optional<std::uint32_t> IocMatcher::parse_address(std::string_view text) noexcept {
+    std::uint32_t address = 0;
+    for (std::size_t octet = 0; octet < 4; ++octet) {
+        if (octet != 0) {
+            if (text.empty() || text.front() != '.') {
+                return std::nullopt;
+            }
+            text.remove_prefix(1);
+        }
+        std::uint32_t value = 0;
+        std::size_t digits = 0;
+        while (digits < text.size() && text[digits] >= '0' && text[digits] <= '9') {
+            value = value * 10 + static_cast<std::uint32_t>(text[digits] - '0');
+            if (++digits > 3 || value > 255) {
+                return std::nullopt;
+            }
+        }
+        if (digits == 0) {
+            return std::nullopt;
+        }
+        text.remove_prefix(digits);
+        address |= value << (8 * octet);  // First octet in the lowest byte
+    }
+    if (!text.empty()) {
+        return std::nullopt;
+    }
+    return address;
+}
+
+std::optional<std::size_t> IocMatcher::match_domain(std::string_view domain) const noexcept {
+    const IocSet& set = sets_[static_cast<std::size_t>(IocKind::Domain)];
+    if (set.empty()) {
+        return std::nullopt;
+    }
+    domain = normalize(IocKind::Domain, domain);
+    // The name itself, then each parent at a label boundary
+    while (!domain.empty()) {
+        if (const auto list = set.find(text_key(IocKind::Domain, domain))) {
+            return *list;
+        }
+        const std::size_t dot = domain.find('.');
+        domain.remove_prefix(dot == std::string_view::npos ? domain.size() : dot + 1);
+    }
+    return std::nullopt;
+}
+
+std::optional<std::size_t> IocMatcher::match_path(std::string_view path) const noexcept {
+    const IocSet& set = sets_[static_cast<std::size_t>(IocKind::Path)];
+    if (set.empty() || path.empty()) {
+        return std::nullopt;
+    }
+    if (const auto list = set.find(text_key(IocKind::Path, path))) {
+        return *list;
+    }
+    const std::size_t separator = path.find_last_of("\\/");
+    if (separator == std::string_view::npos || separator + 1 == path.size()) {
+        return std::nullopt;
+    }
+    if (const auto list = set.find(text_key(IocKind::Path, path.substr(separator + 1)))) {
+        return *list;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::size_t> IocMatcher::match_address(std::uint32_t address) const noexcept {
+    const IocSet& set = sets_[static_cast<std::size_t>(IocKind::Address)];
+    if (set.empty() || address == 0) {
+        return std::nullopt;
+    }
+    if (const auto list = set.find(address_key(address))) {
+        return *list;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::size_t> IocMatcher::match_ipv6(std::string_view canonical) const noexcept {
+    const IocSet& set = sets_[static_cast<std::size_t>(IocKind::Address)];
+    if (set.empty() || canonical.empty()) {
+        return std::nullopt;
+    }
+    if (const auto list = set.find(text_key(IocKind::Address, canonical))) {
+        return *list;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::size_t> IocMatcher::match_string(IocKind kind, event::StringId id,
+                                                    const event::StringPool& strings) noexcept {
+    if (id == event::INVALID_STRING || sets_[static_cast<std::size_t>(kind)].empty()) {
+        return std::nullopt;
+    }
+    Memo& memo = kind == IocKind::Domain ? *domains_ : *paths_;
+    auto& slot = memo[((std::uint64_t{id} * 0x9E3779B97F4A7C15ULL) >> 32) % kMemoSlots];
+    const std::uint64_t word = slot.load(std::memory_order_relaxed);
+    if ((word >> 32) == id) {
+        const auto code = static_cast<std::uint32_t>(word);
+        return code == 0 ? std::nullopt : std::optional<std::size_t>(code - 1);
+    }
+
+    const std::string_view text = strings.get(id);
+    const auto list = kind == IocKind::Domain ? match_domain(text) : match_path(text);
+    const std::uint64_t code = list ? *list + 1 : 0;
+    slot.store((std::uint64_t{id} << 32) | code, std::memory_order_relaxed);
+    return list;
+}
+
+std::optional<std::size_t> IocMatcher::hit(std::optional<std::size_t> list) noexcept {
+    if (list) {
+        hits_[*list].fetch_add(1, std::memory_order_relaxed);
+    }
+    return list;
+}
+
+std::optional<std::size_t> IocMatcher::match(const event::EventPayload& payload,
+                                             const event::StringPool& strings) noexcept {
+    switch (payload.category) {
+        case event::Category::FileSystem:
+            return hit(match_string(IocKind::Path, payload.file.path, strings));
+        case event::Category::Process:
+            return hit(match_string(IocKind::Path, payload.process.image_path, strings));
+        case event::Category::Image:
+            return hit(match_string(IocKind::Path, payload.image.image_path, strings));
+        case event::Category::Network:
+            if (payload.network.family == event::kAddressIPv6) {
+                const event::StringId remote = payload.network.remote_addr;
+                return remote == event::INVALID_STRING ? std::nullopt
+                                                       : hit(match_ipv6(strings.get(remote)));
+            }
+            return hit(match_address(payload.network.remote_addr));
+        case event::Category::Dns:
+            if (const auto list = match_string(IocKind::Domain, payload.dns.domain, strings)) {
+                return hit(list);
+            }
+            return hit(match_address(payload.dns.resolved_ip));
+        default:
+            return std::nullopt;
+    }
+}
+
+std::vector<IocStats> IocMatcher::stats() const {
+    std::vector<IocStats> result = lists_;
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        result[i].hits = hits_[i].load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+void IocMatcher::reset() noexcept {
+    for (std::size_t i = 0; i < lists_.size(); ++i) {
+        hits_[i].store(0, std::memory_order_relaxed);
+    }
+    for (Memo* memo : {domains_.get(), paths_.get()}) {
+        for (auto& slot : *memo) {
+            slot.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+}  // namespace exeray::etw
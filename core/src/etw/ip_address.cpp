@@ -0,0 +1,212 @@
+/// @file ip_address.cpp
+/// @brief IPv6 text conversion (platform independent).
+
+#include "exeray/etw/ip_address.hpp"
+
+#include "exeray/event/string_pool.hpp"
+
+namespace exeray::etw {
+
+namespace {
+
+constexpr char kHex[] = "0123456789abcdef";
+
+int hex_value(char c) noexcept {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/// @brief Dotted IPv4 into out[0..3]; false if malformed.
+bool parse_dotted(std::string_view text, std::uint8_t* out) noexcept {
+    for (std::size_t octet = 0; octet < 4; ++octet) {
+        if (octet != 0) {
+            if (text.empty() || text.front() != '.') {
+                return false;
+            }
+            text.remove_prefix(1);
+        }
+        unsigned value = 0;
+        std::size_t digits = 0;
+        while (digits < text.size() && text[digits] >= '0' && text[digits] <= '9') {
+            value = value * 10 + static_cast<unsigned>(text[digits] - '0');
+            if (++digits > 3 || value > 255) {
+                return false;
+            }
+        }
+        if (digits == 0) {
+            return false;
+        }
+        text.remove_prefix(digits);
+        out[octet] = static_cast<std::uint8_t>(value);
+    }
+    return text.empty();
+}
+
+}  // namespace
+
+std::string_view format_ipv6(const Ipv6Address& address,
+                             std::array<char, kMaxIpv6Text + 1>& out) noexcept {
+    std::array<unsigned, 8> groups{};
+    for (std::size_t i = 0; i < 8; ++i) {
+        groups[i] = (unsigned{address[2 * i]} << 8) | address[2 * i + 1];
+    }
+
+    std::size_t n = 0;
+    auto put = [&out, &n](char c) { out[n++] = c; };
+    auto put_group = [&put](unsigned group) {
+        bool started = false;
+        for (int shift = 12; shift >= 0; shift -= 4) {
+            const unsigned digit = (group >> shift) & 0xF;
+            if (digit != 0 || started || shift == 0) {
+                put(kHex[digit]);
+                started = true;
+            }
+        }
+    };
+
+    // ::ffff:a.b.c.d
+    if (groups[0] == 0 && groups[1] == 0 && groups[2] == 0 && groups[3] == 0 &&
+        groups[4] == 0 && groups[5] == 0xFFFF) {
+        for (const char c : std::string_view("::ffff:")) {
+            put(c);
+        }
+        for (std::size_t i = 12; i < 16; ++i) {
+            if (i != 12) {
+                put('.');
+            }
+            const unsigned octet = address[i];
+            if (octet >= 100) {
+                put(static_cast<char>('0' + octet / 100));
+            }
+            if (octet >= 10) {
+                put(static_cast<char>('0' + octet / 10 % 10));
+            }
+            put(static_cast<char>('0' + octet % 10));
+        }
+        return {out.data(), n};
+    }
+
+    // Longest run of zero groups, the first one on a tie, if at least two
+    std::size_t best = 8;
+    std::size_t best_length = 1;
+    for (std::size_t i = 0; i < 8;) {
+        if (groups[i] != 0) {
+            ++i;
+            continue;
+        }
+        std::size_t end = i;
+        while (end < 8 && groups[end] == 0) {
+            ++end;
+        }
+        if (end - i > best_length) {
+            best = i;
+            best_length = end - i;
+        }
+        i = end;
+    }
+
+    for (std::size_t i = 0; i < 8;) {
+        if (i == best) {
+            put(':');
+            put(':');
+            i += best_length;
+            continue;
+        }
+        if (i != 0 && i != best + best_length) {
+            put(':');
+        }
+        put_group(groups[i]);
+        ++i;
+    }
+    return {out.data(), n};
+}
+
+std::optional<Ipv6Address> parse_ipv6(std::string_view text) noexcept {
+    std::array<std::uint16_t, 8> groups{};
+    std::size_t count = 0;
+    std::size_t gap = 8;  // Group index of "::", 8 = none
+
+    if (text.starts_with("::")) {
+        gap = 0;
+        text.remove_prefix(2);
+    }
+    while (!text.empty()) {
+        // Trailing dotted IPv4 fills the last two groups
+        const std::size_t colon = text.find(':');
+        if (text.substr(0, colon).find('.') != std::string_view::npos) {
+            std::uint8_t v4[4];
+            if (colon != std::string_view::npos || count > 6 || !parse_dotted(text, v4)) {
+                return std::nullopt;
+            }
+            groups[count++] = static_cast<std::uint16_t>((v4[0] << 8) | v4[1]);
+            groups[count++] = static_cast<std::uint16_t>((v4[2] << 8) | v4[3]);
+            text = {};
+            break;
+        }
+
+        unsigned value = 0;
+        std::size_t digits = 0;
+        while (digits < text.size() && hex_value(text[digits]) >= 0) {
+            value = (value << 4) | static_cast<unsigned>(hex_value(text[digits]));
+            if (++digits > 4) {
+                return std::nullopt;
+            }
+        }
+        if (digits == 0 || count == 8) {
+            return std::nullopt;
+        }
+        groups[count++] = static_cast<std::uint16_t>(value);
+        text.remove_prefix(digits);
+        if (text.empty()) {
+            break;
+        }
+        if (text.starts_with("::")) {
+            if (gap != 8) {
+                return std::nullopt;
+            }
+            gap = count;
+            text.remove_prefix(2);
+        } else if (text.front() == ':' && text.size() > 1) {
+            text.remove_prefix(1);
+        } else {
+            return std::nullopt;
+        }
+    }
+    if (gap == 8 ? count != 8 : count > 7) {
+        return std::nullopt;
+    }
+
+    // Move the groups after "::" to the end
+    std::array<std::uint16_t, 8> full{};
+    const std::size_t tail = count - (gap == 8 ? count : gap);
+    for (std::size_t i = 0; i < count - tail; ++i) {
+        full[i] = groups[i];
+    }
+    for (std::size_t i = 0; i < tail; ++i) {
+        full[8 - tail + i] = groups[count - tail + i];
+    }
+    Ipv6Address address{};
+    for (std::size_t i = 0; i < 8; ++i) {
+        address[2 * i] = static_cast<std::uint8_t>(full[i] >> 8);
+        address[2 * i + 1] = static_cast<std::uint8_t>(full[i]);
+    }
+    return address;
+}
+
+event::StringId intern_ipv6(const Ipv6Address& address, event::StringPool* strings) {
+    if (strings == nullptr) {
+        return event::INVALID_STRING;
+    }
+    std::array<char, kMaxIpv6Text + 1> text{};
+    return strings->intern(format_ipv6(address, text));
+}
+
+}  // namespace exeray::etw
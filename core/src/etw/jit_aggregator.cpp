@@ -0,0 +1,129 @@
+/// @file jit_aggregator.cpp
+/// @brief JitAggregator implementation (platform independent).
+
+#include "exeray/etw/jit_aggregator.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace exeray::etw {
+
+static_assert(JitAggregator::kShards == 16, "the shard is the top four bits of the hash");
+
+std::size_t JitAggregator::KeyHash::operator()(const Key& key) const noexcept {
+    std::uint64_t h = key.module_id ^ (static_cast<std::uint64_t>(key.pid) << 40) ^
+                      (static_cast<std::uint64_t>(key.pid) >> 24);
+    h *= 0x9E3779B97F4A7C15ULL;
+    return static_cast<std::size_t>(h ^ (h >> 29));
+}
+
+JitAggregator::JitAggregator(const JitConfig& config)
+    : interval_(static_cast<event::Timestamp>(config.summary_interval_ms) * 1'000'000) {}
+
+bool JitAggregator::admit(std::uint32_t pid, event::EventPayload& payload,
+                          std::uint8_t operation, event::Timestamp at) {
+    if (payload.category != event::Category::Clr) {
+        return true;
+    }
+    const auto op = static_cast<event::ClrOp>(operation);
+    if (op != event::ClrOp::ModuleLoad && op != event::ClrOp::MethodJit) {
+        return true;
+    }
+
+    event::ClrPayload& clr = payload.clr;
+    const Key key{pid, clr.load_address};
+    const std::size_t hash = KeyHash{}(key);
+    Shard& shard = shards_[hash >> (std::numeric_limits<std::size_t>::digits - 4)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.modules.find(key);
+    if (it == shard.modules.end()) {
+        if (shard.modules.size() >= kMaxModulesPerShard) {
+            if (op == event::ClrOp::MethodJit) {
+                overflowed_.fetch_add(1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+        it = shard.modules.try_emplace(key).first;
+        it->second.record.pid = pid;
+        it->second.record.module_id = clr.load_address;
+        it->second.record.first_seen = at;
+    }
+    Module& module = it->second;
+    module.record.last_seen = (std::max)(module.record.last_seen, at);
+
+    if (op == event::ClrOp::ModuleLoad) {
+        // The module's name for its compilations, which may have come first
+        module.record.assembly = clr.assembly_name;
+        module.record.dynamic = clr.is_dynamic != 0;
+        return true;
+    }
+
+    if (clr.assembly_name == event::INVALID_STRING) {
+        clr.assembly_name = module.record.assembly;
+    }
+    if (module.record.dynamic) {
+        clr.is_dynamic = 1;
+        clr.is_suspicious = 1;
+    }
+    ++module.record.methods;
+    if (clr.is_suspicious != 0) {
+        clr.methods = 1;
+        flagged_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // The first compilation shows the module in the graph
+    ++module.unreported;
+    if (!module.reported || (interval_ != 0 && at >= module.reported_at + interval_)) {
+        if (module.reported) {
+            summaries_.fetch_add(1, std::memory_order_relaxed);
+        }
+        clr.methods = module.unreported;
+        module.unreported = 0;
+        module.reported_at = at;
+        module.reported = true;
+        return true;
+    }
+    absorbed_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+std::vector<JitModuleRecord> JitAggregator::modules(std::uint32_t pid) const {
+    std::vector<JitModuleRecord> result;
+    for (const Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& [key, module] : shard.modules) {
+            if (pid == 0 || key.pid == pid) {
+                result.push_back(module.record);
+            }
+        }
+    }
+    return result;
+}
+
+JitStats JitAggregator::stats() const noexcept {
+    JitStats stats;
+    for (const Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.modules += shard.modules.size();
+    }
+    stats.absorbed = absorbed_.load(std::memory_order_relaxed);
+    stats.summaries = summaries_.load(std::memory_order_relaxed);
+    stats.flagged = flagged_.load(std::memory_order_relaxed);
+    stats.overflowed = overflowed_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void JitAggregator::clear() {
+    for (Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.modules.clear();
+    }
+    absorbed_.store(0, std::memory_order_relaxed);
+    summaries_.store(0, std::memory_order_relaxed);
+    flagged_.store(0, std::memory_order_relaxed);
+    overflowed_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace exeray::etw
@@ -0,0 +1,72 @@
+/// @file key_map.cpp
+/// @brief Registry key object to path cache (platform independent).
+
+#include "exeray/etw/key_map.hpp"
+
+namespace exeray::etw {
+
+KeyMap::KeyMap() : buckets_(std::make_unique<Bucket[]>(kBuckets)) {}
+
+void KeyMap::insert(std::uint64_t key_object, event::StringId path) {
+    if (key_object == 0 || path == event::INVALID_STRING) {
+        return;
+    }
+    const std::uint64_t hash = mix(key_object);
+    Bucket& bucket = buckets_[hash % kBuckets];
+    const std::uint32_t tag = tag_of(hash);
+    const std::uint64_t entry = static_cast<std::uint64_t>(tag) << 32 | path;
+
+    // Reopened object (address reuse): overwrite in place
+    for (auto& slot : bucket.slots) {
+        std::uint64_t current = slot.load(std::memory_order_relaxed);
+        if (static_cast<std::uint32_t>(current >> 32) == tag) {
+            slot.compare_exchange_strong(current, entry, std::memory_order_release,
+                                         std::memory_order_relaxed);
+            return;
+        }
+    }
+    for (auto& slot : bucket.slots) {
+        std::uint64_t empty = 0;
+        if (slot.compare_exchange_strong(empty, entry, std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+            size_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    // Full bucket: evict a slot picked by the low bits the bucket index
+    // did not use, so one hot key does not always hit the same victim
+    bucket.slots[(hash / kBuckets) % kWays].store(entry, std::memory_order_release);
+}
+
+void KeyMap::erase(std::uint64_t key_object) {
+    const std::uint64_t hash = mix(key_object);
+    Bucket& bucket = buckets_[hash % kBuckets];
+    const std::uint32_t tag = tag_of(hash);
+    for (auto& slot : bucket.slots) {
+        std::uint64_t current = slot.load(std::memory_order_relaxed);
+        if (static_cast<std::uint32_t>(current >> 32) == tag &&
+            slot.compare_exchange_strong(current, 0, std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+            size_.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+void KeyMap::clear() {
+    for (std::size_t b = 0; b < kBuckets; ++b) {
+        for (auto& slot : buckets_[b].slots) {
+            slot.store(0, std::memory_order_relaxed);
+        }
+    }
+    size_.store(0, std::memory_order_relaxed);
+}
+
+/// Global key map instance.
+static KeyMap g_key_map;
+
+KeyMap& key_map() {
+    return g_key_map;
+}
+
+}  // namespace exeray::etw
@@ -0,0 +1,152 @@
+/// @file logon_sessions.cpp
+/// @brief Logon sessions opened by Security audit events (platform independent).
+
+#include "exeray/etw/logon_sessions.hpp"
+
+#include <algorithm>
+
+namespace exeray::etw {
+
+namespace {
+
+std::uint64_t mixed(std::uint64_t key) noexcept {
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33;
+    return key;
+}
+
+std::size_t shard_index(std::uint64_t logon_id) noexcept {
+    return static_cast<std::size_t>(mixed(logon_id) >> 60);
+}
+
+/// @brief First entry of logon_id's bucket in a shard of shard_size entries.
+std::size_t bucket_of(std::uint64_t logon_id, std::size_t shard_size) noexcept {
+    const std::size_t buckets = shard_size / LogonSessions::kProbe;
+    return static_cast<std::size_t>(mixed(logon_id) % buckets) * LogonSessions::kProbe;
+}
+
+}  // namespace
+
+LogonSessions::LogonSessions(const LogonConfig& config)
+    : shard_size_((std::max)((config.capacity / kShards + kProbe - 1) / kProbe, std::size_t{1}) *
+                  kProbe) {
+    for (Shard& shard : shards_) {
+        shard.entries = std::make_unique<LogonSession[]>(shard_size_);
+    }
+}
+
+void LogonSessions::logon(const LogonSession& session) {
+    if (session.logon_id == 0) {
+        return;
+    }
+    Shard& shard = shards_[shard_index(session.logon_id)];
+    const std::lock_guard lock(shard.mutex);
+    LogonSession* set = &shard.entries[bucket_of(session.logon_id, shard_size_)];
+    // The session itself, else a free entry, else the oldest (its logoff
+    // was most likely missed)
+    LogonSession* victim = set;
+    for (std::size_t i = 0; i < kProbe; ++i) {
+        LogonSession& entry = set[i];
+        if (entry.logon_id == session.logon_id) {
+            victim = &entry;
+            break;
+        }
+        if (victim->logon_id != 0 && (entry.logon_id == 0 || entry.start < victim->start)) {
+            victim = &entry;
+        }
+    }
+    if (victim->logon_id != 0 && victim->logon_id != session.logon_id) {
+        ++shard.evicted;
+    }
+    *victim = session;
+    ++shard.logons;
+}
+
+bool LogonSessions::attribute(std::uint64_t logon_id, event::SecurityPayload& payload,
+                              bool close) {
+    if (logon_id == 0) {
+        return false;
+    }
+    Shard& shard = shards_[shard_index(logon_id)];
+    const std::lock_guard lock(shard.mutex);
+    LogonSession* set = &shard.entries[bucket_of(logon_id, shard_size_)];
+    for (std::size_t i = 0; i < kProbe; ++i) {
+        LogonSession& entry = set[i];
+        if (entry.logon_id != logon_id) {
+            continue;
+        }
+        if (payload.target_user == event::INVALID_STRING) {
+            payload.target_user = entry.user;
+        }
+        if (payload.logon_type == 0) {
+            payload.logon_type = entry.logon_type;
+        }
+        ++shard.attributed;
+        if (close) {
+            entry = LogonSession{};
+            ++shard.logoffs;
+        }
+        return true;
+    }
+    ++shard.unattributed;
+    return false;
+}
+
+std::optional<LogonSession> LogonSessions::find(std::uint64_t logon_id) const {
+    if (logon_id == 0) {
+        return std::nullopt;
+    }
+    const Shard& shard = shards_[shard_index(logon_id)];
+    const std::lock_guard lock(shard.mutex);
+    const LogonSession* set = &shard.entries[bucket_of(logon_id, shard_size_)];
+    for (std::size_t i = 0; i < kProbe; ++i) {
+        if (set[i].logon_id == logon_id) {
+            return set[i];
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<LogonSession> LogonSessions::sessions() const {
+    std::vector<LogonSession> result;
+    for (const Shard& shard : shards_) {
+        const std::lock_guard lock(shard.mutex);
+        for (std::size_t i = 0; i < shard_size_; ++i) {
+            if (shard.entries[i].logon_id != 0) {
+                result.push_back(shard.entries[i]);
+            }
+        }
+    }
+    return result;
+}
+
+LogonStats LogonSessions::stats() const {
+    LogonStats stats;
+    for (const Shard& shard : shards_) {
+        const std::lock_guard lock(shard.mutex);
+        stats.logons += shard.logons;
+        stats.logoffs += shard.logoffs;
+        stats.attributed += shard.attributed;
+        stats.unattributed += shard.unattributed;
+        stats.evicted += shard.evicted;
+        for (std::size_t i = 0; i < shard_size_; ++i) {
+            stats.tracked += shard.entries[i].logon_id != 0 ? 1 : 0;
+        }
+    }
+    return stats;
+}
+
+void LogonSessions::clear() {
+    for (Shard& shard : shards_) {
+        const std::lock_guard lock(shard.mutex);
+        std::fill_n(shard.entries.get(), shard_size_, LogonSession{});
+        shard.logons = 0;
+        shard.logoffs = 0;
+        shard.attributed = 0;
+        shard.unattributed = 0;
+        shard.evicted = 0;
+    }
+}
+
+}  // namespace exeray::etw
@@ -0,0 +1,234 @@
+/// @file manifest_providers.cpp
+/// @brief Runtime manifest provider registrations (platform independent).
+
+#include "exeray/etw/manifest_providers.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+#include "exeray/etw/parse_metrics.hpp"
+#include "exeray/etw/provider_mapping.hpp"
+#include "exeray/etw/providers/guids.hpp"
+
+namespace exeray::etw {
+
+namespace {
+
+bool same_guid(const GUID& a, const GUID& b) noexcept {
+    return std::memcmp(&a, &b, sizeof(GUID)) == 0;
+}
+
+/// @brief Value of a hex digit, -1 if it is none.
+int hex_digit(char c) noexcept {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/// @brief Read digits hex digits at pos into value; false if one is not hex.
+bool read_hex(std::string_view text, std::size_t& pos, std::size_t digits,
+              std::uint64_t& value) noexcept {
+    value = 0;
+    for (std::size_t i = 0; i < digits; ++i, ++pos) {
+        const int digit = hex_digit(text[pos]);
+        if (digit < 0) {
+            return false;
+        }
+        value = value << 4 | static_cast<std::uint64_t>(digit);
+    }
+    return true;
+}
+
+/// @brief Whether a GUID is dispatched to a parser of its own.
+bool built_in(const GUID& guid) noexcept {
+    if (same_guid(guid, providers::KERNEL_STACK_WALK)) {
+        return true;
+    }
+    for (std::size_t i = 0; i < kMetricProviders; ++i) {
+        const auto known = get_provider_guid(provider_name(static_cast<MetricProvider>(i)));
+        if (known && same_guid(*known, guid)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @brief Offset of a slot in ManifestProviders::Target and its transform.
+template <typename Target>
+tdh::FieldDescriptor slot_row(ManifestSlot slot, bool path) noexcept {
+    switch (slot) {
+        case ManifestSlot::Text:
+            return {{}, offsetof(Target, payload.text),
+                    path ? tdh::Transform::Path : tdh::Transform::String};
+        case ManifestSlot::Detail:
+            return {{}, offsetof(Target, payload.detail),
+                    path ? tdh::Transform::Path : tdh::Transform::String};
+        case ManifestSlot::Value:
+            return {{}, offsetof(Target, payload.value), tdh::Transform::U32};
+        default:
+            break;
+    }
+    const auto extra =
+        static_cast<std::size_t>(slot) - static_cast<std::size_t>(ManifestSlot::Extra0);
+    return {{},
+            static_cast<std::uint16_t>(offsetof(Target, values) + extra * sizeof(std::uint64_t)),
+            tdh::Transform::U64};
+}
+
+void fail(std::string* error, std::string reason) {
+    if (error != nullptr) {
+        *error = std::move(reason);
+    }
+}
+
+/// @brief Serials handed to registrations, never reused within the process.
+std::atomic<std::uint64_t> next_serial{1};
+
+}  // namespace
+
+std::optional<GUID> parse_guid(std::string_view text) noexcept {
+    if (text.size() == 38 && text.front() == '{' && text.back() == '}') {
+        text = text.substr(1, 36);
+    }
+    if (text.size() != 36 || text[8] != '-' || text[13] != '-' || text[18] != '-' ||
+        text[23] != '-') {
+        return std::nullopt;
+    }
+    GUID guid{};
+    std::size_t pos = 0;
+    std::uint64_t value = 0;
+    if (!read_hex(text, pos, 8, value)) {
+        return std::nullopt;
+    }
+    guid.Data1 = static_cast<std::uint32_t>(value);
+    ++pos;
+    if (!read_hex(text, pos, 4, value)) {
+        return std::nullopt;
+    }
+    guid.Data2 = static_cast<std::uint16_t>(value);
+    ++pos;
+    if (!read_hex(text, pos, 4, value)) {
+        return std::nullopt;
+    }
+    guid.Data3 = static_cast<std::uint16_t>(value);
+    ++pos;
+    for (std::size_t i = 0; i < 8; ++i) {
+        if (i == 2) {
+            ++pos;  // The dash between the two groups of Data4
+        }
+        if (!read_hex(text, pos, 2, value)) {
+            return std::nullopt;
+        }
+        guid.Data4[i] = static_cast<std::uint8_t>(value);
+    }
+    return guid;
+}
+
+std::optional<std::uint16_t> ManifestProviders::add(const ManifestProviderConfig& config,
+                                                    std::string* error) {
+    const auto parsed = parse_guid(config.guid);
+    if (config.name.empty() || get_provider_guid(config.name) || guid(config.name)) {
+        fail(error, "name '" + config.name + "' is empty, built in or registered");
+        return std::nullopt;
+    }
+    if (!parsed || built_in(*parsed) || find(*parsed) != nullptr) {
+        fail(error, "GUID '" + config.guid + "' is malformed, built in or registered");
+        return std::nullopt;
+    }
+    if (config.fields.size() > kMaxFields) {
+        fail(error, "more than " + std::to_string(kMaxFields) + " fields");
+        return std::nullopt;
+    }
+    for (const ManifestField& field : config.fields) {
+        if (field.property.empty() || field.slot > ManifestSlot::Extra3) {
+            fail(error, "field without a property name or slot");
+            return std::nullopt;
+        }
+    }
+    if (entries_.size() == kMaxProviders) {
+        fail(error, "more than " + std::to_string(kMaxProviders) + " providers");
+        return std::nullopt;
+    }
+
+    const auto index = static_cast<std::uint16_t>(entries_.size());
+    Entry& entry = entries_.emplace_back();
+    entry.provider = {config.name, *parsed, config.fields};
+    entry.serial = next_serial.fetch_add(1, std::memory_order_relaxed);
+    for (std::size_t i = 0; i < config.fields.size(); ++i) {
+        const ManifestField& field = config.fields[i];
+        entry.names[i].assign(field.property.begin(), field.property.end());  // ASCII names
+        tdh::FieldDescriptor row = slot_row<Target>(field.slot, field.path);
+        row.property = entry.names[i];
+        entry.alternatives.push_back(static_cast<std::uint8_t>(i));
+        for (std::size_t j = 0; j < i; ++j) {
+            if (entry.rows[j].offset == row.offset) {
+                entry.alternatives[i] = entry.alternatives[j];
+                break;
+            }
+        }
+        entry.rows.push_back(row);
+    }
+    table_.insert(*parsed, index);
+    return index;
+}
+
+std::optional<GUID> ManifestProviders::guid(std::string_view name) const noexcept {
+    for (const Entry& entry : entries_) {
+        if (entry.provider.name == name) {
+            return entry.provider.guid;
+        }
+    }
+    return std::nullopt;
+}
+
+void ManifestProviders::project(std::uint16_t index, const TdhParsedEvent& event,
+                                std::uint32_t pid, event::StringPool* strings,
+                                event::EventPayload& payload,
+                                event::PendingExtension& extension) const {
+    /// Ordinals of one registration's properties, resolved per schema
+    struct Keys {
+        std::uint64_t serial = 0;
+        std::optional<tdh::PropertyKeys<kMaxFields>> keys;
+    };
+    // Direct mapped by serial; a consumer thread sees few providers
+    thread_local std::array<Keys, 8> cache;
+
+    const Entry& entry = entries_[index];
+    Keys& keys = cache[entry.serial % cache.size()];
+    if (keys.serial != entry.serial) {
+        std::array<std::wstring_view, kMaxFields> names{};
+        for (std::size_t i = 0; i < entry.rows.size(); ++i) {
+            names[i] = entry.rows[i].property;
+        }
+        keys.keys.emplace(names);
+        keys.serial = entry.serial;
+    }
+
+    Target target{};
+    tdh::copy_fields(entry.rows, keys.keys->resolve(event), entry.alternatives, event,
+                     reinterpret_cast<std::byte*>(&target), strings);
+
+    event::ManifestPayload& manifest = target.payload;
+    manifest.process_id = pid;
+    manifest.provider = index;
+    manifest.event_id = event.event_id;
+    manifest.version = event.event_version;
+    payload.category = event::Category::Manifest;
+    payload.manifest = manifest;
+    for (const std::uint64_t value : target.values.values) {
+        if (value != 0) {
+            extension.set(event::ExtensionKind::ManifestValues, target.values);
+            break;
+        }
+    }
+}
+
+}  // namespace exeray::etw
@@ -0,0 +1,343 @@
+/// @file memory_capture.cpp
+/// @brief Budgeted captures of RWX thread start regions off the ingest path.
+
+#include "exeray/etw/memory_capture.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "exeray/etw/image_verifier.hpp"
+#include "exeray/etw/memory_regions.hpp"
+#include "exeray/event/graph.hpp"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
+
+namespace exeray::etw {
+
+std::size_t read_process_memory(std::uint32_t pid, std::uint64_t address,
+                                std::span<std::uint8_t> out) {
+#ifdef _WIN32
+    HANDLE process = OpenProcess(PROCESS_VM_READ | PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (process == nullptr) {
+        return 0;
+    }
+    SIZE_T read = 0;
+    if (ReadProcessMemory(process, reinterpret_cast<LPCVOID>(address), out.data(), out.size(),
+                          &read) == 0) {
+        // A guard or decommitted page fails the whole read: keep what
+        // precedes it, a page at a time
+        constexpr std::size_t kPage = 4096;
+        read = 0;
+        while (read < out.size()) {
+            const std::size_t chunk = (std::min)(kPage - (address + read) % kPage,
+                                                 out.size() - read);
+            SIZE_T got = 0;
+            if (ReadProcessMemory(process, reinterpret_cast<LPCVOID>(address + read),
+                                  out.data() + read, chunk, &got) == 0 ||
+                got == 0) {
+                break;
+            }
+            read += got;
+        }
+    }
+    CloseHandle(process);
+    return static_cast<std::size_t>(read);
+#else
+    (void)pid;
+    (void)address;
+    (void)out;
+    return 0;
+#endif
+}
+
+std::size_t MemoryCapture::DigestHash::operator()(
+    const std::array<std::uint8_t, 32>& digest) const noexcept {
+    std::uint64_t h = 0;
+    std::memcpy(&h, digest.data(), sizeof(h));  // SHA-256 bits are uniform already
+    return static_cast<std::size_t>(h);
+}
+
+MemoryCapture::MemoryCapture(const MemoryCaptureConfig& config, Reader reader)
+    : config_(config), reader_(std::move(reader)) {}
+
+MemoryCapture::~MemoryCapture() {
+    stop();
+}
+
+void MemoryCapture::start(event::EventGraph& graph, event::ExtensionStore& extensions,
+                          Submit submit) {
+    stop();
+    graph_ = &graph;
+    extensions_ = &extensions;
+    submit_ = std::move(submit);
+    // ExtensionIds belong to the session's store; stored bytes stay
+    for (RegionShard& shard : regions_) {
+        const std::lock_guard lock(shard.mutex);
+        shard.regions.clear();
+    }
+    {
+        const std::lock_guard lock(budget_mutex_);
+        tokens_ = static_cast<double>((std::max)(config_.bytes_per_second, config_.max_region));
+        refilled_ = std::chrono::steady_clock::now();
+    }
+    requested_.store(0, std::memory_order_relaxed);
+    captured_.store(0, std::memory_order_relaxed);
+    duplicates_.store(0, std::memory_order_relaxed);
+    unreadable_.store(0, std::memory_order_relaxed);
+    throttled_.store(0, std::memory_order_relaxed);
+    evicted_.store(0, std::memory_order_relaxed);
+    attached_.store(0, std::memory_order_relaxed);
+    backfilled_.store(0, std::memory_order_relaxed);
+    running_.store(true, std::memory_order_release);
+}
+
+void MemoryCapture::attach(std::uint8_t operation, event::EventPayload& payload) {
+    if (!running() || payload.category != event::Category::Thread ||
+        operation != static_cast<std::uint8_t>(event::ThreadOp::Start) ||
+        (payload.thread.start_region & kRegionWritable) == 0) {
+        return;
+    }
+    const event::ThreadPayload& thread = payload.thread;
+    const auto region = memory_regions().find(thread.process_id, thread.start_address);
+    if (!region) {
+        return;  // Freed since the parser saw it
+    }
+
+    const RegionKey key{thread.process_id, region->base};
+    RegionShard& shard = shard_of(thread.process_id);
+    {
+        const std::lock_guard lock(shard.mutex);
+        const auto [it, inserted] = shard.regions.try_emplace(key);
+        if (!inserted) {
+            const Known& known = it->second;
+            if (known.captured && known.extension != event::NO_EXTENSION &&
+                payload.extension == event::NO_EXTENSION) {
+                payload.extension = known.extension;
+                attached_.fetch_add(1, std::memory_order_relaxed);
+            }
+            return;
+        }
+        it->second.end = region->end();
+    }
+    requested_.fetch_add(1, std::memory_order_relaxed);
+
+    const std::lock_guard lock(mutex_);
+    queue_.push_back({thread.process_id, region->base, region->size});
+    if (active_ < (std::max)(config_.workers, std::size_t{1})) {
+        ++active_;
+        submit_([this] { run(); });
+    }
+}
+
+void MemoryCapture::run() {
+    for (;;) {
+        while (capture_batch()) {
+        }
+        // Re-checked under the lock attach() queues under, so no region
+        // queued before the worker leaves is left behind
+        const std::lock_guard lock(mutex_);
+        if (queue_.empty()) {
+            --active_;
+            idle_.notify_all();
+            return;
+        }
+    }
+}
+
+bool MemoryCapture::spend(std::uint64_t bytes) {
+    const std::lock_guard lock(budget_mutex_);
+    const auto now = std::chrono::steady_clock::now();
+    const double elapsed = std::chrono::duration<double>(now - refilled_).count();
+    refilled_ = now;
+    // At most a second's worth banked, and always enough for one region
+    const auto capacity =
+        static_cast<double>((std::max)(config_.bytes_per_second, config_.max_region));
+    tokens_ = (std::min)(capacity,
+                         tokens_ + elapsed * static_cast<double>(config_.bytes_per_second));
+    if (tokens_ < static_cast<double>(bytes)) {
+        return false;
+    }
+    tokens_ -= static_cast<double>(bytes);
+    return true;
+}
+
+bool MemoryCapture::capture_batch() {
+    std::vector<Region> batch;
+    {
+        const std::lock_guard lock(mutex_);
+        const std::size_t n = (std::min)(queue_.size(), kBatch);
+        batch.assign(queue_.begin(), queue_.begin() + static_cast<std::ptrdiff_t>(n));
+        queue_.erase(queue_.begin(), queue_.begin() + static_cast<std::ptrdiff_t>(n));
+    }
+    if (batch.empty()) {
+        return false;
+    }
+
+    std::vector<std::pair<Region, Known>> resolved;
+    std::vector<std::uint8_t> buffer;
+    for (const Region& region : batch) {
+        RegionShard& shard = shard_of(region.pid);
+        const std::uint64_t wanted = (std::min)(region.size, config_.max_region);
+        if (!spend(wanted)) {
+            // Forgotten, so a later thread start in it asks again
+            throttled_.fetch_add(1, std::memory_order_relaxed);
+            const std::lock_guard lock(shard.mutex);
+            shard.regions.erase({region.pid, region.base});
+            continue;
+        }
+
+        buffer.resize(static_cast<std::size_t>(wanted));
+        buffer.resize(reader_(region.pid, region.base, buffer));
+        event::MemoryCaptureExtension record{};
+        record.base = region.base;
+        record.size = buffer.size();
+        if (buffer.empty()) {
+            unreadable_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            const auto digest = sha256(buffer);
+            std::memcpy(record.sha256, digest.data(), digest.size());
+            captured_.fetch_add(1, std::memory_order_relaxed);
+            store(region, digest, buffer);
+        }
+
+        Known known;
+        known.extension = extensions_->append(event::ExtensionKind::MemoryCapture, record);
+        known.end = region.base + region.size;
+        known.captured = true;
+        {
+            const std::lock_guard lock(shard.mutex);
+            shard.regions[{region.pid, region.base}] = known;
+        }
+        resolved.emplace_back(region, known);
+    }
+    backfill(resolved);
+    return true;
+}
+
+void MemoryCapture::store(const Region& region, const std::array<std::uint8_t, 32>& digest,
+                          std::vector<std::uint8_t> bytes) {
+    const std::lock_guard lock(store_mutex_);
+    if (store_.contains(digest)) {
+        duplicates_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (bytes.size() > config_.store_bytes) {
+        return;
+    }
+    while (stored_ + bytes.size() > config_.store_bytes && !order_.empty()) {
+        const auto oldest = store_.find(order_.front());
+        stored_ -= oldest->second.bytes.size();
+        store_.erase(oldest);
+        order_.pop_front();
+        evicted_.fetch_add(1, std::memory_order_relaxed);
+    }
+    stored_ += bytes.size();
+    order_.push_back(digest);
+    store_.emplace(digest, MemoryCaptureRecord{digest, region.pid, region.base, std::move(bytes)});
+}
+
+void MemoryCapture::backfill(const std::vector<std::pair<Region, Known>>& resolved) {
+    if (resolved.empty()) {
+        return;
+    }
+    std::uint64_t backfilled = 0;
+    graph_->for_each_category(event::Category::Thread, [&](event::EventView view) {
+        if (view.operation() != static_cast<std::uint8_t>(event::ThreadOp::Start)) {
+            return;
+        }
+        const event::EventPayload payload = view.payload();
+        if ((payload.thread.start_region & kRegionWritable) == 0 ||
+            payload.extension != event::NO_EXTENSION) {
+            return;
+        }
+        const std::uint64_t start = payload.thread.start_address;
+        for (const auto& [region, known] : resolved) {
+            if (region.pid == payload.thread.process_id && start >= region.base &&
+                start < known.end) {
+                if (known.extension != event::NO_EXTENSION &&
+                    graph_->set_extension(view.id(), known.extension)) {
+                    ++backfilled;
+                }
+                return;
+            }
+        }
+    });
+    backfilled_.fetch_add(backfilled, std::memory_order_relaxed);
+}
+
+void MemoryCapture::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    {
+        std::unique_lock lock(mutex_);
+        idle_.wait(lock, [this] { return active_ == 0; });
+    }
+    while (capture_batch()) {
+    }
+
+    // Thread starts pushed after their region's batch was backfilled
+    std::vector<std::pair<Region, Known>> resolved;
+    for (const RegionShard& shard : regions_) {
+        const std::lock_guard lock(shard.mutex);
+        for (const auto& [key, known] : shard.regions) {
+            if (known.captured) {
+                resolved.emplace_back(Region{key.pid, key.base, known.end - key.base}, known);
+            }
+        }
+    }
+    backfill(resolved);
+}
+
+event::ExtensionId MemoryCapture::capture_of(std::uint32_t pid, std::uint64_t base) const {
+    const RegionShard& shard = shard_of(pid);
+    const std::lock_guard lock(shard.mutex);
+    const auto it = shard.regions.find({pid, base});
+    return it != shard.regions.end() ? it->second.extension : event::NO_EXTENSION;
+}
+
+std::vector<MemoryCaptureRecord> MemoryCapture::captures() const {
+    const std::lock_guard lock(store_mutex_);
+    std::vector<MemoryCaptureRecord> result;
+    result.reserve(order_.size());
+    for (const auto& digest : order_) {
+        const MemoryCaptureRecord& record = store_.at(digest);
+        result.push_back({record.sha256, record.pid, record.base, {}});
+    }
+    return result;
+}
+
+std::optional<MemoryCaptureRecord> MemoryCapture::capture(
+    const std::array<std::uint8_t, 32>& sha256) const {
+    const std::lock_guard lock(store_mutex_);
+    const auto it = store_.find(sha256);
+    if (it == store_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+MemoryCaptureStats MemoryCapture::stats() const noexcept {
+    MemoryCaptureStats stats;
+    stats.requested = requested_.load(std::memory_order_relaxed);
+    stats.captured = captured_.load(std::memory_order_relaxed);
+    stats.duplicates = duplicates_.load(std::memory_order_relaxed);
+    stats.unreadable = unreadable_.load(std::memory_order_relaxed);
+    stats.throttled = throttled_.load(std::memory_order_relaxed);
+    stats.evicted = evicted_.load(std::memory_order_relaxed);
+    {
+        const std::lock_guard lock(store_mutex_);
+        stats.stored = stored_;
+    }
+    stats.attached = attached_.load(std::memory_order_relaxed);
+    stats.backfilled = backfilled_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}  // namespace exeray::etw
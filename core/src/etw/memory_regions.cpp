@@ -0,0 +1,200 @@
+/// @file memory_regions.cpp
+/// @brief Per-process executable allocation tracking (platform independent).
+
+#include "exeray/etw/memory_regions.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace exeray::etw {
+
+namespace {
+
+constexpr std::uint32_t kExecuteMask = 0xF0;      ///< PAGE_EXECUTE through PAGE_EXECUTE_WRITECOPY
+constexpr std::uint32_t kExecuteWriteMask = 0xC0; ///< PAGE_EXECUTE_READWRITE, PAGE_EXECUTE_WRITECOPY
+
+std::uint64_t range_end(std::uint64_t base, std::uint64_t size) noexcept {
+    return size > std::numeric_limits<std::uint64_t>::max() - base
+        ? std::numeric_limits<std::uint64_t>::max() : base + size;
+}
+
+/// @brief First region ending after address.
+std::vector<MemoryRegion>::iterator first_after(std::vector<MemoryRegion>& regions,
+                                                std::uint64_t address) {
+    return std::partition_point(regions.begin(), regions.end(),
+                                [address](const MemoryRegion& r) { return r.end() <= address; });
+}
+
+}  // namespace
+
+bool MemoryRegionTracker::tracked(std::uint32_t protection) noexcept {
+    return (protection & kExecuteMask) != 0;
+}
+
+void MemoryRegionTracker::carve(std::vector<MemoryRegion>& regions, std::uint64_t begin,
+                                std::uint64_t end) {
+    auto it = first_after(regions, begin);
+    while (it != regions.end() && it->base < end) {
+        if (it->base < begin && it->end() > end) {
+            // Hole in the middle: keep both sides
+            MemoryRegion right = *it;
+            right.base = end;
+            right.size = it->end() - end;
+            it->size = begin - it->base;
+            regions.insert(it + 1, right);
+            return;
+        }
+        if (it->base < begin) {
+            it->size = begin - it->base;
+            ++it;
+        } else if (it->end() > end) {
+            it->size = it->end() - end;
+            it->base = end;
+            return;
+        } else {
+            it = regions.erase(it);
+        }
+    }
+}
+
+void MemoryRegionTracker::allocate(std::uint32_t pid, std::uint64_t base, std::uint64_t size,
+                                   std::uint32_t allocator_pid, std::uint32_t protection,
+                                   std::uint64_t timestamp) {
+    if (!tracked(protection) || size == 0) {
+        return;
+    }
+    MemoryRegion region;
+    region.base = base;
+    region.size = range_end(base, size) - base;
+    region.allocated = timestamp;
+    region.allocator_pid = allocator_pid;
+    region.flags = kRegionExecutable;
+    if ((protection & kExecuteWriteMask) != 0) {
+        region.flags |= kRegionWritable;
+    }
+    if (allocator_pid != pid) {
+        region.flags |= kRegionRemote;
+    }
+    insert(pid, region);
+}
+
+void MemoryRegionTracker::restore(std::uint32_t pid, const MemoryRegion& region) {
+    if (region.size == 0) {
+        return;
+    }
+    MemoryRegion copy = region;
+    copy.size = range_end(region.base, region.size) - region.base;
+    insert(pid, copy);
+}
+
+void MemoryRegionTracker::insert(std::uint32_t pid, const MemoryRegion& region) {
+    Shard& shard = shard_of(pid);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto found = shard.processes.find(pid);
+    if (found == shard.processes.end()) {
+        if (shard.processes.size() >= kMaxProcesses) {
+            shard.processes.erase(std::min_element(
+                shard.processes.begin(), shard.processes.end(), [](const auto& a, const auto& b) {
+                    return a.second.last_active < b.second.last_active;
+                }));
+        }
+        found = shard.processes.try_emplace(pid).first;
+    }
+    Process& process = found->second;
+    process.last_active = (std::max)(process.last_active, region.allocated);
+
+    carve(process.regions, region.base, region.end());
+    if (process.regions.size() >= kMaxRegions) {
+        process.regions.erase(std::min_element(
+            process.regions.begin(), process.regions.end(),
+            [](const MemoryRegion& a, const MemoryRegion& b) { return a.allocated < b.allocated; }));
+    }
+    process.regions.insert(first_after(process.regions, region.base), region);
+}
+
+void MemoryRegionTracker::free(std::uint32_t pid, std::uint64_t base, std::uint64_t size) {
+    Shard& shard = shard_of(pid);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const auto found = shard.processes.find(pid);
+    if (found == shard.processes.end()) {
+        return;
+    }
+    auto& regions = found->second.regions;
+    if (size == 0) {
+        // MEM_RELEASE frees the whole allocation
+        const auto it = first_after(regions, base);
+        if (it != regions.end() && it->base <= base) {
+            regions.erase(it);
+        }
+    } else {
+        carve(regions, base, range_end(base, size));
+    }
+    if (regions.empty()) {
+        shard.processes.erase(found);
+    }
+}
+
+void MemoryRegionTracker::forget(std::uint32_t pid) {
+    Shard& shard = shard_of(pid);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.processes.erase(pid);
+}
+
+std::optional<MemoryRegion> MemoryRegionTracker::find(std::uint32_t pid,
+                                                      std::uint64_t address) const {
+    const Shard& shard = shard_of(pid);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const auto found = shard.processes.find(pid);
+    if (found == shard.processes.end()) {
+        return std::nullopt;
+    }
+    const auto& regions = found->second.regions;
+    const auto it = std::partition_point(
+        regions.begin(), regions.end(),
+        [address](const MemoryRegion& r) { return r.end() <= address; });
+    if (it == regions.end() || it->base > address) {
+        return std::nullopt;
+    }
+    return *it;
+}
+
+std::vector<std::pair<std::uint32_t, MemoryRegion>> MemoryRegionTracker::regions() const {
+    std::vector<std::pair<std::uint32_t, MemoryRegion>> all;
+    for (const Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& [pid, process] : shard.processes) {
+            for (const MemoryRegion& region : process.regions) {
+                all.emplace_back(pid, region);
+            }
+        }
+    }
+    return all;
+}
+
+std::size_t MemoryRegionTracker::size() const {
+    std::size_t total = 0;
+    for (const Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& [pid, process] : shard.processes) {
+            total += process.regions.size();
+        }
+    }
+    return total;
+}
+
+void MemoryRegionTracker::clear() {
+    for (Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.processes.clear();
+    }
+}
+
+/// Global region tracker instance.
+static MemoryRegionTracker g_memory_regions;
+
+MemoryRegionTracker& memory_regions() {
+    return g_memory_regions;
+}
+
+}  // namespace exeray::etw
@@ -0,0 +1,378 @@
+/// @file module_map.cpp
+/// @brief Per-process loaded module map (platform independent).
+
+#include "exeray/etw/module_map.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace exeray::etw {
+
+namespace {
+
+constexpr std::size_t kMinTable = 64;
+
+std::size_t home_of(std::uint32_t pid) noexcept {
+    return (pid >> 2) & (ModuleMap::kMaxProcesses - 1);  // PIDs are multiples of four
+}
+
+/// Modules staged by this thread, all for one map.
+struct Staged {
+    static constexpr std::size_t kMaxModules = 1024;  ///< Flushed when reached
+
+    ModuleMap* owner = nullptr;
+    std::vector<std::pair<std::uint32_t, ModuleInfo>> modules;
+};
+
+thread_local Staged t_staged;
+
+}  // namespace
+
+static_assert((ModuleMap::kMaxProcesses & (ModuleMap::kMaxProcesses - 1)) == 0,
+              "kMaxProcesses must be a power of two");
+
+ModuleMap::ModuleMap() : processes_(std::make_unique<Process[]>(kMaxProcesses)) {}
+
+ModuleMap::~ModuleMap() {
+    if (t_staged.owner == this) {
+        t_staged.modules.clear();
+        t_staged.owner = nullptr;
+    }
+}
+
+const ModuleMap::Process* ModuleMap::lookup(std::uint32_t pid) const noexcept {
+    const std::size_t home = home_of(pid);
+    for (std::size_t i = 0; i < kMaxProcesses; ++i) {
+        const Process& process = processes_[(home + i) & (kMaxProcesses - 1)];
+        const std::uint32_t held = process.pid.load(std::memory_order_acquire);
+        if (held == pid) {
+            return &process;
+        }
+        if (held == 0) {
+            return nullptr;  // Probe chains never cross a slot that was never used
+        }
+    }
+    return nullptr;
+}
+
+ModuleMap::Process* ModuleMap::lookup_or_claim(std::uint32_t pid) noexcept {
+    const std::size_t home = home_of(pid);
+    Process* reusable = nullptr;
+    for (std::size_t i = 0; i < kMaxProcesses; ++i) {
+        Process& process = processes_[(home + i) & (kMaxProcesses - 1)];
+        const std::uint32_t held = process.pid.load(std::memory_order_relaxed);
+        if (held == pid) {
+            return &process;
+        }
+        if (held == kForgotten && reusable == nullptr) {
+            reusable = &process;
+        } else if (held == 0) {
+            if (reusable == nullptr) {
+                reusable = &process;
+            }
+            break;
+        }
+    }
+    if (reusable != nullptr) {
+        // Readers check the pid under the sequence counter, so a reused slot
+        // never hands them the previous process's modules
+        const std::uint32_t seq = reusable->seq.load(std::memory_order_relaxed);
+        reusable->seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        reusable->count.store(0, std::memory_order_relaxed);
+        reusable->pid.store(pid, std::memory_order_relaxed);
+        reusable->seq.store(seq + 2, std::memory_order_release);
+    }
+    return reusable;
+}
+
+template <typename Visit>
+bool ModuleMap::read(const Process& process, std::uint32_t pid, Visit&& visit) {
+    for (;;) {
+        const std::uint32_t before = process.seq.load(std::memory_order_acquire);
+        if ((before & 1) != 0) {
+            continue;
+        }
+        const bool held = process.pid.load(std::memory_order_relaxed) == pid;
+        if (held) {
+            const Table* table = process.table.load(std::memory_order_acquire);
+            const std::size_t count =
+                table == nullptr ? 0
+                                 : std::min<std::size_t>(process.count.load(std::memory_order_relaxed),
+                                                         table->capacity);
+            visit(table == nullptr ? nullptr : table->entries.get(), count);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (process.seq.load(std::memory_order_relaxed) == before) {
+            return held;
+        }
+    }
+}
+
+std::vector<ModuleInfo> ModuleMap::snapshot(const Process& process) {
+    std::vector<ModuleInfo> modules;
+    const Table* table = process.table.load(std::memory_order_relaxed);
+    const std::size_t count = process.count.load(std::memory_order_relaxed);
+    modules.reserve(count + 1);
+    for (std::size_t i = 0; i < count; ++i) {
+        const Entry& entry = table->entries[i];
+        const std::uint64_t base = entry.base.load(std::memory_order_relaxed);
+        modules.push_back({base, entry.end.load(std::memory_order_relaxed) - base,
+                           entry.path.load(std::memory_order_relaxed)});
+    }
+    return modules;
+}
+
+void ModuleMap::publish(Process& process, const std::vector<ModuleInfo>& modules) {
+    Table* table = process.table.load(std::memory_order_relaxed);
+    if (table == nullptr || table->capacity < modules.size()) {
+        // Grow into a new table; readers may still be searching the old one
+        const std::size_t capacity =
+            std::max(kMinTable, table == nullptr ? 0 : table->capacity * 2);
+        process.tables.push_back(std::make_unique<Table>(std::max(capacity, modules.size())));
+        table = process.tables.back().get();
+    }
+
+    const std::uint32_t seq = process.seq.load(std::memory_order_relaxed);
+    process.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (std::size_t i = 0; i < modules.size(); ++i) {
+        Entry& entry = table->entries[i];
+        entry.base.store(modules[i].base, std::memory_order_relaxed);
+        entry.end.store(modules[i].end(), std::memory_order_relaxed);
+        entry.path.store(modules[i].path, std::memory_order_relaxed);
+    }
+    process.table.store(table, std::memory_order_release);
+    process.count.store(static_cast<std::uint32_t>(modules.size()), std::memory_order_relaxed);
+    process.seq.store(seq + 2, std::memory_order_release);
+}
+
+void ModuleMap::load(std::uint32_t pid, std::uint64_t base, std::uint64_t size,
+                     event::StringId path) {
+    flush_staged();
+    if (pid == 0 || pid == kForgotten || size == 0) {
+        return;
+    }
+    size = std::min(size, std::numeric_limits<std::uint64_t>::max() - base);
+    const std::pair<std::uint32_t, ModuleInfo> module{pid, {base, size, path}};
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    load_locked(std::span(&module, 1));
+}
+
+void ModuleMap::stage(std::uint32_t pid, std::uint64_t base, std::uint64_t size,
+                      event::StringId path) {
+    if (pid == 0 || pid == kForgotten || size == 0) {
+        return;
+    }
+    if (t_staged.owner != this) {
+        if (t_staged.owner != nullptr) {
+            t_staged.owner->flush_staged();
+        }
+        t_staged.owner = this;
+    }
+    size = std::min(size, std::numeric_limits<std::uint64_t>::max() - base);
+    t_staged.modules.emplace_back(pid, ModuleInfo{base, size, path});
+    if (t_staged.modules.size() >= Staged::kMaxModules) {
+        flush_staged();
+    }
+}
+
+void ModuleMap::flush_staged() {
+    if (t_staged.owner != this || t_staged.modules.empty()) {
+        return;
+    }
+    // Group by process, keeping each one's modules in rundown order
+    auto& batch = t_staged.modules;
+    std::stable_sort(batch.begin(), batch.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        load_locked(batch);
+    }
+    batch.clear();
+}
+
+void ModuleMap::load_locked(std::span<const std::pair<std::uint32_t, ModuleInfo>> batch) {
+    std::size_t begin = 0;
+    while (begin < batch.size()) {
+        const std::uint32_t pid = batch[begin].first;
+        std::size_t end = begin + 1;
+        while (end < batch.size() && batch[end].first == pid) {
+            ++end;
+        }
+        if (Process* process = lookup_or_claim(pid)) {
+            // One copy and one publish however many modules the process gets
+            std::vector<ModuleInfo> modules = snapshot(*process);
+            bool changed = false;
+            for (std::size_t i = begin; i < end; ++i) {
+                changed = insert(modules, batch[i].second) || changed;
+            }
+            if (changed) {
+                publish(*process, modules);
+            }
+        }
+        begin = end;
+    }
+}
+
+bool ModuleMap::insert(std::vector<ModuleInfo>& modules, const ModuleInfo& module) {
+    // A stale module here means its unload was lost; the new one wins
+    std::erase_if(modules, [&module](const ModuleInfo& m) {
+        return m.base < module.end() && m.end() > module.base;
+    });
+    if (modules.size() >= kMaxModules) {
+        return false;
+    }
+    modules.insert(std::partition_point(modules.begin(), modules.end(),
+                                        [&module](const ModuleInfo& m) {
+                                            return m.base < module.base;
+                                        }),
+                   module);
+    return true;
+}
+
+void ModuleMap::unload(std::uint32_t pid, std::uint64_t base) {
+    flush_staged();
+    std::lock_guard<std::mutex> lock(mutex_);
+    Process* process = lookup(pid);
+    if (process == nullptr) {
+        return;
+    }
+    std::vector<ModuleInfo> modules = snapshot(*process);
+    const auto it = std::partition_point(modules.begin(), modules.end(),
+                                         [base](const ModuleInfo& m) { return m.base < base; });
+    if (it == modules.end() || it->base != base) {
+        return;
+    }
+    modules.erase(it);
+    publish(*process, modules);
+}
+
+void ModuleMap::forget(std::uint32_t pid) {
+    flush_staged();
+    std::lock_guard<std::mutex> lock(mutex_);
+    Process* found = lookup(pid);
+    if (found == nullptr) {
+        return;
+    }
+    // Keep the tables: readers may still be in them, and the next process
+    // claiming this slot reuses them
+    Process& process = *found;
+    const std::uint32_t seq = process.seq.load(std::memory_order_relaxed);
+    process.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    process.count.store(0, std::memory_order_relaxed);
+    process.pid.store(kForgotten, std::memory_order_relaxed);
+    process.seq.store(seq + 2, std::memory_order_release);
+}
+
+std::optional<ModuleInfo> ModuleMap::find(std::uint32_t pid, std::uint64_t address) const {
+    const Process* process = lookup(pid);
+    if (process == nullptr) {
+        return std::nullopt;
+    }
+    std::optional<ModuleInfo> result;
+    read(*process, pid, [&result, address](const Entry* entries, std::size_t count) {
+        result.reset();
+        // Last module starting at or below address
+        std::size_t lo = 0;
+        std::size_t hi = count;
+        while (lo < hi) {
+            const std::size_t mid = lo + (hi - lo) / 2;
+            if (entries[mid].base.load(std::memory_order_relaxed) <= address) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo == 0) {
+            return;
+        }
+        const Entry& entry = entries[lo - 1];
+        const std::uint64_t base = entry.base.load(std::memory_order_relaxed);
+        const std::uint64_t end = entry.end.load(std::memory_order_relaxed);
+        if (address < end) {
+            result = ModuleInfo{base, end - base, entry.path.load(std::memory_order_relaxed)};
+        }
+    });
+    return result;
+}
+
+std::size_t ModuleMap::count(std::uint32_t pid) const {
+    const Process* process = lookup(pid);
+    if (process == nullptr) {
+        return 0;
+    }
+    std::size_t result = 0;
+    read(*process, pid, [&result](const Entry* /*entries*/, std::size_t count) { result = count; });
+    return result;
+}
+
+std::vector<ModuleInfo> ModuleMap::modules(std::uint32_t pid) const {
+    const Process* process = lookup(pid);
+    if (process == nullptr) {
+        return {};
+    }
+    std::vector<ModuleInfo> result;
+    read(*process, pid, [&result](const Entry* entries, std::size_t count) {
+        result.clear();
+        result.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::uint64_t base = entries[i].base.load(std::memory_order_relaxed);
+            result.push_back({base, entries[i].end.load(std::memory_order_relaxed) - base,
+                              entries[i].path.load(std::memory_order_relaxed)});
+        }
+    });
+    return result;
+}
+
+std::vector<std::pair<std::uint32_t, ModuleInfo>> ModuleMap::all() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::pair<std::uint32_t, ModuleInfo>> result;
+    for (std::size_t i = 0; i < kMaxProcesses; ++i) {
+        const std::uint32_t pid = processes_[i].pid.load(std::memory_order_relaxed);
+        if (pid != 0 && pid != kForgotten) {
+            for (const ModuleInfo& module : snapshot(processes_[i])) {
+                result.emplace_back(pid, module);
+            }
+        }
+    }
+    return result;
+}
+
+std::size_t ModuleMap::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < kMaxProcesses; ++i) {
+        const std::uint32_t pid = processes_[i].pid.load(std::memory_order_relaxed);
+        if (pid != 0 && pid != kForgotten) {
+            total += processes_[i].count.load(std::memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+void ModuleMap::clear() {
+    if (t_staged.owner == this) {
+        t_staged.modules.clear();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::size_t i = 0; i < kMaxProcesses; ++i) {
+        Process& process = processes_[i];
+        process.pid.store(0, std::memory_order_relaxed);
+        process.seq.store(0, std::memory_order_relaxed);
+        process.table.store(nullptr, std::memory_order_relaxed);
+        process.count.store(0, std::memory_order_relaxed);
+        process.tables.clear();
+    }
+}
+
+/// Global module map instance.
+static ModuleMap g_module_map;
+
+ModuleMap& module_map() {
+    return g_module_map;
+}
+
+}  // namespace exeray::etw
@@ -0,0 +1,261 @@
+/// @file parse_metrics.cpp
+/// @brief ParseMetrics implementation (platform independent).
+
+#include "exeray/etw/parse_metrics.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <unordered_map>
+
+namespace exeray::etw {
+
+namespace {
+
+/// @brief Counter written by one thread, read by any.
+///
+/// A plain load and store instead of fetch_add: the owner is the only
+/// writer, so no locked instruction is needed on the hot path.
+struct Counter {
+    std::atomic<std::uint64_t> value{0};
+
+    void add(std::uint64_t n) noexcept {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::uint64_t get() const noexcept {
+        return value.load(std::memory_order_relaxed);
+    }
+
+    void clear() noexcept { value.store(0, std::memory_order_relaxed); }
+};
+
+/// Probes before a (provider, event ID) pair is given up as untracked.
+constexpr std::size_t kMaxProbes = 16;
+
+/// @brief Table key of a pair; 0 marks a free slot.
+constexpr std::uint32_t key_of(MetricProvider provider, std::uint16_t event_id) noexcept {
+    return ((static_cast<std::uint32_t>(provider) + 1) << 16) | event_id;
+}
+
+}  // namespace
+
+struct ParseMetrics::ThreadTable {
+    struct ProviderRow {
+        Counter events;
+        Counter failures;
+        Counter cycles;
+        std::array<Counter, ProviderMetrics::kCycleBuckets> histogram;
+    };
+
+    struct EventRow {
+        std::atomic<std::uint32_t> key{0};
+        Counter events;
+        Counter failures;
+        Counter cycles;
+    };
+
+    std::array<ProviderRow, kMetricProviders> providers;
+    std::array<EventRow, kEventSlots> events;
+    Counter untracked;
+
+    /// @brief Row of a pair, claiming a free slot if needed; nullptr if full.
+    EventRow* find_or_claim(std::uint32_t key) noexcept {
+        static_assert((kEventSlots & (kEventSlots - 1)) == 0, "kEventSlots must be a power of two");
+        std::size_t slot = (key * 0x9E3779B1U) & (kEventSlots - 1);
+        for (std::size_t i = 0; i < kMaxProbes; ++i, slot = (slot + 1) & (kEventSlots - 1)) {
+            EventRow& row = events[slot];
+            const std::uint32_t current = row.key.load(std::memory_order_relaxed);
+            if (current == key) {
+                return &row;
+            }
+            if (current == 0) {
+                // Readers see the key only after the counters were zeroed
+                row.key.store(key, std::memory_order_release);
+                return &row;
+            }
+        }
+        return nullptr;
+    }
+
+    void clear() noexcept {
+        for (ProviderRow& row : providers) {
+            row.events.clear();
+            row.failures.clear();
+            row.cycles.clear();
+            for (Counter& bucket : row.histogram) {
+                bucket.clear();
+            }
+        }
+        for (EventRow& row : events) {
+            row.events.clear();
+            row.failures.clear();
+            row.cycles.clear();
+            row.key.store(0, std::memory_order_release);
+        }
+        untracked.clear();
+    }
+};
+
+/// @brief Returns the calling thread's table to its owner when the thread exits.
+struct ThreadLease {
+    ParseMetrics* owner = nullptr;
+    ParseMetrics::ThreadTable* table = nullptr;
+
+    ~ThreadLease() {
+        if (owner != nullptr) {
+            owner->release(table);
+        }
+    }
+};
+
+namespace {
+
+thread_local ThreadLease lease;
+
+}  // namespace
+
+std::string_view provider_name(MetricProvider provider) noexcept {
+    switch (provider) {
+        case MetricProvider::Process:    return "Process";
+        case MetricProvider::File:       return "File";
+        case MetricProvider::Registry:   return "Registry";
+        case MetricProvider::Network:    return "Network";
+        case MetricProvider::Image:      return "Image";
+        case MetricProvider::Thread:     return "Thread";
+        case MetricProvider::Memory:     return "Memory";
+        case MetricProvider::PowerShell: return "PowerShell";
+        case MetricProvider::Amsi:       return "AMSI";
+        case MetricProvider::Dns:        return "DNS";
+        case MetricProvider::Security:   return "Security";
+        case MetricProvider::Wmi:        return "WMI";
+        case MetricProvider::Clr:        return "CLR";
+        case MetricProvider::Manifest:   return "Manifest";
+        default:                         return "Unknown";
+    }
+}
+
+ParseMetrics& ParseMetrics::global() noexcept {
+    // Constructed before the first lease, so it outlives every thread's lease
+    static ParseMetrics instance;
+    return instance;
+}
+
+ParseMetrics::~ParseMetrics() = default;
+
+ParseMetrics::ThreadTable& ParseMetrics::local() {
+    if (lease.table != nullptr) {
+        return *lease.table;
+    }
+    std::lock_guard lock(mutex_);
+    if (!free_.empty()) {
+        lease.table = free_.back();
+        free_.pop_back();
+    } else {
+        tables_.push_back(std::make_unique<ThreadTable>());
+        lease.table = tables_.back().get();
+    }
+    lease.owner = this;
+    return *lease.table;
+}
+
+void ParseMetrics::release(ThreadTable* table) noexcept {
+    std::lock_guard lock(mutex_);
+    free_.push_back(table);
+}
+
+std::size_t ParseMetrics::bucket_of(std::uint64_t cycles) noexcept {
+    return (std::min)(static_cast<std::size_t>(std::bit_width(cycles)),
+                      ProviderMetrics::kCycleBuckets - 1);
+}
+
+void ParseMetrics::record(MetricProvider provider, std::uint16_t event_id, bool valid,
+                          std::uint64_t cycles) noexcept {
+    const auto index = static_cast<std::size_t>(provider);
+    if (index >= kMetricProviders) {
+        return;
+    }
+    ThreadTable* table = lease.table;
+    if (table == nullptr) {
+        try {
+            table = &local();
+        } catch (...) {
+            return;  // Out of memory: lose the sample, not the event
+        }
+    }
+
+    ThreadTable::ProviderRow& row = table->providers[index];
+    row.events.add(1);
+    row.cycles.add(cycles);
+    row.histogram[bucket_of(cycles)].add(1);
+    if (!valid) {
+        row.failures.add(1);
+    }
+
+    ThreadTable::EventRow* event = table->find_or_claim(key_of(provider, event_id));
+    if (event == nullptr) {
+        table->untracked.add(1);
+        return;
+    }
+    event->events.add(1);
+    event->cycles.add(cycles);
+    if (!valid) {
+        event->failures.add(1);
+    }
+}
+
+ParseMetricsSnapshot ParseMetrics::snapshot() const {
+    ParseMetricsSnapshot result;
+    std::unordered_map<std::uint32_t, EventMetrics> merged;
+
+    std::lock_guard lock(mutex_);
+    for (const auto& table : tables_) {
+        for (std::size_t p = 0; p < kMetricProviders; ++p) {
+            const ThreadTable::ProviderRow& row = table->providers[p];
+            ProviderMetrics& out = result.providers[p];
+            out.events += row.events.get();
+            out.failures += row.failures.get();
+            out.cycles += row.cycles.get();
+            for (std::size_t b = 0; b < ProviderMetrics::kCycleBuckets; ++b) {
+                out.histogram[b] += row.histogram[b].get();
+            }
+        }
+        for (const ThreadTable::EventRow& row : table->events) {
+            const std::uint32_t key = row.key.load(std::memory_order_acquire);
+            if (key == 0) {
+                continue;
+            }
+            EventMetrics& out = merged[key];
+            out.provider = static_cast<MetricProvider>((key >> 16) - 1);
+            out.event_id = static_cast<std::uint16_t>(key & 0xFFFF);
+            out.events += row.events.get();
+            out.failures += row.failures.get();
+            out.cycles += row.cycles.get();
+        }
+        result.untracked += table->untracked.get();
+    }
+
+    result.events.reserve(merged.size());
+    for (const auto& [key, metrics] : merged) {
+        result.events.push_back(metrics);
+    }
+    std::sort(result.events.begin(), result.events.end(),
+              [](const EventMetrics& a, const EventMetrics& b) {
+                  if (a.cycles != b.cycles) {
+                      return a.cycles > b.cycles;
+                  }
+                  if (a.provider != b.provider) {
+                      return a.provider < b.provider;
+                  }
+                  return a.event_id < b.event_id;
+              });
+    return result;
+}
+
+void ParseMetrics::reset() noexcept {
+    std::lock_guard lock(mutex_);
+    for (const auto& table : tables_) {
+        table->clear();
+    }
+}
+
+}  // namespace exeray::etw
@@ -6,16 +6,17 @@
 
 #ifdef _WIN32
 
+#include "exeray/etw/content_cache.hpp"
 #include "exeray/etw/event_ids.hpp"
 #include "exeray/etw/parser.hpp"
 #include "exeray/etw/parser_utils.hpp"
 #include "exeray/etw/session.hpp"
 #include "exeray/etw/tdh_parser.hpp"
+#include "exeray/etw/text_search.hpp"
 #include "exeray/event/string_pool.hpp"
 
 #include <algorithm>
 #include <cstring>
-#include <cwctype>
 #include <string>
 #include <string_view>
 
@@ -25,22 +26,6 @@ namespace exeray::etw {
 
 namespace {
 
-/// @brief Case-insensitive substring search for wide strings.
-/// @param haystack The string to search in.
-/// @param needle The substring to search for.
-/// @return true if needle is found in haystack (case-insensitive).
-bool contains_case_insensitive(std::wstring_view haystack, std::wstring_view needle) {
-    if (needle.empty()) return true;
-    if (haystack.size() < needle.size()) return false;
-
-    auto it = std::ranges::search(haystack, needle,
-        [](wchar_t a, wchar_t b) {
-            return std::towlower(a) == std::towlower(b);
-        });
-
-    return !it.empty();
-}
-
 /// @brief AMSI scan result values.
 ///
 /// Based on AMSI_RESULT enumeration from amsi.h.
@@ -91,7 +76,7 @@ const char* amsi_result_name(uint32_t result) {
 bool is_bypass_attempt(uint32_t content_size, std::wstring_view app_name) {
     // Empty content after PowerShell is suspicious
     if (content_size == 0) {
-        return contains_case_insensitive(app_name, L"PowerShell");
+        return contains_icase(app_name, L"PowerShell");
     }
     return false;
 }
@@ -99,17 +84,18 @@ bool is_bypass_attempt(uint32_t content_size, std::wstring_view app_name) {
 /// @brief Log AMSI scan event.
 void log_amsi_scan(uint32_t pid, uint32_t result, uint32_t content_size,
                    bool is_bypass) {
-    const char* result_name = amsi_result_name(result);
     if (is_bypass) {
-        EXERAY_WARN("AMSI bypass attempt: pid={}, empty content from PowerShell", pid);
+        EXERAY_WARN_LIMITED(kSuspiciousLogsPerSecond,
+                            "AMSI bypass attempt: pid={}, empty content from PowerShell", pid);
     } else if (is_malware(result)) {
-        EXERAY_WARN("AMSI malware detected: pid={}, result={} (0x{:X}), size={}",
-                    pid, result_name, result, content_size);
+        EXERAY_WARN_LIMITED(kSuspiciousLogsPerSecond,
+                            "AMSI malware detected: pid={}, result={} (0x{:X}), size={}", pid,
+                            amsi_result_name(result), result, content_size);
     } else if (is_blocked_by_admin(result)) {
         EXERAY_INFO("AMSI blocked by admin: pid={}, size={}", pid, content_size);
     } else {
         EXERAY_TRACE("AMSI scan: pid={}, result={}, size={}",
-                     pid, result_name, content_size);
+                     pid, amsi_result_name(result), content_size);
     }
 }
 
@@ -166,10 +152,26 @@ ParsedEvent parse_scan_buffer_event(const EVENT_RECORD* record, event::StringPoo
         offset += (content_name.size() + 1) * sizeof(wchar_t);
     }
 
-    // Extract content size (4 bytes)
+    // Extract content size (4 bytes); the content follows, possibly truncated
     uint32_t content_size = 0;
     if (offset + 4 <= len) {
         std::memcpy(&content_size, data + offset, sizeof(uint32_t));
+        offset += 4;
+    }
+    const size_t content_bytes =
+        offset < len ? (std::min)(static_cast<size_t>(content_size), len - offset) : 0;
+
+    // Resubmitted buffers are only logged again if the result changed
+    bool repeat = false;
+    if (ContentCache* cache = ContentCache::current(); cache != nullptr && content_bytes != 0) {
+        const std::uint64_t hash = content_hash(data + offset, content_bytes);
+        const auto bytes = static_cast<std::uint32_t>(content_bytes);
+        if (ContentCache::Entry* seen = cache->find(hash, bytes)) {
+            repeat = seen->verdict == scan_result;
+            seen->verdict = scan_result;
+        } else {
+            cache->insert(hash, bytes, scan_result);
+        }
     }
 
     // Check for bypass attempt
@@ -177,11 +179,7 @@ ParsedEvent parse_scan_buffer_event(const EVENT_RECORD* record, event::StringPoo
 
     // Set payload with interned strings
     result.payload.amsi.content = event::INVALID_STRING;  // Content often binary/large
-    if (strings != nullptr && !app_name.empty()) {
-        result.payload.amsi.app_name = strings->intern_wide(app_name);
-    } else {
-        result.payload.amsi.app_name = event::INVALID_STRING;
-    }
+    set_wstring(result, result.payload.amsi.app_name, app_name, strings);
     result.payload.amsi.scan_result = scan_result;
     result.payload.amsi.content_size = content_size;
 
@@ -195,7 +193,9 @@ ParsedEvent parse_scan_buffer_event(const EVENT_RECORD* record, event::StringPoo
     }
 
     // Log the scan
-    log_amsi_scan(result.pid, scan_result, content_size, bypass_detected);
+    if (!repeat) {
+        log_amsi_scan(result.pid, scan_result, content_size, bypass_detected);
+    }
 
     result.valid = true;
     return result;
@@ -213,12 +213,14 @@ ParsedEvent parse_amsi_event(const EVENT_RECORD* record, event::StringPool* stri
     switch (event_id) {
         case ids::amsi::SCAN_BUFFER:
             return parse_scan_buffer_event(record, strings);
-        default:
+        default: {
             // Unknown event ID - try TDH fallback
-            if (auto tdh_result = parse_with_tdh(record)) {
-                return convert_tdh_to_amsi(*tdh_result, record, strings);
+            TdhParsedEvent tdh_event;
+            if (parse_with_tdh(record, tdh_event)) {
+                return convert_tdh_to_amsi(tdh_event, record, strings);
             }
             return ParsedEvent{.valid = false};
+        }
     }
 }
 
@@ -3,69 +3,108 @@
 
 #ifdef _WIN32
 
+#include "exeray/etw/manifest_providers.hpp"
+#include "exeray/etw/parse_metrics.hpp"
 #include "exeray/etw/parser.hpp"
+#include "exeray/etw/parser_utils.hpp"
+#include "exeray/etw/provider_table.hpp"
 #include "exeray/etw/session.hpp"
-
-#include <cstring>
-#include <unordered_map>
+#include "exeray/etw/tdh/parser.hpp"
+#include "exeray/trace_spans.hpp"
 
 namespace exeray::etw {
 
 namespace {
 
-/// @brief Hash functor for GUID keys in unordered_map.
-struct GuidHash {
-    std::size_t operator()(const GUID& g) const noexcept {
-        // Combine Data1, Data2, Data3, and Data4 into a single hash
-        std::size_t h = std::hash<uint32_t>{}(g.Data1);
-        h ^= std::hash<uint16_t>{}(g.Data2) + 0x9e3779b9 + (h << 6) + (h >> 2);
-        h ^= std::hash<uint16_t>{}(g.Data3) + 0x9e3779b9 + (h << 6) + (h >> 2);
-        for (int i = 0; i < 8; ++i) {
-            h ^= std::hash<uint8_t>{}(g.Data4[i]) + 0x9e3779b9 + (h << 6) + (h >> 2);
-        }
-        return h;
-    }
-};
+/// @brief Function pointer type for parser functions.
+using ParseFunc = ParsedEvent(*)(const EVENT_RECORD*, event::StringPool*);
 
-/// @brief Equality functor for GUID keys in unordered_map.
-struct GuidEqual {
-    bool operator()(const GUID& a, const GUID& b) const noexcept {
-        return std::memcmp(&a, &b, sizeof(GUID)) == 0;
-    }
+/// @brief Parser of a provider and the provider it is counted as.
+struct DispatchEntry {
+    ParseFunc parse = nullptr;
+    MetricProvider provider = MetricProvider::Unknown;
 };
 
-/// @brief Function pointer type for parser functions.
-using ParseFunc = ParsedEvent(*)(const EVENT_RECORD*, event::StringPool*);
+/// @brief Build the provider GUID -> parser table.
+///
+/// Each provider parser switches on EventDescriptor.Id itself (a dense
+/// switch, compiled to a jump table), so one table level is enough.
+ProviderTable<DispatchEntry> make_dispatch_table() {
+    ProviderTable<DispatchEntry> table;
+    table.insert(providers::KERNEL_PROCESS,    {parse_process_event,    MetricProvider::Process});
+    table.insert(providers::KERNEL_FILE,       {parse_file_event,       MetricProvider::File});
+    table.insert(providers::KERNEL_REGISTRY,   {parse_registry_event,   MetricProvider::Registry});
+    table.insert(providers::KERNEL_NETWORK,    {parse_network_event,    MetricProvider::Network});
+    table.insert(providers::KERNEL_IMAGE,      {parse_image_event,      MetricProvider::Image});
+    table.insert(providers::KERNEL_THREAD,     {parse_thread_event,     MetricProvider::Thread});
+    table.insert(providers::KERNEL_MEMORY,     {parse_memory_event,     MetricProvider::Memory});
+    table.insert(providers::POWERSHELL,        {parse_powershell_event, MetricProvider::PowerShell});
+    table.insert(providers::AMSI,              {parse_amsi_event,       MetricProvider::Amsi});
+    table.insert(providers::DNS_CLIENT,        {parse_dns_event,        MetricProvider::Dns});
+    table.insert(providers::SECURITY_AUDITING, {parse_security_event,   MetricProvider::Security});
+    table.insert(providers::WMI_ACTIVITY,      {parse_wmi_event,        MetricProvider::Wmi});
+    table.insert(providers::CLR_RUNTIME,       {parse_clr_event,        MetricProvider::Clr});
+    return table;
+}
 
 /// @brief Static dispatch table mapping provider GUIDs to parser functions.
-static const std::unordered_map<GUID, ParseFunc, GuidHash, GuidEqual> dispatch_table = {
-    {providers::KERNEL_PROCESS,    parse_process_event},
-    {providers::KERNEL_FILE,       parse_file_event},
-    {providers::KERNEL_REGISTRY,   parse_registry_event},
-    {providers::KERNEL_NETWORK,    parse_network_event},
-    {providers::KERNEL_IMAGE,      parse_image_event},
-    {providers::KERNEL_THREAD,     parse_thread_event},
-    {providers::KERNEL_MEMORY,     parse_memory_event},
-    {providers::POWERSHELL,        parse_powershell_event},
-    {providers::AMSI,              parse_amsi_event},
-    {providers::DNS_CLIENT,        parse_dns_event},
-    {providers::SECURITY_AUDITING, parse_security_event},
-    {providers::WMI_ACTIVITY,      parse_wmi_event},
-    {providers::CLR_RUNTIME,       parse_clr_event},
-};
+const ProviderTable<DispatchEntry> dispatch_table = make_dispatch_table();
+
+/// @brief Decode a record of a registered provider through the schema
+/// cache (its compiled DecodePlan) and project it.
+ParsedEvent parse_manifest_event(const EVENT_RECORD* record, event::StringPool* strings,
+                                 const ManifestProviders& manifests, std::uint16_t index) {
+    TdhParsedEvent tdh_event;
+    if (!parse_with_tdh(record, tdh_event)) {
+        return ParsedEvent{.valid = false};
+    }
+    ParsedEvent result{};
+    extract_common(record, result, event::Category::Manifest);
+    result.operation = record->EventHeader.EventDescriptor.Opcode;
+    manifests.project(index, tdh_event, result.pid, strings, result.payload, result.extension);
+    result.valid = true;
+    return result;
+}
 
 }  // namespace
 
-ParsedEvent dispatch_event(const EVENT_RECORD* record, event::StringPool* strings) {
+ParsedEvent dispatch_event(const EVENT_RECORD* record, event::StringPool* strings,
+                           std::uint32_t muted, const ManifestProviders* manifests) {
     if (record == nullptr) {
         return ParsedEvent{.valid = false};
     }
 
-    const GUID& provider = record->EventHeader.ProviderId;
+    EXERAY_SPAN(Parse);
+    const GUID& provider_id = record->EventHeader.ProviderId;
+    const DispatchEntry* entry = dispatch_table.find(provider_id);
+    if (entry != nullptr && (muted >> static_cast<unsigned>(entry->provider) & 1u) != 0) {
+        return ParsedEvent{.valid = false};  // Disabled; still draining from ETW
+    }
+    // Built-in providers never reach the registrations (add() refuses their GUIDs)
+    const std::uint16_t* manifest =
+        entry == nullptr && manifests != nullptr ? manifests->find(provider_id) : nullptr;
+    const auto parse = [&] {
+        if (entry != nullptr) {
+            return entry->parse(record, strings);
+        }
+        return manifest != nullptr ? parse_manifest_event(record, strings, *manifests, *manifest)
+                                   : ParsedEvent{.valid = false};
+    };
+    ParseMetrics& metrics = ParseMetrics::global();
+    if (!metrics.enabled()) {
+        return parse();
+    }
 
-    auto it = dispatch_table.find(provider);
-    return (it != dispatch_table.end()) ? it->second(record, strings)
-                                        : ParsedEvent{.valid = false};
+    const std::uint16_t event_id = record->EventHeader.EventDescriptor.Id;
+    if (entry == nullptr && manifest == nullptr) {
+        metrics.record(MetricProvider::Unknown, event_id, false, 0);
+        return ParsedEvent{.valid = false};
+    }
+    const std::uint64_t start = read_cycles();
+    ParsedEvent parsed = parse();
+    metrics.record(entry != nullptr ? entry->provider : MetricProvider::Manifest, event_id,
+                   parsed.valid, read_cycles() - start);
+    return parsed;
 }
 
 }  // namespace exeray::etw
@@ -4,6 +4,8 @@
 #ifdef _WIN32
 
 #include "exeray/etw/event_ids.hpp"
+#include "exeray/etw/event_layouts.hpp"
+#include "exeray/etw/file_map.hpp"
 #include "exeray/etw/parser.hpp"
 #include "exeray/etw/parser_utils.hpp"
 #include "exeray/etw/session.hpp"
@@ -22,20 +24,39 @@ void init_file_payload(ParsedEvent& result) {
     result.payload.file.path = event::INVALID_STRING;
     result.payload.file.size = 0;
     result.payload.file.attributes = 0;
-    result.payload.file._pad = 0;
+    result.payload.file.ops = 0;
+}
+
+/// @brief FileObject at offset, as ParsedEvent::object (0 if out of bounds).
+void read_file_object(ParsedEvent& result, const uint8_t* data, size_t len, size_t offset,
+                      size_t ptr_size) {
+    if (data == nullptr || offset + ptr_size > len) {
+        return;
+    }
+    uint64_t object = 0;
+    std::memcpy(&object, data + offset, ptr_size);  // Little-endian: low bytes first
+    result.object = object;
+}
+
+/// @brief Path of the event's FileObject from the file map; I/O issued in
+/// the System context (lazy writer, paging) is given to the opener.
+void resolve_file_object(ParsedEvent& result) {
+    const FileMap::Entry entry = file_map().find(result.object);
+    if (entry.path == event::INVALID_STRING) {
+        return;
+    }
+    result.payload.file.path = entry.path;
+    if ((result.pid == 0 || result.pid == 4 || result.pid == 0xFFFFFFFF) && entry.pid != 0) {
+        result.pid = entry.pid;
+    }
 }
 
 /// @brief Parse file Create event (Event ID 10).
 ///
-/// UserData layout:
-///   Irp: PVOID
-///   FileObject: PVOID
-///   TTID: UINT32
-///   CreateOptions: UINT32
-///   FileAttributes: UINT32
-///   ShareAccess: UINT32
-///   OpenPath: Unicode string
-ParsedEvent parse_file_create(const EVENT_RECORD* record, event::StringPool* strings) {
+/// Field offsets come from the layout of the event's version (see
+/// layouts::FileCreate).
+ParsedEvent parse_file_create(const EVENT_RECORD* record, const layouts::FileCreate& layout,
+                              event::StringPool* strings) {
     ParsedEvent result{};
     extract_common(record, result, event::Category::FileSystem);
     result.operation = static_cast<uint8_t>(event::FileOp::Create);
@@ -52,26 +73,18 @@ ParsedEvent parse_file_create(const EVENT_RECORD* record, event::StringPool* str
     const bool is64bit = (record->EventHeader.Flags & EVENT_HEADER_FLAG_64_BIT_HEADER) != 0;
     const size_t ptr_size = is64bit ? 8 : 4;
 
-    // Skip Irp, FileObject
-    size_t offset = ptr_size * 2;
+    const size_t attributes_at = layout.attributes.at(ptr_size);
+    const size_t offset = layout.open_path.at(ptr_size);
 
-    // Skip TTID
-    offset += sizeof(uint32_t);
-
-    if (offset + 8 > len) {
+    if (attributes_at + sizeof(uint32_t) > len) {
         result.valid = false;
         return result;
     }
 
-    // Skip CreateOptions, read FileAttributes
-    offset += sizeof(uint32_t);
     uint32_t attrs = 0;
-    std::memcpy(&attrs, data + offset, sizeof(uint32_t));
+    std::memcpy(&attrs, data + attributes_at, sizeof(uint32_t));
     result.payload.file.attributes = attrs;
-    offset += sizeof(uint32_t);
-
-    // Skip ShareAccess
-    offset += sizeof(uint32_t);
+    read_file_object(result, data, len, ptr_size, ptr_size);  // After Irp
 
     // Extract OpenPath (Unicode null-terminated)
     if (offset < len && strings != nullptr) {
@@ -81,8 +94,13 @@ ParsedEvent parse_file_create(const EVENT_RECORD* record, event::StringPool* str
         while (wstr_len < max_chars && path[wstr_len] != L'\0') {
             ++wstr_len;
         }
-        if (wstr_len > 0) {
-            result.payload.file.path = strings->intern_wide({path, wstr_len});
+        if (result.object != 0 && wstr_len != 0) {
+            // Interned now, not deferred: the object's I/O events refer to it
+            result.payload.file.path = strings->intern_path_wide({path, wstr_len});
+            file_map().insert(result.object, result.payload.file.path, result.pid);
+        } else {
+            set_wstring(result, result.payload.file.path, {path, wstr_len}, strings,
+                        StringKind::WidePath);
         }
     }
 
@@ -91,6 +109,9 @@ ParsedEvent parse_file_create(const EVENT_RECORD* record, event::StringPool* str
 }
 
 /// @brief Parse file Cleanup event (Event ID 11).
+///
+/// UserData starts with Irp, FileObject: PVOID; the FileObject ends the
+/// coalesced I/O of the handle and leaves the file map.
 ParsedEvent parse_file_cleanup(const EVENT_RECORD* record, event::StringPool* /*strings*/) {
     ParsedEvent result{};
     extract_common(record, result, event::Category::FileSystem);
@@ -98,6 +119,13 @@ ParsedEvent parse_file_cleanup(const EVENT_RECORD* record, event::StringPool* /*
     result.operation = static_cast<uint8_t>(event::FileOp::Create);
     result.status = event::Status::Success;
     init_file_payload(result);
+
+    const bool is64bit = (record->EventHeader.Flags & EVENT_HEADER_FLAG_64_BIT_HEADER) != 0;
+    const size_t ptr_size = is64bit ? 8 : 4;
+    read_file_object(result, static_cast<const uint8_t*>(record->UserData),
+                     record->UserDataLength, ptr_size, ptr_size);
+    resolve_file_object(result);
+    file_map().erase(result.object);
     result.valid = true;
     return result;
 }
@@ -140,6 +168,9 @@ ParsedEvent parse_file_read(const EVENT_RECORD* record, event::StringPool* /*str
     uint32_t io_size = 0;
     std::memcpy(&io_size, data + offset, sizeof(uint32_t));
     result.payload.file.size = io_size;
+    result.payload.file.ops = 1;
+    read_file_object(result, data, len, 8 + ptr_size, ptr_size);
+    resolve_file_object(result);
 
     result.valid = true;
     return result;
@@ -174,6 +205,9 @@ ParsedEvent parse_file_write(const EVENT_RECORD* record, event::StringPool* /*st
     uint32_t io_size = 0;
     std::memcpy(&io_size, data + offset, sizeof(uint32_t));
     result.payload.file.size = io_size;
+    result.payload.file.ops = 1;
+    read_file_object(result, data, len, 8 + ptr_size, ptr_size);
+    resolve_file_object(result);
 
     result.valid = true;
     return result;
@@ -197,10 +231,14 @@ ParsedEvent parse_file_event(const EVENT_RECORD* record, event::StringPool* stri
     }
 
     const auto event_id = record->EventHeader.EventDescriptor.Id;
+    const auto version = record->EventHeader.EventDescriptor.Version;
 
     switch (event_id) {
         case ids::file::CREATE:
-            return parse_file_create(record, strings);
+            if (const auto* layout = layouts::select(layouts::kFileCreate, version)) {
+                return parse_file_create(record, *layout, strings);
+            }
+            break;  // Layout not known for this version
         case ids::file::CLEANUP:
             return parse_file_cleanup(record, strings);
         case ids::file::READ:
@@ -210,12 +248,15 @@ ParsedEvent parse_file_event(const EVENT_RECORD* record, event::StringPool* stri
         case ids::file::FILE_DELETE:
             return parse_file_delete(record, strings);
         default:
-            // Unknown event - try TDH fallback
-            if (auto tdh_result = parse_with_tdh(record)) {
-                return convert_tdh_to_file(*tdh_result, record, strings);
-            }
-            return ParsedEvent{.valid = false};
+            break;
+    }
+
+    // Unknown event or version - try TDH fallback
+    TdhParsedEvent tdh_event;
+    if (parse_with_tdh(record, tdh_event)) {
+        return convert_tdh_to_file(tdh_event, record, strings);
     }
+    return ParsedEvent{.valid = false};
 }
 
 }  // namespace exeray::etw
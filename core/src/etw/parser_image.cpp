@@ -7,49 +7,41 @@
 #ifdef _WIN32
 
 #include "exeray/etw/event_ids.hpp"
+#include "exeray/etw/module_map.hpp"
 #include "exeray/etw/parser.hpp"
 #include "exeray/etw/parser_utils.hpp"
 #include "exeray/etw/session.hpp"
 #include "exeray/etw/tdh_parser.hpp"
+#include "exeray/etw/text_search.hpp"
 #include "exeray/event/string_pool.hpp"
 
 #include <cstring>
-#include <cwchar>
 
 namespace exeray::etw {
 
 namespace {
 
-/// @brief Check if a path is suspicious (temp/appdata directories).
+/// @brief Directories DLLs are rarely loaded from legitimately.
 ///
 /// DLLs loaded from temporary locations are often used for injection attacks.
+constexpr IcaseNeedles SUSPICIOUS_DIRECTORIES = {
+    L"\\temp\\",
+    L"\\tmp\\",
+    L"\\appdata\\local\\temp\\",
+    L"\\appdata\\roaming\\",
+    L"\\users\\public\\",
+    L"\\programdata\\",
+};
+
+/// @brief Check if a path is suspicious (temp/appdata directories).
 /// @param path Wide string path to check.
 /// @param len Length of path in characters.
-/// @return true if path contains suspicious patterns.
+/// @return true if path contains suspicious patterns (case-insensitive).
 bool is_suspicious_path(const wchar_t* path, size_t len) {
     if (path == nullptr || len == 0) {
         return false;
     }
-
-    // Convert to lowercase for case-insensitive matching
-    // Check for common suspicious patterns
-    const wchar_t* suspicious_patterns[] = {
-        L"\\temp\\",
-        L"\\tmp\\",
-        L"\\appdata\\local\\temp\\",
-        L"\\appdata\\roaming\\",
-        L"\\users\\public\\",
-        L"\\programdata\\"
-    };
-
-    // Simple substring search (case-insensitive would require more code)
-    for (const auto* pattern : suspicious_patterns) {
-        if (wcsstr(path, pattern) != nullptr) {
-            return true;
-        }
-    }
-
-    return false;
+    return SUSPICIOUS_DIRECTORIES.any({path, len});
 }
 
 /// @brief Parse Image Load event (Event ID 10).
@@ -64,7 +56,11 @@ bool is_suspicious_path(const wchar_t* path, size_t len) {
 ///   DefaultBase: PVOID (8 bytes)
 ///   Reserved1-4: UINT32 * 4 (16 bytes)
 ///   FileName: Unicode string (null-terminated)
-ParsedEvent parse_image_load(const EVENT_RECORD* record, event::StringPool* strings) {
+///
+/// A DCStart of the rundown is staged in the module map and loaded with the
+/// rest of its process's modules.
+ParsedEvent parse_image_load(const EVENT_RECORD* record, event::StringPool* strings,
+                             bool rundown) {
     ParsedEvent result{};
     extract_common(record, result, event::Category::Image);
     result.operation = static_cast<uint8_t>(event::ImageOp::Load);
@@ -135,11 +131,16 @@ ParsedEvent parse_image_load(const EVENT_RECORD* record, event::StringPool* stri
         }
     }
 
-    // Populate payload
-    if (strings != nullptr && filename_len > 0) {
-        result.payload.image.image_path = strings->intern_wide({filename, filename_len});
+    // Populate payload. The module map needs the path even if this event is
+    // shed, so it is interned here rather than deferred
+    result.payload.image.image_path = event::INVALID_STRING;
+    if (strings != nullptr && filename_len != 0) {
+        result.payload.image.image_path = strings->intern_path_wide({filename, filename_len});
+    }
+    if (rundown) {
+        module_map().stage(process_id, image_base, image_size, result.payload.image.image_path);
     } else {
-        result.payload.image.image_path = event::INVALID_STRING;
+        module_map().load(process_id, image_base, image_size, result.payload.image.image_path);
     }
     result.payload.image.process_id = process_id;
     result.payload.image.base_address = image_base;
@@ -200,6 +201,8 @@ ParsedEvent parse_image_unload(const EVENT_RECORD* record, event::StringPool* /*
     uint32_t process_id = 0;
     std::memcpy(&process_id, data + offset, sizeof(uint32_t));
 
+    module_map().unload(process_id, image_base);
+
     // Populate payload
     result.payload.image.image_path = event::INVALID_STRING;
     result.payload.image.process_id = process_id;
@@ -222,15 +225,21 @@ ParsedEvent parse_image_event(const EVENT_RECORD* record, event::StringPool* str
 
     switch (event_id) {
         case ids::image::LOAD:
-            return parse_image_load(record, strings);
+            return parse_image_load(record, strings, false);
+        case ids::image::DC_START:
+            // Same layout; fills the module map for processes that were
+            // already running when the session started
+            return parse_image_load(record, strings, true);
         case ids::image::UNLOAD:
             return parse_image_unload(record, strings);
-        default:
+        default: {
             // Unknown event ID - try TDH fallback
-            if (auto tdh_result = parse_with_tdh(record)) {
-                return convert_tdh_to_image(*tdh_result, record, strings);
+            TdhParsedEvent tdh_event;
+            if (parse_with_tdh(record, tdh_event)) {
+                return convert_tdh_to_image(tdh_event, record, strings);
             }
             return ParsedEvent{.valid = false};
+        }
     }
 }
 
@@ -4,6 +4,7 @@
 #ifdef _WIN32
 
 #include "exeray/etw/event_ids.hpp"
+#include "exeray/etw/memory_regions.hpp"
 #include "exeray/etw/parser.hpp"
 #include "exeray/etw/parser_utils.hpp"
 #include "exeray/etw/session.hpp"
@@ -119,6 +120,11 @@ ParsedEvent parse_virtual_alloc(const EVENT_RECORD* record) {
         result.payload.memory.is_suspicious = 0;
     }
 
+    // Remember executable allocations for the thread parser; the header's
+    // process is the one that made the call
+    memory_regions().allocate(process_id, base_address, region_size_raw,
+                              record->EventHeader.ProcessId, flags, result.timestamp);
+
     result.pid = process_id;
     result.valid = true;
     return result;
@@ -183,6 +189,8 @@ ParsedEvent parse_virtual_free(const EVENT_RECORD* record) {
     result.payload.memory.protection = 0;
     result.payload.memory.is_suspicious = 0;
 
+    memory_regions().free(process_id, base_address, region_size_raw);
+
     result.pid = process_id;
     result.valid = true;
     return result;
@@ -202,12 +210,14 @@ ParsedEvent parse_memory_event(const EVENT_RECORD* record, event::StringPool* st
             return parse_virtual_alloc(record);
         case ids::memory::VIRTUAL_FREE:
             return parse_virtual_free(record);
-        default:
+        default: {
             // Unknown event ID - try TDH fallback
-            if (auto tdh_result = parse_with_tdh(record)) {
-                return convert_tdh_to_memory(*tdh_result, record, strings);
+            TdhParsedEvent tdh_event;
+            if (parse_with_tdh(record, tdh_event)) {
+                return convert_tdh_to_memory(tdh_event, record, strings);
             }
             return ParsedEvent{.valid = false};
+        }
     }
 }
 
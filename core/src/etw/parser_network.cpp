@@ -4,6 +4,8 @@
 #ifdef _WIN32
 
 #include "exeray/etw/event_ids.hpp"
+#include "exeray/etw/event_layouts.hpp"
+#include "exeray/etw/ip_address.hpp"
 #include "exeray/etw/parser.hpp"
 #include "exeray/etw/parser_utils.hpp"
 #include "exeray/etw/session.hpp"
@@ -18,7 +20,6 @@ namespace {
 /// Protocol numbers (IANA).
 constexpr uint8_t PROTO_TCP = 6;
 constexpr uint8_t PROTO_UDP = 17;
-
 /// @brief Initialize network payload with defaults.
 void init_network_payload(ParsedEvent& result) {
     result.payload.category = event::Category::Network;
@@ -28,19 +29,48 @@ void init_network_payload(ParsedEvent& result) {
     result.payload.network.remote_port = 0;
     result.payload.network.bytes = 0;
     result.payload.network.protocol = 0;
+    result.payload.network.family = 0;
     std::memset(result.payload.network._pad, 0, sizeof(result.payload.network._pad));
+    result.payload.network.remote_domain = event::INVALID_STRING;
+}
+
+/// @brief Read the local and remote address and port of one layout.
+///
+/// IPv4 addresses are stored as they are, IPv6 ones interned (see
+/// ip_address.hpp) and kept in binary as an extension record; without a
+/// pool an IPv6 event keeps only its ports and the extension.
+template <typename Layout>
+void read_tuple(ParsedEvent& result, const uint8_t* data, const Layout& layout,
+                size_t ptr_size, bool ipv6, event::StringPool* strings) {
+    auto& network = result.payload.network;
+    if (ipv6) {
+        Ipv6Address local{};
+        Ipv6Address remote{};
+        std::memcpy(local.data(), data + layout.local_addr.at(ptr_size), local.size());
+        std::memcpy(remote.data(), data + layout.remote_addr.at(ptr_size), remote.size());
+        network.local_addr = intern_ipv6(local, strings);
+        network.remote_addr = intern_ipv6(remote, strings);
+        network.family = event::kAddressIPv6;
+        event::Ipv6TupleExtension tuple{};
+        std::memcpy(tuple.local_addr, local.data(), local.size());
+        std::memcpy(tuple.remote_addr, remote.data(), remote.size());
+        result.extension.set(event::ExtensionKind::Ipv6Tuple, tuple);
+    } else {
+        std::memcpy(&network.local_addr, data + layout.local_addr.at(ptr_size), sizeof(uint32_t));
+        std::memcpy(&network.remote_addr, data + layout.remote_addr.at(ptr_size),
+                    sizeof(uint32_t));
+        network.family = event::kAddressIPv4;
+    }
+    std::memcpy(&network.local_port, data + layout.local_port.at(ptr_size), sizeof(uint16_t));
+    std::memcpy(&network.remote_port, data + layout.remote_port.at(ptr_size), sizeof(uint16_t));
 }
 
 /// @brief Parse TCP connection event.
 ///
-/// Common UserData layout for TCP events:
-///   ProcessId: UINT32
-///   AddressFamily: UINT16
-///   LocalAddr: 4 bytes (IPv4) or 16 bytes (IPv6)
-///   LocalPort: UINT16
-///   RemoteAddr: 4 bytes (IPv4) or 16 bytes (IPv6)
-///   RemotePort: UINT16
-ParsedEvent parse_tcp_connect(const EVENT_RECORD* record) {
+/// Field offsets come from the layout of the event's version (see
+/// layouts::TcpConnect); IPv6 records use layouts::kTcpConnect6.
+ParsedEvent parse_tcp_connect(const EVENT_RECORD* record, const layouts::TcpConnect& layout,
+                              event::StringPool* strings) {
     ParsedEvent result{};
     extract_common(record, result, event::Category::Network);
     result.operation = static_cast<uint8_t>(event::NetworkOp::Connect);
@@ -50,52 +80,39 @@ ParsedEvent parse_tcp_connect(const EVENT_RECORD* record) {
     const auto* data = static_cast<const uint8_t*>(record->UserData);
     const auto len = record->UserDataLength;
 
-    // Minimum size for IPv4: pid(4) + af(2) + laddr(4) + lport(2) + raddr(4) + rport(2) = 18
-    if (data == nullptr || len < 18) {
+    if (data == nullptr || len < layout.size) {
         result.valid = false;
         return result;
     }
 
-    size_t offset = 0;
-
-    // PID
-    uint32_t pid = 0;
-    std::memcpy(&pid, data + offset, sizeof(uint32_t));
-    result.payload.network.local_addr = 0;  // Will be populated below
-    offset += sizeof(uint32_t);
+    const bool is64bit = (record->EventHeader.Flags & EVENT_HEADER_FLAG_64_BIT_HEADER) != 0;
+    const size_t ptr_size = is64bit ? 8 : 4;
 
     // Address family
     uint16_t af = 0;
-    std::memcpy(&af, data + offset, sizeof(uint16_t));
-    offset += sizeof(uint16_t);
-
-    // IPv4 only (af == 2)
-    if (af == 2 && offset + 12 <= len) {
-        uint32_t local_addr = 0;
-        uint16_t local_port = 0;
-        uint32_t remote_addr = 0;
-        uint16_t remote_port = 0;
-
-        std::memcpy(&local_addr, data + offset, sizeof(uint32_t));
-        offset += sizeof(uint32_t);
-        std::memcpy(&local_port, data + offset, sizeof(uint16_t));
-        offset += sizeof(uint16_t);
-        std::memcpy(&remote_addr, data + offset, sizeof(uint32_t));
-        offset += sizeof(uint32_t);
-        std::memcpy(&remote_port, data + offset, sizeof(uint16_t));
-
-        result.payload.network.local_addr = local_addr;
-        result.payload.network.local_port = local_port;
-        result.payload.network.remote_addr = remote_addr;
-        result.payload.network.remote_port = remote_port;
+    std::memcpy(&af, data + layout.address_family.at(ptr_size), sizeof(uint16_t));
+
+    // AddressFamily takes the AF_* values the payload stores
+    if (af == event::kAddressIPv4) {
+        read_tuple(result, data, layout, ptr_size, false, strings);
+    } else if (af == event::kAddressIPv6) {
+        const auto version = record->EventHeader.EventDescriptor.Version;
+        const auto* layout6 = layouts::select(layouts::kTcpConnect6, version);
+        if (layout6 != nullptr && len >= layout6->size) {
+            read_tuple(result, data, *layout6, ptr_size, true, strings);
+        }
     }
 
     result.valid = true;
     return result;
 }
 
-/// @brief Parse TCP data transfer event (send/receive).
-ParsedEvent parse_tcp_transfer(const EVENT_RECORD* record, event::NetworkOp op) {
+/// @brief Parse TCP data transfer event (send/receive) or disconnect.
+///
+/// The tuple (see layouts::TcpTransfer, kTcpTransfer6 for the IPv6 events)
+/// keys the flow table; records too short to carry it keep only the size.
+ParsedEvent parse_tcp_transfer(const EVENT_RECORD* record, event::NetworkOp op, bool ipv6,
+                               event::StringPool* strings) {
     ParsedEvent result{};
     extract_common(record, result, event::Category::Network);
     result.operation = static_cast<uint8_t>(op);
@@ -118,6 +135,13 @@ ParsedEvent parse_tcp_transfer(const EVENT_RECORD* record, event::NetworkOp op)
         result.payload.network.bytes = bytes;
     }
 
+    const auto version = record->EventHeader.EventDescriptor.Version;
+    const auto* layout =
+        layouts::select(ipv6 ? layouts::kTcpTransfer6 : layouts::kTcpTransfer, version);
+    if (layout != nullptr && len >= layout->size) {
+        read_tuple(result, data, *layout, 0, ipv6, strings);
+    }
+
     result.valid = true;
     return result;
 }
@@ -141,26 +165,41 @@ ParsedEvent parse_network_event(const EVENT_RECORD* record, event::StringPool* s
     }
 
     const auto event_id = record->EventHeader.EventDescriptor.Id;
+    const auto version = record->EventHeader.EventDescriptor.Version;
 
     switch (event_id) {
         case ids::network::TCP_CONNECT:
         case ids::network::TCP_ACCEPT:
-            return parse_tcp_connect(record);
+            if (const auto* layout = layouts::select(layouts::kTcpConnect, version)) {
+                return parse_tcp_connect(record, *layout, strings);
+            }
+            break;  // Layout not known for this version
         case ids::network::TCP_SEND:
-            return parse_tcp_transfer(record, event::NetworkOp::Send);
+            return parse_tcp_transfer(record, event::NetworkOp::Send, false, strings);
         case ids::network::TCP_RECEIVE:
-            return parse_tcp_transfer(record, event::NetworkOp::Receive);
+            return parse_tcp_transfer(record, event::NetworkOp::Receive, false, strings);
+        case ids::network::TCP_DISCONNECT:
+            return parse_tcp_transfer(record, event::NetworkOp::Close, false, strings);
+        case ids::network::TCP_SEND_V6:
+            return parse_tcp_transfer(record, event::NetworkOp::Send, true, strings);
+        case ids::network::TCP_RECEIVE_V6:
+            return parse_tcp_transfer(record, event::NetworkOp::Receive, true, strings);
+        case ids::network::TCP_DISCONNECT_V6:
+            return parse_tcp_transfer(record, event::NetworkOp::Close, true, strings);
         case ids::network::UDP_SEND:
             return parse_udp_event(record, event::NetworkOp::Send);
         case ids::network::UDP_RECEIVE:
             return parse_udp_event(record, event::NetworkOp::Receive);
         default:
-            // Unknown event - try TDH fallback
-            if (auto tdh_result = parse_with_tdh(record)) {
-                return convert_tdh_to_network(*tdh_result, record, strings);
-            }
-            return ParsedEvent{.valid = false};
+            break;
+    }
+
+    // Unknown event or version - try TDH fallback
+    TdhParsedEvent tdh_event;
+    if (parse_with_tdh(record, tdh_event)) {
+        return convert_tdh_to_network(tdh_event, record, strings);
     }
+    return ParsedEvent{.valid = false};
 }
 
 }  // namespace exeray::etw
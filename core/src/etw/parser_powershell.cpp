@@ -6,18 +6,19 @@
 
 #ifdef _WIN32
 
+#include "exeray/etw/content_cache.hpp"
 #include "exeray/etw/event_ids.hpp"
 #include "exeray/etw/parser.hpp"
 #include "exeray/etw/parser_utils.hpp"
+#include "exeray/etw/pattern_matcher.hpp"
+#include "exeray/etw/script_assembly.hpp"
 #include "exeray/etw/session.hpp"
 #include "exeray/etw/tdh_parser.hpp"
 #include "exeray/event/string_pool.hpp"
 
-#include <algorithm>
-#include <cctype>
+#include <array>
+#include <bit>
 #include <cstring>
-#include <optional>
-#include <string>
 #include <string_view>
 
 #include "exeray/logging.hpp"
@@ -38,7 +39,7 @@ struct SuspiciousPattern {
     std::string_view description;
 };
 
-/// Patterns to detect. Case-insensitive matching is done on lowercased input.
+/// Patterns to detect, matched case-insensitively.
 constexpr SuspiciousPattern SUSPICIOUS_PATTERNS[] = {
     {"iex",                   "Invoke-Expression shorthand"},
     {"invoke-expression",     "Code execution"},
@@ -69,59 +70,55 @@ constexpr SuspiciousPattern SUSPICIOUS_PATTERNS[] = {
 /// Number of suspicious patterns.
 constexpr size_t PATTERN_COUNT = sizeof(SUSPICIOUS_PATTERNS) / sizeof(SUSPICIOUS_PATTERNS[0]);
 
-/// @brief Convert string to lowercase for case-insensitive matching.
-std::string to_lower(std::string_view input) {
-    std::string result;
-    result.reserve(input.size());
-    for (char c : input) {
-        result.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
-    }
-    return result;
-}
-
-/// @brief Find the first suspicious pattern in script.
-/// @param script The script content to analyze.
-/// @return The matched pattern or std::nullopt if none found.
-std::optional<std::string_view> find_suspicious_pattern(std::string_view script) {
-    if (script.empty()) {
-        return std::nullopt;
-    }
-
-    // Convert to lowercase for case-insensitive matching
-    std::string lower_script = to_lower(script);
-
+/// Automaton over SUSPICIOUS_PATTERNS, built at compile time.
+constexpr auto SUSPICIOUS_MATCHER = make_pattern_matcher([] {
+    std::array<std::string_view, PATTERN_COUNT> patterns{};
     for (size_t i = 0; i < PATTERN_COUNT; ++i) {
-        if (lower_script.find(SUSPICIOUS_PATTERNS[i].pattern) != std::string::npos) {
-            return SUSPICIOUS_PATTERNS[i].pattern;
-        }
+        patterns[i] = SUSPICIOUS_PATTERNS[i].pattern;
     }
-    return std::nullopt;
+    return patterns;
+});
+
+/// @brief Find every suspicious pattern in script, in a single pass.
+/// @param script The script content to analyze (not copied).
+/// @return Bit i set if SUSPICIOUS_PATTERNS[i] occurs; 0 if none.
+PatternMask find_suspicious_patterns(std::wstring_view script) {
+    return SUSPICIOUS_MATCHER.match(script);
 }
 
-/// @brief Check if script contains suspicious patterns.
-/// @param script The script content to analyze.
-/// @return true if any suspicious pattern is found.
-bool contains_suspicious_pattern(std::string_view script) {
-    return find_suspicious_pattern(script).has_value();
-}
+/// Cache verdict of a part stored before its block was scanned whole.
+constexpr PatternMask kUnscanned = ~PatternMask{0};
 
 /// @brief Log suspicious script detection.
-void log_suspicious_script(uint32_t pid, std::string_view matched_pattern) {
-    EXERAY_WARN("Suspicious PowerShell detected: pid={}, pattern='{}'",
-                pid, matched_pattern);
+/// @param matched Patterns found; the first in table order is named.
+void log_suspicious_script(uint32_t pid, PatternMask matched) {
+    EXERAY_WARN_LIMITED(kSuspiciousLogsPerSecond,
+                        "Suspicious PowerShell detected: pid={}, pattern='{}', matches={}", pid,
+                        SUSPICIOUS_PATTERNS[SUSPICIOUS_MATCHER.first(matched)].pattern,
+                        std::popcount(matched));
 }
 
-/// @brief Convert wide string to narrow string for pattern matching.
-std::string wstring_to_string(std::wstring_view wstr) {
-    std::string result;
-    result.reserve(wstr.size());
-    for (wchar_t wc : wstr) {
-        // Simple ASCII conversion - sufficient for pattern matching
-        if (wc < 128) {
-            result.push_back(static_cast<char>(wc));
-        }
+/// @brief Verdict on a reassembled script, from the cache if it was seen whole before.
+/// @param fresh Set if the script was scanned now (its verdict is new).
+PatternMask scan_whole_script(std::wstring_view script, ContentCache* cache, bool& fresh) {
+    fresh = true;
+    if (cache == nullptr) {
+        return find_suspicious_patterns(script);
     }
-    return result;
+    const auto bytes = static_cast<std::uint32_t>(script.size() * sizeof(wchar_t));
+    const std::uint64_t hash = content_hash(script.data(), bytes);
+    ContentCache::Entry* seen = cache->find(hash, bytes);
+    if (seen != nullptr && seen->verdict != kUnscanned) {
+        fresh = false;
+        return seen->verdict;
+    }
+    const PatternMask matched = find_suspicious_patterns(script);
+    if (seen != nullptr) {
+        seen->verdict = matched;
+    } else {
+        cache->insert(hash, bytes, matched);
+    }
+    return matched;
 }
 
 /// @brief Parse Script Block Logging event (Event ID 4104).
@@ -149,9 +146,11 @@ ParsedEvent parse_script_block_event(const EVENT_RECORD* record, event::StringPo
         return result;
     }
 
-    // Extract sequence number (first UINT32)
+    // Extract sequence number (first UINT32) and the number of parts
     uint32_t sequence = 0;
+    uint32_t total = 0;
     std::memcpy(&sequence, data, sizeof(uint32_t));
+    std::memcpy(&total, data + 4, sizeof(uint32_t));
     result.payload.script.sequence = sequence;
 
     // Skip MessageNumber (4) + MessageTotal (4) = 8 bytes
@@ -164,24 +163,70 @@ ParsedEvent parse_script_block_event(const EVENT_RECORD* record, event::StringPo
 
     // Extract script block text (wide string)
     std::wstring_view wscript = extract_wstring(data + offset, len - offset);
-    std::string script = wstring_to_string(wscript);
 
-    // Check for suspicious patterns
-    if (auto pattern = find_suspicious_pattern(script)) {
+    // The parts of a multi-part block are scanned together when the last
+    // one arrives; the ScriptBlockId follows the text
+    ScriptAssembler::Part part = ScriptAssembler::Part::Alone;
+    std::wstring_view whole;
+    const size_t id_offset = offset + (wscript.size() + 1) * sizeof(wchar_t);
+    ScriptAssembler* assembler = total > 1 ? ScriptAssembler::current() : nullptr;
+    if (assembler != nullptr && id_offset + sizeof(ScriptAssembler::BlockId) <= len) {
+        ScriptAssembler::BlockId id{};
+        std::memcpy(id.data(), data + id_offset, id.size());
+        part = assembler->add(id, sequence, total, wscript, result.timestamp, result.pid, whole,
+                              [](std::wstring_view partial, uint32_t pid) {
+                                  // Parts stopped coming: scan what arrived
+                                  if (const PatternMask found = find_suspicious_patterns(partial)) {
+                                      log_suspicious_script(pid, found);
+                                  }
+                              });
+    }
+
+    // A block logged before keeps the verdict of its first scan
+    ContentCache* cache = wscript.empty() ? nullptr : ContentCache::current();
+    const auto bytes = static_cast<std::uint32_t>(wscript.size() * sizeof(wchar_t));
+    const std::uint64_t hash = cache != nullptr ? content_hash(wscript.data(), bytes) : 0;
+    ContentCache::Entry* seen = cache != nullptr ? cache->find(hash, bytes) : nullptr;
+
+    // Check for suspicious patterns: a part by itself, or a whole script
+    PatternMask matched = 0;
+    bool fresh = false;
+    if (part == ScriptAssembler::Part::Complete) {
+        matched = scan_whole_script(whole, ContentCache::current(), fresh);
+    } else if (part == ScriptAssembler::Part::Alone) {
+        fresh = seen == nullptr || seen->verdict == kUnscanned;
+        matched = fresh ? find_suspicious_patterns(wscript) : seen->verdict;
+        if (seen != nullptr) {
+            seen->verdict = matched;
+        }
+    }
+    if (matched != 0) {
         result.payload.script.is_suspicious = 1;
         result.status = event::Status::Suspicious;
 
-        // Log alert with matched pattern
-        log_suspicious_script(result.pid, *pattern);
+        // Log alert with matched patterns, once per content
+        if (fresh) {
+            log_suspicious_script(result.pid, matched);
+        }
     } else {
         result.payload.script.is_suspicious = 0;
     }
 
-    // Intern script block content
-    if (strings != nullptr && !wscript.empty()) {
-        result.payload.script.script_block = strings->intern_wide(wscript);
+    // Intern script block content. A repeat refers to the first
+    // occurrence's string, interned when the block first repeats (the
+    // first occurrence itself may still be shed).
+    if (seen != nullptr) {
+        if (seen->content == event::INVALID_STRING && strings != nullptr) {
+            seen->content = strings->intern_wide(wscript);
+        }
+        result.payload.script.script_block = seen->content;
+        result.payload.script.is_repeat = 1;
     } else {
-        result.payload.script.script_block = event::INVALID_STRING;
+        if (cache != nullptr) {
+            cache->insert(hash, bytes, part == ScriptAssembler::Part::Alone ? matched : kUnscanned);
+        }
+        set_wstring(result, result.payload.script.script_block, wscript, strings);
+        result.payload.script.is_repeat = 0;
     }
     result.payload.script.context = event::INVALID_STRING;
 
@@ -231,12 +276,14 @@ ParsedEvent parse_powershell_event(const EVENT_RECORD* record, event::StringPool
             return parse_script_block_event(record, strings);
         case ids::powershell::MODULE_LOGGING:
             return parse_module_event(record, strings);
-        default:
+        default: {
             // Unknown event ID - try TDH fallback
-            if (auto tdh_result = parse_with_tdh(record)) {
-                return convert_tdh_to_script(*tdh_result, record, strings);
+            TdhParsedEvent tdh_event;
+            if (parse_with_tdh(record, tdh_event)) {
+                return convert_tdh_to_script(tdh_event, record, strings);
             }
             return ParsedEvent{.valid = false};
+        }
     }
 }
 
@@ -4,6 +4,9 @@
 #ifdef _WIN32
 
 #include "exeray/etw/event_ids.hpp"
+#include "exeray/etw/event_layouts.hpp"
+#include "exeray/etw/memory_regions.hpp"
+#include "exeray/etw/module_map.hpp"
 #include "exeray/etw/parser.hpp"
 #include "exeray/etw/parser_utils.hpp"
 #include "exeray/etw/session.hpp"
@@ -18,18 +21,10 @@ namespace {
 
 /// @brief Parse ProcessStart event (Event ID 1).
 ///
-/// UserData layout (version 3+):
-///   UniqueProcessKey: PVOID
-///   ProcessId: UINT32
-///   ParentId: UINT32
-///   SessionId: UINT32
-///   ExitStatus: INT32
-///   DirectoryTableBase: PVOID
-///   Flags: UINT32
-///   UserSID: SID (variable)
-///   ImageFileName: ANSI string (null-terminated)
-///   CommandLine: Unicode string (null-terminated)
-ParsedEvent parse_process_start(const EVENT_RECORD* record, event::StringPool* strings) {
+/// Field offsets come from the layout of the event's version (see
+/// layouts::ProcessStart); the SID and strings follow each other.
+ParsedEvent parse_process_start(const EVENT_RECORD* record, const layouts::ProcessStart& layout,
+                                event::StringPool* strings) {
     ParsedEvent result{};
     extract_common(record, result, event::Category::Process);
     result.operation = static_cast<uint8_t>(event::ProcessOp::Create);
@@ -47,9 +42,8 @@ ParsedEvent parse_process_start(const EVENT_RECORD* record, event::StringPool* s
     const bool is64bit = (record->EventHeader.Flags & EVENT_HEADER_FLAG_64_BIT_HEADER) != 0;
     const size_t ptr_size = is64bit ? 8 : 4;
 
-    size_t offset = ptr_size;  // Skip UniqueProcessKey
-
-    if (offset + 8 > len) {
+    if (layout.process_id.at(ptr_size) + sizeof(uint32_t) > len ||
+        layout.parent_id.at(ptr_size) + sizeof(uint32_t) > len) {
         result.valid = false;
         return result;
     }
@@ -57,18 +51,13 @@ ParsedEvent parse_process_start(const EVENT_RECORD* record, event::StringPool* s
     // Extract ProcessId and ParentId
     uint32_t process_id = 0;
     uint32_t parent_id = 0;
-    std::memcpy(&process_id, data + offset, sizeof(uint32_t));
-    offset += sizeof(uint32_t);
-    std::memcpy(&parent_id, data + offset, sizeof(uint32_t));
-    offset += sizeof(uint32_t);
+    std::memcpy(&process_id, data + layout.process_id.at(ptr_size), sizeof(uint32_t));
+    std::memcpy(&parent_id, data + layout.parent_id.at(ptr_size), sizeof(uint32_t));
 
     result.payload.process.pid = process_id;
     result.payload.process.parent_pid = parent_id;
 
-    // Skip SessionId, ExitStatus, DirectoryTableBase, Flags
-    offset += sizeof(uint32_t) * 2;  // SessionId, ExitStatus
-    offset += ptr_size;               // DirectoryTableBase
-    offset += sizeof(uint32_t);       // Flags
+    size_t offset = layout.user_sid.at(ptr_size);
 
     // Skip SID (variable length) - look for ANSI string after
     // SID format: Revision(1) + SubAuthorityCount(1) + Authority(6) + SubAuthorities(4*count)
@@ -85,11 +74,7 @@ ParsedEvent parse_process_start(const EVENT_RECORD* record, event::StringPool* s
         while (str_len < max_len && image_name[str_len] != '\0') {
             ++str_len;
         }
-        if (str_len > 0) {
-            result.payload.process.image_path = strings->intern({image_name, str_len});
-        } else {
-            result.payload.process.image_path = event::INVALID_STRING;
-        }
+        set_string(result, result.payload.process.image_path, {image_name, str_len}, strings);
         offset += str_len + 1;  // Skip past null terminator
     } else {
         result.payload.process.image_path = event::INVALID_STRING;
@@ -103,11 +88,7 @@ ParsedEvent parse_process_start(const EVENT_RECORD* record, event::StringPool* s
         while (wstr_len < max_chars && cmd_line[wstr_len] != L'\0') {
             ++wstr_len;
         }
-        if (wstr_len > 0) {
-            result.payload.process.command_line = strings->intern_wide({cmd_line, wstr_len});
-        } else {
-            result.payload.process.command_line = event::INVALID_STRING;
-        }
+        set_wstring(result, result.payload.process.command_line, {cmd_line, wstr_len}, strings);
     } else {
         result.payload.process.command_line = event::INVALID_STRING;
     }
@@ -149,6 +130,51 @@ ParsedEvent parse_process_stop(const EVENT_RECORD* record, event::StringPool* /*
     result.payload.process.image_path = event::INVALID_STRING;
     result.payload.process.command_line = event::INVALID_STRING;
 
+    // Its address space is gone
+    memory_regions().forget(process_id);
+    module_map().forget(process_id);
+
+    result.valid = true;
+    return result;
+}
+
+/// @brief Parse ProcessRundown event (Event ID 15): a process that was
+/// running before the session, reported on a capture-state request.
+ParsedEvent parse_process_rundown(const EVENT_RECORD* record,
+                                  const layouts::ProcessRundown& layout,
+                                  event::StringPool* strings) {
+    ParsedEvent result{};
+    extract_common(record, result, event::Category::Process);
+    result.operation = static_cast<uint8_t>(event::ProcessOp::Rundown);
+    result.payload.category = event::Category::Process;
+
+    const auto* data = static_cast<const uint8_t*>(record->UserData);
+    const auto len = record->UserDataLength;
+    const size_t ptr_size =
+        (record->EventHeader.Flags & EVENT_HEADER_FLAG_64_BIT_HEADER) != 0 ? 8 : 4;
+    if (data == nullptr || layout.image_name.at(ptr_size) > len) {
+        result.valid = false;
+        return result;
+    }
+
+    std::memcpy(&result.payload.process.pid, data + layout.process_id.at(ptr_size),
+                sizeof(uint32_t));
+    std::memcpy(&result.payload.process.parent_pid, data + layout.parent_id.at(ptr_size),
+                sizeof(uint32_t));
+
+    result.payload.process.image_path = event::INVALID_STRING;
+    result.payload.process.command_line = event::INVALID_STRING;
+    const size_t offset = layout.image_name.at(ptr_size);
+    if (offset < len && strings != nullptr) {
+        const wchar_t* image_name = reinterpret_cast<const wchar_t*>(data + offset);
+        const size_t max_chars = (len - offset) / sizeof(wchar_t);
+        size_t wstr_len = 0;
+        while (wstr_len < max_chars && image_name[wstr_len] != L'\0') {
+            ++wstr_len;
+        }
+        set_wstring(result, result.payload.process.image_path, {image_name, wstr_len}, strings);
+    }
+
     result.valid = true;
     return result;
 }
@@ -213,20 +239,33 @@ ParsedEvent parse_process_event(const EVENT_RECORD* record, event::StringPool* s
 
     const auto event_id = record->EventHeader.EventDescriptor.Id;
 
+    const auto version = record->EventHeader.EventDescriptor.Version;
+
     switch (event_id) {
         case ids::process::START:
-            return parse_process_start(record, strings);
+            if (const auto* layout = layouts::select(layouts::kProcessStart, version)) {
+                return parse_process_start(record, *layout, strings);
+            }
+            break;  // Layout not known for this version
         case ids::process::STOP:
             return parse_process_stop(record, strings);
         case ids::process::IMAGE_LOAD:
             return parse_image_load(record, strings);
-        default:
-            // Unknown event ID - try TDH fallback
-            if (auto tdh_result = parse_with_tdh(record)) {
-                return convert_tdh_to_process(*tdh_result, record, strings);
+        case ids::process::RUNDOWN:
+            if (const auto* layout = layouts::select(layouts::kProcessRundown, version)) {
+                return parse_process_rundown(record, *layout, strings);
             }
-            return ParsedEvent{.valid = false};
+            break;
+        default:
+            break;
+    }
+
+    // Unknown event ID or version - try TDH fallback
+    TdhParsedEvent tdh_event;
+    if (parse_with_tdh(record, tdh_event)) {
+        return convert_tdh_to_process(tdh_event, record, strings);
     }
+    return ParsedEvent{.valid = false};
 }
 
 }  // namespace exeray::etw
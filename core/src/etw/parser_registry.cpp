@@ -4,6 +4,7 @@
 #ifdef _WIN32
 
 #include "exeray/etw/event_ids.hpp"
+#include "exeray/etw/key_map.hpp"
 #include "exeray/etw/parser.hpp"
 #include "exeray/etw/parser_utils.hpp"
 #include "exeray/etw/session.hpp"
@@ -25,6 +26,53 @@ void init_registry_payload(ParsedEvent& result) {
     result.payload.registry.data_size = 0;
 }
 
+/// @brief Read a PVOID field at offset (caller checked the bounds).
+uint64_t read_pointer(const uint8_t* data, size_t offset, size_t ptr_size) {
+    if (ptr_size == 8) {
+        uint64_t value = 0;
+        std::memcpy(&value, data + offset, sizeof(value));
+        return value;
+    }
+    uint32_t value = 0;
+    std::memcpy(&value, data + offset, sizeof(value));
+    return value;
+}
+
+/// @brief Read a null-terminated wide string at offset and move past it.
+std::wstring_view read_wstring(const uint8_t* data, size_t len, size_t& offset) {
+    if (offset >= len) {
+        return {};
+    }
+    const auto text = extract_wstring(data + offset, len - offset);
+    offset += (text.size() + 1) * sizeof(wchar_t);
+    return text;
+}
+
+/// @brief Whether name is a full registry path ("\REGISTRY\...").
+bool is_absolute(std::wstring_view name) {
+    return !name.empty() && name.front() == L'\\';
+}
+
+/// @brief Path node of a key opened as relative below base_object.
+///
+/// The base key comes from the key map; if it is unknown (opened before
+/// the session), BaseName spells it. A name that is already absolute, or
+/// has no known base, is interned as given.
+event::StringId resolve_key_path(uint64_t base_object, std::wstring_view base_name,
+                                 std::wstring_view relative, event::StringPool& strings) {
+    if (is_absolute(relative)) {
+        return strings.intern_path_wide(relative);
+    }
+    event::StringId base = base_object != 0 ? key_map().find(base_object) : event::INVALID_STRING;
+    if (base == event::INVALID_STRING && !base_name.empty()) {
+        base = strings.intern_path_wide(base_name);
+    }
+    if (base != event::INVALID_STRING) {
+        return strings.intern_path_below(base, relative);
+    }
+    return relative.empty() ? event::INVALID_STRING : strings.intern_path_wide(relative);
+}
+
 /// @brief Parse registry key events (CreateKey, OpenKey).
 ///
 /// UserData layout:
@@ -32,9 +80,13 @@ void init_registry_payload(ParsedEvent& result) {
 ///   KeyObject: PVOID
 ///   Status: NTSTATUS (UINT32)
 ///   Disposition: UINT32 (for CreateKey)
-///   BaseName: UINT32 (offset)
+///   BaseName: Unicode string
 ///   RelativeName: Unicode string
-ParsedEvent parse_key_event(const EVENT_RECORD* record, event::RegistryOp op, event::StringPool* /*strings*/) {
+///
+/// The full key path is interned here, once per open, and recorded in the
+/// key map under KeyObject for the value events that follow.
+ParsedEvent parse_key_event(const EVENT_RECORD* record, event::RegistryOp op,
+                            event::StringPool* strings) {
     ParsedEvent result{};
     extract_common(record, result, event::Category::Registry);
     result.operation = static_cast<uint8_t>(op);
@@ -51,20 +103,36 @@ ParsedEvent parse_key_event(const EVENT_RECORD* record, event::RegistryOp op, ev
     const bool is64bit = (record->EventHeader.Flags & EVENT_HEADER_FLAG_64_BIT_HEADER) != 0;
     const size_t ptr_size = is64bit ? 8 : 4;
 
-    // Skip BaseObject, KeyObject
     size_t offset = ptr_size * 2;
 
     if (offset + 4 > len) {
         result.valid = false;
         return result;
     }
+    const uint64_t base_object = read_pointer(data, 0, ptr_size);
+    const uint64_t key_object = read_pointer(data, ptr_size, ptr_size);
 
     // Extract Status (NTSTATUS)
     int32_t ntstatus = 0;
     std::memcpy(&ntstatus, data + offset, sizeof(int32_t));
     result.status = (ntstatus >= 0) ? event::Status::Success : event::Status::Error;
-
+    offset += sizeof(int32_t);
     result.valid = true;
+
+    if (op == event::RegistryOp::CreateKey) {
+        offset += sizeof(uint32_t);  // Disposition
+    }
+    const auto base_name = read_wstring(data, len, offset);
+    const auto relative_name = read_wstring(data, len, offset);
+    if (strings == nullptr) {
+        return result;
+    }
+
+    const auto path = resolve_key_path(base_object, base_name, relative_name, *strings);
+    result.payload.registry.key_path = path;
+    if (ntstatus >= 0 && path != event::INVALID_STRING) {
+        key_map().insert(key_object, path);
+    }
     return result;
 }
 
@@ -77,7 +145,11 @@ ParsedEvent parse_key_event(const EVENT_RECORD* record, event::RegistryOp op, ev
 ///   DataSize: UINT32 (for SetValue)
 ///   KeyName: Unicode string
 ///   ValueName: Unicode string
-ParsedEvent parse_value_event(const EVENT_RECORD* record, event::RegistryOp op, event::StringPool* /*strings*/) {
+///
+/// The key path is one key map lookup; KeyName is only used for keys
+/// opened before the session (or evicted from the map).
+ParsedEvent parse_value_event(const EVENT_RECORD* record, event::RegistryOp op,
+                              event::StringPool* strings) {
     ParsedEvent result{};
     extract_common(record, result, event::Category::Registry);
     result.operation = static_cast<uint8_t>(op);
@@ -94,13 +166,13 @@ ParsedEvent parse_value_event(const EVENT_RECORD* record, event::RegistryOp op,
     const bool is64bit = (record->EventHeader.Flags & EVENT_HEADER_FLAG_64_BIT_HEADER) != 0;
     const size_t ptr_size = is64bit ? 8 : 4;
 
-    // Skip KeyObject
     size_t offset = ptr_size;
 
     if (offset + 4 > len) {
         result.valid = false;
         return result;
     }
+    const uint64_t key_object = read_pointer(data, 0, ptr_size);
 
     // Extract Status
     int32_t ntstatus = 0;
@@ -109,21 +181,41 @@ ParsedEvent parse_value_event(const EVENT_RECORD* record, event::RegistryOp op,
     offset += sizeof(int32_t);
 
     // For SetValue, extract Type and DataSize
-    if (op == event::RegistryOp::SetValue && offset + 8 <= len) {
-        uint32_t value_type = 0;
-        uint32_t data_size = 0;
-        std::memcpy(&value_type, data + offset, sizeof(uint32_t));
-        offset += sizeof(uint32_t);
-        std::memcpy(&data_size, data + offset, sizeof(uint32_t));
-
-        result.payload.registry.value_type = value_type;
-        result.payload.registry.data_size = data_size;
+    if (op == event::RegistryOp::SetValue) {
+        if (offset + 8 <= len) {
+            uint32_t value_type = 0;
+            uint32_t data_size = 0;
+            std::memcpy(&value_type, data + offset, sizeof(uint32_t));
+            std::memcpy(&data_size, data + offset + sizeof(uint32_t), sizeof(uint32_t));
+
+            result.payload.registry.value_type = value_type;
+            result.payload.registry.data_size = data_size;
+        }
+        offset += 2 * sizeof(uint32_t);
     }
-
     result.valid = true;
+
+    const auto key_name = read_wstring(data, len, offset);
+    const auto value_name = read_wstring(data, len, offset);
+    auto& registry = result.payload.registry;
+    registry.key_path = key_map().find(key_object);
+    if (registry.key_path == event::INVALID_STRING && is_absolute(key_name)) {
+        set_wstring(result, registry.key_path, key_name, strings, StringKind::WidePath);
+    }
+    set_wstring(result, registry.value_name, value_name, strings);
     return result;
 }
 
+/// @brief Drop the key map entry of a closed KeyObject.
+void forget_key(const EVENT_RECORD* record) {
+    const auto* data = static_cast<const uint8_t*>(record->UserData);
+    const bool is64bit = (record->EventHeader.Flags & EVENT_HEADER_FLAG_64_BIT_HEADER) != 0;
+    const size_t ptr_size = is64bit ? 8 : 4;
+    if (data != nullptr && record->UserDataLength >= ptr_size) {
+        key_map().erase(read_pointer(data, 0, ptr_size));
+    }
+}
+
 }  // namespace
 
 ParsedEvent parse_registry_event(const EVENT_RECORD* record, event::StringPool* strings) {
@@ -142,12 +234,19 @@ ParsedEvent parse_registry_event(const EVENT_RECORD* record, event::StringPool*
             return parse_value_event(record, event::RegistryOp::SetValue, strings);
         case ids::registry::VALUE_DELETE:
             return parse_value_event(record, event::RegistryOp::DeleteValue, strings);
-        default:
+        case ids::registry::CLOSE_KEY:
+            // The object may be reused for another key; the event itself
+            // still goes through TDH like before
+            forget_key(record);
+            [[fallthrough]];
+        default: {
             // Unknown event - try TDH fallback
-            if (auto tdh_result = parse_with_tdh(record)) {
-                return convert_tdh_to_registry(*tdh_result, record, strings);
+            TdhParsedEvent tdh_event;
+            if (parse_with_tdh(record, tdh_event)) {
+                return convert_tdh_to_registry(tdh_event, record, strings);
             }
             return ParsedEvent{.valid = false};
+        }
     }
 }
 
@@ -4,10 +4,13 @@
 #ifdef _WIN32
 
 #include "exeray/etw/event_ids.hpp"
+#include "exeray/etw/memory_regions.hpp"
+#include "exeray/etw/module_map.hpp"
 #include "exeray/etw/parser.hpp"
 #include "exeray/etw/parser_utils.hpp"
 #include "exeray/etw/session.hpp"
 #include "exeray/etw/tdh_parser.hpp"
+#include "exeray/etw/thread_map.hpp"
 
 #include <cstring>
 
@@ -91,12 +94,32 @@ ParsedEvent parse_thread_start(const EVENT_RECORD* record) {
     // Get creator PID from event header
     const uint32_t creator_pid = record->EventHeader.ProcessId;
 
+    // Owner for later events that carry only this thread's ID
+    thread_map().start(thread_id, process_id);
+
     // Populate payload
     result.payload.thread.thread_id = thread_id;
     result.payload.thread.process_id = process_id;
     result.payload.thread.start_address = start_address;
     result.payload.thread.creator_pid = creator_pid;
 
+    // Injected code is typically run by starting a thread in memory that
+    // was allocated by hand rather than mapped from an image
+    result.payload.thread.start_region = 0;
+    result.payload.thread.start_unbacked = 0;
+    if (start_address != 0) {
+        if (const auto region = memory_regions().find(process_id, start_address)) {
+            result.payload.thread.start_region = region->flags;
+        }
+        // Only meaningful once some of the process's images have been seen,
+        // including those of a rundown still staged on this thread
+        ModuleMap& modules = module_map();
+        modules.flush_staged();
+        if (modules.count(process_id) != 0 && !modules.find(process_id, start_address)) {
+            result.payload.thread.start_unbacked = 1;
+        }
+    }
+
     // Detect remote thread injection
     if (is_remote_thread(creator_pid, process_id)) {
         result.payload.thread.is_remote = 1;
@@ -104,6 +127,9 @@ ParsedEvent parse_thread_start(const EVENT_RECORD* record) {
     } else {
         result.payload.thread.is_remote = 0;
     }
+    if ((result.payload.thread.start_region & (kRegionWritable | kRegionRemote)) != 0) {
+        result.status = event::Status::Suspicious;
+    }
 
     result.pid = creator_pid;
     result.valid = true;
@@ -131,11 +157,16 @@ ParsedEvent parse_thread_end(const EVENT_RECORD* record) {
     std::memcpy(&process_id, data, sizeof(uint32_t));
     std::memcpy(&thread_id, data + sizeof(uint32_t), sizeof(uint32_t));
 
+    // Also reached from DCEnd, after which the session sees no more events
+    thread_map().end(thread_id, process_id);
+
     result.payload.thread.thread_id = thread_id;
     result.payload.thread.process_id = process_id;
     result.payload.thread.start_address = 0;
     result.payload.thread.creator_pid = 0;
     result.payload.thread.is_remote = 0;
+    result.payload.thread.start_region = 0;
+    result.payload.thread.start_unbacked = 0;
 
     result.pid = record->EventHeader.ProcessId;
     result.valid = true;
@@ -179,12 +210,14 @@ ParsedEvent parse_thread_event(const EVENT_RECORD* record, event::StringPool* st
             return parse_thread_dcstart(record);
         case ids::thread::DC_END:
             return parse_thread_dcend(record);
-        default:
+        default: {
             // Unknown event ID - try TDH fallback
-            if (auto tdh_result = parse_with_tdh(record)) {
-                return convert_tdh_to_thread(*tdh_result, record, strings);
+            TdhParsedEvent tdh_event;
+            if (parse_with_tdh(record, tdh_event)) {
+                return convert_tdh_to_thread(tdh_event, record, strings);
             }
             return ParsedEvent{.valid = false};
+        }
     }
 }
 
@@ -54,11 +54,7 @@ ParsedEvent parse_assembly_event(const EVENT_RECORD* record,
     bool suspicious = is_dynamic || is_suspicious_path(assembly_name);
 
     // Populate payload
-    if (strings != nullptr && !assembly_name.empty()) {
-        result.payload.clr.assembly_name = strings->intern_wide(assembly_name);
-    } else {
-        result.payload.clr.assembly_name = event::INVALID_STRING;
-    }
+    set_wstring(result, result.payload.clr.assembly_name, assembly_name, strings);
     result.payload.clr.method_name = event::INVALID_STRING;
     result.payload.clr.load_address = 0;
     result.payload.clr.is_dynamic = is_dynamic ? 1 : 0;
@@ -73,6 +69,61 @@ ParsedEvent parse_assembly_event(const EVENT_RECORD* record,
     return result;
 }
 
+ParsedEvent parse_module_event(const EVENT_RECORD* record, event::StringPool* strings) {
+    ParsedEvent result{};
+    exeray::etw::extract_common(record, result, event::Category::Clr);
+    result.operation = static_cast<uint8_t>(event::ClrOp::ModuleLoad);
+    result.payload.category = event::Category::Clr;
+
+    const auto* data = static_cast<const uint8_t*>(record->UserData);
+    const auto len = record->UserDataLength;
+
+    // ModuleID(8) + AssemblyID(8) + AppDomainID(8) + ModuleFlags(4) + Reserved1(4)
+    if (data == nullptr || len < 32) {
+        result.valid = false;
+        return result;
+    }
+
+    uint64_t module_id = 0;
+    std::memcpy(&module_id, data, sizeof(module_id));
+    uint32_t flags = 0;
+    std::memcpy(&flags, data + 24, sizeof(flags));
+    size_t offset = 32;
+
+    // ModuleFlags 0x4: dynamic module (Reflection.Emit)
+    bool is_dynamic = (flags & 0x4) != 0;
+
+    std::wstring_view il_path;
+    if (offset < len) {
+        il_path = extract_wstring(data + offset, len - offset);
+    }
+
+    // No IL path means the module was loaded from a byte array
+    if (il_path.empty()) {
+        is_dynamic = true;
+    }
+
+    bool suspicious = is_dynamic || is_suspicious_path(il_path);
+
+    // Populate payload
+    set_wstring(result, result.payload.clr.assembly_name, il_path, strings,
+                StringKind::WidePath);
+    result.payload.clr.method_name = event::INVALID_STRING;
+    result.payload.clr.load_address = module_id;
+    result.payload.clr.is_dynamic = is_dynamic ? 1 : 0;
+    result.payload.clr.is_suspicious = suspicious ? 1 : 0;
+    std::memset(result.payload.clr._pad, 0, sizeof(result.payload.clr._pad));
+    result.payload.clr.methods = 0;
+
+    result.status = suspicious ? event::Status::Suspicious : event::Status::Success;
+
+    log_clr_operation(result.pid, event::ClrOp::ModuleLoad, il_path, {}, is_dynamic,
+                      suspicious);
+
+    result.valid = true;
+    return result;
+}
+
 }  // namespace exeray::etw::clr
 
 #endif  // _WIN32
@@ -15,6 +15,9 @@ ParsedEvent parse_assembly_event(const EVENT_RECORD* record,
                                   event::StringPool* strings,
                                   event::ClrOp op);
 
+/// @brief Parse module load event (ID 151); load_address is the ModuleID.
+ParsedEvent parse_module_event(const EVENT_RECORD* record, event::StringPool* strings);
+
 }  // namespace exeray::etw::clr
 
 #endif  // _WIN32
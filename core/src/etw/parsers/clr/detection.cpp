@@ -5,47 +5,26 @@
 
 #include "detection.hpp"
 
-#include <cstring>
+#include "exeray/etw/text_search.hpp"
 
 namespace exeray::etw::clr {
 
-bool contains_icase(std::wstring_view haystack, const wchar_t* needle) {
-    if (haystack.empty() || needle == nullptr || needle[0] == L'\0') {
-        return false;
-    }
+namespace {
 
-    size_t needle_len = wcslen(needle);
-    if (needle_len > haystack.size()) {
-        return false;
-    }
+/// Directories assemblies are rarely loaded from legitimately.
+constexpr IcaseNeedles SUSPICIOUS_DIRECTORIES = {
+    L"\\temp\\",
+    L"\\tmp\\",
+    L"\\appdata\\",
+    L"\\downloads\\",
+};
 
-    for (size_t i = 0; i <= haystack.size() - needle_len; ++i) {
-        bool match = true;
-        for (size_t j = 0; j < needle_len; ++j) {
-            wchar_t h = haystack[i + j];
-            wchar_t n = needle[j];
-            if (h >= L'A' && h <= L'Z') h = h - L'A' + L'a';
-            if (n >= L'A' && n <= L'Z') n = n - L'A' + L'a';
-            if (h != n) {
-                match = false;
-                break;
-            }
-        }
-        if (match) return true;
-    }
-    return false;
-}
+}  // namespace
 
 bool is_suspicious_path(std::wstring_view path) {
     if (path.empty()) return false;
 
-    if (contains_icase(path, L"\\temp\\") ||
-        contains_icase(path, L"\\tmp\\") ||
-        contains_icase(path, L"\\appdata\\") ||
-        contains_icase(path, L"\\downloads\\")) {
-        return true;
-    }
-    return false;
+    return SUSPICIOUS_DIRECTORIES.any(path);
 }
 
 bool is_obfuscated_name(std::wstring_view name) {
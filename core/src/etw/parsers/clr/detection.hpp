@@ -9,9 +9,6 @@
 
 namespace exeray::etw::clr {
 
-/// @brief Case-insensitive wide string contains check.
-bool contains_icase(std::wstring_view haystack, const wchar_t* needle);
-
 /// @brief Check if assembly comes from a suspicious path.
 bool is_suspicious_path(std::wstring_view path);
 
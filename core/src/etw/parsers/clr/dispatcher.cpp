@@ -22,6 +22,8 @@ ParsedEvent parse_clr_event(const EVENT_RECORD* record, event::StringPool* strin
     const auto event_id = record->EventHeader.EventDescriptor.Id;
 
     switch (event_id) {
+        case ids::clr::MODULE_LOAD:
+            return clr::parse_module_event(record, strings);
         case ids::clr::ASSEMBLY_LOAD_START:
         case ids::clr::ASSEMBLY_LOAD_STOP:
             return clr::parse_assembly_event(record, strings, event::ClrOp::AssemblyLoad);
@@ -29,12 +31,14 @@ ParsedEvent parse_clr_event(const EVENT_RECORD* record, event::StringPool* strin
             return clr::parse_assembly_event(record, strings, event::ClrOp::AssemblyUnload);
         case ids::clr::METHOD_JIT_START:
             return clr::parse_jit_event(record, strings);
-        default:
+        default: {
             // Unknown event ID - try TDH fallback
-            if (auto tdh_result = parse_with_tdh(record)) {
-                return convert_tdh_to_clr(*tdh_result, record, strings);
+            TdhParsedEvent tdh_event;
+            if (parse_with_tdh(record, tdh_event)) {
+                return convert_tdh_to_clr(tdh_event, record, strings);
             }
             return ParsedEvent{.valid = false};
+        }
     }
 }
 
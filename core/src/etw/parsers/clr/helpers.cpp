@@ -48,27 +48,17 @@ void log_clr_operation(uint32_t pid, event::ClrOp op,
         case event::ClrOp::AssemblyLoad:   op_name = "AssemblyLoad"; break;
         case event::ClrOp::AssemblyUnload: op_name = "AssemblyUnload"; break;
         case event::ClrOp::MethodJit:      op_name = "MethodJit"; break;
+        case event::ClrOp::ModuleLoad:     op_name = "ModuleLoad"; break;
     }
 
-    std::string asm_str = wstring_to_narrow(assembly);
-    std::string method_str = wstring_to_narrow(method);
-
+    const char* dynamic = is_dynamic ? " [DYNAMIC/IN-MEMORY]" : "";
     if (is_suspicious) {
-        if (is_dynamic) {
-            EXERAY_WARN("Suspicious CLR {} [DYNAMIC/IN-MEMORY]: pid={}, asm={}, method={}",
-                        op_name, pid, asm_str, method_str);
-        } else {
-            EXERAY_WARN("Suspicious CLR {}: pid={}, asm={}, method={}",
-                        op_name, pid, asm_str, method_str);
-        }
+        EXERAY_WARN_LIMITED(kSuspiciousLogsPerSecond,
+                            "Suspicious CLR {}{}: pid={}, asm={}, method={}", op_name, dynamic,
+                            pid, wstring_to_narrow(assembly), wstring_to_narrow(method));
     } else {
-        if (is_dynamic) {
-            EXERAY_TRACE("CLR {} [DYNAMIC/IN-MEMORY]: pid={}, asm={}, method={}",
-                         op_name, pid, asm_str, method_str);
-        } else {
-            EXERAY_TRACE("CLR {}: pid={}, asm={}, method={}",
-                         op_name, pid, asm_str, method_str);
-        }
+        EXERAY_TRACE("CLR {}{}: pid={}, asm={}, method={}", op_name, dynamic, pid,
+                     wstring_to_narrow(assembly), wstring_to_narrow(method));
     }
 }
 
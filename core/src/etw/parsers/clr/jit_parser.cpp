@@ -7,6 +7,8 @@
 #include "detection.hpp"
 #include "helpers.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cstring>
 #include <string>
 
@@ -26,6 +28,11 @@ ParsedEvent parse_jit_event(const EVENT_RECORD* record, event::StringPool* strin
         return result;
     }
 
+    // ModuleID ties the method to its module: JIT events are folded per
+    // module, named by its ModuleLoad
+    uint64_t module_id = 0;
+    std::memcpy(&module_id, data + 8, sizeof(module_id));
+
     // Skip MethodID(8) + ModuleID(8) + MethodToken(4) + MethodILSize(4)
     size_t offset = 8 + 8 + 4 + 4;
 
@@ -46,12 +53,21 @@ ParsedEvent parse_jit_event(const EVENT_RECORD* record, event::StringPool* strin
     bool suspicious = is_obfuscated_name(method_name) ||
                       is_obfuscated_name(method_ns);
 
-    // Build full method name (namespace.method)
-    std::wstring full_name;
+    // Build full method name (namespace.method); on the stack unless very long
+    std::array<wchar_t, 512> buffer;
+    std::wstring overflow;
+    std::wstring_view full_name = method_name;
     if (!method_ns.empty()) {
-        full_name = std::wstring(method_ns) + L"." + std::wstring(method_name);
-    } else if (!method_name.empty()) {
-        full_name = std::wstring(method_name);
+        const std::size_t size = method_ns.size() + 1 + method_name.size();
+        wchar_t* out = buffer.data();
+        if (size > buffer.size()) {
+            overflow.resize(size);
+            out = overflow.data();
+        }
+        wchar_t* end = std::copy(method_ns.begin(), method_ns.end(), out);
+        *end++ = L'.';
+        std::copy(method_name.begin(), method_name.end(), end);
+        full_name = {out, size};
     }
 
     // Populate payload
@@ -61,10 +77,11 @@ ParsedEvent parse_jit_event(const EVENT_RECORD* record, event::StringPool* strin
     } else {
         result.payload.clr.method_name = event::INVALID_STRING;
     }
-    result.payload.clr.load_address = 0;
+    result.payload.clr.load_address = module_id;
     result.payload.clr.is_dynamic = 0;
     result.payload.clr.is_suspicious = suspicious ? 1 : 0;
     std::memset(result.payload.clr._pad, 0, sizeof(result.payload.clr._pad));
+    result.payload.clr.methods = 1;
 
     result.status = suspicious ? event::Status::Suspicious : event::Status::Success;
 
@@ -25,12 +25,16 @@ ParsedEvent parse_dns_event(const EVENT_RECORD* record, event::StringPool* strin
             return dns::parse_query_completed(record, strings);
         case ids::dns::QUERY_FAILED:
             return dns::parse_query_failed(record, strings);
-        default:
+        case ids::dns::QUERY_SENT:
+            return dns::parse_query_sent(record, strings);
+        default: {
             // Unknown event ID - try TDH fallback
-            if (auto tdh_result = parse_with_tdh(record)) {
-                return convert_tdh_to_dns(*tdh_result, record, strings);
+            TdhParsedEvent tdh_event;
+            if (parse_with_tdh(record, tdh_event)) {
+                return convert_tdh_to_dns(tdh_event, record, strings);
             }
             return ParsedEvent{.valid = false};
+        }
     }
 }
 
@@ -34,13 +34,15 @@ std::string wstring_to_narrow(std::wstring_view wstr) {
 
 void log_dns_query(uint32_t pid, std::wstring_view domain, uint32_t query_type,
                    uint32_t result_code, bool is_suspicious) {
-    std::string narrow_domain = wstring_to_narrow(domain);
+    // The event itself is stored flagged; this is a notice, so a burst of
+    // DGA lookups must not turn into a burst of formatted lines
     if (is_suspicious) {
-        EXERAY_WARN("Suspicious DNS query (DGA-like): pid={}, domain={}, type={}",
-                    pid, narrow_domain, query_type_name(query_type));
+        EXERAY_WARN_LIMITED(kSuspiciousLogsPerSecond,
+                            "Suspicious DNS query (DGA-like): pid={}, domain={}, type={}",
+                            pid, wstring_to_narrow(domain), query_type_name(query_type));
     } else {
         EXERAY_TRACE("DNS query: pid={}, domain={}, type={}, result={}",
-                     pid, narrow_domain, query_type_name(query_type), result_code);
+                     pid, wstring_to_narrow(domain), query_type_name(query_type), result_code);
     }
 }
 
@@ -76,11 +76,7 @@ ParsedEvent parse_query_completed(const EVENT_RECORD* record,
     bool suspicious = is_dga_suspicious(domain);
 
     // Set payload with interned strings
-    if (strings != nullptr && !domain.empty()) {
-        result.payload.dns.domain = strings->intern_wide(domain);
-    } else {
-        result.payload.dns.domain = event::INVALID_STRING;
-    }
+    set_wstring(result, result.payload.dns.domain, domain, strings);
     result.payload.dns.query_type = query_type;
     result.payload.dns.result_code = result_code;
     result.payload.dns.resolved_ip = resolved_ip;
@@ -141,11 +137,7 @@ ParsedEvent parse_query_failed(const EVENT_RECORD* record,
     bool suspicious = is_dga_suspicious(domain);
 
     // Set payload
-    if (strings != nullptr && !domain.empty()) {
-        result.payload.dns.domain = strings->intern_wide(domain);
-    } else {
-        result.payload.dns.domain = event::INVALID_STRING;
-    }
+    set_wstring(result, result.payload.dns.domain, domain, strings);
     result.payload.dns.query_type = query_type;
     result.payload.dns.result_code = error_code;
     result.payload.dns.resolved_ip = 0;
@@ -156,15 +148,59 @@ ParsedEvent parse_query_failed(const EVENT_RECORD* record,
     result.status = suspicious ? event::Status::Suspicious : event::Status::Error;
 
     // Log failed query
-    std::string narrow_domain = wstring_to_narrow(domain);
     if (suspicious) {
-        EXERAY_WARN("DNS query failed (SUSPICIOUS): pid={}, domain={}, type={}, error={}",
-                    result.pid, narrow_domain, query_type_name(query_type), error_code);
+        EXERAY_WARN_LIMITED(kSuspiciousLogsPerSecond,
+                            "DNS query failed (SUSPICIOUS): pid={}, domain={}, type={}, error={}",
+                            result.pid, wstring_to_narrow(domain), query_type_name(query_type),
+                            error_code);
     } else {
-        EXERAY_WARN("DNS query failed: pid={}, domain={}, type={}, error={}",
-                    result.pid, narrow_domain, query_type_name(query_type), error_code);
+        EXERAY_WARN_LIMITED(kSuspiciousLogsPerSecond,
+                            "DNS query failed: pid={}, domain={}, type={}, error={}", result.pid,
+                            wstring_to_narrow(domain), query_type_name(query_type), error_code);
+    }
+
+    result.valid = true;
+    return result;
+}
+
+ParsedEvent parse_query_sent(const EVENT_RECORD* record,
+                              event::StringPool* strings) {
+    ParsedEvent result{};
+    exeray::etw::extract_common(record, result, event::Category::Dns);
+    result.operation = static_cast<uint8_t>(event::DnsOp::Query);
+    result.payload.category = event::Category::Dns;
+
+    const auto* data = static_cast<const uint8_t*>(record->UserData);
+    const auto len = record->UserDataLength;
+
+    if (data == nullptr || len < 4) {
+        result.valid = false;
+        return result;
     }
 
+    size_t offset = 0;
+
+    // Extract domain name
+    std::wstring_view domain = extract_wstring(data + offset, len - offset);
+    offset += (domain.size() + 1) * sizeof(wchar_t);
+
+    // Extract query type; the response carries the same, which pairs them
+    uint16_t query_type = 0;
+    if (offset + 2 <= len) {
+        std::memcpy(&query_type, data + offset, sizeof(uint16_t));
+    }
+
+    bool suspicious = is_dga_suspicious(domain);
+
+    // Set payload; nothing is resolved yet
+    set_wstring(result, result.payload.dns.domain, domain, strings);
+    result.payload.dns.query_type = query_type;
+    result.payload.dns.result_code = 0;
+    result.payload.dns.resolved_ip = 0;
+    result.payload.dns.is_suspicious = suspicious ? 1 : 0;
+    std::memset(result.payload.dns._pad, 0, sizeof(result.payload.dns._pad));
+
+    result.status = suspicious ? event::Status::Suspicious : event::Status::Success;
     result.valid = true;
     return result;
 }
@@ -21,4 +21,8 @@ ParsedEvent parse_query_completed(const EVENT_RECORD* record,
 ParsedEvent parse_query_failed(const EVENT_RECORD* record,
                                 event::StringPool* strings);
 
+/// @brief Parse DNS Query Sent event (Event ID 3009).
+ParsedEvent parse_query_sent(const EVENT_RECORD* record,
+                              event::StringPool* strings);
+
 }  // namespace exeray::etw::dns
@@ -9,23 +9,51 @@
 
 namespace exeray::etw::security {
 
-bool BruteForceTracker::check_and_record(std::wstring_view user) {
-    std::lock_guard<std::mutex> lock(mutex);
-    
-    auto now = std::chrono::steady_clock::now();
-    std::wstring key(user);
-    auto& times = failures[key];
-    
-    // Remove old entries outside the window
-    auto cutoff = now - WINDOW;
-    times.erase(std::remove_if(times.begin(), times.end(),
-        [cutoff](auto& t) { return t < cutoff; }), times.end());
-    
-    // Add current failure
-    times.push_back(now);
-    
-    // Check if threshold exceeded
-    return times.size() >= THRESHOLD;
+namespace {
+
+/// @brief FNV-1a over the UTF-16 code units; never 0 (the free-slot key).
+std::uint64_t user_key(std::wstring_view user) noexcept {
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (const wchar_t c : user) {
+        hash = (hash ^ static_cast<std::uint16_t>(c)) * 1099511628211ULL;
+    }
+    return hash == 0 ? 1 : hash;
+}
+
+}  // namespace
+
+BruteForceTracker::Slot& BruteForceTracker::find_or_claim(std::array<Slot, kWays>& bucket,
+                                                          std::uint64_t key,
+                                                          Clock::time_point now) noexcept {
+    Slot* victim = &bucket[0];
+    for (Slot& slot : bucket) {
+        if (slot.key == key) {
+            return slot;
+        }
+        // Prefer a free slot, then an idle one, then the least recently failed
+        if (victim->key != 0 &&
+            (slot.key == 0 || now - slot.last() > WINDOW || slot.last() < victim->last())) {
+            victim = &slot;
+        }
+    }
+    *victim = Slot{};
+    victim->key = key;
+    return *victim;
+}
+
+bool BruteForceTracker::check_and_record(std::wstring_view user, Clock::time_point now) {
+    const std::uint64_t key = user_key(user);
+    Shard& shard = shards_[(key >> 56) % kShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    Slot& slot = find_or_claim(shard.buckets[(key >> 8) % kBucketsPerShard], key, now);
+    slot.failures[slot.next] = now;
+    slot.next = static_cast<std::uint8_t>((slot.next + 1) % THRESHOLD);
+    slot.count = static_cast<std::uint8_t>((std::min)(slot.count + 1, static_cast<int>(THRESHOLD)));
+
+    // Threshold exceeded when the oldest of the last THRESHOLD failures is
+    // still inside the window
+    return slot.count == THRESHOLD && now - slot.failures[slot.next] <= WINDOW;
 }
 
 /// Global brute force tracker instance.
@@ -5,27 +5,72 @@
 
 #ifdef _WIN32
 
+#include <array>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <mutex>
-#include <string>
 #include <string_view>
-#include <unordered_map>
-#include <vector>
 
 namespace exeray::etw::security {
 
-/// Brute force detection state.
-struct BruteForceTracker {
-    std::mutex mutex;
-    std::unordered_map<std::wstring, std::vector<std::chrono::steady_clock::time_point>> failures;
-    
-    static constexpr size_t THRESHOLD = 5;
+/**
+ * @brief Failed logons per user, for brute force detection.
+ *
+ * Password spraying sends failures for many users at a high rate, so a
+ * lookup must neither allocate nor serialize every parsing thread. Users
+ * are keyed by a 64-bit hash of the name and kept in a fixed table split
+ * into kShards independently locked shards. Each user holds a ring of its
+ * last THRESHOLD failure times: the check is whether the oldest of them is
+ * still within WINDOW, with nothing to erase.
+ *
+ * Memory is bounded: a user hashes to one bucket of kWays slots, and a new
+ * user takes a free slot, else one idle for longer than WINDOW, else the
+ * slot whose last failure is oldest.
+ */
+class BruteForceTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t THRESHOLD = 5;
     static constexpr std::chrono::seconds WINDOW{60};
-    
+
+    static constexpr std::size_t kShards = 16;
+    static constexpr std::size_t kBucketsPerShard = 32;
+    static constexpr std::size_t kWays = 8;  ///< Users per bucket
+
     /// @brief Check if this represents a brute force attempt.
     /// @param user Username that failed login.
     /// @return True if threshold exceeded within the time window.
-    bool check_and_record(std::wstring_view user);
+    bool check_and_record(std::wstring_view user) {
+        return check_and_record(user, Clock::now());
+    }
+
+    /// @brief As above, at an explicit time.
+    bool check_and_record(std::wstring_view user, Clock::time_point now);
+
+private:
+    struct Slot {
+        std::uint64_t key = 0;  ///< 0 = free
+        std::array<Clock::time_point, THRESHOLD> failures{};  ///< Ring of failure times
+        std::uint8_t next = 0;   ///< Ring position written next (the oldest once full)
+        std::uint8_t count = 0;  ///< Failures in the ring, up to THRESHOLD
+
+        [[nodiscard]] Clock::time_point last() const noexcept {
+            return failures[(next + THRESHOLD - 1) % THRESHOLD];
+        }
+    };
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::array<std::array<Slot, kWays>, kBucketsPerShard> buckets{};
+    };
+
+    /// @brief Slot of key in its bucket, claiming one if the user is new.
+    static Slot& find_or_claim(std::array<Slot, kWays>& bucket, std::uint64_t key,
+                               Clock::time_point now) noexcept;
+
+    std::array<Shard, kShards> shards_;
 };
 
 /// Global brute force tracker instance.
@@ -14,6 +14,7 @@ namespace exeray::etw::security {
 // Forward declarations for parser functions
 ParsedEvent parse_logon_success(const EVENT_RECORD* record, event::StringPool* strings);
 ParsedEvent parse_logon_failed(const EVENT_RECORD* record, event::StringPool* strings);
+ParsedEvent parse_logoff(const EVENT_RECORD* record, event::StringPool* strings);
 ParsedEvent parse_process_create(const EVENT_RECORD* record, event::StringPool* strings);
 ParsedEvent parse_process_terminate(const EVENT_RECORD* record, event::StringPool* strings);
 ParsedEvent parse_service_install(const EVENT_RECORD* record, event::StringPool* strings);
@@ -35,6 +36,8 @@ ParsedEvent parse_security_event(const EVENT_RECORD* record, event::StringPool*
             return security::parse_logon_success(record, strings);
         case ids::security::LOGON_FAILED:
             return security::parse_logon_failed(record, strings);
+        case ids::security::LOGOFF:
+            return security::parse_logoff(record, strings);
         case ids::security::PROCESS_CREATE:
             return security::parse_process_create(record, strings);
         case ids::security::PROCESS_EXIT:
@@ -43,11 +46,13 @@ ParsedEvent parse_security_event(const EVENT_RECORD* record, event::StringPool*
             return security::parse_service_install(record, strings);
         case ids::security::TOKEN_RIGHTS:
             return security::parse_token_rights(record, strings);
-        default:
-            if (auto tdh_result = parse_with_tdh(record)) {
-                return convert_tdh_to_security(*tdh_result, record, strings);
+        default: {
+            TdhParsedEvent tdh_event;
+            if (parse_with_tdh(record, tdh_event)) {
+                return convert_tdh_to_security(tdh_event, record, strings);
             }
             return ParsedEvent{.valid = false};
+        }
     }
 }
 
@@ -5,6 +5,7 @@
 
 #include "helpers.hpp"
 #include "constants.hpp"
+#include "exeray/etw/text_search.hpp"
 #include "exeray/logging.hpp"
 
 #ifndef NOMINMAX
@@ -29,12 +30,8 @@ std::wstring_view extract_wstring(const uint8_t* data, size_t max_len) {
 }
 
 bool has_dangerous_privilege(std::wstring_view privileges) {
-    for (const auto* priv : DANGEROUS_PRIVILEGES) {
-        if (privileges.find(priv) != std::wstring_view::npos) {
-            return true;
-        }
-    }
-    return false;
+    static constexpr IcaseNeedles needles(DANGEROUS_PRIVILEGES);
+    return needles.any(privileges);
 }
 
 const char* logon_type_name(uint32_t type) {
@@ -67,19 +64,16 @@ std::string wstring_to_narrow(std::wstring_view wstr, size_t max_len) {
 void log_security_event(const char* event_type, uint32_t pid,
                         std::wstring_view user, bool suspicious,
                         const char* details) {
-    std::string user_str = wstring_to_narrow(user);
+    const char* separator = details != nullptr ? ", " : "";
+    if (details == nullptr) {
+        details = "";
+    }
     if (suspicious) {
-        if (details) {
-            EXERAY_WARN("{}: pid={}, user={}, {} [SUSPICIOUS]", event_type, pid, user_str, details);
-        } else {
-            EXERAY_WARN("{}: pid={}, user={} [SUSPICIOUS]", event_type, pid, user_str);
-        }
+        EXERAY_WARN_LIMITED(kSuspiciousLogsPerSecond, "{}: pid={}, user={}{}{} [SUSPICIOUS]",
+                            event_type, pid, wstring_to_narrow(user), separator, details);
     } else {
-        if (details) {
-            EXERAY_TRACE("{}: pid={}, user={}, {}", event_type, pid, user_str, details);
-        } else {
-            EXERAY_TRACE("{}: pid={}, user={}", event_type, pid, user_str);
-        }
+        EXERAY_TRACE("{}: pid={}, user={}{}{}", event_type, pid, wstring_to_narrow(user),
+                     separator, details);
     }
 }
 
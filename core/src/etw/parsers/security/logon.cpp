@@ -1,5 +1,5 @@
 /// @file logon.cpp
-/// @brief Logon event parsers (4624, 4625).
+/// @brief Logon event parsers (4624, 4625, 4634).
 
 #ifdef _WIN32
 
@@ -39,18 +39,22 @@ ParsedEvent parse_logon_success(const EVENT_RECORD* record, event::StringPool* s
     if (offset + sizeof(uint32_t) <= len) {
         std::memcpy(&logon_type, data + offset, sizeof(uint32_t));
     }
+    offset += sizeof(uint32_t);
+    
+    // Session the logon opens, and where it came from
+    if (offset + sizeof(uint64_t) <= len) {
+        std::memcpy(&result.logon_id, data + offset, sizeof(uint64_t));
+        offset += sizeof(uint64_t);
+        std::wstring_view source = extract_wstring(data + offset, len - offset);
+        if (!source.empty() && source != L"-" && strings != nullptr) {
+            result.logon_source = strings->intern_wide(source);
+        }
+    }
     
     bool suspicious = (logon_type == logon_types::REMOTE_INTERACTIVE);
     
-    if (strings != nullptr) {
-        result.payload.security.subject_user = subject_user.empty() ?
-            event::INVALID_STRING : strings->intern_wide(subject_user);
-        result.payload.security.target_user = target_user.empty() ?
-            event::INVALID_STRING : strings->intern_wide(target_user);
-    } else {
-        result.payload.security.subject_user = event::INVALID_STRING;
-        result.payload.security.target_user = event::INVALID_STRING;
-    }
+    set_wstring(result, result.payload.security.subject_user, subject_user, strings);
+    set_wstring(result, result.payload.security.target_user, target_user, strings);
     result.payload.security.command_line = event::INVALID_STRING;
     result.payload.security.logon_type = logon_type;
     result.payload.security.process_id = result.pid;
@@ -95,11 +99,7 @@ ParsedEvent parse_logon_failed(const EVENT_RECORD* record, event::StringPool* st
     
     bool brute_force = get_brute_force_tracker().check_and_record(target_user);
     
-    if (strings != nullptr && !target_user.empty()) {
-        result.payload.security.target_user = strings->intern_wide(target_user);
-    } else {
-        result.payload.security.target_user = event::INVALID_STRING;
-    }
+    set_wstring(result, result.payload.security.target_user, target_user, strings);
     result.payload.security.subject_user = event::INVALID_STRING;
     result.payload.security.command_line = event::INVALID_STRING;
     result.payload.security.logon_type = logon_type;
@@ -119,6 +119,46 @@ ParsedEvent parse_logon_failed(const EVENT_RECORD* record, event::StringPool* st
     return result;
 }
 
+ParsedEvent parse_logoff(const EVENT_RECORD* record, event::StringPool* strings) {
+    ParsedEvent result{};
+    exeray::etw::extract_common(record, result, event::Category::Security);
+    result.category = event::Category::Security;
+    result.operation = static_cast<uint8_t>(event::SecurityOp::Logoff);
+    result.payload.category = event::Category::Security;
+    
+    const auto* data = static_cast<const uint8_t*>(record->UserData);
+    const auto len = record->UserDataLength;
+    
+    if (data == nullptr || len < 8) {
+        result.valid = false;
+        return result;
+    }
+    
+    size_t offset = 0;
+    std::wstring_view target_user = extract_wstring(data + offset, len - offset);
+    offset += (target_user.size() + 1) * sizeof(wchar_t);
+    
+    uint32_t logon_type = 0;
+    if (offset + sizeof(uint32_t) <= len) {
+        std::memcpy(&logon_type, data + offset, sizeof(uint32_t));
+    }
+    offset += sizeof(uint32_t);
+    if (offset + sizeof(uint64_t) <= len) {
+        std::memcpy(&result.logon_id, data + offset, sizeof(uint64_t));
+    }
+    
+    set_wstring(result, result.payload.security.target_user, target_user, strings);
+    result.payload.security.subject_user = event::INVALID_STRING;
+    result.payload.security.command_line = event::INVALID_STRING;
+    result.payload.security.logon_type = logon_type;
+    result.payload.security.process_id = 0;
+    result.payload.security.is_suspicious = 0;
+    std::memset(result.payload.security._pad, 0, sizeof(result.payload.security._pad));
+    
+    result.valid = true;
+    return result;
+}
+
 }  // namespace exeray::etw::security
 
 #endif  // _WIN32
@@ -38,28 +38,25 @@ ParsedEvent parse_process_create(const EVENT_RECORD* record, event::StringPool*
     offset += (process_name.size() + 1) * sizeof(wchar_t);
     
     std::wstring_view command_line = extract_wstring(data + offset, len - offset);
+    offset += (command_line.size() + 1) * sizeof(wchar_t);
+    
+    // Logon session of the creator, attributed by the consumer
+    if (offset + sizeof(uint64_t) <= len) {
+        std::memcpy(&result.logon_id, data + offset, sizeof(uint64_t));
+    }
     
     uint32_t new_pid = 0;
     
-    if (strings != nullptr) {
-        result.payload.security.subject_user = subject_user.empty() ?
-            event::INVALID_STRING : strings->intern_wide(subject_user);
-        result.payload.security.target_user = event::INVALID_STRING;
-        result.payload.security.command_line = command_line.empty() ?
-            event::INVALID_STRING : strings->intern_wide(command_line);
-    } else {
-        result.payload.security.subject_user = event::INVALID_STRING;
-        result.payload.security.target_user = event::INVALID_STRING;
-        result.payload.security.command_line = event::INVALID_STRING;
-    }
+    set_wstring(result, result.payload.security.subject_user, subject_user, strings);
+    result.payload.security.target_user = event::INVALID_STRING;
+    set_wstring(result, result.payload.security.command_line, command_line, strings);
     result.payload.security.logon_type = 0;
     result.payload.security.process_id = new_pid;
     result.payload.security.is_suspicious = 0;
     std::memset(result.payload.security._pad, 0, sizeof(result.payload.security._pad));
     
-    std::string user_str = wstring_to_narrow(subject_user);
-    std::string cmdline_str = wstring_to_narrow(command_line);
-    EXERAY_TRACE("Process Create: user={}, cmdline={}", user_str, cmdline_str);
+    EXERAY_TRACE("Process Create: user={}, cmdline={}", wstring_to_narrow(subject_user),
+                 wstring_to_narrow(command_line));
     
     result.valid = true;
     return result;
@@ -85,13 +82,13 @@ ParsedEvent parse_process_terminate(const EVENT_RECORD* record, event::StringPoo
     offset += (subject_user.size() + 1) * sizeof(wchar_t);
     
     std::wstring_view process_name = extract_wstring(data + offset, len - offset);
+    offset += (process_name.size() + 1) * sizeof(wchar_t);
     
-    if (strings != nullptr) {
-        result.payload.security.subject_user = subject_user.empty() ?
-            event::INVALID_STRING : strings->intern_wide(subject_user);
-    } else {
-        result.payload.security.subject_user = event::INVALID_STRING;
+    if (offset + sizeof(uint64_t) <= len) {
+        std::memcpy(&result.logon_id, data + offset, sizeof(uint64_t));
     }
+    
+    set_wstring(result, result.payload.security.subject_user, subject_user, strings);
     result.payload.security.target_user = event::INVALID_STRING;
     result.payload.security.command_line = event::INVALID_STRING;
     result.payload.security.logon_type = 0;
@@ -99,8 +96,8 @@ ParsedEvent parse_process_terminate(const EVENT_RECORD* record, event::StringPoo
     result.payload.security.is_suspicious = 0;
     std::memset(result.payload.security._pad, 0, sizeof(result.payload.security._pad));
     
-    std::string process_str = wstring_to_narrow(process_name);
-    EXERAY_TRACE("Process Terminate: pid={}, process={}", result.pid, process_str);
+    EXERAY_TRACE("Process Terminate: pid={}, process={}", result.pid,
+                 wstring_to_narrow(process_name));
     
     result.valid = true;
     return result;
@@ -48,15 +48,8 @@ ParsedEvent parse_service_install(const EVENT_RECORD* record, event::StringPool*
     
     bool suspicious = (start_type == service_start_types::AUTO_START);
     
-    if (strings != nullptr) {
-        result.payload.service.service_name = service_name.empty() ?
-            event::INVALID_STRING : strings->intern_wide(service_name);
-        result.payload.service.service_path = service_path.empty() ?
-            event::INVALID_STRING : strings->intern_wide(service_path);
-    } else {
-        result.payload.service.service_name = event::INVALID_STRING;
-        result.payload.service.service_path = event::INVALID_STRING;
-    }
+    set_wstring(result, result.payload.service.service_name, service_name, strings);
+    set_wstring(result, result.payload.service.service_path, service_path, strings);
     result.payload.service.service_type = service_type;
     result.payload.service.start_type = start_type;
     result.payload.service.is_suspicious = suspicious ? 1 : 0;
@@ -66,13 +59,13 @@ ParsedEvent parse_service_install(const EVENT_RECORD* record, event::StringPool*
         result.status = event::Status::Suspicious;
     }
     
-    std::string name_str = wstring_to_narrow(service_name);
-    std::string path_str = wstring_to_narrow(service_path, 80);
     if (suspicious) {
-        EXERAY_WARN("Service Install (AUTO_START - Persistence!): name={}, path={}",
-                    name_str, path_str);
+        EXERAY_WARN_LIMITED(kSuspiciousLogsPerSecond,
+                            "Service Install (AUTO_START - Persistence!): name={}, path={}",
+                            wstring_to_narrow(service_name), wstring_to_narrow(service_path, 80));
     } else {
-        EXERAY_TRACE("Service Install: name={}, path={}", name_str, path_str);
+        EXERAY_TRACE("Service Install: name={}, path={}", wstring_to_narrow(service_name),
+                     wstring_to_narrow(service_path, 80));
     }
     
     result.valid = true;
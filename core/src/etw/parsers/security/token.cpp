@@ -38,18 +38,17 @@ ParsedEvent parse_token_rights(const EVENT_RECORD* record, event::StringPool* st
     offset += (domain.size() + 1) * sizeof(wchar_t);
     
     std::wstring_view enabled_privs = extract_wstring(data + offset, len - offset);
+    offset += (enabled_privs.size() + 1) * sizeof(wchar_t);
+    
+    // Logon session of the adjusted token, attributed by the consumer
+    if (offset + sizeof(uint64_t) <= len) {
+        std::memcpy(&result.logon_id, data + offset, sizeof(uint64_t));
+    }
     
     bool suspicious = has_dangerous_privilege(enabled_privs);
     
-    if (strings != nullptr) {
-        result.payload.security.subject_user = subject_user.empty() ?
-            event::INVALID_STRING : strings->intern_wide(subject_user);
-        result.payload.security.target_user = target_user.empty() ?
-            event::INVALID_STRING : strings->intern_wide(target_user);
-    } else {
-        result.payload.security.subject_user = event::INVALID_STRING;
-        result.payload.security.target_user = event::INVALID_STRING;
-    }
+    set_wstring(result, result.payload.security.subject_user, subject_user, strings);
+    set_wstring(result, result.payload.security.target_user, target_user, strings);
     result.payload.security.command_line = event::INVALID_STRING;
     result.payload.security.logon_type = 0;
     result.payload.security.process_id = result.pid;
@@ -58,10 +57,9 @@ ParsedEvent parse_token_rights(const EVENT_RECORD* record, event::StringPool* st
     
     if (suspicious) {
         result.status = event::Status::Suspicious;
-        std::string user_str = wstring_to_narrow(subject_user);
-        std::string privs_str = wstring_to_narrow(enabled_privs);
-        EXERAY_WARN("Token Rights (DANGEROUS PRIVILEGE!): user={}, privs={}",
-                    user_str, privs_str);
+        EXERAY_WARN_LIMITED(kSuspiciousLogsPerSecond,
+                            "Token Rights (DANGEROUS PRIVILEGE!): user={}, privs={}",
+                            wstring_to_narrow(subject_user), wstring_to_narrow(enabled_privs));
     }
     
     result.valid = true;
@@ -4,58 +4,73 @@
 #ifdef _WIN32
 
 #include "detection.hpp"
-#include <cwchar>
 
-namespace exeray::etw::wmi {
+#include <array>
+#include <cstddef>
+#include <cstdint>
 
-bool contains_icase(std::wstring_view haystack, const wchar_t* needle) {
-    if (haystack.empty() || needle == nullptr || needle[0] == L'\0') {
-        return false;
-    }
+#include "exeray/etw/text_search.hpp"
 
-    size_t needle_len = wcslen(needle);
-    if (needle_len > haystack.size()) {
-        return false;
-    }
+namespace exeray::etw::wmi {
 
-    for (size_t i = 0; i <= haystack.size() - needle_len; ++i) {
-        bool match = true;
-        for (size_t j = 0; j < needle_len; ++j) {
-            wchar_t h = haystack[i + j];
-            wchar_t n = needle[j];
-            // Fold to lowercase
-            if (h >= L'A' && h <= L'Z') h = h - L'A' + L'a';
-            if (n >= L'A' && n <= L'Z') n = n - L'A' + L'a';
-            if (h != n) {
-                match = false;
-                break;
-            }
-        }
-        if (match) return true;
-    }
-    return false;
+namespace {
+
+/// Needles of is_suspicious_wmi_activity(), searched in one pass.
+enum ActivityNeedle : std::size_t {
+    Win32Process,
+    Create,
+    FirstPersistence,  ///< Event subscription classes, then PowerShell
+};
+
+constexpr IcaseNeedles ACTIVITY_NEEDLES = {
+    L"Win32_Process",
+    L"Create",
+    // WMI event subscription persistence
+    L"__EventConsumer",
+    L"__EventFilter",
+    L"__FilterToConsumerBinding",
+    L"CommandLineEventConsumer",
+    L"ActiveScriptEventConsumer",
+    // PowerShell execution via WMI
+    L"powershell",
+    L"pwsh",
+};
+
+constexpr IcaseNeedles LOCAL_HOST_NEEDLES = {L"127.0.0.1", L"::1"};
+
+constexpr std::uint64_t bit(std::size_t needle) {
+    return std::uint64_t{1} << needle;
 }
 
+/// @brief Direct-mapped verdicts of one consumer thread; StringIds are
+/// never reused within a pool, so an entry stays right until evicted.
+struct VerdictCache {
+    static constexpr std::size_t kSlots = 1024;
+
+    struct Slot {
+        std::uint64_t key = 0;
+        bool used = false;
+        bool suspicious = false;
+    };
+
+    const event::StringPool* pool = nullptr;
+    std::array<Slot, kSlots> slots{};
+};
+
+}  // namespace
+
 bool is_suspicious_wmi_activity(std::wstring_view query_or_method,
                                  std::wstring_view wmi_namespace) {
-    // Check for process creation (fileless execution)
-    if (contains_icase(query_or_method, L"Win32_Process") &&
-        contains_icase(query_or_method, L"Create")) {
-        return true;
-    }
+    const std::uint64_t found = ACTIVITY_NEEDLES.match(query_or_method);
 
-    // Check for WMI event subscription persistence
-    if (contains_icase(query_or_method, L"__EventConsumer") ||
-        contains_icase(query_or_method, L"__EventFilter") ||
-        contains_icase(query_or_method, L"__FilterToConsumerBinding") ||
-        contains_icase(query_or_method, L"CommandLineEventConsumer") ||
-        contains_icase(query_or_method, L"ActiveScriptEventConsumer")) {
+    // Check for process creation (fileless execution)
+    const std::uint64_t process_create = bit(Win32Process) | bit(Create);
+    if ((found & process_create) == process_create) {
         return true;
     }
 
-    // Check for PowerShell execution via WMI
-    if (contains_icase(query_or_method, L"powershell") ||
-        contains_icase(query_or_method, L"pwsh")) {
+    // Check for event subscription persistence or PowerShell via WMI
+    if ((found >> FirstPersistence) != 0) {
         return true;
     }
 
@@ -67,13 +82,31 @@ bool is_suspicious_wmi_activity(std::wstring_view query_or_method,
     return false;
 }
 
+bool is_suspicious_wmi_activity_cached(const event::StringPool* pool,
+                                       event::StringId namespace_id, event::StringId query_id,
+                                       std::wstring_view query_or_method,
+                                       std::wstring_view wmi_namespace) {
+    if (pool == nullptr || query_id == event::INVALID_STRING) {
+        return is_suspicious_wmi_activity(query_or_method, wmi_namespace);
+    }
+    thread_local VerdictCache cache;
+    if (cache.pool != pool) {
+        cache.slots.fill({});
+        cache.pool = pool;
+    }
+    const std::uint64_t key = (std::uint64_t{namespace_id} << 32) | query_id;
+    auto& slot = cache.slots[((key * 0x9E3779B97F4A7C15ULL) >> 54) % VerdictCache::kSlots];
+    if (!slot.used || slot.key != key) {
+        slot = {key, true, is_suspicious_wmi_activity(query_or_method, wmi_namespace)};
+    }
+    return slot.suspicious;
+}
+
 bool is_remote_host(std::wstring_view host) {
     if (host.empty()) return false;
 
     // Local indicators
-    if (host == L"." || host == L"localhost" ||
-        contains_icase(host, L"127.0.0.1") ||
-        contains_icase(host, L"::1")) {
+    if (host == L"." || host == L"localhost" || LOCAL_HOST_NEEDLES.any(host)) {
         return false;
     }
 
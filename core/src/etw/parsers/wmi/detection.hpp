@@ -5,15 +5,25 @@
 
 #include <string_view>
 
-namespace exeray::etw::wmi {
+#include "exeray/event/types.hpp"
+
+namespace exeray::event {
+class StringPool;
+}  // namespace exeray::event
 
-/// @brief Case-insensitive wide string contains check.
-bool contains_icase(std::wstring_view haystack, const wchar_t* needle);
+namespace exeray::etw::wmi {
 
 /// @brief Check if WMI query/method indicates suspicious activity.
 bool is_suspicious_wmi_activity(std::wstring_view query_or_method,
                                  std::wstring_view wmi_namespace);
 
+/// @brief is_suspicious_wmi_activity() remembered per interned (namespace,
+/// query) of a pool, so the operations agents repeat are scanned once.
+bool is_suspicious_wmi_activity_cached(const event::StringPool* pool,
+                                       event::StringId namespace_id, event::StringId query_id,
+                                       std::wstring_view query_or_method,
+                                       std::wstring_view wmi_namespace);
+
 /// @brief Check if target host indicates remote WMI.
 bool is_remote_host(std::wstring_view host);
 
@@ -28,12 +28,14 @@ ParsedEvent parse_wmi_event(const EVENT_RECORD* record, event::StringPool* strin
             return wmi::parse_wmi_operation(record, strings, event::WmiOp::Subscribe);
         case ids::wmi::NAMESPACE_CONNECT:
             return wmi::parse_wmi_operation(record, strings, event::WmiOp::Connect);
-        default:
+        default: {
             // Unknown event ID - try TDH fallback
-            if (auto tdh_result = parse_with_tdh(record)) {
-                return convert_tdh_to_wmi(*tdh_result, record, strings);
+            TdhParsedEvent tdh_event;
+            if (parse_with_tdh(record, tdh_event)) {
+                return convert_tdh_to_wmi(tdh_event, record, strings);
             }
             return ParsedEvent{.valid = false};
+        }
     }
 }
 
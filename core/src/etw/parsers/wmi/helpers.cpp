@@ -4,6 +4,7 @@
 #ifdef _WIN32
 
 #include "exeray/etw/parser.hpp"
+#include "exeray/etw/parser_utils.hpp"
 #include "exeray/event/types.hpp"
 #include "exeray/logging.hpp"
 
@@ -53,25 +54,25 @@ void log_wmi_operation(uint32_t pid, event::WmiOp op,
         case event::WmiOp::Connect: op_name = "Connect"; break;
     }
 
-    std::string ns_str = wstring_to_narrow(ns, 80);
-    std::string query_str = wstring_to_narrow(query, 80);
-    std::string host_str = wstring_to_narrow(host, 80);
-
     if (is_suspicious) {
         if (!host.empty()) {
-            EXERAY_WARN("Suspicious WMI {}: pid={}, ns={}, query={}, host={}",
-                        op_name, pid, ns_str, query_str, host_str);
+            EXERAY_WARN_LIMITED(kSuspiciousLogsPerSecond,
+                                "Suspicious WMI {}: pid={}, ns={}, query={}, host={}", op_name,
+                                pid, wstring_to_narrow(ns, 80), wstring_to_narrow(query, 80),
+                                wstring_to_narrow(host, 80));
         } else {
-            EXERAY_WARN("Suspicious WMI {}: pid={}, ns={}, query={}",
-                        op_name, pid, ns_str, query_str);
+            EXERAY_WARN_LIMITED(kSuspiciousLogsPerSecond,
+                                "Suspicious WMI {}: pid={}, ns={}, query={}", op_name, pid,
+                                wstring_to_narrow(ns, 80), wstring_to_narrow(query, 80));
         }
     } else {
         if (!host.empty()) {
-            EXERAY_TRACE("WMI {}: pid={}, ns={}, query={}, host={}",
-                         op_name, pid, ns_str, query_str, host_str);
+            EXERAY_TRACE("WMI {}: pid={}, ns={}, query={}, host={}", op_name, pid,
+                         wstring_to_narrow(ns, 80), wstring_to_narrow(query, 80),
+                         wstring_to_narrow(host, 80));
         } else {
-            EXERAY_TRACE("WMI {}: pid={}, ns={}, query={}",
-                         op_name, pid, ns_str, query_str);
+            EXERAY_TRACE("WMI {}: pid={}, ns={}, query={}", op_name, pid,
+                         wstring_to_narrow(ns, 80), wstring_to_narrow(query, 80));
         }
     }
 }
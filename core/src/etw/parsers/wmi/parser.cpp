@@ -48,8 +48,19 @@ ParsedEvent parse_wmi_operation(const EVENT_RECORD* record,
         target_host = extract_wstring(data + offset, len - offset);
     }
 
+    // Namespace and query are interned up front: agents repeat the same
+    // ones, and their ids key the verdict cache
+    auto& wmi = result.payload.wmi;
+    wmi.wmi_namespace = wmi_namespace.empty() || strings == nullptr
+                            ? event::INVALID_STRING
+                            : strings->intern_wide(wmi_namespace);
+    wmi.query = query.empty() || strings == nullptr ? event::INVALID_STRING
+                                                    : strings->intern_wide(query);
+    set_wstring(result, wmi.target_host, target_host, strings);
+
     // Check for suspicious patterns
-    bool suspicious = is_suspicious_wmi_activity(query, wmi_namespace);
+    bool suspicious = is_suspicious_wmi_activity_cached(strings, wmi.wmi_namespace, wmi.query,
+                                                        query, wmi_namespace);
     bool remote = is_remote_host(target_host);
 
     // Remote WMI is always suspicious (lateral movement)
@@ -57,32 +68,10 @@ ParsedEvent parse_wmi_operation(const EVENT_RECORD* record,
         suspicious = true;
     }
 
-    // Set payload with interned strings
-    if (strings != nullptr) {
-        if (!wmi_namespace.empty()) {
-            result.payload.wmi.wmi_namespace = strings->intern_wide(wmi_namespace);
-        } else {
-            result.payload.wmi.wmi_namespace = event::INVALID_STRING;
-        }
-        if (!query.empty()) {
-            result.payload.wmi.query = strings->intern_wide(query);
-        } else {
-            result.payload.wmi.query = event::INVALID_STRING;
-        }
-        if (!target_host.empty()) {
-            result.payload.wmi.target_host = strings->intern_wide(target_host);
-        } else {
-            result.payload.wmi.target_host = event::INVALID_STRING;
-        }
-    } else {
-        result.payload.wmi.wmi_namespace = event::INVALID_STRING;
-        result.payload.wmi.query = event::INVALID_STRING;
-        result.payload.wmi.target_host = event::INVALID_STRING;
-    }
-
     result.payload.wmi.is_remote = remote ? 1 : 0;
     result.payload.wmi.is_suspicious = suspicious ? 1 : 0;
     std::memset(result.payload.wmi._pad, 0, sizeof(result.payload.wmi._pad));
+    result.payload.wmi.count = 1;
 
     // Set status
     result.status = suspicious ? event::Status::Suspicious : event::Status::Success;
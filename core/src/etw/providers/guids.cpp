@@ -42,6 +42,11 @@ const GUID KERNEL_MEMORY = {
     0x3D6FA8D3, 0xFE05, 0x11D0, {0x9D, 0xDA, 0x00, 0xC0, 0x4F, 0xD7, 0xBA, 0x7C}
 };
 
+// Stack walk events {DEF2FE46-7BD6-4B80-BD94-F57FE20D0CE3}
+const GUID KERNEL_STACK_WALK = {
+    0xDEF2FE46, 0x7BD6, 0x4B80, {0xBD, 0x94, 0xF5, 0x7F, 0xE2, 0x0D, 0x0C, 0xE3}
+};
+
 // Microsoft-Windows-PowerShell {A0C1853B-5C40-4B15-8766-3CF1C58F985A}
 const GUID POWERSHELL = {
     0xA0C1853B, 0x5C40, 0x4B15, {0x87, 0x66, 0x3C, 0xF1, 0xC5, 0x8F, 0x98, 0x5A}
@@ -82,6 +87,7 @@ const GUID KERNEL_NETWORK = {0, 0, 0, {0}};
 const GUID KERNEL_IMAGE = {0, 0, 0, {0}};
 const GUID KERNEL_THREAD = {0, 0, 0, {0}};
 const GUID KERNEL_MEMORY = {0, 0, 0, {0}};
+const GUID KERNEL_STACK_WALK = {0, 0, 0, {0}};
 const GUID POWERSHELL = {0, 0, 0, {0}};
 const GUID AMSI = {0, 0, 0, {0}};
 const GUID DNS_CLIENT = {0, 0, 0, {0}};
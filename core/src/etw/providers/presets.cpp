@@ -0,0 +1,152 @@
+/// @file etw/providers/presets.cpp
+/// @brief Level, keyword and event ID presets per provider.
+///
+/// Event IDs are the ones the parsers handle (event_ids.hpp). Keywords
+/// are only narrowed where the provider's manifest defines them per event
+/// group; elsewhere the ID filter does the work. Providers without a
+/// manifest (Image, Thread, Memory) ignore ID filters, so only their level
+/// changes.
+
+#include "exeray/etw/provider_presets.hpp"
+#include "exeray/etw/event_ids.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace exeray::etw {
+
+namespace {
+
+// Microsoft-Windows-Kernel-Process keywords
+constexpr std::uint64_t kProcessKeyword = 0x10;
+constexpr std::uint64_t kThreadKeyword = 0x20;
+constexpr std::uint64_t kImageKeyword = 0x40;
+
+// Microsoft-Windows-Kernel-File keywords
+constexpr std::uint64_t kFileNameKeyword = 0x10;  ///< Names of files open at a rundown
+constexpr std::uint64_t kFileCreateKeyword = 0x80;
+constexpr std::uint64_t kFileWriteKeyword = 0x200;
+constexpr std::uint64_t kFileDeletePathKeyword = 0x400;
+constexpr std::uint64_t kFileFileIoKeyword = 0x20;  ///< Cleanup and close
+
+constexpr std::array kProcessMinimal = {ids::process::START, ids::process::STOP,
+                                        ids::process::RUNDOWN};
+
+constexpr std::array kRegistryMinimal = {ids::registry::CREATE_KEY, ids::registry::SET_VALUE,
+                                         ids::registry::VALUE_DELETE};
+constexpr std::array kRegistrySecurity = {ids::registry::CREATE_KEY, ids::registry::OPEN_KEY,
+                                          ids::registry::SET_VALUE, ids::registry::VALUE_DELETE,
+                                          ids::registry::CLOSE_KEY};
+
+constexpr std::array kNetworkMinimal = {ids::network::TCP_CONNECT, ids::network::TCP_ACCEPT,
+                                        ids::network::TCP_DISCONNECT,
+                                        ids::network::TCP_DISCONNECT_V6};
+constexpr std::array kNetworkSecurity = {
+    ids::network::TCP_CONNECT,    ids::network::TCP_ACCEPT,       ids::network::TCP_DISCONNECT,
+    ids::network::TCP_DISCONNECT_V6, ids::network::UDP_SEND,      ids::network::UDP_RECEIVE};
+
+constexpr std::array kPowerShellMinimal = {ids::powershell::SCRIPT_BLOCK_LOGGING};
+constexpr std::array kPowerShellSecurity = {ids::powershell::MODULE_LOGGING,
+                                            ids::powershell::SCRIPT_BLOCK_LOGGING};
+
+constexpr std::array kAmsi = {ids::amsi::SCAN_BUFFER};
+
+// Events captured with a stack under Security and Full
+constexpr std::array kThreadStacks = {ids::thread::START};
+constexpr std::array kMemoryStacks = {ids::memory::VIRTUAL_ALLOC};
+
+constexpr std::array kDnsMinimal = {ids::dns::QUERY_COMPLETED};
+constexpr std::array kDnsSecurity = {ids::dns::QUERY_COMPLETED, ids::dns::QUERY_FAILED,
+                                     ids::dns::QUERY_SENT};
+
+constexpr std::array kWmiMinimal = {ids::wmi::EXEC_METHOD};
+constexpr std::array kWmiSecurity = {ids::wmi::NAMESPACE_CONNECT, ids::wmi::EXEC_QUERY,
+                                     ids::wmi::EXEC_NOTIFICATION_QUERY, ids::wmi::EXEC_METHOD};
+
+constexpr std::array kClrMinimal = {ids::clr::ASSEMBLY_LOAD_STOP};
+constexpr std::array kClrSecurity = {ids::clr::MODULE_LOAD, ids::clr::ASSEMBLY_LOAD_START,
+                                     ids::clr::ASSEMBLY_LOAD_STOP, ids::clr::ASSEMBLY_UNLOAD};
+
+constexpr std::array kSecurityMinimal = {ids::security::LOGON_FAILED,
+                                         ids::security::PROCESS_CREATE};
+constexpr std::array kSecuritySecurity = {
+    ids::security::LOGON_SUCCESS, ids::security::LOGON_FAILED, ids::security::LOGOFF,
+    ids::security::PROCESS_CREATE, ids::security::PROCESS_EXIT,
+    ids::security::SERVICE_INSTALLED, ids::security::TOKEN_RIGHTS};
+
+/// @brief One provider's Minimal and Security settings (Full is all
+/// keywords, with the stacks of Security).
+struct ProviderPresets {
+    std::string_view name;
+    PresetSettings minimal;
+    PresetSettings security;
+    std::uint8_t full_level = 4;
+};
+
+const ProviderPresets kPresets[] = {
+    {"Process", {4, kProcessKeyword, kProcessMinimal},
+     {4, kProcessKeyword | kThreadKeyword | kImageKeyword, {}}},
+    // Keywords only: an ID filter would also drop the rundown of open files
+    {"File", {4, kFileNameKeyword | kFileCreateKeyword | kFileDeletePathKeyword, {}},
+     {4,
+      kFileNameKeyword | kFileCreateKeyword | kFileWriteKeyword | kFileDeletePathKeyword |
+          kFileFileIoKeyword,
+      {}}},
+    {"Registry", {4, 0, kRegistryMinimal}, {4, 0, kRegistrySecurity}},
+    {"Network", {4, 0, kNetworkMinimal}, {4, 0, kNetworkSecurity}},
+    {"Image", {4, 0, {}}, {4, 0, {}}},
+    {"Thread", {4, 0, {}}, {4, 0, {}, kThreadStacks}},
+    {"Memory", {4, 0, {}}, {4, 0, {}, kMemoryStacks}, 5},
+    // Script block logging is a VERBOSE event
+    {"PowerShell", {5, 0, kPowerShellMinimal}, {5, 0, kPowerShellSecurity}, 5},
+    {"AMSI", {4, 0, kAmsi}, {4, 0, kAmsi, kAmsi}},
+    {"DNS", {4, 0, kDnsMinimal}, {4, 0, kDnsSecurity}},
+    {"WMI", {4, 0, kWmiMinimal}, {4, 0, kWmiSecurity}},
+    {"CLR", {4, 0, kClrMinimal}, {4, 0, kClrSecurity}},
+    {"Security", {4, 0, kSecurityMinimal}, {4, 0, kSecuritySecurity}},
+};
+
+}  // namespace
+
+std::optional<PresetSettings> provider_preset(std::string_view provider, ProviderPreset preset) {
+    if (preset == ProviderPreset::Custom) {
+        return std::nullopt;
+    }
+    for (const ProviderPresets& entry : kPresets) {
+        if (entry.name != provider) {
+            continue;
+        }
+        switch (preset) {
+            case ProviderPreset::Minimal:
+                return entry.minimal;
+            case ProviderPreset::Security:
+                return entry.security;
+            default:
+                return PresetSettings{entry.full_level, 0, {}, entry.security.stack_event_ids};
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<ProviderPreset> parse_provider_preset(std::string_view name) {
+    if (name == "custom") return ProviderPreset::Custom;
+    if (name == "minimal") return ProviderPreset::Minimal;
+    if (name == "security") return ProviderPreset::Security;
+    if (name == "full") return ProviderPreset::Full;
+    return std::nullopt;
+}
+
+std::string_view preset_name(ProviderPreset preset) {
+    switch (preset) {
+        case ProviderPreset::Minimal:
+            return "minimal";
+        case ProviderPreset::Security:
+            return "security";
+        case ProviderPreset::Full:
+            return "full";
+        default:
+            return "custom";
+    }
+}
+
+}  // namespace exeray::etw
@@ -0,0 +1,166 @@
+/// @file rate_monitor.cpp
+/// @brief Per-process event rate baselines (platform independent).
+
+#include "exeray/etw/rate_monitor.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace exeray::etw {
+
+namespace {
+
+std::size_t shard_of(std::uint32_t pid) noexcept {
+    return (pid * 0x9E3779B1U) >> 28;
+}
+
+std::size_t set_of(std::uint32_t pid, event::Category category, std::size_t sets) noexcept {
+    const std::uint32_t h =
+        (pid * 0x85EBCA6BU) ^ (static_cast<std::uint32_t>(category) * 0xC2B2AE35U);
+    return (h ^ (h >> 15)) % sets;
+}
+
+}  // namespace
+
+RateMonitor::RateMonitor(const RateConfig& config)
+    : config_(config),
+      window_(static_cast<event::Timestamp>((std::max)(config.window_ms, 1U)) * 1'000'000),
+      idle_(static_cast<event::Timestamp>(config.idle_ms) * 1'000'000),
+      shard_size_((std::max)((config.capacity / kShards + kProbe - 1) / kProbe, std::size_t{1}) *
+                  kProbe) {
+    for (Shard& shard : shards_) {
+        shard.entries = std::make_unique<Entry[]>(shard_size_);
+    }
+}
+
+RateMonitor::Entry& RateMonitor::find(Shard& shard, std::uint32_t pid, event::Category category,
+                                      event::Timestamp at) {
+    Entry* set = &shard.entries[set_of(pid, category, shard_size_ / kProbe) * kProbe];
+    // Replace a free entry, else an idle one, else the least recently seen
+    const auto rank = [this, at](const Entry& entry) {
+        return entry.pid == 0 ? 0 : at >= entry.last_seen + idle_ ? 1 : 2;
+    };
+    Entry* victim = set;
+    for (std::size_t i = 0; i < kProbe; ++i) {
+        Entry& entry = set[i];
+        if (entry.pid == pid && entry.category == category) {
+            return entry;
+        }
+        const int r = rank(entry);
+        const int best = rank(*victim);
+        if (r < best || (r == best && entry.last_seen < victim->last_seen)) {
+            victim = &entry;
+        }
+    }
+    if (rank(*victim) == 2) {
+        ++shard.evicted;
+    }
+    *victim = Entry{};
+    victim->pid = pid;
+    victim->category = category;
+    victim->window_start = at;
+    victim->last_seen = at;
+    return *victim;
+}
+
+void RateMonitor::roll(Entry& entry, event::Timestamp at) const noexcept {
+    if (at < entry.window_start + window_) {
+        return;  // Same window, or an event older than it
+    }
+    const event::Timestamp elapsed = (at - entry.window_start) / window_;
+    const double count = entry.count;
+    entry.baseline = entry.windows == 0
+                         ? count
+                         : config_.alpha * count + (1.0 - config_.alpha) * entry.baseline;
+    if (elapsed > 1) {
+        // Windows without events pull the baseline toward zero
+        entry.baseline *= std::pow(1.0 - config_.alpha, static_cast<double>(elapsed - 1));
+    }
+    entry.windows = static_cast<std::uint32_t>(
+        (std::min)(static_cast<event::Timestamp>(entry.windows) + elapsed,
+                   event::Timestamp{0xFFFFFFFF}));
+    entry.window_start += elapsed * window_;
+    entry.count = 0;
+    entry.flagged = false;
+}
+
+bool RateMonitor::observe(std::uint32_t pid, event::Category category, event::Timestamp at) {
+    if (pid == 0) {
+        return false;
+    }
+    const double seconds = static_cast<double>(window_) / 1e9;
+    RateAnomaly anomaly;
+    {
+        Shard& shard = shards_[shard_of(pid)];
+        const std::lock_guard lock(shard.mutex);
+        ++shard.observed;
+        Entry& entry = find(shard, pid, category, at);
+        roll(entry, at);
+        ++entry.count;
+        entry.last_seen = (std::max)(entry.last_seen, at);
+        if (entry.flagged || entry.windows < config_.warmup_windows) {
+            return false;
+        }
+        const double threshold =
+            (std::max)(config_.factor * entry.baseline, config_.min_rate * seconds);
+        if (static_cast<double>(entry.count) <= threshold) {
+            return false;
+        }
+        entry.flagged = true;
+        anomaly = {pid, category, entry.count / seconds, entry.baseline / seconds, at};
+    }
+
+    const std::lock_guard lock(anomaly_mutex_);
+    if (anomalies_.size() < kMaxAnomalies) {
+        anomalies_.push_back(anomaly);
+    } else {
+        anomalies_[next_anomaly_] = anomaly;
+    }
+    next_anomaly_ = (next_anomaly_ + 1) % kMaxAnomalies;
+    ++anomaly_count_;
+    return true;
+}
+
+std::vector<RateAnomaly> RateMonitor::anomalies() const {
+    const std::lock_guard lock(anomaly_mutex_);
+    if (anomalies_.size() < kMaxAnomalies) {
+        return anomalies_;
+    }
+    std::vector<RateAnomaly> ordered;
+    ordered.reserve(kMaxAnomalies);
+    ordered.insert(ordered.end(), anomalies_.begin() + static_cast<std::ptrdiff_t>(next_anomaly_),
+                   anomalies_.end());
+    ordered.insert(ordered.end(), anomalies_.begin(),
+                   anomalies_.begin() + static_cast<std::ptrdiff_t>(next_anomaly_));
+    return ordered;
+}
+
+RateStats RateMonitor::stats() const {
+    RateStats stats;
+    for (const Shard& shard : shards_) {
+        const std::lock_guard lock(shard.mutex);
+        stats.observed += shard.observed;
+        stats.evicted += shard.evicted;
+        for (std::size_t i = 0; i < shard_size_; ++i) {
+            stats.tracked += shard.entries[i].pid != 0 ? 1 : 0;
+        }
+    }
+    const std::lock_guard lock(anomaly_mutex_);
+    stats.anomalies = anomaly_count_;
+    return stats;
+}
+
+void RateMonitor::clear() {
+    for (Shard& shard : shards_) {
+        const std::lock_guard lock(shard.mutex);
+        std::fill_n(shard.entries.get(), shard_size_, Entry{});
+        shard.observed = 0;
+        shard.evicted = 0;
+    }
+    const std::lock_guard lock(anomaly_mutex_);
+    anomalies_.clear();
+    next_anomaly_ = 0;
+    anomaly_count_ = 0;
+}
+
+}  // namespace exeray::etw
@@ -0,0 +1,55 @@
+/// @file record_ring.cpp
+/// @brief RecordRing construction and consumer sleep/wake.
+
+#include "exeray/etw/record_ring.hpp"
+
+namespace exeray::etw {
+
+namespace {
+
+constexpr std::size_t kMinCapacity = 4096;
+
+std::size_t round_up_pow2(std::size_t value) noexcept {
+    std::size_t size = kMinCapacity;
+    while (size < value) {
+        size <<= 1;
+    }
+    return size;
+}
+
+}  // namespace
+
+RecordRing::RecordRing(std::size_t capacity)
+    : capacity_(round_up_pow2(capacity)),
+      mask_(capacity_ - 1),
+      buffer_(std::make_unique<std::uint8_t[]>(capacity_)) {}
+
+bool RecordRing::wait() noexcept {
+    while (front().empty()) {
+        if (closed_.load(std::memory_order_acquire)) {
+            // Records pushed before close() are still delivered
+            return !front().empty();
+        }
+        const auto signal = signal_.load(std::memory_order_acquire);
+        sleeping_.store(true, std::memory_order_relaxed);
+        // Pairs with commit_write(): either we see the record or it sees us
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (front().empty() && !closed_.load(std::memory_order_acquire)) {
+            signal_.wait(signal, std::memory_order_acquire);
+        }
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void RecordRing::close() noexcept {
+    closed_.store(true, std::memory_order_release);
+    wake();
+}
+
+void RecordRing::wake() noexcept {
+    signal_.fetch_add(1, std::memory_order_release);
+    signal_.notify_one();
+}
+
+}  // namespace exeray::etw
@@ -0,0 +1,843 @@
+/// @file regex_dfa.cpp
+/// @brief Regular expression parsing, NFA compilation and lazy DFA search.
+
+#include "exeray/etw/regex_dfa.hpp"
+
+#include <algorithm>
+#include <array>
+#include <optional>
+
+#include "exeray/etw/text_search.hpp"
+
+namespace exeray::etw {
+
+namespace {
+
+using ByteSet = std::bitset<256>;
+
+constexpr std::uint32_t kInfinite = UINT32_MAX;
+constexpr std::uint32_t kMaxRepeat = 1000;     ///< Largest m or n of {m,n}
+constexpr std::size_t kMaxDepth = 64;          ///< Nested groups
+constexpr std::size_t kMaxProgram = 20000;     ///< NFA instructions
+constexpr std::size_t kMaxLiterals = 16;       ///< Prefilter literals
+constexpr std::size_t kMaxLiteralLength = 64;
+
+constexpr bool is_letter(unsigned char c) noexcept {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+constexpr unsigned char fold(unsigned char c) noexcept {
+    return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c - 'A' + 'a') : c;
+}
+
+/// @brief Add a byte, and its other case if it is an ASCII letter.
+void add_byte(ByteSet& set, unsigned char c) {
+    set.set(c);
+    if (is_letter(c)) {
+        set.set(c ^ 0x20);
+    }
+}
+
+void add_range(ByteSet& set, unsigned char first, unsigned char last) {
+    for (unsigned c = first; c <= last; ++c) {
+        add_byte(set, static_cast<unsigned char>(c));
+    }
+}
+
+/// @brief Pattern syntax tree.
+struct Node {
+    enum class Kind : std::uint8_t { Empty, Set, Concat, Alternate, Repeat } kind = Kind::Empty;
+    ByteSet set;                ///< Set
+    std::vector<Node> children; ///< Concat, Alternate; Repeat has one
+    std::uint32_t min = 0;      ///< Repeat
+    std::uint32_t max = 0;      ///< Repeat (kInfinite: unbounded)
+};
+
+/// @brief Recursive-descent parser of a pattern.
+class Parser {
+public:
+    explicit Parser(std::string_view pattern) noexcept : pattern_(pattern) {}
+
+    /// @return nullptr on success, else the reason.
+    const char* parse(Node& root, bool& anchored_start, bool& anchored_end) {
+        if (pattern_.starts_with('^')) {
+            anchored_start = true;
+            pattern_.remove_prefix(1);
+        }
+        if (pattern_.ends_with('$')) {
+            // Unless the '$' is escaped by an odd run of backslashes
+            std::size_t slashes = 0;
+            while (slashes + 1 < pattern_.size() &&
+                   pattern_[pattern_.size() - 2 - slashes] == '\\') {
+                ++slashes;
+            }
+            if (slashes % 2 == 0) {
+                anchored_end = true;
+                pattern_.remove_suffix(1);
+            }
+        }
+        if (const char* reason = alternate(root)) {
+            return reason;
+        }
+        if (pos_ != pattern_.size()) {
+            return "unbalanced ')' in regex";
+        }
+        if ((anchored_start || anchored_end) && root.kind == Node::Kind::Alternate) {
+            return "anchored regex alternatives need a group, as in ^(a|b)$";
+        }
+        return nullptr;
+    }
+
+private:
+    [[nodiscard]] bool at_end() const noexcept { return pos_ == pattern_.size(); }
+
+    [[nodiscard]] unsigned char peek() const noexcept {
+        return static_cast<unsigned char>(pattern_[pos_]);
+    }
+
+    const char* alternate(Node& node) {
+        Node first;
+        if (const char* reason = concat(first)) {
+            return reason;
+        }
+        if (at_end() || peek() != '|') {
+            node = std::move(first);
+            return nullptr;
+        }
+        node.kind = Node::Kind::Alternate;
+        node.children.push_back(std::move(first));
+        while (!at_end() && peek() == '|') {
+            ++pos_;
+            if (const char* reason = concat(node.children.emplace_back())) {
+                return reason;
+            }
+        }
+        return nullptr;
+    }
+
+    const char* concat(Node& node) {
+        node.kind = Node::Kind::Concat;
+        while (!at_end() && peek() != '|' && peek() != ')') {
+            if (const char* reason = repeat(node.children.emplace_back())) {
+                return reason;
+            }
+        }
+        if (node.children.size() == 1) {
+            Node only = std::move(node.children.front());
+            node = std::move(only);
+        } else if (node.children.empty()) {
+            node.kind = Node::Kind::Empty;
+        }
+        return nullptr;
+    }
+
+    const char* repeat(Node& node) {
+        if (const char* reason = atom(node)) {
+            return reason;
+        }
+        if (at_end()) {
+            return nullptr;
+        }
+        std::uint32_t min = 0;
+        std::uint32_t max = 0;
+        switch (peek()) {
+        case '*':
+            max = kInfinite;
+            break;
+        case '+':
+            min = 1;
+            max = kInfinite;
+            break;
+        case '?':
+            max = 1;
+            break;
+        case '{':
+            if (const char* reason = bounds(min, max)) {
+                return reason;
+            }
+            break;
+        default:
+            return nullptr;
+        }
+        ++pos_;
+        if (!at_end() && peek() == '?') {
+            ++pos_;  // Lazy: the same strings match
+        }
+        if (!at_end() && (peek() == '*' || peek() == '+' || peek() == '?' || peek() == '{')) {
+            return "nothing to repeat in regex";
+        }
+        Node child = std::move(node);
+        node = Node{};
+        node.kind = Node::Kind::Repeat;
+        node.min = min;
+        node.max = max;
+        node.children.push_back(std::move(child));
+        return nullptr;
+    }
+
+    /// @brief `{m}`, `{m,}` or `{m,n}`, leaving pos_ on the closing brace.
+    const char* bounds(std::uint32_t& min, std::uint32_t& max) {
+        ++pos_;
+        const auto number = [this]() -> std::optional<std::uint32_t> {
+            std::uint32_t value = 0;
+            const std::size_t begin = pos_;
+            while (!at_end() && peek() >= '0' && peek() <= '9') {
+                value = value * 10 + (peek() - '0');
+                if (value > kMaxRepeat) {
+                    return std::nullopt;
+                }
+                ++pos_;
+            }
+            return pos_ != begin ? std::optional(value) : std::nullopt;
+        };
+        const auto low = number();
+        if (!low) {
+            return "invalid repetition count in regex";
+        }
+        min = max = *low;
+        if (!at_end() && peek() == ',') {
+            ++pos_;
+            max = kInfinite;
+            if (!at_end() && peek() != '}') {
+                const auto high = number();
+                if (!high || *high < min) {
+                    return "invalid repetition count in regex";
+                }
+                max = *high;
+            }
+        }
+        if (at_end() || peek() != '}') {
+            return "unterminated repetition in regex";
+        }
+        return nullptr;
+    }
+
+    const char* atom(Node& node) {
+        const unsigned char c = peek();
+        switch (c) {
+        case '(': {
+            if (++depth_ > kMaxDepth) {
+                return "regex nested too deeply";
+            }
+            ++pos_;
+            if (pattern_.substr(pos_).starts_with("?:")) {
+                pos_ += 2;
+            }
+            if (const char* reason = alternate(node)) {
+                return reason;
+            }
+            if (at_end()) {
+                return "missing ')' in regex";
+            }
+            ++pos_;
+            --depth_;
+            return nullptr;
+        }
+        case '*':
+        case '+':
+        case '?':
+        case '{':
+            return "nothing to repeat in regex";
+        case '^':
+        case '$':
+            return "^ and $ are only supported at the ends of a regex";
+        case '[':
+            node.kind = Node::Kind::Set;
+            return bracket(node.set);
+        case '.':
+            ++pos_;
+            node.kind = Node::Kind::Set;
+            node.set.set();
+            node.set.reset('\n');
+            return nullptr;
+        case '\\':
+            ++pos_;
+            node.kind = Node::Kind::Set;
+            return escape(node.set);
+        default:
+            ++pos_;
+            node.kind = Node::Kind::Set;
+            add_byte(node.set, c);
+            return nullptr;
+        }
+    }
+
+    /// @brief `[...]` or `[^...]`, pos_ on the '['.
+    const char* bracket(ByteSet& set) {
+        ++pos_;
+        const bool negate = !at_end() && peek() == '^';
+        if (negate) {
+            ++pos_;
+        }
+        bool first = true;
+        while (!at_end() && (peek() != ']' || first)) {
+            first = false;
+            unsigned char low = peek();
+            if (low == '\\') {
+                ++pos_;
+                ByteSet escaped;
+                if (const char* reason = escape(escaped)) {
+                    return reason;
+                }
+                if (escaped.count() > 2 || !single(escaped, low)) {
+                    set |= escaped;  // A class such as \d: no range
+                    continue;
+                }
+            } else {
+                ++pos_;
+            }
+            if (pos_ + 1 < pattern_.size() && peek() == '-' && pattern_[pos_ + 1] != ']') {
+                ++pos_;
+                unsigned char high = peek();
+                ++pos_;
+                if (high == '\\') {
+                    ByteSet escaped;
+                    if (const char* reason = escape(escaped)) {
+                        return reason;
+                    }
+                    if (escaped.count() > 2 || !single(escaped, high)) {
+                        return "invalid range in regex class";
+                    }
+                }
+                if (high < low) {
+                    return "invalid range in regex class";
+                }
+                add_range(set, low, high);
+            } else {
+                add_byte(set, low);
+            }
+        }
+        if (at_end()) {
+            return "missing ']' in regex";
+        }
+        ++pos_;
+        if (negate) {
+            set.flip();
+        }
+        return nullptr;
+    }
+
+    /// @brief The byte a set of one byte (or one letter in both cases) stands for.
+    static bool single(const ByteSet& set, unsigned char& byte) {
+        for (unsigned c = 0; c < 256; ++c) {
+            if (set.test(c)) {
+                byte = static_cast<unsigned char>(c);
+                return set.count() == 1 || (is_letter(byte) && set.test(byte ^ 0x20));
+            }
+        }
+        return false;
+    }
+
+    /// @brief The escape after a backslash.
+    const char* escape(ByteSet& set) {
+        if (at_end()) {
+            return "trailing backslash in regex";
+        }
+        const unsigned char c = peek();
+        ++pos_;
+        switch (c) {
+        case 'd':
+        case 'D':
+            add_range(set, '0', '9');
+            break;
+        case 'w':
+        case 'W':
+            add_range(set, 'a', 'z');
+            add_range(set, '0', '9');
+            set.set('_');
+            break;
+        case 's':
+        case 'S':
+            for (const char space : {' ', '\t', '\r', '\n', '\f', '\v'}) {
+                set.set(static_cast<unsigned char>(space));
+            }
+            break;
+        case 't':
+            set.set('\t');
+            return nullptr;
+        case 'n':
+            set.set('\n');
+            return nullptr;
+        case 'r':
+            set.set('\r');
+            return nullptr;
+        case 'x': {
+            unsigned value = 0;
+            for (int i = 0; i < 2; ++i, ++pos_) {
+                const unsigned char h = at_end() ? 0 : fold(peek());
+                if (h >= '0' && h <= '9') {
+                    value = value * 16 + (h - '0');
+                } else if (h >= 'a' && h <= 'f') {
+                    value = value * 16 + (h - 'a' + 10);
+                } else {
+                    return "expected two hex digits after \\x in regex";
+                }
+            }
+            add_byte(set, static_cast<unsigned char>(value));
+            return nullptr;
+        }
+        default:
+            if (is_letter(c) || (c >= '0' && c <= '9')) {
+                return "unknown escape in regex";
+            }
+            set.set(c);
+            return nullptr;
+        }
+        if (c == 'D' || c == 'W' || c == 'S') {
+            set.flip();
+        }
+        return nullptr;
+    }
+
+    std::string_view pattern_;
+    std::size_t pos_ = 0;
+    std::size_t depth_ = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Prefilter literals
+// ---------------------------------------------------------------------------
+
+using Strings = std::vector<std::string>;
+
+/// @brief What a node tells about the text of its matches.
+struct Literals {
+    std::optional<Strings> exact;  ///< Every match is one of these
+    Strings required;              ///< Every match contains one of these (empty: unknown)
+
+    /// @brief The strings one of which every match contains.
+    [[nodiscard]] const Strings& any() const noexcept {
+        return exact && exact->size() <= kMaxLiterals ? *exact : required;
+    }
+};
+
+/// @brief Worth of a prefilter set: its shortest literal (0 = none).
+std::size_t worth(const Strings& strings) noexcept {
+    if (strings.empty()) {
+        return 0;
+    }
+    std::size_t shortest = SIZE_MAX;
+    for (const std::string& s : strings) {
+        shortest = std::min(shortest, s.size());
+    }
+    return shortest;
+}
+
+void keep_better(Strings& best, const Strings& candidate) {
+    const std::size_t a = worth(candidate);
+    const std::size_t b = worth(best);
+    if (a > b || (a == b && a != 0 && candidate.size() < best.size())) {
+        best = candidate;
+    }
+}
+
+/// @brief Every concatenation of a string of a with one of b, if few and short enough.
+std::optional<Strings> cross(const Strings& a, const Strings& b) {
+    if (a.size() * b.size() > kMaxLiterals) {
+        return std::nullopt;
+    }
+    Strings out;
+    for (const std::string& x : a) {
+        for (const std::string& y : b) {
+            if (x.size() + y.size() > kMaxLiteralLength) {
+                return std::nullopt;
+            }
+            out.push_back(x + y);
+        }
+    }
+    return out;
+}
+
+Literals literals_of(const Node& node) {
+    Literals out;
+    switch (node.kind) {
+    case Node::Kind::Empty:
+        out.exact = Strings{""};
+        break;
+    case Node::Kind::Set: {
+        // One byte, or one letter in both cases
+        const std::size_t count = node.set.count();
+        for (unsigned c = 0; c < 256 && count <= 2; ++c) {
+            if (node.set.test(c)) {
+                const auto byte = static_cast<unsigned char>(c);
+                if (count == 1 || (is_letter(byte) && node.set.test(byte ^ 0x20))) {
+                    out.exact = Strings{std::string(1, static_cast<char>(fold(byte)))};
+                }
+                break;
+            }
+        }
+        break;
+    }
+    case Node::Kind::Concat: {
+        Strings run{""};  // Exact strings of the children since the last break
+        bool exact = true;
+        for (const Node& child : node.children) {
+            const Literals inner = literals_of(child);
+            if (inner.exact) {
+                if (auto joined = cross(run, *inner.exact)) {
+                    run = std::move(*joined);
+                    continue;
+                }
+            }
+            exact = false;
+            keep_better(out.required, run);
+            if (inner.exact && inner.exact->size() <= kMaxLiterals) {
+                run = *inner.exact;
+            } else {
+                keep_better(out.required, inner.required);
+                run = Strings{""};
+            }
+        }
+        keep_better(out.required, run);
+        if (exact) {
+            out.exact = std::move(run);
+        }
+        break;
+    }
+    case Node::Kind::Alternate: {
+        Strings exact;
+        Strings any;
+        bool all_exact = true;
+        bool all_known = true;
+        for (const Node& child : node.children) {
+            const Literals inner = literals_of(child);
+            if (inner.exact) {
+                exact.insert(exact.end(), inner.exact->begin(), inner.exact->end());
+            } else {
+                all_exact = false;
+            }
+            const Strings& strings = inner.any();
+            if (worth(strings) == 0) {
+                all_known = false;
+            }
+            any.insert(any.end(), strings.begin(), strings.end());
+        }
+        const auto dedupe = [](Strings& strings) {
+            std::sort(strings.begin(), strings.end());
+            strings.erase(std::unique(strings.begin(), strings.end()), strings.end());
+        };
+        if (all_exact) {
+            dedupe(exact);
+            if (exact.size() <= kMaxLiterals) {
+                out.exact = std::move(exact);
+            }
+        }
+        if (all_known) {
+            dedupe(any);
+            if (any.size() <= kMaxLiterals) {
+                out.required = std::move(any);
+            }
+        }
+        break;
+    }
+    case Node::Kind::Repeat:
+        if (node.min > 0) {
+            const Literals inner = literals_of(node.children.front());
+            out.required = inner.any();
+        }
+        break;
+    }
+    return out;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Compilation
+// ---------------------------------------------------------------------------
+
+namespace {
+
+/// @brief Emits the NFA of a syntax tree.
+class Emitter {
+public:
+    Emitter(std::vector<regex_detail::Inst>& program, std::vector<ByteSet>& sets)
+        : program_(program), sets_(sets) {}
+
+    /// @return false if the program grew too large.
+    bool emit(const Node& node) {
+        using Op = regex_detail::Inst::Op;
+        switch (node.kind) {
+        case Node::Kind::Empty:
+            return true;
+        case Node::Kind::Set: {
+            auto [it, added] = set_index_.try_emplace(node.set,
+                                                      static_cast<std::uint32_t>(sets_.size()));
+            if (added) {
+                sets_.push_back(node.set);
+            }
+            return push({Op::Byte, it->second, pc() + 1, 0});
+        }
+        case Node::Kind::Concat:
+            for (const Node& child : node.children) {
+                if (!emit(child)) {
+                    return false;
+                }
+            }
+            return true;
+        case Node::Kind::Alternate: {
+            std::vector<std::uint32_t> jumps;
+            for (std::size_t i = 0; i + 1 < node.children.size(); ++i) {
+                const std::uint32_t split = pc();
+                if (!push({Op::Split, 0, split + 1, 0}) || !emit(node.children[i])) {
+                    return false;
+                }
+                jumps.push_back(pc());
+                if (!push({Op::Jump, 0, 0, 0})) {
+                    return false;
+                }
+                program_[split].y = pc();
+            }
+            if (!emit(node.children.back())) {
+                return false;
+            }
+            for (const std::uint32_t jump : jumps) {
+                program_[jump].x = pc();
+            }
+            return true;
+        }
+        case Node::Kind::Repeat: {
+            const Node& child = node.children.front();
+            for (std::uint32_t i = 0; i < node.min; ++i) {
+                if (!emit(child)) {
+                    return false;
+                }
+            }
+            if (node.max == kInfinite) {
+                const std::uint32_t loop = pc();
+                if (!push({Op::Split, 0, loop + 1, 0}) || !emit(child) ||
+                    !push({Op::Jump, 0, loop, 0})) {
+                    return false;
+                }
+                program_[loop].y = pc();
+                return true;
+            }
+            std::vector<std::uint32_t> splits;
+            for (std::uint32_t i = node.min; i < node.max; ++i) {
+                splits.push_back(pc());
+                if (!push({Op::Split, 0, pc() + 1, 0}) || !emit(child)) {
+                    return false;
+                }
+            }
+            for (const std::uint32_t split : splits) {
+                program_[split].y = pc();
+            }
+            return true;
+        }
+        }
+        return false;
+    }
+
+    [[nodiscard]] std::uint32_t pc() const noexcept {
+        return static_cast<std::uint32_t>(program_.size());
+    }
+
+    bool push(const regex_detail::Inst& inst) {
+        if (program_.size() >= kMaxProgram) {
+            return false;
+        }
+        program_.push_back(inst);
+        return true;
+    }
+
+private:
+    std::vector<regex_detail::Inst>& program_;
+    std::vector<ByteSet>& sets_;
+    std::unordered_map<ByteSet, std::uint32_t> set_index_;
+};
+
+}  // namespace
+
+std::unique_ptr<RegexDfa> RegexDfa::compile(std::string_view pattern, const char** reason,
+                                            std::size_t max_states) {
+    const auto fail = [reason](const char* why) {
+        if (reason != nullptr) {
+            *reason = why;
+        }
+        return nullptr;
+    };
+    if (pattern.size() > kMaxProgram) {
+        return fail("regex too long");
+    }
+    std::unique_ptr<RegexDfa> regex(new RegexDfa());
+    Node root;
+    if (const char* why = Parser(pattern).parse(root, regex->anchored_start_,
+                                               regex->anchored_end_)) {
+        return fail(why);
+    }
+    Emitter emitter(regex->program_, regex->sets_);
+    if (!emitter.emit(root) || !emitter.push({Inst::Op::Match, 0, 0, 0})) {
+        return fail("regex too large");
+    }
+
+    // Bytes no instruction tells apart share a class, and a DFA row
+    std::array<std::uint16_t, 256> classes{};
+    std::size_t count = 1;
+    for (const ByteSet& set : regex->sets_) {
+        std::array<std::int16_t, 512> renumber;
+        renumber.fill(-1);
+        std::size_t next = 0;
+        for (std::size_t b = 0; b < 256; ++b) {
+            std::int16_t& id = renumber[classes[b] * 2 + set.test(b)];
+            if (id < 0) {
+                id = static_cast<std::int16_t>(next++);
+            }
+            classes[b] = static_cast<std::uint16_t>(id);
+        }
+        count = next;
+    }
+    regex->class_byte_.assign(count, 0);
+    for (std::size_t b = 256; b-- > 0;) {
+        regex->classes_[b] = static_cast<std::uint8_t>(classes[b]);
+        regex->class_byte_[classes[b]] = static_cast<std::uint8_t>(b);
+    }
+
+    Strings literals = literals_of(root).any();
+    if (worth(literals) > 0) {
+        std::sort(literals.begin(), literals.end());
+        regex->literals_ = std::move(literals);
+    }
+    regex->max_states_ = std::max<std::size_t>(max_states, 4);
+    return regex;
+}
+
+// ---------------------------------------------------------------------------
+// Search
+// ---------------------------------------------------------------------------
+
+std::size_t RegexDfa::StateHash::operator()(
+    const std::vector<std::uint32_t>& insts) const noexcept {
+    std::uint64_t hash = 14695981039346656037ULL;  // FNV-1a over the words
+    for (const std::uint32_t pc : insts) {
+        hash = (hash ^ pc) * 1099511628211ULL;
+    }
+    return static_cast<std::size_t>(hash);
+}
+
+bool RegexDfa::search(std::string_view text) {
+    if (!literals_.empty() &&
+        std::none_of(literals_.begin(), literals_.end(),
+                     [text](const std::string& literal) { return contains_icase(text, literal); })) {
+        return false;
+    }
+    const std::lock_guard lock(mutex_);
+    try {
+        if (start_state_ == kUnknown) {
+            begin_closure();
+            close(start_);
+            std::sort(work_.begin(), work_.end());
+            start_state_ = state_for(work_);
+        }
+        std::int32_t s = start_state_;
+        if (states_[s].match && !anchored_end_) {
+            return true;
+        }
+        const std::size_t classes = class_byte_.size();
+        for (const char c : text) {
+            const std::uint8_t cls = classes_[static_cast<unsigned char>(c)];
+            const std::int32_t cached = next_[static_cast<std::size_t>(s) * classes + cls];
+            s = cached != kUnknown ? cached : step(s, cls);
+            const State& state = states_[s];
+            if (state.match && !anchored_end_) {
+                return true;
+            }
+            if (state.insts.empty()) {
+                return false;  // Dead: anchored and nothing left to match
+            }
+        }
+        return states_[s].match;
+    } catch (...) {
+        flush();  // A state added halfway would leave the index and rows out of step
+        throw;
+    }
+}
+
+std::int32_t RegexDfa::step(std::int32_t s, std::uint8_t c) {
+    const std::uint8_t byte = class_byte_[c];
+    begin_closure();
+    for (const std::uint32_t pc : states_[s].insts) {
+        const Inst& inst = program_[pc];
+        if (inst.op == Inst::Op::Byte && sets_[inst.set].test(byte)) {
+            close(inst.x);
+        }
+    }
+    if (!anchored_start_) {
+        close(start_);  // A match may start at every byte
+    }
+    std::sort(work_.begin(), work_.end());
+    const std::uint64_t flushes = flushes_;
+    const std::int32_t next = state_for(work_);
+    if (flushes == flushes_) {
+        next_[static_cast<std::size_t>(s) * class_byte_.size() + c] = next;
+    }
+    return next;
+}
+
+std::int32_t RegexDfa::state_for(std::vector<std::uint32_t>& insts) {
+    if (const auto it = index_.find(insts); it != index_.end()) {
+        return it->second;
+    }
+    if (states_.size() >= max_states_) {
+        flush();
+    }
+    const auto id = static_cast<std::int32_t>(states_.size());
+    State& state = states_.emplace_back();
+    state.insts = insts;
+    state.match = std::any_of(insts.begin(), insts.end(), [this](std::uint32_t pc) {
+        return program_[pc].op == Inst::Op::Match;
+    });
+    index_.emplace(insts, id);
+    next_.resize(states_.size() * class_byte_.size(), kUnknown);
+    return id;
+}
+
+void RegexDfa::begin_closure() {
+    work_.clear();
+    seen_.assign(program_.size(), 0);
+}
+
+void RegexDfa::close(std::uint32_t pc) {
+    stack_.push_back(pc);
+    while (!stack_.empty()) {
+        const std::uint32_t current = stack_.back();
+        stack_.pop_back();
+        if (seen_[current] != 0) {
+            continue;
+        }
+        seen_[current] = 1;
+        const Inst& inst = program_[current];
+        switch (inst.op) {
+        case Inst::Op::Byte:
+        case Inst::Op::Match:
+            work_.push_back(current);
+            break;
+        case Inst::Op::Jump:
+            stack_.push_back(inst.x);
+            break;
+        case Inst::Op::Split:
+            stack_.push_back(inst.y);
+            stack_.push_back(inst.x);
+            break;
+        }
+    }
+}
+
+void RegexDfa::flush() {
+    states_.clear();
+    index_.clear();
+    next_.clear();
+    start_state_ = kUnknown;
+    ++flushes_;
+}
+
+std::size_t RegexDfa::cached_states() const {
+    const std::lock_guard lock(mutex_);
+    return states_.size();
+}
+
+std::uint64_t RegexDfa::flushes() const {
+    const std::lock_guard lock(mutex_);
+    return flushes_;
+}
+
+}  // namespace exeray::etw
@@ -0,0 +1,173 @@
+/// @file sampler.cpp
+/// @brief Sampler implementation (platform independent).
+
+#include "exeray/etw/sampler.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace exeray::etw {
+
+namespace {
+
+using event::Category;
+using event::EventPayload;
+
+constexpr std::size_t index(Category category) noexcept {
+    return static_cast<std::size_t>(category);
+}
+
+constexpr std::uint16_t kNoSubject = 0xFFFF;
+
+/// @brief Offset in EventPayload of the 32-bit field a category is
+/// sampled by: its main string, or the remote address of network events.
+constexpr std::array<std::uint16_t, index(Category::Count)> kSubject = [] {
+    std::array<std::uint16_t, index(Category::Count)> subject{};
+    subject.fill(kNoSubject);
+    subject[index(Category::FileSystem)] = offsetof(EventPayload, file.path);
+    subject[index(Category::Registry)] = offsetof(EventPayload, registry.key_path);
+    subject[index(Category::Network)] = offsetof(EventPayload, network.remote_addr);
+    subject[index(Category::Process)] = offsetof(EventPayload, process.image_path);
+    subject[index(Category::Scheduler)] = offsetof(EventPayload, scheduler.task_name);
+    subject[index(Category::Image)] = offsetof(EventPayload, image.image_path);
+    subject[index(Category::Script)] = offsetof(EventPayload, script.script_block);
+    subject[index(Category::Amsi)] = offsetof(EventPayload, amsi.content);
+    subject[index(Category::Dns)] = offsetof(EventPayload, dns.domain);
+    subject[index(Category::Security)] = offsetof(EventPayload, security.target_user);
+    subject[index(Category::Service)] = offsetof(EventPayload, service.service_name);
+    subject[index(Category::Wmi)] = offsetof(EventPayload, wmi.query);
+    subject[index(Category::Clr)] = offsetof(EventPayload, clr.assembly_name);
+    subject[index(Category::Manifest)] = offsetof(EventPayload, manifest.text);
+    return subject;
+}();
+
+/// @brief splitmix64 finalizer.
+constexpr std::uint64_t mix(std::uint64_t x) noexcept {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+constexpr std::uint64_t kIncarnationMask = 0x7FFFFFFFULL;
+
+std::uint64_t threshold(double rate) noexcept {
+    if (!(rate < 1.0)) {
+        return Sampler::kKeepAll;
+    }
+    if (!(rate > 0.0)) {
+        return 0;
+    }
+    return static_cast<std::uint64_t>(std::ldexp(rate, 32));
+}
+
+}  // namespace
+
+Sampler::Sampler(const SamplingConfig& config) {
+    for (auto& ops : threshold_) {
+        ops.fill(kKeepAll);
+    }
+    for (const SampleRule& rule : config.rules) {
+        if (index(rule.category) >= kCategories) {
+            continue;
+        }
+        auto& ops = threshold_[index(rule.category)];
+        if (rule.operation >= SampleRule::kAnyOperation) {
+            ops.fill(threshold(rule.rate));
+        } else {
+            ops[rule.operation] = threshold(rule.rate);
+        }
+    }
+}
+
+std::uint32_t Sampler::key(std::uint32_t pid, std::uint32_t incarnation,
+                           const EventPayload& payload) noexcept {
+    const std::size_t category = index(payload.category);
+    std::uint32_t subject = 0;
+    if (category < kCategories && kSubject[category] != kNoSubject) {
+        std::memcpy(&subject, reinterpret_cast<const std::byte*>(&payload) + kSubject[category],
+                    sizeof(subject));
+    }
+    const std::uint64_t h = mix((std::uint64_t{pid} << 32 | subject) ^
+                                std::uint64_t{incarnation} * 0x9E3779B97F4A7C15ULL);
+    return static_cast<std::uint32_t>(h >> 32);
+}
+
+bool Sampler::sample(std::uint32_t pid, const EventPayload& payload, std::size_t category,
+                     std::uint64_t threshold) noexcept {
+    const std::uint64_t entry = processes_[slot(pid)].load(std::memory_order_relaxed);
+    const bool same = static_cast<std::uint32_t>(entry) == pid;
+    const auto incarnation = static_cast<std::uint32_t>(same ? (entry >> 32) & kIncarnationMask : 0);
+    const bool promoted = same && (entry & kPromoted) != 0;
+
+    const bool hashed = key(pid, incarnation, payload) < threshold;
+    if (hashed) {
+        kept_[category].fetch_add(1, std::memory_order_relaxed);
+    } else if (promoted) {
+        promoted_kept_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        dropped_[category].fetch_add(1, std::memory_order_relaxed);
+    }
+    return hashed || promoted;
+}
+
+void Sampler::process_started(std::uint32_t pid) noexcept {
+    std::atomic<std::uint64_t>& cell = processes_[slot(pid)];
+    std::uint64_t entry = cell.load(std::memory_order_relaxed);
+    std::uint64_t next = 0;
+    do {
+        const std::uint64_t incarnation =
+            static_cast<std::uint32_t>(entry) == pid ? ((entry >> 32) + 1) & kIncarnationMask : 0;
+        next = incarnation << 32 | pid;
+    } while (!cell.compare_exchange_weak(entry, next, std::memory_order_relaxed));
+}
+
+void Sampler::promote(std::uint32_t pid) noexcept {
+    std::atomic<std::uint64_t>& cell = processes_[slot(pid)];
+    std::uint64_t entry = cell.load(std::memory_order_relaxed);
+    std::uint64_t next = 0;
+    do {
+        if (static_cast<std::uint32_t>(entry) == pid && (entry & kPromoted) != 0) {
+            return;
+        }
+        next = (static_cast<std::uint32_t>(entry) == pid ? entry : pid) | kPromoted;
+    } while (!cell.compare_exchange_weak(entry, next, std::memory_order_relaxed));
+    promotions_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool Sampler::promoted(std::uint32_t pid) const noexcept {
+    const std::uint64_t entry = processes_[slot(pid)].load(std::memory_order_relaxed);
+    return static_cast<std::uint32_t>(entry) == pid && (entry & kPromoted) != 0;
+}
+
+double Sampler::rate(Category category, std::uint8_t operation) const noexcept {
+    if (index(category) >= kCategories) {
+        return 1.0;
+    }
+    const std::uint64_t value = threshold_[index(category)][operation];
+    return value == kKeepAll ? 1.0 : std::ldexp(static_cast<double>(value), -32);
+}
+
+SamplingStats Sampler::stats() const noexcept {
+    SamplingStats stats;
+    for (std::size_t i = 0; i < kCategories; ++i) {
+        stats.kept[i] = kept_[i].load(std::memory_order_relaxed);
+        stats.dropped[i] = dropped_[i].load(std::memory_order_relaxed);
+    }
+    stats.promoted_kept = promoted_kept_.load(std::memory_order_relaxed);
+    stats.promotions = promotions_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void Sampler::reset() noexcept {
+    for (auto& cell : processes_) {
+        cell.store(0, std::memory_order_relaxed);
+    }
+    for (std::size_t i = 0; i < kCategories; ++i) {
+        kept_[i].store(0, std::memory_order_relaxed);
+        dropped_[i].store(0, std::memory_order_relaxed);
+    }
+    promoted_kept_.store(0, std::memory_order_relaxed);
+    promotions_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace exeray::etw
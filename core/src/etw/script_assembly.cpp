@@ -0,0 +1,76 @@
+/// @file script_assembly.cpp
+/// @brief Script block reassembly buffers (platform independent).
+
+#include "exeray/etw/script_assembly.hpp"
+
+#include <algorithm>
+
+namespace exeray::etw {
+
+namespace {
+
+thread_local ScriptAssembler* active = nullptr;
+
+}  // namespace
+
+ScriptAssembler::Scope::Scope(ScriptAssembler* assembler) noexcept : previous_(active) {
+    active = assembler;
+}
+
+ScriptAssembler::Scope::~Scope() {
+    active = previous_;
+}
+
+ScriptAssembler::ScriptAssembler(std::uint64_t timeout)
+    : arena_(kArenaBytes, ArenaOptions{.lazy_commit = true}), timeout_(timeout) {}
+
+ScriptAssembler* ScriptAssembler::current() noexcept {
+    return active;
+}
+
+ScriptAssembler::Block* ScriptAssembler::find(const BlockId& id) noexcept {
+    for (Block& block : blocks_) {
+        if (block.next != 0 && block.id == id) {
+            return &block;
+        }
+    }
+    return nullptr;
+}
+
+ScriptAssembler::Block& ScriptAssembler::victim() noexcept {
+    return *std::min_element(blocks_.begin(), blocks_.end(), [](const Block& a, const Block& b) {
+        // Free slots first, then the stalest block
+        return (a.next == 0 ? 0 : a.last + 1) < (b.next == 0 ? 0 : b.last + 1);
+    });
+}
+
+bool ScriptAssembler::open(Block& slot, const BlockId& id, std::uint32_t total,
+                           std::size_t part_chars, std::uint64_t now, std::uint32_t pid) {
+    const std::size_t capacity =
+        std::min(kMaxScriptChars, part_chars > kMaxScriptChars / total ? kMaxScriptChars
+                                                                       : part_chars * total);
+    wchar_t* text = capacity >= part_chars ? arena_.allocate<wchar_t>(capacity) : nullptr;
+    if (text == nullptr) {
+        return false;
+    }
+    slot = Block{id, text, 0, capacity, 1, total, pid, now};
+    ++open_;
+    return true;
+}
+
+void ScriptAssembler::release(Block& block) noexcept {
+    block.next = 0;
+    if (--open_ == 0) {
+        arena_.reset();
+    }
+}
+
+void ScriptAssembler::clear() noexcept {
+    for (Block& block : blocks_) {
+        block.next = 0;
+    }
+    open_ = 0;
+    arena_.reset();
+}
+
+}  // namespace exeray::etw
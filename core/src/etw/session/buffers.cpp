@@ -0,0 +1,54 @@
+/// @file buffers.cpp
+/// @brief resolve_buffers() implementation (platform independent).
+
+#include "exeray/etw/session_buffers.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace exeray::etw {
+
+namespace {
+
+constexpr std::uint32_t kMinBufferKb = 4;
+constexpr std::uint32_t kHighRateBufferKb = 256;
+constexpr std::uint32_t kDefaultBufferKb = 64;
+constexpr std::uint32_t kBuffersPerProvider = 8;
+constexpr std::uint32_t kDefaultFlushMs = 1000;
+
+}  // namespace
+
+SessionBuffers resolve_buffers(SessionBuffers requested, std::size_t providers,
+                               std::size_t high_rate, unsigned cores) {
+    if (cores == 0) {
+        cores = std::max(1U, std::thread::hardware_concurrency());
+    }
+    SessionBuffers out = requested;
+
+    if (out.buffer_kb == 0) {
+        out.buffer_kb = high_rate > 0 ? kHighRateBufferKb : kDefaultBufferKb;
+    }
+    out.buffer_kb = std::clamp(out.buffer_kb, kMinBufferKb, SessionBuffers::kMaxBufferKb);
+
+    // ETW needs at least two buffers per processor
+    if (out.min_buffers == 0) {
+        out.min_buffers = cores * 2;
+    }
+
+    if (out.max_buffers == 0) {
+        // High-rate providers count four times
+        const auto weight = providers + 3 * std::min(high_rate, providers);
+        const auto wanted = out.min_buffers + kBuffersPerProvider * weight;
+        const auto budget = std::max<std::size_t>(SessionBuffers::kAutoBudgetKb / out.buffer_kb,
+                                                  out.min_buffers);
+        out.max_buffers = static_cast<std::uint32_t>(std::min(wanted, budget));
+    }
+    out.max_buffers = std::max(out.max_buffers, out.min_buffers);
+
+    if (out.flush_timer_ms == 0) {
+        out.flush_timer_ms = kDefaultFlushMs;
+    }
+    return out;
+}
+
+}  // namespace exeray::etw
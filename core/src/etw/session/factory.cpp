@@ -10,40 +10,82 @@
 #include <cstring>
 #include <vector>
 
+#ifndef EVENT_TRACE_USE_MS_FLUSH_TIMER
+#define EVENT_TRACE_USE_MS_FLUSH_TIMER 0x00000010  // Windows 8+
+#endif
+
 namespace exeray::etw {
 
+namespace {
+
+/// @brief Reset a properties buffer for a real-time session.
+void fill_properties(std::vector<uint8_t>& buffer, const std::wstring& name,
+                     const SessionBuffers& buffers, const SessionLog& log) {
+    std::memset(buffer.data(), 0, buffer.size());
+    auto* props = reinterpret_cast<EVENT_TRACE_PROPERTIES*>(buffer.data());
+    props->Wnode.BufferSize = static_cast<ULONG>(buffer.size());
+    props->Wnode.Flags = WNODE_FLAG_TRACED_GUID;
+    props->Wnode.ClientContext = 1;  // QPC timestamps
+    props->LogFileMode = EVENT_TRACE_REAL_TIME_MODE;
+    props->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+
+    // Zero fields keep the ETW defaults
+    props->BufferSize = buffers.buffer_kb;
+    props->MinimumBuffers = buffers.min_buffers;
+    props->MaximumBuffers = buffers.max_buffers;
+    if (buffers.flush_timer_ms != 0) {
+        props->LogFileMode |= EVENT_TRACE_USE_MS_FLUSH_TIMER;
+        props->FlushTimer = buffers.flush_timer_ms;
+    }
+
+    auto* name_dest = reinterpret_cast<wchar_t*>(buffer.data() + props->LoggerNameOffset);
+    std::wcsncpy(name_dest, name.c_str(), 1023);
+    name_dest[1023] = L'\0';
+
+    // The same buffers also go to the file; real-time delivery is unchanged
+    if (log.enabled()) {
+        props->LogFileMode |= log.mode == LogFileMode::Circular
+                                  ? EVENT_TRACE_FILE_MODE_CIRCULAR
+                                  : EVENT_TRACE_FILE_MODE_SEQUENTIAL;
+        props->MaximumFileSize = log.max_mb;
+        props->LogFileNameOffset =
+            static_cast<ULONG>(sizeof(EVENT_TRACE_PROPERTIES) + 1024 * sizeof(wchar_t));
+        auto* file_dest = reinterpret_cast<wchar_t*>(buffer.data() + props->LogFileNameOffset);
+        std::wcsncpy(file_dest, log.path.c_str(), SessionLog::kMaxPath);
+        file_dest[SessionLog::kMaxPath] = L'\0';
+    }
+}
+
+}  // namespace
+
 std::unique_ptr<Session> Session::create(
     std::wstring_view session_name,
     EventCallback callback,
-    void* context
+    void* context,
+    BufferCallback buffer_callback,
+    const SessionBuffers& buffers,
+    const SessionLog& log
 ) {
     if (session_name.empty() || session_name.size() >= 1024) {
         std::fwprintf(stderr, L"[ETW] Invalid session name length\n");
         return nullptr;
     }
 
+    if (log.path.size() > SessionLog::kMaxPath) {
+        std::fwprintf(stderr, L"[ETW] Log file path too long\n");
+        return nullptr;
+    }
+
     if (callback == nullptr) {
         std::fwprintf(stderr, L"[ETW] Event callback is required\n");
         return nullptr;
     }
 
-    // Allocate properties buffer
+    // Allocate and configure the properties buffer
     std::vector<uint8_t> props_buffer(session::properties_buffer_size(), 0);
     auto* props = reinterpret_cast<EVENT_TRACE_PROPERTIES*>(props_buffer.data());
-
-    // Configure session properties
-    props->Wnode.BufferSize = static_cast<ULONG>(props_buffer.size());
-    props->Wnode.Flags = WNODE_FLAG_TRACED_GUID;
-    props->Wnode.ClientContext = 1;  // QPC timestamps
-    props->LogFileMode = EVENT_TRACE_REAL_TIME_MODE;
-    props->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
-
-    // Copy session name
     std::wstring name_str(session_name);
-    auto* name_dest = reinterpret_cast<wchar_t*>(
-        props_buffer.data() + props->LoggerNameOffset);
-    std::wcsncpy(name_dest, name_str.c_str(), 1023);
-    name_dest[1023] = L'\0';
+    fill_properties(props_buffer, name_str, buffers, log);
 
     // Start the trace session
     TRACEHANDLE session_handle = 0;
@@ -64,13 +106,7 @@ std::unique_ptr<Session> Session::create(
             ControlTraceW(0, name_str.c_str(), stop_props, EVENT_TRACE_CONTROL_STOP);
 
             // Retry start
-            std::memset(props_buffer.data(), 0, props_buffer.size());
-            props->Wnode.BufferSize = static_cast<ULONG>(props_buffer.size());
-            props->Wnode.Flags = WNODE_FLAG_TRACED_GUID;
-            props->Wnode.ClientContext = 1;
-            props->LogFileMode = EVENT_TRACE_REAL_TIME_MODE;
-            props->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
-            std::wcsncpy(name_dest, name_str.c_str(), 1023);
+            fill_properties(props_buffer, name_str, buffers, log);
 
             status = StartTraceW(&session_handle, name_str.c_str(), props);
         }
@@ -84,8 +120,11 @@ std::unique_ptr<Session> Session::create(
     // Open the trace for consumption with callback and context
     EVENT_TRACE_LOGFILEW logfile{};
     logfile.LoggerName = const_cast<LPWSTR>(name_str.c_str());
-    logfile.ProcessTraceMode = PROCESS_TRACE_MODE_REAL_TIME | PROCESS_TRACE_MODE_EVENT_RECORD;
+    // Keep the QPC ticks the session logs; ClockDomain converts them
+    logfile.ProcessTraceMode = PROCESS_TRACE_MODE_REAL_TIME | PROCESS_TRACE_MODE_EVENT_RECORD |
+                               PROCESS_TRACE_MODE_RAW_TIMESTAMP;
     logfile.EventRecordCallback = callback;
+    logfile.BufferCallback = buffer_callback;
     logfile.Context = context;
 
     TRACEHANDLE trace_handle = OpenTraceW(&logfile);
@@ -103,8 +142,55 @@ std::unique_ptr<Session> Session::create(
         return nullptr;
     }
 
+    // StartTraceW writes back the values ETW actually applied
+    const SessionBuffers effective{
+        props->BufferSize,
+        props->MinimumBuffers,
+        props->MaximumBuffers,
+        buffers.flush_timer_ms
+    };
+    // OpenTraceW fills the header; PerfFreq is the QPC rate of the raw timestamps
+    return std::unique_ptr<Session>(
+        new Session(session_handle, trace_handle, std::move(name_str), effective, 0,
+                    static_cast<std::uint64_t>(logfile.LogfileHeader.PerfFreq.QuadPart)));
+}
+
+std::unique_ptr<Session> Session::open_file(
+    std::wstring_view path,
+    EventCallback callback,
+    void* context,
+    BufferCallback buffer_callback
+) {
+    if (path.empty()) {
+        std::fwprintf(stderr, L"[ETW] Trace file path is required\n");
+        return nullptr;
+    }
+
+    if (callback == nullptr) {
+        std::fwprintf(stderr, L"[ETW] Event callback is required\n");
+        return nullptr;
+    }
+
+    // Without PROCESS_TRACE_MODE_REAL_TIME, OpenTraceW reads LogFileName
+    std::wstring path_str(path);
+    EVENT_TRACE_LOGFILEW logfile{};
+    logfile.LogFileName = const_cast<LPWSTR>(path_str.c_str());
+    logfile.ProcessTraceMode = PROCESS_TRACE_MODE_EVENT_RECORD;
+    logfile.EventRecordCallback = callback;
+    logfile.BufferCallback = buffer_callback;
+    logfile.Context = context;
+
+    TRACEHANDLE trace_handle = OpenTraceW(&logfile);
+    if (trace_handle == INVALID_PROCESSTRACE_HANDLE) {
+        session::log_error(L"OpenTraceW", GetLastError());
+        return nullptr;
+    }
+
+    // OpenTraceW fills the header from the file
+    const SessionBuffers buffers{logfile.LogfileHeader.BufferSize / 1024, 0, 0, 0};
+    const auto start_time = static_cast<std::uint64_t>(logfile.LogfileHeader.StartTime.QuadPart);
     return std::unique_ptr<Session>(
-        new Session(session_handle, trace_handle, std::move(name_str)));
+        new Session(0, trace_handle, std::move(path_str), buffers, start_time));
 }
 
 }  // namespace exeray::etw
@@ -16,10 +16,10 @@ namespace exeray::etw::session {
 /// @param error_code Windows error code.
 void log_error(const wchar_t* context, ULONG error_code);
 
-/// @brief Size of the properties buffer including session name.
+/// @brief Size of the properties buffer including session name and log file.
 /// @return Buffer size in bytes.
 constexpr size_t properties_buffer_size() {
-    return sizeof(EVENT_TRACE_PROPERTIES) + (1024 * sizeof(wchar_t));
+    return sizeof(EVENT_TRACE_PROPERTIES) + (2 * 1024 * sizeof(wchar_t));
 }
 
 }  // namespace exeray::etw::session
@@ -0,0 +1,24 @@
+/// @file log.cpp
+/// @brief Session log file naming (platform independent).
+
+#include "exeray/etw/session_log.hpp"
+
+namespace exeray::etw {
+
+std::wstring log_path_for(const std::wstring& path, std::size_t index) {
+    if (index == 0 || path.empty()) {
+        return path;
+    }
+    const std::wstring suffix = L"." + std::to_wstring(index);
+
+    // Only a dot after the last separator starts an extension
+    const auto dot = path.find_last_of(L'.');
+    const auto separator = path.find_last_of(L"\\/");
+    if (dot == std::wstring::npos || dot == 0 ||
+        (separator != std::wstring::npos && dot < separator + 2)) {
+        return path + suffix;
+    }
+    return path.substr(0, dot) + suffix + path.substr(dot);
+}
+
+}  // namespace exeray::etw
@@ -6,10 +6,68 @@
 #include "exeray/etw/session.hpp"
 #include "helpers.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
 namespace exeray::etw {
 
+namespace {
+
+/// @brief EVENT_FILTER_EVENT_ID blob that lets only the given IDs through.
+std::vector<uint8_t> event_id_filter(std::span<const uint16_t> ids) {
+    const auto count = std::min<std::size_t>(ids.size(), MAX_EVENT_FILTER_EVENT_ID_COUNT);
+    std::vector<uint8_t> blob(
+        offsetof(EVENT_FILTER_EVENT_ID, Events) + count * sizeof(USHORT), 0);
+    auto* filter = reinterpret_cast<EVENT_FILTER_EVENT_ID*>(blob.data());
+    filter->FilterIn = TRUE;
+    filter->Count = static_cast<USHORT>(count);
+    std::memcpy(filter->Events, ids.data(), count * sizeof(USHORT));
+    return blob;
+}
+
+}  // namespace
+
 bool Session::enable_provider(const GUID& provider_guid, uint8_t level,
-                               uint64_t keywords) {
+                               uint64_t keywords, const ProviderFilter& filter) {
+    EVENT_FILTER_DESCRIPTOR descriptors[3]{};
+    ULONG descriptor_count = 0;
+
+    const auto pid_count = std::min(filter.pids.size(), ProviderFilter::kMaxPids);
+    if (pid_count > 0) {
+        descriptors[descriptor_count++] = {
+            reinterpret_cast<ULONGLONG>(filter.pids.data()),
+            static_cast<ULONG>(pid_count * sizeof(uint32_t)),
+            EVENT_FILTER_TYPE_PID
+        };
+    }
+    std::vector<uint8_t> id_blob;
+    if (!filter.event_ids.empty()) {
+        id_blob = event_id_filter(filter.event_ids);
+        descriptors[descriptor_count++] = {
+            reinterpret_cast<ULONGLONG>(id_blob.data()),
+            static_cast<ULONG>(id_blob.size()),
+            EVENT_FILTER_TYPE_EVENT_ID
+        };
+    }
+
+    std::vector<uint8_t> stack_blob;
+    if (!filter.stack_event_ids.empty()) {
+        stack_blob = event_id_filter(filter.stack_event_ids);
+        descriptors[descriptor_count++] = {
+            reinterpret_cast<ULONGLONG>(stack_blob.data()),
+            static_cast<ULONG>(stack_blob.size()),
+            EVENT_FILTER_TYPE_STACKWALK
+        };
+    }
+
+    ENABLE_TRACE_PARAMETERS params{};
+    params.Version = ENABLE_TRACE_PARAMETERS_VERSION_2;
+    params.EnableProperty = stack_blob.empty() ? 0 : EVENT_ENABLE_PROPERTY_STACK_TRACE;
+    params.EnableFilterDesc = descriptors;
+    params.FilterDescCount = descriptor_count;
+
     ULONG status = EnableTraceEx2(
         session_handle_,
         &provider_guid,
@@ -18,9 +76,22 @@ bool Session::enable_provider(const GUID& provider_guid, uint8_t level,
         keywords,
         0,  // MatchAllKeyword
         0,  // Timeout (async)
-        nullptr  // EnableParameters
+        descriptor_count > 0 ? &params : nullptr
     );
 
+    // Classic providers reject scope filters: enable them unfiltered and
+    // leave the filtering to the consumer callback; their stacks come as
+    // StackWalk events the session asks for per event type
+    if (status != ERROR_SUCCESS && descriptor_count > 0) {
+        session::log_error(L"EnableTraceEx2 (filtered)", status);
+        status = EnableTraceEx2(session_handle_, &provider_guid,
+                                EVENT_CONTROL_CODE_ENABLE_PROVIDER, level, keywords,
+                                0, 0, nullptr);
+        if (status == ERROR_SUCCESS && !filter.stack_event_ids.empty()) {
+            enable_classic_stacks(provider_guid, filter.stack_event_ids);
+        }
+    }
+
     if (status != ERROR_SUCCESS) {
         session::log_error(L"EnableTraceEx2", status);
         return false;
@@ -28,6 +99,35 @@ bool Session::enable_provider(const GUID& provider_guid, uint8_t level,
     return true;
 }
 
+void Session::enable_classic_stacks(const GUID& provider_guid, std::span<const uint16_t> ids) {
+    for (const uint16_t id : ids) {
+        if (classic_stacks_.size() == MAX_EVENT_FILTER_EVENT_ID_COUNT) {
+            break;
+        }
+        CLASSIC_EVENT_ID event{};
+        event.EventGuid = provider_guid;
+        event.Type = static_cast<UCHAR>(id);
+        classic_stacks_.push_back(event);
+    }
+    const ULONG status = TraceSetInformation(
+        session_handle_, TraceStackTracingInfo, classic_stacks_.data(),
+        static_cast<ULONG>(classic_stacks_.size() * sizeof(CLASSIC_EVENT_ID)));
+    if (status != ERROR_SUCCESS) {
+        session::log_error(L"TraceSetInformation (stack tracing)", status);
+    }
+}
+
+bool Session::capture_state(const GUID& provider_guid, uint64_t keywords) {
+    const ULONG status = EnableTraceEx2(session_handle_, &provider_guid,
+                                        EVENT_CONTROL_CODE_CAPTURE_STATE,
+                                        TRACE_LEVEL_VERBOSE, keywords, 0, 0, nullptr);
+    if (status != ERROR_SUCCESS) {
+        session::log_error(L"EnableTraceEx2 (capture state)", status);
+        return false;
+    }
+    return true;
+}
+
 void Session::disable_provider(const GUID& provider_guid) {
     ULONG status = EnableTraceEx2(
         session_handle_,
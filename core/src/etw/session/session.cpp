@@ -11,15 +11,23 @@
 namespace exeray::etw {
 
 Session::Session(TRACEHANDLE session_handle, TRACEHANDLE trace_handle,
-                 std::wstring session_name)
+                 std::wstring session_name, SessionBuffers buffers,
+                 std::uint64_t start_time, std::uint64_t timer_frequency)
     : session_handle_(session_handle),
       trace_handle_(trace_handle),
-      session_name_(std::move(session_name)) {}
+      session_name_(std::move(session_name)),
+      buffers_(buffers),
+      start_time_(start_time),
+      timer_frequency_(timer_frequency) {}
 
 Session::Session(Session&& other) noexcept
     : session_handle_(other.session_handle_),
       trace_handle_(other.trace_handle_),
-      session_name_(std::move(other.session_name_)) {
+      session_name_(std::move(other.session_name_)),
+      buffers_(other.buffers_),
+      start_time_(other.start_time_),
+      timer_frequency_(other.timer_frequency_),
+      classic_stacks_(std::move(other.classic_stacks_)) {
     other.session_handle_ = 0;
     other.trace_handle_ = INVALID_PROCESSTRACE_HANDLE;
 }
@@ -41,6 +49,10 @@ Session& Session::operator=(Session&& other) noexcept {
         session_handle_ = other.session_handle_;
         trace_handle_ = other.trace_handle_;
         session_name_ = std::move(other.session_name_);
+        buffers_ = other.buffers_;
+        start_time_ = other.start_time_;
+        timer_frequency_ = other.timer_frequency_;
+        classic_stacks_ = std::move(other.classic_stacks_);
 
         other.session_handle_ = 0;
         other.trace_handle_ = INVALID_PROCESSTRACE_HANDLE;
@@ -59,19 +71,63 @@ Session::~Session() {
     }
 
     // Stop the tracing session
-    if (session_handle_ != 0) {
-        std::vector<uint8_t> stop_buffer(session::properties_buffer_size(), 0);
-        auto* stop_props = reinterpret_cast<EVENT_TRACE_PROPERTIES*>(stop_buffer.data());
-        stop_props->Wnode.BufferSize = static_cast<ULONG>(stop_buffer.size());
-        stop_props->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
-
-        ULONG status = ControlTraceW(session_handle_, nullptr, stop_props,
-                                      EVENT_TRACE_CONTROL_STOP);
-        if (status != ERROR_SUCCESS) {
-            session::log_error(L"StopTrace", status);
-        }
-        session_handle_ = 0;
+    stop();
+}
+
+bool Session::flush() {
+    if (session_handle_ == 0) {
+        return false;
+    }
+    std::vector<uint8_t> buffer(session::properties_buffer_size(), 0);
+    auto* props = reinterpret_cast<EVENT_TRACE_PROPERTIES*>(buffer.data());
+    props->Wnode.BufferSize = static_cast<ULONG>(buffer.size());
+    props->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+
+    ULONG status = ControlTraceW(session_handle_, nullptr, props, EVENT_TRACE_CONTROL_FLUSH);
+    if (status != ERROR_SUCCESS) {
+        session::log_error(L"ControlTraceW (flush)", status);
+        return false;
+    }
+    return true;
+}
+
+void Session::stop() {
+    if (session_handle_ == 0) {
+        return;
+    }
+    std::vector<uint8_t> stop_buffer(session::properties_buffer_size(), 0);
+    auto* stop_props = reinterpret_cast<EVENT_TRACE_PROPERTIES*>(stop_buffer.data());
+    stop_props->Wnode.BufferSize = static_cast<ULONG>(stop_buffer.size());
+    stop_props->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+
+    ULONG status = ControlTraceW(session_handle_, nullptr, stop_props,
+                                  EVENT_TRACE_CONTROL_STOP);
+    if (status != ERROR_SUCCESS) {
+        session::log_error(L"StopTrace", status);
+    }
+    session_handle_ = 0;
+}
+
+bool Session::query_stats(SessionStats& out) const {
+    if (session_handle_ == 0) {
+        return false;
+    }
+    std::vector<uint8_t> buffer(session::properties_buffer_size(), 0);
+    auto* props = reinterpret_cast<EVENT_TRACE_PROPERTIES*>(buffer.data());
+    props->Wnode.BufferSize = static_cast<ULONG>(buffer.size());
+    props->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+
+    ULONG status = ControlTraceW(session_handle_, nullptr, props, EVENT_TRACE_CONTROL_QUERY);
+    if (status != ERROR_SUCCESS) {
+        session::log_error(L"ControlTraceW (query)", status);
+        return false;
     }
+    out.events_lost = props->EventsLost;
+    out.buffers_lost = props->RealTimeBuffersLost;
+    out.buffers_written = props->BuffersWritten;
+    out.free_buffers = props->FreeBuffers;
+    out.buffers = props->NumberOfBuffers;
+    return true;
 }
 
 }  // namespace exeray::etw
@@ -0,0 +1,62 @@
+/// @file stats.cpp
+/// @brief StatsPoller implementation (platform independent).
+
+#include "exeray/etw/session_stats.hpp"
+
+namespace exeray::etw {
+
+StatsPoller::~StatsPoller() {
+    stop();
+}
+
+void StatsPoller::start(Query query, std::chrono::milliseconds interval) {
+    stop();
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = false;
+        latest_ = {};
+    }
+    query_ = std::move(query);
+    sample();
+    thread_ = std::thread(&StatsPoller::run, this, interval);
+}
+
+void StatsPoller::stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+    sample();  // Counters at the end of the session
+    query_ = nullptr;
+}
+
+SessionStats StatsPoller::latest() const {
+    std::lock_guard lock(mutex_);
+    return latest_;
+}
+
+void StatsPoller::sample() {
+    SessionStats stats;
+    if (!query_ || !query_(stats)) {
+        return;
+    }
+    std::lock_guard lock(mutex_);
+    stats.samples = latest_.samples + 1;
+    latest_ = stats;
+}
+
+void StatsPoller::run(std::chrono::milliseconds interval) {
+    std::unique_lock lock(mutex_);
+    while (!wake_.wait_for(lock, interval, [this] { return stopping_; })) {
+        lock.unlock();
+        sample();
+        lock.lock();
+    }
+}
+
+}  // namespace exeray::etw
@@ -0,0 +1,107 @@
+/// @file shard_merger.cpp
+/// @brief ShardMerger implementation (platform independent).
+
+#include "exeray/etw/shard_merger.hpp"
+
+#include "exeray/etw/ingest_latency.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace exeray::etw {
+
+namespace {
+
+event::Timestamp steady_now() {
+    return static_cast<event::Timestamp>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+}  // namespace
+
+ShardMerger::ShardMerger(event::EventGraph& graph, std::size_t shards,
+                         event::Timestamp max_lag, Clock clock)
+    : graph_(graph),
+      max_lag_(max_lag),
+      clock_(clock ? std::move(clock) : Clock(steady_now)),
+      shards_(shards) {}
+
+void ShardMerger::submit(std::size_t shard, std::span<const event::PendingEvent> events) {
+    std::lock_guard lock(mutex_);
+    Shard& target = shards_[shard];
+    for (const auto& event : events) {
+        target.queue.push_back(event);
+        target.watermark = std::max(target.watermark, event.timestamp);
+    }
+    release(ready_bound());
+}
+
+event::EventId ShardMerger::push_now(std::size_t shard, const event::PendingEvent& event) {
+    std::lock_guard lock(mutex_);
+    Shard& source = shards_[shard];
+    source.watermark = std::max(source.watermark, event.timestamp);
+    release(event.timestamp);
+
+    event::EventId id = event::INVALID_EVENT;
+    graph_.push_batch(std::span(&event, 1), std::span(&id, 1));
+    record_visible(std::span(&event, 1));
+    return id;
+}
+
+void ShardMerger::flush() {
+    std::lock_guard lock(mutex_);
+    release(std::numeric_limits<event::Timestamp>::max());
+}
+
+std::size_t ShardMerger::pending() const {
+    std::lock_guard lock(mutex_);
+    std::size_t count = 0;
+    for (const auto& shard : shards_) {
+        count += shard.queue.size();
+    }
+    return count;
+}
+
+event::Timestamp ShardMerger::ready_bound() const {
+    event::Timestamp bound = std::numeric_limits<event::Timestamp>::max();
+    for (const auto& shard : shards_) {
+        bound = std::min(bound, shard.watermark);
+    }
+    const auto now = clock_();
+    const auto lagged = now > max_lag_ ? now - max_lag_ : 0;
+    return std::max(bound, lagged);
+}
+
+void ShardMerger::release(event::Timestamp bound) {
+    merged_.clear();
+    for (;;) {
+        // Few shards: a linear scan of the queue heads beats a heap
+        Shard* next = nullptr;
+        for (auto& shard : shards_) {
+            if (!shard.queue.empty() && shard.queue.front().timestamp <= bound &&
+                (next == nullptr ||
+                 shard.queue.front().timestamp < next->queue.front().timestamp)) {
+                next = &shard;
+            }
+        }
+        if (next == nullptr) {
+            break;
+        }
+        merged_.push_back(next->queue.front());
+        next->queue.pop_front();
+    }
+    if (!merged_.empty()) {
+        graph_.push_batch(merged_);
+        record_visible(merged_);
+    }
+}
+
+void ShardMerger::record_visible(std::span<const event::PendingEvent> events) {
+    if (latency_ != nullptr) {
+        latency_->record_visible(events, clock_(), latency_tick_);
+    }
+}
+
+}  // namespace exeray::etw
@@ -0,0 +1,116 @@
+/// @file shed_policy.cpp
+/// @brief ShedPolicy implementation (platform independent).
+
+#include "exeray/etw/shed_policy.hpp"
+
+#include <algorithm>
+
+namespace exeray::etw {
+
+namespace {
+
+constexpr std::size_t index(event::Category category) noexcept {
+    return static_cast<std::size_t>(category);
+}
+
+}  // namespace
+
+ShedPolicy::ShedPolicy(const ShedConfig& config)
+    : sample_percent_(config.sample_percent),
+      drop_percent_(config.drop_percent),
+      sample_every_(config.sample_every == 0 ? 1 : config.sample_every) {
+    for (auto& ops : table_) {
+        ops.fill(ShedPriority::Normal);
+    }
+
+    using event::Category;
+    auto set = [this](Category category, auto op, ShedPriority priority) {
+        table_[index(category)][static_cast<std::uint8_t>(op)] = priority;
+    };
+    set(Category::FileSystem, event::FileOp::Read, ShedPriority::Low);
+    set(Category::FileSystem, event::FileOp::Write, ShedPriority::Low);
+    set(Category::Network, event::NetworkOp::Send, ShedPriority::Low);
+    set(Category::Network, event::NetworkOp::Receive, ShedPriority::Low);
+    table_[index(Category::Process)].fill(ShedPriority::Critical);
+    table_[index(Category::Amsi)].fill(ShedPriority::Critical);
+    table_[index(Category::Script)].fill(ShedPriority::Critical);
+
+    for (const ShedRule& rule : config.rules) {
+        if (index(rule.category) >= kCategories) {
+            continue;
+        }
+        auto& ops = table_[index(rule.category)];
+        if (rule.operation >= ShedRule::kAnyOperation) {
+            ops.fill(rule.priority);
+        } else {
+            ops[rule.operation] = rule.priority;
+        }
+    }
+}
+
+ShedPriority ShedPolicy::priority(const event::EventPayload& payload,
+                                  std::uint8_t operation) const noexcept {
+    const std::size_t category = index(payload.category);
+    if (category >= kCategories) {
+        return ShedPriority::Normal;
+    }
+    // Remote thread creation is how injection shows up; never lose it
+    if (payload.category == event::Category::Thread && payload.thread.is_remote != 0) {
+        return ShedPriority::Critical;
+    }
+    return table_[category][operation];
+}
+
+bool ShedPolicy::admit(const event::EventPayload& payload, std::uint8_t operation,
+                       std::uint8_t pressure) noexcept {
+    if (pressure < sample_percent_.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    const ShedPriority level = priority(payload, operation);
+    if (level == ShedPriority::Critical) {
+        return true;
+    }
+
+    const std::size_t category = index(payload.category);
+    const std::uint8_t drop = drop_percent_.load(std::memory_order_relaxed);
+    bool keep = true;
+    if (level == ShedPriority::Low) {
+        keep = pressure < drop && sample(category);
+    } else if (pressure >= drop) {
+        keep = sample(category);
+    }
+    if (!keep) {
+        shed_[category].fetch_add(1, std::memory_order_relaxed);
+    }
+    return keep;
+}
+
+void ShedPolicy::set_thresholds(std::uint8_t sample_percent,
+                                std::uint8_t drop_percent) noexcept {
+    sample_percent = (std::min)(sample_percent, std::uint8_t{100});
+    drop_percent = std::clamp(drop_percent, sample_percent, std::uint8_t{100});
+    sample_percent_.store(sample_percent, std::memory_order_relaxed);
+    drop_percent_.store(drop_percent, std::memory_order_relaxed);
+}
+
+bool ShedPolicy::sample(std::size_t category) noexcept {
+    return sampled_[category].fetch_add(1, std::memory_order_relaxed) % sample_every_ == 0;
+}
+
+ShedStats ShedPolicy::stats() const noexcept {
+    ShedStats stats;
+    for (std::size_t i = 0; i < kCategories; ++i) {
+        stats.by_category[i] = shed_[i].load(std::memory_order_relaxed);
+        stats.total += stats.by_category[i];
+    }
+    return stats;
+}
+
+void ShedPolicy::reset_stats() noexcept {
+    for (std::size_t i = 0; i < kCategories; ++i) {
+        shed_[i].store(0, std::memory_order_relaxed);
+        sampled_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace exeray::etw
@@ -0,0 +1,251 @@
+/// @file stack_symbolizer.cpp
+/// @brief Module and export names for captured stacks.
+
+#include "exeray/etw/stack_symbolizer.hpp"
+#include "exeray/etw/image_verifier.hpp"
+#include "exeray/etw/module_map.hpp"
+#include "exeray/event/string_pool.hpp"
+#include "exeray/platform/mapped_file.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+namespace exeray::etw {
+
+namespace {
+
+// PE layout offsets (winnt.h)
+constexpr std::size_t kLfanewOffset = 0x3C;
+constexpr std::size_t kFileHeaderSize = 20;
+constexpr std::size_t kSectionHeaderSize = 40;
+constexpr std::uint16_t kPe32Magic = 0x10B;
+constexpr std::uint16_t kPe32PlusMagic = 0x20B;
+
+template <typename T>
+bool read_at(std::span<const std::uint8_t> image, std::size_t offset, T& out) noexcept {
+    if (offset > image.size() || image.size() - offset < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&out, image.data() + offset, sizeof(T));
+    return true;
+}
+
+/// @brief Sections of an image: where each range of RVAs lies in the file.
+class SectionMap {
+public:
+    struct Section {
+        std::uint32_t rva = 0;
+        std::uint32_t size = 0;
+        std::uint32_t file_offset = 0;
+        std::uint32_t file_size = 0;
+    };
+
+    void add(const Section& section) { sections_.push_back(section); }
+
+    /// @brief File offset of an RVA (nullopt if no section holds it in the file).
+    [[nodiscard]] std::optional<std::size_t> offset(std::uint32_t rva) const noexcept {
+        for (const Section& section : sections_) {
+            const std::uint32_t extent = (std::max)(section.size, section.file_size);
+            if (rva >= section.rva && rva - section.rva < extent) {
+                const std::uint32_t delta = rva - section.rva;
+                if (delta >= section.file_size) {
+                    return std::nullopt;
+                }
+                return std::size_t{section.file_offset} + delta;
+            }
+        }
+        return std::nullopt;
+    }
+
+private:
+    std::vector<Section> sections_;
+};
+
+/// @brief NUL-terminated name at a file offset (empty if unterminated).
+std::string_view name_at(std::span<const std::uint8_t> image, std::size_t offset) noexcept {
+    constexpr std::size_t kMaxName = 512;
+    if (offset >= image.size()) {
+        return {};
+    }
+    const auto* start = reinterpret_cast<const char*>(image.data() + offset);
+    const std::size_t limit = (std::min)(image.size() - offset, kMaxName);
+    const auto* end = static_cast<const char*>(std::memchr(start, '\0', limit));
+    return end == nullptr ? std::string_view{} : std::string_view(start, end - start);
+}
+
+}  // namespace
+
+std::vector<ExportSymbol> parse_pe_exports(std::span<const std::uint8_t> image) {
+    std::uint16_t dos_magic = 0;
+    std::uint32_t lfanew = 0;
+    std::uint32_t signature = 0;
+    if (!read_at(image, 0, dos_magic) || dos_magic != 0x5A4D ||
+        !read_at(image, kLfanewOffset, lfanew) || !read_at(image, lfanew, signature) ||
+        signature != 0x00004550) {
+        return {};
+    }
+    const std::size_t file_header = std::size_t{lfanew} + 4;
+    std::uint16_t section_count = 0;
+    std::uint16_t optional_size = 0;
+    std::uint16_t magic = 0;
+    const std::size_t optional = file_header + kFileHeaderSize;
+    if (!read_at(image, file_header + 2, section_count) ||
+        !read_at(image, file_header + 16, optional_size) || !read_at(image, optional, magic) ||
+        (magic != kPe32Magic && magic != kPe32PlusMagic)) {
+        return {};
+    }
+
+    // The data directories follow the fixed part of the optional header;
+    // the export directory is the first
+    const std::size_t directories = optional + (magic == kPe32PlusMagic ? 112 : 96);
+    std::uint32_t directory_count = 0;
+    std::uint32_t export_rva = 0;
+    std::uint32_t export_size = 0;
+    if (!read_at(image, directories - 4, directory_count) || directory_count == 0 ||
+        !read_at(image, directories, export_rva) ||
+        !read_at(image, directories + 4, export_size) || export_rva == 0) {
+        return {};
+    }
+
+    SectionMap sections;
+    const std::size_t section_table = optional + optional_size;
+    for (std::uint16_t i = 0; i < section_count; ++i) {
+        const std::size_t header = section_table + std::size_t{i} * kSectionHeaderSize;
+        SectionMap::Section section;
+        if (!read_at(image, header + 8, section.size) ||
+            !read_at(image, header + 12, section.rva) ||
+            !read_at(image, header + 16, section.file_size) ||
+            !read_at(image, header + 20, section.file_offset)) {
+            return {};
+        }
+        sections.add(section);
+    }
+
+    const auto directory = sections.offset(export_rva);
+    std::uint32_t function_count = 0;
+    std::uint32_t name_count = 0;
+    std::uint32_t functions_rva = 0;
+    std::uint32_t names_rva = 0;
+    std::uint32_t ordinals_rva = 0;
+    if (!directory || !read_at(image, *directory + 20, function_count) ||
+        !read_at(image, *directory + 24, name_count) ||
+        !read_at(image, *directory + 28, functions_rva) ||
+        !read_at(image, *directory + 32, names_rva) ||
+        !read_at(image, *directory + 36, ordinals_rva)) {
+        return {};
+    }
+    const auto functions = sections.offset(functions_rva);
+    const auto names = sections.offset(names_rva);
+    const auto ordinals = sections.offset(ordinals_rva);
+    if (!functions || !names || !ordinals) {
+        return {};
+    }
+
+    std::vector<ExportSymbol> exports;
+    exports.reserve((std::min)(name_count, std::uint32_t{65536}));
+    for (std::uint32_t i = 0; i < name_count; ++i) {
+        std::uint32_t name_rva = 0;
+        std::uint16_t ordinal = 0;
+        std::uint32_t rva = 0;
+        if (!read_at(image, *names + std::size_t{i} * 4, name_rva) ||
+            !read_at(image, *ordinals + std::size_t{i} * 2, ordinal) ||
+            ordinal >= function_count ||
+            !read_at(image, *functions + std::size_t{ordinal} * 4, rva)) {
+            break;
+        }
+        if (rva == 0 || (rva >= export_rva && rva - export_rva < export_size)) {
+            continue;  // Forwarded to another image
+        }
+        const auto name_offset = sections.offset(name_rva);
+        const std::string_view name = name_offset ? name_at(image, *name_offset) : "";
+        if (!name.empty()) {
+            exports.push_back({rva, std::string(name)});
+        }
+    }
+    std::sort(exports.begin(), exports.end(),
+              [](const ExportSymbol& a, const ExportSymbol& b) { return a.rva < b.rva; });
+    return exports;
+}
+
+StackSymbolizer::StackSymbolizer(const ModuleMap& modules, const event::StringPool& strings)
+    : modules_(modules), strings_(strings) {}
+
+std::vector<StackFrame> StackSymbolizer::symbolize(std::uint32_t pid,
+                                                   std::span<const std::uint64_t> frames) {
+    std::vector<StackFrame> resolved;
+    resolved.reserve(frames.size());
+    for (const std::uint64_t address : frames) {
+        StackFrame frame;
+        frame.address = address;
+        frame.kernel = address >= kKernelBase;
+
+        std::optional<ModuleInfo> module;
+        if (frame.kernel) {
+            module = modules_.find(4, address);
+            if (!module) {
+                module = modules_.find(0, address);
+            }
+        } else {
+            module = modules_.find(pid, address);
+        }
+        if (module) {
+            frame.module = module->path;
+            frame.offset = address - module->base;
+            const auto table = exports(module->path);
+            const auto next = std::upper_bound(
+                table->begin(), table->end(), frame.offset,
+                [](std::uint64_t offset, const ExportSymbol& symbol) {
+                    return offset < symbol.rva;
+                });
+            if (next != table->begin()) {
+                const ExportSymbol& symbol = *std::prev(next);
+                frame.function = symbol.name;
+                frame.displacement = frame.offset - symbol.rva;
+            }
+        }
+        resolved.push_back(std::move(frame));
+    }
+    return resolved;
+}
+
+void StackSymbolizer::clear() {
+    const std::lock_guard lock(mutex_);
+    cache_.clear();
+}
+
+std::size_t StackSymbolizer::cached_modules() const {
+    const std::lock_guard lock(mutex_);
+    return cache_.size();
+}
+
+std::shared_ptr<const StackSymbolizer::Exports> StackSymbolizer::exports(event::StringId path) {
+    {
+        const std::lock_guard lock(mutex_);
+        if (const auto it = cache_.find(path); it != cache_.end()) {
+            return it->second;
+        }
+    }
+
+    // Parsed outside the lock; two threads racing on a new module both
+    // parse it and the first insert wins
+    auto table = std::make_shared<Exports>();
+    std::string buffer;
+    const std::filesystem::path file = image_file_path(strings_.read(path, buffer));
+    std::error_code error;
+    const auto size = std::filesystem::file_size(file, error);
+    platform::MappedFile mapped;
+    if (!error && size <= kMaxImageBytes && mapped.open(file)) {
+        *table = parse_pe_exports(mapped.bytes());
+    }
+
+    const std::lock_guard lock(mutex_);
+    return cache_.try_emplace(path, std::move(table)).first->second;
+}
+
+}  // namespace exeray::etw
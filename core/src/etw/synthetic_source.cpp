@@ -0,0 +1,406 @@
+/// @file synthetic_source.cpp
+/// @brief Generated ParsedEvent streams for load tests on any platform.
+
+#include "exeray/etw/synthetic_source.hpp"
+
+#include "exeray/etw/clock.hpp"
+#include "exeray/etw/consumer.hpp"
+#include "exeray/etw/ingest_latency.hpp"
+#include "exeray/etw/parser.hpp"
+#include "exeray/etw/replay_pacer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+
+namespace exeray::etw {
+
+namespace {
+
+using event::Category;
+
+/// PIDs wrap below this, as the Windows PID space mostly does.
+constexpr std::uint32_t kPidLimit = 0x40000;
+
+/// First PID handed out; 0 and 4 are Idle and System.
+constexpr std::uint32_t kFirstPid = 8;
+
+constexpr std::wstring_view kFileDirectories[] = {
+    L"C:\\Windows\\System32\\",
+    L"C:\\Windows\\Temp\\",
+    L"C:\\Program Files\\Common Files\\microsoft shared\\",
+    L"C:\\ProgramData\\Microsoft\\Windows Defender\\Scans\\",
+    L"C:\\Users\\alice\\AppData\\Local\\Temp\\",
+    L"C:\\Users\\alice\\AppData\\Roaming\\Microsoft\\Windows\\Recent\\",
+    L"C:\\Users\\alice\\Documents\\",
+    L"C:\\Users\\bob\\Downloads\\",
+};
+
+constexpr std::wstring_view kModuleDirectories[] = {
+    L"C:\\Windows\\System32\\",
+    L"C:\\Windows\\SysWOW64\\",
+    L"C:\\Windows\\Microsoft.NET\\Framework64\\v4.0.30319\\",
+    L"C:\\Program Files\\Google\\Chrome\\Application\\",
+};
+
+constexpr std::wstring_view kExtensions[] = {L".dll", L".exe", L".log", L".tmp", L".dat",
+                                             L".txt"};
+
+void append_number(std::wstring& out, std::uint64_t value) {
+    wchar_t digits[20];
+    std::size_t count = 0;
+    do {
+        digits[count++] = static_cast<wchar_t>(L'0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (count != 0) {
+        out += digits[--count];
+    }
+}
+
+template <std::size_t N>
+std::wstring_view pick(const std::wstring_view (&items)[N], std::uint32_t index) noexcept {
+    return items[index % N];
+}
+
+/// @brief Whether SyntheticSource generates events of category.
+bool generated(Category category) noexcept {
+    switch (category) {
+        case Category::FileSystem:
+        case Category::Registry:
+        case Category::Network:
+        case Category::Image:
+        case Category::Thread:
+        case Category::Memory:
+        case Category::Script:
+        case Category::Dns:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/// @brief ETW timestamp of the current instant in the clock domain.
+std::uint64_t etw_now(const ClockDomain& clock) noexcept {
+    const event::Timestamp now = IngestLatency::now();
+    const event::Timestamp since = now > clock.graph_anchor ? now - clock.graph_anchor : 0;
+    return clock.etw_anchor + since / ClockDomain::kNsPerTick;
+}
+
+}  // namespace
+
+std::array<std::uint32_t, kSyntheticCategories> SyntheticConfig::default_mix() noexcept {
+    std::array<std::uint32_t, kSyntheticCategories> mix{};
+    mix[static_cast<std::size_t>(Category::FileSystem)] = 45;
+    mix[static_cast<std::size_t>(Category::Registry)] = 25;
+    mix[static_cast<std::size_t>(Category::Network)] = 8;
+    mix[static_cast<std::size_t>(Category::Image)] = 6;
+    mix[static_cast<std::size_t>(Category::Thread)] = 6;
+    mix[static_cast<std::size_t>(Category::Memory)] = 5;
+    mix[static_cast<std::size_t>(Category::Dns)] = 3;
+    mix[static_cast<std::size_t>(Category::Script)] = 2;
+    return mix;
+}
+
+SyntheticSource::SyntheticSource(const SyntheticConfig& config)
+    : config_(config),
+      state_(config.seed * 0x9E3779B97F4A7C15ULL | 1),
+      next_pid_(kFirstPid) {
+    config_.processes = std::clamp(config_.processes, 1u, kPidLimit / 8);
+    config_.strings = (std::max)(config_.strings, 1u);
+    config_.buffer_events = (std::max)(config_.buffer_events, std::size_t{1});
+
+    std::uint32_t total = 0;
+    for (std::size_t i = 0; i < kSyntheticCategories; ++i) {
+        if (generated(static_cast<Category>(i))) {
+            total += config_.mix[i];
+        }
+        cumulative_[i] = total;
+    }
+    if (total == 0) {
+        // Nothing weighted: file I/O only
+        std::fill(cumulative_.begin(), cumulative_.end(), 1u);
+    }
+
+    // The initial processes form a tree: each one was started by an earlier one
+    running_.reserve(config_.processes);
+    for (std::uint32_t i = 0; i < config_.processes; ++i) {
+        const std::uint32_t parent = i == 0 ? 4 : running_[random() % i].pid;
+        running_.push_back({new_pid(), parent});
+    }
+}
+
+std::uint64_t SyntheticSource::random() noexcept {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 7;
+    state_ ^= state_ << 17;
+    return state_;
+}
+
+std::uint32_t SyntheticSource::rank() noexcept {
+    // The Zipf(1) CDF is close to ln(k) / ln(n), so n^u inverts it
+    const double u = static_cast<double>(random() >> 11) * 0x1.0p-53;
+    const auto k = static_cast<std::uint32_t>(std::pow(static_cast<double>(config_.strings), u));
+    return (std::min)((std::max)(k, 1u), config_.strings) - 1;
+}
+
+std::wstring& SyntheticSource::text(std::size_t slot) noexcept {
+    texts_[slot].clear();  // Keeps the capacity
+    return texts_[slot];
+}
+
+std::uint32_t SyntheticSource::new_pid() noexcept {
+    for (;;) {
+        const std::uint32_t pid = next_pid_;
+        next_pid_ += 4;
+        if (next_pid_ >= kPidLimit) {
+            next_pid_ = kFirstPid;
+            wrapped_ = true;
+        }
+        // Until the first wrap every PID is new
+        const bool taken = wrapped_ && std::any_of(running_.begin(), running_.end(),
+                                                   [pid](const Process& process) {
+                                                       return process.pid == pid;
+                                                   });
+        if (!taken) {
+            return pid;
+        }
+    }
+}
+
+ParsedEvent SyntheticSource::next(std::uint64_t timestamp) {
+    ParsedEvent parsed{};
+    parsed.status = event::Status::Success;
+    parsed.timestamp = timestamp;
+    parsed.valid = true;
+    ++produced_;
+
+    if (rundown_ < running_.size()) {
+        make_process(parsed, running_[rundown_++],
+                     static_cast<std::uint8_t>(event::ProcessOp::Rundown));
+        return parsed;
+    }
+    if (replacing_ != 0) {
+        Process& slot = running_[replacing_ - 1];
+        replacing_ = 0;
+        const std::uint32_t parent = running_[random() % running_.size()].pid;
+        slot = {new_pid(), parent};
+        ++started_;
+        make_process(parsed, slot, static_cast<std::uint8_t>(event::ProcessOp::Create));
+        return parsed;
+    }
+
+    const std::uint64_t x = random();
+    if (x % 1000 < config_.churn) {
+        // The new process follows as the next event
+        const std::size_t index = (x >> 10) % running_.size();
+        replacing_ = index + 1;
+        make_process(parsed, running_[index],
+                     static_cast<std::uint8_t>(event::ProcessOp::Terminate));
+        return parsed;
+    }
+
+    const auto pick_weight = static_cast<std::uint32_t>((x >> 20) % cumulative_.back());
+    const auto category = static_cast<Category>(
+        std::upper_bound(cumulative_.begin(), cumulative_.end(), pick_weight) -
+        cumulative_.begin());
+    const std::uint32_t pid = running_[(x >> 40) % running_.size()].pid;
+    thread_id_ = pid * 4 + static_cast<std::uint32_t>(x >> 60) * 4;
+    make_event(parsed, category, pid);
+    return parsed;
+}
+
+void SyntheticSource::make_process(ParsedEvent& parsed, const Process& process,
+                                   std::uint8_t operation) {
+    parsed.category = Category::Process;
+    parsed.operation = operation;
+    // A start is logged by its creator
+    const bool create = operation == static_cast<std::uint8_t>(event::ProcessOp::Create);
+    parsed.pid = create ? process.parent : process.pid;
+    thread_id_ = parsed.pid * 4;
+
+    event::EventPayload& payload = parsed.payload;
+    payload.category = Category::Process;
+    payload.process = {process.pid, process.parent, event::INVALID_STRING,
+                       event::INVALID_STRING};
+    if (operation == static_cast<std::uint8_t>(event::ProcessOp::Terminate)) {
+        return;
+    }
+    const std::uint32_t r = rank();
+    std::wstring& image = text(0);
+    image += L"C:\\Program Files\\Vendor";
+    append_number(image, r % 40);
+    image += L"\\app";
+    append_number(image, r);
+    image += L".exe";
+    std::wstring& command = text(1);
+    command += L'"';
+    command += image;
+    command += L"\" --instance ";
+    append_number(command, process.pid);
+    parsed.deferred.add(payload, payload.process.image_path, image, StringKind::WidePath);
+    parsed.deferred.add(payload, payload.process.command_line, command);
+}
+
+void SyntheticSource::make_event(ParsedEvent& parsed, Category category, std::uint32_t pid) {
+    const std::uint64_t x = random();
+    const std::uint32_t r = rank();
+    const auto roll = static_cast<std::uint32_t>(x % 100);
+    parsed.category = category;
+    parsed.pid = pid;
+    event::EventPayload& payload = parsed.payload;
+    payload.category = category;
+
+    switch (category) {
+        case Category::FileSystem: {
+            const event::FileOp op = roll < 20   ? event::FileOp::Create
+                                     : roll < 55 ? event::FileOp::Read
+                                     : roll < 85 ? event::FileOp::Write
+                                     : roll < 90 ? event::FileOp::Delete
+                                     : roll < 95 ? event::FileOp::Rename
+                                                 : event::FileOp::SetAttributes;
+            parsed.operation = static_cast<std::uint8_t>(op);
+            payload.file.size = (x >> 8) & 0xFFFFF;
+            payload.file.attributes = 0x80;  // FILE_ATTRIBUTE_NORMAL
+            parsed.object = (std::uint64_t{pid} << 32) | r;
+            std::wstring& path = text(0);
+            path += pick(kFileDirectories, r);
+            path += L"file";
+            append_number(path, r);
+            path += pick(kExtensions, r / 8);
+            parsed.deferred.add(payload, payload.file.path, path, StringKind::WidePath);
+            break;
+        }
+        case Category::Registry: {
+            const event::RegistryOp op = roll < 70   ? event::RegistryOp::QueryValue
+                                         : roll < 85 ? event::RegistryOp::SetValue
+                                         : roll < 95 ? event::RegistryOp::CreateKey
+                                                     : event::RegistryOp::DeleteValue;
+            parsed.operation = static_cast<std::uint8_t>(op);
+            payload.registry.value_type = 1;  // REG_SZ
+            payload.registry.data_size = static_cast<std::uint32_t>(x >> 8) & 0x3FF;
+            std::wstring& key = text(0);
+            key += L"\\REGISTRY\\MACHINE\\SOFTWARE\\Vendor";
+            append_number(key, r % 64);
+            key += L"\\Component";
+            append_number(key, r);
+            std::wstring& value = text(1);
+            value += L"Value";
+            append_number(value, r % 16);
+            parsed.deferred.add(payload, payload.registry.key_path, key, StringKind::WidePath);
+            parsed.deferred.add(payload, payload.registry.value_name, value);
+            break;
+        }
+        case Category::Network: {
+            const event::NetworkOp op = roll < 40   ? event::NetworkOp::Send
+                                        : roll < 80 ? event::NetworkOp::Receive
+                                        : roll < 90 ? event::NetworkOp::Connect
+                                                    : event::NetworkOp::Close;
+            parsed.operation = static_cast<std::uint8_t>(op);
+            payload.network.local_addr = 0x0A000002;
+            payload.network.remote_addr = 0x0A000000 | (r & 0xFFFFFF);
+            payload.network.local_port = static_cast<std::uint16_t>(49152 + pid % 16000);
+            payload.network.remote_port = r % 4 == 0 ? 80 : 443;
+            payload.network.bytes = 64 + static_cast<std::uint32_t>(x >> 8) % 16384;
+            payload.network.protocol = 6;
+            payload.network.family = event::kAddressIPv4;
+            break;
+        }
+        case Category::Image: {
+            const bool load = roll < 90;
+            parsed.operation =
+                static_cast<std::uint8_t>(load ? event::ImageOp::Load : event::ImageOp::Unload);
+            payload.image.process_id = pid;
+            payload.image.base_address = 0x7FF800000000ULL + std::uint64_t{r} * 0x10000;
+            payload.image.size = 0x20000;
+            std::wstring& path = text(0);
+            path += pick(kModuleDirectories, r);
+            path += L"module";
+            append_number(path, r);
+            path += L".dll";
+            parsed.deferred.add(payload, payload.image.image_path, path, StringKind::WidePath);
+            break;
+        }
+        case Category::Thread:
+            parsed.operation = static_cast<std::uint8_t>(roll < 50 ? event::ThreadOp::Start
+                                                                   : event::ThreadOp::End);
+            payload.thread.thread_id = thread_id_;
+            payload.thread.process_id = pid;
+            payload.thread.creator_pid = pid;
+            payload.thread.start_address = 0x7FF800001000ULL + std::uint64_t{r} * 0x10000;
+            break;
+        case Category::Memory:
+            parsed.operation = static_cast<std::uint8_t>(roll < 60 ? event::MemoryOp::Alloc
+                                                                   : event::MemoryOp::Free);
+            payload.memory.base_address = 0x1F0000000ULL + ((x >> 8) & 0xFFFF) * 0x10000;
+            payload.memory.region_size = 0x1000 * (1 + static_cast<std::uint32_t>(x >> 24) % 64);
+            payload.memory.process_id = pid;
+            payload.memory.protection = 0x04;  // PAGE_READWRITE
+            break;
+        case Category::Script: {
+            parsed.operation = static_cast<std::uint8_t>(event::ScriptOp::Execute);
+            payload.script.sequence = 1;
+            std::wstring& block = text(0);
+            block += L"Get-Item -Path C:\\Users\\alice\\Documents\\file";
+            append_number(block, r);
+            block += L".txt | Select-Object Length";
+            std::wstring& context = text(1);
+            context += L"ConsoleHost";
+            parsed.deferred.add(payload, payload.script.script_block, block);
+            parsed.deferred.add(payload, payload.script.context, context);
+            break;
+        }
+        case Category::Dns: {
+            const bool failed = roll >= 95;
+            parsed.operation = static_cast<std::uint8_t>(failed ? event::DnsOp::Failure
+                                                                : event::DnsOp::Response);
+            parsed.status = failed ? event::Status::Error : event::Status::Success;
+            payload.dns.query_type = 1;  // A
+            payload.dns.result_code = failed ? 3 : 0;
+            payload.dns.resolved_ip = failed ? 0 : 0x5DB8D800 | (r & 0xFF);
+            std::wstring& domain = text(0);
+            domain += L"host";
+            append_number(domain, r);
+            domain += L".cdn";
+            append_number(domain, r % 32);
+            domain += L".example.com";
+            parsed.deferred.add(payload, payload.dns.domain, domain);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+std::uint64_t SyntheticSource::feed(ConsumerContext& ctx, std::uint64_t count) {
+    const bool paced = config_.rate > 0.0;
+    const double ticks_per_event = paced ? 1e7 / config_.rate : 0.0;
+    const std::uint64_t start = etw_now(ctx.clock);
+    ReplayPacer pacer;
+
+    for (std::uint64_t i = 0; i < count; ++i) {
+        const std::uint64_t stamp =
+            paced ? start + static_cast<std::uint64_t>(static_cast<double>(i) * ticks_per_event)
+                  : etw_now(ctx.clock);
+        ParsedEvent parsed = next(stamp);
+        if (paced) {
+            pacer.pace(stamp);
+        }
+        event::Timestamp received = 0;
+        if (ctx.latency != nullptr && IngestLatency::due(ctx.delivered_tick)) {
+            received = IngestLatency::now();
+        }
+        consume_parsed(ctx, parsed, thread_id_, 0, received);
+        if ((i + 1) % config_.buffer_events == 0) {
+            ctx.buffers_read.fetch_add(1, std::memory_order_relaxed);
+            flush_pending(ctx);
+        }
+    }
+    if (count % config_.buffer_events != 0) {
+        ctx.buffers_read.fetch_add(1, std::memory_order_relaxed);
+    }
+    finish_pending(ctx);
+    return count;
+}
+
+}  // namespace exeray::etw
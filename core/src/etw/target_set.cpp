@@ -0,0 +1,106 @@
+/// @file target_set.cpp
+/// @brief Lock-free process ID set (platform independent).
+
+#include "exeray/etw/target_set.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace exeray::etw {
+
+TargetSet::TargetSet()
+    : bits_(std::make_unique<std::atomic<std::uint64_t>[]>(kBitmapWords)),
+      slots_(std::make_unique<std::atomic<std::uint32_t>[]>(kTableSlots)) {}
+
+bool TargetSet::insert(std::uint32_t pid) {
+    if (in_bitmap(pid)) {
+        if (pid == 0) {
+            return false;
+        }
+        const std::uint32_t bit = pid >> 2;
+        const std::uint64_t mask = std::uint64_t{1} << (bit % 64);
+        if ((bits_[bit / 64].fetch_or(mask, std::memory_order_acq_rel) & mask) == 0) {
+            size_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+    if (!valid(pid)) {
+        return false;
+    }
+    // Only empty slots are claimed, so a PID is never held twice
+    for (std::size_t i = 0, slot = home(pid); i < kTableSlots;
+         ++i, slot = (slot + 1) % kTableSlots) {
+        std::uint32_t held = slots_[slot].load(std::memory_order_acquire);
+        if (held == kEmpty && slots_[slot].compare_exchange_strong(held, pid,
+                                                                   std::memory_order_acq_rel)) {
+            table_size_.fetch_add(1, std::memory_order_release);
+            size_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        if (held == pid) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void TargetSet::erase(std::uint32_t pid) {
+    if (in_bitmap(pid)) {
+        const std::uint32_t bit = pid >> 2;
+        const std::uint64_t mask = std::uint64_t{1} << (bit % 64);
+        if ((bits_[bit / 64].fetch_and(~mask, std::memory_order_acq_rel) & mask) != 0) {
+            size_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+    if (!valid(pid)) {
+        return;
+    }
+    for (std::size_t i = 0, slot = home(pid); i < kTableSlots;
+         ++i, slot = (slot + 1) % kTableSlots) {
+        std::uint32_t held = slots_[slot].load(std::memory_order_acquire);
+        if (held == kEmpty) {
+            return;
+        }
+        // Erased slots stay marked so probes for later PIDs go on past them
+        if (held == pid && slots_[slot].compare_exchange_strong(held, kErased,
+                                                                std::memory_order_acq_rel)) {
+            table_size_.fetch_sub(1, std::memory_order_release);
+            size_.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+std::vector<std::uint32_t> TargetSet::pids() const {
+    std::vector<std::uint32_t> out;
+    for (std::size_t word = 0; word < kBitmapWords; ++word) {
+        std::uint64_t bits = bits_[word].load(std::memory_order_acquire);
+        while (bits != 0) {
+            const auto bit = static_cast<std::uint32_t>(std::countr_zero(bits));
+            out.push_back(static_cast<std::uint32_t>((word * 64 + bit) << 2));
+            bits &= bits - 1;
+        }
+    }
+    for (std::size_t slot = 0; slot < kTableSlots; ++slot) {
+        const std::uint32_t held = slots_[slot].load(std::memory_order_acquire);
+        if (valid(held)) {
+            out.push_back(held);
+        }
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+void TargetSet::clear() {
+    for (std::size_t word = 0; word < kBitmapWords; ++word) {
+        bits_[word].store(0, std::memory_order_relaxed);
+    }
+    for (std::size_t slot = 0; slot < kTableSlots; ++slot) {
+        slots_[slot].store(kEmpty, std::memory_order_relaxed);
+    }
+    size_.store(0, std::memory_order_relaxed);
+    table_size_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace exeray::etw
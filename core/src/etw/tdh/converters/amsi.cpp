@@ -4,13 +4,25 @@
 #ifdef _WIN32
 
 #include "exeray/etw/tdh/converters.hpp"
+#include "exeray/etw/tdh/field_table.hpp"
 #include "exeray/etw/tdh/internal.hpp"
 #include "exeray/etw/parser_utils.hpp"
 #include "exeray/event/string_pool.hpp"
 
 namespace exeray::etw {
 
-using namespace tdh::detail;
+namespace {
+
+using event::EventPayload;
+
+constexpr auto kFields = tdh::field_table<EventPayload>({
+    {L"appname", offsetof(EventPayload, amsi.app_name), tdh::Transform::String},
+    {L"content", offsetof(EventPayload, amsi.content), tdh::Transform::String},
+    {L"scanResult", offsetof(EventPayload, amsi.scan_result), tdh::Transform::U32},
+    {L"contentSize", offsetof(EventPayload, amsi.content_size), tdh::Transform::U32},
+});
+
+}  // namespace
 
 ParsedEvent convert_tdh_to_amsi(
     const TdhParsedEvent& tdh_event,
@@ -22,22 +34,8 @@ ParsedEvent convert_tdh_to_amsi(
     result.payload.category = event::Category::Amsi;
     result.operation = static_cast<uint8_t>(event::AmsiOp::Scan);
     
-    std::wstring app_name = get_wstring_prop(tdh_event, L"appname");
-    if (!app_name.empty() && strings != nullptr) {
-        result.payload.amsi.app_name = strings->intern_wide(app_name);
-    } else {
-        result.payload.amsi.app_name = event::INVALID_STRING;
-    }
-    
-    std::wstring content = get_wstring_prop(tdh_event, L"content");
-    if (!content.empty() && strings != nullptr) {
-        result.payload.amsi.content = strings->intern_wide(content);
-    } else {
-        result.payload.amsi.content = event::INVALID_STRING;
-    }
-    
-    result.payload.amsi.scan_result = get_uint32_prop(tdh_event, L"scanResult");
-    result.payload.amsi.content_size = get_uint32_prop(tdh_event, L"contentSize");
+    thread_local tdh::FieldMapper fields(kFields);
+    fields.apply(tdh_event, result.payload, strings);
     
     result.valid = true;
     return result;
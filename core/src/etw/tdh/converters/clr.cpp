@@ -4,13 +4,37 @@
 #ifdef _WIN32
 
 #include "exeray/etw/tdh/converters.hpp"
+#include "exeray/etw/tdh/field_table.hpp"
 #include "exeray/etw/tdh/internal.hpp"
 #include "exeray/etw/parser_utils.hpp"
 #include "exeray/event/string_pool.hpp"
 
 namespace exeray::etw {
 
-using namespace tdh::detail;
+namespace {
+
+using event::EventPayload;
+
+constexpr auto kFields = tdh::field_table<EventPayload>({
+    {L"AssemblyName", offsetof(EventPayload, clr.assembly_name), tdh::Transform::String},
+    {L"FullyQualifiedAssemblyName", offsetof(EventPayload, clr.assembly_name),
+     tdh::Transform::String},
+    {L"MethodName", offsetof(EventPayload, clr.method_name), tdh::Transform::String},
+    // Module and JIT events carry the ModuleID the JIT aggregation keys on
+    {L"ModuleID", offsetof(EventPayload, clr.load_address), tdh::Transform::U64},
+});
+
+// Module loads without an assembly name are named by their IL path
+constexpr auto kModuleFields = tdh::field_table<EventPayload>({
+    {L"AssemblyName", offsetof(EventPayload, clr.assembly_name), tdh::Transform::String},
+    {L"FullyQualifiedAssemblyName", offsetof(EventPayload, clr.assembly_name),
+     tdh::Transform::String},
+    {L"ModuleILPath", offsetof(EventPayload, clr.assembly_name), tdh::Transform::String},
+    {L"MethodName", offsetof(EventPayload, clr.method_name), tdh::Transform::String},
+    {L"ModuleID", offsetof(EventPayload, clr.load_address), tdh::Transform::U64},
+});
+
+}  // namespace
 
 ParsedEvent convert_tdh_to_clr(
     const TdhParsedEvent& tdh_event,
@@ -22,6 +46,9 @@ ParsedEvent convert_tdh_to_clr(
     result.payload.category = event::Category::Clr;
     
     switch (tdh_event.event_id) {
+        case 151:
+            result.operation = static_cast<uint8_t>(event::ClrOp::ModuleLoad);
+            break;
         case 152:
         case 153:
             result.operation = static_cast<uint8_t>(event::ClrOp::AssemblyLoad);
@@ -37,27 +64,19 @@ ParsedEvent convert_tdh_to_clr(
             return result;
     }
     
-    std::wstring assembly_name = get_wstring_prop(tdh_event, L"AssemblyName");
-    if (assembly_name.empty()) {
-        assembly_name = get_wstring_prop(tdh_event, L"FullyQualifiedAssemblyName");
-    }
-    if (!assembly_name.empty() && strings != nullptr) {
-        result.payload.clr.assembly_name = strings->intern_wide(assembly_name);
+    if (tdh_event.event_id == 151) {
+        thread_local tdh::FieldMapper fields(kModuleFields);
+        fields.apply(tdh_event, result.payload, strings);
     } else {
-        result.payload.clr.assembly_name = event::INVALID_STRING;
+        thread_local tdh::FieldMapper fields(kFields);
+        fields.apply(tdh_event, result.payload, strings);
     }
+    result.payload.clr.methods = tdh_event.event_id == 155 ? 1 : 0;
     
-    std::wstring method_name = get_wstring_prop(tdh_event, L"MethodName");
-    if (!method_name.empty() && strings != nullptr) {
-        result.payload.clr.method_name = strings->intern_wide(method_name);
-    } else {
-        result.payload.clr.method_name = event::INVALID_STRING;
-    }
-    
-    result.payload.clr.load_address = get_uint64_prop(tdh_event, L"ModuleILPath");
-    
-    result.payload.clr.is_dynamic = (assembly_name.find(L"\\") == std::wstring::npos &&
-                                      assembly_name.find(L"/") == std::wstring::npos) ? 1 : 0;
+    const std::string_view assembly_name =
+        strings != nullptr ? strings->get(result.payload.clr.assembly_name) : std::string_view{};
+    result.payload.clr.is_dynamic = (assembly_name.find('\\') == std::string_view::npos &&
+                                     assembly_name.find('/') == std::string_view::npos) ? 1 : 0;
     result.payload.clr.is_suspicious = result.payload.clr.is_dynamic;
     
     result.valid = true;
@@ -4,13 +4,24 @@
 #ifdef _WIN32
 
 #include "exeray/etw/tdh/converters.hpp"
+#include "exeray/etw/tdh/field_table.hpp"
 #include "exeray/etw/tdh/internal.hpp"
 #include "exeray/etw/parser_utils.hpp"
 #include "exeray/event/string_pool.hpp"
 
 namespace exeray::etw {
 
-using namespace tdh::detail;
+namespace {
+
+using event::EventPayload;
+
+constexpr auto kFields = tdh::field_table<EventPayload>({
+    {L"QueryName", offsetof(EventPayload, dns.domain), tdh::Transform::String},
+    {L"QueryType", offsetof(EventPayload, dns.query_type), tdh::Transform::U32},
+    {L"QueryResults", offsetof(EventPayload, dns.resolved_ip), tdh::Transform::U32},
+});
+
+}  // namespace
 
 ParsedEvent convert_tdh_to_dns(
     const TdhParsedEvent& tdh_event,
@@ -27,20 +38,15 @@ ParsedEvent convert_tdh_to_dns(
             result.operation = static_cast<uint8_t>(event::DnsOp::Failure);
             result.status = event::Status::Error;
             break;
+        case 3009: result.operation = static_cast<uint8_t>(event::DnsOp::Query); break;
         default:
             result.valid = false;
             return result;
     }
     
-    std::wstring query_name = get_wstring_prop(tdh_event, L"QueryName");
-    if (!query_name.empty() && strings != nullptr) {
-        result.payload.dns.domain = strings->intern_wide(query_name);
-    } else {
-        result.payload.dns.domain = event::INVALID_STRING;
-    }
+    thread_local tdh::FieldMapper fields(kFields);
+    fields.apply(tdh_event, result.payload, strings);
     
-    result.payload.dns.query_type = get_uint32_prop(tdh_event, L"QueryType");
-    result.payload.dns.resolved_ip = get_uint32_prop(tdh_event, L"QueryResults");
     result.payload.dns.is_suspicious = 0;
     
     result.valid = true;
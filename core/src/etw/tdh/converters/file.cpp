@@ -4,13 +4,29 @@
 #ifdef _WIN32
 
 #include "exeray/etw/tdh/converters.hpp"
+#include "exeray/etw/tdh/field_table.hpp"
 #include "exeray/etw/tdh/internal.hpp"
+#include "exeray/etw/file_map.hpp"
 #include "exeray/etw/parser_utils.hpp"
 #include "exeray/event/string_pool.hpp"
 
 namespace exeray::etw {
 
-using namespace tdh::detail;
+namespace {
+
+/// File events name an object and a path; both feed the file map.
+struct FileFields {
+    uint64_t object = 0;
+    event::StringId path = event::INVALID_STRING;
+};
+
+constexpr auto kFields = tdh::field_table<FileFields>({
+    {L"FileObject", offsetof(FileFields, object), tdh::Transform::U64},
+    {L"FileName", offsetof(FileFields, path), tdh::Transform::Path},
+    {L"OpenPath", offsetof(FileFields, path), tdh::Transform::Path},
+});
+
+}  // namespace
 
 ParsedEvent convert_tdh_to_file(
     const TdhParsedEvent& tdh_event,
@@ -21,6 +37,19 @@ ParsedEvent convert_tdh_to_file(
     extract_common(record, result, event::Category::FileSystem);
     result.payload.category = event::Category::FileSystem;
     
+    thread_local tdh::FieldMapper fields(kFields);
+    FileFields file;
+    fields.apply(tdh_event, file, strings);
+
+    // Any event naming an object (rundown of files open before the session
+    // included) feeds the file map for the I/O that follows
+    if (file.path != event::INVALID_STRING) {
+        file_map().insert(file.object, file.path, result.pid);
+    } else if (file.object != 0) {
+        file.path = file_map().find(file.object).path;
+    }
+    result.object = file.object;
+
     switch (tdh_event.event_id) {
         case 10: result.operation = static_cast<uint8_t>(event::FileOp::Create); break;
         case 11: result.operation = static_cast<uint8_t>(event::FileOp::Create); break;
@@ -31,17 +60,8 @@ ParsedEvent convert_tdh_to_file(
             result.valid = false;
             return result;
     }
-    
-    std::wstring path = get_wstring_prop(tdh_event, L"FileName");
-    if (path.empty()) {
-        path = get_wstring_prop(tdh_event, L"OpenPath");
-    }
-    if (!path.empty() && strings != nullptr) {
-        result.payload.file.path = strings->intern_wide(path);
-    } else {
-        result.payload.file.path = event::INVALID_STRING;
-    }
-    
+    result.payload.file.path = file.path;
+
     result.valid = true;
     return result;
 }
@@ -4,13 +4,26 @@
 #ifdef _WIN32
 
 #include "exeray/etw/tdh/converters.hpp"
+#include "exeray/etw/tdh/field_table.hpp"
 #include "exeray/etw/tdh/internal.hpp"
 #include "exeray/etw/parser_utils.hpp"
 #include "exeray/event/string_pool.hpp"
 
 namespace exeray::etw {
 
-using namespace tdh::detail;
+namespace {
+
+using event::EventPayload;
+
+constexpr auto kFields = tdh::field_table<EventPayload>({
+    {L"ImageBase", offsetof(EventPayload, image.base_address), tdh::Transform::U64},
+    {L"ImageSize", offsetof(EventPayload, image.size), tdh::Transform::U32},
+    {L"ProcessId", offsetof(EventPayload, image.process_id), tdh::Transform::U32},
+    {L"FileName", offsetof(EventPayload, image.image_path), tdh::Transform::Path},
+    {L"ImageFileName", offsetof(EventPayload, image.image_path), tdh::Transform::Path},
+});
+
+}  // namespace
 
 ParsedEvent convert_tdh_to_image(
     const TdhParsedEvent& tdh_event,
@@ -29,19 +42,8 @@ ParsedEvent convert_tdh_to_image(
             return result;
     }
     
-    result.payload.image.base_address = get_uint64_prop(tdh_event, L"ImageBase");
-    result.payload.image.size = static_cast<uint32_t>(get_uint64_prop(tdh_event, L"ImageSize"));
-    result.payload.image.process_id = get_uint32_prop(tdh_event, L"ProcessId");
-    
-    std::wstring path = get_wstring_prop(tdh_event, L"FileName");
-    if (path.empty()) {
-        path = get_wstring_prop(tdh_event, L"ImageFileName");
-    }
-    if (!path.empty() && strings != nullptr) {
-        result.payload.image.image_path = strings->intern_wide(path);
-    } else {
-        result.payload.image.image_path = event::INVALID_STRING;
-    }
+    thread_local tdh::FieldMapper fields(kFields);
+    fields.apply(tdh_event, result.payload, strings);
     
     result.payload.image.is_suspicious = 0;
     result.valid = true;
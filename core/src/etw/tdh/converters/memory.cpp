@@ -4,17 +4,29 @@
 #ifdef _WIN32
 
 #include "exeray/etw/tdh/converters.hpp"
+#include "exeray/etw/tdh/field_table.hpp"
 #include "exeray/etw/tdh/internal.hpp"
 #include "exeray/etw/parser_utils.hpp"
 
 namespace exeray::etw {
 
-using namespace tdh::detail;
+namespace {
+
+using event::EventPayload;
+
+constexpr auto kFields = tdh::field_table<EventPayload>({
+    {L"BaseAddress", offsetof(EventPayload, memory.base_address), tdh::Transform::U64},
+    {L"RegionSize", offsetof(EventPayload, memory.region_size), tdh::Transform::U32},
+    {L"ProcessId", offsetof(EventPayload, memory.process_id), tdh::Transform::U32},
+    {L"Flags", offsetof(EventPayload, memory.protection), tdh::Transform::U32},
+});
+
+}  // namespace
 
 ParsedEvent convert_tdh_to_memory(
     const TdhParsedEvent& tdh_event,
     const EVENT_RECORD* record,
-    event::StringPool* /*strings*/
+    event::StringPool* strings
 ) {
     ParsedEvent result{};
     extract_common(record, result, event::Category::Memory);
@@ -28,11 +40,8 @@ ParsedEvent convert_tdh_to_memory(
             return result;
     }
     
-    result.payload.memory.base_address = get_uint64_prop(tdh_event, L"BaseAddress");
-    result.payload.memory.region_size = static_cast<uint32_t>(
-        get_uint64_prop(tdh_event, L"RegionSize"));
-    result.payload.memory.process_id = get_uint32_prop(tdh_event, L"ProcessId");
-    result.payload.memory.protection = get_uint32_prop(tdh_event, L"Flags");
+    thread_local tdh::FieldMapper fields(kFields);
+    fields.apply(tdh_event, result.payload, strings);
     
     constexpr uint32_t kPageExecuteReadWrite = 0x40;
     constexpr uint32_t kPageExecuteWriteCopy = 0x80;
@@ -4,17 +4,29 @@
 #ifdef _WIN32
 
 #include "exeray/etw/tdh/converters.hpp"
+#include "exeray/etw/tdh/field_table.hpp"
 #include "exeray/etw/tdh/internal.hpp"
 #include "exeray/etw/parser_utils.hpp"
 
 namespace exeray::etw {
 
-using namespace tdh::detail;
+namespace {
+
+using event::EventPayload;
+
+constexpr auto kFields = tdh::field_table<EventPayload>({
+    {L"sport", offsetof(EventPayload, network.local_port), tdh::Transform::U16},
+    {L"dport", offsetof(EventPayload, network.remote_port), tdh::Transform::U16},
+    {L"saddr", offsetof(EventPayload, network.local_addr), tdh::Transform::U32},
+    {L"daddr", offsetof(EventPayload, network.remote_addr), tdh::Transform::U32},
+});
+
+}  // namespace
 
 ParsedEvent convert_tdh_to_network(
     const TdhParsedEvent& tdh_event,
     const EVENT_RECORD* record,
-    event::StringPool* /*strings*/
+    event::StringPool* strings
 ) {
     ParsedEvent result{};
     extract_common(record, result, event::Category::Network);
@@ -40,12 +52,8 @@ ParsedEvent convert_tdh_to_network(
             return result;
     }
     
-    result.payload.network.local_port = static_cast<uint16_t>(
-        get_uint32_prop(tdh_event, L"sport"));
-    result.payload.network.remote_port = static_cast<uint16_t>(
-        get_uint32_prop(tdh_event, L"dport"));
-    result.payload.network.local_addr = get_uint32_prop(tdh_event, L"saddr");
-    result.payload.network.remote_addr = get_uint32_prop(tdh_event, L"daddr");
+    thread_local tdh::FieldMapper fields(kFields);
+    fields.apply(tdh_event, result.payload, strings);
     
     result.valid = true;
     return result;
@@ -4,13 +4,24 @@
 #ifdef _WIN32
 
 #include "exeray/etw/tdh/converters.hpp"
+#include "exeray/etw/tdh/field_table.hpp"
 #include "exeray/etw/tdh/internal.hpp"
 #include "exeray/etw/parser_utils.hpp"
 #include "exeray/event/string_pool.hpp"
 
 namespace exeray::etw {
 
-using namespace tdh::detail;
+namespace {
+
+using event::EventPayload;
+
+constexpr auto kFields = tdh::field_table<EventPayload>({
+    {L"KeyName", offsetof(EventPayload, registry.key_path), tdh::Transform::Path},
+    {L"RelativeName", offsetof(EventPayload, registry.key_path), tdh::Transform::Path},
+    {L"ValueName", offsetof(EventPayload, registry.value_name), tdh::Transform::String},
+});
+
+}  // namespace
 
 ParsedEvent convert_tdh_to_registry(
     const TdhParsedEvent& tdh_event,
@@ -31,22 +42,8 @@ ParsedEvent convert_tdh_to_registry(
             return result;
     }
     
-    std::wstring key_name = get_wstring_prop(tdh_event, L"KeyName");
-    if (key_name.empty()) {
-        key_name = get_wstring_prop(tdh_event, L"RelativeName");
-    }
-    if (!key_name.empty() && strings != nullptr) {
-        result.payload.registry.key_path = strings->intern_wide(key_name);
-    } else {
-        result.payload.registry.key_path = event::INVALID_STRING;
-    }
-    
-    std::wstring value_name = get_wstring_prop(tdh_event, L"ValueName");
-    if (!value_name.empty() && strings != nullptr) {
-        result.payload.registry.value_name = strings->intern_wide(value_name);
-    } else {
-        result.payload.registry.value_name = event::INVALID_STRING;
-    }
+    thread_local tdh::FieldMapper fields(kFields);
+    fields.apply(tdh_event, result.payload, strings);
     
     result.valid = true;
     return result;
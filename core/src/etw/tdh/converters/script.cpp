@@ -4,13 +4,23 @@
 #ifdef _WIN32
 
 #include "exeray/etw/tdh/converters.hpp"
+#include "exeray/etw/tdh/field_table.hpp"
 #include "exeray/etw/tdh/internal.hpp"
 #include "exeray/etw/parser_utils.hpp"
 #include "exeray/event/string_pool.hpp"
 
 namespace exeray::etw {
 
-using namespace tdh::detail;
+namespace {
+
+using event::EventPayload;
+
+constexpr auto kFields = tdh::field_table<EventPayload>({
+    {L"ScriptBlockText", offsetof(EventPayload, script.script_block), tdh::Transform::String},
+    {L"ContextInfo", offsetof(EventPayload, script.script_block), tdh::Transform::String},
+});
+
+}  // namespace
 
 ParsedEvent convert_tdh_to_script(
     const TdhParsedEvent& tdh_event,
@@ -29,15 +39,8 @@ ParsedEvent convert_tdh_to_script(
             return result;
     }
     
-    std::wstring content = get_wstring_prop(tdh_event, L"ScriptBlockText");
-    if (content.empty()) {
-        content = get_wstring_prop(tdh_event, L"ContextInfo");
-    }
-    if (!content.empty() && strings != nullptr) {
-        result.payload.script.script_block = strings->intern_wide(content);
-    } else {
-        result.payload.script.script_block = event::INVALID_STRING;
-    }
+    thread_local tdh::FieldMapper fields(kFields);
+    fields.apply(tdh_event, result.payload, strings);
     
     result.payload.script.context = event::INVALID_STRING;
     result.payload.script.is_suspicious = 0;
@@ -4,13 +4,39 @@
 #ifdef _WIN32
 
 #include "exeray/etw/tdh/converters.hpp"
+#include "exeray/etw/tdh/field_table.hpp"
 #include "exeray/etw/tdh/internal.hpp"
 #include "exeray/etw/parser_utils.hpp"
 #include "exeray/event/string_pool.hpp"
 
 namespace exeray::etw {
 
-using namespace tdh::detail;
+namespace {
+
+using event::EventPayload;
+
+constexpr auto kFields = tdh::field_table<EventPayload>({
+    {L"SubjectUserName", offsetof(EventPayload, security.subject_user), tdh::Transform::String},
+    {L"TargetUserName", offsetof(EventPayload, security.target_user), tdh::Transform::String},
+    {L"CommandLine", offsetof(EventPayload, security.command_line), tdh::Transform::String},
+    {L"LogonType", offsetof(EventPayload, security.logon_type), tdh::Transform::U32},
+    {L"NewProcessId", offsetof(EventPayload, security.process_id), tdh::Transform::U32},
+});
+
+/// Logon session fields, which live beside the payload.
+struct LogonFields {
+    uint64_t logon_id = 0;
+    event::StringId source = event::INVALID_STRING;
+};
+
+// The session a logon opens or a logoff ends, else the actor's
+constexpr auto kLogonFields = tdh::field_table<LogonFields>({
+    {L"TargetLogonId", offsetof(LogonFields, logon_id), tdh::Transform::U64},
+    {L"SubjectLogonId", offsetof(LogonFields, logon_id), tdh::Transform::U64},
+    {L"IpAddress", offsetof(LogonFields, source), tdh::Transform::LogString},
+});
+
+}  // namespace
 
 ParsedEvent convert_tdh_to_security(
     const TdhParsedEvent& tdh_event,
@@ -30,6 +56,10 @@ ParsedEvent convert_tdh_to_security(
             result.operation = static_cast<uint8_t>(event::SecurityOp::LogonFailed);
             result.status = event::Status::Error;
             break;
+        case 4634:
+            result.category = event::Category::Security;
+            result.operation = static_cast<uint8_t>(event::SecurityOp::Logoff);
+            break;
         case 4688:
             result.category = event::Category::Security;
             result.operation = static_cast<uint8_t>(event::SecurityOp::ProcessCreate);
@@ -52,31 +82,16 @@ ParsedEvent convert_tdh_to_security(
             return result;
     }
     
-    std::wstring subject = get_wstring_prop(tdh_event, L"SubjectUserName");
-    if (!subject.empty() && strings != nullptr) {
-        result.payload.security.subject_user = strings->intern_wide(subject);
-    } else {
-        result.payload.security.subject_user = event::INVALID_STRING;
-    }
-    
-    std::wstring target = get_wstring_prop(tdh_event, L"TargetUserName");
-    if (!target.empty() && strings != nullptr) {
-        result.payload.security.target_user = strings->intern_wide(target);
-    } else {
-        result.payload.security.target_user = event::INVALID_STRING;
-    }
-    
-    std::wstring cmd = get_wstring_prop(tdh_event, L"CommandLine");
-    if (!cmd.empty() && strings != nullptr) {
-        result.payload.security.command_line = strings->intern_wide(cmd);
-    } else {
-        result.payload.security.command_line = event::INVALID_STRING;
-    }
-    
-    result.payload.security.logon_type = get_uint32_prop(tdh_event, L"LogonType");
-    result.payload.security.process_id = get_uint32_prop(tdh_event, L"NewProcessId");
+    thread_local tdh::FieldMapper fields(kFields);
+    fields.apply(tdh_event, result.payload, strings);
     result.payload.security.is_suspicious = 0;
     
+    thread_local tdh::FieldMapper logon_fields(kLogonFields);
+    LogonFields logon{.logon_id = result.logon_id, .source = result.logon_source};
+    logon_fields.apply(tdh_event, logon, strings);
+    result.logon_id = logon.logon_id;
+    result.logon_source = logon.source;
+    
     result.valid = true;
     return result;
 }
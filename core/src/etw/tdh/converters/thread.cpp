@@ -4,17 +4,30 @@
 #ifdef _WIN32
 
 #include "exeray/etw/tdh/converters.hpp"
+#include "exeray/etw/tdh/field_table.hpp"
 #include "exeray/etw/tdh/internal.hpp"
 #include "exeray/etw/parser_utils.hpp"
 
 namespace exeray::etw {
 
-using namespace tdh::detail;
+namespace {
+
+using event::EventPayload;
+
+constexpr auto kFields = tdh::field_table<EventPayload>({
+    {L"TThreadId", offsetof(EventPayload, thread.thread_id), tdh::Transform::U32},
+    {L"ThreadId", offsetof(EventPayload, thread.thread_id), tdh::Transform::U32},
+    {L"ProcessId", offsetof(EventPayload, thread.process_id), tdh::Transform::U32},
+    {L"StackProcess", offsetof(EventPayload, thread.creator_pid), tdh::Transform::U32},
+    {L"Win32StartAddr", offsetof(EventPayload, thread.start_address), tdh::Transform::U64},
+});
+
+}  // namespace
 
 ParsedEvent convert_tdh_to_thread(
     const TdhParsedEvent& tdh_event,
     const EVENT_RECORD* record,
-    event::StringPool* /*strings*/
+    event::StringPool* strings
 ) {
     ParsedEvent result{};
     extract_common(record, result, event::Category::Thread);
@@ -30,13 +43,8 @@ ParsedEvent convert_tdh_to_thread(
             return result;
     }
     
-    result.payload.thread.thread_id = get_uint32_prop(tdh_event, L"TThreadId");
-    if (result.payload.thread.thread_id == 0) {
-        result.payload.thread.thread_id = get_uint32_prop(tdh_event, L"ThreadId");
-    }
-    result.payload.thread.process_id = get_uint32_prop(tdh_event, L"ProcessId");
-    result.payload.thread.creator_pid = get_uint32_prop(tdh_event, L"StackProcess");
-    result.payload.thread.start_address = get_uint64_prop(tdh_event, L"Win32StartAddr");
+    thread_local tdh::FieldMapper fields(kFields);
+    fields.apply(tdh_event, result.payload, strings);
     
     result.payload.thread.is_remote = 
         (result.payload.thread.creator_pid != 0 &&
@@ -4,13 +4,24 @@
 #ifdef _WIN32
 
 #include "exeray/etw/tdh/converters.hpp"
+#include "exeray/etw/tdh/field_table.hpp"
 #include "exeray/etw/tdh/internal.hpp"
 #include "exeray/etw/parser_utils.hpp"
 #include "exeray/event/string_pool.hpp"
 
 namespace exeray::etw {
 
-using namespace tdh::detail;
+namespace {
+
+using event::EventPayload;
+
+constexpr auto kFields = tdh::field_table<EventPayload>({
+    {L"NamespaceName", offsetof(EventPayload, wmi.wmi_namespace), tdh::Transform::String},
+    {L"Query", offsetof(EventPayload, wmi.query), tdh::Transform::String},
+    {L"ClassName", offsetof(EventPayload, wmi.query), tdh::Transform::String},
+});
+
+}  // namespace
 
 ParsedEvent convert_tdh_to_wmi(
     const TdhParsedEvent& tdh_event,
@@ -31,25 +42,12 @@ ParsedEvent convert_tdh_to_wmi(
             return result;
     }
     
-    std::wstring ns = get_wstring_prop(tdh_event, L"NamespaceName");
-    if (!ns.empty() && strings != nullptr) {
-        result.payload.wmi.wmi_namespace = strings->intern_wide(ns);
-    } else {
-        result.payload.wmi.wmi_namespace = event::INVALID_STRING;
-    }
-    
-    std::wstring query = get_wstring_prop(tdh_event, L"Query");
-    if (query.empty()) {
-        query = get_wstring_prop(tdh_event, L"ClassName");
-    }
-    if (!query.empty() && strings != nullptr) {
-        result.payload.wmi.query = strings->intern_wide(query);
-    } else {
-        result.payload.wmi.query = event::INVALID_STRING;
-    }
+    thread_local tdh::FieldMapper fields(kFields);
+    fields.apply(tdh_event, result.payload, strings);
     
     result.payload.wmi.is_remote = false;
     result.payload.wmi.is_suspicious = (tdh_event.event_id == 22);
+    result.payload.wmi.count = 1;
     
     result.valid = true;
     return result;
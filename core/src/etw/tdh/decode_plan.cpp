@@ -0,0 +1,646 @@
+/// @file decode_plan.cpp
+/// @brief DecodePlan implementation (platform independent).
+
+#include "exeray/etw/tdh/decode_plan.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+namespace exeray::etw {
+
+std::span<wchar_t> TdhParsedEvent::text(std::size_t chars) {
+    if (kTextChars - text_used_ >= chars) {
+        const std::span<wchar_t> out(text_.data() + text_used_, chars);
+        text_used_ += chars;
+        return out;
+    }
+    std::wstring& spill = overflow_.emplace_front(chars, L'\0');
+    return {spill.data(), chars};
+}
+
+namespace tdh {
+
+namespace {
+
+template <typename T>
+T load(const std::uint8_t* p) noexcept {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+/// @brief Natural size of a fixed-size type, 0 if it has none.
+std::uint16_t fixed_size_of(InType type) noexcept {
+    switch (type) {
+        case InType::Int8:
+        case InType::UInt8:
+            return 1;
+        case InType::Int16:
+        case InType::UInt16:
+            return 2;
+        case InType::Int32:
+        case InType::UInt32:
+        case InType::HexInt32:
+        case InType::Boolean:
+        case InType::Float:
+            return 4;
+        case InType::Int64:
+        case InType::UInt64:
+        case InType::HexInt64:
+        case InType::Double:
+        case InType::FileTime:
+            return 8;
+        case InType::Guid:
+        case InType::SystemTime:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+bool is_integer(InType type) noexcept {
+    switch (type) {
+        case InType::Int8:
+        case InType::UInt8:
+        case InType::Int16:
+        case InType::UInt16:
+        case InType::Int32:
+        case InType::UInt32:
+        case InType::HexInt32:
+        case InType::Int64:
+        case InType::UInt64:
+        case InType::HexInt64:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/// @brief Widen ASCII text into the event's text storage.
+std::wstring_view widen(TdhParsedEvent& out, const char* text, std::size_t chars) {
+    const std::span<wchar_t> buffer = out.text(chars);
+    for (std::size_t i = 0; i < chars; ++i) {
+        buffer[i] = static_cast<wchar_t>(static_cast<unsigned char>(text[i]));
+    }
+    return {buffer.data(), buffer.size()};
+}
+
+/// @brief UTF-16 text of up to units characters (up to a NUL).
+///
+/// Viewed in place where wchar_t is UTF-16 and the data is aligned,
+/// copied into the event otherwise.
+std::wstring_view utf16_of(TdhParsedEvent& out, const std::uint8_t* p, std::size_t units) {
+    std::size_t length = 0;
+    while (length < units && load<std::uint16_t>(p + length * 2) != 0) {
+        ++length;
+    }
+    if constexpr (sizeof(wchar_t) == sizeof(std::uint16_t)) {
+        if (reinterpret_cast<std::uintptr_t>(p) % alignof(wchar_t) == 0) {
+            return {reinterpret_cast<const wchar_t*>(p), length};
+        }
+    }
+    const std::span<wchar_t> buffer = out.text(length);
+    for (std::size_t i = 0; i < length; ++i) {
+        buffer[i] = static_cast<wchar_t>(load<std::uint16_t>(p + i * 2));
+    }
+    return {buffer.data(), buffer.size()};
+}
+
+std::wstring_view ansi_of(TdhParsedEvent& out, const std::uint8_t* p, std::size_t chars) {
+    std::size_t length = 0;
+    while (length < chars && p[length] != 0) {
+        ++length;
+    }
+    return widen(out, reinterpret_cast<const char*>(p), length);
+}
+
+/// @brief GUID as TDH formats it: {XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX}.
+std::wstring_view guid_of(TdhParsedEvent& out, const std::uint8_t* p) {
+    char text[40];
+    const int length = std::snprintf(
+        text, sizeof(text), "{%08X-%04X-%04X-%02X%02X-%02X%02X%02X%02X%02X%02X}",
+        static_cast<unsigned>(load<std::uint32_t>(p)),
+        static_cast<unsigned>(load<std::uint16_t>(p + 4)),
+        static_cast<unsigned>(load<std::uint16_t>(p + 6)),
+        p[8], p[9], p[10], p[11], p[12], p[13], p[14], p[15]);
+    return widen(out, text, static_cast<std::size_t>(length));
+}
+
+/// @brief SID as ConvertSidToStringSid formats it: S-1-5-21-...
+std::wstring_view sid_of(TdhParsedEvent& out, const std::uint8_t* p) {
+    std::uint64_t authority = 0;
+    for (int i = 2; i < 8; ++i) {
+        authority = (authority << 8) | p[i];
+    }
+    // Revision and authority, then up to 255 sub-authorities of 10 digits
+    char text[32 + 255 * 11];
+    int length = 0;
+    if (authority >> 32 == 0) {
+        length = std::snprintf(text, sizeof(text), "S-%u-%llu", static_cast<unsigned>(p[0]),
+                               static_cast<unsigned long long>(authority));
+    } else {
+        length = std::snprintf(text, sizeof(text), "S-%u-0x%012llX",
+                               static_cast<unsigned>(p[0]),
+                               static_cast<unsigned long long>(authority));
+    }
+    for (std::uint8_t i = 0; i < p[1]; ++i) {
+        length += std::snprintf(text + length, sizeof(text) - static_cast<std::size_t>(length),
+                                "-%u", static_cast<unsigned>(load<std::uint32_t>(p + 8 + i * 4)));
+    }
+    return widen(out, text, static_cast<std::size_t>(length));
+}
+
+/// @brief Bytes of a SID at p, 0 if fewer than available.
+std::size_t sid_size(const std::uint8_t* p, std::size_t available) noexcept {
+    if (available < 8) {
+        return 0;
+    }
+    const std::size_t size = 8 + std::size_t{p[1]} * 4;
+    return size <= available ? size : 0;
+}
+
+/// @brief Integer value of a decoded property (for length rules).
+std::uint64_t integer_of(const TdhPropertyValue* value) noexcept {
+    if (value == nullptr) {
+        return 0;
+    }
+    if (const auto* v = std::get_if<std::uint64_t>(value)) {
+        return *v;
+    }
+    if (const auto* v = std::get_if<std::uint32_t>(value)) {
+        return *v;
+    }
+    if (const auto* v = std::get_if<std::int32_t>(value)) {
+        return *v < 0 ? 0 : static_cast<std::uint64_t>(*v);
+    }
+    return 0;
+}
+
+/// @brief Value of a fixed-size or pointer field of size bytes at p.
+TdhPropertyValue value_of(TdhParsedEvent& out, InType type, const std::uint8_t* p,
+                          std::size_t size) {
+    switch (type) {
+        case InType::Int8:
+            return static_cast<std::int32_t>(load<std::int8_t>(p));
+        case InType::Int16:
+            return static_cast<std::int32_t>(load<std::int16_t>(p));
+        case InType::Int32:
+            return load<std::int32_t>(p);
+        case InType::UInt8:
+            return static_cast<std::uint32_t>(p[0]);
+        case InType::UInt16:
+            return static_cast<std::uint32_t>(load<std::uint16_t>(p));
+        case InType::UInt32:
+        case InType::HexInt32:
+        case InType::Boolean:
+            return load<std::uint32_t>(p);
+        case InType::Int64:
+        case InType::UInt64:
+        case InType::HexInt64:
+        case InType::FileTime:
+            return load<std::uint64_t>(p);
+        case InType::Pointer:
+            return size == 4 ? std::uint64_t{load<std::uint32_t>(p)} : load<std::uint64_t>(p);
+        case InType::Guid:
+            return guid_of(out, p);
+        case InType::UnicodeString:
+            return utf16_of(out, p, size / 2);
+        case InType::AnsiString:
+            return ansi_of(out, p, size);
+        default:
+            return std::span<const std::uint8_t>(p, size);
+    }
+}
+
+}  // namespace
+
+std::optional<DecodePlan> DecodePlan::compile(std::span<const PropertySchema> properties,
+                                              std::size_t top_level) {
+    constexpr std::uint16_t kNone = PropertySchema::kNoProperty;
+    if (properties.size() > TdhParsedEvent::kMaxProperties) {
+        return std::nullopt;
+    }
+    DecodePlan plan;
+    plan.top_level_ = (std::min)(top_level, properties.size());
+    plan.fields_.resize(properties.size());
+    for (std::size_t i = 0; i < properties.size(); ++i) {
+        plan.fields_[i].name = properties[i].name;
+    }
+
+    // Visit the properties in decode order: top level, struct members in
+    // place. A length or count has to come from an integer decoded before
+    // and stored, i.e. not inside an array element.
+    enum class Seen : std::uint8_t { No, Stored, InArray };
+    std::vector<Seen> seen(properties.size(), Seen::No);
+    std::vector<std::size_t> order;  // Decode order, members after their struct
+    const auto source_ok = [&](std::size_t source) {
+        return source < properties.size() && seen[source] == Seen::Stored &&
+               !plan.fields_[source].array() && is_integer(plan.fields_[source].type);
+    };
+    const auto visit = [&](auto& self, std::size_t i, bool in_array) -> bool {
+        if (seen[i] != Seen::No) {
+            return false;  // Member of two structs
+        }
+        const PropertySchema& property = properties[i];
+        Field& field = plan.fields_[i];
+        if (property.count_property != kNone) {
+            if (!source_ok(property.count_property)) {
+                return false;
+            }
+            field.count_of = property.count_property;
+        } else {
+            field.count = property.count;
+        }
+        seen[i] = in_array ? Seen::InArray : Seen::Stored;
+        order.push_back(i);
+
+        if (property.struct_members != 0) {
+            const std::size_t first = property.struct_start;
+            if (first <= i || first + property.struct_members > properties.size()) {
+                return false;
+            }
+            field.type = static_cast<InType>(0);
+            field.rule = Rule::Struct;
+            field.first_member = property.struct_start;
+            field.members = property.struct_members;
+            for (std::size_t m = first; m < first + property.struct_members; ++m) {
+                if (!self(self, m, in_array || field.array())) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        field.type = static_cast<InType>(property.in_type);
+        if (property.length_property != kNone) {
+            if (!source_ok(property.length_property)) {
+                return false;
+            }
+            switch (field.type) {
+                case InType::UnicodeString:
+                case InType::AnsiString:
+                case InType::Binary:
+                    field.rule = Rule::FromField;
+                    field.length_of = property.length_property;
+                    return true;
+                default:
+                    return false;
+            }
+        }
+        if (const std::uint16_t natural = fixed_size_of(field.type); natural != 0) {
+            if (property.length != 0 && property.length != natural) {
+                return false;
+            }
+            field.rule = Rule::Fixed;
+            field.size = natural;
+            return true;
+        }
+        switch (field.type) {
+            case InType::Pointer:
+                field.rule = Rule::Pointer;
+                return true;
+            case InType::UnicodeString:
+                field.rule = property.length != 0 ? Rule::Fixed : Rule::Utf16Z;
+                field.size = static_cast<std::uint16_t>(property.length * 2);
+                return true;
+            case InType::AnsiString:
+                field.rule = property.length != 0 ? Rule::Fixed : Rule::AnsiZ;
+                field.size = property.length;
+                return true;
+            case InType::Binary:
+                field.rule = Rule::Fixed;
+                field.size = property.length;
+                return property.length != 0;
+            case InType::CountedString:
+                field.rule = Rule::Counted;
+                return true;
+            case InType::Sid:
+                field.rule = Rule::Sid;
+                return true;
+            case InType::WbemSid:
+                field.rule = Rule::WbemSid;
+                return true;
+            default:
+                return false;
+        }
+    };
+    for (std::size_t i = 0; i < plan.top_level_; ++i) {
+        if (!visit(visit, i, false)) {
+            return std::nullopt;
+        }
+    }
+
+    // Element sizes, members before the structs holding them
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        Field& field = plan.fields_[*it];
+        for (std::size_t ps = 0; ps < 2; ++ps) {
+            std::size_t size = kVariable;
+            switch (field.rule) {
+                case Rule::Fixed:
+                    size = field.size;
+                    break;
+                case Rule::Pointer:
+                    size = ps == 0 ? 4 : 8;
+                    break;
+                case Rule::Struct:
+                    size = 0;
+                    for (std::size_t m = 0; m < field.members && size < kVariable; ++m) {
+                        size += plan.total_size(plan.fields_[field.first_member + m], ps);
+                    }
+                    break;
+                default:
+                    break;
+            }
+            field.element[ps] = static_cast<std::uint16_t>((std::min)(size, std::size_t{kVariable}));
+        }
+    }
+
+    // Offsets are known up to the first variable-length field
+    for (std::size_t i = 0; i < plan.top_level_; ++i) {
+        const Field& field = plan.fields_[i];
+        const std::size_t size4 = plan.total_size(field, 0);
+        const std::size_t size8 = plan.total_size(field, 1);
+        if (size4 == kVariable || size8 == kVariable ||
+            plan.fixed_size_[1] + size8 >= kVariable) {
+            break;
+        }
+        plan.fields_[i].offset = {static_cast<std::uint16_t>(plan.fixed_size_[0]),
+                                  static_cast<std::uint16_t>(plan.fixed_size_[1])};
+        plan.fixed_size_[0] += size4;
+        plan.fixed_size_[1] += size8;
+        ++plan.fixed_fields_;
+    }
+    return plan;
+}
+
+std::size_t DecodePlan::total_size(const Field& field, std::size_t ps) const noexcept {
+    if (field.element[ps] == kVariable || field.count_of != PropertySchema::kNoProperty) {
+        return kVariable;
+    }
+    return std::size_t{field.element[ps]} * field.count;
+}
+
+bool DecodePlan::decode(std::span<const std::uint8_t> data, unsigned pointer_size,
+                        TdhParsedEvent& out) const {
+    const std::size_t ps = pointer_size == 4 ? 0 : 1;
+    const std::size_t base = out.size();
+
+    // One entry per property up front, so that ordinals match the schema
+    // even when the data ends early
+    for (const Field& field : fields_) {
+        out.push(field.name, std::monostate{});
+    }
+
+    // Fixed prefix: one bounds check, then straight loads
+    std::size_t i = 0;
+    std::size_t pos = 0;
+    if (data.size() >= fixed_size_[ps]) {
+        for (; i < fixed_fields_; ++i) {
+            const Field& field = fields_[i];
+            std::size_t at = field.offset[ps];
+            if (!field.array() && field.rule != Rule::Struct) {
+                out.set(base + i, value_of(out, field.type, data.data() + at, field.element[ps]));
+            } else {
+                read(i, data, at, ps, base, out, true);
+            }
+        }
+        pos = fixed_size_[ps];
+    }
+
+    for (; i < top_level_; ++i) {
+        if (!read(i, data, pos, ps, base, out, true)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DecodePlan::read(std::size_t index, std::span<const std::uint8_t> data,
+                      std::size_t& pos, std::size_t ps, std::size_t base,
+                      TdhParsedEvent& out, bool store) const {
+    const Field& field = fields_[index];
+    if (!field.array()) {
+        return read_element(index, data, pos, ps, base, out, store);
+    }
+
+    const std::uint64_t count = field.count_of != PropertySchema::kNoProperty
+        ? integer_of(out.at(base + field.count_of))
+        : field.count;
+    const std::size_t start = pos;
+    const std::uint16_t element = field.element[ps];
+    if (element != kVariable) {
+        if (element != 0 && count > (data.size() - pos) / element) {
+            return false;
+        }
+        pos += static_cast<std::size_t>(count) * element;
+    } else {
+        // Members of array elements are not stored: one value per ordinal
+        for (std::uint64_t k = 0; k < count; ++k) {
+            const std::size_t before = pos;
+            if (!read_element(index, data, pos, ps, base, out, false)) {
+                return false;
+            }
+            if (pos == before) {
+                break;  // Empty elements: the others are empty too
+            }
+        }
+    }
+    if (store) {
+        out.set(base + index,
+                TdhArray{data.subspan(start, pos - start),
+                         static_cast<std::uint32_t>((std::min)(count, std::uint64_t{UINT32_MAX})),
+                         static_cast<std::uint16_t>(element != kVariable ? element : 0),
+                         static_cast<std::uint16_t>(field.type)});
+    }
+    return true;
+}
+
+bool DecodePlan::read_element(std::size_t index, std::span<const std::uint8_t> data,
+                              std::size_t& pos, std::size_t ps, std::size_t base,
+                              TdhParsedEvent& out, bool store) const {
+    const Field& field = fields_[index];
+    const std::size_t pointer = ps == 0 ? 4 : 8;
+    const std::size_t available = data.size() - pos;
+    const std::uint8_t* p = data.data() + pos;
+    TdhPropertyValue value;
+
+    switch (field.rule) {
+        case Rule::Fixed:
+        case Rule::Pointer: {
+            const std::size_t size = field.rule == Rule::Pointer ? pointer : field.size;
+            if (available < size) {
+                return false;
+            }
+            if (store) {
+                value = value_of(out, field.type, p, size);
+            }
+            pos += size;
+            break;
+        }
+        case Rule::Utf16Z: {
+            if (available < 2) {
+                return false;
+            }
+            std::size_t units = 0;
+            while ((units + 1) * 2 <= available && load<std::uint16_t>(p + units * 2) != 0) {
+                ++units;
+            }
+            if (store) {
+                value = utf16_of(out, p, units);
+            }
+            pos += (std::min)(available, (units + 1) * 2);
+            break;
+        }
+        case Rule::AnsiZ: {
+            if (available == 0) {
+                return false;
+            }
+            std::size_t chars = 0;
+            while (chars < available && p[chars] != 0) {
+                ++chars;
+            }
+            if (store) {
+                value = ansi_of(out, p, chars);
+            }
+            pos += (std::min)(available, chars + 1);
+            break;
+        }
+        case Rule::Counted: {
+            if (available < 2) {
+                return false;
+            }
+            const std::size_t bytes = load<std::uint16_t>(p);
+            if (available - 2 < bytes) {
+                return false;
+            }
+            if (store) {
+                value = utf16_of(out, p + 2, bytes / 2);
+            }
+            pos += 2 + bytes;
+            break;
+        }
+        case Rule::Sid:
+        case Rule::WbemSid: {
+            const std::size_t skip = field.rule == Rule::WbemSid ? 2 * pointer : 0;
+            const std::size_t size =
+                available < skip ? 0 : sid_size(p + skip, available - skip);
+            if (size == 0) {
+                return false;
+            }
+            if (store) {
+                value = sid_of(out, p + skip);
+            }
+            pos += skip + size;
+            break;
+        }
+        case Rule::FromField: {
+            const std::uint64_t count = integer_of(out.at(base + field.length_of));
+            const std::uint64_t bytes =
+                field.type == InType::UnicodeString ? count * 2 : count;
+            if (bytes > available) {
+                return false;
+            }
+            const auto size = static_cast<std::size_t>(bytes);
+            if (store) {
+                value = value_of(out, field.type, p, size);
+            }
+            pos += size;
+            break;
+        }
+        case Rule::Struct: {
+            const std::size_t start = pos;
+            for (std::size_t m = 0; m < field.members; ++m) {
+                if (!read(field.first_member + m, data, pos, ps, base, out, store)) {
+                    return false;
+                }
+            }
+            if (store) {
+                value = data.subspan(start, pos - start);
+            }
+            break;
+        }
+    }
+    if (store) {
+        out.set(base + index, value);
+    }
+    return true;
+}
+
+std::optional<TdhPropertyValue> decode_value(InType type, std::size_t length,
+                                             unsigned pointer_size,
+                                             std::span<const std::uint8_t> data,
+                                             TdhParsedEvent& out, std::size_t& consumed) {
+    const std::uint8_t* p = data.data();
+    std::size_t size = 0;
+    switch (type) {
+        case InType::Int8:
+        case InType::UInt8:
+        case InType::Int16:
+        case InType::UInt16:
+        case InType::Int32:
+        case InType::UInt32:
+        case InType::HexInt32:
+        case InType::Boolean:
+        case InType::Int64:
+        case InType::UInt64:
+        case InType::HexInt64:
+        case InType::FileTime:
+        case InType::Guid:
+            size = fixed_size_of(type);
+            if (length != 0 && length != size) {
+                return std::nullopt;
+            }
+            break;
+        case InType::Pointer:
+            size = pointer_size == 4 ? 4 : 8;
+            break;
+        case InType::Binary:
+            size = length;
+            break;
+        case InType::UnicodeString:
+            if (length != 0) {
+                size = length * 2;
+                break;
+            }
+            if (data.size() < 2) {
+                return std::nullopt;
+            }
+            while ((size + 1) * 2 <= data.size() && load<std::uint16_t>(p + size * 2) != 0) {
+                ++size;
+            }
+            consumed = (std::min)(data.size(), (size + 1) * 2);
+            return utf16_of(out, p, size);
+        case InType::AnsiString:
+            if (length != 0) {
+                size = length;
+                break;
+            }
+            if (data.empty()) {
+                return std::nullopt;
+            }
+            while (size < data.size() && p[size] != 0) {
+                ++size;
+            }
+            consumed = (std::min)(data.size(), size + 1);
+            return ansi_of(out, p, size);
+        case InType::Sid:
+            size = sid_size(p, data.size());
+            if (size == 0) {
+                return std::nullopt;
+            }
+            consumed = size;
+            return sid_of(out, p);
+        default:
+            return std::nullopt;
+    }
+    if (size == 0 || data.size() < size) {
+        return std::nullopt;
+    }
+    consumed = size;
+    return value_of(out, type, p, size);
+}
+
+}  // namespace tdh
+}  // namespace exeray::etw
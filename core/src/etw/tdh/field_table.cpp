@@ -0,0 +1,82 @@
+/// @file field_table.cpp
+/// @brief The copy loop behind FieldTable.
+
+#include "exeray/etw/tdh/field_table.hpp"
+#include "exeray/event/string_pool.hpp"
+
+#include <cstring>
+#include <variant>
+
+namespace exeray::etw::tdh {
+
+namespace {
+
+/// @brief Integer value (0 if missing or not an integer).
+std::uint64_t integer(const TdhPropertyValue& value) noexcept {
+    if (const auto* val = std::get_if<std::uint64_t>(&value)) {
+        return *val;
+    }
+    if (const auto* val = std::get_if<std::uint32_t>(&value)) {
+        return *val;
+    }
+    if (const auto* val = std::get_if<std::int32_t>(&value)) {
+        return static_cast<std::uint32_t>(*val);
+    }
+    return 0;
+}
+
+template <typename V>
+void store(std::byte* field, V value) noexcept {
+    std::memcpy(field, &value, sizeof(value));
+}
+
+}  // namespace
+
+void copy_fields(std::span<const FieldDescriptor> rows,
+                 std::span<const std::uint16_t> ordinals,
+                 std::span<const std::uint8_t> alternative, const TdhParsedEvent& event,
+                 std::byte* target, event::StringPool* strings) {
+    std::uint64_t filled = 0;  // Bit per first alternative
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        const std::uint64_t bit = std::uint64_t{1} << alternative[i];
+        const TdhPropertyValue* value = event.at(ordinals[i]);
+        if ((filled & bit) != 0 || value == nullptr) {
+            continue;
+        }
+        const FieldDescriptor& row = rows[i];
+        std::byte* field = target + row.offset;
+        switch (row.transform) {
+            case Transform::U16:
+            case Transform::U32:
+            case Transform::U64: {
+                const std::uint64_t number = integer(*value);
+                if (number == 0) {
+                    continue;
+                }
+                if (row.transform == Transform::U16) {
+                    store(field, static_cast<std::uint16_t>(number));
+                } else if (row.transform == Transform::U32) {
+                    store(field, static_cast<std::uint32_t>(number));
+                } else {
+                    store(field, number);
+                }
+                break;
+            }
+            case Transform::String:
+            case Transform::Path:
+            case Transform::LogString: {
+                const auto* text = std::get_if<std::wstring_view>(value);
+                if (text == nullptr || text->empty() || strings == nullptr ||
+                    (row.transform == Transform::LogString && *text == L"-")) {
+                    continue;
+                }
+                store(field, row.transform == Transform::Path ? strings->intern_path_wide(*text)
+                                                              : strings->intern_wide(*text));
+                break;
+            }
+        }
+        filled |= bit;
+    }
+}
+
+}  // namespace exeray::etw::tdh
@@ -7,6 +7,8 @@
 #include "exeray/etw/tdh/internal.hpp"
 #include "exeray/logging.hpp"
 
+#include <optional>
+
 namespace exeray::etw {
 
 TdhSchemaCache& global_tdh_cache() {
@@ -14,49 +16,59 @@ TdhSchemaCache& global_tdh_cache() {
     return cache;
 }
 
-std::optional<TdhParsedEvent> parse_with_tdh(
+bool parse_with_tdh(
     const EVENT_RECORD* record,
+    TdhParsedEvent& out,
     TdhSchemaCache* cache
 ) {
     if (record == nullptr) {
-        return std::nullopt;
+        return false;
     }
     
     // Use provided cache or global cache
     TdhSchemaCache* actual_cache = cache ? cache : &global_tdh_cache();
-    PTRACE_EVENT_INFO info = actual_cache->get_schema(record);
+    const TdhSchema* schema = actual_cache->get(record);
     
-    if (info == nullptr) {
+    if (schema == nullptr) {
         EXERAY_TRACE("TDH: Failed to get schema for event ID {}", 
                      record->EventHeader.EventDescriptor.Id);
-        return std::nullopt;
+        return false;
     }
     
-    TdhParsedEvent result;
-    result.event_id = record->EventHeader.EventDescriptor.Id;
-    result.event_version = record->EventHeader.EventDescriptor.Version;
+    out.event_id = record->EventHeader.EventDescriptor.Id;
+    out.event_version = record->EventHeader.EventDescriptor.Version;
+    out.schema = schema->id;
+
+    // Fast path: compiled layout, no TDH calls
+    if (schema->plan) {
+        const std::span<const std::uint8_t> data(
+            static_cast<const std::uint8_t*>(record->UserData), record->UserDataLength);
+        schema->plan->decode(data, tdh::detail::get_pointer_size(record), out);
+        return true;
+    }
+
+    PTRACE_EVENT_INFO info = schema->info();
     
     // Set up user data pointers
     PBYTE user_data = static_cast<PBYTE>(record->UserData);
     ULONG user_data_length = record->UserDataLength;
     
-    // Extract all top-level properties
-    for (ULONG i = 0; i < info->TopLevelPropertyCount && user_data_length > 0; ++i) {
-        std::wstring name = tdh::detail::get_property_name(info, i);
-        if (name.empty()) {
-            continue;
-        }
-        
-        auto value = tdh::detail::extract_property(info, record, i, user_data, user_data_length);
-        if (value) {
-            result.properties[name] = std::move(*value);
+    // Extract all top-level properties; one entry each (monostate if it
+    // could not be extracted) so that ordinals match the schema
+    for (ULONG i = 0; i < info->TopLevelPropertyCount; ++i) {
+        const std::wstring_view name = tdh::detail::get_property_name(info, i);
+        std::optional<TdhPropertyValue> value;
+        if (!name.empty() && user_data_length > 0) {
+            value = tdh::detail::extract_property(info, record, i, user_data, user_data_length,
+                                                  out);
         }
+        out.push(name, value ? *value : TdhPropertyValue{});
     }
     
     EXERAY_TRACE("TDH: Parsed event ID {} with {} properties",
-                 result.event_id, result.properties.size());
+                 out.event_id, out.size());
     
-    return result;
+    return true;
 }
 
 }  // namespace exeray::etw
@@ -13,7 +13,8 @@ std::optional<TdhPropertyValue> extract_property(
     const EVENT_RECORD* record,
     ULONG property_index,
     PBYTE& user_data,
-    ULONG& user_data_length
+    ULONG& user_data_length,
+    TdhParsedEvent& event
 ) {
     if (property_index >= info->TopLevelPropertyCount) {
         return std::nullopt;
@@ -26,6 +27,28 @@ std::optional<TdhPropertyValue> extract_property(
         return std::nullopt;
     }
     
+    // Plain values are read straight from UserData; only mapped, array
+    // and unusual types go through TdhFormatProperty
+    const bool array = (prop.Flags & PropertyParamCount) != 0 || prop.count > 1;
+    std::size_t length = prop.length;
+    if (prop.Flags & PropertyParamLength) {
+        // Properties are extracted in order, so an earlier length has its
+        // value already (0 would read as NUL-terminated: left to TDH)
+        length = static_cast<std::size_t>(get_uint64_prop(event, prop.lengthPropertyIndex));
+    }
+    if (!array && prop.nonStructType.MapNameOffset == 0 &&
+        (length != 0 || (prop.Flags & PropertyParamLength) == 0)) {
+        std::size_t consumed = 0;
+        if (auto value = decode_value(
+                static_cast<InType>(prop.nonStructType.InType), length,
+                get_pointer_size(record),
+                std::span<const std::uint8_t>(user_data, user_data_length), event, consumed)) {
+            user_data += consumed;
+            user_data_length -= static_cast<ULONG>(consumed);
+            return value;
+        }
+    }
+    
     ULONG buffer_size = 0;
     USHORT consumed = 0;
     
@@ -45,7 +68,10 @@ std::optional<TdhPropertyValue> extract_property(
     );
     
     if (status == ERROR_INSUFFICIENT_BUFFER && buffer_size > 0) {
-        std::vector<WCHAR> buffer(buffer_size / sizeof(WCHAR) + 1);
+        // Format straight into the event's text storage, so that string
+        // values need no copy
+        const std::span<wchar_t> buffer = event.text(buffer_size / sizeof(WCHAR) + 1);
+        buffer.back() = L'\0';
         
         status = TdhFormatProperty(
             info,
@@ -84,47 +110,11 @@ std::optional<TdhPropertyValue> extract_property(
                 case TDH_INTYPE_COUNTEDSTRING:
                 case TDH_INTYPE_SID:
                 case TDH_INTYPE_GUID:
-                    return std::wstring(buffer.data());
+                    return std::wstring_view(buffer.data());
                     
                 default:
-                    return std::wstring(buffer.data());
-            }
-        }
-    }
-    
-    // If TdhFormatProperty fails, try raw extraction for common types
-    if (user_data_length >= 4) {
-        switch (prop.nonStructType.InType) {
-            case TDH_INTYPE_UINT32:
-            case TDH_INTYPE_HEXINT32: {
-                uint32_t val = *reinterpret_cast<uint32_t*>(user_data);
-                user_data += 4;
-                user_data_length -= 4;
-                return val;
-            }
-            case TDH_INTYPE_INT32: {
-                int32_t val = *reinterpret_cast<int32_t*>(user_data);
-                user_data += 4;
-                user_data_length -= 4;
-                return val;
-            }
-            default:
-                break;
-        }
-    }
-    
-    if (user_data_length >= 8) {
-        switch (prop.nonStructType.InType) {
-            case TDH_INTYPE_UINT64:
-            case TDH_INTYPE_HEXINT64:
-            case TDH_INTYPE_POINTER: {
-                uint64_t val = *reinterpret_cast<uint64_t*>(user_data);
-                user_data += 8;
-                user_data_length -= 8;
-                return val;
+                    return std::wstring_view(buffer.data());
             }
-            default:
-                break;
         }
     }
     
@@ -13,15 +13,15 @@ ULONG get_pointer_size(const EVENT_RECORD* record) {
     return (record->EventHeader.Flags & EVENT_HEADER_FLAG_64_BIT_HEADER) ? 8 : 4;
 }
 
-std::wstring get_property_name(PTRACE_EVENT_INFO info, ULONG property_index) {
+std::wstring_view get_property_name(PTRACE_EVENT_INFO info, ULONG property_index) {
     if (property_index >= info->TopLevelPropertyCount) {
-        return L"";
+        return {};
     }
     const auto& prop = info->EventPropertyInfoArray[property_index];
     if (prop.NameOffset == 0) {
-        return L"";
+        return {};
     }
-    return std::wstring(reinterpret_cast<PWCHAR>(
+    return std::wstring_view(reinterpret_cast<PCWSTR>(
         reinterpret_cast<PBYTE>(info) + prop.NameOffset
     ));
 }
@@ -4,11 +4,84 @@
 #ifdef _WIN32
 
 #include "exeray/etw/tdh/schema_cache.hpp"
+#include "exeray/etw/tdh/schema_file.hpp"
+#include <cstddef>
 #include <cstring>
 #include <functional>
+#include <string>
 
 namespace exeray::etw {
 
+namespace {
+
+/// Slots of a new cache; doubled whenever it gets half full.
+constexpr std::size_t kInitialSlots = 256;
+
+/// Source of TdhSchema::id, shared by all caches so ids stay unique.
+std::atomic<std::uint64_t> next_schema_id{1};
+
+/// @brief Describe every property (struct members included) for DecodePlan::compile().
+std::vector<tdh::PropertySchema> describe(PTRACE_EVENT_INFO info) {
+    std::vector<tdh::PropertySchema> properties;
+    properties.reserve(info->PropertyCount);
+    for (ULONG i = 0; i < info->PropertyCount; ++i) {
+        const auto& prop = info->EventPropertyInfoArray[i];
+        tdh::PropertySchema schema;
+        if (prop.NameOffset != 0) {
+            schema.name = reinterpret_cast<PCWSTR>(reinterpret_cast<PBYTE>(info) + prop.NameOffset);
+        }
+        if (prop.Flags & PropertyStruct) {
+            schema.struct_start = prop.structType.StructStartIndex;
+            schema.struct_members = prop.structType.NumOfStructMembers;
+        } else {
+            schema.in_type = prop.nonStructType.InType;
+            if (prop.Flags & PropertyParamLength) {
+                schema.length_property = prop.lengthPropertyIndex;
+            } else {
+                schema.length = prop.length;
+            }
+        }
+        if (prop.Flags & PropertyParamCount) {
+            schema.count_property = prop.countPropertyIndex;
+        } else {
+            schema.count = prop.count;
+        }
+        properties.push_back(std::move(schema));
+    }
+    return properties;
+}
+
+/// @brief Check that a TRACE_EVENT_INFO from a file stays inside its buffer.
+bool valid_info(const std::vector<BYTE>& buffer) {
+    if (buffer.size() < sizeof(TRACE_EVENT_INFO)) {
+        return false;
+    }
+    const auto* info = reinterpret_cast<const TRACE_EVENT_INFO*>(buffer.data());
+    const std::size_t properties_end = offsetof(TRACE_EVENT_INFO, EventPropertyInfoArray) +
+        std::size_t{info->PropertyCount} * sizeof(EVENT_PROPERTY_INFO);
+    if (info->TopLevelPropertyCount > info->PropertyCount || properties_end > buffer.size()) {
+        return false;
+    }
+    // Names are read up to their NUL, so each has to end inside the buffer
+    for (ULONG i = 0; i < info->PropertyCount; ++i) {
+        std::size_t offset = info->EventPropertyInfoArray[i].NameOffset;
+        if (offset == 0) {
+            continue;
+        }
+        for (;; offset += sizeof(WCHAR)) {
+            if (offset + sizeof(WCHAR) > buffer.size()) {
+                return false;
+            }
+            if (buffer[offset] == 0 && buffer[offset + 1] == 0) {
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
 bool TdhSchemaCache::EventKey::operator==(const EventKey& other) const {
     return event_id == other.event_id &&
            event_version == other.event_version &&
@@ -21,29 +94,46 @@ size_t TdhSchemaCache::EventKeyHash::operator()(const EventKey& key) const {
     h ^= std::hash<uint16_t>{}(key.provider_guid.Data3) << 2;
     h ^= std::hash<uint16_t>{}(key.event_id) << 3;
     h ^= std::hash<uint8_t>{}(key.event_version) << 4;
-    return h;
+    // Spread into the low bits used as the slot index
+    return static_cast<size_t>(static_cast<uint64_t>(h) * 0x9E3779B97F4A7C15ULL >> 32);
 }
 
-PTRACE_EVENT_INFO TdhSchemaCache::get_schema(const EVENT_RECORD* record) {
-    if (record == nullptr) {
-        return nullptr;
+TdhSchemaCache::Table::Table(std::size_t slot_count)
+    : mask(slot_count - 1),
+      slots(std::make_unique<std::atomic<const Entry*>[]>(slot_count)) {}
+
+TdhSchemaCache::TdhSchemaCache() {
+    tables_.push_back(std::make_unique<Table>(kInitialSlots));
+    table_.store(tables_.back().get(), std::memory_order_release);
+}
+
+TdhSchemaCache::~TdhSchemaCache() = default;
+
+const TdhSchemaCache::Entry* TdhSchemaCache::find(const EventKey& key) const noexcept {
+    const Table* table = table_.load(std::memory_order_acquire);
+    for (std::size_t probe = 0, pos = EventKeyHash{}(key) & table->mask; probe <= table->mask;
+         ++probe, pos = (pos + 1) & table->mask) {
+        const Entry* entry = table->slots[pos].load(std::memory_order_acquire);
+        if (entry == nullptr) {
+            return nullptr;
+        }
+        if (entry->key == key) {
+            return entry;
+        }
     }
-    
-    EventKey key{
-        record->EventHeader.ProviderId,
-        record->EventHeader.EventDescriptor.Id,
-        record->EventHeader.EventDescriptor.Version
-    };
-    
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    // Check cache first
-    auto it = cache_.find(key);
-    if (it != cache_.end()) {
-        return reinterpret_cast<PTRACE_EVENT_INFO>(it->second.data());
+    return nullptr;
+}
+
+void TdhSchemaCache::place(Table& table, const Entry* entry) noexcept {
+    std::size_t pos = EventKeyHash{}(entry->key) & table.mask;
+    while (table.slots[pos].load(std::memory_order_relaxed) != nullptr) {
+        pos = (pos + 1) & table.mask;
     }
-    
-    // Not in cache, fetch from TDH
+    table.slots[pos].store(entry, std::memory_order_release);
+}
+
+std::unique_ptr<TdhSchemaCache::Entry> TdhSchemaCache::fetch(const EVENT_RECORD* record,
+                                                             const EventKey& key) {
     ULONG buffer_size = 0;
     ULONG status = TdhGetEventInformation(
         const_cast<PEVENT_RECORD>(record),
@@ -67,20 +157,165 @@ PTRACE_EVENT_INFO TdhSchemaCache::get_schema(const EVENT_RECORD* record) {
     if (status != ERROR_SUCCESS) {
         return nullptr;
     }
+    return make_entry(key, std::move(buffer));
+}
+
+std::unique_ptr<TdhSchemaCache::Entry> TdhSchemaCache::make_entry(const EventKey& key,
+                                                                  std::vector<BYTE> buffer) {
+    // Compile in place, so that the names the plan hands out point at its
+    // final location
+    auto entry = std::make_unique<Entry>(Entry{
+        key, TdhSchema{std::move(buffer), std::nullopt,
+                       next_schema_id.fetch_add(1, std::memory_order_relaxed)}});
+    const PTRACE_EVENT_INFO info = entry->schema.info();
+    const auto properties = describe(info);
+    entry->schema.plan = tdh::DecodePlan::compile(properties, info->TopLevelPropertyCount);
+    return entry;
+}
+
+PTRACE_EVENT_INFO TdhSchemaCache::get_schema(const EVENT_RECORD* record) {
+    const TdhSchema* schema = get(record);
+    return schema != nullptr ? schema->info() : nullptr;
+}
+
+const TdhSchema* TdhSchemaCache::get(const EVENT_RECORD* record) {
+    if (record == nullptr) {
+        return nullptr;
+    }
     
-    // Store in cache and return
-    auto [insert_it, inserted] = cache_.emplace(key, std::move(buffer));
-    return reinterpret_cast<PTRACE_EVENT_INFO>(insert_it->second.data());
+    EventKey key{
+        record->EventHeader.ProviderId,
+        record->EventHeader.EventDescriptor.Id,
+        record->EventHeader.EventDescriptor.Version
+    };
+    
+    // Check cache first
+    if (const Entry* entry = find(key)) {
+        return &entry->schema;
+    }
+    
+    // Not in cache: fetch from TDH without holding up other lookups
+    std::unique_ptr<Entry> fresh = fetch(record, key);
+    if (!fresh) {
+        return nullptr;
+    }
+    return &insert(std::move(fresh))->schema;
+}
+
+const TdhSchemaCache::Entry* TdhSchemaCache::insert(std::unique_ptr<Entry> fresh) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (const Entry* entry = find(fresh->key)) {
+        return entry;  // Another thread inserted it meanwhile
+    }
+
+    Table* table = table_.load(std::memory_order_relaxed);
+    const std::size_t count = count_.load(std::memory_order_relaxed) + 1;
+    if (count * 2 > table->mask + 1) {
+        auto next = std::make_unique<Table>((table->mask + 1) * 2);
+        for (const auto& entry : entries_) {
+            place(*next, entry.get());
+        }
+        table = next.get();
+        tables_.push_back(std::move(next));
+        table_.store(table, std::memory_order_release);
+    }
+
+    const Entry* entry = fresh.get();
+    entries_.push_back(std::move(fresh));
+    place(*table, entry);
+    count_.store(count, std::memory_order_relaxed);
+    return entry;
 }
 
 void TdhSchemaCache::clear() {
     std::lock_guard<std::mutex> lock(mutex_);
-    cache_.clear();
+    auto fresh = std::make_unique<Table>(kInitialSlots);
+    table_.store(fresh.get(), std::memory_order_release);
+    tables_.clear();
+    tables_.push_back(std::move(fresh));
+    entries_.clear();
+    count_.store(0, std::memory_order_relaxed);
 }
 
 size_t TdhSchemaCache::size() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return cache_.size();
+    return count_.load(std::memory_order_relaxed);
+}
+
+std::size_t TdhSchemaCache::load(const std::filesystem::path& path) {
+    auto records = tdh::read_schema_file(path, tdh::os_fingerprint());
+    if (!records) {
+        return 0;
+    }
+    std::size_t added = 0;
+    for (tdh::SchemaRecord& record : *records) {
+        if (!valid_info(record.info)) {
+            continue;
+        }
+        const EventKey key{record.provider, record.event_id, record.event_version};
+        if (find(key) != nullptr) {
+            continue;
+        }
+        std::unique_ptr<Entry> fresh = make_entry(key, std::move(record.info));
+        const Entry* candidate = fresh.get();
+        if (insert(std::move(fresh)) == candidate) {
+            ++added;
+        }
+    }
+    return added;
+}
+
+bool TdhSchemaCache::save(const std::filesystem::path& path) {
+    std::vector<tdh::SchemaRecord> records;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        records.reserve(entries_.size());
+        for (const auto& entry : entries_) {
+            records.push_back({entry->key.provider_guid, entry->key.event_id,
+                               entry->key.event_version, entry->schema.buffer});
+        }
+    }
+    return tdh::write_schema_file(path, records, tdh::os_fingerprint());
+}
+
+std::size_t TdhSchemaCache::prewarm(const GUID& provider) {
+    GUID guid = provider;
+    ULONG size = 0;
+    ULONG status = TdhEnumerateManifestProviderEvents(&guid, nullptr, &size);
+    if (status != ERROR_INSUFFICIENT_BUFFER || size == 0) {
+        return 0;  // No manifest (MOF or TraceLogging provider)
+    }
+    std::vector<BYTE> buffer(size);
+    auto* events = reinterpret_cast<PPROVIDER_EVENT_INFO>(buffer.data());
+    status = TdhEnumerateManifestProviderEvents(&guid, events, &size);
+    if (status != ERROR_SUCCESS) {
+        return 0;
+    }
+
+    std::size_t added = 0;
+    for (ULONG i = 0; i < events->NumberOfEvents; ++i) {
+        EVENT_DESCRIPTOR descriptor = events->EventDescriptorsArray[i];
+        const EventKey key{provider, descriptor.Id, descriptor.Version};
+        if (find(key) != nullptr) {
+            continue;
+        }
+        ULONG info_size = 0;
+        status = TdhGetManifestEventInformation(&guid, &descriptor, nullptr, &info_size);
+        if (status != ERROR_INSUFFICIENT_BUFFER || info_size == 0) {
+            continue;
+        }
+        std::vector<BYTE> info(info_size);
+        status = TdhGetManifestEventInformation(
+            &guid, &descriptor, reinterpret_cast<PTRACE_EVENT_INFO>(info.data()), &info_size);
+        if (status != ERROR_SUCCESS) {
+            continue;
+        }
+        std::unique_ptr<Entry> fresh = make_entry(key, std::move(info));
+        const Entry* candidate = fresh.get();
+        if (insert(std::move(fresh)) == candidate) {
+            ++added;
+        }
+    }
+    return added;
 }
 
 }  // namespace exeray::etw
@@ -0,0 +1,186 @@
+/// @file schema_file.cpp
+/// @brief Schema file encoding (platform independent) and OS fingerprint.
+
+#include "exeray/etw/tdh/schema_file.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
+
+namespace exeray::etw::tdh {
+
+namespace {
+
+constexpr std::size_t kHeaderSize = 32;
+constexpr std::size_t kRecordHeaderSize = sizeof(GUID) + 8;
+
+std::size_t padded(std::size_t size) {
+    return (size + 7) & ~std::size_t{7};
+}
+
+std::uint64_t fnv1a(std::span<const std::uint8_t> bytes) {
+    std::uint64_t hash = 0xCBF29CE484222325ULL;
+    for (const std::uint8_t byte : bytes) {
+        hash = (hash ^ byte) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+template <typename T>
+void put(std::vector<std::uint8_t>& out, std::size_t offset, const T& value) {
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+T get(std::span<const std::uint8_t> bytes, std::size_t offset) {
+    T value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    return value;
+}
+
+}  // namespace
+
+std::vector<std::uint8_t> encode_schemas(std::span<const SchemaRecord> records,
+                                         std::uint64_t fingerprint) {
+    std::size_t total = kHeaderSize;
+    for (const SchemaRecord& record : records) {
+        total += kRecordHeaderSize + padded(record.info.size());
+    }
+
+    std::vector<std::uint8_t> out(total, 0);
+    std::size_t offset = kHeaderSize;
+    for (const SchemaRecord& record : records) {
+        put(out, offset, record.provider);
+        put(out, offset + sizeof(GUID), record.event_id);
+        put(out, offset + sizeof(GUID) + 2, record.event_version);
+        put(out, offset + sizeof(GUID) + 4, static_cast<std::uint32_t>(record.info.size()));
+        offset += kRecordHeaderSize;
+        if (!record.info.empty()) {
+            std::memcpy(out.data() + offset, record.info.data(), record.info.size());
+        }
+        offset += padded(record.info.size());
+    }
+
+    put(out, 0, kSchemaFileMagic);
+    put(out, 4, kSchemaFileFormat);
+    put(out, 8, fingerprint);
+    put(out, 16, static_cast<std::uint32_t>(records.size()));
+    put(out, 24, fnv1a(std::span(out).subspan(kHeaderSize)));
+    return out;
+}
+
+std::optional<std::vector<SchemaRecord>> decode_schemas(std::span<const std::uint8_t> bytes,
+                                                        std::uint64_t fingerprint) {
+    if (bytes.size() < kHeaderSize ||
+        get<std::uint32_t>(bytes, 0) != kSchemaFileMagic ||
+        get<std::uint32_t>(bytes, 4) != kSchemaFileFormat ||
+        get<std::uint64_t>(bytes, 8) != fingerprint ||
+        get<std::uint64_t>(bytes, 24) != fnv1a(bytes.subspan(kHeaderSize))) {
+        return std::nullopt;
+    }
+
+    const auto count = get<std::uint32_t>(bytes, 16);
+    std::vector<SchemaRecord> records;
+    std::size_t offset = kHeaderSize;
+    for (std::uint32_t i = 0; i < count; ++i) {
+        if (bytes.size() - offset < kRecordHeaderSize) {
+            return std::nullopt;
+        }
+        SchemaRecord record;
+        record.provider = get<GUID>(bytes, offset);
+        record.event_id = get<std::uint16_t>(bytes, offset + sizeof(GUID));
+        record.event_version = get<std::uint8_t>(bytes, offset + sizeof(GUID) + 2);
+        const auto size = get<std::uint32_t>(bytes, offset + sizeof(GUID) + 4);
+        offset += kRecordHeaderSize;
+        if (size > kMaxSchemaBytes || bytes.size() - offset < padded(size)) {
+            return std::nullopt;
+        }
+        record.info.assign(bytes.begin() + static_cast<std::ptrdiff_t>(offset),
+                           bytes.begin() + static_cast<std::ptrdiff_t>(offset + size));
+        offset += padded(size);
+        records.push_back(std::move(record));
+    }
+    if (offset != bytes.size()) {
+        return std::nullopt;  // Trailing data: not what we wrote
+    }
+    return records;
+}
+
+bool write_schema_file(const std::filesystem::path& path,
+                       std::span<const SchemaRecord> records, std::uint64_t fingerprint) {
+    const std::vector<std::uint8_t> bytes = encode_schemas(records, fingerprint);
+    std::filesystem::path temp = path;
+    temp += ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(bytes.data()),
+                   static_cast<std::streamsize>(bytes.size()));
+        if (!file) {
+            file.close();
+            std::error_code ignored;
+            std::filesystem::remove(temp, ignored);
+            return false;
+        }
+    }
+    // Readers see either the old file or the complete new one
+    std::error_code error;
+    std::filesystem::rename(temp, path, error);
+    if (error) {
+        std::filesystem::remove(temp, error);
+        return false;
+    }
+    return true;
+}
+
+std::optional<std::vector<SchemaRecord>> read_schema_file(const std::filesystem::path& path,
+                                                          std::uint64_t fingerprint) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+    const std::vector<std::uint8_t> bytes{std::istreambuf_iterator<char>(file),
+                                          std::istreambuf_iterator<char>()};
+    return decode_schemas(bytes, fingerprint);
+}
+
+std::uint64_t os_fingerprint() {
+#ifdef _WIN32
+    // RtlGetVersion reports the real version, unlike the manifest-shimmed
+    // GetVersionEx
+    using RtlGetVersionFn = LONG(WINAPI*)(PRTL_OSVERSIONINFOW);
+    RTL_OSVERSIONINFOW version{};
+    version.dwOSVersionInfoSize = sizeof(version);
+    HMODULE ntdll = GetModuleHandleW(L"ntdll.dll");
+    const auto rtl_get_version = ntdll != nullptr
+        ? reinterpret_cast<RtlGetVersionFn>(GetProcAddress(ntdll, "RtlGetVersion"))
+        : nullptr;
+    if (rtl_get_version == nullptr || rtl_get_version(&version) != 0) {
+        return 0;
+    }
+
+    DWORD ubr = 0;
+    DWORD size = sizeof(ubr);
+    if (RegGetValueW(HKEY_LOCAL_MACHINE, L"SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion",
+                     L"UBR", RRF_RT_REG_DWORD, nullptr, &ubr, &size) != ERROR_SUCCESS) {
+        ubr = 0;
+    }
+    return (static_cast<std::uint64_t>(version.dwMajorVersion & 0xFF) << 56) |
+           (static_cast<std::uint64_t>(version.dwMinorVersion & 0xFF) << 48) |
+           (static_cast<std::uint64_t>(version.dwBuildNumber & 0xFFFF) << 32) | ubr;
+#else
+    return 0;
+#endif
+}
+
+}  // namespace exeray::etw::tdh
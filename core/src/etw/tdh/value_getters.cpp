@@ -7,39 +7,36 @@
 
 namespace exeray::etw::tdh::detail {
 
-std::wstring get_wstring_prop(const TdhParsedEvent& event, const std::wstring& name) {
-    auto it = event.properties.find(name);
-    if (it != event.properties.end()) {
-        if (auto* str = std::get_if<std::wstring>(&it->second)) {
+std::wstring_view get_wstring_prop(const TdhParsedEvent& event, std::size_t ordinal) {
+    if (const TdhPropertyValue* value = event.at(ordinal)) {
+        if (auto* str = std::get_if<std::wstring_view>(value)) {
             return *str;
         }
     }
-    return L"";
+    return {};
 }
 
-uint32_t get_uint32_prop(const TdhParsedEvent& event, const std::wstring& name) {
-    auto it = event.properties.find(name);
-    if (it != event.properties.end()) {
-        if (auto* val = std::get_if<uint32_t>(&it->second)) {
+uint32_t get_uint32_prop(const TdhParsedEvent& event, std::size_t ordinal) {
+    if (const TdhPropertyValue* value = event.at(ordinal)) {
+        if (auto* val = std::get_if<uint32_t>(value)) {
             return *val;
         }
-        if (auto* val = std::get_if<uint64_t>(&it->second)) {
+        if (auto* val = std::get_if<uint64_t>(value)) {
             return static_cast<uint32_t>(*val);
         }
-        if (auto* val = std::get_if<int32_t>(&it->second)) {
+        if (auto* val = std::get_if<int32_t>(value)) {
             return static_cast<uint32_t>(*val);
         }
     }
     return 0;
 }
 
-uint64_t get_uint64_prop(const TdhParsedEvent& event, const std::wstring& name) {
-    auto it = event.properties.find(name);
-    if (it != event.properties.end()) {
-        if (auto* val = std::get_if<uint64_t>(&it->second)) {
+uint64_t get_uint64_prop(const TdhParsedEvent& event, std::size_t ordinal) {
+    if (const TdhPropertyValue* value = event.at(ordinal)) {
+        if (auto* val = std::get_if<uint64_t>(value)) {
             return *val;
         }
-        if (auto* val = std::get_if<uint32_t>(&it->second)) {
+        if (auto* val = std::get_if<uint32_t>(value)) {
             return static_cast<uint64_t>(*val);
         }
     }
@@ -0,0 +1,215 @@
+/// @file text_search.cpp
+/// @brief Case-insensitive substring search (platform independent).
+
+#include "exeray/etw/text_search.hpp"
+
+#include <bit>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EXERAY_SEARCH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace exeray::etw {
+
+namespace {
+
+template <typename CharT>
+constexpr CharT fold(CharT c) noexcept {
+    return (c >= CharT('A') && c <= CharT('Z')) ? static_cast<CharT>(c - CharT('A') + CharT('a'))
+                                                : c;
+}
+
+/// @brief Compare n characters, ignoring ASCII case.
+template <typename CharT>
+bool equal_icase(const CharT* a, const CharT* b, std::size_t n) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+        if (fold(a[i]) != fold(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Verify a candidate whose first and last characters already match.
+template <typename CharT>
+bool matches_at(const CharT* at, std::basic_string_view<CharT> needle) noexcept {
+    return needle.size() <= 2 || equal_icase(at + 1, needle.data() + 1, needle.size() - 2);
+}
+
+#if defined(__AVX2__) || defined(EXERAY_SEARCH_SSE2)
+
+#if defined(__AVX2__)
+using Vector = __m256i;
+constexpr std::size_t kVectorBytes = 32;
+#else
+using Vector = __m128i;
+constexpr std::size_t kVectorBytes = 16;
+#endif
+
+/// Positions tested per block.
+template <typename CharT>
+constexpr std::size_t kBlock = kVectorBytes / sizeof(CharT);
+
+/// movemask bits kept: the lowest one of each character.
+template <typename CharT>
+constexpr std::uint32_t kLaneBits = sizeof(CharT) == 1   ? 0xFFFFFFFFU
+                                    : sizeof(CharT) == 2 ? 0x55555555U
+                                                         : 0x11111111U;
+
+template <typename CharT>
+Vector broadcast(CharT c) noexcept {
+#if defined(__AVX2__)
+    if constexpr (sizeof(CharT) == 1) {
+        return _mm256_set1_epi8(static_cast<char>(c));
+    } else if constexpr (sizeof(CharT) == 2) {
+        return _mm256_set1_epi16(static_cast<short>(c));
+    } else {
+        return _mm256_set1_epi32(static_cast<int>(c));
+    }
+#else
+    if constexpr (sizeof(CharT) == 1) {
+        return _mm_set1_epi8(static_cast<char>(c));
+    } else if constexpr (sizeof(CharT) == 2) {
+        return _mm_set1_epi16(static_cast<short>(c));
+    } else {
+        return _mm_set1_epi32(static_cast<int>(c));
+    }
+#endif
+}
+
+/// @brief One needle character, folded, and the bit that folds letters.
+///
+/// Setting 0x20 lowercases exactly A-Z onto a-z, so it is applied only
+/// when the character is a letter; anything else must match as is.
+template <typename CharT>
+struct Probe {
+    Vector value;
+    Vector case_bit;
+
+    explicit Probe(CharT c) noexcept
+        : value(broadcast(fold(c))),
+          case_bit(broadcast(fold(c) >= CharT('a') && fold(c) <= CharT('z') ? CharT(0x20)
+                                                                            : CharT(0))) {}
+};
+
+/// @brief Lanes of p equal to the probe's character (all ones), case folded.
+template <typename CharT>
+Vector equal(const CharT* p, const Probe<CharT>& probe) noexcept {
+#if defined(__AVX2__)
+    const Vector v = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const Vector*>(p)),
+                                     probe.case_bit);
+    if constexpr (sizeof(CharT) == 1) {
+        return _mm256_cmpeq_epi8(v, probe.value);
+    } else if constexpr (sizeof(CharT) == 2) {
+        return _mm256_cmpeq_epi16(v, probe.value);
+    } else {
+        return _mm256_cmpeq_epi32(v, probe.value);
+    }
+#else
+    const Vector v = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const Vector*>(p)),
+                                  probe.case_bit);
+    if constexpr (sizeof(CharT) == 1) {
+        return _mm_cmpeq_epi8(v, probe.value);
+    } else if constexpr (sizeof(CharT) == 2) {
+        return _mm_cmpeq_epi16(v, probe.value);
+    } else {
+        return _mm_cmpeq_epi32(v, probe.value);
+    }
+#endif
+}
+
+/// @brief Candidate starts in [p, p + kBlock): first and last characters match.
+template <typename CharT>
+std::uint32_t candidates(const CharT* p, std::size_t last_offset, const Probe<CharT>& first,
+                         const Probe<CharT>& last) noexcept {
+#if defined(__AVX2__)
+    const Vector both = _mm256_and_si256(equal(p, first), equal(p + last_offset, last));
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(both)) & kLaneBits<CharT>;
+#else
+    const Vector both = _mm_and_si128(equal(p, first), equal(p + last_offset, last));
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(both)) & kLaneBits<CharT>;
+#endif
+}
+
+#endif  // __AVX2__ || EXERAY_SEARCH_SSE2
+
+template <typename CharT>
+std::size_t find_folded(std::basic_string_view<CharT> haystack,
+                        std::basic_string_view<CharT> needle) noexcept {
+    const std::size_t m = needle.size();
+    if (m == 0 || m > haystack.size()) {
+        return std::basic_string_view<CharT>::npos;
+    }
+
+    const CharT* text = haystack.data();
+    const std::size_t starts = haystack.size() - m + 1;  // Candidate positions
+    std::size_t i = 0;
+
+#if defined(__AVX2__) || defined(EXERAY_SEARCH_SSE2)
+    const Probe<CharT> first(needle.front());
+    const Probe<CharT> last(needle.back());
+    for (; i + kBlock<CharT> <= starts; i += kBlock<CharT>) {
+        std::uint32_t mask = candidates(text + i, m - 1, first, last);
+        while (mask != 0) {
+            const std::size_t pos =
+                i + static_cast<std::size_t>(std::countr_zero(mask)) / sizeof(CharT);
+            if (matches_at(text + pos, needle)) {
+                return pos;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    const CharT first_char = fold(needle.front());
+    const CharT last_char = fold(needle.back());
+    for (; i < starts; ++i) {
+        if (fold(text[i]) == first_char && fold(text[i + m - 1]) == last_char &&
+            matches_at(text + i, needle)) {
+            return i;
+        }
+    }
+    return std::basic_string_view<CharT>::npos;
+}
+
+}  // namespace
+
+std::size_t find_icase(std::wstring_view haystack, std::wstring_view needle) noexcept {
+    return find_folded(haystack, needle);
+}
+
+std::size_t find_icase(std::string_view haystack, std::string_view needle) noexcept {
+    return find_folded(haystack, needle);
+}
+
+std::uint64_t IcaseNeedles::scan(std::wstring_view haystack, bool stop_at_first) const noexcept {
+    std::uint64_t pending = all_;  // Needles not found yet
+
+    std::uint64_t found = 0;
+    for (std::size_t i = 0; i < haystack.size() && pending != 0; ++i) {
+        const wchar_t c = fold(haystack[i]);
+        std::uint64_t starting = static_cast<std::size_t>(c) < kAscii
+            ? by_first_[static_cast<std::size_t>(c)] & pending
+            : other_first_ & pending;
+        while (starting != 0) {
+            const auto index = static_cast<std::size_t>(std::countr_zero(starting));
+            starting &= starting - 1;
+            const std::wstring_view needle = needles_[index];
+            if (needle.size() <= haystack.size() - i &&
+                fold(needle.front()) == c &&
+                equal_icase(haystack.data() + i + 1, needle.data() + 1, needle.size() - 1)) {
+                found |= std::uint64_t{1} << index;
+                pending &= ~(std::uint64_t{1} << index);
+                if (stop_at_first) {
+                    return found;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+}  // namespace exeray::etw
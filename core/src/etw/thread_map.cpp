@@ -0,0 +1,69 @@
+/// @file thread_map.cpp
+/// @brief Thread ID to process map (platform independent).
+
+#include "exeray/etw/thread_map.hpp"
+
+namespace exeray::etw {
+
+ThreadMap::ThreadMap() : pages_(std::make_unique<std::atomic<Page*>[]>(kPages)) {}
+
+ThreadMap::~ThreadMap() {
+    clear();
+}
+
+std::atomic<std::uint32_t>* ThreadMap::slot(std::uint32_t tid) {
+    if ((tid & 3U) != 0 || tid >= kMaxThreadId) {
+        return nullptr;
+    }
+    const std::size_t index = tid >> 2;
+    std::atomic<Page*>& entry = pages_[index / kPageSize];
+    Page* page = entry.load(std::memory_order_acquire);
+    if (page == nullptr) {
+        // Racing starts on one page: the loser frees its copy
+        auto fresh = std::make_unique<Page>();
+        if (entry.compare_exchange_strong(page, fresh.get(), std::memory_order_acq_rel)) {
+            page = fresh.release();
+        }
+    }
+    return &page->pids[index % kPageSize];
+}
+
+void ThreadMap::start(std::uint32_t tid, std::uint32_t pid) {
+    if (pid == 0) {
+        return;
+    }
+    std::atomic<std::uint32_t>* owner = slot(tid);
+    if (owner != nullptr && owner->exchange(pid, std::memory_order_acq_rel) == 0) {
+        size_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ThreadMap::end(std::uint32_t tid, std::uint32_t pid) {
+    if ((tid & 3U) != 0 || tid >= kMaxThreadId || pid == 0) {
+        return;
+    }
+    const std::size_t index = tid >> 2;
+    Page* page = pages_[index / kPageSize].load(std::memory_order_acquire);
+    std::uint32_t expected = pid;
+    if (page != nullptr &&
+        page->pids[index % kPageSize].compare_exchange_strong(expected, 0,
+                                                              std::memory_order_acq_rel)) {
+        size_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void ThreadMap::clear() {
+    for (std::size_t i = 0; i < kPages; ++i) {
+        delete pages_[i].exchange(nullptr, std::memory_order_relaxed);
+    }
+    size_.store(0, std::memory_order_relaxed);
+}
+
+/// Global thread map instance.
+static ThreadMap g_thread_map;
+
+ThreadMap& thread_map() {
+    return g_thread_map;
+}
+
+}  // namespace exeray::etw
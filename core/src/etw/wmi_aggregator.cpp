@@ -0,0 +1,109 @@
+/// @file wmi_aggregator.cpp
+/// @brief WmiAggregator implementation (platform independent).
+
+#include "exeray/etw/wmi_aggregator.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace exeray::etw {
+
+static_assert(WmiAggregator::kShards == 16, "the shard is the top four bits of the hash");
+
+std::size_t WmiAggregator::KeyHash::operator()(const Key& key) const noexcept {
+    std::uint64_t h = (std::uint64_t{key.pid} << 8) | key.operation;
+    h = (h ^ key.wmi_namespace) * 0x9E3779B97F4A7C15ULL;
+    h = (h ^ key.query) * 0x9E3779B97F4A7C15ULL;
+    h = (h ^ key.target_host) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<std::size_t>(h ^ (h >> 29));
+}
+
+WmiAggregator::WmiAggregator(const WmiConfig& config)
+    : interval_(static_cast<event::Timestamp>(config.summary_interval_ms) * 1'000'000) {}
+
+bool WmiAggregator::admit(std::uint32_t pid, event::EventPayload& payload,
+                          std::uint8_t operation, event::Timestamp at) {
+    if (payload.category != event::Category::Wmi) {
+        return true;
+    }
+
+    event::WmiPayload& wmi = payload.wmi;
+    const Key key{pid, operation, wmi.wmi_namespace, wmi.query, wmi.target_host};
+    const std::size_t hash = KeyHash{}(key);
+    Shard& shard = shards_[hash >> (std::numeric_limits<std::size_t>::digits - 4)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.operations.find(key);
+    if (it == shard.operations.end()) {
+        if (shard.operations.size() >= kMaxOperationsPerShard) {
+            overflowed_.fetch_add(1, std::memory_order_relaxed);
+            wmi.count = 1;
+            return true;
+        }
+        it = shard.operations.try_emplace(key).first;
+        WmiOperationRecord& record = it->second.record;
+        record.pid = pid;
+        record.operation = operation;
+        record.wmi_namespace = wmi.wmi_namespace;
+        record.query = wmi.query;
+        record.target_host = wmi.target_host;
+        record.count = 1;
+        record.first_seen = at;
+        record.last_seen = at;
+        // The first occurrence shows the operation and its verdict
+        it->second.reported_at = at;
+        wmi.count = 1;
+        return true;
+    }
+
+    Operation& op = it->second;
+    ++op.record.count;
+    op.record.last_seen = (std::max)(op.record.last_seen, at);
+    ++op.unreported;
+    if (interval_ != 0 && at >= op.reported_at + interval_) {
+        summaries_.fetch_add(1, std::memory_order_relaxed);
+        wmi.count = op.unreported;
+        op.unreported = 0;
+        op.reported_at = at;
+        return true;
+    }
+    absorbed_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+std::vector<WmiOperationRecord> WmiAggregator::operations(std::uint32_t pid) const {
+    std::vector<WmiOperationRecord> result;
+    for (const Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& [key, op] : shard.operations) {
+            if (pid == 0 || key.pid == pid) {
+                result.push_back(op.record);
+            }
+        }
+    }
+    return result;
+}
+
+WmiStats WmiAggregator::stats() const noexcept {
+    WmiStats stats;
+    for (const Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.operations += shard.operations.size();
+    }
+    stats.absorbed = absorbed_.load(std::memory_order_relaxed);
+    stats.summaries = summaries_.load(std::memory_order_relaxed);
+    stats.overflowed = overflowed_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void WmiAggregator::clear() {
+    for (Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.operations.clear();
+    }
+    absorbed_.store(0, std::memory_order_relaxed);
+    summaries_.store(0, std::memory_order_relaxed);
+    overflowed_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace exeray::etw
@@ -0,0 +1,104 @@
+/// @file alert_queue.cpp
+/// @brief Lock-free alert ring with a consumer wakeup (platform independent).
+
+#include "exeray/event/alert_queue.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace exeray::event {
+
+AlertQueue::AlertQueue(std::size_t capacity)
+    : slots_(std::make_unique<Slot[]>(std::bit_ceil((std::max)(capacity, std::size_t{2})))),
+      mask_(std::bit_ceil((std::max)(capacity, std::size_t{2})) - 1) {
+    for (std::size_t i = 0; i <= mask_; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool AlertQueue::push(const Alert& alert) noexcept {
+    std::uint64_t position = tail_.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    for (;;) {
+        slot = &slots_[position & mask_];
+        const std::uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        if (sequence == position) {
+            if (tail_.compare_exchange_weak(position, position + 1,
+                                            std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (sequence < position) {
+            // Not popped since its last lap: the ring is full
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            position = tail_.load(std::memory_order_relaxed);
+        }
+    }
+    slot->alert = alert;
+    slot->sequence.store(position + 1, std::memory_order_release);
+
+    // Pairs with the fence in wait(): either the consumer sees the alert
+    // before sleeping or this sees the consumer waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_relaxed) != 0) {
+        notify();
+    }
+    return true;
+}
+
+std::size_t AlertQueue::pop(std::span<Alert> out) noexcept {
+    std::uint64_t position = head_.load(std::memory_order_relaxed);
+    std::size_t n = 0;
+    while (n < out.size()) {
+        Slot& slot = slots_[position & mask_];
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+            break;  // Not filled yet
+        }
+        out[n++] = slot.alert;
+        slot.sequence.store(position + mask_ + 1, std::memory_order_release);
+        ++position;
+    }
+    head_.store(position, std::memory_order_relaxed);
+    return n;
+}
+
+bool AlertQueue::empty() const noexcept {
+    const std::uint64_t position = head_.load(std::memory_order_relaxed);
+    return slots_[position & mask_].sequence.load(std::memory_order_acquire) != position + 1;
+}
+
+bool AlertQueue::wait(std::chrono::milliseconds timeout) {
+    waiters_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::unique_lock lock(mutex_);
+    ready_.wait_for(lock, timeout, [this] { return woken_ || !empty(); });
+    woken_ = false;
+    lock.unlock();
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+    return !empty();
+}
+
+void AlertQueue::wake() {
+    {
+        const std::lock_guard lock(mutex_);
+        woken_ = true;
+    }
+    ready_.notify_all();
+}
+
+void AlertQueue::notify() {
+    // Taking the mutex orders the notify after the consumer's predicate check
+    { const std::lock_guard lock(mutex_); }
+    ready_.notify_all();
+}
+
+AlertStats AlertQueue::stats() const noexcept {
+    AlertStats stats;
+    // Every position claimed was filled: tail_ counts the alerts queued
+    stats.pushed = tail_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}  // namespace exeray::event
@@ -0,0 +1,686 @@
+/// @file arrow_export.cpp
+/// @brief Arrow IPC file writer for EventGraph exports (platform independent).
+///
+/// The Arrow metadata is FlatBuffers. Instead of depending on the FlatBuffers
+/// library for the handful of tables Arrow needs (Schema.fbs, Message.fbs,
+/// File.fbs), FbNode describes a table tree and FbWriter lays it out front
+/// to back: each table's vtable just before it, its children after it, so
+/// every offset points forward as the format requires.
+
+#include "exeray/event/arrow_export.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "exeray/event/payload_fields.hpp"
+#include "exeray/thread_pool.hpp"
+
+namespace exeray::event {
+
+namespace {
+
+constexpr std::size_t kCategoryCount = static_cast<std::size_t>(Category::Count);
+
+// -------------------------------------------------------------------------
+// FlatBuffers
+// -------------------------------------------------------------------------
+
+/// @brief A FlatBuffers value: a table of scalars and children, a string,
+/// a vector of structs or a vector of tables.
+struct FbNode {
+    enum class Kind : std::uint8_t { Table, String, Structs, Tables };
+
+    static constexpr std::size_t kNoChild = std::numeric_limits<std::size_t>::max();
+
+    struct Slot {
+        std::uint16_t id;    ///< Field index in the schema
+        std::uint8_t size;   ///< Bytes of the scalar, or 4 for a child offset
+        std::uint64_t bits;  ///< Scalar bytes (first size bytes)
+        std::size_t child;   ///< Index in children, or kNoChild
+    };
+
+    Kind kind = Kind::Table;
+    std::vector<Slot> slots;          ///< Table fields
+    std::vector<FbNode> children;     ///< Table children, or Tables elements
+    std::vector<std::uint8_t> bytes;  ///< String text, or Structs elements
+    std::uint32_t count = 0;          ///< Structs elements
+
+    template <typename T>
+    FbNode& scalar(std::uint16_t id, T value) {
+        std::uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(T));
+        slots.push_back({id, static_cast<std::uint8_t>(sizeof(T)), bits, kNoChild});
+        return *this;
+    }
+
+    FbNode& child(std::uint16_t id, FbNode node) {
+        children.push_back(std::move(node));
+        slots.push_back({id, 4, 0, children.size() - 1});
+        return *this;
+    }
+};
+
+FbNode fb_string(std::string_view text) {
+    FbNode node;
+    node.kind = FbNode::Kind::String;
+    node.bytes.assign(text.begin(), text.end());
+    return node;
+}
+
+/// @brief Vector of 8-byte aligned structs.
+template <typename T>
+FbNode fb_structs(const std::vector<T>& elements) {
+    static_assert(alignof(T) == 8 && std::is_trivially_copyable_v<T>);
+    FbNode node;
+    node.kind = FbNode::Kind::Structs;
+    node.count = static_cast<std::uint32_t>(elements.size());
+    node.bytes.resize(elements.size() * sizeof(T));
+    std::memcpy(node.bytes.data(), elements.data(), node.bytes.size());
+    return node;
+}
+
+FbNode fb_tables(std::vector<FbNode> elements) {
+    FbNode node;
+    node.kind = FbNode::Kind::Tables;
+    node.children = std::move(elements);
+    return node;
+}
+
+/// @brief Lays out a FbNode tree as a finished buffer.
+class FbWriter {
+public:
+    /// @return The buffer, padded to 8 bytes.
+    std::vector<std::uint8_t> finish(const FbNode& root) {
+        out_.assign(4, 0);
+        put32(0, static_cast<std::uint32_t>(place(root)));
+        align(8);
+        return std::move(out_);
+    }
+
+private:
+    void align(std::size_t to) { out_.resize((out_.size() + to - 1) / to * to, 0); }
+
+    void put32(std::size_t at, std::uint32_t value) {
+        std::memcpy(out_.data() + at, &value, sizeof(value));
+    }
+
+    void push32(std::uint32_t value) {
+        out_.resize(out_.size() + 4);
+        put32(out_.size() - 4, value);
+    }
+
+    void push16(std::uint16_t value) {
+        out_.resize(out_.size() + 2);
+        std::memcpy(out_.data() + out_.size() - 2, &value, sizeof(value));
+    }
+
+    /// @brief Point the offset at from to the value at target.
+    void link(std::size_t from, std::size_t target) {
+        put32(from, static_cast<std::uint32_t>(target - from));
+    }
+
+    std::size_t place(const FbNode& node) {
+        std::size_t at = 0;
+        switch (node.kind) {
+            case FbNode::Kind::String:
+                align(4);
+                at = out_.size();
+                push32(static_cast<std::uint32_t>(node.bytes.size()));
+                out_.insert(out_.end(), node.bytes.begin(), node.bytes.end());
+                out_.push_back(0);
+                return at;
+            case FbNode::Kind::Structs:
+                // The length comes right before the 8-byte aligned elements
+                align(4);
+                if ((out_.size() + 4) % 8 != 0) {
+                    out_.resize(out_.size() + 4, 0);
+                }
+                at = out_.size();
+                push32(node.count);
+                out_.insert(out_.end(), node.bytes.begin(), node.bytes.end());
+                return at;
+            case FbNode::Kind::Tables: {
+                align(4);
+                at = out_.size();
+                push32(static_cast<std::uint32_t>(node.children.size()));
+                const std::size_t slots = out_.size();
+                out_.resize(slots + 4 * node.children.size(), 0);
+                for (std::size_t i = 0; i < node.children.size(); ++i) {
+                    link(slots + 4 * i, place(node.children[i]));
+                }
+                return at;
+            }
+            case FbNode::Kind::Table:
+                break;
+        }
+        return place_table(node);
+    }
+
+    std::size_t place_table(const FbNode& node) {
+        // After the vtable offset, widest fields first, each aligned to its size
+        std::vector<std::size_t> order(node.slots.size());
+        std::iota(order.begin(), order.end(), std::size_t{0});
+        std::stable_sort(order.begin(), order.end(), [&node](std::size_t a, std::size_t b) {
+            return node.slots[a].size > node.slots[b].size;
+        });
+        std::vector<std::uint16_t> offsets(node.slots.size());
+        std::size_t size = 4;
+        std::size_t widest = 4;
+        std::size_t fields = 0;
+        for (const std::size_t i : order) {
+            const std::size_t width = node.slots[i].size;
+            size = (size + width - 1) / width * width;
+            offsets[i] = static_cast<std::uint16_t>(size);
+            size += width;
+            widest = (std::max)(widest, width);
+            fields = (std::max)(fields, std::size_t{node.slots[i].id} + 1);
+        }
+
+        align(2);
+        const std::size_t vtable = out_.size();
+        std::vector<std::uint16_t> entries(fields, 0);
+        for (std::size_t i = 0; i < node.slots.size(); ++i) {
+            entries[node.slots[i].id] = offsets[i];
+        }
+        push16(static_cast<std::uint16_t>(4 + 2 * fields));
+        push16(static_cast<std::uint16_t>(size));
+        for (const std::uint16_t entry : entries) {
+            push16(entry);
+        }
+
+        align(widest);
+        const std::size_t table = out_.size();
+        out_.resize(table + size, 0);
+        put32(table, static_cast<std::uint32_t>(table - vtable));  // soffset: vtable before
+        for (std::size_t i = 0; i < node.slots.size(); ++i) {
+            const FbNode::Slot& slot = node.slots[i];
+            if (slot.child == FbNode::kNoChild) {
+                std::memcpy(out_.data() + table + offsets[i], &slot.bits, slot.size);
+            }
+        }
+        for (std::size_t i = 0; i < node.slots.size(); ++i) {
+            const FbNode::Slot& slot = node.slots[i];
+            if (slot.child != FbNode::kNoChild) {
+                link(table + offsets[i], place(node.children[slot.child]));
+            }
+        }
+        return table;
+    }
+
+    std::vector<std::uint8_t> out_;
+};
+
+// -------------------------------------------------------------------------
+// Arrow metadata (Schema.fbs, Message.fbs, File.fbs)
+// -------------------------------------------------------------------------
+
+constexpr std::int16_t kMetadataV5 = 4;
+constexpr std::uint8_t kHeaderSchema = 1;
+constexpr std::uint8_t kHeaderDictionaryBatch = 2;
+constexpr std::uint8_t kHeaderRecordBatch = 3;
+constexpr std::uint8_t kTypeInt = 2;
+constexpr std::uint8_t kTypeUtf8 = 5;
+constexpr std::uint8_t kTypeTimestamp = 10;
+constexpr std::int16_t kNanosecond = 3;
+constexpr char kMagic[8] = {'A', 'R', 'R', 'O', 'W', '1', 0, 0};
+
+struct FieldNode {
+    std::int64_t length;
+    std::int64_t null_count;
+};
+
+struct BufferSpec {
+    std::int64_t offset;  ///< From the start of the message body
+    std::int64_t length;
+};
+
+struct FileBlock {
+    std::int64_t offset;  ///< Of the message in the file
+    std::int32_t metadata_length;
+    std::int32_t pad;
+    std::int64_t body_length;
+};
+
+FbNode int_type(std::size_t bytes, bool is_signed) {
+    FbNode type;
+    type.scalar(0, static_cast<std::int32_t>(bytes * 8)).scalar(1, is_signed);
+    return type;
+}
+
+FbNode record_batch(std::int64_t length, const std::vector<FieldNode>& nodes,
+                    const std::vector<BufferSpec>& buffers) {
+    FbNode batch;
+    batch.scalar(0, length).child(1, fb_structs(nodes)).child(2, fb_structs(buffers));
+    return batch;
+}
+
+FbNode message(std::uint8_t header_type, FbNode header, std::int64_t body_length) {
+    FbNode node;
+    node.scalar(0, kMetadataV5)
+        .scalar(1, header_type)
+        .child(2, std::move(header))
+        .scalar(3, body_length);
+    return node;
+}
+
+// -------------------------------------------------------------------------
+// Columns
+// -------------------------------------------------------------------------
+
+/// @brief Where a column's values come from.
+enum class Source : std::uint8_t {
+    Id,
+    Parent,
+    Time,
+    Correlation,
+    Status,
+    Operation,
+    Number,  ///< Unsigned payload member
+    String,  ///< StringId payload member
+    Ipv6     ///< Network address StringId, when the family is IPv6
+};
+
+struct Column {
+    std::string_view name;
+    Source source;
+    std::uint16_t offset = 0;  ///< Payload members: from the start of EventPayload
+    std::uint8_t size = 0;     ///< Bytes per value in the batch
+
+    [[nodiscard]] bool is_string() const noexcept {
+        return source == Source::String || source == Source::Ipv6;
+    }
+};
+
+std::vector<Column> columns_of(Category category) {
+    std::vector<Column> columns{
+        {"id", Source::Id, 0, sizeof(EventId)},
+        {"parent_id", Source::Parent, 0, sizeof(EventId)},
+        {"timestamp", Source::Time, 0, sizeof(Timestamp)},
+        {"correlation_id", Source::Correlation, 0, sizeof(std::uint32_t)},
+        {"status", Source::Status, 0, sizeof(Status)},
+        {"operation", Source::Operation, 0, sizeof(std::uint8_t)},
+    };
+    for (const PayloadField& field : payload_fields()) {
+        if (field.category == category) {
+            columns.push_back({field.name, field.is_string ? Source::String : Source::Number,
+                               field.offset, field.is_string ? std::uint8_t{4} : field.size});
+        }
+    }
+    if (category == Category::Network) {
+        columns.push_back({"local_addr6", Source::Ipv6,
+                           static_cast<std::uint16_t>(offsetof(EventPayload, network) +
+                                                      offsetof(NetworkPayload, local_addr)),
+                           4});
+        columns.push_back({"remote_addr6", Source::Ipv6,
+                           static_cast<std::uint16_t>(offsetof(EventPayload, network) +
+                                                      offsetof(NetworkPayload, remote_addr)),
+                           4});
+    }
+    return columns;
+}
+
+/// @brief Rows of one category from one graph chunk, a column each.
+struct Batch {
+    std::size_t rows = 0;
+    std::vector<std::vector<std::uint8_t>> columns;
+};
+
+/// @brief parallel_reduce() state: the batches of each category, oldest first.
+struct Batches {
+    std::array<std::vector<Batch>, kCategoryCount> categories;
+};
+
+template <typename T>
+void push(std::vector<std::uint8_t>& out, T value) {
+    const auto at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &value, sizeof(T));
+}
+
+void append(Batch& batch, const std::vector<Column>& columns, EventView view) {
+    const EventPayload& payload = view.payload();
+    const auto* bytes = reinterpret_cast<const std::uint8_t*>(&payload);
+    for (std::size_t i = 0; i < columns.size(); ++i) {
+        const Column& column = columns[i];
+        std::vector<std::uint8_t>& out = batch.columns[i];
+        switch (column.source) {
+            case Source::Id:
+                push(out, view.id());
+                break;
+            case Source::Parent:
+                push(out, view.parent_id());
+                break;
+            case Source::Time:
+                push(out, view.timestamp());
+                break;
+            case Source::Correlation:
+                push(out, view.correlation_id());
+                break;
+            case Source::Status:
+                push(out, view.status());
+                break;
+            case Source::Operation:
+                push(out, view.operation());
+                break;
+            case Source::Number:
+            case Source::String:
+                out.insert(out.end(), bytes + column.offset, bytes + column.offset + column.size);
+                break;
+            case Source::Ipv6: {
+                StringId id = INVALID_STRING;
+                if (payload.network.family == kAddressIPv6) {
+                    std::memcpy(&id, bytes + column.offset, sizeof(id));
+                }
+                push(out, id);
+                break;
+            }
+        }
+    }
+    ++batch.rows;
+}
+
+// -------------------------------------------------------------------------
+// File
+// -------------------------------------------------------------------------
+
+/// @brief Body of a message: buffers, each padded to 8 bytes.
+struct Body {
+    std::vector<std::uint8_t> bytes;
+    std::vector<BufferSpec> buffers;
+
+    void add(const void* data, std::size_t size) {
+        buffers.push_back({static_cast<std::int64_t>(bytes.size()),
+                           static_cast<std::int64_t>(size)});
+        const auto* begin = static_cast<const std::uint8_t*>(data);
+        bytes.insert(bytes.end(), begin, begin + size);
+        bytes.resize((bytes.size() + 7) & ~std::size_t{7}, 0);
+    }
+};
+
+/// @brief Writes one category's file.
+class ArrowFile {
+public:
+    ArrowFile(const std::vector<Column>& columns, std::vector<Batch>& batches,
+              const StringPool& strings)
+        : columns_(columns), batches_(batches), strings_(strings) {}
+
+    bool write(const std::filesystem::path& path) {
+        build_dictionaries();
+        file_.open(path, std::ios::binary | std::ios::trunc);
+        put(kMagic, sizeof(kMagic));
+        const FbNode schema = make_schema();
+        put_message(message(kHeaderSchema, schema, 0), {});
+
+        std::vector<FileBlock> dictionaries;
+        for (std::size_t i = 0; i < columns_.size(); ++i) {
+            if (columns_[i].is_string()) {
+                dictionaries.push_back(put_dictionary(i));
+            }
+        }
+        std::vector<FileBlock> batches;
+        for (Batch& batch : batches_) {
+            batches.push_back(put_batch(batch));
+        }
+        const std::uint32_t end_of_stream[2] = {0xFFFFFFFFU, 0};
+        put(end_of_stream, sizeof(end_of_stream));
+
+        FbNode footer;
+        footer.scalar(0, kMetadataV5)
+            .child(1, schema)
+            .child(2, fb_structs(dictionaries))
+            .child(3, fb_structs(batches));
+        const std::vector<std::uint8_t> bytes = FbWriter().finish(footer);
+        put(bytes.data(), bytes.size());
+        const auto size = static_cast<std::int32_t>(bytes.size());
+        put(&size, sizeof(size));
+        put(kMagic, 6);
+        file_.close();
+        return !file_.fail();
+    }
+
+private:
+    /// @brief Collect each string column's distinct StringIds, in order of
+    /// first appearance.
+    void build_dictionaries() {
+        dictionaries_.resize(columns_.size());
+        index_.resize(columns_.size());
+        for (std::size_t i = 0; i < columns_.size(); ++i) {
+            if (!columns_[i].is_string()) {
+                continue;
+            }
+            for (const Batch& batch : batches_) {
+                for (std::size_t row = 0; row < batch.rows; ++row) {
+                    const StringId id = string_at(batch, i, row);
+                    if (id != INVALID_STRING &&
+                        index_[i]
+                            .try_emplace(id, static_cast<std::int32_t>(dictionaries_[i].size()))
+                            .second) {
+                        dictionaries_[i].push_back(id);
+                    }
+                }
+            }
+        }
+    }
+
+    static StringId string_at(const Batch& batch, std::size_t column, std::size_t row) {
+        StringId id;
+        std::memcpy(&id, batch.columns[column].data() + row * sizeof(StringId), sizeof(id));
+        return id;
+    }
+
+    FbNode make_schema() const {
+        std::vector<FbNode> fields;
+        for (std::size_t i = 0; i < columns_.size(); ++i) {
+            const Column& column = columns_[i];
+            FbNode field;
+            field.child(0, fb_string(column.name)).scalar(1, column.is_string());
+            if (column.is_string()) {
+                FbNode encoding;
+                encoding.scalar(0, static_cast<std::int64_t>(i)).child(1, int_type(4, true));
+                field.scalar(2, kTypeUtf8).child(3, FbNode{}).child(4, std::move(encoding));
+            } else if (column.source == Source::Time) {
+                FbNode type;
+                type.scalar(0, kNanosecond);
+                field.scalar(2, kTypeTimestamp).child(3, std::move(type));
+            } else {
+                field.scalar(2, kTypeInt).child(3, int_type(column.size, false));
+            }
+            field.child(5, fb_tables({}));
+            fields.push_back(std::move(field));
+        }
+        FbNode schema;
+        schema.scalar(0, static_cast<std::int16_t>(std::endian::native == std::endian::big))
+            .child(1, fb_tables(std::move(fields)));
+        return schema;
+    }
+
+    FileBlock put_dictionary(std::size_t column) {
+        const std::vector<StringId>& values = dictionaries_[column];
+        std::vector<std::int32_t> offsets{0};
+        std::vector<std::uint8_t> text;
+        for (const StringId id : values) {
+            const std::string_view value = strings_.get(id);
+            text.insert(text.end(), value.begin(), value.end());
+            offsets.push_back(static_cast<std::int32_t>(text.size()));
+        }
+        Body body;
+        body.add(nullptr, 0);
+        body.add(offsets.data(), offsets.size() * sizeof(std::int32_t));
+        body.add(text.data(), text.size());
+
+        const auto rows = static_cast<std::int64_t>(values.size());
+        FbNode dictionary;
+        dictionary.scalar(0, static_cast<std::int64_t>(column))
+            .child(1, record_batch(rows, {{rows, 0}}, body.buffers));
+        return put_message(message(kHeaderDictionaryBatch, std::move(dictionary),
+                                   static_cast<std::int64_t>(body.bytes.size())),
+                           body.bytes);
+    }
+
+    FileBlock put_batch(Batch& batch) {
+        Body body;
+        std::vector<FieldNode> nodes;
+        std::vector<std::uint8_t> validity;
+        for (std::size_t i = 0; i < columns_.size(); ++i) {
+            std::vector<std::uint8_t>& values = batch.columns[i];
+            std::int64_t nulls = 0;
+            validity.clear();
+            if (columns_[i].is_string()) {
+                // StringIds become dictionary indices; INVALID_STRING a null
+                validity.assign((batch.rows + 7) / 8, 0);
+                for (std::size_t row = 0; row < batch.rows; ++row) {
+                    const StringId id = string_at(batch, i, row);
+                    std::int32_t slot = 0;
+                    if (id != INVALID_STRING) {
+                        slot = index_[i].at(id);
+                        validity[row / 8] |= static_cast<std::uint8_t>(1U << (row % 8));
+                    } else {
+                        ++nulls;
+                    }
+                    std::memcpy(values.data() + row * sizeof(slot), &slot, sizeof(slot));
+                }
+            }
+            nodes.push_back({static_cast<std::int64_t>(batch.rows), nulls});
+            // Without nulls the validity bitmap may be left out
+            body.add(validity.data(), nulls != 0 ? validity.size() : 0);
+            body.add(values.data(), values.size());
+        }
+        return put_message(message(kHeaderRecordBatch,
+                                   record_batch(static_cast<std::int64_t>(batch.rows), nodes,
+                                                body.buffers),
+                                   static_cast<std::int64_t>(body.bytes.size())),
+                           body.bytes);
+    }
+
+    void put(const void* data, std::size_t size) {
+        file_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        position_ += size;
+    }
+
+    /// @brief Write an encapsulated message: marker, length, metadata, body.
+    FileBlock put_message(const FbNode& header, const std::vector<std::uint8_t>& body) {
+        const std::vector<std::uint8_t> metadata = FbWriter().finish(header);
+        FileBlock block{static_cast<std::int64_t>(position_),
+                        static_cast<std::int32_t>(8 + metadata.size()), 0,
+                        static_cast<std::int64_t>(body.size())};
+        const std::uint32_t marker = 0xFFFFFFFFU;
+        const auto length = static_cast<std::int32_t>(metadata.size());
+        put(&marker, sizeof(marker));
+        put(&length, sizeof(length));
+        put(metadata.data(), metadata.size());
+        put(body.data(), body.size());
+        return block;
+    }
+
+    const std::vector<Column>& columns_;
+    std::vector<Batch>& batches_;
+    const StringPool& strings_;
+    std::vector<std::vector<StringId>> dictionaries_;  ///< Per column, by index
+    std::vector<std::unordered_map<StringId, std::int32_t>> index_;  ///< Per column
+    std::ofstream file_;
+    std::size_t position_ = 0;
+};
+
+}  // namespace
+
+std::optional<ArrowExport> export_arrow(const EventGraph& graph, const StringPool& strings,
+                                        const std::filesystem::path& dir, ThreadPool& pool) {
+    std::error_code error;
+    std::filesystem::create_directories(dir, error);
+    if (error) {
+        return std::nullopt;
+    }
+
+    std::array<std::vector<Column>, kCategoryCount> columns;
+    for (std::size_t c = 0; c < kCategoryCount; ++c) {
+        columns[c] = columns_of(static_cast<Category>(c));
+    }
+    Batches all = graph.parallel_reduce(
+        Batches{},
+        [&columns](Batches& acc, EventView view) {
+            const auto c = static_cast<std::size_t>(view.category());
+            if (c >= kCategoryCount) {
+                return;
+            }
+            std::vector<Batch>& list = acc.categories[c];
+            if (list.empty()) {
+                list.emplace_back().columns.resize(columns[c].size());
+            }
+            append(list.back(), columns[c], view);
+        },
+        [](Batches& acc, Batches&& next) {
+            for (std::size_t c = 0; c < kCategoryCount; ++c) {
+                std::move(next.categories[c].begin(), next.categories[c].end(),
+                          std::back_inserter(acc.categories[c]));
+            }
+        },
+        pool);
+
+    ArrowExport result;
+    std::vector<std::size_t> written;
+    for (std::size_t c = 0; c < kCategoryCount; ++c) {
+        if (all.categories[c].empty()) {
+            continue;
+        }
+        written.push_back(c);
+        result.batches += all.categories[c].size();
+        for (const Batch& batch : all.categories[c]) {
+            result.rows += batch.rows;
+        }
+    }
+    result.files = written.size();
+
+    // One file per task; the caller takes files too, so it never just waits
+    struct Shared {
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> done{0};
+        std::atomic<bool> failed{false};
+    };
+    auto shared = std::make_shared<Shared>();
+    const std::size_t count = written.size();
+    auto work = [shared, count, &written, &columns, &all, &strings, &dir] {
+        for (;;) {
+            const std::size_t i = shared->next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= count) {
+                return;
+            }
+            const std::size_t c = written[i];
+            ArrowFile file(columns[c], all.categories[c], strings);
+            const std::string name(category_name(static_cast<Category>(c)));
+            if (!file.write(dir / (name + ".arrow"))) {
+                shared->failed.store(true, std::memory_order_relaxed);
+            }
+            if (shared->done.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+                shared->done.notify_all();
+            }
+        }
+    };
+    for (std::size_t i = 1; i < (std::min)(count, pool.size()); ++i) {
+        pool.submit(work);
+    }
+    work();
+    for (std::size_t done = shared->done.load(std::memory_order_acquire); done < count;
+         done = shared->done.load(std::memory_order_acquire)) {
+        shared->done.wait(done, std::memory_order_acquire);
+    }
+    if (shared->failed.load(std::memory_order_relaxed)) {
+        return std::nullopt;
+    }
+    return result;
+}
+
+}  // namespace exeray::event
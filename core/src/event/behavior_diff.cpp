@@ -0,0 +1,151 @@
+/// @file behavior_diff.cpp
+/// @brief Normalized behavior feature sets and their differences (platform independent).
+
+#include "exeray/event/behavior_diff.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace exeray::event {
+
+namespace {
+
+constexpr char lower(char c) noexcept {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+constexpr bool is_hex(char c) noexcept {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+}
+
+/// @brief FNV-1a of the text, mixed, with the kind in the top four bits.
+std::uint64_t feature_hash(FeatureKind kind, std::string_view text) noexcept {
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (const char c : text) {
+        hash = (hash ^ static_cast<std::uint8_t>(c)) * 1099511628211ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    return (static_cast<std::uint64_t>(kind) << 60) | (hash >> 4);
+}
+
+/// @brief Append a lower-case path component with hex runs holding digits as '#'.
+void append_component(std::string& out, std::string_view component) {
+    std::size_t i = 0;
+    while (i < component.size()) {
+        const char c = lower(component[i]);
+        if (!is_hex(c)) {
+            out += c;
+            ++i;
+            continue;
+        }
+        std::size_t end = i;
+        bool digit = false;
+        while (end < component.size() && is_hex(lower(component[end]))) {
+            digit |= component[end] >= '0' && component[end] <= '9';
+            ++end;
+        }
+        if (digit) {
+            out += '#';
+        } else {
+            std::transform(component.begin() + static_cast<std::ptrdiff_t>(i),
+                           component.begin() + static_cast<std::ptrdiff_t>(end),
+                           std::back_inserter(out), lower);
+        }
+        i = end;
+    }
+}
+
+}  // namespace
+
+std::string normalize_behavior_path(std::string_view path) {
+    std::string out;
+    out.reserve(path.size());
+    bool user = false;  // The component is the one after "\users\"
+    std::size_t start = 0;
+    while (start <= path.size()) {
+        std::size_t end = path.find_first_of("\\/", start);
+        if (end == std::string_view::npos) {
+            end = path.size();
+        }
+        const std::string_view component = path.substr(start, end - start);
+        if (start != 0) {
+            out += '\\';
+        }
+        const std::size_t at = out.size();
+        if (user && !component.empty()) {
+            out += '*';
+        } else {
+            append_component(out, component);
+        }
+        user = std::string_view(out).substr(at) == "users";
+        start = end + 1;
+    }
+    return out;
+}
+
+BehaviorSet BehaviorSet::from_graph(const EventGraph& graph, const StringPool& strings,
+                                    const FilterSpec& scope) {
+    BehaviorSet set;
+    const auto resolve = [&strings](StringId id) { return strings.get(id); };
+    graph.for_each_where(scope, [&](EventView view) { set.add(view, resolve); });
+    set.seal();
+    return set;
+}
+
+BehaviorSet BehaviorSet::from_log(const MappedEventLog& log, const FilterSpec& scope) {
+    BehaviorSet set;
+    const auto resolve = [&log](StringId id) { return log.resolve_string(id); };
+    log.for_each_in_range(scope.from, scope.to, [&](EventView view) {
+        if (scope.matches(view)) {
+            set.add(view, resolve);
+        }
+    });
+    set.seal();
+    return set;
+}
+
+std::uint64_t BehaviorSet::add_text(FeatureKind kind, std::string_view text) {
+    std::string normalized;
+    if (kind == FeatureKind::File || kind == FeatureKind::Registry ||
+        kind == FeatureKind::Module) {
+        normalized = normalize_behavior_path(text);
+    } else {
+        std::transform(text.begin(), text.end(), std::back_inserter(normalized), lower);
+        if (kind == FeatureKind::Domain && !normalized.empty() && normalized.back() == '.') {
+            normalized.pop_back();  // Fully qualified form
+        }
+    }
+    const std::uint64_t feature = feature_hash(kind, normalized);
+    if (names_.try_emplace(feature, std::move(normalized)).second) {
+        features_.push_back(feature);
+    }
+    return feature;
+}
+
+void BehaviorSet::seal() {
+    std::sort(features_.begin(), features_.end());
+}
+
+bool BehaviorSet::contains(std::uint64_t feature) const noexcept {
+    return std::binary_search(features_.begin(), features_.end(), feature);
+}
+
+std::string_view BehaviorSet::describe(std::uint64_t feature) const noexcept {
+    const auto it = names_.find(feature);
+    return it != names_.end() ? std::string_view(it->second) : std::string_view();
+}
+
+BehaviorDiff diff_behavior(const BehaviorSet& before, const BehaviorSet& after) {
+    BehaviorDiff diff;
+    const auto a = before.features();
+    const auto b = after.features();
+    std::set_difference(b.begin(), b.end(), a.begin(), a.end(), std::back_inserter(diff.added));
+    std::set_difference(a.begin(), a.end(), b.begin(), b.end(),
+                        std::back_inserter(diff.removed));
+    diff.shared = b.size() - diff.added.size();
+    return diff;
+}
+
+}  // namespace exeray::event
@@ -0,0 +1,435 @@
+#include "exeray/event/columns.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace exeray::event {
+
+namespace {
+
+/// @brief AND the result of pred(column[row]) into mask, 64 rows per word.
+template <typename T, typename Pred>
+void apply(const T* column, std::size_t rows, std::uint64_t* mask, Pred pred) noexcept {
+    for (std::size_t word = 0; word < rows / 64; ++word) {
+        const T* block = column + word * 64;
+        std::uint64_t bits = 0;
+        for (std::size_t j = 0; j < 64; ++j) {
+            bits |= static_cast<std::uint64_t>(pred(block[j])) << j;
+        }
+        mask[word] &= bits;
+    }
+}
+
+/// @brief Whether a filter restricts the time range.
+bool has_time_range(const FilterSpec& spec) noexcept {
+    return spec.from != 0 || spec.to != std::numeric_limits<Timestamp>::max();
+}
+
+/// @brief Evaluate the fixed-offset predicates for up to 64 nodes.
+std::uint64_t match_fixed_scalar(const EventNode* nodes, std::size_t rows,
+                                 const FilterSpec& spec) noexcept {
+    std::uint64_t bits = 0;
+    for (std::size_t j = 0; j < rows; ++j) {
+        const EventNode& node = nodes[j];
+        const bool ok =
+            node.timestamp >= spec.from && node.timestamp <= spec.to &&
+            (spec.categories == 0 ||
+             ((spec.categories >> static_cast<std::uint32_t>(node.payload.category)) & 1u) != 0) &&
+            (spec.statuses == 0 ||
+             ((spec.statuses >> static_cast<std::uint32_t>(node.status)) & 1u) != 0) &&
+            (spec.operation < 0 || node.operation == static_cast<std::uint8_t>(spec.operation)) &&
+            (spec.correlation_id == 0 || node.correlation_id == spec.correlation_id);
+        bits |= static_cast<std::uint64_t>(ok) << j;
+    }
+    return bits;
+}
+
+#if defined(__AVX2__)
+
+static_assert(offsetof(EventNode, timestamp) == 16, "kernel assumes timestamp at 16");
+static_assert(offsetof(EventNode, correlation_id) == 24, "kernel assumes correlation at 24");
+static_assert(offsetof(EventNode, status) == 28, "kernel assumes status at 28");
+static_assert(offsetof(EventNode, operation) == 29, "kernel assumes operation at 29");
+static_assert(offsetof(EventNode, payload) == 32, "kernel assumes payload at 32");
+
+/// @brief Set-membership test: (1 << value) & set != 0, per 32-bit lane.
+__m256i in_set(__m256i value, std::uint32_t set) noexcept {
+    const __m256i bit = _mm256_sllv_epi32(_mm256_set1_epi32(1), value);
+    const __m256i hit = _mm256_and_si256(bit, _mm256_set1_epi32(static_cast<int>(set)));
+    return _mm256_xor_si256(_mm256_cmpeq_epi32(hit, _mm256_setzero_si256()),
+                            _mm256_set1_epi32(-1));
+}
+
+/// @brief Unsigned a > b for 64-bit lanes.
+__m256i greater_u64(__m256i a, __m256i b) noexcept {
+    const __m256i sign = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ULL));
+    return _mm256_cmpgt_epi64(_mm256_xor_si256(a, sign), _mm256_xor_si256(b, sign));
+}
+
+/// @brief Evaluate the fixed-offset predicates for exactly 64 nodes.
+std::uint64_t match_fixed_avx2(const EventNode* nodes, const FilterSpec& spec) noexcept {
+    // Byte offsets of 8 consecutive nodes
+    const __m256i stride = _mm256_setr_epi32(0, 64, 128, 192, 256, 320, 384, 448);
+    const __m128i stride4 = _mm_setr_epi32(0, 64, 128, 192);
+    const bool time = has_time_range(spec);
+    const __m256i from = _mm256_set1_epi64x(static_cast<long long>(spec.from));
+    const __m256i to = _mm256_set1_epi64x(static_cast<long long>(spec.to));
+    const __m256i low_byte = _mm256_set1_epi32(0xFF);
+
+    std::uint64_t bits = 0;
+    for (std::size_t group = 0; group < 8; ++group) {
+        const auto* base = reinterpret_cast<const char*>(nodes + group * 8);
+        __m256i keep = _mm256_set1_epi32(-1);
+
+        if (spec.categories != 0) {
+            const __m256i cat = _mm256_and_si256(
+                _mm256_i32gather_epi32(reinterpret_cast<const int*>(base + 32), stride, 1),
+                low_byte);
+            keep = _mm256_and_si256(keep, in_set(cat, spec.categories));
+        }
+        if (spec.statuses != 0 || spec.operation >= 0) {
+            // status and operation share one dword at offset 28
+            const __m256i word =
+                _mm256_i32gather_epi32(reinterpret_cast<const int*>(base + 28), stride, 1);
+            if (spec.statuses != 0) {
+                keep = _mm256_and_si256(
+                    keep, in_set(_mm256_and_si256(word, low_byte), spec.statuses));
+            }
+            if (spec.operation >= 0) {
+                const __m256i op = _mm256_and_si256(_mm256_srli_epi32(word, 8), low_byte);
+                keep = _mm256_and_si256(
+                    keep, _mm256_cmpeq_epi32(op, _mm256_set1_epi32(spec.operation)));
+            }
+        }
+        if (spec.correlation_id != 0) {
+            const __m256i corr =
+                _mm256_i32gather_epi32(reinterpret_cast<const int*>(base + 24), stride, 1);
+            keep = _mm256_and_si256(
+                keep, _mm256_cmpeq_epi32(
+                          corr, _mm256_set1_epi32(static_cast<int>(spec.correlation_id))));
+        }
+
+        auto lanes = static_cast<std::uint64_t>(
+            _mm256_movemask_ps(_mm256_castsi256_ps(keep)));
+        if (time && lanes != 0) {
+            std::uint64_t in_range = 0;
+            for (int half = 0; half < 2; ++half) {
+                const __m256i ts = _mm256_i32gather_epi64(
+                    reinterpret_cast<const long long*>(base + 16 + half * 256), stride4, 1);
+                const __m256i out =
+                    _mm256_or_si256(greater_u64(from, ts), greater_u64(ts, to));
+                const auto rejected = static_cast<std::uint64_t>(
+                    _mm256_movemask_pd(_mm256_castsi256_pd(out)));
+                in_range |= (~rejected & 0xFu) << (half * 4);
+            }
+            lanes &= in_range;
+        }
+        bits |= lanes << (group * 8);
+    }
+    return bits;
+}
+
+#endif  // __AVX2__
+
+/// @brief AND every predicate of spec into mask (rows / 64 words).
+void narrow_columns(const SegmentColumns& columns, std::size_t rows, const FilterSpec& spec,
+                    std::uint64_t* mask) noexcept {
+    if (has_time_range(spec)) {
+        const auto from = spec.from;
+        const auto to = spec.to;
+        apply(columns.timestamps, rows, mask,
+              [from, to](Timestamp ts) { return ts >= from && ts <= to; });
+    }
+    if (spec.categories != 0) {
+        const auto set = spec.categories;
+        apply(columns.categories, rows, mask, [set](Category cat) {
+            return ((set >> static_cast<std::uint32_t>(cat)) & 1u) != 0;
+        });
+    }
+    if (spec.statuses != 0) {
+        const auto set = spec.statuses;
+        apply(columns.statuses, rows, mask, [set](Status status) {
+            return ((set >> static_cast<std::uint32_t>(status)) & 1u) != 0;
+        });
+    }
+    if (spec.operation >= 0) {
+        const auto op = static_cast<std::uint8_t>(spec.operation);
+        apply(columns.operations, rows, mask, [op](std::uint8_t v) { return v == op; });
+    }
+    if (spec.pid != 0) {
+        const auto pid = spec.pid;
+        apply(columns.pids, rows, mask, [pid](std::uint32_t v) { return v == pid; });
+    }
+    if (spec.remote_port != 0) {
+        const auto port = spec.remote_port;
+        apply(columns.remote_ports, rows, mask,
+              [port](std::uint16_t v) { return v == port; });
+    }
+    if (spec.correlation_id != 0) {
+        const auto id = spec.correlation_id;
+        apply(columns.correlation_ids, rows, mask,
+              [id](std::uint32_t v) { return v == id; });
+    }
+}
+
+/// @brief Fill groups from a key column: (key, row) pairs sorted by key.
+template <typename T>
+void group_rows(RowGroups& groups, const T* column, std::size_t rows) {
+    std::vector<std::uint64_t> pairs(rows);
+    if constexpr (sizeof(T) == 1) {
+        // Few distinct keys: a counting sort keeps rows ascending per key
+        std::array<std::uint32_t, 257> starts{};
+        for (std::size_t row = 0; row < rows; ++row) {
+            ++starts[static_cast<std::size_t>(column[row]) + 1];
+        }
+        for (std::size_t key = 1; key < starts.size(); ++key) {
+            starts[key] += starts[key - 1];
+        }
+        for (std::size_t row = 0; row < rows; ++row) {
+            pairs[starts[static_cast<std::size_t>(column[row])]++] =
+                static_cast<std::uint64_t>(column[row]) << 16 | row;
+        }
+    } else {
+        for (std::size_t row = 0; row < rows; ++row) {
+            pairs[row] = static_cast<std::uint64_t>(column[row]) << 16 | row;
+        }
+        std::sort(pairs.begin(), pairs.end());
+    }
+
+    const std::size_t words = rows / 64;
+    std::uint32_t keys = 0;
+    std::int16_t dense_slots = 0;
+    for (std::size_t i = 0; i < rows;) {
+        const auto key = static_cast<std::uint32_t>(pairs[i] >> 16);
+        const std::size_t begin = i;
+        for (; i < rows && static_cast<std::uint32_t>(pairs[i] >> 16) == key; ++i) {
+            groups.rows[i] = static_cast<std::uint16_t>(pairs[i] & 0xFFFF);
+        }
+        groups.keys[keys] = key;
+        groups.offsets[keys] = static_cast<std::uint32_t>(begin);
+        groups.dense[keys] = -1;
+        if (i - begin >= RowGroups::kDenseRows) {
+            std::uint64_t* bitmap = groups.bitmaps + static_cast<std::size_t>(dense_slots) * words;
+            std::fill_n(bitmap, words, std::uint64_t{0});
+            for (std::size_t j = begin; j < i; ++j) {
+                bitmap[groups.rows[j] >> 6] |= std::uint64_t{1} << (groups.rows[j] & 63);
+            }
+            groups.dense[keys] = dense_slots++;
+        }
+        ++keys;
+    }
+    groups.offsets[keys] = static_cast<std::uint32_t>(rows);
+    groups.key_count = keys;
+}
+
+/// @brief The two bits of a Bloom filter of words * 64 bits that key sets.
+template <std::size_t Words>
+std::array<std::size_t, 2> bloom_bits(std::uint32_t key) noexcept {
+    const std::uint64_t hash = (static_cast<std::uint64_t>(key) + 1) * 0x9E3779B97F4A7C15ULL;
+    constexpr std::size_t kBits = Words * 64;
+    return {static_cast<std::size_t>(hash >> 40) % kBits,
+            static_cast<std::size_t>(hash >> 16) % kBits};
+}
+
+template <std::size_t Words>
+void bloom_add(std::array<std::uint64_t, Words>& bloom, std::uint32_t key) noexcept {
+    for (const std::size_t bit : bloom_bits<Words>(key)) {
+        bloom[bit / 64] |= std::uint64_t{1} << (bit % 64);
+    }
+}
+
+template <std::size_t Words>
+bool bloom_may_contain(const std::array<std::uint64_t, Words>& bloom,
+                       std::uint32_t key) noexcept {
+    for (const std::size_t bit : bloom_bits<Words>(key)) {
+        if ((bloom[bit / 64] & (std::uint64_t{1} << (bit % 64))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief OR the rows of key into out (rows / 64 words).
+void or_key(const RowGroups& groups, std::uint32_t key, std::size_t rows,
+            std::uint64_t* out) noexcept {
+    const std::uint32_t* keys = groups.keys;
+    const std::uint32_t* keys_end = keys + groups.key_count;
+    const std::uint32_t* it = std::lower_bound(keys, keys_end, key);
+    if (it == keys_end || *it != key) {
+        return;
+    }
+    const auto k = static_cast<std::size_t>(it - keys);
+    if (groups.dense[k] >= 0) {
+        const std::size_t words = rows / 64;
+        const std::uint64_t* bitmap =
+            groups.bitmaps + static_cast<std::size_t>(groups.dense[k]) * words;
+        for (std::size_t word = 0; word < words; ++word) {
+            out[word] |= bitmap[word];
+        }
+        return;
+    }
+    for (std::size_t i = groups.offsets[k]; i < groups.offsets[k + 1]; ++i) {
+        out[groups.rows[i] >> 6] |= std::uint64_t{1} << (groups.rows[i] & 63);
+    }
+}
+
+}  // namespace
+
+void store_columns(const SegmentColumns& columns, std::size_t i,
+                   const EventNode& node) noexcept {
+    columns.timestamps[i] = node.timestamp;
+    columns.correlation_ids[i] = node.correlation_id;
+    columns.pids[i] = event_pid(node.payload);
+    columns.remote_ports[i] = event_remote_port(node.payload);
+    columns.categories[i] = node.payload.category;
+    columns.operations[i] = node.operation;
+    columns.statuses[i] = node.status;
+}
+
+void filter_columns(const SegmentColumns& columns, std::size_t rows,
+                    const FilterSpec& spec, std::uint64_t* mask) noexcept {
+    assert(rows % 64 == 0 && "rows must be a multiple of 64");
+    std::fill_n(mask, rows / 64, ~std::uint64_t{0});
+    narrow_columns(columns, rows, spec, mask);
+}
+
+void store_bitmaps(SegmentBitmaps& bitmaps, const SegmentColumns& columns,
+                   std::size_t rows) {
+    assert(rows % 64 == 0 && rows <= RowGroups::kMaxRows && "rows out of range");
+    group_rows(bitmaps.categories, columns.categories, rows);
+    group_rows(bitmaps.statuses, columns.statuses, rows);
+    group_rows(bitmaps.correlations, columns.correlation_ids, rows);
+    bitmaps.statuses_current.store(true, std::memory_order_release);
+}
+
+bool filter_sealed(const SegmentColumns& columns, const SegmentBitmaps* bitmaps,
+                   std::size_t rows, const FilterSpec& spec, std::uint64_t* mask) noexcept {
+    const std::uint32_t statuses =
+        bitmaps != nullptr && bitmaps->statuses_current.load(std::memory_order_acquire)
+            ? spec.statuses
+            : 0;
+    if (bitmaps == nullptr ||
+        (spec.categories == 0 && statuses == 0 && spec.correlation_id == 0)) {
+        filter_columns(columns, rows, spec, mask);
+        return true;
+    }
+
+    const std::size_t words = rows / 64;
+    std::fill_n(mask, words, ~std::uint64_t{0});
+    std::uint64_t selected[RowGroups::kMaxRows / 64];
+    const auto intersect = [&](const RowGroups& groups, std::uint32_t set, bool bitset) {
+        std::fill_n(selected, words, std::uint64_t{0});
+        if (bitset) {
+            for (; set != 0; set &= set - 1) {
+                or_key(groups, static_cast<std::uint32_t>(std::countr_zero(set)), rows, selected);
+            }
+        } else {
+            or_key(groups, set, rows, selected);
+        }
+        std::uint64_t any = 0;
+        for (std::size_t word = 0; word < words; ++word) {
+            mask[word] &= selected[word];
+            any |= mask[word];
+        }
+        return any != 0;
+    };
+    if ((spec.categories != 0 && !intersect(bitmaps->categories, spec.categories, true)) ||
+        (statuses != 0 && !intersect(bitmaps->statuses, statuses, true)) ||
+        (spec.correlation_id != 0 &&
+         !intersect(bitmaps->correlations, spec.correlation_id, false))) {
+        std::fill_n(mask, words, std::uint64_t{0});
+        return false;
+    }
+
+    FilterSpec rest = spec;
+    rest.categories = 0;
+    rest.statuses = statuses != 0 ? 0 : spec.statuses;
+    rest.correlation_id = 0;
+    narrow_columns(columns, rows, rest, mask);
+    return true;
+}
+
+bool SegmentZone::may_match(const FilterSpec& spec) const noexcept {
+    return (spec.categories == 0 || (spec.categories & categories) != 0) &&
+           (spec.statuses == 0 ||
+            (spec.statuses & statuses.load(std::memory_order_acquire)) != 0) &&
+           (spec.pid == 0 || bloom_may_contain(pids, spec.pid)) &&
+           (spec.string_id == INVALID_STRING || bloom_may_contain(strings, spec.string_id));
+}
+
+void zone_add_pid(std::array<uint64_t, SegmentZone::kPidWords>& bloom, uint32_t pid) noexcept {
+    bloom_add(bloom, pid);
+}
+
+bool zone_may_hold_pid(const std::array<uint64_t, SegmentZone::kPidWords>& bloom,
+                       uint32_t pid) noexcept {
+    return bloom_may_contain(bloom, pid);
+}
+
+void store_zone(SegmentZone& zone, const SegmentColumns& columns, const EventNode* nodes,
+                std::size_t rows) noexcept {
+    std::uint32_t categories = 0;
+    std::uint32_t statuses = 0;
+    zone.pids.fill(0);
+    zone.strings.fill(0);
+    for (std::size_t i = 0; i < rows; ++i) {
+        categories |= 1u << static_cast<std::uint32_t>(columns.categories[i]);
+        statuses |= 1u << static_cast<std::uint32_t>(columns.statuses[i]);
+        if (columns.pids[i] != 0) {
+            bloom_add(zone.pids, columns.pids[i]);
+        }
+        for_each_string(nodes[i].payload, [&zone](StringId id) {
+            if (id != INVALID_STRING) {
+                bloom_add(zone.strings, id);
+            }
+        });
+    }
+    zone.categories = categories;
+    zone.statuses.store(statuses, std::memory_order_release);
+}
+
+void filter_nodes(const EventNode* nodes, std::size_t rows, const FilterSpec& spec,
+                  std::uint64_t* mask) noexcept {
+    for (std::size_t word = 0; word * 64 < rows; ++word) {
+        const EventNode* block = nodes + word * 64;
+        const std::size_t n = (std::min)(std::size_t{64}, rows - word * 64);
+#if defined(__AVX2__)
+        std::uint64_t bits = n == 64 ? match_fixed_avx2(block, spec)
+                                     : match_fixed_scalar(block, n, spec);
+#else
+        std::uint64_t bits = match_fixed_scalar(block, n, spec);
+#endif
+        if (spec.pid != 0 || spec.remote_port != 0 || spec.string_id != INVALID_STRING) {
+            for (auto rest = bits; rest != 0; rest &= rest - 1) {
+                const auto j = static_cast<std::size_t>(std::countr_zero(rest));
+                const EventPayload& payload = block[j].payload;
+                if ((spec.pid != 0 && event_pid(payload) != spec.pid) ||
+                    (spec.remote_port != 0 &&
+                     event_remote_port(payload) != spec.remote_port) ||
+                    (spec.string_id != INVALID_STRING &&
+                     !carries_string(payload, spec.string_id))) {
+                    bits &= ~(std::uint64_t{1} << j);
+                }
+            }
+        }
+        mask[word] = bits;
+    }
+}
+
+bool filter_kernels_vectorized() noexcept {
+#if defined(__AVX2__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+}  // namespace exeray::event
@@ -2,40 +2,246 @@
 /// @brief Event Correlation Engine implementation.
 
 #include "exeray/event/correlator.hpp"
+#include "exeray/event/columns.hpp"
+#include "exeray/event/graph.hpp"
 #include "exeray/event/payload.hpp"
 
+#include <algorithm>
+#include <bit>
+
 #include <mutex>
+#include <utility>
+#include <vector>
 
 namespace exeray::event {
 
+namespace {
+
+/// @brief How an event is correlated: owning PID, parent PID, and which
+/// PID's ProcessCreate is its parent event (0 = none).
+struct Keys {
+    uint32_t pid = 0;
+    uint32_t parent_pid = 0;
+    uint32_t parent_of = 0;
+};
+
+/// ETW header PID of events not attributed to a process.
+constexpr uint32_t kNoHeaderPid = 0xFFFFFFFF;
+
+Keys correlation_keys(const PendingEvent& event) {
+    const EventPayload& payload = event.payload;
+    if (payload.category == Category::Process) {
+        // Parent is the parent process's create event
+        return {payload.process.pid, payload.process.parent_pid, payload.process.parent_pid};
+    }
+    // Parent is the owning process: the payload's own PID where it has one
+    // (Thread, Memory, Image, Security), else the event header's
+    uint32_t pid = event_pid(payload);
+    if (pid == 0 && event.pid != kNoHeaderPid) {
+        pid = event.pid;
+    }
+    return {pid, 0, pid};
+}
+
+}  // namespace
+
 // =============================================================================
-// Parent Lookups
+// Shard Locks
 // =============================================================================
 
-EventId Correlator::find_process_parent(uint32_t parent_pid) {
-    if (parent_pid == 0) {
-        return INVALID_EVENT;
+/// @brief Locks a set of shards in ascending order, so that two holders of
+/// overlapping sets never wait on each other in a cycle.
+template <bool Exclusive>
+class Correlator::ShardLock {
+public:
+    ShardLock(const Correlator& correlator, uint32_t mask) noexcept
+        : shards_(correlator.shards_.data()), mask_(mask) {
+        for (uint32_t bits = mask_; bits != 0; bits &= bits - 1) {
+            auto& mutex = shards_[std::countr_zero(bits)].mutex;
+            if constexpr (Exclusive) {
+                mutex.lock();
+            } else {
+                mutex.lock_shared();
+            }
+        }
+    }
+
+    ~ShardLock() {
+        for (uint32_t bits = mask_; bits != 0; bits &= bits - 1) {
+            auto& mutex = shards_[std::countr_zero(bits)].mutex;
+            if constexpr (Exclusive) {
+                mutex.unlock();
+            } else {
+                mutex.unlock_shared();
+            }
+        }
     }
 
-    std::shared_lock lock(mutex_);
-    auto it = process_events_.find(parent_pid);
-    if (it != process_events_.end()) {
-        return it->second;
+    ShardLock(const ShardLock&) = delete;
+    ShardLock& operator=(const ShardLock&) = delete;
+
+private:
+    const Shard* shards_;
+    uint32_t mask_;
+};
+
+// =============================================================================
+// Incarnations
+// =============================================================================
+
+namespace {
+
+/// @brief Newest life of history started at time at (0 = newest), or nullptr.
+template <typename History>
+auto* life_at(History& history, Timestamp at) noexcept {
+    decltype(&history.lives[0]) found = nullptr;
+    for (std::size_t i = history.count; i-- > 0;) {
+        if (at == 0 || history.lives[i].start <= at) {
+            found = &history.lives[i];
+            break;
+        }
     }
-    return INVALID_EVENT;
+    return found;
 }
 
-EventId Correlator::find_thread_parent(uint32_t pid) {
-    if (pid == 0) {
-        return INVALID_EVENT;
+}  // namespace
+
+Correlator::Incarnation* Correlator::find(uint32_t pid, Timestamp at) noexcept {
+    auto& processes = shard(pid).processes;
+    auto it = processes.find(pid);
+    return it != processes.end() ? life_at(it->second, at) : nullptr;
+}
+
+const Correlator::Incarnation* Correlator::find(uint32_t pid, Timestamp at) const noexcept {
+    const auto& processes = shard(pid).processes;
+    auto it = processes.find(pid);
+    return it != processes.end() ? life_at(it->second, at) : nullptr;
+}
+
+Correlator::Incarnation& Correlator::open(uint32_t pid, Timestamp start) {
+    Shard& owner = shard(pid);
+    auto it = owner.processes.find(pid);
+    if (it == owner.processes.end()) {
+        // Make room by forgetting the longest-dead processes; a PID reused
+        // since it was retired is still running and stays
+        while (!owner.retired.empty() && (owner.processes.size() >= kMaxPidsPerShard ||
+                                          owner.retired.size() > kMaxPidsPerShard)) {
+            const uint32_t old = owner.retired.front();
+            owner.retired.pop_front();
+            auto dead = owner.processes.find(old);
+            if (dead != owner.processes.end() && dead->second.count > 0 &&
+                dead->second.lives[dead->second.count - 1].stop != 0) {
+                owner.processes.erase(dead);
+            }
+        }
+        it = owner.processes.try_emplace(pid).first;
+    }
+
+    // Keep lives ordered by start, dropping the oldest when full
+    History& history = it->second;
+    if (history.count == kHistory) {
+        std::move(history.lives.begin() + 1, history.lives.end(), history.lives.begin());
+        --history.count;
     }
+    std::size_t slot = history.count;
+    while (slot > 0 && history.lives[slot - 1].start > start) {
+        history.lives[slot] = history.lives[slot - 1];
+        --slot;
+    }
+    history.lives[slot] = Incarnation{start, 0, INVALID_EVENT, 0};
+    ++history.count;
+    return history.lives[slot];
+}
 
-    std::shared_lock lock(mutex_);
-    auto it = process_events_.find(pid);
-    if (it != process_events_.end()) {
-        return it->second;
+uint32_t Correlator::assign_correlation(Incarnation& life, uint32_t parent_pid, Timestamp at) {
+    if (life.correlation_id == 0) {
+        // Try to inherit from the parent process alive at the time
+        const Incarnation* parent = parent_pid != 0 ? find(parent_pid, at) : nullptr;
+        life.correlation_id = parent != nullptr ? parent->correlation_id : 0;
+        // Generate new correlation ID if not inherited
+        if (life.correlation_id == 0) {
+            life.correlation_id = next_correlation_.fetch_add(1, std::memory_order_relaxed);
+        }
     }
-    return INVALID_EVENT;
+    return life.correlation_id;
+}
+
+template <bool Write>
+bool Correlator::resolve_event(PendingEvent& event, Burst& burst) {
+    const Keys keys = correlation_keys(event);
+    const Timestamp at = event.timestamp;
+    const bool process = event.payload.category == Category::Process;
+
+    // Bursts from one process resolve like the previous event without any
+    // lookup, as long as they fall in its newest incarnation
+    if (process) {
+        burst.pid = 0;  // May start or end an incarnation
+    } else if (keys.pid != 0 && keys.pid == burst.pid && (at == 0 || at >= burst.from)) {
+        event.parent = burst.parent;
+        event.correlation_id = burst.correlation_id;
+        return true;
+    }
+
+    const bool creates = process && event.operation == static_cast<uint8_t>(ProcessOp::Create);
+    const bool terminates =
+        process && event.operation == static_cast<uint8_t>(ProcessOp::Terminate);
+
+    event.parent = INVALID_EVENT;
+    if (keys.parent_of != 0) {
+        const Incarnation* parent = find(keys.parent_of, at);
+        if (parent != nullptr) {
+            event.parent = parent->create;
+        }
+    }
+
+    event.correlation_id = 0;
+    if (keys.pid == 0) {
+        return true;
+    }
+    Incarnation* life = find(keys.pid, at);
+    // A create starts a new life unless this one began with it
+    if (creates && life != nullptr && life->start != at) {
+        life = nullptr;
+    }
+    if (life == nullptr || life->correlation_id == 0 || (terminates && life->stop == 0)) {
+        if constexpr (!Write) {
+            return false;
+        } else {
+            if (life == nullptr) {
+                life = &open(keys.pid, creates ? at : 0);
+            }
+            assign_correlation(*life, keys.parent_pid, at);
+            if (terminates && life->stop == 0) {
+                life->stop = std::max<Timestamp>(at, 1);
+                shard(keys.pid).retired.push_back(keys.pid);
+                tree_.stop(life->create, at);
+            }
+        }
+    }
+    event.correlation_id = life->correlation_id;
+    if (!process && life == find(keys.pid, 0)) {
+        burst = Burst{keys.pid, life->start, event.parent, event.correlation_id};
+    }
+    return true;
+}
+
+// =============================================================================
+// Parent Lookups
+// =============================================================================
+
+EventId Correlator::find_process_parent(uint32_t parent_pid, Timestamp at) {
+    if (parent_pid == 0) {
+        return INVALID_EVENT;
+    }
+
+    std::shared_lock lock(shard(parent_pid).mutex);
+    const Incarnation* parent = std::as_const(*this).find(parent_pid, at);
+    return parent != nullptr ? parent->create : INVALID_EVENT;
+}
+
+EventId Correlator::find_thread_parent(uint32_t pid) {
+    // Parent of a thread is its owning process's create event
+    return find_process_parent(pid);
 }
 
 EventId Correlator::find_operation_parent(uint32_t pid) {
@@ -54,38 +260,68 @@ uint32_t Correlator::get_correlation_id(uint32_t pid, uint32_t parent_pid) {
 
     // First check if PID already has a correlation ID (read lock)
     {
-        std::shared_lock lock(mutex_);
-        auto it = pid_correlations_.find(pid);
-        if (it != pid_correlations_.end()) {
-            return it->second;
+        std::shared_lock lock(shard(pid).mutex);
+        const Incarnation* life = std::as_const(*this).find(pid, 0);
+        if (life != nullptr && life->correlation_id != 0) {
+            return life->correlation_id;
         }
     }
 
-    // Need to create a new correlation ID (write lock)
-    std::unique_lock lock(mutex_);
+    // Need to create a new correlation ID (write lock on both shards;
+    // re-checked after acquiring them)
+    ShardLock<true> lock(*this, shard_bit(pid) | shard_bit(parent_pid));
+    Incarnation* life = find(pid, 0);
+    if (life == nullptr) {
+        life = &open(pid, 0);
+    }
+    return assign_correlation(*life, parent_pid, 0);
+}
 
-    // Double-check after acquiring write lock
-    auto it = pid_correlations_.find(pid);
-    if (it != pid_correlations_.end()) {
-        return it->second;
+// =============================================================================
+// Batches
+// =============================================================================
+
+Correlation Correlator::resolve(const PendingEvent& event) {
+    PendingEvent resolved = event;
+    resolve_batch(std::span(&resolved, 1));
+    return {resolved.parent, resolved.correlation_id};
+}
+
+void Correlator::resolve_batch(std::span<PendingEvent> events) {
+    uint32_t read_mask = 0;
+    for (const PendingEvent& event : events) {
+        const Keys keys = correlation_keys(event);
+        read_mask |= shard_bit(keys.parent_of) | shard_bit(keys.pid);
     }
 
-    // Try to inherit from parent process
-    uint32_t corr_id = 0;
-    if (parent_pid != 0) {
-        auto parent_it = pid_correlations_.find(parent_pid);
-        if (parent_it != pid_correlations_.end()) {
-            corr_id = parent_it->second;
+    Burst burst;
+    // Index of the first event that must change state
+    std::size_t first_write = events.size();
+    {
+        ShardLock<false> lock(*this, read_mask);
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            if (!resolve_event<false>(events[i], burst)) {
+                first_write = i;
+                break;
+            }
         }
     }
-
-    // Generate new correlation ID if not inherited
-    if (corr_id == 0) {
-        corr_id = next_correlation_.fetch_add(1, std::memory_order_relaxed);
+    if (first_write == events.size()) {
+        return;
     }
 
-    pid_correlations_[pid] = corr_id;
-    return corr_id;
+    // Resolve the rest in batch order, as with per-event calls
+    const auto rest = events.subspan(first_write);
+    uint32_t write_mask = 0;
+    for (const PendingEvent& event : rest) {
+        const Keys keys = correlation_keys(event);
+        write_mask |= shard_bit(keys.parent_of) | shard_bit(keys.pid) |
+                      shard_bit(keys.parent_pid);
+    }
+    ShardLock<true> lock(*this, write_mask);
+    for (PendingEvent& event : rest) {
+        resolve_event<true>(event, burst);
+    }
 }
 
 // =============================================================================
@@ -98,23 +334,159 @@ void Correlator::register_event(const EventNode& node) {
         return;
     }
 
-    // Check if it's a ProcessCreate operation (op code 0 or 1 typically)
-    // ProcessOp::Create = 0
-    if (node.operation != static_cast<uint8_t>(ProcessOp::Create)) {
+    // ProcessCreate starts an incarnation; a rundown stands in for the
+    // create of a process already running, whose start is unknown
+    const bool rundown = node.operation == static_cast<uint8_t>(ProcessOp::Rundown);
+    if (node.operation != static_cast<uint8_t>(ProcessOp::Create) && !rundown) {
         return;
     }
 
     const auto& proc = node.payload.process;
-    register_process(proc.pid, node.id);
+    register_process(proc.pid, node.id, rundown ? 0 : node.timestamp, node.parent_id);
 }
 
-void Correlator::register_process(uint32_t pid, EventId event_id) {
+void Correlator::register_process(uint32_t pid, EventId event_id, Timestamp start,
+                                  EventId parent) {
     if (pid == 0 || event_id == INVALID_EVENT) {
         return;
     }
 
-    std::unique_lock lock(mutex_);
-    process_events_[pid] = event_id;
+    std::unique_lock lock(shard(pid).mutex);
+    Incarnation* life = find(pid, start);
+    if (life == nullptr || (start != 0 && life->start != start)) {
+        life = &open(pid, start);
+    }
+    life->create = event_id;
+    tree_.add(event_id, parent, pid, start);
+}
+
+// =============================================================================
+// Risk Scores
+// =============================================================================
+
+void Correlator::add_risk(uint32_t pid, uint32_t correlation_id, Timestamp timestamp,
+                          double weight) {
+    if (pid == 0 && correlation_id == 0) {
+        return;
+    }
+    std::lock_guard lock(risk_mutex_);
+    process_risk_.add(pid, timestamp, weight);
+    chain_risk_.add(correlation_id, timestamp, weight);
+    if (risk_hook_ && pid != 0 && process_risk_.score(pid) >= risk_threshold_) {
+        risk_hook_(pid);
+    }
+}
+
+void Correlator::add_risk_batch(std::span<const PendingEvent> events) {
+    const auto suspicious = [](const PendingEvent& event) {
+        return event.status == Status::Suspicious;
+    };
+    auto it = std::find_if(events.begin(), events.end(), suspicious);
+    if (it == events.end()) {
+        return;
+    }
+    std::lock_guard lock(risk_mutex_);
+    for (; it != events.end(); ++it) {
+        if (suspicious(*it)) {
+            const uint32_t pid = event_pid(it->payload);
+            process_risk_.add(pid, it->timestamp);
+            chain_risk_.add(it->correlation_id, it->timestamp);
+            if (risk_hook_ && pid != 0 && process_risk_.score(pid) >= risk_threshold_) {
+                risk_hook_(pid);
+            }
+        }
+    }
+}
+
+void Correlator::on_process_risk(double threshold, RiskHook hook) {
+    std::lock_guard lock(risk_mutex_);
+    risk_threshold_ = threshold;
+    risk_hook_ = std::move(hook);
+}
+
+double Correlator::process_risk(uint32_t pid, Timestamp now) const {
+    std::lock_guard lock(risk_mutex_);
+    return process_risk_.score(pid, now);
+}
+
+std::size_t Correlator::top_processes(std::span<RiskScore> out, Timestamp now) const {
+    std::lock_guard lock(risk_mutex_);
+    return process_risk_.top(out, now);
+}
+
+std::size_t Correlator::top_chains(std::span<RiskScore> out, Timestamp now) const {
+    std::lock_guard lock(risk_mutex_);
+    return chain_risk_.top(out, now);
+}
+
+// =============================================================================
+// Checkpoints
+// =============================================================================
+
+CorrelatorState Correlator::state() const {
+    CorrelatorState state;
+    {
+        ShardLock<false> lock(*this, ~uint32_t{0} >> (32 - kShards));
+        for (const Shard& owner : shards_) {
+            for (const auto& [pid, history] : owner.processes) {
+                for (std::size_t i = 0; i < history.count; ++i) {
+                    const Incarnation& life = history.lives[i];
+                    state.lives.push_back({pid, life.correlation_id, life.start, life.stop});
+                }
+            }
+        }
+        // Read under the locks: resolve_batch() only assigns IDs under them
+        state.next_correlation = next_correlation_.load(std::memory_order_relaxed);
+    }
+
+    std::lock_guard lock(risk_mutex_);
+    state.risk_time = std::max(process_risk_.newest(), chain_risk_.newest());
+    state.process_risk.resize(process_risk_.size());
+    state.process_risk.resize(process_risk_.top(state.process_risk, state.risk_time));
+    state.chain_risk.resize(chain_risk_.size());
+    state.chain_risk.resize(chain_risk_.top(state.chain_risk, state.risk_time));
+    return state;
+}
+
+void Correlator::restore(const CorrelatorState& state) {
+    uint32_t next = state.next_correlation;
+    {
+        ShardLock<true> lock(*this, ~uint32_t{0} >> (32 - kShards));
+        for (const ProcessLife& saved : state.lives) {
+            if (saved.pid == 0) {
+                continue;
+            }
+            Incarnation& life = open(saved.pid, saved.start);
+            life.stop = saved.stop;
+            life.correlation_id = saved.correlation_id;
+            next = std::max(next, saved.correlation_id + 1);
+        }
+
+        // Dead processes are forgotten first when a shard fills, longest
+        // dead first
+        for (Shard& owner : shards_) {
+            std::vector<std::pair<Timestamp, uint32_t>> dead;
+            for (const auto& [pid, history] : owner.processes) {
+                const Timestamp stop = history.lives[history.count - 1].stop;
+                if (stop != 0) {
+                    dead.emplace_back(stop, pid);
+                }
+            }
+            std::sort(dead.begin(), dead.end());
+            for (const auto& [stop, pid] : dead) {
+                owner.retired.push_back(pid);
+            }
+        }
+        uint32_t current = next_correlation_.load(std::memory_order_relaxed);
+        while (current < next &&
+               !next_correlation_.compare_exchange_weak(current, next,
+                                                        std::memory_order_relaxed)) {
+        }
+    }
+
+    std::lock_guard lock(risk_mutex_);
+    process_risk_.restore(state.process_risk, state.risk_time);
+    chain_risk_.restore(state.chain_risk, state.risk_time);
 }
 
 }  // namespace exeray::event
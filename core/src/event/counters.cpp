@@ -0,0 +1,163 @@
+/// @file counters.cpp
+/// @brief Sharded event counters and the bounded per-pid table.
+
+#include "exeray/event/counters.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace exeray::event {
+
+namespace {
+
+/// Linear probe limit in the per-pid table.
+constexpr std::size_t kMaxPidProbe = 32;
+
+/// @brief Shard of the calling thread, assigned round-robin on first use.
+std::size_t this_thread_shard() noexcept {
+    static std::atomic<std::size_t> next{0};
+    thread_local const std::size_t shard =
+        next.fetch_add(1, std::memory_order_relaxed) % EventCounters::kShards;
+    return shard;
+}
+
+}  // namespace
+
+std::uint64_t CounterSnapshot::category(Category cat) const noexcept {
+    std::uint64_t sum = 0;
+    for (const auto n : cells[static_cast<std::size_t>(cat)]) {
+        sum += n;
+    }
+    return sum;
+}
+
+std::uint64_t CounterSnapshot::status(Status st) const noexcept {
+    std::uint64_t sum = 0;
+    for (const auto& row : cells) {
+        sum += row[static_cast<std::size_t>(st)];
+    }
+    return sum;
+}
+
+std::uint64_t CounterSnapshot::total() const noexcept {
+    std::uint64_t sum = 0;
+    for (const auto& row : cells) {
+        for (const auto n : row) {
+            sum += n;
+        }
+    }
+    return sum;
+}
+
+EventCounters::EventCounters()
+    : shards_(std::make_unique<Shard[]>(kShards)),
+      pids_(std::make_unique<PidSlot[]>(kPidSlots)) {}
+
+void EventCounters::update(Category cat, Status status, uint32_t pid,
+                           std::uint64_t delta) noexcept {
+    const auto c = static_cast<std::size_t>(cat);
+    const auto s = static_cast<std::size_t>(status);
+    if (c < CounterSnapshot::kCategoryCount && s < kStatusCount) {
+        Shard& shard = shards_[this_thread_shard()];
+        shard.cells[c * kStatusCount + s].fetch_add(delta, std::memory_order_relaxed);
+        if (delta == 1) {
+            shard.pushed[c].fetch_add(1, std::memory_order_relaxed);
+            if (status == Status::Suspicious) {
+                shard.flagged.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+    if (pid == 0) {
+        return;
+    }
+    // Events are removed only after being added, so a removal never claims a
+    // new slot: it finds the one its add claimed, or counts as untracked
+    PidSlot* slot = find_pid(pid, delta == 1);
+    (slot != nullptr ? slot->count : untracked_).fetch_add(delta, std::memory_order_relaxed);
+}
+
+void EventCounters::restatus(Category cat, Status from, Status to) noexcept {
+    const auto c = static_cast<std::size_t>(cat);
+    const auto f = static_cast<std::size_t>(from);
+    const auto t = static_cast<std::size_t>(to);
+    if (c >= CounterSnapshot::kCategoryCount || f >= kStatusCount || t >= kStatusCount) {
+        return;
+    }
+    Shard& shard = shards_[this_thread_shard()];
+    shard.cells[c * kStatusCount + f].fetch_sub(1, std::memory_order_relaxed);
+    shard.cells[c * kStatusCount + t].fetch_add(1, std::memory_order_relaxed);
+    if (to == Status::Suspicious) {
+        shard.flagged.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+EventCounters::PidSlot* EventCounters::find_pid(uint32_t pid, bool create) const noexcept {
+    // Fibonacci hashing, as for the correlation head table
+    auto pos = static_cast<std::size_t>(
+                   (static_cast<std::uint64_t>(pid) * 0x9E3779B97F4A7C15ULL) >> 32) &
+               (kPidSlots - 1);
+    for (std::size_t probe = 0; probe < kMaxPidProbe; ++probe) {
+        PidSlot& slot = pids_[(pos + probe) & (kPidSlots - 1)];
+        auto key = slot.pid.load(std::memory_order_acquire);
+        if (key == pid) {
+            return &slot;
+        }
+        if (key == 0) {
+            if (!create) {
+                return nullptr;
+            }
+            if (slot.pid.compare_exchange_strong(key, pid, std::memory_order_acq_rel) ||
+                key == pid) {
+                return &slot;
+            }
+        }
+    }
+    return nullptr;
+}
+
+CounterSnapshot EventCounters::snapshot() const noexcept {
+    CounterSnapshot snap;
+    for (std::size_t shard = 0; shard < kShards; ++shard) {
+        const Shard& cells = shards_[shard];
+        for (std::size_t i = 0; i < kCells; ++i) {
+            snap.cells[i / kStatusCount][i % kStatusCount] +=
+                cells.cells[i].load(std::memory_order_relaxed);
+        }
+        for (std::size_t c = 0; c < CounterSnapshot::kCategoryCount; ++c) {
+            snap.pushed[c] += cells.pushed[c].load(std::memory_order_relaxed);
+        }
+        snap.flagged += cells.flagged.load(std::memory_order_relaxed);
+    }
+    return snap;
+}
+
+std::uint64_t EventCounters::pid_count(uint32_t pid) const noexcept {
+    if (pid == 0) {
+        return 0;
+    }
+    const PidSlot* slot = find_pid(pid, false);
+    return slot != nullptr ? slot->count.load(std::memory_order_relaxed) : 0;
+}
+
+std::size_t EventCounters::top_pids(std::span<PidCount> out) const {
+    if (out.empty()) {
+        return 0;
+    }
+    std::vector<PidCount> live;
+    for (std::size_t i = 0; i < kPidSlots; ++i) {
+        const auto pid = pids_[i].pid.load(std::memory_order_acquire);
+        const auto count = pids_[i].count.load(std::memory_order_relaxed);
+        if (pid != 0 && count != 0) {
+            live.push_back(PidCount{pid, count});
+        }
+    }
+    const std::size_t n = (std::min)(out.size(), live.size());
+    std::partial_sort(live.begin(), live.begin() + static_cast<std::ptrdiff_t>(n),
+                      live.end(), [](const PidCount& a, const PidCount& b) {
+                          return a.count != b.count ? a.count > b.count : a.pid < b.pid;
+                      });
+    std::copy_n(live.begin(), n, out.begin());
+    return n;
+}
+
+}  // namespace exeray::event
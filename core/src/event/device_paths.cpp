@@ -0,0 +1,135 @@
+/// @file device_paths.cpp
+/// @brief NT device to DOS drive map behind StringPool::intern_path().
+
+#include "exeray/event/device_paths.hpp"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+#include "exeray/event/utf8.hpp"
+#endif
+
+namespace exeray::event {
+
+namespace {
+
+/// Prefix of every NT device path.
+constexpr std::string_view kDevicePrefix = "\\Device\\";
+
+constexpr char fold(char c) noexcept {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool starts_with_icase(std::string_view str, std::string_view prefix) noexcept {
+    return str.size() >= prefix.size() &&
+           std::equal(prefix.begin(), prefix.end(), str.begin(),
+                      [](char a, char b) { return fold(a) == fold(b); });
+}
+
+std::int64_t now_ticks() noexcept {
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+}  // namespace
+
+DevicePathMap::DevicePathMap(bool auto_refresh) : auto_refresh_(auto_refresh) {
+    std::lock_guard lock(mutex_);
+    // UNC redirector: \Device\Mup\server\share -> \\server\share
+    publish(Snapshot{Entry{"\\Device\\Mup", "\\", false}});
+}
+
+void DevicePathMap::refresh() {
+    last_refresh_.store(now_ticks(), std::memory_order_relaxed);
+    Snapshot from_os;
+#ifdef _WIN32
+    wchar_t target[MAX_PATH];
+    for (wchar_t letter = L'A'; letter <= L'Z'; ++letter) {
+        const wchar_t drive[3] = {letter, L':', L'\0'};
+        // The first string of the result is the current mapping
+        if (QueryDosDeviceW(drive, target, MAX_PATH) == 0) {
+            continue;
+        }
+        from_os.push_back(Entry{to_utf8(target), std::string{static_cast<char>(letter), ':'},
+                                true});
+    }
+#endif
+
+    std::lock_guard lock(mutex_);
+    Snapshot entries;
+    for (const auto& entry : *current_.load(std::memory_order_acquire)) {
+        if (!entry.from_os) {
+            entries.push_back(entry);
+        }
+    }
+    entries.insert(entries.end(), from_os.begin(), from_os.end());
+    publish(std::move(entries));
+}
+
+void DevicePathMap::set(std::string_view device, std::string_view dos) {
+    std::lock_guard lock(mutex_);
+    Snapshot entries = *current_.load(std::memory_order_acquire);
+    const auto existing = std::find_if(entries.begin(), entries.end(), [device](const Entry& e) {
+        return e.device.size() == device.size() && starts_with_icase(e.device, device);
+    });
+    if (existing != entries.end()) {
+        *existing = Entry{std::string(device), std::string(dos), false};
+    } else {
+        entries.push_back(Entry{std::string(device), std::string(dos), false});
+    }
+    publish(std::move(entries));
+}
+
+std::size_t DevicePathMap::match(std::string_view path, std::string_view& dos) {
+    if (!starts_with_icase(path, kDevicePrefix)) {
+        return 0;
+    }
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        for (const auto& entry : *current_.load(std::memory_order_acquire)) {
+            const auto len = entry.device.size();
+            if (starts_with_icase(path, entry.device) &&
+                (path.size() == len || path[len] == '\\')) {
+                dos = entry.dos;
+                return len;
+            }
+        }
+        if (!auto_refresh_ || attempt > 0) {
+            break;
+        }
+        refresh_on_miss();
+    }
+    return 0;
+}
+
+std::size_t DevicePathMap::size() const noexcept {
+    return current_.load(std::memory_order_acquire)->size();
+}
+
+void DevicePathMap::publish(Snapshot entries) {
+    const Snapshot* current = current_.load(std::memory_order_relaxed);
+    if (current != nullptr && *current == entries) {
+        return;  // Repeated refreshes for unmapped devices add nothing
+    }
+    snapshots_.push_back(std::make_unique<Snapshot>(std::move(entries)));
+    current_.store(snapshots_.back().get(), std::memory_order_release);
+}
+
+void DevicePathMap::refresh_on_miss() {
+    const auto interval =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(kRefreshInterval)
+            .count();
+    auto last = last_refresh_.load(std::memory_order_relaxed);
+    const auto now = now_ticks();
+    // One thread per interval wins the CAS and refreshes
+    if (now - last < interval ||
+        !last_refresh_.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        return;
+    }
+    refresh();
+}
+
+}  // namespace exeray::event
@@ -0,0 +1,573 @@
+/// @file event_log.cpp
+/// @brief Event log writer and replay (platform independent).
+
+#include "exeray/event/event_log.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <unordered_map>
+
+#include "exeray/event/log_codec.hpp"
+#include "exeray/event/payload_visit.hpp"
+#include "exeray/task_graph.hpp"
+
+namespace exeray::event {
+
+namespace {
+
+constexpr std::size_t kHeaderSize = kLogHeaderSize;
+constexpr std::size_t kBlockHeaderSize = kLogHeaderSize;
+constexpr std::size_t kStringHeaderSize = 8;
+
+/// Queued event bytes that make a flush write before it has read everything.
+constexpr std::size_t kWriteThreshold = std::size_t{4} << 20;
+
+std::size_t padded(std::size_t size) {
+    return (size + 7) & ~std::size_t{7};
+}
+
+template <typename T>
+void put(std::vector<std::uint8_t>& out, std::size_t offset, const T& value) {
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+T get(std::span<const std::uint8_t> bytes, std::size_t offset) {
+    T value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    return value;
+}
+
+/// @brief Append a block header for payload bytes that follow it.
+void put_block_header(std::vector<std::uint8_t>& out, LogBlock kind, std::uint32_t count,
+                      std::span<const std::uint8_t> payload) {
+    const std::size_t at = out.size();
+    out.resize(at + kBlockHeaderSize);
+    put(out, at, static_cast<std::uint32_t>(kind));
+    put(out, at + 4, count);
+    put(out, at + 8, static_cast<std::uint64_t>(payload.size()));
+    put(out, at + 16, log_checksum(payload));
+}
+
+/// @brief Append a packed block: header, then packed padded to 64.
+void put_packed_block(std::vector<std::uint8_t>& out, LogBlock kind, std::uint32_t count,
+                      std::uint64_t unpacked, std::vector<std::uint8_t>& packed) {
+    packed.resize((packed.size() + kLogHeaderSize - 1) & ~(kLogHeaderSize - 1), 0);
+    const std::size_t at = out.size();
+    put_block_header(out, kind, count, packed);
+    put(out, at + 24, unpacked);
+    out.insert(out.end(), packed.begin(), packed.end());
+}
+
+/// @brief Append the file header.
+void put_file_header(std::vector<std::uint8_t>& out) {
+    const std::size_t at = out.size();
+    out.resize(at + kHeaderSize, 0);
+    put(out, at, kEventLogMagic);
+    put(out, at + 4, kEventLogFormat);
+    put(out, at + 8, static_cast<std::uint32_t>(sizeof(EventNode)));
+    put(out, at + 12, static_cast<std::uint32_t>(EventGraph::kSegmentSize));
+}
+
+/// @brief Append a strings block entry.
+void put_string_entry(std::vector<std::uint8_t>& out, const LogString& entry) {
+    const auto length = static_cast<std::uint32_t>(
+        (std::min)(entry.text.size(), std::size_t{kMaxLogString}));
+    const std::uint32_t flags = entry.path ? kLogPathString : 0;
+
+    const std::size_t at = out.size();
+    out.resize(at + kStringHeaderSize + padded(length), 0);
+    put(out, at, entry.id);
+    put(out, at + 4, flags | length);
+    if (length != 0) {
+        std::memcpy(out.data() + at + kStringHeaderSize, entry.text.data(), length);
+    }
+}
+
+/// @brief Append the strings block entry of id.
+void put_string_entry(std::vector<std::uint8_t>& out, const StringPool& strings, StringId id) {
+    put_string_entry(out, LogString{id, strings.get(id), strings.path_leaf(id) != id});
+}
+
+/// @brief Old event IDs of the log mapped to the IDs replay pushed them as.
+class IdMap {
+public:
+    void add(EventId old_id, EventId new_id) {
+        if (!runs_.empty()) {
+            Run& last = runs_.back();
+            if (old_id == last.old_first + last.length && new_id == last.new_first + last.length) {
+                ++last.length;
+                return;
+            }
+        }
+        runs_.push_back({old_id, new_id, 1});
+    }
+
+    [[nodiscard]] EventId find(EventId old_id) const noexcept {
+        auto it = std::upper_bound(runs_.begin(), runs_.end(), old_id,
+                                   [](EventId id, const Run& run) { return id < run.old_first; });
+        if (it == runs_.begin()) {
+            return INVALID_EVENT;
+        }
+        --it;
+        return old_id - it->old_first < it->length ? it->new_first + (old_id - it->old_first)
+                                                   : INVALID_EVENT;
+    }
+
+private:
+    /// Consecutive old IDs pushed as consecutive new IDs.
+    struct Run {
+        EventId old_first;
+        EventId new_first;
+        std::uint64_t length;
+    };
+
+    std::vector<Run> runs_;  ///< Ascending old_first (the log is oldest first)
+};
+
+}  // namespace
+
+std::uint64_t log_checksum(std::span<const std::uint8_t> payload) noexcept {
+    std::uint64_t hash = 0xCBF29CE484222325ULL;
+    for (const std::uint8_t byte : payload) {
+        hash = (hash ^ byte) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+EventLogWriter::EventLogWriter(const EventGraph& graph, const StringPool& strings) noexcept
+    : graph_(graph), strings_(strings) {}
+
+EventLogWriter::~EventLogWriter() {
+    stop();
+}
+
+bool EventLogWriter::open(const std::filesystem::path& path) {
+    stop();
+    std::lock_guard lock(flush_mutex_);
+    file_ = std::ofstream(path, std::ios::binary | std::ios::trunc);
+    std::vector<std::uint8_t> header;
+    put_file_header(header);
+    file_.write(reinterpret_cast<const char*>(header.data()),
+                static_cast<std::streamsize>(header.size()));
+    file_.flush();
+
+    next_ = static_cast<std::size_t>(graph_.oldest_id() - 1);
+    written_.clear();
+    events_written_.store(0, std::memory_order_relaxed);
+    bytes_written_.store(header.size(), std::memory_order_relaxed);
+    lost_.store(0, std::memory_order_relaxed);
+    failed_.store(!file_, std::memory_order_relaxed);
+    if (!file_) {
+        file_.close();
+        return false;
+    }
+    return true;
+}
+
+void EventLogWriter::set_compression(bool enabled, ThreadPool* pool) {
+    std::lock_guard lock(flush_mutex_);
+    compress_ = enabled;
+    pool_ = pool;
+}
+
+void EventLogWriter::start(std::chrono::milliseconds interval) {
+    if (thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard lock(wake_mutex_);
+        stopping_ = false;
+    }
+    thread_ = std::thread(&EventLogWriter::run, this, interval);
+}
+
+void EventLogWriter::stop() {
+    if (thread_.joinable()) {
+        {
+            std::lock_guard lock(wake_mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+    flush();
+    std::lock_guard lock(flush_mutex_);
+    if (file_.is_open()) {
+        file_.close();
+    }
+}
+
+void EventLogWriter::run(std::chrono::milliseconds interval) {
+    std::unique_lock lock(wake_mutex_);
+    while (!wake_.wait_for(lock, interval, [this] { return stopping_; })) {
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+std::size_t EventLogWriter::flush() {
+    std::lock_guard lock(flush_mutex_);
+    if (!file_.is_open() || failed()) {
+        return 0;
+    }
+
+    std::size_t events = 0;
+    for (;;) {
+        const EventGraph::SegmentSpan span = graph_.segment_span(next_);
+        if (span.length == 0) {
+            break;
+        }
+        if (!encode_span(span)) {
+            continue;  // Recycled while copied: segment_span() moves to the oldest
+        }
+        if (span.first > next_) {
+            lost_.fetch_add(span.first - next_, std::memory_order_relaxed);
+        }
+        next_ = span.first + span.length;
+        events += span.length;
+        if (events_out_.size() >= kWriteThreshold && !write_queued()) {
+            return 0;
+        }
+    }
+    if (!write_queued()) {
+        return 0;
+    }
+    return events;
+}
+
+bool EventLogWriter::encode_span(const EventGraph::SegmentSpan& span) {
+    const std::size_t block = events_out_.size();
+    const std::size_t bytes = span.length * sizeof(EventNode);
+    events_out_.resize(block + kBlockHeaderSize + bytes);
+    std::uint8_t* nodes = events_out_.data() + block + kBlockHeaderSize;
+    std::memcpy(nodes, span.nodes, bytes);
+    if (graph_.epoch() != span.epoch) {
+        events_out_.resize(block);
+        return false;
+    }
+
+    // Strings of the copy, which the ring can no longer change
+    for (std::size_t i = 0; i < span.length; ++i) {
+        EventNode node;
+        std::memcpy(&node, nodes + i * sizeof(EventNode), sizeof(EventNode));
+        for_each_string(node.payload, [this](StringId id) { note_string(id); });
+    }
+
+    const std::span<const std::uint8_t> payload(nodes, bytes);
+    std::vector<std::uint8_t> header;
+    put_block_header(header, LogBlock::Events, static_cast<std::uint32_t>(span.length), payload);
+    std::memcpy(events_out_.data() + block, header.data(), kBlockHeaderSize);
+    return true;
+}
+
+void EventLogWriter::note_string(StringId id) {
+    if (id == INVALID_STRING || !written_.insert(id).second) {
+        return;
+    }
+    put_string_entry(strings_out_, strings_, id);
+    ++string_count_;
+}
+
+bool EventLogWriter::write_queued() {
+    std::uint64_t bytes = 0;
+    auto write = [this, &bytes](const std::vector<std::uint8_t>& part) {
+        if (!part.empty()) {
+            file_.write(reinterpret_cast<const char*>(part.data()),
+                        static_cast<std::streamsize>(part.size()));
+            bytes += part.size();
+        }
+    };
+    if (compress_) {
+        write(pack_queued());
+    } else {
+        std::vector<std::uint8_t> header;
+        if (string_count_ != 0) {
+            // Keeps the blocks that follow 64-byte aligned
+            strings_out_.resize(
+                (strings_out_.size() + kLogHeaderSize - 1) & ~(kLogHeaderSize - 1), 0);
+            put_block_header(header, LogBlock::Strings, string_count_, strings_out_);
+        }
+        write(header);
+        write(strings_out_);
+        write(events_out_);
+    }
+    file_.flush();
+
+    std::uint64_t events = 0;
+    for (std::size_t at = 0; at < events_out_.size();) {
+        const auto block = std::span<const std::uint8_t>(events_out_).subspan(at);
+        events += get<std::uint32_t>(block, 4);
+        at += kBlockHeaderSize + get<std::uint64_t>(block, 8);
+    }
+    strings_out_.clear();
+    events_out_.clear();
+    string_count_ = 0;
+    if (!file_) {
+        failed_.store(true, std::memory_order_relaxed);
+        return false;
+    }
+    events_written_.fetch_add(events, std::memory_order_relaxed);
+    bytes_written_.fetch_add(bytes, std::memory_order_relaxed);
+    return true;
+}
+
+std::vector<std::uint8_t> EventLogWriter::pack_queued() {
+    struct Block {
+        std::size_t offset;  ///< Of the payload in events_out_
+        std::uint32_t count;
+        std::vector<std::uint8_t> packed;
+    };
+    std::vector<Block> blocks;
+    for (std::size_t at = 0; at < events_out_.size();) {
+        const auto block = std::span<const std::uint8_t>(events_out_).subspan(at);
+        blocks.push_back({at + kBlockHeaderSize, get<std::uint32_t>(block, 4), {}});
+        at += kBlockHeaderSize + get<std::uint64_t>(block, 8);
+    }
+    auto pack = [this](Block& block) {
+        pack_events(std::span<const std::uint8_t>(events_out_)
+                        .subspan(block.offset, std::size_t{block.count} * sizeof(EventNode)),
+                    block.packed);
+    };
+    if (pool_ != nullptr && blocks.size() > 1) {
+        std::vector<TaskHandle<void>> tasks;
+        tasks.reserve(blocks.size() - 1);
+        for (std::size_t i = 1; i < blocks.size(); ++i) {
+            tasks.push_back(spawn(*pool_, [&pack, &block = blocks[i]] { pack(block); }));
+        }
+        pack(blocks.front());
+        when_all(tasks).wait();
+    } else {
+        std::for_each(blocks.begin(), blocks.end(), pack);
+    }
+
+    std::vector<std::uint8_t> out;
+    if (string_count_ != 0) {
+        std::vector<std::uint8_t> packed;
+        pack_bytes(strings_out_, packed);
+        put_packed_block(out, LogBlock::PackedStrings, string_count_, strings_out_.size(),
+                         packed);
+    }
+    for (Block& block : blocks) {
+        put_packed_block(out, LogBlock::PackedEvents, block.count,
+                         std::uint64_t{block.count} * sizeof(EventNode), block.packed);
+    }
+    return out;
+}
+
+void encode_log_header(std::vector<std::uint8_t>& out) {
+    put_file_header(out);
+}
+
+void encode_strings_block(std::span<const LogString> entries, bool compress,
+                          std::vector<std::uint8_t>& out) {
+    if (entries.empty()) {
+        return;
+    }
+    std::vector<std::uint8_t> payload;
+    for (const LogString& entry : entries) {
+        put_string_entry(payload, entry);
+    }
+    const auto count = static_cast<std::uint32_t>(entries.size());
+    if (compress) {
+        std::vector<std::uint8_t> packed;
+        pack_bytes(payload, packed);
+        put_packed_block(out, LogBlock::PackedStrings, count, payload.size(), packed);
+    } else {
+        payload.resize((payload.size() + kLogHeaderSize - 1) & ~(kLogHeaderSize - 1), 0);
+        put_block_header(out, LogBlock::Strings, count, payload);
+        out.insert(out.end(), payload.begin(), payload.end());
+    }
+}
+
+void encode_events_block(std::span<const EventNode> nodes, bool compress,
+                         std::vector<std::uint8_t>& out) {
+    if (nodes.empty()) {
+        return;
+    }
+    const std::span<const std::uint8_t> block(reinterpret_cast<const std::uint8_t*>(nodes.data()),
+                                              nodes.size() * sizeof(EventNode));
+    const auto count = static_cast<std::uint32_t>(nodes.size());
+    if (compress) {
+        std::vector<std::uint8_t> packed;
+        pack_events(block, packed);
+        put_packed_block(out, LogBlock::PackedEvents, count, block.size(), packed);
+    } else {
+        put_block_header(out, LogBlock::Events, count, block);
+        out.insert(out.end(), block.begin(), block.end());
+    }
+}
+
+void encode_event_log(std::span<const EventNode> nodes, const StringPool& strings,
+                      bool compress, std::vector<std::uint8_t>& out) {
+    put_file_header(out);
+    std::unordered_set<StringId> seen;
+    std::vector<LogString> entries;
+    for (const EventNode& node : nodes) {
+        for_each_string(node.payload, [&](StringId id) {
+            if (id != INVALID_STRING && seen.insert(id).second) {
+                entries.push_back({id, strings.get(id), strings.path_leaf(id) != id});
+            }
+        });
+    }
+    encode_strings_block(entries, compress, out);
+    for (std::size_t first = 0; first < nodes.size(); first += EventGraph::kSegmentSize) {
+        const std::size_t length = (std::min)(nodes.size() - first, EventGraph::kSegmentSize);
+        encode_events_block(nodes.subspan(first, length), compress, out);
+    }
+}
+
+std::optional<LogReplay> replay_event_log(std::span<const std::uint8_t> bytes,
+                                          EventGraph& graph, StringPool& strings) {
+    if (bytes.size() < kHeaderSize ||
+        get<std::uint32_t>(bytes, 0) != kEventLogMagic ||
+        get<std::uint32_t>(bytes, 4) != kEventLogFormat ||
+        get<std::uint32_t>(bytes, 8) != sizeof(EventNode)) {
+        return std::nullopt;
+    }
+
+    LogReplay replay;
+    std::unordered_map<StringId, StringId> string_ids;
+    IdMap event_ids;
+    std::vector<PendingEvent> pending;
+    std::vector<EventId> old_ids;
+    std::vector<EventId> new_ids;
+
+    // Push what is pending; false if the graph did not take all of it
+    auto push_pending = [&] {
+        new_ids.resize(pending.size());
+        const std::size_t pushed = graph.push_batch(pending, new_ids);
+        for (std::size_t i = 0; i < pushed; ++i) {
+            event_ids.add(old_ids[i], new_ids[i]);
+        }
+        replay.events += pushed;
+        const bool all = pushed == pending.size();
+        pending.clear();
+        old_ids.clear();
+        return all;
+    };
+
+    std::vector<std::uint8_t> unpacked;
+    std::vector<EventNode> unpacked_nodes;
+    std::size_t offset = kHeaderSize;
+    while (offset < bytes.size()) {
+        if (bytes.size() - offset < kBlockHeaderSize) {
+            replay.complete = false;
+            break;
+        }
+        const std::size_t header = offset;
+        auto kind = static_cast<LogBlock>(get<std::uint32_t>(bytes, header));
+        const auto count = get<std::uint32_t>(bytes, header + 4);
+        auto size = get<std::uint64_t>(bytes, header + 8);
+        offset += kBlockHeaderSize;
+        if (bytes.size() - offset < size) {
+            replay.complete = false;  // Cut short, e.g. by a crash mid-write
+            break;
+        }
+        auto payload = bytes.subspan(offset, static_cast<std::size_t>(size));
+        if (log_checksum(payload) != get<std::uint64_t>(bytes, header + 16)) {
+            replay.complete = false;
+            break;
+        }
+        offset += payload.size();
+
+        if (kind == LogBlock::PackedStrings || kind == LogBlock::PackedEvents) {
+            size = get<std::uint64_t>(bytes, header + 24);
+            bool ok = size <= max_unpacked_size(payload.size());
+            if (ok && kind == LogBlock::PackedStrings) {
+                unpacked.resize(static_cast<std::size_t>(size));
+                ok = unpack_bytes(payload, unpacked);
+                payload = unpacked;
+                kind = LogBlock::Strings;
+            } else if (ok) {
+                ok = size == std::uint64_t{count} * sizeof(EventNode);
+                unpacked_nodes.resize(ok ? count : 0);
+                ok = ok && unpack_events(payload, unpacked_nodes);
+                payload = {reinterpret_cast<const std::uint8_t*>(unpacked_nodes.data()),
+                           unpacked_nodes.size() * sizeof(EventNode)};
+                kind = LogBlock::Events;
+            }
+            if (!ok) {
+                replay.complete = false;
+                break;
+            }
+        }
+
+        if (kind == LogBlock::Strings) {
+            std::size_t at = 0;
+            std::uint32_t i = 0;
+            for (; i < count && payload.size() - at >= kStringHeaderSize; ++i) {
+                const auto id = get<StringId>(payload, at);
+                const auto word = get<std::uint32_t>(payload, at + 4);
+                const std::uint32_t length = word & ~kLogPathString;
+                at += kStringHeaderSize;
+                if (length > kMaxLogString || payload.size() - at < padded(length)) {
+                    break;
+                }
+                const std::string_view text(reinterpret_cast<const char*>(payload.data() + at),
+                                            length);
+                string_ids[id] = (word & kLogPathString) != 0 ? strings.intern_path(text)
+                                                              : strings.intern(text);
+                at += padded(length);
+            }
+            replay.strings += i;
+            if (i != count) {
+                replay.complete = false;
+                break;
+            }
+        } else if (kind == LogBlock::Events) {
+            if (size != std::uint64_t{count} * sizeof(EventNode)) {
+                replay.complete = false;
+                break;
+            }
+            bool full = false;
+            for (std::uint32_t i = 0; i < count && !full; ++i) {
+                EventNode node;
+                std::memcpy(&node, payload.data() + std::size_t{i} * sizeof(EventNode),
+                            sizeof(EventNode));
+                // A parent in the pending batch needs its new ID first
+                if (!old_ids.empty() && node.parent_id >= old_ids.front()) {
+                    full = !push_pending();
+                }
+                for_each_string(node.payload, [&string_ids](auto& id) {
+                    const auto it = string_ids.find(id);
+                    id = it != string_ids.end() ? it->second : INVALID_STRING;
+                });
+                PendingEvent event{};
+                event.category = node.payload.category;
+                event.operation = node.operation;
+                event.status = node.status;
+                event.parent = node.parent_id != INVALID_EVENT ? event_ids.find(node.parent_id)
+                                                               : INVALID_EVENT;
+                event.correlation_id = node.correlation_id;
+                event.payload = node.payload;
+                event.payload.extension = NO_EXTENSION;  // Records are not logged
+                event.timestamp = node.timestamp;
+                event.pid = event_pid(node.payload);
+                pending.push_back(event);
+                old_ids.push_back(node.id);
+            }
+            if (full || !push_pending()) {
+                replay.complete = false;
+                break;
+            }
+        }
+        // Blocks of an unknown kind are skipped
+    }
+    return replay;
+}
+
+std::optional<LogReplay> read_event_log(const std::filesystem::path& path, EventGraph& graph,
+                                        StringPool& strings) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+    const std::vector<std::uint8_t> bytes{std::istreambuf_iterator<char>(file),
+                                          std::istreambuf_iterator<char>()};
+    return replay_event_log(bytes, graph, strings);
+}
+
+}  // namespace exeray::event
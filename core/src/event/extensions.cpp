@@ -0,0 +1,46 @@
+/// @file extensions.cpp
+/// @brief Arena-backed extension records.
+
+#include "exeray/event/extensions.hpp"
+
+#include <limits>
+
+namespace exeray::event {
+
+ExtensionId ExtensionStore::append(ExtensionKind kind, std::span<const std::uint8_t> bytes) {
+    if (kind == ExtensionKind::None || bytes.empty() || bytes.size() > kMaxBytes) {
+        return NO_EXTENSION;
+    }
+    // Whole u32 words keep the header aligned for the next record
+    const std::size_t words = (kHeaderSize + bytes.size() + 3) / 4;
+    auto* storage = reinterpret_cast<std::uint8_t*>(arena_.allocate_local<std::uint32_t>(words));
+    if (storage == nullptr) {
+        return NO_EXTENSION;
+    }
+    const auto offset = static_cast<std::size_t>(storage - arena_.base());
+    if (offset >= (std::numeric_limits<ExtensionId>::max)()) {
+        return NO_EXTENSION;
+    }
+
+    const auto size = static_cast<std::uint32_t>(bytes.size());
+    const auto tag = static_cast<std::uint32_t>(kind);
+    std::memcpy(storage, &size, sizeof(size));
+    std::memcpy(storage + sizeof(size), &tag, sizeof(tag));
+    std::memcpy(storage + kHeaderSize, bytes.data(), bytes.size());
+    count_.fetch_add(1, std::memory_order_relaxed);
+    return static_cast<ExtensionId>(offset + 1);
+}
+
+Extension ExtensionStore::get(ExtensionId id) const noexcept {
+    if (id == NO_EXTENSION) {
+        return {};
+    }
+    const std::uint8_t* storage = arena_.base() + (id - 1);
+    std::uint32_t size = 0;
+    std::uint32_t tag = 0;
+    std::memcpy(&size, storage, sizeof(size));
+    std::memcpy(&tag, storage + sizeof(size), sizeof(tag));
+    return {static_cast<ExtensionKind>(tag), std::span(storage + kHeaderSize, size)};
+}
+
+}  // namespace exeray::event
@@ -0,0 +1,208 @@
+/// @file forwarder.cpp
+/// @brief Batching, buffering and sending of EventForwarder.
+
+#include "exeray/event/forwarder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <utility>
+
+#include "exeray/event/event_log.hpp"
+
+namespace exeray::event {
+
+namespace {
+
+template <typename T>
+void put(std::vector<std::uint8_t>& out, std::size_t offset, const T& value) {
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+}  // namespace
+
+EventForwarder::EventForwarder(const EventGraph& graph, const StringPool& strings,
+                               ForwarderConfig config)
+    : graph_(graph),
+      strings_(strings),
+      config_(std::move(config)),
+      next_(static_cast<std::size_t>(graph.oldest_id() - 1)) {}
+
+EventForwarder::~EventForwarder() {
+    stop();
+}
+
+void EventForwarder::start() {
+    if (tail_thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard lock(queue_mutex_);
+        stopping_ = false;
+        draining_ = false;
+    }
+    tail_thread_ = std::thread(&EventForwarder::run_tail, this);
+    send_thread_ = std::thread(&EventForwarder::run_send, this);
+}
+
+void EventForwarder::stop() {
+    if (tail_thread_.joinable()) {
+        {
+            std::lock_guard lock(queue_mutex_);
+            stopping_ = true;
+        }
+        queue_ready_.notify_all();
+        tail_thread_.join();
+    }
+    poll();
+    {
+        std::lock_guard lock(queue_mutex_);
+        draining_ = true;
+    }
+    if (send_thread_.joinable()) {
+        queue_ready_.notify_all();
+        send_thread_.join();
+    } else {
+        run_send();  // Never started: send on this thread
+    }
+    connection_.close();
+}
+
+std::size_t EventForwarder::poll() {
+    std::lock_guard lock(poll_mutex_);
+    std::size_t events = 0;
+    for (;;) {
+        const EventGraph::SegmentSpan span = graph_.segment_span(next_);
+        if (span.length == 0) {
+            break;
+        }
+        const std::size_t at = pending_.size();
+        pending_.resize(at + span.length);
+        std::memcpy(pending_.data() + at, span.nodes, span.length * sizeof(EventNode));
+        if (graph_.epoch() != span.epoch) {
+            pending_.resize(at);
+            continue;  // Recycled while copied: segment_span() moves to the oldest
+        }
+        if (span.first > next_) {
+            lost_.fetch_add(span.first - next_, std::memory_order_relaxed);
+        }
+        next_ = span.first + span.length;
+        events += span.length;
+    }
+
+    const std::size_t size = (std::max)(config_.batch_events, std::size_t{1});
+    const std::span<const EventNode> nodes(pending_);
+    for (std::size_t first = 0; first < nodes.size(); first += size) {
+        queue_batch(nodes.subspan(first, (std::min)(size, nodes.size() - first)));
+    }
+    pending_.clear();
+    return events;
+}
+
+void EventForwarder::queue_batch(std::span<const EventNode> nodes) {
+    Batch batch;
+    batch.events = nodes.size();
+    batch.bytes.resize(kForwardFrameHeaderSize);
+    encode_event_log(nodes, strings_, config_.compress, batch.bytes);
+    put(batch.bytes, 0, kForwardFrameMagic);
+    put(batch.bytes, 4, kEventLogFormat);
+    put(batch.bytes, 8,
+        static_cast<std::uint64_t>(batch.bytes.size() - kForwardFrameHeaderSize));
+
+    std::lock_guard lock(queue_mutex_);
+    make_room(batch.bytes.size());
+    if (buffered_ + batch.bytes.size() > config_.max_buffered_bytes) {
+        drop(batch);  // Only the batch being sent is left, and this one does not fit
+        return;
+    }
+    buffered_ += batch.bytes.size();
+    queue_.push_back(std::move(batch));
+    queue_ready_.notify_all();
+}
+
+void EventForwarder::make_room(std::size_t bytes) {
+    while (!queue_.empty() && buffered_ + bytes > config_.max_buffered_bytes) {
+        buffered_ -= queue_.front().bytes.size();
+        drop(queue_.front());
+        queue_.pop_front();
+    }
+}
+
+void EventForwarder::drop(const Batch& batch) {
+    batches_dropped_.fetch_add(1, std::memory_order_relaxed);
+    events_dropped_.fetch_add(batch.events, std::memory_order_relaxed);
+}
+
+std::size_t EventForwarder::buffered_bytes() const {
+    std::lock_guard lock(queue_mutex_);
+    return buffered_;
+}
+
+bool EventForwarder::connect() {
+    if (connection_.is_open()) {
+        return true;
+    }
+    const bool open =
+        config_.transport == ForwarderConfig::Transport::Pipe
+            ? connection_.open_pipe(config_.pipe, config_.send_timeout)
+            : connection_.open_tcp(config_.host, config_.port, config_.send_timeout);
+    if (open) {
+        if (connected_once_) {
+            reconnects_.fetch_add(1, std::memory_order_relaxed);
+        }
+        connected_once_ = true;
+    }
+    return open;
+}
+
+void EventForwarder::run_tail() {
+    std::unique_lock lock(queue_mutex_);
+    while (!queue_ready_.wait_for(lock, config_.interval, [this] { return stopping_; })) {
+        lock.unlock();
+        poll();
+        lock.lock();
+    }
+}
+
+void EventForwarder::run_send() {
+    auto backoff = config_.reconnect_min;
+    std::unique_lock lock(queue_mutex_);
+    for (;;) {
+        queue_ready_.wait(lock, [this] { return !queue_.empty() || draining_; });
+        if (queue_.empty()) {
+            return;  // Drained
+        }
+        // Out of the queue while sent, so make_room() cannot drop it meanwhile;
+        // it stays in buffered_ until sent or dropped
+        Batch batch = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+        const bool sent = connect() && connection_.send(batch.bytes);
+        lock.lock();
+
+        if (sent) {
+            buffered_ -= batch.bytes.size();
+            batches_sent_.fetch_add(1, std::memory_order_relaxed);
+            events_sent_.fetch_add(batch.events, std::memory_order_relaxed);
+            bytes_sent_.fetch_add(batch.bytes.size(), std::memory_order_relaxed);
+            backoff = config_.reconnect_min;
+            continue;
+        }
+        if (draining_) {
+            // No retries once stopping: drop what is left
+            buffered_ -= batch.bytes.size();
+            drop(batch);
+            for (const Batch& rest : queue_) {
+                drop(rest);
+            }
+            queue_.clear();
+            buffered_ = 0;
+            return;
+        }
+        queue_.push_front(std::move(batch));
+        queue_ready_.wait_for(lock, backoff, [this] { return draining_; });
+        backoff = (std::min)(backoff * 2, config_.reconnect_max);
+    }
+}
+
+}  // namespace exeray::event
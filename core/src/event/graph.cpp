@@ -1,90 +1,1414 @@
 #include "exeray/event/graph.hpp"
+#include "exeray/event/log_codec.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cassert>
 #include <chrono>
 #include <cstring>
+#include <memory>
+#include <optional>
 
 namespace exeray::event {
 
-EventGraph::EventGraph(Arena& arena, StringPool& strings, std::size_t capacity)
+namespace {
+
+/// Bytes of one segment's column arrays (see seal_segment()).
+constexpr std::size_t kColumnBytes =
+    (sizeof(Timestamp) + 2 * sizeof(uint32_t) + sizeof(uint16_t) + sizeof(Category) +
+     sizeof(uint8_t) + sizeof(Status)) *
+    EventGraph::kSegmentSize;
+
+/// Keys a one-byte column can hold.
+constexpr std::size_t kByteKeys = 256;
+
+/// Bitmaps a row group needs at most (each holds RowGroups::kDenseRows rows or more).
+constexpr std::size_t kDenseSlots = EventGraph::kSegmentSize / RowGroups::kDenseRows;
+
+/// @brief Bytes of a RowGroups sized for key_capacity keys.
+constexpr std::size_t row_group_bytes(std::size_t key_capacity) {
+    return key_capacity * (sizeof(std::uint32_t) + sizeof(std::int16_t)) +
+           (key_capacity + 1) * sizeof(std::uint32_t) +
+           EventGraph::kSegmentSize * sizeof(std::uint16_t) +
+           kDenseSlots * EventGraph::kSegmentSize / 8;
+}
+
+/// Bytes of one segment's row group arrays (see allocate_bitmaps()).
+constexpr std::size_t kBitmapBytes =
+    2 * row_group_bytes(kByteKeys) + row_group_bytes(EventGraph::kSegmentSize);
+
+/// @brief Allocate the arrays of one RowGroups; false if the arena is exhausted.
+bool allocate_groups(Arena& arena, RowGroups& groups, std::size_t key_capacity) {
+    groups.keys = arena.allocate<std::uint32_t>(key_capacity);
+    groups.offsets = arena.allocate<std::uint32_t>(key_capacity + 1);
+    groups.rows = arena.allocate<std::uint16_t>(EventGraph::kSegmentSize);
+    groups.dense = arena.allocate<std::int16_t>(key_capacity);
+    groups.bitmaps = arena.allocate<std::uint64_t>(kDenseSlots * EventGraph::kSegmentSize / 64);
+    groups.key_count = 0;
+    return groups.keys != nullptr && groups.offsets != nullptr && groups.rows != nullptr &&
+           groups.dense != nullptr && groups.bitmaps != nullptr;
+}
+
+/// @brief Row group storage for one segment slot (nullptr if the arena is exhausted).
+SegmentBitmaps* allocate_bitmaps(Arena& arena) {
+    auto* storage = arena.allocate<SegmentBitmaps>(1);
+    if (storage == nullptr) {
+        return nullptr;
+    }
+    auto* bitmaps = std::construct_at(storage);
+    if (!allocate_groups(arena, bitmaps->categories, kByteKeys) ||
+        !allocate_groups(arena, bitmaps->statuses, kByteKeys) ||
+        !allocate_groups(arena, bitmaps->correlations, EventGraph::kSegmentSize)) {
+        return nullptr;
+    }
+    return bitmaps;
+}
+
+/// @brief Round a capacity to the storage actually used by a retention mode.
+std::size_t effective_capacity(std::size_t capacity, Retention retention) {
+    if (retention != Retention::Ring) {
+        return (std::min)(capacity, EventGraph::kMaxEvents);
+    }
+    // Ring mode recycles whole segments and keeps at least one live segment
+    // while the next one is being refilled.
+    const auto segments = (std::max)(
+        std::size_t{2},
+        (capacity + EventGraph::kSegmentSize - 1) / EventGraph::kSegmentSize);
+    return segments * EventGraph::kSegmentSize;
+}
+
+/// @brief Size the correlation head table (one entry per 8 events, min 1024).
+std::size_t correlation_table_size(std::size_t capacity) {
+    return std::bit_ceil((std::max)(std::size_t{1024}, capacity / 8));
+}
+
+/// @brief Maximum probe distance before the head table is considered full.
+constexpr std::size_t kMaxCorrelationProbe = 64;
+
+/// @brief Push value onto an intrusive chain (lock-free).
+///
+/// The successor link is written before the head is published with release
+/// ordering, so a reader that sees the new head also sees its successor.
+template <typename Link>
+void link_front(std::atomic<Link>& head, std::atomic<Link>& next, Link value) {
+    auto old = head.load(std::memory_order_relaxed);
+    do {
+        next.store(old, std::memory_order_relaxed);
+    } while (!head.compare_exchange_weak(old, value, std::memory_order_release,
+                                         std::memory_order_relaxed));
+}
+
+/// @brief Decoded segments a thread read last, kept alive for the views it
+/// still holds after the cache has moved on.
+struct ThreadPins {
+    static constexpr std::size_t kPins = 4;
+
+    std::array<std::shared_ptr<EventNode[]>, kPins> pins;
+    std::size_t next = 0;
+
+    void hold(const std::shared_ptr<EventNode[]>& nodes) {
+        for (const auto& pin : pins) {
+            if (pin == nodes) {
+                return;
+            }
+        }
+        pins[next++ % kPins] = nodes;
+    }
+};
+
+thread_local ThreadPins t_pins;
+
+}  // namespace
+
+struct EventGraph::ColdStore {
+    /// @brief Decoded copy of one compressed segment.
+    struct Decoded {
+        std::size_t segment = 0;
+        DecodedNodes nodes;     ///< nullptr = unused entry
+        std::uint64_t used = 0;  ///< LRU tick of the last read
+        bool dirty = false;      ///< Updated since it was decoded
+    };
+
+    explicit ColdStore(const CompressionConfig& config, std::size_t segments)
+        : hot_segments((std::max)(config.hot_segments, std::size_t{1})),
+          packed(segments),
+          cache((std::max)(config.cache_segments, std::size_t{1})) {}
+
+    const std::size_t hot_segments;
+
+    std::size_t next = 0;  ///< Oldest segment not yet compressed (segment_mutex_)
+
+    // Guarded by mutex
+    std::mutex mutex;
+    std::vector<std::vector<std::uint8_t>> packed;  ///< By segment (empty = plain)
+    std::vector<Decoded> cache;
+    std::uint64_t tick = 0;
+
+    std::atomic<std::size_t> segments{0};
+    std::atomic<std::uint64_t> packed_bytes{0};
+    std::atomic<std::uint64_t> decodes{0};
+    std::atomic<std::uint64_t> decode_ns{0};
+    std::atomic<std::uint64_t> cache_hits{0};
+    std::atomic<std::uint64_t> repacks{0};
+
+    /// @brief Compress a dirty copy again (caller holds mutex).
+    void repack(Decoded& entry) {
+        std::vector<std::uint8_t>& bytes = packed[entry.segment];
+        const std::size_t before = bytes.size();
+        bytes.clear();
+        pack_events({reinterpret_cast<const std::uint8_t*>(entry.nodes.get()),
+                     sizeof(EventNode) * EventGraph::kSegmentSize},
+                    bytes);
+        bytes.shrink_to_fit();
+        packed_bytes.fetch_add(bytes.size(), std::memory_order_relaxed);
+        packed_bytes.fetch_sub(before, std::memory_order_relaxed);
+        repacks.fetch_add(1, std::memory_order_relaxed);
+        entry.dirty = false;
+    }
+
+    /// @brief The decoded copy of a compressed segment (caller holds mutex).
+    Decoded& decoded(std::size_t segment) {
+        Decoded* victim = &cache.front();
+        for (Decoded& entry : cache) {
+            if (entry.nodes != nullptr && entry.segment == segment) {
+                entry.used = ++tick;
+                cache_hits.fetch_add(1, std::memory_order_relaxed);
+                return entry;
+            }
+            if (entry.nodes == nullptr || (victim->nodes != nullptr && entry.used < victim->used)) {
+                victim = &entry;
+            }
+        }
+        if (victim->nodes != nullptr && victim->dirty) {
+            repack(*victim);
+        }
+        // Readers may still hold the old copy; it is theirs to release
+        if (victim->nodes == nullptr || victim->nodes.use_count() > 1) {
+            victim->nodes = DecodedNodes(std::make_unique<EventNode[]>(EventGraph::kSegmentSize));
+        }
+        const auto start = std::chrono::steady_clock::now();
+        const bool ok = unpack_events(packed[segment], {victim->nodes.get(), EventGraph::kSegmentSize});
+        assert(ok && "compressed segment failed to unpack");
+        (void)ok;
+        decode_ns.fetch_add(static_cast<std::uint64_t>(
+                                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now() - start)
+                                    .count()),
+                            std::memory_order_relaxed);
+        decodes.fetch_add(1, std::memory_order_relaxed);
+        victim->segment = segment;
+        victim->used = ++tick;
+        victim->dirty = false;
+        return *victim;
+    }
+};
+
+EventGraph::EventGraph(Arena& arena, StringPool& strings, std::size_t capacity,
+                       Retention retention)
     : arena_(arena),
       strings_(strings),
-      nodes_(arena.allocate<EventNode>(capacity)),
-      capacity_(capacity) {
-    // Initialize nodes memory to zero for debug consistency
-    if (nodes_ != nullptr) {
-        std::memset(nodes_, 0, sizeof(EventNode) * capacity);
+      retention_(retention),
+      capacity_(effective_capacity(capacity, retention)),
+      max_segments_((capacity_ + kSegmentSize - 1) / kSegmentSize),
+      segments_(std::make_unique<Segment[]>(max_segments_)),
+      correlation_mask_(correlation_table_size(capacity_) - 1),
+      correlation_heads_(std::make_unique<ChainHead[]>(correlation_mask_ + 1)),
+      process_heads_(std::make_unique<ChainHead[]>(correlation_mask_ + 1)),
+      // One spare slot in ring mode: a category segment is only recycled once
+      // a full capacity of newer events of that category exists, so every
+      // entry it held has been evicted.
+      category_segments_(max_segments_ + (retention == Retention::Ring ? 1 : 0)) {
+    for (auto& index : categories_) {
+        index.segments = std::make_unique<CategorySegment[]>(category_segments_);
     }
 }
 
-EventId EventGraph::push(Category cat, std::uint8_t op, Status status,
-                         EventId parent, uint32_t correlation_id,
-                         const EventPayload& payload) {
-    // Reserve a slot atomically
-    const auto index = count_.fetch_add(1, std::memory_order_acq_rel);
+EventGraph::~EventGraph() = default;
 
-    // Check capacity
-    if (index >= capacity_) {
-        // Rollback count if we exceeded capacity
-        count_.fetch_sub(1, std::memory_order_relaxed);
-        return INVALID_EVENT;
+EventNode* EventGraph::acquire_segment(std::size_t segment) {
+    Segment& slot = segments_[slot_of(segment)];
+    const auto tag = static_cast<std::uint64_t>(segment) + 1;
+    if (slot.tag.load(std::memory_order_acquire) == tag) [[likely]] {
+        return slot.nodes.load(std::memory_order_acquire);
+    }
+
+    // Slow path: first push into this segment. Serialize allocation so that
+    // concurrent pushers don't each carve a segment out of the bump arena.
+    std::lock_guard lock(segment_mutex_);
+    const auto current = slot.tag.load(std::memory_order_acquire);
+    if (current == tag) {
+        return slot.nodes.load(std::memory_order_acquire);
+    }
+    if (current > tag) {
+        // A stalled pusher whose segment has already been recycled
+        return nullptr;
+    }
+
+    // The last segment is truncated to the configured capacity
+    const std::size_t first = segment << kSegmentShift;
+    const std::size_t size =
+        retention_ == Retention::Ring ? kSegmentSize
+                                      : (std::min)(kSegmentSize, capacity_ - first);
+
+    EventNode* nodes = slot.nodes.load(std::memory_order_acquire);
+    NodeLinks* links = slot.links.load(std::memory_order_acquire);
+    bool zeroed = false;
+    if (current != 0) {
+        // Ring mode: reuse the storage of the oldest segment
+        evict_slot(slot_of(segment), current);
+        for (std::size_t i = 0; i < size; ++i) {
+            links[i].first_child.store(0, std::memory_order_relaxed);
+            links[i].next_sibling.store(0, std::memory_order_relaxed);
+            links[i].next_correlated.store(0, std::memory_order_relaxed);
+            links[i].next_in_process.store(0, std::memory_order_relaxed);
+            links[i].published.store(0, std::memory_order_relaxed);
+            links[i].tags.store(0, std::memory_order_relaxed);
+        }
+    } else {
+        // Compression and spilling hand back the node storage of cold segments
+        const bool reuse = !spare_nodes_.empty();
+        nodes = reuse ? spare_nodes_.back() : arena_.allocate<EventNode>(size);
+        links = arena_.allocate<NodeLinks>(size);
+        if (nodes == nullptr || links == nullptr) {
+            return nullptr;
+        }
+        if (reuse) {
+            spare_nodes_.pop_back();
+        } else {
+            zeroed = arena_.zeroed(nodes);
+            storage_bytes_.fetch_add(sizeof(EventNode) * size, std::memory_order_relaxed);
+        }
+        std::uninitialized_value_construct_n(links, size);
+        slot.nodes.store(nodes, std::memory_order_release);
+        slot.links.store(links, std::memory_order_release);
+        segments_allocated_.fetch_add(1, std::memory_order_relaxed);
+        storage_bytes_.fetch_add(sizeof(NodeLinks) * size, std::memory_order_relaxed);
+    }
+
+    // Initialize segment memory to zero for debug consistency. Fresh mapped
+    // pages already are: clearing them would fault in the whole segment on
+    // the pushing thread
+    if (!zeroed) {
+        std::memset(static_cast<void*>(nodes), 0, sizeof(EventNode) * size);
+    }
+    slot.sealed.store(0, std::memory_order_relaxed);
+    slot.min_timestamp.store(kNoTimestamp, std::memory_order_relaxed);
+    slot.max_timestamp.store(0, std::memory_order_relaxed);
+    slot.tags.store(0, std::memory_order_relaxed);
+
+    slot.tag.store(tag, std::memory_order_release);
+    return nodes;
+}
+
+void EventGraph::evict_slot(std::size_t slot, std::uint64_t old_tag) {
+    // Everything up to and including the evicted segment is gone. Segments
+    // are claimed in order almost always; max() covers the rare case of a
+    // later segment being claimed first.
+    const auto evicted_end = static_cast<std::size_t>(old_tag) << kSegmentShift;
+    if (evicted_end > first_index_.load(std::memory_order_relaxed)) {
+        first_index_.store(evicted_end, std::memory_order_release);
+    }
+    // Slots abandoned by lapped writers are never published; eviction
+    // carries the watermark past them
+    auto mark = published_.load(std::memory_order_acquire);
+    while (mark < evicted_end &&
+           !published_.compare_exchange_weak(mark, evicted_end,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+    }
+
+    // Index chains need no pruning: links into the recycled segment fall
+    // below first_index_ and terminate every walk that reaches them.
+    Segment& evicted = segments_[slot];
+
+    // Uncount every event the segment published (one pass per kSegmentSize
+    // pushes), handing it to the long-term store on the way; unpublished
+    // slots abandoned by lapped writers are skipped
+    const auto base = evicted_end - kSegmentSize;
+    const EventNode* nodes = evicted.nodes.load(std::memory_order_acquire);
+    const NodeLinks* links = evicted.links.load(std::memory_order_acquire);
+    std::optional<RetainedEvents::Batch> retained;
+    if (retained_ != nullptr) {
+        retained.emplace(*retained_);
+    }
+    for (std::size_t i = 0; i < kSegmentSize; ++i) {
+        if (links[i].published.load(std::memory_order_acquire) == link_of(base + i)) {
+            counters_.remove(nodes[i].payload.category, nodes[i].status,
+                             event_pid(nodes[i].payload));
+            if (retained) {
+                retained->add(nodes[i], links[i].tags.load(std::memory_order_acquire));
+            }
+        }
+    }
+    retained.reset();
+    for (std::size_t c = 0; c < kCategoryCount; ++c) {
+        const auto n = evicted.category_counts[c].exchange(0, std::memory_order_relaxed);
+        categories_[c].evicted.fetch_add(n, std::memory_order_release);
+    }
+
+    // Readers never block eviction. They re-check the tag or the publish
+    // flag of every slot they visit, and the fence orders this retirement
+    // before the caller starts overwriting links and nodes.
+    evicted.sealed.store(0, std::memory_order_release);
+    evicted.tag.store(0, std::memory_order_release);
+    epoch_.fetch_add(1, std::memory_order_acq_rel);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+std::atomic<EventGraph::Link>* EventGraph::acquire_category_segment(
+    CategoryIndex& index, std::size_t segment) {
+    CategorySegment& slot = index.segments[category_slot_of(segment)];
+    const auto tag = static_cast<std::uint64_t>(segment) + 1;
+    if (slot.tag.load(std::memory_order_acquire) == tag) [[likely]] {
+        return slot.entries.load(std::memory_order_acquire);
+    }
+
+    std::lock_guard lock(segment_mutex_);
+    const auto current = slot.tag.load(std::memory_order_acquire);
+    if (current == tag) {
+        return slot.entries.load(std::memory_order_acquire);
+    }
+    if (current > tag) {
+        return nullptr;
+    }
+
+    auto* entries = slot.entries.load(std::memory_order_acquire);
+    if (current != 0) {
+        // Ring mode: every entry in the old segment refers to an evicted
+        // event. Retire the tag first; readers re-check it after each entry.
+        slot.tag.store(0, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (std::size_t i = 0; i < kSegmentSize; ++i) {
+            entries[i].store(0, std::memory_order_relaxed);
+        }
+    } else {
+        entries = arena_.allocate<std::atomic<Link>>(kSegmentSize);
+        if (entries == nullptr) {
+            return nullptr;
+        }
+        std::uninitialized_value_construct_n(entries, kSegmentSize);
+        slot.entries.store(entries, std::memory_order_release);
+        storage_bytes_.fetch_add(sizeof(std::atomic<Link>) * kSegmentSize,
+                                 std::memory_order_relaxed);
     }
 
-    // Generate unique ID atomically
-    const auto id = next_id_.fetch_add(1, std::memory_order_relaxed);
+    slot.tag.store(tag, std::memory_order_release);
+    return entries;
+}
+
+void EventGraph::index_category(Category cat, std::size_t index) {
+    const auto c = static_cast<std::size_t>(cat);
+    if (c >= kCategoryCount) {
+        return;
+    }
+    segments_[slot_of(index >> kSegmentShift)].category_counts[c].fetch_add(
+        1, std::memory_order_relaxed);
+
+    CategoryIndex& category = categories_[c];
+    const auto pos = category.total.fetch_add(1, std::memory_order_acq_rel);
+    store_category_entry(category, pos, index);
+}
+
+void EventGraph::store_category_entry(CategoryIndex& category, std::size_t pos,
+                                      std::size_t index) {
+    if (auto* entries = acquire_category_segment(category, pos >> kSegmentShift)) {
+        // Release publishes the node written by push() to category readers
+        entries[pos & (kSegmentSize - 1)].store(link_of(index), std::memory_order_release);
+    }
+}
 
-    // Get current timestamp
+void EventGraph::store_node(EventNode& node, EventId id, const PendingEvent& event) {
+    node.id = id;
+    node.parent_id = event.parent;
+    node.timestamp = event.timestamp;
+    node.status = event.status;
+    node.operation = event.operation;
+    node.correlation_id = event.correlation_id;
+    std::memset(node._pad, 0, sizeof(node._pad));
+
+    // Copy payload - category must already match the expected category
+    assert(event.payload.category == event.category &&
+           "payload.category must match cat parameter");
+    node.payload = event.payload;
+}
+
+EventId EventGraph::push(Category cat, std::uint8_t op, Status status,
+                         EventId parent, uint32_t correlation_id,
+                         const EventPayload& payload) {
     const auto now = std::chrono::steady_clock::now();
     const auto timestamp = static_cast<Timestamp>(
         std::chrono::duration_cast<std::chrono::nanoseconds>(
             now.time_since_epoch())
             .count());
+    return push(cat, op, status, parent, correlation_id, payload, timestamp);
+}
+
+EventId EventGraph::push(Category cat, std::uint8_t op, Status status,
+                         EventId parent, uint32_t correlation_id,
+                         const EventPayload& payload, Timestamp timestamp) {
+    assert(payload.category == cat && "payload.category must match cat parameter");
+    (void)cat;
+    const Reservation slot = reserve();
+    if (!slot) {
+        return INVALID_EVENT;
+    }
+    slot.node->timestamp = timestamp;
+    slot.node->status = status;
+    slot.node->operation = op;
+    slot.node->payload = payload;
+    return commit(slot, parent, correlation_id);
+}
+
+EventGraph::Reservation EventGraph::reserve() {
+    // Reserve a slot atomically
+    auto index = count_.fetch_add(1, std::memory_order_acq_rel);
+
+    // Check capacity (ring mode never fills up, it recycles, until it has
+    // handed out kMaxEvents indexes)
+    if (index >= (retention_ == Retention::Append ? capacity_ : kMaxEvents)) {
+        // Rollback count if we exceeded capacity
+        count_.fetch_sub(1, std::memory_order_relaxed);
+        return {};
+    }
 
-    // Write event data to reserved slot
-    EventNode& node = nodes_[index];
+    EventNode* segment = acquire_segment(index >> kSegmentShift);
+    while (segment == nullptr && retention_ == Retention::Ring &&
+           index < first_index_.load(std::memory_order_acquire)) {
+        // Lapped by the writers: the reserved slot was recycled before this
+        // thread got to it, so take a fresh one instead of dropping the event
+        index = count_.fetch_add(1, std::memory_order_acq_rel);
+        if (index >= kMaxEvents) {
+            count_.fetch_sub(1, std::memory_order_relaxed);
+            return {};
+        }
+        segment = acquire_segment(index >> kSegmentShift);
+    }
+    if (segment == nullptr) {
+        // Arena exhausted - behave like a full graph. Ring indexes keep
+        // moving forward, so a rollback there could hand out a live index
+        // twice; the reserved slot is left as a zeroed hole instead.
+        if (retention_ == Retention::Append) {
+            count_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return {};
+    }
+    return {&segment[index & (kSegmentSize - 1)], index};
+}
+
+EventId EventGraph::commit(const Reservation& slot, EventId parent, uint32_t correlation_id,
+                           uint32_t pid) {
+    assert(slot && "commit() needs a reservation");
+    // The ID is the reserved slot, so get(id) always finds this node
+    const std::size_t index = slot.index;
+    const auto id = static_cast<EventId>(index) + 1;
+    EventNode& node = *slot.node;
     node.id = id;
     node.parent_id = parent;
-    node.timestamp = timestamp;
-    node.status = status;
-    node.operation = op;
     node.correlation_id = correlation_id;
     std::memset(node._pad, 0, sizeof(node._pad));
 
-    // Copy payload - category must already match the expected category
-    assert(payload.category == cat && "payload.category must match cat parameter");
-    node.payload = payload;
+    // Publish into the lock-free index chains
+    const Category cat = node.payload.category;
+    link_event(index, parent, correlation_id, process_key(node.payload, pid));
+    if (string_index_ != nullptr) {
+        string_index_->add(index, node.payload, first_index_.load(std::memory_order_relaxed));
+    }
+    index_category(cat, index);
+    index_timestamp(index, node.timestamp, node.timestamp);
+    counters_.add(cat, node.status, event_pid(node.payload));
+    if (timeline_ != nullptr) {
+        timeline_->add(node.timestamp, cat, node.status == Status::Suspicious);
+    }
+    if (sketches_ != nullptr) {
+        sketches_->add(node.payload, event_pid(node.payload));
+    }
 
-    // Update indexes under lock
-    {
-        std::unique_lock lock(mutex_);
-        if (parent != INVALID_EVENT) {
-            parent_index_.emplace(parent, index);
+    publish(index);
+    advance_published();
+    if (alerts_ != nullptr && node.status == Status::Suspicious) {
+        alerts_->push({id, node.timestamp, event_pid(node.payload), cat, node.operation, 0, 0});
+    }
+    if (retained_ != nullptr && node.status == Status::Suspicious) {
+        retained_->mark(correlation_id, event_pid(node.payload));
+    }
+    return id;
+}
+
+std::size_t EventGraph::push_batch(std::span<const PendingEvent> events,
+                                   std::span<EventId> ids) {
+    assert((ids.empty() || ids.size() >= events.size()) &&
+           "ids must be empty or hold one slot per event");
+    if (events.empty()) {
+        return 0;
+    }
+
+    // Reserve every slot with a single RMW; append mode keeps what fits
+    const auto first = count_.fetch_add(events.size(), std::memory_order_acq_rel);
+    std::size_t accepted = events.size();
+    const auto limit = retention_ == Retention::Append ? capacity_ : kMaxEvents;
+    if (first + accepted > limit) {
+        accepted = first < limit ? limit - first : 0;
+        count_.fetch_sub(events.size() - accepted, std::memory_order_relaxed);
+    }
+
+    std::size_t done = 0;
+    while (done < accepted) {
+        const auto index = first + done;
+        EventNode* segment = acquire_segment(index >> kSegmentShift);
+        if (segment == nullptr) {
+            break;
         }
-        if (correlation_id != 0) {
-            correlation_index_.emplace(correlation_id, index);
+
+        // Write the run that fits in this segment contiguously
+        const auto offset = index & (kSegmentSize - 1);
+        const auto run = (std::min)(accepted - done, kSegmentSize - offset);
+
+        // Category index positions once per category for the run, only
+        // now that its segment exists: a short batch leaves none unused
+        std::array<std::uint32_t, kCategoryCount> run_counts{};
+        for (std::size_t i = 0; i < run; ++i) {
+            const auto c = static_cast<std::size_t>(events[done + i].category);
+            if (c < kCategoryCount) {
+                ++run_counts[c];
+            }
+        }
+        std::array<std::size_t, kCategoryCount> category_pos{};
+        for (std::size_t c = 0; c < kCategoryCount; ++c) {
+            if (run_counts[c] != 0) {
+                category_pos[c] = categories_[c].total.fetch_add(run_counts[c],
+                                                                 std::memory_order_acq_rel);
+            }
+        }
+
+        Timestamp low = kNoTimestamp;
+        Timestamp high = 0;
+        EventTags run_tags = 0;
+        for (std::size_t i = 0; i < run; ++i) {
+            const PendingEvent& event = events[done + i];
+            const auto id = static_cast<EventId>(index + i) + 1;
+            store_node(segment[offset + i], id, event);
+            link_event(index + i, event.parent, event.correlation_id,
+                       process_key(event.payload, event.pid));
+            if (string_index_ != nullptr) {
+                string_index_->add(index + i, event.payload,
+                                   first_index_.load(std::memory_order_relaxed));
+            }
+
+            const auto c = static_cast<std::size_t>(event.category);
+            if (c < kCategoryCount) {
+                store_category_entry(categories_[c], category_pos[c]++, index + i);
+            }
+            low = (std::min)(low, event.timestamp);
+            high = (std::max)(high, event.timestamp);
+            counters_.add(event.category, event.status, event_pid(event.payload));
+            if (timeline_ != nullptr) {
+                timeline_->add(event.timestamp, event.category,
+                               event.status == Status::Suspicious);
+            }
+            if (sketches_ != nullptr) {
+                sketches_->add(event.payload, event_pid(event.payload));
+            }
+            if (event.tags != 0) {
+                links_at(index + i).tags.store(event.tags, std::memory_order_relaxed);
+                run_tags |= event.tags;
+            }
+            publish(index + i);
+            if (!ids.empty()) {
+                ids[done + i] = id;
+            }
+        }
+
+        Segment& slot = segments_[slot_of(index >> kSegmentShift)];
+        if (run_tags != 0) {
+            slot.tags.fetch_or(run_tags, std::memory_order_release);
+        }
+        for (std::size_t c = 0; c < kCategoryCount; ++c) {
+            if (run_counts[c] != 0) {
+                slot.category_counts[c].fetch_add(run_counts[c],
+                                                  std::memory_order_relaxed);
+            }
+        }
+        index_timestamp(index, low, high);
+        done += run;
+    }
+    advance_published();
+    if (alerts_ != nullptr) {
+        for (std::size_t i = 0; i < done; ++i) {
+            const PendingEvent& event = events[i];
+            if (event.status == Status::Suspicious) {
+                alerts_->push({static_cast<EventId>(first + i) + 1, event.timestamp,
+                               event_pid(event.payload), event.category, event.operation, 0,
+                               0});
+            }
+        }
+    }
+    if (retained_ != nullptr) {
+        for (std::size_t i = 0; i < done; ++i) {
+            const PendingEvent& event = events[i];
+            if (event.status == Status::Suspicious || event.tags != 0) {
+                retained_->mark(event.correlation_id, event_pid(event.payload));
+            }
         }
     }
 
-    return id;
+    if (done < accepted) {
+        // Arena exhausted (append) or lapped by the ring. Lapped events are
+        // retried one at a time on fresh slots, indexed as the runs above.
+        if (retention_ == Retention::Append) {
+            count_.fetch_sub(accepted - done, std::memory_order_relaxed);
+            return done;
+        }
+        for (; done < accepted; ++done) {
+            const PendingEvent& event = events[done];
+            assert(event.payload.category == event.category &&
+                   "payload.category must match cat parameter");
+            const Reservation slot = reserve();
+            if (!slot) {
+                break;
+            }
+            slot.node->timestamp = event.timestamp;
+            slot.node->status = event.status;
+            slot.node->operation = event.operation;
+            slot.node->payload = event.payload;
+            if (event.tags != 0) {
+                links_at(slot.index).tags.store(event.tags, std::memory_order_relaxed);
+                segments_[slot_of(slot.index >> kSegmentShift)].tags.fetch_or(
+                    event.tags, std::memory_order_release);
+            }
+            const auto id = commit(slot, event.parent, event.correlation_id, event.pid);
+            // commit() marks suspicious events itself
+            if (retained_ != nullptr && event.tags != 0 && event.status != Status::Suspicious) {
+                retained_->mark(event.correlation_id, event_pid(event.payload));
+            }
+            if (!ids.empty()) {
+                ids[done] = id;
+            }
+        }
+    }
+    return done;
+}
+
+void EventGraph::index_timestamp(std::size_t index, Timestamp low, Timestamp high) {
+    Segment& slot = segments_[slot_of(index >> kSegmentShift)];
+    // Push order is nearly monotonic, so after the first few events of a
+    // segment the min check is a plain load and the max CAS rarely retries
+    auto current_low = slot.min_timestamp.load(std::memory_order_relaxed);
+    while (low < current_low &&
+           !slot.min_timestamp.compare_exchange_weak(current_low, low,
+                                                     std::memory_order_release,
+                                                     std::memory_order_relaxed)) {
+    }
+    auto current_high = slot.max_timestamp.load(std::memory_order_relaxed);
+    while (high > current_high &&
+           !slot.max_timestamp.compare_exchange_weak(current_high, high,
+                                                     std::memory_order_release,
+                                                     std::memory_order_relaxed)) {
+    }
+}
+
+EventGraph::ChainHead* EventGraph::find_head(ChainHead* heads, uint32_t correlation_id,
+                                             bool create) const {
+    // Fibonacci hashing spreads the sequential IDs handed out by Correlator
+    // and the multiples of 4 that Windows uses as PIDs
+    auto pos = static_cast<std::size_t>(
+                   (static_cast<std::uint64_t>(correlation_id) * 0x9E3779B97F4A7C15ULL) >> 32) &
+               correlation_mask_;
+
+    for (std::size_t probe = 0; probe < kMaxCorrelationProbe; ++probe) {
+        ChainHead& entry = heads[pos];
+        auto key = entry.key.load(std::memory_order_acquire);
+        if (key == correlation_id) {
+            return &entry;
+        }
+        if (create) {
+            if (key == 0 &&
+                (entry.key.compare_exchange_strong(key, correlation_id,
+                                                   std::memory_order_acq_rel) ||
+                 key == correlation_id)) {
+                return &entry;
+            }
+            // Ring mode: an entry whose whole chain was evicted can be reused
+            const auto head = entry.head.load(std::memory_order_acquire);
+            if (key != 0 && head != 0 && !link_live(head) &&
+                entry.key.compare_exchange_strong(key, correlation_id,
+                                                  std::memory_order_acq_rel)) {
+                return &entry;
+            }
+        } else if (key == 0) {
+            return nullptr;
+        }
+        pos = (pos + 1) & correlation_mask_;
+    }
+    return nullptr;
+}
+
+void EventGraph::link_event(std::size_t index, EventId parent, uint32_t correlation_id,
+                            uint32_t pid) {
+    const Link link = link_of(index);
+    NodeLinks& links = links_at(index);
+
+    if (parent != INVALID_EVENT && exists(parent)) {
+        NodeLinks& parent_links = links_at(static_cast<std::size_t>(parent - 1));
+        link_front(parent_links.first_child, links.next_sibling, link);
+    }
+
+    if (correlation_id != 0) {
+        if (ChainHead* entry = find_head(correlation_heads_.get(), correlation_id, true)) {
+            link_front(entry->head, links.next_correlated, link);
+        } else {
+            unlinked_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    if (pid != 0) {
+        if (ChainHead* entry = find_head(process_heads_.get(), pid, true)) {
+            link_front(entry->head, links.next_in_process, link);
+        } else {
+            unlinked_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
 }
 
 EventView EventGraph::get(EventId id) const {
     // EventId starts at 1, so index = id - 1
-    const auto index = id - 1;
-    return EventView(&nodes_[index]);
+    const auto index = static_cast<std::size_t>(id - 1);
+    return EventView(node_at(index));
 }
 
 bool EventGraph::exists(EventId id) const noexcept {
-    if (id == INVALID_EVENT) {
+    if (id == INVALID_EVENT || is_evicted(id)) {
+        return false;
+    }
+    const auto index = static_cast<std::size_t>(id - 1);
+    if (retention_ == Retention::Append && index >= capacity_) {
+        return false;
+    }
+    // Below the watermark every node is written; above it, an individual
+    // push may already have published its own slot
+    if (index < published_.load(std::memory_order_acquire)) {
+        return segment_live(index >> kSegmentShift);
+    }
+    return index < count_.load(std::memory_order_acquire) &&
+           segment_live(index >> kSegmentShift) && slot_published(index);
+}
+
+bool EventGraph::set_status(EventId id, Status status) {
+    if (!exists(id)) {
         return false;
     }
-    const auto current_count = count_.load(std::memory_order_acquire);
-    // ID starts at 1, so valid IDs are 1..current_count
-    return id <= current_count;
+    const auto index = static_cast<std::size_t>(id - 1);
+    auto* node = const_cast<EventNode*>(node_at(index));
+    if (node->id != id) {
+        return false;
+    }
+    std::atomic_ref<Status> current(node->status);
+    Status previous = current.load(std::memory_order_relaxed);
+    do {
+        if (previous == status) {
+            return false;
+        }
+    } while (!current.compare_exchange_weak(previous, status, std::memory_order_relaxed));
+
+    counters_.restatus(node->payload.category, previous, status);
+    if (timeline_ != nullptr && status == Status::Suspicious) {
+        timeline_->flag(node->timestamp);
+    }
+    if (alerts_ != nullptr && status == Status::Suspicious) {
+        alerts_->push({id, node->timestamp, event_pid(node->payload), node->payload.category,
+                       node->operation, 1, 0});
+    }
+    if (retained_ != nullptr && status == Status::Suspicious) {
+        retained_->mark(node->correlation_id, event_pid(node->payload));
+    }
+
+    // Sealing copies statuses under the same lock, so either it sees the
+    // new status or the column is updated here
+    const auto segment = index >> kSegmentShift;
+    Segment& slot = segments_[slot_of(segment)];
+    std::lock_guard lock(segment_mutex_);
+    // Compression and spilling copy under the same lock: either the copy
+    // has the new status or it is applied to the copy here
+    if (EventNode* nodes = slot.nodes.load(std::memory_order_acquire); nodes == nullptr) {
+        if (cold_ != nullptr) {
+            update_cold(index, [status](EventNode& cold) { cold.status = status; });
+        }
+    } else if (&nodes[index & (kSegmentSize - 1)] != node) {
+        nodes[index & (kSegmentSize - 1)].status = status;
+    }
+    if (slot.sealed.load(std::memory_order_acquire) == static_cast<std::uint64_t>(segment) + 1) {
+        slot.columns.load(std::memory_order_acquire)->statuses[index & (kSegmentSize - 1)] = status;
+        if (SegmentBitmaps* bitmaps = slot.bitmaps.load(std::memory_order_acquire);
+            bitmaps != nullptr) {
+            bitmaps->statuses_current.store(false, std::memory_order_release);
+        }
+        if (SegmentZone* zone = slot.zone.load(std::memory_order_acquire); zone != nullptr) {
+            zone->statuses.fetch_or(1u << static_cast<uint32_t>(status),
+                                    std::memory_order_acq_rel);
+        }
+    }
+    return true;
+}
+
+bool EventGraph::set_extension(EventId id, ExtensionId extension) {
+    if (!exists(id) || extension == NO_EXTENSION) {
+        return false;
+    }
+    const auto index = static_cast<std::size_t>(id - 1);
+    auto* node = const_cast<EventNode*>(node_at(index));
+    if (node->id != id) {
+        return false;
+    }
+    ExtensionId expected = NO_EXTENSION;
+    if (!std::atomic_ref<ExtensionId>(node->payload.extension)
+             .compare_exchange_strong(expected, extension, std::memory_order_relaxed)) {
+        return false;
+    }
+    if (cold_ != nullptr || spill_ != nullptr) {
+        // As set_status(): a segment compressed or spilled meanwhile takes
+        // it in its copy
+        std::lock_guard lock(segment_mutex_);
+        EventNode* nodes =
+            segments_[slot_of(index >> kSegmentShift)].nodes.load(std::memory_order_acquire);
+        if (nodes == nullptr) {
+            update_cold(index, [extension](EventNode& cold) {
+                if (cold.payload.extension == NO_EXTENSION) {
+                    cold.payload.extension = extension;
+                }
+            });
+        } else if (EventNode& moved = nodes[index & (kSegmentSize - 1)]; &moved != node &&
+                   moved.payload.extension == NO_EXTENSION) {
+            moved.payload.extension = extension;
+        }
+    }
+    return true;
+}
+
+bool EventGraph::set_retained(RetainedEvents* store) noexcept {
+    if (store != nullptr && retention_ != Retention::Ring) {
+        return false;
+    }
+    retained_ = store;
+    return true;
+}
+
+void EventGraph::set_string_index(std::span<const PayloadField> fields) {
+    string_index_ = fields.empty() ? nullptr : std::make_unique<StringIndex>(fields);
+}
+
+void EventGraph::set_timeline(std::size_t seconds) {
+    timeline_ = seconds == 0 ? nullptr : std::make_unique<EventTimeline>(seconds);
+}
+
+void EventGraph::set_sketches(std::size_t top) {
+    sketches_ = top == 0 ? nullptr : std::make_unique<EventSketches>(top);
+}
+
+bool EventGraph::add_tags(EventId id, EventTags tags) {
+    if (!exists(id)) {
+        return false;
+    }
+    const auto index = static_cast<std::size_t>(id - 1);
+    if (node_at(index)->id != id) {
+        return false;
+    }
+    // Node first: a reader that finds the bit in the segment union then
+    // finds it on the node too
+    links_at(index).tags.fetch_or(tags, std::memory_order_release);
+    segments_[slot_of(index >> kSegmentShift)].tags.fetch_or(tags, std::memory_order_release);
+    if (retained_ != nullptr && tags != 0) {
+        const EventNode* node = node_at(index);
+        retained_->mark(node->correlation_id, event_pid(node->payload));
+    }
+    return true;
+}
+
+EventTags EventGraph::tags(EventId id) const noexcept {
+    if (!exists(id)) {
+        return 0;
+    }
+    return links_at(static_cast<std::size_t>(id - 1)).tags.load(std::memory_order_acquire);
 }
 
 std::size_t EventGraph::count() const noexcept {
-    return count_.load(std::memory_order_acquire);
+    const auto published = published_.load(std::memory_order_acquire);
+    if (retention_ == Retention::Append) {
+        return (std::min)(published, capacity_);
+    }
+    const auto first = first_index_.load(std::memory_order_acquire);
+    return published > first ? published - first : 0;
+}
+
+void EventGraph::publish(std::size_t index) noexcept {
+    // Release pairs with the acquire in slot_published(): the node body and
+    // its index links are visible to anyone who sees the flag
+    links_at(index).published.store(link_of(index), std::memory_order_release);
+}
+
+EventGraph::SegmentSpan EventGraph::segment_span(std::size_t index) const noexcept {
+    SegmentSpan span;
+    span.epoch = epoch_.load(std::memory_order_acquire);
+    const auto first = first_index_.load(std::memory_order_acquire);
+    span.first = (std::max)(index, first);
+    // Every slot below the watermark is published
+    const auto end = first + count();
+    const auto segment = span.first >> kSegmentShift;
+    if (span.first >= end || !segment_live(segment)) {
+        return span;
+    }
+    span.nodes = segment_nodes(segment) + (span.first & (kSegmentSize - 1));
+    span.length = (std::min)(end, (segment + 1) << kSegmentShift) - span.first;
+    return span;
+}
+
+void EventGraph::advance_published() noexcept {
+    // Writers finish out of order; whoever completes the oldest pending slot
+    // carries the watermark over every later slot that is already published
+    auto mark = published_.load(std::memory_order_acquire);
+    bool advanced = false;
+    while (mark < count_.load(std::memory_order_acquire) &&
+           segment_live(mark >> kSegmentShift) && slot_published(mark)) {
+        // seq_cst pairs with when_published(): either we see its watcher or
+        // it sees our mark (a locked instruction on x86 either way)
+        if (published_.compare_exchange_weak(mark, mark + 1,
+                                             std::memory_order_seq_cst,
+                                             std::memory_order_acquire)) {
+            ++mark;
+            advanced = true;
+            // The writer that completes a segment seals it
+            if ((mark & (kSegmentSize - 1)) == 0) {
+                if (columnar_.load(std::memory_order_relaxed)) {
+                    seal_segment((mark >> kSegmentShift) - 1);
+                }
+                // ... and compresses the one that left the hot window
+                if (cold_ != nullptr && (mark >> kSegmentShift) > cold_->hot_segments) {
+                    compress_segment((mark >> kSegmentShift) - 1 - cold_->hot_segments);
+                } else if (spill_ != nullptr && (mark >> kSegmentShift) > spill_hot_) {
+                    spill_segment((mark >> kSegmentShift) - 1 - spill_hot_);
+                }
+            }
+        }
+    }
+    if (advanced && watching_.load(std::memory_order_seq_cst) != 0) {
+        notify_watchers(mark);
+    }
+}
+
+void EventGraph::when_published(EventId after, Task fn) {
+    {
+        std::lock_guard lock(watch_mutex_);
+        watchers_.push_back({static_cast<std::size_t>(after), std::move(fn)});
+        watching_.store(watchers_.size(), std::memory_order_seq_cst);
+    }
+    const auto mark = published_.load(std::memory_order_seq_cst);
+    if (mark > after) {
+        notify_watchers(mark);
+    }
+}
+
+void EventGraph::notify_watchers(std::size_t mark) {
+    std::vector<Task> ready;
+    {
+        std::lock_guard lock(watch_mutex_);
+        std::erase_if(watchers_, [&ready, mark](Watcher& watcher) {
+            if (watcher.after >= mark) {
+                return false;
+            }
+            ready.push_back(std::move(watcher.fn));
+            return true;
+        });
+        watching_.store(watchers_.size(), std::memory_order_seq_cst);
+    }
+    for (Task& fn : ready) {
+        fn();
+    }
+}
+
+void EventGraph::release_watchers() {
+    notify_watchers(std::numeric_limits<std::size_t>::max());
+}
+
+bool EventGraph::seal_segment(std::size_t segment) {
+    Segment& slot = segments_[slot_of(segment)];
+    const auto tag = static_cast<std::uint64_t>(segment) + 1;
+
+    std::lock_guard lock(segment_mutex_);
+    if (slot.tag.load(std::memory_order_acquire) != tag ||
+        slot.sealed.load(std::memory_order_acquire) == tag) {
+        return false;
+    }
+
+    // Column storage is allocated once per directory slot and reused when
+    // ring mode recycles the slot
+    const SegmentColumns* columns = slot.columns.load(std::memory_order_acquire);
+    if (columns == nullptr) {
+        auto* fresh = arena_.allocate<SegmentColumns>(1);
+        if (fresh == nullptr) {
+            return false;
+        }
+        fresh->timestamps = arena_.allocate<Timestamp>(kSegmentSize);
+        fresh->correlation_ids = arena_.allocate<uint32_t>(kSegmentSize);
+        fresh->pids = arena_.allocate<uint32_t>(kSegmentSize);
+        fresh->remote_ports = arena_.allocate<uint16_t>(kSegmentSize);
+        fresh->categories = arena_.allocate<Category>(kSegmentSize);
+        fresh->operations = arena_.allocate<uint8_t>(kSegmentSize);
+        fresh->statuses = arena_.allocate<Status>(kSegmentSize);
+        if (fresh->timestamps == nullptr || fresh->correlation_ids == nullptr ||
+            fresh->pids == nullptr || fresh->remote_ports == nullptr ||
+            fresh->categories == nullptr || fresh->operations == nullptr ||
+            fresh->statuses == nullptr) {
+            return false;
+        }
+        slot.columns.store(fresh, std::memory_order_release);
+        storage_bytes_.fetch_add(sizeof(SegmentColumns) + kColumnBytes,
+                                 std::memory_order_relaxed);
+        columns = fresh;
+    }
+
+    DecodedNodes pin;
+    const EventNode* nodes = segment_nodes(segment, pin);
+    for (std::size_t i = 0; i < kSegmentSize; ++i) {
+        store_columns(*columns, i, nodes[i]);
+    }
+
+    // Row groups are optional: without them filters read every column
+    SegmentBitmaps* bitmaps = slot.bitmaps.load(std::memory_order_acquire);
+    if (bitmaps == nullptr) {
+        bitmaps = allocate_bitmaps(arena_);
+        if (bitmaps != nullptr) {
+            slot.bitmaps.store(bitmaps, std::memory_order_release);
+            storage_bytes_.fetch_add(sizeof(SegmentBitmaps) + kBitmapBytes,
+                                     std::memory_order_relaxed);
+        }
+    }
+    if (bitmaps != nullptr) {
+        store_bitmaps(*bitmaps, *columns, kSegmentSize);
+    }
+    SegmentZone* zone = slot.zone.load(std::memory_order_acquire);
+    if (zone == nullptr) {
+        if (auto* storage = arena_.allocate<SegmentZone>(1); storage != nullptr) {
+            zone = std::construct_at(storage);
+            slot.zone.store(zone, std::memory_order_release);
+            storage_bytes_.fetch_add(sizeof(SegmentZone), std::memory_order_relaxed);
+        }
+    }
+    if (zone != nullptr) {
+        store_zone(*zone, *columns, nodes, kSegmentSize);
+    }
+    slot.sealed.store(tag, std::memory_order_release);
+    return true;
+}
+
+bool EventGraph::segment_may_match(std::size_t segment, const FilterSpec& spec) const noexcept {
+    const Segment& slot = segments_[slot_of(segment)];
+    if (slot.max_timestamp.load(std::memory_order_acquire) < spec.from ||
+        slot.min_timestamp.load(std::memory_order_acquire) > spec.to) {
+        return false;
+    }
+    if (spec.categories != 0) {
+        bool any = false;
+        for (auto set = spec.categories; set != 0 && !any; set &= set - 1) {
+            const auto c = static_cast<std::size_t>(std::countr_zero(set));
+            any = c < kCategoryCount &&
+                  slot.category_counts[c].load(std::memory_order_relaxed) != 0;
+        }
+        if (!any) {
+            return false;
+        }
+    }
+    // The zone map describes the segment only while it is sealed
+    const SegmentZone* zone = slot.zone.load(std::memory_order_acquire);
+    return zone == nullptr ||
+           slot.sealed.load(std::memory_order_acquire) != static_cast<std::uint64_t>(segment) + 1 ||
+           zone->may_match(spec);
+}
+
+std::size_t EventGraph::seal_segments() {
+    const auto begin = first_index_.load(std::memory_order_acquire);
+    const auto end = published_.load(std::memory_order_acquire);
+    std::size_t sealed = 0;
+    for (auto segment = begin >> kSegmentShift; ((segment + 1) << kSegmentShift) <= end;
+         ++segment) {
+        if (seal_segment(segment)) {
+            ++sealed;
+        }
+    }
+    return sealed;
+}
+
+bool EventGraph::set_compression(const CompressionConfig& config) {
+    if (!config.enabled) {
+        cold_.reset();
+        return true;
+    }
+    if (retention_ == Retention::Ring) {
+        return false;
+    }
+    cold_ = std::make_unique<ColdStore>(config, max_segments_);
+    return true;
+}
+
+std::size_t EventGraph::compress_segments() {
+    if (cold_ == nullptr) {
+        return 0;
+    }
+    const auto full = (std::min)(published_.load(std::memory_order_acquire), capacity_) >>
+                      kSegmentShift;
+    std::size_t segment = 0;
+    {
+        std::lock_guard lock(segment_mutex_);
+        segment = cold_->next;
+    }
+    std::size_t compressed = 0;
+    for (; segment + cold_->hot_segments < full; ++segment) {
+        if (compress_segment(segment)) {
+            ++compressed;
+        }
+    }
+    return compressed;
+}
+
+bool EventGraph::compress_segment(std::size_t segment) {
+    ColdStore& cold = *cold_;
+    Segment& slot = segments_[segment];
+
+    // Packed under the lock that set_status() takes after its write, so a
+    // late status is either packed or applied to the decoded copy
+    std::lock_guard lock(segment_mutex_);
+    EventNode* nodes = slot.nodes.load(std::memory_order_acquire);
+    if (slot.tag.load(std::memory_order_acquire) != static_cast<std::uint64_t>(segment) + 1 ||
+        nodes == nullptr || ((segment + 1) << kSegmentShift) > capacity_) {
+        return false;
+    }
+    std::vector<std::uint8_t> packed;
+    pack_events({reinterpret_cast<const std::uint8_t*>(nodes), sizeof(EventNode) * kSegmentSize},
+                packed);
+    packed.shrink_to_fit();
+    cold.packed_bytes.fetch_add(packed.size(), std::memory_order_relaxed);
+    {
+        std::lock_guard cold_lock(cold.mutex);
+        cold.packed[segment] = std::move(packed);
+    }
+
+    // As ring eviction: the epoch moves before the storage is reused
+    slot.nodes.store(nullptr, std::memory_order_release);
+    epoch_.fetch_add(1, std::memory_order_acq_rel);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    spare_nodes_.push_back(nodes);
+    cold.segments.fetch_add(1, std::memory_order_relaxed);
+    if (segment == cold.next) {
+        ++cold.next;
+    }
+    return true;
+}
+
+const EventNode* EventGraph::cold_nodes(std::size_t segment, DecodedNodes* pin) const noexcept {
+    // Only compressed segments have no node storage, so cold_ is set
+    ColdStore& cold = *cold_;
+    DecodedNodes nodes;
+    {
+        std::lock_guard lock(cold.mutex);
+        nodes = cold.decoded(segment).nodes;
+    }
+    if (pin != nullptr) {
+        *pin = std::move(nodes);
+        return pin->get();
+    }
+    t_pins.hold(nodes);
+    return nodes.get();
+}
+
+template <typename Update>
+void EventGraph::update_cold(std::size_t index, Update&& update) {
+    ColdStore& cold = *cold_;
+    std::lock_guard lock(cold.mutex);
+    ColdStore::Decoded& entry = cold.decoded(index >> kSegmentShift);
+    update(entry.nodes[index & (kSegmentSize - 1)]);
+    entry.dirty = true;
+}
+
+CompressionStats EventGraph::compression_stats() const noexcept {
+    CompressionStats stats;
+    if (cold_ == nullptr) {
+        return stats;
+    }
+    stats.segments = cold_->segments.load(std::memory_order_relaxed);
+    stats.raw_bytes = static_cast<std::uint64_t>(stats.segments) * sizeof(EventNode) * kSegmentSize;
+    stats.packed_bytes = cold_->packed_bytes.load(std::memory_order_relaxed);
+    stats.decodes = cold_->decodes.load(std::memory_order_relaxed);
+    stats.decode_ns = cold_->decode_ns.load(std::memory_order_relaxed);
+    stats.cache_hits = cold_->cache_hits.load(std::memory_order_relaxed);
+    stats.repacks = cold_->repacks.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool EventGraph::set_spill(Arena* storage, std::size_t hot_segments) {
+    if (storage == nullptr) {
+        spill_ = nullptr;
+        return true;
+    }
+    if (retention_ == Retention::Ring || cold_ != nullptr) {
+        return false;
+    }
+    spill_ = storage;
+    spill_hot_ = (std::max)(hot_segments, std::size_t{1});
+    return true;
+}
+
+std::size_t EventGraph::spill_segments() {
+    if (spill_ == nullptr) {
+        return 0;
+    }
+    const auto full = (std::min)(published_.load(std::memory_order_acquire), capacity_) >>
+                      kSegmentShift;
+    std::size_t segment = 0;
+    {
+        std::lock_guard lock(segment_mutex_);
+        segment = spill_next_;
+    }
+    std::size_t spilled = 0;
+    for (; segment + spill_hot_ < full; ++segment) {
+        if (spill_segment(segment)) {
+            ++spilled;
+        }
+    }
+    return spilled;
+}
+
+bool EventGraph::spill_segment(std::size_t segment) {
+    Segment& slot = segments_[segment];
+
+    // Copied under the lock set_status() takes after its write, so a late
+    // status is either copied or applied to the copy
+    std::lock_guard lock(segment_mutex_);
+    EventNode* nodes = slot.nodes.load(std::memory_order_acquire);
+    if (slot.tag.load(std::memory_order_acquire) != static_cast<std::uint64_t>(segment) + 1 ||
+        nodes == nullptr || ((segment + 1) << kSegmentShift) > capacity_) {
+        return false;
+    }
+    const auto* storage = reinterpret_cast<const std::uint8_t*>(nodes);
+    if (storage >= spill_->base() && storage < spill_->base() + spill_->capacity()) {
+        return false;  // Already spilled
+    }
+    EventNode* spilled = spill_->allocate<EventNode>(kSegmentSize);
+    if (spilled == nullptr) {
+        return false;
+    }
+    std::memcpy(static_cast<void*>(spilled), nodes, sizeof(EventNode) * kSegmentSize);
+
+    // As ring eviction: the epoch moves before the storage is reused
+    slot.nodes.store(spilled, std::memory_order_release);
+    epoch_.fetch_add(1, std::memory_order_acq_rel);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    spare_nodes_.push_back(nodes);
+    spill_->page_out(spilled, sizeof(EventNode) * kSegmentSize);
+    spilled_.fetch_add(1, std::memory_order_relaxed);
+    if (segment == spill_next_) {
+        ++spill_next_;
+    }
+    return true;
+}
+
+std::size_t EventGraph::sealed_count() const noexcept {
+    const auto begin = first_index_.load(std::memory_order_acquire);
+    const auto end = published_.load(std::memory_order_acquire);
+    std::size_t sealed = 0;
+    for (auto segment = begin >> kSegmentShift; ((segment + 1) << kSegmentShift) <= end;
+         ++segment) {
+        if (segments_[slot_of(segment)].sealed.load(std::memory_order_acquire) ==
+            segment + 1) {
+            ++sealed;
+        }
+    }
+    return sealed;
+}
+
+std::size_t EventGraph::scan(const FilterSpec& spec, std::vector<EventId>& out) const {
+    const auto before = out.size();
+    const auto begin = first_index_.load(std::memory_order_acquire);
+    match_where(begin, begin + count(), spec, [&out](std::size_t index, const EventNode&) {
+        out.push_back(static_cast<EventId>(index) + 1);
+        return true;
+    });
+    return out.size() - before;
+}
+
+std::size_t EventGraph::parallel_scan(const FilterSpec& spec, std::vector<EventId>& out,
+                                      ThreadPool& pool) const {
+    const auto begin = first_index_.load(std::memory_order_acquire);
+    const auto end = begin + count();
+    std::vector<std::vector<EventId>> partial(chunk_count(begin, end));
+    run_chunks(begin, end, pool, [this, &spec, &partial](std::size_t i, std::size_t first,
+                                                         std::size_t last) {
+        auto& ids = partial[i];
+        match_where(first, last, spec, [&ids](std::size_t index, const EventNode&) {
+            ids.push_back(static_cast<EventId>(index) + 1);
+            return true;
+        });
+        return true;
+    });
+
+    std::size_t total = 0;
+    for (const auto& ids : partial) {
+        total += ids.size();
+    }
+    out.reserve(out.size() + total);
+    for (const auto& ids : partial) {
+        out.insert(out.end(), ids.begin(), ids.end());
+    }
+    return total;
+}
+
+EventId EventGraph::newest_id() const noexcept {
+    return oldest_id() + count() - 1;
+}
+
+EventId EventGraph::oldest_id() const noexcept {
+    return static_cast<EventId>(first_index_.load(std::memory_order_acquire)) + 1;
+}
+
+std::uint64_t EventGraph::epoch() const noexcept {
+    return epoch_.load(std::memory_order_acquire);
+}
+
+bool EventGraph::is_evicted(EventId id) const noexcept {
+    return id != INVALID_EVENT && id < oldest_id();
+}
+
+std::size_t EventGraph::segment_count() const noexcept {
+    return segments_allocated_.load(std::memory_order_relaxed);
+}
+
+std::size_t EventGraph::category_count(Category cat) const noexcept {
+    const auto c = static_cast<std::size_t>(cat);
+    if (c >= kCategoryCount) {
+        return 0;
+    }
+    const CategoryIndex& index = categories_[c];
+    const auto total = index.total.load(std::memory_order_acquire);
+    const auto evicted = index.evicted.load(std::memory_order_acquire);
+    return total > evicted ? total - evicted : 0;
+}
+
+std::size_t EventGraph::estimate_in_range(Timestamp from, Timestamp to) const noexcept {
+    if (from > to) {
+        return 0;
+    }
+    const auto begin = first_index_.load(std::memory_order_acquire);
+    const auto end = begin + count();
+    std::size_t rows = 0;
+    for (auto segment = begin >> kSegmentShift; (segment << kSegmentShift) < end;
+         ++segment) {
+        const Segment& slot = segments_[slot_of(segment)];
+        if (!segment_live(segment) ||
+            slot.max_timestamp.load(std::memory_order_acquire) < from ||
+            slot.min_timestamp.load(std::memory_order_acquire) > to) {
+            continue;
+        }
+        rows += (std::min)(end, (segment + 1) << kSegmentShift) -
+                (std::max)(begin, segment << kSegmentShift);
+    }
+    return rows;
 }
 
 std::string_view EventGraph::resolve_string(StringId id) const {
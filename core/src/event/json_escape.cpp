@@ -0,0 +1,131 @@
+/// @file json_escape.cpp
+/// @brief SSE2/AVX2 scan for the characters JSON strings must escape.
+
+#include "exeray/event/json_escape.hpp"
+
+#include <bit>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EXERAY_JSON_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace exeray::event {
+
+namespace {
+
+constexpr bool needs_escape(char c) noexcept {
+    const auto byte = static_cast<std::uint8_t>(c);
+    return byte < 0x20 || c == '"' || c == '\\';
+}
+
+#if defined(__AVX2__)
+
+/// @brief Bit i set when byte i of the 32 at p needs escaping.
+std::uint32_t escape_mask32(const char* p) noexcept {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    // Unsigned v <= 0x1F: the maximum with 0x1F is 0x1F
+    const __m256i control = _mm256_cmpeq_epi8(_mm256_max_epu8(v, _mm256_set1_epi8(0x1F)),
+                                              _mm256_set1_epi8(0x1F));
+    const __m256i quote = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'));
+    const __m256i backslash = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'));
+    return static_cast<std::uint32_t>(
+        _mm256_movemask_epi8(_mm256_or_si256(control, _mm256_or_si256(quote, backslash))));
+}
+
+#elif defined(EXERAY_JSON_SSE2)
+
+/// @brief Bit i set when byte i of the 16 at p needs escaping.
+std::uint32_t escape_mask16(const char* p) noexcept {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i control =
+        _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(0x1F)), _mm_set1_epi8(0x1F));
+    const __m128i quote = _mm_cmpeq_epi8(v, _mm_set1_epi8('"'));
+    const __m128i backslash = _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'));
+    return static_cast<std::uint32_t>(
+        _mm_movemask_epi8(_mm_or_si128(control, _mm_or_si128(quote, backslash))));
+}
+
+#endif
+
+}  // namespace
+
+std::size_t json_plain_prefix(std::string_view text) noexcept {
+    const char* p = text.data();
+    const std::size_t size = text.size();
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= size; i += 32) {
+        if (const std::uint32_t mask = escape_mask32(p + i); mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+#elif defined(EXERAY_JSON_SSE2)
+    for (; i + 16 <= size; i += 16) {
+        if (const std::uint32_t mask = escape_mask16(p + i); mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+#endif
+    while (i < size && !needs_escape(p[i])) {
+        ++i;
+    }
+    return i;
+}
+
+void append_json_string(std::string& out, std::string_view text) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    out.push_back('"');
+    while (!text.empty()) {
+        const std::size_t plain = json_plain_prefix(text);
+        out.append(text.data(), plain);
+        text.remove_prefix(plain);
+        if (text.empty()) {
+            break;
+        }
+        const auto c = static_cast<std::uint8_t>(text.front());
+        text.remove_prefix(1);
+        switch (c) {
+            case '"':
+                out.append("\\\"", 2);
+                break;
+            case '\\':
+                out.append("\\\\", 2);
+                break;
+            case '\n':
+                out.append("\\n", 2);
+                break;
+            case '\r':
+                out.append("\\r", 2);
+                break;
+            case '\t':
+                out.append("\\t", 2);
+                break;
+            case '\b':
+                out.append("\\b", 2);
+                break;
+            case '\f':
+                out.append("\\f", 2);
+                break;
+            default: {
+                const char escape[] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 15]};
+                out.append(escape, sizeof(escape));
+                break;
+            }
+        }
+    }
+    out.push_back('"');
+}
+
+bool json_kernels_vectorized() noexcept {
+#if defined(__AVX2__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+}  // namespace exeray::event
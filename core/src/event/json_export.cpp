@@ -0,0 +1,153 @@
+/// @file json_export.cpp
+/// @brief NDJSON rendering with a per-StringId escaped literal cache.
+
+#include "exeray/event/json_export.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+#include "exeray/event/json_escape.hpp"
+
+namespace exeray::event {
+
+namespace {
+
+/// Bytes rendered before write() hands them to the stream.
+constexpr std::size_t kWriteChunk = std::size_t{1} << 20;
+
+constexpr std::string_view kStatusNames[] = {"Success", "Denied", "Pending", "Error",
+                                             "Suspicious"};
+
+void append_number(std::string& out, std::uint64_t value) {
+    char digits[20];
+    const auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    out.append(digits, static_cast<std::size_t>(end - digits));
+}
+
+/// @brief Append an IPv4 address stored in network byte order as "a.b.c.d".
+void append_ipv4(std::string& out, std::uint32_t address) {
+    std::uint8_t bytes[4];
+    std::memcpy(bytes, &address, sizeof(bytes));
+    out.push_back('"');
+    for (std::size_t i = 0; i < 4; ++i) {
+        if (i != 0) {
+            out.push_back('.');
+        }
+        append_number(out, bytes[i]);
+    }
+    out.push_back('"');
+}
+
+}  // namespace
+
+NdjsonExporter::NdjsonExporter(const StringPool& strings, std::size_t cache_bytes)
+    : strings_(strings),
+      cache_bytes_((std::min)(cache_bytes,
+                              std::size_t{std::numeric_limits<std::uint32_t>::max()})) {
+    for (const PayloadField& field : payload_fields()) {
+        const bool address =
+            field.category == Category::Network &&
+            (field.name == "local_addr" || field.name == "remote_addr");
+        members_[static_cast<std::size_t>(field.category)].push_back(
+            {field, ",\"" + std::string(field.name) + "\":", address});
+    }
+}
+
+void NdjsonExporter::append(EventView event, std::string& out) {
+    out.append("{\"id\":", 6);
+    append_number(out, event.id());
+    out.append(",\"parent_id\":", 13);
+    append_number(out, event.parent_id());
+    out.append(",\"timestamp\":", 13);
+    append_number(out, event.timestamp());
+    if (wall_clock_.valid()) {
+        out.append(",\"wall_time\":", 13);
+        append_number(out, wall_clock_.to_unix(event.timestamp()));
+    }
+    out.append(",\"correlation_id\":", 18);
+    append_number(out, event.correlation_id());
+
+    const Category category = event.category();
+    const std::string_view name = category_name(category);
+    out.append(",\"category\":\"", 13);
+    out.append(name.data(), name.size());
+    out.append("\",\"operation\":", 14);
+    append_number(out, event.operation());
+    out.append(",\"status\":", 10);
+    const auto status = static_cast<std::size_t>(event.status());
+    if (status < std::size(kStatusNames)) {
+        out.push_back('"');
+        out.append(kStatusNames[status]);
+        out.push_back('"');
+    } else {
+        append_number(out, status);
+    }
+
+    if (static_cast<std::size_t>(category) < members_.size()) {
+        const EventPayload& payload = event.payload();
+        const auto* bytes = reinterpret_cast<const std::uint8_t*>(&payload);
+        const bool ipv6 = category == Category::Network && payload.network.family == kAddressIPv6;
+        for (const Member& member : members_[static_cast<std::size_t>(category)]) {
+            out.append(member.key);
+            std::uint64_t value = 0;
+            std::memcpy(&value, bytes + member.field.offset, member.field.size);
+            if (member.field.is_string || (member.address && ipv6)) {
+                append_string(out, static_cast<StringId>(value));
+            } else if (member.address) {
+                append_ipv4(out, static_cast<std::uint32_t>(value));
+            } else {
+                append_number(out, value);
+            }
+        }
+    }
+    out.append("}\n", 2);
+}
+
+void NdjsonExporter::append_string(std::string& out, StringId id) {
+    if (id == INVALID_STRING) {
+        out.append("null", 4);
+        return;
+    }
+    if (const auto it = cache_.find(id); it != cache_.end()) {
+        out.append(cache_text_, it->second.offset, it->second.length);
+        return;
+    }
+    const std::string_view text = strings_.get(id);
+    if (text.size() > kMaxCachedJsonString ||
+        cache_text_.size() + text.size() * kMaxJsonEscape + 2 > cache_bytes_) {
+        append_json_string(out, text);
+        return;
+    }
+    const std::size_t offset = cache_text_.size();
+    append_json_string(cache_text_, text);
+    const std::size_t length = cache_text_.size() - offset;
+    cache_.emplace(id, Cached{static_cast<std::uint32_t>(offset),
+                              static_cast<std::uint32_t>(length)});
+    out.append(cache_text_, offset, length);
+}
+
+std::size_t NdjsonExporter::write(const EventGraph& graph, std::ostream& out) {
+    std::string buffer;
+    buffer.reserve(kWriteChunk + 4096);
+    std::size_t events = 0;
+    graph.for_each([&](EventView event) {
+        append(event, buffer);
+        ++events;
+        if (buffer.size() >= kWriteChunk) {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    });
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return events;
+}
+
+void NdjsonExporter::clear_cache() {
+    cache_.clear();
+    cache_text_.clear();
+}
+
+}  // namespace exeray::event
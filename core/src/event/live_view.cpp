@@ -0,0 +1,94 @@
+/// @file live_view.cpp
+/// @brief Incremental maintenance and paging of LiveView.
+
+#include "exeray/event/live_view.hpp"
+
+#include <algorithm>
+
+namespace exeray::event {
+
+namespace {
+
+/// Events refresh() visits per graph run.
+constexpr std::size_t kRefreshBatch = 4096;
+
+}  // namespace
+
+LiveView::LiveView(const EventGraph& graph, const FilterSpec& filter, ViewOptions options)
+    : graph_(graph), filter_(filter), options_(options), epoch_(graph.epoch()) {
+    options_.page_size = std::max<std::size_t>(options_.page_size, 1);
+}
+
+std::size_t LiveView::pages() const noexcept {
+    return (entries_.size() + options_.page_size - 1) / options_.page_size;
+}
+
+uint64_t LiveView::key_of(const EventNode& node) const noexcept {
+    switch (options_.sort) {
+        case ViewSort::Timestamp:
+            return node.timestamp;
+        case ViewSort::Pid:
+            return event_pid(node.payload);
+        case ViewSort::Id:
+            break;
+    }
+    return node.id;
+}
+
+void LiveView::insert(const Entry& entry) {
+    if (entries_.empty() || entries_.back() < entry) {
+        entries_.push_back(entry);
+        return;
+    }
+    entries_.insert(std::upper_bound(entries_.begin(), entries_.end(), entry), entry);
+}
+
+std::size_t LiveView::refresh() {
+    const EventId newest = graph_.newest_id();
+    if (next_ > static_cast<std::size_t>(newest)) {
+        // The session was reset: IDs start over
+        entries_.clear();
+        next_ = 0;
+    }
+    if (const uint64_t epoch = graph_.epoch(); epoch != epoch_) {
+        epoch_ = epoch;
+        const EventId oldest = graph_.oldest_id();
+        std::erase_if(entries_, [oldest](const Entry& entry) { return entry.id < oldest; });
+    }
+
+    std::size_t added = 0;
+    for (;;) {
+        EventId last = INVALID_EVENT;
+        const std::size_t visited =
+            graph_.for_each_run(next_, kRefreshBatch, [&](const EventNode& node) {
+                last = node.id;
+                if (filter_.matches(node)) {
+                    insert({key_of(node), node.id});
+                    ++added;
+                }
+            });
+        if (visited == 0) {
+            return added;
+        }
+        next_ = static_cast<std::size_t>(last);  // Index of the event after last
+    }
+}
+
+std::size_t LiveView::page(std::size_t index, std::span<QueryRow> out) const {
+    if (index >= pages()) {
+        return 0;
+    }
+    const std::size_t size = entries_.size();
+    const std::size_t begin = index * options_.page_size;
+    const std::size_t count = std::min({options_.page_size, size - begin, out.size()});
+    std::size_t written = 0;
+    for (std::size_t i = begin; i < begin + count; ++i) {
+        const Entry& entry = entries_[options_.descending ? size - 1 - i : i];
+        if (graph_.exists(entry.id)) {  // Skip what was evicted since refresh()
+            out[written++] = project(graph_.get(entry.id));
+        }
+    }
+    return written;
+}
+
+}  // namespace exeray::event
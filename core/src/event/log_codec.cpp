@@ -0,0 +1,202 @@
+/// @file log_codec.cpp
+/// @brief LZ coder and EventNode transform of the event log blocks.
+
+#include "exeray/event/log_codec.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace exeray::event {
+
+namespace {
+
+constexpr std::size_t kMinMatch = 4;
+constexpr std::size_t kMaxOffset = 65535;
+constexpr unsigned kHashBits = 14;
+constexpr std::size_t kNodeSize = sizeof(EventNode);
+
+std::uint32_t read32(const std::uint8_t* at) noexcept {
+    std::uint32_t value;
+    std::memcpy(&value, at, sizeof(value));
+    return value;
+}
+
+std::uint32_t hash(std::uint32_t sequence) noexcept {
+    return (sequence * 2654435761U) >> (32 - kHashBits);
+}
+
+/// @brief Rest of a length whose nibble is 15: 255s, then the remainder.
+void put_length(std::vector<std::uint8_t>& out, std::size_t rest) {
+    for (; rest >= 255; rest -= 255) {
+        out.push_back(255);
+    }
+    out.push_back(static_cast<std::uint8_t>(rest));
+}
+
+/// @brief Append a sequence; match_length 0 is the closing literals-only one.
+void put_sequence(std::vector<std::uint8_t>& out, std::span<const std::uint8_t> literals,
+                  std::size_t offset, std::size_t match_length) {
+    const std::size_t extra = match_length != 0 ? match_length - kMinMatch : 0;
+    out.push_back(static_cast<std::uint8_t>(((std::min)(literals.size(), std::size_t{15}) << 4) |
+                                            (std::min)(extra, std::size_t{15})));
+    if (literals.size() >= 15) {
+        put_length(out, literals.size() - 15);
+    }
+    out.insert(out.end(), literals.begin(), literals.end());
+    if (match_length != 0) {
+        out.push_back(static_cast<std::uint8_t>(offset));
+        out.push_back(static_cast<std::uint8_t>(offset >> 8));
+        if (extra >= 15) {
+            put_length(out, extra - 15);
+        }
+    }
+}
+
+std::uint64_t zigzag(std::uint64_t delta) noexcept {
+    return (delta << 1) ^ (0 - (delta >> 63));
+}
+
+std::uint64_t unzigzag(std::uint64_t value) noexcept {
+    return (value >> 1) ^ (0 - (value & 1));
+}
+
+}  // namespace
+
+void pack_bytes(std::span<const std::uint8_t> data, std::vector<std::uint8_t>& out) {
+    out.reserve(out.size() + data.size() / 2 + 16);
+    std::vector<std::uint32_t> table(std::size_t{1} << kHashBits, 0);  // Position + 1
+    const std::uint8_t* bytes = data.data();
+    std::size_t anchor = 0;
+    std::size_t pos = 0;
+    while (data.size() - pos >= kMinMatch) {
+        const std::uint32_t sequence = read32(bytes + pos);
+        std::uint32_t& slot = table[hash(sequence)];
+        const std::size_t candidate = slot;
+        slot = static_cast<std::uint32_t>(pos + 1);
+        if (candidate == 0 || pos - (candidate - 1) > kMaxOffset ||
+            read32(bytes + candidate - 1) != sequence) {
+            ++pos;
+            continue;
+        }
+        const std::size_t match = candidate - 1;
+        std::size_t length = kMinMatch;
+        while (pos + length < data.size() && bytes[match + length] == bytes[pos + length]) {
+            ++length;
+        }
+        put_sequence(out, data.subspan(anchor, pos - anchor), pos - match, length);
+        pos += length;
+        anchor = pos;
+    }
+    put_sequence(out, data.subspan(anchor), 0, 0);
+}
+
+bool unpack_bytes(std::span<const std::uint8_t> packed, std::span<std::uint8_t> out) noexcept {
+    std::size_t in = 0;
+    std::size_t at = 0;
+    auto read_length = [&](std::size_t& length) {
+        for (;;) {
+            if (in >= packed.size()) {
+                return false;
+            }
+            const std::uint8_t byte = packed[in++];
+            length += byte;
+            if (byte != 255) {
+                return true;
+            }
+        }
+    };
+
+    while (at < out.size()) {
+        if (in >= packed.size()) {
+            return false;
+        }
+        const std::uint8_t token = packed[in++];
+        std::size_t literals = token >> 4;
+        if (literals == 15 && !read_length(literals)) {
+            return false;
+        }
+        if (literals > packed.size() - in || literals > out.size() - at) {
+            return false;
+        }
+        std::memcpy(out.data() + at, packed.data() + in, literals);
+        in += literals;
+        at += literals;
+        if (at == out.size()) {
+            break;  // The closing sequence has no match
+        }
+
+        if (packed.size() - in < 2) {
+            return false;
+        }
+        const std::size_t offset = packed[in] | (std::size_t{packed[in + 1]} << 8);
+        in += 2;
+        std::size_t length = token & 15;
+        if (length == 15 && !read_length(length)) {
+            return false;
+        }
+        length += kMinMatch;
+        if (offset == 0 || offset > at || length > out.size() - at) {
+            return false;
+        }
+        // Byte by byte: a match may overlap what it is copying
+        const std::uint8_t* from = out.data() + at - offset;
+        for (std::size_t i = 0; i < length; ++i) {
+            out[at + i] = from[i];
+        }
+        at += length;
+    }
+    return true;
+}
+
+void pack_events(std::span<const std::uint8_t> nodes, std::vector<std::uint8_t>& out) {
+    const std::size_t count = nodes.size() / kNodeSize;
+    std::vector<std::uint8_t> shuffled(count * kNodeSize);
+    EventId previous_id = 0;
+    Timestamp previous_time = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        EventNode node;
+        std::memcpy(&node, nodes.data() + i * kNodeSize, kNodeSize);
+        const EventId id = node.id;
+        const Timestamp time = node.timestamp;
+        node.id = id - previous_id;
+        // Parents precede their children, so 0 is left for INVALID_EVENT
+        node.parent_id = node.parent_id != INVALID_EVENT ? id - node.parent_id : 0;
+        node.timestamp = zigzag(time - previous_time);
+        previous_id = id;
+        previous_time = time;
+
+        std::uint8_t bytes[kNodeSize];
+        std::memcpy(bytes, &node, kNodeSize);
+        for (std::size_t b = 0; b < kNodeSize; ++b) {
+            shuffled[b * count + i] = bytes[b];
+        }
+    }
+    pack_bytes(shuffled, out);
+}
+
+bool unpack_events(std::span<const std::uint8_t> packed, std::span<EventNode> out) {
+    const std::size_t count = out.size();
+    std::vector<std::uint8_t> shuffled(count * kNodeSize);
+    if (!unpack_bytes(packed, shuffled)) {
+        return false;
+    }
+    EventId previous_id = 0;
+    Timestamp previous_time = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::uint8_t bytes[kNodeSize];
+        for (std::size_t b = 0; b < kNodeSize; ++b) {
+            bytes[b] = shuffled[b * count + i];
+        }
+        EventNode node;
+        std::memcpy(&node, bytes, kNodeSize);
+        node.id += previous_id;
+        node.parent_id = node.parent_id != 0 ? node.id - node.parent_id : INVALID_EVENT;
+        node.timestamp = previous_time + unzigzag(node.timestamp);
+        previous_id = node.id;
+        previous_time = node.timestamp;
+        out[i] = node;
+    }
+    return true;
+}
+
+}  // namespace exeray::event
@@ -0,0 +1,351 @@
+/// @file log_merge.cpp
+/// @brief K-way timestamp merge of event logs (platform independent).
+
+#include "exeray/event/log_merge.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "exeray/event/event_log.hpp"
+#include "exeray/event/mapped_log.hpp"
+#include "exeray/event/payload_visit.hpp"
+#include "exeray/task_graph.hpp"
+#include "exeray/thread_pool.hpp"
+
+namespace exeray::event {
+
+namespace {
+
+using Logs = std::vector<std::unique_ptr<MappedEventLog>>;
+
+/// Low bits of a rank entry: the event's rank within its partition.
+constexpr int kRankBits = 40;
+constexpr std::uint64_t kRankMask = (std::uint64_t{1} << kRankBits) - 1;
+
+/// @brief A time range [from, to) of the merge; the last one includes to.
+struct Partition {
+    Timestamp from = 0;
+    Timestamp to = 0;
+    bool last = false;
+
+    [[nodiscard]] bool contains(Timestamp t) const noexcept {
+        return t >= from && (t < to || (last && t == to));
+    }
+    [[nodiscard]] bool overlaps(const MappedEventLog::Block& block) const noexcept {
+        return block.high >= from && (block.low < to || (last && block.low == to));
+    }
+};
+
+/// @brief One input's events of a partition, in log order.
+class Cursor {
+public:
+    Cursor(const MappedEventLog& log, const Partition& range) : log_(log), range_(range) {
+        for (const MappedEventLog::Block& block : log.event_blocks()) {
+            if (range.overlaps(block)) {
+                blocks_.push_back(&block);
+            }
+        }
+        settle();
+    }
+
+    [[nodiscard]] const EventNode* current() const noexcept {
+        return position_ < events_.size() ? &events_[position_] : nullptr;
+    }
+
+    void next() {
+        ++position_;
+        settle();
+    }
+
+private:
+    /// @brief Move to the next event in range, loading blocks as needed.
+    void settle() {
+        for (;;) {
+            while (position_ < events_.size() && !range_.contains(events_[position_].timestamp)) {
+                ++position_;
+            }
+            if (position_ < events_.size() || block_ == blocks_.size()) {
+                return;
+            }
+            events_ = log_.block_events(*blocks_[block_++]);
+            position_ = 0;
+        }
+    }
+
+    const MappedEventLog& log_;
+    Partition range_;
+    std::vector<const MappedEventLog::Block*> blocks_;
+    std::size_t block_ = 0;
+    std::span<const EventNode> events_;
+    std::size_t position_ = 0;
+};
+
+/**
+ * @brief Visit a partition's events in (timestamp, input) order.
+ * @param fn Called with (input, node).
+ */
+template <typename F>
+void merge_partition(const Logs& logs, const Partition& range, F&& fn) {
+    std::vector<Cursor> cursors;
+    cursors.reserve(logs.size());
+    for (const auto& log : logs) {
+        cursors.emplace_back(*log, range);
+    }
+
+    // Min-heap of inputs with events left, by their current event
+    std::vector<std::size_t> heap;
+    for (std::size_t i = 0; i < cursors.size(); ++i) {
+        if (cursors[i].current() != nullptr) {
+            heap.push_back(i);
+        }
+    }
+    const auto later = [&cursors](std::size_t a, std::size_t b) {
+        const Timestamp ta = cursors[a].current()->timestamp;
+        const Timestamp tb = cursors[b].current()->timestamp;
+        return ta != tb ? ta > tb : a > b;
+    };
+    std::make_heap(heap.begin(), heap.end(), later);
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        const std::size_t input = heap.back();
+        fn(input, *cursors[input].current());
+        cursors[input].next();
+        if (cursors[input].current() != nullptr) {
+            std::push_heap(heap.begin(), heap.end(), later);
+        } else {
+            heap.pop_back();
+        }
+    }
+}
+
+/// @brief Cut the inputs' time span into up to wanted ranges of about equal
+/// event counts, from their block directories.
+std::vector<Partition> plan_partitions(const Logs& logs, std::size_t wanted) {
+    std::vector<std::pair<Timestamp, std::uint32_t>> starts;  // (block low, count)
+    std::size_t total = 0;
+    Timestamp high = 0;
+    for (const auto& log : logs) {
+        for (const MappedEventLog::Block& block : log->event_blocks()) {
+            starts.emplace_back(block.low, block.count);
+            total += block.count;
+            high = (std::max)(high, block.high);
+        }
+    }
+    if (starts.empty()) {
+        return {};
+    }
+    std::sort(starts.begin(), starts.end());
+
+    std::vector<Timestamp> bounds{starts.front().first};
+    std::size_t seen = 0;
+    for (const auto& [low, count] : starts) {
+        // A block starting past the next quantile opens a partition
+        if (seen * wanted >= total * bounds.size() && low > bounds.back()) {
+            bounds.push_back(low);
+        }
+        seen += count;
+    }
+
+    std::vector<Partition> partitions;
+    for (std::size_t p = 0; p < bounds.size(); ++p) {
+        const bool last = p + 1 == bounds.size();
+        partitions.push_back({bounds[p], last ? high : bounds[p + 1], last});
+    }
+    return partitions;
+}
+
+/// @brief Append a file to a stream; false on a read or write error.
+bool append_file(const std::filesystem::path& path, std::ofstream& out) {
+    std::error_code error;
+    if (std::filesystem::file_size(path, error) == 0) {
+        return !error;  // Inserting an empty buffer would set failbit
+    }
+    std::ifstream in(path, std::ios::binary);
+    out << in.rdbuf();
+    return in && out;
+}
+
+}  // namespace
+
+std::optional<LogMergeStats> merge_event_logs(std::span<const std::filesystem::path> inputs,
+                                              const std::filesystem::path& output,
+                                              const LogMergeOptions& options) {
+    LogMergeStats stats;
+    stats.inputs = inputs.size();
+    Logs logs;
+    for (const std::filesystem::path& path : inputs) {
+        logs.push_back(std::make_unique<MappedEventLog>());
+        if (!logs.back()->open(path)) {
+            return std::nullopt;
+        }
+    }
+
+    // Shared string table: one entry per distinct text, keyed by the mapped
+    // bytes; per input, its StringIds to the shared ones
+    std::vector<LogString> strings;
+    std::unordered_map<std::string_view, StringId> by_text;
+    std::vector<std::unordered_map<StringId, StringId>> string_maps(logs.size());
+    for (std::size_t i = 0; i < logs.size(); ++i) {
+        std::vector<LogString> entries;
+        logs[i]->for_each_string([&entries](const LogString& entry) {
+            entries.push_back(entry);
+        });
+        // By ID, so the shared IDs do not depend on hash order
+        std::sort(entries.begin(), entries.end(),
+                  [](const LogString& a, const LogString& b) { return a.id < b.id; });
+        for (const LogString& entry : entries) {
+            const auto next = static_cast<StringId>(strings.size() + 1);
+            const auto [it, inserted] = by_text.try_emplace(entry.text, next);
+            if (inserted) {
+                strings.push_back({next, entry.text, entry.path});
+            } else {
+                strings[it->second - 1].path |= entry.path;
+                ++stats.duplicate_strings;
+            }
+            string_maps[i][entry.id] = it->second;
+        }
+    }
+    stats.strings = strings.size();
+
+    std::size_t wanted = options.partitions;
+    if (wanted == 0) {
+        wanted = options.pool != nullptr ? (std::max)(4 * options.pool->size(), std::size_t{1}) : 1;
+    }
+    const std::vector<Partition> partitions = plan_partitions(logs, wanted);
+    stats.partitions = partitions.size();
+
+    // Run fn(p) for every partition, on the pool if there is one
+    const auto for_each_partition = [&](const auto& fn) {
+        if (options.pool == nullptr || partitions.size() < 2) {
+            for (std::size_t p = 0; p < partitions.size(); ++p) {
+                fn(p);
+            }
+            return;
+        }
+        std::vector<TaskHandle<void>> tasks;
+        for (std::size_t p = 1; p < partitions.size(); ++p) {
+            tasks.push_back(spawn(*options.pool, [&fn, p] { fn(p); }));
+        }
+        fn(0);
+        when_all(tasks).wait();
+    };
+
+    // Pass 1: each event's partition and rank in it, per input by its ID
+    // offset ((partition + 1) << kRankBits | rank; 0 = not in the log)
+    std::vector<std::vector<std::uint64_t>> ranks(logs.size());
+    for (std::size_t i = 0; i < logs.size(); ++i) {
+        if (logs[i]->count() != 0) {
+            ranks[i].resize(logs[i]->newest_id() - logs[i]->oldest_id() + 1);
+        }
+    }
+    std::vector<std::uint64_t> counts(partitions.size());
+    for_each_partition([&](std::size_t p) {
+        const std::uint64_t tag = static_cast<std::uint64_t>(p + 1) << kRankBits;
+        std::uint64_t rank = 0;
+        merge_partition(logs, partitions[p], [&](std::size_t input, const EventNode& node) {
+            ranks[input][node.id - logs[input]->oldest_id()] = tag | rank++;
+        });
+        counts[p] = rank;
+    });
+
+    // Output IDs start at 1 and run on across partitions
+    std::vector<EventId> bases(partitions.size() + 1, 1);
+    for (std::size_t p = 0; p < partitions.size(); ++p) {
+        bases[p + 1] = bases[p] + counts[p];
+    }
+    stats.events = bases.back() - 1;
+    const auto new_id = [&](std::size_t input, EventId id) {
+        const MappedEventLog& log = *logs[input];
+        if (id == INVALID_EVENT || log.count() == 0 || id < log.oldest_id() ||
+            id > log.newest_id()) {
+            return INVALID_EVENT;
+        }
+        const std::uint64_t entry = ranks[input][id - log.oldest_id()];
+        return entry == 0 ? INVALID_EVENT : bases[(entry >> kRankBits) - 1] + (entry & kRankMask);
+    };
+
+    // Pass 2: merge again, rewriting each partition into its part file
+    const auto part_path = [&output](std::size_t p) {
+        std::filesystem::path path = output;
+        path += ".part" + std::to_string(p);
+        return path;
+    };
+    std::vector<std::size_t> orphans(partitions.size());
+    std::vector<char> written(partitions.size());
+    for_each_partition([&](std::size_t p) {
+        std::ofstream part(part_path(p), std::ios::binary | std::ios::trunc);
+        std::vector<EventNode> block;
+        block.reserve(EventGraph::kSegmentSize);
+        std::vector<std::uint8_t> bytes;
+        const auto flush = [&] {
+            bytes.clear();
+            encode_events_block(block, options.compress, bytes);
+            part.write(reinterpret_cast<const char*>(bytes.data()),
+                       static_cast<std::streamsize>(bytes.size()));
+            block.clear();
+        };
+        EventId id = bases[p];
+        merge_partition(logs, partitions[p], [&](std::size_t input, const EventNode& source) {
+            EventNode& node = block.emplace_back(source);
+            node.id = id++;
+            node.parent_id = new_id(input, source.parent_id);
+            if (source.parent_id != INVALID_EVENT && node.parent_id == INVALID_EVENT) {
+                ++orphans[p];
+            }
+            node._pad[0] = node._pad[1] = 0;
+            node.payload.extension = NO_EXTENSION;  // Records are not logged
+            const auto& map = string_maps[input];
+            for_each_string(node.payload, [&map](StringId& string) {
+                const auto it = map.find(string);
+                string = it != map.end() ? it->second : INVALID_STRING;
+            });
+            if (block.size() == EventGraph::kSegmentSize) {
+                flush();
+            }
+        });
+        if (!block.empty()) {
+            flush();
+        }
+        written[p] = part.good() ? 1 : 0;
+    });
+
+    // Header and string table, then the parts in time order
+    bool ok = std::all_of(written.begin(), written.end(), [](char w) { return w != 0; });
+    {
+        std::ofstream file(output, std::ios::binary | std::ios::trunc);
+        std::vector<std::uint8_t> bytes;
+        encode_log_header(bytes);
+        const std::span<const LogString> table(strings);
+        for (std::size_t first = 0; first < table.size(); first += EventGraph::kSegmentSize) {
+            const std::size_t length = (std::min)(table.size() - first, EventGraph::kSegmentSize);
+            encode_strings_block(table.subspan(first, length), options.compress, bytes);
+        }
+        file.write(reinterpret_cast<const char*>(bytes.data()),
+                   static_cast<std::streamsize>(bytes.size()));
+        for (std::size_t p = 0; ok && p < partitions.size(); ++p) {
+            ok = append_file(part_path(p), file);
+        }
+        ok = ok && file.good();
+    }
+    std::error_code error;
+    for (std::size_t p = 0; p < partitions.size(); ++p) {
+        std::filesystem::remove(part_path(p), error);
+    }
+    if (!ok) {
+        std::filesystem::remove(output, error);
+        return std::nullopt;
+    }
+
+    for (const std::size_t n : orphans) {
+        stats.orphans += n;
+    }
+    stats.bytes = std::filesystem::file_size(output, error);
+    return stats;
+}
+
+}  // namespace exeray::event
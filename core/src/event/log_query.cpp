@@ -0,0 +1,246 @@
+/// @file log_query.cpp
+/// @brief Parallel queries over many saved event logs (platform independent).
+
+#include "exeray/event/log_query.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <tuple>
+#include <unordered_map>
+
+#include "exeray/task_graph.hpp"
+#include "exeray/thread_pool.hpp"
+
+namespace exeray::event {
+
+namespace {
+
+/// @brief Run fn(i) for i in [0, n), on the pool if there is one.
+template <typename F>
+void parallel_for(ThreadPool* pool, std::size_t n, const F& fn) {
+    if (pool == nullptr || n < 2) {
+        for (std::size_t i = 0; i < n; ++i) {
+            fn(i);
+        }
+        return;
+    }
+    std::vector<TaskHandle<void>> tasks;
+    tasks.reserve(n - 1);
+    for (std::size_t i = 1; i < n; ++i) {
+        tasks.push_back(spawn(*pool, [&fn, i] { fn(i); }));
+    }
+    fn(0);
+    when_all(tasks).wait();
+}
+
+/// @brief Whether row a comes before row b in the query's order.
+bool precedes(const LogRow& a, const LogRow& b, QueryOrder order) noexcept {
+    const auto key = [](const LogRow& r) {
+        return std::tuple{r.row.timestamp, r.log, r.row.id};
+    };
+    return order == QueryOrder::OldestFirst ? key(a) < key(b) : key(b) < key(a);
+}
+
+/// @brief Keep the first limit rows in order (the rest in no order are dropped).
+void keep_first(std::vector<LogRow>& rows, std::size_t limit, QueryOrder order) {
+    if (rows.size() > limit) {
+        const auto nth = rows.begin() + static_cast<std::ptrdiff_t>(limit);
+        std::nth_element(rows.begin(), nth, rows.end(),
+                         [order](const LogRow& a, const LogRow& b) {
+                             return precedes(a, b, order);
+                         });
+        rows.erase(nth, rows.end());
+    }
+}
+
+}  // namespace
+
+bool LogQueryExecutor::add(const std::filesystem::path& path) {
+    auto log = std::make_unique<MappedEventLog>();
+    if (!log->open(path)) {
+        return false;
+    }
+    logs_.push_back(std::move(log));
+    return true;
+}
+
+std::vector<LogQueryExecutor::Task> LogQueryExecutor::plan(const LogQuery& query,
+                                                           LogQueryStats& stats) const {
+    if (query.query.limit == 0 || query.query.filter.from > query.query.filter.to) {
+        return {};
+    }
+
+    // Per log, in parallel: its first use builds the block directory and,
+    // for a carried text, the string table
+    struct Plan {
+        std::vector<Task> tasks;
+        std::size_t blocks = 0;
+        std::size_t skipped = 0;
+        bool lacks_text = false;
+    };
+    std::vector<Plan> plans(logs_.size());
+    parallel_for(pool_, logs_.size(), [&](std::size_t i) {
+        const MappedEventLog& log = *logs_[i];
+        FilterSpec spec = query.query.filter;
+        spec.string_id = INVALID_STRING;
+        if (!query.carries.empty()) {
+            log.for_each_string([&](const LogString& entry) {
+                if (entry.text == query.carries) {
+                    spec.string_id = entry.id;
+                }
+                return spec.string_id == INVALID_STRING;
+            });
+            if (spec.string_id == INVALID_STRING) {
+                plans[i].lacks_text = true;
+                return;
+            }
+        }
+        Plan& plan = plans[i];
+        for (const MappedEventLog::Block& block : log.event_blocks()) {
+            if (!block.may_match(spec)) {
+                ++plan.skipped;
+                continue;
+            }
+            if (plan.tasks.empty() || plan.tasks.back().blocks.size() == kBlocksPerTask) {
+                plan.tasks.push_back({static_cast<std::uint32_t>(i), spec, {}});
+            }
+            plan.tasks.back().blocks.push_back(&block);
+            ++plan.blocks;
+        }
+    });
+
+    std::vector<Task> tasks;
+    for (Plan& plan : plans) {
+        stats.logs_skipped += plan.lacks_text ? 1 : 0;
+        stats.blocks += plan.blocks;
+        stats.blocks_skipped += plan.skipped;
+        std::move(plan.tasks.begin(), plan.tasks.end(), std::back_inserter(tasks));
+    }
+    stats.tasks = tasks.size();
+    return tasks;
+}
+
+std::uint64_t LogQueryExecutor::count(const LogQuery& query, LogQueryStats* stats) const {
+    LogQuery all = query;
+    all.query.limit = std::numeric_limits<std::size_t>::max();
+    LogQueryStats local;
+    const std::vector<Task> tasks = plan(all, local);
+    std::vector<std::uint64_t> counts(tasks.size());
+    std::vector<std::uint64_t> scanned(tasks.size());
+    parallel_for(pool_, tasks.size(), [&](std::size_t t) {
+        const Task& task = tasks[t];
+        for (const MappedEventLog::Block* block : task.blocks) {
+            const std::span<const EventNode> events = logs_[task.log]->block_events(*block);
+            for (const EventNode& node : events) {
+                counts[t] += task.spec.matches(node) ? 1 : 0;
+            }
+            scanned[t] += events.size();
+        }
+    });
+    std::uint64_t total = 0;
+    for (std::size_t t = 0; t < tasks.size(); ++t) {
+        total += counts[t];
+        local.events += scanned[t];
+    }
+    if (stats != nullptr) {
+        *stats = local;
+    }
+    return total;
+}
+
+std::vector<LogRow> LogQueryExecutor::rows(const LogQuery& query, LogQueryStats* stats) const {
+    LogQueryStats local;
+    const std::vector<Task> tasks = plan(query, local);
+    const QueryOrder order = query.query.order;
+    const std::size_t limit = query.query.limit;
+
+    // Each task keeps its best limit rows, trimmed whenever it holds twice that
+    std::vector<std::vector<LogRow>> partial(tasks.size());
+    std::vector<std::uint64_t> scanned(tasks.size());
+    parallel_for(pool_, tasks.size(), [&](std::size_t t) {
+        const Task& task = tasks[t];
+        std::vector<LogRow>& out = partial[t];
+        for (const MappedEventLog::Block* block : task.blocks) {
+            const std::span<const EventNode> events = logs_[task.log]->block_events(*block);
+            for (const EventNode& node : events) {
+                if (!task.spec.matches(node)) {
+                    continue;
+                }
+                out.push_back({task.log, project(EventView(node))});
+                if (limit <= out.size() / 2) {
+                    keep_first(out, limit, order);
+                }
+            }
+            scanned[t] += events.size();
+        }
+        keep_first(out, limit, order);
+    });
+
+    std::vector<LogRow> merged;
+    for (std::size_t t = 0; t < tasks.size(); ++t) {
+        merged.insert(merged.end(), partial[t].begin(), partial[t].end());
+        local.events += scanned[t];
+    }
+    keep_first(merged, limit, order);
+    std::sort(merged.begin(), merged.end(),
+              [order](const LogRow& a, const LogRow& b) { return precedes(a, b, order); });
+    if (stats != nullptr) {
+        *stats = local;
+    }
+    return merged;
+}
+
+std::size_t LogQueryExecutor::top_counts(const LogQuery& query, GroupKey key,
+                                         std::span<GroupCount> out,
+                                         LogQueryStats* stats) const {
+    LogQuery all = query;
+    all.query.limit = std::numeric_limits<std::size_t>::max();
+    LogQueryStats local;
+    const std::vector<Task> tasks = out.empty() ? std::vector<Task>{} : plan(all, local);
+
+    const bool keep_zero = group_counts_zero(key);
+    std::vector<std::unordered_map<uint32_t, std::size_t>> partial(tasks.size());
+    std::vector<std::uint64_t> scanned(tasks.size());
+    parallel_for(pool_, tasks.size(), [&](std::size_t t) {
+        const Task& task = tasks[t];
+        for (const MappedEventLog::Block* block : task.blocks) {
+            const std::span<const EventNode> events = logs_[task.log]->block_events(*block);
+            for (const EventNode& node : events) {
+                if (!task.spec.matches(node)) {
+                    continue;
+                }
+                const uint32_t value = group_value(EventView(node), key);
+                if (value != 0 || keep_zero) {
+                    ++partial[t][value];
+                }
+            }
+            scanned[t] += events.size();
+        }
+    });
+
+    std::unordered_map<uint32_t, std::size_t> counts;
+    for (std::size_t t = 0; t < tasks.size(); ++t) {
+        for (const auto& [value, count] : partial[t]) {
+            counts[value] += count;
+        }
+        local.events += scanned[t];
+    }
+    std::vector<GroupCount> groups;
+    groups.reserve(counts.size());
+    for (const auto& [value, count] : counts) {
+        groups.push_back(GroupCount{value, count});
+    }
+    const std::size_t n = (std::min)(out.size(), groups.size());
+    std::partial_sort(groups.begin(), groups.begin() + static_cast<std::ptrdiff_t>(n),
+                      groups.end(), [](const GroupCount& a, const GroupCount& b) {
+                          return a.count != b.count ? a.count > b.count : a.key < b.key;
+                      });
+    std::copy_n(groups.begin(), n, out.begin());
+    if (stats != nullptr) {
+        *stats = local;
+    }
+    return n;
+}
+
+}  // namespace exeray::event
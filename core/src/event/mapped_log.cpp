@@ -0,0 +1,399 @@
+/// @file mapped_log.cpp
+/// @brief In-place reader of saved event logs and its persisted index.
+
+#include "exeray/event/mapped_log.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+#include "exeray/event/log_codec.hpp"
+
+namespace exeray::event {
+
+namespace {
+
+constexpr std::size_t kIndexHeaderSize = 40;
+constexpr std::size_t kStringHeaderSize = 8;
+
+template <typename T>
+void store(std::vector<std::uint8_t>& out, std::size_t offset, const T& value) {
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+T load(std::span<const std::uint8_t> bytes, std::size_t offset) {
+    T value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    return value;
+}
+
+/// @brief Payload of a block, as its header sizes it (empty if past the end).
+std::span<const std::uint8_t> block_payload(std::span<const std::uint8_t> bytes,
+                                            const MappedEventLog::Block& block) {
+    const auto at = static_cast<std::size_t>(block.offset);
+    const auto size = load<std::uint64_t>(bytes, at - kLogHeaderSize + 8);
+    if (size > bytes.size() - at) {
+        return {};
+    }
+    return bytes.subspan(at, static_cast<std::size_t>(size));
+}
+
+static_assert(std::is_trivially_copyable_v<MappedEventLog::Block>,
+              "Blocks are saved to the index file byte for byte");
+
+}  // namespace
+
+bool MappedEventLog::Block::may_match(const FilterSpec& spec) const noexcept {
+    if (high < spec.from || low > spec.to ||
+        (spec.statuses != 0 && (spec.statuses & statuses) == 0) ||
+        (spec.pid != 0 && !zone_may_hold_pid(pids, spec.pid))) {
+        return false;
+    }
+    if (spec.categories == 0) {
+        return true;
+    }
+    for (std::size_t c = 0; c < kCategoryCount; ++c) {
+        if (categories[c] != 0 && (spec.categories & (1u << c)) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MappedEventLog::open(const std::filesystem::path& path) {
+    if (file_.is_open() || !file_.open(path)) {
+        return false;
+    }
+    const auto bytes = file_.bytes();
+    if (bytes.size() < kLogHeaderSize ||
+        load<std::uint32_t>(bytes, 0) != kEventLogMagic ||
+        load<std::uint32_t>(bytes, 4) != kEventLogFormat ||
+        load<std::uint32_t>(bytes, 8) != sizeof(EventNode)) {
+        file_.close();
+        return false;
+    }
+    index_path_ = path;
+    index_path_ += ".exri";
+    return true;
+}
+
+std::size_t MappedEventLog::count() const {
+    return directory().count;
+}
+
+EventId MappedEventLog::oldest_id() const {
+    const auto& events = directory().events;
+    return events.empty() ? INVALID_EVENT : events.front().first_id;
+}
+
+EventId MappedEventLog::newest_id() const {
+    const auto& events = directory().events;
+    return events.empty() ? INVALID_EVENT : events.back().first_id + events.back().count - 1;
+}
+
+const EventNode* MappedEventLog::find(EventId id) const {
+    const auto& events = directory().events;
+    auto it = std::upper_bound(events.begin(), events.end(), id,
+                               [](EventId value, const Block& block) {
+                                   return value < block.first_id;
+                               });
+    if (it == events.begin()) {
+        return nullptr;
+    }
+    --it;
+    const EventId index = id - it->first_id;
+    if (index >= it->count) {
+        return nullptr;
+    }
+    const EventNode* first = nodes(*it);
+    return first != nullptr ? first + index : nullptr;
+}
+
+const EventNode* MappedEventLog::nodes(const Block& block) const {
+    if (block.kind == LogBlock::Events) {
+        return reinterpret_cast<const EventNode*>(file_.bytes().data() + block.offset);
+    }
+    {
+        std::lock_guard lock(unpacked_mutex_);
+        const auto it = unpacked_.find(block.offset);
+        if (it != unpacked_.end()) {
+            return it->second.get();
+        }
+    }
+    // Unpacked unlocked; a thread that raced us keeps its copy
+    auto unpacked = std::make_unique<EventNode[]>(block.count);
+    if (!unpack_events(block_payload(file_.bytes(), block), {unpacked.get(), block.count})) {
+        return nullptr;
+    }
+    std::lock_guard lock(unpacked_mutex_);
+    return unpacked_.try_emplace(block.offset, std::move(unpacked)).first->second.get();
+}
+
+bool MappedEventLog::exists(EventId id) const {
+    return id != INVALID_EVENT && find(id) != nullptr;
+}
+
+EventView MappedEventLog::get(EventId id) const {
+    return EventView(id != INVALID_EVENT ? find(id) : nullptr);
+}
+
+std::string_view MappedEventLog::resolve_string(StringId id) const {
+    const auto& entries = strings();
+    const auto it = entries.find(id);
+    return it != entries.end() ? it->second.text : std::string_view{};
+}
+
+std::span<const MappedEventLog::Block> MappedEventLog::event_blocks() const {
+    return directory().events;
+}
+
+std::span<const EventNode> MappedEventLog::block_events(const Block& block) const {
+    const EventNode* first = nodes(block);
+    return first != nullptr ? std::span<const EventNode>(first, block.count)
+                            : std::span<const EventNode>{};
+}
+
+const std::unordered_map<StringId, LogString>& MappedEventLog::strings() const {
+    std::call_once(strings_once_, [this] {
+        const auto bytes = file_.bytes();
+        for (const Block& block : directory().strings) {
+            auto payload = block_payload(bytes, block);
+            if (block.kind == LogBlock::PackedStrings) {
+                const auto size = load<std::uint64_t>(bytes, block.offset - kLogHeaderSize + 24);
+                auto& unpacked = unpacked_strings_.emplace_back();
+                if (size > max_unpacked_size(payload.size())) {
+                    continue;
+                }
+                unpacked.resize(static_cast<std::size_t>(size));
+                if (!unpack_bytes(payload, unpacked)) {
+                    continue;
+                }
+                payload = unpacked;
+            }
+            std::size_t at = 0;
+            for (std::uint32_t i = 0; i < block.count && payload.size() - at >= kStringHeaderSize;
+                 ++i) {
+                const auto entry = load<StringId>(payload, at);
+                const auto word = load<std::uint32_t>(payload, at + 4);
+                const std::uint32_t length = word & ~kLogPathString;
+                const std::size_t padded = (std::size_t{length} + 7) & ~std::size_t{7};
+                at += kStringHeaderSize;
+                if (length > kMaxLogString || payload.size() - at < padded) {
+                    break;
+                }
+                strings_.emplace(
+                    entry, LogString{entry,
+                                     std::string_view(
+                                         reinterpret_cast<const char*>(payload.data() + at),
+                                         length),
+                                     (word & kLogPathString) != 0});
+                at += padded;
+            }
+        }
+    });
+    return strings_;
+}
+
+bool MappedEventLog::complete() const {
+    return directory().complete;
+}
+
+bool MappedEventLog::index_loaded() const {
+    return directory().loaded;
+}
+
+bool MappedEventLog::verify() const {
+    const auto bytes = file_.bytes();
+    auto intact = [&bytes](const Block& block) {
+        const auto at = static_cast<std::size_t>(block.offset) - kLogHeaderSize;
+        return log_checksum(block_payload(bytes, block)) == load<std::uint64_t>(bytes, at + 16);
+    };
+    const Directory& dir = directory();
+    return std::all_of(dir.strings.begin(), dir.strings.end(), intact) &&
+           std::all_of(dir.events.begin(), dir.events.end(), intact);
+}
+
+const MappedEventLog::Directory& MappedEventLog::directory() const {
+    std::call_once(directory_once_, [this] {
+        if (!load_index(directory_)) {
+            directory_ = Directory{};
+            scan(directory_);
+            save_index(directory_);
+        }
+    });
+    return directory_;
+}
+
+void MappedEventLog::scan(Directory& dir) const {
+    const auto bytes = file_.bytes();
+    file_.advise_sequential();
+    std::size_t offset = kLogHeaderSize;
+    while (offset < bytes.size()) {
+        if (bytes.size() - offset < kLogHeaderSize) {
+            dir.complete = false;
+            break;
+        }
+        Block block;
+        block.kind = static_cast<LogBlock>(load<std::uint32_t>(bytes, offset));
+        block.count = load<std::uint32_t>(bytes, offset + 4);
+        const auto size = load<std::uint64_t>(bytes, offset + 8);
+        offset += kLogHeaderSize;
+        if (bytes.size() - offset < size) {
+            dir.complete = false;  // Cut short, e.g. by a crash mid-write
+            break;
+        }
+        block.offset = offset;
+        offset += static_cast<std::size_t>(size);
+
+        if (block.kind == LogBlock::Strings || block.kind == LogBlock::PackedStrings) {
+            dir.strings.push_back(block);
+        } else if (block.kind == LogBlock::Events || block.kind == LogBlock::PackedEvents) {
+            const bool packed = block.kind == LogBlock::PackedEvents;
+            const auto unpacked_size =
+                packed ? load<std::uint64_t>(bytes, block.offset - kLogHeaderSize + 24) : size;
+            if (unpacked_size != std::uint64_t{block.count} * sizeof(EventNode) ||
+                block.count == 0 || (packed && unpacked_size > max_unpacked_size(size))) {
+                dir.complete = false;
+                break;
+            }
+            // Packed nodes are unpacked for the summary only, not cached
+            std::unique_ptr<EventNode[]> unpacked;
+            const EventNode* first = nullptr;
+            if (packed) {
+                unpacked = std::make_unique<EventNode[]>(block.count);
+                if (!unpack_events(block_payload(bytes, block), {unpacked.get(), block.count})) {
+                    dir.complete = false;
+                    break;
+                }
+                first = unpacked.get();
+            } else {
+                first = nodes(block);
+            }
+            block.first_id = first->id;
+            block.low = first->timestamp;
+            block.high = first->timestamp;
+            for (std::uint32_t i = 0; i < block.count; ++i) {
+                block.low = (std::min)(block.low, first[i].timestamp);
+                block.high = (std::max)(block.high, first[i].timestamp);
+                const auto c = static_cast<std::size_t>(first[i].payload.category);
+                if (c < kCategoryCount) {
+                    ++block.categories[c];
+                }
+                block.statuses |= 1u << static_cast<std::uint32_t>(first[i].status);
+                if (const std::uint32_t pid = event_pid(first[i].payload); pid != 0) {
+                    zone_add_pid(block.pids, pid);
+                }
+            }
+            dir.count += block.count;
+            dir.events.push_back(block);
+        }
+        // Blocks of an unknown kind are skipped
+    }
+}
+
+bool MappedEventLog::load_index(Directory& dir) const {
+    std::ifstream file(index_path_, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    const std::vector<std::uint8_t> bytes{std::istreambuf_iterator<char>(file),
+                                          std::istreambuf_iterator<char>()};
+    if (bytes.size() < kIndexHeaderSize ||
+        load<std::uint32_t>(bytes, 0) != kLogIndexMagic ||
+        load<std::uint32_t>(bytes, 4) != kLogIndexFormat ||
+        load<std::uint64_t>(bytes, 8) != file_.bytes().size()) {
+        return false;  // Another log, or this one grew since
+    }
+    const auto events = load<std::uint32_t>(bytes, 24);
+    const auto strings = load<std::uint32_t>(bytes, 28);
+    if (bytes.size() != kIndexHeaderSize + (std::size_t{events} + strings) * sizeof(Block)) {
+        return false;
+    }
+    dir.count = static_cast<std::size_t>(load<std::uint64_t>(bytes, 16));
+    dir.complete = load<std::uint32_t>(bytes, 32) != 0;
+    dir.events.resize(events);
+    dir.strings.resize(strings);
+    std::memcpy(dir.events.data(), bytes.data() + kIndexHeaderSize, events * sizeof(Block));
+    std::memcpy(dir.strings.data(), bytes.data() + kIndexHeaderSize + events * sizeof(Block),
+                strings * sizeof(Block));
+
+    // Never trust an offset that would read past the mapping
+    const std::size_t size = file_.bytes().size();
+    auto inside = [size](const Block& block) {
+        return block.offset >= kLogHeaderSize && block.offset % alignof(EventNode) == 0 &&
+               block.offset <= size &&
+               (block.kind != LogBlock::Events ||
+                std::uint64_t{block.count} * sizeof(EventNode) <= size - block.offset);
+    };
+    if (!std::all_of(dir.events.begin(), dir.events.end(), inside) ||
+        !std::all_of(dir.strings.begin(), dir.strings.end(), inside)) {
+        return false;
+    }
+    dir.loaded = true;
+    return true;
+}
+
+void MappedEventLog::save_index(const Directory& dir) const {
+    std::vector<std::uint8_t> bytes(kIndexHeaderSize, 0);
+    store(bytes, 0, kLogIndexMagic);
+    store(bytes, 4, kLogIndexFormat);
+    store(bytes, 8, static_cast<std::uint64_t>(file_.bytes().size()));
+    store(bytes, 16, static_cast<std::uint64_t>(dir.count));
+    store(bytes, 24, static_cast<std::uint32_t>(dir.events.size()));
+    store(bytes, 28, static_cast<std::uint32_t>(dir.strings.size()));
+    store(bytes, 32, static_cast<std::uint32_t>(dir.complete ? 1 : 0));
+    for (const auto* blocks : {&dir.events, &dir.strings}) {
+        const auto* data = reinterpret_cast<const std::uint8_t*>(blocks->data());
+        bytes.insert(bytes.end(), data, data + blocks->size() * sizeof(Block));
+    }
+
+    // Written beside and renamed, so a reader never sees half an index
+    std::filesystem::path temp = index_path_;
+    temp += ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()),
+                   static_cast<std::streamsize>(bytes.size()));
+        if (!file) {
+            file.close();
+            std::error_code error;
+            std::filesystem::remove(temp, error);
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temp, index_path_, error);
+    if (error) {
+        std::filesystem::remove(temp, error);
+    }
+}
+
+const MappedEventLog::Links& MappedEventLog::children() const {
+    std::call_once(links_once_, [this] { build_links(); });
+    return children_;
+}
+
+const MappedEventLog::Links& MappedEventLog::correlations() const {
+    std::call_once(links_once_, [this] { build_links(); });
+    return correlations_;
+}
+
+void MappedEventLog::build_links() const {
+    for (const Block& block : directory().events) {
+        const EventNode* first = nodes(block);
+        for (std::uint32_t i = 0; first != nullptr && i < block.count; ++i) {
+            if (first[i].parent_id != INVALID_EVENT) {
+                children_.emplace_back(first[i].parent_id, first[i].id);
+            }
+            if (first[i].correlation_id != 0) {
+                correlations_.emplace_back(first[i].correlation_id, first[i].id);
+            }
+        }
+    }
+    std::sort(children_.begin(), children_.end());
+    std::sort(correlations_.begin(), correlations_.end());
+}
+
+}  // namespace exeray::event
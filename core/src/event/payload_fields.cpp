@@ -0,0 +1,153 @@
+/// @file payload_fields.cpp
+/// @brief Payload member table (platform independent).
+
+#include "exeray/event/payload_fields.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+#include "exeray/event/payload_visit.hpp"
+
+namespace exeray::event {
+
+namespace {
+
+#define EXERAY_PAYLOAD_FIELD(category, member, type, field, is_string)              \
+    PayloadField{Category::category, #field,                                        \
+                 static_cast<std::uint16_t>(offsetof(EventPayload, member) +        \
+                                            offsetof(type, field)),                 \
+                 static_cast<std::uint8_t>(sizeof(type::field)), is_string}
+
+constexpr PayloadField kFields[] = {
+    EXERAY_PAYLOAD_FIELD(FileSystem, file, FilePayload, path, true),
+    EXERAY_PAYLOAD_FIELD(FileSystem, file, FilePayload, size, false),
+    EXERAY_PAYLOAD_FIELD(FileSystem, file, FilePayload, attributes, false),
+    EXERAY_PAYLOAD_FIELD(FileSystem, file, FilePayload, ops, false),
+    EXERAY_PAYLOAD_FIELD(Registry, registry, RegistryPayload, key_path, true),
+    EXERAY_PAYLOAD_FIELD(Registry, registry, RegistryPayload, value_name, true),
+    EXERAY_PAYLOAD_FIELD(Registry, registry, RegistryPayload, value_type, false),
+    EXERAY_PAYLOAD_FIELD(Registry, registry, RegistryPayload, data_size, false),
+    EXERAY_PAYLOAD_FIELD(Network, network, NetworkPayload, local_addr, false),
+    EXERAY_PAYLOAD_FIELD(Network, network, NetworkPayload, remote_addr, false),
+    EXERAY_PAYLOAD_FIELD(Network, network, NetworkPayload, local_port, false),
+    EXERAY_PAYLOAD_FIELD(Network, network, NetworkPayload, remote_port, false),
+    EXERAY_PAYLOAD_FIELD(Network, network, NetworkPayload, bytes, false),
+    EXERAY_PAYLOAD_FIELD(Network, network, NetworkPayload, protocol, false),
+    EXERAY_PAYLOAD_FIELD(Network, network, NetworkPayload, family, false),
+    EXERAY_PAYLOAD_FIELD(Network, network, NetworkPayload, remote_domain, true),
+    EXERAY_PAYLOAD_FIELD(Process, process, ProcessPayload, pid, false),
+    EXERAY_PAYLOAD_FIELD(Process, process, ProcessPayload, parent_pid, false),
+    EXERAY_PAYLOAD_FIELD(Process, process, ProcessPayload, image_path, true),
+    EXERAY_PAYLOAD_FIELD(Process, process, ProcessPayload, command_line, true),
+    EXERAY_PAYLOAD_FIELD(Scheduler, scheduler, SchedulerPayload, task_name, true),
+    EXERAY_PAYLOAD_FIELD(Scheduler, scheduler, SchedulerPayload, action, true),
+    EXERAY_PAYLOAD_FIELD(Scheduler, scheduler, SchedulerPayload, trigger_type, false),
+    EXERAY_PAYLOAD_FIELD(Input, input, InputPayload, hook_type, false),
+    EXERAY_PAYLOAD_FIELD(Input, input, InputPayload, target_tid, false),
+    EXERAY_PAYLOAD_FIELD(Image, image, ImagePayload, image_path, true),
+    EXERAY_PAYLOAD_FIELD(Image, image, ImagePayload, process_id, false),
+    EXERAY_PAYLOAD_FIELD(Image, image, ImagePayload, base_address, false),
+    EXERAY_PAYLOAD_FIELD(Image, image, ImagePayload, size, false),
+    EXERAY_PAYLOAD_FIELD(Image, image, ImagePayload, is_suspicious, false),
+    EXERAY_PAYLOAD_FIELD(Thread, thread, ThreadPayload, thread_id, false),
+    EXERAY_PAYLOAD_FIELD(Thread, thread, ThreadPayload, process_id, false),
+    EXERAY_PAYLOAD_FIELD(Thread, thread, ThreadPayload, start_address, false),
+    EXERAY_PAYLOAD_FIELD(Thread, thread, ThreadPayload, creator_pid, false),
+    EXERAY_PAYLOAD_FIELD(Thread, thread, ThreadPayload, is_remote, false),
+    EXERAY_PAYLOAD_FIELD(Thread, thread, ThreadPayload, start_region, false),
+    EXERAY_PAYLOAD_FIELD(Thread, thread, ThreadPayload, start_unbacked, false),
+    EXERAY_PAYLOAD_FIELD(Memory, memory, MemoryPayload, base_address, false),
+    EXERAY_PAYLOAD_FIELD(Memory, memory, MemoryPayload, region_size, false),
+    EXERAY_PAYLOAD_FIELD(Memory, memory, MemoryPayload, process_id, false),
+    EXERAY_PAYLOAD_FIELD(Memory, memory, MemoryPayload, protection, false),
+    EXERAY_PAYLOAD_FIELD(Memory, memory, MemoryPayload, is_suspicious, false),
+    EXERAY_PAYLOAD_FIELD(Script, script, ScriptPayload, script_block, true),
+    EXERAY_PAYLOAD_FIELD(Script, script, ScriptPayload, context, true),
+    EXERAY_PAYLOAD_FIELD(Script, script, ScriptPayload, sequence, false),
+    EXERAY_PAYLOAD_FIELD(Script, script, ScriptPayload, is_suspicious, false),
+    EXERAY_PAYLOAD_FIELD(Script, script, ScriptPayload, is_repeat, false),
+    EXERAY_PAYLOAD_FIELD(Amsi, amsi, AmsiPayload, content, true),
+    EXERAY_PAYLOAD_FIELD(Amsi, amsi, AmsiPayload, app_name, true),
+    EXERAY_PAYLOAD_FIELD(Amsi, amsi, AmsiPayload, scan_result, false),
+    EXERAY_PAYLOAD_FIELD(Amsi, amsi, AmsiPayload, content_size, false),
+    EXERAY_PAYLOAD_FIELD(Dns, dns, DnsPayload, domain, true),
+    EXERAY_PAYLOAD_FIELD(Dns, dns, DnsPayload, query_type, false),
+    EXERAY_PAYLOAD_FIELD(Dns, dns, DnsPayload, result_code, false),
+    EXERAY_PAYLOAD_FIELD(Dns, dns, DnsPayload, resolved_ip, false),
+    EXERAY_PAYLOAD_FIELD(Dns, dns, DnsPayload, is_suspicious, false),
+    EXERAY_PAYLOAD_FIELD(Security, security, SecurityPayload, subject_user, true),
+    EXERAY_PAYLOAD_FIELD(Security, security, SecurityPayload, target_user, true),
+    EXERAY_PAYLOAD_FIELD(Security, security, SecurityPayload, command_line, true),
+    EXERAY_PAYLOAD_FIELD(Security, security, SecurityPayload, logon_type, false),
+    EXERAY_PAYLOAD_FIELD(Security, security, SecurityPayload, process_id, false),
+    EXERAY_PAYLOAD_FIELD(Security, security, SecurityPayload, is_suspicious, false),
+    EXERAY_PAYLOAD_FIELD(Service, service, ServicePayload, service_name, true),
+    EXERAY_PAYLOAD_FIELD(Service, service, ServicePayload, service_path, true),
+    EXERAY_PAYLOAD_FIELD(Service, service, ServicePayload, service_type, false),
+    EXERAY_PAYLOAD_FIELD(Service, service, ServicePayload, start_type, false),
+    EXERAY_PAYLOAD_FIELD(Service, service, ServicePayload, is_suspicious, false),
+    EXERAY_PAYLOAD_FIELD(Wmi, wmi, WmiPayload, wmi_namespace, true),
+    EXERAY_PAYLOAD_FIELD(Wmi, wmi, WmiPayload, query, true),
+    EXERAY_PAYLOAD_FIELD(Wmi, wmi, WmiPayload, target_host, true),
+    EXERAY_PAYLOAD_FIELD(Wmi, wmi, WmiPayload, is_remote, false),
+    EXERAY_PAYLOAD_FIELD(Wmi, wmi, WmiPayload, is_suspicious, false),
+    EXERAY_PAYLOAD_FIELD(Wmi, wmi, WmiPayload, count, false),
+    EXERAY_PAYLOAD_FIELD(Clr, clr, ClrPayload, assembly_name, true),
+    EXERAY_PAYLOAD_FIELD(Clr, clr, ClrPayload, method_name, true),
+    EXERAY_PAYLOAD_FIELD(Clr, clr, ClrPayload, load_address, false),
+    EXERAY_PAYLOAD_FIELD(Clr, clr, ClrPayload, is_dynamic, false),
+    EXERAY_PAYLOAD_FIELD(Clr, clr, ClrPayload, is_suspicious, false),
+    EXERAY_PAYLOAD_FIELD(Clr, clr, ClrPayload, methods, false),
+    EXERAY_PAYLOAD_FIELD(Manifest, manifest, ManifestPayload, text, true),
+    EXERAY_PAYLOAD_FIELD(Manifest, manifest, ManifestPayload, detail, true),
+    EXERAY_PAYLOAD_FIELD(Manifest, manifest, ManifestPayload, process_id, false),
+    EXERAY_PAYLOAD_FIELD(Manifest, manifest, ManifestPayload, value, false),
+    EXERAY_PAYLOAD_FIELD(Manifest, manifest, ManifestPayload, provider, false),
+    EXERAY_PAYLOAD_FIELD(Manifest, manifest, ManifestPayload, event_id, false),
+    EXERAY_PAYLOAD_FIELD(Manifest, manifest, ManifestPayload, version, false),
+};
+
+#undef EXERAY_PAYLOAD_FIELD
+
+constexpr std::size_t string_fields(Category category) {
+    std::size_t count = 0;
+    for (const PayloadField& field : kFields) {
+        count += field.category == category && field.is_string;
+    }
+    return count;
+}
+
+template <std::size_t... I>
+constexpr bool strings_match_traits(std::index_sequence<I...>) {
+    return ((static_cast<Category>(I) == Category::Network ||
+             string_fields(static_cast<Category>(I)) ==
+                 payload_string_count<std::tuple_element_t<I, PayloadTypes>>) &&
+            ...);
+}
+
+// The table and PayloadTraits::strings describe the same members. Network
+// addresses are StringIds for IPv6 only, so the table lists them as numbers
+// and only remote_domain as a string
+static_assert(strings_match_traits(std::make_index_sequence<std::tuple_size_v<PayloadTypes>>{}),
+              "kFields and PayloadTraits disagree on a payload's string members");
+
+constexpr std::string_view kCategoryNames[] = {
+    "FileSystem", "Registry", "Network", "Process", "Scheduler", "Input",
+    "Image", "Thread", "Memory", "Script", "Amsi", "Dns",
+    "Security", "Service", "Wmi", "Clr", "Manifest",
+};
+static_assert(std::size(kCategoryNames) == static_cast<std::size_t>(Category::Count));
+
+}  // namespace
+
+std::span<const PayloadField> payload_fields() noexcept {
+    return kFields;
+}
+
+std::string_view category_name(Category category) noexcept {
+    const auto index = static_cast<std::size_t>(category);
+    return index < std::size(kCategoryNames) ? kCategoryNames[index] : std::string_view{};
+}
+
+}  // namespace exeray::event
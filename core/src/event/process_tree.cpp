@@ -0,0 +1,242 @@
+/// @file process_tree.cpp
+/// @brief Materialized process tree (platform independent).
+
+#include "exeray/event/process_tree.hpp"
+#include "exeray/event/graph.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+namespace exeray::event {
+
+void ProcessTree::add(EventId create, EventId parent, uint32_t pid, Timestamp start) {
+    if (create == INVALID_EVENT) {
+        return;
+    }
+    std::unique_lock lock(mutex_);
+    if (nodes_.size() >= kMaxNodes || index_.contains(create)) {
+        return;
+    }
+    const auto index = static_cast<uint32_t>(nodes_.size());
+    Node& node = nodes_.emplace_back();
+    node.create = create;
+    node.pid = pid;
+    node.start = start;
+    node.parent = index_of(parent);
+    node.up.fill(kNone);
+
+    uint32_t* tail = &last_root_;
+    uint32_t* head = &first_root_;
+    if (node.parent != kNone) {
+        Node& up = nodes_[node.parent];
+        node.depth = up.depth + 1;
+        node.up[0] = node.parent;
+        for (std::size_t k = 1; k < kJumps && node.up[k - 1] != kNone; ++k) {
+            node.up[k] = nodes_[node.up[k - 1]].up[k - 1];
+        }
+        head = &up.first_child;
+        tail = &up.last_child;
+    }
+    if (*tail != kNone) {
+        nodes_[*tail].next_sibling = index;
+    } else {
+        *head = index;
+    }
+    *tail = index;
+    index_.emplace(create, index);
+}
+
+void ProcessTree::stop(EventId create, Timestamp at) {
+    std::shared_lock lock(mutex_);
+    const uint32_t index = index_of(create);
+    if (index != kNone) {
+        nodes_[index].stop.store(std::max<Timestamp>(at, 1), std::memory_order_relaxed);
+    }
+}
+
+void ProcessTree::count(std::span<const PendingEvent> events) {
+    std::shared_lock lock(mutex_);
+    if (nodes_.empty()) {
+        return;
+    }
+    // Events of one process come in runs; one ancestor walk per run
+    EventId run = INVALID_EVENT;
+    std::uint64_t n = 0;
+    for (const PendingEvent& event : events) {
+        if (event.parent != run) {
+            if (n != 0) {
+                add_events(index_of(run), n);
+            }
+            run = event.parent;
+            n = 0;
+        }
+        ++n;
+    }
+    if (n != 0) {
+        add_events(index_of(run), n);
+    }
+}
+
+void ProcessTree::add_events(uint32_t index, std::uint64_t n) noexcept {
+    if (index == kNone) {
+        return;
+    }
+    nodes_[index].events.fetch_add(n, std::memory_order_relaxed);
+    for (; index != kNone; index = nodes_[index].parent) {
+        nodes_[index].subtree.fetch_add(n, std::memory_order_relaxed);
+    }
+}
+
+uint32_t ProcessTree::index_of(EventId create) const noexcept {
+    if (create == INVALID_EVENT) {
+        return kNone;
+    }
+    const auto it = index_.find(create);
+    return it != index_.end() ? it->second : kNone;
+}
+
+ProcessTreeNode ProcessTree::view(uint32_t index) const {
+    const Node& node = nodes_[index];
+    ProcessTreeNode out;
+    out.create = node.create;
+    out.parent = node.parent != kNone ? nodes_[node.parent].create : INVALID_EVENT;
+    out.pid = node.pid;
+    out.depth = node.depth;
+    out.start = node.start;
+    out.stop = node.stop.load(std::memory_order_relaxed);
+    out.events = node.events.load(std::memory_order_relaxed);
+    out.subtree_events = node.subtree.load(std::memory_order_relaxed);
+    return out;
+}
+
+uint32_t ProcessTree::lift(uint32_t index, uint32_t levels) const noexcept {
+    for (std::size_t k = kJumps; k-- > 0 && index != kNone;) {
+        while (levels >= (uint32_t{1} << k) && index != kNone) {
+            index = nodes_[index].up[k];
+            levels -= uint32_t{1} << k;
+        }
+    }
+    return index;
+}
+
+std::optional<ProcessTreeNode> ProcessTree::node(EventId create) const {
+    std::shared_lock lock(mutex_);
+    const uint32_t index = index_of(create);
+    if (index == kNone) {
+        return std::nullopt;
+    }
+    return view(index);
+}
+
+std::vector<ProcessTreeNode> ProcessTree::ancestors(EventId create) const {
+    std::shared_lock lock(mutex_);
+    std::vector<ProcessTreeNode> result;
+    const uint32_t index = index_of(create);
+    if (index == kNone) {
+        return result;
+    }
+    result.reserve(nodes_[index].depth);
+    for (uint32_t up = nodes_[index].parent; up != kNone; up = nodes_[up].parent) {
+        result.push_back(view(up));
+    }
+    return result;
+}
+
+std::vector<ProcessTreeNode> ProcessTree::children(EventId create) const {
+    std::shared_lock lock(mutex_);
+    std::vector<ProcessTreeNode> result;
+    const uint32_t index = index_of(create);
+    if (index == kNone) {
+        return result;
+    }
+    for (uint32_t child = nodes_[index].first_child; child != kNone;
+         child = nodes_[child].next_sibling) {
+        result.push_back(view(child));
+    }
+    return result;
+}
+
+std::vector<ProcessTreeNode> ProcessTree::descendants(EventId create,
+                                                      std::size_t max_nodes) const {
+    std::shared_lock lock(mutex_);
+    std::vector<ProcessTreeNode> result;
+    uint32_t first = first_root_;
+    uint32_t stop_at = kNone;  // Walk ends when it climbs back to this node
+    if (create != INVALID_EVENT) {
+        stop_at = index_of(create);
+        if (stop_at == kNone) {
+            return result;
+        }
+        first = nodes_[stop_at].first_child;
+    }
+
+    // Pre-order without a stack: down to the first child, else across to the
+    // next sibling of the nearest ancestor that has one
+    for (uint32_t index = first; index != kNone && result.size() < max_nodes;) {
+        result.push_back(view(index));
+        if (nodes_[index].first_child != kNone) {
+            index = nodes_[index].first_child;
+            continue;
+        }
+        while (index != kNone && nodes_[index].next_sibling == kNone) {
+            index = nodes_[index].parent;
+            if (index == stop_at) {
+                index = kNone;
+            }
+        }
+        if (index != kNone) {
+            index = nodes_[index].next_sibling;
+        }
+    }
+    return result;
+}
+
+std::uint64_t ProcessTree::subtree_events(EventId create) const {
+    std::shared_lock lock(mutex_);
+    const uint32_t index = index_of(create);
+    return index != kNone ? nodes_[index].subtree.load(std::memory_order_relaxed) : 0;
+}
+
+EventId ProcessTree::common_ancestor(EventId a, EventId b) const {
+    std::shared_lock lock(mutex_);
+    uint32_t x = index_of(a);
+    uint32_t y = index_of(b);
+    if (x == kNone || y == kNone) {
+        return INVALID_EVENT;
+    }
+    if (nodes_[x].depth < nodes_[y].depth) {
+        std::swap(x, y);
+    }
+    x = lift(x, nodes_[x].depth - nodes_[y].depth);
+    if (x == y) {
+        return nodes_[x].create;
+    }
+    // Deeper than 2^kJumps the table runs out; finish one step at a time
+    while (nodes_[x].depth >= (uint32_t{1} << kJumps) && nodes_[x].parent != nodes_[y].parent) {
+        x = nodes_[x].parent;
+        y = nodes_[y].parent;
+    }
+    for (std::size_t k = kJumps; k-- > 0;) {
+        if (nodes_[x].up[k] != nodes_[y].up[k]) {
+            x = nodes_[x].up[k];
+            y = nodes_[y].up[k];
+        }
+    }
+    const uint32_t parent = nodes_[x].parent;
+    return parent != kNone ? nodes_[parent].create : INVALID_EVENT;
+}
+
+std::size_t ProcessTree::size() const {
+    std::shared_lock lock(mutex_);
+    return nodes_.size();
+}
+
+void ProcessTree::clear() {
+    std::unique_lock lock(mutex_);
+    nodes_.clear();
+    index_.clear();
+    first_root_ = kNone;
+    last_root_ = kNone;
+}
+
+}  // namespace exeray::event
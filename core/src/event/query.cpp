@@ -0,0 +1,125 @@
+/// @file query.cpp
+/// @brief Query planning, projection and aggregation over EventGraph.
+
+#include "exeray/event/query.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace exeray::event {
+
+namespace {
+
+/// Cost of one category-index step relative to one scanned row. Index steps
+/// chase a pointer to a random node; scan rows are sequential and filtered
+/// 64 at a time.
+constexpr std::size_t kIndexStepCost = 4;
+
+/// @brief Run a query and write one projected value per match into out.
+template <typename T, typename Project>
+std::size_t run_into(const EventGraph& graph, const Query& query, std::span<T> out,
+                     Project project_fn) {
+    Query bounded = query;
+    bounded.limit = (std::min)(query.limit, out.size());
+    std::size_t n = 0;
+    for_each_match(graph, bounded, [&](EventView view) { out[n++] = project_fn(view); });
+    return n;
+}
+
+}  // namespace
+
+uint32_t group_value(const EventView& view, GroupKey key) noexcept {
+    switch (key) {
+        case GroupKey::Pid:
+            return event_pid(view.payload());
+        case GroupKey::RemotePort:
+            return event_remote_port(view.payload());
+        case GroupKey::Category:
+            return static_cast<uint32_t>(view.category());
+        case GroupKey::Operation:
+            return view.operation();
+        case GroupKey::Correlation:
+            return view.correlation_id();
+    }
+    return 0;
+}
+
+bool group_counts_zero(GroupKey key) noexcept {
+    return key == GroupKey::Category || key == GroupKey::Operation;
+}
+
+QueryRow project(const EventView& view) noexcept {
+    return QueryRow{view.id(),
+                    view.timestamp(),
+                    event_pid(view.payload()),
+                    view.correlation_id(),
+                    event_remote_port(view.payload()),
+                    view.category(),
+                    view.operation(),
+                    view.status()};
+}
+
+QueryPlan plan_query(const EventGraph& graph, const Query& query) noexcept {
+    const FilterSpec& spec = query.filter;
+    if (query.limit == 0 || spec.from > spec.to) {
+        return QueryPlan::Empty;
+    }
+    if (spec.correlation_id != 0) {
+        return QueryPlan::Correlation;
+    }
+    if (std::popcount(spec.categories) == 1) {
+        const auto cat = static_cast<Category>(std::countr_zero(spec.categories));
+        const bool timed =
+            spec.from != 0 || spec.to != std::numeric_limits<Timestamp>::max();
+        const std::size_t scan_rows =
+            timed ? graph.estimate_in_range(spec.from, spec.to) : graph.count();
+        if (graph.category_count(cat) * kIndexStepCost <= scan_rows) {
+            return QueryPlan::Category;
+        }
+    }
+    return QueryPlan::Scan;
+}
+
+std::size_t run_query(const EventGraph& graph, const Query& query,
+                      std::span<EventId> out) {
+    return run_into(graph, query, out, [](const EventView& view) { return view.id(); });
+}
+
+std::size_t run_query(const EventGraph& graph, const Query& query,
+                      std::span<QueryRow> out) {
+    return run_into(graph, query, out, [](const EventView& view) { return project(view); });
+}
+
+std::size_t top_counts(const EventGraph& graph, const Query& query, GroupKey key,
+                       std::span<GroupCount> out) {
+    if (out.empty()) {
+        return 0;
+    }
+    Query all = query;
+    all.order = QueryOrder::OldestFirst;
+    all.limit = std::numeric_limits<std::size_t>::max();
+
+    std::unordered_map<uint32_t, std::size_t> counts;
+    const bool keep_zero = group_counts_zero(key);
+    for_each_match(graph, all, [&](EventView view) {
+        const uint32_t value = group_value(view, key);
+        if (value != 0 || keep_zero) {
+            ++counts[value];
+        }
+    });
+
+    std::vector<GroupCount> groups;
+    groups.reserve(counts.size());
+    for (const auto& [value, count] : counts) {
+        groups.push_back(GroupCount{value, count});
+    }
+    const std::size_t n = (std::min)(out.size(), groups.size());
+    std::partial_sort(groups.begin(), groups.begin() + static_cast<std::ptrdiff_t>(n),
+                      groups.end(), [](const GroupCount& a, const GroupCount& b) {
+                          return a.count != b.count ? a.count > b.count : a.key < b.key;
+                      });
+    std::copy_n(groups.begin(), n, out.begin());
+    return n;
+}
+
+}  // namespace exeray::event
@@ -0,0 +1,121 @@
+/// @file retained_events.cpp
+/// @brief Long-term store of flagged evicted events (platform independent).
+
+#include "exeray/event/retained_events.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace exeray::event {
+
+namespace {
+
+/// @brief Spread a mark key over the table (Fibonacci hashing).
+std::size_t mark_hash(std::uint64_t key) noexcept {
+    return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+}  // namespace
+
+RetainedEvents::RetainedEvents(const RetainedConfig& config)
+    : nodes_(config.enabled ? config.capacity : 0),
+      tags_(nodes_.size()),
+      marks_(config.enabled ? std::bit_ceil((std::max)(config.marks, kMaxProbe)) : 0) {}
+
+void RetainedEvents::Batch::add(const EventNode& node, EventTags tags) {
+    RetainedEvents& store = store_;
+    const bool keep = node.status == Status::Suspicious || tags != 0 ||
+                      store.has_mark(kCorrelation | node.correlation_id) ||
+                      store.has_mark(kProcess | event_pid(node.payload));
+    if (!keep || store.nodes_.empty()) {
+        store.dropped_.add(node.payload.category, node.status, event_pid(node.payload));
+        if (store.dropped_count_++ == 0 || node.timestamp < store.dropped_from_) {
+            store.dropped_from_ = node.timestamp;
+        }
+        store.dropped_to_ = (std::max)(store.dropped_to_, node.timestamp);
+        return;
+    }
+    if (store.size_ == store.nodes_.size()) {
+        ++store.overwritten_;
+    } else {
+        ++store.size_;
+    }
+    store.nodes_[store.next_] = node;
+    store.tags_[store.next_] = tags;
+    store.next_ = (store.next_ + 1) % store.nodes_.size();
+    ++store.kept_;
+}
+
+void RetainedEvents::mark(uint32_t correlation_id, uint32_t pid) {
+    if (marks_.empty()) {
+        return;
+    }
+    std::lock_guard lock(mutex_);
+    if (correlation_id != 0) {
+        insert_mark(kCorrelation | correlation_id);
+    }
+    if (pid != 0) {
+        insert_mark(kProcess | pid);
+    }
+}
+
+bool RetainedEvents::marked_correlation(uint32_t correlation_id) const {
+    std::lock_guard lock(mutex_);
+    return has_mark(kCorrelation | correlation_id);
+}
+
+bool RetainedEvents::marked_process(uint32_t pid) const {
+    std::lock_guard lock(mutex_);
+    return has_mark(kProcess | pid);
+}
+
+void RetainedEvents::insert_mark(std::uint64_t key) {
+    const std::size_t mask = marks_.size() - 1;
+    Mark* oldest = nullptr;
+    for (std::size_t probe = 0; probe < kMaxProbe; ++probe) {
+        Mark& slot = marks_[(mark_hash(key) + probe) & mask];
+        if (slot.key == key || slot.key == 0) {
+            mark_count_ += slot.key == 0 ? 1 : 0;
+            slot = {key, ++tick_};
+            return;
+        }
+        if (oldest == nullptr || slot.tick < oldest->tick) {
+            oldest = &slot;
+        }
+    }
+    // Window full: the mark flagged longest ago makes room
+    *oldest = {key, ++tick_};
+}
+
+bool RetainedEvents::has_mark(std::uint64_t key) const noexcept {
+    // ID 0 (no chain, unattributed) is never marked
+    if (marks_.empty() || (key & 0xFFFFFFFFu) == 0) {
+        return false;
+    }
+    const std::size_t mask = marks_.size() - 1;
+    for (std::size_t probe = 0; probe < kMaxProbe; ++probe) {
+        const Mark& slot = marks_[(mark_hash(key) + probe) & mask];
+        if (slot.key == key) {
+            return true;
+        }
+        if (slot.key == 0) {
+            return false;
+        }
+    }
+    return false;
+}
+
+RetainedStats RetainedEvents::stats() const {
+    std::lock_guard lock(mutex_);
+    RetainedStats stats;
+    stats.events = size_;
+    stats.marks = mark_count_;
+    stats.kept = kept_;
+    stats.dropped = dropped_count_;
+    stats.overwritten = overwritten_;
+    stats.dropped_from = dropped_from_;
+    stats.dropped_to = dropped_to_;
+    return stats;
+}
+
+}  // namespace exeray::event
@@ -0,0 +1,103 @@
+/// @file risk_table.cpp
+/// @brief Decaying risk scores (platform independent).
+
+#include "exeray/event/risk_table.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace exeray::event {
+
+namespace {
+
+/// @brief log2(2^a + 2^b) without leaving the log domain.
+double log2_add(double a, double b) noexcept {
+    const double high = std::max(a, b);
+    const double low = std::min(a, b);
+    return high + std::log2(1.0 + std::exp2(low - high));
+}
+
+}  // namespace
+
+RiskTable::RiskTable(Timestamp half_life) noexcept
+    : half_life_(static_cast<double>(std::max<Timestamp>(half_life, 1))) {}
+
+double RiskTable::half_lives(Timestamp timestamp) const noexcept {
+    return timestamp >= origin_ ? static_cast<double>(timestamp - origin_) / half_life_
+                                : -static_cast<double>(origin_ - timestamp) / half_life_;
+}
+
+double RiskTable::decayed(double level, Timestamp now) const noexcept {
+    return std::exp2(level - half_lives(now == 0 ? newest_ : now));
+}
+
+void RiskTable::add(uint32_t key, Timestamp timestamp, double weight) {
+    if (key == 0 || !(weight > 0.0)) {
+        return;
+    }
+    if (entries_.empty() && origin_ == 0) {
+        origin_ = timestamp;
+    }
+    newest_ = std::max(newest_, timestamp);
+    const double level = std::log2(weight) + half_lives(timestamp);
+
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        if (entries_.size() >= kMaxEntries) {
+            const auto lowest = order_.begin();
+            if (lowest->first >= level) {
+                return;
+            }
+            entries_.erase(lowest->second);
+            order_.erase(lowest);
+        }
+        it = entries_.emplace(key, Entry{level, 0, timestamp}).first;
+    } else {
+        order_.erase({it->second.level, key});
+        it->second.level = log2_add(it->second.level, level);
+    }
+    Entry& entry = it->second;
+    ++entry.events;
+    entry.last = std::max(entry.last, timestamp);
+    order_.emplace(entry.level, key);
+}
+
+void RiskTable::restore(std::span<const RiskScore> scores, Timestamp now) {
+    for (const RiskScore& score : scores) {
+        if (score.key == 0 || !(score.score > 0.0) || score.events == 0) {
+            continue;
+        }
+        const auto held = entries_.find(score.key);
+        const Timestamp last = held != entries_.end() ? held->second.last : 0;
+        add(score.key, now, score.score);
+        const auto it = entries_.find(score.key);
+        if (it != entries_.end()) {
+            // add() counted one event at now; keep the saved count and time
+            it->second.events += score.events - 1;
+            it->second.last = std::max(last, score.last);
+        }
+    }
+}
+
+double RiskTable::score(uint32_t key, Timestamp now) const {
+    const auto it = entries_.find(key);
+    return it != entries_.end() ? decayed(it->second.level, now) : 0.0;
+}
+
+std::size_t RiskTable::top(std::span<RiskScore> out, Timestamp now) const {
+    std::size_t n = 0;
+    for (auto it = order_.rbegin(); it != order_.rend() && n < out.size(); ++it, ++n) {
+        const Entry& entry = entries_.at(it->second);
+        out[n] = RiskScore{it->second, decayed(entry.level, now), entry.events, entry.last};
+    }
+    return n;
+}
+
+void RiskTable::clear() noexcept {
+    entries_.clear();
+    order_.clear();
+    origin_ = 0;
+    newest_ = 0;
+}
+
+}  // namespace exeray::event
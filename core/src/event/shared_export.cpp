@@ -0,0 +1,237 @@
+/// @file shared_export.cpp
+/// @brief Shared-memory export of an EventGraph, and its reader.
+
+#include "exeray/event/shared_export.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <new>
+
+#include "exeray/event/payload_visit.hpp"
+
+namespace exeray::event {
+
+namespace {
+
+/// Bytes before a string entry's text: its StringId and length.
+constexpr std::size_t kEntryHeaderSize = 8;
+
+/// Longest string text exported; longer ones are cut.
+constexpr std::size_t kMaxEntryText = std::size_t{1} << 16;
+
+std::size_t round_up(std::size_t value, std::size_t granularity) {
+    return (value + granularity - 1) / granularity * granularity;
+}
+
+std::atomic_ref<std::uint64_t> word(std::uint64_t& value) noexcept {
+    return std::atomic_ref<std::uint64_t>(value);
+}
+
+}  // namespace
+
+SharedGraphExport::SharedGraphExport(const EventGraph& graph, const StringPool& strings) noexcept
+    : graph_(graph), strings_(strings) {}
+
+SharedGraphExport::~SharedGraphExport() {
+    stop();
+}
+
+bool SharedGraphExport::open(const SharedExportConfig& config) {
+    std::lock_guard lock(flush_mutex_);
+    const std::size_t slots = std::bit_ceil(
+        (std::max)(config.node_slots, 2 * EventGraph::kSegmentSize));
+    const std::size_t nodes_offset = round_up(sizeof(SharedExportHeader), alignof(EventNode));
+    const std::size_t strings_offset = nodes_offset + slots * sizeof(EventNode);
+    const std::size_t string_bytes = round_up(config.string_bytes, 8);
+    if (!section_.create(config.name, strings_offset + string_bytes)) {
+        return false;
+    }
+    std::uint8_t* base = section_.bytes().data();
+    header_ = new (base) SharedExportHeader{};
+    header_->header_size = sizeof(SharedExportHeader);
+    header_->node_size = sizeof(EventNode);
+    header_->node_slots = slots;
+    header_->nodes_offset = nodes_offset;
+    header_->strings_offset = strings_offset;
+    header_->strings_capacity = string_bytes;
+    nodes_ = reinterpret_cast<EventNode*>(base + nodes_offset);
+    string_area_ = base + strings_offset;
+    next_ = static_cast<std::size_t>(graph_.oldest_id() - 1);
+    sequence_ = 0;
+    strings_used_ = 0;
+    written_.clear();
+    return true;
+}
+
+void SharedGraphExport::start(std::chrono::milliseconds interval) {
+    if (thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard lock(wake_mutex_);
+        stopping_ = false;
+    }
+    thread_ = std::thread(&SharedGraphExport::run, this, interval);
+}
+
+void SharedGraphExport::stop() {
+    if (thread_.joinable()) {
+        {
+            std::lock_guard lock(wake_mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+    flush();
+    std::lock_guard lock(flush_mutex_);
+    section_.close();
+    header_ = nullptr;
+}
+
+void SharedGraphExport::run(std::chrono::milliseconds interval) {
+    std::unique_lock lock(wake_mutex_);
+    while (!wake_.wait_for(lock, interval, [this] { return stopping_; })) {
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+std::size_t SharedGraphExport::flush() {
+    std::lock_guard lock(flush_mutex_);
+    if (header_ == nullptr) {
+        return 0;
+    }
+
+    std::size_t events = 0;
+    for (;;) {
+        const EventGraph::SegmentSpan span = graph_.segment_span(next_);
+        if (span.length == 0) {
+            break;
+        }
+        if (!export_span(span)) {
+            continue;  // Recycled while copied: segment_span() moves to the oldest
+        }
+        if (span.first > next_) {
+            lost_.fetch_add(span.first - next_, std::memory_order_relaxed);
+            word(header_->lost).store(lost(), std::memory_order_relaxed);
+        }
+        next_ = span.first + span.length;
+        events += span.length;
+    }
+    exported_.fetch_add(events, std::memory_order_relaxed);
+    return events;
+}
+
+bool SharedGraphExport::export_span(const EventGraph::SegmentSpan& span) {
+    const std::uint64_t slots = header_->node_slots;
+
+    // Readers that see any overwritten byte see the claim first. A retry
+    // after a recycled span may be shorter; the claim never moves back
+    const std::uint64_t claimed = word(header_->claimed).load(std::memory_order_relaxed);
+    word(header_->claimed).store((std::max)(claimed, sequence_ + span.length),
+                                 std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::size_t first = sequence_ & (slots - 1);
+    const std::size_t head = (std::min)(span.length, static_cast<std::size_t>(slots - first));
+    std::memcpy(static_cast<void*>(nodes_ + first), span.nodes, head * sizeof(EventNode));
+    std::memcpy(static_cast<void*>(nodes_), span.nodes + head,
+                (span.length - head) * sizeof(EventNode));
+    if (graph_.epoch() != span.epoch) {
+        // The slots are claimed but unpublished; the retry writes them again
+        return false;
+    }
+
+    // Strings of the copy, which the ring can no longer change
+    for (std::size_t i = 0; i < span.length; ++i) {
+        for_each_string(nodes_[(sequence_ + i) & (slots - 1)].payload,
+                        [this](StringId id) { note_string(id); });
+    }
+    word(header_->strings_used).store(strings_used_, std::memory_order_release);
+    word(header_->strings_dropped).store(strings_dropped(), std::memory_order_relaxed);
+
+    sequence_ += span.length;
+    word(header_->published).store(sequence_, std::memory_order_release);
+    return true;
+}
+
+void SharedGraphExport::note_string(StringId id) {
+    if (id == INVALID_STRING || written_.contains(id)) {
+        return;
+    }
+    const std::string_view text = strings_.get(id);
+    const std::size_t length = (std::min)(text.size(), kMaxEntryText);
+    const std::size_t size = kEntryHeaderSize + round_up(length, 8);
+    if (strings_used_ + size > header_->strings_capacity) {
+        strings_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    written_.insert(id);
+    std::uint8_t* entry = string_area_ + strings_used_;
+    const auto length32 = static_cast<std::uint32_t>(length);
+    std::memcpy(entry, &id, sizeof(id));
+    std::memcpy(entry + 4, &length32, sizeof(length32));
+    std::memcpy(entry + kEntryHeaderSize, text.data(), length);
+    strings_used_ += size;
+}
+
+bool SharedGraphReader::open(std::string_view name) {
+    header_ = nullptr;
+    index_.clear();
+    strings_read_ = 0;
+    missed_ = 0;
+    overrun_ = false;
+    if (!section_.open(name) || section_.bytes().size() < sizeof(SharedExportHeader)) {
+        return false;
+    }
+    const std::uint8_t* base = section_.bytes().data();
+    const auto* header = reinterpret_cast<const SharedExportHeader*>(base);
+    const std::size_t size = section_.bytes().size();
+    if (header->magic != kSharedExportMagic || header->format != kSharedExportFormat ||
+        header->header_size != sizeof(SharedExportHeader) ||
+        header->node_size != sizeof(EventNode) || !std::has_single_bit(header->node_slots) ||
+        header->nodes_offset % alignof(EventNode) != 0 ||
+        header->nodes_offset + header->node_slots * sizeof(EventNode) > header->strings_offset ||
+        header->strings_offset + header->strings_capacity > size) {
+        section_.close();
+        return false;
+    }
+    header_ = header;
+    nodes_ = reinterpret_cast<const EventNode*>(base + header->nodes_offset);
+    string_area_ = base + header->strings_offset;
+    const std::uint64_t claimed = load(header->claimed);
+    cursor_ = claimed > header->node_slots ? claimed - header->node_slots : 0;
+    return true;
+}
+
+std::string_view SharedGraphReader::resolve(StringId id) {
+    if (header_ == nullptr) {
+        return {};
+    }
+    if (const auto it = index_.find(id); it != index_.end()) {
+        return it->second;
+    }
+    // Index the entries published since the last miss
+    const std::uint64_t used = (std::min)(load(header_->strings_used), header_->strings_capacity);
+    while (strings_read_ + kEntryHeaderSize <= used) {
+        const std::uint8_t* entry = string_area_ + strings_read_;
+        StringId entry_id = INVALID_STRING;
+        std::uint32_t length = 0;
+        std::memcpy(&entry_id, entry, sizeof(entry_id));
+        std::memcpy(&length, entry + 4, sizeof(length));
+        const std::uint64_t size = kEntryHeaderSize + round_up(length, 8);
+        if (strings_read_ + size > used) {
+            break;
+        }
+        index_.emplace(entry_id, std::string_view(reinterpret_cast<const char*>(entry) +
+                                                      kEntryHeaderSize,
+                                                  length));
+        strings_read_ += size;
+    }
+    const auto it = index_.find(id);
+    return it != index_.end() ? it->second : std::string_view{};
+}
+
+}  // namespace exeray::event
@@ -0,0 +1,210 @@
+/// @file sketches.cpp
+/// @brief Heavy-hitter and cardinality sketches (platform independent).
+
+#include "exeray/event/sketches.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace exeray::event {
+
+namespace {
+
+/// @brief splitmix64 finalizer: spreads sequential IDs over all 64 bits.
+constexpr std::uint64_t mix(std::uint64_t x) noexcept {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+constexpr std::array<std::uint64_t, HeavyHitters::kDepth> kRowSeeds = {
+    0x243F6A8885A308D3ULL, 0x13198A2E03707344ULL, 0xA4093822299F31D0ULL,
+    0x082EFA98EC4E6C89ULL};
+
+std::size_t column(std::size_t row, std::uint64_t key) noexcept {
+    return static_cast<std::size_t>(mix(key ^ kRowSeeds[row]) & (HeavyHitters::kWidth - 1));
+}
+
+}  // namespace
+
+// ============================================================================
+// CardinalitySketch
+// ============================================================================
+
+void CardinalitySketch::add(std::uint64_t key) noexcept {
+    const std::uint64_t hash = mix(key);
+    const auto index = static_cast<std::size_t>(hash >> (64 - kPrecision));
+    // Rank of the first set bit after the index bits; the guard bit caps it
+    const std::uint64_t rest = (hash << kPrecision) | (std::uint64_t{1} << (kPrecision - 1));
+    const auto rank = static_cast<std::uint8_t>(std::countl_zero(rest) + 1);
+
+    std::atomic<std::uint8_t>& reg = registers_[index];
+    std::uint8_t current = reg.load(std::memory_order_relaxed);
+    while (rank > current &&
+           !reg.compare_exchange_weak(current, rank, std::memory_order_relaxed)) {
+    }
+}
+
+double CardinalitySketch::estimate() const noexcept {
+    constexpr auto m = static_cast<double>(kRegisters);
+    double sum = 0.0;
+    std::size_t zeros = 0;
+    for (const auto& reg : registers_) {
+        const std::uint8_t value = reg.load(std::memory_order_relaxed);
+        sum += std::ldexp(1.0, -static_cast<int>(value));
+        zeros += value == 0 ? 1 : 0;
+    }
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+    const double raw = alpha * m * m / sum;
+    if (raw <= 2.5 * m && zeros != 0) {
+        return m * std::log(m / static_cast<double>(zeros));  // Linear counting
+    }
+    return raw;
+}
+
+// ============================================================================
+// HeavyHitters
+// ============================================================================
+
+HeavyHitters::HeavyHitters(std::size_t capacity)
+    : capacity_((std::max)(capacity, std::size_t{1})),
+      keys_(std::make_unique<std::atomic<std::uint64_t>[]>(capacity_)) {
+    for (std::size_t i = 0; i < capacity_; ++i) {
+        keys_[i].store(kNoKey, std::memory_order_relaxed);
+    }
+}
+
+void HeavyHitters::add(std::uint64_t key) noexcept {
+    std::uint64_t count = ~std::uint64_t{0};
+    for (std::size_t row = 0; row < kDepth; ++row) {
+        const std::uint32_t previous =
+            counts_[row][column(row, key)].fetch_add(1, std::memory_order_relaxed);
+        count = (std::min)(count, std::uint64_t{previous} + 1);
+    }
+    if (count <= floor_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    for (std::size_t i = 0; i < capacity_; ++i) {
+        if (keys_[i].load(std::memory_order_relaxed) == key) {
+            return;
+        }
+    }
+
+    const std::lock_guard lock(mutex_);
+    std::size_t victim = capacity_;
+    std::uint64_t lowest = ~std::uint64_t{0};
+    for (std::size_t i = 0; i < capacity_; ++i) {
+        const std::uint64_t tracked = keys_[i].load(std::memory_order_relaxed);
+        if (tracked == key) {
+            return;  // Inserted by another thread meanwhile
+        }
+        const std::uint64_t estimated = tracked == kNoKey ? 0 : estimate(tracked);
+        if (estimated < lowest) {
+            lowest = estimated;
+            victim = i;
+        }
+    }
+    if (count <= lowest) {
+        return;
+    }
+    keys_[victim].store(key, std::memory_order_relaxed);
+
+    // Admission threshold: the smallest tracked estimate once every slot is used
+    std::uint64_t floor = ~std::uint64_t{0};
+    for (std::size_t i = 0; i < capacity_; ++i) {
+        const std::uint64_t tracked = keys_[i].load(std::memory_order_relaxed);
+        floor = tracked == kNoKey ? 0 : (std::min)(floor, estimate(tracked));
+        if (floor == 0) {
+            break;
+        }
+    }
+    floor_.store(floor, std::memory_order_relaxed);
+}
+
+std::uint64_t HeavyHitters::estimate(std::uint64_t key) const noexcept {
+    std::uint64_t count = ~std::uint64_t{0};
+    for (std::size_t row = 0; row < kDepth; ++row) {
+        count = (std::min)(count, std::uint64_t{counts_[row][column(row, key)].load(
+                                      std::memory_order_relaxed)});
+    }
+    return count;
+}
+
+std::vector<HeavyHitter> HeavyHitters::top() const {
+    std::vector<HeavyHitter> hitters;
+    hitters.reserve(capacity_);
+    for (std::size_t i = 0; i < capacity_; ++i) {
+        const std::uint64_t key = keys_[i].load(std::memory_order_relaxed);
+        if (key != kNoKey) {
+            hitters.push_back({key, estimate(key)});
+        }
+    }
+    std::sort(hitters.begin(), hitters.end(), [](const HeavyHitter& a, const HeavyHitter& b) {
+        return a.count != b.count ? a.count > b.count : a.key < b.key;
+    });
+    return hitters;
+}
+
+// ============================================================================
+// EventSketches
+// ============================================================================
+
+std::string_view sketch_kind_name(SketchKind kind) noexcept {
+    switch (kind) {
+        case SketchKind::Files: return "files";
+        case SketchKind::RemoteAddresses: return "remote_addresses";
+        case SketchKind::Domains: return "domains";
+        case SketchKind::Processes: return "processes";
+        case SketchKind::Count: break;
+    }
+    return "unknown";
+}
+
+static_assert(kSketchKinds == 4, "EventSketches initializes one Sketch per kind");
+
+EventSketches::EventSketches(std::size_t top)
+    : sketches_{{Sketch(top), Sketch(top), Sketch(top), Sketch(top)}} {}
+
+void EventSketches::add(SketchKind kind, std::uint64_t key) noexcept {
+    Sketch& sketch = sketches_[static_cast<std::size_t>(kind)];
+    sketch.hitters.add(key);
+    sketch.unique.add(key);
+}
+
+void EventSketches::add(const EventPayload& payload, std::uint32_t pid) noexcept {
+    switch (payload.category) {
+        case Category::FileSystem:
+            if (payload.file.path != INVALID_STRING) {
+                add(SketchKind::Files, payload.file.path);
+            }
+            break;
+        case Category::Network:
+            if (payload.network.remote_addr != 0) {
+                add(SketchKind::RemoteAddresses, address_key(payload.network));
+            }
+            break;
+        case Category::Dns:
+            if (payload.dns.domain != INVALID_STRING) {
+                add(SketchKind::Domains, payload.dns.domain);
+            }
+            break;
+        default:
+            break;
+    }
+    if (pid != 0) {
+        add(SketchKind::Processes, pid);
+    }
+}
+
+SketchSnapshot EventSketches::snapshot() const {
+    SketchSnapshot snap;
+    for (std::size_t k = 0; k < kSketchKinds; ++k) {
+        snap.kinds[k].unique = sketches_[k].unique.estimate();
+        snap.kinds[k].top = sketches_[k].hitters.top();
+    }
+    return snap;
+}
+
+}  // namespace exeray::event
@@ -0,0 +1,36 @@
+/// @file snapshot.cpp
+/// @brief GraphSnapshot construction and bulk scan.
+
+#include "exeray/event/snapshot.hpp"
+
+#include <algorithm>
+
+namespace exeray::event {
+
+GraphSnapshot::GraphSnapshot(const EventGraph& graph) noexcept
+    : graph_(&graph),
+      begin_(graph.first_index_.load(std::memory_order_acquire)),
+      end_(begin_ + graph.count()),
+      epoch_(graph.epoch()) {
+    // Totals are read after the watermark: every event below end_ reserved
+    // its category position before it was published, so it lies below them
+    for (std::size_t c = 0; c < EventGraph::kCategoryCount; ++c) {
+        category_totals_[c] = graph.categories_[c].total.load(std::memory_order_acquire);
+    }
+}
+
+std::size_t GraphSnapshot::live_begin() const noexcept {
+    return (std::max)(begin_, graph_->first_index_.load(std::memory_order_acquire));
+}
+
+std::size_t GraphSnapshot::scan(const FilterSpec& spec, std::vector<EventId>& out) const {
+    const auto before = out.size();
+    graph_->match_where(live_begin(), end_, spec,
+                        [&out](std::size_t index, const EventNode&) {
+                            out.push_back(static_cast<EventId>(index) + 1);
+                            return true;
+                        });
+    return out.size() - before;
+}
+
+}  // namespace exeray::event
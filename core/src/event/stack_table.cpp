@@ -0,0 +1,81 @@
+/// @file stack_table.cpp
+/// @brief Deduplicated call stacks.
+
+#include "exeray/event/stack_table.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace exeray::event {
+
+namespace {
+
+std::uint64_t hash_frames(std::span<const std::uint64_t> frames) noexcept {
+    std::uint64_t hash = 0x9E3779B97F4A7C15ULL ^ frames.size();
+    for (const std::uint64_t frame : frames) {
+        hash ^= frame + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+        hash *= 0xBF58476D1CE4E5B9ULL;
+    }
+    return hash ^ (hash >> 31);
+}
+
+bool same_frames(const Extension& record, std::span<const std::uint64_t> frames) noexcept {
+    return record.kind == ExtensionKind::Stack && record.bytes.size() == frames.size_bytes() &&
+           std::memcmp(record.bytes.data(), frames.data(), frames.size_bytes()) == 0;
+}
+
+}  // namespace
+
+ExtensionId StackTable::intern(std::span<const std::uint64_t> frames) {
+    if (frames.empty()) {
+        return NO_EXTENSION;
+    }
+    frames = frames.first((std::min)(frames.size(), kMaxFrames));
+    interned_.fetch_add(1, std::memory_order_relaxed);
+
+    const std::uint64_t hash = hash_frames(frames);
+    Shard& shard = shards_[hash % kShards];
+    std::lock_guard lock(shard.mutex);
+    const auto [first, last] = shard.stacks.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        if (same_frames(store_.get(it->second), frames)) {
+            return it->second;
+        }
+    }
+
+    const ExtensionId id = store_.append(
+        ExtensionKind::Stack,
+        std::span(reinterpret_cast<const std::uint8_t*>(frames.data()), frames.size_bytes()));
+    if (id != NO_EXTENSION) {
+        shard.stacks.emplace(hash, id);
+        distinct_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return id;
+}
+
+std::vector<std::uint64_t> StackTable::frames(ExtensionId id) const {
+    const Extension record = store_.get(id);
+    if (record.kind != ExtensionKind::Stack) {
+        return {};
+    }
+    std::vector<std::uint64_t> frames(record.bytes.size() / sizeof(std::uint64_t));
+    std::memcpy(frames.data(), record.bytes.data(), frames.size() * sizeof(std::uint64_t));
+    return frames;
+}
+
+void StackTable::clear() {
+    for (Shard& shard : shards_) {
+        std::lock_guard lock(shard.mutex);
+        shard.stacks.clear();
+    }
+    interned_.store(0, std::memory_order_relaxed);
+    distinct_.store(0, std::memory_order_relaxed);
+    orphaned_.store(0, std::memory_order_relaxed);
+}
+
+StackTableStats StackTable::stats() const noexcept {
+    return {interned_.load(std::memory_order_relaxed), distinct_.load(std::memory_order_relaxed),
+            orphaned_.load(std::memory_order_relaxed)};
+}
+
+}  // namespace exeray::event
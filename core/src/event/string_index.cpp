@@ -0,0 +1,164 @@
+/// @file string_index.cpp
+/// @brief StringId posting lists (platform independent).
+
+#include "exeray/event/string_index.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+namespace exeray::event {
+
+namespace {
+
+/// Lists smaller than this are never compacted.
+constexpr std::size_t kMinCompactBytes = 64;
+
+std::uint64_t zigzag(std::int64_t value) noexcept {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t unzigzag(std::uint64_t value) noexcept {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+void put_varint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+/// @brief Call fn(index) for every posting of an encoded list.
+template <typename F>
+void decode(const std::vector<std::uint8_t>& bytes, F&& fn) {
+    std::uint64_t index = 0;
+    std::size_t pos = 0;
+    while (pos < bytes.size()) {
+        std::uint64_t value = 0;
+        for (unsigned shift = 0; pos < bytes.size(); shift += 7) {
+            const std::uint8_t byte = bytes[pos++];
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                break;
+            }
+        }
+        index += static_cast<std::uint64_t>(unzigzag(value));
+        fn(index);
+    }
+}
+
+}  // namespace
+
+StringIndex::StringIndex(std::span<const PayloadField> fields) {
+    for (const PayloadField& field : fields) {
+        const auto c = static_cast<std::size_t>(field.category);
+        if (!field.is_string || field.size != sizeof(StringId) || c >= offsets_.size()) {
+            continue;
+        }
+        auto& offsets = offsets_[c];
+        if (std::find(offsets.begin(), offsets.end(), field.offset) == offsets.end()) {
+            offsets.push_back(field.offset);
+        }
+    }
+}
+
+void StringIndex::add(std::size_t index, const EventPayload& payload, std::size_t first_live) {
+    const auto c = static_cast<std::size_t>(payload.category);
+    if (c >= offsets_.size()) {
+        return;
+    }
+    for (const std::uint16_t offset : offsets_[c]) {
+        StringId id;
+        std::memcpy(&id, reinterpret_cast<const std::uint8_t*>(&payload) + offset, sizeof(id));
+        if (id == INVALID_STRING) {
+            continue;
+        }
+        Shard& shard = shards_[id % kShards];
+        const std::lock_guard lock(shard.mutex);
+        Postings& postings = shard.lists[id];
+        if (!postings.bytes.empty() && postings.last == index) {
+            continue;  // Two indexed fields of one event hold the same string
+        }
+        if (first_live != 0 && postings.bytes.size() >= kMinCompactBytes &&
+            postings.bytes.size() >= 2 * postings.compacted) {
+            compact(postings, first_live);
+        }
+        append(postings, index);
+    }
+}
+
+void StringIndex::append(Postings& postings, std::uint64_t index) {
+    const auto delta = static_cast<std::int64_t>(index - postings.last);
+    put_varint(postings.bytes, zigzag(delta));
+    postings.last = index;
+}
+
+void StringIndex::compact(Postings& postings, std::size_t first_live) {
+    Postings kept;
+    decode(postings.bytes, [&kept, first_live](std::uint64_t index) {
+        if (index >= first_live) {
+            append(kept, index);
+        }
+    });
+    kept.compacted = kept.bytes.size();
+    postings = std::move(kept);
+}
+
+std::size_t StringIndex::collect(StringId id, std::vector<std::size_t>& out) const {
+    const Shard& shard = shards_[id % kShards];
+    const std::lock_guard lock(shard.mutex);
+    const auto it = shard.lists.find(id);
+    if (it == shard.lists.end()) {
+        return 0;
+    }
+    const std::size_t before = out.size();
+    decode(it->second.bytes,
+           [&out](std::uint64_t index) { out.push_back(static_cast<std::size_t>(index)); });
+    return out.size() - before;
+}
+
+std::size_t StringIndex::lists() const {
+    std::size_t total = 0;
+    for (const Shard& shard : shards_) {
+        const std::lock_guard lock(shard.mutex);
+        total += shard.lists.size();
+    }
+    return total;
+}
+
+std::size_t StringIndex::bytes() const {
+    std::size_t total = 0;
+    for (const Shard& shard : shards_) {
+        const std::lock_guard lock(shard.mutex);
+        for (const auto& [id, postings] : shard.lists) {
+            total += postings.bytes.size();
+        }
+    }
+    return total;
+}
+
+std::vector<PayloadField> find_string_fields(std::span<const std::string> names,
+                                             std::vector<std::string>* unknown) {
+    std::vector<PayloadField> found;
+    for (const std::string& name : names) {
+        const auto dot = name.find('.');
+        const std::string_view category =
+            std::string_view(name).substr(0, dot == std::string::npos ? 0 : dot);
+        const std::string_view member =
+            dot == std::string::npos ? std::string_view{} : std::string_view(name).substr(dot + 1);
+        const auto fields = payload_fields();
+        const auto it = std::find_if(fields.begin(), fields.end(), [&](const PayloadField& f) {
+            return f.is_string && f.name == member && category_name(f.category) == category;
+        });
+        if (it != fields.end()) {
+            found.push_back(*it);
+        } else if (unknown != nullptr) {
+            unknown->push_back(name);
+        }
+    }
+    return found;
+}
+
+}  // namespace exeray::event
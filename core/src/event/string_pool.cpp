@@ -1,150 +1,1026 @@
 #include "exeray/event/string_pool.hpp"
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cstring>
-#include <mutex>
+#include <limits>
+#include <memory>
+#include <new>
+#include <thread>
+
+#include "exeray/event/utf8.hpp"
 
 namespace exeray::event {
 
-StringPool::StringPool(Arena& arena, std::size_t initial_capacity)
-    : arena_(arena), strings_(initial_capacity) {}
+namespace {
 
-StringId StringPool::intern(std::string_view str) {
-    // Fast path: read-only lookup
-    {
-        std::shared_lock lock(mutex_);
-        auto it = strings_.find(str);
-        if (it != strings_.end()) {
-            return it->second;
+/**
+ * @brief Streaming hash over UTF-8 bytes.
+ *
+ * Bytes are packed into little-endian 64-bit words and mixed a word at a
+ * time, so feeding a string whole or in chunks gives the same tag. This
+ * lets intern_wide() look up long strings without a UTF-8 copy.
+ */
+class Utf8Hasher {
+public:
+    void bytes(std::string_view str) noexcept {
+        std::size_t i = 0;
+        if constexpr (std::endian::native == std::endian::little) {
+            if (shift_ == 0) {
+                for (; i + 8 <= str.size(); i += 8) {
+                    std::uint64_t word;
+                    std::memcpy(&word, str.data() + i, sizeof(word));
+                    mix(word);
+                }
+            }
+        }
+        for (; i < str.size(); ++i) {
+            byte(static_cast<std::uint8_t>(str[i]));
+        }
+    }
+
+    void byte(std::uint8_t value) noexcept {
+        word_ |= static_cast<std::uint64_t>(value) << shift_;
+        shift_ += 8;
+        if (shift_ == 64) {
+            mix(word_);
+            word_ = 0;
+            shift_ = 0;
+        }
+    }
+
+    /// @brief 32-bit tag of everything fed; also selects the home slot.
+    [[nodiscard]] std::uint32_t tag() const noexcept {
+        std::uint64_t hash = (hash_ ^ word_ ^ length_) * kMultiplier;
+        hash ^= hash >> 32;
+        hash *= kMultiplier;
+        return static_cast<std::uint32_t>(hash ^ (hash >> 29));
+    }
+
+    /// @brief Number of bytes fed.
+    [[nodiscard]] std::size_t length() const noexcept { return length_ + shift_ / 8; }
+
+private:
+    static constexpr std::uint64_t kMultiplier = 0x9E3779B97F4A7C15ULL;
+
+    void mix(std::uint64_t word) noexcept {
+        hash_ = (hash_ ^ word) * kMultiplier;
+        hash_ ^= hash_ >> 31;
+        length_ += 8;
+    }
+
+    std::uint64_t hash_ = 0xCBF29CE484222325ULL;
+    std::uint64_t word_ = 0;
+    std::uint64_t length_ = 0;  ///< Bytes mixed as whole words
+    unsigned shift_ = 0;
+};
+
+/// Wide code units transcoded per stack chunk by intern_wide().
+constexpr std::size_t kWideChunk = 512;
+
+/**
+ * @brief Transcode wstr chunk by chunk into a stack buffer.
+ *
+ * Chunks never split a surrogate pair, so their concatenation equals
+ * encode_utf8(wstr). Stops early when fn returns false.
+ *
+ * @return false if fn stopped the walk.
+ */
+template <typename Fn>
+bool for_each_utf8_chunk(std::wstring_view wstr, Fn&& fn) {
+    std::array<char, kWideChunk * kMaxUtf8PerUnit> buffer;
+    while (!wstr.empty()) {
+        auto units = (std::min)(wstr.size(), kWideChunk);
+        const auto last = static_cast<std::uint32_t>(wstr[units - 1]);
+        if (units < wstr.size() && last >= 0xD800 && last <= 0xDBFF) {
+            --units;  // Keep the pair together in the next chunk
+        }
+        const auto bytes = encode_utf8(wstr.substr(0, units), buffer.data());
+        if (!fn(std::string_view{buffer.data(), bytes})) {
+            return false;
+        }
+        wstr.remove_prefix(units);
+    }
+    return true;
+}
+
+/// @brief Smallest power of two >= value.
+std::size_t round_up_pow2(std::size_t value) noexcept {
+    std::size_t size = 1;
+    while (size < value) {
+        size <<= 1;
+    }
+    return size;
+}
+
+/// @brief Fold-map tag of a StringId; a bijection, so equal tags mean
+/// equal ids and the map needs no key comparison.
+constexpr std::uint32_t fold_tag(StringId id) noexcept {
+    std::uint32_t x = id;
+    x ^= x >> 16;
+    x *= 0x7FEB352DU;
+    x ^= x >> 15;
+    x *= 0x846CA68BU;
+    x ^= x >> 16;
+    return x;
+}
+
+constexpr bool is_ascii_upper(char c) noexcept {
+    return c >= 'A' && c <= 'Z';
+}
+
+constexpr std::uint32_t id_of(std::uint64_t entry) noexcept {
+    return static_cast<std::uint32_t>(entry);
+}
+
+constexpr std::uint32_t tag_of_entry(std::uint64_t entry) noexcept {
+    return static_cast<std::uint32_t>(entry >> 32);
+}
+
+/// What a released ID points at: a zero length prefix, i.e. "".
+alignas(8) constexpr std::uint8_t kReleased[16] = {};
+
+/// Public interning calls of this thread in progress (see InternScope).
+thread_local std::uint32_t t_intern_depth = 0;
+
+}  // namespace
+
+StringPool::Table::Table(std::size_t slot_count)
+    : mask(slot_count - 1),
+      slots(std::make_unique<std::atomic<std::uint64_t>[]>(slot_count)) {}
+
+StringPool::Index::Index(std::size_t capacity) {
+    // Half load at capacity entries
+    tables.push_back(std::make_unique<Table>(
+        round_up_pow2((std::max)(capacity, std::size_t{8}) * 2)));
+    table.store(tables.back().get(), std::memory_order_release);
+}
+
+StringPool::Generations::Generations()
+    : chunks(std::make_unique<std::atomic<Handle*>[]>(kHandleChunks)) {}
+
+/**
+ * @brief Holds off compact() while a public intern call runs.
+ *
+ * Only the outermost call of a thread registers, so intern_path() calling
+ * intern() neither counts twice nor waits on a compaction it blocks.
+ */
+class StringPool::InternScope {
+public:
+    explicit InternScope(const StringPool& pool) {
+        Generations* generations = pool.generations_.get();
+        if (generations == nullptr || t_intern_depth++ != 0) {
+            nested_ = generations != nullptr;
+            return;
+        }
+        for (;;) {
+            // Pairs with compact(): either it sees this intern or we see it compacting
+            generations->interns.fetch_add(1, std::memory_order_seq_cst);
+            if (!generations->compacting.load(std::memory_order_seq_cst)) {
+                break;
+            }
+            generations->interns.fetch_sub(1, std::memory_order_release);
+            std::lock_guard wait(generations->compact_mutex);
+        }
+        gate_ = generations;
+    }
+
+    ~InternScope() {
+        if (gate_ != nullptr) {
+            gate_->interns.fetch_sub(1, std::memory_order_release);
+        }
+        if (gate_ != nullptr || nested_) {
+            --t_intern_depth;
+        }
+    }
+
+    InternScope(const InternScope&) = delete;
+    InternScope& operator=(const InternScope&) = delete;
+
+private:
+    Generations* gate_ = nullptr;
+    bool nested_ = false;
+};
+
+StringPool::StringPool(Arena& arena, std::size_t initial_capacity, StringStorage storage)
+    : arena_(arena),
+      generations_(storage == StringStorage::Generational ? std::make_unique<Generations>()
+                                                          : nullptr),
+      index_(initial_capacity),
+      folds_(0) {}
+
+StringPool::~StringPool() = default;
+
+template <typename Eq>
+StringId StringPool::find(const Table& table, std::uint32_t tag, Eq&& equals) const {
+    for (std::size_t probe = 0, pos = tag & table.mask; probe <= table.mask;
+         ++probe, pos = (pos + 1) & table.mask) {
+        const auto entry = table.slots[pos].load(std::memory_order_acquire);
+        if (entry == 0) {
+            return INVALID_STRING;
+        }
+        if (tag_of_entry(entry) == tag && equals(id_of(entry))) {
+            touch(id_of(entry));
+            return id_of(entry);
         }
     }
+    return INVALID_STRING;
+}
 
-    // Slow path: need to insert
-    std::unique_lock lock(mutex_);
+template <typename Eq>
+std::pair<StringId, bool> StringPool::insert(Table& table, std::uint32_t tag, StringId id,
+                                             Eq&& equals) {
+    const std::uint64_t fresh = static_cast<std::uint64_t>(tag) << 32 | id;
+    for (std::size_t probe = 0, pos = tag & table.mask; probe <= table.mask;
+         ++probe, pos = (pos + 1) & table.mask) {
+        auto entry = table.slots[pos].load(std::memory_order_acquire);
+        if (entry == 0 &&
+            table.slots[pos].compare_exchange_strong(entry, fresh, std::memory_order_acq_rel,
+                                                     std::memory_order_acquire)) {
+            return {id, true};
+        }
+        // Interns of one string probe the same slots, so a racing winner
+        // shows up no later than the slot we lost
+        if (tag_of_entry(entry) == tag && equals(id_of(entry))) {
+            touch(id_of(entry));
+            return {id_of(entry), false};
+        }
+    }
+    return {INVALID_STRING, false};
+}
+
+void StringPool::grow(Index& index, const Table* full) {
+    std::lock_guard lock(index.grow_mutex);
+    if (index.table.load(std::memory_order_acquire) != full) {
+        return;  // Another insert already grew it
+    }
 
-    // Double-check after acquiring exclusive lock
-    auto it = strings_.find(str);
-    if (it != strings_.end()) {
-        return it->second;
+    // Stop new inserts, then wait for those in flight to land in full
+    index.growing.store(true, std::memory_order_seq_cst);
+    while (index.writers.load(std::memory_order_seq_cst) != 0) {
+        std::this_thread::yield();
+    }
+
+    auto next = std::make_unique<Table>((full->mask + 1) * 2);
+    for (std::size_t i = 0; i <= full->mask; ++i) {
+        const auto entry = full->slots[i].load(std::memory_order_relaxed);
+        if (entry == 0) {
+            continue;
+        }
+        auto pos = tag_of_entry(entry) & next->mask;
+        while (next->slots[pos].load(std::memory_order_relaxed) != 0) {
+            pos = (pos + 1) & next->mask;
+        }
+        next->slots[pos].store(entry, std::memory_order_relaxed);
     }
 
+    // Readers still on full keep a complete view; it is retired, not freed
+    index.table.store(next.get(), std::memory_order_release);
+    index.tables.push_back(std::move(next));
+    index.growing.store(false, std::memory_order_seq_cst);
+}
+
+std::uint8_t* StringPool::allocate_string(std::size_t size, StringId& id) const {
+    if (size >= kPathNode) {
+        return nullptr;  // Length prefix reserves the top bit
+    }
     // Allocate: [len:u32][chars...]
-    const auto len = static_cast<std::uint32_t>(str.size());
-    const std::size_t total_size = sizeof(std::uint32_t) + str.size();
+    // Byte-aligned from the thread buffer: the length prefix is read with
+    // memcpy, so strings pack without per-string cache-line padding
+    std::uint8_t* storage = nullptr;
+    if (generations_ != nullptr) {
+        storage = allocate_block(sizeof(std::uint32_t) + size, id);
+    } else {
+        storage = arena_.allocate_local<std::uint8_t>(sizeof(std::uint32_t) + size);
+        id = id_at(storage);
+    }
+    if (storage == nullptr || id == INVALID_STRING) {
+        return nullptr;
+    }
+    const auto len = static_cast<std::uint32_t>(size);
+    std::memcpy(storage, &len, sizeof(len));
+    return storage + sizeof(len);
+}
 
-    auto* storage = arena_.allocate<std::uint8_t>(total_size);
+StringId StringPool::id_at(const std::uint8_t* storage) const noexcept {
     if (storage == nullptr) {
         return INVALID_STRING;
     }
+    // StringId = offset + 1 (so offset 0 maps to ID 1, never returning 0).
+    // A growable arena may reach past what a 32-bit id can address.
+    const auto offset = static_cast<std::size_t>(storage - arena_.base());
+    if (offset >= (std::numeric_limits<StringId>::max)()) {
+        return INVALID_STRING;
+    }
+    return static_cast<StringId>(offset + 1);
+}
+
+std::uint8_t* StringPool::allocate_bytes(std::size_t bytes) const {
+    Generations& generations = *generations_;
+    for (Block* block = generations.current.load(std::memory_order_acquire);;) {
+        if (block != nullptr && bytes <= block->capacity) {
+            const auto offset = block->used.fetch_add(bytes, std::memory_order_relaxed);
+            if (offset + bytes <= block->capacity) {
+                return block->data.get() + offset;
+            }
+        }
+        // Full or missing: open the next block unless a racing allocation did
+        std::lock_guard lock(generations.mutex);
+        Block* const now = generations.current.load(std::memory_order_acquire);
+        if (now != block) {
+            block = now;
+            continue;
+        }
+        const bool own = bytes > kBlockSize;  // The current block stays open
+        auto next = std::make_unique<Block>(own ? bytes : kBlockSize);
+        if (next->data == nullptr) {
+            return nullptr;
+        }
+        if (own) {
+            next->used.store(bytes, std::memory_order_relaxed);
+            generations.blocks.push_back(std::move(next));
+            return generations.blocks.back()->data.get();
+        }
+        block = next.get();
+        generations.blocks.push_back(std::move(next));
+        generations.current.store(block, std::memory_order_release);
+    }
+}
 
-    // StringId = offset + 1 (so offset 0 maps to ID 1, never returning 0)
-    const auto id = static_cast<StringId>(
-        static_cast<std::size_t>(storage - arena_.base()) + 1);
+std::uint8_t* StringPool::allocate_block(std::size_t bytes, StringId& id) const {
+    Generations& generations = *generations_;
+    auto* storage = allocate_bytes((bytes + 3) & ~std::size_t{3});
+    if (storage == nullptr) {
+        return nullptr;
+    }
+    // IDs are handle indexes + 1 and never reused
+    const auto index = generations.next_handle.fetch_add(1, std::memory_order_relaxed);
+    if (index >= (std::numeric_limits<StringId>::max)()) {
+        return nullptr;
+    }
+    const auto chunk_index = static_cast<std::size_t>(index >> kHandleShift);
+    Handle* chunk = generations.chunks[chunk_index].load(std::memory_order_acquire);
+    if (chunk == nullptr) {
+        std::lock_guard lock(generations.mutex);
+        chunk = generations.chunks[chunk_index].load(std::memory_order_relaxed);
+        if (chunk == nullptr) {
+            std::unique_ptr<Handle[]> owned(new (std::nothrow) Handle[kHandlesPerChunk]);
+            if (owned == nullptr) {
+                return nullptr;
+            }
+            chunk = owned.get();
+            generations.owned.push_back(std::move(owned));
+            generations.chunks[chunk_index].store(chunk, std::memory_order_release);
+        }
+    }
+    chunk[index & (kHandlesPerChunk - 1)].touched.store(
+        generations.generation.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    id = static_cast<StringId>(index + 1);
+    return storage;
+}
 
-    // Write length prefix
-    std::memcpy(storage, &len, sizeof(len));
+void StringPool::seal(StringId id, const std::uint8_t* storage) const noexcept {
+    if (generations_ != nullptr) {
+        handle(id)->entry.store(storage, std::memory_order_release);
+    }
+}
+
+StringPool::Handle* StringPool::handle(StringId id) const noexcept {
+    const std::size_t index = static_cast<std::size_t>(id) - 1;
+    Handle* chunk = generations_->chunks[index >> kHandleShift].load(std::memory_order_acquire);
+    return chunk != nullptr ? chunk + (index & (kHandlesPerChunk - 1)) : nullptr;
+}
+
+void StringPool::touch(StringId id) const noexcept {
+    if (generations_ == nullptr) {
+        return;
+    }
+    // Store only on the first use in a generation; the line stays shared
+    const auto generation = generations_->generation.load(std::memory_order_relaxed);
+    Handle* const stamped = handle(id);
+    if (stamped->touched.load(std::memory_order_relaxed) != generation) {
+        stamped->touched.store(generation, std::memory_order_relaxed);
+    }
+}
 
-    // Write string data
-    if (len > 0) {
-        std::memcpy(storage + sizeof(len), str.data(), len);
+const std::uint8_t* StringPool::entry(StringId id) const noexcept {
+    // ID = offset + 1, so offset = ID - 1
+    if (generations_ == nullptr) {
+        return arena_.base() + (id - 1);
     }
+    return handle(id)->entry.load(std::memory_order_acquire);
+}
 
-    // Create stable string_view pointing to arena memory
-    std::string_view stored{
-        reinterpret_cast<const char*>(storage + sizeof(len)), len};
+std::size_t StringPool::entry_size(const std::uint8_t* storage) const noexcept {
+    std::uint32_t value = 0;
+    std::memcpy(&value, storage, sizeof(value));
+    return (value & kPathNode) != 0 ? sizeof(PathNode) : sizeof(std::uint32_t) + value;
+}
 
-    strings_.emplace(stored, id);
-    bytes_used_ += total_size;
+template <typename Eq>
+StringId StringPool::publish(Index& index, std::uint32_t tag, StringId id,
+                             std::size_t total_size, Eq&& equals) {
+    // The entry is fully written before the slot makes it visible
+    for (;;) {
+        // Pairs with grow(): either it sees this writer or we see it growing
+        index.writers.fetch_add(1, std::memory_order_seq_cst);
+        if (index.growing.load(std::memory_order_seq_cst)) {
+            index.writers.fetch_sub(1, std::memory_order_release);
+            std::lock_guard wait(index.grow_mutex);
+            continue;
+        }
+        Table* table = index.table.load(std::memory_order_acquire);
+        const auto [stored, inserted] = insert(*table, tag, id, equals);
+        index.writers.fetch_sub(1, std::memory_order_release);
 
-    return id;
+        if (!inserted) {
+            // Lost the race to an equal entry; our copy stays unused
+            return stored;
+        }
+        bytes_used_.fetch_add(total_size, std::memory_order_relaxed);
+        const auto count = index.count.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (count * 2 > table->mask + 1) {
+            grow(index, table);
+        }
+        return stored;
+    }
+}
+
+StringId StringPool::intern(std::string_view str) {
+    const InternScope scope(*this);
+    Utf8Hasher hasher;
+    hasher.bytes(str);
+    const auto tag = hasher.tag();
+    const auto equals = [this, str](StringId id) { return !is_path(id) && raw(id) == str; };
+
+    // Fast path: lock-free lookup
+    if (const auto id = find(*index_.table.load(std::memory_order_acquire), tag, equals);
+        id != INVALID_STRING) {
+        return id;
+    }
+    // Store the string first so the slot publishes a complete entry
+    StringId id = INVALID_STRING;
+    auto* chars = allocate_string(str.size(), id);
+    if (chars == nullptr) {
+        return INVALID_STRING;
+    }
+    if (!str.empty()) {
+        std::memcpy(chars, str.data(), str.size());
+    }
+    seal(id, chars - sizeof(std::uint32_t));
+    const StringId stored = publish(index_, tag, id, sizeof(std::uint32_t) + str.size(), equals);
+    if (stored == id) {
+        index_new(id);
+    }
+    return stored;
 }
 
 StringId StringPool::intern_wide(std::wstring_view wstr) {
-    if (wstr.empty()) {
-        return intern("");
-    }
-
-    // Convert wide string to UTF-8 with full Unicode support including surrogate pairs
-    std::string utf8;
-    utf8.reserve(wstr.size() * 3);  // Worst case: 3 bytes per BMP character
-
-    for (std::size_t i = 0; i < wstr.size(); ++i) {
-        const auto wc = static_cast<std::uint32_t>(wstr[i]);
-
-        // Check for high surrogate (0xD800-0xDBFF)
-        if (wc >= 0xD800 && wc <= 0xDBFF) {
-            // Need a low surrogate to follow
-            if (i + 1 < wstr.size()) {
-                const auto low = static_cast<std::uint32_t>(wstr[i + 1]);
-                // Check for low surrogate (0xDC00-0xDFFF)
-                if (low >= 0xDC00 && low <= 0xDFFF) {
-                    // Valid surrogate pair: decode to code point
-                    // code_point = 0x10000 + ((high - 0xD800) << 10) + (low - 0xDC00)
-                    const std::uint32_t code_point =
-                        0x10000 + ((wc - 0xD800) << 10) + (low - 0xDC00);
-                    ++i;  // Consume the low surrogate
-
-                    // Encode as 4-byte UTF-8: 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
-                    utf8.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
-                    utf8.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
-                    utf8.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
-                    utf8.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
-                    continue;
-                }
+    const InternScope scope(*this);
+    if (wstr.size() <= kWideChunk) {
+        // Typical path or key: one vectorized transcode onto the stack
+        std::array<char, kWideChunk * kMaxUtf8PerUnit> buffer;
+        return intern({buffer.data(), encode_utf8(wstr, buffer.data())});
+    }
+
+    // Long strings (script blocks) are hashed and compared chunk by chunk;
+    // nothing is stored unless the string is new
+    Utf8Hasher hasher;
+    for_each_utf8_chunk(wstr, [&hasher](std::string_view chunk) {
+        hasher.bytes(chunk);
+        return true;
+    });
+    const auto tag = hasher.tag();
+    const auto size = hasher.length();
+    const auto equals = [this, wstr, size](StringId id) {
+        if (is_path(id)) {
+            return false;
+        }
+        auto stored = raw(id);
+        if (stored.size() != size) {
+            return false;
+        }
+        return for_each_utf8_chunk(wstr, [&stored](std::string_view chunk) {
+            if (stored.substr(0, chunk.size()) != chunk) {
+                return false;
             }
-            // Unpaired high surrogate: replace with U+FFFD (replacement character)
-            utf8.push_back(static_cast<char>(0xEF));
-            utf8.push_back(static_cast<char>(0xBF));
-            utf8.push_back(static_cast<char>(0xBD));
-            continue;
+            stored.remove_prefix(chunk.size());
+            return true;
+        });
+    };
+
+    if (const auto id = find(*index_.table.load(std::memory_order_acquire), tag, equals);
+        id != INVALID_STRING) {
+        return id;
+    }
+    // Genuine miss: transcode straight into arena memory
+    StringId id = INVALID_STRING;
+    auto* chars = allocate_string(size, id);
+    if (chars == nullptr) {
+        return INVALID_STRING;
+    }
+    encode_utf8(wstr, reinterpret_cast<char*>(chars));
+    seal(id, chars - sizeof(std::uint32_t));
+    const StringId stored = publish(index_, tag, id, sizeof(std::uint32_t) + size, equals);
+    if (stored == id) {
+        index_new(id);
+    }
+    return stored;
+}
+
+StringId StringPool::intern_path(std::string_view path) {
+    const InternScope scope(*this);
+    DevicePathMap* devices = devices_.load(std::memory_order_acquire);
+    std::string_view dos;
+    const auto device = devices != nullptr ? devices->match(path, dos) : 0;
+    if (device == 0) {
+        return intern_components(path);
+    }
+    // Store the DOS form once; readers never translate again
+    const auto rest = path.substr(device);
+    const auto size = dos.size() + rest.size();
+    if (size > kWideChunk * kMaxUtf8PerUnit) {
+        std::string normalized(dos);
+        normalized += rest;
+        return intern_components(normalized);
+    }
+    std::array<char, kWideChunk * kMaxUtf8PerUnit> buffer;
+    std::copy(dos.begin(), dos.end(), buffer.begin());
+    std::copy(rest.begin(), rest.end(), buffer.begin() + static_cast<std::ptrdiff_t>(dos.size()));
+    return intern_components({buffer.data(), size});
+}
+
+void StringPool::set_device_paths(DevicePathMap* devices) noexcept {
+    devices_.store(devices, std::memory_order_release);
+}
+
+void StringPool::set_trigram_index(TrigramIndex* index) noexcept {
+    trigrams_.store(index, std::memory_order_release);
+}
+
+void StringPool::index_new(StringId id) {
+    TrigramIndex* trigrams = trigrams_.load(std::memory_order_acquire);
+    if (trigrams == nullptr) {
+        return;
+    }
+    std::string buffer;
+    trigrams->add(id, read(id, buffer));
+}
+
+StringId StringPool::intern_components(std::string_view path) {
+    if (path.empty()) {
+        return intern(path);
+    }
+    return append_components(INVALID_STRING, 0, path);
+}
+
+StringId StringPool::append_components(StringId node, std::size_t length,
+                                       std::string_view path) {
+    // Each component keeps its trailing separator, so resolving is plain
+    // concatenation and any spelling round-trips exactly
+    std::size_t begin = 0;
+    while (begin < path.size()) {
+        const auto sep = path.find_first_of("\\/", begin);
+        const auto end = sep == std::string_view::npos ? path.size() : sep + 1;
+        const StringId leaf = intern(path.substr(begin, end - begin));
+        if (leaf == INVALID_STRING) {
+            return INVALID_STRING;
+        }
+        node = intern_node(node, leaf, length + end);
+        if (node == INVALID_STRING) {
+            return INVALID_STRING;
         }
+        begin = end;
+    }
+    return node;
+}
 
-        // Check for unpaired low surrogate (0xDC00-0xDFFF)
-        if (wc >= 0xDC00 && wc <= 0xDFFF) {
-            // Unpaired low surrogate: replace with U+FFFD
-            utf8.push_back(static_cast<char>(0xEF));
-            utf8.push_back(static_cast<char>(0xBF));
-            utf8.push_back(static_cast<char>(0xBD));
-            continue;
+StringId StringPool::intern_path_below(StringId dir, std::string_view relative) {
+    const InternScope scope(*this);
+    if (!is_path(dir)) {
+        return intern_path(relative);
+    }
+    const auto first = relative.find_first_not_of("\\/");
+    if (first == std::string_view::npos) {
+        return dir;
+    }
+    relative.remove_prefix(first);
+
+    // A key is stored without a trailing separator; its directory form is
+    // the sibling node whose leaf has one
+    const PathNode& node = node_at(dir);
+    std::size_t length = node.header & ~kPathNode;
+    const auto leaf = raw(node.leaf);
+    if (leaf.empty() || (leaf.back() != '\\' && leaf.back() != '/')) {
+        std::array<char, kWideChunk * kMaxUtf8PerUnit> buffer;
+        if (leaf.size() >= buffer.size()) {
+            return INVALID_STRING;
+        }
+        std::copy(leaf.begin(), leaf.end(), buffer.begin());
+        buffer[leaf.size()] = '\\';
+        const StringId separated = intern({buffer.data(), leaf.size() + 1});
+        if (separated == INVALID_STRING) {
+            return INVALID_STRING;
         }
+        dir = intern_node(node.parent, separated, ++length);
+        if (dir == INVALID_STRING) {
+            return INVALID_STRING;
+        }
+    }
+    return append_components(dir, length, relative);
+}
 
-        // Regular BMP character encoding
-        if (wc < 0x80) {
-            utf8.push_back(static_cast<char>(wc));
-        } else if (wc < 0x800) {
-            utf8.push_back(static_cast<char>(0xC0 | (wc >> 6)));
-            utf8.push_back(static_cast<char>(0x80 | (wc & 0x3F)));
-        } else {
-            utf8.push_back(static_cast<char>(0xE0 | (wc >> 12)));
-            utf8.push_back(static_cast<char>(0x80 | ((wc >> 6) & 0x3F)));
-            utf8.push_back(static_cast<char>(0x80 | (wc & 0x3F)));
+StringId StringPool::intern_path_below(StringId dir, std::wstring_view relative) {
+    const InternScope scope(*this);
+    if (relative.size() <= kWideChunk) {
+        std::array<char, kWideChunk * kMaxUtf8PerUnit> buffer;
+        return intern_path_below(dir, {buffer.data(), encode_utf8(relative, buffer.data())});
+    }
+    return intern_path_below(dir, std::string_view(to_utf8(relative)));
+}
+
+StringId StringPool::intern_path_wide(std::wstring_view wpath) {
+    const InternScope scope(*this);
+    if (wpath.size() <= kWideChunk) {
+        std::array<char, kWideChunk * kMaxUtf8PerUnit> buffer;
+        return intern_path({buffer.data(), encode_utf8(wpath, buffer.data())});
+    }
+    return intern_path(to_utf8(wpath));
+}
+
+StringId StringPool::intern_node(StringId parent, StringId leaf, std::size_t length) {
+    // Node tags live in the same table; mix both ids apart from string tags
+    std::uint64_t key = (static_cast<std::uint64_t>(parent) << 32 | leaf) * 0x9E3779B97F4A7C15ULL;
+    const auto tag = static_cast<std::uint32_t>(key >> 32 ^ key);
+    const auto equals = [this, parent, leaf](StringId id) {
+        if (!is_path(id)) {
+            return false;
+        }
+        const PathNode& node = node_at(id);
+        return node.parent == parent && node.leaf == leaf;
+    };
+
+    if (const auto id = find(*index_.table.load(std::memory_order_acquire), tag, equals);
+        id != INVALID_STRING) {
+        return id;
+    }
+    if (length >= kPathNode) {
+        return INVALID_STRING;
+    }
+    PathNode* storage = nullptr;
+    StringId id = INVALID_STRING;
+    if (generations_ != nullptr) {
+        storage = reinterpret_cast<PathNode*>(allocate_block(sizeof(PathNode), id));
+    } else {
+        storage = arena_.allocate_local<PathNode>();
+        id = id_at(reinterpret_cast<const std::uint8_t*>(storage));
+    }
+    if (storage == nullptr || id == INVALID_STRING) {
+        return INVALID_STRING;
+    }
+    std::construct_at(storage, static_cast<std::uint32_t>(kPathNode | length), parent, leaf);
+    seal(id, reinterpret_cast<const std::uint8_t*>(storage));
+    const StringId stored = publish(index_, tag, id, sizeof(PathNode), equals);
+    if (stored == id) {
+        index_new(id);
+    }
+    return stored;
+}
+
+StringId StringPool::path_parent(StringId id) const noexcept {
+    return is_path(id) ? node_at(id).parent : INVALID_STRING;
+}
+
+StringId StringPool::path_leaf(StringId id) const noexcept {
+    return is_path(id) ? node_at(id).leaf : id;
+}
+
+bool StringPool::is_under(StringId path, StringId dir) const noexcept {
+    if (dir == INVALID_STRING || !is_path(dir)) {
+        return false;
+    }
+    for (StringId node = path; node != INVALID_STRING && is_path(node);
+         node = node_at(node).parent) {
+        if (node == dir) {
+            return true;
         }
     }
+    return false;
+}
+
+bool StringPool::is_path(StringId id) const noexcept {
+    return id != INVALID_STRING && (header(id) & kPathNode) != 0;
+}
+
+std::uint32_t StringPool::header(StringId id) const noexcept {
+    std::uint32_t value = 0;
+    std::memcpy(&value, entry(id), sizeof(value));
+    return value;
+}
+
+std::string_view StringPool::raw(StringId id) const noexcept {
+    const auto* storage = entry(id);
+    std::uint32_t size = 0;
+    std::memcpy(&size, storage, sizeof(size));
+    return {reinterpret_cast<const char*>(storage + sizeof(std::uint32_t)), size};
+}
+
+const StringPool::PathNode& StringPool::node_at(StringId id) const noexcept {
+    return *std::launder(reinterpret_cast<const PathNode*>(entry(id)));
+}
+
+std::string_view StringPool::resolve(StringId id) const noexcept {
+    const PathNode& node = node_at(id);
+    if (const auto cached = node.resolved.load(std::memory_order_acquire);
+        cached != INVALID_STRING) {
+        return raw(cached);
+    }
+
+    const std::size_t length = node.header & ~kPathNode;
+    StringId full = INVALID_STRING;
+    auto* chars = allocate_string(length, full);
+    if (chars == nullptr) {
+        return {};
+    }
+    assemble(id, reinterpret_cast<char*>(chars), length);
+    seal(full, chars - sizeof(std::uint32_t));
 
-    return intern(utf8);
+    // A racing resolve may win; its copy is the one every reader sees
+    StringId expected = INVALID_STRING;
+    if (node.resolved.compare_exchange_strong(expected, full, std::memory_order_acq_rel,
+                                              std::memory_order_acquire)) {
+        bytes_used_.fetch_add(sizeof(std::uint32_t) + length, std::memory_order_relaxed);
+        return raw(full);
+    }
+    return raw(expected);
+}
+
+void StringPool::assemble(StringId id, char* chars, std::size_t length) const noexcept {
+    // Fill from the leaf backwards; every node knows its full length
+    std::size_t end = length;
+    for (StringId at = id; at != INVALID_STRING; at = node_at(at).parent) {
+        const auto leaf = raw(node_at(at).leaf);
+        end -= leaf.size();
+        std::memcpy(chars + end, leaf.data(), leaf.size());
+    }
+}
+
+StringId StringPool::folded(StringId id) {
+    if (id == INVALID_STRING) {
+        return INVALID_STRING;
+    }
+    const InternScope scope(*this);
+    const auto tag = fold_tag(id);
+    const auto same_key = [](StringId) { return true; };
+    if (const auto cached = find(*folds_.table.load(std::memory_order_acquire), tag, same_key);
+        cached != INVALID_STRING) {
+        return cached;
+    }
+
+    StringId result = id;
+    if (is_path(id)) {
+        // Fold component by component; the full path is never resolved
+        const PathNode& node = node_at(id);
+        const StringId parent = folded(node.parent);
+        const StringId leaf = folded(node.leaf);
+        if ((node.parent != INVALID_STRING && parent == INVALID_STRING) ||
+            leaf == INVALID_STRING) {
+            return INVALID_STRING;
+        }
+        if (parent != node.parent || leaf != node.leaf) {
+            result = intern_node(parent, leaf, node.header & ~kPathNode);
+        }
+    } else if (const auto str = raw(id); std::any_of(str.begin(), str.end(), is_ascii_upper)) {
+        std::string lower(str);
+        for (auto& c : lower) {
+            if (is_ascii_upper(c)) {
+                c = static_cast<char>(c - 'A' + 'a');
+            }
+        }
+        result = intern(lower);
+    }
+    if (result == INVALID_STRING) {
+        return INVALID_STRING;
+    }
+    // Racing folds of one id agree: interning deduplicates the result
+    return publish(folds_, tag, result, 0, same_key);
+}
+
+bool StringPool::equals_icase(StringId a, StringId b) {
+    if (a == b) {
+        return true;
+    }
+    const StringId fa = folded(a);
+    return fa != INVALID_STRING && fa == folded(b);
 }
 
 std::string_view StringPool::get(StringId id) const noexcept {
     if (id == INVALID_STRING) {
         return {};
     }
+    return is_path(id) ? resolve(id) : raw(id);
+}
 
-    // ID = offset + 1, so offset = ID - 1
-    const auto* storage = arena_.base() + (id - 1);
-
-    std::uint32_t len = 0;
-    std::memcpy(&len, storage, sizeof(len));
+std::string_view StringPool::read(StringId id, std::string& buffer) const {
+    if (id == INVALID_STRING) {
+        return {};
+    }
+    if (!is_path(id)) {
+        return raw(id);
+    }
+    const PathNode& node = node_at(id);
+    if (const auto cached = node.resolved.load(std::memory_order_acquire);
+        cached != INVALID_STRING) {
+        return raw(cached);
+    }
+    buffer.resize(node.header & ~kPathNode);
+    assemble(id, buffer.data(), buffer.size());
+    return buffer;
+}
 
-    return {reinterpret_cast<const char*>(storage + sizeof(len)), len};
+bool StringPool::in_range(StringId id) const noexcept {
+    if (generations_ != nullptr) {
+        // Handed out and sealed; released IDs stay in range as ""
+        if (id == INVALID_STRING ||
+            id > generations_->next_handle.load(std::memory_order_acquire)) {
+            return false;
+        }
+        const Handle* const at = handle(id);
+        return at != nullptr && at->entry.load(std::memory_order_acquire) != nullptr;
+    }
+    const std::size_t used = arena_.used();
+    const std::size_t offset = static_cast<std::size_t>(id) - 1;
+    if (id == INVALID_STRING || offset + sizeof(std::uint32_t) > used) {
+        return false;
+    }
+    const std::uint32_t value = header(id);
+    const std::size_t size =
+        (value & kPathNode) != 0 ? sizeof(PathNode) : sizeof(std::uint32_t) + value;
+    return offset + size <= used;
 }
 
 std::size_t StringPool::count() const noexcept {
-    std::shared_lock lock(mutex_);
-    return strings_.size();
+    return index_.count.load(std::memory_order_relaxed);
 }
 
 std::size_t StringPool::bytes_used() const noexcept {
-    std::shared_lock lock(mutex_);
-    return bytes_used_;
+    return bytes_used_.load(std::memory_order_relaxed);
+}
+
+std::uint32_t StringPool::generation() const noexcept {
+    return generations_ != nullptr ? generations_->generation.load(std::memory_order_relaxed)
+                                   : 0;
+}
+
+StringMarks StringPool::marks() const {
+    return StringMarks(generations_ != nullptr
+                           ? static_cast<std::size_t>(
+                                 generations_->next_handle.load(std::memory_order_acquire))
+                           : 0);
+}
+
+StringPool::CompactStats StringPool::compact(const StringMarks& live) {
+    CompactStats stats;
+    if (generations_ == nullptr) {
+        return stats;
+    }
+    Generations& generations = *generations_;
+    std::lock_guard exclusive(generations.compact_mutex);
+
+    // Close the gate, then wait for the interns in flight
+    generations.compacting.store(true, std::memory_order_seq_cst);
+    while (generations.interns.load(std::memory_order_seq_cst) != 0) {
+        std::this_thread::yield();
+    }
+
+    const auto closing = generations.generation.load(std::memory_order_relaxed);
+    stats.generation = closing + 1;
+    generations.generation.store(stats.generation, std::memory_order_relaxed);
+
+    // Every block so far is emptied; copies go to fresh ones
+    std::vector<std::unique_ptr<Block>> emptied;
+    {
+        std::lock_guard lock(generations.mutex);
+        emptied.swap(generations.blocks);
+        generations.current.store(nullptr, std::memory_order_release);
+    }
+
+    // Only resolve() allocates past this point, and its entries are new
+    const auto handed_out = static_cast<std::size_t>(
+        (std::min)(generations.next_handle.load(std::memory_order_acquire),
+                   std::uint64_t{(std::numeric_limits<StringId>::max)()}));
+    std::vector<std::uint64_t> keep((handed_out + 63) / 64);
+    const auto kept = [&keep, handed_out](StringId id) {
+        const std::size_t bit = static_cast<std::size_t>(id) - 1;
+        return id != INVALID_STRING && bit < handed_out && (keep[bit / 64] >> (bit % 64) & 1) != 0;
+    };
+    const auto mark = [&keep, handed_out](StringId id) {
+        const std::size_t bit = static_cast<std::size_t>(id) - 1;
+        if (id != INVALID_STRING && bit < handed_out) {
+            keep[bit / 64] |= std::uint64_t{1} << (bit % 64);
+        }
+    };
+
+    // A node's parent and leaf are older than the node, so one descending
+    // pass carries every kept node's references down
+    for (std::size_t index = handed_out; index-- > 0;) {
+        const auto id = static_cast<StringId>(index + 1);
+        const Handle* const at = handle(id);
+        const std::uint8_t* storage =
+            at != nullptr ? at->entry.load(std::memory_order_acquire) : nullptr;
+        if (storage == nullptr || storage == kReleased) {
+            continue;
+        }
+        if (!kept(id) && !live.marked(id) &&
+            at->touched.load(std::memory_order_relaxed) < closing) {
+            continue;
+        }
+        mark(id);
+        if (is_path(id)) {
+            const PathNode& node = node_at(id);
+            mark(node.parent);
+            mark(node.leaf);
+            mark(node.resolved.load(std::memory_order_acquire));
+        }
+    }
+
+    // Copy the kept entries forward; IDs stay, only the handles move
+    std::size_t bytes_kept = 0;
+    for (std::size_t index = 0; index < handed_out; ++index) {
+        const auto id = static_cast<StringId>(index + 1);
+        Handle* const at = handle(id);
+        const std::uint8_t* storage =
+            at != nullptr ? at->entry.load(std::memory_order_acquire) : nullptr;
+        if (storage == nullptr || storage == kReleased) {
+            continue;
+        }
+        if (!kept(id)) {
+            at->entry.store(kReleased, std::memory_order_release);
+            ++stats.released;
+            continue;
+        }
+        const std::size_t size = entry_size(storage);
+        auto* copy = allocate_bytes((size + 3) & ~std::size_t{3});
+        if (copy == nullptr) {
+            continue;  // Out of memory: the entry stays where it is
+        }
+        if (is_path(id)) {
+            const PathNode& node = node_at(id);
+            auto* moved = std::construct_at(reinterpret_cast<PathNode*>(copy), node.header,
+                                            node.parent, node.leaf);
+            moved->resolved.store(node.resolved.load(std::memory_order_acquire),
+                                  std::memory_order_relaxed);
+        } else {
+            std::memcpy(copy, storage, size);
+        }
+        at->entry.store(copy, std::memory_order_release);
+        bytes_kept += size;
+        ++stats.kept;
+    }
+    stats.bytes_kept = bytes_kept;
+
+    // Rebuild the index over the kept entries; folds are recomputed on demand
+    {
+        const Table& full = *index_.table.load(std::memory_order_acquire);
+        std::vector<std::uint64_t> entries;
+        for (std::size_t i = 0; i <= full.mask; ++i) {
+            const auto slot = full.slots[i].load(std::memory_order_relaxed);
+            if (slot != 0 && kept(id_of(slot))) {
+                entries.push_back(slot);
+            }
+        }
+        auto next = std::make_unique<Table>(
+            round_up_pow2((std::max)(entries.size(), std::size_t{8}) * 4));
+        for (const auto slot : entries) {
+            auto pos = tag_of_entry(slot) & next->mask;
+            while (next->slots[pos].load(std::memory_order_relaxed) != 0) {
+                pos = (pos + 1) & next->mask;
+            }
+            next->slots[pos].store(slot, std::memory_order_relaxed);
+        }
+        std::lock_guard lock(index_.grow_mutex);
+        index_.table.store(next.get(), std::memory_order_release);
+        index_.tables.clear();
+        index_.tables.push_back(std::move(next));
+        index_.count.store(entries.size(), std::memory_order_relaxed);
+    }
+    {
+        auto empty = std::make_unique<Table>(round_up_pow2(std::size_t{8} * 2));
+        std::lock_guard lock(folds_.grow_mutex);
+        folds_.table.store(empty.get(), std::memory_order_release);
+        folds_.tables.clear();
+        folds_.tables.push_back(std::move(empty));
+        folds_.count.store(0, std::memory_order_relaxed);
+    }
+    bytes_used_.store(bytes_kept, std::memory_order_relaxed);
+
+    // Views into the previous compaction's blocks have had a generation to go
+    stats.blocks_freed = generations.retired.size();
+    generations.retired = std::move(emptied);
+
+    generations.compacting.store(false, std::memory_order_seq_cst);
+    return stats;
 }
 
 }  // namespace exeray::event
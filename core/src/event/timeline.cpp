@@ -0,0 +1,93 @@
+/// @file timeline.cpp
+/// @brief Per-second event histogram (platform independent).
+
+#include "exeray/event/timeline.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace exeray::event {
+
+EventTimeline::EventTimeline(std::size_t seconds)
+    : slots_(std::make_unique<Slot[]>((std::max)(seconds, std::size_t{1}))),
+      size_((std::max)(seconds, std::size_t{1})) {}
+
+EventTimeline::Slot* EventTimeline::claim(std::uint64_t second) noexcept {
+    Slot& slot = slots_[second % size_];
+    std::uint64_t seen = slot.second.load(std::memory_order_acquire);
+    while (seen != second) {
+        if (seen == kClearing) {
+            std::this_thread::yield();
+            seen = slot.second.load(std::memory_order_acquire);
+            continue;
+        }
+        if (seen != kEmpty && seen > second) {
+            return nullptr;  // Older than the window
+        }
+        if (slot.second.compare_exchange_weak(seen, kClearing, std::memory_order_acquire,
+                                              std::memory_order_acquire)) {
+            for (auto& count : slot.counts) {
+                count.store(0, std::memory_order_relaxed);
+            }
+            slot.suspicious.store(0, std::memory_order_relaxed);
+            slot.second.store(second, std::memory_order_release);
+            break;
+        }
+    }
+
+    std::uint64_t latest = latest_.load(std::memory_order_relaxed);
+    while ((latest == kEmpty || latest < second) &&
+           !latest_.compare_exchange_weak(latest, second, std::memory_order_release,
+                                          std::memory_order_relaxed)) {
+    }
+    return &slot;
+}
+
+void EventTimeline::add(Timestamp ts, Category cat, bool suspicious) noexcept {
+    const auto c = static_cast<std::size_t>(cat);
+    if (c >= TimelineBucket::kCategoryCount) {
+        return;
+    }
+    Slot* slot = claim(ts / kBucketNs);
+    if (slot == nullptr) {
+        return;
+    }
+    slot->counts[c].fetch_add(1, std::memory_order_relaxed);
+    if (suspicious) {
+        slot->suspicious.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void EventTimeline::flag(Timestamp ts) noexcept {
+    if (Slot* slot = claim(ts / kBucketNs); slot != nullptr) {
+        slot->suspicious.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::size_t EventTimeline::read(std::span<TimelineBucket> out) const noexcept {
+    const std::uint64_t latest = latest_.load(std::memory_order_acquire);
+    if (latest == kEmpty) {
+        return 0;
+    }
+    std::size_t n = (std::min)(out.size(), size_);
+    n = static_cast<std::size_t>((std::min)(static_cast<std::uint64_t>(n), latest + 1));
+    const std::uint64_t first = latest + 1 - n;
+
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::uint64_t second = first + i;
+        const Slot& slot = slots_[second % size_];
+        TimelineBucket& bucket = out[i];
+        bucket = TimelineBucket{};
+        bucket.start = second * kBucketNs;
+        if (slot.second.load(std::memory_order_acquire) != second) {
+            continue;
+        }
+        for (std::size_t c = 0; c < bucket.counts.size(); ++c) {
+            bucket.counts[c] = slot.counts[c].load(std::memory_order_relaxed);
+        }
+        bucket.suspicious = slot.suspicious.load(std::memory_order_relaxed);
+    }
+    return n;
+}
+
+}  // namespace exeray::event
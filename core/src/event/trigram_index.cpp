@@ -0,0 +1,125 @@
+/// @file trigram_index.cpp
+/// @brief Trigram substring index over interned strings (platform independent).
+
+#include "exeray/event/trigram_index.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <utility>
+
+#include "exeray/etw/text_search.hpp"
+#include "exeray/event/string_pool.hpp"
+
+namespace exeray::event {
+
+namespace {
+
+constexpr std::size_t kGram = 3;
+
+constexpr std::uint8_t fold(char c) noexcept {
+    const auto byte = static_cast<std::uint8_t>(c);
+    return (byte >= 'A' && byte <= 'Z') ? static_cast<std::uint8_t>(byte - 'A' + 'a') : byte;
+}
+
+/// @brief Distinct folded trigrams of text, sorted.
+std::vector<std::uint32_t> trigrams(std::string_view text) {
+    std::vector<std::uint32_t> grams;
+    if (text.size() < kGram) {
+        return grams;
+    }
+    grams.reserve(text.size() - kGram + 1);
+    std::uint32_t gram = static_cast<std::uint32_t>(fold(text[0])) << 8 | fold(text[1]);
+    for (std::size_t i = kGram - 1; i < text.size(); ++i) {
+        gram = (gram << 8 | fold(text[i])) & 0xFFFFFF;
+        grams.push_back(gram);
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+std::size_t shard_of(std::uint32_t gram) noexcept {
+    return (gram * 0x9E3779B1U) >> 28;
+}
+
+}  // namespace
+
+void TrigramIndex::add(StringId id, std::string_view text) {
+    if (id == INVALID_STRING) {
+        return;
+    }
+    {
+        const std::lock_guard lock(all_mutex_);
+        all_.push_back(id);
+    }
+    const auto grams = trigrams(text);
+    for (const std::uint32_t gram : grams) {
+        Shard& shard = shards_[shard_of(gram)];
+        const std::lock_guard lock(shard.mutex);
+        shard.lists[gram].push_back(id);
+    }
+    postings_.fetch_add(grams.size(), std::memory_order_relaxed);
+}
+
+std::vector<StringId> TrigramIndex::candidates(std::string_view needle) const {
+    const auto grams = trigrams(needle);
+    if (grams.empty()) {
+        const std::lock_guard lock(all_mutex_);
+        std::vector<StringId> all = all_;
+        std::sort(all.begin(), all.end());
+        return all;
+    }
+
+    // Copy each list out of its shard, then intersect smallest first
+    std::vector<std::vector<StringId>> lists;
+    lists.reserve(grams.size());
+    for (const std::uint32_t gram : grams) {
+        const Shard& shard = shards_[shard_of(gram)];
+        const std::lock_guard lock(shard.mutex);
+        const auto it = shard.lists.find(gram);
+        if (it == shard.lists.end()) {
+            return {};
+        }
+        lists.push_back(it->second);
+    }
+    std::sort(lists.begin(), lists.end(),
+              [](const auto& a, const auto& b) { return a.size() < b.size(); });
+
+    // Concurrent adds append out of order; sort before intersecting
+    std::vector<StringId> result = std::move(lists.front());
+    std::sort(result.begin(), result.end());
+    std::vector<StringId> next;
+    for (std::size_t i = 1; i < lists.size() && !result.empty(); ++i) {
+        std::sort(lists[i].begin(), lists[i].end());
+        next.clear();
+        std::set_intersection(result.begin(), result.end(), lists[i].begin(), lists[i].end(),
+                              std::back_inserter(next));
+        result.swap(next);
+    }
+    return result;
+}
+
+std::size_t TrigramIndex::search(const StringPool& pool, std::string_view needle,
+                                 std::vector<StringId>& out, std::size_t limit) const {
+    std::size_t found = 0;
+    std::string buffer;
+    for (const StringId id : candidates(needle)) {
+        if (found == limit) {
+            break;
+        }
+        const std::string_view text = pool.read(id, buffer);
+        if (needle.empty() || etw::contains_icase(text, needle)) {
+            out.push_back(id);
+            ++found;
+        }
+    }
+    return found;
+}
+
+std::size_t TrigramIndex::size() const {
+    const std::lock_guard lock(all_mutex_);
+    return all_.size();
+}
+
+}  // namespace exeray::event
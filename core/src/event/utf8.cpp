@@ -0,0 +1,230 @@
+#include "exeray/event/utf8.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EXERAY_UTF8_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace exeray::event {
+
+namespace {
+
+/// Code units handled by the scalar encoder before retrying the kernel.
+constexpr std::size_t kScalarRun = 16;
+
+constexpr bool is_high_surrogate(std::uint32_t wc) noexcept {
+    return wc >= 0xD800 && wc <= 0xDBFF;
+}
+
+constexpr bool is_low_surrogate(std::uint32_t wc) noexcept {
+    return wc >= 0xDC00 && wc <= 0xDFFF;
+}
+
+#if defined(__AVX2__)
+
+/// @brief Load 32 code units; false if any of them is not ASCII.
+bool load_ascii32(const wchar_t* src, __m256i& narrow) noexcept {
+    const auto* p = reinterpret_cast<const __m256i*>(src);
+    if constexpr (sizeof(wchar_t) == 2) {
+        const __m256i a = _mm256_loadu_si256(p);
+        const __m256i b = _mm256_loadu_si256(p + 1);
+        if (!_mm256_testz_si256(_mm256_or_si256(a, b),
+                                _mm256_set1_epi16(static_cast<short>(0xFF80)))) {
+            return false;
+        }
+        // Packing works per 128-bit lane; restore the qword order
+        narrow = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+    } else {
+        const __m256i a = _mm256_loadu_si256(p);
+        const __m256i b = _mm256_loadu_si256(p + 1);
+        const __m256i c = _mm256_loadu_si256(p + 2);
+        const __m256i d = _mm256_loadu_si256(p + 3);
+        const __m256i all = _mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d));
+        if (!_mm256_testz_si256(all, _mm256_set1_epi32(static_cast<int>(0xFFFFFF80)))) {
+            return false;
+        }
+        const __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(a, b),
+                                                   _mm256_packs_epi32(c, d));
+        narrow = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+    }
+    return true;
+}
+
+#elif defined(EXERAY_UTF8_SSE2)
+
+/// @brief Load 16 code units; false if any of them is not ASCII.
+bool load_ascii16(const wchar_t* src, __m128i& narrow) noexcept {
+    const auto* p = reinterpret_cast<const __m128i*>(src);
+    const __m128i zero = _mm_setzero_si128();
+    if constexpr (sizeof(wchar_t) == 2) {
+        const __m128i a = _mm_loadu_si128(p);
+        const __m128i b = _mm_loadu_si128(p + 1);
+        const __m128i high = _mm_and_si128(_mm_or_si128(a, b),
+                                           _mm_set1_epi16(static_cast<short>(0xFF80)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xFFFF) {
+            return false;
+        }
+        narrow = _mm_packus_epi16(a, b);
+    } else {
+        const __m128i a = _mm_loadu_si128(p);
+        const __m128i b = _mm_loadu_si128(p + 1);
+        const __m128i c = _mm_loadu_si128(p + 2);
+        const __m128i d = _mm_loadu_si128(p + 3);
+        const __m128i all = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+        const __m128i high = _mm_and_si128(all, _mm_set1_epi32(static_cast<int>(0xFFFFFF80)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, zero)) != 0xFFFF) {
+            return false;
+        }
+        narrow = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+    }
+    return true;
+}
+
+#endif
+
+/**
+ * @brief Narrow the leading all-ASCII blocks of src.
+ * @param out Destination, or nullptr to only count.
+ * @return Code units consumed (a multiple of the block size).
+ */
+std::size_t ascii_blocks(const wchar_t* src, std::size_t size, char* out) noexcept {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    __m256i narrow;
+    for (; i + 32 <= size && load_ascii32(src + i, narrow); i += 32) {
+        if (out != nullptr) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), narrow);
+        }
+    }
+#elif defined(EXERAY_UTF8_SSE2)
+    __m128i narrow;
+    for (; i + 16 <= size && load_ascii16(src + i, narrow); i += 16) {
+        if (out != nullptr) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), narrow);
+        }
+    }
+#else
+    (void)src;
+    (void)size;
+    (void)out;
+#endif
+    return i;
+}
+
+/**
+ * @brief Encode the code point at src[i] (one unit, or a surrogate pair).
+ * @param out Destination for up to 4 bytes.
+ * @return Bytes written; i is advanced past the consumed units.
+ */
+std::size_t encode_one(const wchar_t* src, std::size_t size, std::size_t& i,
+                       char* out) noexcept {
+    const auto emit = [out](std::size_t at, std::uint32_t value) {
+        out[at] = static_cast<char>(static_cast<std::uint8_t>(value));
+    };
+    const auto wc = static_cast<std::uint32_t>(src[i++]);
+    if (wc < 0x80) {
+        emit(0, wc);
+        return 1;
+    }
+    if (wc < 0x800) {
+        emit(0, 0xC0 | (wc >> 6));
+        emit(1, 0x80 | (wc & 0x3F));
+        return 2;
+    }
+    if (is_high_surrogate(wc) && i < size) {
+        const auto low = static_cast<std::uint32_t>(src[i]);
+        if (is_low_surrogate(low)) {
+            // code_point = 0x10000 + ((high - 0xD800) << 10) + (low - 0xDC00)
+            const std::uint32_t code_point = 0x10000 + ((wc - 0xD800) << 10) + (low - 0xDC00);
+            ++i;  // Consume the low surrogate
+
+            // 4-byte UTF-8: 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
+            emit(0, 0xF0 | (code_point >> 18));
+            emit(1, 0x80 | ((code_point >> 12) & 0x3F));
+            emit(2, 0x80 | ((code_point >> 6) & 0x3F));
+            emit(3, 0x80 | (code_point & 0x3F));
+            return 4;
+        }
+    }
+    if (is_high_surrogate(wc) || is_low_surrogate(wc)) {
+        // Unpaired surrogate: U+FFFD (replacement character)
+        emit(0, 0xEF);
+        emit(1, 0xBF);
+        emit(2, 0xBD);
+        return 3;
+    }
+    emit(0, 0xE0 | (wc >> 12));
+    emit(1, 0x80 | ((wc >> 6) & 0x3F));
+    emit(2, 0x80 | (wc & 0x3F));
+    return 3;
+}
+
+/// @brief encode_one() without writing.
+std::size_t length_one(const wchar_t* src, std::size_t size, std::size_t& i) noexcept {
+    const auto wc = static_cast<std::uint32_t>(src[i++]);
+    if (wc < 0x80) {
+        return 1;
+    }
+    if (wc < 0x800) {
+        return 2;
+    }
+    if (is_high_surrogate(wc) && i < size && is_low_surrogate(static_cast<std::uint32_t>(src[i]))) {
+        ++i;
+        return 4;
+    }
+    return 3;
+}
+
+}  // namespace
+
+std::size_t utf8_length(std::wstring_view wstr) noexcept {
+    const wchar_t* src = wstr.data();
+    const std::size_t size = wstr.size();
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < size;) {
+        const auto ascii = ascii_blocks(src + i, size - i, nullptr);
+        i += ascii;
+        bytes += ascii;
+        for (const auto end = (std::min)(size, i + kScalarRun); i < end;) {
+            bytes += length_one(src, size, i);
+        }
+    }
+    return bytes;
+}
+
+std::size_t encode_utf8(std::wstring_view wstr, char* out) noexcept {
+    const wchar_t* src = wstr.data();
+    const std::size_t size = wstr.size();
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < size;) {
+        const auto ascii = ascii_blocks(src + i, size - i, out + bytes);
+        i += ascii;
+        bytes += ascii;
+        // Non-ASCII run (or a tail shorter than a block)
+        for (const auto end = (std::min)(size, i + kScalarRun); i < end;) {
+            bytes += encode_one(src, size, i, out + bytes);
+        }
+    }
+    return bytes;
+}
+
+std::string to_utf8(std::wstring_view wstr) {
+    std::string result(utf8_length(wstr), '\0');
+    encode_utf8(wstr, result.data());
+    return result;
+}
+
+bool utf8_kernels_vectorized() noexcept {
+#if defined(__AVX2__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+}  // namespace exeray::event
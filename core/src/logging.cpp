@@ -7,7 +7,10 @@
 #include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -41,10 +44,88 @@ std::once_flag g_default_init_flag;
 /// Flag to track if custom init was called (for shutdown)
 std::atomic<bool> g_initialized{false};
 
+/// Flood filter shared by the default and the async logger
+struct {
+    std::mutex mutex;
+    FloodFilter filter;  ///< Guarded by mutex
+} g_flood;
+
+/// @brief Logger that passes messages through g_flood before its sinks.
+///
+/// init() gives it one AsyncForwardSink, so the filter runs on the calling
+/// thread, before the async queue.
+class FloodGuardedLogger final : public spdlog::logger {
+public:
+    using spdlog::logger::logger;
+
+protected:
+    void sink_it_(const spdlog::details::log_msg& msg) override {
+        FloodFilter::Verdict verdict;
+        {
+            std::lock_guard lock(g_flood.mutex);
+            verdict = g_flood.filter.check(
+                msg.level, std::string_view(msg.payload.data(), msg.payload.size()),
+                FloodFilter::Clock::now());
+        }
+        if (verdict.repeat) {
+            log_repeat(*verdict.repeat);
+        }
+        if (!verdict.emit) {
+            return;
+        }
+        if (verdict.dropped != 0) {
+            log_text(spdlog::level::warn,
+                     fmt::format("{} messages dropped (log rate limit)", verdict.dropped));
+        }
+        spdlog::logger::sink_it_(msg);
+    }
+
+    void flush_() override {
+        std::vector<FloodFilter::Repeat> repeats;
+        {
+            std::lock_guard lock(g_flood.mutex);
+            repeats = g_flood.filter.flush_repeats();
+        }
+        for (const FloodFilter::Repeat& repeat : repeats) {
+            log_repeat(repeat);
+        }
+        spdlog::logger::flush_();
+    }
+
+private:
+    void log_repeat(const FloodFilter::Repeat& repeat) {
+        log_text(repeat.level, fmt::format("{} (repeated {} times)", repeat.message, repeat.count));
+    }
+
+    void log_text(spdlog::level::level_enum level, const std::string& text) {
+        spdlog::logger::sink_it_(spdlog::details::log_msg(spdlog::source_loc{}, this->name(), level, text));
+    }
+};
+
+/// @brief Sink that hands messages to an async logger (formatting is done there).
+class AsyncForwardSink final : public spdlog::sinks::sink {
+public:
+    explicit AsyncForwardSink(std::shared_ptr<spdlog::async_logger> async)
+        : async_(std::move(async)) {}
+
+    void log(const spdlog::details::log_msg& msg) override {
+        async_->log(msg.time, msg.source, msg.level, msg.payload);
+    }
+    void flush() override { async_->flush(); }
+    void set_pattern(const std::string& pattern) override { async_->set_pattern(pattern); }
+    void set_formatter(std::unique_ptr<spdlog::formatter> formatter) override {
+        async_->set_formatter(std::move(formatter));
+    }
+
+private:
+    std::shared_ptr<spdlog::async_logger> async_;
+};
+
 /// Create a default synchronous stderr logger
 std::shared_ptr<spdlog::logger> create_default_logger() {
     auto console_sink = std::make_shared<spdlog::sinks::stderr_color_sink_mt>();
-    auto logger = std::make_shared<spdlog::logger>(kLoggerName, console_sink);
+    auto logger =
+        std::make_shared<FloodGuardedLogger>(kLoggerName, console_sink);
     logger->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] [%n] %v");
     logger->set_level(spdlog::level::info);
     return logger;
@@ -81,20 +162,25 @@ void init(spdlog::level::level_enum level, const std::string& log_file) {
         }
         
         // Create async logger with all sinks
-        g_logger = std::make_shared<spdlog::async_logger>(
+        auto async = std::make_shared<spdlog::async_logger>(
             kLoggerName,
             sinks.begin(),
             sinks.end(),
             spdlog::thread_pool(),
             spdlog::async_overflow_policy::block);
-        
+        async->set_level(level);
+
+        // Flush on warning and above for important messages
+        async->flush_on(spdlog::level::warn);
+
+        // Filter floods before they reach the queue
+        g_logger = std::make_shared<FloodGuardedLogger>(
+            kLoggerName, std::make_shared<AsyncForwardSink>(std::move(async)));
+
         // Set format: [timestamp] [level] [logger] message
         g_logger->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] [%n] %v");
         g_logger->set_level(level);
         
-        // Flush on warning and above for important messages
-        g_logger->flush_on(spdlog::level::warn);
-        
         // Register logger globally
         spdlog::register_logger(g_logger);
         
@@ -116,10 +202,104 @@ spdlog::logger& get() {
 
 void shutdown() {
     if (g_initialized.load(std::memory_order_acquire)) {
+        g_logger->flush();  // Reports held-back repeats
         spdlog::shutdown();
         g_logger.reset();
         g_initialized.store(false, std::memory_order_release);
     }
 }
 
+std::uint64_t RateLimit::acquire() noexcept {
+    const std::int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+                                 std::chrono::steady_clock::now().time_since_epoch())
+                                 .count();
+    std::int64_t window = window_.load(std::memory_order_relaxed);
+    if (window != now && window_.compare_exchange_strong(window, now,
+                                                         std::memory_order_relaxed)) {
+        used_.store(0, std::memory_order_relaxed);
+    }
+    if (used_.fetch_add(1, std::memory_order_relaxed) < per_second_) {
+        return 1 + dropped_.exchange(0, std::memory_order_relaxed);
+    }
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return 0;
+}
+
+FloodStats flood_stats() noexcept {
+    std::lock_guard lock(g_flood.mutex);
+    return g_flood.filter.stats();
+}
+
+void reset_flood_filter() {
+    std::lock_guard lock(g_flood.mutex);
+    g_flood.filter = FloodFilter{};
+}
+
+FloodFilter::FloodFilter(const Limits& limits) : limits_(limits), tokens_(limits.burst) {}
+
+std::optional<FloodFilter::Repeat> FloodFilter::take_repeats(Slot& slot) {
+    if (slot.repeats == 0) {
+        return std::nullopt;
+    }
+    Repeat repeat{slot.level, slot.message, slot.repeats};
+    slot.repeats = 0;
+    return repeat;
+}
+
+FloodFilter::Verdict FloodFilter::check(spdlog::level::level_enum level,
+                                        std::string_view message, Clock::time_point now) {
+    Verdict verdict;
+    if (level >= spdlog::level::critical) {
+        verdict.emit = true;
+        return verdict;
+    }
+
+    const std::uint64_t hash =
+        std::hash<std::string_view>{}(message) * 31 + static_cast<std::uint64_t>(level);
+    Slot& slot = slots_[hash % kSlots];
+    if (slot.level == level && slot.hash == hash && slot.message == message) {
+        if (now - slot.logged < limits_.repeat_window) {
+            ++slot.repeats;
+            ++stats_.repeated;
+            return verdict;
+        }
+        verdict.repeat = take_repeats(slot);
+    } else {
+        if (slot.level != spdlog::level::off) {
+            verdict.repeat = take_repeats(slot);
+        }
+        slot.hash = hash;
+        slot.level = level;
+        slot.message.assign(message);
+        slot.repeats = 0;
+    }
+    slot.logged = now;
+
+    if (refilled_ != Clock::time_point{}) {
+        const double elapsed = std::chrono::duration<double>(now - refilled_).count();
+        tokens_ = (std::min)(limits_.burst, tokens_ + elapsed * limits_.per_second);
+    }
+    refilled_ = now;
+    if (tokens_ < 1.0) {
+        ++dropped_;
+        ++stats_.dropped;
+        return verdict;
+    }
+    tokens_ -= 1.0;
+    verdict.emit = true;
+    verdict.dropped = dropped_;
+    dropped_ = 0;
+    return verdict;
+}
+
+std::vector<FloodFilter::Repeat> FloodFilter::flush_repeats() {
+    std::vector<Repeat> repeats;
+    for (Slot& slot : slots_) {
+        if (auto repeat = take_repeats(slot)) {
+            repeats.push_back(std::move(*repeat));
+        }
+    }
+    return repeats;
+}
+
 }  // namespace exeray::log
@@ -0,0 +1,359 @@
+/// @file metrics.cpp
+/// @brief MetricsRegistry implementation and text exposition.
+
+#include "exeray/metrics.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+
+namespace exeray {
+
+namespace {
+
+/// @brief Counter written by one thread, read by any.
+///
+/// A plain load and store instead of fetch_add: the owner is the only
+/// writer, so no locked instruction is needed on the hot path.
+struct Cell {
+    std::atomic<std::uint64_t> value{0};
+
+    void add(std::uint64_t n) noexcept {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::uint64_t get() const noexcept {
+        return value.load(std::memory_order_relaxed);
+    }
+};
+
+std::atomic<std::uint64_t> next_serial{1};
+
+/// @brief Value as Prometheus expects it (integers without exponent).
+std::string format_value(double value) {
+    if (std::isnan(value)) {
+        return "NaN";
+    }
+    if (std::isinf(value)) {
+        return value > 0 ? "+Inf" : "-Inf";
+    }
+    char text[32];
+    if (value == std::floor(value) && std::fabs(value) < 9007199254740992.0) {
+        std::snprintf(text, sizeof(text), "%lld", static_cast<long long>(value));
+    } else {
+        std::snprintf(text, sizeof(text), "%.17g", value);
+    }
+    return text;
+}
+
+/// @brief HELP text with backslashes and line breaks escaped.
+std::string escape_help(std::string_view help) {
+    std::string out;
+    out.reserve(help.size());
+    for (const char c : help) {
+        if (c == '\\') {
+            out += "\\\\";
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+/// @brief name{labels,extra} (braces omitted when both are empty).
+std::string series(std::string_view name, std::string_view labels, std::string_view extra = {}) {
+    std::string out(name);
+    if (labels.empty() && extra.empty()) {
+        return out;
+    }
+    out += '{';
+    out += labels;
+    if (!labels.empty() && !extra.empty()) {
+        out += ',';
+    }
+    out += extra;
+    out += '}';
+    return out;
+}
+
+}  // namespace
+
+struct MetricsRegistry::Shard {
+    std::array<Cell, kMaxCounters> counters;
+    std::array<std::array<Cell, kHistogramBuckets>, kMaxHistograms> buckets;
+    std::array<Cell, kMaxHistograms> sums;
+};
+
+struct MetricsRegistry::Shards {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Shard>> all;  ///< Guarded by mutex
+    std::vector<Shard*> free;                 ///< Guarded by mutex
+
+    Shard* acquire() {
+        std::lock_guard lock(mutex);
+        if (!free.empty()) {
+            Shard* shard = free.back();
+            free.pop_back();
+            return shard;
+        }
+        all.push_back(std::make_unique<Shard>());
+        return all.back().get();
+    }
+
+    void release(Shard* shard) {
+        std::lock_guard lock(mutex);
+        free.push_back(shard);
+    }
+};
+
+/// @brief Shards of the calling thread, one per registry it updated.
+///
+/// Returns them to registries still alive when the thread exits.
+struct MetricsThreadCache {
+    struct Entry {
+        std::uint64_t serial;
+        std::weak_ptr<MetricsRegistry::Shards> owner;
+        MetricsRegistry::Shard* shard;
+    };
+
+    std::vector<Entry> entries;
+
+    ~MetricsThreadCache() {
+        for (const Entry& entry : entries) {
+            if (const auto owner = entry.owner.lock()) {
+                try {
+                    owner->release(entry.shard);
+                } catch (...) {
+                    // Out of memory: the shard stays counted but is not reused
+                }
+            }
+        }
+    }
+};
+
+namespace {
+
+thread_local MetricsThreadCache thread_cache;
+
+}  // namespace
+
+std::string metric_label(std::string_view key, std::string_view value) {
+    std::string out(key);
+    out += "=\"";
+    for (const char c : value) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+    return out;
+}
+
+MetricsRegistry::MetricsRegistry()
+    : serial_(next_serial.fetch_add(1, std::memory_order_relaxed)),
+      shards_(std::make_shared<Shards>()) {}
+
+MetricsRegistry::~MetricsRegistry() = default;
+
+MetricsRegistry::Id MetricsRegistry::add_descriptor(std::vector<Descriptor>& table,
+                                                   std::size_t limit, std::string_view name,
+                                                   std::string_view help,
+                                                   std::string_view labels) {
+    std::lock_guard lock(mutex_);
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        if (table[i].name == name && table[i].labels == labels) {
+            return static_cast<Id>(i);
+        }
+    }
+    if (table.size() >= limit) {
+        return kInvalid;
+    }
+    table.push_back(Descriptor{std::string(name), std::string(help), std::string(labels)});
+    return static_cast<Id>(table.size() - 1);
+}
+
+MetricsRegistry::Id MetricsRegistry::counter(std::string_view name, std::string_view help,
+                                             std::string_view labels) {
+    return add_descriptor(counters_, kMaxCounters, name, help, labels);
+}
+
+MetricsRegistry::Id MetricsRegistry::gauge(std::string_view name, std::string_view help,
+                                           std::string_view labels) {
+    return add_descriptor(gauge_info_, kMaxGauges, name, help, labels);
+}
+
+MetricsRegistry::Id MetricsRegistry::histogram(std::string_view name, std::string_view help,
+                                               std::string_view labels) {
+    return add_descriptor(histograms_, kMaxHistograms, name, help, labels);
+}
+
+void MetricsRegistry::add_collector(Collector collector) {
+    std::lock_guard lock(mutex_);
+    collectors_.push_back(std::move(collector));
+}
+
+MetricsRegistry::Shard* MetricsRegistry::local() noexcept {
+    std::vector<MetricsThreadCache::Entry>& entries = thread_cache.entries;
+    for (const MetricsThreadCache::Entry& entry : entries) {
+        if (entry.serial == serial_) {
+            return entry.shard;
+        }
+    }
+    try {
+        // Registries destroyed since took their shards with them
+        std::erase_if(entries, [](const MetricsThreadCache::Entry& entry) {
+            return entry.owner.expired();
+        });
+        Shard* shard = shards_->acquire();
+        entries.push_back(MetricsThreadCache::Entry{serial_, shards_, shard});
+        return shard;
+    } catch (...) {
+        return nullptr;  // Out of memory: lose the update, not the event
+    }
+}
+
+void MetricsRegistry::add(Id counter, std::uint64_t n) noexcept {
+    if (counter >= kMaxCounters) {
+        return;
+    }
+    if (Shard* shard = local()) {
+        shard->counters[counter].add(n);
+    }
+}
+
+void MetricsRegistry::set(Id gauge, std::int64_t value) noexcept {
+    if (gauge < kMaxGauges) {
+        gauges_[gauge].store(value, std::memory_order_relaxed);
+    }
+}
+
+void MetricsRegistry::adjust(Id gauge, std::int64_t delta) noexcept {
+    if (gauge < kMaxGauges) {
+        gauges_[gauge].fetch_add(delta, std::memory_order_relaxed);
+    }
+}
+
+void MetricsRegistry::observe(Id histogram, std::uint64_t value) noexcept {
+    if (histogram >= kMaxHistograms) {
+        return;
+    }
+    if (Shard* shard = local()) {
+        shard->buckets[histogram][bucket_of(value)].add(1);
+        shard->sums[histogram].add(value);
+    }
+}
+
+std::size_t MetricsRegistry::bucket_of(std::uint64_t value) noexcept {
+    return (std::min)(static_cast<std::size_t>(std::bit_width(value)), kHistogramBuckets - 1);
+}
+
+std::vector<MetricSample> MetricsRegistry::snapshot() const {
+    std::vector<MetricSample> samples;
+    std::vector<Collector> collectors;
+    {
+        std::lock_guard lock(mutex_);
+        std::lock_guard shards_lock(shards_->mutex);
+        for (std::size_t i = 0; i < counters_.size(); ++i) {
+            MetricSample& sample = samples.emplace_back();
+            sample.name = counters_[i].name;
+            sample.help = counters_[i].help;
+            sample.labels = counters_[i].labels;
+            sample.type = MetricType::Counter;
+            std::uint64_t total = 0;
+            for (const auto& shard : shards_->all) {
+                total += shard->counters[i].get();
+            }
+            sample.value = static_cast<double>(total);
+        }
+        for (std::size_t i = 0; i < gauge_info_.size(); ++i) {
+            MetricSample& sample = samples.emplace_back();
+            sample.name = gauge_info_[i].name;
+            sample.help = gauge_info_[i].help;
+            sample.labels = gauge_info_[i].labels;
+            sample.value = static_cast<double>(gauges_[i].load(std::memory_order_relaxed));
+        }
+        for (std::size_t i = 0; i < histograms_.size(); ++i) {
+            MetricSample& sample = samples.emplace_back();
+            sample.name = histograms_[i].name;
+            sample.help = histograms_[i].help;
+            sample.labels = histograms_[i].labels;
+            sample.type = MetricType::Histogram;
+            sample.buckets.assign(kHistogramBuckets, 0);
+            std::uint64_t sum = 0;
+            for (const auto& shard : shards_->all) {
+                for (std::size_t b = 0; b < kHistogramBuckets; ++b) {
+                    const std::uint64_t n = shard->buckets[i][b].get();
+                    sample.buckets[b] += n;
+                    sample.count += n;
+                }
+                sum += shard->sums[i].get();
+            }
+            sample.value = static_cast<double>(sum);
+        }
+        collectors = collectors_;
+    }
+
+    for (const Collector& collect : collectors) {
+        collect(samples);
+    }
+    std::stable_sort(samples.begin(), samples.end(),
+                     [](const MetricSample& a, const MetricSample& b) { return a.name < b.name; });
+    return samples;
+}
+
+bool MetricsRegistry::write(std::ostream& out, MetricsFormat format) const {
+    return write(out, snapshot(), format);
+}
+
+bool MetricsRegistry::write(std::ostream& out, const std::vector<MetricSample>& samples,
+                            MetricsFormat format) {
+    const bool open_metrics = format == MetricsFormat::OpenMetrics;
+    const std::string* family = nullptr;
+    for (const MetricSample& sample : samples) {
+        if (family == nullptr || *family != sample.name) {
+            family = &sample.name;
+            // OpenMetrics names the counter family without its _total suffix
+            std::string_view name = sample.name;
+            if (open_metrics && sample.type == MetricType::Counter && name.ends_with("_total")) {
+                name.remove_suffix(6);
+            }
+            const char* type = sample.type == MetricType::Counter   ? "counter"
+                               : sample.type == MetricType::Gauge   ? "gauge"
+                                                                    : "histogram";
+            out << "# HELP " << name << ' ' << escape_help(sample.help) << '\n';
+            out << "# TYPE " << name << ' ' << type << '\n';
+        }
+
+        if (sample.type != MetricType::Histogram) {
+            out << series(sample.name, sample.labels) << ' ' << format_value(sample.value)
+                << '\n';
+            continue;
+        }
+        const std::string bucket_name = sample.name + "_bucket";
+        std::uint64_t cumulative = 0;
+        for (std::size_t b = 0; b + 1 < sample.buckets.size(); ++b) {
+            cumulative += sample.buckets[b];
+            const std::uint64_t bound = b == 0 ? 0 : (std::uint64_t{1} << b) - 1;
+            const std::string le = "le=\"" + std::to_string(bound) + "\"";
+            out << series(bucket_name, sample.labels, le) << ' ' << cumulative << '\n';
+        }
+        out << series(bucket_name, sample.labels, "le=\"+Inf\"") << ' ' << sample.count << '\n';
+        out << series(sample.name + "_sum", sample.labels) << ' ' << format_value(sample.value)
+            << '\n';
+        out << series(sample.name + "_count", sample.labels) << ' ' << sample.count << '\n';
+    }
+    if (open_metrics) {
+        out << "# EOF\n";
+    }
+    return static_cast<bool>(out);
+}
+
+}  // namespace exeray
@@ -0,0 +1,224 @@
+/// @file platform/connection.cpp
+/// @brief Stream connections through Winsock and named pipes, or BSD sockets.
+
+#include "exeray/platform/connection.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace exeray::platform {
+
+namespace {
+
+#ifdef _WIN32
+/// @brief Winsock stays initialized for the life of the process.
+bool winsock_ready() {
+    static const bool ready = [] {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    return ready;
+}
+
+void close_socket(std::intptr_t handle) {
+    closesocket(static_cast<SOCKET>(handle));
+}
+
+void set_send_timeout(std::intptr_t handle, std::chrono::milliseconds timeout) {
+    const auto value = static_cast<DWORD>(timeout.count());
+    setsockopt(static_cast<SOCKET>(handle), SOL_SOCKET, SO_SNDTIMEO,
+               reinterpret_cast<const char*>(&value), sizeof(value));
+}
+#elif defined(__unix__) || defined(__APPLE__)
+void close_socket(std::intptr_t handle) {
+    ::close(static_cast<int>(handle));
+}
+
+void set_send_timeout(std::intptr_t handle, std::chrono::milliseconds timeout) {
+    timeval value{};
+    value.tv_sec = static_cast<decltype(value.tv_sec)>(timeout.count() / 1000);
+    value.tv_usec = static_cast<decltype(value.tv_usec)>(timeout.count() % 1000 * 1000);
+    setsockopt(static_cast<int>(handle), SOL_SOCKET, SO_SNDTIMEO, &value, sizeof(value));
+#ifdef SO_NOSIGPIPE
+    const int on = 1;
+    setsockopt(static_cast<int>(handle), SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+}
+#endif
+
+}  // namespace
+
+Connection::~Connection() {
+    close();
+}
+
+Connection::Connection(Connection&& other) noexcept
+    : handle_(std::exchange(other.handle_, kClosed)), pipe_(other.pipe_) {}
+
+Connection& Connection::operator=(Connection&& other) noexcept {
+    if (this != &other) {
+        close();
+        handle_ = std::exchange(other.handle_, kClosed);
+        pipe_ = other.pipe_;
+    }
+    return *this;
+}
+
+bool Connection::open_tcp(const std::string& host, std::uint16_t port,
+                          std::chrono::milliseconds send_timeout) {
+    close();
+#if defined(_WIN32) || defined(__unix__) || defined(__APPLE__)
+#ifdef _WIN32
+    if (!winsock_ready()) {
+        return false;
+    }
+#endif
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0) {
+        return false;
+    }
+    for (const addrinfo* address = addresses; address != nullptr; address = address->ai_next) {
+        const auto raw = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        const auto handle = static_cast<std::intptr_t>(raw);
+        if (handle == kClosed) {
+            continue;
+        }
+#ifdef _WIN32
+        const auto length = static_cast<int>(address->ai_addrlen);
+#else
+        const auto length = address->ai_addrlen;
+#endif
+        if (connect(raw, address->ai_addr, length) == 0) {
+            set_send_timeout(handle, send_timeout);
+            handle_ = handle;
+            pipe_ = false;
+            break;
+        }
+        close_socket(handle);
+    }
+    freeaddrinfo(addresses);
+#endif
+    return is_open();
+}
+
+bool Connection::open_pipe(const std::string& path, std::chrono::milliseconds send_timeout) {
+    close();
+#ifdef _WIN32
+    (void)send_timeout;  // Pipe writes complete once the server's buffer takes them
+    HANDLE pipe =
+        CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+    if (pipe == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    handle_ = reinterpret_cast<std::intptr_t>(pipe);
+    pipe_ = true;
+#elif defined(__unix__) || defined(__APPLE__)
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    const int handle = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (handle < 0) {
+        return false;
+    }
+    if (connect(handle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(handle);
+        return false;
+    }
+    set_send_timeout(handle, send_timeout);
+    handle_ = handle;
+    pipe_ = false;
+#else
+    (void)path;
+    (void)send_timeout;
+#endif
+    return is_open();
+}
+
+bool Connection::send(std::span<const std::uint8_t> bytes) {
+    if (!is_open()) {
+        return false;
+    }
+    while (!bytes.empty()) {
+        std::size_t sent = 0;
+#ifdef _WIN32
+        const auto chunk = static_cast<DWORD>((std::min)(bytes.size(), std::size_t{1} << 30));
+        if (pipe_) {
+            DWORD written = 0;
+            if (WriteFile(reinterpret_cast<HANDLE>(handle_), bytes.data(), chunk, &written,
+                          nullptr) == 0) {
+                close();
+                return false;
+            }
+            sent = written;
+        } else {
+            const int result = ::send(static_cast<SOCKET>(handle_),
+                                      reinterpret_cast<const char*>(bytes.data()),
+                                      static_cast<int>(chunk), 0);
+            if (result <= 0) {
+                close();
+                return false;
+            }
+            sent = static_cast<std::size_t>(result);
+        }
+#elif defined(__unix__) || defined(__APPLE__)
+#ifdef MSG_NOSIGNAL
+        constexpr int kFlags = MSG_NOSIGNAL;  // A closed peer fails the send, no SIGPIPE
+#else
+        constexpr int kFlags = 0;
+#endif
+        const ssize_t result =
+            ::send(static_cast<int>(handle_), bytes.data(), bytes.size(), kFlags);
+        if (result <= 0) {
+            close();
+            return false;
+        }
+        sent = static_cast<std::size_t>(result);
+#endif
+        bytes = bytes.subspan(sent);
+    }
+    return true;
+}
+
+void Connection::close() noexcept {
+    if (handle_ == kClosed) {
+        return;
+    }
+#ifdef _WIN32
+    if (pipe_) {
+        CloseHandle(reinterpret_cast<HANDLE>(handle_));
+    } else {
+        close_socket(handle_);
+    }
+#elif defined(__unix__) || defined(__APPLE__)
+    close_socket(handle_);
+#endif
+    handle_ = kClosed;
+    pipe_ = false;
+}
+
+}  // namespace exeray::platform
@@ -0,0 +1,178 @@
+/// @file platform/shared_memory.cpp
+/// @brief Named sections through CreateFileMapping or shm_open.
+
+#include "exeray/platform/shared_memory.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace exeray::platform {
+
+namespace {
+
+#ifdef _WIN32
+std::wstring section_name(std::string_view name) {
+    std::wstring wide = L"Local\\";
+    wide.append(name.begin(), name.end());
+    return wide;
+}
+#else
+std::string section_name(std::string_view name) {
+    std::string path = "/";
+    path.append(name);
+    return path;
+}
+#endif
+
+}  // namespace
+
+SharedMemory::~SharedMemory() {
+    close();
+}
+
+SharedMemory::SharedMemory(SharedMemory&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      owned_(std::exchange(other.owned_, {})),
+      handle_(std::exchange(other.handle_, nullptr)) {}
+
+SharedMemory& SharedMemory::operator=(SharedMemory&& other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        owned_ = std::exchange(other.owned_, {});
+        handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+}
+
+bool SharedMemory::create(std::string_view name, std::size_t size) {
+    close();
+    if (name.empty() || size == 0) {
+        return false;
+    }
+#ifdef _WIN32
+    const auto length = static_cast<std::uint64_t>(size);
+    HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(length >> 32),
+                                        static_cast<DWORD>(length),
+                                        section_name(name).c_str());
+    if (mapping == nullptr) {
+        return false;
+    }
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        // Another live writer owns the name
+        CloseHandle(mapping);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        return false;
+    }
+    // The name lives as long as a handle to the section does
+    handle_ = mapping;
+    data_ = static_cast<std::uint8_t*>(view);
+#elif defined(__unix__) || defined(__APPLE__)
+    const std::string path = section_name(name);
+    // A crashed writer leaves its section behind: start over
+    shm_unlink(path.c_str());
+    const int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    void* view = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+        view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        shm_unlink(path.c_str());
+        return false;
+    }
+    owned_ = path;
+    data_ = static_cast<std::uint8_t*>(view);
+#else
+    return false;
+#endif
+    size_ = size;
+    return true;
+}
+
+bool SharedMemory::open(std::string_view name) {
+    close();
+    if (name.empty()) {
+        return false;
+    }
+#ifdef _WIN32
+    HANDLE mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, section_name(name).c_str());
+    if (mapping == nullptr) {
+        return false;
+    }
+    // The view keeps the section alive after its handle is closed
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == nullptr) {
+        return false;
+    }
+    MEMORY_BASIC_INFORMATION region{};
+    VirtualQuery(view, &region, sizeof(region));
+    data_ = static_cast<std::uint8_t*>(view);
+    size_ = region.RegionSize;
+#elif defined(__unix__) || defined(__APPLE__)
+    const int fd = shm_open(section_name(name).c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info {};
+    void* view = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, fd,
+                    0);
+    }
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    data_ = static_cast<std::uint8_t*>(view);
+    size_ = static_cast<std::size_t>(info.st_size);
+#else
+    return false;
+#endif
+    return true;
+}
+
+void SharedMemory::close() noexcept {
+    if (data_ == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    if (handle_ != nullptr) {
+        CloseHandle(handle_);
+    }
+#elif defined(__unix__) || defined(__APPLE__)
+    munmap(data_, size_);
+    if (!owned_.empty()) {
+        shm_unlink(owned_.c_str());
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    owned_.clear();
+    handle_ = nullptr;
+}
+
+}  // namespace exeray::platform
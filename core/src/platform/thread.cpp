@@ -0,0 +1,499 @@
+/// @file platform/thread.cpp
+/// @brief Thread affinity, priority and cache topology.
+
+#include "exeray/platform/thread.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <thread>
+#include <tuple>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <avrt.h>
+#else
+#include <sys/resource.h>
+#endif
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#endif
+
+namespace exeray::platform {
+
+namespace {
+
+/// Processors of one Windows processor group, addressable by one mask.
+constexpr unsigned kGroupSize = 64;
+
+/// @brief Mask of the listed cores that belong to group.
+[[maybe_unused]] std::uint64_t mask_of(const std::vector<unsigned>& cores, unsigned group) {
+    std::uint64_t mask = 0;
+    for (const unsigned core : cores) {
+        if (core / kGroupSize == group) {
+            mask |= std::uint64_t{1} << (core % kGroupSize);
+        }
+    }
+    return mask;
+}
+
+[[maybe_unused]] std::vector<unsigned> cores_of(std::uint64_t mask, unsigned group) {
+    std::vector<unsigned> cores;
+    for (unsigned bit = 0; bit < kGroupSize; ++bit) {
+        if ((mask >> bit) & 1U) {
+            cores.push_back(group * kGroupSize + bit);
+        }
+    }
+    return cores;
+}
+
+/// @brief Each hardware thread its own core on package 0.
+[[maybe_unused]] CpuTopology fallback_topology() {
+    CpuTopology topology;
+    const unsigned count = std::max(1U, std::thread::hardware_concurrency());
+    for (unsigned id = 0; id < count; ++id) {
+        topology.cpus.push_back(LogicalCpu{id, id, 0, id / kGroupSize, 0});
+    }
+    return topology;
+}
+
+[[maybe_unused]] LogicalCpu* locate(std::vector<LogicalCpu>& cpus, unsigned id) {
+    const auto it = std::lower_bound(cpus.begin(), cpus.end(), id,
+                                     [](const LogicalCpu& cpu, unsigned key) { return cpu.id < key; });
+    return it != cpus.end() && it->id == id ? &*it : nullptr;
+}
+
+#if defined(__linux__)
+bool set_affinity(const std::vector<unsigned>& cores) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const unsigned core : cores) {
+        if (core < CPU_SETSIZE) {
+            CPU_SET(core, &set);
+        }
+    }
+    return CPU_COUNT(&set) > 0 &&
+           pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+std::vector<unsigned> get_affinity() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    std::vector<unsigned> cores;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+        for (unsigned core = 0; core < CPU_SETSIZE; ++core) {
+            if (CPU_ISSET(core, &set)) {
+                cores.push_back(core);
+            }
+        }
+    }
+    return cores;
+}
+
+std::string read_file(const std::string& path) {
+    std::ifstream file(path);
+    std::stringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+/// @brief Read a non-negative integer file; fallback if missing or negative.
+unsigned read_unsigned(const std::string& path, unsigned fallback) {
+    std::ifstream file(path);
+    long value = -1;
+    return (file >> value) && value >= 0 ? static_cast<unsigned>(value) : fallback;
+}
+#endif
+
+}  // namespace
+
+#ifdef _WIN32
+
+namespace {
+
+/// @brief Confine self to the group of cores.front(); previous receives the old affinity.
+bool set_group_affinity(HANDLE self, const std::vector<unsigned>& cores, GROUP_AFFINITY* previous) {
+    const unsigned group = cores.front() / kGroupSize;
+    GROUP_AFFINITY affinity{};
+    affinity.Group = static_cast<WORD>(group);
+    affinity.Mask = static_cast<KAFFINITY>(mask_of(cores, group));
+    return affinity.Mask != 0 && SetThreadGroupAffinity(self, &affinity, previous) != 0;
+}
+
+/// @brief Call fn with the id of every processor in affinity.
+template <typename F>
+void for_each_cpu(const GROUP_AFFINITY& affinity, F&& fn) {
+    for (const unsigned id : cores_of(affinity.Mask, affinity.Group)) {
+        fn(id);
+    }
+}
+
+/// @brief Processor relationships of one kind, as a buffer of variable-size entries.
+std::vector<std::uint8_t> processor_information(LOGICAL_PROCESSOR_RELATIONSHIP relation) {
+    DWORD length = 0;
+    GetLogicalProcessorInformationEx(relation, nullptr, &length);
+    std::vector<std::uint8_t> buffer(length);
+    auto* info = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data());
+    if (length == 0 || !GetLogicalProcessorInformationEx(relation, info, &length)) {
+        return {};
+    }
+    buffer.resize(length);
+    return buffer;
+}
+
+/// @brief Call fn with every entry of a processor_information() buffer.
+template <typename F>
+void for_each_entry(const std::vector<std::uint8_t>& buffer, F&& fn) {
+    for (std::size_t offset = 0; offset < buffer.size();) {
+        const auto* entry =
+            reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+        fn(*entry);
+        offset += entry->Size;
+    }
+}
+
+}  // namespace
+
+ScopedPlacement::ScopedPlacement(const ThreadPlacement& placement) {
+    HANDLE self = GetCurrentThread();
+    GROUP_AFFINITY previous{};
+    if (!placement.cores.empty() && set_group_affinity(self, placement.cores, &previous)) {
+        previous_cores_ = cores_of(previous.Mask, previous.Group);
+        pinned_ = true;
+    }
+
+    if (placement.priority == ThreadPriority::Normal) {
+        return;
+    }
+    previous_priority_ = GetThreadPriority(self);
+    if (placement.priority == ThreadPriority::Capture) {
+        DWORD task_index = 0;
+        mmcss_ = AvSetMmThreadCharacteristicsW(L"Capture", &task_index);
+        raised_ = mmcss_ != nullptr;
+    }
+    if (!raised_) {
+        const int level = placement.priority == ThreadPriority::High
+                              ? THREAD_PRIORITY_HIGHEST
+                              : THREAD_PRIORITY_TIME_CRITICAL;
+        raised_ = SetThreadPriority(self, level) != 0;
+    }
+}
+
+ScopedPlacement::~ScopedPlacement() {
+    HANDLE self = GetCurrentThread();
+    if (mmcss_ != nullptr) {
+        AvRevertMmThreadCharacteristics(mmcss_);
+    } else if (raised_) {
+        SetThreadPriority(self, previous_priority_);
+    }
+    if (pinned_) {
+        set_group_affinity(self, previous_cores_, nullptr);
+    }
+}
+
+std::vector<unsigned> l2_siblings(unsigned core) {
+    std::vector<unsigned> siblings;
+    for_each_entry(processor_information(RelationCache), [&](const auto& entry) {
+        const CACHE_RELATIONSHIP& cache = entry.Cache;
+        if (siblings.empty() && cache.Level == 2 && cache.Type != CacheInstruction &&
+            cache.GroupMask.Group == core / kGroupSize &&
+            ((cache.GroupMask.Mask >> (core % kGroupSize)) & 1U)) {
+            siblings = cores_of(cache.GroupMask.Mask, cache.GroupMask.Group);
+        }
+    });
+    return siblings.empty() ? std::vector<unsigned>{core} : siblings;
+}
+
+CpuTopology cpu_topology() {
+    const auto buffer = processor_information(RelationAll);
+    CpuTopology topology;
+    unsigned cores = 0;
+    for_each_entry(buffer, [&](const auto& entry) {
+        if (entry.Relationship != RelationProcessorCore) {
+            return;
+        }
+        for (WORD i = 0; i < entry.Processor.GroupCount; ++i) {
+            const GROUP_AFFINITY& affinity = entry.Processor.GroupMask[i];
+            for_each_cpu(affinity, [&](unsigned id) {
+                topology.cpus.push_back(LogicalCpu{id, cores, 0, affinity.Group, 0});
+            });
+        }
+        ++cores;
+    });
+    if (topology.cpus.empty()) {
+        return fallback_topology();
+    }
+    std::sort(topology.cpus.begin(), topology.cpus.end(),
+              [](const LogicalCpu& a, const LogicalCpu& b) { return a.id < b.id; });
+
+    // Packages and nodes mark the processors they hold
+    unsigned packages = 0;
+    for_each_entry(buffer, [&](const auto& entry) {
+        if (entry.Relationship == RelationProcessorPackage) {
+            for (WORD i = 0; i < entry.Processor.GroupCount; ++i) {
+                for_each_cpu(entry.Processor.GroupMask[i], [&](unsigned id) {
+                    if (LogicalCpu* cpu = locate(topology.cpus, id)) {
+                        cpu->package = packages;
+                    }
+                });
+            }
+            ++packages;
+        } else if (entry.Relationship == RelationNumaNode) {
+            for_each_cpu(entry.NumaNode.GroupMask, [&](unsigned id) {
+                if (LogicalCpu* cpu = locate(topology.cpus, id)) {
+                    cpu->node = entry.NumaNode.NodeNumber;
+                }
+            });
+        }
+    });
+    return topology;
+}
+
+#else  // !_WIN32
+
+ScopedPlacement::ScopedPlacement(const ThreadPlacement& placement) {
+#if defined(__linux__)
+    if (!placement.cores.empty()) {
+        previous_cores_ = get_affinity();
+        pinned_ = !previous_cores_.empty() && set_affinity(placement.cores);
+    }
+#else
+    (void)placement;
+#endif
+    // Raising priority needs privileges outside Windows; not applied
+    (void)previous_priority_;
+    (void)mmcss_;
+}
+
+ScopedPlacement::~ScopedPlacement() {
+#if defined(__linux__)
+    if (pinned_) {
+        set_affinity(previous_cores_);
+    }
+#endif
+}
+
+std::vector<unsigned> l2_siblings(unsigned core) {
+#if defined(__linux__)
+    const std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(core) + "/cache/index";
+    for (int index = 0; index < 8; ++index) {
+        std::ifstream level_file(base + std::to_string(index) + "/level");
+        std::ifstream type_file(base + std::to_string(index) + "/type");
+        int level = 0;
+        std::string type;
+        if (!(level_file >> level) || level != 2 || !(type_file >> type) ||
+            type == "Instruction") {
+            continue;
+        }
+        std::ifstream list_file(base + std::to_string(index) + "/shared_cpu_list");
+        std::stringstream list;
+        list << list_file.rdbuf();
+        auto cores = parse_cpu_list(list.str());
+        if (std::find(cores.begin(), cores.end(), core) != cores.end()) {
+            return cores;
+        }
+    }
+#endif
+    return {core};
+}
+
+CpuTopology cpu_topology() {
+#if defined(__linux__)
+    const std::vector<unsigned> ids = get_affinity();
+    if (ids.empty()) {
+        return fallback_topology();
+    }
+    // core_id is only unique within a package: number (package, core_id) densely
+    std::vector<std::pair<unsigned, unsigned>> cores;
+    CpuTopology topology;
+    for (const unsigned id : ids) {
+        const std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(id) + "/topology/";
+        const unsigned package = read_unsigned(base + "physical_package_id", 0);
+        const std::pair<unsigned, unsigned> key{package, read_unsigned(base + "core_id", id)};
+        auto it = std::find(cores.begin(), cores.end(), key);
+        if (it == cores.end()) {
+            it = cores.insert(cores.end(), key);
+        }
+        const auto core = static_cast<unsigned>(it - cores.begin());
+        topology.cpus.push_back(LogicalCpu{id, core, package, 0, 0});
+    }
+    for (const unsigned node : parse_cpu_list(read_file("/sys/devices/system/node/possible"))) {
+        const std::string list =
+            read_file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        for (const unsigned id : parse_cpu_list(list)) {
+            if (LogicalCpu* cpu = locate(topology.cpus, id)) {
+                cpu->node = node;
+            }
+        }
+    }
+    return topology;
+#else
+    return fallback_topology();
+#endif
+}
+
+#endif  // _WIN32
+
+double process_cpu_seconds() noexcept {
+#ifdef _WIN32
+    FILETIME created;
+    FILETIME exited;
+    FILETIME kernel;
+    FILETIME user;
+    if (GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user) == 0) {
+        return 0.0;
+    }
+    // FILETIME counts 100 ns units
+    const auto ticks = [](const FILETIME& time) {
+        return static_cast<double>(static_cast<std::uint64_t>(time.dwHighDateTime) << 32 |
+                                   time.dwLowDateTime);
+    };
+    return (ticks(kernel) + ticks(user)) / 1e7;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0.0;
+    }
+    const auto seconds = [](const timeval& time) {
+        return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_usec) / 1e6;
+    };
+    return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+#endif
+}
+
+std::vector<unsigned> parse_cpu_list(std::string_view list) {
+    while (!list.empty() && (list.back() == '\n' || list.back() == ' ')) {
+        list.remove_suffix(1);
+    }
+    std::vector<unsigned> cores;
+    while (!list.empty()) {
+        const auto comma = list.find(',');
+        const auto item = list.substr(0, comma);
+        list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+
+        const auto dash = item.find('-');
+        const auto first_text = item.substr(0, dash);
+        const auto last_text = dash == std::string_view::npos ? first_text : item.substr(dash + 1);
+        unsigned first = 0;
+        unsigned last = 0;
+        const auto first_end = first_text.data() + first_text.size();
+        const auto last_end = last_text.data() + last_text.size();
+        if (first_text.empty() || last_text.empty() ||
+            std::from_chars(first_text.data(), first_end, first).ptr != first_end ||
+            std::from_chars(last_text.data(), last_end, last).ptr != last_end || last < first) {
+            return {};
+        }
+        for (unsigned core = first; core <= last; ++core) {
+            cores.push_back(core);
+        }
+    }
+    return cores;
+}
+
+const LogicalCpu* CpuTopology::find(unsigned id) const noexcept {
+    const auto it = std::lower_bound(cpus.begin(), cpus.end(), id,
+                                     [](const LogicalCpu& cpu, unsigned key) { return cpu.id < key; });
+    return it != cpus.end() && it->id == id ? &*it : nullptr;
+}
+
+std::vector<unsigned> CpuTopology::package_cpus(unsigned package) const {
+    std::vector<unsigned> ids;
+    for (const LogicalCpu& cpu : cpus) {
+        if (cpu.package == package) {
+            ids.push_back(cpu.id);
+        }
+    }
+    return ids;
+}
+
+std::vector<std::vector<unsigned>> place_workers(const CpuTopology& topology,
+                                                 PoolPlacement placement, std::size_t count) {
+    // Compact order: socket by socket, the SMT siblings of a core together
+    std::vector<LogicalCpu> compact = topology.cpus;
+    std::sort(compact.begin(), compact.end(), [](const LogicalCpu& a, const LogicalCpu& b) {
+        return std::tie(a.package, a.core, a.id) < std::tie(b.package, b.core, b.id);
+    });
+    if (placement == PoolPlacement::None || compact.empty()) {
+        return std::vector<std::vector<unsigned>>(
+            count > 0 ? count : std::max<std::size_t>(1, compact.size()));
+    }
+
+    // Candidate placements in the order workers take them
+    std::vector<std::vector<unsigned>> slots;
+    switch (placement) {
+    case PoolPlacement::Compact:
+        for (const LogicalCpu& cpu : compact) {
+            slots.push_back({cpu.id});
+        }
+        break;
+    case PoolPlacement::OnePerCore:
+        for (std::size_t i = 0; i < compact.size(); ++i) {
+            if (i == 0 || compact[i].core != compact[i - 1].core) {
+                slots.emplace_back();
+            }
+            slots.back().push_back(compact[i].id);
+        }
+        break;
+    case PoolPlacement::Scatter: {
+        // Rank by SMT thread within the core, then core within the package,
+        // then package: first threads of every core on every socket come first
+        struct Ranked {
+            std::size_t thread;
+            std::size_t core;
+            unsigned package;
+            unsigned id;
+        };
+        std::vector<Ranked> ranked;
+        std::size_t thread = 0;
+        std::size_t core = 0;
+        for (std::size_t i = 0; i < compact.size(); ++i) {
+            if (i > 0 && compact[i].package != compact[i - 1].package) {
+                core = 0;
+                thread = 0;
+            } else if (i > 0 && compact[i].core != compact[i - 1].core) {
+                ++core;
+                thread = 0;
+            } else if (i > 0) {
+                ++thread;
+            }
+            ranked.push_back(Ranked{thread, core, compact[i].package, compact[i].id});
+        }
+        std::sort(ranked.begin(), ranked.end(), [](const Ranked& a, const Ranked& b) {
+            return std::tie(a.thread, a.core, a.package) < std::tie(b.thread, b.core, b.package);
+        });
+        for (const Ranked& cpu : ranked) {
+            slots.push_back({cpu.id});
+        }
+        break;
+    }
+    case PoolPlacement::None:  // Returned above
+    case PoolPlacement::Group:
+        slots.emplace_back();
+        for (const LogicalCpu& cpu : topology.cpus) {
+            if (cpu.group == topology.cpus.front().group) {
+                slots.back().push_back(cpu.id);
+            }
+        }
+        count = count > 0 ? count : slots.back().size();
+        break;
+    }
+
+    if (count == 0) {
+        count = slots.size();
+    }
+    std::vector<std::vector<unsigned>> workers;
+    workers.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        workers.push_back(slots[i % slots.size()]);
+    }
+    return workers;
+}
+
+}  // namespace exeray::platform
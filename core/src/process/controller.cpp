@@ -4,13 +4,16 @@
 #include "exeray/process/controller.hpp"
 #include "exeray/logging.hpp"
 
+#include <algorithm>
 #include <string>
+#include <unordered_map>
 
 #ifdef _WIN32
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
 #endif
 #include <windows.h>
+#include <tlhelp32.h>
 #endif
 
 namespace exeray::process {
@@ -23,6 +26,50 @@ void log_error(const char* function) {
     DWORD error = GetLastError();
     EXERAY_ERROR("[exeray::process] {} failed with error {}", function, error);
 }
+
+/// @brief Change some of a job's extended limits, keeping the others.
+///
+/// SetInformationJobObject replaces every basic limit at once, so each
+/// setter reads the current ones first.
+template <typename Update>
+void update_limits(HANDLE job, const char* what, Update&& update) {
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION info{};
+    if (!QueryInformationJobObject(job, JobObjectExtendedLimitInformation, &info, sizeof(info),
+                                   nullptr)) {
+        log_error("QueryInformationJobObject");
+        return;
+    }
+    update(info);
+    if (!SetInformationJobObject(job, JobObjectExtendedLimitInformation, &info, sizeof(info))) {
+        EXERAY_ERROR("[exeray::process] SetInformationJobObject ({}) failed with error {}", what,
+                     GetLastError());
+    }
+}
+
+/// @brief Suspend or resume every thread of pid; an attached process has
+/// no primary thread handle.
+void for_each_thread(std::uint32_t pid, bool suspend) {
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot == INVALID_HANDLE_VALUE) {
+        log_error("CreateToolhelp32Snapshot");
+        return;
+    }
+    THREADENTRY32 entry{};
+    entry.dwSize = sizeof(entry);
+    for (BOOL more = Thread32First(snapshot, &entry); more; more = Thread32Next(snapshot, &entry)) {
+        if (entry.th32OwnerProcessID != pid) {
+            continue;
+        }
+        HANDLE thread = OpenThread(THREAD_SUSPEND_RESUME, FALSE, entry.th32ThreadID);
+        if (thread != nullptr) {
+            if ((suspend ? SuspendThread(thread) : ResumeThread(thread)) == static_cast<DWORD>(-1)) {
+                log_error(suspend ? "SuspendThread" : "ResumeThread");
+            }
+            CloseHandle(thread);
+        }
+    }
+    CloseHandle(snapshot);
+}
 #endif
 
 }  // namespace
@@ -106,6 +153,7 @@ std::unique_ptr<Controller> Controller::launch(
     controller->thread_handle_ = pi.hThread;
     controller->job_handle_ = job;
     controller->pid_ = pi.dwProcessId;
+    controller->launched_ = true;
 
     return controller;
 #else
@@ -115,13 +163,73 @@ std::unique_ptr<Controller> Controller::launch(
 #endif
 }
 
+std::unique_ptr<Controller> Controller::attach([[maybe_unused]] std::uint32_t pid) {
+#ifdef _WIN32
+    constexpr DWORD kQuery = PROCESS_QUERY_LIMITED_INFORMATION | SYNCHRONIZE;
+    HANDLE process = OpenProcess(kQuery | PROCESS_TERMINATE, FALSE, pid);
+    if (process == nullptr) {
+        // Protected services refuse termination rights; observing still works
+        process = OpenProcess(kQuery, FALSE, pid);
+    }
+    if (process == nullptr) {
+        log_error("OpenProcess");
+        return nullptr;
+    }
+    auto controller = std::unique_ptr<Controller>(new Controller());
+    controller->process_handle_ = process;
+    controller->pid_ = pid;
+    return controller;
+#else
+    EXERAY_ERROR("[exeray::process] Controller::attach() not supported on this platform");
+    return nullptr;
+#endif
+}
+
+std::vector<std::uint32_t> running_descendants([[maybe_unused]] std::uint32_t pid) {
+    std::vector<std::uint32_t> out;
+#ifdef _WIN32
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    if (snapshot == INVALID_HANDLE_VALUE) {
+        log_error("CreateToolhelp32Snapshot");
+        return out;
+    }
+    std::unordered_multimap<std::uint32_t, std::uint32_t> children;
+    PROCESSENTRY32W entry{};
+    entry.dwSize = sizeof(entry);
+    for (BOOL more = Process32FirstW(snapshot, &entry); more;
+         more = Process32NextW(snapshot, &entry)) {
+        // A parent PID may have been reused; a process is never its own child
+        if (entry.th32ProcessID != entry.th32ParentProcessID) {
+            children.emplace(entry.th32ParentProcessID, entry.th32ProcessID);
+        }
+    }
+    CloseHandle(snapshot);
+
+    // Walk down the tree; a PID is visited once even if reuse makes a cycle
+    std::vector<std::uint32_t> frontier{pid};
+    while (!frontier.empty()) {
+        const std::uint32_t parent = frontier.back();
+        frontier.pop_back();
+        const auto [first, last] = children.equal_range(parent);
+        for (auto it = first; it != last; ++it) {
+            if (it->second != pid &&
+                std::find(out.begin(), out.end(), it->second) == out.end()) {
+                out.push_back(it->second);
+                frontier.push_back(it->second);
+            }
+        }
+    }
+#endif
+    return out;
+}
+
 // -----------------------------------------------------------------------------
 // Destructor
 // -----------------------------------------------------------------------------
 
 Controller::~Controller() {
 #ifdef _WIN32
-    if (is_running()) {
+    if (launched_ && is_running()) {
         terminate(1);
     }
     if (thread_handle_ != nullptr) {
@@ -142,7 +250,9 @@ Controller::~Controller() {
 
 void Controller::resume() {
 #ifdef _WIN32
-    if (thread_handle_ != nullptr) {
+    if (!launched_) {
+        for_each_thread(pid_, false);
+    } else if (thread_handle_ != nullptr) {
         DWORD result = ResumeThread(static_cast<HANDLE>(thread_handle_));
         if (result == static_cast<DWORD>(-1)) {
             log_error("ResumeThread");
@@ -153,7 +263,9 @@ void Controller::resume() {
 
 void Controller::suspend() {
 #ifdef _WIN32
-    if (thread_handle_ != nullptr) {
+    if (!launched_) {
+        for_each_thread(pid_, true);
+    } else if (thread_handle_ != nullptr) {
         DWORD result = SuspendThread(static_cast<HANDLE>(thread_handle_));
         if (result == static_cast<DWORD>(-1)) {
             log_error("SuspendThread");
@@ -218,17 +330,11 @@ void Controller::set_memory_limit([[maybe_unused]] std::size_t bytes) {
         return;
     }
 
-    JOBOBJECT_EXTENDED_LIMIT_INFORMATION info{};
-    info.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_PROCESS_MEMORY;
-    info.ProcessMemoryLimit = bytes;
-
-    if (!SetInformationJobObject(
-            static_cast<HANDLE>(job_handle_),
-            JobObjectExtendedLimitInformation,
-            &info,
-            sizeof(info))) {
-        log_error("SetInformationJobObject (memory limit)");
-    }
+    update_limits(static_cast<HANDLE>(job_handle_), "memory limit",
+                  [bytes](JOBOBJECT_EXTENDED_LIMIT_INFORMATION& info) {
+                      info.BasicLimitInformation.LimitFlags |= JOB_OBJECT_LIMIT_PROCESS_MEMORY;
+                      info.ProcessMemoryLimit = bytes;
+                  });
 #endif
 }
 
@@ -258,23 +364,88 @@ void Controller::set_cpu_limit([[maybe_unused]] std::uint32_t percent) {
 #endif
 }
 
+void Controller::set_io_limit([[maybe_unused]] std::uint64_t bytes_per_second,
+                              [[maybe_unused]] std::uint64_t ops_per_second) {
+#ifdef _WIN32
+    if (job_handle_ == nullptr) {
+        return;
+    }
+
+    // A null volume name sets the limits of every volume the job uses
+    JOBOBJECT_IO_RATE_CONTROL_INFORMATION info{};
+    info.ControlFlags = JOB_OBJECT_IO_RATE_CONTROL_ENABLE;
+    info.MaxBandwidth = static_cast<LONG64>(bytes_per_second);
+    info.MaxIops = static_cast<LONG64>(ops_per_second);
+    info.VolumeName = nullptr;
+
+    const DWORD status =
+        SetIoRateControlInformationJobObject(static_cast<HANDLE>(job_handle_), &info);
+    if (status == 0) {
+        log_error("SetIoRateControlInformationJobObject");
+    }
+#endif
+}
+
+void Controller::apply(const ResourceLimits& limits) {
+    if (limits.memory_bytes > 0) {
+        set_memory_limit(limits.memory_bytes);
+    }
+    if (limits.cpu_percent > 0) {
+        set_cpu_limit(limits.cpu_percent);
+    }
+    if (limits.io_bytes_per_second > 0 || limits.io_ops_per_second > 0) {
+        set_io_limit(limits.io_bytes_per_second, limits.io_ops_per_second);
+    }
+}
+
 void Controller::deny_child_processes() {
 #ifdef _WIN32
     if (job_handle_ == nullptr) {
         return;
     }
 
-    JOBOBJECT_BASIC_LIMIT_INFORMATION info{};
-    info.LimitFlags = JOB_OBJECT_LIMIT_ACTIVE_PROCESS;
-    info.ActiveProcessLimit = 1;
+    update_limits(static_cast<HANDLE>(job_handle_), "deny child processes",
+                  [](JOBOBJECT_EXTENDED_LIMIT_INFORMATION& info) {
+                      info.BasicLimitInformation.LimitFlags |= JOB_OBJECT_LIMIT_ACTIVE_PROCESS;
+                      info.BasicLimitInformation.ActiveProcessLimit = 1;
+                  });
+#endif
+}
 
-    if (!SetInformationJobObject(
-            static_cast<HANDLE>(job_handle_),
-            JobObjectBasicLimitInformation,
-            &info,
-            sizeof(info))) {
-        log_error("SetInformationJobObject (deny child processes)");
+bool Controller::query_accounting([[maybe_unused]] JobAccounting& out) const {
+#ifdef _WIN32
+    if (job_handle_ == nullptr) {
+        return false;
+    }
+    const auto job = static_cast<HANDLE>(job_handle_);
+
+    JOBOBJECT_BASIC_AND_IO_ACCOUNTING_INFORMATION accounting{};
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits{};
+    if (!QueryInformationJobObject(job, JobObjectBasicAndIoAccountingInformation, &accounting,
+                                   sizeof(accounting), nullptr) ||
+        !QueryInformationJobObject(job, JobObjectExtendedLimitInformation, &limits,
+                                   sizeof(limits), nullptr)) {
+        log_error("QueryInformationJobObject (accounting)");
+        return false;
     }
+
+    // Times are in 100 ns units
+    const auto& basic = accounting.BasicInfo;
+    const auto& io = accounting.IoInfo;
+    out.user_time_ns = static_cast<std::uint64_t>(basic.TotalUserTime.QuadPart) * 100;
+    out.kernel_time_ns = static_cast<std::uint64_t>(basic.TotalKernelTime.QuadPart) * 100;
+    out.read_bytes = io.ReadTransferCount;
+    out.write_bytes = io.WriteTransferCount;
+    out.other_bytes = io.OtherTransferCount;
+    out.read_ops = io.ReadOperationCount;
+    out.write_ops = io.WriteOperationCount;
+    out.peak_process_memory = limits.PeakProcessMemoryUsed;
+    out.peak_job_memory = limits.PeakJobMemoryUsed;
+    out.active_processes = basic.ActiveProcesses;
+    out.total_processes = basic.TotalProcesses;
+    return true;
+#else
+    return false;
 #endif
 }
 
@@ -0,0 +1,163 @@
+/// @file sampling_profiler.cpp
+/// @brief Stage table and SamplingProfiler implementation.
+
+#include "exeray/sampling_profiler.hpp"
+#include "exeray/trace_spans.hpp"
+
+namespace exeray {
+
+namespace {
+
+/// @brief Process-wide stage slots; never freed, so the sampler may read
+/// a slot while its thread exits.
+struct StageTable {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<StageSlot>> all;  ///< Guarded by mutex
+    std::vector<StageSlot*> free;                 ///< Guarded by mutex
+
+    static StageTable& global() {
+        static StageTable table;
+        return table;
+    }
+};
+
+std::string folded_name(const char* role, std::uint32_t stack) {
+    std::string name(role);
+    // Outermost stage first, as folded stacks go root to leaf
+    for (int shift = 28; shift >= 0; shift -= 4) {
+        const std::uint32_t kind = (stack >> shift) & 0xF;
+        if (kind != 0) {
+            name += ';';
+            name += span_name(static_cast<SpanKind>(kind - 1));
+        }
+    }
+    return name;
+}
+
+}  // namespace
+
+ProfiledThread::ProfiledThread(const char* role) : previous_(detail::stage_slot) {
+    StageTable& table = StageTable::global();
+    {
+        std::lock_guard lock(table.mutex);
+        if (table.free.empty()) {
+            table.all.push_back(std::make_unique<StageSlot>());
+            slot_ = table.all.back().get();
+        } else {
+            slot_ = table.free.back();
+            table.free.pop_back();
+        }
+    }
+    slot_->stack.store(0, std::memory_order_relaxed);
+    slot_->depth = 0;
+    slot_->role.store(role, std::memory_order_release);
+    detail::stage_slot = slot_;
+}
+
+ProfiledThread::~ProfiledThread() {
+    detail::stage_slot = previous_;
+    slot_->role.store(nullptr, std::memory_order_release);
+    StageTable& table = StageTable::global();
+    try {
+        std::lock_guard lock(table.mutex);
+        table.free.push_back(slot_);
+    } catch (...) {
+        // Out of memory: the slot stays unused
+    }
+}
+
+SamplingProfiler::~SamplingProfiler() {
+    stop();
+}
+
+bool SamplingProfiler::start(std::chrono::microseconds interval) {
+    std::lock_guard lock(mutex_);
+    if (thread_.joinable() || interval.count() <= 0) {
+        return false;
+    }
+    stop_ = false;
+    thread_ = std::thread(&SamplingProfiler::run, this, interval);
+    return true;
+}
+
+void SamplingProfiler::stop() {
+    std::thread thread;
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+        thread = std::move(thread_);
+    }
+    wake_.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+bool SamplingProfiler::running() const {
+    std::lock_guard lock(mutex_);
+    return thread_.joinable();
+}
+
+void SamplingProfiler::run(std::chrono::microseconds interval) {
+    auto next = std::chrono::steady_clock::now() + interval;
+    std::unique_lock lock(mutex_);
+    while (!wake_.wait_until(lock, next, [this] { return stop_; })) {
+        lock.unlock();
+        sample();
+        lock.lock();
+        next += interval;
+        // Fell behind (suspended, overloaded host): skip, don't burst
+        next = (std::max)(next, std::chrono::steady_clock::now());
+    }
+}
+
+void SamplingProfiler::sample() {
+    std::vector<std::pair<const char*, std::uint32_t>> taken;
+    {
+        StageTable& table = StageTable::global();
+        std::lock_guard lock(table.mutex);
+        taken.reserve(table.all.size());
+        for (const auto& slot : table.all) {
+            const char* role = slot->role.load(std::memory_order_acquire);
+            if (role != nullptr) {
+                taken.emplace_back(role, slot->stack.load(std::memory_order_relaxed));
+            }
+        }
+    }
+    std::lock_guard lock(mutex_);
+    for (const auto& key : taken) {
+        ++counts_[key];
+    }
+    samples_ += taken.size();
+}
+
+std::vector<std::pair<std::string, std::uint64_t>> SamplingProfiler::folded() const {
+    std::map<std::string, std::uint64_t> merged;
+    {
+        std::lock_guard lock(mutex_);
+        for (const auto& [key, count] : counts_) {
+            merged[folded_name(key.first, key.second)] += count;
+        }
+    }
+    return {merged.begin(), merged.end()};
+}
+
+std::uint64_t SamplingProfiler::samples() const {
+    std::lock_guard lock(mutex_);
+    return samples_;
+}
+
+bool SamplingProfiler::write_folded(std::ostream& out) const {
+    for (const auto& [stack, count] : folded()) {
+        out << stack << ' ' << count << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+void SamplingProfiler::reset() {
+    std::lock_guard lock(mutex_);
+    counts_.clear();
+    samples_ = 0;
+}
+
+}  // namespace exeray
@@ -0,0 +1,278 @@
+/// @file thread_pool.cpp
+/// @brief Work-stealing thread pool (platform independent).
+
+#include "exeray/thread_pool.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+
+namespace exeray {
+
+namespace {
+
+/// Rounds of yielding an idle worker spends looking for tasks before sleeping.
+constexpr int kSpins = 64;
+
+static_assert((ThreadPool::kDequeCapacity & (ThreadPool::kDequeCapacity - 1)) == 0,
+              "kDequeCapacity must be a power of two");
+
+/// Pool and worker index of the calling thread.
+thread_local const ThreadPool* t_pool = nullptr;
+thread_local std::size_t t_index = 0;
+
+/**
+ * @brief Bounded Chase-Lev deque (Le et al., "Correct and Efficient
+ * Work-Stealing for Weak Memory Models").
+ *
+ * The owner pushes and pops at the bottom, thieves take from the top. A
+ * thief moves its task out only after winning the top, so each slot has a
+ * flag the thief clears when done; the owner treats a slot still flagged
+ * as full rather than overwrite a task being moved.
+ */
+class Deque {
+public:
+    /// @brief Owner: add task at the bottom; false (task untouched) if full.
+    bool push(Task& task) noexcept {
+        const std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        const std::int64_t top = top_.load(std::memory_order_acquire);
+        if (bottom - top >= static_cast<std::int64_t>(ThreadPool::kDequeCapacity)) {
+            return false;
+        }
+        Slot& slot = slots_[index(bottom)];
+        if (slot.full.load(std::memory_order_acquire)) {
+            return false;  // A thief is still moving the previous task out
+        }
+        slot.task = std::move(task);
+        slot.full.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// @brief Owner: take the newest task.
+    bool pop(Task& task) noexcept {
+        const std::int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t top = top_.load(std::memory_order_relaxed);
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+        if (top == bottom) {
+            // Last task: race the thieves for it
+            const bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                          std::memory_order_relaxed);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            if (!won) {
+                return false;
+            }
+        }
+        Slot& slot = slots_[index(bottom)];
+        task = std::move(slot.task);
+        slot.full.store(false, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// @brief Any thread: take the oldest task; false if empty or lost a race.
+    bool steal(Task& task) noexcept {
+        std::int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t bottom = bottom_.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return false;
+        }
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return false;
+        }
+        Slot& slot = slots_[index(top)];
+        task = std::move(slot.task);
+        slot.full.store(false, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Slot {
+        Task task;
+        std::atomic<bool> full{false};
+    };
+
+    static std::size_t index(std::int64_t position) noexcept {
+        return static_cast<std::size_t>(position) & (ThreadPool::kDequeCapacity - 1);
+    }
+
+    alignas(64) std::atomic<std::int64_t> top_{0};
+    alignas(64) std::atomic<std::int64_t> bottom_{0};
+    alignas(64) std::unique_ptr<Slot[]> slots_ =
+        std::make_unique<Slot[]>(ThreadPool::kDequeCapacity);
+};
+
+/// @brief Tasks submitted from outside the pool, or past a full deque.
+class Inbox {
+public:
+    void push(Task task) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+        size_.store(tasks_.size(), std::memory_order_release);
+    }
+
+    bool pop(Task& task) {
+        if (size_.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (tasks_.empty()) {
+            return false;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+        size_.store(tasks_.size(), std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::deque<Task> tasks_;
+    std::atomic<std::size_t> size_{0};
+};
+
+}  // namespace
+
+struct ThreadPool::Worker {
+    Deque deque;
+    Inbox inbox;
+    std::uint32_t victim = 0;  ///< xorshift state choosing where to steal first
+    std::vector<unsigned> cores;  ///< Pinned to for the worker's life (empty = any)
+};
+
+ThreadPool::ThreadPool(std::size_t num_threads, platform::PoolPlacement placement) {
+    std::vector<std::vector<unsigned>> cores;
+    if (placement != platform::PoolPlacement::None) {
+        cores = platform::place_workers(platform::cpu_topology(), placement, num_threads);
+    } else {
+        cores.resize(std::max<std::size_t>(
+            1, num_threads > 0 ? num_threads : std::thread::hardware_concurrency()));
+    }
+    const std::size_t count = cores.size();
+    workers_.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+        workers_.back()->victim = static_cast<std::uint32_t>(i * 2654435761u) | 1u;
+        workers_.back()->cores = std::move(cores[i]);
+    }
+    threads_.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        threads_.emplace_back([this, i] { run(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    stopping_.store(true, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_seq_cst) != 0) {
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+        epoch_.notify_all();
+    }
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+const std::vector<unsigned>& ThreadPool::worker_cores(std::size_t index) const noexcept {
+    return workers_[index]->cores;
+}
+
+std::size_t ThreadPool::current() const noexcept {
+    return t_pool == this ? t_index : workers_.size();
+}
+
+void ThreadPool::submit(Task task) {
+    if (!task) {
+        return;
+    }
+    const std::size_t self = current();
+    if (self < workers_.size()) {
+        Worker& worker = *workers_[self];
+        if (!worker.deque.push(task)) {
+            worker.inbox.push(std::move(task));
+        }
+    } else {
+        const std::size_t target = next_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+        workers_[target]->inbox.push(std::move(task));
+    }
+    wake_one();
+}
+
+void ThreadPool::wake_one() noexcept {
+    // Pairs with the fence in run(): either this sees the sleeper, or the
+    // sleeper's last look finds the task
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_seq_cst) != 0) {
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+        epoch_.notify_one();
+    }
+}
+
+bool ThreadPool::find(std::size_t index, Task& task) {
+    Worker& self = *workers_[index];
+    if (self.deque.pop(task) || self.inbox.pop(task)) {
+        return true;
+    }
+    const std::size_t count = workers_.size();
+    std::uint32_t& x = self.victim;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    const std::size_t start = x % count;
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::size_t victim = (start + i) % count;
+        if (victim == index) {
+            continue;
+        }
+        if (workers_[victim]->deque.steal(task) || workers_[victim]->inbox.pop(task)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(std::size_t index) {
+    t_pool = this;
+    t_index = index;
+    const platform::ScopedPlacement placement(
+        platform::ThreadPlacement{workers_[index]->cores, platform::ThreadPriority::Normal});
+    Task task;
+    for (;;) {
+        bool found = find(index, task);
+        for (int spin = 0; !found && spin < kSpins; ++spin) {
+            std::this_thread::yield();
+            found = find(index, task);
+        }
+        if (found) {
+            task();
+            task = Task{};
+            continue;
+        }
+
+        // Announce the sleep, then look once more before committing to it
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        const std::uint32_t key = epoch_.load(std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        found = find(index, task);
+        if (found || stopping_.load(std::memory_order_seq_cst)) {
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            if (!found) {
+                return;  // Own deque and inbox are empty: nothing left for this worker
+            }
+            task();
+            task = Task{};
+            continue;
+        }
+        epoch_.wait(key, std::memory_order_seq_cst);
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace exeray
@@ -0,0 +1,229 @@
+/// @file trace_spans.cpp
+/// @brief SpanTrace implementation (TraceLogging on Windows with EXERAY_SPANS).
+
+#include "exeray/trace_spans.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#if defined(_WIN32) && defined(EXERAY_SPANS)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <TraceLoggingProvider.h>
+
+// {2c01bd5f-08c5-4dfd-804e-997ca115e52b}
+TRACELOGGING_DEFINE_PROVIDER(g_span_provider, "ExeRay.Spans",
+                             (0x2c01bd5f, 0x08c5, 0x4dfd,
+                              0x80, 0x4e, 0x99, 0x7c, 0xa1, 0x15, 0xe5, 0x2b));
+#endif
+
+namespace exeray {
+
+namespace {
+
+/// Span durations keep the low 56 bits; the kind goes in the top byte.
+constexpr unsigned kKindShift = 56;
+constexpr std::uint64_t kCycleMask = (std::uint64_t{1} << kKindShift) - 1;
+
+std::int64_t steady_ns() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+}  // namespace
+
+struct SpanTrace::Ring {
+    struct Slot {
+        std::atomic<std::uint64_t> start{0};
+        std::atomic<std::uint64_t> packed{0};  ///< Kind << kKindShift | cycles
+    };
+
+    static_assert((kRingRecords & (kRingRecords - 1)) == 0,
+                  "kRingRecords must be a power of two");
+
+    explicit Ring(std::uint32_t number) noexcept : index(number) {}
+
+    std::array<Slot, kRingRecords> slots;
+    std::atomic<std::uint64_t> head{0};  ///< Spans ever written; the next goes to head % size
+    std::uint32_t index;
+};
+
+/// @brief Returns the calling thread's ring to its owner when the thread exits.
+struct SpanLease {
+    SpanTrace* owner = nullptr;
+    SpanTrace::Ring* ring = nullptr;
+
+    ~SpanLease() {
+        if (owner != nullptr) {
+            owner->release(ring);
+        }
+    }
+};
+
+namespace {
+
+thread_local SpanLease lease;
+
+}  // namespace
+
+std::string_view span_name(SpanKind kind) noexcept {
+    switch (kind) {
+        case SpanKind::Parse:     return "parse";
+        case SpanKind::Intern:    return "intern";
+        case SpanKind::Detect:    return "detect";
+        case SpanKind::Correlate: return "correlate";
+        case SpanKind::Push:      return "push";
+        default:                  return "unknown";
+    }
+}
+
+SpanTrace& SpanTrace::global() noexcept {
+    // Constructed before the first lease, so it outlives every thread's lease
+    static SpanTrace instance;
+    return instance;
+}
+
+SpanTrace::SpanTrace() : epoch_cycles_(etw::read_cycles()), epoch_ns_(steady_ns()) {
+#if defined(_WIN32) && defined(EXERAY_SPANS)
+    TraceLoggingRegister(g_span_provider);
+#endif
+}
+
+SpanTrace::~SpanTrace() {
+#if defined(_WIN32) && defined(EXERAY_SPANS)
+    TraceLoggingUnregister(g_span_provider);
+#endif
+}
+
+SpanTrace::Ring& SpanTrace::local() {
+    if (lease.ring != nullptr) {
+        return *lease.ring;
+    }
+    std::lock_guard lock(mutex_);
+    if (!free_.empty()) {
+        lease.ring = free_.back();
+        free_.pop_back();
+    } else {
+        rings_.push_back(std::make_unique<Ring>(static_cast<std::uint32_t>(rings_.size())));
+        lease.ring = rings_.back().get();
+    }
+    lease.owner = this;
+    return *lease.ring;
+}
+
+void SpanTrace::release(Ring* ring) noexcept {
+    std::lock_guard lock(mutex_);
+    free_.push_back(ring);
+}
+
+void SpanTrace::record(SpanKind kind, std::uint64_t start, std::uint64_t cycles) noexcept {
+    Ring* ring = lease.ring;
+    if (ring == nullptr) {
+        try {
+            ring = &local();
+        } catch (...) {
+            return;  // Out of memory: lose the span, not the event
+        }
+    }
+
+    // Single writer: the slot is filled before head publishes it
+    const std::uint64_t head = ring->head.load(std::memory_order_relaxed);
+    Ring::Slot& slot = ring->slots[head & (kRingRecords - 1)];
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.packed.store((static_cast<std::uint64_t>(kind) << kKindShift) | (cycles & kCycleMask),
+                      std::memory_order_relaxed);
+    ring->head.store(head + 1, std::memory_order_release);
+
+#if defined(_WIN32) && defined(EXERAY_SPANS)
+    TraceLoggingWrite(g_span_provider, "Span",
+                      TraceLoggingString(span_name(kind).data(), "Kind"),
+                      TraceLoggingUInt64(start, "Start"),
+                      TraceLoggingUInt64(cycles, "Cycles"));
+#endif
+}
+
+std::vector<SpanRecord> SpanTrace::snapshot() const {
+    std::vector<SpanRecord> result;
+    std::lock_guard lock(mutex_);
+    for (const auto& ring : rings_) {
+        const std::uint64_t head = ring->head.load(std::memory_order_acquire);
+        const std::uint64_t first = head >= kRingRecords ? head - kRingRecords + 1 : 0;
+        const std::size_t copied_from = result.size();
+        for (std::uint64_t i = first; i < head; ++i) {
+            const Ring::Slot& slot = ring->slots[i & (kRingRecords - 1)];
+            const std::uint64_t packed = slot.packed.load(std::memory_order_relaxed);
+            result.push_back(SpanRecord{slot.start.load(std::memory_order_relaxed),
+                                        packed & kCycleMask, ring->index,
+                                        static_cast<SpanKind>(packed >> kKindShift)});
+        }
+
+        // Spans the owner overwrote (or is overwriting) during the copy are
+        // dropped: once head is h, the slots of indices <= h - size are stale
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const std::uint64_t after = ring->head.load(std::memory_order_relaxed);
+        if (after >= kRingRecords && after - kRingRecords + 1 > first) {
+            const std::uint64_t stale = (std::min)(after - kRingRecords + 1, head) - first;
+            result.erase(result.begin() + static_cast<std::ptrdiff_t>(copied_from),
+                         result.begin() + static_cast<std::ptrdiff_t>(copied_from + stale));
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const SpanRecord& a, const SpanRecord& b) {
+        return a.start != b.start ? a.start < b.start : a.thread < b.thread;
+    });
+    return result;
+}
+
+std::uint64_t SpanTrace::recorded() const {
+    std::uint64_t total = 0;
+    std::lock_guard lock(mutex_);
+    for (const auto& ring : rings_) {
+        total += ring->head.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+double SpanTrace::cycles_per_us() const noexcept {
+    const std::int64_t elapsed_ns = steady_ns() - epoch_ns_;
+    const std::uint64_t elapsed_cycles = etw::read_cycles() - epoch_cycles_;
+    if (elapsed_ns <= 0 || elapsed_cycles == 0) {
+        return 1000.0;  // Too early to tell: assume 1 GHz
+    }
+    return static_cast<double>(elapsed_cycles) * 1000.0 / static_cast<double>(elapsed_ns);
+}
+
+bool SpanTrace::write_chrome_trace(std::ostream& out) const {
+    const std::vector<SpanRecord> spans = snapshot();
+    const double per_us = cycles_per_us();
+    const std::uint64_t origin = spans.empty() ? 0 : spans.front().start;
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    char line[160];
+    bool first = true;
+    for (const SpanRecord& span : spans) {
+        const std::string_view name = span_name(span.kind);
+        const int length = std::snprintf(
+            line, sizeof(line),
+            "%s\n{\"name\":\"%.*s\",\"cat\":\"exeray\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+            "\"pid\":1,\"tid\":%u}",
+            first ? "" : ",", static_cast<int>(name.size()), name.data(),
+            static_cast<double>(span.start - origin) / per_us,
+            static_cast<double>(span.cycles) / per_us, span.thread);
+        out.write(line, length);
+        first = false;
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+void SpanTrace::reset() noexcept {
+    std::lock_guard lock(mutex_);
+    for (const auto& ring : rings_) {
+        ring->head.store(0, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace exeray
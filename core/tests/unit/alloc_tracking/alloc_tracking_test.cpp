@@ -0,0 +1,93 @@
+/// @file alloc_tracking_test.cpp
+/// @brief Tests for the allocation counters and the report.
+
+#include "alloc_tracking/alloc_tracking_test_common.hpp"
+
+#include <memory>
+#include <thread>
+
+namespace exeray::test {
+namespace {
+
+/// Escapes a pointer so that the compiler cannot elide its allocation.
+void keep(const void* p) {
+    static const void* volatile sink;
+    sink = p;
+    static_cast<void>(sink);  // Read back: a write-only variable warns
+}
+
+class AllocTrackingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (!alloc::hooked()) {
+            GTEST_SKIP() << "Built without EXERAY_TRACK_ALLOCATIONS";
+        }
+    }
+};
+
+TEST_F(AllocTrackingTest, Scope_CountsAllocationsAndBytes) {
+    const alloc::AllocationScope scope;
+    auto first = std::make_unique<char[]>(100);
+    auto second = std::make_unique<char[]>(28);
+    keep(first.get());
+    keep(second.get());
+
+    EXPECT_EQ(scope.count().allocations, 2U);
+    EXPECT_EQ(scope.count().bytes, 128U);
+}
+
+TEST_F(AllocTrackingTest, Scope_IgnoresOtherThreads) {
+    const alloc::AllocationScope scope;
+    const auto process = alloc::process_allocations();
+    std::unique_ptr<int> other;
+    std::thread worker([&other] {
+        other = std::make_unique<int>(7);
+        keep(other.get());
+    });
+    const auto started = scope.count();  // std::thread allocates its state here
+    worker.join();
+
+    EXPECT_EQ(scope.count().allocations, started.allocations);
+    EXPECT_GT(alloc::process_allocations().allocations,
+              process.allocations + started.allocations);
+}
+
+TEST_F(AllocTrackingTest, Scope_Restart_StartsOver) {
+    alloc::AllocationScope scope;
+    keep(std::make_unique<int>(1).get());
+    scope.restart();
+    EXPECT_EQ(scope.count().allocations, 0U);
+}
+
+TEST_F(AllocTrackingTest, Measure_CountsPerEventAfterWarmup) {
+    std::size_t calls = 0;
+    const AllocationSite site = measure_allocations(
+        "grows", [&calls] {
+            // Only the warmup allocates
+            if (calls++ < 10) {
+                keep(std::make_unique<std::uint64_t>(calls).get());
+            }
+        },
+        10, 100);
+    EXPECT_EQ(site.allocations, 0.0);
+
+    const AllocationSite every = measure_allocations(
+        "every", [] { keep(std::make_unique<std::uint64_t>(1).get()); }, 1, 100);
+    EXPECT_EQ(every.allocations, 1.0);
+    EXPECT_EQ(every.bytes, 8.0);
+}
+
+TEST(AllocationReportTest, WorstOffendersFirst) {
+    const std::string report =
+        allocation_report({{"clean", 0, 0}, {"worst", 3, 96}, {"some", 1, 512}});
+
+    const auto worst = report.find("worst");
+    const auto some = report.find("some");
+    const auto clean = report.find("clean");
+    ASSERT_NE(clean, std::string::npos);
+    EXPECT_LT(worst, some);
+    EXPECT_LT(some, clean);
+}
+
+}  // namespace
+}  // namespace exeray::test
@@ -0,0 +1,80 @@
+/// @file alloc_tracking_test_common.hpp
+/// @brief Per-event allocation measurement and the worst-offenders report.
+
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "exeray/alloc_tracking.hpp"
+
+namespace exeray::test {
+
+/// @brief Heap use of one step of the event path, per event.
+struct AllocationSite {
+    std::string name;
+    double allocations = 0;  ///< Per event
+    double bytes = 0;        ///< Per event
+};
+
+/// Events run before counting: caches, pools and indexes fill up first
+constexpr std::size_t kWarmupEvents = 1024;
+
+/// Events counted per site
+constexpr std::size_t kMeasuredEvents = 4096;
+
+/**
+ * @brief Run step() for warmup events, then count its allocations.
+ * @param step Handles events_per_step events on the calling thread.
+ */
+template <typename Fn>
+AllocationSite measure_allocations(std::string name, Fn&& step,
+                                   std::size_t warmup = kWarmupEvents,
+                                   std::size_t events = kMeasuredEvents,
+                                   std::size_t events_per_step = 1) {
+    for (std::size_t i = 0; i < warmup; i += events_per_step) {
+        step();
+    }
+    const alloc::AllocationScope scope;
+    std::size_t done = 0;
+    for (; done < events; done += events_per_step) {
+        step();
+    }
+    const alloc::AllocationCount count = scope.count();
+    const auto n = static_cast<double>(done);
+    return {std::move(name), static_cast<double>(count.allocations) / n,
+            static_cast<double>(count.bytes) / n};
+}
+
+/// @brief Sites sorted worst first (allocations, then bytes per event).
+inline std::string allocation_report(std::vector<AllocationSite> sites) {
+    std::sort(sites.begin(), sites.end(), [](const AllocationSite& a, const AllocationSite& b) {
+        return a.allocations != b.allocations ? a.allocations > b.allocations
+                                              : a.bytes > b.bytes;
+    });
+    std::string report = "allocs/event  bytes/event  site\n";
+    char line[64];
+    for (const AllocationSite& site : sites) {
+        std::snprintf(line, sizeof(line), "%12.3f %12.1f  ", site.allocations, site.bytes);
+        report += line;
+        report += site.name;
+        report += '\n';
+    }
+    return report;
+}
+
+/// @brief Fail for each site that allocates, with the report of all sites.
+inline void expect_allocation_free(const std::vector<AllocationSite>& sites) {
+    for (const AllocationSite& site : sites) {
+        EXPECT_EQ(site.allocations, 0.0) << site.name << " allocates in steady state\n"
+                                         << allocation_report(sites);
+    }
+}
+
+}  // namespace exeray::test
@@ -0,0 +1,139 @@
+/// @file event_path_alloc_test.cpp
+/// @brief Steady-state heap allocations of the portable event path.
+///
+/// Each step of ingest must stop allocating once warmed up; the report
+/// printed by every test lists the worst offenders first.
+
+#include "alloc_tracking/alloc_tracking_test_common.hpp"
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/consumer.hpp"
+#include "exeray/etw/synthetic_source.hpp"
+#include "exeray/etw/tdh/decode_plan.hpp"
+#include "exeray/event/correlator.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/string_pool.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace exeray::test {
+namespace {
+
+class EventPathAllocTest : public ::testing::Test {
+protected:
+    static constexpr std::size_t kArenaSize = 64 * 1024 * 1024;
+
+    void SetUp() override {
+        if (!alloc::hooked()) {
+            GTEST_SKIP() << "Built without EXERAY_TRACK_ALLOCATIONS";
+        }
+    }
+
+    Arena arena_{kArenaSize};
+    event::StringPool strings_{arena_};
+    event::EventGraph graph_{arena_, strings_, 1 << 16};
+};
+
+TEST_F(EventPathAllocTest, StringPool_SteadyState_AllocationFree) {
+    const std::vector<std::string> paths = {
+        "C:\\Windows\\System32\\kernel32.dll", "C:\\Users\\Public\\Documents\\report.docx",
+        "HKLM\\SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Run"};
+    const std::vector<std::wstring> wide = {L"C:\\Windows\\System32\\ntdll.dll",
+                                            L"C:\\Program Files\\App\\app.exe",
+                                            L"\\Device\\HarddiskVolume3\\Temp\\a.tmp"};
+    std::size_t i = 0;
+    event::StringId last = event::INVALID_STRING;
+    std::vector<AllocationSite> sites;
+    sites.push_back(measure_allocations("StringPool::intern", [&] {
+        last = strings_.intern(paths[i++ % paths.size()]);
+    }));
+    sites.push_back(measure_allocations("StringPool::intern_wide", [&] {
+        last = strings_.intern_wide(wide[i++ % wide.size()]);
+    }));
+    sites.push_back(measure_allocations("StringPool::intern_path", [&] {
+        last = strings_.intern_path(paths[i++ % paths.size()]);
+    }));
+    sites.push_back(measure_allocations("StringPool::intern_path_wide", [&] {
+        last = strings_.intern_path_wide(wide[i++ % wide.size()]);
+    }));
+    sites.push_back(measure_allocations("StringPool::folded", [&] {
+        last = strings_.folded(strings_.intern(paths[i++ % paths.size()]));
+    }));
+    EXPECT_NE(last, event::INVALID_STRING);
+
+    expect_allocation_free(sites);
+}
+
+TEST_F(EventPathAllocTest, EventGraph_Push_AllocationFree) {
+    event::EventPayload payload{};
+    payload.category = event::Category::Process;
+    payload.process.pid = 1234;
+    const AllocationSite site = measure_allocations("EventGraph::push", [&] {
+        graph_.push(event::Category::Process, static_cast<std::uint8_t>(event::ProcessOp::Create),
+                    event::Status::Success, event::INVALID_EVENT, 0, payload);
+    });
+    EXPECT_GT(graph_.count(), 0U);
+
+    expect_allocation_free({site});
+}
+
+TEST_F(EventPathAllocTest, DecodePlan_Decode_AllocationFree) {
+    std::vector<etw::tdh::PropertySchema> schema(4);
+    const wchar_t* names[] = {L"ProcessId", L"Base", L"Port", L"FileName"};
+    const etw::tdh::InType types[] = {etw::tdh::InType::UInt32, etw::tdh::InType::Pointer,
+                                      etw::tdh::InType::UInt16,
+                                      etw::tdh::InType::UnicodeString};
+    for (std::size_t p = 0; p < schema.size(); ++p) {
+        schema[p].name = names[p];
+        schema[p].in_type = static_cast<std::uint16_t>(types[p]);
+    }
+    const auto plan = etw::tdh::DecodePlan::compile(schema);
+    ASSERT_TRUE(plan.has_value());
+
+    std::vector<std::uint8_t> data(4 + 8 + 2);
+    const std::uint32_t pid = 4242;
+    std::memcpy(data.data(), &pid, sizeof(pid));
+    for (const char c : std::string("C:\\a.txt")) {
+        data.push_back(static_cast<std::uint8_t>(c));
+        data.push_back(0);
+    }
+    data.insert(data.end(), {0, 0});
+
+    bool decoded = false;
+    const AllocationSite site = measure_allocations("DecodePlan::decode", [&] {
+        etw::TdhParsedEvent event;
+        decoded = plan->decode(data, 8, event);
+    });
+    EXPECT_TRUE(decoded);
+
+    expect_allocation_free({site});
+}
+
+TEST_F(EventPathAllocTest, Consumer_SyntheticStream_AllocationFree) {
+    event::Correlator correlator;
+    etw::ConsumerContext ctx;
+    ctx.graph = &graph_;
+    ctx.strings = &strings_;
+    ctx.correlator = &correlator;
+    ctx.clock = etw::ClockDomain::capture();
+
+    // No churn: each new process is registered in the correlator, which allocates
+    etw::SyntheticConfig config;
+    config.processes = 50;
+    config.strings = 200;
+    config.churn = 0;
+    etw::SyntheticSource source(config);
+    const AllocationSite site = measure_allocations(
+        "SyntheticSource::feed (consume, correlate, push)",
+        [&] { source.feed(ctx, config.buffer_events); }, 16 * 1024, 16 * 1024,
+        config.buffer_events);
+    EXPECT_GT(graph_.count(), 0U);
+
+    expect_allocation_free({site});
+}
+
+}  // namespace
+}  // namespace exeray::test
@@ -0,0 +1,130 @@
+#include "arena_test_common.hpp"
+
+#include <cstring>
+#include <filesystem>
+
+namespace exeray {
+namespace arena_test {
+
+TEST_F(ArenaTest, Backend_Default_HeapFullyCommitted) {
+    Arena arena{kDefaultCapacity};
+    EXPECT_EQ(arena.backend(), ArenaBackend::Heap);
+    EXPECT_EQ(arena.committed(), kDefaultCapacity);
+    EXPECT_EQ(arena.numa_node(), -1);
+}
+
+TEST_F(ArenaTest, Backend_LazyCommit_CommitsInChunks) {
+    constexpr std::size_t kCapacity = 4 * Arena::kCommitChunk;
+    Arena arena{kCapacity, ArenaOptions{.lazy_commit = true}};
+    if (arena.backend() != ArenaBackend::Virtual) {
+        GTEST_SKIP() << "address space reservation unavailable";
+    }
+    EXPECT_EQ(arena.committed(), 0U);
+
+    auto* first = arena.allocate<std::uint8_t>(64);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(arena.committed(), Arena::kCommitChunk);
+    std::memset(first, 0xAB, 64);
+
+    // Crossing the chunk boundary commits the next chunk only
+    auto* second = arena.allocate<std::uint8_t>(Arena::kCommitChunk);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(arena.committed(), 2 * Arena::kCommitChunk);
+    std::memset(second, 0xCD, Arena::kCommitChunk);
+    EXPECT_EQ(first[63], 0xAB);
+}
+
+TEST_F(ArenaTest, Backend_LazyCommit_ExhaustsAtCapacity) {
+    constexpr std::size_t kCapacity = Arena::kCommitChunk + 4096;
+    Arena arena{kCapacity, ArenaOptions{.lazy_commit = true}};
+
+    auto* all = arena.allocate<std::uint8_t>(kCapacity);
+    ASSERT_NE(all, nullptr);
+    all[kCapacity - 1] = 1;
+    EXPECT_GE(arena.committed(), kCapacity);
+    EXPECT_EQ(arena.allocate<std::uint8_t>(), nullptr);
+}
+
+TEST_F(ArenaTest, Backend_LazyCommit_ConcurrentAllocationsWritable) {
+    constexpr std::size_t kCapacity = 8 * Arena::kCommitChunk;
+    constexpr int kThreads = 4;
+    Arena arena{kCapacity, ArenaOptions{.lazy_commit = true}};
+
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&arena, &failures, t] {
+            for (int i = 0; i < 1000; ++i) {
+                auto* data = arena.allocate<CacheLine>(4);
+                if (data == nullptr) {
+                    failures.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                std::memset(data, t, sizeof(CacheLine) * 4);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(failures.load(), 0);
+    EXPECT_GE(arena.committed(), arena.used());
+}
+
+TEST_F(ArenaTest, Backend_LargePages_FallsBackGracefully) {
+    // Large pages need privileges/reserved pages; any backend is acceptable
+    Arena arena{Arena::kCommitChunk, ArenaOptions{.large_pages = true}};
+    EXPECT_EQ(arena.committed(), arena.capacity());
+
+    auto* data = arena.allocate<std::uint8_t>(Arena::kCommitChunk);
+    ASSERT_NE(data, nullptr);
+    std::memset(data, 0x5A, Arena::kCommitChunk);
+    EXPECT_EQ(data[Arena::kCommitChunk - 1], 0x5A);
+}
+
+#ifndef _WIN32
+TEST_F(ArenaTest, Backend_NumaNode_NotAppliedOffWindows) {
+    Arena arena{kDefaultCapacity, ArenaOptions{.numa_node = 0}};
+    EXPECT_EQ(arena.numa_node(), -1);
+    EXPECT_NE(arena.allocate<Aligned8>(), nullptr);
+}
+#endif
+
+TEST_F(ArenaTest, Backend_Reset_KeepsCommittedMemory) {
+    Arena arena{2 * Arena::kCommitChunk, ArenaOptions{.lazy_commit = true}};
+    ASSERT_NE(arena.allocate<std::uint8_t>(Arena::kCommitChunk + 1), nullptr);
+    const auto committed = arena.committed();
+    arena.reset();
+    EXPECT_EQ(arena.committed(), committed);
+    EXPECT_NE(arena.allocate<std::uint8_t>(Arena::kCommitChunk), nullptr);
+}
+
+TEST_F(ArenaTest, Backend_File_MapsScratchFile) {
+    const auto path = std::filesystem::temp_directory_path() / "exeray_arena_backend_test.bin";
+    constexpr std::size_t kCapacity = 2 * Arena::kCommitChunk;
+    Arena arena{kCapacity, ArenaOptions{.backing_file = path.string()}};
+    if (arena.backend() != ArenaBackend::File) {
+        GTEST_SKIP() << "file mapping unavailable";
+    }
+    EXPECT_EQ(arena.capacity(), kCapacity);
+    EXPECT_EQ(arena.committed(), kCapacity);
+
+    auto* data = arena.allocate<std::uint8_t>(kCapacity);
+    ASSERT_NE(data, nullptr);
+    EXPECT_TRUE(arena.zeroed(data));
+    std::memset(data, 0x5A, kCapacity);
+    arena.page_out(data, kCapacity);
+    EXPECT_EQ(data[0], 0x5A);
+    EXPECT_EQ(data[kCapacity - 1], 0x5A);
+    EXPECT_EQ(arena.allocate<std::uint8_t>(), nullptr);
+}
+
+TEST_F(ArenaTest, Backend_File_UnwritablePathFallsBack) {
+    Arena arena{kDefaultCapacity,
+                ArenaOptions{.backing_file = "/nonexistent-dir/exeray/arena.bin"}};
+    EXPECT_NE(arena.backend(), ArenaBackend::File);
+    EXPECT_NE(arena.allocate<Aligned8>(), nullptr);
+}
+
+}  // namespace arena_test
+}  // namespace exeray
@@ -0,0 +1,87 @@
+#include "arena_test_common.hpp"
+
+#include <cstring>
+
+namespace exeray {
+namespace arena_test {
+
+class GrowableArenaTest : public ArenaTest {
+protected:
+    static constexpr std::size_t kInitial = Arena::kCommitChunk;
+    static constexpr std::size_t kCeiling = 16 * Arena::kCommitChunk;
+
+    Arena arena_{kInitial, ArenaOptions{.max_capacity = kCeiling}};
+
+    void SetUp() override {
+        if (arena_.backend() != ArenaBackend::Virtual) {
+            GTEST_SKIP() << "address space reservation unavailable";
+        }
+    }
+};
+
+TEST_F(GrowableArenaTest, Construct_CommitsInitialReservesCeiling) {
+    EXPECT_EQ(arena_.capacity(), kCeiling);
+    EXPECT_EQ(arena_.committed(), kInitial);
+    EXPECT_EQ(arena_.used(), 0U);
+}
+
+TEST_F(GrowableArenaTest, Allocate_PastInitial_GrowsInPlace) {
+    auto* first = arena_.allocate<std::uint8_t>(kInitial);
+    ASSERT_NE(first, nullptr);
+    std::memset(first, 0x11, kInitial);
+
+    auto* grown = arena_.allocate<std::uint8_t>(3 * Arena::kCommitChunk);
+    ASSERT_NE(grown, nullptr);
+    std::memset(grown, 0x22, 3 * Arena::kCommitChunk);
+    EXPECT_EQ(arena_.committed(), 4 * Arena::kCommitChunk);
+
+    // Pointers stay stable and offsets stay relative to the same base
+    EXPECT_EQ(first, arena_.base());
+    EXPECT_EQ(static_cast<std::size_t>(grown - arena_.base()), kInitial);
+    EXPECT_EQ(first[kInitial - 1], 0x11);
+}
+
+TEST_F(GrowableArenaTest, Allocate_BeyondCeiling_ReturnsNullptr) {
+    ASSERT_NE(arena_.allocate<std::uint8_t>(kCeiling), nullptr);
+    EXPECT_EQ(arena_.committed(), kCeiling);
+    EXPECT_EQ(arena_.allocate<std::uint8_t>(), nullptr);
+}
+
+TEST_F(GrowableArenaTest, Allocate_ConcurrentGrowth_AllWritable) {
+    constexpr int kThreads = 4;
+    std::atomic<std::size_t> allocated{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([this, &allocated, t] {
+            for (int i = 0; i < 200; ++i) {
+                auto* block = arena_.allocate<Huge>(1);
+                if (block == nullptr) {
+                    return;
+                }
+                std::memset(block, t, sizeof(Huge));
+                allocated.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(allocated.load(), kCeiling / sizeof(Huge));
+    EXPECT_EQ(arena_.committed(), kCeiling);
+}
+
+TEST_F(ArenaTest, Growable_CeilingNotAboveCapacity_StaysFixed) {
+    Arena arena{kDefaultCapacity, ArenaOptions{.max_capacity = kDefaultCapacity / 2}};
+    EXPECT_EQ(arena.backend(), ArenaBackend::Heap);
+    EXPECT_EQ(arena.capacity(), kDefaultCapacity);
+}
+
+TEST_F(ArenaTest, Growable_LargePages_GrowthTakesPrecedence) {
+    Arena arena{Arena::kCommitChunk,
+                ArenaOptions{.large_pages = true, .max_capacity = 4 * Arena::kCommitChunk}};
+    EXPECT_NE(arena.backend(), ArenaBackend::LargePages);
+    EXPECT_NE(arena.allocate<std::uint8_t>(Arena::kCommitChunk), nullptr);
+}
+
+}  // namespace arena_test
+}  // namespace exeray
@@ -0,0 +1,136 @@
+#include "arena_test_common.hpp"
+
+namespace exeray {
+namespace arena_test {
+
+class LocalArenaTest : public ArenaTest {
+protected:
+    // Large enough for full-size blocks
+    static constexpr std::size_t kLocalCapacity = 64 * Arena::kLocalBlock;
+
+    Arena arena_{kLocalCapacity};
+};
+
+TEST_F(LocalArenaTest, AllocateLocal_Bytes_PackedWithoutPadding) {
+    char* first = arena_.allocate_local<char>(10);
+    char* second = arena_.allocate_local<char>(10);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(second, first + 10);
+}
+
+TEST_F(LocalArenaTest, AllocateLocal_NaturalAlignment) {
+    ASSERT_NE(arena_.allocate_local<Tiny>(), nullptr);
+    auto* a8 = arena_.allocate_local<Aligned8>();
+    auto* a16 = arena_.allocate_local<Aligned16>();
+    auto* a32 = arena_.allocate_local<Aligned32>();
+    auto* cl = arena_.allocate_local<CacheLine>();
+    ASSERT_NE(a8, nullptr);
+    ASSERT_NE(a16, nullptr);
+    ASSERT_NE(a32, nullptr);
+    ASSERT_NE(cl, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(a8) % 8, 0U);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(a16) % 16, 0U);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(a32) % 32, 0U);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(cl) % 64, 0U);
+}
+
+TEST_F(LocalArenaTest, AllocateLocal_SmallObjects_OneBlockClaimed) {
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_NE(arena_.allocate_local<std::uint32_t>(4), nullptr);
+    }
+    // 16000 bytes fit in the first block: one shared-offset claim
+    EXPECT_EQ(arena_.used(), Arena::kLocalBlock);
+}
+
+TEST_F(LocalArenaTest, AllocateLocal_BlockFull_ClaimsNext) {
+    for (std::size_t i = 0; i < Arena::kLocalBlock / 64 + 1; ++i) {
+        ASSERT_NE(arena_.allocate_local<CacheLine>(), nullptr);
+    }
+    EXPECT_EQ(arena_.used(), 2 * Arena::kLocalBlock);
+}
+
+TEST_F(LocalArenaTest, AllocateLocal_LargeRequest_BypassesBuffer) {
+    auto* small = arena_.allocate_local<char>();
+    ASSERT_NE(small, nullptr);
+    const auto used = arena_.used();
+
+    auto* large = arena_.allocate_local<char>(Arena::kLocalBlock / 2);
+    ASSERT_NE(large, nullptr);
+    EXPECT_EQ(arena_.used(), used + Arena::kLocalBlock / 2);
+    // The thread buffer is still current
+    EXPECT_EQ(arena_.allocate_local<char>(), small + 1);
+}
+
+TEST_F(LocalArenaTest, AllocateLocal_Reset_DropsBuffer) {
+    ASSERT_NE(arena_.allocate_local<char>(100), nullptr);
+    arena_.reset();
+    EXPECT_EQ(arena_.allocate_local<char>(), reinterpret_cast<const char*>(arena_.base()));
+}
+
+TEST_F(LocalArenaTest, AllocateLocal_SeparateArenas_SeparateBuffers) {
+    Arena other{kLocalCapacity};
+    char* a = arena_.allocate_local<char>();
+    char* b = other.allocate_local<char>();
+    char* a2 = arena_.allocate_local<char>();
+    char* b2 = other.allocate_local<char>();
+    EXPECT_EQ(a2, a + 1);
+    EXPECT_EQ(b2, b + 1);
+    EXPECT_EQ(reinterpret_cast<const char*>(other.base()), b);
+}
+
+TEST_F(LocalArenaTest, AllocateLocal_Threads_DisjointBlocks) {
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 1000;
+    std::vector<std::vector<std::uint64_t*>> pointers(kThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([this, &pointers, t] {
+            for (int i = 0; i < kPerThread; ++i) {
+                auto* value = arena_.allocate_local<std::uint64_t>();
+                if (value != nullptr) {
+                    *value = static_cast<std::uint64_t>(t) << 32 | static_cast<std::uint64_t>(i);
+                    pointers[t].push_back(value);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::set<const std::uint8_t*> blocks[kThreads];
+    for (int t = 0; t < kThreads; ++t) {
+        ASSERT_EQ(pointers[t].size(), static_cast<std::size_t>(kPerThread));
+        for (int i = 0; i < kPerThread; ++i) {
+            EXPECT_EQ(*pointers[t][i],
+                      static_cast<std::uint64_t>(t) << 32 | static_cast<std::uint64_t>(i));
+            const auto offset = reinterpret_cast<const std::uint8_t*>(pointers[t][i]) -
+                                arena_.base();
+            blocks[t].insert(arena_.base() +
+                             offset / Arena::kLocalBlock * Arena::kLocalBlock);
+        }
+    }
+    // Each thread wrote into its own block
+    for (int t = 0; t < kThreads; ++t) {
+        for (int u = t + 1; u < kThreads; ++u) {
+            for (const auto* block : blocks[t]) {
+                EXPECT_EQ(blocks[u].count(block), 0U);
+            }
+        }
+    }
+}
+
+TEST_F(ArenaTest, AllocateLocal_ArenaSmallerThanBlock_ExactFit) {
+    Arena arena{1024};
+    char* first = arena.allocate_local<char>(100);
+    char* second = arena.allocate_local<char>(100);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(second, first + 100);
+    EXPECT_EQ(arena.used(), 200U);
+    EXPECT_EQ(arena.allocate_local<char>(1000), nullptr);
+}
+
+}  // namespace arena_test
+}  // namespace exeray
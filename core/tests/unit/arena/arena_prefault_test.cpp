@@ -0,0 +1,96 @@
+#include "arena_test_common.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace exeray {
+namespace arena_test {
+
+namespace {
+
+/// @brief Wait up to a few seconds for the prefault thread to commit bytes.
+bool committed_at_least(const Arena& arena, std::size_t bytes) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (arena.committed() < bytes) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST_F(ArenaTest, Prefault_KeepsAWindowAheadOfTheOffset) {
+    constexpr std::size_t kCapacity = 16 * Arena::kCommitChunk;
+    constexpr std::size_t kWindow = 2 * Arena::kCommitChunk;
+    Arena arena{kCapacity, ArenaOptions{.lazy_commit = true, .prefault = kWindow}};
+    if (arena.backend() != ArenaBackend::Virtual) {
+        GTEST_SKIP() << "address space reservation unavailable";
+    }
+    EXPECT_TRUE(committed_at_least(arena, kWindow));
+    EXPECT_LT(arena.committed(), kCapacity);
+
+    // Using more than half the window asks for the next one
+    auto* block = arena.allocate<std::uint8_t>(Arena::kCommitChunk + 64);
+    ASSERT_NE(block, nullptr);
+    std::memset(block, 0xAB, Arena::kCommitChunk + 64);
+    EXPECT_TRUE(committed_at_least(arena, 4 * Arena::kCommitChunk));
+    EXPECT_EQ(block[Arena::kCommitChunk], 0xAB);
+
+    // Up to the capacity and no further
+    ASSERT_NE(arena.allocate<std::uint8_t>(kCapacity - 2 * Arena::kCommitChunk), nullptr);
+    EXPECT_TRUE(committed_at_least(arena, kCapacity));
+    EXPECT_EQ(arena.committed(), kCapacity);
+}
+
+TEST_F(ArenaTest, Prefault_ConcurrentWritersKeepTheirBytes) {
+    constexpr std::size_t kCapacity = 32 * Arena::kCommitChunk;
+    Arena arena{kCapacity, ArenaOptions{.lazy_commit = true, .prefault = Arena::kCommitChunk}};
+
+    std::vector<std::thread> writers;
+    std::atomic<int> corrupted{0};
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([&arena, &corrupted, t] {
+            const auto value = static_cast<std::uint8_t>(t + 1);
+            for (int i = 0; i < 256; ++i) {
+                auto* block = arena.allocate<std::uint8_t>(16 * 1024);
+                if (block == nullptr) {
+                    return;
+                }
+                std::memset(block, value, 16 * 1024);
+                if (block[0] != value || block[16 * 1024 - 1] != value) {
+                    corrupted.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+    EXPECT_EQ(corrupted.load(), 0);
+}
+
+TEST_F(ArenaTest, Zeroed_OnlyFreshMappedMemory) {
+    Arena heap{kDefaultCapacity};
+    EXPECT_FALSE(heap.zeroed(heap.allocate<std::uint8_t>(64)));
+
+    Arena arena{4 * Arena::kCommitChunk, ArenaOptions{.lazy_commit = true}};
+    if (arena.backend() != ArenaBackend::Virtual) {
+        GTEST_SKIP() << "address space reservation unavailable";
+    }
+    auto* first = arena.allocate<std::uint8_t>(4096);
+    ASSERT_NE(first, nullptr);
+    EXPECT_TRUE(arena.zeroed(first));
+    std::memset(first, 0xCD, 4096);
+
+    // Handed out before the reset: no longer known to be zero
+    arena.reset();
+    EXPECT_FALSE(arena.zeroed(arena.allocate<std::uint8_t>(4096)));
+    EXPECT_TRUE(arena.zeroed(arena.allocate<std::uint8_t>(4096)));
+}
+
+}  // namespace arena_test
+}  // namespace exeray
@@ -0,0 +1,76 @@
+#include "arena_test_common.hpp"
+
+namespace exeray {
+namespace arena_test {
+
+TEST_F(ArenaTest, Stats_Fresh_AllZeroButCapacity) {
+    Arena arena{kDefaultCapacity};
+    const ArenaStats stats = arena.stats();
+    EXPECT_EQ(stats.used, 0U);
+    EXPECT_EQ(stats.capacity, kDefaultCapacity);
+    EXPECT_EQ(stats.reserved, kDefaultCapacity);
+    EXPECT_EQ(stats.committed, kDefaultCapacity);
+    EXPECT_EQ(stats.high_water, 0U);
+    EXPECT_EQ(stats.padding, 0U);
+    EXPECT_EQ(stats.failures, 0U);
+}
+
+TEST_F(ArenaTest, Stats_Padding_CountsAlignmentGaps) {
+    Arena arena{kDefaultCapacity};
+    ASSERT_NE(arena.allocate<Tiny>(), nullptr);
+    ASSERT_NE(arena.allocate<Tiny>(), nullptr);
+    ASSERT_NE(arena.allocate<Tiny>(), nullptr);
+    // Each Tiny after the first pads 63 bytes up to the next cache line
+    EXPECT_EQ(arena.stats().padding, 2U * 63);
+    EXPECT_EQ(arena.stats().used, 2U * 64 + 1);
+}
+
+TEST_F(ArenaTest, Stats_Failures_CountRefusedAllocations) {
+    Arena arena{1024};
+    EXPECT_EQ(arena.allocate<std::uint8_t>(2048), nullptr);
+    EXPECT_EQ(arena.allocate_local<std::uint8_t>(2048), nullptr);
+    EXPECT_EQ(arena.allocate<std::uint64_t>(std::numeric_limits<std::size_t>::max()),
+              nullptr);
+    EXPECT_NE(arena.allocate<std::uint8_t>(16), nullptr);
+    EXPECT_EQ(arena.stats().failures, 3U);
+}
+
+TEST_F(ArenaTest, Stats_LocalBufferRefill_CountsAbandonedTail) {
+    Arena arena{64 * Arena::kLocalBlock};
+    ASSERT_NE(arena.allocate_local<char>(Arena::kLocalBlock - 100), nullptr);
+    EXPECT_EQ(arena.used(), Arena::kLocalBlock - 100);  // Bypassed: too large
+
+    ASSERT_NE(arena.allocate_local<char>(1000), nullptr);   // Claims a block
+    const auto before = arena.stats().padding;
+    for (std::size_t i = 0; i < Arena::kLocalBlock / 1000; ++i) {
+        ASSERT_NE(arena.allocate_local<char>(1000), nullptr);
+    }
+    // One refill abandoned a tail of 1000 * k bytes short of the block
+    EXPECT_EQ(arena.stats().padding - before, Arena::kLocalBlock % 1000);
+}
+
+TEST_F(ArenaTest, Stats_HighWater_SurvivesReset) {
+    Arena arena{kDefaultCapacity};
+    ASSERT_NE(arena.allocate<std::uint8_t>(4096), nullptr);
+    arena.reset();
+    ASSERT_NE(arena.allocate<std::uint8_t>(100), nullptr);
+
+    const ArenaStats stats = arena.stats();
+    EXPECT_EQ(stats.used, 100U);
+    EXPECT_EQ(stats.high_water, 4096U);
+    EXPECT_EQ(stats.padding, 0U);
+}
+
+TEST_F(ArenaTest, Stats_LazyCommit_ReportsReservation) {
+    Arena arena{Arena::kCommitChunk + 1, ArenaOptions{.lazy_commit = true}};
+    if (arena.backend() != ArenaBackend::Virtual) {
+        GTEST_SKIP() << "address space reservation unavailable";
+    }
+    const ArenaStats stats = arena.stats();
+    EXPECT_EQ(stats.reserved, 2 * Arena::kCommitChunk);
+    EXPECT_EQ(stats.capacity, Arena::kCommitChunk + 1);
+    EXPECT_EQ(stats.committed, 0U);
+}
+
+}  // namespace arena_test
+}  // namespace exeray
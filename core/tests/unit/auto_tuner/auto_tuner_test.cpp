@@ -0,0 +1,159 @@
+/// @file auto_tuner_test.cpp
+/// @brief Tests for the auto-tuner policy and its metric signals.
+
+#include <gtest/gtest.h>
+
+#include "exeray/auto_tuner.hpp"
+
+#include <vector>
+
+namespace exeray {
+namespace {
+
+constexpr TuningState kInitial{.batch = 512, .workers = 2, .sample_percent = 50,
+                               .drop_percent = 80};
+
+AutoTuneConfig bounds() {
+    AutoTuneConfig config;
+    config.enabled = true;
+    config.min_batch = 128;
+    config.max_batch = 2048;
+    config.min_workers = 1;
+    config.max_workers = 4;
+    config.min_sample_percent = 30;
+    config.latency_target_ms = 500;
+    config.quiet_intervals = 2;
+    return config;
+}
+
+/// @brief Tuner primed with a zero baseline.
+AutoTuner primed(const AutoTuneConfig& config = bounds(), unsigned processors = 4) {
+    AutoTuner tuner(config, kInitial, processors);
+    tuner.step({}, 1.0);
+    return tuner;
+}
+
+TEST(AutoTunerTest, FirstStep_OnlyRecordsBaseline) {
+    AutoTuner tuner(bounds(), kInitial, 4);
+
+    EXPECT_EQ(tuner.step({.lost = 1000}, 1.0), kInitial);
+    EXPECT_TRUE(tuner.reason().empty());
+}
+
+TEST(AutoTunerTest, Loss_GrowsBatchAndShedsEarlier) {
+    AutoTuner tuner = primed();
+
+    const TuningState state = tuner.step({.lost = 10}, 1.0);
+
+    EXPECT_EQ(state.batch, 1024U);
+    EXPECT_EQ(state.sample_percent, 40U);
+    EXPECT_EQ(state.drop_percent, 70U);
+    EXPECT_EQ(state.workers, 2U);
+    EXPECT_EQ(tuner.reason(), "events lost");
+}
+
+TEST(AutoTunerTest, Loss_StaysWithinBounds) {
+    AutoTuner tuner = primed();
+    for (int i = 1; i <= 10; ++i) {
+        tuner.step({.lost = 10.0 * i}, 1.0);
+    }
+
+    EXPECT_EQ(tuner.state().batch, 2048U);
+    EXPECT_EQ(tuner.state().sample_percent, 30U);
+    EXPECT_EQ(tuner.state().drop_percent, 60U);
+
+    tuner.step({.lost = 200}, 1.0);
+    EXPECT_TRUE(tuner.reason().empty()) << "No move left, so no change is reported";
+}
+
+TEST(AutoTunerTest, Backlog_AddsWorkersUpToMax) {
+    AutoTuner tuner = primed();
+
+    for (int i = 0; i < 5; ++i) {
+        tuner.step({.backlog = 1e6}, 1.0);
+    }
+
+    EXPECT_EQ(tuner.state().workers, 4U);
+    EXPECT_EQ(tuner.state().batch, 512U);
+}
+
+TEST(AutoTunerTest, CpuOverBudget_RemovesWorkersAndSheds) {
+    AutoTuneConfig config = bounds();
+    config.cpu_budget_percent = 25;
+    AutoTuner tuner = primed(config, 4);
+
+    // 2 CPU seconds in 1 s on 4 processors: 50%
+    const TuningState state = tuner.step({.cpu_seconds = 2.0}, 1.0);
+
+    EXPECT_EQ(state.workers, 1U);
+    EXPECT_EQ(state.sample_percent, 40U);
+    EXPECT_EQ(tuner.reason(), "CPU over budget");
+}
+
+TEST(AutoTunerTest, HighLatency_ShrinksBatch) {
+    AutoTuner tuner = primed();
+
+    const TuningState state = tuner.step({.latency_s = 2.0}, 1.0);
+
+    EXPECT_EQ(state.batch, 256U);
+    EXPECT_EQ(tuner.reason(), "latency above target");
+}
+
+TEST(AutoTunerTest, Quiet_RelaxesTowardInitial) {
+    AutoTuner tuner = primed();
+    tuner.step({.lost = 10}, 1.0);
+    tuner.step({.lost = 20}, 1.0);
+    ASSERT_EQ(tuner.state().batch, 2048U);
+
+    tuner.step({.lost = 20}, 1.0);
+    EXPECT_TRUE(tuner.reason().empty()) << "One quiet interval is not enough";
+    tuner.step({.lost = 20}, 1.0);
+    EXPECT_EQ(tuner.reason(), "quiet");
+    EXPECT_EQ(tuner.state().batch, 1024U);
+    EXPECT_EQ(tuner.state().sample_percent, 40U);
+
+    for (int i = 0; i < 4; ++i) {
+        tuner.step({.lost = 20}, 1.0);
+    }
+    EXPECT_EQ(tuner.state(), kInitial);
+}
+
+TEST(AutoTunerTest, InlineDetection_WorkersUntouched) {
+    TuningState inline_detection = kInitial;
+    inline_detection.workers = 0;
+    AutoTuner tuner(bounds(), inline_detection, 4);
+    tuner.step({}, 1.0);
+
+    tuner.step({.backlog = 1e6}, 1.0);
+
+    EXPECT_EQ(tuner.state().workers, 0U);
+}
+
+TEST(AutoTunerTest, Signals_FromMetricsSnapshot) {
+    std::vector<MetricSample> samples;
+    const auto add = [&samples](const char* name, double value, std::string labels = {}) {
+        MetricSample& sample = samples.emplace_back();
+        sample.name = name;
+        sample.value = value;
+        sample.labels = std::move(labels);
+    };
+    add("exeray_etw_events_lost_total", 3);
+    add("exeray_etw_buffers_lost_total", 1);
+    add("exeray_ring_overflows_total", 2);
+    add("exeray_detection_backlog", 700);
+    add("exeray_ingest_latency_seconds", 9.0,
+        metric_label("stage", "delivered") + "," + metric_label("quantile", "0.99"));
+    add("exeray_ingest_latency_seconds", 0.25,
+        metric_label("stage", "visible") + "," + metric_label("quantile", "0.99"));
+    add("exeray_process_cpu_seconds_total", 12.5);
+
+    const TuningSignals signals = TuningSignals::from(samples);
+
+    EXPECT_DOUBLE_EQ(signals.lost, 6.0);
+    EXPECT_DOUBLE_EQ(signals.backlog, 700.0);
+    EXPECT_DOUBLE_EQ(signals.latency_s, 0.25);
+    EXPECT_DOUBLE_EQ(signals.cpu_seconds, 12.5);
+}
+
+}  // namespace
+}  // namespace exeray
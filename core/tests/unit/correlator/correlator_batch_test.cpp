@@ -0,0 +1,248 @@
+#include "correlator_test_common.hpp"
+
+#include "exeray/event/graph.hpp"
+
+using namespace exeray::event;
+using exeray::event::testing::CorrelatorTest;
+
+namespace {
+
+PendingEvent make_pending(Category category, uint32_t pid, uint32_t parent_pid = 0) {
+    PendingEvent event{};
+    event.category = category;
+    event.payload.category = category;
+    switch (category) {
+        case Category::Process:
+            event.payload.process.pid = pid;
+            event.payload.process.parent_pid = parent_pid;
+            break;
+        case Category::Thread:
+            event.payload.thread.process_id = pid;
+            break;
+        case Category::Memory:
+            event.payload.memory.process_id = pid;
+            break;
+        case Category::Image:
+            event.payload.image.process_id = pid;
+            break;
+        default:
+            break;
+    }
+    return event;
+}
+
+}  // namespace
+
+// ============================================================================
+// Batch Resolution
+// ============================================================================
+
+TEST_F(CorrelatorTest, ResolveBatch_Empty_NoOp) {
+    correlator_.resolve_batch({});
+
+    EXPECT_EQ(correlator_.get_correlation_id(1234), 1U);
+}
+
+TEST_F(CorrelatorTest, ResolveBatch_Parents_ByCategory) {
+    correlator_.register_process(100, 7);
+    correlator_.register_process(200, 9);
+
+    std::vector<PendingEvent> batch = {
+        make_pending(Category::Process, 200, 100),  // Child of 100's create
+        make_pending(Category::Thread, 200),
+        make_pending(Category::Memory, 200),
+        make_pending(Category::Image, 100),
+        make_pending(Category::FileSystem, 0),
+    };
+    correlator_.resolve_batch(batch);
+
+    EXPECT_EQ(batch[0].parent, 7U);
+    EXPECT_EQ(batch[1].parent, 9U);
+    EXPECT_EQ(batch[2].parent, 9U);
+    EXPECT_EQ(batch[3].parent, 7U);
+    EXPECT_EQ(batch[4].parent, INVALID_EVENT);
+    EXPECT_EQ(batch[4].correlation_id, 0U);
+}
+
+TEST_F(CorrelatorTest, ResolveBatch_MatchesPerEventCalls) {
+    std::vector<PendingEvent> batch = {
+        make_pending(Category::Thread, 10),
+        make_pending(Category::Process, 20, 10),
+        make_pending(Category::Image, 30),
+        make_pending(Category::Thread, 20),
+        make_pending(Category::Process, 40, 30),
+        make_pending(Category::Memory, 10),
+    };
+
+    Correlator reference;
+    reference.register_process(10, 3);
+    correlator_.register_process(10, 3);
+    std::vector<uint32_t> expected_corr;
+    std::vector<EventId> expected_parent;
+    expected_corr.push_back(reference.get_correlation_id(10));
+    expected_parent.push_back(reference.find_thread_parent(10));
+    expected_corr.push_back(reference.get_correlation_id(20, 10));
+    expected_parent.push_back(reference.find_process_parent(10));
+    expected_corr.push_back(reference.get_correlation_id(30));
+    expected_parent.push_back(reference.find_operation_parent(30));
+    expected_corr.push_back(reference.get_correlation_id(20));
+    expected_parent.push_back(reference.find_thread_parent(20));
+    expected_corr.push_back(reference.get_correlation_id(40, 30));
+    expected_parent.push_back(reference.find_process_parent(30));
+    expected_corr.push_back(reference.get_correlation_id(10));
+    expected_parent.push_back(reference.find_operation_parent(10));
+
+    correlator_.resolve_batch(batch);
+
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        EXPECT_EQ(batch[i].correlation_id, expected_corr[i]) << i;
+        EXPECT_EQ(batch[i].parent, expected_parent[i]) << i;
+    }
+}
+
+TEST_F(CorrelatorTest, ResolveBatch_ChildInheritsFromSameBatch) {
+    std::vector<PendingEvent> batch = {
+        make_pending(Category::Thread, 1000),
+        make_pending(Category::Process, 2000, 1000),
+    };
+    correlator_.resolve_batch(batch);
+
+    EXPECT_GT(batch[0].correlation_id, 0U);
+    EXPECT_EQ(batch[1].correlation_id, batch[0].correlation_id);
+    EXPECT_EQ(correlator_.get_correlation_id(2000), batch[0].correlation_id);
+}
+
+TEST_F(CorrelatorTest, ResolveBatch_OverwritesStaleFields) {
+    PendingEvent event = make_pending(Category::Thread, 55);
+    event.parent = 12345;
+    event.correlation_id = 999;
+    correlator_.resolve_batch(std::span(&event, 1));
+
+    EXPECT_EQ(event.parent, INVALID_EVENT);
+    EXPECT_EQ(event.correlation_id, correlator_.get_correlation_id(55));
+}
+
+TEST_F(CorrelatorTest, ResolveBatch_ConcurrentSamePids_SameIds) {
+    constexpr int kNumThreads = 8;
+    constexpr uint32_t kPids = 64;
+
+    std::vector<std::vector<PendingEvent>> batches(kNumThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; ++t) {
+        threads.emplace_back([this, &batches, t]() {
+            for (uint32_t pid = 1; pid <= kPids; ++pid) {
+                batches[t].push_back(make_pending(Category::Thread, pid));
+            }
+            correlator_.resolve_batch(batches[t]);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int t = 1; t < kNumThreads; ++t) {
+        for (uint32_t i = 0; i < kPids; ++i) {
+            EXPECT_EQ(batches[t][i].correlation_id, batches[0][i].correlation_id);
+        }
+    }
+}
+
+// ============================================================================
+// Single Resolution
+// ============================================================================
+
+TEST_F(CorrelatorTest, Resolve_MatchesSeparateLookups) {
+    correlator_.register_process(100, 7);
+    const uint32_t parent_corr = correlator_.get_correlation_id(100);
+
+    const PendingEvent child = make_pending(Category::Process, 200, 100);
+    const Correlation resolved = correlator_.resolve(child);
+    EXPECT_EQ(resolved.parent, 7U);
+    EXPECT_EQ(resolved.correlation_id, parent_corr);
+    EXPECT_EQ(correlator_.get_correlation_id(200), parent_corr);
+
+    const Correlation orphan = correlator_.resolve(make_pending(Category::Thread, 300));
+    EXPECT_EQ(orphan.parent, INVALID_EVENT);
+    EXPECT_NE(orphan.correlation_id, 0U);
+    EXPECT_NE(orphan.correlation_id, parent_corr);
+}
+
+TEST_F(CorrelatorTest, ResolveBatch_InheritsAcrossShards) {
+    // PIDs in every shard, each the child of the previous one
+    std::vector<PendingEvent> batch;
+    for (uint32_t i = 1; i <= 2 * Correlator::kShards; ++i) {
+        batch.push_back(make_pending(Category::Process, 4 * (i + 1), 4 * i));
+    }
+    correlator_.resolve_batch(batch);
+    for (const PendingEvent& event : batch) {
+        EXPECT_EQ(event.correlation_id, batch.front().correlation_id);
+    }
+}
+
+// ============================================================================
+// Header PIDs
+// ============================================================================
+
+namespace {
+
+PendingEvent make_header_event(Category category, uint32_t header_pid, Timestamp at = 0) {
+    PendingEvent event{};
+    event.category = category;
+    event.payload.category = category;
+    event.pid = header_pid;
+    event.timestamp = at;
+    return event;
+}
+
+}  // namespace
+
+TEST_F(CorrelatorTest, ResolveBatch_AllCategoriesUseHeaderPid) {
+    correlator_.register_process(100, 7);
+    const uint32_t corr = correlator_.get_correlation_id(100);
+
+    std::vector<PendingEvent> batch = {
+        make_header_event(Category::FileSystem, 100),
+        make_header_event(Category::Registry, 100),
+        make_header_event(Category::Network, 100),
+        make_header_event(Category::Dns, 100),
+        make_header_event(Category::Script, 100),
+        make_header_event(Category::FileSystem, 0xFFFFFFFF),  // Not attributed
+    };
+    correlator_.resolve_batch(batch);
+    for (std::size_t i = 0; i + 1 < batch.size(); ++i) {
+        EXPECT_EQ(batch[i].parent, 7U) << i;
+        EXPECT_EQ(batch[i].correlation_id, corr) << i;
+    }
+    EXPECT_EQ(batch.back().parent, INVALID_EVENT);
+    EXPECT_EQ(batch.back().correlation_id, 0U);
+
+    // The payload's PID wins over the header's
+    PendingEvent thread = make_pending(Category::Thread, 200);
+    thread.pid = 100;
+    correlator_.resolve_batch(std::span(&thread, 1));
+    EXPECT_NE(thread.correlation_id, corr);
+}
+
+TEST_F(CorrelatorTest, ResolveBatch_BurstFollowsIncarnations) {
+    PendingEvent create_old = make_pending(Category::Process, 100);
+    create_old.timestamp = 1000;
+    correlator_.resolve_batch(std::span(&create_old, 1));
+    correlator_.register_process(100, 7, 1000);
+
+    PendingEvent create_new = make_pending(Category::Process, 100);
+    create_new.timestamp = 3000;
+    std::vector<PendingEvent> batch = {
+        make_header_event(Category::FileSystem, 100, 2000),
+        make_header_event(Category::FileSystem, 100, 2500),
+        create_new,  // PID reused in the middle of the burst
+        make_header_event(Category::FileSystem, 100, 3500),
+        make_header_event(Category::FileSystem, 100, 2800),  // Late
+    };
+    correlator_.resolve_batch(batch);
+    EXPECT_EQ(batch[0].correlation_id, create_old.correlation_id);
+    EXPECT_EQ(batch[1].correlation_id, create_old.correlation_id);
+    EXPECT_NE(batch[2].correlation_id, create_old.correlation_id);
+    EXPECT_EQ(batch[3].correlation_id, batch[2].correlation_id);
+    EXPECT_EQ(batch[4].correlation_id, create_old.correlation_id);
+    EXPECT_EQ(batch[4].parent, 7U);
+}
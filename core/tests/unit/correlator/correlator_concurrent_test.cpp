@@ -1,5 +1,7 @@
 #include "correlator_test_common.hpp"
 
+#include "exeray/event/graph.hpp"
+
 using namespace exeray::event;
 using exeray::event::testing::CorrelatorTest;
 
@@ -149,3 +151,31 @@ TEST_F(CorrelatorTest, GetCorrelationId_ConcurrentDifferentPids_AllUnique) {
 }
 
 
+
+TEST_F(CorrelatorTest, ConcurrentCrossShardBatches_NoDeadlock) {
+    constexpr int kNumThreads = 8;
+    constexpr uint32_t kBatches = 500;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; ++t) {
+        threads.emplace_back([this, t]() {
+            for (uint32_t b = 0; b < kBatches; ++b) {
+                // Children and parents in different shards, in both orders
+                std::vector<PendingEvent> batch(4);
+                for (uint32_t i = 0; i < batch.size(); ++i) {
+                    const uint32_t pid = 4 * (1 + ((b * 7 + i * 5 + t) % 64));
+                    batch[i].category = Category::Process;
+                    batch[i].payload.category = Category::Process;
+                    batch[i].payload.process.pid = pid + 4096 * (b + 1);
+                    batch[i].payload.process.parent_pid = (t % 2 == 0) ? pid : pid + 4;
+                }
+                correlator_.resolve_batch(batch);
+                correlator_.register_process(batch[0].payload.process.pid, b + 1);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_NE(correlator_.get_correlation_id(4), 0U);
+}
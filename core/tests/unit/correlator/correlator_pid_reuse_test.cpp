@@ -0,0 +1,109 @@
+#include "correlator_test_common.hpp"
+
+#include "exeray/event/graph.hpp"
+
+using namespace exeray::event;
+using exeray::event::testing::CorrelatorTest;
+
+namespace {
+
+constexpr uint32_t kParent = 100;
+constexpr uint32_t kReused = 200;
+
+PendingEvent make_process(ProcessOp op, uint32_t pid, uint32_t parent_pid, Timestamp at) {
+    PendingEvent event{};
+    event.category = Category::Process;
+    event.operation = static_cast<uint8_t>(op);
+    event.payload.category = Category::Process;
+    event.payload.process.pid = pid;
+    event.payload.process.parent_pid = parent_pid;
+    event.timestamp = at;
+    return event;
+}
+
+PendingEvent make_thread(uint32_t pid, Timestamp at) {
+    PendingEvent event{};
+    event.category = Category::Thread;
+    event.payload.category = Category::Thread;
+    event.payload.thread.process_id = pid;
+    event.timestamp = at;
+    return event;
+}
+
+/// @brief Resolve a create and register its event, as the consumer does.
+Correlation create(Correlator& correlator, uint32_t pid, uint32_t parent_pid, Timestamp at,
+                   EventId id) {
+    const Correlation result =
+        correlator.resolve(make_process(ProcessOp::Create, pid, parent_pid, at));
+    correlator.register_process(pid, id, at);
+    return result;
+}
+
+}  // namespace
+
+TEST_F(CorrelatorTest, PidReuse_NewProcessGetsOwnTree) {
+    const Correlation first = create(correlator_, kReused, 0, 1000, 10);
+    auto stop = std::array{make_process(ProcessOp::Terminate, kReused, 0, 2000)};
+    correlator_.resolve_batch(stop);
+    EXPECT_EQ(stop[0].correlation_id, first.correlation_id);
+
+    // Same PID, different parent: neither the old tree nor its create event
+    const uint32_t parent_corr = create(correlator_, kParent, 0, 500, 20).correlation_id;
+    const Correlation second = create(correlator_, kReused, kParent, 3000, 30);
+    EXPECT_NE(second.correlation_id, first.correlation_id);
+    EXPECT_EQ(second.correlation_id, parent_corr);
+    EXPECT_EQ(second.parent, 20U);
+    EXPECT_EQ(correlator_.find_process_parent(kReused), 30U);
+    EXPECT_EQ(correlator_.get_correlation_id(kReused), second.correlation_id);
+}
+
+TEST_F(CorrelatorTest, PidReuse_LateEventsResolveToTheirIncarnation) {
+    const Correlation first = create(correlator_, kReused, 0, 1000, 10);
+    const Correlation second = create(correlator_, kReused, 0, 3000, 30);
+
+    std::array batch = {make_thread(kReused, 3500), make_thread(kReused, 1500)};
+    correlator_.resolve_batch(batch);
+    EXPECT_EQ(batch[0].parent, 30U);
+    EXPECT_EQ(batch[0].correlation_id, second.correlation_id);
+    EXPECT_EQ(batch[1].parent, 10U);  // Delivered late, before the reuse
+    EXPECT_EQ(batch[1].correlation_id, first.correlation_id);
+
+    EXPECT_EQ(correlator_.find_process_parent(kReused, 2000), 10U);
+    EXPECT_EQ(correlator_.find_process_parent(kReused, 3000), 30U);
+}
+
+TEST_F(CorrelatorTest, PidReuse_ChildOfDeadParentDoesNotInherit) {
+    const uint32_t old_corr = create(correlator_, kParent, 0, 1000, 10).correlation_id;
+    auto stop = std::array{make_process(ProcessOp::Terminate, kParent, 0, 2000)};
+    correlator_.resolve_batch(stop);
+    const uint32_t new_corr = create(correlator_, kParent, 0, 3000, 30).correlation_id;
+
+    // A child created by the first parent, delivered after the reuse
+    const Correlation child = create(correlator_, 300, kParent, 1500, 40);
+    EXPECT_EQ(child.parent, 10U);
+    EXPECT_EQ(child.correlation_id, old_corr);
+    EXPECT_NE(child.correlation_id, new_corr);
+}
+
+TEST_F(CorrelatorTest, PidReuse_HistoryBounded) {
+    for (Timestamp life = 1; life <= Correlator::kHistory + 2; ++life) {
+        create(correlator_, kReused, 0, life * 1000, life);
+    }
+    // Oldest lives forgotten: the earliest remembered one answers instead
+    EXPECT_EQ(correlator_.find_process_parent(kReused, 1500), INVALID_EVENT);
+    EXPECT_EQ(correlator_.find_process_parent(kReused, 3500), 3U);
+    EXPECT_EQ(correlator_.find_process_parent(kReused), Correlator::kHistory + 2);
+}
+
+TEST_F(CorrelatorTest, PidReuse_TerminatedProcessesForgottenWhenFull) {
+    // PIDs of one shard: multiples of 4 * kShards
+    const uint32_t step = 4 * Correlator::kShards;
+    for (uint32_t i = 1; i <= Correlator::kMaxPidsPerShard + 10; ++i) {
+        create(correlator_, i * step, 0, 1000, i);
+        auto stop = std::array{make_process(ProcessOp::Terminate, i * step, 0, 2000)};
+        correlator_.resolve_batch(stop);
+    }
+    EXPECT_EQ(correlator_.find_process_parent(step), INVALID_EVENT);
+    EXPECT_EQ(correlator_.find_process_parent((Correlator::kMaxPidsPerShard + 10) * step),
+              Correlator::kMaxPidsPerShard + 10);
+}
@@ -0,0 +1,140 @@
+#include "correlator_test_common.hpp"
+
+#include "exeray/event/graph.hpp"
+#include "exeray/event/process_tree.hpp"
+
+#include <array>
+
+using namespace exeray::event;
+using exeray::event::testing::CorrelatorTest;
+
+namespace {
+
+PendingEvent owned_by(EventId create) {
+    PendingEvent event{};
+    event.category = Category::Thread;
+    event.payload.category = Category::Thread;
+    event.parent = create;
+    return event;
+}
+
+/// Forest used below (create event IDs):
+///   1 ─┬─ 2 ─┬─ 4
+///      │     └─ 5 ── 7
+///      └─ 3
+///   6
+void build(ProcessTree& tree) {
+    tree.add(1, INVALID_EVENT, 4, 100);
+    tree.add(2, 1, 8, 200);
+    tree.add(3, 1, 12, 300);
+    tree.add(4, 2, 16, 400);
+    tree.add(5, 2, 20, 500);
+    tree.add(6, 99, 24, 600);  // Parent never seen: a root
+    tree.add(7, 5, 28, 700);
+}
+
+std::vector<EventId> creates(const std::vector<ProcessTreeNode>& nodes) {
+    std::vector<EventId> ids;
+    for (const ProcessTreeNode& node : nodes) {
+        ids.push_back(node.create);
+    }
+    return ids;
+}
+
+}  // namespace
+
+TEST(ProcessTreeTest, Adjacency) {
+    ProcessTree tree;
+    build(tree);
+    EXPECT_EQ(tree.size(), 7U);
+
+    EXPECT_EQ(creates(tree.children(1)), (std::vector<EventId>{2, 3}));
+    EXPECT_EQ(creates(tree.children(2)), (std::vector<EventId>{4, 5}));
+    EXPECT_TRUE(tree.children(3).empty());
+    EXPECT_EQ(creates(tree.ancestors(7)), (std::vector<EventId>{5, 2, 1}));
+    EXPECT_TRUE(tree.ancestors(6).empty());
+
+    EXPECT_EQ(creates(tree.descendants(2)), (std::vector<EventId>{4, 5, 7}));
+    EXPECT_EQ(creates(tree.descendants(INVALID_EVENT)),
+              (std::vector<EventId>{1, 2, 4, 5, 7, 3, 6}));
+    EXPECT_EQ(creates(tree.descendants(INVALID_EVENT, 3)), (std::vector<EventId>{1, 2, 4}));
+    EXPECT_TRUE(tree.descendants(42).empty());
+
+    const auto node = tree.node(7);
+    ASSERT_TRUE(node.has_value());
+    EXPECT_EQ(node->parent, 5U);
+    EXPECT_EQ(node->pid, 28U);
+    EXPECT_EQ(node->depth, 3U);
+    EXPECT_EQ(node->start, 700U);
+    EXPECT_EQ(tree.node(6)->parent, INVALID_EVENT);
+
+    tree.add(7, 1, 28, 700);  // Duplicate create ignored
+    EXPECT_EQ(tree.size(), 7U);
+}
+
+TEST(ProcessTreeTest, CommonAncestor) {
+    ProcessTree tree;
+    build(tree);
+    EXPECT_EQ(tree.common_ancestor(4, 7), 2U);
+    EXPECT_EQ(tree.common_ancestor(7, 3), 1U);
+    EXPECT_EQ(tree.common_ancestor(5, 7), 5U);
+    EXPECT_EQ(tree.common_ancestor(4, 4), 4U);
+    EXPECT_EQ(tree.common_ancestor(7, 6), INVALID_EVENT);
+    EXPECT_EQ(tree.common_ancestor(7, 42), INVALID_EVENT);
+}
+
+TEST(ProcessTreeTest, CommonAncestor_DeepChain) {
+    ProcessTree tree;
+    constexpr EventId kDepth = 3000;
+    tree.add(1, INVALID_EVENT, 4, 1);
+    for (EventId id = 2; id <= kDepth; ++id) {
+        tree.add(id, id - 1, 4, id);
+    }
+    tree.add(kDepth + 1, 1000, 8, 0);  // Branch off the middle
+    EXPECT_EQ(tree.common_ancestor(kDepth, kDepth + 1), 1000U);
+    EXPECT_EQ(tree.common_ancestor(kDepth, 17), 17U);
+    EXPECT_EQ(tree.node(kDepth)->depth, kDepth - 1);
+}
+
+TEST(ProcessTreeTest, Count_AddsAlongAncestors) {
+    ProcessTree tree;
+    build(tree);
+    std::array batch = {owned_by(7), owned_by(7), owned_by(4), owned_by(3), owned_by(42),
+                        owned_by(INVALID_EVENT)};
+    tree.count(batch);
+
+    EXPECT_EQ(tree.node(7)->events, 2U);
+    EXPECT_EQ(tree.node(5)->events, 0U);
+    EXPECT_EQ(tree.subtree_events(5), 2U);
+    EXPECT_EQ(tree.subtree_events(2), 3U);
+    EXPECT_EQ(tree.subtree_events(1), 4U);
+    EXPECT_EQ(tree.subtree_events(6), 0U);
+    EXPECT_EQ(tree.subtree_events(42), 0U);
+
+    tree.stop(4, 900);
+    EXPECT_EQ(tree.node(4)->stop, 900U);
+    EXPECT_EQ(tree.node(5)->stop, 0U);
+
+    tree.clear();
+    EXPECT_EQ(tree.size(), 0U);
+    EXPECT_FALSE(tree.node(1).has_value());
+}
+
+TEST_F(CorrelatorTest, ProcessTree_FollowsRegistrationAndTermination) {
+    correlator_.register_process(100, 10, 1000);
+    correlator_.register_process(200, 20, 2000, 10);
+
+    PendingEvent stop{};
+    stop.category = Category::Process;
+    stop.operation = static_cast<uint8_t>(ProcessOp::Terminate);
+    stop.payload.category = Category::Process;
+    stop.payload.process.pid = 200;
+    stop.payload.process.parent_pid = 100;
+    stop.timestamp = 3000;
+    correlator_.resolve_batch(std::span(&stop, 1));
+
+    const ProcessTree& tree = correlator_.process_tree();
+    EXPECT_EQ(creates(tree.children(10)), (std::vector<EventId>{20}));
+    EXPECT_EQ(tree.node(20)->stop, 3000U);
+    EXPECT_EQ(tree.node(10)->stop, 0U);
+}
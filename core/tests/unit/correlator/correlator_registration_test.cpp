@@ -17,6 +17,17 @@ TEST_F(CorrelatorTest, RegisterEvent_ProcessCreate_UpdatesMapping) {
     EXPECT_EQ(correlator_.find_process_parent(kPid), kEventId);
 }
 
+TEST_F(CorrelatorTest, RegisterEvent_ProcessRundown_UpdatesMapping) {
+    constexpr uint32_t kPid = 1234;
+    constexpr EventId kEventId = 42;
+
+    // A process running before the session is known only by its rundown
+    EventNode node = make_process_node(kPid, kEventId, ProcessOp::Rundown);
+    correlator_.register_event(node);
+
+    EXPECT_EQ(correlator_.find_process_parent(kPid), kEventId);
+}
+
 TEST_F(CorrelatorTest, RegisterEvent_NonProcessCreate_NoEffect) {
     constexpr uint32_t kPid = 1234;
     constexpr EventId kEventId = 42;
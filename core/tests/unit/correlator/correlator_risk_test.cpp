@@ -0,0 +1,131 @@
+#include "correlator_test_common.hpp"
+
+#include "exeray/event/graph.hpp"
+#include "exeray/event/risk_table.hpp"
+
+#include <array>
+#include <cmath>
+
+using namespace exeray::event;
+using exeray::event::testing::CorrelatorTest;
+
+namespace {
+
+constexpr Timestamp kBase = 1'000'000'000'000ULL;
+constexpr Timestamp kHalfLife = RiskTable::kDefaultHalfLife;
+
+PendingEvent make_scored(uint32_t pid, uint32_t correlation_id, Status status,
+                         Timestamp timestamp) {
+    PendingEvent event{};
+    event.category = Category::Process;
+    event.status = status;
+    event.correlation_id = correlation_id;
+    event.payload.category = Category::Process;
+    event.payload.process.pid = pid;
+    event.timestamp = timestamp;
+    return event;
+}
+
+}  // namespace
+
+// ============================================================================
+// RiskTable
+// ============================================================================
+
+TEST(RiskTableTest, Score_HalvesEveryHalfLife) {
+    RiskTable table(kHalfLife);
+    table.add(4, kBase, 8.0);
+    EXPECT_DOUBLE_EQ(table.score(4), 8.0);
+    EXPECT_NEAR(table.score(4, kBase + kHalfLife), 4.0, 1e-9);
+    EXPECT_NEAR(table.score(4, kBase + 3 * kHalfLife), 1.0, 1e-9);
+
+    table.add(4, kBase + kHalfLife, 1.0);
+    EXPECT_NEAR(table.score(4), 5.0, 1e-9);  // Decayed to the newest event
+    EXPECT_EQ(table.score(8), 0.0);
+}
+
+TEST(RiskTableTest, Add_OrderIndependent) {
+    RiskTable forward(kHalfLife);
+    RiskTable backward(kHalfLife);
+    for (Timestamp i = 0; i < 10; ++i) {
+        forward.add(4, kBase + i * kHalfLife / 4);
+        backward.add(4, kBase + (9 - i) * kHalfLife / 4);
+    }
+    const Timestamp now = kBase + 10 * kHalfLife;
+    EXPECT_NEAR(forward.score(4, now), backward.score(4, now), 1e-12);
+}
+
+TEST(RiskTableTest, Top_RanksByDecayedScore) {
+    RiskTable table(kHalfLife);
+    table.add(4, kBase, 3.0);              // Early and heavy
+    table.add(8, kBase + 2 * kHalfLife);   // Late and light: 1 vs 3/4 at the end
+    table.add(12, kBase + kHalfLife, 1.0);
+    table.add(0, kBase, 100.0);            // Ignored
+    table.add(16, kBase, -1.0);            // Ignored
+
+    std::array<RiskScore, 8> top{};
+    ASSERT_EQ(table.top(top), 3U);
+    EXPECT_EQ(top[0].key, 8U);
+    EXPECT_EQ(top[1].key, 4U);
+    EXPECT_EQ(top[2].key, 12U);
+    EXPECT_NEAR(top[1].score, 0.75, 1e-9);
+    EXPECT_EQ(top[0].events, 1U);
+    EXPECT_EQ(top[0].last, kBase + 2 * kHalfLife);
+
+    std::array<RiskScore, 1> first{};
+    ASSERT_EQ(table.top(first), 1U);
+    EXPECT_EQ(first[0].key, 8U);
+}
+
+TEST(RiskTableTest, Bounded_ReplacesLowestScore) {
+    RiskTable table(kHalfLife);
+    for (uint32_t key = 1; key <= RiskTable::kMaxEntries; ++key) {
+        table.add(key, kBase, 1.0 + key);
+    }
+    table.add(RiskTable::kMaxEntries + 1, kBase, 0.5);  // Lower than all: dropped
+    EXPECT_EQ(table.score(RiskTable::kMaxEntries + 1), 0.0);
+
+    table.add(RiskTable::kMaxEntries + 2, kBase, 1000.0);
+    EXPECT_EQ(table.size(), RiskTable::kMaxEntries);
+    EXPECT_EQ(table.score(1), 0.0);  // Lowest evicted
+    EXPECT_DOUBLE_EQ(table.score(RiskTable::kMaxEntries + 2), 1000.0);
+
+    table.clear();
+    EXPECT_EQ(table.size(), 0U);
+}
+
+// ============================================================================
+// Correlator Risk Scores
+// ============================================================================
+
+TEST_F(CorrelatorTest, AddRiskBatch_ScoresSuspiciousOnly) {
+    std::array<PendingEvent, 4> batch = {
+        make_scored(100, 1, Status::Suspicious, kBase),
+        make_scored(100, 1, Status::Success, kBase),
+        make_scored(200, 1, Status::Suspicious, kBase),
+        make_scored(200, 2, Status::Suspicious, kBase),
+    };
+    correlator_.add_risk_batch(batch);
+
+    EXPECT_DOUBLE_EQ(correlator_.process_risk(100), 1.0);
+    EXPECT_DOUBLE_EQ(correlator_.process_risk(200), 2.0);
+
+    std::array<RiskScore, 4> top{};
+    ASSERT_EQ(correlator_.top_processes(top), 2U);
+    EXPECT_EQ(top[0].key, 200U);
+    ASSERT_EQ(correlator_.top_chains(top), 2U);
+    EXPECT_EQ(top[0].key, 1U);
+    EXPECT_DOUBLE_EQ(top[0].score, 2.0);
+    EXPECT_EQ(top[1].key, 2U);
+}
+
+TEST_F(CorrelatorTest, AddRisk_DecaysWithTime) {
+    correlator_.add_risk(100, 7, kBase, 4.0);
+    correlator_.add_risk(0, 0, kBase, 4.0);  // Nothing to score
+    EXPECT_NEAR(correlator_.process_risk(100, kBase + 2 * kHalfLife), 1.0, 1e-9);
+
+    std::array<RiskScore, 2> top{};
+    ASSERT_EQ(correlator_.top_chains(top, kBase + kHalfLife), 1U);
+    EXPECT_EQ(top[0].key, 7U);
+    EXPECT_NEAR(top[0].score, 2.0, 1e-9);
+}
@@ -0,0 +1,52 @@
+#include "engine_test_common.hpp"
+
+#include <chrono>
+#include <thread>
+
+namespace exeray::test {
+
+TEST_F(EngineTest, EventsAfter_NotIngesting_ResumesAtOnce) {
+    Engine engine(make_config());
+    auto wait = [](Engine& e, event::EventId seen) -> AsyncTask<event::EventId> {
+        co_return co_await e.events_after(seen);
+    };
+    EXPECT_EQ(wait(engine, 0).get(), event::INVALID_EVENT);
+
+    push_process(engine, 100);
+    const event::EventId newest = push_process(engine, 101);
+    EXPECT_EQ(engine.graph().newest_id(), newest);
+    EXPECT_EQ(wait(engine, 0).get(), newest);
+    EXPECT_EQ(wait(engine, newest).get(), newest);  // Nothing new, nothing feeding
+}
+
+TEST_F(EngineTest, WaitForEvents_ReturnsNewOrTimesOut) {
+    using namespace std::chrono_literals;
+    Engine engine(make_config());
+    EXPECT_EQ(engine.wait_for_events(0, 1ms), event::INVALID_EVENT);  // Timed out
+
+    const event::EventId first = push_process(engine, 100);
+    EXPECT_EQ(engine.wait_for_events(0, 10s), first);  // Already there
+    EXPECT_EQ(engine.wait_for_events(first, 1ms), first);
+    EXPECT_EQ(engine.wait_for_events(first, 1ms), first);  // Watcher still armed
+
+    std::thread pusher([&engine] {
+        std::this_thread::sleep_for(20ms);
+        push_process(engine, 101);
+    });
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(engine.wait_for_events(first, 10s), first + 1);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);  // Woken, not timed out
+    pusher.join();
+}
+
+TEST_F(EngineTest, AsyncControl_NotMonitoring) {
+    Engine engine(make_config());
+    engine.drain_async().get();  // Nothing to stop
+    EXPECT_FALSE(engine.is_monitoring());
+#ifndef _WIN32
+    EXPECT_FALSE(engine.start_monitoring_async(L"C:\\Windows\\notepad.exe").get());
+    EXPECT_FALSE(engine.replay_async(L"trace.etl").get().has_value());
+#endif
+}
+
+}  // namespace exeray::test
@@ -0,0 +1,184 @@
+#include "engine_test_common.hpp"
+
+#include "exeray/checkpoint.hpp"
+#include "exeray/etw/memory_regions.hpp"
+#include "exeray/etw/module_map.hpp"
+
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <string>
+
+namespace exeray::test {
+
+namespace {
+
+constexpr event::Timestamp kSecond = 1'000'000'000ULL;
+
+std::uint64_t wall_now() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+Checkpoint sample_checkpoint() {
+    Checkpoint checkpoint;
+    checkpoint.written = wall_now();
+    checkpoint.strings = 50000;
+    checkpoint.correlator.next_correlation = 8;
+    checkpoint.correlator.lives = {{100, 3, 10 * kSecond, 0},
+                                   {100, 7, 20 * kSecond, 0},
+                                   {200, 5, 12 * kSecond, 15 * kSecond}};
+    checkpoint.correlator.risk_time = 30 * kSecond;
+    checkpoint.correlator.process_risk = {{100, 2.5, 3, 29 * kSecond}};
+    checkpoint.correlator.chain_risk = {{7, 2.5, 3, 29 * kSecond}};
+    etw::MemoryRegion region;
+    region.base = 0x10000;
+    region.size = 0x2000;
+    region.allocated = 25 * kSecond;
+    region.allocator_pid = 300;
+    region.flags = etw::kRegionExecutable | etw::kRegionRemote;
+    checkpoint.regions = {{100, region}};
+    checkpoint.modules = {{100, 0x7FF00000, 0x1000, "C:\\Windows\\System32\\ntdll.dll"},
+                          {100, 0x400000, 0x3000, "C:\\a.exe"}};
+    return checkpoint;
+}
+
+}  // namespace
+
+// ============================================================================
+// 1. File Format
+// ============================================================================
+
+TEST(CheckpointFileTest, RoundTrip_KeepsEveryRecord) {
+    const Checkpoint saved = sample_checkpoint();
+    const auto bytes = encode_checkpoint(saved);
+    EXPECT_EQ(bytes.size() % 8, 0u);
+
+    const auto loaded = decode_checkpoint(bytes);
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->written, saved.written);
+    EXPECT_EQ(loaded->strings, 50000u);
+    EXPECT_EQ(loaded->correlator.next_correlation, 8u);
+    ASSERT_EQ(loaded->correlator.lives.size(), 3u);
+    EXPECT_EQ(loaded->correlator.lives[2].stop, 15 * kSecond);
+    ASSERT_EQ(loaded->correlator.chain_risk.size(), 1u);
+    EXPECT_DOUBLE_EQ(loaded->correlator.chain_risk[0].score, 2.5);
+    ASSERT_EQ(loaded->regions.size(), 1u);
+    EXPECT_EQ(loaded->regions[0].second.allocator_pid, 300u);
+    EXPECT_EQ(loaded->regions[0].second.flags, etw::kRegionExecutable | etw::kRegionRemote);
+    ASSERT_EQ(loaded->modules.size(), 2u);
+    EXPECT_EQ(loaded->modules[0].path, "C:\\Windows\\System32\\ntdll.dll");
+    EXPECT_EQ(loaded->modules[1].size, 0x3000u);
+}
+
+TEST(CheckpointFileTest, Decode_RejectsCorruptOrTruncatedData) {
+    auto bytes = encode_checkpoint(sample_checkpoint());
+    EXPECT_FALSE(decode_checkpoint(std::span(bytes).first(bytes.size() - 8)).has_value());
+    bytes[bytes.size() - 20] ^= 0x40;
+    EXPECT_FALSE(decode_checkpoint(bytes).has_value());
+    EXPECT_FALSE(decode_checkpoint({}).has_value());
+}
+
+// ============================================================================
+// 2. Correlator State
+// ============================================================================
+
+TEST(CorrelatorCheckpointTest, Restore_KeepsChainsOfProcessesStartedBefore) {
+    event::Correlator before;
+    before.register_process(100, 1, 10 * kSecond);
+    const uint32_t chain = before.get_correlation_id(100);
+    before.register_process(200, 2, 11 * kSecond);
+    const uint32_t other = before.get_correlation_id(200);
+    before.add_risk(100, chain, 12 * kSecond, 4.0);
+
+    event::Correlator after;
+    after.restore(before.state());
+    EXPECT_EQ(after.get_correlation_id(100), chain);
+    EXPECT_EQ(after.get_correlation_id(400, 100), chain);  // A child joins the chain
+    EXPECT_GT(after.get_correlation_id(500), (std::max)(chain, other));
+    EXPECT_EQ(after.find_process_parent(100), event::INVALID_EVENT);  // Until a rundown
+
+    std::array<event::RiskScore, 2> top{};
+    ASSERT_EQ(after.top_chains(top), 1u);
+    EXPECT_EQ(top[0].key, chain);
+    EXPECT_DOUBLE_EQ(top[0].score, 4.0);
+    EXPECT_EQ(top[0].events, 1u);
+
+    after.register_process(100, 9, 0);  // Rundown of the still running process
+    EXPECT_EQ(after.find_process_parent(100), 9u);
+    EXPECT_EQ(after.get_correlation_id(100), chain);
+}
+
+// ============================================================================
+// 3. Engine
+// ============================================================================
+
+class EngineCheckpointTest : public EngineTest {
+protected:
+    void SetUp() override {
+        path_ = std::filesystem::temp_directory_path() /
+                ("exeray_checkpoint_" +
+                 std::to_string(::testing::UnitTest::GetInstance()->random_seed()) + "_" +
+                 ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        std::filesystem::remove(path_);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path_);
+    }
+
+    EngineConfig checkpoint_config() const {
+        EngineConfig config = make_config();
+        config.checkpoint_file = path_.wstring();
+        return config;
+    }
+
+    std::filesystem::path path_;
+};
+
+TEST_F(EngineCheckpointTest, Construction_RestoresCorrelationAndRisk) {
+    ASSERT_TRUE(write_checkpoint_file(path_, sample_checkpoint()));
+
+    Engine engine{checkpoint_config()};
+    EXPECT_TRUE(engine.restored_checkpoint());
+    const auto chains = engine.riskiest_chains(4);
+    ASSERT_EQ(chains.size(), 1u);
+    EXPECT_EQ(chains[0].key, 7u);
+    EXPECT_EQ(chains[0].events, 3u);
+}
+
+TEST_F(EngineCheckpointTest, Construction_IgnoresStaleCheckpoints) {
+    Checkpoint stale = sample_checkpoint();
+    stale.written -= 3600 * kSecond;
+    ASSERT_TRUE(write_checkpoint_file(path_, stale));
+
+    Engine engine{checkpoint_config()};
+    EXPECT_FALSE(engine.restored_checkpoint());
+    EXPECT_TRUE(engine.riskiest_chains(4).empty());
+}
+
+TEST_F(EngineCheckpointTest, SaveCheckpoint_KeepsTrackersNotYetRestored) {
+    ASSERT_TRUE(write_checkpoint_file(path_, sample_checkpoint()));
+    etw::memory_regions().clear();
+    etw::module_map().clear();
+    {
+        Engine engine{checkpoint_config()};
+        ASSERT_TRUE(engine.restored_checkpoint());
+        EXPECT_TRUE(engine.save_checkpoint());
+    }
+
+    const auto saved = read_checkpoint_file(path_);
+    ASSERT_TRUE(saved.has_value());
+    EXPECT_EQ(saved->correlator.lives.size(), 3u);
+    EXPECT_EQ(saved->regions.size(), 1u);
+    EXPECT_EQ(saved->modules.size(), 2u);
+    EXPECT_GE(saved->correlator.next_correlation, 8u);
+}
+
+TEST_F(EngineCheckpointTest, SaveCheckpoint_FailsWithoutAFile) {
+    Engine engine{make_config()};
+    EXPECT_FALSE(engine.restored_checkpoint());
+    EXPECT_FALSE(engine.save_checkpoint());
+}
+
+}  // namespace exeray::test
@@ -0,0 +1,71 @@
+#include "engine_test_common.hpp"
+
+namespace exeray::test {
+
+// ============================================================================
+// 2. Memory Statistics
+// ============================================================================
+
+TEST_F(EngineTest, MemoryStats_Fresh_ReportsBudgets) {
+    Engine engine{make_config()};
+    const MemoryStats stats = engine.memory_stats();
+    EXPECT_EQ(stats.events.capacity, kArenaSize);
+    EXPECT_TRUE(stats.strings_shared);
+    EXPECT_EQ(stats.strings.capacity, stats.events.capacity);
+    EXPECT_EQ(stats.event_count, 0U);
+    EXPECT_EQ(stats.event_capacity, 4 * event::EventGraph::kSegmentSize);
+    EXPECT_EQ(stats.event_bytes, 0U);
+    EXPECT_EQ(stats.string_count, 0U);
+}
+
+TEST_F(EngineTest, MemoryStats_SplitsEventAndStringBytes) {
+    EngineConfig config = make_config();
+    config.string_arena.size = kStringArenaSize;
+    Engine engine{std::move(config)};
+
+    ASSERT_NE(push_process(engine, 1), event::INVALID_EVENT);
+    ASSERT_NE(engine.strings().intern("C:\\Temp\\a.txt"), event::INVALID_STRING);
+
+    const MemoryStats stats = engine.memory_stats();
+    EXPECT_FALSE(stats.strings_shared);
+    EXPECT_EQ(stats.event_count, 1U);
+    EXPECT_GE(stats.event_bytes,
+              event::EventGraph::kSegmentSize * sizeof(event::EventNode));
+    EXPECT_LE(stats.event_bytes, stats.events.used);
+    EXPECT_EQ(stats.string_count, 1U);
+    EXPECT_EQ(stats.string_bytes, sizeof(std::uint32_t) + 13);
+    EXPECT_LE(stats.string_bytes, stats.strings.used);
+    EXPECT_EQ(stats.strings.capacity, kStringArenaSize);
+}
+
+TEST_F(EngineTest, MemoryStats_ExhaustedArena_CountsFailures) {
+    EngineConfig config = make_config();
+    config.arena_size = 64 * 1024;  // Too small for one segment
+    Engine engine{std::move(config)};
+
+    EXPECT_EQ(push_process(engine, 1), event::INVALID_EVENT);
+    EXPECT_GT(engine.memory_stats().events.failures, 0U);
+}
+
+TEST_F(EngineTest, CompactStrings_KeepsStringsOfRetainedEvents) {
+    EngineConfig config = make_config();
+    config.string_storage = event::StringStorage::Generational;
+    Engine engine{std::move(config)};
+
+    event::EventPayload payload = make_process_payload(1);
+    payload.process.image_path = engine.strings().intern_path("C:\\Windows\\cmd.exe");
+    const event::StringId unused = engine.strings().intern("unused");
+    ASSERT_NE(engine.graph().push(event::Category::Process,
+                                  static_cast<uint8_t>(event::ProcessOp::Create),
+                                  event::Status::Success, event::INVALID_EVENT, 0, payload),
+              event::INVALID_EVENT);
+    engine.compact_strings();
+
+    const auto stats = engine.compact_strings();
+
+    EXPECT_GT(stats.released, 0U);
+    EXPECT_EQ(engine.strings().get(payload.process.image_path), "C:\\Windows\\cmd.exe");
+    EXPECT_EQ(engine.strings().get(unused), "");
+}
+
+}  // namespace exeray::test
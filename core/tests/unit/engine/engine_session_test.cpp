@@ -0,0 +1,441 @@
+#include "engine_test_common.hpp"
+
+#include "exeray/trace_spans.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace exeray::test {
+
+// ============================================================================
+// 1. Arenas and Session Recycling
+// ============================================================================
+
+TEST_F(EngineTest, Arenas_Default_StringsShareEventArena) {
+    Engine engine{make_config()};
+    const auto used = engine.diagnostics().arena_used;
+    ASSERT_NE(engine.strings().intern("C:\\Windows\\System32\\kernel32.dll"),
+              event::INVALID_STRING);
+    EXPECT_GT(engine.diagnostics().arena_used, used);
+}
+
+TEST_F(EngineTest, Arenas_DedicatedStringArena_LeavesEventArena) {
+    EngineConfig config = make_config();
+    config.string_arena.size = kStringArenaSize;
+    Engine engine{std::move(config)};
+
+    const auto used = engine.diagnostics().arena_used;
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_NE(engine.strings().intern("path_" + std::to_string(i)),
+                  event::INVALID_STRING);
+    }
+    EXPECT_EQ(engine.diagnostics().arena_used, used);
+}
+
+TEST_F(EngineTest, Arenas_ScratchArena_UsesConfiguredSize) {
+    EngineConfig config = make_config();
+    config.scratch_arena.size = 64 * 1024;
+    Engine engine{std::move(config)};
+
+    EXPECT_EQ(engine.scratch_arena().capacity(), 64U * 1024);
+    EXPECT_NE(engine.scratch_arena().allocate<std::uint64_t>(16), nullptr);
+}
+
+TEST_F(EngineTest, ResetSession_DiscardsEventsAndRecyclesMemory) {
+    EngineConfig config = make_config();
+    config.string_arena.size = kStringArenaSize;
+    config.scratch_arena.size = 64 * 1024;
+    Engine engine{std::move(config)};
+
+    for (uint32_t pid = 1; pid <= 100; ++pid) {
+        ASSERT_NE(push_process(engine, pid), event::INVALID_EVENT);
+    }
+    ASSERT_NE(engine.strings().intern("session one"), event::INVALID_STRING);
+    ASSERT_NE(engine.scratch_arena().allocate<std::uint64_t>(), nullptr);
+    const auto used = engine.diagnostics().arena_used;
+    ASSERT_GT(used, 0U);
+
+    ASSERT_TRUE(engine.reset_session());
+    EXPECT_EQ(engine.session(), 1U);
+    EXPECT_EQ(engine.graph().count(), 0U);
+    EXPECT_EQ(engine.strings().count(), 0U);
+    EXPECT_EQ(engine.scratch_arena().used(), 0U);
+    EXPECT_EQ(engine.graph().counters().snapshot().total(), 0U);
+
+    // The next session reuses the same memory from the start
+    EXPECT_EQ(push_process(engine, 42), 1U);
+    EXPECT_EQ(engine.graph().get(1).payload().process.pid, 42U);
+    EXPECT_LE(engine.diagnostics().arena_used, used);
+    const auto id = engine.strings().intern("session two");
+    EXPECT_EQ(engine.strings().get(id), "session two");
+}
+
+TEST_F(EngineTest, ResetSession_KeepsGraphAddressAndFullBudget) {
+    Engine engine{make_config()};
+    const event::EventGraph* graph = &engine.graph();
+
+    for (int round = 0; round < 3; ++round) {
+        std::size_t stored = 0;
+        while (push_process(engine, 7) != event::INVALID_EVENT) {
+            ++stored;
+        }
+        EXPECT_EQ(stored, 4 * event::EventGraph::kSegmentSize) << "round " << round;
+        ASSERT_TRUE(engine.reset_session());
+    }
+    EXPECT_EQ(&engine.graph(), graph);
+    EXPECT_EQ(engine.session(), 3U);
+}
+
+TEST_F(EngineTest, ResetSession_KeepsDevicePathNormalization) {
+    Engine engine{make_config()};
+    engine.device_paths().set("\\Device\\HarddiskVolume42", "Q:");
+    const event::StringId before = engine.strings().intern_path("\\Device\\HarddiskVolume42\\a");
+    EXPECT_EQ(engine.strings().get(before), "Q:\\a");
+
+    ASSERT_TRUE(engine.reset_session());
+    const event::StringId after = engine.strings().intern_path("\\Device\\HarddiskVolume42\\b");
+    EXPECT_EQ(engine.strings().get(after), "Q:\\b");
+}
+
+TEST_F(EngineTest, DevicePaths_Disabled_KeptAsGiven) {
+    EngineConfig config = make_config();
+    config.normalize_device_paths = false;
+    Engine engine{config};
+    engine.device_paths().set("\\Device\\HarddiskVolume42", "Q:");
+
+    const event::StringId id = engine.strings().intern_path("\\Device\\HarddiskVolume42\\a");
+    EXPECT_EQ(engine.strings().get(id), "\\Device\\HarddiskVolume42\\a");
+}
+
+TEST_F(EngineTest, IngestStats_NotMonitoring_NoRing) {
+    Engine engine{make_config()};
+
+    const IngestStats stats = engine.ingest_stats();
+    EXPECT_EQ(stats.ring_bytes, 0U);
+    EXPECT_EQ(stats.staged, 0U);
+    EXPECT_EQ(stats.overflows, 0U);
+    EXPECT_GT(make_config().ingest_ring_bytes, 0U);
+}
+
+TEST_F(EngineTest, Targets_NotMonitoring_NoneAdded) {
+    Engine engine{make_config()};
+
+    EXPECT_FALSE(engine.add_target(L"C:\\Windows\\System32\\notepad.exe"));
+    EXPECT_TRUE(engine.target_pids().empty());
+    EXPECT_EQ(engine.target_pid(), 0U);
+    EXPECT_TRUE(make_config().follow_children);
+    engine.freeze_target();  // No targets: nothing to do
+    engine.kill_target();
+}
+
+TEST_F(EngineTest, TargetUsage_NoTargets_AllZero) {
+    EngineConfig config = make_config();
+    config.target_limits.cpu_percent = 25;
+    config.target_limits.io_bytes_per_second = 8 * 1024 * 1024;
+    Engine engine{config};
+
+    const process::JobAccounting usage = engine.target_usage();
+    EXPECT_EQ(usage.user_time_ns + usage.kernel_time_ns, 0U);
+    EXPECT_EQ(usage.read_bytes + usage.write_bytes + usage.other_bytes, 0U);
+    EXPECT_EQ(usage.peak_job_memory, 0U);
+    EXPECT_EQ(usage.active_processes, 0U);
+}
+
+TEST_F(EngineTest, SystemWide_ConfigSpreadsSessionsAndRecycles) {
+    const EngineConfig config = EngineConfig::system_wide(kArenaSize, 6);
+
+    EXPECT_EQ(config.retention, event::Retention::Ring);
+    EXPECT_EQ(config.max_event_bytes, kArenaSize / 2);
+    EXPECT_EQ(config.string_arena.size, kArenaSize / 4);
+    EXPECT_GT(config.ingest_ring_bytes, make_config().ingest_ring_bytes);
+    EXPECT_FALSE(config.follow_children);
+    // Parents resolve within one session; busy providers get their own
+    EXPECT_EQ(config.providers.at("Image").session, config.providers.at("Process").session);
+    EXPECT_NE(config.providers.at("File").session, config.providers.at("Process").session);
+    EXPECT_NE(config.providers.at("Network").session, config.providers.at("File").session);
+    EXPECT_EQ(config.providers.size(), make_config().providers.size());
+
+    Engine engine{config};
+    EXPECT_GE(engine.graph().capacity(), kArenaSize / 2 / sizeof(event::EventNode) / 2);
+#ifndef _WIN32
+    EXPECT_FALSE(engine.monitor_system());
+    EXPECT_FALSE(engine.is_monitoring());
+#endif
+}
+
+TEST_F(EngineTest, StandbySession_NeedsConfigAndNoSystemWide) {
+    Engine plain{make_config()};
+    EXPECT_FALSE(plain.prepare_monitoring());
+    EXPECT_FALSE(plain.standing_by());
+    plain.close_standby();  // Nothing to close
+
+    EngineConfig config = make_config();
+    config.standby_session = true;
+    Engine engine{std::move(config)};
+    EXPECT_FALSE(engine.monitor_system());
+#ifndef _WIN32
+    EXPECT_FALSE(engine.prepare_monitoring());
+#endif
+    EXPECT_FALSE(engine.standing_by());
+    EXPECT_TRUE(engine.reset_session());
+}
+
+TEST_F(EngineTest, Attach_NoSuchProcess_NotMonitoring) {
+    Engine engine{make_config()};
+
+    // PID 0 (the idle process) can never be opened
+    EXPECT_FALSE(engine.attach(0));
+    EXPECT_FALSE(engine.is_monitoring());
+    EXPECT_TRUE(engine.target_pids().empty());
+}
+
+TEST_F(EngineTest, SessionStats_NotMonitoring_Zero) {
+    Engine engine{make_config()};
+
+    EXPECT_EQ(engine.session_stats(), etw::SessionStats{});
+}
+
+TEST_F(EngineTest, ShedStats_NotMonitoring_Zero) {
+    Engine engine{make_config()};
+
+    EXPECT_EQ(engine.shed_stats().total, 0U);
+    EXPECT_TRUE(make_config().shedding.enabled);
+}
+
+TEST_F(EngineTest, ParseMetrics_ConfigTogglesRecording) {
+    EngineConfig config = make_config();
+    config.parse_metrics = false;
+    {
+        Engine engine{std::move(config)};
+        EXPECT_FALSE(etw::ParseMetrics::global().enabled());
+    }
+    Engine engine{make_config()};
+    EXPECT_TRUE(etw::ParseMetrics::global().enabled());
+    EXPECT_EQ(engine.parse_metrics().of(etw::MetricProvider::Process).failures, 0U);
+}
+
+TEST_F(EngineTest, IngestLatency_NotMonitoring_Empty) {
+    Engine engine{make_config()};
+
+    EXPECT_EQ(engine.ingest_latency(etw::LatencyStage::Visible).count, 0U);
+    EXPECT_EQ(engine.ingest_latency(etw::LatencyStage::Delivered, event::Category::Process).p99,
+              0U);
+    EXPECT_TRUE(make_config().ingest_latency);
+}
+
+TEST_F(EngineTest, Replay_MissingFile_Nullopt) {
+    Engine engine{make_config()};
+
+    EXPECT_FALSE(engine.replay(L"does-not-exist.etl").has_value());
+    EXPECT_EQ(engine.graph().count(), 0U);
+}
+
+TEST_F(EngineTest, RunSynthetic_FeedsGraphAndLatency) {
+    EngineConfig config = make_config();
+    config.flows.enabled = false;  // Every transfer is stored
+    config.file_coalesce_ms = 0;
+    Engine engine{std::move(config)};
+
+    etw::SyntheticConfig load;
+    load.processes = 50;
+    load.churn = 10;
+    const auto stats = engine.run_synthetic(load, 5000);
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_EQ(stats->events, 5000U);
+    EXPECT_EQ(stats->buffers, 20U);
+    EXPECT_EQ(engine.graph().count(), 5000U);
+    EXPECT_GT(engine.strings().count(), 0U);
+    EXPECT_GT(engine.ingest_latency(etw::LatencyStage::Visible).count, 0U);
+}
+
+TEST_F(EngineTest, RunSynthetic_Rate_Paced) {
+    Engine engine{make_config()};
+
+    etw::SyntheticConfig load;
+    load.processes = 10;
+    load.rate = 20000.0;
+    const auto stats = engine.run_synthetic(load, 2000);
+    ASSERT_TRUE(stats.has_value());
+    // The last event is due 100 ms after the first
+    EXPECT_GE(stats->elapsed, std::chrono::milliseconds(90));
+}
+
+TEST_F(EngineTest, DumpSpans_ChromeTraceOfIngestPath) {
+    Engine engine{make_config()};
+    etw::SyntheticConfig load;
+    load.processes = 10;
+    ASSERT_TRUE(engine.run_synthetic(load, 1000).has_value());
+
+    const std::filesystem::path path =
+        std::filesystem::temp_directory_path() /
+        ("exeray_spans_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()) +
+         ".json");
+    ASSERT_TRUE(engine.dump_spans(path.wstring()));
+    std::ostringstream text;
+    text << std::ifstream(path).rdbuf();
+    std::filesystem::remove(path);
+
+    const std::string json = text.str();
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0), 0U);
+    const bool has_spans = json.find("\"name\":\"intern\"") != std::string::npos &&
+                           json.find("\"name\":\"correlate\"") != std::string::npos &&
+                           json.find("\"name\":\"push\"") != std::string::npos;
+    EXPECT_EQ(has_spans, kSpansEnabled);
+}
+
+TEST_F(EngineTest, DumpSpans_UnwritablePath_False) {
+    Engine engine{make_config()};
+    EXPECT_FALSE(engine.dump_spans(L"/nonexistent-dir/spans.json"));
+}
+
+TEST_F(EngineTest, Metrics_RunSynthetic_CountsBatchesAndEvents) {
+    Engine engine{make_config()};
+    etw::SyntheticConfig load;
+    load.processes = 10;
+    ASSERT_TRUE(engine.run_synthetic(load, 1000).has_value());
+
+    double batches = 0;
+    double pushed = 0;
+    std::uint64_t batch_events = 0;
+    for (const MetricSample& sample : engine.metrics().snapshot()) {
+        if (sample.name == "exeray_batches_total") {
+            batches = sample.value;
+        } else if (sample.name == "exeray_events_pushed_total") {
+            pushed += sample.value;
+        } else if (sample.name == "exeray_batch_events") {
+            batch_events = static_cast<std::uint64_t>(sample.value);
+        }
+    }
+    EXPECT_GT(batches, 0.0);
+    EXPECT_EQ(pushed, static_cast<double>(engine.graph().count()));
+    EXPECT_GT(batch_events, 0U);
+    EXPECT_LE(batch_events, engine.graph().count());  // Some events are pushed singly
+
+    std::ostringstream text;
+    ASSERT_TRUE(engine.metrics().write(text));
+    EXPECT_NE(text.str().find("# TYPE exeray_parse_events_total counter"), std::string::npos);
+    EXPECT_NE(text.str().find("exeray_ingest_latency_seconds{stage=\"visible\",quantile="),
+              std::string::npos);
+}
+
+TEST_F(EngineTest, Metrics_RunSynthetic_PublishesSketches) {
+    Engine engine{make_config()};
+    etw::SyntheticConfig load;
+    load.processes = 10;
+    ASSERT_TRUE(engine.run_synthetic(load, 1000).has_value());
+    ASSERT_NE(engine.graph().sketches(), nullptr);
+
+    std::size_t unique = 0;
+    std::size_t top = 0;
+    for (const MetricSample& sample : engine.metrics().snapshot()) {
+        if (sample.name == "exeray_sketch_unique") {
+            ++unique;
+        } else if (sample.name == "exeray_sketch_top_events") {
+            EXPECT_NE(sample.labels.find("key=\""), std::string::npos);
+            EXPECT_GT(sample.value, 0.0);
+            ++top;
+        }
+    }
+    EXPECT_EQ(unique, event::kSketchKinds);
+    EXPECT_GT(top, 0U);
+}
+
+TEST_F(EngineTest, RateStats_RunSynthetic_CountsEventsWhenEnabled) {
+    EngineConfig config = make_config();
+    config.rates.enabled = true;
+    Engine engine{std::move(config)};
+    etw::SyntheticConfig load;
+    load.processes = 10;
+    ASSERT_TRUE(engine.run_synthetic(load, 1000).has_value());
+
+    const etw::RateStats stats = engine.rate_stats();
+    EXPECT_GT(stats.observed, 0U);
+    EXPECT_GT(stats.tracked, 0U);
+
+    Engine off{make_config()};
+    ASSERT_TRUE(off.run_synthetic(load, 1000).has_value());
+    EXPECT_EQ(off.rate_stats().observed, 0U);
+    EXPECT_TRUE(off.rate_anomalies().empty());
+}
+
+TEST_F(EngineTest, Profile_RunSynthetic_SamplesConsumerStages) {
+    EngineConfig config = make_config();
+    config.profile_interval_us = 100;
+    Engine engine{std::move(config)};
+    EXPECT_TRUE(engine.profiler().running());
+
+    etw::SyntheticConfig load;
+    load.processes = 50;
+    ASSERT_TRUE(engine.run_synthetic(load, 50000).has_value());
+    EXPECT_FALSE(engine.set_profiling(0));  // Stops the watchdog
+
+    const std::filesystem::path path =
+        std::filesystem::temp_directory_path() /
+        ("exeray_profile_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()) +
+         ".folded");
+    ASSERT_TRUE(engine.dump_profile(path.wstring()));
+    std::ostringstream text;
+    text << std::ifstream(path).rdbuf();
+    std::filesystem::remove(path);
+
+    // Every line is "role[;stage...] count"; detection runs off the consumer
+    std::istringstream lines(text.str());
+    std::string line;
+    std::size_t count = 0;
+    while (std::getline(lines, line)) {
+        const std::string role = line.substr(0, line.find_first_of("; "));
+        EXPECT_TRUE(role == "consumer" || role == "detector") << line;
+        EXPECT_NE(line.find(' '), std::string::npos) << line;
+        ++count;
+    }
+    EXPECT_EQ(count > 0, engine.profiler().samples() > 0);
+}
+
+TEST_F(EngineTest, Diagnostics_NotMonitoring_NoSessions) {
+    Engine engine{make_config()};
+
+    EXPECT_EQ(engine.diagnostics().etw_sessions, 0U);
+    for (const auto& [name, cfg] : make_config().providers) {
+        EXPECT_EQ(cfg.session, 0) << name;  // One shared session by default
+    }
+}
+
+TEST_F(EngineTest, Providers_ToggleWhileIdle_UpdatesConfig) {
+    Engine engine{make_config()};
+    ASSERT_TRUE(engine.is_provider_enabled("File"));
+
+    engine.disable_provider("File");
+    EXPECT_FALSE(engine.is_provider_enabled("File"));
+    engine.enable_provider("File");
+    EXPECT_TRUE(engine.is_provider_enabled("File"));
+
+    engine.enable_provider("Nope");
+    EXPECT_FALSE(engine.is_provider_enabled("Nope"));
+}
+
+TEST_F(EngineTest, ManifestProviders_RegisteredFromConfigAndAtRuntime) {
+    EngineConfig config = make_config();
+    config.manifest_providers.push_back(
+        {"TaskScheduler", "{DE7B24EA-73C8-4A09-985D-5BDADCFA9017}",
+         {{"TaskName", etw::ManifestSlot::Text}}});
+    config.manifest_providers.push_back({"Broken", "{DE7B24EA}", {}});
+    Engine engine{std::move(config)};
+
+    EXPECT_EQ(engine.manifest_providers().size(), 1u);
+    EXPECT_TRUE(engine.is_provider_enabled("TaskScheduler"));
+    EXPECT_FALSE(engine.is_provider_enabled("Broken"));
+    engine.disable_provider("TaskScheduler");
+    EXPECT_FALSE(engine.is_provider_enabled("TaskScheduler"));
+
+    EXPECT_TRUE(engine.register_provider(
+        {"AuditApi", "{E02A841C-75A3-4FA7-AFC8-AE09CF9B7F23}", {{"TargetProcessId",
+                                                                 etw::ManifestSlot::Value}}}));
+    EXPECT_TRUE(engine.is_provider_enabled("AuditApi"));
+    EXPECT_FALSE(engine.register_provider(
+        {"AuditApi", "{E02A841C-75A3-4FA7-AFC8-AE09CF9B7F24}", {}}));  // Name taken
+    ASSERT_NE(engine.manifest_providers().provider(1), nullptr);
+    EXPECT_EQ(engine.manifest_providers().provider(1)->name, "AuditApi");
+}
+
+}  // namespace exeray::test
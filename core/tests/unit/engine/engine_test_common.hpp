@@ -0,0 +1,43 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "exeray/engine.hpp"
+
+namespace exeray::test {
+
+// ============================================================================
+// Test Fixture
+// ============================================================================
+
+class EngineTest : public ::testing::Test {
+protected:
+    static constexpr std::size_t kArenaSize = 16 * 1024 * 1024;  // 16MB
+    static constexpr std::size_t kStringArenaSize = 1024 * 1024;  // 1MB
+
+    static EngineConfig make_config() {
+        EngineConfig config = EngineConfig::with_defaults(kArenaSize, 1);
+        config.max_events = 4 * event::EventGraph::kSegmentSize;
+        return config;
+    }
+
+    static event::EventPayload make_process_payload(uint32_t pid) {
+        event::EventPayload payload{};
+        payload.category = event::Category::Process;
+        payload.process.pid = pid;
+        payload.process.parent_pid = 1;
+        return payload;
+    }
+
+    static event::EventId push_process(Engine& engine, uint32_t pid) {
+        return engine.graph().push(event::Category::Process,
+                                   static_cast<uint8_t>(event::ProcessOp::Create),
+                                   event::Status::Success, event::INVALID_EVENT, 0,
+                                   make_process_payload(pid));
+    }
+};
+
+}  // namespace exeray::test
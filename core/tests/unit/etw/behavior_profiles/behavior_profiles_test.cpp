@@ -0,0 +1,229 @@
+/// @file behavior_profiles_test.cpp
+/// @brief Tests for per-executable behavior baselines.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/behavior_profiles.hpp"
+#include "exeray/event/string_pool.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+namespace exeray::etw {
+namespace {
+
+using event::Category;
+
+constexpr auto kCreate = static_cast<std::uint8_t>(event::ProcessOp::Create);
+constexpr auto kTerminate = static_cast<std::uint8_t>(event::ProcessOp::Terminate);
+constexpr auto kRead = static_cast<std::uint8_t>(event::FileOp::Read);
+constexpr auto kWrite = static_cast<std::uint8_t>(event::FileOp::Write);
+constexpr auto kConnect = static_cast<std::uint8_t>(event::NetworkOp::Connect);
+
+constexpr std::string_view kNotepad = "C:\\Windows\\System32\\notepad.exe";
+
+ProfileConfig config(std::uint64_t min_events = 5) {
+    ProfileConfig config;
+    config.enabled = true;
+    config.min_events = min_events;
+    return config;
+}
+
+class BehaviorProfilesTest : public ::testing::Test {
+protected:
+    Arena arena_{16 * 1024 * 1024};
+    event::StringPool strings_{arena_};
+    std::filesystem::path dir_;
+
+    void SetUp() override {
+        dir_ = std::filesystem::temp_directory_path() /
+               ("exeray_profiles_" +
+                std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::filesystem::remove_all(dir_);
+        std::filesystem::create_directories(dir_);
+    }
+
+    void TearDown() override {
+        std::error_code error;
+        std::filesystem::remove_all(dir_, error);
+    }
+
+    bool start(BehaviorProfiles& profiles, std::uint32_t pid, std::string_view image) {
+        event::EventPayload payload{};
+        payload.category = Category::Process;
+        payload.process.pid = pid;
+        payload.process.image_path = strings_.intern_path(image);
+        return profiles.observe(4, payload, kCreate, strings_);
+    }
+
+    bool stop(BehaviorProfiles& profiles, std::uint32_t pid) {
+        event::EventPayload payload{};
+        payload.category = Category::Process;
+        payload.process.pid = pid;
+        return profiles.observe(pid, payload, kTerminate, strings_);
+    }
+
+    bool file(BehaviorProfiles& profiles, std::uint32_t pid, std::uint8_t op,
+              std::string_view path) {
+        event::EventPayload payload{};
+        payload.category = Category::FileSystem;
+        payload.file.path = strings_.intern_path(path);
+        return profiles.observe(pid, payload, op, strings_);
+    }
+
+    bool connect(BehaviorProfiles& profiles, std::uint32_t pid, std::uint16_t port) {
+        event::EventPayload payload{};
+        payload.category = Category::Network;
+        payload.network.remote_addr = 0x0100007F;
+        payload.network.remote_port = port;
+        return profiles.observe(pid, payload, kConnect, strings_);
+    }
+
+    /// @brief A session of notepad reading documents, saved to path.
+    void learn_notepad(const std::filesystem::path& path) {
+        BehaviorProfiles profiles(config());
+        start(profiles, 100, kNotepad);
+        for (int i = 0; i < 10; ++i) {
+            file(profiles, 100, kRead, "C:\\Users\\alice\\Documents\\note" + std::to_string(i));
+        }
+        connect(profiles, 100, 443);
+        stop(profiles, 100);
+        ASSERT_TRUE(profiles.save(path));
+    }
+};
+
+TEST_F(BehaviorProfilesTest, ImageKey_IgnoresAsciiCase) {
+    EXPECT_EQ(BehaviorProfiles::image_key("C:\\Windows\\NOTEPAD.EXE"),
+              BehaviorProfiles::image_key("c:\\windows\\notepad.exe"));
+    EXPECT_NE(BehaviorProfiles::image_key("C:\\Windows\\notepad.exe"),
+              BehaviorProfiles::image_key("C:\\Windows\\calc.exe"));
+}
+
+TEST_F(BehaviorProfilesTest, Observe_LearnsOperationsOfStartedProcesses) {
+    BehaviorProfiles profiles(config());
+    start(profiles, 100, kNotepad);
+    file(profiles, 100, kRead, "C:\\Users\\alice\\Documents\\a.txt");
+    file(profiles, 200, kWrite, "C:\\Users\\alice\\Documents\\b.txt");  // Never started
+
+    const ProfileRecord learned = profiles.learned(BehaviorProfiles::image_key(kNotepad));
+    EXPECT_EQ(learned.events, 1u);
+    EXPECT_EQ(learned.operations[static_cast<std::size_t>(Category::FileSystem)],
+              std::uint64_t{1} << kRead);
+    EXPECT_EQ(profiles.stats().learned, 1u);
+}
+
+TEST_F(BehaviorProfilesTest, Load_FlagsBehaviorNewToTheProfile) {
+    const auto path = dir_ / "profiles.bin";
+    learn_notepad(path);
+
+    BehaviorProfiles profiles(config());
+    ASSERT_TRUE(profiles.load(path));
+    EXPECT_EQ(profiles.stats().loaded, 1u);
+    start(profiles, 300, "c:\\windows\\system32\\NOTEPAD.exe");
+
+    EXPECT_FALSE(file(profiles, 300, kRead, "C:\\Users\\alice\\Documents\\note3"));
+    EXPECT_FALSE(file(profiles, 300, kRead, "C:\\Users\\alice\\Documents\\other.txt"));
+    EXPECT_FALSE(connect(profiles, 300, 443));
+    EXPECT_TRUE(file(profiles, 300, kWrite, "C:\\Users\\alice\\Documents\\note3"));
+    EXPECT_TRUE(file(profiles, 300, kRead, "C:\\Windows\\System32\\config\\SAM"));
+    EXPECT_TRUE(connect(profiles, 300, 4444));
+
+    const ProfileStats stats = profiles.stats();
+    EXPECT_EQ(stats.checked, 6u);
+    EXPECT_EQ(stats.novel, 3u);
+}
+
+TEST_F(BehaviorProfilesTest, Load_ImmatureProfileNeverFlags) {
+    const auto path = dir_ / "profiles.bin";
+    learn_notepad(path);
+
+    BehaviorProfiles profiles(config(1000));
+    ASSERT_TRUE(profiles.load(path));
+    start(profiles, 300, kNotepad);
+    EXPECT_FALSE(file(profiles, 300, kWrite, "C:\\Windows\\System32\\config\\SAM"));
+    EXPECT_EQ(profiles.stats().checked, 0u);
+}
+
+TEST_F(BehaviorProfilesTest, Load_RejectsFilesThatAreNotProfiles) {
+    const auto path = dir_ / "garbage.bin";
+    std::ofstream(path, std::ios::binary) << "not a profile file at all, not even close";
+
+    BehaviorProfiles profiles(config());
+    EXPECT_FALSE(profiles.load(path));
+    EXPECT_FALSE(profiles.load(dir_ / "missing.bin"));
+    EXPECT_EQ(profiles.stats().loaded, 0u);
+}
+
+TEST_F(BehaviorProfilesTest, Save_KeepsLoadedProfilesAndAddsLearned) {
+    const auto path = dir_ / "profiles.bin";
+    learn_notepad(path);
+
+    {
+        BehaviorProfiles profiles(config());
+        ASSERT_TRUE(profiles.load(path));
+        start(profiles, 300, kNotepad);
+        file(profiles, 300, kWrite, "C:\\Users\\alice\\Documents\\note3");
+        start(profiles, 400, "C:\\Windows\\System32\\calc.exe");
+        file(profiles, 400, kRead, "C:\\Windows\\Fonts\\arial.ttf");
+        ASSERT_TRUE(profiles.save(path));  // Replaces the mapped file
+        EXPECT_EQ(profiles.stats().loaded, 2u);
+    }
+
+    BehaviorProfiles profiles(config());
+    ASSERT_TRUE(profiles.load(path));
+    const ProfileRecord* notepad = profiles.loaded(BehaviorProfiles::image_key(kNotepad));
+    ASSERT_NE(notepad, nullptr);
+    EXPECT_EQ(notepad->events, 13u);  // 12 learned first, 1 in the second session
+    EXPECT_EQ(notepad->operations[static_cast<std::size_t>(Category::FileSystem)],
+              (std::uint64_t{1} << kRead) | (std::uint64_t{1} << kWrite));
+    EXPECT_NE(profiles.loaded(BehaviorProfiles::image_key("C:\\Windows\\System32\\calc.exe")),
+              nullptr);
+}
+
+TEST_F(BehaviorProfilesTest, Merge_CombinesTheFilesOfSeveralHosts) {
+    const auto host_a = dir_ / "a.bin";
+    const auto host_b = dir_ / "b.bin";
+    learn_notepad(host_a);
+    {
+        BehaviorProfiles profiles(config());
+        start(profiles, 100, kNotepad);
+        for (int i = 0; i < 10; ++i) {
+            file(profiles, 100, kWrite, "D:\\Reports\\r" + std::to_string(i));
+        }
+        ASSERT_TRUE(profiles.save(host_b));
+    }
+
+    const auto combined = dir_ / "combined.bin";
+    {
+        BehaviorProfiles profiles(config());
+        ASSERT_TRUE(profiles.merge(host_a));
+        ASSERT_TRUE(profiles.merge(host_b));
+        ASSERT_TRUE(profiles.save(combined));
+    }
+
+    BehaviorProfiles profiles(config());
+    ASSERT_TRUE(profiles.load(combined));
+    start(profiles, 300, kNotepad);
+    EXPECT_FALSE(file(profiles, 300, kRead, "C:\\Users\\alice\\Documents\\x.txt"));
+    EXPECT_FALSE(file(profiles, 300, kWrite, "D:\\Reports\\y.txt"));
+    EXPECT_FALSE(connect(profiles, 300, 443));
+    EXPECT_TRUE(file(profiles, 300, kWrite, "C:\\Windows\\Temp\\payload.dll"));
+}
+
+TEST_F(BehaviorProfilesTest, Observe_TerminatedProcessIsForgotten) {
+    const auto path = dir_ / "profiles.bin";
+    learn_notepad(path);
+
+    BehaviorProfiles profiles(config());
+    ASSERT_TRUE(profiles.load(path));
+    start(profiles, 300, kNotepad);
+    stop(profiles, 300);
+    EXPECT_FALSE(file(profiles, 300, kWrite, "C:\\Windows\\Temp\\payload.dll"));
+}
+
+}  // namespace
+}  // namespace exeray::etw
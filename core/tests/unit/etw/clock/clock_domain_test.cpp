@@ -0,0 +1,91 @@
+/// @file clock_domain_test.cpp
+/// @brief Tests for ETW record timestamp conversion into the graph clock.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/clock.hpp"
+
+namespace exeray::etw {
+namespace {
+
+TEST(ClockDomainTest, ToGraph_AtAnchor_ReturnsGraphAnchor) {
+    ClockDomain domain{1000, 5'000'000};
+    EXPECT_EQ(domain.to_graph(1000), 5'000'000U);
+}
+
+TEST(ClockDomainTest, ToGraph_ScalesTicksToNanoseconds) {
+    ClockDomain domain{1000, 5'000'000};
+    EXPECT_EQ(domain.to_graph(1010), 5'001'000U);
+    EXPECT_EQ(domain.to_graph(990), 4'999'000U);
+}
+
+TEST(ClockDomainTest, ToGraph_BeforeGraphEpoch_ClampsToZero) {
+    ClockDomain domain{1'000'000, 500};
+    EXPECT_EQ(domain.to_graph(0), 0U);
+}
+
+TEST(ClockDomainTest, SetFrequency_ScalesQpcTicksWithoutDrift) {
+    ClockDomain domain{0, 0};
+    domain.set_frequency(10'000'000);  // The usual QPC rate: 100 ns per tick
+    EXPECT_EQ(domain.ticks_to_ns(12'345), 1'234'500U);
+
+    // 3 MHz: the third of a nanosecond is carried in the fraction, which
+    // truncates by under a nanosecond per 2^32 ticks
+    domain.set_frequency(3'000'000);
+    EXPECT_NEAR(static_cast<double>(domain.ticks_to_ns(3)), 1'000.0, 1.0);
+    const std::uint64_t day = domain.ticks_to_ns(3'000'000ULL * 86'400);
+    EXPECT_LE(day, 86'400'000'000'000ULL);
+    EXPECT_GT(day, 86'400'000'000'000ULL - 100);
+
+    // Faster than 1 GHz: below a nanosecond per tick
+    domain.set_frequency(2'500'000'000ULL);
+    EXPECT_NEAR(static_cast<double>(domain.ticks_to_ns(2'500'000'000ULL)), 1e9, 1.0);
+
+    domain.set_frequency(0);  // Ignored
+    EXPECT_NEAR(static_cast<double>(domain.ticks_to_ns(2'500'000'000ULL)), 1e9, 1.0);
+}
+
+TEST(ClockDomainTest, Capture_FromCounter_MapsCounterTicksToGraph) {
+    const auto domain = ClockDomain::capture(1'000'000, 1'000'000);  // 1 us ticks
+    EXPECT_EQ(domain.to_graph(1'000'000), domain.graph_anchor);
+    EXPECT_EQ(domain.to_graph(1'000'005), domain.graph_anchor + 5'000);
+    EXPECT_TRUE(domain.wall().valid());
+}
+
+TEST(ClockDomainTest, Replay_MapsRecordsToTheirRecordedWallTime) {
+    // 2023-11-14 22:13:20 UTC as FILETIME
+    const std::uint64_t start = ClockDomain::kUnixEpochFiletime + 17'000'000'000'000'000ULL;
+    const auto domain = ClockDomain::replay(start);
+    const event::WallClock wall = domain.wall();
+
+    EXPECT_EQ(wall.to_unix(domain.to_graph(start)), 1'700'000'000'000'000'000ULL);
+    EXPECT_EQ(wall.to_unix(domain.to_graph(start + 10)), 1'700'000'000'000'001'000ULL);
+    EXPECT_EQ(wall.to_unix(domain.to_graph(start - 10)), 1'699'999'999'999'999'000ULL);
+}
+
+TEST(ClockDomainTest, WallClock_WithoutAnchor_ReturnsZero) {
+    const event::WallClock wall{};
+    EXPECT_FALSE(wall.valid());
+    EXPECT_EQ(wall.to_unix(123), 0U);
+}
+
+TEST(ClockDomainTest, Capture_MapsNowCloseToSteadyClock) {
+    const auto domain = ClockDomain::capture();
+    const auto system_ns = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count());
+    const auto steady_ns = static_cast<event::Timestamp>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+
+    const auto mapped = domain.to_graph(ClockDomain::kUnixEpochFiletime +
+                                        system_ns / ClockDomain::kNsPerTick);
+    // Both clocks were read within a few milliseconds of each other
+    const auto diff = mapped > steady_ns ? mapped - steady_ns : steady_ns - mapped;
+    EXPECT_LT(diff, 1'000'000'000U);
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,119 @@
+/// @file content_cache_test.cpp
+/// @brief Tests for content hashing and the repeat cache.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/content_cache.hpp"
+
+#include <cstdint>
+#include <set>
+#include <string>
+
+namespace exeray::etw {
+namespace {
+
+std::uint64_t hash_of(const std::string& text) {
+    return content_hash(text.data(), text.size());
+}
+
+TEST(ContentCacheTest, Hash_DependsOnEveryByteAndLength) {
+    // Short and striped inputs, with and without a partial last stripe
+    for (const std::size_t size : {0u, 1u, 7u, 8u, 63u, 64u, 65u, 200u, 1024u, 1100u, 5000u}) {
+        std::string text(size, 'a');
+        for (std::size_t i = 0; i < size; ++i) {
+            text[i] = static_cast<char>('a' + (i * 7) % 26);
+        }
+        const std::uint64_t base = hash_of(text);
+        EXPECT_EQ(base, hash_of(text));
+        EXPECT_NE(base, hash_of(text + 'x')) << size;
+        for (const std::size_t at : {std::size_t{0}, size / 2, size - 1}) {
+            if (size == 0) {
+                break;
+            }
+            std::string changed = text;
+            changed[at] ^= 1;
+            EXPECT_NE(base, hash_of(changed)) << size << " @" << at;
+        }
+    }
+}
+
+TEST(ContentCacheTest, Hash_FewCollisionsOnSimilarInputs) {
+    std::set<std::uint64_t> seen;
+    for (int i = 0; i < 20000; ++i) {
+        seen.insert(hash_of("Write-Host " + std::to_string(i)));
+        seen.insert(hash_of(std::string(100, 'z') + std::to_string(i)));
+    }
+    EXPECT_EQ(seen.size(), 40000u);
+}
+
+TEST(ContentCacheTest, FindAfterInsert_CountsRepeats) {
+    ContentCache cache;
+    EXPECT_EQ(cache.find(42, 10), nullptr);
+
+    ContentCache::Entry& entry = cache.insert(42, 10, 0x5);
+    entry.content = 7;
+    EXPECT_EQ(cache.find(42, 11), nullptr);  // Same hash, other size
+
+    ContentCache::Entry* again = cache.find(42, 10);
+    ASSERT_NE(again, nullptr);
+    EXPECT_EQ(again->verdict, 0x5u);
+    EXPECT_EQ(again->content, 7u);
+    EXPECT_EQ(again->repeats, 1u);
+    EXPECT_EQ(cache.hits(), 1u);
+    EXPECT_EQ(cache.misses(), 2u);
+}
+
+TEST(ContentCacheTest, Full_EvictsLeastRecentlyUsed) {
+    ContentCache cache;
+    // Hashes differing in the high half land in different buckets; the low
+    // half makes some share one
+    const auto hash = [](std::uint64_t i) { return (i << 32) | (i % 3); };
+    for (std::uint64_t i = 0; i < ContentCache::kCapacity; ++i) {
+        cache.insert(hash(i), 1, i);
+    }
+    EXPECT_EQ(cache.size(), ContentCache::kCapacity);
+
+    ASSERT_NE(cache.find(hash(0), 1), nullptr);  // Now the most recent
+    cache.insert(hash(5000), 1, 5000);            // Evicts 1, the oldest
+    EXPECT_EQ(cache.find(hash(1), 1), nullptr);
+    EXPECT_NE(cache.find(hash(0), 1), nullptr);
+    EXPECT_NE(cache.find(hash(2), 1), nullptr);
+    EXPECT_NE(cache.find(hash(5000), 1), nullptr);
+
+    // Evicting keeps every other entry reachable
+    for (std::uint64_t i = 0; i < ContentCache::kCapacity; ++i) {
+        cache.insert(hash(10000 + i), 1, i);
+    }
+    EXPECT_EQ(cache.size(), ContentCache::kCapacity);
+    for (std::uint64_t i = 0; i < ContentCache::kCapacity; ++i) {
+        ASSERT_NE(cache.find(hash(10000 + i), 1), nullptr) << i;
+    }
+    EXPECT_EQ(cache.find(hash(5000), 1), nullptr);
+}
+
+TEST(ContentCacheTest, Clear_ForgetsEntries) {
+    ContentCache cache;
+    cache.insert(1, 1, 0);
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.find(1, 1), nullptr);
+}
+
+TEST(ContentCacheTest, Scope_BindsCacheToThread) {
+    EXPECT_EQ(ContentCache::current(), nullptr);
+    ContentCache outer;
+    ContentCache inner;
+    {
+        const ContentCache::Scope bind_outer(&outer);
+        EXPECT_EQ(ContentCache::current(), &outer);
+        {
+            const ContentCache::Scope bind_inner(&inner);
+            EXPECT_EQ(ContentCache::current(), &inner);
+        }
+        EXPECT_EQ(ContentCache::current(), &outer);
+    }
+    EXPECT_EQ(ContentCache::current(), nullptr);
+}
+
+}  // namespace
+}  // namespace exeray::etw
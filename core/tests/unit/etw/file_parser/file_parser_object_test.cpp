@@ -0,0 +1,78 @@
+/// @file file_parser_object_test.cpp
+/// @brief File object to path resolution of I/O events.
+
+#include "file_parser_test_common.hpp"
+
+#ifdef _WIN32
+
+namespace exeray::etw {
+namespace {
+
+constexpr uint64_t kObject = 0xFFFFA00012345670ULL;
+
+// =============================================================================
+// File Object Resolution
+// =============================================================================
+
+class FileObjectTest : public FileParserTest {
+protected:
+    ParsedEvent parse(uint16_t event_id, std::vector<uint8_t>& data, uint32_t pid = 1234) {
+        EVENT_RECORD record = make_record(event_id, true);
+        record.EventHeader.ProcessId = pid;
+        record.UserData = data.data();
+        record.UserDataLength = static_cast<USHORT>(data.size());
+        return parse_file_event(&record, strings_.get());
+    }
+};
+
+TEST_F(FileObjectTest, Read_AfterCreate_TakesPath) {
+    auto create = build_file_create_data(L"C:\\Users\\Public\\data.bin", 0, true, kObject);
+    const auto path = parse(ids::file::CREATE, create).payload.file.path;
+    ASSERT_NE(path, event::INVALID_STRING);
+
+    auto read = build_file_read_write_data(4096, true, kObject);
+    auto result = parse(ids::file::READ, read);
+
+    EXPECT_EQ(result.payload.file.path, path);
+    EXPECT_EQ(strings_->get(result.payload.file.path), "C:\\Users\\Public\\data.bin");
+}
+
+TEST_F(FileObjectTest, SystemWrite_AttributedToOpener) {
+    auto create = build_file_create_data(L"C:\\out.log", 0, true, kObject);
+    parse(ids::file::CREATE, create, 1234);
+
+    auto write = build_file_read_write_data(512, true, kObject);
+    EXPECT_EQ(parse(ids::file::WRITE, write, 4).pid, 1234u);
+    EXPECT_EQ(parse(ids::file::WRITE, write, 5678).pid, 5678u);
+}
+
+TEST_F(FileObjectTest, Cleanup_NamesAndEvictsObject) {
+    auto create = build_file_create_data(L"C:\\out.log", 0, true, kObject);
+    const auto path = parse(ids::file::CREATE, create).payload.file.path;
+
+    auto cleanup = build_file_read_write_data(0, true, 0);
+    std::memcpy(cleanup.data() + 8, &kObject, sizeof(kObject));  // Irp, FileObject
+    EXPECT_EQ(parse(ids::file::CLEANUP, cleanup).payload.file.path, path);
+
+    auto read = build_file_read_write_data(4096, true, kObject);
+    EXPECT_EQ(parse(ids::file::READ, read).payload.file.path, event::INVALID_STRING);
+}
+
+TEST_F(FileObjectTest, Read_UnknownObject_Unnamed) {
+    auto read = build_file_read_write_data(4096, true, kObject);
+    auto result = parse(ids::file::READ, read);
+
+    EXPECT_TRUE(result.valid);
+    EXPECT_EQ(result.payload.file.path, event::INVALID_STRING);
+}
+
+}  // namespace
+}  // namespace exeray::etw
+
+#else  // !_WIN32
+
+TEST(FileParserObjectTest, SkippedOnNonWindows) {
+    GTEST_SKIP() << "ETW parser tests require Windows platform";
+}
+
+#endif  // _WIN32
@@ -26,6 +26,20 @@ TEST_F(FileParserTest, ParseFileRead_ExtractsIoSize) {
     EXPECT_EQ(result.payload.file.size, 65536u);
 }
 
+TEST_F(FileParserTest, ParseFileRead_ReportsFileObjectAndOneOp) {
+    auto data = build_file_read_write_data(512, true, 0xFFFFA00012345670);
+
+    EVENT_RECORD record = make_record(ids::file::READ, true);
+    record.UserData = data.data();
+    record.UserDataLength = static_cast<USHORT>(data.size());
+
+    auto result = parse_file_event(&record, strings_.get());
+
+    EXPECT_TRUE(result.valid);
+    EXPECT_EQ(result.object, 0xFFFFA00012345670u);
+    EXPECT_EQ(result.payload.file.ops, 1u);
+}
+
 TEST_F(FileParserTest, ParseFileWrite_ExtractsIoSize) {
     auto data = build_file_read_write_data(65536);
 
@@ -22,6 +22,7 @@
 
 #include "exeray/arena.hpp"
 #include "exeray/etw/event_ids.hpp"
+#include "exeray/etw/file_map.hpp"
 #include "exeray/etw/parser.hpp"
 #include "exeray/event/string_pool.hpp"
 #include "exeray/event/types.hpp"
@@ -35,8 +36,11 @@ protected:
     void SetUp() override {
         arena_ = std::make_unique<Arena>(kArenaSize);
         strings_ = std::make_unique<event::StringPool>(*arena_);
+        file_map().clear();
     }
 
+    void TearDown() override { file_map().clear(); }
+
     EVENT_RECORD make_record(uint16_t event_id, bool is64bit = true) {
         EVENT_RECORD record{};
         record.EventHeader.EventDescriptor.Id = event_id;
@@ -54,7 +58,8 @@ protected:
     std::vector<uint8_t> build_file_create_data(
         const std::wstring& path,
         uint32_t attributes = 0,
-        bool is64bit = true
+        bool is64bit = true,
+        uint64_t file_object = 0
     ) {
         const size_t ptr_size = is64bit ? 8 : 4;
         // Irp + FileObject + TTID + CreateOptions + FileAttributes + ShareAccess + path
@@ -62,6 +67,7 @@ protected:
                             (path.size() + 1) * sizeof(wchar_t);
 
         std::vector<uint8_t> buffer(total_size, 0);
+        std::memcpy(buffer.data() + ptr_size, &file_object, ptr_size);
         size_t offset = 0;
 
         // Skip Irp, FileObject
@@ -87,13 +93,15 @@ protected:
     ///         TTID(4), IoSize(4), IoFlags(4)
     std::vector<uint8_t> build_file_read_write_data(
         uint32_t io_size,
-        bool is64bit = true
+        bool is64bit = true,
+        uint64_t file_object = 0
     ) {
         const size_t ptr_size = is64bit ? 8 : 4;
         // Offset(8) + Irp + FileObject + FileKey + TTID + IoSize + IoFlags
         size_t total_size = 8 + ptr_size * 3 + sizeof(uint32_t) * 3;
 
         std::vector<uint8_t> buffer(total_size, 0);
+        std::memcpy(buffer.data() + 8 + ptr_size, &file_object, ptr_size);
         // Skip Offset(8) + Irp + FileObject + FileKey + TTID
         size_t offset = 8 + ptr_size * 3 + sizeof(uint32_t);
         // IoSize
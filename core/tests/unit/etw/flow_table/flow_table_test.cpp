@@ -0,0 +1,145 @@
+/// @file flow_table_test.cpp
+/// @brief Tests for the per-connection network flow table.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/flow_table.hpp"
+
+#include <cstdint>
+#include <memory>
+
+namespace exeray::etw {
+namespace {
+
+using event::NetworkOp;
+
+constexpr std::uint32_t kApp = 1000;
+constexpr std::uint64_t kMs = 1'000'000;
+
+event::EventPayload tcp(std::uint16_t local_port, std::uint32_t bytes = 0) {
+    event::EventPayload payload{};
+    payload.category = event::Category::Network;
+    payload.network.local_addr = 0x0100A8C0;
+    payload.network.remote_addr = 0x08080808;
+    payload.network.local_port = local_port;
+    payload.network.remote_port = 443;
+    payload.network.bytes = bytes;
+    payload.network.protocol = 6;
+    return payload;
+}
+
+/// @brief admit() of one event; bytes receives the stored size if kept.
+bool admit(FlowTable& table, event::EventPayload payload, NetworkOp op, event::Timestamp at,
+           std::uint32_t* bytes = nullptr) {
+    const bool kept = table.admit(kApp, payload, static_cast<std::uint8_t>(op), at);
+    if (bytes != nullptr) {
+        *bytes = payload.network.bytes;
+    }
+    return kept;
+}
+
+TEST(FlowTableTest, Transfers_FoldedIntoSummaries) {
+    auto table = std::make_unique<FlowTable>(FlowConfig{true, 100});
+    EXPECT_TRUE(admit(*table, tcp(5000), NetworkOp::Connect, 10 * kMs));
+    EXPECT_TRUE(admit(*table, tcp(5000, 100), NetworkOp::Receive, 11 * kMs));  // First each way
+    EXPECT_TRUE(admit(*table, tcp(5000, 7), NetworkOp::Send, 11 * kMs));
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_FALSE(admit(*table, tcp(5000, 10), NetworkOp::Receive, (12 + i) * kMs));
+    }
+
+    // One interval after the last stored receive, the summary carries the rest
+    std::uint32_t bytes = 0;
+    EXPECT_TRUE(admit(*table, tcp(5000, 10), NetworkOp::Receive, 111 * kMs, &bytes));
+    EXPECT_EQ(bytes, 510u);
+
+    const auto flows = table->flows(kApp);
+    ASSERT_EQ(flows.size(), 1u);
+    EXPECT_EQ(flows[0].key.local_port, 5000u);
+    EXPECT_EQ(flows[0].bytes_received, 610u);
+    EXPECT_EQ(flows[0].packets_received, 52u);
+    EXPECT_EQ(flows[0].bytes_sent, 7u);
+    EXPECT_EQ(flows[0].packets_sent, 1u);
+    EXPECT_EQ(flows[0].first_seen, 10 * kMs);
+    EXPECT_EQ(flows[0].last_seen, 111 * kMs);
+
+    const FlowStats stats = table->stats();
+    EXPECT_EQ(stats.flows, 1u);
+    EXPECT_EQ(stats.absorbed, 50u);
+    EXPECT_EQ(stats.summaries, 1u);
+}
+
+TEST(FlowTableTest, Close_ReportsRemainderAndEndsFlow) {
+    auto table = std::make_unique<FlowTable>(FlowConfig{true, 0});
+    EXPECT_TRUE(admit(*table, tcp(5000, 1), NetworkOp::Send, kMs));
+    EXPECT_FALSE(admit(*table, tcp(5000, 20), NetworkOp::Send, 2 * kMs));
+    EXPECT_TRUE(admit(*table, tcp(5000, 300), NetworkOp::Receive, 3 * kMs));
+    EXPECT_FALSE(admit(*table, tcp(5000, 4000), NetworkOp::Receive, 10'000 * kMs));  // No summaries
+
+    std::uint32_t bytes = 0;
+    EXPECT_TRUE(admit(*table, tcp(5000), NetworkOp::Close, 10'001 * kMs, &bytes));
+    EXPECT_EQ(bytes, 4020u);
+    EXPECT_TRUE(table->flows().empty());
+
+    // A close of an unknown flow is stored unchanged
+    EXPECT_TRUE(admit(*table, tcp(6000, 9), NetworkOp::Close, 10'002 * kMs, &bytes));
+    EXPECT_EQ(bytes, 9u);
+}
+
+TEST(FlowTableTest, FlowsKeyedByTupleAndProcess) {
+    auto table = std::make_unique<FlowTable>();
+    EXPECT_TRUE(admit(*table, tcp(5000, 1), NetworkOp::Receive, kMs));
+    EXPECT_TRUE(admit(*table, tcp(5001, 1), NetworkOp::Receive, kMs));
+    auto other = tcp(5000, 1);
+    EXPECT_TRUE(table->admit(kApp + 4, other, static_cast<std::uint8_t>(NetworkOp::Receive), kMs));
+    EXPECT_FALSE(admit(*table, tcp(5001, 1), NetworkOp::Receive, 2 * kMs));
+
+    EXPECT_EQ(table->flows().size(), 3u);
+    EXPECT_EQ(table->flows(kApp).size(), 2u);
+    EXPECT_EQ(table->flows(kApp + 4).size(), 1u);
+
+    // A connect on a tuple still open starts a new flow
+    EXPECT_TRUE(admit(*table, tcp(5001), NetworkOp::Connect, 3 * kMs));
+    EXPECT_TRUE(admit(*table, tcp(5001, 2), NetworkOp::Receive, 4 * kMs));
+    for (const FlowRecord& flow : table->flows(kApp)) {
+        if (flow.key.local_port == 5001) {
+            EXPECT_EQ(flow.bytes_received, 2u);
+            EXPECT_EQ(flow.first_seen, 3 * kMs);
+        }
+    }
+
+    table->clear();
+    EXPECT_TRUE(table->flows().empty());
+    EXPECT_EQ(table->stats().absorbed, 0u);
+}
+
+TEST(FlowTableTest, OtherEvents_PassThrough) {
+    auto table = std::make_unique<FlowTable>();
+    event::EventPayload file{};
+    file.category = event::Category::FileSystem;
+    EXPECT_TRUE(table->admit(kApp, file, 0, kMs));
+    EXPECT_TRUE(admit(*table, tcp(53), NetworkOp::DnsQuery, kMs));
+    EXPECT_TRUE(admit(*table, tcp(80), NetworkOp::Listen, kMs));
+    EXPECT_TRUE(table->flows().empty());
+}
+
+TEST(FlowTableTest, Full_StoresNewFlowsUnaggregated) {
+    auto table = std::make_unique<FlowTable>();
+    std::uint64_t kept = 0;
+    for (std::uint32_t flow = 0; flow < FlowTable::kMaxFlows + 4096; ++flow) {
+        auto payload = tcp(static_cast<std::uint16_t>(flow), 1);
+        payload.network.remote_addr = flow >> 16;
+        for (int i = 0; i < 2; ++i) {
+            kept += table->admit(kApp, payload, static_cast<std::uint8_t>(NetworkOp::Send), kMs)
+                        ? 1
+                        : 0;
+        }
+    }
+    const FlowStats stats = table->stats();
+    EXPECT_LE(stats.flows, FlowTable::kMaxFlows);
+    EXPECT_GT(stats.overflowed, 0u);
+    EXPECT_EQ(kept, stats.flows + stats.overflowed);  // First transfers and overflow
+    EXPECT_EQ(kept + stats.absorbed, 2 * (FlowTable::kMaxFlows + 4096));
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -250,9 +250,6 @@ TEST_F(ImageParserTest, ParseImageLoad_EmptyFileName_NotSuspicious) {
 }
 
 TEST_F(ImageParserTest, ParseImageLoad_CaseInsensitiveCheck) {
-    // Note: Current implementation uses wcsstr which is case-sensitive.
-    // This test documents the current behavior. If case-insensitive matching
-    // is implemented, this test should expect is_suspicious = 1.
     auto data = build_image_load_data_64bit(0x10000, 4096, 1234, L"C:\\WINDOWS\\TEMP\\x.dll");
 
     EVENT_RECORD record = make_record(ids::image::LOAD, true);
@@ -262,9 +259,7 @@ TEST_F(ImageParserTest, ParseImageLoad_CaseInsensitiveCheck) {
     auto result = parse_image_event(&record, strings_.get());
 
     EXPECT_TRUE(result.valid);
-    // Current implementation is case-sensitive, so uppercase TEMP won't match \temp\
-    // If case-insensitive detection is added later, change to EXPECT_EQ(..., 1u)
-    EXPECT_EQ(result.payload.image.is_suspicious, 0u);
+    EXPECT_EQ(result.payload.image.is_suspicious, 1u);
 }
 
 TEST_F(ImageParserTest, ParseImageLoad_UNCPath_NotFlagged) {
@@ -426,6 +421,34 @@ TEST_F(ImageParserTest, ParseImageUnload_SetsUnloadOperation) {
     EXPECT_EQ(result.operation, static_cast<uint8_t>(event::ImageOp::Unload));
 }
 
+// =============================================================================
+// 8. Module Map
+// =============================================================================
+
+TEST_F(ImageParserTest, ParseImageLoadAndUnload_UpdateModuleMap) {
+    module_map().clear();
+    auto load = build_image_load_data_64bit(0x7FF600000000ULL, 0x20000, 5678, L"C:\\app\\a.dll");
+    EVENT_RECORD record = make_record(ids::image::LOAD, true);
+    record.UserData = load.data();
+    record.UserDataLength = static_cast<USHORT>(load.size());
+
+    auto result = parse_image_event(&record, strings_.get());
+
+    ASSERT_TRUE(result.valid);
+    const auto module = module_map().find(5678, 0x7FF600010000ULL);
+    ASSERT_TRUE(module.has_value());
+    EXPECT_EQ(module->path, result.payload.image.image_path);
+
+    auto unload = build_image_unload_data_64bit(0x7FF600000000ULL, 0x20000, 5678);
+    record = make_record(ids::image::UNLOAD, true);
+    record.UserData = unload.data();
+    record.UserDataLength = static_cast<USHORT>(unload.size());
+    parse_image_event(&record, strings_.get());
+
+    EXPECT_FALSE(module_map().find(5678, 0x7FF600010000ULL).has_value());
+    module_map().clear();
+}
+
 }  // namespace
 }  // namespace exeray::etw
 
@@ -18,6 +18,7 @@
 
 #include "exeray/arena.hpp"
 #include "exeray/etw/event_ids.hpp"
+#include "exeray/etw/module_map.hpp"
 #include "exeray/etw/parser.hpp"
 #include "exeray/event/string_pool.hpp"
 #include "exeray/event/types.hpp"
@@ -0,0 +1,258 @@
+/// @file image_verifier_test.cpp
+/// @brief Tests for image hashing and verdict attachment on pool workers.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/image_verifier.hpp"
+#include "exeray/event/extensions.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/string_pool.hpp"
+#include "exeray/thread_pool.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace exeray::etw {
+namespace {
+
+using event::Category;
+using event::EventId;
+using event::Status;
+
+constexpr auto kLoad = static_cast<std::uint8_t>(event::ImageOp::Load);
+
+std::string hex(std::span<const std::uint8_t> bytes) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    std::string text;
+    for (const std::uint8_t byte : bytes) {
+        text += kHex[byte >> 4];
+        text += kHex[byte & 15];
+    }
+    return text;
+}
+
+std::span<const std::uint8_t> bytes_of(std::string_view text) {
+    return {reinterpret_cast<const std::uint8_t*>(text.data()), text.size()};
+}
+
+TEST(Sha256Test, MatchesKnownDigests) {
+    EXPECT_EQ(hex(sha256({})),
+              "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    EXPECT_EQ(hex(sha256(bytes_of("abc"))),
+              "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    // 56 bytes: the length no longer fits the first padding block
+    EXPECT_EQ(hex(sha256(bytes_of("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"))),
+              "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    const std::string million(1'000'000, 'a');
+    EXPECT_EQ(hex(sha256(bytes_of(million))),
+              "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+class ImageVerifierTest : public ::testing::Test {
+protected:
+    Arena arena_{64 * 1024 * 1024};
+    event::StringPool strings_{arena_};
+    event::ExtensionStore extensions_{arena_};
+    event::EventGraph graph_{arena_, strings_, 65536};
+    ThreadPool pool_{4};
+    std::filesystem::path dir_;
+
+    void SetUp() override {
+        dir_ = std::filesystem::temp_directory_path() /
+               ("exeray_images_" +
+                std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::filesystem::remove_all(dir_);
+        std::filesystem::create_directories(dir_);
+    }
+
+    void TearDown() override {
+        std::error_code error;
+        std::filesystem::remove_all(dir_, error);
+    }
+
+    std::filesystem::path write(std::string_view name, std::string_view content) {
+        const auto path = dir_ / name;
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+        return path;
+    }
+
+    void start(ImageVerifier& verifier) {
+        verifier.start(graph_, strings_, extensions_,
+                       [this](std::function<void()> task) { pool_.submit(std::move(task)); });
+    }
+
+    /// @brief Push an image load the way the consumer does: attach, then push.
+    EventId load(ImageVerifier& verifier, const std::filesystem::path& path) {
+        event::EventPayload payload{};
+        payload.category = Category::Image;
+        payload.image.image_path = strings_.intern_path(path.string());
+        payload.image.process_id = 100;
+        verifier.attach(payload);
+        return graph_.push(Category::Image, kLoad, Status::Success, event::INVALID_EVENT, 100,
+                           payload);
+    }
+
+    event::ImageVerdictExtension verdict_of(EventId id) {
+        const event::Extension extension = extensions_.get(graph_.get(id).payload().extension);
+        EXPECT_EQ(extension.kind, event::ExtensionKind::ImageVerdict);
+        event::ImageVerdictExtension verdict{};
+        EXPECT_TRUE(extension.read(verdict));
+        return verdict;
+    }
+};
+
+ImageVerifyConfig config() {
+    ImageVerifyConfig config;
+    config.enabled = true;
+    config.workers = 2;
+    return config;
+}
+
+TEST_F(ImageVerifierTest, EveryLoadGetsTheVerdictOfItsImage) {
+    const auto a = write("a.dll", "first image");
+    const auto b = write("b.dll", "second image");
+    ImageVerifier verifier(config());
+    start(verifier);
+
+    std::vector<EventId> loads_a;
+    std::vector<EventId> loads_b;
+    for (int i = 0; i < 100; ++i) {
+        loads_a.push_back(load(verifier, a));
+        loads_b.push_back(load(verifier, b));
+    }
+    verifier.stop();
+
+    const auto expected_a = hex(sha256(bytes_of("first image")));
+    const auto expected_b = hex(sha256(bytes_of("second image")));
+    for (const EventId id : loads_a) {
+        EXPECT_EQ(hex(verdict_of(id).sha256), expected_a);
+    }
+    for (const EventId id : loads_b) {
+        EXPECT_EQ(hex(verdict_of(id).sha256), expected_b);
+    }
+    // One record per image, shared by its loads
+    EXPECT_EQ(graph_.get(loads_a.front()).payload().extension,
+              graph_.get(loads_a.back()).payload().extension);
+
+    const ImageVerifyStats stats = verifier.stats();
+    EXPECT_EQ(stats.images, 2u);
+    EXPECT_EQ(stats.hashed, 2u);
+    EXPECT_EQ(stats.attached + stats.backfilled, 200u);
+}
+
+TEST_F(ImageVerifierTest, ResolvedImageIsAttachedBeforeThePush) {
+    const auto a = write("a.dll", "image");
+    ImageVerifier verifier(config());
+    start(verifier);
+    load(verifier, a);
+    verifier.stop();
+
+    start(verifier);  // New session: the path is resolved again, from the cache
+    const EventId first = load(verifier, a);
+    while (verifier.verdict(graph_.get(first).payload().image.image_path) ==
+           event::NO_EXTENSION) {
+        std::this_thread::yield();
+    }
+    const EventId second = load(verifier, a);
+    verifier.stop();
+
+    EXPECT_NE(graph_.get(second).payload().extension, event::NO_EXTENSION);
+    const ImageVerifyStats stats = verifier.stats();
+    EXPECT_EQ(stats.hashed, 0u);
+    EXPECT_EQ(stats.cached, 1u);
+    EXPECT_GE(stats.attached, 1u);
+}
+
+TEST_F(ImageVerifierTest, CachePersistsAcrossRunsUntilTheFileChanges) {
+    const auto a = write("a.dll", "version one");
+    const auto cache = dir_ / "images.cache";
+    {
+        ImageVerifier verifier(config());
+        start(verifier);
+        load(verifier, a);
+        verifier.stop();
+        EXPECT_EQ(verifier.stats().hashed, 1u);
+        ASSERT_TRUE(verifier.save(cache));
+    }
+    {
+        ImageVerifier verifier(config());
+        ASSERT_TRUE(verifier.load(cache));
+        start(verifier);
+        const EventId id = load(verifier, a);
+        verifier.stop();
+        EXPECT_EQ(verifier.stats().hashed, 0u);
+        EXPECT_EQ(verifier.stats().cached, 1u);
+        EXPECT_EQ(hex(verdict_of(id).sha256), hex(sha256(bytes_of("version one"))));
+    }
+
+    // A new version of the file is a new cache key
+    write("a.dll", "version two, longer");
+    std::filesystem::last_write_time(
+        a, std::filesystem::last_write_time(a) + std::chrono::seconds(10));
+    ImageVerifier verifier(config());
+    ASSERT_TRUE(verifier.load(cache));
+    start(verifier);
+    const EventId id = load(verifier, a);
+    verifier.stop();
+    EXPECT_EQ(verifier.stats().hashed, 1u);
+    EXPECT_EQ(hex(verdict_of(id).sha256), hex(sha256(bytes_of("version two, longer"))));
+}
+
+TEST_F(ImageVerifierTest, MissingOrOversizedFilesAreUnreadable) {
+    const auto big = write("big.dll", std::string(4096, 'x'));
+    ImageVerifyConfig small = config();
+    small.max_bytes = 1024;
+    ImageVerifier verifier(small);
+    start(verifier);
+    const EventId missing = load(verifier, dir_ / "missing.dll");
+    const EventId oversized = load(verifier, big);
+    verifier.stop();
+
+    EXPECT_EQ(verdict_of(missing).signature, event::ImageSignature::Unreadable);
+    EXPECT_EQ(verdict_of(oversized).signature, event::ImageSignature::Unreadable);
+    EXPECT_EQ(verifier.stats().unreadable, 2u);
+}
+
+TEST_F(ImageVerifierTest, LoadRejectsFilesThatAreNotCaches) {
+    ImageVerifier verifier(config());
+    EXPECT_FALSE(verifier.load(write("garbage.cache", "not an image cache")));
+    EXPECT_FALSE(verifier.load(dir_ / "missing.cache"));
+}
+
+TEST_F(ImageVerifierTest, LoadRejectsCountsBeyondTheFile) {
+    const auto cache = dir_ / "images.cache";
+    {
+        ImageVerifier verifier(config());
+        start(verifier);
+        load(verifier, write("a.dll", "content"));
+        verifier.stop();
+        ASSERT_TRUE(verifier.save(cache));
+    }
+    std::string bytes;
+    {
+        std::ifstream file(cache, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(file), {});
+    }
+    ASSERT_GE(bytes.size(), 16u);
+    for (const std::uint32_t count : {2u, 0xFFFFFFFFu}) {
+        std::memcpy(bytes.data() + 12, &count, sizeof(count));  // Header: record count
+        ImageVerifier verifier(config());
+        EXPECT_FALSE(verifier.load(write("images.cache", bytes))) << count;
+    }
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,149 @@
+/// @file ingest_latency_test.cpp
+/// @brief Tests for the ingest latency histograms.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/ingest_latency.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace exeray::etw {
+namespace {
+
+using event::Category;
+
+event::PendingEvent at(Category category, event::Timestamp ts) {
+    event::PendingEvent event{};
+    event.category = category;
+    event.timestamp = ts;
+    return event;
+}
+
+TEST(LatencyHistogramTest, BucketOf_SmallValuesExact) {
+    for (std::uint64_t ns = 0; ns < LatencyHistogram::kSubBuckets; ++ns) {
+        EXPECT_EQ(LatencyHistogram::bucket_of(ns), ns);
+        EXPECT_EQ(LatencyHistogram::upper_bound(ns), ns);
+    }
+}
+
+TEST(LatencyHistogramTest, BucketOf_BoundsContainValue) {
+    for (std::uint64_t ns : {16ULL, 17ULL, 31ULL, 32ULL, 1000ULL, 123456789ULL, 1ULL << 40}) {
+        const std::size_t bucket = LatencyHistogram::bucket_of(ns);
+        const std::uint64_t upper = LatencyHistogram::upper_bound(bucket);
+        EXPECT_GE(upper, ns);
+        EXPECT_LE(upper - ns, ns / LatencyHistogram::kSubBuckets);
+        EXPECT_LT(LatencyHistogram::upper_bound(bucket - 1), ns);
+    }
+}
+
+TEST(LatencyHistogramTest, BucketOf_HugeValues_LastBucket) {
+    EXPECT_EQ(LatencyHistogram::bucket_of(UINT64_MAX), LatencyHistogram::kBuckets - 1);
+    EXPECT_EQ(LatencyHistogram::bucket_of((1ULL << 41) - 1), LatencyHistogram::kBuckets - 1);
+}
+
+TEST(LatencyHistogramTest, Percentile_Empty_Zero) {
+    const LatencyHistogram histogram;
+    EXPECT_EQ(histogram.percentile(0.99), 0U);
+    EXPECT_EQ(histogram.summary().count, 0U);
+}
+
+TEST(LatencyHistogramTest, Summary_MatchesPercentiles) {
+    auto histogram = std::make_unique<LatencyHistogram>();
+    for (std::uint64_t ns = 1; ns <= 10000; ++ns) {
+        histogram->record(ns * 1000);  // 1 us .. 10 ms
+    }
+
+    const LatencySummary summary = histogram->summary();
+    EXPECT_EQ(summary.count, 10000U);
+    EXPECT_EQ(summary.p50, histogram->percentile(0.50));
+    EXPECT_EQ(summary.p99, histogram->percentile(0.99));
+    EXPECT_EQ(summary.p999, histogram->percentile(0.999));
+    EXPECT_NEAR(static_cast<double>(summary.p50), 5'000'000.0, 5'000'000.0 / 16);
+    EXPECT_NEAR(static_cast<double>(summary.p99), 9'900'000.0, 9'900'000.0 / 16);
+    EXPECT_GE(summary.max, 10'000'000U);
+}
+
+TEST(LatencyHistogramTest, Merge_AddsCounts) {
+    LatencyHistogram a;
+    LatencyHistogram b;
+    a.record(10);
+    b.record(20);
+    b.record(30);
+    a.merge(b);
+
+    EXPECT_EQ(a.count(), 3U);
+    a.reset();
+    EXPECT_EQ(a.count(), 0U);
+}
+
+TEST(IngestLatencyTest, Record_FutureTimestamp_CountsAsZero) {
+    auto latency = std::make_unique<IngestLatency>();
+    latency->record(LatencyStage::Delivered, Category::Process, 500, 100);
+
+    const LatencySummary summary = latency->summary(LatencyStage::Delivered, Category::Process);
+    EXPECT_EQ(summary.count, 1U);
+    EXPECT_EQ(summary.max, 0U);
+}
+
+TEST(IngestLatencyTest, Summary_PerCategoryAndAll) {
+    auto latency = std::make_unique<IngestLatency>();
+    latency->record(LatencyStage::Visible, Category::FileSystem, 0, 10);
+    latency->record(LatencyStage::Visible, Category::Network, 0, 1'000'000);
+
+    EXPECT_EQ(latency->summary(LatencyStage::Visible, Category::FileSystem).count, 1U);
+    EXPECT_EQ(latency->summary(LatencyStage::Visible, Category::FileSystem).p99, 10U);
+    const LatencySummary all = latency->summary(LatencyStage::Visible, Category::Count);
+    EXPECT_EQ(all.count, 2U);
+    EXPECT_GE(all.max, 1'000'000U);
+    EXPECT_EQ(latency->summary(LatencyStage::Delivered, Category::Count).count, 0U);
+    EXPECT_EQ(latency->summary(LatencyStage::Count, Category::Count).count, 0U);
+}
+
+TEST(IngestLatencyTest, RecordVisible_SamplesOneInN) {
+    auto latency = std::make_unique<IngestLatency>();
+    std::vector<event::PendingEvent> batch(IngestLatency::kSampleEvery * 4 + 1,
+                                           at(Category::Registry, 100));
+    std::uint32_t tick = 0;
+    latency->record_visible(batch, 200, tick);
+
+    EXPECT_EQ(latency->summary(LatencyStage::Visible, Category::Registry).count, 5U);
+    EXPECT_EQ(tick, batch.size());
+}
+
+TEST(IngestLatencyTest, Due_FirstThenEveryN) {
+    std::uint32_t tick = 0;
+    std::size_t sampled = 0;
+    for (std::uint32_t i = 0; i < IngestLatency::kSampleEvery * 3; ++i) {
+        sampled += IngestLatency::due(tick) ? 1 : 0;
+    }
+    EXPECT_EQ(sampled, 3U);
+}
+
+TEST(IngestLatencyTest, Record_ConcurrentThreads_Summed) {
+    auto latency = std::make_unique<IngestLatency>();
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 5000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&latency] {
+            for (int i = 0; i < kPerThread; ++i) {
+                latency->record(LatencyStage::Visible, Category::Thread, 0,
+                                static_cast<event::Timestamp>(i));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(latency->summary(LatencyStage::Visible, Category::Thread).count,
+              std::uint64_t{kThreads} * kPerThread);
+    latency->reset();
+    EXPECT_EQ(latency->summary(LatencyStage::Visible, Category::Count).count, 0U);
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,132 @@
+/// @file io_coalescer_test.cpp
+/// @brief Tests for the merging of consecutive file reads and writes.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/io_coalescer.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace exeray::etw {
+namespace {
+
+using event::FileOp;
+
+constexpr std::uint32_t kApp = 1000;
+constexpr std::uint64_t kHandle = 0xFFFF'A000'0000'1000;
+constexpr std::uint64_t kOtherHandle = 0xFFFF'A000'0000'2000;
+constexpr event::Timestamp kMs = 1'000'000;
+
+event::PendingEvent file(FileOp op, event::Timestamp at, std::uint64_t size = 0,
+                         std::uint32_t pid = kApp) {
+    event::PendingEvent event{};
+    event.category = event::Category::FileSystem;
+    event.operation = static_cast<std::uint8_t>(op);
+    event.status = event::Status::Success;
+    event.payload.category = event::Category::FileSystem;
+    event.payload.file.size = size;
+    event.payload.file.ops = op == FileOp::Read || op == FileOp::Write ? 1 : 0;
+    event.timestamp = at;
+    event.pid = pid;
+    return event;
+}
+
+class IoCoalescerTest : public ::testing::Test {
+protected:
+    void SetUp() override { io_.set_window(100 * kMs); }
+
+    IoCoalescer io_;
+    std::vector<event::PendingEvent> out_;
+};
+
+TEST_F(IoCoalescerTest, Disabled_TakesNothing) {
+    IoCoalescer off;
+    EXPECT_FALSE(off.enabled());
+    EXPECT_FALSE(off.offer(file(FileOp::Read, kMs, 10), kHandle, out_));
+    EXPECT_TRUE(out_.empty());
+}
+
+TEST_F(IoCoalescerTest, ConsecutiveReads_MergedUntilCleanup) {
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(io_.offer(file(FileOp::Read, (1 + i) * kMs, 4096), kHandle, out_));
+    }
+    EXPECT_TRUE(out_.empty());
+    EXPECT_EQ(io_.held(), 1u);
+    EXPECT_EQ(io_.merged(), 9u);
+
+    // The cleanup of the handle is stored after the merged read
+    EXPECT_FALSE(io_.offer(file(FileOp::Create, 20 * kMs), kHandle, out_));
+    ASSERT_EQ(out_.size(), 1u);
+    EXPECT_EQ(out_[0].operation, static_cast<std::uint8_t>(FileOp::Read));
+    EXPECT_EQ(out_[0].payload.file.size, 40960u);
+    EXPECT_EQ(out_[0].payload.file.ops, 10u);
+    EXPECT_EQ(out_[0].timestamp, kMs);
+    EXPECT_EQ(io_.held(), 0u);
+}
+
+TEST_F(IoCoalescerTest, OperationChange_StartsNewRun) {
+    EXPECT_TRUE(io_.offer(file(FileOp::Read, kMs, 10), kHandle, out_));
+    EXPECT_TRUE(io_.offer(file(FileOp::Read, 2 * kMs, 10), kHandle, out_));
+    EXPECT_TRUE(io_.offer(file(FileOp::Write, 3 * kMs, 5), kHandle, out_));
+    ASSERT_EQ(out_.size(), 1u);
+    EXPECT_EQ(out_[0].payload.file.size, 20u);
+
+    io_.release_all(out_);
+    ASSERT_EQ(out_.size(), 2u);
+    EXPECT_EQ(out_[1].operation, static_cast<std::uint8_t>(FileOp::Write));
+    EXPECT_EQ(out_[1].payload.file.ops, 1u);
+}
+
+TEST_F(IoCoalescerTest, HandlesAndProcesses_KeptApart) {
+    EXPECT_TRUE(io_.offer(file(FileOp::Write, kMs, 1), kHandle, out_));
+    EXPECT_TRUE(io_.offer(file(FileOp::Write, kMs, 2), kOtherHandle, out_));
+    EXPECT_TRUE(io_.offer(file(FileOp::Write, kMs, 3, kApp + 4), kHandle, out_));
+    EXPECT_TRUE(io_.offer(file(FileOp::Write, 2 * kMs, 4), kOtherHandle, out_));
+    EXPECT_EQ(io_.held(), 3u);
+    EXPECT_TRUE(out_.empty());
+
+    // Without a file object nothing can be keyed
+    EXPECT_FALSE(io_.offer(file(FileOp::Write, 3 * kMs, 5), 0, out_));
+    io_.release_all(out_);
+    ASSERT_EQ(out_.size(), 3u);
+    EXPECT_EQ(out_[1].payload.file.size, 6u);
+}
+
+TEST_F(IoCoalescerTest, Window_ReleasesRunsThatOutlivedIt) {
+    EXPECT_TRUE(io_.offer(file(FileOp::Read, kMs, 1), kHandle, out_));
+    EXPECT_TRUE(io_.offer(file(FileOp::Read, 50 * kMs, 1), kOtherHandle, out_));
+
+    io_.expire(100 * kMs, out_);
+    EXPECT_TRUE(out_.empty());
+    io_.expire(102 * kMs, out_);
+    ASSERT_EQ(out_.size(), 1u);
+    EXPECT_EQ(out_[0].timestamp, kMs);
+
+    // A read past the window of its run starts the next one
+    EXPECT_TRUE(io_.offer(file(FileOp::Read, 140 * kMs, 1), kOtherHandle, out_));
+    EXPECT_TRUE(io_.offer(file(FileOp::Read, 151 * kMs, 1), kOtherHandle, out_));
+    ASSERT_EQ(out_.size(), 2u);
+    EXPECT_EQ(out_[1].payload.file.ops, 2u);
+    EXPECT_EQ(io_.held(), 1u);
+}
+
+TEST_F(IoCoalescerTest, Suspicious_NeverMerged) {
+    EXPECT_TRUE(io_.offer(file(FileOp::Write, kMs, 1), kHandle, out_));
+    auto flagged = file(FileOp::Write, 2 * kMs, 1);
+    flagged.status = event::Status::Suspicious;
+    EXPECT_FALSE(io_.offer(flagged, kHandle, out_));
+    ASSERT_EQ(out_.size(), 1u);
+    EXPECT_EQ(io_.held(), 0u);
+}
+
+TEST_F(IoCoalescerTest, Bounded_ReleasesOldestRun) {
+    for (std::uint64_t i = 0; i <= IoCoalescer::kMaxRuns; ++i) {
+        EXPECT_TRUE(io_.offer(file(FileOp::Read, kMs, 1), kHandle + i * 8, out_));
+    }
+    EXPECT_EQ(io_.held(), IoCoalescer::kMaxRuns);
+    ASSERT_EQ(out_.size(), 1u);
+}
+
+}  // namespace
+}  // namespace exeray::etw
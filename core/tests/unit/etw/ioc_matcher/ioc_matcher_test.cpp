@@ -0,0 +1,158 @@
+/// @file ioc_matcher_test.cpp
+/// @brief Tests for IOC list loading and matching.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/ioc_matcher.hpp"
+#include "exeray/event/string_pool.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace exeray::etw {
+namespace {
+
+IocConfig sample_config() {
+    IocConfig config;
+    config.enabled = true;
+    config.lists.push_back(IocList{"c2", IocKind::Domain, {"evil.example.com", "Bad.Test."}, ""});
+    config.lists.push_back(IocList{"tools", IocKind::Path,
+                                   {"C:/Users/Public/dropper.exe", "mimikatz.exe"}, ""});
+    config.lists.push_back(IocList{"hosts", IocKind::Address, {"203.0.113.7", "10.0.0.300"}, ""});
+    return config;
+}
+
+TEST(IocMatcherTest, Domain_MatchesNameAndSubdomains) {
+    const IocMatcher matcher(sample_config());
+    EXPECT_EQ(matcher.match_domain("evil.example.com"), 0u);
+    EXPECT_EQ(matcher.match_domain("CDN.Evil.Example.com"), 0u);
+    EXPECT_EQ(matcher.match_domain("bad.test."), 0u);
+    EXPECT_FALSE(matcher.match_domain("example.com").has_value());
+    EXPECT_FALSE(matcher.match_domain("notevil.example.com").has_value());
+    EXPECT_FALSE(matcher.match_domain("").has_value());
+}
+
+TEST(IocMatcherTest, Path_MatchesWholePathOrBareName) {
+    const IocMatcher matcher(sample_config());
+    EXPECT_EQ(matcher.match_path("c:\\users\\public\\DROPPER.exe"), 1u);
+    EXPECT_EQ(matcher.match_path("D:\\tmp\\Mimikatz.EXE"), 1u);
+    EXPECT_EQ(matcher.match_path("mimikatz.exe"), 1u);
+    EXPECT_FALSE(matcher.match_path("C:\\Temp\\dropper.exe").has_value());
+    EXPECT_FALSE(matcher.match_path("C:\\tools\\mimikatz.exe.txt").has_value());
+}
+
+TEST(IocMatcherTest, Address_ParsesDottedQuads) {
+    EXPECT_EQ(IocMatcher::parse_address("8.8.4.4"), 0x04040808u);
+    EXPECT_EQ(IocMatcher::parse_address("1.2.3.4"), 0x04030201u);
+    EXPECT_FALSE(IocMatcher::parse_address("1.2.3").has_value());
+    EXPECT_FALSE(IocMatcher::parse_address("1.2.3.256").has_value());
+    EXPECT_FALSE(IocMatcher::parse_address("1.2.3.4.5").has_value());
+    EXPECT_FALSE(IocMatcher::parse_address("1..3.4").has_value());
+
+    const IocMatcher matcher(sample_config());
+    EXPECT_EQ(matcher.match_address(*IocMatcher::parse_address("203.0.113.7")), 2u);
+    EXPECT_FALSE(matcher.match_address(*IocMatcher::parse_address("203.0.113.8")).has_value());
+
+    const auto stats = matcher.stats();
+    ASSERT_EQ(stats.size(), 3u);
+    EXPECT_EQ(stats[2].entries, 1u);
+    EXPECT_EQ(stats[2].rejected, 1u);  // 10.0.0.300
+}
+
+TEST(IocMatcherTest, Address_MatchesIpv6InAnyTextForm) {
+    IocConfig config;
+    config.enabled = true;
+    config.lists.push_back(
+        IocList{"hosts6", IocKind::Address, {"2001:DB8:0:0::7", "::ffff:198.51.100.1", "2001::g"}, ""});
+    IocMatcher matcher(config);
+    EXPECT_EQ(matcher.match_ipv6("2001:db8::7"), 0u);
+    EXPECT_EQ(matcher.match_ipv6("::ffff:198.51.100.1"), 0u);
+    EXPECT_FALSE(matcher.match_ipv6("2001:db8::8").has_value());
+    EXPECT_EQ(matcher.stats()[0].rejected, 1u);
+
+    // Network payloads of IPv6 traffic carry the interned canonical text
+    Arena arena(64 * 1024);
+    event::StringPool strings(arena);
+    event::EventPayload network{};
+    network.category = event::Category::Network;
+    network.network.family = event::kAddressIPv6;
+    network.network.remote_addr = strings.intern("2001:db8::7");
+    EXPECT_EQ(matcher.match(network, strings), 0u);
+    network.network.remote_addr = event::INVALID_STRING;
+    EXPECT_FALSE(matcher.match(network, strings).has_value());
+}
+
+TEST(IocMatcherTest, Match_ChecksPayloadFieldsAndCountsHits) {
+    Arena arena(64 * 1024);
+    event::StringPool strings(arena);
+    IocMatcher matcher(sample_config());
+
+    event::EventPayload file{};
+    file.category = event::Category::FileSystem;
+    file.file.path = strings.intern_path("C:\\Tools\\mimikatz.exe");
+    event::EventPayload dns{};
+    dns.category = event::Category::Dns;
+    dns.dns.domain = strings.intern("www.evil.example.com");
+    event::EventPayload network{};
+    network.category = event::Category::Network;
+    network.network.remote_addr = *IocMatcher::parse_address("203.0.113.7");
+    event::EventPayload clean{};
+    clean.category = event::Category::Dns;
+    clean.dns.domain = strings.intern("example.org");
+
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(matcher.match(file, strings), 1u);  // Remembered after the first
+    }
+    EXPECT_EQ(matcher.match(dns, strings), 0u);
+    EXPECT_EQ(matcher.match(network, strings), 2u);
+    EXPECT_FALSE(matcher.match(clean, strings).has_value());
+    EXPECT_FALSE(matcher.match(clean, strings).has_value());
+
+    auto stats = matcher.stats();
+    EXPECT_EQ(stats[0].hits, 1u);
+    EXPECT_EQ(stats[1].hits, 3u);
+    EXPECT_EQ(stats[2].hits, 1u);
+
+    matcher.reset();
+    stats = matcher.stats();
+    EXPECT_EQ(stats[1].hits, 0u);
+    EXPECT_EQ(matcher.match(file, strings), 1u);
+}
+
+TEST(IocMatcherTest, File_LoadsOneIndicatorPerLine) {
+    const auto path = std::filesystem::temp_directory_path() / "exeray_ioc_matcher_test.txt";
+    {
+        std::ofstream out(path);
+        out << "# feed header\n\nfirst.example\r\n  second.example  \n";
+        for (int i = 0; i < 5000; ++i) {
+            out << "host" << i << ".feed.example\n";
+        }
+    }
+    IocConfig config;
+    config.lists.push_back(IocList{"feed", IocKind::Domain, {}, path.string()});
+    config.lists.push_back(IocList{"missing", IocKind::Domain, {}, (path / "absent").string()});
+    const IocMatcher matcher(config);
+    std::filesystem::remove(path);
+
+    EXPECT_FALSE(matcher.empty());
+    EXPECT_EQ(matcher.stats()[0].entries, 5002u);
+    EXPECT_EQ(matcher.stats()[1].entries, 0u);
+    EXPECT_EQ(matcher.match_domain("first.example"), 0u);
+    EXPECT_EQ(matcher.match_domain("second.example"), 0u);
+    EXPECT_EQ(matcher.match_domain("host4999.feed.example"), 0u);
+    EXPECT_FALSE(matcher.match_domain("host5000.feed.example").has_value());
+    EXPECT_FALSE(matcher.match_domain("feed.example").has_value());
+}
+
+TEST(IocMatcherTest, Empty_NeverMatches) {
+    const IocMatcher matcher;
+    EXPECT_TRUE(matcher.empty());
+    EXPECT_FALSE(matcher.match_domain("evil.example.com").has_value());
+    EXPECT_FALSE(matcher.match_path("C:\\x.exe").has_value());
+    EXPECT_FALSE(matcher.match_address(1).has_value());
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,72 @@
+/// @file ip_address_test.cpp
+/// @brief Tests for IPv6 text conversion and interning.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/ip_address.hpp"
+#include "exeray/event/string_pool.hpp"
+
+#include <array>
+#include <string>
+#include <string_view>
+
+namespace exeray::etw {
+namespace {
+
+std::string canonical(std::string_view text) {
+    const auto address = parse_ipv6(text);
+    if (!address) {
+        return "<invalid>";
+    }
+    std::array<char, kMaxIpv6Text + 1> out{};
+    return std::string(format_ipv6(*address, out));
+}
+
+TEST(IpAddressTest, Format_IsCanonical) {
+    EXPECT_EQ(canonical("2001:0DB8:0000:0000:0000:0000:0000:0001"), "2001:db8::1");
+    EXPECT_EQ(canonical("::"), "::");
+    EXPECT_EQ(canonical("::1"), "::1");
+    EXPECT_EQ(canonical("1::"), "1::");
+    EXPECT_EQ(canonical("2001:db8:0:1:1:1:1:1"), "2001:db8:0:1:1:1:1:1");  // One zero group stays
+    EXPECT_EQ(canonical("2001:0:0:1:0:0:0:1"), "2001:0:0:1::1");          // Longest run
+    EXPECT_EQ(canonical("2001:db8:0:0:1:0:0:1"), "2001:db8::1:0:0:1");    // First on a tie
+    EXPECT_EQ(canonical("fe80::abcd:ef01:2345:6789"), "fe80::abcd:ef01:2345:6789");
+    EXPECT_EQ(canonical("::ffff:c000:0280"), "::ffff:192.0.2.128");
+    EXPECT_EQ(canonical("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff"),
+              "ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff");
+}
+
+TEST(IpAddressTest, Parse_AcceptsEmbeddedIpv4) {
+    const auto address = parse_ipv6("64:ff9b::192.0.2.33");
+    ASSERT_TRUE(address.has_value());
+    EXPECT_EQ((*address)[0], 0x00);
+    EXPECT_EQ((*address)[1], 0x64);
+    EXPECT_EQ((*address)[12], 192);
+    EXPECT_EQ((*address)[15], 33);
+    EXPECT_EQ(canonical("::ffff:10.0.0.1"), "::ffff:10.0.0.1");
+}
+
+TEST(IpAddressTest, Parse_RejectsMalformed) {
+    for (const char* text : {"", ":", "1:", ":1", "1:::2", "1::2::3", "12345::", "g::",
+                             "1:2:3:4:5:6:7", "1:2:3:4:5:6:7:8:9", "1::2:3:4:5:6:7:8",
+                             "::1.2.3", "::1.2.3.4:5", "1.2.3.4", "::256.0.0.1"}) {
+        EXPECT_FALSE(parse_ipv6(text).has_value()) << text;
+    }
+}
+
+TEST(IpAddressTest, Intern_DedupesByCanonicalText) {
+    Arena arena(64 * 1024);
+    event::StringPool strings(arena);
+    const auto a = parse_ipv6("2001:db8::1");
+    const auto b = parse_ipv6("2001:DB8:0::0:1");
+    ASSERT_TRUE(a && b);
+    const event::StringId id = intern_ipv6(*a, &strings);
+    EXPECT_NE(id, event::INVALID_STRING);
+    EXPECT_EQ(intern_ipv6(*b, &strings), id);
+    EXPECT_EQ(strings.get(id), "2001:db8::1");
+    EXPECT_EQ(intern_ipv6(*a, nullptr), event::INVALID_STRING);
+}
+
+}  // namespace
+}  // namespace exeray::etw
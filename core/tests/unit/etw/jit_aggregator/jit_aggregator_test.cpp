@@ -0,0 +1,128 @@
+/// @file jit_aggregator_test.cpp
+/// @brief Tests for per-module aggregation of CLR JIT events.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/jit_aggregator.hpp"
+
+#include <cstdint>
+
+namespace exeray::etw {
+namespace {
+
+constexpr std::uint64_t kMs = 1'000'000;
+constexpr std::uint64_t kModule = 0x7FFA10000000ULL;
+constexpr event::StringId kAssembly = 21;
+constexpr event::StringId kMethod = 22;
+
+event::EventPayload clr_payload(std::uint64_t module_id,
+                                event::StringId assembly = event::INVALID_STRING) {
+    event::EventPayload payload{};
+    payload.category = event::Category::Clr;
+    payload.clr.assembly_name = assembly;
+    payload.clr.method_name = kMethod;
+    payload.clr.load_address = module_id;
+    payload.clr.methods = 1;
+    return payload;
+}
+
+bool load(JitAggregator& jit, std::uint32_t pid, std::uint64_t module_id, bool dynamic = false) {
+    event::EventPayload payload = clr_payload(module_id, kAssembly);
+    payload.clr.is_dynamic = dynamic ? 1 : 0;
+    return jit.admit(pid, payload, static_cast<std::uint8_t>(event::ClrOp::ModuleLoad), 0);
+}
+
+bool compile(JitAggregator& jit, std::uint32_t pid, event::EventPayload& payload,
+             event::Timestamp at) {
+    return jit.admit(pid, payload, static_cast<std::uint8_t>(event::ClrOp::MethodJit), at);
+}
+
+TEST(JitAggregatorTest, Admit_FirstCompilationThenPeriodicSummaries) {
+    JitAggregator jit(JitConfig{true, 100});
+    EXPECT_TRUE(load(jit, 100, kModule));
+
+    int stored = 0;
+    std::uint64_t counted = 0;
+    for (std::uint64_t i = 0; i < 1000; ++i) {
+        event::EventPayload payload = clr_payload(kModule);
+        if (compile(jit, 100, payload, i * kMs)) {
+            ++stored;
+            counted += payload.clr.methods;
+            EXPECT_EQ(payload.clr.assembly_name, kAssembly);
+        }
+    }
+    // The first and one per 100 ms; their counts add up to every compilation
+    EXPECT_EQ(stored, 10);
+    EXPECT_EQ(counted, 1000u - 99u);
+
+    const JitStats stats = jit.stats();
+    EXPECT_EQ(stats.modules, 1u);
+    EXPECT_EQ(stats.summaries, 9u);
+    EXPECT_EQ(stats.absorbed, 990u);
+
+    const auto modules = jit.modules(100);
+    ASSERT_EQ(modules.size(), 1u);
+    EXPECT_EQ(modules[0].methods, 1000u);
+    EXPECT_EQ(modules[0].assembly, kAssembly);
+    EXPECT_TRUE(jit.modules(200).empty());
+}
+
+TEST(JitAggregatorTest, Admit_DynamicModulesAndSuspiciousMethodsKeptIndividually) {
+    JitAggregator jit;
+    EXPECT_TRUE(load(jit, 100, kModule, true));
+    for (int i = 0; i < 5; ++i) {
+        event::EventPayload payload = clr_payload(kModule);
+        EXPECT_TRUE(compile(jit, 100, payload, 1));
+        EXPECT_EQ(payload.clr.is_dynamic, 1);
+        EXPECT_EQ(payload.clr.is_suspicious, 1);
+        EXPECT_EQ(payload.clr.methods, 1u);
+    }
+
+    // Obfuscated names in an ordinary module
+    event::EventPayload first = clr_payload(kModule + 1);
+    EXPECT_TRUE(compile(jit, 100, first, 1));
+    event::EventPayload obfuscated = clr_payload(kModule + 1);
+    obfuscated.clr.is_suspicious = 1;
+    EXPECT_TRUE(compile(jit, 100, obfuscated, 2));
+    event::EventPayload plain = clr_payload(kModule + 1);
+    EXPECT_FALSE(compile(jit, 100, plain, 3));
+
+    EXPECT_EQ(jit.stats().flagged, 6u);
+    EXPECT_EQ(jit.stats().absorbed, 1u);
+}
+
+TEST(JitAggregatorTest, Admit_ProcessesAndModulesAggregateSeparately) {
+    JitAggregator jit(JitConfig{true, 0});
+    for (std::uint32_t pid : {100u, 200u}) {
+        for (std::uint64_t module_id : {kModule, kModule + 0x1000}) {
+            for (int i = 0; i < 3; ++i) {
+                event::EventPayload payload = clr_payload(module_id);
+                EXPECT_EQ(compile(jit, pid, payload, 1), i == 0);
+            }
+        }
+    }
+    EXPECT_EQ(jit.stats().modules, 4u);
+    EXPECT_EQ(jit.modules().size(), 4u);
+    // Compiled before their load: named once it arrives
+    EXPECT_TRUE(load(jit, 100, kModule));
+    event::EventPayload payload = clr_payload(kModule);
+    EXPECT_FALSE(compile(jit, 100, payload, 2));
+    EXPECT_EQ(payload.clr.assembly_name, kAssembly);
+
+    jit.clear();
+    EXPECT_EQ(jit.stats().modules, 0u);
+    EXPECT_EQ(jit.stats().absorbed, 0u);
+}
+
+TEST(JitAggregatorTest, Admit_OtherEventsPassThrough) {
+    JitAggregator jit;
+    event::EventPayload payload = clr_payload(kModule);
+    EXPECT_TRUE(jit.admit(1, payload, static_cast<std::uint8_t>(event::ClrOp::AssemblyLoad), 0));
+    event::EventPayload file{};
+    file.category = event::Category::FileSystem;
+    EXPECT_TRUE(jit.admit(1, file, static_cast<std::uint8_t>(event::ClrOp::MethodJit), 0));
+    EXPECT_EQ(jit.stats().modules, 0u);
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,109 @@
+/// @file key_map_test.cpp
+/// @brief Tests for the registry key object to path cache.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/key_map.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace exeray::etw {
+namespace {
+
+constexpr std::uint64_t kRun = 0xFFFF'C001'2345'6780ULL;
+constexpr std::uint64_t kServices = 0xFFFF'C001'2345'67A0ULL;
+
+TEST(KeyMapTest, Find_ReturnsPath) {
+    auto map = std::make_unique<KeyMap>();
+    map->insert(kRun, 10);
+    map->insert(kServices, 20);
+
+    EXPECT_EQ(map->find(kRun), 10u);
+    EXPECT_EQ(map->find(kServices), 20u);
+    EXPECT_EQ(map->find(kRun + 0x40), event::INVALID_STRING);
+    EXPECT_EQ(map->size(), 2u);
+}
+
+TEST(KeyMapTest, Insert_ReusedObject_Replaces) {
+    auto map = std::make_unique<KeyMap>();
+    map->insert(kRun, 10);
+    map->insert(kRun, 11);  // Closed, then the address named another key
+
+    EXPECT_EQ(map->find(kRun), 11u);
+    EXPECT_EQ(map->size(), 1u);
+}
+
+TEST(KeyMapTest, Insert_NullObjectOrPath_Ignored) {
+    auto map = std::make_unique<KeyMap>();
+    map->insert(0, 10);
+    map->insert(kRun, event::INVALID_STRING);
+
+    EXPECT_EQ(map->find(0), event::INVALID_STRING);
+    EXPECT_EQ(map->find(kRun), event::INVALID_STRING);
+    EXPECT_EQ(map->size(), 0u);
+}
+
+TEST(KeyMapTest, Erase_ForgetsObject) {
+    auto map = std::make_unique<KeyMap>();
+    map->insert(kRun, 10);
+    map->insert(kServices, 20);
+    map->erase(kRun);
+    map->erase(kRun);  // Close of an unknown object
+
+    EXPECT_EQ(map->find(kRun), event::INVALID_STRING);
+    EXPECT_EQ(map->find(kServices), 20u);
+    EXPECT_EQ(map->size(), 1u);
+}
+
+TEST(KeyMapTest, Full_EvictsButKeepsNewest) {
+    auto map = std::make_unique<KeyMap>();
+    constexpr std::size_t kKeys = KeyMap::kBuckets * KeyMap::kWays * 2;
+    for (std::size_t i = 0; i < kKeys; ++i) {
+        map->insert(0x1000 + i * 16, static_cast<event::StringId>(i + 1));
+    }
+
+    EXPECT_LE(map->size(), KeyMap::kBuckets * KeyMap::kWays);
+    const std::uint64_t last = 0x1000 + (kKeys - 1) * 16;
+    EXPECT_EQ(map->find(last), static_cast<event::StringId>(kKeys));
+}
+
+TEST(KeyMapTest, Clear_Empties) {
+    auto map = std::make_unique<KeyMap>();
+    map->insert(kRun, 10);
+    map->clear();
+
+    EXPECT_EQ(map->find(kRun), event::INVALID_STRING);
+    EXPECT_EQ(map->size(), 0u);
+}
+
+TEST(KeyMapTest, ConcurrentReaders_SeeInsertedPaths) {
+    auto map = std::make_unique<KeyMap>();
+    constexpr std::uint64_t kKeys = 4096;
+    std::atomic<bool> done{false};
+    std::atomic<std::uint64_t> wrong{0};
+
+    std::thread reader([&] {
+        while (!done.load(std::memory_order_acquire)) {
+            for (std::uint64_t k = 0; k < kKeys; ++k) {
+                const auto path = map->find(0x8000 + k * 16);
+                if (path != event::INVALID_STRING && path != k + 1) {
+                    wrong.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+    });
+    for (std::uint64_t k = 0; k < kKeys; ++k) {
+        map->insert(0x8000 + k * 16, static_cast<event::StringId>(k + 1));
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    EXPECT_EQ(wrong.load(), 0u);
+    EXPECT_EQ(map->find(0x8000), 1u);
+}
+
+}  // namespace
+}  // namespace exeray::etw
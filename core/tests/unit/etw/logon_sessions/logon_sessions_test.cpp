@@ -0,0 +1,154 @@
+/// @file logon_sessions_test.cpp
+/// @brief Tests for logon sessions and the attribution of Security events.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/consumer.hpp"
+#include "exeray/etw/logon_sessions.hpp"
+#include "exeray/etw/parser.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/string_pool.hpp"
+
+#include <cstdint>
+
+namespace exeray::etw {
+namespace {
+
+constexpr std::uint64_t kLogonId = 0x3A1F2C;
+constexpr event::StringId kAlice = 31;
+constexpr event::StringId kBob = 32;
+constexpr event::StringId kSource = 33;
+
+event::SecurityPayload security_payload() {
+    event::SecurityPayload payload{};
+    payload.subject_user = event::INVALID_STRING;
+    payload.target_user = event::INVALID_STRING;
+    payload.command_line = event::INVALID_STRING;
+    return payload;
+}
+
+TEST(LogonSessionsTest, Attribute_FillsUserAndTypeOfTheSession) {
+    LogonSessions sessions;
+    sessions.logon({kLogonId, kAlice, 10, kSource, 1000});
+
+    event::SecurityPayload create = security_payload();
+    EXPECT_TRUE(sessions.attribute(kLogonId, create));
+    EXPECT_EQ(create.target_user, kAlice);
+    EXPECT_EQ(create.logon_type, 10u);
+
+    // The event's own values win
+    event::SecurityPayload token = security_payload();
+    token.target_user = kBob;
+    EXPECT_TRUE(sessions.attribute(kLogonId, token));
+    EXPECT_EQ(token.target_user, kBob);
+
+    event::SecurityPayload unknown = security_payload();
+    EXPECT_FALSE(sessions.attribute(kLogonId + 1, unknown));
+    EXPECT_EQ(unknown.target_user, event::INVALID_STRING);
+
+    const auto session = sessions.find(kLogonId);
+    ASSERT_TRUE(session.has_value());
+    EXPECT_EQ(session->source, kSource);
+    EXPECT_EQ(session->start, 1000u);
+
+    const LogonStats stats = sessions.stats();
+    EXPECT_EQ(stats.logons, 1u);
+    EXPECT_EQ(stats.attributed, 2u);
+    EXPECT_EQ(stats.unattributed, 1u);
+    EXPECT_EQ(stats.tracked, 1u);
+}
+
+TEST(LogonSessionsTest, Attribute_LogoffClosesTheSession) {
+    LogonSessions sessions;
+    sessions.logon({kLogonId, kAlice, 2, event::INVALID_STRING, 1000});
+
+    event::SecurityPayload logoff = security_payload();
+    EXPECT_TRUE(sessions.attribute(kLogonId, logoff, true));
+    EXPECT_EQ(logoff.target_user, kAlice);
+    EXPECT_FALSE(sessions.find(kLogonId).has_value());
+    EXPECT_TRUE(sessions.sessions().empty());
+    EXPECT_EQ(sessions.stats().logoffs, 1u);
+
+    event::SecurityPayload after = security_payload();
+    EXPECT_FALSE(sessions.attribute(kLogonId, after));
+}
+
+TEST(LogonSessionsTest, Capacity_FixedTableEvictsTheOldestSessions) {
+    LogonConfig small;
+    small.capacity = LogonSessions::kShards * LogonSessions::kProbe;
+    LogonSessions sessions(small);
+
+    for (std::uint64_t id = 1; id <= 2000; ++id) {
+        sessions.logon({id, kAlice, 3, event::INVALID_STRING, id});
+    }
+    const LogonStats stats = sessions.stats();
+    EXPECT_LE(stats.tracked, small.capacity);
+    EXPECT_EQ(stats.evicted, 2000u - stats.tracked);
+    // The latest logon is always kept
+    EXPECT_TRUE(sessions.find(2000).has_value());
+
+    // Logoffs free entries for new sessions without evicting
+    for (const LogonSession& session : sessions.sessions()) {
+        event::SecurityPayload logoff = security_payload();
+        sessions.attribute(session.logon_id, logoff, true);
+    }
+    sessions.logon({5000, kBob, 3, event::INVALID_STRING, 5000});
+    EXPECT_EQ(sessions.stats().evicted, stats.evicted);
+    EXPECT_EQ(sessions.stats().tracked, 1u);
+
+    sessions.clear();
+    EXPECT_EQ(sessions.stats().tracked, 0u);
+    EXPECT_EQ(sessions.stats().logons, 0u);
+}
+
+class LogonConsumerTest : public ::testing::Test {
+protected:
+    Arena arena_{4 * 1024 * 1024};
+    event::StringPool strings_{arena_};
+    event::EventGraph graph_{arena_, strings_, 1024};
+    LogonSessions logons_;
+    ConsumerContext ctx_;
+
+    void SetUp() override {
+        ctx_.graph = &graph_;
+        ctx_.strings = &strings_;
+        ctx_.logons = &logons_;
+    }
+
+    void consume(event::SecurityOp op, event::StringId target_user, std::uint32_t logon_type,
+                 std::uint64_t timestamp) {
+        ParsedEvent parsed{};
+        parsed.valid = true;
+        parsed.category = event::Category::Security;
+        parsed.operation = static_cast<std::uint8_t>(op);
+        parsed.pid = 100;
+        parsed.timestamp = timestamp;
+        parsed.logon_id = kLogonId;
+        parsed.payload.category = event::Category::Security;
+        parsed.payload.security = security_payload();
+        parsed.payload.security.target_user = target_user;
+        parsed.payload.security.logon_type = logon_type;
+        consume_parsed(ctx_, parsed, 0, 0, 0);
+    }
+};
+
+TEST_F(LogonConsumerTest, ConsumeParsed_ProcessEventsCarryTheirSessionsUser) {
+    const event::StringId user = strings_.intern("CORP\\alice");
+    consume(event::SecurityOp::Logon, user, 10, 1000);
+    consume(event::SecurityOp::ProcessCreate, event::INVALID_STRING, 0, 2000);
+    consume(event::SecurityOp::Logoff, event::INVALID_STRING, 0, 3000);
+    consume(event::SecurityOp::ProcessTerminate, event::INVALID_STRING, 0, 4000);
+    flush_pending(ctx_);
+
+    ASSERT_EQ(graph_.count(), 4u);
+    EXPECT_EQ(graph_.get(2).payload().security.target_user, user);
+    EXPECT_EQ(graph_.get(2).payload().security.logon_type, 10u);
+    EXPECT_EQ(graph_.get(3).payload().security.target_user, user);
+    // After the logoff the session is gone
+    EXPECT_EQ(graph_.get(4).payload().security.target_user, event::INVALID_STRING);
+    EXPECT_EQ(logons_.stats().unattributed, 1u);
+}
+
+}  // namespace
+}  // namespace exeray::etw
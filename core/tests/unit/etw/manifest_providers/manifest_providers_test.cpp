@@ -0,0 +1,140 @@
+/// @file manifest_providers_test.cpp
+/// @brief Tests for runtime manifest provider registrations.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/manifest_providers.hpp"
+#include "exeray/event/string_pool.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace exeray::etw {
+namespace {
+
+constexpr const char* kTaskScheduler = "{DE7B24EA-73C8-4A09-985D-5BDADCFA9017}";
+
+ManifestProviderConfig task_scheduler() {
+    return {"TaskScheduler", kTaskScheduler,
+            {{"TaskName", ManifestSlot::Text},
+             {"Path", ManifestSlot::Detail, true},
+             {"ActionName", ManifestSlot::Detail, true},
+             {"ResultCode", ManifestSlot::Value},
+             {"EnginePID", ManifestSlot::Extra1}}};
+}
+
+class ManifestProvidersTest : public ::testing::Test {
+protected:
+    Arena arena_{1 << 16};
+    event::StringPool strings_{arena_};
+    ManifestProviders providers_;
+};
+
+TEST(ParseGuidTest, ReadsRegistryForm) {
+    const auto guid = parse_guid(kTaskScheduler);
+    ASSERT_TRUE(guid);
+    EXPECT_EQ(guid->Data1, 0xDE7B24EAu);
+    EXPECT_EQ(guid->Data2, 0x73C8u);
+    EXPECT_EQ(guid->Data3, 0x4A09u);
+    EXPECT_EQ(guid->Data4[0], 0x98u);
+    EXPECT_EQ(guid->Data4[2], 0x5Bu);
+    EXPECT_EQ(guid->Data4[7], 0x17u);
+
+    const auto bare = parse_guid("de7b24ea-73c8-4a09-985d-5bdadcfa9017");
+    ASSERT_TRUE(bare);
+    EXPECT_EQ(std::memcmp(&*bare, &*guid, sizeof(GUID)), 0);
+
+    EXPECT_FALSE(parse_guid(""));
+    EXPECT_FALSE(parse_guid("{DE7B24EA-73C8-4A09-985D-5BDADCFA9017"));
+    EXPECT_FALSE(parse_guid("DE7B24EA-73C8-4A09-985D-5BDADCFA901G"));
+    EXPECT_FALSE(parse_guid("DE7B24EA73C8-4A09-985D-5BDADCFA90170"));
+}
+
+TEST_F(ManifestProvidersTest, Add_RefusesTakenAndMalformed) {
+    std::string error;
+    ASSERT_EQ(providers_.add(task_scheduler(), &error), std::uint16_t{0}) << error;
+    EXPECT_EQ(providers_.size(), 1u);
+    EXPECT_TRUE(providers_.guid("TaskScheduler"));
+    ASSERT_NE(providers_.find(*parse_guid(kTaskScheduler)), nullptr);
+    EXPECT_EQ(*providers_.find(*parse_guid(kTaskScheduler)), 0u);
+
+    EXPECT_FALSE(providers_.add(task_scheduler(), &error));  // Name taken
+    ManifestProviderConfig other = task_scheduler();
+    other.name = "Other";
+    EXPECT_FALSE(providers_.add(other, &error));  // GUID taken
+    EXPECT_NE(error.find("GUID"), std::string::npos);
+    other.guid = "not a guid";
+    EXPECT_FALSE(providers_.add(other, &error));
+    other.guid = "{0B9A1F47-7E49-4C65-A2BB-4A8E1D6F1C00}";
+    other.name = "DNS";  // Has a parser
+    EXPECT_FALSE(providers_.add(other, &error));
+    other.name = "Other";
+    other.fields.push_back({"", ManifestSlot::Text});
+    EXPECT_FALSE(providers_.add(other, &error));
+    other.fields.assign(ManifestProviders::kMaxFields + 1, {"X", ManifestSlot::Value});
+    EXPECT_FALSE(providers_.add(other, &error));
+    other.fields.clear();
+    EXPECT_EQ(providers_.add(other), std::uint16_t{1});  // No fields: IDs and PID only
+    EXPECT_EQ(providers_.size(), 2u);
+}
+
+TEST_F(ManifestProvidersTest, Project_FillsSlotsAndAlternatives) {
+    ASSERT_TRUE(providers_.add(task_scheduler()));
+    TdhParsedEvent tdh;
+    tdh.schema = 11;
+    tdh.event_id = 106;
+    tdh.event_version = 1;
+    tdh.push(L"TaskName", std::wstring_view(L"\\Updater"));
+    tdh.push(L"Path", std::wstring_view(L""));  // Empty: the next alternative fills Detail
+    tdh.push(L"ActionName", std::wstring_view(L"C:\\Users\\a\\AppData\\x.exe"));
+    tdh.push(L"ResultCode", std::uint32_t{5});
+    tdh.push(L"EnginePID", std::uint64_t{4321});
+    event::EventPayload payload{};
+    event::PendingExtension extension;
+
+    providers_.project(0, tdh, 900, &strings_, payload, extension);
+
+    ASSERT_EQ(payload.category, event::Category::Manifest);
+    const event::ManifestPayload& manifest = payload.manifest;
+    EXPECT_EQ(strings_.get(manifest.text), "\\Updater");
+    EXPECT_EQ(manifest.detail, strings_.intern_path("C:\\Users\\a\\AppData\\x.exe"));
+    EXPECT_EQ(manifest.value, 5u);
+    EXPECT_EQ(manifest.process_id, 900u);
+    EXPECT_EQ(manifest.provider, 0u);
+    EXPECT_EQ(manifest.event_id, 106u);
+    EXPECT_EQ(manifest.version, 1u);
+
+    ASSERT_EQ(extension.kind, event::ExtensionKind::ManifestValues);
+    event::ManifestValuesExtension values{};
+    ASSERT_TRUE((event::Extension{extension.kind, extension.view()}.read(values)));
+    EXPECT_EQ(values.values[0], 0u);
+    EXPECT_EQ(values.values[1], 4321u);
+}
+
+TEST_F(ManifestProvidersTest, Project_OrdinalsFollowEachSchema) {
+    ASSERT_TRUE(providers_.add(task_scheduler()));
+    TdhParsedEvent first;
+    first.schema = 21;
+    first.push(L"TaskName", std::wstring_view(L"\\A"));
+    event::EventPayload payload{};
+    event::PendingExtension extension;
+    providers_.project(0, first, 1, &strings_, payload, extension);
+    EXPECT_EQ(strings_.get(payload.manifest.text), "\\A");
+    EXPECT_EQ(payload.manifest.detail, event::INVALID_STRING);
+    EXPECT_EQ(extension.kind, event::ExtensionKind::None);  // No Extra slot filled
+
+    // Another event of the provider with the properties in another order
+    TdhParsedEvent second;
+    second.schema = 22;
+    second.push(L"ResultCode", std::uint32_t{7});
+    second.push(L"TaskName", std::wstring_view(L"\\B"));
+    payload = {};
+    providers_.project(0, second, 1, &strings_, payload, extension);
+    EXPECT_EQ(strings_.get(payload.manifest.text), "\\B");
+    EXPECT_EQ(payload.manifest.value, 7u);
+    EXPECT_EQ(extension.kind, event::ExtensionKind::None);
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,233 @@
+/// @file memory_capture_test.cpp
+/// @brief Tests for budgeted captures of RWX thread start regions on pool workers.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/image_verifier.hpp"
+#include "exeray/etw/memory_capture.hpp"
+#include "exeray/etw/memory_regions.hpp"
+#include "exeray/event/extensions.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/string_pool.hpp"
+#include "exeray/thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace exeray::etw {
+namespace {
+
+using event::Category;
+using event::EventId;
+using event::Status;
+
+constexpr std::uint32_t kPid = 100;
+constexpr std::uint32_t kRwx = 0x40;  // PAGE_EXECUTE_READWRITE
+constexpr auto kStart = static_cast<std::uint8_t>(event::ThreadOp::Start);
+
+/// @brief Reads byte (address & 0xFF) ^ pid everywhere; counts its calls.
+struct FakeMemory {
+    std::atomic<int> reads{0};
+    bool readable = true;
+
+    MemoryCapture::Reader reader() {
+        return [this](std::uint32_t pid, std::uint64_t address, std::span<std::uint8_t> out) {
+            reads.fetch_add(1);
+            if (!readable) {
+                return std::size_t{0};
+            }
+            for (std::size_t i = 0; i < out.size(); ++i) {
+                out[i] = static_cast<std::uint8_t>(((address + i) & 0xFF) ^ (pid & 0x0F));
+            }
+            return out.size();
+        };
+    }
+};
+
+class MemoryCaptureTest : public ::testing::Test {
+protected:
+    Arena arena_{16 * 1024 * 1024};
+    event::StringPool strings_{arena_};
+    event::ExtensionStore extensions_{arena_};
+    event::EventGraph graph_{arena_, strings_, 65536};
+    ThreadPool pool_{4};
+    FakeMemory memory_;
+
+    void SetUp() override { memory_regions().clear(); }
+    void TearDown() override { memory_regions().clear(); }
+
+    void start(MemoryCapture& capture) {
+        capture.start(graph_, extensions_,
+                      [this](std::function<void()> task) { pool_.submit(std::move(task)); });
+    }
+
+    /// @brief Push a thread start the way the parser and consumer do.
+    EventId thread_start(MemoryCapture& capture, std::uint32_t pid, std::uint64_t address,
+                         std::uint8_t operation = kStart) {
+        event::EventPayload payload{};
+        payload.category = Category::Thread;
+        payload.thread.process_id = pid;
+        payload.thread.start_address = address;
+        if (const auto region = memory_regions().find(pid, address)) {
+            payload.thread.start_region = region->flags;
+        }
+        capture.attach(operation, payload);
+        return graph_.push(Category::Thread, operation, Status::Suspicious, event::INVALID_EVENT,
+                           pid, payload);
+    }
+
+    event::MemoryCaptureExtension capture_of(EventId id) {
+        const event::Extension extension = extensions_.get(graph_.get(id).payload().extension);
+        EXPECT_EQ(extension.kind, event::ExtensionKind::MemoryCapture);
+        event::MemoryCaptureExtension record{};
+        EXPECT_TRUE(extension.read(record));
+        return record;
+    }
+};
+
+MemoryCaptureConfig config() {
+    MemoryCaptureConfig config;
+    config.enabled = true;
+    config.workers = 2;
+    return config;
+}
+
+std::array<std::uint8_t, 32> digest_of(const event::MemoryCaptureExtension& record) {
+    std::array<std::uint8_t, 32> digest{};
+    std::memcpy(digest.data(), record.sha256, digest.size());
+    return digest;
+}
+
+TEST_F(MemoryCaptureTest, EveryThreadStartInTheRegionGetsItsCapture) {
+    memory_regions().allocate(kPid, 0x10000, 0x2000, kPid, kRwx, 1);
+    MemoryCapture capture(config(), memory_.reader());
+    start(capture);
+
+    std::vector<EventId> starts;
+    for (int i = 0; i < 50; ++i) {
+        starts.push_back(thread_start(capture, kPid, 0x10000 + static_cast<std::uint64_t>(i)));
+    }
+    capture.stop();
+
+    const event::MemoryCaptureExtension first = capture_of(starts.front());
+    EXPECT_EQ(first.base, 0x10000u);
+    EXPECT_EQ(first.size, 0x2000u);
+    const event::ExtensionId shared = graph_.get(starts.front()).payload().extension;
+    for (const EventId id : starts) {
+        EXPECT_EQ(graph_.get(id).payload().extension, shared);
+    }
+    EXPECT_EQ(memory_.reads.load(), 1);
+
+    const auto stored = capture.capture(digest_of(first));
+    ASSERT_TRUE(stored.has_value());
+    EXPECT_EQ(stored->bytes.size(), 0x2000u);
+    EXPECT_EQ(stored->pid, kPid);
+    EXPECT_EQ(digest_of(first), sha256(stored->bytes));
+
+    const MemoryCaptureStats stats = capture.stats();
+    EXPECT_EQ(stats.requested, 1u);
+    EXPECT_EQ(stats.captured, 1u);
+    EXPECT_EQ(stats.stored, 0x2000u);
+    EXPECT_EQ(stats.attached + stats.backfilled, 50u);
+}
+
+TEST_F(MemoryCaptureTest, OnlyThreadStartsInRwxRegionsAreCaptured) {
+    constexpr std::uint32_t kExecuteRead = 0x20;  // PAGE_EXECUTE_READ
+    memory_regions().allocate(kPid, 0x10000, 0x1000, kPid, kExecuteRead, 1);
+    memory_regions().allocate(kPid, 0x20000, 0x1000, kPid, kRwx, 1);
+    MemoryCapture capture(config(), memory_.reader());
+    start(capture);
+    const EventId rx = thread_start(capture, kPid, 0x10010);
+    const EventId untracked = thread_start(capture, kPid, 0x90000);
+    const EventId rundown =
+        thread_start(capture, kPid, 0x20010, static_cast<std::uint8_t>(event::ThreadOp::DCStart));
+    capture.stop();
+
+    EXPECT_EQ(graph_.get(rx).payload().extension, event::NO_EXTENSION);
+    EXPECT_EQ(graph_.get(untracked).payload().extension, event::NO_EXTENSION);
+    EXPECT_EQ(graph_.get(rundown).payload().extension, event::NO_EXTENSION);
+    EXPECT_EQ(capture.stats().requested, 0u);
+    EXPECT_EQ(memory_.reads.load(), 0);
+}
+
+TEST_F(MemoryCaptureTest, SameBytesAreStoredOnce) {
+    // Same fake bytes: same low address bits and the same low PID bits
+    memory_regions().allocate(kPid, 0x10000, 0x100, kPid, kRwx, 1);
+    memory_regions().allocate(kPid + 16, 0x30000, 0x100, kPid, kRwx, 1);
+    MemoryCapture capture(config(), memory_.reader());
+    start(capture);
+    const EventId a = thread_start(capture, kPid, 0x10000);
+    const EventId b = thread_start(capture, kPid + 16, 0x30000);
+    capture.stop();
+
+    EXPECT_EQ(digest_of(capture_of(a)), digest_of(capture_of(b)));
+    EXPECT_NE(graph_.get(a).payload().extension, graph_.get(b).payload().extension);
+    const MemoryCaptureStats stats = capture.stats();
+    EXPECT_EQ(stats.captured, 2u);
+    EXPECT_EQ(stats.duplicates, 1u);
+    EXPECT_EQ(stats.stored, 0x100u);
+    EXPECT_EQ(capture.captures().size(), 1u);
+}
+
+TEST_F(MemoryCaptureTest, StoreKeepsTheNewestWithinItsCap) {
+    MemoryCaptureConfig small = config();
+    small.store_bytes = 0x300;
+    memory_regions().allocate(kPid, 0x10000, 0x200, kPid, kRwx, 1);
+    memory_regions().allocate(kPid, 0x10201, 0x200, kPid, kRwx, 1);
+    MemoryCapture capture(small, memory_.reader());
+    start(capture);
+    thread_start(capture, kPid, 0x10000);
+    capture.stop();
+    start(capture);
+    thread_start(capture, kPid, 0x10201);
+    capture.stop();
+
+    const auto captures = capture.captures();
+    ASSERT_EQ(captures.size(), 1u);
+    EXPECT_EQ(captures[0].base, 0x10201u);
+    EXPECT_EQ(capture.stats().evicted, 1u);
+    EXPECT_EQ(capture.stats().stored, 0x200u);
+}
+
+TEST_F(MemoryCaptureTest, ReadsBeyondTheBudgetAreThrottled) {
+    MemoryCaptureConfig slow = config();
+    slow.bytes_per_second = 1;
+    slow.max_region = 0x1000;
+    memory_regions().allocate(kPid, 0x10000, 0x1000, kPid, kRwx, 1);
+    memory_regions().allocate(kPid, 0x20000, 0x1000, kPid, kRwx, 1);
+    MemoryCapture capture(slow, memory_.reader());
+    start(capture);
+    const EventId first = thread_start(capture, kPid, 0x10000);
+    const EventId second = thread_start(capture, kPid, 0x20000);
+    capture.stop();
+
+    // The bucket holds one region's worth and refills a byte a second
+    const int read = (graph_.get(first).payload().extension != event::NO_EXTENSION ? 1 : 0) +
+                     (graph_.get(second).payload().extension != event::NO_EXTENSION ? 1 : 0);
+    EXPECT_EQ(read, 1);
+    EXPECT_EQ(capture.stats().throttled, 1u);
+    EXPECT_EQ(memory_.reads.load(), 1);
+}
+
+TEST_F(MemoryCaptureTest, UnreadableRegionsGetAnEmptyRecord) {
+    memory_.readable = false;
+    memory_regions().allocate(kPid, 0x10000, 0x1000, kPid, kRwx, 1);
+    MemoryCapture capture(config(), memory_.reader());
+    start(capture);
+    const EventId id = thread_start(capture, kPid, 0x10000);
+    capture.stop();
+
+    EXPECT_EQ(capture_of(id).size, 0u);
+    EXPECT_EQ(capture.stats().unreadable, 1u);
+    EXPECT_TRUE(capture.captures().empty());
+}
+
+}  // namespace
+}  // namespace exeray::etw
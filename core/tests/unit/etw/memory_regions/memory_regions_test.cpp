@@ -0,0 +1,104 @@
+/// @file memory_regions_test.cpp
+/// @brief Tests for the per-process executable allocation tracker.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/memory_regions.hpp"
+
+#include <cstdint>
+
+namespace exeray::etw {
+namespace {
+
+constexpr std::uint32_t kReadWrite = 0x04;         // PAGE_READWRITE
+constexpr std::uint32_t kExecuteRead = 0x20;       // PAGE_EXECUTE_READ
+constexpr std::uint32_t kExecuteReadWrite = 0x40;  // PAGE_EXECUTE_READWRITE
+
+constexpr std::uint32_t kVictim = 1000;
+constexpr std::uint32_t kInjector = 2000;
+
+TEST(MemoryRegionsTest, Find_ReturnsContainingAllocation) {
+    MemoryRegionTracker tracker;
+    tracker.allocate(kVictim, 0x10000, 0x1000, kInjector, kExecuteReadWrite, 5);
+    tracker.allocate(kVictim, 0x30000, 0x2000, kVictim, kExecuteRead, 6);
+
+    const auto region = tracker.find(kVictim, 0x10800);
+    ASSERT_TRUE(region.has_value());
+    EXPECT_EQ(region->base, 0x10000u);
+    EXPECT_EQ(region->allocator_pid, kInjector);
+    EXPECT_EQ(region->allocated, 5u);
+    EXPECT_EQ(region->flags, kRegionExecutable | kRegionWritable | kRegionRemote);
+
+    EXPECT_EQ(tracker.find(kVictim, 0x31FFF)->flags, kRegionExecutable);
+    EXPECT_FALSE(tracker.find(kVictim, 0x11000).has_value());  // One past the end
+    EXPECT_FALSE(tracker.find(kVictim, 0xFFFF).has_value());
+    EXPECT_FALSE(tracker.find(kInjector, 0x10800).has_value());  // Other process
+}
+
+TEST(MemoryRegionsTest, Allocate_IgnoresNonExecutableMemory) {
+    MemoryRegionTracker tracker;
+    tracker.allocate(kVictim, 0x10000, 0x1000, kVictim, kReadWrite, 1);
+    tracker.allocate(kVictim, 0x20000, 0, kVictim, kExecuteRead, 1);
+    EXPECT_EQ(tracker.size(), 0u);
+    EXPECT_FALSE(MemoryRegionTracker::tracked(kReadWrite));
+    EXPECT_TRUE(MemoryRegionTracker::tracked(kExecuteRead));
+}
+
+TEST(MemoryRegionsTest, Free_TrimsSplitsAndReleases) {
+    MemoryRegionTracker tracker;
+    tracker.allocate(kVictim, 0x10000, 0x4000, kVictim, kExecuteRead, 1);
+
+    tracker.free(kVictim, 0x11000, 0x1000);  // Hole in the middle
+    EXPECT_EQ(tracker.size(), 2u);
+    EXPECT_TRUE(tracker.find(kVictim, 0x10FFF).has_value());
+    EXPECT_FALSE(tracker.find(kVictim, 0x11000).has_value());
+    EXPECT_EQ(tracker.find(kVictim, 0x12000)->base, 0x12000u);
+
+    tracker.free(kVictim, 0x13800, 0x1000);  // Tail
+    EXPECT_EQ(tracker.find(kVictim, 0x12000)->size, 0x1800u);
+
+    tracker.free(kVictim, 0x12000, 0);       // Release the whole allocation
+    EXPECT_FALSE(tracker.find(kVictim, 0x12000).has_value());
+    tracker.free(kVictim, 0x10000, 0);
+    EXPECT_EQ(tracker.size(), 0u);
+}
+
+TEST(MemoryRegionsTest, Allocate_ReplacesOverlappedRegions) {
+    MemoryRegionTracker tracker;
+    tracker.allocate(kVictim, 0x10000, 0x3000, kVictim, kExecuteRead, 1);
+    tracker.allocate(kVictim, 0x11000, 0x1000, kInjector, kExecuteReadWrite, 2);
+
+    EXPECT_EQ(tracker.size(), 3u);
+    EXPECT_EQ(tracker.find(kVictim, 0x11000)->allocator_pid, kInjector);
+    EXPECT_EQ(tracker.find(kVictim, 0x10000)->allocator_pid, kVictim);
+    EXPECT_EQ(tracker.find(kVictim, 0x12000)->allocator_pid, kVictim);
+}
+
+TEST(MemoryRegionsTest, Bounded_EvictsOldestAndForgets) {
+    MemoryRegionTracker tracker;
+    for (std::uint64_t i = 0; i < MemoryRegionTracker::kMaxRegions + 10; ++i) {
+        tracker.allocate(kVictim, 0x100000 + i * 0x1000, 0x1000, kVictim, kExecuteRead, i);
+    }
+    EXPECT_EQ(tracker.size(), MemoryRegionTracker::kMaxRegions);
+    EXPECT_FALSE(tracker.find(kVictim, 0x100000).has_value());  // Oldest evicted
+    EXPECT_TRUE(tracker.find(kVictim, 0x100000 + (MemoryRegionTracker::kMaxRegions + 9) * 0x1000)
+                    .has_value());
+
+    tracker.forget(kVictim);
+    EXPECT_EQ(tracker.size(), 0u);
+
+    // Processes of one shard beyond the limit push out the least recently active
+    const std::uint32_t step = 4 * MemoryRegionTracker::kShards;
+    for (std::uint32_t i = 0; i <= MemoryRegionTracker::kMaxProcesses; ++i) {
+        tracker.allocate(4 + i * step, 0x10000, 0x1000, 4 + i * step, kExecuteRead, i);
+    }
+    EXPECT_EQ(tracker.size(), MemoryRegionTracker::kMaxProcesses);
+    EXPECT_FALSE(tracker.find(4, 0x10000).has_value());
+    EXPECT_TRUE(tracker.find(4 + step, 0x10000).has_value());
+
+    tracker.clear();
+    EXPECT_EQ(tracker.size(), 0u);
+}
+
+}  // namespace
+}  // namespace exeray::etw
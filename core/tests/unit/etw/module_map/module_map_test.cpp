@@ -0,0 +1,183 @@
+/// @file module_map_test.cpp
+/// @brief Tests for the per-process loaded module map.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/module_map.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace exeray::etw {
+namespace {
+
+constexpr std::uint32_t kApp = 1000;
+constexpr std::uint32_t kOther = 2000;
+
+TEST(ModuleMapTest, Find_ReturnsContainingModule) {
+    auto map = std::make_unique<ModuleMap>();
+    map->load(kApp, 0x7FF600000000, 0x20000, 11);
+    map->load(kApp, 0x7FFE00000000, 0x1000, 12);
+
+    const auto module = map->find(kApp, 0x7FF600010000);
+    ASSERT_TRUE(module.has_value());
+    EXPECT_EQ(module->base, 0x7FF600000000u);
+    EXPECT_EQ(module->size, 0x20000u);
+    EXPECT_EQ(module->path, 11u);
+
+    EXPECT_EQ(map->find(kApp, 0x7FFE00000FFF)->path, 12u);
+    EXPECT_FALSE(map->find(kApp, 0x7FF600020000).has_value());  // One past the end
+    EXPECT_FALSE(map->find(kApp, 0x1000).has_value());
+    EXPECT_FALSE(map->find(kOther, 0x7FF600010000).has_value());
+    EXPECT_EQ(map->count(kApp), 2u);
+    EXPECT_EQ(map->count(kOther), 0u);
+}
+
+TEST(ModuleMapTest, Modules_SortedByBase) {
+    auto map = std::make_unique<ModuleMap>();
+    for (const std::uint64_t base : {0x50000u, 0x10000u, 0x30000u}) {
+        map->load(kApp, base, 0x1000, static_cast<event::StringId>(base >> 16));
+    }
+    const auto modules = map->modules(kApp);
+    ASSERT_EQ(modules.size(), 3u);
+    EXPECT_EQ(modules[0].base, 0x10000u);
+    EXPECT_EQ(modules[1].base, 0x30000u);
+    EXPECT_EQ(modules[2].base, 0x50000u);
+    EXPECT_TRUE(map->modules(kOther).empty());
+}
+
+TEST(ModuleMapTest, Load_ReplacesOverlappedModules) {
+    auto map = std::make_unique<ModuleMap>();
+    map->load(kApp, 0x10000, 0x4000, 1);
+    map->load(kApp, 0x12000, 0x4000, 2);  // Unload of the first was lost
+
+    EXPECT_EQ(map->count(kApp), 1u);
+    EXPECT_FALSE(map->find(kApp, 0x10000).has_value());
+    EXPECT_EQ(map->find(kApp, 0x15000)->path, 2u);
+}
+
+TEST(ModuleMapTest, UnloadAndForget) {
+    auto map = std::make_unique<ModuleMap>();
+    map->load(kApp, 0x10000, 0x1000, 1);
+    map->load(kApp, 0x20000, 0x1000, 2);
+    map->load(kOther, 0x10000, 0x1000, 3);
+
+    map->unload(kApp, 0x10800);  // Not a base: ignored
+    EXPECT_EQ(map->count(kApp), 2u);
+    map->unload(kApp, 0x10000);
+    EXPECT_FALSE(map->find(kApp, 0x10000).has_value());
+    EXPECT_TRUE(map->find(kApp, 0x20000).has_value());
+
+    map->forget(kApp);
+    EXPECT_EQ(map->count(kApp), 0u);
+    EXPECT_FALSE(map->find(kApp, 0x20000).has_value());
+    EXPECT_EQ(map->find(kOther, 0x10000)->path, 3u);
+    EXPECT_EQ(map->size(), 1u);
+
+    // A new process reusing the pid starts empty
+    map->load(kApp, 0x40000, 0x1000, 4);
+    EXPECT_EQ(map->count(kApp), 1u);
+    EXPECT_EQ(map->find(kApp, 0x40000)->path, 4u);
+
+    map->clear();
+    EXPECT_EQ(map->size(), 0u);
+}
+
+TEST(ModuleMapTest, Bounded_DropsBeyondLimits) {
+    auto map = std::make_unique<ModuleMap>();
+    for (std::size_t i = 0; i < ModuleMap::kMaxModules + 10; ++i) {
+        map->load(kApp, 0x100000 + i * 0x1000, 0x1000, 1);
+    }
+    EXPECT_EQ(map->count(kApp), ModuleMap::kMaxModules);
+
+    // Forgotten slots are reused, so a churn of processes never fills the map
+    for (std::uint32_t pid = 4; pid < 4 * (ModuleMap::kMaxProcesses + 100); pid += 4) {
+        if (pid == kApp) {
+            continue;
+        }
+        map->load(pid, 0x10000, 0x1000, 1);
+        map->forget(pid);
+    }
+    map->load(kOther + 4, 0x10000, 0x1000, 5);
+    EXPECT_EQ(map->find(kOther + 4, 0x10000)->path, 5u);
+}
+
+TEST(ModuleMapTest, Stage_VisibleAfterFlush) {
+    auto map = std::make_unique<ModuleMap>();
+    for (std::uint64_t i = 0; i < 100; ++i) {
+        map->stage(kApp, 0x10000000 + (99 - i) * 0x10000, 0x10000, 1);  // Any order
+        map->stage(kOther, 0x20000000 + i * 0x10000, 0x10000, 2);
+    }
+    EXPECT_EQ(map->count(kApp), 0u);
+
+    map->flush_staged();
+    EXPECT_EQ(map->count(kApp), 100u);
+    EXPECT_EQ(map->count(kOther), 100u);
+    const auto modules = map->modules(kApp);
+    EXPECT_TRUE(std::is_sorted(modules.begin(), modules.end(),
+                               [](const ModuleInfo& a, const ModuleInfo& b) {
+                                   return a.base < b.base;
+                               }));
+}
+
+TEST(ModuleMapTest, Stage_FlushedBeforeOtherWrites) {
+    auto map = std::make_unique<ModuleMap>();
+    map->stage(kApp, 0x10000, 0x1000, 1);
+    map->stage(kApp, 0x10000, 0x2000, 2);  // Later rundown entry wins
+    map->unload(kApp, 0x10000);
+    EXPECT_EQ(map->count(kApp), 0u);
+
+    map->stage(kApp, 0x30000, 0x1000, 3);
+    map->load(kApp, 0x40000, 0x1000, 4);
+    EXPECT_EQ(map->count(kApp), 2u);
+
+    map->stage(kOther, 0x30000, 0x1000, 3);
+    map->forget(kOther);
+    EXPECT_EQ(map->count(kOther), 0u);
+}
+
+TEST(ModuleMapTest, Stage_AnotherMapFlushesFirst) {
+    auto first = std::make_unique<ModuleMap>();
+    auto second = std::make_unique<ModuleMap>();
+    first->stage(kApp, 0x10000, 0x1000, 1);
+    second->stage(kApp, 0x20000, 0x1000, 2);
+
+    EXPECT_EQ(first->count(kApp), 1u);
+    second->flush_staged();
+    EXPECT_EQ(second->count(kApp), 1u);
+}
+
+TEST(ModuleMapTest, Find_ConsistentWhileWriterGrowsTable) {
+    auto map = std::make_unique<ModuleMap>();
+    map->load(kApp, 0x1000, 0x1000, 7);
+
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (std::uint64_t i = 1; i < 2000; ++i) {
+            map->load(kApp, 0x100000 + i * 0x1000, 0x1000, 8);
+            if (i % 3 == 0) {
+                map->unload(kApp, 0x100000 + (i - 1) * 0x1000);
+            }
+        }
+        done.store(true);
+    });
+
+    // The first module is never touched, so every lookup must find it intact
+    std::size_t reads = 0;
+    while (!done.load() || reads < 1000) {
+        const auto module = map->find(kApp, 0x1800);
+        ASSERT_TRUE(module.has_value());
+        ASSERT_EQ(module->base, 0x1000u);
+        ASSERT_EQ(module->size, 0x1000u);
+        ASSERT_EQ(module->path, 7u);
+        ++reads;
+    }
+    writer.join();
+    EXPECT_EQ(map->modules(kApp).front().path, 7u);
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -47,7 +47,7 @@ TEST_F(NetworkParserTest, ParseTcpConnect_IPv4_ExtractsPorts) {
     EXPECT_EQ(result.payload.network.remote_port, remote_port);
 }
 
-TEST_F(NetworkParserTest, ParseTcpConnect_IPv6_SkipsCorrectly) {
+TEST_F(NetworkParserTest, ParseTcpConnect_IPv6_InternsAddresses) {
     uint8_t local_addr[16] = {0};
     uint8_t remote_addr[16] = {0};
     // ::1 (loopback)
@@ -67,12 +67,13 @@ TEST_F(NetworkParserTest, ParseTcpConnect_IPv6_SkipsCorrectly) {
 
     auto result = parse_network_event(&record, strings_.get());
 
-    // IPv6 parsing: addresses remain 0 since only IPv4 is fully extracted
+    // IPv6 addresses do not fit the payload: it holds their interned text
     EXPECT_TRUE(result.valid);
     EXPECT_EQ(result.payload.network.protocol, PROTO_TCP);
-    // IPv6 addresses are not stored in local_addr/remote_addr (they are 32-bit)
-    EXPECT_EQ(result.payload.network.local_addr, 0u);
-    EXPECT_EQ(result.payload.network.remote_addr, 0u);
+    EXPECT_EQ(result.payload.network.family, event::kAddressIPv6);
+    EXPECT_EQ(strings_->get(result.payload.network.local_addr), "::1");
+    EXPECT_EQ(strings_->get(result.payload.network.remote_addr), "2001:4860:4860::88");
+    EXPECT_EQ(result.payload.network.remote_port, 443u);
 }
 
 TEST_F(NetworkParserTest, ParseTcpConnect_SetsProtocolTcp) {
@@ -136,6 +137,37 @@ TEST_F(NetworkParserTest, ParseTcpTransfer_ZeroBytes_Valid) {
     EXPECT_EQ(result.payload.network.bytes, 0u);
 }
 
+TEST_F(NetworkParserTest, ParseTcpTransfer_IPv4_ExtractsTuple) {
+    auto data = build_tcp_transfer_ipv4_data(1234, 1500, 0xC0A80001, 54321, 0x08080808, 443);
+
+    EVENT_RECORD record = make_record(ids::network::TCP_RECEIVE);
+    record.UserData = data.data();
+    record.UserDataLength = static_cast<USHORT>(data.size());
+
+    auto result = parse_network_event(&record, strings_.get());
+
+    EXPECT_TRUE(result.valid);
+    EXPECT_EQ(result.payload.network.bytes, 1500u);
+    EXPECT_EQ(result.payload.network.local_addr, 0xC0A80001u);
+    EXPECT_EQ(result.payload.network.remote_addr, 0x08080808u);
+    EXPECT_EQ(result.payload.network.local_port, 54321u);
+    EXPECT_EQ(result.payload.network.remote_port, 443u);
+}
+
+TEST_F(NetworkParserTest, ParseTcpDisconnect_SetsClose) {
+    auto data = build_tcp_transfer_ipv4_data(1234, 0, 0xC0A80001, 54321, 0x08080808, 443);
+
+    EVENT_RECORD record = make_record(ids::network::TCP_DISCONNECT);
+    record.UserData = data.data();
+    record.UserDataLength = static_cast<USHORT>(data.size());
+
+    auto result = parse_network_event(&record, strings_.get());
+
+    EXPECT_TRUE(result.valid);
+    EXPECT_EQ(result.operation, static_cast<uint8_t>(event::NetworkOp::Close));
+    EXPECT_EQ(result.payload.network.remote_port, 443u);
+}
+
 // =============================================================================
 // 3. UDP Operations
 // =============================================================================
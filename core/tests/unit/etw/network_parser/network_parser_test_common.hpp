@@ -129,6 +129,22 @@ protected:
         return buffer;
     }
 
+    /// Build TCP transfer data with the IPv4 tuple (layouts::TcpTransfer).
+    std::vector<uint8_t> build_tcp_transfer_ipv4_data(uint32_t pid, uint32_t bytes,
+                                                      uint32_t local_addr, uint16_t local_port,
+                                                      uint32_t remote_addr, uint16_t remote_port) {
+        std::vector<uint8_t> buffer(20, 0);
+
+        std::memcpy(buffer.data(), &pid, sizeof(uint32_t));
+        std::memcpy(buffer.data() + 4, &bytes, sizeof(uint32_t));
+        std::memcpy(buffer.data() + 8, &remote_addr, sizeof(uint32_t));
+        std::memcpy(buffer.data() + 12, &local_addr, sizeof(uint32_t));
+        std::memcpy(buffer.data() + 16, &remote_port, sizeof(uint16_t));
+        std::memcpy(buffer.data() + 18, &local_port, sizeof(uint16_t));
+
+        return buffer;
+    }
+
     /// Build minimal UDP event data (empty, just valid record).
     std::vector<uint8_t> build_udp_event_data() {
         return std::vector<uint8_t>(8, 0);
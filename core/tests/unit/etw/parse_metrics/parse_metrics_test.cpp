@@ -0,0 +1,143 @@
+/// @file parse_metrics_test.cpp
+/// @brief Tests for per-provider and per-event-ID parse metrics.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/parse_metrics.hpp"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace exeray::etw {
+namespace {
+
+/// Resets the process-wide counters around each test.
+class ParseMetricsTest : public ::testing::Test {
+protected:
+    void SetUp() override { metrics_.reset(); }
+    void TearDown() override { metrics_.reset(); }
+
+    ParseMetrics& metrics_ = ParseMetrics::global();
+};
+
+const EventMetrics* find(const ParseMetricsSnapshot& snapshot, MetricProvider provider,
+                         std::uint16_t event_id) {
+    for (const EventMetrics& event : snapshot.events) {
+        if (event.provider == provider && event.event_id == event_id) {
+            return &event;
+        }
+    }
+    return nullptr;
+}
+
+TEST_F(ParseMetricsTest, BucketOf_Log2) {
+    EXPECT_EQ(ParseMetrics::bucket_of(0), 0U);
+    EXPECT_EQ(ParseMetrics::bucket_of(1), 1U);
+    EXPECT_EQ(ParseMetrics::bucket_of(3), 2U);
+    EXPECT_EQ(ParseMetrics::bucket_of(4), 3U);
+    EXPECT_EQ(ParseMetrics::bucket_of(UINT64_MAX), ProviderMetrics::kCycleBuckets - 1);
+}
+
+TEST_F(ParseMetricsTest, Record_CountsPerProviderAndEvent) {
+    metrics_.record(MetricProvider::File, 12, true, 100);
+    metrics_.record(MetricProvider::File, 12, false, 50);
+    metrics_.record(MetricProvider::File, 15, true, 10);
+    metrics_.record(MetricProvider::Process, 1, true, 1000);
+
+    const ParseMetricsSnapshot snapshot = metrics_.snapshot();
+    const ProviderMetrics& file = snapshot.of(MetricProvider::File);
+    EXPECT_EQ(file.events, 3U);
+    EXPECT_EQ(file.failures, 1U);
+    EXPECT_EQ(file.cycles, 160U);
+    EXPECT_EQ(file.histogram[ParseMetrics::bucket_of(100)], 1U);
+    EXPECT_EQ(snapshot.of(MetricProvider::Process).events, 1U);
+    EXPECT_EQ(snapshot.of(MetricProvider::Registry).events, 0U);
+
+    const EventMetrics* create = find(snapshot, MetricProvider::File, 12);
+    ASSERT_NE(create, nullptr);
+    EXPECT_EQ(create->events, 2U);
+    EXPECT_EQ(create->failures, 1U);
+    EXPECT_EQ(create->cycles, 150U);
+    EXPECT_EQ(snapshot.untracked, 0U);
+}
+
+TEST_F(ParseMetricsTest, Snapshot_EventsMostExpensiveFirst) {
+    metrics_.record(MetricProvider::File, 12, true, 10);
+    metrics_.record(MetricProvider::Process, 1, true, 1000);
+    metrics_.record(MetricProvider::Registry, 5, true, 100);
+
+    const ParseMetricsSnapshot snapshot = metrics_.snapshot();
+    ASSERT_EQ(snapshot.events.size(), 3U);
+    EXPECT_EQ(snapshot.events[0].provider, MetricProvider::Process);
+    EXPECT_EQ(snapshot.events[1].provider, MetricProvider::Registry);
+    EXPECT_EQ(snapshot.events[2].provider, MetricProvider::File);
+}
+
+TEST_F(ParseMetricsTest, Record_TableFull_CountsUntracked) {
+    const std::size_t ids = ParseMetrics::kEventSlots + 64;
+    for (std::size_t id = 0; id < ids; ++id) {
+        metrics_.record(MetricProvider::Wmi, static_cast<std::uint16_t>(id), true, 1);
+    }
+
+    const ParseMetricsSnapshot snapshot = metrics_.snapshot();
+    EXPECT_EQ(snapshot.of(MetricProvider::Wmi).events, ids);
+    EXPECT_GT(snapshot.untracked, 0U);
+    EXPECT_EQ(snapshot.events.size() + snapshot.untracked, ids);
+}
+
+TEST_F(ParseMetricsTest, Record_InvalidProvider_Ignored) {
+    metrics_.record(MetricProvider::Count, 1, true, 1);
+
+    const ParseMetricsSnapshot snapshot = metrics_.snapshot();
+    EXPECT_TRUE(snapshot.events.empty());
+}
+
+TEST_F(ParseMetricsTest, Reset_ClearsAll) {
+    metrics_.record(MetricProvider::Dns, 3008, false, 20);
+    metrics_.reset();
+
+    const ParseMetricsSnapshot snapshot = metrics_.snapshot();
+    EXPECT_EQ(snapshot.of(MetricProvider::Dns).events, 0U);
+    EXPECT_EQ(snapshot.of(MetricProvider::Dns).failures, 0U);
+    EXPECT_TRUE(snapshot.events.empty());
+}
+
+TEST_F(ParseMetricsTest, Record_ConcurrentThreads_Summed) {
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 10000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([this] {
+            for (int i = 0; i < kPerThread; ++i) {
+                metrics_.record(MetricProvider::Network, static_cast<std::uint16_t>(i % 4),
+                                i % 10 != 0, 2);
+            }
+        });
+    }
+    // Snapshots while recording see partial but consistent counts
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_LE(metrics_.snapshot().of(MetricProvider::Network).events,
+                  std::uint64_t{kThreads} * kPerThread);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const ParseMetricsSnapshot snapshot = metrics_.snapshot();
+    const ProviderMetrics& network = snapshot.of(MetricProvider::Network);
+    EXPECT_EQ(network.events, std::uint64_t{kThreads} * kPerThread);
+    EXPECT_EQ(network.failures, std::uint64_t{kThreads} * kPerThread / 10);
+    EXPECT_EQ(network.cycles, std::uint64_t{kThreads} * kPerThread * 2);
+    ASSERT_EQ(snapshot.events.size(), 4U);
+    EXPECT_EQ(snapshot.events[0].events, std::uint64_t{kThreads} * kPerThread / 4);
+}
+
+TEST(ParseMetricsNameTest, ProviderName) {
+    EXPECT_EQ(provider_name(MetricProvider::Process), "Process");
+    EXPECT_EQ(provider_name(MetricProvider::Amsi), "AMSI");
+    EXPECT_EQ(provider_name(MetricProvider::Unknown), "Unknown");
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,63 @@
+/// @file parser_allocations_test.cpp
+/// @brief Steady-state heap allocations of every ETW parser.
+///
+/// Each case of parser_cases_common.hpp is parsed directly and through
+/// dispatch_event(); after warmup neither may allocate. The report lists
+/// the worst offenders first.
+
+#include "alloc_tracking/alloc_tracking_test_common.hpp"
+
+#ifdef _WIN32
+
+#include "etw/parser_cases_common.hpp"
+
+#include <string>
+#include <vector>
+
+namespace exeray::etw::cases {
+namespace {
+
+template <typename Case>
+void measure_case(std::vector<test::AllocationSite>& sites, const std::string& name,
+                  ParseFn parse) {
+    const Case input;
+    bool valid = true;
+    sites.push_back(test::measure_allocations("Parse/" + name, [&] {
+        valid = parse(input.record(), input.pool()).valid && valid;
+    }));
+    sites.push_back(test::measure_allocations("Dispatch/" + name, [&] {
+        valid = dispatch_event(input.record(), input.pool()).valid && valid;
+    }));
+    EXPECT_TRUE(valid) << name;
+}
+
+TEST(ParserAllocationsTest, EveryParser_SteadyState_AllocationFree) {
+    if (!alloc::hooked()) {
+        GTEST_SKIP() << "Built without EXERAY_TRACK_ALLOCATIONS";
+    }
+    std::vector<test::AllocationSite> sites;
+    measure_case<ProcessStart>(sites, "ProcessStart", parse_process_event);
+    measure_case<FileCreate>(sites, "FileCreate", parse_file_event);
+    measure_case<FileRead>(sites, "FileRead", parse_file_event);
+    measure_case<TcpConnect>(sites, "TcpConnect", parse_network_event);
+    measure_case<RegistrySetValue>(sites, "RegistrySetValue", parse_registry_event);
+    measure_case<ImageLoad>(sites, "ImageLoad", parse_image_event);
+    measure_case<ThreadStart>(sites, "ThreadStart", parse_thread_event);
+    measure_case<MemoryAlloc>(sites, "MemoryAlloc", parse_memory_event);
+    measure_case<ScriptBlock>(sites, "ScriptBlock", parse_powershell_event);
+    measure_case<AmsiScan>(sites, "AmsiScan", parse_amsi_event);
+    measure_case<DnsQuery>(sites, "DnsQuery", parse_dns_event);
+
+    test::expect_allocation_free(sites);
+}
+
+}  // namespace
+}  // namespace exeray::etw::cases
+
+#else  // !_WIN32
+
+TEST(ParserAllocationsTest, SkippedOnNonWindows) {
+    GTEST_SKIP() << "ETW parser tests require Windows platform";
+}
+
+#endif  // _WIN32
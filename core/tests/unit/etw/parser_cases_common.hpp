@@ -0,0 +1,158 @@
+/// @file parser_cases_common.hpp
+/// @brief One typical record per ETW parser, built with the parser test fixtures.
+///
+/// Shared by the parser benchmarks (bench/parser_bench.cpp) and the
+/// zero-allocation tests, so both measure exactly the layouts the parser
+/// tests check.
+
+#pragma once
+
+#ifdef _WIN32
+
+#include "exeray/etw/event_ids.hpp"
+#include "exeray/etw/parser.hpp"
+#include "exeray/etw/providers/guids.hpp"
+
+#include "etw/amsi_parser/amsi_parser_test_common.hpp"
+#include "etw/dns_parser/dns_parser_test_common.hpp"
+#include "etw/file_parser/file_parser_test_common.hpp"
+#include "etw/image_parser/image_parser_test_common.hpp"
+#include "etw/memory_parser/memory_parser_test_common.hpp"
+#include "etw/network_parser/network_parser_test_common.hpp"
+#include "etw/powershell_parser/powershell_parser_test_common.hpp"
+#include "etw/process_parser/process_parser_test_common.hpp"
+#include "etw/registry_parser/registry_parser_test_common.hpp"
+#include "etw/thread_parser/thread_parser_test_common.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace exeray::etw::cases {
+
+using ParseFn = ParsedEvent (*)(const EVENT_RECORD*, event::StringPool*);
+
+/// @brief A test fixture used as a record builder: its pool, data and record.
+template <typename Fixture>
+class Input : public Fixture {
+public:
+    void TestBody() override {}
+
+    [[nodiscard]] const EVENT_RECORD* record() const noexcept { return &record_; }
+    [[nodiscard]] event::StringPool* pool() const noexcept { return this->strings_.get(); }
+
+protected:
+    /// @brief Point record_ at data_ and set the provider dispatch routes by.
+    void finish(const GUID& provider) {
+        record_.EventHeader.ProviderId = provider;
+        record_.UserData = data_.data();
+        record_.UserDataLength = static_cast<USHORT>(data_.size());
+    }
+
+    std::vector<uint8_t> data_;
+    EVENT_RECORD record_{};
+};
+
+struct ProcessStart : Input<ProcessParserTest> {
+    ProcessStart() {
+        SetUp();
+        data_ = build_process_start_data(4242, 1000, 5, "notepad.exe",
+                                         L"C:\\Windows\\System32\\notepad.exe C:\\notes.txt");
+        record_ = make_record(ids::process::START);
+        finish(providers::KERNEL_PROCESS);
+    }
+};
+
+struct FileCreate : Input<FileParserTest> {
+    FileCreate() {
+        SetUp();
+        data_ = build_file_create_data(L"\\Device\\HarddiskVolume3\\Windows\\System32\\kernel32.dll");
+        record_ = make_record(ids::file::CREATE);
+        finish(providers::KERNEL_FILE);
+    }
+};
+
+struct FileRead : Input<FileParserTest> {
+    FileRead() {
+        SetUp();
+        data_ = build_file_read_write_data(4096);
+        record_ = make_record(ids::file::READ);
+        finish(providers::KERNEL_FILE);
+    }
+};
+
+struct TcpConnect : Input<NetworkParserTest> {
+    TcpConnect() {
+        SetUp();
+        data_ = build_tcp_connect_ipv4_data(4242, 0x0A000001, 49152, 0x5DB8D822, 443);
+        record_ = make_record(ids::network::TCP_CONNECT);
+        finish(providers::KERNEL_NETWORK);
+    }
+};
+
+struct RegistrySetValue : Input<RegistryParserTest> {
+    RegistrySetValue() {
+        SetUp();
+        data_ = build_value_event_data(0, 1 /* REG_SZ */, 64);
+        record_ = make_record(ids::registry::SET_VALUE);
+        finish(providers::KERNEL_REGISTRY);
+    }
+};
+
+struct ImageLoad : Input<ImageParserTest> {
+    ImageLoad() {
+        SetUp();
+        data_ = build_image_load_data_64bit(0x00007FF812340000ULL, 0x1A0000, 4242,
+                                            L"C:\\Windows\\System32\\kernel32.dll");
+        record_ = make_record(ids::image::LOAD);
+        finish(providers::KERNEL_IMAGE);
+    }
+};
+
+struct ThreadStart : Input<ThreadParserTest> {
+    ThreadStart() {
+        SetUp();
+        data_ = build_thread_start_data(4242, 5150, 0x00007FF812345678ULL);
+        record_ = make_record(ids::thread::START, true, 4242);
+        finish(providers::KERNEL_THREAD);
+    }
+};
+
+struct MemoryAlloc : Input<MemoryParserTest> {
+    MemoryAlloc() {
+        SetUp();
+        data_ = build_memory_data_64bit(0x10000, 4096, 4242, PAGE_READWRITE_VAL);
+        record_ = make_record(ids::memory::VIRTUAL_ALLOC);
+        finish(providers::KERNEL_MEMORY);
+    }
+};
+
+struct ScriptBlock : Input<PowerShellParserTest> {
+    ScriptBlock() {
+        SetUp();
+        data_ = build_script_block_data(1, 1, L"Get-ChildItem -Path C:\\Users | Select-Object Name");
+        record_ = make_record(ids::powershell::SCRIPT_BLOCK_LOGGING);
+        finish(providers::POWERSHELL);
+    }
+};
+
+struct AmsiScan : Input<AmsiParserTest> {
+    AmsiScan() {
+        SetUp();
+        data_ = build_scan_buffer_data(0, L"PowerShell.exe", 256);
+        record_ = make_record(ids::amsi::SCAN_BUFFER);
+        finish(providers::AMSI);
+    }
+};
+
+struct DnsQuery : Input<DnsParserTest> {
+    DnsQuery() {
+        SetUp();
+        data_ = build_query_completed_data(L"example.com", dns_types::A, 0, L"93.184.216.34");
+        record_ = make_record(ids::dns::QUERY_COMPLETED);
+        finish(providers::DNS_CLIENT);
+    }
+};
+
+}  // namespace exeray::etw::cases
+
+#endif  // _WIN32
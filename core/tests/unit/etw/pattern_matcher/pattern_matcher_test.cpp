@@ -0,0 +1,71 @@
+/// @file pattern_matcher_test.cpp
+/// @brief Tests for the compile-time Aho-Corasick pattern matcher.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/pattern_matcher.hpp"
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace exeray::etw {
+namespace {
+
+constexpr auto kMatcher = make_pattern_matcher([] {
+    return std::array<std::string_view, 5>{"he", "she", "his", "hers", "-enc "};
+});
+
+constexpr PatternMask bit(std::size_t i) {
+    return PatternMask{1} << i;
+}
+
+TEST(PatternMatcherTest, Build_SharesPrefixes) {
+    // root, h, he, s, sh, she, hi, his, her, hers, -, -e, -en, -enc, "-enc "
+    EXPECT_EQ(kMatcher.state_count(), 15U);
+    EXPECT_EQ(kMatcher.pattern_count(), 5U);
+}
+
+TEST(PatternMatcherTest, Match_ReportsEveryPattern) {
+    // "ushers" holds she, he and hers, overlapping each other
+    EXPECT_EQ(kMatcher.match(std::string_view("ushers")), bit(0) | bit(1) | bit(3));
+    EXPECT_EQ(kMatcher.match(std::string_view("this")), bit(2));
+    EXPECT_EQ(kMatcher.match(std::string_view("xyz")), 0U);
+    EXPECT_EQ(kMatcher.match(std::string_view("")), 0U);
+}
+
+TEST(PatternMatcherTest, Match_CaseInsensitive) {
+    EXPECT_EQ(kMatcher.match(std::string_view("USHERS")), bit(0) | bit(1) | bit(3));
+    EXPECT_EQ(kMatcher.match(std::wstring_view(L"cmd.exe -ENC aQBlAHgA")), bit(4));
+}
+
+TEST(PatternMatcherTest, Match_FailureLinksAfterMismatch) {
+    // "hi" and "he" diverge after 'h'; "sh" must fall back to "h"
+    EXPECT_EQ(kMatcher.match(std::string_view("shis")), bit(2));
+    EXPECT_EQ(kMatcher.match(std::string_view("hhhhe")), bit(0));
+    EXPECT_EQ(kMatcher.match(std::string_view("h e")), 0U);
+}
+
+TEST(PatternMatcherTest, Match_SkipsNonAscii) {
+    EXPECT_EQ(kMatcher.match(std::wstring_view(L"hé中s")), 0U);
+    EXPECT_EQ(kMatcher.match(std::wstring_view(L"héis")), bit(2));
+    EXPECT_EQ(kMatcher.match(std::string_view("h\xc3\xa9is")), bit(2));
+}
+
+TEST(PatternMatcherTest, First_LowestIndex) {
+    EXPECT_EQ(kMatcher.first(bit(3) | bit(1)), 1U);
+    EXPECT_EQ(kMatcher.first(0), kMatcher.pattern_count());
+}
+
+TEST(PatternMatcherTest, Match_LongText) {
+    std::wstring text(64 * 1024, L'a');
+    EXPECT_EQ(kMatcher.match(std::wstring_view(text)), 0U);
+    text.replace(text.size() - 4, 4, L"HERS");
+    EXPECT_EQ(kMatcher.match(std::wstring_view(text)), bit(0) | bit(3));
+}
+
+static_assert(kMatcher.match(std::string_view("his")) == bit(2));
+
+}  // namespace
+}  // namespace exeray::etw
@@ -413,6 +413,58 @@ TEST_F(PowerShellParserTest, ParseScriptBlock_MultiPartScript_AllPartsLinked) {
     EXPECT_EQ(result.payload.script.sequence, message_number);
 }
 
+// =============================================================================
+// 7. Repeated Content
+// =============================================================================
+
+TEST_F(PowerShellParserTest, ParseScriptBlock_RepeatReusesFirstVerdictAndString) {
+    std::wstring script = L"iex (New-Object Net.WebClient).DownloadString($u)";
+    auto data = build_script_block_data(1, 1, script);
+
+    EVENT_RECORD record = make_record(ids::powershell::SCRIPT_BLOCK_LOGGING);
+    record.UserData = data.data();
+    record.UserDataLength = static_cast<USHORT>(data.size());
+
+    ContentCache cache;
+    const ContentCache::Scope scope(&cache);
+    auto first = parse_powershell_event(&record, strings_.get());
+    auto second = parse_powershell_event(&record, strings_.get());
+    auto third = parse_powershell_event(&record, strings_.get());
+
+    EXPECT_EQ(first.payload.script.is_repeat, 0u);
+    EXPECT_EQ(second.payload.script.is_repeat, 1u);
+    EXPECT_EQ(second.payload.script.is_suspicious, 1u);
+    EXPECT_EQ(second.status, event::Status::Suspicious);
+    EXPECT_EQ(second.payload.script.script_block, first.payload.script.script_block);
+    EXPECT_EQ(third.payload.script.script_block, first.payload.script.script_block);
+    EXPECT_EQ(cache.hits(), 2u);
+}
+
+TEST_F(PowerShellParserTest, ParseScriptBlock_PartsScannedWholeOnLastPart) {
+    // "mimikatz" is cut across the two parts
+    auto part1 = build_script_block_data(1, 2, L"$x = 'Invoke-Mimi");
+    auto part2 = build_script_block_data(2, 2, L"katz'");
+
+    ContentCache cache;
+    ScriptAssembler assembler;
+    const ContentCache::Scope cached(&cache);
+    const ScriptAssembler::Scope parts(&assembler);
+
+    EVENT_RECORD record = make_record(ids::powershell::SCRIPT_BLOCK_LOGGING);
+    record.UserData = part1.data();
+    record.UserDataLength = static_cast<USHORT>(part1.size());
+    auto first = parse_powershell_event(&record, strings_.get());
+    record.UserData = part2.data();
+    record.UserDataLength = static_cast<USHORT>(part2.size());
+    auto last = parse_powershell_event(&record, strings_.get());
+
+    EXPECT_TRUE(first.valid);
+    EXPECT_EQ(first.payload.script.is_suspicious, 0u);
+    EXPECT_EQ(last.payload.script.is_suspicious, 1u);
+    EXPECT_EQ(last.status, event::Status::Suspicious);
+    EXPECT_EQ(assembler.completed(), 1u);
+}
+
 }  // namespace
 }  // namespace exeray::etw
 
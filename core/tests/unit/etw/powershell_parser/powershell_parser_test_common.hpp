@@ -17,8 +17,10 @@
 #include <evntcons.h>
 
 #include "exeray/arena.hpp"
+#include "exeray/etw/content_cache.hpp"
 #include "exeray/etw/event_ids.hpp"
 #include "exeray/etw/parser.hpp"
+#include "exeray/etw/script_assembly.hpp"
 #include "exeray/event/string_pool.hpp"
 #include "exeray/event/types.hpp"
 
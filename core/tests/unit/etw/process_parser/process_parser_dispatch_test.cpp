@@ -3,6 +3,9 @@
 
 #include "process_parser_test_common.hpp"
 
+#include "exeray/etw/parse_metrics.hpp"
+#include "exeray/etw/providers/guids.hpp"
+
 #ifdef _WIN32
 
 namespace exeray::etw {
@@ -61,6 +64,28 @@ TEST_F(ProcessParserTest, ParseProcessEvent_EventId5_DispatchesToImageLoad) {
     EXPECT_EQ(result.payload.process.pid, 400u);
 }
 
+TEST_F(ProcessParserTest, ParseProcessEvent_EventId15_DispatchesToRundown) {
+    // ProcessId, CreateTime, ParentProcessID, four UINT32s, then ImageName
+    std::vector<uint8_t> data(24 + 2 * sizeof(wchar_t), 0);
+    const uint32_t pid = 500;
+    const uint32_t parent = 4;
+    std::memcpy(data.data(), &pid, sizeof(pid));
+    std::memcpy(data.data() + 12, &parent, sizeof(parent));
+    const wchar_t name = L'a';
+    std::memcpy(data.data() + 24, &name, sizeof(name));
+
+    EVENT_RECORD record = make_record(ids::process::RUNDOWN, true);
+    record.UserData = data.data();
+    record.UserDataLength = static_cast<USHORT>(data.size());
+
+    auto result = parse_process_event(&record, strings_.get());
+
+    EXPECT_TRUE(result.valid);
+    EXPECT_EQ(result.operation, static_cast<uint8_t>(event::ProcessOp::Rundown));
+    EXPECT_EQ(result.payload.process.pid, 500u);
+    EXPECT_EQ(result.payload.process.parent_pid, 4u);
+}
+
 TEST_F(ProcessParserTest, ParseProcessStop_ValidEvent_ExtractsPID) {
     auto data = build_process_stop_data(9876);
     
@@ -105,6 +130,20 @@ TEST_F(ProcessParserTest, ParseImageLoad_32bit_CorrectPointerHandling) {
     EXPECT_EQ(result.payload.process.pid, 7890u);
 }
 
+TEST_F(ProcessParserTest, DispatchEvent_MutedProvider_DropsRecord) {
+    auto data = build_process_stop_data(300);
+
+    EVENT_RECORD record = make_record(ids::process::STOP, true);
+    record.EventHeader.ProviderId = providers::KERNEL_PROCESS;
+    record.UserData = data.data();
+    record.UserDataLength = static_cast<USHORT>(data.size());
+
+    const auto process_bit = std::uint32_t{1} << static_cast<unsigned>(MetricProvider::Process);
+    const auto file_bit = std::uint32_t{1} << static_cast<unsigned>(MetricProvider::File);
+    EXPECT_FALSE(dispatch_event(&record, strings_.get(), process_bit).valid);
+    EXPECT_TRUE(dispatch_event(&record, strings_.get(), file_bit).valid);
+}
+
 }  // namespace
 }  // namespace exeray::etw
 
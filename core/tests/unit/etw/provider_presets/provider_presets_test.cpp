@@ -0,0 +1,126 @@
+/// @file provider_presets_test.cpp
+/// @brief Tests for per-provider keyword presets.
+
+#include <gtest/gtest.h>
+
+#include "exeray/engine.hpp"
+#include "exeray/etw/event_ids.hpp"
+#include "exeray/etw/provider_presets.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace exeray::etw {
+namespace {
+
+bool contains(std::span<const std::uint16_t> ids, std::uint16_t id) {
+    return std::find(ids.begin(), ids.end(), id) != ids.end();
+}
+
+TEST(ProviderPresetsTest, Custom_HasNoSettings) {
+    EXPECT_FALSE(provider_preset("Process", ProviderPreset::Custom).has_value());
+}
+
+TEST(ProviderPresetsTest, UnknownProvider_HasNoSettings) {
+    EXPECT_FALSE(provider_preset("Nope", ProviderPreset::Minimal).has_value());
+}
+
+TEST(ProviderPresetsTest, Full_EnablesEverything) {
+    auto settings = provider_preset("Registry", ProviderPreset::Full);
+    ASSERT_TRUE(settings.has_value());
+    EXPECT_EQ(settings->keywords, 0u);
+    EXPECT_TRUE(settings->event_ids.empty());
+}
+
+TEST(ProviderPresetsTest, ProcessMinimal_KeepsRundown) {
+    auto settings = provider_preset("Process", ProviderPreset::Minimal);
+    ASSERT_TRUE(settings.has_value());
+    EXPECT_NE(settings->keywords, 0u);
+    EXPECT_TRUE(contains(settings->event_ids, ids::process::START));
+    EXPECT_TRUE(contains(settings->event_ids, ids::process::RUNDOWN));
+}
+
+TEST(ProviderPresetsTest, FileMinimal_FiltersByKeywordOnly) {
+    auto settings = provider_preset("File", ProviderPreset::Minimal);
+    ASSERT_TRUE(settings.has_value());
+    EXPECT_NE(settings->keywords, 0u);
+    EXPECT_TRUE(settings->event_ids.empty());
+}
+
+TEST(ProviderPresetsTest, Security_IsSupersetOfMinimal) {
+    for (const char* provider : {"Registry", "Network", "PowerShell", "DNS", "WMI", "CLR"}) {
+        auto minimal = provider_preset(provider, ProviderPreset::Minimal);
+        auto security = provider_preset(provider, ProviderPreset::Security);
+        ASSERT_TRUE(minimal && security) << provider;
+        for (std::uint16_t id : minimal->event_ids) {
+            EXPECT_TRUE(contains(security->event_ids, id)) << provider << " " << id;
+        }
+    }
+}
+
+TEST(ProviderPresetsTest, Names_RoundTrip) {
+    for (auto preset : {ProviderPreset::Custom, ProviderPreset::Minimal,
+                        ProviderPreset::Security, ProviderPreset::Full}) {
+        EXPECT_EQ(parse_provider_preset(preset_name(preset)), preset);
+    }
+    EXPECT_FALSE(parse_provider_preset("Minimal").has_value());
+}
+
+TEST(ProviderSettingsTest, Custom_UsesConfigFields) {
+    ProviderConfig cfg;
+    cfg.level = 5;
+    cfg.keywords = 0x30;
+    cfg.event_ids = {1, 2};
+
+    auto settings = provider_settings("Registry", cfg);
+    EXPECT_EQ(settings.level, 5);
+    EXPECT_EQ(settings.keywords, 0x30u);
+    EXPECT_EQ(settings.event_ids.size(), 2u);
+}
+
+TEST(ProviderSettingsTest, Preset_ReplacesLevelAndKeywords) {
+    ProviderConfig cfg;
+    cfg.keywords = 0x1;
+    cfg.preset = ProviderPreset::Minimal;
+
+    auto settings = provider_settings("PowerShell", cfg);
+    EXPECT_EQ(settings.level, 5);
+    EXPECT_EQ(settings.keywords, 0u);
+    EXPECT_TRUE(contains(settings.event_ids, ids::powershell::SCRIPT_BLOCK_LOGGING));
+}
+
+TEST(ProviderSettingsTest, ExplicitEventIds_OverridePreset) {
+    ProviderConfig cfg;
+    cfg.preset = ProviderPreset::Security;
+    cfg.event_ids = {ids::registry::SET_VALUE};
+
+    auto settings = provider_settings("Registry", cfg);
+    ASSERT_EQ(settings.event_ids.size(), 1u);
+    EXPECT_EQ(settings.event_ids[0], ids::registry::SET_VALUE);
+}
+
+TEST(ProviderPresetsTest, SecurityAndFull_CaptureStacksOfInjectionEvents) {
+    for (auto preset : {ProviderPreset::Security, ProviderPreset::Full}) {
+        EXPECT_TRUE(contains(provider_preset("Thread", preset)->stack_event_ids,
+                             ids::thread::START));
+        EXPECT_TRUE(contains(provider_preset("Memory", preset)->stack_event_ids,
+                             ids::memory::VIRTUAL_ALLOC));
+        EXPECT_TRUE(contains(provider_preset("AMSI", preset)->stack_event_ids,
+                             ids::amsi::SCAN_BUFFER));
+        EXPECT_TRUE(provider_preset("Registry", preset)->stack_event_ids.empty());
+    }
+    EXPECT_TRUE(provider_preset("Thread", ProviderPreset::Minimal)->stack_event_ids.empty());
+}
+
+TEST(ProviderSettingsTest, ExplicitStackEventIds_OverridePreset) {
+    ProviderConfig cfg;
+    cfg.preset = ProviderPreset::Security;
+    cfg.stack_event_ids = {ids::thread::END};
+
+    auto settings = provider_settings("Thread", cfg);
+    ASSERT_EQ(settings.stack_event_ids.size(), 1u);
+    EXPECT_EQ(settings.stack_event_ids[0], ids::thread::END);
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,82 @@
+/// @file provider_table_test.cpp
+/// @brief Tests for the flat provider GUID dispatch table.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/provider_table.hpp"
+
+#include <cstddef>
+
+namespace exeray::etw {
+namespace {
+
+// The GUIDs of guids.cpp (stubbed to zero off Windows)
+constexpr GUID kProviders[] = {
+    {0x22FB2CD6, 0x0E7B, 0x422B, {0xA0, 0xC7, 0x2F, 0xAD, 0x1F, 0xD0, 0xE7, 0x16}},
+    {0xEDD08927, 0x9CC4, 0x4E65, {0xB9, 0x70, 0xC2, 0x56, 0x0F, 0xB5, 0xC2, 0x89}},
+    {0x70EB4F03, 0xC1DE, 0x4F73, {0xA0, 0x51, 0x33, 0xD1, 0x3D, 0x54, 0x13, 0xBD}},
+    {0x7DD42A49, 0x5329, 0x4832, {0x8D, 0xFD, 0x43, 0xD9, 0x79, 0x15, 0x3A, 0x88}},
+    {0x2CB15D1D, 0x5FC1, 0x11D2, {0xAB, 0xE1, 0x00, 0xA0, 0xC9, 0x11, 0xF5, 0x18}},
+    {0x3D6FA8D1, 0xFE05, 0x11D0, {0x9D, 0xDA, 0x00, 0xC0, 0x4F, 0xD7, 0xBA, 0x7C}},
+    {0x3D6FA8D3, 0xFE05, 0x11D0, {0x9D, 0xDA, 0x00, 0xC0, 0x4F, 0xD7, 0xBA, 0x7C}},
+    {0xA0C1853B, 0x5C40, 0x4B15, {0x87, 0x66, 0x3C, 0xF1, 0xC5, 0x8F, 0x98, 0x5A}},
+    {0x2A576B87, 0x09A7, 0x520E, {0xC2, 0x1A, 0x49, 0x42, 0xF0, 0x27, 0x1D, 0x67}},
+    {0x1C95126E, 0x7EEA, 0x49A9, {0xA3, 0xFE, 0xA3, 0x78, 0xB0, 0x3D, 0xDB, 0x4D}},
+    {0x54849625, 0x5478, 0x4994, {0xA5, 0xBA, 0x3E, 0x3B, 0x03, 0x28, 0xC3, 0x0D}},
+    {0x1418EF04, 0xB0B4, 0x4623, {0xBF, 0x7E, 0xD7, 0x4A, 0xB4, 0x7B, 0xBD, 0xAA}},
+    {0xE13C0D23, 0xCCBC, 0x4E12, {0x93, 0x1B, 0xD9, 0xCC, 0x2E, 0xEE, 0x27, 0xE4}},
+};
+
+class ProviderTableTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (std::size_t i = 0; i < std::size(kProviders); ++i) {
+            ASSERT_TRUE(table_.insert(kProviders[i], static_cast<int>(i)));
+        }
+    }
+
+    ProviderTable<int> table_;
+};
+
+TEST_F(ProviderTableTest, Find_KnownProviders_ReturnsValue) {
+    for (std::size_t i = 0; i < std::size(kProviders); ++i) {
+        const int* value = table_.find(kProviders[i]);
+        ASSERT_NE(value, nullptr) << i;
+        EXPECT_EQ(*value, static_cast<int>(i));
+    }
+}
+
+TEST_F(ProviderTableTest, Find_KnownProviders_DirectHit) {
+    for (const auto& guid : kProviders) {
+        EXPECT_EQ(table_.probes(guid), 1U);
+    }
+}
+
+TEST_F(ProviderTableTest, Find_Unknown_Nullptr) {
+    const GUID unknown{0x12345678, 0x1111, 0x2222, {1, 2, 3, 4, 5, 6, 7, 8}};
+    EXPECT_EQ(table_.find(unknown), nullptr);
+}
+
+TEST_F(ProviderTableTest, Find_SameData1DifferentGuid_Nullptr) {
+    GUID lookalike = kProviders[1];
+    lookalike.Data4[7] ^= 0xFF;
+    EXPECT_EQ(table_.find(lookalike), nullptr);
+}
+
+TEST_F(ProviderTableTest, Insert_Duplicate_Rejected) {
+    EXPECT_FALSE(table_.insert(kProviders[0], 99));
+    EXPECT_EQ(*table_.find(kProviders[0]), 0);
+}
+
+TEST(ProviderTableFullTest, Insert_Full_Rejected) {
+    ProviderTable<int, 4> table;
+    for (std::uint32_t i = 0; i < 4; ++i) {
+        ASSERT_TRUE(table.insert(GUID{i, 0, 0, {}}, static_cast<int>(i)));
+    }
+    EXPECT_FALSE(table.insert(GUID{9, 0, 0, {}}, 9));
+    EXPECT_EQ(table.find(GUID{9, 0, 0, {}}), nullptr);
+    EXPECT_EQ(*table.find(GUID{3, 0, 0, {}}), 3);
+}
+
+}  // namespace
+}  // namespace exeray::etw
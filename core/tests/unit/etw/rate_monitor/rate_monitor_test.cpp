@@ -0,0 +1,153 @@
+/// @file rate_monitor_test.cpp
+/// @brief Tests for per-process event rate baselines.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/rate_monitor.hpp"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace exeray::etw {
+namespace {
+
+using event::Category;
+
+constexpr std::uint64_t kMs = 1'000'000;
+constexpr std::uint64_t kSecond = 1000 * kMs;
+
+RateConfig config() {
+    RateConfig config;
+    config.enabled = true;
+    config.factor = 5.0;
+    config.min_rate = 20.0;
+    config.warmup_windows = 3;
+    return config;
+}
+
+/// @brief Feed count events of pid evenly over second s; returns the flags raised.
+int feed(RateMonitor& monitor, std::uint32_t pid, Category category, std::uint64_t s,
+         int count) {
+    int flagged = 0;
+    for (int i = 0; i < count; ++i) {
+        const std::uint64_t at = s * kSecond + static_cast<std::uint64_t>(i) * (kSecond / count);
+        flagged += monitor.observe(pid, category, at) ? 1 : 0;
+    }
+    return flagged;
+}
+
+TEST(RateMonitorTest, Observe_SpikeAboveBaselineFlaggedOncePerWindow) {
+    RateMonitor monitor(config());
+    for (std::uint64_t s = 1; s <= 10; ++s) {
+        EXPECT_EQ(feed(monitor, 100, Category::FileSystem, s, 10), 0) << s;
+    }
+    EXPECT_EQ(feed(monitor, 100, Category::FileSystem, 11, 500), 1);
+
+    const auto anomalies = monitor.anomalies();
+    ASSERT_EQ(anomalies.size(), 1u);
+    EXPECT_EQ(anomalies[0].pid, 100u);
+    EXPECT_EQ(anomalies[0].category, Category::FileSystem);
+    EXPECT_NEAR(anomalies[0].baseline, 10.0, 0.5);
+    EXPECT_GT(anomalies[0].rate, 5 * anomalies[0].baseline);
+    EXPECT_EQ(monitor.stats().anomalies, 1u);
+    EXPECT_EQ(monitor.stats().observed, 600u);
+}
+
+TEST(RateMonitorTest, Observe_CategoriesAndProcessesHaveOwnBaselines) {
+    RateMonitor monitor(config());
+    for (std::uint64_t s = 1; s <= 10; ++s) {
+        feed(monitor, 100, Category::FileSystem, s, 200);
+        feed(monitor, 100, Category::Network, s, 5);
+        feed(monitor, 200, Category::Network, s, 5);
+    }
+    // A busy file writer is normal for process 100; its network burst is not
+    EXPECT_EQ(feed(monitor, 100, Category::FileSystem, 11, 400), 0);
+    EXPECT_EQ(feed(monitor, 100, Category::Network, 11, 100), 1);
+    EXPECT_EQ(feed(monitor, 200, Category::Network, 11, 5), 0);
+}
+
+TEST(RateMonitorTest, Observe_WarmupAndMinimumRateSuppressFlags) {
+    RateMonitor monitor(config());
+    // A process starting with a burst has no baseline to exceed yet
+    EXPECT_EQ(feed(monitor, 100, Category::FileSystem, 1, 1000), 0);
+
+    for (std::uint64_t s = 1; s <= 10; ++s) {
+        feed(monitor, 200, Category::Registry, s, 1);
+    }
+    // Ten times the baseline, but under min_rate
+    EXPECT_EQ(feed(monitor, 200, Category::Registry, 11, 10), 0);
+    EXPECT_EQ(feed(monitor, 200, Category::Registry, 12, 30), 1);
+}
+
+TEST(RateMonitorTest, Observe_IdleWindowsLowerTheBaseline) {
+    RateMonitor monitor(config());
+    for (std::uint64_t s = 1; s <= 10; ++s) {
+        feed(monitor, 100, Category::FileSystem, s, 100);
+    }
+    EXPECT_EQ(feed(monitor, 100, Category::FileSystem, 11, 400), 0);
+    // After a long quiet spell the same volume is a spike again
+    EXPECT_EQ(feed(monitor, 100, Category::FileSystem, 50, 400), 1);
+}
+
+TEST(RateMonitorTest, Capacity_FixedTableEvictsLeastRecentlySeen) {
+    RateConfig small = config();
+    small.capacity = 16;  // One set of kProbe entries per shard minimum
+    RateMonitor monitor(small);
+    for (std::uint32_t pid = 1; pid <= 2000; ++pid) {
+        monitor.observe(pid, Category::Process, kSecond);
+    }
+    const RateStats stats = monitor.stats();
+    EXPECT_EQ(stats.observed, 2000u);
+    EXPECT_EQ(stats.tracked, RateMonitor::kShards * RateMonitor::kProbe);
+    EXPECT_EQ(stats.evicted, 2000u - stats.tracked);
+
+    // Idle entries are reused without counting as evictions
+    for (std::uint32_t pid = 5000; pid < 5100; ++pid) {
+        monitor.observe(pid, Category::Process, 1000 * kSecond);
+    }
+    EXPECT_LE(monitor.stats().evicted, 2000u - stats.tracked + 100u);
+}
+
+TEST(RateMonitorTest, Anomalies_KeepMostRecentOldestFirst) {
+    RateConfig eager = config();
+    eager.warmup_windows = 1;
+    eager.min_rate = 0.0;
+    RateMonitor monitor(eager);
+    const std::uint32_t total = RateMonitor::kMaxAnomalies + 10;
+    for (std::uint32_t i = 0; i < total; ++i) {
+        // One event is the baseline; six in the next window exceed five times it
+        monitor.observe(i + 1, Category::Dns, kSecond);
+        EXPECT_EQ(feed(monitor, i + 1, Category::Dns, 2, 6), 1);
+    }
+    const auto anomalies = monitor.anomalies();
+    ASSERT_EQ(anomalies.size(), RateMonitor::kMaxAnomalies);
+    EXPECT_EQ(anomalies.front().pid, 11u);
+    EXPECT_EQ(anomalies.back().pid, total);
+    EXPECT_EQ(monitor.stats().anomalies, total);
+
+    monitor.clear();
+    EXPECT_TRUE(monitor.anomalies().empty());
+    EXPECT_EQ(monitor.stats().tracked, 0u);
+}
+
+TEST(RateMonitorTest, Observe_ConcurrentProcessesCountEveryEvent) {
+    RateMonitor monitor(config());
+    std::vector<std::thread> threads;
+    for (std::uint32_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&monitor, t] {
+            for (int i = 0; i < 10000; ++i) {
+                monitor.observe(100 + t, Category::FileSystem,
+                                static_cast<std::uint64_t>(i) * kMs);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(monitor.stats().observed, 40000u);
+    EXPECT_EQ(monitor.stats().tracked, 4u);
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,128 @@
+/// @file regex_dfa_test.cpp
+/// @brief Tests for the lazy DFA regular expression search.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/regex_dfa.hpp"
+
+#include <cstdint>
+#include <random>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace exeray::etw {
+namespace {
+
+std::unique_ptr<RegexDfa> compiled(std::string_view pattern, std::size_t max_states = 256) {
+    const char* reason = nullptr;
+    auto regex = RegexDfa::compile(pattern, &reason, max_states);
+    EXPECT_NE(regex, nullptr) << pattern << ": " << (reason != nullptr ? reason : "");
+    return regex;
+}
+
+TEST(RegexDfaTest, Search_LiteralsClassesAndRepetition) {
+    auto regex = compiled(R"(power(shell|_ise)\.exe)");
+    EXPECT_TRUE(regex->search("C:\\Windows\\PowerShell.EXE"));
+    EXPECT_TRUE(regex->search("powershell.exe -nop"));
+    EXPECT_TRUE(regex->search("power_ise.exe"));
+    EXPECT_FALSE(regex->search("powershellXexe"));
+    EXPECT_FALSE(regex->search("pwsh.exe"));
+
+    auto hex = compiled(R"(0x[\da-f]{4,8}(?:h)?)");
+    EXPECT_TRUE(hex->search("addr 0x7FFE1234"));
+    EXPECT_FALSE(hex->search("addr 0x7f"));
+
+    auto words = compiled(R"(\w+\s+/c\s+\S)");
+    EXPECT_TRUE(words->search("cmd.exe /c whoami"));
+    EXPECT_FALSE(words->search("cmd.exe /c "));
+
+    auto negated = compiled("[^a-z]x");
+    EXPECT_TRUE(negated->search("1x"));
+    EXPECT_FALSE(negated->search("Ax"));  // Case folding applies to the class first
+}
+
+TEST(RegexDfaTest, Search_Anchors) {
+    auto whole = compiled(R"(^(cmd|pwsh)\.exe$)");
+    EXPECT_TRUE(whole->search("CMD.exe"));
+    EXPECT_FALSE(whole->search("xcmd.exe"));
+    EXPECT_FALSE(whole->search("cmd.exe "));
+
+    auto suffix = compiled(R"(\.ps1$)");
+    EXPECT_TRUE(suffix->search("a.ps1.ps1"));
+    EXPECT_FALSE(suffix->search("a.ps1.txt"));
+
+    auto dollar = compiled(R"(cost\$)");
+    EXPECT_TRUE(dollar->search("cost$5"));
+
+    EXPECT_TRUE(compiled("^$")->search(""));
+    EXPECT_FALSE(compiled("^$")->search("a"));
+    EXPECT_TRUE(compiled("")->search("anything"));
+}
+
+TEST(RegexDfaTest, Compile_RejectsInvalidPatterns) {
+    for (const std::string_view pattern :
+         {"(a", "a)", "[a", "*a", "a**", "a{2", "a{3,1}", "a{1001}", "\\", "\\q", "a^b",
+          "^a|b", "[z-a]", "\\xZZ"}) {
+        const char* reason = nullptr;
+        EXPECT_EQ(RegexDfa::compile(pattern, &reason), nullptr) << pattern;
+        EXPECT_NE(reason, nullptr) << pattern;
+    }
+    EXPECT_EQ(RegexDfa::compile(std::string(100, '(') + "a" + std::string(100, ')')), nullptr);
+    EXPECT_EQ(RegexDfa::compile("(a{1000}){1000}"), nullptr);
+}
+
+TEST(RegexDfaTest, Literals_AreRequiredFactors) {
+    EXPECT_EQ(compiled(R"(power(shell|_ise)\.exe)")->literals(),
+              (std::vector<std::string>{"power_ise.exe", "powershell.exe"}));
+    EXPECT_EQ(compiled(R"(\d+MIMIKATZ\d+)")->literals(), std::vector<std::string>{"mimikatz"});
+    EXPECT_EQ(compiled("(certutil|bitsadmin).*-urlcache")->literals(),
+              std::vector<std::string>{"-urlcache"});
+    EXPECT_EQ(compiled("(certutil|bitsadmin)")->literals(),
+              (std::vector<std::string>{"bitsadmin", "certutil"}));
+    EXPECT_TRUE(compiled("a?b*")->literals().empty());
+    EXPECT_TRUE(compiled(".+")->literals().empty());
+}
+
+TEST(RegexDfaTest, SmallCache_FlushesAndAgreesWithStdRegex) {
+    // The n-th symbol from the end: a DFA of 2^(n+1) states
+    const std::string pattern = "(a|b)*a(a|b){6}$";
+    auto regex = compiled(pattern, 8);
+    const std::regex reference(pattern, std::regex::ECMAScript | std::regex::icase);
+
+    std::mt19937 rng(7);
+    for (int i = 0; i < 500; ++i) {
+        std::string text(rng() % 40, 'a');
+        for (char& c : text) {
+            c = "abAB"[rng() % 4];
+        }
+        ASSERT_EQ(regex->search(text), std::regex_search(text, reference)) << text;
+    }
+    EXPECT_GT(regex->flushes(), 0U);
+    EXPECT_LE(regex->cached_states(), 8U);
+}
+
+TEST(RegexDfaTest, Search_ConcurrentCallersShareTheCache) {
+    auto regex = compiled(R"(\\temp\\[^\\]+\.(exe|dll)$)", 16);
+    std::vector<std::thread> threads;
+    std::vector<int> wrong(4, 0);
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 2000; ++i) {
+                const std::string name = "C:\\Temp\\x" + std::to_string(i + t);
+                wrong[t] += !regex->search(name + ".exe");
+                wrong[t] += regex->search(name + ".txt");
+                wrong[t] += regex->search("C:\\Temp\\dir\\x.dll");
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(wrong, std::vector<int>(4, 0));
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,98 @@
+/// @file registry_parser_path_test.cpp
+/// @brief Key path resolution through the key object map.
+
+#include "registry_parser_test_common.hpp"
+
+#ifdef _WIN32
+
+namespace exeray::etw {
+namespace {
+
+constexpr uint64_t kSoftware = 0xFFFFC00100001000ULL;
+constexpr uint64_t kRun = 0xFFFFC00100002000ULL;
+
+// =============================================================================
+// Key Path Resolution
+// =============================================================================
+
+TEST_F(RegistryParserTest, CreateKey_AbsoluteName_RecordsPath) {
+    auto data = build_named_key_data(0, kSoftware, L"", L"\\REGISTRY\\MACHINE\\SOFTWARE", true);
+    auto result = parse(ids::registry::CREATE_KEY, data);
+
+    ASSERT_TRUE(result.valid);
+    EXPECT_EQ(strings_->get(result.payload.registry.key_path), "\\REGISTRY\\MACHINE\\SOFTWARE");
+    EXPECT_EQ(key_map().find(kSoftware), result.payload.registry.key_path);
+}
+
+TEST_F(RegistryParserTest, OpenKey_RelativeToKnownKey_JoinsPath) {
+    auto base = build_named_key_data(0, kSoftware, L"", L"\\REGISTRY\\MACHINE\\SOFTWARE", false);
+    parse(ids::registry::OPEN_KEY, base);
+
+    auto data = build_named_key_data(kSoftware, kRun, L"",
+                                     L"Microsoft\\Windows\\CurrentVersion\\Run", false);
+    auto result = parse(ids::registry::OPEN_KEY, data);
+
+    EXPECT_EQ(strings_->get(result.payload.registry.key_path),
+              "\\REGISTRY\\MACHINE\\SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Run");
+    EXPECT_EQ(key_map().find(kRun), result.payload.registry.key_path);
+}
+
+TEST_F(RegistryParserTest, OpenKey_UnknownBase_UsesBaseName) {
+    auto data = build_named_key_data(kSoftware, kRun, L"\\REGISTRY\\MACHINE\\SOFTWARE",
+                                     L"Classes", false);
+    auto result = parse(ids::registry::OPEN_KEY, data);
+
+    EXPECT_EQ(strings_->get(result.payload.registry.key_path),
+              "\\REGISTRY\\MACHINE\\SOFTWARE\\Classes");
+}
+
+TEST_F(RegistryParserTest, CreateKey_Failed_NotRecorded) {
+    auto data = build_named_key_data(0, kRun, L"", L"\\REGISTRY\\MACHINE\\X", true,
+                                     static_cast<int32_t>(0xC0000034));
+    parse(ids::registry::CREATE_KEY, data);
+
+    EXPECT_EQ(key_map().find(kRun), event::INVALID_STRING);
+}
+
+TEST_F(RegistryParserTest, SetValue_KnownKey_ResolvesPathAndValueName) {
+    auto key = build_named_key_data(0, kRun, L"", L"\\REGISTRY\\MACHINE\\SOFTWARE\\Run", true);
+    const auto path = parse(ids::registry::CREATE_KEY, key).payload.registry.key_path;
+
+    auto data = build_named_value_data(kRun, L"", L"Updater");
+    auto result = parse(ids::registry::SET_VALUE, data);
+
+    ASSERT_TRUE(result.valid);
+    EXPECT_EQ(result.payload.registry.key_path, path);
+    EXPECT_EQ(strings_->get(result.payload.registry.value_name), "Updater");
+    EXPECT_EQ(result.payload.registry.value_type, 1u);
+    EXPECT_EQ(result.payload.registry.data_size, 8u);
+}
+
+TEST_F(RegistryParserTest, SetValue_UnknownKey_FallsBackToKeyName) {
+    auto data = build_named_value_data(kRun, L"\\REGISTRY\\USER\\S-1-5-21\\Run", L"x");
+    auto result = parse(ids::registry::SET_VALUE, data);
+
+    EXPECT_EQ(strings_->get(result.payload.registry.key_path), "\\REGISTRY\\USER\\S-1-5-21\\Run");
+}
+
+TEST_F(RegistryParserTest, CloseKey_ForgetsKeyObject) {
+    auto key = build_named_key_data(0, kRun, L"", L"\\REGISTRY\\MACHINE\\SOFTWARE\\Run", true);
+    parse(ids::registry::CREATE_KEY, key);
+
+    auto close = build_value_event_data(0);
+    std::memcpy(close.data(), &kRun, sizeof(kRun));
+    parse(ids::registry::CLOSE_KEY, close);
+
+    EXPECT_EQ(key_map().find(kRun), event::INVALID_STRING);
+}
+
+}  // namespace
+}  // namespace exeray::etw
+
+#else  // !_WIN32
+
+TEST(RegistryParserPathTest, SkippedOnNonWindows) {
+    GTEST_SKIP() << "ETW parser tests require Windows platform";
+}
+
+#endif  // _WIN32
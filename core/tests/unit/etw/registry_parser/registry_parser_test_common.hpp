@@ -9,6 +9,7 @@
 
 #include <cstdint>
 #include <cstring>
+#include <string_view>
 #include <vector>
 
 #ifndef WIN32_LEAN_AND_MEAN
@@ -20,6 +21,7 @@
 
 #include "exeray/arena.hpp"
 #include "exeray/etw/event_ids.hpp"
+#include "exeray/etw/key_map.hpp"
 #include "exeray/etw/parser.hpp"
 #include "exeray/event/string_pool.hpp"
 #include "exeray/event/types.hpp"
@@ -33,8 +35,11 @@ protected:
     void SetUp() override {
         arena_ = std::make_unique<Arena>(kArenaSize);
         strings_ = std::make_unique<event::StringPool>(*arena_);
+        key_map().clear();
     }
 
+    void TearDown() override { key_map().clear(); }
+
     EVENT_RECORD make_record(uint16_t event_id, bool is64bit = true) {
         EVENT_RECORD record{};
         record.EventHeader.EventDescriptor.Id = event_id;
@@ -96,6 +101,45 @@ protected:
         return buffer;
     }
 
+    /// Append a null-terminated UTF-16 string.
+    static void append_wstring(std::vector<uint8_t>& buffer, std::wstring_view text) {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(text.data());
+        buffer.insert(buffer.end(), bytes, bytes + text.size() * sizeof(wchar_t));
+        buffer.insert(buffer.end(), sizeof(wchar_t), 0);
+    }
+
+    /// Build CreateKey (with Disposition) or OpenKey user data with names.
+    std::vector<uint8_t> build_named_key_data(uint64_t base_object, uint64_t key_object,
+                                              std::wstring_view base_name,
+                                              std::wstring_view relative_name,
+                                              bool create, int32_t ntstatus = 0) {
+        std::vector<uint8_t> buffer(16 + sizeof(int32_t) + (create ? sizeof(uint32_t) : 0), 0);
+        std::memcpy(buffer.data(), &base_object, sizeof(base_object));
+        std::memcpy(buffer.data() + 8, &key_object, sizeof(key_object));
+        std::memcpy(buffer.data() + 16, &ntstatus, sizeof(ntstatus));
+        append_wstring(buffer, base_name);
+        append_wstring(buffer, relative_name);
+        return buffer;
+    }
+
+    /// Build SetValue user data with KeyName and ValueName.
+    std::vector<uint8_t> build_named_value_data(uint64_t key_object, std::wstring_view key_name,
+                                                std::wstring_view value_name) {
+        auto buffer = build_value_event_data(0, 1, 8);
+        std::memcpy(buffer.data(), &key_object, sizeof(key_object));
+        append_wstring(buffer, key_name);
+        append_wstring(buffer, value_name);
+        return buffer;
+    }
+
+    /// Parse user data as a 64-bit event of event_id.
+    ParsedEvent parse(uint16_t event_id, std::vector<uint8_t>& data) {
+        EVENT_RECORD record = make_record(event_id, true);
+        record.UserData = data.data();
+        record.UserDataLength = static_cast<USHORT>(data.size());
+        return parse_registry_event(&record, strings_.get());
+    }
+
     std::unique_ptr<Arena> arena_;
     std::unique_ptr<event::StringPool> strings_;
 };
@@ -0,0 +1,67 @@
+/// @file replay_pacer_test.cpp
+/// @brief Tests for wall-clock pacing of replayed trace records.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/replay_pacer.hpp"
+
+#include <chrono>
+
+namespace exeray::etw {
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr std::uint64_t kStart = 133'000'000'000'000'000ULL;  // Some FILETIME
+constexpr std::uint64_t kTicksPerMs = 10'000;                 // 100-ns ticks
+
+TEST(ReplayPacerTest, FirstRecord_NoDelay) {
+    ReplayPacer pacer;
+    EXPECT_EQ(pacer.delay(kStart, ReplayPacer::Clock::now()), 0ns);
+}
+
+TEST(ReplayPacerTest, LaterRecord_WaitsForRecordedGap) {
+    ReplayPacer pacer;
+    const auto t0 = ReplayPacer::Clock::time_point{} + 1s;
+    (void)pacer.delay(kStart, t0);
+
+    EXPECT_EQ(pacer.delay(kStart + 50 * kTicksPerMs, t0), 50ms);
+    EXPECT_EQ(pacer.delay(kStart + 50 * kTicksPerMs, t0 + 20ms), 30ms);
+    EXPECT_EQ(pacer.delay(kStart + 50 * kTicksPerMs, t0 + 80ms), 0ns);
+}
+
+TEST(ReplayPacerTest, Speed_ScalesGap) {
+    ReplayPacer pacer(4.0);
+    const auto t0 = ReplayPacer::Clock::time_point{} + 1s;
+    (void)pacer.delay(kStart, t0);
+
+    EXPECT_EQ(pacer.delay(kStart + 100 * kTicksPerMs, t0), 25ms);
+}
+
+TEST(ReplayPacerTest, InvalidSpeed_RealTime) {
+    ReplayPacer pacer(0.0);
+    const auto t0 = ReplayPacer::Clock::time_point{} + 1s;
+    (void)pacer.delay(kStart, t0);
+
+    EXPECT_EQ(pacer.delay(kStart + 10 * kTicksPerMs, t0), 10ms);
+}
+
+TEST(ReplayPacerTest, RecordBeforeFirst_NoDelay) {
+    ReplayPacer pacer;
+    const auto t0 = ReplayPacer::Clock::time_point{} + 1s;
+    (void)pacer.delay(kStart, t0);
+
+    EXPECT_EQ(pacer.delay(kStart - kTicksPerMs, t0), 0ns);
+}
+
+TEST(ReplayPacerTest, Pace_SleepsAboutTheGap) {
+    ReplayPacer pacer;
+    const auto begin = ReplayPacer::Clock::now();
+    pacer.pace(kStart);
+    pacer.pace(kStart + 20 * kTicksPerMs);
+
+    EXPECT_GE(ReplayPacer::Clock::now() - begin, 19ms);
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,126 @@
+/// @file sampler_test.cpp
+/// @brief Tests for deterministic per-category sampling.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/sampler.hpp"
+
+#include <cstdint>
+
+namespace exeray::etw {
+namespace {
+
+using event::Category;
+
+template <typename Op>
+constexpr std::uint8_t op(Op value) {
+    return static_cast<std::uint8_t>(value);
+}
+
+event::EventPayload file_event(event::StringId path) {
+    event::EventPayload payload{};
+    payload.category = Category::FileSystem;
+    payload.file.path = path;
+    return payload;
+}
+
+SamplingConfig file_rate(double rate) {
+    SamplingConfig config;
+    config.enabled = true;
+    config.rules.push_back({.category = Category::FileSystem, .rate = rate});
+    return config;
+}
+
+/// Distinct paths of pid kept out of n.
+std::size_t kept(Sampler& sampler, std::uint32_t pid, std::uint32_t n) {
+    std::size_t count = 0;
+    for (std::uint32_t path = 1; path <= n; ++path) {
+        count += sampler.admit(pid, file_event(path), op(event::FileOp::Read)) ? 1 : 0;
+    }
+    return count;
+}
+
+TEST(SamplerTest, Unconfigured_KeepsEverything) {
+    Sampler sampler;
+    EXPECT_EQ(kept(sampler, 1234, 1000), 1000U);
+    EXPECT_EQ(sampler.stats().dropped_total(), 0U);
+    EXPECT_DOUBLE_EQ(sampler.rate(Category::FileSystem, op(event::FileOp::Read)), 1.0);
+}
+
+TEST(SamplerTest, Rate_IsApproximatelyRespected) {
+    Sampler sampler(file_rate(0.01));
+    const std::size_t count = kept(sampler, 1234, 100000);
+    EXPECT_GT(count, 800U);
+    EXPECT_LT(count, 1200U);
+    const SamplingStats stats = sampler.stats();
+    EXPECT_EQ(stats.kept[static_cast<std::size_t>(Category::FileSystem)], count);
+    EXPECT_EQ(stats.dropped_total(), 100000U - count);
+}
+
+TEST(SamplerTest, Decision_IsDeterministic) {
+    Sampler first(file_rate(0.5));
+    Sampler second(file_rate(0.5));
+    for (std::uint32_t path = 1; path <= 1000; ++path) {
+        const bool keep = first.admit(1234, file_event(path), op(event::FileOp::Read));
+        EXPECT_EQ(second.admit(1234, file_event(path), op(event::FileOp::Read)), keep);
+        // Repeats of one subject share their fate
+        EXPECT_EQ(first.admit(1234, file_event(path), op(event::FileOp::Write)), keep);
+    }
+}
+
+TEST(SamplerTest, Incarnation_ChangesTheKey) {
+    const event::EventPayload payload = file_event(42);
+    EXPECT_EQ(Sampler::key(1234, 0, payload), Sampler::key(1234, 0, payload));
+    EXPECT_NE(Sampler::key(1234, 0, payload), Sampler::key(1234, 1, payload));
+    EXPECT_NE(Sampler::key(1234, 0, payload), Sampler::key(1238, 0, payload));
+}
+
+TEST(SamplerTest, RateZero_DropsEverything) {
+    Sampler sampler(file_rate(0.0));
+    EXPECT_EQ(kept(sampler, 1234, 1000), 0U);
+}
+
+TEST(SamplerTest, OperationRule_OverridesCategory) {
+    SamplingConfig config = file_rate(0.0);
+    config.rules.push_back(
+        {.category = Category::FileSystem, .operation = op(event::FileOp::Delete), .rate = 1.0});
+    Sampler sampler(config);
+    EXPECT_FALSE(sampler.admit(1234, file_event(7), op(event::FileOp::Read)));
+    EXPECT_TRUE(sampler.admit(1234, file_event(7), op(event::FileOp::Delete)));
+    EXPECT_DOUBLE_EQ(sampler.rate(Category::FileSystem, op(event::FileOp::Delete)), 1.0);
+    EXPECT_DOUBLE_EQ(sampler.rate(Category::FileSystem, op(event::FileOp::Read)), 0.0);
+}
+
+TEST(SamplerTest, Promote_KeepsUntilTheProcessRestarts) {
+    Sampler sampler(file_rate(0.0));
+    sampler.promote(1234);
+    EXPECT_TRUE(sampler.promoted(1234));
+    EXPECT_FALSE(sampler.promoted(5678));
+    EXPECT_EQ(kept(sampler, 1234, 100), 100U);
+    EXPECT_EQ(kept(sampler, 5678, 100), 0U);
+
+    sampler.promote(1234);
+    SamplingStats stats = sampler.stats();
+    EXPECT_EQ(stats.promotions, 1U);
+    EXPECT_EQ(stats.promoted_kept, 100U);
+
+    sampler.process_started(1234);
+    EXPECT_FALSE(sampler.promoted(1234));
+    EXPECT_EQ(kept(sampler, 1234, 100), 0U);
+}
+
+TEST(SamplerTest, Reset_ForgetsPromotionsAndCounters) {
+    Sampler sampler(file_rate(0.0));
+    sampler.promote(1234);
+    (void)kept(sampler, 1234, 10);
+    (void)kept(sampler, 5678, 10);
+    sampler.reset();
+    EXPECT_FALSE(sampler.promoted(1234));
+    const SamplingStats stats = sampler.stats();
+    EXPECT_EQ(stats.promotions, 0U);
+    EXPECT_EQ(stats.promoted_kept, 0U);
+    EXPECT_EQ(stats.dropped_total(), 0U);
+}
+
+}  // namespace
+}  // namespace exeray::etw
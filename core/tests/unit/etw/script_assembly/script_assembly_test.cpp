@@ -0,0 +1,116 @@
+/// @file script_assembly_test.cpp
+/// @brief Tests for multi-part script block reassembly.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/script_assembly.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace exeray::etw {
+namespace {
+
+using Part = ScriptAssembler::Part;
+
+ScriptAssembler::BlockId block_id(std::uint8_t n) {
+    ScriptAssembler::BlockId id{};
+    id[0] = n;
+    id[15] = 0xAB;
+    return id;
+}
+
+class ScriptAssemblyTest : public ::testing::Test {
+protected:
+    Part add(std::uint8_t block, std::uint32_t number, std::uint32_t total,
+             std::wstring_view text, std::uint64_t now = 0) {
+        return assembler_.add(block_id(block), number, total, text, now, 100 + block, whole_,
+                              [this](std::wstring_view partial, std::uint32_t pid) {
+                                  unfinished_.emplace_back(partial);
+                                  pids_.push_back(pid);
+                              });
+    }
+
+    ScriptAssembler assembler_{1000};
+    std::wstring_view whole_;
+    std::vector<std::wstring> unfinished_;
+    std::vector<std::uint32_t> pids_;
+};
+
+TEST_F(ScriptAssemblyTest, Add_CompletesOnLastPart) {
+    EXPECT_EQ(add(1, 1, 3, L"$a = 'Invoke-Mi"), Part::Pending);
+    EXPECT_EQ(add(1, 2, 3, L"mikatz'; iex $"), Part::Pending);
+    EXPECT_EQ(assembler_.open_blocks(), 1U);
+    EXPECT_EQ(add(1, 3, 3, L"a"), Part::Complete);
+    EXPECT_EQ(whole_, L"$a = 'Invoke-Mimikatz'; iex $a");
+    EXPECT_EQ(assembler_.open_blocks(), 0U);
+    EXPECT_EQ(assembler_.completed(), 1U);
+    EXPECT_TRUE(unfinished_.empty());
+}
+
+TEST_F(ScriptAssemblyTest, Add_SinglePartsAndStrayPartsStandAlone) {
+    EXPECT_EQ(add(1, 1, 1, L"Get-Process"), Part::Alone);
+    EXPECT_EQ(add(2, 2, 3, L"middle"), Part::Alone);  // Its first part was never seen
+    EXPECT_EQ(assembler_.open_blocks(), 0U);
+}
+
+TEST_F(ScriptAssemblyTest, Add_InterleavedBlocksCompleteSeparately) {
+    EXPECT_EQ(add(1, 1, 2, L"aa"), Part::Pending);
+    EXPECT_EQ(add(2, 1, 2, L"xx"), Part::Pending);
+    EXPECT_EQ(add(1, 2, 2, L"b"), Part::Complete);
+    EXPECT_EQ(whole_, L"aab");
+    EXPECT_EQ(add(2, 2, 2, L"y"), Part::Complete);
+    EXPECT_EQ(whole_, L"xxy");
+}
+
+TEST_F(ScriptAssemblyTest, OutOfOrderPart_HandsBackWhatArrived) {
+    EXPECT_EQ(add(1, 1, 3, L"first"), Part::Pending);
+    EXPECT_EQ(add(1, 3, 3, L"third"), Part::Alone);
+    ASSERT_EQ(unfinished_.size(), 1U);
+    EXPECT_EQ(unfinished_[0], L"first");
+    EXPECT_EQ(pids_[0], 101U);
+    EXPECT_EQ(assembler_.unfinished(), 1U);
+    EXPECT_EQ(assembler_.open_blocks(), 0U);
+}
+
+TEST_F(ScriptAssemblyTest, OversizedPart_HandsBackWhatArrived) {
+    EXPECT_EQ(add(1, 1, 2, L"abcd"), Part::Pending);  // Room for two parts of four
+    EXPECT_EQ(add(1, 2, 2, L"0123456789"), Part::Alone);
+    ASSERT_EQ(unfinished_.size(), 1U);
+    EXPECT_EQ(unfinished_[0], L"abcd");
+}
+
+TEST_F(ScriptAssemblyTest, StaleBlock_HandedBackOnTimeout) {
+    EXPECT_EQ(add(1, 1, 2, L"waiting", 0), Part::Pending);
+    EXPECT_EQ(add(2, 1, 2, L"other", 500), Part::Pending);
+    EXPECT_TRUE(unfinished_.empty());
+    EXPECT_EQ(add(2, 2, 2, L"!", 1200), Part::Complete);  // Block 1 idle for 1200 > 1000
+    ASSERT_EQ(unfinished_.size(), 1U);
+    EXPECT_EQ(unfinished_[0], L"waiting");
+    EXPECT_EQ(whole_, L"other!");
+    EXPECT_EQ(add(1, 2, 2, L"late"), Part::Alone);
+}
+
+TEST_F(ScriptAssemblyTest, FullTable_EvictsStalestBlock) {
+    for (std::size_t i = 0; i < ScriptAssembler::kMaxBlocks; ++i) {
+        EXPECT_EQ(add(static_cast<std::uint8_t>(i), 1, 2, L"part", 10 + i), Part::Pending);
+    }
+    EXPECT_EQ(add(200, 1, 2, L"new", 100), Part::Pending);
+    ASSERT_EQ(unfinished_.size(), 1U);
+    EXPECT_EQ(pids_[0], 100U);  // Block 0, the least recently extended
+    EXPECT_EQ(assembler_.open_blocks(), ScriptAssembler::kMaxBlocks);
+    EXPECT_EQ(add(0, 2, 2, L"gone", 100), Part::Alone);
+}
+
+TEST_F(ScriptAssemblyTest, Clear_DropsOpenBlocks) {
+    EXPECT_EQ(add(1, 1, 2, L"abc"), Part::Pending);
+    assembler_.clear();
+    EXPECT_EQ(assembler_.open_blocks(), 0U);
+    EXPECT_EQ(add(1, 2, 2, L"def"), Part::Alone);
+    EXPECT_TRUE(unfinished_.empty());
+}
+
+}  // namespace
+}  // namespace exeray::etw
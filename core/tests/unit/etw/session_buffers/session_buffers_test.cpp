@@ -0,0 +1,55 @@
+/// @file session_buffers_test.cpp
+/// @brief Tests for automatic ETW session buffer sizing.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/session_buffers.hpp"
+
+namespace exeray::etw {
+namespace {
+
+TEST(SessionBuffersTest, Resolve_Auto_EveryFieldSet) {
+    const auto out = resolve_buffers({}, 3, 0, 8);
+    EXPECT_EQ(out.buffer_kb, 64U);
+    EXPECT_EQ(out.min_buffers, 16U);
+    EXPECT_GT(out.max_buffers, out.min_buffers);
+    EXPECT_EQ(out.flush_timer_ms, 1000U);
+}
+
+TEST(SessionBuffersTest, Resolve_HighRateProviders_LargerBuffers) {
+    const auto quiet = resolve_buffers({}, 4, 0, 8);
+    const auto busy = resolve_buffers({}, 4, 3, 8);
+
+    EXPECT_EQ(busy.buffer_kb, 256U);
+    EXPECT_GT(static_cast<std::size_t>(busy.buffer_kb) * busy.max_buffers,
+              static_cast<std::size_t>(quiet.buffer_kb) * quiet.max_buffers);
+}
+
+TEST(SessionBuffersTest, Resolve_MoreCores_MoreMinimumBuffers) {
+    EXPECT_LT(resolve_buffers({}, 4, 1, 2).min_buffers,
+              resolve_buffers({}, 4, 1, 32).min_buffers);
+}
+
+TEST(SessionBuffersTest, Resolve_Auto_StaysWithinBudget) {
+    const auto out = resolve_buffers({}, 200, 200, 4);
+    EXPECT_LE(static_cast<std::size_t>(out.buffer_kb) * out.max_buffers,
+              SessionBuffers::kAutoBudgetKb);
+}
+
+TEST(SessionBuffersTest, Resolve_Explicit_Kept) {
+    const SessionBuffers requested{128, 10, 40, 50};
+    EXPECT_EQ(resolve_buffers(requested, 9, 3, 16), requested);
+}
+
+TEST(SessionBuffersTest, Resolve_OutOfRange_Clamped) {
+    const auto out = resolve_buffers({4096, 20, 5, 0}, 1, 0, 4);
+    EXPECT_EQ(out.buffer_kb, SessionBuffers::kMaxBufferKb);
+    EXPECT_EQ(out.max_buffers, out.min_buffers);  // Never below the minimum
+}
+
+TEST(SessionBuffersTest, Resolve_NoCoreCount_QueriesSystem) {
+    EXPECT_GE(resolve_buffers({}, 1, 0).min_buffers, 2U);
+}
+
+}  // namespace
+}  // namespace exeray::etw
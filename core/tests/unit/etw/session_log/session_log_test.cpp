@@ -0,0 +1,38 @@
+/// @file session_log_test.cpp
+/// @brief Tests for the ETL log file settings of live sessions.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/session_log.hpp"
+
+namespace exeray::etw {
+namespace {
+
+TEST(SessionLogTest, Default_Disabled) {
+    const SessionLog log;
+    EXPECT_FALSE(log.enabled());
+    EXPECT_EQ(log.mode, LogFileMode::Circular);
+    EXPECT_GT(log.max_mb, 0U);
+}
+
+TEST(SessionLogTest, LogPathFor_FirstSession_Unchanged) {
+    EXPECT_EQ(log_path_for(L"C:\\logs\\trace.etl", 0), L"C:\\logs\\trace.etl");
+}
+
+TEST(SessionLogTest, LogPathFor_LaterSession_BeforeExtension) {
+    EXPECT_EQ(log_path_for(L"C:\\logs\\trace.etl", 2), L"C:\\logs\\trace.2.etl");
+    EXPECT_EQ(log_path_for(L"logs/trace.v1.etl", 1), L"logs/trace.v1.1.etl");
+}
+
+TEST(SessionLogTest, LogPathFor_NoExtension_Appended) {
+    EXPECT_EQ(log_path_for(L"trace", 3), L"trace.3");
+    EXPECT_EQ(log_path_for(L"C:\\logs.d\\trace", 1), L"C:\\logs.d\\trace.1");
+    EXPECT_EQ(log_path_for(L"C:\\logs\\.etl", 1), L"C:\\logs\\.etl.1");
+}
+
+TEST(SessionLogTest, LogPathFor_Empty_StaysEmpty) {
+    EXPECT_EQ(log_path_for(L"", 4), L"");
+}
+
+}  // namespace
+}  // namespace exeray::etw
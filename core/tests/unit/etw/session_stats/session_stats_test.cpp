@@ -0,0 +1,100 @@
+/// @file session_stats_test.cpp
+/// @brief Tests for the background ETW session statistics poller.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/session_stats.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace exeray::etw {
+namespace {
+
+using namespace std::chrono_literals;
+
+TEST(StatsPollerTest, Latest_NotStarted_Zero) {
+    StatsPoller poller;
+    EXPECT_EQ(poller.latest(), SessionStats{});
+}
+
+TEST(StatsPollerTest, Start_SamplesImmediately) {
+    StatsPoller poller;
+    poller.start([](SessionStats& out) {
+        out.events_lost = 3;
+        out.buffers = 16;
+        return true;
+    }, 1h);
+
+    const auto stats = poller.latest();
+    EXPECT_EQ(stats.events_lost, 3U);
+    EXPECT_EQ(stats.buffers, 16U);
+    EXPECT_EQ(stats.samples, 1U);
+    poller.stop();
+}
+
+TEST(StatsPollerTest, Running_SamplesPeriodically) {
+    std::atomic<std::uint64_t> lost{0};
+    StatsPoller poller;
+    poller.start([&lost](SessionStats& out) {
+        out.events_lost = lost.fetch_add(1) + 1;
+        return true;
+    }, 1ms);
+
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (poller.latest().samples < 5 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+    }
+    EXPECT_GE(poller.latest().samples, 5U);
+    poller.stop();
+}
+
+TEST(StatsPollerTest, Stop_TakesFinalSampleAndKeepsIt) {
+    std::atomic<std::uint64_t> lost{10};
+    StatsPoller poller;
+    poller.start([&lost](SessionStats& out) {
+        out.events_lost = lost.load();
+        return true;
+    }, 1h);
+
+    lost.store(42);
+    poller.stop();  // Returns promptly although the interval is an hour
+
+    EXPECT_EQ(poller.latest().events_lost, 42U);
+    EXPECT_EQ(poller.latest().samples, 2U);
+}
+
+TEST(StatsPollerTest, FailedQuery_KeepsPreviousSample) {
+    std::atomic<bool> fail{false};
+    StatsPoller poller;
+    poller.start([&fail](SessionStats& out) {
+        out.buffers_written = 7;
+        return !fail.load();
+    }, 1h);
+
+    fail.store(true);
+    poller.stop();
+
+    EXPECT_EQ(poller.latest().buffers_written, 7U);
+    EXPECT_EQ(poller.latest().samples, 1U);
+}
+
+TEST(StatsPollerTest, Restart_ResetsCounters) {
+    StatsPoller poller;
+    poller.start([](SessionStats& out) {
+        out.events_lost = 5;
+        return true;
+    }, 1h);
+    poller.start([](SessionStats& out) {
+        out.events_lost = 0;
+        return true;
+    }, 1h);
+
+    EXPECT_EQ(poller.latest().events_lost, 0U);
+    EXPECT_EQ(poller.latest().samples, 1U);
+    poller.stop();
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,159 @@
+/// @file shard_merger_test.cpp
+/// @brief Tests for the timestamp-ordered merge of ETW session batches.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/ingest_latency.hpp"
+#include "exeray/etw/shard_merger.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace exeray::etw {
+namespace {
+
+using event::PendingEvent;
+using event::Timestamp;
+
+class ShardMergerTest : public ::testing::Test {
+protected:
+    static PendingEvent at(Timestamp ts) {
+        PendingEvent event{};
+        event.category = event::Category::FileSystem;
+        event.parent = event::INVALID_EVENT;
+        event.payload.category = event::Category::FileSystem;
+        event.timestamp = ts;
+        return event;
+    }
+
+    /// Timestamps in graph (push) order.
+    std::vector<Timestamp> pushed() const {
+        std::vector<Timestamp> out;
+        graph_.for_each([&out](event::EventView view) { out.push_back(view.timestamp()); });
+        return out;
+    }
+
+    /// A clock the test controls.
+    ShardMerger::Clock fake_clock() {
+        return [this] { return now_.load(); };
+    }
+
+    Arena arena_{16 * 1024 * 1024};
+    event::StringPool strings_{arena_};
+    event::EventGraph graph_{arena_, strings_, 65536};
+    std::atomic<Timestamp> now_{0};
+};
+
+TEST_F(ShardMergerTest, Submit_SingleShard_PushesInOrder) {
+    ShardMerger merger(graph_, 1, ShardMerger::kDefaultMaxLag, fake_clock());
+    const PendingEvent batch[] = {at(10), at(20), at(30)};
+    merger.submit(0, batch);
+
+    EXPECT_EQ(pushed(), (std::vector<Timestamp>{10, 20, 30}));
+    EXPECT_EQ(merger.pending(), 0U);
+}
+
+TEST_F(ShardMergerTest, Submit_TwoShards_HeldUntilBothPass) {
+    ShardMerger merger(graph_, 2, ShardMerger::kDefaultMaxLag, fake_clock());
+    const PendingEvent first[] = {at(10), at(30), at(50)};
+    merger.submit(0, first);
+    EXPECT_EQ(graph_.count(), 0U);  // Shard 1 has not reported yet
+    EXPECT_EQ(merger.pending(), 3U);
+
+    const PendingEvent second[] = {at(20), at(40)};
+    merger.submit(1, second);
+
+    // Everything up to shard 1's watermark (40) is merged; 50 waits
+    EXPECT_EQ(pushed(), (std::vector<Timestamp>{10, 20, 30, 40}));
+    EXPECT_EQ(merger.pending(), 1U);
+}
+
+TEST_F(ShardMergerTest, Submit_IdleShard_ReleasedAfterMaxLag) {
+    ShardMerger merger(graph_, 2, 100, fake_clock());
+    now_ = 150;
+    const PendingEvent batch[] = {at(40), at(60), at(90)};
+    merger.submit(0, batch);
+    EXPECT_EQ(pushed(), (std::vector<Timestamp>{40}));  // Older than now - lag
+
+    now_ = 190;
+    merger.submit(0, {});
+    EXPECT_EQ(pushed(), (std::vector<Timestamp>{40, 60, 90}));
+}
+
+TEST_F(ShardMergerTest, PushNow_ReleasesEarlierEventsFirst) {
+    ShardMerger merger(graph_, 2, ShardMerger::kDefaultMaxLag, fake_clock());
+    const PendingEvent batch[] = {at(10), at(30)};
+    merger.submit(0, batch);
+
+    const event::EventId id = merger.push_now(1, at(20));
+    ASSERT_NE(id, event::INVALID_EVENT);
+    EXPECT_EQ(graph_.get(id).timestamp(), 20U);
+    EXPECT_EQ(pushed(), (std::vector<Timestamp>{10, 20}));
+    EXPECT_EQ(merger.pending(), 1U);
+}
+
+TEST_F(ShardMergerTest, Flush_PushesEverything) {
+    ShardMerger merger(graph_, 3, ShardMerger::kDefaultMaxLag, fake_clock());
+    const PendingEvent first[] = {at(30), at(60)};
+    const PendingEvent second[] = {at(10)};
+    merger.submit(0, first);
+    merger.submit(2, second);
+    ASSERT_EQ(graph_.count(), 0U);
+
+    merger.flush();
+    EXPECT_EQ(pushed(), (std::vector<Timestamp>{10, 30, 60}));
+    EXPECT_EQ(merger.pending(), 0U);
+}
+
+TEST_F(ShardMergerTest, Submit_Concurrent_OrderedAndComplete) {
+    constexpr std::size_t kShards = 4;
+    constexpr Timestamp kPerShard = 2000;
+    ShardMerger merger(graph_, kShards, ShardMerger::kDefaultMaxLag, fake_clock());
+
+    std::vector<std::thread> threads;
+    for (std::size_t shard = 0; shard < kShards; ++shard) {
+        threads.emplace_back([&merger, shard] {
+            std::vector<PendingEvent> batch;
+            for (Timestamp i = 0; i < kPerShard; ++i) {
+                batch.push_back(at(i * kShards + shard + 1));
+                if (batch.size() == 50) {
+                    merger.submit(shard, batch);
+                    batch.clear();
+                }
+            }
+            merger.submit(shard, batch);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    merger.flush();
+
+    const auto order = pushed();
+    ASSERT_EQ(order.size(), kShards * kPerShard);
+    EXPECT_TRUE(std::is_sorted(order.begin(), order.end()));
+}
+
+TEST_F(ShardMergerTest, Latency_RecordsAgeAtRelease) {
+    IngestLatency latency;
+    ShardMerger merger(graph_, 2, ShardMerger::kDefaultMaxLag, fake_clock());
+    merger.set_latency(&latency);
+    now_ = 1000;
+
+    const PendingEvent first[] = {at(100)};
+    merger.submit(0, first);
+    EXPECT_EQ(latency.summary(LatencyStage::Visible, event::Category::FileSystem).count, 0U);
+
+    const PendingEvent second[] = {at(200)};
+    merger.submit(1, second);
+    const LatencySummary visible =
+        latency.summary(LatencyStage::Visible, event::Category::FileSystem);
+    EXPECT_EQ(visible.count, 1U);  // First of kSampleEvery events
+    EXPECT_EQ(visible.p50, LatencyHistogram::upper_bound(LatencyHistogram::bucket_of(900)));
+}
+
+}  // namespace
+}  // namespace exeray::etw
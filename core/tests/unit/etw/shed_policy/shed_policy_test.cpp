@@ -0,0 +1,174 @@
+/// @file shed_policy_test.cpp
+/// @brief Tests for priority-based load shedding in the ETW consumer.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/shed_policy.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace exeray::etw {
+namespace {
+
+using event::Category;
+
+event::EventPayload payload_of(Category category) {
+    event::EventPayload payload{};
+    payload.category = category;
+    return payload;
+}
+
+template <typename Op>
+constexpr std::uint8_t op(Op value) {
+    return static_cast<std::uint8_t>(value);
+}
+
+/// Events kept out of n admitted at one pressure.
+std::size_t kept(ShedPolicy& policy, const event::EventPayload& payload, std::uint8_t operation,
+                 std::uint8_t pressure, std::size_t n) {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        count += policy.admit(payload, operation, pressure) ? 1 : 0;
+    }
+    return count;
+}
+
+TEST(ShedPolicyTest, Defaults_Priorities) {
+    const ShedPolicy policy;
+    EXPECT_EQ(policy.priority(payload_of(Category::FileSystem), op(event::FileOp::Read)),
+              ShedPriority::Low);
+    EXPECT_EQ(policy.priority(payload_of(Category::FileSystem), op(event::FileOp::Write)),
+              ShedPriority::Low);
+    EXPECT_EQ(policy.priority(payload_of(Category::FileSystem), op(event::FileOp::Delete)),
+              ShedPriority::Normal);
+    EXPECT_EQ(policy.priority(payload_of(Category::Network), op(event::NetworkOp::Send)),
+              ShedPriority::Low);
+    EXPECT_EQ(policy.priority(payload_of(Category::Network), op(event::NetworkOp::Connect)),
+              ShedPriority::Normal);
+    EXPECT_EQ(policy.priority(payload_of(Category::Process), op(event::ProcessOp::Terminate)),
+              ShedPriority::Critical);
+    EXPECT_EQ(policy.priority(payload_of(Category::Amsi), 0), ShedPriority::Critical);
+    EXPECT_EQ(policy.priority(payload_of(Category::Script), 0), ShedPriority::Critical);
+    EXPECT_EQ(policy.priority(payload_of(Category::Thread), op(event::ThreadOp::Start)),
+              ShedPriority::Normal);
+}
+
+TEST(ShedPolicyTest, Priority_RemoteThread_Critical) {
+    const ShedPolicy policy;
+    auto payload = payload_of(Category::Thread);
+    payload.thread.is_remote = 1;
+    EXPECT_EQ(policy.priority(payload, op(event::ThreadOp::Start)), ShedPriority::Critical);
+}
+
+TEST(ShedPolicyTest, Admit_LowPressure_KeepsAll) {
+    ShedPolicy policy;
+    const auto read = payload_of(Category::FileSystem);
+    EXPECT_EQ(kept(policy, read, op(event::FileOp::Read), 49, 100), 100U);
+    EXPECT_EQ(policy.stats().total, 0U);
+}
+
+TEST(ShedPolicyTest, Admit_SamplePressure_SamplesLowOnly) {
+    ShedPolicy policy;
+    const auto file = payload_of(Category::FileSystem);
+    EXPECT_EQ(kept(policy, file, op(event::FileOp::Read), 60, 80), 10U);  // 1 in 8
+    EXPECT_EQ(kept(policy, file, op(event::FileOp::Delete), 60, 80), 80U);
+
+    const auto stats = policy.stats();
+    EXPECT_EQ(stats.of(Category::FileSystem), 70U);
+    EXPECT_EQ(stats.total, 70U);
+}
+
+TEST(ShedPolicyTest, Admit_DropPressure_DropsLowSamplesNormal) {
+    ShedPolicy policy;
+    const auto net = payload_of(Category::Network);
+    EXPECT_EQ(kept(policy, net, op(event::NetworkOp::Receive), 90, 40), 0U);
+    EXPECT_EQ(kept(policy, payload_of(Category::Registry), 0, 90, 40), 5U);
+    EXPECT_EQ(kept(policy, payload_of(Category::Process), 0, 100, 40), 40U);
+
+    const auto stats = policy.stats();
+    EXPECT_EQ(stats.of(Category::Network), 40U);
+    EXPECT_EQ(stats.of(Category::Registry), 35U);
+    EXPECT_EQ(stats.of(Category::Process), 0U);
+}
+
+TEST(ShedPolicyTest, Rules_OverrideDefaults) {
+    ShedConfig config;
+    config.rules = {
+        {Category::Registry, ShedRule::kAnyOperation, ShedPriority::Low},
+        {Category::Registry, 3, ShedPriority::Critical},
+        {Category::FileSystem, op(event::FileOp::Read), ShedPriority::Critical},
+    };
+    ShedPolicy policy(config);
+
+    EXPECT_EQ(policy.priority(payload_of(Category::Registry), 0), ShedPriority::Low);
+    EXPECT_EQ(policy.priority(payload_of(Category::Registry), 3), ShedPriority::Critical);
+    EXPECT_EQ(policy.priority(payload_of(Category::FileSystem), op(event::FileOp::Read)),
+              ShedPriority::Critical);
+    EXPECT_EQ(policy.priority(payload_of(Category::FileSystem), op(event::FileOp::Write)),
+              ShedPriority::Low);
+}
+
+TEST(ShedPolicyTest, Thresholds_Configurable) {
+    ShedConfig config;
+    config.sample_percent = 10;
+    config.drop_percent = 20;
+    config.sample_every = 2;
+    ShedPolicy policy(config);
+    const auto file = payload_of(Category::FileSystem);
+
+    EXPECT_EQ(kept(policy, file, op(event::FileOp::Write), 15, 10), 5U);
+    EXPECT_EQ(kept(policy, file, op(event::FileOp::Write), 20, 10), 0U);
+}
+
+TEST(ShedPolicyTest, SetThresholds_AppliesAndOrders) {
+    ShedPolicy policy;
+    const auto file = payload_of(Category::FileSystem);
+
+    policy.set_thresholds(30, 10);
+
+    EXPECT_EQ(policy.sample_percent(), 30U);
+    EXPECT_EQ(policy.drop_percent(), 30U);  // Raised to the sample threshold
+    EXPECT_EQ(kept(policy, file, op(event::FileOp::Read), 35, 16), 0U);
+    EXPECT_EQ(kept(policy, file, op(event::FileOp::Read), 25, 16), 16U);
+}
+
+TEST(ShedPolicyTest, ResetStats_ZeroesCounters) {
+    ShedPolicy policy;
+    ASSERT_EQ(kept(policy, payload_of(Category::Network), op(event::NetworkOp::Send), 99, 10), 0U);
+    ASSERT_EQ(policy.stats().total, 10U);
+
+    policy.reset_stats();
+    EXPECT_EQ(policy.stats().total, 0U);
+}
+
+TEST(ShedPolicyTest, Admit_Concurrent_CountsEveryEvent) {
+    constexpr int kThreads = 4;
+    constexpr std::size_t kEvents = 4000;
+    ShedPolicy policy;
+    std::atomic<std::size_t> total_kept{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&policy, &total_kept] {
+            total_kept += kept(policy, payload_of(Category::Registry), 0, 85, kEvents);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(total_kept.load() + policy.stats().total, kThreads * kEvents);
+    EXPECT_EQ(total_kept.load(), kThreads * kEvents / 8);
+}
+
+TEST(ShedPolicyTest, PressurePercent_Clamped) {
+    EXPECT_EQ(pressure_percent(0, 0), 0U);
+    EXPECT_EQ(pressure_percent(1, 4), 25U);
+    EXPECT_EQ(pressure_percent(9, 4), 100U);
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,177 @@
+/// @file stack_symbolizer_test.cpp
+/// @brief Tests for PE export parsing and stack symbolization.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/module_map.hpp"
+#include "exeray/etw/stack_symbolizer.hpp"
+#include "exeray/event/string_pool.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace exeray::etw {
+namespace {
+
+template <typename T>
+void put(std::vector<std::uint8_t>& image, std::size_t offset, T value) {
+    std::memcpy(image.data() + offset, &value, sizeof(T));
+}
+
+void put_name(std::vector<std::uint8_t>& image, std::size_t offset, std::string_view name) {
+    std::memcpy(image.data() + offset, name.data(), name.size());
+}
+
+/**
+ * @brief Smallest PE32+ image with an export directory.
+ *
+ * One section maps RVAs 0x200-0x3FF to the same file offsets. Exports:
+ * Beta at 0x1000, Alpha at 0x1400 and Fwd, forwarded to another image.
+ */
+std::vector<std::uint8_t> make_image() {
+    std::vector<std::uint8_t> image(0x400, 0);
+    put<std::uint16_t>(image, 0, 0x5A4D);         // MZ
+    put<std::uint32_t>(image, 0x3C, 0x40);        // e_lfanew
+    put<std::uint32_t>(image, 0x40, 0x00004550);  // PE\0\0
+    put<std::uint16_t>(image, 0x44, 0x8664);      // Machine
+    put<std::uint16_t>(image, 0x46, 1);           // NumberOfSections
+    put<std::uint16_t>(image, 0x54, 0xF0);        // SizeOfOptionalHeader
+    put<std::uint16_t>(image, 0x58, 0x20B);       // PE32+
+    put<std::uint32_t>(image, 0x58 + 108, 16);    // NumberOfRvaAndSizes
+    put<std::uint32_t>(image, 0x58 + 112, 0x200); // Export directory RVA
+    put<std::uint32_t>(image, 0x58 + 116, 0x100); // and size
+
+    const std::size_t section = 0x58 + 0xF0;
+    put<std::uint32_t>(image, section + 8, 0x200);   // VirtualSize
+    put<std::uint32_t>(image, section + 12, 0x200);  // VirtualAddress
+    put<std::uint32_t>(image, section + 16, 0x200);  // SizeOfRawData
+    put<std::uint32_t>(image, section + 20, 0x200);  // PointerToRawData
+
+    put<std::uint32_t>(image, 0x200 + 20, 3);      // NumberOfFunctions
+    put<std::uint32_t>(image, 0x200 + 24, 3);      // NumberOfNames
+    put<std::uint32_t>(image, 0x200 + 28, 0x240);  // AddressOfFunctions
+    put<std::uint32_t>(image, 0x200 + 32, 0x250);  // AddressOfNames
+    put<std::uint32_t>(image, 0x200 + 36, 0x260);  // AddressOfNameOrdinals
+
+    put<std::uint32_t>(image, 0x240, 0x1000);
+    put<std::uint32_t>(image, 0x244, 0x1400);
+    put<std::uint32_t>(image, 0x248, 0x2A0);  // Inside the export directory
+    put<std::uint32_t>(image, 0x250, 0x270);
+    put<std::uint32_t>(image, 0x254, 0x280);
+    put<std::uint32_t>(image, 0x258, 0x290);
+    put<std::uint16_t>(image, 0x260, 1);
+    put<std::uint16_t>(image, 0x262, 0);
+    put<std::uint16_t>(image, 0x264, 2);
+    put_name(image, 0x270, "Alpha");
+    put_name(image, 0x280, "Beta");
+    put_name(image, 0x290, "Fwd");
+    put_name(image, 0x2A0, "other.Fwd");
+    return image;
+}
+
+TEST(PeExportsTest, ParsesNamedExportsSortedByRva) {
+    const auto exports = parse_pe_exports(make_image());
+    ASSERT_EQ(exports.size(), 2u);
+    EXPECT_EQ(exports[0].name, "Beta");
+    EXPECT_EQ(exports[0].rva, 0x1000u);
+    EXPECT_EQ(exports[1].name, "Alpha");
+    EXPECT_EQ(exports[1].rva, 0x1400u);
+}
+
+TEST(PeExportsTest, RejectsTruncatedAndForeignFiles) {
+    auto image = make_image();
+    EXPECT_TRUE(parse_pe_exports(std::span(image).first(0x100)).empty());
+    EXPECT_TRUE(parse_pe_exports({}).empty());
+    image[0] = 'X';
+    EXPECT_TRUE(parse_pe_exports(image).empty());
+}
+
+class StackSymbolizerTest : public ::testing::Test {
+protected:
+    static constexpr std::uint64_t kBase = 0x7FF700000000ULL;
+    static constexpr std::uint64_t kKernel = 0xFFFFF80000000000ULL;
+
+    Arena arena_{4 * 1024 * 1024};
+    event::StringPool strings_{arena_};
+    ModuleMap modules_;
+    std::filesystem::path dir_;
+
+    void SetUp() override {
+        dir_ = std::filesystem::temp_directory_path() /
+               ("exeray_stacks_" +
+                std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::filesystem::remove_all(dir_);
+        std::filesystem::create_directories(dir_);
+    }
+
+    void TearDown() override {
+        std::error_code error;
+        std::filesystem::remove_all(dir_, error);
+    }
+
+    event::StringId write_image(std::string_view name) {
+        const auto path = dir_ / name;
+        const auto image = make_image();
+        std::ofstream(path, std::ios::binary)
+            .write(reinterpret_cast<const char*>(image.data()),
+                   static_cast<std::streamsize>(image.size()));
+        return strings_.intern_path(path.string());
+    }
+};
+
+TEST_F(StackSymbolizerTest, ResolvesModulesAndNearestExports) {
+    const event::StringId dll = write_image("sample.dll");
+    const event::StringId driver = strings_.intern_path((dir_ / "missing.sys").string());
+    modules_.load(100, kBase, 0x10000, dll);
+    modules_.load(4, kKernel, 0x10000, driver);
+
+    StackSymbolizer symbolizer(modules_, strings_);
+    const std::uint64_t frames[] = {kBase + 0x1010, kBase + 0x1500, kBase + 0x500, 0x12345,
+                                    kKernel + 0x20};
+    const auto resolved = symbolizer.symbolize(100, frames);
+    ASSERT_EQ(resolved.size(), 5u);
+
+    EXPECT_EQ(resolved[0].module, dll);
+    EXPECT_EQ(resolved[0].function, "Beta");
+    EXPECT_EQ(resolved[0].displacement, 0x10u);
+    EXPECT_EQ(resolved[1].function, "Alpha");
+    EXPECT_EQ(resolved[1].displacement, 0x100u);
+    // Below the first export: the module and offset only
+    EXPECT_EQ(resolved[2].module, dll);
+    EXPECT_EQ(resolved[2].offset, 0x500u);
+    EXPECT_TRUE(resolved[2].function.empty());
+    // Outside every module
+    EXPECT_EQ(resolved[3].module, event::INVALID_STRING);
+    EXPECT_EQ(resolved[3].address, 0x12345u);
+    // Kernel frames resolve against the System process
+    EXPECT_TRUE(resolved[4].kernel);
+    EXPECT_EQ(resolved[4].module, driver);
+    EXPECT_TRUE(resolved[4].function.empty());
+
+    EXPECT_EQ(symbolizer.cached_modules(), 2u);
+}
+
+TEST_F(StackSymbolizerTest, ExportTablesAreReadOncePerModule) {
+    const event::StringId dll = write_image("sample.dll");
+    modules_.load(100, kBase, 0x10000, dll);
+    StackSymbolizer symbolizer(modules_, strings_);
+
+    const std::uint64_t frames[] = {kBase + 0x1010};
+    EXPECT_EQ(symbolizer.symbolize(100, frames)[0].function, "Beta");
+    // Served from the cache: the file is gone
+    std::filesystem::remove(dir_ / "sample.dll");
+    EXPECT_EQ(symbolizer.symbolize(100, frames)[0].function, "Beta");
+
+    symbolizer.clear();
+    EXPECT_EQ(symbolizer.cached_modules(), 0u);
+    EXPECT_TRUE(symbolizer.symbolize(100, frames)[0].function.empty());
+}
+
+}  // namespace
+}  // namespace exeray::etw
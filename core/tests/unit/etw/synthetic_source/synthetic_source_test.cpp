@@ -0,0 +1,194 @@
+/// @file synthetic_source_test.cpp
+/// @brief Tests for generated ParsedEvent streams and their delivery.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/consumer.hpp"
+#include "exeray/etw/parser.hpp"
+#include "exeray/etw/synthetic_source.hpp"
+#include "exeray/event/correlator.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/string_pool.hpp"
+
+#include <cstring>
+#include <set>
+#include <vector>
+
+namespace exeray::etw {
+namespace {
+
+using event::Category;
+using event::ProcessOp;
+
+constexpr auto kRundown = static_cast<std::uint8_t>(ProcessOp::Rundown);
+constexpr auto kCreate = static_cast<std::uint8_t>(ProcessOp::Create);
+constexpr auto kTerminate = static_cast<std::uint8_t>(ProcessOp::Terminate);
+
+SyntheticConfig small_config() {
+    SyntheticConfig config;
+    config.processes = 20;
+    config.strings = 100;
+    return config;
+}
+
+/// @brief Next event with its deferred strings interned into pool.
+ParsedEvent next_interned(SyntheticSource& source, event::StringPool& pool) {
+    ParsedEvent parsed = source.next(1);
+    parsed.deferred.commit(parsed.payload, pool);
+    return parsed;
+}
+
+TEST(SyntheticSourceTest, SameSeed_SameStream) {
+    SyntheticSource first(small_config());
+    SyntheticSource second(small_config());
+    for (int i = 0; i < 2000; ++i) {
+        const ParsedEvent a = first.next(i);
+        const ParsedEvent b = second.next(i);
+        ASSERT_EQ(a.category, b.category);
+        ASSERT_EQ(a.operation, b.operation);
+        ASSERT_EQ(a.pid, b.pid);
+        ASSERT_EQ(std::memcmp(&a.payload, &b.payload, sizeof(a.payload)), 0);
+        ASSERT_EQ(a.deferred.size(), b.deferred.size());
+    }
+}
+
+TEST(SyntheticSourceTest, StartsWithRundownOfEveryProcess) {
+    SyntheticSource source(small_config());
+    std::set<std::uint32_t> pids;
+    for (int i = 0; i < 20; ++i) {
+        const ParsedEvent parsed = source.next(1);
+        ASSERT_TRUE(parsed.valid);
+        ASSERT_EQ(parsed.category, Category::Process);
+        ASSERT_EQ(parsed.operation, kRundown);
+        EXPECT_EQ(parsed.payload.process.pid % 4, 0U);
+        EXPECT_GT(parsed.payload.process.pid, 4U);
+        EXPECT_EQ(parsed.deferred.size(), 2U);  // Image path and command line
+        pids.insert(parsed.payload.process.pid);
+    }
+    EXPECT_EQ(pids.size(), 20U);
+    const ParsedEvent after = source.next(1);
+    EXPECT_FALSE(after.category == Category::Process && after.operation == kRundown);
+}
+
+TEST(SyntheticSourceTest, Mix_OnlyWeightedCategories) {
+    SyntheticConfig config = small_config();
+    config.mix = {};
+    config.mix[static_cast<std::size_t>(Category::Registry)] = 3;
+    config.mix[static_cast<std::size_t>(Category::Dns)] = 1;
+    config.churn = 0;
+    SyntheticSource source(config);
+    for (int i = 0; i < 20; ++i) {
+        (void)source.next(1);
+    }
+
+    int registry = 0;
+    int dns = 0;
+    for (int i = 0; i < 4000; ++i) {
+        const ParsedEvent parsed = source.next(1);
+        ASSERT_TRUE(parsed.category == Category::Registry || parsed.category == Category::Dns);
+        (parsed.category == Category::Registry ? registry : dns)++;
+    }
+    EXPECT_NEAR(static_cast<double>(registry) / 4000.0, 0.75, 0.05);
+    EXPECT_GT(dns, 0);
+}
+
+TEST(SyntheticSourceTest, Churn_ReplacesTerminatedProcess) {
+    SyntheticConfig config = small_config();
+    config.churn = 100;
+    SyntheticSource source(config);
+    std::set<std::uint32_t> running;
+    for (int i = 0; i < 20; ++i) {
+        running.insert(source.next(1).payload.process.pid);
+    }
+
+    for (int i = 0; i < 5000; ++i) {
+        const ParsedEvent parsed = source.next(1);
+        if (parsed.category != Category::Process) {
+            ASSERT_TRUE(running.count(parsed.pid)) << "event of a process not running";
+            continue;
+        }
+        ASSERT_EQ(parsed.operation, kTerminate);
+        ASSERT_EQ(running.erase(parsed.payload.process.pid), 1U);
+
+        // The replacement follows right away, started by a running process
+        const ParsedEvent created = source.next(1);
+        ASSERT_EQ(created.category, Category::Process);
+        ASSERT_EQ(created.operation, kCreate);
+        EXPECT_TRUE(running.count(created.payload.process.parent_pid) ||
+                    created.payload.process.parent_pid == parsed.payload.process.pid);
+        EXPECT_EQ(created.pid, created.payload.process.parent_pid);
+        ASSERT_TRUE(running.insert(created.payload.process.pid).second);
+    }
+    EXPECT_EQ(running.size(), 20U);
+    EXPECT_GT(source.started(), 300U);
+}
+
+TEST(SyntheticSourceTest, NoChurn_NoProcessEventsAfterRundown) {
+    SyntheticConfig config = small_config();
+    config.churn = 0;
+    SyntheticSource source(config);
+    for (int i = 0; i < 5020; ++i) {
+        const ParsedEvent parsed = source.next(1);
+        if (i >= 20) {
+            ASSERT_NE(parsed.category, Category::Process);
+        }
+    }
+    EXPECT_EQ(source.started(), 0U);
+    EXPECT_EQ(source.produced(), 5020U);
+}
+
+TEST(SyntheticSourceTest, Strings_BoundedBySetting) {
+    Arena arena(16 << 20);
+    event::StringPool pool(arena);
+    SyntheticConfig config = small_config();
+    config.mix = {};
+    config.mix[static_cast<std::size_t>(Category::FileSystem)] = 1;
+    config.churn = 0;
+    config.strings = 50;
+    SyntheticSource source(config);
+    for (int i = 0; i < 20; ++i) {
+        (void)next_interned(source, pool);
+    }
+
+    std::set<event::StringId> paths;
+    for (int i = 0; i < 5000; ++i) {
+        const ParsedEvent parsed = next_interned(source, pool);
+        ASSERT_NE(parsed.payload.file.path, event::INVALID_STRING);
+        paths.insert(parsed.payload.file.path);
+    }
+    EXPECT_LE(paths.size(), 50U);
+    EXPECT_GT(paths.size(), 25U);  // Skewed, but the tail is reached
+}
+
+TEST(SyntheticSourceTest, Feed_CorrelatesAndStoresEveryEvent) {
+    Arena arena(64 << 20);
+    event::StringPool pool(arena);
+    event::EventGraph graph(arena, pool, 1 << 16);
+    event::Correlator correlator;
+    ConsumerContext ctx;
+    ctx.graph = &graph;
+    ctx.strings = &pool;
+    ctx.correlator = &correlator;
+    ctx.clock = ClockDomain::capture();
+
+    SyntheticConfig config = small_config();
+    config.churn = 20;
+    config.buffer_events = 100;
+    SyntheticSource source(config);
+    EXPECT_EQ(source.feed(ctx, 1050), 1050U);
+
+    EXPECT_EQ(graph.count(), 1050U);
+    EXPECT_EQ(ctx.buffers_read.load(), 11U);
+    std::size_t uncorrelated = 0;
+    event::Timestamp last = 0;
+    graph.for_each([&](event::EventView view) {
+        uncorrelated += view.correlation_id() == 0 ? 1 : 0;
+        EXPECT_GE(view.timestamp(), last);
+        last = view.timestamp();
+    });
+    EXPECT_EQ(uncorrelated, 0U);
+}
+
+}  // namespace
+}  // namespace exeray::etw
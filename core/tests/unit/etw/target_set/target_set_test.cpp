@@ -0,0 +1,122 @@
+/// @file target_set_test.cpp
+/// @brief Tests for the lock-free target process set.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/target_set.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace exeray::etw {
+namespace {
+
+TEST(TargetSetTest, BitmapAndTablePids) {
+    auto set = std::make_unique<TargetSet>();
+    EXPECT_TRUE(set->empty());
+    EXPECT_TRUE(set->insert(1000));                       // Bitmap
+    EXPECT_TRUE(set->insert(TargetSet::kBitmapPids + 8));  // Large: table
+    EXPECT_TRUE(set->insert(1001));                       // Not a multiple of four: table
+    EXPECT_TRUE(set->insert(1000));                       // Already a member
+    EXPECT_EQ(set->size(), 3U);
+
+    EXPECT_TRUE(set->contains(1000));
+    EXPECT_TRUE(set->contains(TargetSet::kBitmapPids + 8));
+    EXPECT_TRUE(set->contains(1001));
+    EXPECT_FALSE(set->contains(1004));
+    EXPECT_FALSE(set->contains(TargetSet::kBitmapPids + 12));
+    EXPECT_EQ(set->pids(),
+              (std::vector<std::uint32_t>{1000, 1001, TargetSet::kBitmapPids + 8}));
+}
+
+TEST(TargetSetTest, UnknownPids_NeverMembers) {
+    auto set = std::make_unique<TargetSet>();
+    EXPECT_FALSE(set->insert(0));
+    EXPECT_FALSE(set->insert(0xFFFFFFFFU));
+    EXPECT_FALSE(set->contains(0));
+    EXPECT_FALSE(set->contains(0xFFFFFFFFU));
+    EXPECT_TRUE(set->empty());
+}
+
+TEST(TargetSetTest, Erase_KeepsLaterProbesReachable) {
+    auto set = std::make_unique<TargetSet>();
+    // Odd PIDs all go to the table; some of them collide
+    for (std::uint32_t pid = 1; pid < 400; pid += 2) {
+        ASSERT_TRUE(set->insert(pid));
+    }
+    for (std::uint32_t pid = 1; pid < 400; pid += 4) {
+        set->erase(pid);
+    }
+    set->erase(1000);  // Not a member
+    for (std::uint32_t pid = 1; pid < 400; pid += 2) {
+        EXPECT_EQ(set->contains(pid), pid % 4 == 3) << pid;
+    }
+    EXPECT_EQ(set->size(), 100U);
+
+    set->clear();
+    EXPECT_TRUE(set->empty());
+    EXPECT_FALSE(set->contains(3));
+    EXPECT_TRUE(set->insert(1));  // Erased slots are free again
+}
+
+TEST(TargetSetTest, Adopt_FollowsDescendants) {
+    auto set = std::make_unique<TargetSet>();
+    constexpr std::uint32_t kTarget = 1000;
+    ASSERT_TRUE(set->insert(kTarget));
+
+    // cmd.exe -> powershell.exe -> conhost.exe, and an unrelated process
+    EXPECT_TRUE(set->adopt(kTarget, 2000));
+    EXPECT_TRUE(set->adopt(2000, TargetSet::kBitmapPids + 4));
+    EXPECT_FALSE(set->adopt(3000, 3004));
+    EXPECT_FALSE(set->adopt(3004, 3004));
+    EXPECT_TRUE(set->contains(TargetSet::kBitmapPids + 4));
+    EXPECT_FALSE(set->contains(3004));
+
+    // The middle process exits; its PID may be reused by a stranger
+    set->erase(2000);
+    EXPECT_FALSE(set->adopt(2000, 5000));
+    EXPECT_EQ(set->pids(), (std::vector<std::uint32_t>{kTarget, TargetSet::kBitmapPids + 4}));
+}
+
+TEST(TargetSetTest, FullTable_RefusesInsert) {
+    auto set = std::make_unique<TargetSet>();
+    for (std::size_t i = 0; i < TargetSet::kTableSlots; ++i) {
+        ASSERT_TRUE(set->insert(static_cast<std::uint32_t>(2 * i + 1)));
+    }
+    EXPECT_FALSE(set->insert(static_cast<std::uint32_t>(2 * TargetSet::kTableSlots + 1)));
+    EXPECT_TRUE(set->insert(4));  // The bitmap is unaffected
+}
+
+TEST(TargetSetTest, ConcurrentFollowersAndReaders) {
+    auto set = std::make_unique<TargetSet>();
+    constexpr int kThreads = 4;
+    constexpr std::uint32_t kPerThread = 2000;
+    std::atomic<bool> stop{false};
+    std::thread reader([&] {
+        while (!stop.load()) {
+            EXPECT_FALSE(set->contains(2));  // Never inserted
+        }
+    });
+    std::vector<std::thread> writers;
+    for (int t = 0; t < kThreads; ++t) {
+        writers.emplace_back([&set] {
+            // Every thread inserts the same PIDs; each counts once
+            for (std::uint32_t i = 1; i <= kPerThread; ++i) {
+                set->insert(i * 4);
+                set->insert(i * 2 + 1);  // Fills the table
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    stop.store(true);
+    reader.join();
+    EXPECT_EQ(set->size(), kPerThread + TargetSet::kTableSlots);
+}
+
+}  // namespace
+}  // namespace exeray::etw
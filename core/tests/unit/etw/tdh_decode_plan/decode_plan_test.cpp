@@ -0,0 +1,586 @@
+/// @file decode_plan_test.cpp
+/// @brief Tests for compiled TDH decode plans.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/tdh/decode_plan.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace exeray::etw::tdh {
+namespace {
+
+PropertySchema prop(const wchar_t* name, InType type, std::uint16_t length = 0) {
+    PropertySchema schema;
+    schema.name = name;
+    schema.in_type = static_cast<std::uint16_t>(type);
+    schema.length = length;
+    return schema;
+}
+
+/// Little-endian UserData builder.
+class Bytes {
+public:
+    template <typename T>
+    Bytes& put(T value) {
+        const auto* p = reinterpret_cast<const std::uint8_t*>(&value);
+        data_.insert(data_.end(), p, p + sizeof(T));
+        return *this;
+    }
+
+    Bytes& utf16(const char* text, bool terminate = true) {
+        for (; *text != '\0'; ++text) {
+            put<std::uint16_t>(static_cast<std::uint8_t>(*text));
+        }
+        if (terminate) {
+            put<std::uint16_t>(0);
+        }
+        return *this;
+    }
+
+    std::span<const std::uint8_t> span() const { return data_; }
+    std::size_t size() const { return data_.size(); }
+
+private:
+    std::vector<std::uint8_t> data_;
+};
+
+template <typename T>
+T value(const TdhParsedEvent& event, const wchar_t* name) {
+    const TdhPropertyValue* found = event.find(name);
+    EXPECT_NE(found, nullptr) << "missing property";
+    if (found == nullptr || !std::holds_alternative<T>(*found)) {
+        ADD_FAILURE() << "wrong type";
+        return T{};
+    }
+    return std::get<T>(*found);
+}
+
+TEST(DecodePlanTest, Compile_FixedPrefixOffsets) {
+    const std::vector<PropertySchema> schema = {
+        prop(L"ProcessId", InType::UInt32),
+        prop(L"Base", InType::Pointer),
+        prop(L"Flags", InType::UInt16),
+        prop(L"Name", InType::UnicodeString),
+        prop(L"After", InType::UInt32),
+    };
+    const auto plan = DecodePlan::compile(schema);
+    ASSERT_TRUE(plan.has_value());
+
+    EXPECT_EQ(plan->size(), 5U);
+    EXPECT_EQ(plan->fixed_fields(), 3U);
+    EXPECT_EQ(plan->fixed_size(8), 14U);
+    EXPECT_EQ(plan->fixed_size(4), 10U);
+}
+
+TEST(DecodePlanTest, Decode_IntegersAndStrings) {
+    const std::vector<PropertySchema> schema = {
+        prop(L"ProcessId", InType::UInt32),
+        prop(L"Base", InType::Pointer),
+        prop(L"Port", InType::UInt16),
+        prop(L"Delta", InType::Int16),
+        prop(L"FileName", InType::UnicodeString),
+        prop(L"Tail", InType::UInt64),
+    };
+    const auto plan = DecodePlan::compile(schema);
+    ASSERT_TRUE(plan.has_value());
+
+    Bytes data;
+    data.put<std::uint32_t>(1234)
+        .put<std::uint64_t>(0x7FF612340000ULL)
+        .put<std::uint16_t>(443)
+        .put<std::int16_t>(-5)
+        .utf16("C:\\a.txt")
+        .put<std::uint64_t>(99);
+
+    TdhParsedEvent event;
+    EXPECT_TRUE(plan->decode(data.span(), 8, event));
+    ASSERT_EQ(event.size(), 6U);
+    EXPECT_EQ(value<std::uint32_t>(event, L"ProcessId"), 1234U);
+    EXPECT_EQ(value<std::uint64_t>(event, L"Base"), 0x7FF612340000ULL);
+    EXPECT_EQ(value<std::uint32_t>(event, L"Port"), 443U);
+    EXPECT_EQ(value<std::int32_t>(event, L"Delta"), -5);
+    EXPECT_EQ(value<std::wstring_view>(event, L"FileName"), L"C:\\a.txt");
+    EXPECT_EQ(value<std::uint64_t>(event, L"Tail"), 99U);
+}
+
+TEST(DecodePlanTest, Decode_32BitPointers) {
+    const std::vector<PropertySchema> schema = {
+        prop(L"Base", InType::Pointer),
+        prop(L"Size", InType::UInt32),
+    };
+    const auto plan = DecodePlan::compile(schema);
+    ASSERT_TRUE(plan.has_value());
+
+    Bytes data;
+    data.put<std::uint32_t>(0x401000).put<std::uint32_t>(4096);
+    TdhParsedEvent event;
+    EXPECT_TRUE(plan->decode(data.span(), 4, event));
+    EXPECT_EQ(value<std::uint64_t>(event, L"Base"), 0x401000U);
+    EXPECT_EQ(value<std::uint32_t>(event, L"Size"), 4096U);
+}
+
+TEST(DecodePlanTest, Decode_LengthFromProperty) {
+    PropertySchema blob = prop(L"Content", InType::Binary);
+    blob.length_property = 0;
+    PropertySchema name = prop(L"AppName", InType::UnicodeString);
+    name.length_property = 1;
+    const std::vector<PropertySchema> schema = {
+        prop(L"ContentSize", InType::UInt32),
+        prop(L"NameLength", InType::UInt16),
+        blob,
+        name,
+    };
+    const auto plan = DecodePlan::compile(schema);
+    ASSERT_TRUE(plan.has_value());
+
+    Bytes data;
+    data.put<std::uint32_t>(3).put<std::uint16_t>(2);
+    data.put<std::uint8_t>(0xAA).put<std::uint8_t>(0xBB).put<std::uint8_t>(0xCC);
+    data.utf16("ps", false);
+
+    TdhParsedEvent event;
+    EXPECT_TRUE(plan->decode(data.span(), 8, event));
+    const auto content = value<std::span<const std::uint8_t>>(event, L"Content");
+    EXPECT_EQ(std::vector<std::uint8_t>(content.begin(), content.end()),
+              (std::vector<std::uint8_t>{0xAA, 0xBB, 0xCC}));
+    EXPECT_EQ(value<std::wstring_view>(event, L"AppName"), L"ps");
+}
+
+TEST(DecodePlanTest, Decode_SidAndWbemSid) {
+    const std::vector<PropertySchema> schema = {
+        prop(L"UserSid", InType::Sid),
+        prop(L"TokenSid", InType::WbemSid),
+        prop(L"After", InType::UInt32),
+    };
+    const auto plan = DecodePlan::compile(schema);
+    ASSERT_TRUE(plan.has_value());
+    EXPECT_EQ(plan->fixed_fields(), 0U);
+
+    Bytes data;
+    // S-1-5-18 (LocalSystem)
+    data.put<std::uint8_t>(1).put<std::uint8_t>(1);
+    for (std::uint8_t b : {0, 0, 0, 0, 0, 5}) {
+        data.put<std::uint8_t>(b);
+    }
+    data.put<std::uint32_t>(18);
+    // TOKEN_USER (two pointers), then S-1-5-21-7-8
+    data.put<std::uint64_t>(0).put<std::uint64_t>(0);
+    data.put<std::uint8_t>(1).put<std::uint8_t>(3);
+    for (std::uint8_t b : {0, 0, 0, 0, 0, 5}) {
+        data.put<std::uint8_t>(b);
+    }
+    data.put<std::uint32_t>(21).put<std::uint32_t>(7).put<std::uint32_t>(8);
+    data.put<std::uint32_t>(42);
+
+    TdhParsedEvent event;
+    EXPECT_TRUE(plan->decode(data.span(), 8, event));
+    EXPECT_EQ(value<std::wstring_view>(event, L"UserSid"), L"S-1-5-18");
+    EXPECT_EQ(value<std::wstring_view>(event, L"TokenSid"), L"S-1-5-21-7-8");
+    EXPECT_EQ(value<std::uint32_t>(event, L"After"), 42U);
+}
+
+TEST(DecodePlanTest, Decode_GuidAndCountedString) {
+    const std::vector<PropertySchema> schema = {
+        prop(L"Activity", InType::Guid),
+        prop(L"Label", InType::CountedString),
+    };
+    const auto plan = DecodePlan::compile(schema);
+    ASSERT_TRUE(plan.has_value());
+
+    Bytes data;
+    data.put<std::uint32_t>(0x12345678).put<std::uint16_t>(0x9ABC).put<std::uint16_t>(0xDEF0);
+    for (std::uint8_t b : {1, 2, 3, 4, 5, 6, 7, 8}) {
+        data.put<std::uint8_t>(b);
+    }
+    data.put<std::uint16_t>(6).utf16("abc", false);
+
+    TdhParsedEvent event;
+    EXPECT_TRUE(plan->decode(data.span(), 8, event));
+    EXPECT_EQ(value<std::wstring_view>(event, L"Activity"), L"{12345678-9ABC-DEF0-0102-030405060708}");
+    EXPECT_EQ(value<std::wstring_view>(event, L"Label"), L"abc");
+}
+
+TEST(DecodePlanTest, Decode_Truncated_KeepsEarlierFieldsAndOrdinals) {
+    const std::vector<PropertySchema> schema = {
+        prop(L"ProcessId", InType::UInt32),
+        prop(L"ThreadId", InType::UInt32),
+        prop(L"Name", InType::UnicodeString),
+    };
+    const auto plan = DecodePlan::compile(schema);
+    ASSERT_TRUE(plan.has_value());
+
+    Bytes data;
+    data.put<std::uint32_t>(7).put<std::uint16_t>(1);  // ThreadId cut short
+
+    TdhParsedEvent event;
+    EXPECT_FALSE(plan->decode(data.span(), 8, event));
+    ASSERT_EQ(event.size(), 3U);
+    EXPECT_EQ(value<std::uint32_t>(event, L"ProcessId"), 7U);
+    EXPECT_TRUE(std::holds_alternative<std::monostate>(*event.at(1)));
+    EXPECT_TRUE(std::holds_alternative<std::monostate>(*event.at(2)));
+    EXPECT_EQ(event.properties()[2].name, L"Name");
+}
+
+TEST(DecodePlanTest, Decode_UnterminatedString_TakesRest) {
+    const std::vector<PropertySchema> schema = {prop(L"Name", InType::UnicodeString)};
+    const auto plan = DecodePlan::compile(schema);
+    ASSERT_TRUE(plan.has_value());
+
+    Bytes data;
+    data.utf16("abc", false);
+    TdhParsedEvent event;
+    EXPECT_TRUE(plan->decode(data.span(), 8, event));
+    EXPECT_EQ(value<std::wstring_view>(event, L"Name"), L"abc");
+}
+
+PropertySchema structure(const wchar_t* name, std::uint16_t start, std::uint16_t members) {
+    PropertySchema schema;
+    schema.name = name;
+    schema.struct_start = start;
+    schema.struct_members = members;
+    return schema;
+}
+
+TEST(DecodePlanTest, Decode_Struct_MembersAtTheirOrdinals) {
+    // Header { Pid, Name }, then Tail; members follow the top level
+    const std::vector<PropertySchema> schema = {
+        structure(L"Header", 2, 2),
+        prop(L"Tail", InType::UInt16),
+        prop(L"Pid", InType::UInt32),
+        prop(L"Name", InType::UnicodeString),
+    };
+    const auto plan = DecodePlan::compile(schema, 2);
+    ASSERT_TRUE(plan.has_value());
+    EXPECT_EQ(plan->size(), 4U);
+
+    Bytes data;
+    data.put<std::uint32_t>(42).utf16("ab").put<std::uint16_t>(7);
+    TdhParsedEvent event;
+    EXPECT_TRUE(plan->decode(data.span(), 8, event));
+    ASSERT_EQ(event.size(), 4U);
+    EXPECT_EQ(value<std::uint32_t>(event, L"Pid"), 42U);
+    EXPECT_EQ(value<std::wstring_view>(event, L"Name"), L"ab");
+    EXPECT_EQ(value<std::uint32_t>(event, L"Tail"), 7U);
+    EXPECT_EQ(value<std::span<const std::uint8_t>>(event, L"Header").size(), 10U);
+    EXPECT_EQ(event.properties()[2].name, L"Pid");
+}
+
+TEST(DecodePlanTest, Decode_FixedArray_ViewsElements) {
+    PropertySchema items = prop(L"Items", InType::UInt32);
+    items.count = 3;
+    const std::vector<PropertySchema> schema = {items, prop(L"After", InType::UInt8)};
+    const auto plan = DecodePlan::compile(schema);
+    ASSERT_TRUE(plan.has_value());
+    EXPECT_EQ(plan->fixed_fields(), 2U);
+    EXPECT_EQ(plan->fixed_size(8), 13U);
+
+    Bytes data;
+    data.put<std::uint32_t>(1).put<std::uint32_t>(2).put<std::uint32_t>(3).put<std::uint8_t>(9);
+    TdhParsedEvent event;
+    EXPECT_TRUE(plan->decode(data.span(), 8, event));
+    const auto array = value<TdhArray>(event, L"Items");
+    EXPECT_EQ(array.count, 3U);
+    EXPECT_EQ(array.element_size, 4U);
+    EXPECT_EQ(array.in_type, static_cast<std::uint16_t>(InType::UInt32));
+    ASSERT_EQ(array.element(2).size(), 4U);
+    std::uint32_t third = 0;
+    std::memcpy(&third, array.element(2).data(), sizeof(third));
+    EXPECT_EQ(third, 3U);
+    EXPECT_EQ(value<std::uint32_t>(event, L"After"), 9U);
+}
+
+TEST(DecodePlanTest, Decode_CountedArray_UsesCountProperty) {
+    PropertySchema items = prop(L"Items", InType::UInt16);
+    items.count_property = 0;
+    const std::vector<PropertySchema> schema = {
+        prop(L"Count", InType::UInt8), items, prop(L"After", InType::UInt8)};
+    const auto plan = DecodePlan::compile(schema);
+    ASSERT_TRUE(plan.has_value());
+    EXPECT_EQ(plan->fixed_fields(), 1U);
+
+    Bytes data;
+    data.put<std::uint8_t>(2).put<std::uint16_t>(10).put<std::uint16_t>(20).put<std::uint8_t>(5);
+    TdhParsedEvent event;
+    EXPECT_TRUE(plan->decode(data.span(), 8, event));
+    const auto array = value<TdhArray>(event, L"Items");
+    EXPECT_EQ(array.count, 2U);
+    EXPECT_EQ(array.bytes.size(), 4U);
+    EXPECT_EQ(value<std::uint32_t>(event, L"After"), 5U);
+}
+
+TEST(DecodePlanTest, Decode_CountedArray_CountPastData_False) {
+    PropertySchema items = prop(L"Items", InType::UInt32);
+    items.count_property = 0;
+    const std::vector<PropertySchema> schema = {prop(L"Count", InType::UInt32), items};
+    const auto plan = DecodePlan::compile(schema);
+    ASSERT_TRUE(plan.has_value());
+
+    Bytes data;
+    data.put<std::uint32_t>(1000000).put<std::uint32_t>(1);
+    TdhParsedEvent event;
+    EXPECT_FALSE(plan->decode(data.span(), 8, event));
+    EXPECT_TRUE(std::holds_alternative<std::monostate>(*event.at(1)));
+}
+
+TEST(DecodePlanTest, Decode_VariableStructArray_SpansAllElements) {
+    // Entries[Count] of { Id, Name }; members are not stored per element
+    PropertySchema entries = structure(L"Entries", 3, 2);
+    entries.count_property = 0;
+    const std::vector<PropertySchema> schema = {
+        prop(L"Count", InType::UInt16),
+        entries,
+        prop(L"After", InType::UInt32),
+        prop(L"Id", InType::UInt32),
+        prop(L"Name", InType::UnicodeString),
+    };
+    const auto plan = DecodePlan::compile(schema, 3);
+    ASSERT_TRUE(plan.has_value());
+
+    Bytes data;
+    data.put<std::uint16_t>(2);
+    data.put<std::uint32_t>(1).utf16("a");
+    data.put<std::uint32_t>(2).utf16("bc");
+    data.put<std::uint32_t>(77);
+    TdhParsedEvent event;
+    EXPECT_TRUE(plan->decode(data.span(), 4, event));
+    const auto array = value<TdhArray>(event, L"Entries");
+    EXPECT_EQ(array.count, 2U);
+    EXPECT_EQ(array.element_size, 0U);
+    EXPECT_EQ(array.bytes.size(), 4U + 4U + 4U + 6U);
+    EXPECT_TRUE(array.element(0).empty());
+    EXPECT_EQ(value<std::uint32_t>(event, L"After"), 77U);
+    EXPECT_TRUE(std::holds_alternative<std::monostate>(*event.at(3)));
+}
+
+TEST(DecodePlanTest, Compile_BadStructOrCount_Nullopt) {
+    // Members must come after the struct
+    const std::vector<PropertySchema> backwards = {
+        prop(L"A", InType::UInt32), structure(L"S", 0, 1)};
+    EXPECT_FALSE(DecodePlan::compile(backwards).has_value());
+
+    // A member shared by two structs
+    const std::vector<PropertySchema> shared = {
+        structure(L"S1", 2, 1), structure(L"S2", 2, 1), prop(L"M", InType::UInt32)};
+    EXPECT_FALSE(DecodePlan::compile(shared, 2).has_value());
+
+    // Counts come from earlier integers that are not array elements
+    PropertySchema by_string = prop(L"Items", InType::UInt32);
+    by_string.count_property = 0;
+    const std::vector<PropertySchema> string_count = {
+        prop(L"S", InType::UnicodeString), by_string};
+    EXPECT_FALSE(DecodePlan::compile(string_count).has_value());
+
+    PropertySchema elements = structure(L"E", 2, 2);
+    elements.count = 2;
+    PropertySchema inner = prop(L"Data", InType::Binary);
+    inner.length_property = 2;  // Length inside the same array element
+    const std::vector<PropertySchema> in_array = {
+        prop(L"X", InType::UInt8), elements, prop(L"Len", InType::UInt8), inner};
+    EXPECT_FALSE(DecodePlan::compile(in_array, 2).has_value());
+}
+
+TEST(DecodePlanTest, Compile_BadLengthProperty_Nullopt) {
+    PropertySchema name = prop(L"Name", InType::UnicodeString);
+    name.length_property = 1;  // Not an earlier property
+    const std::vector<PropertySchema> forward = {name, prop(L"Length", InType::UInt16)};
+    EXPECT_FALSE(DecodePlan::compile(forward).has_value());
+
+    PropertySchema blob = prop(L"Blob", InType::Binary);
+    blob.length_property = 0;  // Source is a string
+    const std::vector<PropertySchema> string_source = {prop(L"S", InType::UnicodeString), blob};
+    EXPECT_FALSE(DecodePlan::compile(string_source).has_value());
+}
+
+TEST(DecodePlanTest, Compile_UnknownType_Nullopt) {
+    PropertySchema unknown = prop(L"X", InType::UInt32);
+    unknown.in_type = 999;
+    const std::vector<PropertySchema> schema = {unknown};
+    EXPECT_FALSE(DecodePlan::compile(schema).has_value());
+}
+
+TEST(DecodePlanTest, Decode_AppendsAfterExisting) {
+    const std::vector<PropertySchema> schema = {prop(L"A", InType::UInt8)};
+    const auto plan = DecodePlan::compile(schema);
+    ASSERT_TRUE(plan.has_value());
+
+    Bytes data;
+    data.put<std::uint8_t>(5);
+    TdhParsedEvent event;
+    event.push(L"Existing", std::uint32_t{1});
+    EXPECT_TRUE(plan->decode(data.span(), 8, event));
+    EXPECT_EQ(event.size(), 2U);
+    EXPECT_EQ(value<std::uint32_t>(event, L"A"), 5U);
+}
+
+TEST(DecodePlanTest, Decode_LongText_SpillsPastInlineStorage) {
+    const std::vector<PropertySchema> schema = {
+        prop(L"First", InType::AnsiString),
+        prop(L"Second", InType::AnsiString),
+    };
+    const auto plan = DecodePlan::compile(schema);
+    ASSERT_TRUE(plan.has_value());
+
+    const std::string first(TdhParsedEvent::kTextChars - 10, 'a');
+    const std::string second(300, 'b');
+    std::vector<std::uint8_t> data(first.begin(), first.end());
+    data.push_back(0);
+    data.insert(data.end(), second.begin(), second.end());
+    data.push_back(0);
+
+    TdhParsedEvent event;
+    EXPECT_TRUE(plan->decode(data, 8, event));
+    EXPECT_EQ(value<std::wstring_view>(event, L"First"), std::wstring(first.begin(), first.end()));
+    EXPECT_EQ(value<std::wstring_view>(event, L"Second"),
+              std::wstring(second.begin(), second.end()));
+}
+
+TEST(TdhParsedEventTest, Push_StopsAtCapacity) {
+    TdhParsedEvent event;
+    for (std::size_t i = 0; i < TdhParsedEvent::kMaxProperties; ++i) {
+        EXPECT_TRUE(event.push(L"P", std::uint32_t{1}));
+    }
+    EXPECT_FALSE(event.push(L"Extra", std::uint32_t{2}));
+    EXPECT_EQ(event.size(), TdhParsedEvent::kMaxProperties);
+    EXPECT_EQ(event.find(L"Extra"), nullptr);
+    EXPECT_EQ(event.at(TdhParsedEvent::kMaxProperties), nullptr);
+}
+
+TEST(PropertyKeysTest, Resolve_OrdinalsAndAbsent) {
+    TdhParsedEvent event;
+    event.push(L"A", std::uint32_t{1});
+    event.push(L"B", std::uint32_t{2});
+    event.schema = 5;
+
+    PropertyKeys<3> keys({L"B", L"Missing", L"A"});
+    const auto& at = keys.resolve(event);
+    EXPECT_EQ(at[0], 1U);
+    EXPECT_EQ(at[1], PropertyKeys<3>::kAbsent);
+    EXPECT_EQ(at[2], 0U);
+    EXPECT_EQ(event.at(at[1]), nullptr);
+}
+
+TEST(PropertyKeysTest, Resolve_CachedPerSchema) {
+    PropertyKeys<1> keys({L"X"});
+
+    TdhParsedEvent first;
+    first.push(L"X", std::uint32_t{1});
+    first.schema = 1;
+    EXPECT_EQ(keys.resolve(first)[0], 0U);
+
+    // Same schema id: the cached ordinal is used without comparing names
+    TdhParsedEvent same;
+    same.push(L"Y", std::uint32_t{0});
+    same.push(L"X", std::uint32_t{1});
+    same.schema = 1;
+    EXPECT_EQ(keys.resolve(same)[0], 0U);
+
+    // Another schema, and events without one, are resolved again
+    same.schema = 2;
+    EXPECT_EQ(keys.resolve(same)[0], 1U);
+    same.schema = 0;
+    EXPECT_EQ(keys.resolve(same)[0], 1U);
+    first.schema = 0;
+    EXPECT_EQ(keys.resolve(first)[0], 0U);
+}
+
+TEST(DecodeValueTest, Integers_ReadNatively) {
+    Bytes data;
+    data.put<std::uint16_t>(0xBEEF).put<std::int8_t>(-3);
+    TdhParsedEvent event;
+    std::size_t consumed = 0;
+    const auto word = decode_value(InType::UInt16, 0, 8, data.span(), event, consumed);
+    ASSERT_TRUE(word.has_value());
+    EXPECT_EQ(std::get<std::uint32_t>(*word), 0xBEEFU);
+    EXPECT_EQ(consumed, 2U);
+
+    const auto byte = decode_value(InType::Int8, 0, 8, data.span().subspan(2), event, consumed);
+    ASSERT_TRUE(byte.has_value());
+    EXPECT_EQ(std::get<std::int32_t>(*byte), -3);
+    EXPECT_EQ(consumed, 1U);
+}
+
+TEST(DecodeValueTest, PointerFollowsPointerSize) {
+    Bytes data;
+    data.put<std::uint64_t>(0x1122334455667788ULL);
+    TdhParsedEvent event;
+    std::size_t consumed = 0;
+    const auto p32 = decode_value(InType::Pointer, 0, 4, data.span(), event, consumed);
+    ASSERT_TRUE(p32.has_value());
+    EXPECT_EQ(std::get<std::uint64_t>(*p32), 0x55667788ULL);
+    EXPECT_EQ(consumed, 4U);
+    const auto p64 = decode_value(InType::Pointer, 0, 8, data.span(), event, consumed);
+    ASSERT_TRUE(p64.has_value());
+    EXPECT_EQ(std::get<std::uint64_t>(*p64), 0x1122334455667788ULL);
+    EXPECT_EQ(consumed, 8U);
+}
+
+TEST(DecodeValueTest, Strings_TerminatedOrFixedLength) {
+    Bytes data;
+    data.utf16("abc").utf16("de", false);
+    TdhParsedEvent event;
+    std::size_t consumed = 0;
+    const auto terminated =
+        decode_value(InType::UnicodeString, 0, 8, data.span(), event, consumed);
+    ASSERT_TRUE(terminated.has_value());
+    EXPECT_EQ(std::get<std::wstring_view>(*terminated), L"abc");
+    EXPECT_EQ(consumed, 8U);
+
+    const auto fixed = decode_value(InType::UnicodeString, 2, 8, data.span().subspan(8), event,
+                                    consumed);
+    ASSERT_TRUE(fixed.has_value());
+    EXPECT_EQ(std::get<std::wstring_view>(*fixed), L"de");
+    EXPECT_EQ(consumed, 4U);
+
+    const std::uint8_t ansi[] = {'x', 'y', 0, 'z'};
+    const auto narrow = decode_value(InType::AnsiString, 0, 8, ansi, event, consumed);
+    ASSERT_TRUE(narrow.has_value());
+    EXPECT_EQ(std::get<std::wstring_view>(*narrow), L"xy");
+    EXPECT_EQ(consumed, 3U);
+}
+
+TEST(DecodeValueTest, SidAndGuid_Formatted) {
+    Bytes data;
+    data.put<std::uint8_t>(1).put<std::uint8_t>(1);
+    for (std::uint8_t b : {0, 0, 0, 0, 0, 5}) {
+        data.put<std::uint8_t>(b);
+    }
+    data.put<std::uint32_t>(18);
+    TdhParsedEvent event;
+    std::size_t consumed = 0;
+    const auto sid = decode_value(InType::Sid, 0, 8, data.span(), event, consumed);
+    ASSERT_TRUE(sid.has_value());
+    EXPECT_EQ(std::get<std::wstring_view>(*sid), L"S-1-5-18");
+    EXPECT_EQ(consumed, 12U);
+
+    Bytes guid;
+    guid.put<std::uint32_t>(0x12345678).put<std::uint16_t>(0x9ABC).put<std::uint16_t>(0xDEF0);
+    for (std::uint8_t b = 1; b <= 8; ++b) {
+        guid.put<std::uint8_t>(b);
+    }
+    const auto text = decode_value(InType::Guid, 0, 8, guid.span(), event, consumed);
+    ASSERT_TRUE(text.has_value());
+    EXPECT_EQ(std::get<std::wstring_view>(*text), L"{12345678-9ABC-DEF0-0102-030405060708}");
+    EXPECT_EQ(consumed, 16U);
+}
+
+TEST(DecodeValueTest, ShortDataOrUnusualType_Nullopt) {
+    Bytes data;
+    data.put<std::uint16_t>(1);
+    TdhParsedEvent event;
+    std::size_t consumed = 0;
+    EXPECT_FALSE(decode_value(InType::UInt32, 0, 8, data.span(), event, consumed).has_value());
+    EXPECT_FALSE(decode_value(InType::UInt32, 2, 8, data.span(), event, consumed).has_value());
+    EXPECT_FALSE(decode_value(InType::Float, 0, 8, data.span(), event, consumed).has_value());
+    EXPECT_FALSE(
+        decode_value(InType::CountedString, 0, 8, data.span(), event, consumed).has_value());
+    EXPECT_EQ(consumed, 0U);
+}
+
+}  // namespace
+}  // namespace exeray::etw::tdh
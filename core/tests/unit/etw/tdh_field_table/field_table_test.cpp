@@ -0,0 +1,178 @@
+/// @file field_table_test.cpp
+/// @brief Tests for the descriptor tables TDH converters are built from.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/tdh/field_table.hpp"
+#include "exeray/event/payload.hpp"
+#include "exeray/event/string_pool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace exeray::etw::tdh {
+namespace {
+
+using event::EventPayload;
+
+constexpr auto kProcessFields = field_table<EventPayload>({
+    {L"ProcessId", offsetof(EventPayload, process.pid), Transform::U32},
+    {L"ProcessID", offsetof(EventPayload, process.pid), Transform::U32},
+    {L"ImageFileName", offsetof(EventPayload, process.image_path), Transform::Path},
+    {L"ImageName", offsetof(EventPayload, process.image_path), Transform::Path},
+    {L"CommandLine", offsetof(EventPayload, process.command_line), Transform::String},
+});
+
+constexpr auto kNetworkFields = field_table<EventPayload>({
+    {L"sport", offsetof(EventPayload, network.local_port), Transform::U16},
+    {L"daddr", offsetof(EventPayload, network.remote_addr), Transform::U32},
+});
+
+struct Logon {
+    std::uint64_t logon_id = 0;
+    event::StringId source = event::INVALID_STRING;
+};
+
+constexpr auto kLogonFields = field_table<Logon>({
+    {L"TargetLogonId", offsetof(Logon, logon_id), Transform::U64},
+    {L"SubjectLogonId", offsetof(Logon, logon_id), Transform::U64},
+    {L"IpAddress", offsetof(Logon, source), Transform::LogString},
+});
+
+class FieldTableTest : public ::testing::Test {
+protected:
+    Arena arena_{1 << 16};
+    event::StringPool strings_{arena_};
+};
+
+TEST(FieldTableLayoutTest, Alternatives_PointAtFirstRowOfField) {
+    const auto& alternatives = kProcessFields.alternatives();
+
+    EXPECT_EQ(alternatives[0], 0U);
+    EXPECT_EQ(alternatives[1], 0U);
+    EXPECT_EQ(alternatives[2], 2U);
+    EXPECT_EQ(alternatives[3], 2U);
+    EXPECT_EQ(alternatives[4], 4U);
+    EXPECT_EQ(kProcessFields.names()[3], L"ImageName");
+}
+
+TEST_F(FieldTableTest, Apply_CopiesAndInterns) {
+    TdhParsedEvent tdh;
+    tdh.schema = 1;
+    tdh.push(L"CommandLine", std::wstring_view(L"cmd /c dir"));
+    tdh.push(L"ProcessId", std::uint64_t{4242});
+    tdh.push(L"ImageFileName", std::wstring_view(L"C:\\Windows\\cmd.exe"));
+    FieldMapper mapper(kProcessFields);
+    EventPayload payload{};
+
+    mapper.apply(tdh, payload, &strings_);
+
+    EXPECT_EQ(payload.process.pid, 4242U);
+    EXPECT_EQ(strings_.get(payload.process.image_path), "C:\\Windows\\cmd.exe");
+    EXPECT_EQ(payload.process.image_path, strings_.intern_path("C:\\Windows\\cmd.exe"));
+    EXPECT_EQ(strings_.get(payload.process.command_line), "cmd /c dir");
+}
+
+TEST_F(FieldTableTest, Apply_FallsBackOnMissingOrEmpty) {
+    TdhParsedEvent tdh;
+    tdh.schema = 2;
+    tdh.push(L"ProcessId", std::uint32_t{0});
+    tdh.push(L"ProcessID", std::int32_t{77});
+    tdh.push(L"ImageName", std::wstring_view(L"svchost.exe"));
+    tdh.push(L"ImageFileName", std::wstring_view());
+    FieldMapper mapper(kProcessFields);
+    EventPayload payload{};
+
+    mapper.apply(tdh, payload, &strings_);
+
+    EXPECT_EQ(payload.process.pid, 77U);
+    EXPECT_EQ(strings_.get(payload.process.image_path), "svchost.exe");
+    EXPECT_EQ(payload.process.command_line, event::INVALID_STRING);
+}
+
+TEST_F(FieldTableTest, Apply_FirstAlternativeWins) {
+    TdhParsedEvent tdh;
+    tdh.push(L"ProcessID", std::uint32_t{2});
+    tdh.push(L"ProcessId", std::uint32_t{1});
+    FieldMapper mapper(kProcessFields);
+    EventPayload payload{};
+
+    mapper.apply(tdh, payload, nullptr);
+
+    EXPECT_EQ(payload.process.pid, 1U) << "Table order decides, not schema order";
+}
+
+TEST_F(FieldTableTest, Apply_TruncatesToFieldWidth) {
+    TdhParsedEvent tdh;
+    tdh.push(L"sport", std::uint32_t{0x10050});
+    tdh.push(L"daddr", std::uint64_t{0x1'0A00'0001});
+    FieldMapper mapper(kNetworkFields);
+    EventPayload payload{};
+    payload.network.remote_port = 0xBEEF;
+
+    mapper.apply(tdh, payload, &strings_);
+
+    EXPECT_EQ(payload.network.local_port, 0x50U);
+    EXPECT_EQ(payload.network.remote_addr, 0x0A000001U);
+    EXPECT_EQ(payload.network.remote_port, 0xBEEFU) << "Fields without a row are untouched";
+}
+
+TEST_F(FieldTableTest, Apply_WithoutStringPool_LeavesStrings) {
+    TdhParsedEvent tdh;
+    tdh.push(L"CommandLine", std::wstring_view(L"x"));
+    tdh.push(L"ProcessId", std::uint32_t{5});
+    FieldMapper mapper(kProcessFields);
+    EventPayload payload{};
+
+    mapper.apply(tdh, payload, nullptr);
+
+    EXPECT_EQ(payload.process.pid, 5U);
+    EXPECT_EQ(payload.process.command_line, event::INVALID_STRING);
+}
+
+TEST_F(FieldTableTest, Apply_LogStringDash_IsMissing) {
+    FieldMapper mapper(kLogonFields);
+    {
+        TdhParsedEvent tdh;
+        tdh.push(L"SubjectLogonId", std::uint64_t{0x3E7});
+        tdh.push(L"IpAddress", std::wstring_view(L"-"));
+        Logon logon;
+        mapper.apply(tdh, logon, &strings_);
+
+        EXPECT_EQ(logon.logon_id, 0x3E7U);
+        EXPECT_EQ(logon.source, event::INVALID_STRING);
+    }
+    {
+        TdhParsedEvent tdh;
+        tdh.push(L"IpAddress", std::wstring_view(L"10.0.0.5"));
+        Logon logon;
+        mapper.apply(tdh, logon, &strings_);
+
+        EXPECT_EQ(strings_.get(logon.source), "10.0.0.5");
+    }
+}
+
+TEST_F(FieldTableTest, Apply_OrdinalsResolvedPerSchema) {
+    FieldMapper mapper(kNetworkFields);
+    TdhParsedEvent first;
+    first.schema = 9;
+    first.push(L"sport", std::uint32_t{80});
+    first.push(L"daddr", std::uint32_t{1});
+    EventPayload payload{};
+    mapper.apply(first, payload, nullptr);
+
+    // Same schema, so the ordinals of the first event are reused
+    TdhParsedEvent second;
+    second.schema = 9;
+    second.push(L"renamed", std::uint32_t{443});
+    second.push(L"other", std::uint32_t{2});
+    mapper.apply(second, payload, nullptr);
+
+    EXPECT_EQ(payload.network.local_port, 443U);
+    EXPECT_EQ(payload.network.remote_addr, 2U);
+}
+
+}  // namespace
+}  // namespace exeray::etw::tdh
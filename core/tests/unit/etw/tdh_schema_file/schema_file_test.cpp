@@ -0,0 +1,147 @@
+/// @file schema_file_test.cpp
+/// @brief Tests for the on-disk TDH schema cache format.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/tdh/schema_file.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace exeray::etw::tdh {
+namespace {
+
+constexpr std::uint64_t kFingerprint = 0x0A00'0000'4A65'0C1DULL;
+
+SchemaRecord record(std::uint32_t data1, std::uint16_t id, std::uint8_t version,
+                    std::size_t size) {
+    SchemaRecord result;
+    result.provider.Data1 = data1;
+    result.provider.Data4[7] = static_cast<std::uint8_t>(id);
+    result.event_id = id;
+    result.event_version = version;
+    for (std::size_t i = 0; i < size; ++i) {
+        result.info.push_back(static_cast<std::uint8_t>(i * 7 + id));
+    }
+    return result;
+}
+
+void expect_same(const SchemaRecord& a, const SchemaRecord& b) {
+    EXPECT_EQ(a.provider.Data1, b.provider.Data1);
+    EXPECT_EQ(a.provider.Data4[7], b.provider.Data4[7]);
+    EXPECT_EQ(a.event_id, b.event_id);
+    EXPECT_EQ(a.event_version, b.event_version);
+    EXPECT_EQ(a.info, b.info);
+}
+
+class SchemaFileTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = std::filesystem::temp_directory_path() /
+                ("exeray_schema_" + std::to_string(::testing::UnitTest::GetInstance()
+                                                       ->random_seed()) +
+                 "_" + ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        std::filesystem::remove(path_);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path_);
+    }
+
+    std::filesystem::path path_;
+};
+
+TEST(SchemaFileEncodeTest, RoundTrip_KeepsRecordsInOrder) {
+    const std::vector<SchemaRecord> records{record(1, 10, 0, 96), record(2, 11, 3, 5),
+                                            record(1, 12, 1, 0)};
+    const auto bytes = encode_schemas(records, kFingerprint);
+    EXPECT_EQ(bytes.size() % 8, 0u);
+
+    const auto decoded = decode_schemas(bytes, kFingerprint);
+    ASSERT_TRUE(decoded.has_value());
+    ASSERT_EQ(decoded->size(), records.size());
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        expect_same((*decoded)[i], records[i]);
+    }
+}
+
+TEST(SchemaFileEncodeTest, Empty_DecodesToNoRecords) {
+    const auto decoded = decode_schemas(encode_schemas({}, kFingerprint), kFingerprint);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_TRUE(decoded->empty());
+}
+
+TEST(SchemaFileEncodeTest, OtherFingerprint_Rejected) {
+    const std::vector<SchemaRecord> records{record(1, 10, 0, 16)};
+    const auto bytes = encode_schemas(records, kFingerprint);
+    EXPECT_FALSE(decode_schemas(bytes, kFingerprint + 1).has_value());
+}
+
+TEST(SchemaFileEncodeTest, Truncated_Rejected) {
+    const std::vector<SchemaRecord> records{record(1, 10, 0, 40), record(2, 11, 0, 40)};
+    auto bytes = encode_schemas(records, kFingerprint);
+    for (const std::size_t size : {std::size_t{0}, std::size_t{16}, std::size_t{40},
+                                   bytes.size() - 8}) {
+        const std::vector<std::uint8_t> cut(bytes.begin(),
+                                            bytes.begin() + static_cast<std::ptrdiff_t>(size));
+        EXPECT_FALSE(decode_schemas(cut, kFingerprint).has_value()) << size;
+    }
+}
+
+TEST(SchemaFileEncodeTest, FlippedPayloadByte_Rejected) {
+    const std::vector<SchemaRecord> records{record(1, 10, 0, 40)};
+    auto bytes = encode_schemas(records, kFingerprint);
+    bytes[bytes.size() - 9] ^= 0x01;
+    EXPECT_FALSE(decode_schemas(bytes, kFingerprint).has_value());
+}
+
+TEST(SchemaFileEncodeTest, BadMagic_Rejected) {
+    auto bytes = encode_schemas({}, kFingerprint);
+    bytes[0] ^= 0xFF;
+    EXPECT_FALSE(decode_schemas(bytes, kFingerprint).has_value());
+}
+
+TEST_F(SchemaFileTest, WriteRead_RoundTrip) {
+    const std::vector<SchemaRecord> records{record(7, 1, 0, 200), record(7, 2, 0, 13)};
+    ASSERT_TRUE(write_schema_file(path_, records, kFingerprint));
+
+    const auto read = read_schema_file(path_, kFingerprint);
+    ASSERT_TRUE(read.has_value());
+    ASSERT_EQ(read->size(), 2u);
+    expect_same((*read)[0], records[0]);
+    expect_same((*read)[1], records[1]);
+
+    auto temp = path_;
+    temp += ".tmp";
+    EXPECT_FALSE(std::filesystem::exists(temp));
+}
+
+TEST_F(SchemaFileTest, Write_ReplacesOldFile) {
+    ASSERT_TRUE(write_schema_file(path_, std::vector{record(1, 1, 0, 8)}, kFingerprint));
+    ASSERT_TRUE(write_schema_file(path_, std::vector{record(2, 2, 0, 8), record(3, 3, 0, 8)},
+                                  kFingerprint));
+    const auto read = read_schema_file(path_, kFingerprint);
+    ASSERT_TRUE(read.has_value());
+    EXPECT_EQ(read->size(), 2u);
+}
+
+TEST_F(SchemaFileTest, Missing_Nullopt) {
+    EXPECT_FALSE(read_schema_file(path_, kFingerprint).has_value());
+}
+
+TEST_F(SchemaFileTest, Garbage_Nullopt) {
+    {
+        std::ofstream file(path_, std::ios::binary);
+        file << "not a schema file at all, just some text";
+    }
+    EXPECT_FALSE(read_schema_file(path_, kFingerprint).has_value());
+}
+
+TEST(SchemaFileFingerprintTest, Fingerprint_Stable) {
+    EXPECT_EQ(os_fingerprint(), os_fingerprint());
+}
+
+}  // namespace
+}  // namespace exeray::etw::tdh
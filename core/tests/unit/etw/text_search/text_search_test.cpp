@@ -0,0 +1,140 @@
+/// @file text_search_test.cpp
+/// @brief Tests for the shared case-insensitive substring search.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/text_search.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace exeray::etw {
+namespace {
+
+constexpr std::size_t npos = std::wstring_view::npos;
+
+/// Reference: the nested loop the detectors used before.
+std::size_t naive_find_icase(std::wstring_view haystack, std::wstring_view needle) {
+    auto fold = [](wchar_t c) { return (c >= L'A' && c <= L'Z') ? c - L'A' + L'a' : c; };
+    if (needle.empty() || needle.size() > haystack.size()) {
+        return npos;
+    }
+    for (std::size_t i = 0; i + needle.size() <= haystack.size(); ++i) {
+        std::size_t j = 0;
+        while (j < needle.size() && fold(haystack[i + j]) == fold(needle[j])) {
+            ++j;
+        }
+        if (j == needle.size()) {
+            return i;
+        }
+    }
+    return npos;
+}
+
+TEST(TextSearchTest, FindIcase_Basics) {
+    EXPECT_EQ(find_icase(L"SELECT * FROM Win32_Process", L"win32_process"), 14U);
+    EXPECT_EQ(find_icase(L"abc", L"abc"), 0U);
+    EXPECT_EQ(find_icase(L"abc", L"C"), 2U);
+    EXPECT_EQ(find_icase(L"abc", L"abcd"), npos);
+    EXPECT_EQ(find_icase(L"abc", L""), npos);
+    EXPECT_EQ(find_icase(L"", L"a"), npos);
+}
+
+TEST(TextSearchTest, FindIcase_FoldsOnlyLetters) {
+    // '@' | 0x20 is '`': non-letters must not be folded
+    EXPECT_EQ(find_icase(L"x`y", L"x@y"), npos);
+    EXPECT_EQ(find_icase(L"[\\]", L"{|}"), npos);
+    EXPECT_EQ(find_icase(L"C:\\USERS\\PUBLIC\\a.dll", L"\\users\\public\\"), 2U);
+    EXPECT_EQ(find_icase(L"\u00C9T\u00C9", L"\u00E9t\u00E9"), npos);  // ASCII folding only
+}
+
+TEST(TextSearchTest, FindIcase_MatchesNaiveAtEveryOffset) {
+    // Haystacks longer than a vector block, with the needle at each position
+    const std::wstring needle = L"PoWeRsHeLl";
+    for (std::size_t length = needle.size(); length < 80; ++length) {
+        for (std::size_t at = 0; at + needle.size() <= length; ++at) {
+            std::wstring text(length, L'p');
+            text.replace(at, needle.size(), L"powershell");
+            ASSERT_EQ(find_icase(text, needle), naive_find_icase(text, needle))
+                << "length " << length << " at " << at;
+        }
+    }
+}
+
+TEST(TextSearchTest, FindIcase_FirstAndLastMatchButMiddleDiffers) {
+    std::wstring text(64, L'x');
+    text.replace(20, 4, L"pwxh");
+    text.replace(50, 4, L"PWSH");
+    EXPECT_EQ(find_icase(text, L"pwsh"), 50U);
+}
+
+TEST(TextSearchTest, FindIcase_SingleCharacterAndNonAsciiText) {
+    std::wstring text(40, L'\u4E2D');
+    text[33] = L'Q';
+    EXPECT_EQ(find_icase(text, L"q"), 33U);
+    EXPECT_EQ(find_icase(text, L"\u4E2D\u4E2D"), 0U);
+}
+
+TEST(TextSearchTest, ContainsIcase) {
+    EXPECT_TRUE(contains_icase(L"C:\\Windows\\TEMP\\x.dll", L"\\temp\\"));
+    EXPECT_FALSE(contains_icase(L"C:\\Windows\\System32\\x.dll", L"\\temp\\"));
+}
+
+TEST(TextSearchTest, FindIcaseUtf8_MatchesWideAtEveryOffset) {
+    // Byte lanes: twice the positions per block of the wide kernel
+    const std::string needle = "\\TeMp\\";
+    for (std::size_t length = needle.size(); length < 100; ++length) {
+        for (std::size_t at = 0; at + needle.size() <= length; ++at) {
+            std::string text(length, 't');
+            text.replace(at, needle.size(), "\\temp\\");
+            const std::wstring wide(text.begin(), text.end());
+            ASSERT_EQ(find_icase(text, needle),
+                      naive_find_icase(wide, std::wstring(needle.begin(), needle.end())))
+                << "length " << length << " at " << at;
+        }
+    }
+}
+
+TEST(TextSearchTest, FindIcaseUtf8_NonAsciiBytesCompareExactly) {
+    const std::string text = "x.ngrok-free.app \xC3\x89t\xC3\xA9";
+    EXPECT_EQ(find_icase(std::string_view(text), "NGROK"), 2U);
+    EXPECT_EQ(find_icase(std::string_view(text), "\xC3\xA9t"), std::string_view::npos);
+    EXPECT_TRUE(contains_icase(std::string_view(text), "\xC3\x89T"));
+    EXPECT_FALSE(contains_icase(std::string_view("abc"), ""));
+}
+
+TEST(TextSearchTest, Needles_MatchReportsEveryNeedle) {
+    constexpr IcaseNeedles needles = {L"Win32_Process", L"Create", L"pwsh", L"__EventFilter"};
+    EXPECT_EQ(needles.size(), 4U);
+    EXPECT_EQ(needles.match(L"Win32_Process.Create(\"pwsh -c x\")"), 0b0111U);
+    EXPECT_EQ(needles.match(L"SELECT * FROM __eventfilter"), 0b1000U);
+    EXPECT_EQ(needles.match(L"nothing here"), 0U);
+    EXPECT_EQ(needles.match(L""), 0U);
+}
+
+TEST(TextSearchTest, Needles_SharedFirstCharacter) {
+    constexpr IcaseNeedles needles = {L"\\temp\\", L"\\tmp\\", L"\\appdata\\"};
+    EXPECT_EQ(needles.match(L"C:\\Users\\a\\AppData\\Local\\Temp\\x.dll"), 0b101U);
+    EXPECT_EQ(needles.match(L"C:\\tmp"), 0U);  // Needle runs past the end
+    EXPECT_TRUE(needles.any(L"D:\\TMP\\y"));
+    EXPECT_FALSE(needles.any(L"C:\\Program Files\\z"));
+}
+
+TEST(TextSearchTest, Needles_FromArrayAndEmptyNeedle) {
+    static constexpr const wchar_t* kList[] = {L"SeDebugPrivilege", L"", L"SeTcbPrivilege"};
+    constexpr IcaseNeedles needles(kList);
+    EXPECT_EQ(needles.size(), 3U);
+    EXPECT_EQ(needles.match(L"SeTcbPrivilege SeDebugPrivilege"), 0b101U);
+    EXPECT_FALSE(needles.any(L"SeShutdownPrivilege"));
+}
+
+TEST(TextSearchTest, Needles_NonAsciiFirstCharacter) {
+    constexpr IcaseNeedles needles = {L"\u00E9t\u00E9", L"x"};
+    EXPECT_EQ(needles.match(L"l'\u00E9t\u00E9"), 0b01U);
+    EXPECT_EQ(needles.match(L"\u00C9T\u00C9 x"), 0b10U);
+}
+
+}  // namespace
+}  // namespace exeray::etw
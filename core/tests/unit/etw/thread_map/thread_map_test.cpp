@@ -0,0 +1,99 @@
+/// @file thread_map_test.cpp
+/// @brief Tests for the thread ID to process map.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/thread_map.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace exeray::etw {
+namespace {
+
+constexpr std::uint32_t kApp = 1000;
+constexpr std::uint32_t kOther = 2000;
+
+TEST(ThreadMapTest, Find_ReturnsOwner) {
+    auto map = std::make_unique<ThreadMap>();
+    map->start(4, kApp);
+    map->start(8, kOther);
+    map->start(0x12340, kApp);
+
+    EXPECT_EQ(map->find(4), kApp);
+    EXPECT_EQ(map->find(8), kOther);
+    EXPECT_EQ(map->find(0x12340), kApp);
+    EXPECT_EQ(map->find(12), 0u);
+    EXPECT_EQ(map->find(0x99990), 0u);  // Page never allocated
+    EXPECT_EQ(map->size(), 3u);
+
+    map->start(4, kApp);  // DCStart after Start counts once
+    EXPECT_EQ(map->size(), 3u);
+}
+
+TEST(ThreadMapTest, End_OnlyClearsMatchingOwner) {
+    auto map = std::make_unique<ThreadMap>();
+    map->start(4, kApp);
+    map->end(4, kOther);  // Stale end of a previous owner of the TID
+    EXPECT_EQ(map->find(4), kApp);
+
+    map->end(4, kApp);
+    EXPECT_EQ(map->find(4), 0u);
+    EXPECT_EQ(map->size(), 0u);
+
+    // A reused TID belongs to its newest process
+    map->start(8, kApp);
+    map->start(8, kOther);
+    EXPECT_EQ(map->find(8), kOther);
+    EXPECT_EQ(map->size(), 1u);
+}
+
+TEST(ThreadMapTest, Untracked_IgnoredAndClear) {
+    auto map = std::make_unique<ThreadMap>();
+    map->start(6, kApp);  // Not a multiple of four
+    map->start(static_cast<std::uint32_t>(ThreadMap::kMaxThreadId), kApp);
+    map->start(16, 0);
+    EXPECT_EQ(map->find(6), 0u);
+    EXPECT_EQ(map->find(static_cast<std::uint32_t>(ThreadMap::kMaxThreadId)), 0u);
+    EXPECT_EQ(map->find(0xFFFFFFFC), 0u);
+    EXPECT_EQ(map->size(), 0u);
+
+    map->start(20, kApp);
+    map->clear();
+    EXPECT_EQ(map->find(20), 0u);
+    EXPECT_EQ(map->size(), 0u);
+    map->start(20, kOther);
+    EXPECT_EQ(map->find(20), kOther);
+}
+
+TEST(ThreadMapTest, Find_ConsistentWhileWriterAllocatesPages) {
+    auto map = std::make_unique<ThreadMap>();
+    map->start(4, kApp);
+
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (std::uint32_t tid = 8; tid < 4 * 200000; tid += 4) {
+            map->start(tid, kOther);
+            if (tid % 12 == 0) {
+                map->end(tid - 4, kOther);
+            }
+        }
+        done.store(true);
+    });
+
+    // The first thread is never touched; others are either unknown or kOther
+    std::size_t reads = 0;
+    while (!done.load() || reads < 1000) {
+        ASSERT_EQ(map->find(4), kApp);
+        const std::uint32_t owner = map->find(static_cast<std::uint32_t>(8 + 4 * (reads % 150000)));
+        ASSERT_TRUE(owner == 0 || owner == kOther);
+        ++reads;
+    }
+    writer.join();
+    EXPECT_EQ(map->find(4 * 150000), kOther);
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,92 @@
+/// @file wmi_aggregator_test.cpp
+/// @brief Tests for per-client aggregation of repeated WMI operations.
+
+#include <gtest/gtest.h>
+
+#include "exeray/etw/wmi_aggregator.hpp"
+
+#include <cstdint>
+
+namespace exeray::etw {
+namespace {
+
+constexpr std::uint64_t kMs = 1'000'000;
+constexpr event::StringId kCimv2 = 41;
+constexpr event::StringId kQuery = 42;
+constexpr event::StringId kOtherQuery = 43;
+constexpr auto kQueryOp = static_cast<std::uint8_t>(event::WmiOp::Query);
+
+event::EventPayload wmi_payload(event::StringId query = kQuery) {
+    event::EventPayload payload{};
+    payload.category = event::Category::Wmi;
+    payload.wmi.wmi_namespace = kCimv2;
+    payload.wmi.query = query;
+    payload.wmi.target_host = event::INVALID_STRING;
+    payload.wmi.count = 1;
+    return payload;
+}
+
+TEST(WmiAggregatorTest, Admit_FirstOccurrenceThenPeriodicSummaries) {
+    WmiAggregator wmi(WmiConfig{true, 100});
+
+    int stored = 0;
+    std::uint64_t counted = 0;
+    for (std::uint64_t i = 0; i < 1000; ++i) {
+        event::EventPayload payload = wmi_payload();
+        if (wmi.admit(100, payload, kQueryOp, i * kMs)) {
+            ++stored;
+            counted += payload.wmi.count;
+        }
+    }
+    // The first and one per 100 ms; their counts add up to every occurrence
+    EXPECT_EQ(stored, 10);
+    EXPECT_EQ(counted, 1000u - 99u);
+
+    const WmiStats stats = wmi.stats();
+    EXPECT_EQ(stats.operations, 1u);
+    EXPECT_EQ(stats.summaries, 9u);
+    EXPECT_EQ(stats.absorbed, 990u);
+
+    const auto operations = wmi.operations(100);
+    ASSERT_EQ(operations.size(), 1u);
+    EXPECT_EQ(operations[0].count, 1000u);
+    EXPECT_EQ(operations[0].query, kQuery);
+    EXPECT_TRUE(wmi.operations(200).empty());
+}
+
+TEST(WmiAggregatorTest, Admit_ClientsQueriesAndOperationsAggregateSeparately) {
+    WmiAggregator wmi(WmiConfig{true, 0});
+    for (std::uint32_t pid : {100u, 200u}) {
+        for (event::StringId query : {kQuery, kOtherQuery}) {
+            for (auto op : {event::WmiOp::Query, event::WmiOp::ExecMethod}) {
+                for (int i = 0; i < 3; ++i) {
+                    event::EventPayload payload = wmi_payload(query);
+                    EXPECT_EQ(wmi.admit(pid, payload, static_cast<std::uint8_t>(op), 1), i == 0);
+                }
+            }
+        }
+    }
+    EXPECT_EQ(wmi.stats().operations, 8u);
+    EXPECT_EQ(wmi.stats().absorbed, 16u);
+
+    // A remote target is a new operation
+    event::EventPayload remote = wmi_payload();
+    remote.wmi.target_host = 44;
+    EXPECT_TRUE(wmi.admit(100, remote, kQueryOp, 2));
+
+    wmi.clear();
+    EXPECT_EQ(wmi.stats().operations, 0u);
+    EXPECT_EQ(wmi.stats().absorbed, 0u);
+}
+
+TEST(WmiAggregatorTest, Admit_OtherEventsPassThrough) {
+    WmiAggregator wmi;
+    event::EventPayload file{};
+    file.category = event::Category::FileSystem;
+    EXPECT_TRUE(wmi.admit(1, file, kQueryOp, 0));
+    EXPECT_TRUE(wmi.admit(1, file, kQueryOp, 0));
+    EXPECT_EQ(wmi.stats().operations, 0u);
+}
+
+}  // namespace
+}  // namespace exeray::etw
@@ -0,0 +1,153 @@
+#include "event_graph_test_common.hpp"
+
+#include <chrono>
+#include <thread>
+
+#include "exeray/event/alert_queue.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+namespace {
+
+Alert alert(EventId id) {
+    Alert a;
+    a.id = id;
+    return a;
+}
+
+}  // namespace
+
+// ============================================================================
+// Alert queue
+// ============================================================================
+
+TEST(AlertQueueTest, Pop_OldestFirstAndDropsWhenFull) {
+    AlertQueue queue(4);
+    EXPECT_EQ(queue.capacity(), 4u);
+    EXPECT_TRUE(queue.empty());
+    for (EventId id = 1; id <= 5; ++id) {
+        EXPECT_EQ(queue.push(alert(id)), id <= 4);
+    }
+    EXPECT_FALSE(queue.empty());
+
+    std::array<Alert, 3> out{};
+    ASSERT_EQ(queue.pop(out), 3u);
+    EXPECT_EQ(out[0].id, 1u);
+    EXPECT_EQ(out[2].id, 3u);
+
+    // Freed slots take new alerts, behind the one left
+    EXPECT_TRUE(queue.push(alert(6)));
+    ASSERT_EQ(queue.pop(out), 2u);
+    EXPECT_EQ(out[0].id, 4u);
+    EXPECT_EQ(out[1].id, 6u);
+    EXPECT_TRUE(queue.empty());
+
+    const AlertStats stats = queue.stats();
+    EXPECT_EQ(stats.pushed, 5u);
+    EXPECT_EQ(stats.dropped, 1u);
+}
+
+TEST(AlertQueueTest, Push_ConcurrentProducersLoseNothing) {
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 20000;
+    AlertQueue queue(1024);
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < kThreads; ++t) {
+        producers.emplace_back([&queue, t] {
+            for (int i = 0; i < kPerThread; ++i) {
+                Alert a = alert(static_cast<EventId>(i) + 1);
+                a.pid = static_cast<std::uint32_t>(t);
+                while (!queue.push(a)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // Each producer's alerts come out in its own order
+    std::array<EventId, kThreads> last{};
+    std::array<Alert, 64> out{};
+    int received = 0;
+    while (received < kThreads * kPerThread) {
+        const std::size_t n = queue.pop(out);
+        for (std::size_t i = 0; i < n; ++i) {
+            ASSERT_EQ(out[i].id, last[out[i].pid] + 1);
+            last[out[i].pid] = out[i].id;
+        }
+        received += static_cast<int>(n);
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(AlertQueueTest, Wait_WokenByPushOrWake) {
+    AlertQueue queue;
+    EXPECT_FALSE(queue.wait(std::chrono::milliseconds(1)));
+
+    std::thread producer([&queue] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        queue.push(alert(7));
+    });
+    const auto begin = std::chrono::steady_clock::now();
+    EXPECT_TRUE(queue.wait(std::chrono::seconds(10)));
+    EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::seconds(5));
+    producer.join();
+
+    std::array<Alert, 1> out{};
+    ASSERT_EQ(queue.pop(out), 1u);
+    std::thread waker([&queue] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        queue.wake();
+    });
+    EXPECT_FALSE(queue.wait(std::chrono::seconds(10)));
+    waker.join();
+}
+
+TEST_F(EventGraphTest, Alerts_QueuedForSuspiciousPushesBatchesAndStatusChanges) {
+    EXPECT_EQ(graph_.alerts(), nullptr);
+    AlertQueue queue;
+    graph_.set_alerts(&queue);
+
+    const EventPayload process = make_process_payload(42);
+    graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 42, process, 5);
+    const EventId flagged = graph_.push(Category::Process, 1, Status::Suspicious, INVALID_EVENT,
+                                        42, process, 6);
+    const EventId later = graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 42,
+                                      process, 7);
+
+    std::vector<PendingEvent> batch(3);
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        PendingEvent& event = batch[i];
+        event.category = Category::Network;
+        event.operation = 2;
+        event.status = i == 1 ? Status::Suspicious : Status::Success;
+        event.parent = INVALID_EVENT;
+        event.correlation_id = 0;
+        event.payload = make_network_payload();
+        event.timestamp = 8;
+    }
+    std::vector<EventId> ids(batch.size());
+    EXPECT_EQ(graph_.push_batch(batch, ids), 3u);
+    EXPECT_TRUE(graph_.set_status(later, Status::Suspicious));
+    EXPECT_FALSE(graph_.set_status(later, Status::Suspicious));  // No change, no alert
+
+    std::array<Alert, 8> out{};
+    ASSERT_EQ(queue.pop(out), 3u);
+    EXPECT_EQ(out[0].id, flagged);
+    EXPECT_EQ(out[0].pid, 42u);
+    EXPECT_EQ(out[0].category, Category::Process);
+    EXPECT_EQ(out[0].operation, 1u);
+    EXPECT_EQ(out[0].timestamp, 6u);
+    EXPECT_EQ(out[0].late, 0u);
+    EXPECT_EQ(out[1].id, ids[1]);
+    EXPECT_EQ(out[1].category, Category::Network);
+    EXPECT_EQ(out[2].id, later);
+    EXPECT_EQ(out[2].late, 1u);
+}
+
+}  // namespace exeray::event::test
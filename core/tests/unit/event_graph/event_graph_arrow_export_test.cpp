@@ -0,0 +1,215 @@
+/// @file event_graph_arrow_export_test.cpp
+/// @brief Tests for the Arrow IPC export, read back with a minimal FlatBuffers reader.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/event/arrow_export.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/thread_pool.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace exeray::event {
+namespace {
+
+constexpr std::size_t kArenaSize = 64 * 1024 * 1024;
+
+/// @brief Just enough of an Arrow IPC file reader to check what was written.
+class ArrowReader {
+public:
+    explicit ArrowReader(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        bytes_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    [[nodiscard]] bool framed() const {
+        return bytes_.size() > 16 && std::memcmp(bytes_.data(), "ARROW1\0\0", 8) == 0 &&
+               std::memcmp(bytes_.data() + bytes_.size() - 6, "ARROW1", 6) == 0;
+    }
+
+    /// @brief Root table of the footer.
+    [[nodiscard]] std::size_t footer() const {
+        const std::size_t length = read<std::int32_t>(bytes_.size() - 10);
+        return root(bytes_.size() - 10 - length);
+    }
+
+    [[nodiscard]] std::size_t root(std::size_t buffer) const {
+        return buffer + read<std::uint32_t>(buffer);
+    }
+
+    /// @brief Position of a table field, or 0 when absent.
+    [[nodiscard]] std::size_t field(std::size_t table, std::uint16_t id) const {
+        const std::size_t vtable = table - read<std::int32_t>(table);
+        if (4u + 2u * id >= read<std::uint16_t>(vtable)) {
+            return 0;
+        }
+        const auto offset = read<std::uint16_t>(vtable + 4 + 2 * id);
+        return offset != 0 ? table + offset : 0;
+    }
+
+    /// @brief Follow the offset stored in a table field.
+    [[nodiscard]] std::size_t child(std::size_t table, std::uint16_t id) const {
+        const std::size_t at = field(table, id);
+        return at + read<std::uint32_t>(at);
+    }
+
+    [[nodiscard]] std::uint32_t length(std::size_t vector) const {
+        return read<std::uint32_t>(vector);
+    }
+
+    [[nodiscard]] std::size_t element(std::size_t vector, std::size_t i) const {
+        const std::size_t at = vector + 4 + 4 * i;
+        return at + read<std::uint32_t>(at);
+    }
+
+    [[nodiscard]] std::string_view string(std::size_t at) const {
+        return {reinterpret_cast<const char*>(bytes_.data()) + at + 4, read<std::uint32_t>(at)};
+    }
+
+    template <typename T>
+    [[nodiscard]] T read(std::size_t at) const {
+        T value;
+        std::memcpy(&value, bytes_.data() + at, sizeof(T));
+        return value;
+    }
+
+    /// @brief Message of a footer Block: its header table and body start.
+    struct Message {
+        std::size_t header;
+        std::size_t body;
+        std::uint8_t type;
+    };
+
+    [[nodiscard]] Message message(std::size_t blocks, std::size_t i) const {
+        const std::size_t block = blocks + 4 + 24 * i;  // Structs follow the length
+        const auto offset = static_cast<std::size_t>(read<std::int64_t>(block));
+        const auto metadata = static_cast<std::size_t>(read<std::int32_t>(block + 8));
+        EXPECT_EQ(read<std::uint32_t>(offset), 0xFFFFFFFFU);
+        const std::size_t table = root(offset + 8);
+        return {child(table, 2), offset + metadata, read<std::uint8_t>(field(table, 1))};
+    }
+
+    /// @brief Start and length of buffer i of a RecordBatch body.
+    [[nodiscard]] std::pair<std::size_t, std::size_t> buffer(const Message& message,
+                                                             std::size_t i) const {
+        const std::size_t at = child(message.header, 2) + 4 + 16 * i;
+        return {message.body + read<std::int64_t>(at),
+                static_cast<std::size_t>(read<std::int64_t>(at + 8))};
+    }
+
+private:
+    std::vector<std::uint8_t> bytes_;
+};
+
+class ArrowExportTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = std::filesystem::temp_directory_path() /
+               ("exeray_arrow_" +
+                std::to_string(::testing::UnitTest::GetInstance()->random_seed()) + "_" +
+                ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        std::filesystem::remove_all(dir_);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(dir_); }
+
+    Arena arena_{kArenaSize};
+    StringPool strings_{arena_};
+    EventGraph graph_{arena_, strings_, 4 * EventGraph::kSegmentSize};
+    std::filesystem::path dir_;
+};
+
+TEST_F(ArrowExportTest, ExportArrow_WritesOneReadableFilePerCategory) {
+    const std::size_t processes = EventGraph::kSegmentSize + 10;  // Two batches
+    for (std::size_t i = 1; i <= processes; ++i) {
+        EventPayload payload{};
+        payload.category = Category::Process;
+        payload.process.pid = static_cast<std::uint32_t>(i);
+        payload.process.image_path =
+            strings_.intern_path(i % 2 == 0 ? "C:\\Windows\\cmd.exe" : "C:\\Tools\\a.exe");
+        payload.process.command_line = i % 3 == 0 ? strings_.intern("run") : INVALID_STRING;
+        graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 1, payload, 100 + i);
+    }
+    EventPayload network{};
+    network.category = Category::Network;
+    network.network.family = kAddressIPv6;
+    network.network.local_addr = strings_.intern("fe80::1");
+    graph_.push(Category::Network, 0, Status::Success, 1, 1, network, 5000);
+
+    ThreadPool pool(2);
+    const auto done = export_arrow(graph_, strings_, dir_, pool);
+    ASSERT_TRUE(done.has_value());
+    EXPECT_EQ(done->files, 2u);
+    EXPECT_EQ(done->rows, processes + 1);
+    EXPECT_EQ(done->batches, 3u);
+    EXPECT_FALSE(std::filesystem::exists(dir_ / "FileSystem.arrow"));
+
+    const ArrowReader file(dir_ / "Process.arrow");
+    ASSERT_TRUE(file.framed());
+    const std::size_t footer = file.footer();
+    const std::size_t fields = file.child(file.child(footer, 1), 1);
+    ASSERT_EQ(file.length(fields), 10u);
+    EXPECT_EQ(file.string(file.child(file.element(fields, 0), 0)), "id");
+    EXPECT_EQ(file.string(file.child(file.element(fields, 8), 0)), "image_path");
+    EXPECT_NE(file.field(file.element(fields, 8), 4), 0u);  // Dictionary encoded
+    EXPECT_EQ(file.field(file.element(fields, 0), 4), 0u);
+
+    // Dictionaries, image_path first: values in order of first appearance
+    const std::size_t dictionaries = file.child(footer, 2);
+    ASSERT_EQ(file.length(dictionaries), 2u);
+    const auto image = file.message(dictionaries, 0);
+    EXPECT_EQ(image.type, 2);
+    const ArrowReader::Message values{file.child(image.header, 1), image.body, 3};
+    const auto [offsets, offsets_size] = file.buffer(values, 1);
+    const auto [text, text_size] = file.buffer(values, 2);
+    ASSERT_EQ(offsets_size, 3 * sizeof(std::int32_t));
+    const auto first_end = static_cast<std::size_t>(file.read<std::int32_t>(offsets + 4));
+    EXPECT_EQ(text_size,
+              first_end + strings_.get(graph_.get(2).payload().process.image_path).size());
+    std::string first;
+    for (std::size_t i = 0; i < first_end; ++i) {
+        first.push_back(file.read<char>(text + i));
+    }
+    EXPECT_EQ(first, strings_.get(graph_.get(1).payload().process.image_path));
+
+    // Record batches: the ids, and command_line nulls
+    const std::size_t batches = file.child(footer, 3);
+    ASSERT_EQ(file.length(batches), 2u);
+    std::size_t rows = 0;
+    for (std::size_t b = 0; b < 2; ++b) {
+        const auto batch = file.message(batches, b);
+        EXPECT_EQ(batch.type, 3);
+        const auto length =
+            static_cast<std::size_t>(file.read<std::int64_t>(file.field(batch.header, 0)));
+        const auto [ids, ids_size] = file.buffer(batch, 1);
+        ASSERT_EQ(ids_size, length * sizeof(EventId));
+        for (std::size_t row = 0; row < length; ++row) {
+            ASSERT_EQ(file.read<EventId>(ids + row * sizeof(EventId)), rows + row + 1);
+        }
+        const std::size_t nodes = file.child(batch.header, 1);
+        const auto nulls = file.read<std::int64_t>(nodes + 4 + 16 * 9 + 8);
+        EXPECT_EQ(static_cast<std::size_t>(nulls), length - (rows + length) / 3 + rows / 3);
+        const auto [index, index_size] = file.buffer(batch, 2 * 8 + 1);
+        ASSERT_EQ(index_size, length * sizeof(std::int32_t));
+        EXPECT_EQ(file.read<std::int32_t>(index), 0);  // Odd ids: the first text
+        rows += length;
+    }
+    EXPECT_EQ(rows, processes);
+
+    const ArrowReader net(dir_ / "Network.arrow");
+    ASSERT_TRUE(net.framed());
+    const std::size_t net_fields = net.child(net.child(net.footer(), 1), 1);
+    EXPECT_EQ(net.string(net.child(net.element(net_fields, net.length(net_fields) - 2), 0)),
+              "local_addr6");
+}
+
+}  // namespace
+}  // namespace exeray::event
@@ -0,0 +1,181 @@
+#include "event_graph_test_common.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// 15. Batched Push
+// ============================================================================
+
+namespace {
+
+PendingEvent make_pending(const EventPayload& payload, EventId parent = INVALID_EVENT,
+                          uint32_t correlation_id = 0, Timestamp timestamp = 0) {
+    return PendingEvent{payload.category, 0, Status::Success, parent,
+                        correlation_id, payload, timestamp};
+}
+
+}  // namespace
+
+TEST_F(EventGraphTest, PushBatch_Empty_ReturnsZero) {
+    EXPECT_EQ(graph_.push_batch({}), 0U);
+    EXPECT_EQ(graph_.count(), 0U);
+}
+
+TEST_F(EventGraphTest, PushBatch_StoresEventsInOrderWithIds) {
+    std::vector<PendingEvent> batch;
+    for (uint32_t i = 0; i < 10; ++i) {
+        batch.push_back(make_pending(make_process_payload(100 + i), INVALID_EVENT,
+                                     0, 1000 + i));
+    }
+    std::vector<EventId> ids(batch.size(), INVALID_EVENT);
+
+    ASSERT_EQ(graph_.push_batch(batch, ids), batch.size());
+    EXPECT_EQ(graph_.count(), batch.size());
+
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        ASSERT_TRUE(graph_.exists(ids[i]));
+        EventView view = graph_.get(ids[i]);
+        EXPECT_EQ(view.as_process().pid, 100 + i);
+        EXPECT_EQ(view.timestamp(), 1000 + i);
+    }
+    EXPECT_EQ(graph_.category_count(Category::Process), batch.size());
+}
+
+TEST_F(EventGraphTest, PushBatch_AcrossSegments_IndexesEveryEvent) {
+    // Start mid-segment so the batch straddles a segment boundary
+    EventPayload lead = make_file_payload();
+    for (std::size_t i = 0; i < EventGraph::kSegmentSize - 5; ++i) {
+        graph_.push(Category::FileSystem, 0, Status::Success, INVALID_EVENT, 0, lead);
+    }
+    EventId parent = graph_.push(Category::Process, 0, Status::Success,
+                                 INVALID_EVENT, 0, make_process_payload());
+
+    std::vector<PendingEvent> batch;
+    for (int i = 0; i < 20; ++i) {
+        batch.push_back(i % 2 == 0 ? make_pending(make_network_payload(), parent, 7)
+                                   : make_pending(make_thread_payload(), parent, 7));
+    }
+    ASSERT_EQ(graph_.push_batch(batch), batch.size());
+
+    EXPECT_EQ(graph_.category_count(Category::Network), 10U);
+    EXPECT_EQ(graph_.category_count(Category::Thread), 10U);
+
+    int children = 0;
+    graph_.for_each_child(parent, [&children](EventView) { ++children; });
+    EXPECT_EQ(children, 20);
+
+    int correlated = 0;
+    graph_.for_each_correlation(7, [&correlated](EventView) { ++correlated; });
+    EXPECT_EQ(correlated, 20);
+
+    int network = 0;
+    graph_.for_each_category(Category::Network, [&network](EventView) { ++network; });
+    EXPECT_EQ(network, 10);
+}
+
+TEST_F(EventGraphTest, PushBatch_BeyondCapacity_StoresPrefix) {
+    Arena arena(16 * 1024 * 1024);
+    StringPool strings(arena);
+    EventGraph small(arena, strings, 8);
+
+    std::vector<PendingEvent> batch(12, make_pending(make_process_payload()));
+    EXPECT_EQ(small.push_batch(batch), 8U);
+    EXPECT_EQ(small.count(), 8U);
+    EXPECT_EQ(small.push_batch(batch), 0U);
+}
+
+TEST_F(EventGraphTest, PushBatch_ArenaExhausted_CountsOnlyStoredEvents) {
+    Arena arena(2 * 1024 * 1024);
+    StringPool strings(arena);
+    EventGraph graph(arena, strings, 65536);
+
+    std::vector<PendingEvent> batch(30000, make_pending(make_file_payload()));
+    const std::size_t accepted = graph.push_batch(batch);
+    ASSERT_GT(accepted, 0U);
+    ASSERT_LT(accepted, batch.size());  // The arena ran out of segments
+
+    EXPECT_EQ(graph.count(), accepted);
+    EXPECT_EQ(graph.category_count(Category::FileSystem), accepted);
+    std::size_t visited = 0;
+    graph.for_each_category(Category::FileSystem, [&visited](EventView) { ++visited; });
+    EXPECT_EQ(visited, accepted);
+}
+
+TEST_F(EventGraphTest, PushBatch_Concurrent_AllStored) {
+    constexpr int kThreads = 4;
+    constexpr int kBatches = 50;
+    constexpr std::size_t kBatchSize = 64;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([this]() {
+            std::vector<PendingEvent> batch(kBatchSize,
+                                            make_pending(make_registry_payload()));
+            for (int b = 0; b < kBatches; ++b) {
+                EXPECT_EQ(graph_.push_batch(batch), batch.size());
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    const auto expected = static_cast<std::size_t>(kThreads * kBatches) * kBatchSize;
+    EXPECT_EQ(graph_.count(), expected);
+    EXPECT_EQ(graph_.category_count(Category::Registry), expected);
+}
+
+// ============================================================================
+// In-Place Reserve and Commit
+// ============================================================================
+
+TEST_F(EventGraphTest, Reserve_InvisibleUntilCommit) {
+    const EventId parent = graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT,
+                                       0, make_process_payload());
+    const auto slot = graph_.reserve();
+    ASSERT_TRUE(slot);
+    slot.node->timestamp = 42;
+    slot.node->status = Status::Suspicious;
+    slot.node->operation = 3;
+    slot.node->payload = make_thread_payload(99);
+    EXPECT_EQ(graph_.count(), 1U);
+
+    const EventId id = graph_.commit(slot, parent, 5);
+    EXPECT_EQ(id, parent + 1);
+    EXPECT_EQ(graph_.count(), 2U);
+
+    EventView view = graph_.get(id);
+    EXPECT_EQ(view.parent_id(), parent);
+    EXPECT_EQ(view.correlation_id(), 5U);
+    EXPECT_EQ(view.timestamp(), 42U);
+    EXPECT_EQ(view.status(), Status::Suspicious);
+    EXPECT_EQ(view.as_thread().thread_id, 99U);
+    EXPECT_EQ(graph_.category_count(Category::Thread), 1U);
+}
+
+TEST_F(EventGraphTest, Reserve_LaterPushWaitsForCommit) {
+    const auto slot = graph_.reserve();
+    ASSERT_TRUE(slot);
+    graph_.push(Category::Network, 0, Status::Success, INVALID_EVENT, 0, make_network_payload());
+    EXPECT_EQ(graph_.count(), 0U);  // Watermark stops at the reserved slot
+
+    slot.node->timestamp = 1;
+    slot.node->status = Status::Success;
+    slot.node->operation = 0;
+    slot.node->payload = make_file_payload();
+    graph_.commit(slot, INVALID_EVENT, 0);
+    EXPECT_EQ(graph_.count(), 2U);
+}
+
+TEST_F(EventGraphTest, Reserve_AtCapacity_ReturnsEmpty) {
+    Arena small_arena{1024 * 1024};
+    StringPool small_strings{small_arena};
+    EventGraph small{small_arena, small_strings, 1};
+    small.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, make_process_payload());
+
+    EXPECT_FALSE(small.reserve());
+}
+
+}  // namespace exeray::event::test
@@ -0,0 +1,149 @@
+#include "event_graph_test_common.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "exeray/event/behavior_diff.hpp"
+#include "exeray/event/event_log.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+namespace {
+
+/// @brief Push one run of a program: its files, keys, lookups and modules.
+void run_program(EventGraph& graph, StringPool& strings, std::string_view temp,
+                 std::string_view version, std::uint16_t port, Timestamp at) {
+    const auto push = [&](Category category, EventPayload payload) {
+        payload.category = category;
+        graph.push(category, 0, Status::Success, INVALID_EVENT, 0, payload, at++);
+    };
+    EventPayload file{};
+    file.file.path = strings.intern_path(std::string("C:\\Users\\alice\\AppData\\Local\\Temp\\") +
+                                         std::string(temp));
+    push(Category::FileSystem, file);
+    push(Category::FileSystem, file);  // Seen twice, one feature
+    EventPayload key{};
+    key.registry.key_path = strings.intern_path("HKLM\\Software\\Vendor\\App");
+    push(Category::Registry, key);
+    EventPayload module{};
+    module.image.image_path = strings.intern_path(
+        std::string("C:\\Program Files\\App\\") + std::string(version) + "\\core.dll");
+    push(Category::Image, module);
+    EventPayload dns{};
+    dns.dns.domain = strings.intern("Update.Vendor.com.");
+    push(Category::Dns, dns);
+    EventPayload network{};
+    network.network.remote_port = port;
+    network.network.family = kAddressIPv4;
+    network.network.remote_domain = strings.intern("update.vendor.com");
+    push(Category::Network, network);
+}
+
+std::vector<std::string> described(const BehaviorSet& set,
+                                   const std::vector<std::uint64_t>& features) {
+    std::vector<std::string> texts;
+    for (const std::uint64_t feature : features) {
+        texts.emplace_back(set.describe(feature));
+    }
+    std::sort(texts.begin(), texts.end());
+    return texts;
+}
+
+}  // namespace
+
+// ============================================================================
+// Behavior diff
+// ============================================================================
+
+TEST(BehaviorPathTest, Normalize_CollapsesUsersAndVaryingRuns) {
+    EXPECT_EQ(normalize_behavior_path("C:\\Users\\Bob\\AppData\\Local\\Temp\\tmp4A1F.tmp"),
+              "c:\\users\\*\\appdata\\local\\temp\\tmp#.tmp");
+    EXPECT_EQ(normalize_behavior_path("C:/Program Files/App/1.2.3/x.dll"),
+              "c:\\program files\\app\\#.#.#\\x.dll");
+    EXPECT_EQ(normalize_behavior_path("C:\\ProgramData\\{3F2504E0-4F89-11D3-9A0C-0305E82C3301}"),
+              "c:\\programdata\\{#-#-#-#-#}");
+    EXPECT_EQ(normalize_behavior_path("HKCU\\Software\\Beef"), "hkcu\\software\\beef");
+    EXPECT_EQ(normalize_behavior_path(""), "");
+}
+
+TEST_F(EventGraphTest, BehaviorDiff_LiveGraphAgainstSavedLog) {
+    // The first run, saved to a log
+    Arena arena{16 * 1024 * 1024};
+    StringPool strings{arena};
+    EventGraph before{arena, strings, 4096};
+    run_program(before, strings, "tmp4A1F.tmp", "1.2.3", 443, 100);
+    const std::filesystem::path path =
+        std::filesystem::temp_directory_path() /
+        ("exeray_behavior_" +
+         std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+    {
+        EventLogWriter writer(before, strings);
+        ASSERT_TRUE(writer.open(path));
+        writer.stop();
+    }
+    MappedEventLog log;
+    ASSERT_TRUE(log.open(path));
+    const BehaviorSet first = BehaviorSet::from_log(log);
+
+    // The second run, live: another temp name and version, and a new port
+    run_program(graph_, strings_, "tmpC09B.tmp", "1.2.4", 4444, 200);
+    const BehaviorSet second = BehaviorSet::from_graph(graph_, strings_);
+
+    // File, key, module, domain, port
+    EXPECT_EQ(first.size(), 5u);
+    EXPECT_EQ(second.size(), 5u);
+    const BehaviorDiff diff = diff_behavior(first, second);
+    EXPECT_EQ(diff.shared, 4u);
+    ASSERT_EQ(diff.added.size(), 1u);
+    ASSERT_EQ(diff.removed.size(), 1u);
+    EXPECT_EQ(feature_kind(diff.added[0]), FeatureKind::RemotePort);
+    EXPECT_EQ(second.describe(diff.added[0]), "4444");
+    EXPECT_EQ(first.describe(diff.removed[0]), "443");
+    EXPECT_EQ(second.describe(diff.removed[0]), "");
+    EXPECT_DOUBLE_EQ(diff.similarity(), 4.0 / 6.0);
+
+    // Both the DNS query and the connection name the same domain
+    const auto features = second.features();
+    EXPECT_TRUE(std::is_sorted(features.begin(), features.end()));
+    const auto domains = std::count_if(features.begin(), features.end(), [](std::uint64_t f) {
+        return feature_kind(f) == FeatureKind::Domain;
+    });
+    EXPECT_EQ(domains, 1);
+    EXPECT_EQ(described(second, {features.begin(), features.end()}),
+              (std::vector<std::string>{
+                  "4444", "c:\\program files\\app\\#.#.#\\core.dll",
+                  "c:\\users\\*\\appdata\\local\\temp\\tmp#.tmp", "hklm\\software\\vendor\\app",
+                  "update.vendor.com"}));
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(std::filesystem::path(path) += ".exri");
+}
+
+TEST_F(EventGraphTest, BehaviorDiff_ScopeSelectsTheSession) {
+    run_program(graph_, strings_, "a1.tmp", "1.0", 80, 100);
+    run_program(graph_, strings_, "b.tmp", "1.0", 8080, 1000);
+
+    FilterSpec early;
+    early.to = 999;
+    FilterSpec late;
+    late.from = 1000;
+    const BehaviorSet first = BehaviorSet::from_graph(graph_, strings_, early);
+    const BehaviorSet second = BehaviorSet::from_graph(graph_, strings_, late);
+    const BehaviorDiff diff = diff_behavior(first, second);
+    EXPECT_EQ(described(second, diff.added),
+              (std::vector<std::string>{"8080", "c:\\users\\*\\appdata\\local\\temp\\b.tmp"}));
+    EXPECT_EQ(described(first, diff.removed),
+              (std::vector<std::string>{"80", "c:\\users\\*\\appdata\\local\\temp\\#.tmp"}));
+    EXPECT_TRUE(second.contains(diff.added[0]));
+    EXPECT_FALSE(first.contains(diff.added[0]));
+
+    const BehaviorDiff same = diff_behavior(first, first);
+    EXPECT_TRUE(same.added.empty() && same.removed.empty());
+    EXPECT_DOUBLE_EQ(same.similarity(), 1.0);
+}
+
+}  // namespace exeray::event::test
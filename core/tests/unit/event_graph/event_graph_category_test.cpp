@@ -66,4 +66,45 @@ TEST_F(EventGraphTest, ForEachCategory_Empty_NoCallbacks) {
     EXPECT_EQ(net_count, 0);
 }
 
+TEST_F(EventGraphTest, CategoryCount_MatchesPushes) {
+    for (int i = 0; i < 25; ++i) {
+        EventPayload p = make_process_payload();
+        graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+    }
+    for (int i = 0; i < 10; ++i) {
+        EventPayload p = make_file_payload();
+        graph_.push(Category::FileSystem, 0, Status::Success, INVALID_EVENT, 0, p);
+    }
+
+    EXPECT_EQ(graph_.category_count(Category::Process), 25U);
+    EXPECT_EQ(graph_.category_count(Category::FileSystem), 10U);
+    EXPECT_EQ(graph_.category_count(Category::Network), 0U);
+    EXPECT_EQ(graph_.category_count(Category::Count), 0U);
+}
+
+TEST_F(EventGraphTest, ForEachCategory_InterleavedAcrossSegments_InPushOrder) {
+    // Interleave two categories over more than one segment
+    constexpr std::size_t kTotal = EventGraph::kSegmentSize + 100;
+    std::vector<EventId> file_ids;
+    for (std::size_t i = 0; i < kTotal; ++i) {
+        if (i % 3 == 0) {
+            EventPayload p = make_file_payload();
+            file_ids.push_back(graph_.push(Category::FileSystem, 0, Status::Success,
+                                           INVALID_EVENT, 0, p));
+        } else {
+            EventPayload p = make_process_payload();
+            graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+        }
+    }
+
+    std::vector<EventId> visited;
+    graph_.for_each_category(Category::FileSystem, [&visited](EventView view) {
+        EXPECT_EQ(view.category(), Category::FileSystem);
+        visited.push_back(view.id());
+    });
+
+    EXPECT_EQ(visited, file_ids);
+    EXPECT_EQ(graph_.category_count(Category::FileSystem), file_ids.size());
+}
+
 }  // namespace exeray::event::test
@@ -0,0 +1,288 @@
+#include "event_graph_test_common.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// 16. Columnar Sealed Segments
+// ============================================================================
+
+class EventGraphColumnarTest : public EventGraphTest {
+protected:
+    /// Push a mix of network and process events over several segments.
+    void push_mixed(EventGraph& graph, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            if (i % 4 == 0) {
+                EventPayload p = make_network_payload(i % 8 == 0 ? 443 : 80);
+                graph.push(Category::Network, 0, Status::Success, INVALID_EVENT, 0, p);
+            } else {
+                EventPayload p = make_process_payload(static_cast<uint32_t>(i % 5));
+                graph.push(Category::Process, 1,
+                           i % 3 == 0 ? Status::Denied : Status::Success,
+                           INVALID_EVENT, 0, p);
+            }
+        }
+    }
+
+    /// Reference result: matching IDs found by a full row scan.
+    static std::vector<EventId> reference(const EventGraph& graph, const FilterSpec& spec) {
+        std::vector<EventId> ids;
+        graph.for_each([&](EventView view) {
+            const uint32_t pid = event_pid(view.payload());
+            const uint16_t port = event_remote_port(view.payload());
+            if (spec.matches(view.timestamp(), view.category(), view.operation(),
+                             view.status(), pid, port, view.correlation_id())) {
+                ids.push_back(view.id());
+            }
+        });
+        return ids;
+    }
+
+    static std::vector<EventId> collect(const EventGraph& graph, const FilterSpec& spec) {
+        std::vector<EventId> ids;
+        graph.for_each_where(spec, [&ids](EventView view) { ids.push_back(view.id()); });
+        return ids;
+    }
+};
+
+TEST_F(EventGraphColumnarTest, Disabled_NothingSealed) {
+    push_mixed(graph_, EventGraph::kSegmentSize * 2);
+    EXPECT_EQ(graph_.sealed_count(), 0U);
+}
+
+TEST_F(EventGraphColumnarTest, Enabled_SealsOnlyFullSegments) {
+    graph_.set_columnar(true);
+    push_mixed(graph_, EventGraph::kSegmentSize * 3 + 10);
+    EXPECT_EQ(graph_.sealed_count(), 3U);
+}
+
+TEST_F(EventGraphColumnarTest, SealSegments_CatchesUpAfterEnabling) {
+    push_mixed(graph_, EventGraph::kSegmentSize * 2 + 1);
+    EXPECT_EQ(graph_.seal_segments(), 2U);
+    EXPECT_EQ(graph_.seal_segments(), 0U);
+    EXPECT_EQ(graph_.sealed_count(), 2U);
+}
+
+TEST_F(EventGraphColumnarTest, ForEachWhere_SealedAndHot_MatchReference) {
+    graph_.set_columnar(true);
+    push_mixed(graph_, EventGraph::kSegmentSize * 2 + 500);
+    ASSERT_EQ(graph_.sealed_count(), 2U);
+
+    FilterSpec port443;
+    port443.with_category(Category::Network).remote_port = 443;
+    EXPECT_EQ(collect(graph_, port443), reference(graph_, port443));
+    EXPECT_FALSE(collect(graph_, port443).empty());
+
+    FilterSpec denied_pid;
+    denied_pid.with_status(Status::Denied).pid = 3;
+    EXPECT_EQ(collect(graph_, denied_pid), reference(graph_, denied_pid));
+
+    FilterSpec op1;
+    op1.operation = 1;
+    EXPECT_EQ(collect(graph_, op1), reference(graph_, op1));
+
+    FilterSpec any;
+    EXPECT_EQ(collect(graph_, any).size(), graph_.count());
+}
+
+TEST_F(EventGraphColumnarTest, SetStatus_UpdatesSealedColumns) {
+    graph_.set_columnar(true);
+    push_mixed(graph_, EventGraph::kSegmentSize * 2);
+    ASSERT_EQ(graph_.sealed_count(), 2U);
+
+    ASSERT_TRUE(graph_.set_status(5, Status::Suspicious));
+    FilterSpec suspicious;
+    suspicious.with_status(Status::Suspicious);
+    EXPECT_EQ(collect(graph_, suspicious), std::vector<EventId>{5});
+    EXPECT_EQ(collect(graph_, suspicious), reference(graph_, suspicious));
+}
+
+TEST_F(EventGraphColumnarTest, RowGroups_CombinedKeys_MatchReference) {
+    graph_.set_columnar(true);
+    // Correlation 7 is dense in the first segment, 9 is a handful of rows
+    for (std::size_t i = 0; i < EventGraph::kSegmentSize * 2; ++i) {
+        const uint32_t correlation =
+            i < EventGraph::kSegmentSize / 2 ? 7 : (i % 997 == 0 ? 9 : 1);
+        EventPayload p = i % 2 == 0 ? make_file_payload() : make_registry_payload();
+        graph_.push(p.category, 0, i % 5 == 0 ? Status::Suspicious : Status::Success,
+                    INVALID_EVENT, correlation, p);
+    }
+    ASSERT_EQ(graph_.sealed_count(), 2U);
+
+    FilterSpec dense;
+    dense.with_category(Category::FileSystem).with_category(Category::Dns).correlation_id = 7;
+    EXPECT_EQ(collect(graph_, dense), reference(graph_, dense));
+    EXPECT_EQ(collect(graph_, dense).size(), EventGraph::kSegmentSize / 4);
+
+    FilterSpec sparse;
+    sparse.with_status(Status::Suspicious).correlation_id = 9;
+    EXPECT_EQ(collect(graph_, sparse), reference(graph_, sparse));
+
+    FilterSpec with_rest;
+    with_rest.with_category(Category::Registry).with_status(Status::Success).operation = 0;
+    with_rest.from = graph_.get(100).timestamp();
+    EXPECT_EQ(collect(graph_, with_rest), reference(graph_, with_rest));
+
+    FilterSpec none;
+    none.with_category(Category::Network).correlation_id = 7;
+    EXPECT_TRUE(collect(graph_, none).empty());
+}
+
+/// Heap arrays backing one RowGroups of rows rows.
+struct GroupStorage {
+    explicit GroupStorage(std::size_t rows)
+        : keys(rows), offsets(rows + 1), row_list(rows), dense(rows),
+          bitmaps(rows / RowGroups::kDenseRows * rows / 64) {}
+
+    RowGroups groups() {
+        return {keys.data(), offsets.data(), row_list.data(), dense.data(), bitmaps.data(), 0};
+    }
+
+    std::vector<uint32_t> keys;
+    std::vector<uint32_t> offsets;
+    std::vector<uint16_t> row_list;
+    std::vector<int16_t> dense;
+    std::vector<uint64_t> bitmaps;
+};
+
+TEST(SegmentBitmapsTest, FilterSealed_DenseAndSparseKeys) {
+    constexpr std::size_t kRows = 1024;
+    std::vector<Timestamp> timestamps(kRows);
+    std::vector<uint32_t> correlations(kRows), pids(kRows);
+    std::vector<uint16_t> ports(kRows);
+    std::vector<Category> categories(kRows);
+    std::vector<uint8_t> operations(kRows);
+    std::vector<Status> statuses(kRows);
+    for (std::size_t i = 0; i < kRows; ++i) {
+        categories[i] = i % 3 == 0 ? Category::Network : Category::Process;  // Dense
+        statuses[i] = i % 100 == 0 ? Status::Denied : Status::Success;       // Sparse
+        correlations[i] = static_cast<uint32_t>(i % 300);
+    }
+    const SegmentColumns columns{timestamps.data(), correlations.data(), pids.data(),
+                                 ports.data(),      categories.data(),   operations.data(),
+                                 statuses.data()};
+
+    GroupStorage category_storage(kRows), status_storage(kRows), correlation_storage(kRows);
+    SegmentBitmaps bitmaps;
+    bitmaps.categories = category_storage.groups();
+    bitmaps.statuses = status_storage.groups();
+    bitmaps.correlations = correlation_storage.groups();
+    store_bitmaps(bitmaps, columns, kRows);
+    EXPECT_EQ(bitmaps.categories.key_count, 2U);
+    EXPECT_EQ(bitmaps.correlations.key_count, 300U);
+
+    FilterSpec spec;
+    spec.with_category(Category::Network).with_status(Status::Denied);
+    std::vector<uint64_t> expected(kRows / 64), mask(kRows / 64);
+    filter_columns(columns, kRows, spec, expected.data());
+    EXPECT_TRUE(filter_sealed(columns, &bitmaps, kRows, spec, mask.data()));
+    EXPECT_EQ(mask, expected);
+
+    spec.correlation_id = 1;  // Rows 1, 301, 601, 901: none a multiple of 3 and 100
+    EXPECT_FALSE(filter_sealed(columns, &bitmaps, kRows, spec, mask.data()));
+    EXPECT_EQ(mask, std::vector<uint64_t>(kRows / 64, 0));
+}
+
+TEST_F(EventGraphColumnarTest, StringFilter_SealedAndHot_MatchViewReference) {
+    graph_.set_columnar(true);
+    const StringId rare = strings_.intern("C:\\rare.dll");
+    const StringId common = strings_.intern("C:\\common.dll");
+    std::vector<EventId> expected;
+    for (std::size_t i = 0; i < EventGraph::kSegmentSize * 3 + 100; ++i) {
+        EventPayload p = make_file_payload(i % 3001 == 5 ? rare : common);
+        const EventId id =
+            graph_.push(Category::FileSystem, 0, Status::Success, INVALID_EVENT, 0, p);
+        if (i % 3001 == 5) {
+            expected.push_back(id);
+        }
+    }
+    ASSERT_EQ(graph_.sealed_count(), 3U);
+
+    FilterSpec spec;
+    spec.string_id = rare;
+    EXPECT_EQ(collect(graph_, spec), expected);
+    std::vector<EventId> scanned;
+    graph_.scan(spec, scanned);
+    EXPECT_EQ(scanned, expected);
+
+    spec.string_id = strings_.intern("C:\\never.dll");
+    EXPECT_TRUE(collect(graph_, spec).empty());
+}
+
+TEST(SegmentZoneTest, MayMatch_ReflectsCategoriesStatusesPidsAndStrings) {
+    constexpr std::size_t kRows = 256;
+    std::vector<Timestamp> timestamps(kRows);
+    std::vector<uint32_t> correlations(kRows), pids(kRows);
+    std::vector<uint16_t> ports(kRows);
+    std::vector<Category> categories(kRows, Category::Process);
+    std::vector<uint8_t> operations(kRows);
+    std::vector<Status> statuses(kRows, Status::Success);
+    std::vector<EventNode> nodes(kRows);
+    for (std::size_t i = 0; i < kRows; ++i) {
+        pids[i] = static_cast<uint32_t>(1000 + i);
+        nodes[i].payload.category = Category::Process;
+        nodes[i].payload.process.image_path = static_cast<StringId>(50 + i);
+    }
+    const SegmentColumns columns{timestamps.data(), correlations.data(), pids.data(),
+                                 ports.data(),      categories.data(),   operations.data(),
+                                 statuses.data()};
+    SegmentZone zone;
+    store_zone(zone, columns, nodes.data(), kRows);
+
+    FilterSpec spec;
+    EXPECT_TRUE(zone.may_match(spec));
+    spec.with_category(Category::Network);
+    EXPECT_FALSE(zone.may_match(spec));
+    spec.with_category(Category::Process);
+    EXPECT_TRUE(zone.may_match(spec));
+
+    spec.with_status(Status::Suspicious);
+    EXPECT_FALSE(zone.may_match(spec));
+    spec.statuses = 0;
+
+    for (std::size_t i = 0; i < kRows; ++i) {
+        spec.pid = pids[i];
+        ASSERT_TRUE(zone.may_match(spec));  // No false negatives
+    }
+    int rejected = 0;
+    for (uint32_t pid = 1; pid < 1000; ++pid) {
+        spec.pid = pid;
+        rejected += zone.may_match(spec) ? 0 : 1;
+    }
+    EXPECT_GT(rejected, 700);  // 256 PIDs fill about 40% of the bits
+    spec.pid = 0;
+
+    spec.string_id = 60;
+    EXPECT_TRUE(zone.may_match(spec));
+    spec.string_id = 5000;
+    EXPECT_FALSE(zone.may_match(spec));
+}
+
+TEST_F(EventGraphColumnarTest, ForEachWhere_TimeRange_MatchesReference) {
+    graph_.set_columnar(true);
+    push_mixed(graph_, EventGraph::kSegmentSize * 3);
+
+    FilterSpec window;
+    window.from = graph_.get(EventGraph::kSegmentSize / 2).timestamp();
+    window.to = graph_.get(EventGraph::kSegmentSize * 2 + 7).timestamp();
+    window.with_category(Category::Process);
+    EXPECT_EQ(collect(graph_, window), reference(graph_, window));
+}
+
+TEST_F(EventGraphColumnarTest, RingMode_RecycledSegmentsResealed) {
+    Arena arena(32 * 1024 * 1024);
+    StringPool strings(arena);
+    EventGraph ring(arena, strings, EventGraph::kSegmentSize * 2, Retention::Ring);
+    ring.set_columnar(true);
+    push_mixed(ring, EventGraph::kSegmentSize * 5);
+
+    FilterSpec net;
+    net.with_category(Category::Network);
+    EXPECT_EQ(collect(ring, net), reference(ring, net));
+    for (EventId id : collect(ring, net)) {
+        EXPECT_FALSE(ring.is_evicted(id));
+    }
+}
+
+}  // namespace exeray::event::test
@@ -0,0 +1,205 @@
+#include "event_graph_test_common.hpp"
+
+#include <cstring>
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// Compressed Cold Segments
+// ============================================================================
+
+class EventGraphCompressionTest : public EventGraphTest {
+protected:
+    static CompressionConfig compression(std::size_t hot, std::size_t cache) {
+        return {.enabled = true, .hot_segments = hot, .cache_segments = cache};
+    }
+
+    /// Push the same mix of process and network events into graph.
+    static void push_mixed(EventGraph& graph, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto timestamp = static_cast<Timestamp>(1000 + i * 10);
+            if (i % 4 == 0) {
+                EventPayload p = make_network_payload(i % 8 == 0 ? 443 : 80);
+                graph.push(Category::Network, 0, Status::Success, INVALID_EVENT, 0, p,
+                           timestamp);
+            } else {
+                EventPayload p = make_process_payload(static_cast<uint32_t>(4 * (i % 5) + 4));
+                graph.push(Category::Process, 1, i % 3 == 0 ? Status::Denied : Status::Success,
+                           INVALID_EVENT, static_cast<uint32_t>(i % 7), p, timestamp);
+            }
+        }
+    }
+
+    static std::vector<EventId> ids_of(const EventGraph& graph, const FilterSpec& spec) {
+        std::vector<EventId> ids;
+        graph.for_each_where(spec, [&ids](EventView view) { ids.push_back(view.id()); });
+        return ids;
+    }
+
+    /// Reference graph without compression, holding the same events.
+    Arena plain_arena_{kArenaSize};
+    StringPool plain_strings_{plain_arena_};
+    EventGraph plain_{plain_arena_, plain_strings_, kDefaultCapacity};
+};
+
+TEST_F(EventGraphCompressionTest, Disabled_NothingCompressed) {
+    push_mixed(graph_, EventGraph::kSegmentSize * 3);
+    EXPECT_EQ(graph_.compress_segments(), 0U);
+    EXPECT_EQ(graph_.compression_stats().segments, 0U);
+}
+
+TEST_F(EventGraphCompressionTest, RingRetention_Refused) {
+    EventGraph ring(arena_, strings_, kDefaultCapacity, Retention::Ring);
+    EXPECT_FALSE(ring.set_compression(compression(1, 2)));
+    EXPECT_TRUE(ring.set_compression({}));
+}
+
+TEST_F(EventGraphCompressionTest, Enabled_CompressesOutsideHotWindow) {
+    ASSERT_TRUE(graph_.set_compression(compression(2, 2)));
+    push_mixed(graph_, EventGraph::kSegmentSize * 6 + 10);
+    push_mixed(plain_, EventGraph::kSegmentSize * 6 + 10);
+
+    const CompressionStats stats = graph_.compression_stats();
+    EXPECT_EQ(stats.segments, 4U);
+    EXPECT_EQ(stats.raw_bytes, 4 * EventGraph::kSegmentSize * sizeof(EventNode));
+    EXPECT_GT(stats.ratio(), 4.0);
+    EXPECT_EQ(graph_.compress_segments(), 0U);
+
+    // Storage of compressed segments went to the newer ones
+    EXPECT_EQ(graph_.segment_count(), plain_.segment_count());
+    EXPECT_LT(graph_.storage_bytes() + 3 * EventGraph::kSegmentSize * sizeof(EventNode),
+              plain_.storage_bytes());
+}
+
+TEST_F(EventGraphCompressionTest, Queries_MatchUncompressedGraph) {
+    ASSERT_TRUE(graph_.set_compression(compression(1, 2)));
+    push_mixed(graph_, EventGraph::kSegmentSize * 5 + 77);
+    push_mixed(plain_, EventGraph::kSegmentSize * 5 + 77);
+    ASSERT_EQ(graph_.compression_stats().segments, 4U);
+
+    std::vector<EventNode> all;
+    graph_.for_each_span([&all](std::span<const EventNode> run) {
+        all.insert(all.end(), run.begin(), run.end());
+    });
+    std::vector<EventNode> expected;
+    plain_.for_each_span([&expected](std::span<const EventNode> run) {
+        expected.insert(expected.end(), run.begin(), run.end());
+    });
+    ASSERT_EQ(all.size(), expected.size());
+    EXPECT_EQ(std::memcmp(all.data(), expected.data(), all.size() * sizeof(EventNode)), 0);
+
+    for (const EventId id : {EventId{1}, EventId{4097}, EventId{9000}, EventId{20000}}) {
+        ASSERT_TRUE(graph_.exists(id));
+        EXPECT_EQ(graph_.get(id).id(), id);
+        EXPECT_EQ(graph_.get(id).timestamp(), plain_.get(id).timestamp());
+    }
+
+    FilterSpec denied;
+    denied.with_status(Status::Denied).pid = 8;
+    EXPECT_EQ(ids_of(graph_, denied), ids_of(plain_, denied));
+    EXPECT_FALSE(ids_of(graph_, denied).empty());
+
+    std::vector<EventId> scanned;
+    std::vector<EventId> scanned_plain;
+    graph_.scan(denied, scanned);
+    plain_.scan(denied, scanned_plain);
+    EXPECT_EQ(scanned, scanned_plain);
+
+    std::size_t in_range = 0;
+    graph_.for_each_in_range(5000, 60000, [&in_range](EventView) { ++in_range; });
+    std::size_t in_range_plain = 0;
+    plain_.for_each_in_range(5000, 60000, [&in_range_plain](EventView) { ++in_range_plain; });
+    EXPECT_EQ(in_range, in_range_plain);
+
+    std::vector<EventId> correlated;
+    graph_.for_each_correlation(3, [&correlated](EventView view) {
+        correlated.push_back(view.id());
+    });
+    std::vector<EventId> correlated_plain;
+    plain_.for_each_correlation(3, [&correlated_plain](EventView view) {
+        correlated_plain.push_back(view.id());
+    });
+    EXPECT_EQ(correlated, correlated_plain);
+
+    const CompressionStats stats = graph_.compression_stats();
+    EXPECT_GT(stats.decodes, 0U);
+    EXPECT_GT(stats.cache_hits, 0U);
+}
+
+TEST_F(EventGraphCompressionTest, SealedColdSegments_FilterMatchesUncompressed) {
+    graph_.set_columnar(true);
+    plain_.set_columnar(true);
+    ASSERT_TRUE(graph_.set_compression(compression(1, 1)));
+    push_mixed(graph_, EventGraph::kSegmentSize * 4);
+    push_mixed(plain_, EventGraph::kSegmentSize * 4);
+
+    FilterSpec port443;
+    port443.with_category(Category::Network).remote_port = 443;
+    EXPECT_EQ(ids_of(graph_, port443), ids_of(plain_, port443));
+
+    // Segment summaries rule out every cold segment without decoding it
+    const std::uint64_t decodes = graph_.compression_stats().decodes;
+    FilterSpec none;
+    none.with_category(Category::Registry);
+    EXPECT_TRUE(ids_of(graph_, none).empty());
+    EXPECT_EQ(graph_.compression_stats().decodes, decodes);
+}
+
+TEST_F(EventGraphCompressionTest, SetStatus_SurvivesCacheEviction) {
+    ASSERT_TRUE(graph_.set_compression(compression(1, 1)));
+    push_mixed(graph_, EventGraph::kSegmentSize * 4);
+    ASSERT_EQ(graph_.compression_stats().segments, 3U);
+
+    const EventId cold = 10;
+    ASSERT_TRUE(graph_.set_status(cold, Status::Suspicious));
+    ASSERT_TRUE(graph_.set_extension(cold, 42));
+
+    // Read two other cold segments through the one-entry cache
+    EXPECT_EQ(graph_.get(EventGraph::kSegmentSize + 1).id(), EventGraph::kSegmentSize + 1);
+    EXPECT_EQ(graph_.get(2 * EventGraph::kSegmentSize + 1).id(),
+              2 * EventGraph::kSegmentSize + 1);
+    EXPECT_GE(graph_.compression_stats().repacks, 1U);
+
+    EXPECT_EQ(graph_.get(cold).status(), Status::Suspicious);
+    EXPECT_EQ(graph_.get(cold).payload().extension, 42U);
+}
+
+TEST_F(EventGraphCompressionTest, View_OutlivesCacheEntry) {
+    ASSERT_TRUE(graph_.set_compression(compression(1, 1)));
+    push_mixed(graph_, EventGraph::kSegmentSize * 4);
+    push_mixed(plain_, EventGraph::kSegmentSize * 4);
+
+    const EventView view = graph_.get(5);
+    (void)graph_.get(EventGraph::kSegmentSize + 5);
+    (void)graph_.get(2 * EventGraph::kSegmentSize + 5);
+    EXPECT_EQ(view.id(), 5U);
+    EXPECT_EQ(view.timestamp(), plain_.get(5).timestamp());
+}
+
+TEST_F(EventGraphCompressionTest, ConcurrentReaders_SeeEveryEvent) {
+    ASSERT_TRUE(graph_.set_compression(compression(1, 3)));
+    push_mixed(graph_, EventGraph::kSegmentSize * 6);
+
+    std::atomic<std::size_t> wrong{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([this, &wrong, t] {
+            for (std::size_t i = 0; i < 1000; ++i) {
+                const auto id = static_cast<EventId>((i * 7919 + t * 104729) %
+                                                     (EventGraph::kSegmentSize * 6)) +
+                                1;
+                if (graph_.get(id).id() != id) {
+                    wrong.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(wrong.load(), 0U);
+}
+
+}  // namespace exeray::event::test
@@ -180,4 +180,71 @@ TEST_F(EventGraphTest, Push_ConcurrentWithGet_SafeRead) {
     EXPECT_EQ(read_count.load(), kNumReaders * 100);
 }
 
+TEST_F(EventGraphTest, Push_Concurrent_IdMatchesStoredNode) {
+    constexpr int kNumThreads = 8;
+    constexpr int kEventsPerThread = 4000;
+    std::vector<std::thread> threads;
+    std::atomic<int> mismatches{0};
+
+    for (int t = 0; t < kNumThreads; ++t) {
+        threads.emplace_back([this, t, &mismatches]() {
+            for (int i = 0; i < kEventsPerThread; ++i) {
+                const auto pid = static_cast<uint32_t>(t * kEventsPerThread + i);
+                EventPayload p = make_process_payload(pid);
+                EventId id = graph_.push(Category::Process, 0, Status::Success,
+                                         INVALID_EVENT, 0, p);
+                // A push is visible through its own ID as soon as it returns
+                if (!graph_.exists(id) || graph_.get(id).id() != id ||
+                    graph_.get(id).as_process().pid != pid) {
+                    ++mismatches;
+                }
+            }
+        });
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(mismatches.load(), 0);
+    EXPECT_EQ(graph_.count(), static_cast<std::size_t>(kNumThreads * kEventsPerThread));
+}
+
+TEST_F(EventGraphTest, Count_ConcurrentReaders_OnlySeeWrittenNodes) {
+    constexpr int kNumWriters = 4;
+    constexpr int kEventsPerWriter = 5000;
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+
+    std::thread reader([this, &done, &torn]() {
+        while (!done.load(std::memory_order_acquire)) {
+            // Every event below the watermark must carry its own ID
+            const auto visible = graph_.count();
+            for (std::size_t i = visible; i > 0 && i + 64 > visible; --i) {
+                if (graph_.get(static_cast<EventId>(i)).id() != i) {
+                    ++torn;
+                }
+            }
+        }
+    });
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < kNumWriters; ++w) {
+        writers.emplace_back([this]() {
+            for (int i = 0; i < kEventsPerWriter; ++i) {
+                EventPayload p = make_thread_payload();
+                graph_.push(Category::Thread, 0, Status::Success, INVALID_EVENT, 0, p);
+            }
+        });
+    }
+    for (auto& t : writers) {
+        t.join();
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(graph_.count(), static_cast<std::size_t>(kNumWriters * kEventsPerWriter));
+}
+
 }  // namespace exeray::event::test
@@ -0,0 +1,204 @@
+#include "event_graph_test_common.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// 18. Incremental Counters
+// ============================================================================
+
+class EventGraphCountersTest : public EventGraphTest {
+protected:
+    /// Push a mix of categories, statuses and pids.
+    static void push_mixed(EventGraph& graph, std::size_t n) {
+        constexpr Status kStatuses[] = {Status::Success, Status::Denied, Status::Error,
+                                        Status::Suspicious};
+        for (std::size_t i = 0; i < n; ++i) {
+            const Status status = kStatuses[i % 4];
+            if (i % 3 == 0) {
+                EventPayload p = make_network_payload();
+                graph.push(Category::Network, 0, status, INVALID_EVENT, 0, p);
+            } else if (i % 3 == 1) {
+                EventPayload p = make_process_payload(static_cast<uint32_t>(100 + i % 7));
+                graph.push(Category::Process, 0, status, INVALID_EVENT, 0, p);
+            } else {
+                EventPayload p = make_thread_payload();
+                p.thread.process_id = static_cast<uint32_t>(200 + i % 3);
+                graph.push(Category::Thread, 0, status, INVALID_EVENT, 0, p);
+            }
+        }
+    }
+
+    /// Reference snapshot computed by a full scan.
+    static CounterSnapshot reference(const EventGraph& graph) {
+        CounterSnapshot snap;
+        graph.for_each([&snap](EventView view) {
+            ++snap.cells[static_cast<std::size_t>(view.category())]
+                        [static_cast<std::size_t>(view.status())];
+        });
+        return snap;
+    }
+
+    /// Reference per-pid count computed by a full scan.
+    static std::uint64_t reference_pid(const EventGraph& graph, uint32_t pid) {
+        std::uint64_t n = 0;
+        graph.for_each([&](EventView view) {
+            if (event_pid(view.payload()) == pid) {
+                ++n;
+            }
+        });
+        return n;
+    }
+};
+
+TEST_F(EventGraphCountersTest, Empty_AllZero) {
+    const CounterSnapshot snap = graph_.counters().snapshot();
+    EXPECT_EQ(snap.total(), 0U);
+    EXPECT_EQ(graph_.counters().pid_count(1234), 0U);
+    std::array<PidCount, 4> top{};
+    EXPECT_EQ(graph_.counters().top_pids(top), 0U);
+}
+
+TEST_F(EventGraphCountersTest, Push_MatchesFullScan) {
+    push_mixed(graph_, 1000);
+    const CounterSnapshot snap = graph_.counters().snapshot();
+    EXPECT_EQ(snap.cells, reference(graph_).cells);
+    EXPECT_EQ(snap.total(), graph_.count());
+    EXPECT_EQ(snap.status(Status::Suspicious), 250U);
+    EXPECT_EQ(snap.status(Status::Pending), 0U);
+    for (auto cat : {Category::Network, Category::Process, Category::Thread}) {
+        EXPECT_EQ(snap.category(cat), graph_.category_count(cat));
+    }
+}
+
+TEST_F(EventGraphCountersTest, PidCounts_AttributeThreadAndProcessEvents) {
+    push_mixed(graph_, 1000);
+    for (uint32_t pid : {100u, 103u, 106u, 200u, 202u}) {
+        EXPECT_EQ(graph_.counters().pid_count(pid), reference_pid(graph_, pid)) << pid;
+    }
+    // Network events carry no pid
+    EXPECT_EQ(graph_.counters().pid_count(0), 0U);
+
+    std::array<PidCount, 3> top{};
+    ASSERT_EQ(graph_.counters().top_pids(top), 3U);
+    EXPECT_GE(top[0].count, top[1].count);
+    EXPECT_GE(top[1].count, top[2].count);
+    EXPECT_EQ(top[0].count, reference_pid(graph_, top[0].pid));
+}
+
+TEST_F(EventGraphCountersTest, PushBatch_Counted) {
+    EventPayload p = make_process_payload(77);
+    std::vector<PendingEvent> batch(
+        50, PendingEvent{Category::Process, 0, Status::Suspicious, INVALID_EVENT, 0, p, 0});
+    ASSERT_EQ(graph_.push_batch(batch), batch.size());
+
+    const CounterSnapshot snap = graph_.counters().snapshot();
+    EXPECT_EQ(snap.at(Category::Process, Status::Suspicious), 50U);
+    EXPECT_EQ(graph_.counters().pid_count(77), 50U);
+}
+
+TEST_F(EventGraphCountersTest, RingMode_EvictionUncounts) {
+    Arena arena(16 * 1024 * 1024);
+    StringPool strings(arena);
+    EventGraph ring(arena, strings, EventGraph::kSegmentSize * 2, Retention::Ring);
+    push_mixed(ring, EventGraph::kSegmentSize * 5 + 123);
+
+    const CounterSnapshot snap = ring.counters().snapshot();
+    EXPECT_EQ(snap.total(), ring.count());
+    EXPECT_EQ(snap.cells, reference(ring).cells);
+    for (uint32_t pid : {100u, 104u, 201u}) {
+        EXPECT_EQ(ring.counters().pid_count(pid), reference_pid(ring, pid)) << pid;
+    }
+}
+
+TEST_F(EventGraphCountersTest, ConcurrentPush_TotalsExact) {
+    constexpr int kThreads = 8;
+    constexpr int kPerThread = 2000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([this, t]() {
+            EventPayload p = make_process_payload(static_cast<uint32_t>(1000 + t));
+            for (int i = 0; i < kPerThread; ++i) {
+                graph_.push(Category::Process, 0,
+                            i % 2 == 0 ? Status::Success : Status::Suspicious,
+                            INVALID_EVENT, 0, p);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    const CounterSnapshot snap = graph_.counters().snapshot();
+    EXPECT_EQ(snap.at(Category::Process, Status::Success), kThreads * kPerThread / 2U);
+    EXPECT_EQ(snap.at(Category::Process, Status::Suspicious), kThreads * kPerThread / 2U);
+    for (int t = 0; t < kThreads; ++t) {
+        EXPECT_EQ(graph_.counters().pid_count(static_cast<uint32_t>(1000 + t)),
+                  static_cast<std::uint64_t>(kPerThread));
+    }
+}
+
+TEST_F(EventGraphCountersTest, SetStatus_MovesCountAndUpdatesNode) {
+    EventPayload p = make_process_payload(42);
+    const EventId id = graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+
+    EXPECT_TRUE(graph_.set_status(id, Status::Suspicious));
+    EXPECT_EQ(graph_.get(id).status(), Status::Suspicious);
+    EXPECT_FALSE(graph_.set_status(id, Status::Suspicious));  // Unchanged
+    EXPECT_FALSE(graph_.set_status(id + 1, Status::Suspicious));  // Never pushed
+
+    const CounterSnapshot snap = graph_.counters().snapshot();
+    EXPECT_EQ(snap.at(Category::Process, Status::Success), 0U);
+    EXPECT_EQ(snap.at(Category::Process, Status::Suspicious), 1U);
+    EXPECT_EQ(graph_.counters().pid_count(42), 1U);
+}
+
+TEST_F(EventGraphCountersTest, Pushed_CumulativeAcrossStatusChangesAndEviction) {
+    EventPayload p = make_process_payload(42);
+    const EventId id = graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+    graph_.push(Category::Process, 0, Status::Suspicious, INVALID_EVENT, 0, p);
+    EXPECT_TRUE(graph_.set_status(id, Status::Suspicious));
+    EXPECT_TRUE(graph_.set_status(id, Status::Denied));
+
+    const CounterSnapshot snap = graph_.counters().snapshot();
+    EXPECT_EQ(snap.pushed[static_cast<std::size_t>(Category::Process)], 2U);
+    EXPECT_EQ(snap.flagged, 2U);  // Pushed as, and once marked, Suspicious
+    EXPECT_EQ(snap.at(Category::Process, Status::Denied), 1U);
+    EXPECT_EQ(graph_.counters().pid_count(42), 2U);
+
+    Arena arena(16 * 1024 * 1024);
+    StringPool strings(arena);
+    EventGraph ring(arena, strings, EventGraph::kSegmentSize * 2, Retention::Ring);
+    push_mixed(ring, EventGraph::kSegmentSize * 5);
+    const CounterSnapshot ring_snap = ring.counters().snapshot();
+    std::uint64_t pushed = 0;
+    for (const auto n : ring_snap.pushed) {
+        pushed += n;
+    }
+    EXPECT_EQ(pushed, EventGraph::kSegmentSize * 5);  // Eviction only uncounts live cells
+    EXPECT_LT(ring_snap.total(), pushed);
+}
+
+TEST(EventCountersTest, PidTableFull_CountsUntracked) {
+    EventCounters counters;
+    constexpr uint32_t kPids = EventCounters::kPidSlots + 500;
+    for (uint32_t pid = 1; pid <= kPids; ++pid) {
+        counters.add(Category::Process, Status::Success, pid);
+    }
+
+    std::uint64_t tracked = 0;
+    for (uint32_t pid = 1; pid <= kPids; ++pid) {
+        tracked += counters.pid_count(pid);
+    }
+    EXPECT_GT(counters.untracked_pids(), 0U);
+    EXPECT_EQ(tracked + counters.untracked_pids(), kPids);
+
+    for (uint32_t pid = 1; pid <= kPids; ++pid) {
+        counters.remove(Category::Process, Status::Success, pid);
+    }
+    EXPECT_EQ(counters.untracked_pids(), 0U);
+    EXPECT_EQ(counters.snapshot().total(), 0U);
+}
+
+}  // namespace exeray::event::test
@@ -0,0 +1,164 @@
+/// @file event_graph_forwarder_test.cpp
+/// @brief Tests for forwarding events to a collector over TCP.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/event/event_log.hpp"
+#include "exeray/event/forwarder.hpp"
+#include "exeray/event/graph.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace exeray::event {
+namespace {
+
+constexpr std::size_t kArenaSize = 64 * 1024 * 1024;
+
+#if defined(__unix__) || defined(__APPLE__)
+
+/// @brief Loopback TCP collector keeping everything one client sends.
+class Collector {
+public:
+    Collector() {
+        listener_ = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        bind(listener_, reinterpret_cast<sockaddr*>(&address), length);
+        listen(listener_, 1);
+        getsockname(listener_, reinterpret_cast<sockaddr*>(&address), &length);
+        port_ = ntohs(address.sin_port);
+        thread_ = std::thread([this] {
+            const int client = accept(listener_, nullptr, nullptr);
+            std::uint8_t buffer[65536];
+            for (ssize_t got; (got = recv(client, buffer, sizeof(buffer), 0)) > 0;) {
+                received_.insert(received_.end(), buffer, buffer + got);
+            }
+            close(client);
+        });
+    }
+
+    ~Collector() {
+        if (thread_.joinable()) {
+            shutdown(listener_, SHUT_RDWR);
+            thread_.join();
+        }
+        close(listener_);
+    }
+
+    [[nodiscard]] std::uint16_t port() const noexcept { return port_; }
+
+    /// @brief Wait for the client to disconnect, then replay every frame.
+    std::size_t replay(EventGraph& graph, StringPool& strings) {
+        thread_.join();
+        std::size_t frames = 0;
+        for (std::size_t at = 0; at < received_.size(); ++frames) {
+            std::uint32_t magic;
+            std::uint64_t length;
+            std::memcpy(&magic, received_.data() + at, sizeof(magic));
+            std::memcpy(&length, received_.data() + at + 8, sizeof(length));
+            EXPECT_EQ(magic, kForwardFrameMagic);
+            const auto done = replay_event_log(
+                {received_.data() + at + kForwardFrameHeaderSize, length}, graph, strings);
+            EXPECT_TRUE(done.has_value() && done->complete);
+            at += kForwardFrameHeaderSize + length;
+        }
+        return frames;
+    }
+
+private:
+    int listener_ = -1;
+    std::uint16_t port_ = 0;
+    std::thread thread_;
+    std::vector<std::uint8_t> received_;
+};
+
+class ForwarderTest : public ::testing::Test {
+protected:
+    void push_events(std::size_t total) {
+        for (std::size_t i = 1; i <= total; ++i) {
+            EventPayload payload{};
+            payload.category = Category::FileSystem;
+            payload.file.path =
+                strings_.intern_path("C:\\data\\file" + std::to_string(i % 20) + ".txt");
+            graph_.push(Category::FileSystem, 0, Status::Success, INVALID_EVENT, 0, payload,
+                        1000 + i);
+        }
+    }
+
+    Arena arena_{kArenaSize};
+    StringPool strings_{arena_};
+    EventGraph graph_{arena_, strings_, 4 * EventGraph::kSegmentSize};
+};
+
+TEST_F(ForwarderTest, Stop_DeliversEveryBatchToTheCollector) {
+    Collector collector;
+    ForwarderConfig config;
+    config.port = collector.port();
+    config.batch_events = 1000;
+    config.interval = std::chrono::milliseconds(5);
+    const std::size_t total = 4500;
+
+    EventForwarder forwarder(graph_, strings_, config);
+    forwarder.start();
+    push_events(total);
+    forwarder.stop();
+    EXPECT_EQ(forwarder.events_sent(), total);
+    EXPECT_EQ(forwarder.events_dropped(), 0u);
+    EXPECT_EQ(forwarder.buffered_bytes(), 0u);
+    EXPECT_EQ(forwarder.reconnects(), 0u);
+
+    Arena arena(kArenaSize);
+    StringPool strings(arena);
+    EventGraph copy(arena, strings, 4 * EventGraph::kSegmentSize);
+    EXPECT_EQ(collector.replay(copy, strings), forwarder.batches_sent());
+    ASSERT_EQ(copy.count(), total);
+    for (const EventId id : {EventId{1}, EventId{999}, EventId{1001}, EventId{total}}) {
+        EXPECT_EQ(copy.get(id).timestamp(), graph_.get(id).timestamp());
+        EXPECT_EQ(strings.get(copy.get(id).payload().file.path),
+                  strings_.get(graph_.get(id).payload().file.path));
+    }
+}
+
+TEST_F(ForwarderTest, Poll_DropsOldestBatchesWhenTheBufferIsFull) {
+    std::uint16_t port = 0;
+    {
+        Collector closed;  // Its port refuses connections once it is gone
+        port = closed.port();
+    }
+    ForwarderConfig config;
+    config.port = port;
+    config.batch_events = 100;
+    config.compress = false;
+    config.max_buffered_bytes = 4 * 100 * sizeof(EventNode);  // Room for 3 batches
+
+    EventForwarder forwarder(graph_, strings_, config);
+    push_events(1000);
+    EXPECT_EQ(forwarder.poll(), 1000u);
+    EXPECT_GE(forwarder.batches_dropped(), 7u);
+    EXPECT_LT(forwarder.batches_dropped(), 10u);
+    EXPECT_EQ(forwarder.events_dropped(), 100 * forwarder.batches_dropped());
+    EXPECT_LE(forwarder.buffered_bytes(), config.max_buffered_bytes);
+
+    forwarder.stop();  // Nothing to send to: the rest is dropped too
+    EXPECT_EQ(forwarder.events_sent(), 0u);
+    EXPECT_EQ(forwarder.events_dropped(), 1000u);
+    EXPECT_EQ(forwarder.buffered_bytes(), 0u);
+}
+
+#endif
+
+}  // namespace
+}  // namespace exeray::event
@@ -44,4 +44,89 @@ TEST_F(EventGraphTest, ForEach_EventOrder_Preserved) {
     }
 }
 
+TEST_F(EventGraphTest, ForEachRun_CrossesSegmentsAndStopsAtLimit) {
+    const std::size_t total = EventGraph::kSegmentSize + 10;
+    for (std::size_t i = 0; i < total; ++i) {
+        EventPayload p = make_process_payload(static_cast<uint32_t>(i));
+        graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+    }
+
+    // A run spanning the segment boundary, in index order
+    std::vector<EventId> ids;
+    const std::size_t begin = EventGraph::kSegmentSize - 5;
+    const std::size_t visited =
+        graph_.for_each_run(begin, 8, [&ids](const EventNode& node) { ids.push_back(node.id); });
+    ASSERT_EQ(visited, 8U);
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        EXPECT_EQ(ids[i], begin + i + 1);
+    }
+
+    // The newest event ends the run; nothing lies past it
+    EXPECT_EQ(graph_.for_each_run(total - 3, 100, [](const EventNode&) {}), 3U);
+    EXPECT_EQ(graph_.for_each_run(total, 100, [](const EventNode&) {}), 0U);
+}
+
+TEST_F(EventGraphTest, SegmentSpan_BorrowsPublishedNodesInPlace) {
+    EXPECT_EQ(graph_.segment_span(0).length, 0U);
+
+    const std::size_t total = EventGraph::kSegmentSize + 10;
+    for (std::size_t i = 0; i < total; ++i) {
+        EventPayload p = make_process_payload(static_cast<uint32_t>(i));
+        graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+    }
+
+    // From index 3 to the end of the first segment, then the partial second
+    const auto head = graph_.segment_span(3);
+    ASSERT_NE(head.nodes, nullptr);
+    EXPECT_EQ(head.first, 3U);
+    EXPECT_EQ(head.length, EventGraph::kSegmentSize - 3);
+    EXPECT_EQ(head.nodes[0].id, 4U);
+    EXPECT_EQ(&head.nodes[0], graph_.get(4).node());  // No copy
+    EXPECT_EQ(head.epoch, graph_.epoch());
+
+    const auto tail = graph_.segment_span(head.first + head.length);
+    EXPECT_EQ(tail.length, 10U);
+    EXPECT_EQ(tail.nodes[9].id, total);
+    EXPECT_EQ(graph_.segment_span(total).length, 0U);
+}
+
+TEST_F(EventGraphTest, ForEachSpan_CoversEveryEventInOrder) {
+    const std::size_t total = 2 * EventGraph::kSegmentSize + 5;
+    for (std::size_t i = 0; i < total; ++i) {
+        EventPayload p = make_process_payload(static_cast<uint32_t>(i));
+        graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+    }
+
+    std::size_t spans = 0;
+    EventId expected = 1;
+    graph_.for_each_span([&](std::span<const EventNode> nodes) {
+        ++spans;
+        EXPECT_LE(nodes.size(), EventGraph::kSegmentSize);
+        for (const EventNode& node : nodes) {
+            EXPECT_EQ(node.id, expected++);
+        }
+    });
+    EXPECT_EQ(spans, 3U);  // One run per segment
+    EXPECT_EQ(expected, total + 1);
+
+    // Returning false stops after the first run
+    spans = 0;
+    graph_.for_each_span([&spans](std::span<const EventNode>) {
+        ++spans;
+        return false;
+    });
+    EXPECT_EQ(spans, 1U);
+}
+
+TEST_F(EventGraphTest, EventView_FromReference_ViewsSameNode) {
+    EventPayload p = make_process_payload(77);
+    const EventId id = graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+
+    const EventNode& node = *graph_.get(id).node();
+    static_assert(noexcept(EventView(node)));
+    const EventView view(node);
+    EXPECT_EQ(view.node(), &node);
+    EXPECT_EQ(view.as_process().pid, 77U);
+}
+
 }  // namespace exeray::event::test
@@ -0,0 +1,162 @@
+/// @file event_graph_json_export_test.cpp
+/// @brief Tests for JSON escaping and NDJSON rendering.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/json_escape.hpp"
+#include "exeray/event/json_export.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+namespace exeray::event {
+namespace {
+
+constexpr std::size_t kArenaSize = 64 * 1024 * 1024;
+
+std::string json(std::string_view text) {
+    std::string out;
+    append_json_string(out, text);
+    return out;
+}
+
+TEST(JsonEscapeTest, AppendJsonString_EscapesQuotesBackslashesAndControls) {
+    EXPECT_EQ(json(""), "\"\"");
+    EXPECT_EQ(json("C:\\Windows\\\"x\""), "\"C:\\\\Windows\\\\\\\"x\\\"\"");
+    EXPECT_EQ(json("a\nb\tc\r\b\f"), "\"a\\nb\\tc\\r\\b\\f\"");
+    EXPECT_EQ(json(std::string_view("\x01\x1f\0", 3)), "\"\\u0001\\u001f\\u0000\"");
+    EXPECT_EQ(json("caf\xC3\xA9 \x7F"), "\"caf\xC3\xA9 \x7F\"");  // Copied as is
+}
+
+TEST(JsonEscapeTest, JsonPlainPrefix_FindsTheFirstEscapeAtAnyPosition) {
+    // Around and across the 16- and 32-byte blocks of the kernels
+    for (std::size_t size : {std::size_t{1}, std::size_t{15}, std::size_t{33}, std::size_t{100}}) {
+        const std::string plain(size, 'x');
+        EXPECT_EQ(json_plain_prefix(plain), size);
+        for (std::size_t at = 0; at < size; ++at) {
+            for (const char c : {'"', '\\', '\n', '\x1f'}) {
+                std::string text = plain;
+                text[at] = c;
+                ASSERT_EQ(json_plain_prefix(text), at) << size << " " << at;
+            }
+            std::string text = plain;
+            text[at] = ' ';  // 0x20 is the first byte that is not a control
+            ASSERT_EQ(json_plain_prefix(text), size);
+        }
+    }
+}
+
+class NdjsonTest : public ::testing::Test {
+protected:
+    Arena arena_{kArenaSize};
+    StringPool strings_{arena_};
+    EventGraph graph_{arena_, strings_, 4 * EventGraph::kSegmentSize};
+};
+
+TEST_F(NdjsonTest, Append_RendersNodeFieldsAndPayloadMembers) {
+    EventPayload file{};
+    file.category = Category::FileSystem;
+    file.file.path = strings_.intern_path("C:\\data\\\"a\".txt");
+    file.file.size = 4096;
+    const EventId id = graph_.push(Category::FileSystem, 1, Status::Denied, INVALID_EVENT, 9,
+                                   file, 1700000000000000000ULL);
+
+    NdjsonExporter exporter(strings_);
+    std::string line;
+    exporter.append(graph_.get(id), line);
+    EXPECT_EQ(line.find(
+                  "{\"id\":1,\"parent_id\":0,\"timestamp\":1700000000000000000,"
+                  "\"correlation_id\":9,\"category\":\"FileSystem\",\"operation\":1,"
+                  "\"status\":\"Denied\",\"path\":\"C:\\\\data\\\\\\\"a\\\".txt\""),
+              0u);
+    EXPECT_NE(line.find(",\"size\":4096"), std::string::npos);
+    EXPECT_EQ(line.back(), '\n');
+    EXPECT_EQ(line.find('\n'), line.size() - 1);
+}
+
+TEST_F(NdjsonTest, Append_WithWallClock_RendersWallTimeAfterTimestamp) {
+    EventPayload process{};
+    process.category = Category::Process;
+    const EventId id = graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0,
+                                   process, 5'000);
+
+    NdjsonExporter exporter(strings_);
+    exporter.set_wall_clock(WallClock{1'000, 1700000000000000000ULL});
+    std::string line;
+    exporter.append(graph_.get(id), line);
+    EXPECT_NE(line.find("\"timestamp\":5000,\"wall_time\":1700000000000004000,"),
+              std::string::npos);
+
+    exporter.set_wall_clock({});
+    line.clear();
+    exporter.append(graph_.get(id), line);
+    EXPECT_EQ(line.find("wall_time"), std::string::npos);
+}
+
+TEST_F(NdjsonTest, Append_RendersAddressesAndMissingStrings) {
+    EventPayload v4{};
+    v4.category = Category::Network;
+    const std::uint8_t loopback[4] = {127, 0, 0, 1};
+    std::memcpy(&v4.network.remote_addr, loopback, sizeof(loopback));
+    EventPayload v6 = v4;
+    v6.network.family = kAddressIPv6;
+    v6.network.remote_addr = strings_.intern("fe80::1");
+    v6.network.local_addr = INVALID_STRING;
+    EventPayload process{};
+    process.category = Category::Process;
+    process.process.image_path = strings_.intern_path("C:\\a.exe");
+
+    NdjsonExporter exporter(strings_);
+    std::string out;
+    exporter.append(graph_.get(graph_.push(Category::Network, 0, Status::Success,
+                                           INVALID_EVENT, 0, v4, 1)),
+                    out);
+    EXPECT_NE(out.find("\"local_addr\":\"0.0.0.0\",\"remote_addr\":\"127.0.0.1\""),
+              std::string::npos);
+    out.clear();
+    exporter.append(graph_.get(graph_.push(Category::Network, 0, Status::Success,
+                                           INVALID_EVENT, 0, v6, 2)),
+                    out);
+    EXPECT_NE(out.find("\"local_addr\":null,\"remote_addr\":\"fe80::1\""), std::string::npos);
+    out.clear();
+    exporter.append(graph_.get(graph_.push(Category::Process, 0, Status::Success,
+                                           INVALID_EVENT, 0, process, 3)),
+                    out);
+    EXPECT_NE(out.find("\"image_path\":\"C:\\\\a.exe\",\"command_line\":null"),
+              std::string::npos);
+}
+
+TEST_F(NdjsonTest, Write_EscapesEachStringOnceAndSkipsCachingLongOnes) {
+    const std::string script = "Write-Host \"" + std::string(5000, 'x') + "\"";
+    for (std::size_t i = 0; i < 300; ++i) {
+        EventPayload payload{};
+        payload.category = Category::Script;
+        payload.script.script_block = strings_.intern(script);
+        payload.script.context = strings_.intern("host" + std::to_string(i % 3));
+        graph_.push(Category::Script, 0, Status::Success, INVALID_EVENT, 0, payload, i);
+    }
+
+    NdjsonExporter exporter(strings_);
+    std::ostringstream out;
+    EXPECT_EQ(exporter.write(graph_, out), 300u);
+    EXPECT_EQ(exporter.cached_strings(), 3u);
+
+    const std::string text = out.str();
+    std::size_t lines = 0;
+    for (std::size_t at = 0; (at = text.find('\n', at)) != std::string::npos; ++at) {
+        ++lines;
+    }
+    EXPECT_EQ(lines, 300u);
+    EXPECT_NE(text.find("\"script_block\":\"Write-Host \\\"xxx"), std::string::npos);
+    EXPECT_NE(text.find("\"context\":\"host2\""), std::string::npos);
+
+    exporter.clear_cache();
+    EXPECT_EQ(exporter.cached_strings(), 0u);
+}
+
+}  // namespace
+}  // namespace exeray::event
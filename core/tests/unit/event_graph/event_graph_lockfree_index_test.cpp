@@ -0,0 +1,117 @@
+#include "event_graph_test_common.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// 13. Lock-Free Index Chains
+// ============================================================================
+
+TEST_F(EventGraphTest, ForEachChild_NewestFirst) {
+    EventPayload p = make_process_payload();
+    EventId parent = graph_.push(Category::Process, 0, Status::Success,
+                                 INVALID_EVENT, 0, p);
+    EventId c1 = graph_.push(Category::Process, 0, Status::Success, parent, 0, p);
+    EventId c2 = graph_.push(Category::Process, 0, Status::Success, parent, 0, p);
+    EventId c3 = graph_.push(Category::Process, 0, Status::Success, parent, 0, p);
+
+    std::vector<EventId> children;
+    graph_.for_each_child(parent, [&](EventView v) { children.push_back(v.id()); });
+
+    EXPECT_EQ(children, (std::vector<EventId>{c3, c2, c1}));
+}
+
+TEST_F(EventGraphTest, ForEachChild_UnknownParent_NotLinked) {
+    EventPayload p = make_process_payload();
+    graph_.push(Category::Process, 0, Status::Success, 5000, 0, p);
+
+    int count = 0;
+    graph_.for_each_child(5000, [&count](EventView) { ++count; });
+    EXPECT_EQ(count, 0);
+}
+
+TEST_F(EventGraphTest, ForEachCorrelation_ManyDistinctIds_AllIsolated) {
+    constexpr uint32_t kIds = 2048;
+    EventPayload p = make_network_payload();
+    for (uint32_t corr = 1; corr <= kIds; ++corr) {
+        graph_.push(Category::Network, 0, Status::Success, INVALID_EVENT, corr, p);
+        graph_.push(Category::Network, 0, Status::Success, INVALID_EVENT, corr, p);
+    }
+
+    for (uint32_t corr = 1; corr <= kIds; ++corr) {
+        int count = 0;
+        graph_.for_each_correlation(corr, [&](EventView v) {
+            EXPECT_EQ(v.correlation_id(), corr);
+            ++count;
+        });
+        ASSERT_EQ(count, 2) << "correlation " << corr;
+    }
+    EXPECT_EQ(graph_.unlinked_count(), 0u);
+}
+
+TEST_F(EventGraphTest, ForEachCorrelation_FullHeadTable_CountsUnlinked) {
+    // 4096 events get the minimum table of 1024 correlation heads
+    EventGraph small{arena_, strings_, 4096};
+    constexpr uint32_t kIds = 1200;
+    EventPayload p = make_network_payload();
+    for (uint32_t corr = 1; corr <= kIds; ++corr) {
+        small.push(Category::Network, 0, Status::Success, INVALID_EVENT, corr, p);
+    }
+
+    std::size_t reachable = 0;
+    for (uint32_t corr = 1; corr <= kIds; ++corr) {
+        small.for_each_correlation(corr, [&reachable](EventView) { ++reachable; });
+    }
+    EXPECT_GE(small.unlinked_count(), kIds - 1024);
+    EXPECT_EQ(reachable + small.unlinked_count(), kIds);
+}
+
+TEST_F(EventGraphTest, ChainTraversal_ConcurrentWithPush_NoLock) {
+    constexpr int kPushers = 4;
+    constexpr int kPerPusher = 2000;
+    constexpr uint32_t kCorr = 7;
+
+    EventPayload p = make_file_payload();
+    EventId parent = graph_.push(Category::FileSystem, 0, Status::Success,
+                                 INVALID_EVENT, 0, p);
+
+    std::atomic<bool> stop{false};
+    std::thread reader([&]() {
+        while (!stop.load(std::memory_order_acquire)) {
+            int last = -1;
+            int count = 0;
+            graph_.for_each_child(parent, [&](EventView v) {
+                EXPECT_EQ(v.parent_id(), parent);
+                ++count;
+            });
+            // Chains only grow
+            EXPECT_GE(count, last);
+            last = count;
+        }
+    });
+
+    std::vector<std::thread> pushers;
+    for (int t = 0; t < kPushers; ++t) {
+        pushers.emplace_back([&]() {
+            for (int i = 0; i < kPerPusher; ++i) {
+                EventPayload q = make_file_payload();
+                graph_.push(Category::FileSystem, 0, Status::Success, parent, kCorr, q);
+            }
+        });
+    }
+    for (auto& t : pushers) {
+        t.join();
+    }
+    stop.store(true, std::memory_order_release);
+    reader.join();
+
+    int children = 0;
+    graph_.for_each_child(parent, [&children](EventView) { ++children; });
+    int correlated = 0;
+    graph_.for_each_correlation(kCorr, [&correlated](EventView) { ++correlated; });
+    EXPECT_EQ(children, kPushers * kPerPusher);
+    EXPECT_EQ(correlated, kPushers * kPerPusher);
+}
+
+}  // namespace exeray::event::test
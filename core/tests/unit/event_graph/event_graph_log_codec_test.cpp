@@ -0,0 +1,222 @@
+/// @file event_graph_log_codec_test.cpp
+/// @brief Tests for compressed event log blocks.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/event/event_log.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/log_codec.hpp"
+#include "exeray/event/mapped_log.hpp"
+#include "exeray/thread_pool.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace exeray::event {
+namespace {
+
+constexpr std::size_t kArenaSize = 64 * 1024 * 1024;
+
+std::vector<std::uint8_t> round_trip(const std::vector<std::uint8_t>& data,
+                                     std::size_t* packed_size = nullptr) {
+    std::vector<std::uint8_t> packed;
+    pack_bytes(data, packed);
+    if (packed_size != nullptr) {
+        *packed_size = packed.size();
+    }
+    packed.resize(packed.size() + 13, 0xAB);  // Padding after the stream is ignored
+    std::vector<std::uint8_t> out(data.size());
+    EXPECT_TRUE(unpack_bytes(packed, out));
+    return out;
+}
+
+TEST(LogCodecTest, PackBytes_RoundTripsAnyInput) {
+    EXPECT_TRUE(round_trip({}).empty());
+    const std::vector<std::uint8_t> tiny{1, 2, 3};
+    EXPECT_EQ(round_trip(tiny), tiny);
+
+    std::mt19937 random(7);
+    std::vector<std::uint8_t> noise(100000);
+    for (auto& byte : noise) {
+        byte = static_cast<std::uint8_t>(random());
+    }
+    EXPECT_EQ(round_trip(noise), noise);
+
+    // Long runs and repeats far apart: overlapping matches and long lengths
+    std::vector<std::uint8_t> runs(300000, 0);
+    for (std::size_t i = 0; i < runs.size(); i += 1000) {
+        runs[i] = static_cast<std::uint8_t>(i / 1000);
+    }
+    std::size_t packed = 0;
+    EXPECT_EQ(round_trip(runs, &packed), runs);
+    EXPECT_LT(packed, runs.size() / 20);
+}
+
+TEST(LogCodecTest, UnpackBytes_RejectsCorruptInput) {
+    std::vector<std::uint8_t> data(4096);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<std::uint8_t>(i % 17);
+    }
+    std::vector<std::uint8_t> packed;
+    pack_bytes(data, packed);
+
+    std::vector<std::uint8_t> out(data.size());
+    EXPECT_FALSE(unpack_bytes({packed.data(), packed.size() / 2}, out));
+    std::vector<std::uint8_t> larger(data.size() + 1);
+    EXPECT_FALSE(unpack_bytes(packed, larger));
+
+    // A match reaching before the start of the output
+    const std::vector<std::uint8_t> bad{0x10, 'a', 0xFF, 0x00, 0x00};
+    std::vector<std::uint8_t> small(8);
+    EXPECT_FALSE(unpack_bytes(bad, small));
+}
+
+TEST(LogCodecTest, PackEvents_RestoresNodesAndShrinksThem) {
+    std::vector<EventNode> nodes(4096);
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        EventNode& node = nodes[i];
+        node = EventNode{};
+        node.id = 1000 + i;
+        node.parent_id = i % 3 == 0 ? INVALID_EVENT : node.id - 1 - i % 5;
+        node.timestamp = 1'700'000'000'000'000'000ULL + i * 1500 - (i % 2) * 700;
+        node.correlation_id = static_cast<std::uint32_t>(i / 64);
+        node.status = Status::Success;
+        node.operation = static_cast<std::uint8_t>(i % 4);
+        node.payload.category = i % 10 == 0 ? Category::Process : Category::FileSystem;
+        node.payload.file.path = static_cast<StringId>(40 + i % 8);
+        node.payload.file.size = 4096;
+    }
+    std::vector<std::uint8_t> packed;
+    pack_events({reinterpret_cast<const std::uint8_t*>(nodes.data()),
+                 nodes.size() * sizeof(EventNode)},
+                packed);
+    EXPECT_LT(packed.size(), nodes.size() * sizeof(EventNode) / 4);
+
+    std::vector<EventNode> out(nodes.size());
+    ASSERT_TRUE(unpack_events(packed, out));
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        ASSERT_EQ(std::memcmp(&out[i], &nodes[i], sizeof(EventNode)), 0) << "node " << i;
+    }
+}
+
+class CompressedLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const std::string name =
+            std::to_string(::testing::UnitTest::GetInstance()->random_seed()) + "_" +
+            ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        path_ = std::filesystem::temp_directory_path() / ("exeray_packed_" + name);
+        plain_ = std::filesystem::temp_directory_path() / ("exeray_plain_" + name);
+    }
+
+    void TearDown() override {
+        for (const auto& path : {path_, plain_}) {
+            std::filesystem::remove(path);
+            std::filesystem::remove(std::filesystem::path(path) += ".exri");
+        }
+    }
+
+    void push_events(std::size_t total) {
+        EventPayload process{};
+        process.category = Category::Process;
+        process.process.pid = 100;
+        process.process.image_path = strings_.intern_path("C:\\Windows\\System32\\cmd.exe");
+        process.process.command_line = strings_.intern("cmd /c build.bat");
+        const EventId root = graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT,
+                                         3, process, 1000);
+        for (std::size_t i = 2; i <= total; ++i) {
+            EventPayload file{};
+            file.category = Category::FileSystem;
+            file.file.path =
+                strings_.intern_path("C:\\src\\file" + std::to_string(i % 50) + ".cpp");
+            file.file.size = static_cast<std::uint32_t>(i % 7) * 512;
+            graph_.push(Category::FileSystem, static_cast<std::uint8_t>(i % 3), Status::Success,
+                        root, 3, file, 1000 + i * 250);
+        }
+    }
+
+    Arena arena_{kArenaSize};
+    StringPool strings_{arena_};
+    EventGraph graph_{arena_, strings_, 4 * EventGraph::kSegmentSize};
+    std::filesystem::path path_;
+    std::filesystem::path plain_;
+};
+
+TEST_F(CompressedLogTest, Replay_ReadsPackedBlocks) {
+    const std::size_t total = 3 * EventGraph::kSegmentSize + 100;
+    push_events(total);
+    ThreadPool pool(2);
+    {
+        EventLogWriter log(graph_, strings_);
+        log.set_compression(true, &pool);
+        ASSERT_TRUE(log.open(path_));
+        EXPECT_EQ(log.flush(), total);
+        log.stop();
+        EXPECT_EQ(log.bytes_written(), std::filesystem::file_size(path_));
+    }
+    {
+        EventLogWriter log(graph_, strings_);
+        ASSERT_TRUE(log.open(plain_));
+        log.stop();
+    }
+    EXPECT_LT(std::filesystem::file_size(path_) * 4, std::filesystem::file_size(plain_));
+
+    Arena arena(kArenaSize);
+    StringPool strings(arena);
+    EventGraph copy(arena, strings, 4 * EventGraph::kSegmentSize);
+    const auto replay = read_event_log(path_, copy, strings);
+    ASSERT_TRUE(replay.has_value());
+    EXPECT_TRUE(replay->complete);
+    EXPECT_EQ(replay->events, total);
+    EXPECT_EQ(replay->strings, 52u);
+    for (const EventId id : {EventId{1}, EventId{2}, EventId{total / 2}, EventId{total}}) {
+        const EventView a = graph_.get(id);
+        const EventView b = copy.get(id);
+        EXPECT_EQ(b.parent_id(), a.parent_id());
+        EXPECT_EQ(b.timestamp(), a.timestamp());
+        EXPECT_EQ(b.operation(), a.operation());
+    }
+    EXPECT_EQ(strings.get(copy.get(total).payload().file.path),
+              strings_.get(graph_.get(total).payload().file.path));
+}
+
+TEST_F(CompressedLogTest, MappedLog_UnpacksBlocksOnDemand) {
+    const std::size_t total = 2 * EventGraph::kSegmentSize + 5;
+    push_events(total);
+    EventLogWriter writer(graph_, strings_);
+    writer.set_compression(true);
+    ASSERT_TRUE(writer.open(path_));
+    writer.stop();
+
+    for (const bool reopened : {false, true}) {
+        MappedEventLog log;
+        ASSERT_TRUE(log.open(path_));
+        EXPECT_EQ(log.index_loaded(), reopened);
+        ASSERT_EQ(log.count(), total);
+        EXPECT_TRUE(log.complete());
+        EXPECT_TRUE(log.verify());
+
+        const EventView last = log.get(total);
+        EXPECT_EQ(last.timestamp(), graph_.get(total).timestamp());
+        EXPECT_EQ(last.parent_id(), 1u);
+        EXPECT_EQ(log.resolve_string(last.payload().file.path),
+                  strings_.get(graph_.get(total).payload().file.path));
+        EXPECT_EQ(log.resolve_string(log.get(1).payload().process.command_line),
+                  "cmd /c build.bat");
+
+        std::size_t files = 0;
+        log.for_each_category(Category::FileSystem, [&](EventView) { ++files; });
+        EXPECT_EQ(files, total - 1);
+        std::size_t children = 0;
+        log.for_each_child(1, [&](EventView) { ++children; });
+        EXPECT_EQ(children, total - 1);
+    }
+}
+
+}  // namespace
+}  // namespace exeray::event
@@ -0,0 +1,213 @@
+/// @file event_graph_log_merge_test.cpp
+/// @brief Tests for merging the event logs of many hosts by timestamp.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/event/event_log.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/log_merge.hpp"
+#include "exeray/event/mapped_log.hpp"
+#include "exeray/thread_pool.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace exeray::event {
+namespace {
+
+constexpr std::size_t kHosts = 3;
+constexpr std::size_t kEventsPerHost = 10000;
+
+/// @brief One host's graph, written to its own log.
+struct Host {
+    Arena arena{16 * 1024 * 1024};
+    StringPool strings{arena};
+    EventGraph graph{arena, strings, 8 * EventGraph::kSegmentSize};
+};
+
+class LogMergeTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const std::string prefix =
+            "exeray_merge_" +
+            std::to_string(::testing::UnitTest::GetInstance()->random_seed()) + "_" +
+            ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        const auto temp = std::filesystem::temp_directory_path();
+        for (std::size_t h = 0; h < kHosts; ++h) {
+            inputs_.push_back(temp / (prefix + "_host" + std::to_string(h)));
+        }
+        output_ = temp / (prefix + "_merged");
+        serial_ = temp / (prefix + "_serial");
+    }
+
+    void TearDown() override {
+        for (const auto& path : {inputs_[0], inputs_[1], inputs_[2], output_, serial_}) {
+            std::filesystem::remove(path);
+            std::filesystem::remove(std::filesystem::path(path) += ".exri");
+        }
+    }
+
+    /// @brief Host h's events: timestamps h, h + kHosts, ... so the hosts
+    /// interleave; every fourth event is a child of the one before, and
+    /// hosts share the image paths but not the file names.
+    void write_hosts(bool compress) {
+        for (std::size_t h = 0; h < kHosts; ++h) {
+            auto host = std::make_unique<Host>();
+            EventId previous = INVALID_EVENT;
+            for (std::size_t i = 0; i < kEventsPerHost; ++i) {
+                EventPayload payload{};
+                const auto timestamp = static_cast<Timestamp>(i * kHosts + h + 1);
+                const EventId parent = i % 4 == 3 ? previous : INVALID_EVENT;
+                if (i % 2 == 0) {
+                    payload.category = Category::Process;
+                    payload.process.pid = static_cast<std::uint32_t>(h * 1000 + i % 7);
+                    payload.process.image_path =
+                        host->strings.intern_path("C:\\Windows\\image" + std::to_string(i % 5));
+                    previous = host->graph.push(Category::Process, 0, Status::Success, parent,
+                                                static_cast<std::uint32_t>(h), payload,
+                                                timestamp);
+                } else {
+                    payload.category = Category::FileSystem;
+                    payload.file.path = host->strings.intern(
+                        "host" + std::to_string(h) + "_file" + std::to_string(i % 11));
+                    previous = host->graph.push(Category::FileSystem, 1, Status::Success, parent,
+                                                0, payload, timestamp);
+                }
+            }
+            EventLogWriter writer(host->graph, host->strings);
+            writer.set_compression(compress);
+            ASSERT_TRUE(writer.open(inputs_[h]));
+            writer.stop();
+        }
+    }
+
+    std::vector<std::filesystem::path> inputs_;
+    std::filesystem::path output_;
+    std::filesystem::path serial_;
+};
+
+/// @brief Text of an event's image or file path.
+std::string text(const MappedEventLog& log, EventView view) {
+    const EventPayload& payload = view.payload();
+    return std::string(log.resolve_string(payload.category == Category::Process
+                                              ? payload.process.image_path
+                                              : payload.file.path));
+}
+
+TEST_F(LogMergeTest, Merge_InterleavesHostsByTimestampWithSharedStrings) {
+    write_hosts(false);
+    const auto stats = merge_event_logs(inputs_, output_);
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_EQ(stats->inputs, kHosts);
+    EXPECT_EQ(stats->events, kHosts * kEventsPerHost);
+    EXPECT_EQ(stats->partitions, 1u);
+    EXPECT_EQ(stats->orphans, 0u);
+    // Five shared image paths, eleven file names per host
+    EXPECT_EQ(stats->strings, 5 + kHosts * 11);
+    EXPECT_EQ(stats->duplicate_strings, (kHosts - 1) * 5);
+    EXPECT_EQ(stats->bytes, std::filesystem::file_size(output_));
+
+    MappedEventLog log;
+    ASSERT_TRUE(log.open(output_));
+    ASSERT_TRUE(log.verify());
+    ASSERT_EQ(log.count(), kHosts * kEventsPerHost);
+    EXPECT_EQ(log.oldest_id(), 1u);
+
+    EventId expected = 1;
+    log.for_each([&](EventView view) {
+        // Timestamps 1..N, one per event, so IDs and timestamps agree
+        ASSERT_EQ(view.id(), expected);
+        ASSERT_EQ(view.timestamp(), static_cast<Timestamp>(expected));
+        const std::size_t host = (expected - 1) % kHosts;
+        const std::size_t i = (expected - 1) / kHosts;
+        EXPECT_EQ(view.correlation_id(), i % 2 == 0 ? host : 0u);
+        if (i % 2 == 0) {
+            EXPECT_EQ(text(log, view), "C:\\Windows\\image" + std::to_string(i % 5));
+        } else {
+            EXPECT_EQ(text(log, view), "host" + std::to_string(host) + "_file" +
+                                            std::to_string(i % 11));
+        }
+        // The parent is the host's previous event, kHosts IDs back
+        EXPECT_EQ(view.parent_id(), i % 4 == 3 ? expected - kHosts : INVALID_EVENT);
+        ++expected;
+    });
+}
+
+TEST_F(LogMergeTest, Merge_PartitionsOnAPoolMatchTheSerialMerge) {
+    write_hosts(true);
+    ASSERT_TRUE(merge_event_logs(inputs_, serial_).has_value());
+    ThreadPool pool(4);
+    const auto stats =
+        merge_event_logs(inputs_, output_, {.pool = &pool, .partitions = 5, .compress = true});
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_GT(stats->partitions, 1u);
+    EXPECT_EQ(stats->events, kHosts * kEventsPerHost);
+
+    MappedEventLog serial;
+    MappedEventLog parallel;
+    ASSERT_TRUE(serial.open(serial_));
+    ASSERT_TRUE(parallel.open(output_));
+    ASSERT_TRUE(parallel.verify());
+    ASSERT_EQ(parallel.count(), serial.count());
+    serial.for_each([&](EventView view) {
+        const EventView other = parallel.get(view.id());
+        ASSERT_EQ(other.timestamp(), view.timestamp());
+        EXPECT_EQ(other.parent_id(), view.parent_id());
+        EXPECT_EQ(text(parallel, other), text(serial, view));
+    });
+    for (std::size_t p = 0; p < stats->partitions; ++p) {
+        EXPECT_FALSE(std::filesystem::exists(std::filesystem::path(output_) +=
+                                             ".part" + std::to_string(p)));
+    }
+
+    // The merged log replays like any other
+    Host replayed;
+    const auto bytes = [&] {
+        std::vector<std::uint8_t> data(std::filesystem::file_size(output_));
+        std::ifstream(output_, std::ios::binary)
+            .read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        return data;
+    }();
+    const auto replay = replay_event_log(bytes, replayed.graph, replayed.strings);
+    ASSERT_TRUE(replay.has_value());
+    EXPECT_EQ(replay->events, kHosts * kEventsPerHost);
+}
+
+TEST_F(LogMergeTest, Merge_KeepsHostOrderAndDropsParentsOutsideTheInput) {
+    Host host;
+    EventPayload payload{};
+    payload.category = Category::Process;
+    payload.process.image_path = host.strings.intern_path("C:\\a.exe");
+    // Out of time order within the host, and a parent the log never saw
+    host.graph.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, payload, 50);
+    host.graph.push(Category::Process, 0, Status::Success, 999, 0, payload, 20);
+    EventLogWriter writer(host.graph, host.strings);
+    ASSERT_TRUE(writer.open(inputs_[0]));
+    writer.stop();
+
+    const std::vector<std::filesystem::path> one{inputs_[0]};
+    const auto stats = merge_event_logs(one, output_);
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_EQ(stats->orphans, 1u);
+    MappedEventLog log;
+    ASSERT_TRUE(log.open(output_));
+    ASSERT_EQ(log.count(), 2u);
+    EXPECT_EQ(log.get(1).timestamp(), 50u);
+    EXPECT_EQ(log.get(2).timestamp(), 20u);
+    EXPECT_EQ(log.get(2).parent_id(), INVALID_EVENT);
+}
+
+TEST_F(LogMergeTest, Merge_FailsOnAMissingInputAndLeavesNothing) {
+    write_hosts(false);
+    std::filesystem::remove(inputs_[1]);
+    EXPECT_FALSE(merge_event_logs(inputs_, output_).has_value());
+    EXPECT_FALSE(std::filesystem::exists(output_));
+}
+
+}  // namespace
+}  // namespace exeray::event
@@ -0,0 +1,206 @@
+/// @file event_graph_log_query_test.cpp
+/// @brief Tests for parallel queries over many saved event logs.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/event/event_log.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/log_query.hpp"
+#include "exeray/thread_pool.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace exeray::event {
+namespace {
+
+constexpr std::size_t kLogs = 3;
+constexpr std::size_t kEventsPerLog = 12000;
+
+class LogQueryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const std::string prefix =
+            "exeray_query_" +
+            std::to_string(::testing::UnitTest::GetInstance()->random_seed()) + "_" +
+            ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        for (std::size_t l = 0; l < kLogs; ++l) {
+            paths_.push_back(std::filesystem::temp_directory_path() /
+                             (prefix + "_" + std::to_string(l)));
+        }
+        write_logs();
+    }
+
+    void TearDown() override {
+        for (const auto& path : paths_) {
+            std::filesystem::remove(path);
+            std::filesystem::remove(std::filesystem::path(path) += ".exri");
+        }
+    }
+
+    /// @brief Log l: timestamps l, l + kLogs, ...; every tenth event is a
+    /// Network one to port 443 or 4444, the others are Process events whose
+    /// PID, 1000 * (l + 1) + block, changes every block (4096 events); log 1
+    /// alone runs "evil.exe".
+    void write_logs() {
+        for (std::size_t l = 0; l < kLogs; ++l) {
+            Arena arena{16 * 1024 * 1024};
+            StringPool strings{arena};
+            EventGraph graph{arena, strings, 4 * EventGraph::kSegmentSize};
+            for (std::size_t i = 0; i < kEventsPerLog; ++i) {
+                EventPayload payload{};
+                const auto timestamp = static_cast<Timestamp>(i * kLogs + l);
+                const auto pid =
+                    static_cast<std::uint32_t>(1000 * (l + 1) + i / EventGraph::kSegmentSize);
+                if (i % 10 == 0) {
+                    payload.category = Category::Network;
+                    payload.network.remote_port = i % 20 == 0 ? 443 : 4444;
+                    graph.push(Category::Network, 0, Status::Success, INVALID_EVENT, 0, payload,
+                               timestamp);
+                } else {
+                    payload.category = Category::Process;
+                    payload.process.pid = pid;
+                    payload.process.image_path = strings.intern(
+                        l == 1 && i % 100 == 1 ? std::string("evil.exe")
+                                               : "image" + std::to_string(i % 7));
+                    graph.push(Category::Process, 1,
+                               i % 1000 == 1 ? Status::Denied : Status::Success, INVALID_EVENT,
+                               0, payload, timestamp);
+                }
+            }
+            EventLogWriter writer(graph, strings);
+            writer.set_compression(l == 2);
+            ASSERT_TRUE(writer.open(paths_[l]));
+            writer.stop();
+        }
+    }
+
+    void add_all(LogQueryExecutor& executor) {
+        for (const auto& path : paths_) {
+            ASSERT_TRUE(executor.add(path));
+        }
+    }
+
+    std::vector<std::filesystem::path> paths_;
+};
+
+TEST_F(LogQueryTest, Count_MatchesEveryLogAndSkipsBlocksByZoneMap) {
+    ThreadPool pool(4);
+    LogQueryExecutor executor(&pool);
+    add_all(executor);
+    EXPECT_EQ(executor.size(), kLogs);
+    EXPECT_FALSE(executor.add(paths_[0].string() + ".missing"));
+
+    LogQuery all;
+    LogQueryStats stats;
+    EXPECT_EQ(executor.count(all, &stats), kLogs * kEventsPerLog);
+    EXPECT_EQ(stats.events, kLogs * kEventsPerLog);
+    EXPECT_EQ(stats.blocks_skipped, 0u);
+
+    LogQuery network;
+    network.query.category(Category::Network).remote_port(4444);
+    EXPECT_EQ(executor.count(network), kLogs * kEventsPerLog / 20);
+
+    // One PID lives in one block of one log: the other blocks are never read
+    LogQuery one_pid;
+    one_pid.query.pid(2001);
+    EXPECT_EQ(executor.count(one_pid, &stats), 4096u - 410u);  // Less its Network events
+    EXPECT_EQ(stats.blocks, 1u);
+    EXPECT_EQ(stats.events, EventGraph::kSegmentSize);
+    EXPECT_GE(stats.blocks_skipped, 2 * kLogs);
+
+    LogQuery denied;
+    denied.query.status(Status::Denied).between(0, 3000 * kLogs);
+    EXPECT_EQ(executor.count(denied, &stats), 3 * kLogs);
+    EXPECT_GT(stats.blocks_skipped, 0u);
+}
+
+TEST_F(LogQueryTest, Carries_ResolvesTheTextPerLog) {
+    LogQueryExecutor executor;
+    add_all(executor);
+    LogQuery evil;
+    evil.carries = "evil.exe";
+    LogQueryStats stats;
+    EXPECT_EQ(executor.count(evil, &stats), kEventsPerLog / 100);
+    EXPECT_EQ(stats.logs_skipped, kLogs - 1);
+
+    const std::vector<LogRow> rows = executor.rows(evil);
+    ASSERT_EQ(rows.size(), kEventsPerLog / 100);
+    for (const LogRow& row : rows) {
+        EXPECT_EQ(row.log, 1u);
+        const MappedEventLog& log = executor.log(row.log);
+        EXPECT_EQ(log.resolve_string(log.get(row.row.id).payload().process.image_path),
+                  "evil.exe");
+    }
+}
+
+TEST_F(LogQueryTest, Rows_MergedInTimestampOrderUpToTheLimit) {
+    ThreadPool pool(4);
+    LogQueryExecutor parallel(&pool);
+    LogQueryExecutor serial;
+    add_all(parallel);
+    add_all(serial);
+
+    LogQuery oldest;
+    oldest.query.category(Category::Network).take(50);
+    const std::vector<LogRow> rows = parallel.rows(oldest);
+    ASSERT_EQ(rows.size(), 50u);
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        // Network events every tenth of each log, interleaved across logs
+        EXPECT_EQ(rows[i].log, i % kLogs);
+        EXPECT_EQ(rows[i].row.timestamp, (i / kLogs) * 10 * kLogs + i % kLogs);
+        EXPECT_EQ(rows[i].row.category, Category::Network);
+    }
+
+    LogQuery newest = oldest;
+    newest.query.newest_first().take(7);
+    const std::vector<LogRow> latest = parallel.rows(newest);
+    ASSERT_EQ(latest.size(), 7u);
+    EXPECT_EQ(latest[0].log, kLogs - 1);
+    EXPECT_EQ(latest[0].row.timestamp, (kEventsPerLog - 10) * kLogs + kLogs - 1);
+    for (std::size_t i = 1; i < latest.size(); ++i) {
+        EXPECT_GT(latest[i - 1].row.timestamp, latest[i].row.timestamp);
+    }
+
+    LogQuery everything;
+    everything.query.status(Status::Success);
+    const std::vector<LogRow> a = parallel.rows(everything);
+    const std::vector<LogRow> b = serial.rows(everything);
+    ASSERT_EQ(a.size(), b.size());
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        ASSERT_EQ(a[i].log, b[i].log);
+        ASSERT_EQ(a[i].row.id, b[i].row.id);
+    }
+
+    LogQuery none;
+    none.query.take(0);
+    EXPECT_TRUE(parallel.rows(none).empty());
+}
+
+TEST_F(LogQueryTest, TopCounts_SumsGroupsAcrossLogs) {
+    ThreadPool pool(2);
+    LogQueryExecutor executor(&pool);
+    add_all(executor);
+
+    LogQuery network;
+    network.query.category(Category::Network);
+    std::array<GroupCount, 4> groups{};
+    ASSERT_EQ(executor.top_counts(network, GroupKey::RemotePort, groups), 2u);
+    EXPECT_EQ(groups[0].count, kLogs * kEventsPerLog / 20);
+    EXPECT_EQ(groups[1].count, kLogs * kEventsPerLog / 20);
+    EXPECT_EQ(groups[0].key, 443u);  // Ties by ascending key
+    EXPECT_EQ(groups[1].key, 4444u);
+
+    std::array<GroupCount, 1> top{};
+    ASSERT_EQ(executor.top_counts(LogQuery{}, GroupKey::Category, top), 1u);
+    EXPECT_EQ(top[0].key, static_cast<std::uint32_t>(Category::Process));
+    EXPECT_EQ(top[0].count, kLogs * (kEventsPerLog - kEventsPerLog / 10));
+}
+
+}  // namespace
+}  // namespace exeray::event
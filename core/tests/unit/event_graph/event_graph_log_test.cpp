@@ -0,0 +1,248 @@
+/// @file event_graph_log_test.cpp
+/// @brief Tests for the append-only event log and its replay.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/event/event_log.hpp"
+#include "exeray/event/graph.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace exeray::event {
+namespace {
+
+constexpr std::size_t kArenaSize = 64 * 1024 * 1024;
+
+class EventLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = std::filesystem::temp_directory_path() /
+                ("exeray_log_" + std::to_string(::testing::UnitTest::GetInstance()
+                                                    ->random_seed()) +
+                 "_" + ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        std::filesystem::remove(path_);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path_);
+    }
+
+    std::vector<std::uint8_t> bytes() const {
+        std::ifstream file(path_, std::ios::binary);
+        return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    }
+
+    EventId push_process(std::uint32_t pid, std::string_view image, EventId parent,
+                         Timestamp timestamp) {
+        EventPayload payload{};
+        payload.category = Category::Process;
+        payload.process.pid = pid;
+        payload.process.parent_pid = 4;
+        payload.process.image_path = strings_.intern_path(image);
+        payload.process.command_line = strings_.intern("cmd /c dir");
+        return graph_.push(Category::Process, 0, Status::Success, parent, 7, payload, timestamp);
+    }
+
+    EventId push_file(std::string_view path, EventId parent, Timestamp timestamp) {
+        EventPayload payload{};
+        payload.category = Category::FileSystem;
+        payload.file.path = strings_.intern_path(path);
+        payload.file.size = 4096;
+        return graph_.push(Category::FileSystem, 1, Status::Denied, parent, 0, payload,
+                           timestamp);
+    }
+
+    Arena arena_{kArenaSize};
+    StringPool strings_{arena_};
+    EventGraph graph_{arena_, strings_, 65536};
+    std::filesystem::path path_;
+};
+
+TEST_F(EventLogTest, Replay_RebuildsIdenticalGraph) {
+    const EventId root = push_process(100, "C:\\Windows\\System32\\cmd.exe", INVALID_EVENT, 10);
+    push_file("C:\\Users\\a\\notes.txt", root, 20);
+    EventPayload net{};
+    net.category = Category::Network;
+    net.network.family = kAddressIPv6;
+    net.network.local_addr = strings_.intern("fe80::1");
+    net.network.remote_addr = strings_.intern("2001:db8::7");
+    net.network.remote_port = 443;
+    graph_.push(Category::Network, 2, Status::Success, root, 0, net, 30);
+    EventPayload input{};
+    input.category = Category::Input;
+    graph_.push(Category::Input, 0, Status::Success, INVALID_EVENT, 0, input, 40);
+
+    EventLogWriter log(graph_, strings_);
+    ASSERT_TRUE(log.open(path_));
+    EXPECT_EQ(log.flush(), 4u);
+    log.stop();
+    EXPECT_EQ(log.events_written(), 4u);
+    EXPECT_EQ(log.bytes_written(), std::filesystem::file_size(path_));
+    EXPECT_FALSE(log.failed());
+
+    Arena arena(kArenaSize);
+    StringPool strings(arena);
+    strings.intern("shifts every StringId of the copy");
+    EventGraph copy(arena, strings, 1024);
+    const auto replay = read_event_log(path_, copy, strings);
+    ASSERT_TRUE(replay.has_value());
+    EXPECT_TRUE(replay->complete);
+    EXPECT_EQ(replay->events, 4u);
+    EXPECT_EQ(replay->strings, 5u);
+    ASSERT_EQ(copy.count(), graph_.count());
+
+    for (EventId id = 1; id <= graph_.count(); ++id) {
+        const EventView a = graph_.get(id);
+        const EventView b = copy.get(id);
+        EXPECT_EQ(b.parent_id(), a.parent_id());
+        EXPECT_EQ(b.timestamp(), a.timestamp());
+        EXPECT_EQ(b.category(), a.category());
+        EXPECT_EQ(b.status(), a.status());
+        EXPECT_EQ(b.operation(), a.operation());
+        EXPECT_EQ(b.correlation_id(), a.correlation_id());
+    }
+    const EventPayload& process = copy.get(1).payload();
+    EXPECT_EQ(strings.get(process.process.image_path), "C:\\Windows\\System32\\cmd.exe");
+    EXPECT_NE(strings.path_leaf(process.process.image_path), process.process.image_path);
+    EXPECT_EQ(strings.get(process.process.command_line), "cmd /c dir");
+    EXPECT_EQ(strings.get(copy.get(2).payload().file.path), "C:\\Users\\a\\notes.txt");
+    EXPECT_EQ(strings.get(copy.get(3).payload().network.remote_addr), "2001:db8::7");
+    EXPECT_EQ(copy.get(3).payload().network.remote_port, 443);
+
+    std::size_t children = 0;
+    copy.for_each_child(1, [&](EventView) { ++children; });
+    EXPECT_EQ(children, 2u);
+    EXPECT_EQ(copy.counters().pid_count(100), graph_.counters().pid_count(100));
+}
+
+TEST_F(EventLogTest, Flush_AppendsOnlyNewEventsAndStrings) {
+    EventLogWriter log(graph_, strings_);
+    ASSERT_TRUE(log.open(path_));
+    const EventId root = push_process(100, "C:\\a.exe", INVALID_EVENT, 1);
+    push_file("C:\\x.txt", root, 2);
+    EXPECT_EQ(log.flush(), 2u);
+    EXPECT_EQ(log.flush(), 0u);
+    const auto first = log.bytes_written();
+
+    // Same strings again: only the event block grows the file
+    push_file("C:\\x.txt", root, 3);
+    EXPECT_EQ(log.flush(), 1u);
+    EXPECT_EQ(log.bytes_written() - first, kLogHeaderSize + sizeof(EventNode));
+    log.stop();
+
+    Arena arena(kArenaSize);
+    StringPool strings(arena);
+    EventGraph copy(arena, strings, 1024);
+    const auto replay = replay_event_log(bytes(), copy, strings);
+    ASSERT_TRUE(replay.has_value());
+    EXPECT_EQ(replay->events, 3u);
+    EXPECT_EQ(copy.get(3).parent_id(), 1u);
+    EXPECT_EQ(strings.get(copy.get(3).payload().file.path), "C:\\x.txt");
+}
+
+TEST_F(EventLogTest, Start_WritesInTheBackground) {
+    EventLogWriter log(graph_, strings_);
+    ASSERT_TRUE(log.open(path_));
+    log.start(std::chrono::milliseconds(1));
+    for (Timestamp t = 1; t <= 5000; ++t) {
+        push_file("C:\\spin.bin", INVALID_EVENT, t);
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (log.events_written() < 5000 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(log.events_written(), 5000u);
+    log.stop();
+
+    Arena arena(kArenaSize);
+    StringPool strings(arena);
+    EventGraph copy(arena, strings, 65536);
+    const auto replay = read_event_log(path_, copy, strings);
+    ASSERT_TRUE(replay.has_value());
+    EXPECT_EQ(replay->events, 5000u);
+    EXPECT_EQ(replay->strings, 1u);
+    EXPECT_EQ(copy.get(5000).timestamp(), 5000u);
+}
+
+TEST_F(EventLogTest, Replay_StopsAtPartialOrCorruptBlock) {
+    EventLogWriter log(graph_, strings_);
+    ASSERT_TRUE(log.open(path_));
+    push_process(100, "C:\\a.exe", INVALID_EVENT, 1);
+    log.flush();
+    const auto intact = log.bytes_written();
+    push_file("C:\\x.txt", 1, 2);
+    log.stop();
+
+    std::vector<std::uint8_t> data = bytes();
+    data.resize(data.size() - 10);  // Crash in the middle of the last write
+    {
+        Arena arena(kArenaSize);
+        StringPool strings(arena);
+        EventGraph copy(arena, strings, 1024);
+        const auto replay = replay_event_log(data, copy, strings);
+        ASSERT_TRUE(replay.has_value());
+        EXPECT_FALSE(replay->complete);
+        EXPECT_EQ(replay->events, 1u);
+    }
+
+    data = bytes();
+    data[intact + kLogHeaderSize + 8] ^= 0xFF;  // In the second flush's first string
+    {
+        Arena arena(kArenaSize);
+        StringPool strings(arena);
+        EventGraph copy(arena, strings, 1024);
+        const auto replay = replay_event_log(data, copy, strings);
+        ASSERT_TRUE(replay.has_value());
+        EXPECT_FALSE(replay->complete);
+        EXPECT_EQ(copy.count(), 1u);
+    }
+
+    data = bytes();
+    data[0] = 'X';
+    Arena arena(kArenaSize);
+    StringPool strings(arena);
+    EventGraph copy(arena, strings, 1024);
+    EXPECT_FALSE(replay_event_log(data, copy, strings).has_value());
+    EXPECT_FALSE(read_event_log(path_ / "missing", copy, strings).has_value());
+}
+
+TEST_F(EventLogTest, Ring_CountsLostEventsAndRenumbers) {
+    Arena arena(kArenaSize);
+    StringPool strings(arena);
+    EventGraph ring(arena, strings, 2 * EventGraph::kSegmentSize, Retention::Ring);
+    EventLogWriter log(ring, strings);
+    ASSERT_TRUE(log.open(path_));
+
+    EventPayload payload{};
+    payload.category = Category::Thread;
+    const std::size_t total = 3 * EventGraph::kSegmentSize;
+    for (std::size_t i = 1; i <= total; ++i) {
+        ring.push(Category::Thread, 0, Status::Success,
+                  i > 1 ? static_cast<EventId>(i - 1) : INVALID_EVENT, 0, payload,
+                  static_cast<Timestamp>(i));
+    }
+    EXPECT_EQ(log.flush(), ring.count());
+    EXPECT_EQ(log.lost(), total - ring.count());
+    log.stop();
+
+    Arena copy_arena(kArenaSize);
+    StringPool copy_strings(copy_arena);
+    EventGraph copy(copy_arena, copy_strings, total);
+    const auto replay = read_event_log(path_, copy, copy_strings);
+    ASSERT_TRUE(replay.has_value());
+    EXPECT_EQ(replay->events, ring.count());
+    EXPECT_EQ(copy.get(1).timestamp(), ring.oldest_id());
+    EXPECT_EQ(copy.get(1).parent_id(), INVALID_EVENT);  // Its parent was evicted
+    EXPECT_EQ(copy.get(2).parent_id(), 1u);
+}
+
+}  // namespace
+}  // namespace exeray::event
@@ -0,0 +1,255 @@
+/// @file event_graph_mapped_log_test.cpp
+/// @brief Tests for reading a saved event log in place.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/event/event_log.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/mapped_log.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace exeray::event {
+namespace {
+
+constexpr std::size_t kArenaSize = 64 * 1024 * 1024;
+
+class MappedLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = std::filesystem::temp_directory_path() /
+                ("exeray_mapped_" + std::to_string(::testing::UnitTest::GetInstance()
+                                                       ->random_seed()) +
+                 "_" + ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        index_ = path_;
+        index_ += ".exri";
+        std::filesystem::remove(path_);
+        std::filesystem::remove(index_);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path_);
+        std::filesystem::remove(index_);
+    }
+
+    EventId push_process(std::uint32_t pid, std::string_view image, EventId parent,
+                         std::uint32_t correlation, Timestamp timestamp) {
+        EventPayload payload{};
+        payload.category = Category::Process;
+        payload.process.pid = pid;
+        payload.process.image_path = strings_.intern_path(image);
+        return graph_.push(Category::Process, 0, Status::Success, parent, correlation, payload,
+                           timestamp);
+    }
+
+    EventId push_file(std::string_view path, EventId parent, Timestamp timestamp) {
+        EventPayload payload{};
+        payload.category = Category::FileSystem;
+        payload.file.path = strings_.intern_path(path);
+        return graph_.push(Category::FileSystem, 1, Status::Success, parent, 0, payload,
+                           timestamp);
+    }
+
+    void write_log() {
+        EventLogWriter log(graph_, strings_);
+        ASSERT_TRUE(log.open(path_));
+        log.stop();
+    }
+
+    Arena arena_{kArenaSize};
+    StringPool strings_{arena_};
+    EventGraph graph_{arena_, strings_, 4 * EventGraph::kSegmentSize};
+    std::filesystem::path path_;
+    std::filesystem::path index_;
+};
+
+TEST_F(MappedLogTest, Get_MatchesTheWrittenGraph) {
+    const EventId root = push_process(100, "C:\\Windows\\System32\\cmd.exe", INVALID_EVENT, 9, 10);
+    push_file("C:\\Users\\a\\notes.txt", root, 20);
+    push_process(101, "C:\\Windows\\notepad.exe", root, 9, 30);
+    write_log();
+
+    MappedEventLog log;
+    ASSERT_TRUE(log.open(path_));
+    EXPECT_FALSE(log.open(path_));  // Once per object
+    ASSERT_EQ(log.count(), 3u);
+    EXPECT_EQ(log.oldest_id(), 1u);
+    EXPECT_EQ(log.newest_id(), 3u);
+    EXPECT_TRUE(log.complete());
+    EXPECT_TRUE(log.verify());
+
+    for (EventId id = 1; id <= 3; ++id) {
+        const EventView a = graph_.get(id);
+        const EventView b = log.get(id);
+        EXPECT_EQ(b.id(), id);
+        EXPECT_EQ(b.parent_id(), a.parent_id());
+        EXPECT_EQ(b.timestamp(), a.timestamp());
+        EXPECT_EQ(b.category(), a.category());
+        EXPECT_EQ(b.correlation_id(), a.correlation_id());
+    }
+    EXPECT_EQ(log.resolve_string(log.get(1).payload().process.image_path),
+              "C:\\Windows\\System32\\cmd.exe");
+    EXPECT_EQ(log.resolve_string(log.get(2).payload().file.path), "C:\\Users\\a\\notes.txt");
+    EXPECT_TRUE(log.resolve_string(INVALID_STRING).empty());
+
+    EXPECT_FALSE(log.exists(INVALID_EVENT));
+    EXPECT_FALSE(log.exists(4));
+    EXPECT_THROW((void)log.get(4), std::logic_error);
+}
+
+TEST_F(MappedLogTest, Iteration_UsesBlockIndexes) {
+    const std::size_t total = 2 * EventGraph::kSegmentSize + 10;
+    for (std::size_t i = 1; i <= total; ++i) {
+        if (i % 100 == 0) {
+            push_process(static_cast<std::uint32_t>(i), "C:\\a.exe", INVALID_EVENT, 0,
+                         static_cast<Timestamp>(i));
+        } else {
+            push_file("C:\\x.txt", i > 1 ? 1 : INVALID_EVENT, static_cast<Timestamp>(i));
+        }
+    }
+    write_log();
+
+    MappedEventLog log;
+    ASSERT_TRUE(log.open(path_));
+    ASSERT_EQ(log.count(), total);
+
+    std::size_t all = 0;
+    EventId previous = 0;
+    log.for_each([&](EventView view) {
+        EXPECT_GT(view.id(), previous);
+        previous = view.id();
+        ++all;
+    });
+    EXPECT_EQ(all, total);
+
+    std::size_t processes = 0;
+    log.for_each_category(Category::Process, [&](EventView view) {
+        EXPECT_EQ(view.category(), Category::Process);
+        ++processes;
+    });
+    EXPECT_EQ(processes, total / 100);
+
+    std::vector<Timestamp> range;
+    log.for_each_in_range(EventGraph::kSegmentSize - 1, EventGraph::kSegmentSize + 1,
+                          [&](EventView view) { range.push_back(view.timestamp()); });
+    EXPECT_EQ(range, (std::vector<Timestamp>{EventGraph::kSegmentSize - 1,
+                                             EventGraph::kSegmentSize,
+                                             EventGraph::kSegmentSize + 1}));
+
+    std::size_t stopped = 0;
+    log.for_each([&](EventView) { return ++stopped < 5; });
+    EXPECT_EQ(stopped, 5u);
+}
+
+TEST_F(MappedLogTest, Links_WalkChildrenAndCorrelationsNewestFirst) {
+    const EventId root = push_process(100, "C:\\a.exe", INVALID_EVENT, 0, 1);
+    push_file("C:\\x.txt", root, 2);
+    const EventId child = push_process(101, "C:\\b.exe", root, 5, 3);
+    push_process(102, "C:\\c.exe", child, 5, 4);
+    write_log();
+
+    MappedEventLog log;
+    ASSERT_TRUE(log.open(path_));
+    std::vector<EventId> children;
+    log.for_each_child(root, [&](EventView view) { children.push_back(view.id()); });
+    EXPECT_EQ(children, (std::vector<EventId>{3, 2}));
+
+    std::vector<EventId> correlated;
+    log.for_each_correlation(5, [&](EventView view) { correlated.push_back(view.id()); });
+    EXPECT_EQ(correlated, (std::vector<EventId>{4, 3}));
+
+    std::size_t none = 0;
+    log.for_each_child(4, [&](EventView) { ++none; });
+    log.for_each_correlation(0, [&](EventView) { ++none; });
+    EXPECT_EQ(none, 0u);
+}
+
+TEST_F(MappedLogTest, Index_IsSavedAndReloadedUntilTheLogGrows) {
+    push_process(100, "C:\\a.exe", INVALID_EVENT, 0, 1);
+    push_file("C:\\x.txt", 1, 2);
+    EventLogWriter writer(graph_, strings_);
+    ASSERT_TRUE(writer.open(path_));
+    writer.flush();
+    {
+        MappedEventLog log;
+        ASSERT_TRUE(log.open(path_));
+        EXPECT_EQ(log.count(), 2u);
+        EXPECT_FALSE(log.index_loaded());
+    }
+    ASSERT_TRUE(std::filesystem::exists(index_));
+    {
+        MappedEventLog log;
+        ASSERT_TRUE(log.open(path_));
+        EXPECT_TRUE(log.index_loaded());
+        EXPECT_EQ(log.count(), 2u);
+        EXPECT_EQ(log.get(2).timestamp(), 2u);
+        EXPECT_EQ(log.resolve_string(log.get(2).payload().file.path), "C:\\x.txt");
+    }
+
+    push_file("C:\\y.txt", 1, 3);
+    writer.stop();
+    MappedEventLog log;
+    ASSERT_TRUE(log.open(path_));
+    EXPECT_FALSE(log.index_loaded());  // Stale: rebuilt
+    EXPECT_EQ(log.count(), 3u);
+    EXPECT_EQ(log.resolve_string(log.get(3).payload().file.path), "C:\\y.txt");
+}
+
+TEST_F(MappedLogTest, Open_RejectsOtherFilesAndFlagsDamage) {
+    MappedEventLog missing;
+    EXPECT_FALSE(missing.open(path_));
+
+    push_process(100, "C:\\a.exe", INVALID_EVENT, 0, 1);
+    EventLogWriter writer(graph_, strings_);
+    ASSERT_TRUE(writer.open(path_));
+    writer.flush();
+    push_file("C:\\x.txt", 1, 2);
+    writer.stop();
+
+    std::vector<std::uint8_t> data;
+    {
+        std::ifstream file(path_, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    auto rewrite = [&](const std::vector<std::uint8_t>& bytes) {
+        std::filesystem::remove(index_);
+        std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()),
+                   static_cast<std::streamsize>(bytes.size()));
+    };
+
+    std::vector<std::uint8_t> cut(data.begin(), data.end() - 10);
+    rewrite(cut);
+    {
+        MappedEventLog log;
+        ASSERT_TRUE(log.open(path_));
+        EXPECT_FALSE(log.complete());
+        EXPECT_EQ(log.count(), 1u);
+    }
+
+    std::vector<std::uint8_t> flipped = data;
+    flipped.back() ^= 0xFF;
+    rewrite(flipped);
+    {
+        MappedEventLog log;
+        ASSERT_TRUE(log.open(path_));
+        EXPECT_EQ(log.count(), 2u);
+        EXPECT_FALSE(log.verify());
+    }
+
+    std::vector<std::uint8_t> foreign = data;
+    foreign[0] = 'X';
+    rewrite(foreign);
+    MappedEventLog log;
+    EXPECT_FALSE(log.open(path_));
+}
+
+}  // namespace
+}  // namespace exeray::event
@@ -0,0 +1,165 @@
+#include "event_graph_test_common.hpp"
+
+#include "exeray/thread_pool.hpp"
+
+#include <mutex>
+#include <string>
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// 20. Parallel Iteration
+// ============================================================================
+
+class EventGraphParallelTest : public EventGraphTest {
+protected:
+    ThreadPool pool_{4};
+
+    /// Push n process events with pid = index, several segments' worth.
+    void push_processes(EventGraph& graph, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            EventPayload p = make_process_payload(static_cast<uint32_t>(i));
+            const Status status = i % 5 == 0 ? Status::Suspicious : Status::Success;
+            graph.push(Category::Process, 1, status, INVALID_EVENT, 0, p, 1000 + i);
+        }
+    }
+};
+
+TEST_F(EventGraphParallelTest, Empty_VisitsNothing) {
+    std::atomic<int> visited{0};
+    graph_.parallel_for_each([&](EventView) { visited.fetch_add(1); }, pool_);
+    EXPECT_EQ(visited.load(), 0);
+    EXPECT_EQ(graph_.parallel_reduce(
+                  7, [](int& acc, EventView) { ++acc; }, [](int& acc, int&& c) { acc += c; },
+                  pool_),
+              7);
+    std::vector<EventId> ids;
+    EXPECT_EQ(graph_.parallel_scan(FilterSpec{}, ids, pool_), 0U);
+}
+
+TEST_F(EventGraphParallelTest, ForEach_VisitsEveryEventOnce) {
+    const std::size_t n = EventGraph::kSegmentSize * 5 + 321;
+    push_processes(graph_, n);
+
+    std::vector<std::atomic<int>> seen(n + 1);
+    graph_.parallel_for_each(
+        [&](EventView view) { seen[view.id()].fetch_add(1, std::memory_order_relaxed); },
+        pool_);
+    for (std::size_t id = 1; id <= n; ++id) {
+        ASSERT_EQ(seen[id].load(), 1) << "id " << id;
+    }
+}
+
+TEST_F(EventGraphParallelTest, ForEach_FalseStopsClaimingChunks) {
+    push_processes(graph_, EventGraph::kSegmentSize * 8);
+    std::atomic<std::size_t> visited{0};
+    graph_.parallel_for_each(
+        [&](EventView) {
+            visited.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        },
+        pool_);
+    // One event per chunk that started before the stop was seen, at most
+    EXPECT_GE(visited.load(), 1U);
+    EXPECT_LE(visited.load(), 8U);
+}
+
+TEST_F(EventGraphParallelTest, ForEachWhere_MatchesSequential) {
+    push_processes(graph_, EventGraph::kSegmentSize * 3 + 17);
+    FilterSpec suspicious;
+    suspicious.with_status(Status::Suspicious);
+
+    std::vector<EventId> expected;
+    graph_.for_each_where(suspicious, [&](EventView view) { expected.push_back(view.id()); });
+
+    std::mutex mutex;
+    std::vector<EventId> ids;
+    graph_.parallel_for_each_where(
+        suspicious,
+        [&](EventView view) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ids.push_back(view.id());
+        },
+        pool_);
+    std::sort(ids.begin(), ids.end());
+    EXPECT_EQ(ids, expected);
+}
+
+TEST_F(EventGraphParallelTest, Reduce_CombinesChunksInOrder) {
+    const std::size_t n = EventGraph::kSegmentSize * 4 + 5;
+    push_processes(graph_, n);
+
+    // Concatenation is not commutative: chunk order shows in the result
+    const auto digits = graph_.parallel_reduce(
+        std::string{},
+        [](std::string& acc, EventView view) {
+            if (view.as_process().pid % 1000 == 0) {
+                acc += std::to_string(view.as_process().pid) + ",";
+            }
+        },
+        [](std::string& acc, std::string&& chunk) { acc += chunk; }, pool_);
+    std::string expected;
+    for (std::size_t pid = 0; pid < n; pid += 1000) {
+        expected += std::to_string(pid) + ",";
+    }
+    EXPECT_EQ(digits, expected);
+
+    const auto sum = graph_.parallel_reduce(
+        std::uint64_t{0}, [](std::uint64_t& acc, EventView view) { acc += view.as_process().pid; },
+        [](std::uint64_t& acc, std::uint64_t&& chunk) { acc += chunk; }, pool_);
+    EXPECT_EQ(sum, static_cast<std::uint64_t>(n) * (n - 1) / 2);
+}
+
+TEST_F(EventGraphParallelTest, Scan_MatchesSequentialOrder) {
+    graph_.set_columnar(true);
+    push_processes(graph_, EventGraph::kSegmentSize * 3 + 200);
+    ASSERT_EQ(graph_.sealed_count(), 3U);
+
+    FilterSpec spec;
+    spec.with_status(Status::Suspicious);
+    spec.from = 1500;
+    std::vector<EventId> expected;
+    graph_.scan(spec, expected);
+
+    std::vector<EventId> ids{INVALID_EVENT};
+    EXPECT_EQ(graph_.parallel_scan(spec, ids, pool_), expected.size());
+    ASSERT_EQ(ids.size(), expected.size() + 1);
+    EXPECT_EQ(ids.front(), INVALID_EVENT);
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), ids.begin() + 1));
+}
+
+TEST_F(EventGraphParallelTest, RingMode_UnalignedStart_MatchesSequential) {
+    Arena arena(16 * 1024 * 1024);
+    StringPool strings(arena);
+    EventGraph ring(arena, strings, EventGraph::kSegmentSize * 2, Retention::Ring);
+    push_processes(ring, EventGraph::kSegmentSize * 4 + 999);
+
+    FilterSpec all;
+    std::vector<EventId> expected;
+    ring.scan(all, expected);
+    std::vector<EventId> ids;
+    ring.parallel_scan(all, ids, pool_);
+    EXPECT_EQ(ids, expected);
+
+    const auto count = ring.parallel_reduce(
+        std::size_t{0}, [](std::size_t& acc, EventView) { ++acc; },
+        [](std::size_t& acc, std::size_t&& chunk) { acc += chunk; }, pool_);
+    EXPECT_EQ(count, ring.count());
+}
+
+TEST_F(EventGraphParallelTest, CalledFromPoolWorker) {
+    push_processes(graph_, EventGraph::kSegmentSize * 3);
+    std::atomic<std::size_t> visited{0};
+    std::atomic<bool> finished{false};
+    pool_.submit([&] {
+        graph_.parallel_for_each([&](EventView) { visited.fetch_add(1); }, pool_);
+        finished.store(true);
+        finished.notify_all();
+    });
+    finished.wait(false);
+    EXPECT_EQ(visited.load(), EventGraph::kSegmentSize * 3);
+}
+
+}  // namespace exeray::event::test
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "exeray/event/columns.hpp"
+#include "exeray/event/payload_visit.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// Payload visitor and traits
+// ============================================================================
+
+TEST(PayloadVisitTest, Visit_PassesActiveMemberForEveryCategory) {
+    for (std::uint8_t c = 0; c < static_cast<std::uint8_t>(Category::Count); ++c) {
+        EventPayload payload{};
+        payload.category = static_cast<Category>(c);
+
+        Category seen = Category::Count;
+        const void* member = nullptr;
+        EXPECT_TRUE(visit(payload, [&](auto& p) {
+            seen = PayloadTraits<std::remove_cvref_t<decltype(p)>>::category;
+            member = &p;
+        }));
+        EXPECT_EQ(seen, payload.category);
+        EXPECT_EQ(member, static_cast<const void*>(&payload.file));
+    }
+}
+
+TEST(PayloadVisitTest, Visit_OutOfRangeCategory_NotCalled) {
+    EventPayload payload{};
+    payload.category = Category::Count;
+
+    bool called = false;
+    EXPECT_FALSE(visit(payload, [&called](const auto&) { called = true; }));
+    EXPECT_FALSE(called);
+}
+
+TEST(PayloadVisitTest, ForEachString_VisitsStringMembersInOrder) {
+    EventPayload payload{};
+    payload.category = Category::Security;
+    payload.security.subject_user = 1;
+    payload.security.target_user = 2;
+    payload.security.command_line = 3;
+    payload.security.process_id = 99;
+
+    std::vector<StringId> ids;
+    for_each_string(payload, [&ids](StringId id) { ids.push_back(id); });
+    EXPECT_EQ(ids, (std::vector<StringId>{1, 2, 3}));
+}
+
+TEST(PayloadVisitTest, ForEachString_MutableRemapsInPlace) {
+    EventPayload payload{};
+    payload.category = Category::Registry;
+    payload.registry.key_path = 5;
+    payload.registry.value_name = 6;
+
+    for_each_string(payload, [](StringId& id) { id += 10; });
+    EXPECT_EQ(payload.registry.key_path, 15u);
+    EXPECT_EQ(payload.registry.value_name, 16u);
+}
+
+TEST(PayloadVisitTest, ForEachString_NetworkAddressesOnlyForIpv6) {
+    EventPayload payload{};
+    payload.category = Category::Network;
+    payload.network.local_addr = 0x0100007F;
+    payload.network.remote_addr = 0x08080808;
+    payload.network.family = kAddressIPv4;
+
+    // The domain is always a string, the addresses only for IPv6
+    int count = 0;
+    for_each_string(payload, [&count](StringId) { ++count; });
+    EXPECT_EQ(count, 1);
+
+    count = 0;
+    payload.network.family = kAddressIPv6;
+    for_each_string(payload, [&count](StringId) { ++count; });
+    EXPECT_EQ(count, 3);
+}
+
+TEST(PayloadVisitTest, EventPid_FollowsTraits) {
+    static_assert(payload_has_pid<ProcessPayload>);
+    static_assert(payload_has_pid<ThreadPayload>);
+    static_assert(!payload_has_pid<FilePayload>);
+    static_assert(payload_string_count<WmiPayload> == 3);
+    static_assert(payload_string_count<InputPayload> == 0);
+
+    EventPayload payload{};
+    payload.category = Category::Memory;
+    payload.memory.process_id = 4242;
+    EXPECT_EQ(event_pid(payload), 4242u);
+
+    payload = EventPayload{};
+    payload.category = Category::Script;
+    EXPECT_EQ(event_pid(payload), 0u);
+}
+
+}  // namespace exeray::event::test
@@ -0,0 +1,86 @@
+#include "event_graph_test_common.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+namespace {
+
+constexpr auto kCreate = static_cast<uint8_t>(ProcessOp::Create);
+constexpr auto kTerminate = static_cast<uint8_t>(ProcessOp::Terminate);
+
+PendingEvent pending(const EventPayload& payload, uint8_t op = 0, uint32_t header_pid = 0) {
+    return PendingEvent{payload.category, op, Status::Success, INVALID_EVENT, 0, payload, 0,
+                        header_pid};
+}
+
+EventPayload thread_of(uint32_t pid) {
+    EventPayload payload{};
+    payload.category = Category::Thread;
+    payload.thread.process_id = pid;
+    return payload;
+}
+
+}  // namespace
+
+// ============================================================================
+// Per-process index
+// ============================================================================
+
+TEST_F(EventGraphTest, ForEachProcess_PayloadAndHeaderPids) {
+    const std::vector<PendingEvent> events = {
+        pending(make_process_payload(100), kCreate, 4),  // Logged by the parent
+        pending(make_file_payload(), 0, 100),            // Only the header names it
+        pending(thread_of(200)),
+        pending(make_registry_payload(), 0, 100),
+        pending(thread_of(100)),
+    };
+    std::vector<EventId> ids(events.size());
+    ASSERT_EQ(graph_.push_batch(events, ids), events.size());
+
+    std::vector<EventId> seen;
+    graph_.for_each_process(100, [&seen](EventView view) { seen.push_back(view.id()); });
+    EXPECT_EQ(seen, (std::vector<EventId>{ids[4], ids[3], ids[1], ids[0]}));
+
+    seen.clear();
+    graph_.for_each_process(4, [&seen](EventView view) { seen.push_back(view.id()); });
+    EXPECT_TRUE(seen.empty());  // The parent only logged the create
+    graph_.for_each_process(0, [&seen](EventView view) { seen.push_back(view.id()); });
+    EXPECT_TRUE(seen.empty());
+}
+
+TEST_F(EventGraphTest, ForEachProcess_StopsAtStartOfIncarnation) {
+    EventPayload p = make_process_payload(300);
+    graph_.push(Category::Process, kCreate, Status::Success, INVALID_EVENT, 0, p);
+    EventPayload old_thread = thread_of(300);
+    graph_.push(Category::Thread, 0, Status::Success, INVALID_EVENT, 0, old_thread);
+    graph_.push(Category::Process, kTerminate, Status::Success, INVALID_EVENT, 0, p);
+
+    // PID reused by a new process
+    const EventId start =
+        graph_.push(Category::Process, kCreate, Status::Success, INVALID_EVENT, 0, p);
+    EventPayload thread = thread_of(300);
+    const EventId newest =
+        graph_.push(Category::Thread, 0, Status::Success, INVALID_EVENT, 0, thread);
+
+    std::vector<EventId> seen;
+    graph_.for_each_process(300, [&seen](EventView view) { seen.push_back(view.id()); });
+    EXPECT_EQ(seen, (std::vector<EventId>{newest, start}));
+}
+
+TEST_F(EventGraphTest, ForEachProcess_CommitTakesHeaderPid) {
+    const auto slot = graph_.reserve();
+    ASSERT_TRUE(slot);
+    slot.node->payload = make_file_payload();
+    const EventId id = graph_.commit(slot, INVALID_EVENT, 0, 512);
+
+    int visited = 0;
+    graph_.for_each_process(512, [&](EventView view) {
+        EXPECT_EQ(view.id(), id);
+        ++visited;
+        return false;
+    });
+    EXPECT_EQ(visited, 1);
+}
+
+}  // namespace exeray::event::test
@@ -0,0 +1,103 @@
+#include "event_graph_test_common.hpp"
+
+#include "exeray/event/retained_events.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// Long-term store of evicted events
+// ============================================================================
+
+class EventGraphRetainedTest : public EventGraphTest {
+protected:
+    static constexpr std::size_t kRingCapacity = EventGraph::kSegmentSize * 2;
+
+    Arena ring_arena_{16 * 1024 * 1024};
+    StringPool ring_strings_{ring_arena_};
+    EventGraph ring_{ring_arena_, ring_strings_, kRingCapacity, Retention::Ring};
+    RetainedEvents store_{RetainedConfig{.enabled = true, .capacity = 64, .marks = 64}};
+
+    void SetUp() override { ASSERT_TRUE(ring_.set_retained(&store_)); }
+
+    EventId push(uint32_t pid, uint32_t correlation = 0, Status status = Status::Success) {
+        return ring_.push(Category::Process, 0, status, INVALID_EVENT, correlation,
+                          make_process_payload(pid));
+    }
+
+    /// @brief Push benign events of pid 1 until the segment of id is evicted.
+    void evict(EventId id) {
+        while (!ring_.is_evicted(id)) {
+            push(1);
+        }
+    }
+
+    std::vector<EventId> retained_ids() const {
+        std::vector<EventId> ids;
+        store_.for_each([&ids](EventView view, EventTags) { ids.push_back(view.id()); });
+        return ids;
+    }
+};
+
+TEST_F(EventGraphRetainedTest, Eviction_KeepsFlaggedChainsAndCountsTheRest) {
+    const EventId before = push(20, 7);  // Same chain, before the detection
+    const EventId flagged = push(10, 7, Status::Suspicious);
+    const EventId process = push(10);  // Same process
+    const EventId noise = push(30);
+    evict(noise);
+
+    EXPECT_EQ(retained_ids(), (std::vector<EventId>{before, flagged, process}));
+    std::vector<EventId> chain;
+    store_.for_each_correlation(7, [&chain](EventView view, EventTags) {
+        chain.push_back(view.id());
+    });
+    EXPECT_EQ(chain, (std::vector<EventId>{before, flagged}));
+
+    const RetainedStats stats = store_.stats();
+    EXPECT_EQ(stats.events, 3u);
+    EXPECT_EQ(stats.kept, 3u);
+    EXPECT_EQ(stats.dropped, EventGraph::kSegmentSize - 3);
+    EXPECT_EQ(stats.marks, 2u);
+    EXPECT_EQ(store_.dropped().pid_count(30), 1u);
+    EXPECT_EQ(store_.dropped().snapshot().at(Category::Process, Status::Success),
+              EventGraph::kSegmentSize - 3);
+}
+
+TEST_F(EventGraphRetainedTest, LateFlags_MarkProcessOfLiveEvents) {
+    const EventId tagged = push(40);
+    const EventId restatused = push(50);
+    const EventId later = push(50);
+    ASSERT_TRUE(ring_.add_tags(tagged, 0x4));
+    ASSERT_TRUE(ring_.set_status(restatused, Status::Suspicious));
+    EXPECT_TRUE(store_.marked_process(40));
+    EXPECT_TRUE(store_.marked_process(50));
+    EXPECT_FALSE(store_.marked_correlation(0));
+    evict(later);
+
+    EventTags tags = 0;
+    store_.for_each_process(40, [&tags](EventView, EventTags t) { tags |= t; });
+    EXPECT_EQ(tags, 0x4u);
+    EXPECT_EQ(retained_ids(), (std::vector<EventId>{tagged, restatused, later}));
+}
+
+TEST_F(EventGraphRetainedTest, FullStore_OverwritesOldest) {
+    for (uint32_t i = 0; i < 100; ++i) {
+        push(1000 + i, 0, Status::Suspicious);
+    }
+    evict(100);
+
+    const RetainedStats stats = store_.stats();
+    EXPECT_EQ(stats.events, store_.capacity());
+    EXPECT_EQ(stats.overwritten, 100 - store_.capacity());
+    EXPECT_EQ(retained_ids().front(), 100 - store_.capacity() + 1);
+    EXPECT_LE(stats.marks, 64u);  // The mark table forgot the oldest pids
+}
+
+TEST_F(EventGraphRetainedTest, SetRetained_RefusedInAppendMode) {
+    EXPECT_FALSE(graph_.set_retained(&store_));
+    EXPECT_EQ(graph_.retained(), nullptr);
+    EXPECT_TRUE(graph_.set_retained(nullptr));
+}
+
+}  // namespace exeray::event::test
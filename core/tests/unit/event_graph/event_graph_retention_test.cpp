@@ -0,0 +1,238 @@
+#include "event_graph_test_common.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// 12. Ring-Buffer Retention
+// ============================================================================
+
+class EventGraphRingTest : public EventGraphTest {
+protected:
+    static constexpr std::size_t kRingSegments = 3;
+    static constexpr std::size_t kRingCapacity = EventGraph::kSegmentSize * kRingSegments;
+
+    Arena ring_arena_{16 * 1024 * 1024};
+    StringPool ring_strings_{ring_arena_};
+    EventGraph ring_{ring_arena_, ring_strings_, kRingCapacity, Retention::Ring};
+
+    EventId push_n(std::size_t n, EventId parent = INVALID_EVENT,
+                   uint32_t correlation = 0) {
+        EventId last = INVALID_EVENT;
+        for (std::size_t i = 0; i < n; ++i) {
+            EventPayload p = make_process_payload(static_cast<uint32_t>(i));
+            last = ring_.push(Category::Process, 0, Status::Success, parent,
+                              correlation, p);
+        }
+        return last;
+    }
+};
+
+TEST_F(EventGraphRingTest, ForEachRun_EvictedBegin_StartsAtOldest) {
+    push_n(kRingCapacity * 2);
+    const EventId oldest = ring_.oldest_id();
+    ASSERT_GT(oldest, 1U);
+
+    EventId first = INVALID_EVENT;
+    const std::size_t visited = ring_.for_each_run(0, 4, [&first](const EventNode& node) {
+        if (first == INVALID_EVENT) {
+            first = node.id;
+        }
+    });
+    EXPECT_EQ(visited, 4U);
+    EXPECT_EQ(first, oldest);
+}
+
+TEST_F(EventGraphRingTest, SegmentSpan_EvictionChangesEpoch) {
+    push_n(kRingCapacity);
+    const auto span = ring_.segment_span(0);
+    ASSERT_GT(span.length, 0U);
+    EXPECT_EQ(span.first, ring_.oldest_id() - 1);
+
+    // Recycling the segment is visible to a reader holding the span
+    push_n(kRingCapacity);
+    EXPECT_NE(ring_.epoch(), span.epoch);
+    EXPECT_EQ(ring_.segment_span(0).first, ring_.oldest_id() - 1);
+}
+
+TEST_F(EventGraphRingTest, Push_BeyondCapacity_NeverFails) {
+    for (std::size_t i = 0; i < kRingCapacity * 3; ++i) {
+        EventPayload p = make_process_payload();
+        ASSERT_NE(ring_.push(Category::Process, 0, Status::Success,
+                             INVALID_EVENT, 0, p),
+                  INVALID_EVENT);
+    }
+    EXPECT_LE(ring_.count(), kRingCapacity);
+    EXPECT_EQ(ring_.segment_count(), kRingSegments);
+}
+
+TEST_F(EventGraphRingTest, Eviction_RecyclesOldestSegmentAndBumpsEpoch) {
+    push_n(kRingCapacity);
+    EXPECT_EQ(ring_.epoch(), 0U);
+    EXPECT_EQ(ring_.oldest_id(), 1U);
+    EXPECT_TRUE(ring_.exists(1));
+
+    const auto used_before = ring_arena_.used();
+    EventId newest = push_n(1);
+
+    EXPECT_EQ(ring_.epoch(), 1U);
+    EXPECT_EQ(ring_.oldest_id(), EventGraph::kSegmentSize + 1);
+    EXPECT_TRUE(ring_.is_evicted(1));
+    EXPECT_FALSE(ring_.exists(1));
+    EXPECT_FALSE(ring_.exists(EventGraph::kSegmentSize));
+    EXPECT_TRUE(ring_.exists(EventGraph::kSegmentSize + 1));
+    EXPECT_TRUE(ring_.exists(newest));
+    EXPECT_EQ(ring_.get(newest).id(), newest);
+
+    // Recycled node storage is reused; only the spare category index
+    // segment is allocated on the first wrap
+    EXPECT_EQ(ring_arena_.used() - used_before,
+              EventGraph::kSegmentSize *
+                  (EventGraph::kCompactIndex ? sizeof(std::uint32_t) : sizeof(std::uint64_t)));
+
+    // Steady state: further wraps allocate nothing
+    const auto used_wrapped = ring_arena_.used();
+    push_n(kRingCapacity * 2);
+    EXPECT_EQ(ring_arena_.used(), used_wrapped);
+}
+
+TEST_F(EventGraphRingTest, Count_TracksLiveEventsOnly) {
+    push_n(kRingCapacity + 10);
+    EXPECT_EQ(ring_.count(), kRingCapacity - EventGraph::kSegmentSize + 10);
+}
+
+TEST_F(EventGraphRingTest, ForEach_VisitsLiveEventsInOrder) {
+    push_n(kRingCapacity + EventGraph::kSegmentSize / 2);
+
+    EventId expected = ring_.oldest_id();
+    std::size_t visited = 0;
+    ring_.for_each([&](EventView view) {
+        EXPECT_EQ(view.id(), expected++);
+        ++visited;
+    });
+    EXPECT_EQ(visited, ring_.count());
+}
+
+TEST_F(EventGraphRingTest, Indexes_PrunedWithEvictedSegment) {
+    EventPayload p = make_process_payload();
+    EventId root = ring_.push(Category::Process, 0, Status::Success,
+                              INVALID_EVENT, 0, p);
+
+    // Children and correlated events fill the first segment
+    push_n(EventGraph::kSegmentSize - 1, root, 77);
+
+    // Fill the rest of the ring with one extra segment plus one event
+    push_n(kRingCapacity - EventGraph::kSegmentSize);
+    std::size_t children_before = 0;
+    ring_.for_each_child(root, [&](EventView) { ++children_before; });
+    EXPECT_EQ(children_before, EventGraph::kSegmentSize - 1);
+
+    push_n(1, root, 77);
+
+    // The root itself is evicted now, so it no longer has children
+    std::size_t children = 0;
+    ring_.for_each_child(root, [&](EventView) { ++children; });
+    std::size_t correlated = 0;
+    ring_.for_each_correlation(77, [&](EventView view) {
+        EXPECT_TRUE(ring_.exists(view.id()));
+        ++correlated;
+    });
+
+    EXPECT_FALSE(ring_.exists(root));
+    EXPECT_EQ(children, 0U);
+    EXPECT_EQ(correlated, 1U);
+}
+
+TEST_F(EventGraphRingTest, Construct_SmallCapacityRoundsToTwoSegments) {
+    Arena arena{4 * 1024 * 1024};
+    StringPool strings{arena};
+    EventGraph ring{arena, strings, 10, Retention::Ring};
+    EXPECT_EQ(ring.capacity(), EventGraph::kSegmentSize * 2);
+    EXPECT_EQ(ring.retention(), Retention::Ring);
+}
+
+TEST_F(EventGraphRingTest, CategoryIndex_SkipsEvictedEvents) {
+    // One network event in the first segment, then enough process events
+    // to evict it
+    EventPayload net = make_network_payload();
+    ring_.push(Category::Network, 0, Status::Success, INVALID_EVENT, 0, net);
+    push_n(kRingCapacity * 2);
+
+    std::size_t net_seen = 0;
+    ring_.for_each_category(Category::Network, [&](EventView) { ++net_seen; });
+    EXPECT_EQ(net_seen, 0U);
+    EXPECT_EQ(ring_.category_count(Category::Network), 0U);
+
+    std::size_t process_seen = 0;
+    EventId previous = INVALID_EVENT;
+    ring_.for_each_category(Category::Process, [&](EventView view) {
+        EXPECT_TRUE(ring_.exists(view.id()));
+        EXPECT_GT(view.id(), previous);
+        previous = view.id();
+        ++process_seen;
+    });
+    EXPECT_EQ(process_seen, ring_.count());
+    EXPECT_EQ(ring_.category_count(Category::Process), ring_.count());
+}
+
+TEST_F(EventGraphRingTest, ForEach_ConcurrentWithEviction_OnlyPublishedSlots) {
+    std::atomic<bool> done{false};
+    std::atomic<std::size_t> bad{0};
+
+    std::thread reader([this, &done, &bad]() {
+        while (!done.load(std::memory_order_acquire)) {
+            // A view may only go stale if a recycle happened during the pass
+            const auto epoch = ring_.epoch();
+            ring_.for_each([this, epoch, &bad](EventView view) {
+                if (view.id() == INVALID_EVENT && ring_.epoch() == epoch) {
+                    ++bad;
+                }
+            });
+        }
+    });
+
+    push_n(kRingCapacity * 6);
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    EXPECT_EQ(bad.load(), 0U);
+    EXPECT_GT(ring_.epoch(), 0U);
+}
+
+TEST_F(EventGraphTest, AppendMode_NeverEvicts) {
+    EventPayload p = make_process_payload();
+    graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+    EXPECT_EQ(graph_.retention(), Retention::Append);
+    EXPECT_EQ(graph_.oldest_id(), 1U);
+    EXPECT_EQ(graph_.epoch(), 0U);
+    EXPECT_FALSE(graph_.is_evicted(1));
+}
+
+TEST_F(EventGraphRingTest, ConcurrentPushAcrossEvictions_IdsUnique) {
+    constexpr int kThreads = 4;
+    constexpr std::size_t kPerThread = kRingCapacity;
+    std::vector<std::thread> threads;
+    std::atomic<std::size_t> failures{0};
+
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([this, &failures]() {
+            for (std::size_t i = 0; i < kPerThread; ++i) {
+                EventPayload p = make_process_payload();
+                if (ring_.push(Category::Process, 0, Status::Success,
+                               INVALID_EVENT, 0, p) == INVALID_EVENT) {
+                    ++failures;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(failures.load(), 0U);
+    EXPECT_GT(ring_.epoch(), 0U);
+    EXPECT_LE(ring_.count(), kRingCapacity);
+}
+
+}  // namespace exeray::event::test
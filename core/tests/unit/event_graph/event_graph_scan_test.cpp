@@ -0,0 +1,153 @@
+#include "event_graph_test_common.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// 17. Bulk Filter Scan
+// ============================================================================
+
+class EventGraphScanTest : public EventGraphTest {
+protected:
+    /// Push events cycling through categories, statuses and correlations.
+    void push_varied(EventGraph& graph, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto corr = static_cast<uint32_t>(i % 7);
+            const Status status = i % 3 == 0 ? Status::Denied : Status::Success;
+            if (i % 4 == 0) {
+                EventPayload p = make_network_payload(i % 8 == 0 ? 443 : 80);
+                graph.push(Category::Network, static_cast<uint8_t>(i % 2), status,
+                           INVALID_EVENT, corr, p, 1000 + i);
+            } else if (i % 4 == 1) {
+                EventPayload p = make_file_payload();
+                graph.push(Category::FileSystem, static_cast<uint8_t>(i % 3), status,
+                           INVALID_EVENT, corr, p, 1000 + i);
+            } else {
+                EventPayload p = make_process_payload(static_cast<uint32_t>(i % 5));
+                graph.push(Category::Process, 1, status, INVALID_EVENT, corr, p,
+                           1000 + i);
+            }
+        }
+    }
+
+    /// Reference result: matching IDs found node by node.
+    static std::vector<EventId> reference(const EventGraph& graph, const FilterSpec& spec) {
+        std::vector<EventId> ids;
+        graph.for_each([&](EventView view) {
+            uint32_t pid = 0;
+            uint16_t port = 0;
+            if (view.category() == Category::Process) {
+                pid = view.as_process().pid;
+            } else if (view.category() == Category::Network) {
+                port = view.as_network().remote_port;
+            }
+            if (spec.matches(view.timestamp(), view.category(), view.operation(),
+                             view.status(), pid, port, view.correlation_id())) {
+                ids.push_back(view.id());
+            }
+        });
+        return ids;
+    }
+
+    static std::vector<FilterSpec> filters() {
+        std::vector<FilterSpec> specs(8);
+        specs[1].with_category(Category::Network).with_category(Category::FileSystem);
+        specs[2].with_status(Status::Denied).operation = 1;
+        specs[3].correlation_id = 3;
+        specs[4].from = 1500;
+        specs[4].to = 1000 + EventGraph::kSegmentSize + 77;
+        specs[5].with_category(Category::Network).remote_port = 443;
+        specs[6].pid = 4;
+        specs[6].with_status(Status::Success);
+        specs[7].operation = 2;
+        specs[7].from = 5000;
+        return specs;
+    }
+};
+
+TEST_F(EventGraphScanTest, Empty_NoMatches) {
+    std::vector<EventId> ids;
+    EXPECT_EQ(graph_.scan(FilterSpec{}, ids), 0U);
+    EXPECT_TRUE(ids.empty());
+}
+
+TEST_F(EventGraphScanTest, HotSegments_MatchReference) {
+    push_varied(graph_, EventGraph::kSegmentSize * 2 + 131);
+    for (const FilterSpec& spec : filters()) {
+        std::vector<EventId> ids;
+        const std::size_t found = graph_.scan(spec, ids);
+        EXPECT_EQ(found, ids.size());
+        EXPECT_EQ(ids, reference(graph_, spec));
+    }
+}
+
+TEST_F(EventGraphScanTest, SealedSegments_MatchReference) {
+    graph_.set_columnar(true);
+    push_varied(graph_, EventGraph::kSegmentSize * 2 + 131);
+    ASSERT_EQ(graph_.sealed_count(), 2U);
+    for (const FilterSpec& spec : filters()) {
+        std::vector<EventId> ids;
+        graph_.scan(spec, ids);
+        EXPECT_EQ(ids, reference(graph_, spec));
+    }
+}
+
+TEST_F(EventGraphScanTest, AppendsToExistingOutput) {
+    push_varied(graph_, 100);
+    std::vector<EventId> ids{INVALID_EVENT};
+    FilterSpec network;
+    network.with_category(Category::Network);
+    EXPECT_EQ(graph_.scan(network, ids), 25U);
+    ASSERT_EQ(ids.size(), 26U);
+    EXPECT_EQ(ids.front(), INVALID_EVENT);
+}
+
+TEST_F(EventGraphScanTest, RingMode_UnalignedStart_MatchesReference) {
+    Arena arena(16 * 1024 * 1024);
+    StringPool strings(arena);
+    EventGraph ring(arena, strings, EventGraph::kSegmentSize * 2, Retention::Ring);
+    push_varied(ring, EventGraph::kSegmentSize * 4 + 999);
+
+    for (const FilterSpec& spec : filters()) {
+        std::vector<EventId> ids;
+        ring.scan(spec, ids);
+        EXPECT_EQ(ids, reference(ring, spec));
+        for (EventId id : ids) {
+            EXPECT_FALSE(ring.is_evicted(id));
+        }
+    }
+}
+
+TEST(FilterNodesTest, PartialBlock_ClearsTrailingBits) {
+    std::vector<EventNode> nodes(70);
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        nodes[i].timestamp = i;
+        nodes[i].status = Status::Success;
+        nodes[i].payload.category = i % 2 == 0 ? Category::Network : Category::Process;
+    }
+    FilterSpec network;
+    network.with_category(Category::Network);
+
+    std::uint64_t mask[2] = {~std::uint64_t{0}, ~std::uint64_t{0}};
+    filter_nodes(nodes.data(), nodes.size(), network, mask);
+    EXPECT_EQ(mask[0], 0x5555555555555555ULL);
+    EXPECT_EQ(mask[1], 0x15ULL);  // rows 64, 66, 68
+}
+
+TEST(FilterNodesTest, TimeBounds_AreInclusiveAndUnsigned) {
+    std::vector<EventNode> nodes(64);
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        // Values above INT64_MAX catch a signed comparison in the kernel
+        nodes[i].timestamp = (Timestamp{1} << 63) + i;
+    }
+    FilterSpec spec;
+    spec.from = (Timestamp{1} << 63) + 10;
+    spec.to = (Timestamp{1} << 63) + 20;
+
+    std::uint64_t mask = 0;
+    filter_nodes(nodes.data(), nodes.size(), spec, &mask);
+    EXPECT_EQ(mask, ((std::uint64_t{1} << 11) - 1) << 10);
+}
+
+}  // namespace exeray::event::test
@@ -0,0 +1,120 @@
+#include "event_graph_test_common.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// 11. Segmented Storage
+// ============================================================================
+
+TEST_F(EventGraphTest, Construct_NoNodeStorageAllocatedUpFront) {
+    Arena arena{16 * 1024 * 1024};
+    StringPool strings{arena};
+    const auto used_before = arena.used();
+
+    EventGraph graph{arena, strings, 1 << 20};
+
+    EXPECT_EQ(arena.used(), used_before);
+    EXPECT_EQ(graph.segment_count(), 0U);
+    EXPECT_EQ(graph.capacity(), std::size_t{1} << 20);
+}
+
+TEST_F(EventGraphTest, Push_AllocatesSegmentsOnDemand) {
+    EventPayload p = make_process_payload();
+
+    graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+    EXPECT_EQ(graph_.segment_count(), 1U);
+
+    for (std::size_t i = 1; i < EventGraph::kSegmentSize; ++i) {
+        graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+    }
+    EXPECT_EQ(graph_.segment_count(), 1U);
+
+    graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+    EXPECT_EQ(graph_.segment_count(), 2U);
+}
+
+TEST_F(EventGraphTest, Push_IndexBytesPerSegmentFollowTheLinkWidth) {
+    Arena arena{16 * 1024 * 1024};
+    StringPool strings{arena};
+    EventGraph graph{arena, strings, 1 << 16};
+    EventPayload p = make_process_payload();
+    graph.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+
+    // Five links and the tags beside each node, one category index segment
+    const std::size_t link = EventGraph::kCompactIndex ? 4 : 8;
+    const std::size_t links = EventGraph::kCompactIndex ? 32 : 48;
+    EXPECT_EQ(graph.storage_bytes(),
+              (sizeof(EventNode) + links + link) * EventGraph::kSegmentSize);
+    EXPECT_EQ(EventGraph::kMaxEvents,
+              EventGraph::kCompactIndex ? 0xFFFFFFFFu : ~std::size_t{0});
+}
+
+TEST_F(EventGraphTest, Get_AcrossSegmentBoundary_ReturnsCorrectNode) {
+    constexpr std::size_t kEvents = EventGraph::kSegmentSize * 3 + 7;
+
+    for (std::size_t i = 0; i < kEvents; ++i) {
+        EventPayload p = make_process_payload(static_cast<uint32_t>(i));
+        graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+    }
+
+    for (std::size_t i = 0; i < kEvents; ++i) {
+        const auto id = static_cast<EventId>(i + 1);
+        ASSERT_TRUE(graph_.exists(id));
+        EventView view = graph_.get(id);
+        EXPECT_EQ(view.id(), id);
+        EXPECT_EQ(view.as_process().pid, static_cast<uint32_t>(i));
+    }
+}
+
+TEST_F(EventGraphTest, EventView_StableAcrossGrowth) {
+    EventPayload p = make_process_payload(42);
+    EventId first = graph_.push(Category::Process, 0, Status::Success,
+                                INVALID_EVENT, 0, p);
+    const EventNode* node = graph_.get(first).node();
+
+    for (std::size_t i = 0; i < EventGraph::kSegmentSize * 2; ++i) {
+        graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+    }
+
+    EXPECT_EQ(graph_.get(first).node(), node);
+    EXPECT_EQ(EventView(node).as_process().pid, 42U);
+}
+
+TEST_F(EventGraphTest, ForEach_SpansAllSegments) {
+    constexpr std::size_t kEvents = EventGraph::kSegmentSize + 100;
+    EventPayload p = make_file_payload();
+    for (std::size_t i = 0; i < kEvents; ++i) {
+        graph_.push(Category::FileSystem, 0, Status::Success, INVALID_EVENT, 0, p);
+    }
+
+    std::size_t visited = 0;
+    EventId expected = 1;
+    graph_.for_each([&](EventView view) {
+        EXPECT_EQ(view.id(), expected++);
+        ++visited;
+    });
+    EXPECT_EQ(visited, kEvents);
+}
+
+TEST_F(EventGraphTest, Push_ArenaExhausted_ReturnsInvalidEvent) {
+    // Room for the first segment (nodes plus index links) but not the second
+    Arena tiny_arena{sizeof(EventNode) * EventGraph::kSegmentSize * 2};
+    StringPool tiny_strings{tiny_arena};
+    EventGraph tiny_graph{tiny_arena, tiny_strings, EventGraph::kSegmentSize * 4};
+
+    EventPayload p = make_process_payload();
+    for (std::size_t i = 0; i < EventGraph::kSegmentSize; ++i) {
+        ASSERT_NE(tiny_graph.push(Category::Process, 0, Status::Success,
+                                  INVALID_EVENT, 0, p),
+                  INVALID_EVENT);
+    }
+
+    EXPECT_EQ(tiny_graph.push(Category::Process, 0, Status::Success,
+                              INVALID_EVENT, 0, p),
+              INVALID_EVENT);
+    EXPECT_EQ(tiny_graph.count(), EventGraph::kSegmentSize);
+}
+
+}  // namespace exeray::event::test
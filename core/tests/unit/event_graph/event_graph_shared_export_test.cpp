@@ -0,0 +1,147 @@
+/// @file event_graph_shared_export_test.cpp
+/// @brief Tests for exporting a graph through shared memory.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/shared_export.hpp"
+
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace exeray::event {
+namespace {
+
+constexpr std::size_t kArenaSize = 64 * 1024 * 1024;
+
+class SharedExportTest : public ::testing::Test {
+protected:
+    void push_events(std::size_t total) {
+        for (std::size_t i = 1; i <= total; ++i) {
+            EventPayload payload{};
+            payload.category = Category::FileSystem;
+            payload.file.path =
+                strings_.intern_path("C:\\data\\file" + std::to_string(i % 20) + ".txt");
+            graph_.push(Category::FileSystem, 0, Status::Success, INVALID_EVENT, 0, payload,
+                        1000 + i);
+        }
+    }
+
+    /// Section name unique to this test and process (tests run in parallel).
+    static std::string section_name() {
+        std::string name = "exeray-test-";
+        name += ::testing::UnitTest::GetInstance()->current_test_info()->name();
+#if defined(__unix__) || defined(__APPLE__)
+        name += "-" + std::to_string(getpid());
+#endif
+        return name;
+    }
+
+    SharedExportConfig config(std::size_t slots = std::size_t{1} << 16) const {
+        return {.name = section_name(), .node_slots = slots, .string_bytes = 1 << 20};
+    }
+
+    Arena arena_{kArenaSize};
+    StringPool strings_{arena_};
+    EventGraph graph_{arena_, strings_, 8 * EventGraph::kSegmentSize};
+};
+
+TEST_F(SharedExportTest, Reader_SeesEveryEventAndString) {
+    SharedGraphExport exporter(graph_, strings_);
+    ASSERT_TRUE(exporter.open(config()));
+    push_events(5000);
+    EXPECT_EQ(exporter.flush(), 5000u);
+
+    SharedGraphReader reader;
+    ASSERT_TRUE(reader.open(section_name()));
+    EXPECT_EQ(reader.header()->node_slots, std::size_t{1} << 16);
+
+    std::vector<EventId> ids;
+    std::size_t paths_ok = 0;
+    reader.read([&](const EventNode& node) {
+        ids.push_back(node.id);
+        paths_ok += reader.resolve(node.payload.file.path) ==
+                    strings_.get(graph_.get(node.id).payload().file.path);
+    });
+    ASSERT_EQ(ids.size(), 5000u);
+    EXPECT_EQ(ids.front(), 1u);
+    EXPECT_EQ(ids.back(), 5000u);
+    EXPECT_EQ(paths_ok, 5000u);
+    EXPECT_EQ(reader.missed(), 0u);
+    EXPECT_FALSE(reader.overrun());
+
+    // Only what was exported since
+    push_events(10);
+    exporter.flush();
+    EXPECT_EQ(reader.read([](const EventNode&) {}), 10u);
+    EXPECT_EQ(reader.cursor(), 5010u);
+}
+
+TEST_F(SharedExportTest, SlowReader_MissesOverwrittenEventsOnly) {
+    SharedGraphExport exporter(graph_, strings_);
+    ASSERT_TRUE(exporter.open(config(2 * EventGraph::kSegmentSize)));
+    SharedGraphReader reader;
+    ASSERT_TRUE(reader.open(section_name()));
+
+    // Five segments through a ring of two: the exporter never waits
+    push_events(5 * EventGraph::kSegmentSize);
+    EXPECT_EQ(exporter.flush(), 5 * EventGraph::kSegmentSize);
+
+    EventId first = INVALID_EVENT;
+    std::size_t read = 0;
+    reader.read([&](const EventNode& node) {
+        if (first == INVALID_EVENT) {
+            first = node.id;
+        }
+        ++read;
+    });
+    EXPECT_EQ(reader.missed(), 3 * EventGraph::kSegmentSize);
+    EXPECT_EQ(read, 2 * EventGraph::kSegmentSize);
+    EXPECT_EQ(first, 3 * EventGraph::kSegmentSize + 1);
+}
+
+TEST_F(SharedExportTest, Open_RejectsMissingSection) {
+    SharedGraphReader reader;
+    EXPECT_FALSE(reader.open(section_name()));
+    EXPECT_EQ(reader.read([](const EventNode&) {}), 0u);
+}
+
+TEST_F(SharedExportTest, Stop_RemovesSection) {
+    SharedGraphExport exporter(graph_, strings_);
+    ASSERT_TRUE(exporter.open(config()));
+    exporter.start(std::chrono::milliseconds(1));
+    push_events(100);
+    exporter.stop();
+    EXPECT_EQ(exporter.events_exported(), 100u);
+
+    SharedGraphReader reader;
+    EXPECT_FALSE(reader.open(section_name()));
+}
+
+TEST_F(SharedExportTest, FullStringArea_CountsDroppedStrings) {
+    SharedGraphExport exporter(graph_, strings_);
+    SharedExportConfig small = config();
+    small.string_bytes = 64;
+    ASSERT_TRUE(exporter.open(small));
+    push_events(100);
+    exporter.flush();
+    EXPECT_GT(exporter.strings_dropped(), 0u);
+
+    SharedGraphReader reader;
+    ASSERT_TRUE(reader.open(section_name()));
+    EXPECT_EQ(reader.header()->strings_dropped, exporter.strings_dropped());
+    std::size_t resolved = 0;
+    reader.read([&](const EventNode& node) {
+        resolved += !reader.resolve(node.payload.file.path).empty();
+    });
+    EXPECT_GT(resolved, 0u);
+    EXPECT_LT(resolved, 100u);
+}
+
+}  // namespace
+}  // namespace exeray::event
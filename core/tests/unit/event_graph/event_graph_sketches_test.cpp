@@ -0,0 +1,117 @@
+#include "event_graph_test_common.hpp"
+
+#include <cmath>
+#include <thread>
+
+#include "exeray/event/sketches.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// Heavy-hitter and cardinality sketches
+// ============================================================================
+
+TEST(CardinalitySketchTest, Estimate_WithinFewPercent) {
+    for (const std::uint64_t n : {10ULL, 1000ULL, 100000ULL}) {
+        CardinalitySketch sketch;
+        for (std::uint64_t i = 0; i < n; ++i) {
+            sketch.add(i);
+            sketch.add(i);  // Repeats do not count
+        }
+        const double error = std::abs(sketch.estimate() - static_cast<double>(n)) /
+                             static_cast<double>(n);
+        EXPECT_LT(error, 0.05) << n;
+    }
+    EXPECT_EQ(CardinalitySketch{}.estimate(), 0.0);
+}
+
+TEST(HeavyHittersTest, Top_FindsFrequentKeysAmongNoise) {
+    HeavyHitters hitters(5);
+    for (std::uint64_t round = 0; round < 200; ++round) {
+        for (std::uint64_t key = 1; key <= 5; ++key) {
+            for (std::uint64_t i = 0; i < key; ++i) {
+                hitters.add(key);
+            }
+        }
+        for (std::uint64_t i = 0; i < 20; ++i) {
+            hitters.add(1000 + round * 20 + i);  // Each noise key seen once
+        }
+    }
+
+    const auto top = hitters.top();
+    ASSERT_EQ(top.size(), 5u);
+    for (std::size_t i = 0; i < top.size(); ++i) {
+        EXPECT_EQ(top[i].key, 5 - i);
+        EXPECT_GE(top[i].count, (5 - i) * 200);  // Count-Min never underestimates
+    }
+}
+
+TEST(HeavyHittersTest, Add_ConcurrentWritersKeepTopKey) {
+    HeavyHitters hitters(3);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&hitters, t] {
+            for (std::uint64_t i = 0; i < 20000; ++i) {
+                hitters.add(i % 2 == 0 ? 7 : 100 + t * 20000 + i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const auto top = hitters.top();
+    ASSERT_FALSE(top.empty());
+    EXPECT_EQ(top.front().key, 7u);
+    EXPECT_GE(top.front().count, 40000u);
+}
+
+TEST_F(EventGraphTest, Sketches_TrackFilesAddressesDomainsAndProcesses) {
+    EXPECT_EQ(graph_.sketches(), nullptr);
+    graph_.set_sketches(2);
+    ASSERT_NE(graph_.sketches(), nullptr);
+
+    const StringId hot = strings_.intern("C:\\hot.txt");
+    for (int i = 0; i < 10; ++i) {
+        EventPayload file{};
+        file.category = Category::FileSystem;
+        file.file.path = i % 2 == 0 ? hot : strings_.intern("C:\\cold" + std::to_string(i));
+        graph_.push(Category::FileSystem, 0, Status::Success, INVALID_EVENT, 0, file);
+    }
+    EventPayload dns{};
+    dns.category = Category::Dns;
+    dns.dns.domain = strings_.intern("example.com");
+    graph_.push(Category::Dns, 0, Status::Success, INVALID_EVENT, 0, dns);
+
+    std::vector<PendingEvent> batch(3);
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        batch[i] = PendingEvent{Category::Network, 0, Status::Success, INVALID_EVENT, 0,
+                                make_network_payload(), 0};
+        batch[i].payload.network.remote_addr = 0x0100007F + static_cast<uint32_t>(i % 2);
+    }
+    graph_.push_batch(batch);
+    graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0,
+                make_process_payload(4242));
+
+    const SketchSnapshot snap = graph_.sketches()->snapshot();
+    EXPECT_NEAR(snap[SketchKind::Files].unique, 6.0, 0.5);
+    ASSERT_FALSE(snap[SketchKind::Files].top.empty());
+    EXPECT_EQ(snap[SketchKind::Files].top.front().key, hot);
+    EXPECT_EQ(snap[SketchKind::Files].top.front().count, 5u);
+    EXPECT_NEAR(snap[SketchKind::Domains].unique, 1.0, 0.5);
+    EXPECT_NEAR(snap[SketchKind::RemoteAddresses].unique, 2.0, 0.5);
+    EXPECT_EQ(snap[SketchKind::RemoteAddresses].top.front().key, 0x0100007Fu);
+    ASSERT_FALSE(snap[SketchKind::Processes].top.empty());
+    EXPECT_EQ(snap[SketchKind::Processes].top.front().key, 4242u);
+}
+
+TEST(EventSketchesTest, AddressKey_SeparatesIpv6StringIds) {
+    NetworkPayload network{};
+    network.remote_addr = 5;
+    EXPECT_EQ(address_key(network), 5u);
+    network.family = kAddressIPv6;
+    EXPECT_EQ(address_key(network), (std::uint64_t{1} << 32) | 5);
+}
+
+}  // namespace exeray::event::test
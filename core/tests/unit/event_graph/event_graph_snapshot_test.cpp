@@ -0,0 +1,123 @@
+#include "event_graph_test_common.hpp"
+
+#include "exeray/event/snapshot.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// 19. Snapshots
+// ============================================================================
+
+namespace {
+
+std::vector<EventId> ids_of(const GraphSnapshot& snap) {
+    std::vector<EventId> ids;
+    snap.for_each([&ids](EventView view) { ids.push_back(view.id()); });
+    return ids;
+}
+
+}  // namespace
+
+TEST_F(EventGraphTest, Snapshot_Empty_VisitsNothing) {
+    GraphSnapshot snap(graph_);
+    graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0,
+                make_process_payload());
+    EXPECT_EQ(snap.count(), 0U);
+    EXPECT_TRUE(ids_of(snap).empty());
+    EXPECT_TRUE(snap.intact());
+}
+
+TEST_F(EventGraphTest, Snapshot_IgnoresLaterPushes) {
+    std::vector<EventId> before;
+    for (int i = 0; i < 100; ++i) {
+        before.push_back(graph_.push(i % 2 == 0 ? Category::Process : Category::Network, 0,
+                                     Status::Success, INVALID_EVENT, 0,
+                                     i % 2 == 0 ? make_process_payload()
+                                                : make_network_payload(),
+                                     1000 + static_cast<Timestamp>(i)));
+    }
+    GraphSnapshot snap(graph_);
+    for (std::size_t i = 0; i < EventGraph::kSegmentSize; ++i) {
+        graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0,
+                    make_process_payload(), 1000);
+    }
+
+    EXPECT_EQ(snap.count(), before.size());
+    EXPECT_EQ(ids_of(snap), before);
+    EXPECT_TRUE(snap.contains(before.front()));
+    EXPECT_FALSE(snap.contains(before.back() + 1));
+
+    int processes = 0;
+    snap.for_each_category(Category::Process, [&processes](EventView) { ++processes; });
+    EXPECT_EQ(processes, 50);
+
+    int in_range = 0;
+    snap.for_each_in_range(1000, 1009, [&in_range](EventView) { ++in_range; });
+    EXPECT_EQ(in_range, 10);
+
+    FilterSpec network;
+    network.with_category(Category::Network);
+    std::vector<EventId> matched;
+    EXPECT_EQ(snap.scan(network, matched), 50U);
+    int where = 0;
+    snap.for_each_where(network, [&where](EventView) { ++where; });
+    EXPECT_EQ(where, 50);
+}
+
+TEST_F(EventGraphTest, Snapshot_StableWhileWritersRun) {
+    for (int i = 0; i < 1000; ++i) {
+        graph_.push(Category::Registry, 0, Status::Success, INVALID_EVENT, 0,
+                    make_registry_payload());
+    }
+    GraphSnapshot snap(graph_);
+
+    std::atomic<bool> stop{false};
+    std::thread writer([this, &stop]() {
+        while (!stop.load(std::memory_order_relaxed) && graph_.count() < 30000) {
+            graph_.push(Category::Registry, 0, Status::Success, INVALID_EVENT, 0,
+                        make_registry_payload());
+        }
+    });
+    for (int round = 0; round < 20; ++round) {
+        std::size_t seen = 0;
+        snap.for_each_category(Category::Registry, [&seen](EventView) { ++seen; });
+        EXPECT_EQ(seen, 1000U);
+    }
+    stop.store(true);
+    writer.join();
+}
+
+TEST_F(EventGraphTest, Snapshot_RingLapped_NotIntact) {
+    Arena arena(16 * 1024 * 1024);
+    StringPool strings(arena);
+    EventGraph ring(arena, strings, EventGraph::kSegmentSize * 2, Retention::Ring);
+    EventPayload p = make_process_payload();
+    for (std::size_t i = 0; i < EventGraph::kSegmentSize * 2; ++i) {
+        ring.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+    }
+    GraphSnapshot snap(ring);
+    ASSERT_TRUE(snap.intact());
+
+    // Recycle the oldest segment of the snapshot
+    for (std::size_t i = 0; i < EventGraph::kSegmentSize; ++i) {
+        ring.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+    }
+    EXPECT_FALSE(snap.intact());
+    EXPECT_NE(snap.epoch(), ring.epoch());
+
+    std::size_t visited = 0;
+    snap.for_each([&](EventView view) {
+        EXPECT_FALSE(ring.is_evicted(view.id()));
+        EXPECT_LE(view.id(), static_cast<EventId>(EventGraph::kSegmentSize * 2));
+        ++visited;
+    });
+    EXPECT_EQ(visited, EventGraph::kSegmentSize);
+
+    std::size_t categorized = 0;
+    snap.for_each_category(Category::Process, [&categorized](EventView) { ++categorized; });
+    EXPECT_EQ(categorized, EventGraph::kSegmentSize);
+}
+
+}  // namespace exeray::event::test
@@ -0,0 +1,150 @@
+#include "event_graph_test_common.hpp"
+
+#include <cstring>
+#include <filesystem>
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// Spilled Cold Segments
+// ============================================================================
+
+class EventGraphSpillTest : public EventGraphTest {
+protected:
+    static constexpr std::size_t kSpillSize = 8 * EventGraph::kSegmentSize * sizeof(EventNode);
+
+    /// Push the same mix of process and network events into graph.
+    static void push_mixed(EventGraph& graph, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto timestamp = static_cast<Timestamp>(1000 + i * 10);
+            if (i % 4 == 0) {
+                EventPayload p = make_network_payload(i % 8 == 0 ? 443 : 80);
+                graph.push(Category::Network, 0, Status::Success, INVALID_EVENT, 0, p,
+                           timestamp);
+            } else {
+                EventPayload p = make_process_payload(static_cast<uint32_t>(4 * (i % 5) + 4));
+                graph.push(Category::Process, 1, i % 3 == 0 ? Status::Denied : Status::Success,
+                           INVALID_EVENT, static_cast<uint32_t>(i % 7), p, timestamp);
+            }
+        }
+    }
+
+    static std::vector<EventId> ids_of(const EventGraph& graph, const FilterSpec& spec) {
+        std::vector<EventId> ids;
+        graph.for_each_where(spec, [&ids](EventView view) { ids.push_back(view.id()); });
+        return ids;
+    }
+
+    /// File-backed spill arena; falls back to memory where mapping fails.
+    Arena spill_{kSpillSize,
+                 ArenaOptions{.backing_file = (std::filesystem::temp_directory_path() /
+                                               "exeray_graph_spill_test.bin")
+                                                  .string()}};
+
+    /// Reference graph without spilling, holding the same events.
+    Arena plain_arena_{kArenaSize};
+    StringPool plain_strings_{plain_arena_};
+    EventGraph plain_{plain_arena_, plain_strings_, kDefaultCapacity};
+};
+
+TEST_F(EventGraphSpillTest, Disabled_NothingSpilled) {
+    push_mixed(graph_, EventGraph::kSegmentSize * 3);
+    EXPECT_EQ(graph_.spill_segments(), 0U);
+    EXPECT_EQ(graph_.spilled_count(), 0U);
+    EXPECT_EQ(spill_.used(), 0U);
+}
+
+TEST_F(EventGraphSpillTest, RingRetentionOrCompression_Refused) {
+    EventGraph ring(arena_, strings_, kDefaultCapacity, Retention::Ring);
+    EXPECT_FALSE(ring.set_spill(&spill_));
+    EXPECT_TRUE(ring.set_spill(nullptr));
+
+    ASSERT_TRUE(graph_.set_compression({.enabled = true}));
+    EXPECT_FALSE(graph_.set_spill(&spill_));
+}
+
+TEST_F(EventGraphSpillTest, Enabled_MovesSegmentsOutsideHotWindow) {
+    ASSERT_TRUE(graph_.set_spill(&spill_, 2));
+    push_mixed(graph_, EventGraph::kSegmentSize * 6 + 10);
+    push_mixed(plain_, EventGraph::kSegmentSize * 6 + 10);
+
+    EXPECT_EQ(graph_.spilled_count(), 4U);
+    EXPECT_EQ(spill_.used(), 4 * EventGraph::kSegmentSize * sizeof(EventNode));
+    EXPECT_EQ(graph_.spill_segments(), 0U);
+
+    // Node blocks of spilled segments went to the newer ones
+    EXPECT_EQ(graph_.segment_count(), plain_.segment_count());
+    EXPECT_LT(graph_.storage_bytes() + 3 * EventGraph::kSegmentSize * sizeof(EventNode),
+              plain_.storage_bytes());
+}
+
+TEST_F(EventGraphSpillTest, Queries_MatchUnspilledGraph) {
+    graph_.set_columnar(true);
+    plain_.set_columnar(true);
+    ASSERT_TRUE(graph_.set_spill(&spill_, 1));
+    push_mixed(graph_, EventGraph::kSegmentSize * 5 + 77);
+    push_mixed(plain_, EventGraph::kSegmentSize * 5 + 77);
+    ASSERT_EQ(graph_.spilled_count(), 4U);
+
+    std::vector<EventNode> all;
+    graph_.for_each_span([&all](std::span<const EventNode> run) {
+        all.insert(all.end(), run.begin(), run.end());
+    });
+    std::vector<EventNode> expected;
+    plain_.for_each_span([&expected](std::span<const EventNode> run) {
+        expected.insert(expected.end(), run.begin(), run.end());
+    });
+    ASSERT_EQ(all.size(), expected.size());
+    EXPECT_EQ(std::memcmp(all.data(), expected.data(), all.size() * sizeof(EventNode)), 0);
+
+    FilterSpec port443;
+    port443.with_category(Category::Network).remote_port = 443;
+    EXPECT_EQ(ids_of(graph_, port443), ids_of(plain_, port443));
+
+    FilterSpec denied;
+    denied.with_status(Status::Denied).pid = 8;
+    std::vector<EventId> scanned;
+    std::vector<EventId> scanned_plain;
+    graph_.scan(denied, scanned);
+    plain_.scan(denied, scanned_plain);
+    EXPECT_EQ(scanned, scanned_plain);
+    EXPECT_FALSE(scanned.empty());
+
+    std::vector<EventId> correlated;
+    graph_.for_each_correlation(3, [&correlated](EventView view) {
+        correlated.push_back(view.id());
+    });
+    std::vector<EventId> correlated_plain;
+    plain_.for_each_correlation(3, [&correlated_plain](EventView view) {
+        correlated_plain.push_back(view.id());
+    });
+    EXPECT_EQ(correlated, correlated_plain);
+}
+
+TEST_F(EventGraphSpillTest, SetStatus_OnSpilledEvent) {
+    ASSERT_TRUE(graph_.set_spill(&spill_, 1));
+    push_mixed(graph_, EventGraph::kSegmentSize * 4);
+    ASSERT_EQ(graph_.spilled_count(), 3U);
+
+    const EventId cold = 10;
+    ASSERT_TRUE(graph_.set_status(cold, Status::Suspicious));
+    ASSERT_TRUE(graph_.set_extension(cold, 42));
+    EXPECT_EQ(graph_.get(cold).status(), Status::Suspicious);
+    EXPECT_EQ(graph_.get(cold).payload().extension, 42U);
+}
+
+TEST_F(EventGraphSpillTest, FullSpillArena_KeepsLaterSegmentsInPlace) {
+    Arena small{2 * EventGraph::kSegmentSize * sizeof(EventNode)};
+    ASSERT_TRUE(graph_.set_spill(&small, 1));
+    push_mixed(graph_, EventGraph::kSegmentSize * 6);
+    push_mixed(plain_, EventGraph::kSegmentSize * 6);
+
+    EXPECT_EQ(graph_.spilled_count(), 2U);
+    for (const EventId id : {EventId{1}, EventId{9000}, EventId{20000}}) {
+        EXPECT_EQ(graph_.get(id).timestamp(), plain_.get(id).timestamp());
+    }
+}
+
+}  // namespace exeray::event::test
@@ -0,0 +1,129 @@
+#include "event_graph_test_common.hpp"
+
+#include <string>
+
+#include "exeray/event/payload_fields.hpp"
+#include "exeray/event/string_index.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+namespace {
+
+std::vector<PayloadField> fields(std::initializer_list<std::string> names) {
+    const std::vector<std::string> list(names);
+    return find_string_fields(list);
+}
+
+EventId push_file(EventGraph& graph, StringId path) {
+    EventPayload payload{};
+    payload.category = Category::FileSystem;
+    payload.file.path = path;
+    return graph.push(Category::FileSystem, 0, Status::Success, INVALID_EVENT, 0, payload);
+}
+
+std::vector<EventId> with_string(const EventGraph& graph, StringId id) {
+    std::vector<EventId> seen;
+    graph.for_each_with_string(id, [&seen](EventView view) { seen.push_back(view.id()); });
+    return seen;
+}
+
+}  // namespace
+
+// ============================================================================
+// String index
+// ============================================================================
+
+TEST(StringIndexTest, FindStringFields_ResolvesNamesAndReportsUnknown) {
+    const std::vector<std::string> names = {"FileSystem.path", "Dns.domain", "Process.pid",
+                                            "Bogus.path", "path"};
+    std::vector<std::string> unknown;
+    const auto found = find_string_fields(names, &unknown);
+
+    ASSERT_EQ(found.size(), 2u);
+    EXPECT_EQ(found[0].category, Category::FileSystem);
+    EXPECT_EQ(found[1].category, Category::Dns);
+    EXPECT_EQ(unknown, (std::vector<std::string>{"Process.pid", "Bogus.path", "path"}));
+}
+
+TEST_F(EventGraphTest, ForEachWithString_NoIndex_VisitsNothing) {
+    const StringId path = strings_.intern("C:\\a.txt");
+    push_file(graph_, path);
+    EXPECT_EQ(graph_.string_index(), nullptr);
+    EXPECT_TRUE(with_string(graph_, path).empty());
+}
+
+TEST_F(EventGraphTest, ForEachWithString_FindsEventsOfOneString) {
+    graph_.set_string_index(fields({"FileSystem.path", "Registry.key_path"}));
+    const StringId a = strings_.intern("C:\\a.txt");
+    const StringId b = strings_.intern("C:\\b.txt");
+
+    std::vector<EventId> expected;
+    for (int i = 0; i < 500; ++i) {
+        const EventId id = push_file(graph_, i % 3 == 0 ? a : b);
+        if (i % 3 == 0) {
+            expected.push_back(id);
+        }
+    }
+    EventPayload reg = make_registry_payload();
+    reg.registry.key_path = a;  // Same string in another indexed field
+    expected.push_back(
+        graph_.push(Category::Registry, 0, Status::Success, INVALID_EVENT, 0, reg));
+    EventPayload dns{};
+    dns.category = Category::Dns;
+    dns.dns.domain = a;  // Not indexed
+    graph_.push(Category::Dns, 0, Status::Success, INVALID_EVENT, 0, dns);
+
+    EXPECT_EQ(with_string(graph_, a), expected);
+    EXPECT_EQ(with_string(graph_, b).size(), 500u - (expected.size() - 1));
+    EXPECT_TRUE(with_string(graph_, INVALID_STRING).empty());
+    EXPECT_EQ(graph_.string_index()->lists(), 2u);
+    EXPECT_LT(graph_.string_index()->bytes(), 1000u);  // Deltas fit in a byte or two
+}
+
+TEST_F(EventGraphTest, ForEachWithString_BatchAndEarlyStop) {
+    graph_.set_string_index(fields({"FileSystem.path"}));
+    const StringId path = strings_.intern("C:\\batch.txt");
+
+    std::vector<PendingEvent> events(10);
+    for (PendingEvent& event : events) {
+        event.category = Category::FileSystem;
+        event.status = Status::Success;
+        event.parent = INVALID_EVENT;
+        event.payload = make_file_payload(path);
+    }
+    std::vector<EventId> ids(events.size());
+    ASSERT_EQ(graph_.push_batch(events, ids), events.size());
+    EXPECT_EQ(with_string(graph_, path), ids);
+
+    int visited = 0;
+    graph_.for_each_with_string(path, [&visited](EventView) { return ++visited < 3; });
+    EXPECT_EQ(visited, 3);
+}
+
+TEST(StringIndexRingTest, ForEachWithString_SkipsEvictedEvents) {
+    Arena arena(32 * 1024 * 1024);
+    StringPool strings(arena);
+    EventGraph ring(arena, strings, EventGraph::kSegmentSize * 2, Retention::Ring);
+    ring.set_string_index(fields({"FileSystem.path"}));
+    const StringId path = strings.intern("C:\\ring.txt");
+
+    std::vector<EventId> all;
+    for (std::size_t i = 0; i < EventGraph::kSegmentSize * 5; ++i) {
+        all.push_back(push_file(ring, path));
+    }
+
+    const std::vector<EventId> seen = with_string(ring, path);
+    ASSERT_FALSE(seen.empty());
+    for (EventId id : seen) {
+        EXPECT_FALSE(ring.is_evicted(id));
+    }
+    EXPECT_EQ(seen.back(), all.back());
+    EXPECT_LE(seen.size(), EventGraph::kSegmentSize * 2);
+
+    // Compaction keeps the list near the live window, not the whole history
+    EXPECT_LT(ring.string_index()->bytes(), EventGraph::kSegmentSize * 5);
+}
+
+}  // namespace exeray::event::test
@@ -0,0 +1,83 @@
+#include "event_graph_test_common.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// Detection tags
+// ============================================================================
+
+TEST_F(EventGraphTest, AddTags_AccumulatesBitsBesideNode) {
+    EventPayload p = make_process_payload();
+    const EventId id = graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+
+    EXPECT_EQ(graph_.tags(id), 0U);
+    EXPECT_TRUE(graph_.add_tags(id, 0b01));
+    EXPECT_TRUE(graph_.add_tags(id, 0b10));
+    EXPECT_EQ(graph_.tags(id), 0b11U);
+    EXPECT_EQ(graph_.get(id).status(), Status::Success);  // Tags leave the node alone
+
+    EXPECT_FALSE(graph_.add_tags(id + 1, 1));  // Never pushed
+    EXPECT_EQ(graph_.tags(id + 1), 0U);
+}
+
+TEST_F(EventGraphTest, ForEachTagged_VisitsMatchingEventsOldestFirst) {
+    const std::size_t total = 3 * EventGraph::kSegmentSize;
+    std::vector<EventId> ids;
+    for (std::size_t i = 0; i < total; ++i) {
+        EventPayload p = make_process_payload(static_cast<uint32_t>(i));
+        ids.push_back(graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p));
+    }
+    // Tagged out of order, as detection workers do; the middle segment has none
+    graph_.add_tags(ids[total - 1], 0b100);
+    graph_.add_tags(ids[5], 0b001);
+    graph_.add_tags(ids[7], 0b011);
+
+    std::vector<EventId> seen;
+    graph_.for_each_tagged(0b001, [&seen](EventView view) { seen.push_back(view.id()); });
+    EXPECT_EQ(seen, (std::vector<EventId>{ids[5], ids[7]}));
+
+    seen.clear();
+    graph_.for_each_tagged(0b110, [&seen](EventView view) { seen.push_back(view.id()); });
+    EXPECT_EQ(seen, (std::vector<EventId>{ids[7], ids[total - 1]}));
+
+    int none = 0;
+    graph_.for_each_tagged(0, [&none](EventView) { ++none; });
+    EXPECT_EQ(none, 0);
+}
+
+TEST_F(EventGraphTest, PushBatch_CarriesTags) {
+    EventPayload p = make_process_payload();
+    std::vector<PendingEvent> events(4, PendingEvent{Category::Process, 0, Status::Success,
+                                                     INVALID_EVENT, 0, p, 0});
+    events[2].tags = 0b1000;
+    std::vector<EventId> ids(events.size());
+    ASSERT_EQ(graph_.push_batch(events, ids), events.size());
+
+    EXPECT_EQ(graph_.tags(ids[1]), 0U);
+    EXPECT_EQ(graph_.tags(ids[2]), 0b1000U);
+    std::vector<EventId> seen;
+    graph_.for_each_tagged(0b1000, [&seen](EventView view) { seen.push_back(view.id()); });
+    EXPECT_EQ(seen, std::vector<EventId>{ids[2]});
+}
+
+TEST_F(EventGraphTest, Ring_RecycledSegmentDropsTags) {
+    Arena arena(64 * 1024 * 1024);
+    StringPool strings(arena);
+    EventGraph ring(arena, strings, 2 * EventGraph::kSegmentSize, Retention::Ring);
+
+    EventPayload p = make_process_payload();
+    const EventId first = ring.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+    ring.add_tags(first, 1);
+    for (std::size_t i = 0; i < 2 * EventGraph::kSegmentSize; ++i) {
+        ring.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+    }
+
+    EXPECT_EQ(ring.tags(first), 0U);
+    int seen = 0;
+    ring.for_each_tagged(1, [&seen](EventView) { ++seen; });
+    EXPECT_EQ(seen, 0);
+}
+
+}  // namespace exeray::event::test
@@ -149,6 +149,14 @@ protected:
         return payload;
     }
 
+    static EventPayload make_manifest_payload() {
+        EventPayload payload{};
+        payload.category = Category::Manifest;
+        payload.manifest.text = INVALID_STRING;
+        payload.manifest.detail = INVALID_STRING;
+        return payload;
+    }
+
     EventPayload make_payload_for_category(Category cat) {
         switch (cat) {
             case Category::FileSystem: return make_file_payload();
@@ -167,6 +175,7 @@ protected:
             case Category::Service: return make_service_payload();
             case Category::Wmi: return make_wmi_payload();
             case Category::Clr: return make_clr_payload();
+            case Category::Manifest: return make_manifest_payload();
             case Category::Count: break;
         }
         return make_file_payload();  // Fallback
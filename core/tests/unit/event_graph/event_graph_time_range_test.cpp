@@ -0,0 +1,109 @@
+#include "event_graph_test_common.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// 14. Time-Range Queries
+// ============================================================================
+
+namespace {
+
+/// Reference result: IDs in [from, to] found by a full scan.
+std::vector<EventId> scan_range(const EventGraph& graph, Timestamp from, Timestamp to) {
+    std::vector<EventId> ids;
+    graph.for_each([&](EventView view) {
+        if (view.timestamp() >= from && view.timestamp() <= to) {
+            ids.push_back(view.id());
+        }
+    });
+    return ids;
+}
+
+}  // namespace
+
+TEST_F(EventGraphTest, ForEachInRange_Empty_NoCallbacks) {
+    int count = 0;
+    graph_.for_each_in_range(0, ~Timestamp{0}, [&count](EventView) { ++count; });
+    EXPECT_EQ(count, 0);
+}
+
+TEST_F(EventGraphTest, ForEachInRange_AcrossSegments_MatchesFullScan) {
+    constexpr std::size_t kEvents = EventGraph::kSegmentSize * 3 + 17;
+    std::vector<Timestamp> stamps;
+    for (std::size_t i = 0; i < kEvents; ++i) {
+        EventPayload p = make_process_payload();
+        EventId id = graph_.push(Category::Process, 0, Status::Success,
+                                 INVALID_EVENT, 0, p);
+        stamps.push_back(graph_.get(id).timestamp());
+    }
+
+    // A window starting in the second segment and ending in the fourth
+    const Timestamp from = stamps[EventGraph::kSegmentSize + 100];
+    const Timestamp to = stamps[EventGraph::kSegmentSize * 3 + 5];
+
+    std::vector<EventId> ids;
+    graph_.for_each_in_range(from, to, [&ids](EventView view) {
+        ids.push_back(view.id());
+    });
+
+    EXPECT_EQ(ids, scan_range(graph_, from, to));
+    EXPECT_FALSE(ids.empty());
+}
+
+TEST_F(EventGraphTest, ForEachInRange_OutsideBounds_NoCallbacks) {
+    EventPayload p = make_process_payload();
+    EventId id = graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+    const Timestamp ts = graph_.get(id).timestamp();
+
+    int count = 0;
+    graph_.for_each_in_range(ts + 1, ts + 1000, [&count](EventView) { ++count; });
+    graph_.for_each_in_range(0, ts - 1, [&count](EventView) { ++count; });
+    graph_.for_each_in_range(ts, ts - 1, [&count](EventView) { ++count; });
+    EXPECT_EQ(count, 0);
+
+    graph_.for_each_in_range(ts, ts, [&count](EventView) { ++count; });
+    EXPECT_EQ(count, 1);
+}
+
+TEST_F(EventGraphTest, Push_ExplicitTimestamp_StoredVerbatim) {
+    EventPayload p = make_process_payload();
+    EventId late = graph_.push(Category::Process, 0, Status::Success,
+                               INVALID_EVENT, 0, p, 2000);
+    EventId early = graph_.push(Category::Process, 0, Status::Success,
+                                INVALID_EVENT, 0, p, 1000);
+
+    EXPECT_EQ(graph_.get(late).timestamp(), 2000U);
+    EXPECT_EQ(graph_.get(early).timestamp(), 1000U);
+
+    // Out-of-order stamps within a segment are still found by range queries
+    std::vector<EventId> ids;
+    graph_.for_each_in_range(500, 1500, [&ids](EventView view) {
+        ids.push_back(view.id());
+    });
+    EXPECT_EQ(ids, (std::vector<EventId>{early}));
+}
+
+TEST_F(EventGraphTest, ForEachInRange_RingMode_SkipsEvictedSegments) {
+    Arena arena(16 * 1024 * 1024);
+    StringPool strings(arena);
+    EventGraph ring(arena, strings, EventGraph::kSegmentSize * 2, Retention::Ring);
+
+    EventPayload p = make_process_payload();
+    for (std::size_t i = 0; i < EventGraph::kSegmentSize * 5; ++i) {
+        ring.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, p);
+    }
+
+    std::size_t visited = 0;
+    EventId previous = INVALID_EVENT;
+    ring.for_each_in_range(0, ~Timestamp{0}, [&](EventView view) {
+        EXPECT_FALSE(ring.is_evicted(view.id()));
+        EXPECT_GT(view.id(), previous);
+        previous = view.id();
+        ++visited;
+    });
+    EXPECT_EQ(visited, ring.count());
+}
+
+}  // namespace exeray::event::test
@@ -0,0 +1,131 @@
+#include "event_graph_test_common.hpp"
+
+#include <thread>
+
+#include "exeray/event/timeline.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+namespace {
+
+constexpr Timestamp kSecond = EventTimeline::kBucketNs;
+
+std::size_t cat(Category c) { return static_cast<std::size_t>(c); }
+
+}  // namespace
+
+// ============================================================================
+// Per-second timeline
+// ============================================================================
+
+TEST(EventTimelineTest, Read_EmptyBeforeFirstEvent) {
+    const EventTimeline timeline(60);
+    std::vector<TimelineBucket> out(60);
+    EXPECT_EQ(timeline.read(out), 0u);
+}
+
+TEST(EventTimelineTest, Read_OldestFirstWithEmptySecondsZeroed) {
+    EventTimeline timeline(60);
+    timeline.add(100 * kSecond, Category::Process, false);
+    timeline.add(100 * kSecond + 5, Category::Process, true);
+    timeline.add(102 * kSecond + kSecond - 1, Category::Network, false);
+
+    std::vector<TimelineBucket> out(3);
+    ASSERT_EQ(timeline.read(out), 3u);
+    EXPECT_EQ(out[0].start, 100 * kSecond);
+    EXPECT_EQ(out[0].counts[cat(Category::Process)], 2u);
+    EXPECT_EQ(out[0].suspicious, 1u);
+    EXPECT_EQ(out[1].start, 101 * kSecond);
+    EXPECT_EQ(out[1].total(), 0u);
+    EXPECT_EQ(out[2].counts[cat(Category::Network)], 1u);
+    EXPECT_EQ(out[2].total(), 1u);
+}
+
+TEST(EventTimelineTest, Add_RecyclesBucketsAndDropsEventsOlderThanWindow) {
+    EventTimeline timeline(4);
+    timeline.add(10 * kSecond, Category::Dns, false);
+    timeline.add(14 * kSecond, Category::Dns, false);  // Same slot as second 10
+    timeline.add(10 * kSecond, Category::Dns, false);  // Now outside the window
+
+    std::vector<TimelineBucket> out(16);
+    ASSERT_EQ(timeline.read(out), 4u);
+    EXPECT_EQ(out[0].start, 11 * kSecond);
+    EXPECT_EQ(out[3].start, 14 * kSecond);
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+        total += out[i].total();
+    }
+    EXPECT_EQ(total, 1u);
+}
+
+TEST(EventTimelineTest, Add_ConcurrentWritersLoseNoCounts) {
+    EventTimeline timeline(8);
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 20000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&timeline] {
+            for (int i = 0; i < kPerThread; ++i) {
+                timeline.add(static_cast<Timestamp>(i % 4) * kSecond, Category::FileSystem,
+                             i % 10 == 0);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<TimelineBucket> out(4);
+    ASSERT_EQ(timeline.read(out), 4u);
+    std::uint64_t total = 0;
+    std::uint64_t suspicious = 0;
+    for (const auto& bucket : out) {
+        total += bucket.total();
+        suspicious += bucket.suspicious;
+    }
+    EXPECT_EQ(total, static_cast<std::uint64_t>(kThreads) * kPerThread);
+    EXPECT_EQ(suspicious, static_cast<std::uint64_t>(kThreads) * kPerThread / 10);
+}
+
+TEST_F(EventGraphTest, Timeline_NoneByDefault) {
+    EXPECT_EQ(graph_.timeline(), nullptr);
+    graph_.set_timeline(30);
+    ASSERT_NE(graph_.timeline(), nullptr);
+    EXPECT_EQ(graph_.timeline()->seconds(), 30u);
+    graph_.set_timeline(0);
+    EXPECT_EQ(graph_.timeline(), nullptr);
+}
+
+TEST_F(EventGraphTest, Timeline_CountsPushesBatchesAndStatusChanges) {
+    graph_.set_timeline(10);
+    const EventPayload process = make_process_payload();
+    graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0, process, 5 * kSecond);
+    const EventId later = graph_.push(Category::Process, 0, Status::Success, INVALID_EVENT, 0,
+                                      process, 6 * kSecond);
+
+    std::vector<PendingEvent> batch(3);
+    for (auto& event : batch) {
+        event.category = Category::Network;
+        event.operation = 0;
+        event.status = Status::Suspicious;
+        event.parent = INVALID_EVENT;
+        event.correlation_id = 0;
+        event.payload = make_network_payload();
+        event.timestamp = 6 * kSecond + 1;
+    }
+    EXPECT_EQ(graph_.push_batch(batch), 3u);
+    EXPECT_TRUE(graph_.set_status(later, Status::Suspicious));
+
+    std::vector<TimelineBucket> out(2);
+    ASSERT_EQ(graph_.timeline()->read(out), 2u);
+    EXPECT_EQ(out[0].start, 5 * kSecond);
+    EXPECT_EQ(out[0].counts[cat(Category::Process)], 1u);
+    EXPECT_EQ(out[0].suspicious, 0u);
+    EXPECT_EQ(out[1].counts[cat(Category::Process)], 1u);
+    EXPECT_EQ(out[1].counts[cat(Category::Network)], 3u);
+    EXPECT_EQ(out[1].suspicious, 4u);
+}
+
+}  // namespace exeray::event::test
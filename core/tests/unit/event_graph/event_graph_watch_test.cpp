@@ -0,0 +1,85 @@
+#include "event_graph_test_common.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// 21. Publication Watchers
+// ============================================================================
+
+TEST_F(EventGraphTest, NewestId_TracksPushesAcrossEviction) {
+    EXPECT_EQ(graph_.newest_id(), INVALID_EVENT);
+    const EventId first = graph_.push(Category::Process, 1, Status::Success, INVALID_EVENT, 0,
+                                      make_process_payload());
+    EXPECT_EQ(graph_.newest_id(), first);
+
+    Arena arena(16 * 1024 * 1024);
+    StringPool strings(arena);
+    EventGraph ring(arena, strings, EventGraph::kSegmentSize * 2, Retention::Ring);
+    EventId last = INVALID_EVENT;
+    for (std::size_t i = 0; i < EventGraph::kSegmentSize * 3 + 5; ++i) {
+        last = ring.push(Category::Process, 1, Status::Success, INVALID_EVENT, 0,
+                         make_process_payload());
+    }
+    EXPECT_EQ(ring.newest_id(), last);
+    EXPECT_GT(ring.oldest_id(), 1u);
+}
+
+TEST_F(EventGraphTest, WhenPublished_FiresOnNewerEvent) {
+    int fired = 0;
+    graph_.when_published(INVALID_EVENT, [&fired] { ++fired; });
+    EXPECT_EQ(fired, 0);
+
+    const EventId id = graph_.push(Category::Process, 1, Status::Success, INVALID_EVENT, 0,
+                                   make_process_payload());
+    EXPECT_EQ(fired, 1);
+
+    graph_.when_published(INVALID_EVENT, [&fired] { ++fired; });  // Already there
+    EXPECT_EQ(fired, 2);
+
+    graph_.when_published(id + 1, [&fired] { fired += 10; });  // Needs two more
+    graph_.push(Category::Process, 1, Status::Success, INVALID_EVENT, 0, make_process_payload());
+    EXPECT_EQ(fired, 2);
+    graph_.push(Category::Process, 1, Status::Success, INVALID_EVENT, 0, make_process_payload());
+    EXPECT_EQ(fired, 12);
+}
+
+TEST_F(EventGraphTest, ReleaseWatchers_FiresWaitingCallbacksOnce) {
+    int fired = 0;
+    graph_.when_published(100, [&fired] { ++fired; });
+    graph_.when_published(200, [&fired] { ++fired; });
+    graph_.release_watchers();
+    EXPECT_EQ(fired, 2);
+    graph_.release_watchers();
+    graph_.push(Category::Process, 1, Status::Success, INVALID_EVENT, 0, make_process_payload());
+    EXPECT_EQ(fired, 2);
+}
+
+TEST_F(EventGraphTest, WhenPublished_ConcurrentPushersNeverMissWatcher) {
+    std::atomic<int> fired{0};
+    std::atomic<bool> done{false};
+    std::thread pusher([&] {
+        for (int i = 0; i < 20000; ++i) {
+            graph_.push(Category::Process, 1, Status::Success, INVALID_EVENT, 0,
+                        make_process_payload());
+        }
+        done.store(true);
+    });
+    std::vector<EventId> afters;
+    while (!done.load()) {
+        afters.push_back(graph_.newest_id());
+        graph_.when_published(afters.back(), [&fired] { fired.fetch_add(1); });
+    }
+    pusher.join();
+
+    // Every watcher that an event was published after has fired
+    const EventId newest = graph_.newest_id();
+    const auto expected = std::count_if(afters.begin(), afters.end(),
+                                        [newest](EventId after) { return after < newest; });
+    EXPECT_EQ(fired.load(), expected);
+    graph_.release_watchers();
+    EXPECT_EQ(fired.load(), static_cast<int>(afters.size()));
+}
+
+}  // namespace exeray::event::test
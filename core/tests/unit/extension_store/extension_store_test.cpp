@@ -0,0 +1,141 @@
+/// @file extension_store_test.cpp
+/// @brief Tests for arena-backed event extension records.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/consumer.hpp"
+#include "exeray/etw/parser.hpp"
+#include "exeray/event/extensions.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/string_pool.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace exeray::event {
+namespace {
+
+constexpr std::size_t kArenaSize = 4 * 1024 * 1024;
+
+Ipv6TupleExtension make_tuple(std::uint8_t seed) {
+    Ipv6TupleExtension tuple{};
+    for (std::uint8_t i = 0; i < 16; ++i) {
+        tuple.local_addr[i] = static_cast<std::uint8_t>(seed + i);
+        tuple.remote_addr[i] = static_cast<std::uint8_t>(seed * 2 + i);
+    }
+    return tuple;
+}
+
+TEST(ExtensionStoreTest, Append_ReadsBack) {
+    Arena arena{kArenaSize};
+    ExtensionStore store{arena};
+    const auto tuple = make_tuple(1);
+
+    const ExtensionId id = store.append(ExtensionKind::Ipv6Tuple, tuple);
+    ASSERT_NE(id, NO_EXTENSION);
+    EXPECT_EQ(store.count(), 1U);
+
+    const Extension record = store.get(id);
+    EXPECT_EQ(record.kind, ExtensionKind::Ipv6Tuple);
+    Ipv6TupleExtension out{};
+    ASSERT_TRUE(record.read(out));
+    EXPECT_EQ(std::memcmp(&out, &tuple, sizeof(tuple)), 0);
+}
+
+TEST(ExtensionStoreTest, OddSizes_StayAligned) {
+    Arena arena{kArenaSize};
+    ExtensionStore store{arena};
+    const std::uint8_t bytes[7] = {1, 2, 3, 4, 5, 6, 7};
+
+    const ExtensionId first = store.append(ExtensionKind::Ipv6Tuple, std::span(bytes, 3));
+    const ExtensionId second = store.append(ExtensionKind::Ipv6Tuple, std::span(bytes, 7));
+    ASSERT_NE(first, NO_EXTENSION);
+    ASSERT_NE(second, NO_EXTENSION);
+    EXPECT_EQ((second - 1) % 4, 0U);
+    EXPECT_EQ(store.get(first).bytes.size(), 3U);
+    EXPECT_EQ(store.get(second).bytes[6], 7);
+}
+
+TEST(ExtensionStoreTest, Rejected_ReturnsNoExtension) {
+    Arena arena{kArenaSize};
+    ExtensionStore store{arena};
+    std::vector<std::uint8_t> large(ExtensionStore::kMaxBytes + 1);
+
+    EXPECT_EQ(store.append(ExtensionKind::None, std::span(large.data(), 4)), NO_EXTENSION);
+    EXPECT_EQ(store.append(ExtensionKind::Ipv6Tuple, std::span<const std::uint8_t>{}),
+              NO_EXTENSION);
+    EXPECT_EQ(store.append(ExtensionKind::Ipv6Tuple, std::span<const std::uint8_t>(large)),
+              NO_EXTENSION);
+    EXPECT_EQ(store.get(NO_EXTENSION).kind, ExtensionKind::None);
+    EXPECT_EQ(store.count(), 0U);
+}
+
+TEST(ExtensionStoreTest, WrongSize_ReadFails) {
+    Arena arena{kArenaSize};
+    ExtensionStore store{arena};
+    const std::uint32_t small = 5;
+    Ipv6TupleExtension out{};
+
+    EXPECT_FALSE(store.get(store.append(ExtensionKind::Ipv6Tuple, small)).read(out));
+}
+
+TEST(ExtensionStoreTest, ConcurrentAppends_AllReadBack) {
+    Arena arena{kArenaSize};
+    ExtensionStore store{arena};
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 500;
+    std::vector<std::vector<ExtensionId>> ids(kThreads);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < kPerThread; ++i) {
+                ids[t].push_back(store.append(ExtensionKind::Ipv6Tuple,
+                                              make_tuple(static_cast<std::uint8_t>(t))));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(store.count(), static_cast<std::size_t>(kThreads * kPerThread));
+    for (int t = 0; t < kThreads; ++t) {
+        for (const ExtensionId id : ids[t]) {
+            Ipv6TupleExtension out{};
+            ASSERT_TRUE(store.get(id).read(out));
+            EXPECT_EQ(out.local_addr[0], t);
+        }
+    }
+}
+
+TEST(ExtensionStoreTest, ConsumeParsed_StoresExtensionOfKeptEvent) {
+    Arena arena{kArenaSize};
+    StringPool strings{arena};
+    ExtensionStore store{arena};
+    EventGraph graph{arena, strings, 1024};
+    etw::ConsumerContext ctx;
+    ctx.graph = &graph;
+    ctx.strings = &strings;
+    ctx.extensions = &store;
+
+    etw::ParsedEvent parsed{};
+    parsed.valid = true;
+    parsed.category = Category::Network;
+    parsed.operation = static_cast<std::uint8_t>(NetworkOp::Connect);
+    parsed.payload.category = Category::Network;
+    parsed.extension.set(ExtensionKind::Ipv6Tuple, make_tuple(9));
+    etw::consume_parsed(ctx, parsed, 0, 0, 0);
+    etw::flush_pending(ctx);
+
+    ASSERT_EQ(graph.count(), 1U);
+    Ipv6TupleExtension out{};
+    ASSERT_TRUE(store.get(graph.get(1).payload().extension).read(out));
+    EXPECT_EQ(out.remote_addr[0], 18);
+}
+
+}  // namespace
+}  // namespace exeray::event
@@ -0,0 +1,196 @@
+/// @file logging_test.cpp
+/// @brief Tests for compile-time level filtering and per call site rate limits.
+
+#include <gtest/gtest.h>
+
+#include "exeray/logging.hpp"
+
+#include <spdlog/sinks/ostream_sink.h>
+
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace exeray {
+namespace {
+
+/// Sends the logger to a stream for the duration of a test.
+class LoggingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto& logger = log::get();
+        // Repeats held back by earlier tests would be flushed into out_
+        logger.flush();
+        log::reset_flood_filter();
+        saved_sinks_ = logger.sinks();
+        saved_level_ = logger.level();
+        logger.sinks() = {std::make_shared<spdlog::sinks::ostream_sink_st>(out_)};
+        logger.set_level(spdlog::level::trace);
+    }
+
+    void TearDown() override {
+        auto& logger = log::get();
+        logger.flush();
+        logger.sinks() = saved_sinks_;
+        logger.set_level(saved_level_);
+    }
+
+    std::size_t lines() {
+        log::get().flush();
+        const std::string text = out_.str();
+        std::size_t count = 0;
+        for (const char c : text) {
+            count += c == '\n' ? 1 : 0;
+        }
+        return count;
+    }
+
+    std::ostringstream out_;
+    std::vector<spdlog::sink_ptr> saved_sinks_;
+    spdlog::level::level_enum saved_level_ = spdlog::level::info;
+};
+
+int count_call(int& calls) {
+    return ++calls;
+}
+
+TEST_F(LoggingTest, BelowActiveLevel_ArgumentsNotEvaluated) {
+    int calls = 0;
+    EXERAY_TRACE("value={}", count_call(calls));
+    EXPECT_EQ(calls, EXERAY_ACTIVE_LEVEL <= EXERAY_LEVEL_TRACE ? 1 : 0);
+    EXPECT_EQ(lines(), EXERAY_ACTIVE_LEVEL <= EXERAY_LEVEL_TRACE ? 1U : 0U);
+}
+
+TEST_F(LoggingTest, BelowRuntimeLevel_ArgumentsNotEvaluated) {
+    log::get().set_level(spdlog::level::err);
+    int calls = 0;
+    EXERAY_WARN("value={}", count_call(calls));
+    EXPECT_EQ(calls, 0);
+    EXPECT_EQ(lines(), 0U);
+}
+
+TEST_F(LoggingTest, Enabled_Logs) {
+    EXERAY_ERROR("error {}", 1);
+    EXPECT_EQ(lines(), EXERAY_ACTIVE_LEVEL <= EXERAY_LEVEL_ERROR ? 1U : 0U);
+}
+
+TEST_F(LoggingTest, WarnLimited_DropsBeyondRate) {
+    int calls = 0;
+    for (int i = 0; i < 100; ++i) {
+        EXERAY_WARN_LIMITED(5, "value={}", count_call(calls));
+    }
+    // One window may end during the loop
+    EXPECT_GE(calls, 5);
+    EXPECT_LE(calls, 10);
+}
+
+TEST(RateLimitTest, Acquire_ReportsDropped) {
+    log::RateLimit limit{2};
+    std::uint64_t allowed = 0;
+    std::uint64_t reported = 0;
+    for (int i = 0; i < 10; ++i) {
+        if (const std::uint64_t n = limit.acquire(); n != 0) {
+            ++allowed;
+            reported += n - 1;
+        }
+    }
+    EXPECT_GE(allowed, 2U);
+    EXPECT_LE(allowed, 4U);  // At most one window boundary
+    EXPECT_LE(reported, 10U - allowed);
+}
+
+TEST(RateLimitTest, Zero_DropsEverything) {
+    log::RateLimit limit{0};
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(limit.acquire(), 0U);
+    }
+}
+
+using namespace std::chrono_literals;
+
+TEST(FloodFilterTest, Repeats_CountedAndSummarizedAfterWindow) {
+    log::FloodFilter filter;
+    const auto t0 = log::FloodFilter::Clock::now();
+    EXPECT_TRUE(filter.check(spdlog::level::warn, "schema missing", t0).emit);
+    for (int i = 0; i < 1000; ++i) {
+        const auto verdict = filter.check(spdlog::level::warn, "schema missing", t0 + 1ms);
+        EXPECT_FALSE(verdict.emit);
+        EXPECT_FALSE(verdict.repeat.has_value());
+    }
+    EXPECT_EQ(filter.stats().repeated, 1000U);
+
+    const auto verdict = filter.check(spdlog::level::warn, "schema missing", t0 + 2s);
+    EXPECT_TRUE(verdict.emit);
+    ASSERT_TRUE(verdict.repeat.has_value());
+    EXPECT_EQ(verdict.repeat->count, 1000U);
+    EXPECT_EQ(verdict.repeat->message, "schema missing");
+    EXPECT_EQ(verdict.repeat->level, spdlog::level::warn);
+}
+
+TEST(FloodFilterTest, DifferentLevelOrText_NotDeduplicated) {
+    log::FloodFilter filter;
+    const auto t0 = log::FloodFilter::Clock::now();
+    EXPECT_TRUE(filter.check(spdlog::level::warn, "a", t0).emit);
+    EXPECT_TRUE(filter.check(spdlog::level::err, "a", t0).emit);
+    EXPECT_TRUE(filter.check(spdlog::level::warn, "b", t0).emit);
+    EXPECT_EQ(filter.stats().repeated, 0U);
+}
+
+TEST(FloodFilterTest, FlushRepeats_ReportsPendingOnce) {
+    log::FloodFilter filter;
+    const auto t0 = log::FloodFilter::Clock::now();
+    (void)filter.check(spdlog::level::info, "x", t0);
+    (void)filter.check(spdlog::level::info, "x", t0);
+    (void)filter.check(spdlog::level::info, "x", t0);
+
+    const auto repeats = filter.flush_repeats();
+    ASSERT_EQ(repeats.size(), 1U);
+    EXPECT_EQ(repeats[0].count, 2U);
+    EXPECT_TRUE(filter.flush_repeats().empty());
+}
+
+TEST(FloodFilterTest, TokenBucket_DropsAndReportsCount) {
+    log::FloodFilter::Limits limits;
+    limits.per_second = 10.0;
+    limits.burst = 5.0;
+    log::FloodFilter filter(limits);
+    const auto t0 = log::FloodFilter::Clock::now();
+
+    int emitted = 0;
+    for (int i = 0; i < 20; ++i) {
+        emitted += filter.check(spdlog::level::warn, "m" + std::to_string(i), t0).emit ? 1 : 0;
+    }
+    EXPECT_EQ(emitted, 5);
+    EXPECT_EQ(filter.stats().dropped, 15U);
+
+    // 100 ms refill one token; the next message reports the drops
+    const auto verdict = filter.check(spdlog::level::warn, "late", t0 + 100ms);
+    EXPECT_TRUE(verdict.emit);
+    EXPECT_EQ(verdict.dropped, 15U);
+}
+
+TEST(FloodFilterTest, Critical_AlwaysPasses) {
+    log::FloodFilter::Limits limits;
+    limits.burst = 0.0;
+    log::FloodFilter filter(limits);
+    const auto t0 = log::FloodFilter::Clock::now();
+    EXPECT_FALSE(filter.check(spdlog::level::err, "e", t0).emit);
+    EXPECT_TRUE(filter.check(spdlog::level::critical, "c", t0).emit);
+    EXPECT_TRUE(filter.check(spdlog::level::critical, "c", t0).emit);
+}
+
+TEST_F(LoggingTest, Logger_CollapsesStorm) {
+    const auto before = log::flood_stats();
+    for (int i = 0; i < 500; ++i) {
+        EXERAY_ERROR("storm message");
+    }
+    if constexpr (EXERAY_ACTIVE_LEVEL <= EXERAY_LEVEL_ERROR) {
+        EXPECT_EQ(lines(), 2U);  // Once, then "(repeated 499 times)" at flush
+        EXPECT_NE(out_.str().find("storm message (repeated 499 times)"), std::string::npos);
+        EXPECT_EQ(log::flood_stats().repeated - before.repeated, 499U);
+    }
+}
+
+}  // namespace
+}  // namespace exeray
@@ -0,0 +1,170 @@
+/// @file metrics_test.cpp
+/// @brief Tests for the metrics registry and its text exposition.
+
+#include <gtest/gtest.h>
+
+#include "exeray/metrics.hpp"
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace exeray {
+namespace {
+
+const MetricSample* find(const std::vector<MetricSample>& samples, const std::string& name,
+                         const std::string& labels = {}) {
+    for (const MetricSample& sample : samples) {
+        if (sample.name == name && sample.labels == labels) {
+            return &sample;
+        }
+    }
+    return nullptr;
+}
+
+TEST(MetricsRegistryTest, Counter_SummedAcrossThreads) {
+    MetricsRegistry registry;
+    const auto id = registry.counter("test_total", "Test counter");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 1000; ++i) {
+                registry.add(id);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    registry.add(id, 5);
+
+    const auto samples = registry.snapshot();
+    const MetricSample* sample = find(samples, "test_total");
+    ASSERT_NE(sample, nullptr);
+    EXPECT_EQ(sample->type, MetricType::Counter);
+    EXPECT_EQ(sample->value, 4005.0);
+}
+
+TEST(MetricsRegistryTest, Register_SameNameAndLabels_SameId) {
+    MetricsRegistry registry;
+    const auto a = registry.counter("x_total", "X", "k=\"a\"");
+    const auto b = registry.counter("x_total", "X", "k=\"b\"");
+    EXPECT_NE(a, b);
+    EXPECT_EQ(registry.counter("x_total", "X", "k=\"a\""), a);
+}
+
+TEST(MetricsRegistryTest, FullTable_InvalidIdIgnored) {
+    MetricsRegistry registry;
+    for (std::size_t i = 0; i < MetricsRegistry::kMaxHistograms; ++i) {
+        ASSERT_NE(registry.histogram("h" + std::to_string(i), "H"), MetricsRegistry::kInvalid);
+    }
+    const auto id = registry.histogram("overflow", "H");
+    EXPECT_EQ(id, MetricsRegistry::kInvalid);
+    registry.observe(id, 1);
+    registry.add(id);
+    registry.set(id, 1);
+    EXPECT_EQ(find(registry.snapshot(), "overflow"), nullptr);
+}
+
+TEST(MetricsRegistryTest, Gauge_SetAndAdjust) {
+    MetricsRegistry registry;
+    const auto id = registry.gauge("depth", "Depth");
+    registry.set(id, 10);
+    registry.adjust(id, -3);
+    const auto samples = registry.snapshot();
+    ASSERT_NE(find(samples, "depth"), nullptr);
+    EXPECT_EQ(find(samples, "depth")->value, 7.0);
+    EXPECT_EQ(find(samples, "depth")->type, MetricType::Gauge);
+}
+
+TEST(MetricsRegistryTest, Histogram_PowerOfTwoBuckets) {
+    EXPECT_EQ(MetricsRegistry::bucket_of(0), 0U);
+    EXPECT_EQ(MetricsRegistry::bucket_of(1), 1U);
+    EXPECT_EQ(MetricsRegistry::bucket_of(3), 2U);
+    EXPECT_EQ(MetricsRegistry::bucket_of(4), 3U);
+    EXPECT_EQ(MetricsRegistry::bucket_of(~std::uint64_t{0}),
+              MetricsRegistry::kHistogramBuckets - 1);
+
+    MetricsRegistry registry;
+    const auto id = registry.histogram("size", "Size");
+    registry.observe(id, 0);
+    registry.observe(id, 3);
+    registry.observe(id, 3);
+    registry.observe(id, 100);
+
+    const auto samples = registry.snapshot();
+    const MetricSample* sample = find(samples, "size");
+    ASSERT_NE(sample, nullptr);
+    EXPECT_EQ(sample->count, 4U);
+    EXPECT_EQ(sample->value, 106.0);
+    ASSERT_EQ(sample->buckets.size(), MetricsRegistry::kHistogramBuckets);
+    EXPECT_EQ(sample->buckets[0], 1U);
+    EXPECT_EQ(sample->buckets[2], 2U);
+    EXPECT_EQ(sample->buckets[7], 1U);
+}
+
+TEST(MetricsRegistryTest, Collector_AddsSamplesSortedByName) {
+    MetricsRegistry registry;
+    registry.counter("b_total", "B");
+    registry.add_collector([](std::vector<MetricSample>& out) {
+        MetricSample& sample = out.emplace_back();
+        sample.name = "a";
+        sample.help = "A";
+        sample.value = 2.5;
+    });
+    const auto samples = registry.snapshot();
+    ASSERT_EQ(samples.size(), 2U);
+    EXPECT_EQ(samples[0].name, "a");
+    EXPECT_EQ(samples[0].value, 2.5);
+    EXPECT_EQ(samples[1].name, "b_total");
+}
+
+TEST(MetricsRegistryTest, Registry_Destroyed_ThreadShardDropped) {
+    auto first = std::make_unique<MetricsRegistry>();
+    first->add(first->counter("a_total", "A"), 3);
+    first.reset();
+
+    MetricsRegistry second;
+    const auto id = second.counter("a_total", "A");
+    second.add(id);
+    EXPECT_EQ(find(second.snapshot(), "a_total")->value, 1.0);
+}
+
+TEST(MetricLabelTest, EscapesValue) {
+    EXPECT_EQ(metric_label("rule", "a\"b\\c\nd"), "rule=\"a\\\"b\\\\c\\nd\"");
+}
+
+TEST(MetricsTextTest, Prometheus_CounterGaugeHistogram) {
+    MetricsRegistry registry;
+    registry.add(registry.counter("req_total", "Requests", metric_label("kind", "x")), 2);
+    registry.set(registry.gauge("temp", "Temperature\nnow"), -4);
+    registry.observe(registry.histogram("lat", "Latency"), 2);
+
+    std::ostringstream out;
+    ASSERT_TRUE(registry.write(out));
+    const std::string text = out.str();
+    EXPECT_NE(text.find("# HELP req_total Requests\n# TYPE req_total counter\n"
+                        "req_total{kind=\"x\"} 2\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("# HELP temp Temperature\\nnow\n# TYPE temp gauge\ntemp -4\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("# TYPE lat histogram\nlat_bucket{le=\"0\"} 0\nlat_bucket{le=\"1\"} 0\n"
+                        "lat_bucket{le=\"3\"} 1\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("lat_bucket{le=\"+Inf\"} 1\nlat_sum 2\nlat_count 1\n"),
+              std::string::npos);
+    EXPECT_EQ(text.find("# EOF"), std::string::npos);
+}
+
+TEST(MetricsTextTest, OpenMetrics_CounterFamilyAndEof) {
+    MetricsRegistry registry;
+    registry.add(registry.counter("req_total", "Requests"));
+
+    std::ostringstream out;
+    ASSERT_TRUE(registry.write(out, MetricsFormat::OpenMetrics));
+    EXPECT_EQ(out.str(), "# HELP req Requests\n# TYPE req counter\nreq_total 1\n# EOF\n");
+}
+
+}  // namespace
+}  // namespace exeray
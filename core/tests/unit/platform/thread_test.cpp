@@ -0,0 +1,138 @@
+/// @file thread_test.cpp
+/// @brief Tests for thread placement and CPU topology helpers.
+
+#include <gtest/gtest.h>
+
+#include "exeray/platform/thread.hpp"
+
+#include <algorithm>
+#include <thread>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace exeray::platform {
+namespace {
+
+TEST(ParseCpuListTest, RangesAndSingles) {
+    EXPECT_EQ(parse_cpu_list("0-3,8,10-11\n"),
+              (std::vector<unsigned>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(parse_cpu_list("5"), (std::vector<unsigned>{5}));
+}
+
+TEST(ParseCpuListTest, Malformed_Empty) {
+    EXPECT_TRUE(parse_cpu_list("").empty());
+    EXPECT_TRUE(parse_cpu_list("3-1").empty());
+    EXPECT_TRUE(parse_cpu_list("a,b").empty());
+    EXPECT_TRUE(parse_cpu_list("1,,2").empty());
+}
+
+TEST(L2SiblingsTest, ContainsCore) {
+    const auto siblings = l2_siblings(0);
+    ASSERT_FALSE(siblings.empty());
+    EXPECT_NE(std::find(siblings.begin(), siblings.end(), 0U), siblings.end());
+}
+
+TEST(ScopedPlacementTest, Empty_ChangesNothing) {
+    const ThreadPlacement placement;
+    EXPECT_TRUE(placement.empty());
+
+    const ScopedPlacement scoped(placement);
+    EXPECT_FALSE(scoped.pinned());
+    EXPECT_FALSE(scoped.raised());
+}
+
+#if defined(__linux__)
+TEST(ScopedPlacementTest, Pin_RunsOnCoreThenRestores) {
+    cpu_set_t before;
+    CPU_ZERO(&before);
+    ASSERT_EQ(sched_getaffinity(0, sizeof(before), &before), 0);
+    unsigned core = 0;
+    while (!CPU_ISSET(core, &before)) {
+        ++core;
+    }
+
+    std::thread worker([core, &before] {
+        {
+            const ScopedPlacement scoped(ThreadPlacement{{core}, ThreadPriority::Normal});
+            ASSERT_TRUE(scoped.pinned());
+            EXPECT_EQ(static_cast<unsigned>(sched_getcpu()), core);
+        }
+        cpu_set_t after;
+        CPU_ZERO(&after);
+        ASSERT_EQ(sched_getaffinity(0, sizeof(after), &after), 0);
+        EXPECT_TRUE(CPU_EQUAL(&before, &after));
+    });
+    worker.join();
+}
+#endif
+
+/// Two sockets of two cores with two SMT threads, numbered as Linux does
+/// (siblings N apart); each socket in its own processor group.
+CpuTopology two_sockets() {
+    CpuTopology topology;
+    for (unsigned id = 0; id < 8; ++id) {
+        const unsigned core = id % 4;
+        const unsigned package = core / 2;
+        topology.cpus.push_back(LogicalCpu{id, core, package, package, package});
+    }
+    return topology;
+}
+
+using Slots = std::vector<std::vector<unsigned>>;
+
+TEST(PlaceWorkersTest, Compact_FillsCoresAndSocketsInTurn) {
+    EXPECT_EQ(place_workers(two_sockets(), PoolPlacement::Compact, 0),
+              (Slots{{0}, {4}, {1}, {5}, {2}, {6}, {3}, {7}}));
+    EXPECT_EQ(place_workers(two_sockets(), PoolPlacement::Compact, 3), (Slots{{0}, {4}, {1}}));
+}
+
+TEST(PlaceWorkersTest, Scatter_AlternatesSocketsPhysicalCoresFirst) {
+    EXPECT_EQ(place_workers(two_sockets(), PoolPlacement::Scatter, 0),
+              (Slots{{0}, {2}, {1}, {3}, {4}, {6}, {5}, {7}}));
+    EXPECT_EQ(place_workers(two_sockets(), PoolPlacement::Scatter, 2), (Slots{{0}, {2}}));
+}
+
+TEST(PlaceWorkersTest, OnePerCore_PinsSiblingSets) {
+    EXPECT_EQ(place_workers(two_sockets(), PoolPlacement::OnePerCore, 0),
+              (Slots{{0, 4}, {1, 5}, {2, 6}, {3, 7}}));
+    // More workers than cores wrap around
+    EXPECT_EQ(place_workers(two_sockets(), PoolPlacement::OnePerCore, 5),
+              (Slots{{0, 4}, {1, 5}, {2, 6}, {3, 7}, {0, 4}}));
+}
+
+TEST(PlaceWorkersTest, Group_StaysInFirstGroup) {
+    EXPECT_EQ(place_workers(two_sockets(), PoolPlacement::Group, 0),
+              (Slots{{0, 1, 4, 5}, {0, 1, 4, 5}, {0, 1, 4, 5}, {0, 1, 4, 5}}));
+    EXPECT_EQ(place_workers(two_sockets(), PoolPlacement::Group, 1), (Slots{{0, 1, 4, 5}}));
+}
+
+TEST(PlaceWorkersTest, None_LeavesWorkersUnpinned) {
+    EXPECT_EQ(place_workers(two_sockets(), PoolPlacement::None, 3), (Slots{{}, {}, {}}));
+    EXPECT_EQ(place_workers(two_sockets(), PoolPlacement::None, 0).size(), 8u);
+    EXPECT_EQ(place_workers(CpuTopology{}, PoolPlacement::Compact, 2), (Slots{{}, {}}));
+}
+
+TEST(CpuTopologyTest, FindAndPackages) {
+    const CpuTopology topology = two_sockets();
+    ASSERT_NE(topology.find(6), nullptr);
+    EXPECT_EQ(topology.find(6)->package, 1u);
+    EXPECT_EQ(topology.find(8), nullptr);
+    EXPECT_EQ(topology.package_cpus(1), (std::vector<unsigned>{2, 3, 6, 7}));
+}
+
+TEST(CpuTopologyTest, Discovered_SortedAndConsistent) {
+    const CpuTopology topology = cpu_topology();
+    ASSERT_FALSE(topology.cpus.empty());
+    EXPECT_TRUE(std::is_sorted(topology.cpus.begin(), topology.cpus.end(),
+                               [](const LogicalCpu& a, const LogicalCpu& b) { return a.id < b.id; }));
+    for (const LogicalCpu& cpu : topology.cpus) {
+        EXPECT_EQ(topology.find(cpu.id), &cpu);
+        const auto same_package = topology.package_cpus(cpu.package);
+        EXPECT_NE(std::find(same_package.begin(), same_package.end(), cpu.id), same_package.end());
+    }
+}
+
+}  // namespace
+}  // namespace exeray::platform
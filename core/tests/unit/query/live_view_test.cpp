@@ -0,0 +1,114 @@
+#include "query_test_common.hpp"
+
+#include "exeray/event/live_view.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// 4. Live Views
+// ============================================================================
+
+namespace {
+
+FilterSpec network_filter() {
+    FilterSpec filter;
+    filter.with_category(Category::Network);
+    return filter;
+}
+
+std::vector<EventId> page_ids(const LiveView& view, std::size_t index) {
+    std::vector<QueryRow> rows(view.options().page_size);
+    rows.resize(view.page(index, rows));
+    std::vector<EventId> ids;
+    for (const QueryRow& row : rows) {
+        ids.push_back(row.id);
+    }
+    return ids;
+}
+
+}  // namespace
+
+TEST_F(QueryTest, LiveView_RefreshTestsOnlyNewEvents) {
+    push_mix(300);
+    LiveView view(graph_, network_filter(), {ViewSort::Id, false, 1000});
+    EXPECT_EQ(view.refresh(), 100U);
+    EXPECT_EQ(page_ids(view, 0), reference(Query{}.category(Category::Network)));
+    EXPECT_EQ(view.refresh(), 0U);  // Nothing new
+
+    push_file(FileOp::Read, 5000);
+    const EventId added = push_network(443, 5001);
+    EXPECT_EQ(view.refresh(), 1U);
+    EXPECT_EQ(view.size(), 101U);
+    EXPECT_EQ(page_ids(view, 0).back(), added);
+}
+
+TEST_F(QueryTest, LiveView_PagesNewestFirst) {
+    std::vector<EventId> ids;
+    for (int i = 0; i < 23; ++i) {
+        ids.push_back(push_network(443, 1000 + i));
+        push_file(FileOp::Write, 1000 + i);
+    }
+    LiveView view(graph_, network_filter(), {ViewSort::Timestamp, true, 10});
+    view.refresh();
+    ASSERT_EQ(view.pages(), 3U);
+
+    std::reverse(ids.begin(), ids.end());
+    EXPECT_EQ(page_ids(view, 0), std::vector<EventId>(ids.begin(), ids.begin() + 10));
+    EXPECT_EQ(page_ids(view, 2), std::vector<EventId>(ids.begin() + 20, ids.end()));
+    EXPECT_TRUE(page_ids(view, 3).empty());
+
+    std::array<QueryRow, 4> small{};
+    EXPECT_EQ(view.page(1, small), 4U);  // Capped by the buffer
+    EXPECT_EQ(small[0].id, ids[10]);
+}
+
+TEST_F(QueryTest, LiveView_LateTimestampsSortedIn) {
+    const EventId a = push_network(80, 300);
+    const EventId b = push_network(80, 100);
+    const EventId c = push_network(80, 200);
+    LiveView view(graph_, network_filter(), {ViewSort::Timestamp, false, 10});
+    view.refresh();
+    const EventId d = push_network(80, 150);
+    view.refresh();
+    EXPECT_EQ(page_ids(view, 0), (std::vector<EventId>{b, d, c, a}));
+}
+
+TEST_F(QueryTest, LiveView_SortByPidAndStatusFilter) {
+    push_process(300, 1);
+    const EventId low = push_process(100, 2, 0, Status::Denied);
+    const EventId high = push_process(200, 3, 0, Status::Denied);
+    push_process(50, 4);
+    FilterSpec filter;
+    filter.with_status(Status::Denied);
+    LiveView view(graph_, filter, {ViewSort::Pid, false, 10});
+    view.refresh();
+    EXPECT_EQ(page_ids(view, 0), (std::vector<EventId>{low, high}));
+}
+
+TEST_F(QueryTest, LiveView_RingEvictionDropsEntries) {
+    Arena arena(16 * 1024 * 1024);
+    StringPool strings(arena);
+    EventGraph ring(arena, strings, EventGraph::kSegmentSize * 2, Retention::Ring);
+    EventPayload payload{};
+    payload.category = Category::Network;
+    const auto push = [&ring, &payload](Timestamp ts) {
+        return ring.push(Category::Network, 0, Status::Success, INVALID_EVENT, 0, payload, ts);
+    };
+    for (std::size_t i = 0; i < EventGraph::kSegmentSize; ++i) {
+        push(i);
+    }
+    LiveView view(ring, network_filter(), {ViewSort::Id, false, 64});
+    view.refresh();
+    EXPECT_EQ(view.size(), EventGraph::kSegmentSize);
+
+    for (std::size_t i = 0; i < EventGraph::kSegmentSize * 3; ++i) {
+        push(i);
+    }
+    view.refresh();
+    EXPECT_EQ(view.size(), ring.count());
+    EXPECT_EQ(page_ids(view, 0).front(), ring.oldest_id());
+}
+
+}  // namespace exeray::event::test
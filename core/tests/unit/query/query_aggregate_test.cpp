@@ -0,0 +1,72 @@
+#include "query_test_common.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// 3. Aggregation
+// ============================================================================
+
+TEST_F(QueryTest, TopCounts_EmptyOutput_ReturnsZero) {
+    push_mix(10);
+    EXPECT_EQ(top_counts(graph_, Query{}, GroupKey::Category, {}), 0U);
+}
+
+TEST_F(QueryTest, TopCounts_RemotePort_SortedByCount) {
+    for (int i = 0; i < 5; ++i) {
+        push_network(443, 1000 + i);
+    }
+    for (int i = 0; i < 3; ++i) {
+        push_network(80, 2000 + i);
+    }
+    push_network(53, 3000);
+    push_file(FileOp::Read, 4000);  // No port: not grouped
+
+    std::array<GroupCount, 2> top{};
+    ASSERT_EQ(top_counts(graph_, Query{}, GroupKey::RemotePort, top), 2U);
+    EXPECT_EQ(top[0].key, 443U);
+    EXPECT_EQ(top[0].count, 5U);
+    EXPECT_EQ(top[1].key, 80U);
+    EXPECT_EQ(top[1].count, 3U);
+}
+
+TEST_F(QueryTest, TopCounts_TalkersInWindow) {
+    // Chain 7 talks early, chain 9 talks late
+    for (int i = 0; i < 10; ++i) {
+        push_network(443, 1000 + i, 7);
+    }
+    for (int i = 0; i < 4; ++i) {
+        push_network(443, 5000 + i, 9);
+    }
+
+    std::array<GroupCount, 4> top{};
+    const Query window = Query{}.category(Category::Network).since(4000);
+    ASSERT_EQ(top_counts(graph_, window, GroupKey::Correlation, top), 1U);
+    EXPECT_EQ(top[0].key, 9U);
+    EXPECT_EQ(top[0].count, 4U);
+}
+
+TEST_F(QueryTest, TopCounts_IgnoresLimitAndOrder) {
+    push_mix(300);
+    std::array<GroupCount, 16> all{};
+    std::array<GroupCount, 16> limited{};
+    const std::size_t n = top_counts(graph_, Query{}, GroupKey::Category, all);
+    ASSERT_EQ(top_counts(graph_, Query{}.take(1).newest_first(), GroupKey::Category,
+                         limited),
+              n);
+    ASSERT_EQ(n, 3U);
+
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(all[i].key, limited[i].key);
+        EXPECT_EQ(all[i].count, limited[i].count);
+        total += all[i].count;
+        if (i > 0) {
+            EXPECT_GE(all[i - 1].count, all[i].count);
+        }
+    }
+    EXPECT_EQ(total, 300U);
+}
+
+}  // namespace exeray::event::test
@@ -0,0 +1,137 @@
+#include "query_test_common.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// 2. Query Execution
+// ============================================================================
+
+namespace {
+
+/// Queries covering every plan, with and without order and limit.
+std::vector<Query> sample_queries() {
+    std::vector<Query> queries;
+    queries.push_back(Query{});
+    queries.push_back(Query{}.category(Category::Network).remote_port(443));
+    queries.push_back(
+        Query{}.category(Category::FileSystem).operation(static_cast<uint8_t>(FileOp::Write)));
+    queries.push_back(Query{}.pid(103).status(Status::Success));
+    queries.push_back(Query{}.status(Status::Denied).between(1500, 9000));
+    queries.push_back(Query{}.correlation(2));
+    queries.push_back(Query{}.correlation(4).category(Category::Process).newest_first());
+    queries.push_back(Query{}.correlation(1).take(7));
+    queries.push_back(Query{}.category(Category::Network).newest_first().take(10));
+    queries.push_back(Query{}.since(5000).take(33));
+    queries.push_back(Query{}.since(5000).newest_first().take(33));
+    return queries;
+}
+
+}  // namespace
+
+TEST_F(QueryTest, Run_EmptyGraph_NoResults) {
+    for (const Query& query : sample_queries()) {
+        EXPECT_TRUE(run(query).empty());
+    }
+}
+
+TEST_F(QueryTest, Run_MatchesReference) {
+    push_mix(EventGraph::kSegmentSize * 2 + 321);
+    for (const Query& query : sample_queries()) {
+        EXPECT_EQ(run(query), reference(query));
+    }
+}
+
+TEST_F(QueryTest, Run_Columnar_MatchesReference) {
+    graph_.set_columnar(true);
+    push_mix(EventGraph::kSegmentSize * 2 + 321);
+    ASSERT_EQ(graph_.sealed_count(), 2U);
+    for (const Query& query : sample_queries()) {
+        EXPECT_EQ(run(query), reference(query));
+    }
+}
+
+TEST_F(QueryTest, Run_BufferCapsLimit) {
+    push_mix(500);
+    std::array<EventId, 5> ids{};
+    EXPECT_EQ(run_query(graph_, Query{}.newest_first(), ids), ids.size());
+
+    const auto expected = reference(Query{}.newest_first().take(ids.size()));
+    EXPECT_TRUE(std::equal(ids.begin(), ids.end(), expected.begin()));
+}
+
+TEST_F(QueryTest, Run_Rows_ProjectIndexedFields) {
+    const EventId id = push_process(4242, 7777, 9, Status::Denied);
+    push_network(443, 8888, 9);
+
+    std::array<QueryRow, 4> rows{};
+    ASSERT_EQ(run_query(graph_, Query{}.category(Category::Process), rows), 1U);
+    EXPECT_EQ(rows[0].id, id);
+    EXPECT_EQ(rows[0].timestamp, 7777U);
+    EXPECT_EQ(rows[0].pid, 4242U);
+    EXPECT_EQ(rows[0].correlation_id, 9U);
+    EXPECT_EQ(rows[0].category, Category::Process);
+    EXPECT_EQ(rows[0].status, Status::Denied);
+
+    ASSERT_EQ(run_query(graph_, Query{}.correlation(9).newest_first(), rows), 2U);
+    EXPECT_EQ(rows[0].category, Category::Network);
+    EXPECT_EQ(rows[0].remote_port, 443U);
+}
+
+TEST_F(QueryTest, ForEachMatch_StopsWhenVisitorReturnsFalse) {
+    push_mix(1000);
+    std::size_t visited = 0;
+    const std::size_t emitted = for_each_match(graph_, Query{}, [&visited](EventView) {
+        return ++visited < 3;
+    });
+    EXPECT_EQ(visited, 3U);
+    EXPECT_EQ(emitted, 3U);
+}
+
+TEST_F(QueryTest, ForEach_VisitorReturningFalse_StopsIteration) {
+    push_mix(EventGraph::kSegmentSize + 10);
+    std::size_t visited = 0;
+    graph_.for_each([&visited](EventView) { return ++visited < 5; });
+    EXPECT_EQ(visited, 5U);
+
+    visited = 0;
+    graph_.for_each_category(Category::Network, [&visited](EventView) {
+        return ++visited < 5;
+    });
+    EXPECT_EQ(visited, 5U);
+
+    visited = 0;
+    graph_.for_each_in_range(0, ~Timestamp{0}, [&visited](EventView) {
+        return ++visited < 5;
+    });
+    EXPECT_EQ(visited, 5U);
+
+    visited = 0;
+    graph_.for_each_correlation(2, [&visited](EventView) { return ++visited < 5; });
+    EXPECT_EQ(visited, 5U);
+}
+
+TEST_F(QueryTest, Run_RingMode_MatchesReference) {
+    Arena arena(16 * 1024 * 1024);
+    StringPool strings(arena);
+    EventGraph ring(arena, strings, EventGraph::kSegmentSize * 2, Retention::Ring);
+    EventPayload payload{};
+    payload.category = Category::Network;
+    for (std::size_t i = 0; i < EventGraph::kSegmentSize * 5; ++i) {
+        payload.network.remote_port = static_cast<uint16_t>(i % 3 == 0 ? 443 : 80);
+        ring.push(Category::Network, 0, Status::Success, INVALID_EVENT,
+                  static_cast<uint32_t>(i % 4), payload, 1000 + i);
+    }
+
+    const Query query = Query{}.remote_port(443).newest_first().take(100);
+    std::vector<EventId> ids(100);
+    ids.resize(run_query(ring, query, ids));
+    ASSERT_EQ(ids.size(), 100U);
+    for (std::size_t i = 1; i < ids.size(); ++i) {
+        EXPECT_GT(ids[i - 1], ids[i]);
+        EXPECT_FALSE(ring.is_evicted(ids[i]));
+    }
+}
+
+}  // namespace exeray::event::test
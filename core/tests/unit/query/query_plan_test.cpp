@@ -0,0 +1,71 @@
+#include "query_test_common.hpp"
+
+namespace exeray::event::test {
+
+using namespace exeray::event;
+
+// ============================================================================
+// 1. Query Planning
+// ============================================================================
+
+TEST_F(QueryTest, Plan_ZeroLimitOrInvertedRange_Empty) {
+    push_mix(10);
+    EXPECT_EQ(plan_query(graph_, Query{}.take(0)), QueryPlan::Empty);
+    EXPECT_EQ(plan_query(graph_, Query{}.between(2000, 1000)), QueryPlan::Empty);
+    EXPECT_TRUE(run(Query{}.between(2000, 1000)).empty());
+}
+
+TEST_F(QueryTest, Plan_Correlation_UsesChain) {
+    push_mix(100);
+    EXPECT_EQ(plan_query(graph_, Query{}.correlation(3).category(Category::Network)),
+              QueryPlan::Correlation);
+}
+
+TEST_F(QueryTest, Plan_RareCategory_UsesCategoryIndex) {
+    for (int i = 0; i < 1000; ++i) {
+        push_file(FileOp::Read, 1000 + i);
+    }
+    push_network(443, 5000);
+    EXPECT_EQ(plan_query(graph_, Query{}.category(Category::Network)), QueryPlan::Category);
+}
+
+TEST_F(QueryTest, Plan_CommonCategory_Scans) {
+    for (int i = 0; i < 1000; ++i) {
+        push_file(FileOp::Read, 1000 + i);
+    }
+    EXPECT_EQ(plan_query(graph_, Query{}.category(Category::FileSystem)), QueryPlan::Scan);
+}
+
+TEST_F(QueryTest, Plan_NarrowTimeRange_PrefersScan) {
+    // Network is a quarter of the graph, but the window holds one segment
+    constexpr std::size_t kEvents = EventGraph::kSegmentSize * 8;
+    for (std::size_t i = 0; i < kEvents; ++i) {
+        if (i % 4 == 0) {
+            push_network(443, 1000 + i);
+        } else {
+            push_file(FileOp::Read, 1000 + i);
+        }
+    }
+    Query recent = Query{}.category(Category::Network).since(1000 + kEvents - 100);
+    EXPECT_EQ(plan_query(graph_, recent), QueryPlan::Scan);
+    EXPECT_EQ(run(recent), reference(recent));
+}
+
+TEST_F(QueryTest, Plan_MultipleCategories_Scans) {
+    push_network(443, 1000);
+    EXPECT_EQ(plan_query(graph_, Query{}.category(Category::Network).category(Category::Dns)),
+              QueryPlan::Scan);
+}
+
+TEST_F(QueryTest, EstimateInRange_CountsOverlappingSegments) {
+    constexpr std::size_t kEvents = EventGraph::kSegmentSize * 3;
+    for (std::size_t i = 0; i < kEvents; ++i) {
+        push_file(FileOp::Read, 1000 + i);
+    }
+    EXPECT_EQ(graph_.estimate_in_range(0, ~Timestamp{0}), kEvents);
+    EXPECT_EQ(graph_.estimate_in_range(1000, 1000), EventGraph::kSegmentSize);
+    EXPECT_EQ(graph_.estimate_in_range(1000 + kEvents, ~Timestamp{0}), 0U);
+    EXPECT_EQ(graph_.estimate_in_range(10, 5), 0U);
+}
+
+}  // namespace exeray::event::test
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "exeray/arena.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/query.hpp"
+
+namespace exeray::event::test {
+
+// ============================================================================
+// Test Fixture
+// ============================================================================
+
+class QueryTest : public ::testing::Test {
+protected:
+    static constexpr std::size_t kArenaSize = 64 * 1024 * 1024;  // 64MB
+    static constexpr std::size_t kDefaultCapacity = 65536;
+
+    Arena arena_{kArenaSize};
+    StringPool strings_{arena_};
+    EventGraph graph_{arena_, strings_, kDefaultCapacity};
+
+    // -------------------------------------------------------------------------
+    // Helper: Push events with explicit timestamps
+    // -------------------------------------------------------------------------
+
+    EventId push_file(FileOp op, Timestamp ts, uint32_t correlation_id = 0) {
+        EventPayload payload{};
+        payload.category = Category::FileSystem;
+        payload.file.path = INVALID_STRING;
+        return graph_.push(Category::FileSystem, static_cast<uint8_t>(op),
+                           Status::Success, INVALID_EVENT, correlation_id, payload, ts);
+    }
+
+    EventId push_network(uint16_t remote_port, Timestamp ts, uint32_t correlation_id = 0) {
+        EventPayload payload{};
+        payload.category = Category::Network;
+        payload.network.remote_port = remote_port;
+        return graph_.push(Category::Network, static_cast<uint8_t>(NetworkOp::Connect),
+                           Status::Success, INVALID_EVENT, correlation_id, payload, ts);
+    }
+
+    EventId push_process(uint32_t pid, Timestamp ts, uint32_t correlation_id = 0,
+                         Status status = Status::Success) {
+        EventPayload payload{};
+        payload.category = Category::Process;
+        payload.process.pid = pid;
+        return graph_.push(Category::Process, static_cast<uint8_t>(ProcessOp::Create),
+                           status, INVALID_EVENT, correlation_id, payload, ts);
+    }
+
+    /// @brief Push a repeating mix of the three categories, stamped 1000 + i.
+    void push_mix(std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const Timestamp ts = 1000 + i;
+            const auto corr = static_cast<uint32_t>(i % 5);
+            switch (i % 3) {
+                case 0:
+                    push_file(i % 2 == 0 ? FileOp::Write : FileOp::Read, ts, corr);
+                    break;
+                case 1:
+                    push_network(static_cast<uint16_t>(i % 4 == 1 ? 443 : 80), ts, corr);
+                    break;
+                default:
+                    push_process(static_cast<uint32_t>(100 + i % 7), ts, corr,
+                                 i % 11 == 0 ? Status::Denied : Status::Success);
+                    break;
+            }
+        }
+    }
+
+    /// @brief Reference result: full scan, then order and limit.
+    std::vector<EventId> reference(const Query& query) const {
+        std::vector<EventId> ids;
+        graph_.for_each([&](EventView view) {
+            if (query.filter.matches(view)) {
+                ids.push_back(view.id());
+            }
+        });
+        if (query.order == QueryOrder::NewestFirst) {
+            std::reverse(ids.begin(), ids.end());
+        }
+        if (ids.size() > query.limit) {
+            ids.resize(query.limit);
+        }
+        return ids;
+    }
+
+    /// @brief Run a query into a vector large enough for every event.
+    std::vector<EventId> run(const Query& query) const {
+        std::vector<EventId> ids(graph_.count());
+        ids.resize(run_query(graph_, query, ids));
+        return ids;
+    }
+};
+
+}  // namespace exeray::event::test
@@ -0,0 +1,126 @@
+/// @file sampling_profiler_test.cpp
+/// @brief Tests for stage markers and their folded-stack sampling.
+
+#include <gtest/gtest.h>
+
+#include "exeray/sampling_profiler.hpp"
+#include "exeray/trace_spans.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace exeray {
+namespace {
+
+std::uint64_t count_of(const SamplingProfiler& profiler, const std::string& stack) {
+    for (const auto& [folded, count] : profiler.folded()) {
+        if (folded == stack) {
+            return count;
+        }
+    }
+    return 0;
+}
+
+TEST(SamplingProfilerTest, NoRole_NotSampled) {
+    SamplingProfiler profiler;
+    {
+        EXERAY_SPAN(Parse);
+        profiler.sample();
+    }
+    EXPECT_EQ(profiler.samples(), 0U);
+    EXPECT_TRUE(profiler.folded().empty());
+}
+
+TEST(SamplingProfilerTest, NestedStages_FoldedRootToLeaf) {
+    SamplingProfiler profiler;
+    const ProfiledThread role("consumer");
+    profiler.sample();
+    {
+        EXERAY_SPAN(Correlate);
+        profiler.sample();
+        {
+            EXERAY_SPAN(Push);
+            profiler.sample();
+            profiler.sample();
+        }
+    }
+    profiler.sample();
+
+    EXPECT_EQ(profiler.samples(), 5U);
+    EXPECT_EQ(count_of(profiler, "consumer"), 2U);
+    EXPECT_EQ(count_of(profiler, "consumer;correlate"), 1U);
+    EXPECT_EQ(count_of(profiler, "consumer;correlate;push"), 2U);
+
+    std::ostringstream out;
+    ASSERT_TRUE(profiler.write_folded(out));
+    EXPECT_EQ(out.str(), "consumer 2\nconsumer;correlate 1\nconsumer;correlate;push 2\n");
+}
+
+TEST(SamplingProfilerTest, DeepNesting_KeepsInnermostOutOfStack) {
+    SamplingProfiler profiler;
+    const ProfiledThread role("deep");
+    {
+        const StageScope s0(0), s1(0), s2(0), s3(0), s4(0), s5(0), s6(0), s7(0);
+        {
+            const StageScope too_deep(4);  // Beyond kMaxDepth: not marked
+            profiler.sample();
+        }
+        profiler.sample();
+    }
+    profiler.sample();
+    const std::string eight = "deep;parse;parse;parse;parse;parse;parse;parse;parse";
+    EXPECT_EQ(count_of(profiler, eight), 2U);
+    EXPECT_EQ(count_of(profiler, "deep"), 1U);
+}
+
+TEST(SamplingProfilerTest, RoleEnds_ThreadNoLongerSampled) {
+    SamplingProfiler profiler;
+    {
+        const ProfiledThread role("ingest");
+        profiler.sample();
+    }
+    profiler.sample();
+    EXPECT_EQ(count_of(profiler, "ingest"), 1U);
+    EXPECT_EQ(profiler.samples(), 1U);
+}
+
+TEST(SamplingProfilerTest, Watchdog_SamplesOtherThreads) {
+    SamplingProfiler profiler;
+    std::atomic<bool> done{false};
+    std::thread worker([&] {
+        const ProfiledThread role("detector");
+        EXERAY_SPAN(Detect);
+        while (!done.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    ASSERT_TRUE(profiler.start(std::chrono::microseconds(500)));
+    EXPECT_FALSE(profiler.start(std::chrono::microseconds(500)));
+    EXPECT_TRUE(profiler.running());
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (count_of(profiler, "detector;detect") < 3 &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    profiler.stop();
+    done.store(true);
+    worker.join();
+
+    EXPECT_FALSE(profiler.running());
+    EXPECT_GE(count_of(profiler, "detector;detect"), 3U);
+    profiler.reset();
+    EXPECT_EQ(profiler.samples(), 0U);
+}
+
+TEST(SamplingProfilerTest, ZeroInterval_NotStarted) {
+    SamplingProfiler profiler;
+    EXPECT_FALSE(profiler.start(std::chrono::microseconds(0)));
+    EXPECT_FALSE(profiler.running());
+}
+
+}  // namespace
+}  // namespace exeray
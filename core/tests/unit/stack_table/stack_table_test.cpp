@@ -0,0 +1,154 @@
+/// @file stack_table_test.cpp
+/// @brief Tests for deduplicated call stacks and their attachment to events.
+
+#include <gtest/gtest.h>
+
+#include "exeray/arena.hpp"
+#include "exeray/etw/consumer.hpp"
+#include "exeray/etw/parser.hpp"
+#include "exeray/event/extensions.hpp"
+#include "exeray/event/graph.hpp"
+#include "exeray/event/stack_table.hpp"
+#include "exeray/event/string_pool.hpp"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace exeray::event {
+namespace {
+
+constexpr std::size_t kArenaSize = 4 * 1024 * 1024;
+
+std::vector<std::uint64_t> make_stack(std::uint64_t seed, std::size_t depth = 12) {
+    std::vector<std::uint64_t> frames;
+    for (std::size_t i = 0; i < depth; ++i) {
+        frames.push_back(0x7FF800000000ULL + seed * 0x1000 + i * 0x10);
+    }
+    return frames;
+}
+
+TEST(StackTableTest, Intern_SameFramesShareOneRecord) {
+    Arena arena{kArenaSize};
+    ExtensionStore store{arena};
+    StackTable table{store};
+
+    const ExtensionId a = table.intern(make_stack(1));
+    const ExtensionId b = table.intern(make_stack(2));
+    ASSERT_NE(a, NO_EXTENSION);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(table.intern(make_stack(1)), a);
+    EXPECT_EQ(store.get(a).kind, ExtensionKind::Stack);
+    EXPECT_EQ(table.frames(a), make_stack(1));
+
+    // A prefix is a different stack
+    EXPECT_NE(table.intern(make_stack(1, 11)), a);
+
+    const StackTableStats stats = table.stats();
+    EXPECT_EQ(stats.interned, 4U);
+    EXPECT_EQ(stats.distinct, 3U);
+    EXPECT_EQ(store.count(), 3U);
+}
+
+TEST(StackTableTest, Intern_KeepsTheInnermostFramesOfDeepStacks) {
+    Arena arena{kArenaSize};
+    ExtensionStore store{arena};
+    StackTable table{store};
+
+    const auto deep = make_stack(3, StackTable::kMaxFrames + 40);
+    const std::vector<std::uint64_t> kept(deep.begin(), deep.begin() + StackTable::kMaxFrames);
+    EXPECT_EQ(table.frames(table.intern(deep)), kept);
+    EXPECT_EQ(table.intern({}), NO_EXTENSION);
+    EXPECT_TRUE(table.frames(NO_EXTENSION).empty());
+}
+
+TEST(StackTableTest, Intern_ConcurrentThreadsAgreeOnIds) {
+    Arena arena{kArenaSize};
+    ExtensionStore store{arena};
+    StackTable table{store};
+
+    constexpr int kThreads = 4;
+    constexpr std::uint64_t kStacks = 200;
+    std::vector<std::vector<ExtensionId>> ids(kThreads, std::vector<ExtensionId>(kStacks));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (std::uint64_t i = 0; i < kStacks; ++i) {
+                ids[t][i] = table.intern(make_stack(i));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int t = 1; t < kThreads; ++t) {
+        EXPECT_EQ(ids[t], ids[0]);
+    }
+    EXPECT_EQ(table.stats().distinct, kStacks);
+}
+
+class StackConsumerTest : public ::testing::Test {
+protected:
+    Arena arena_{kArenaSize};
+    StringPool strings_{arena_};
+    ExtensionStore store_{arena_};
+    StackTable stacks_{store_};
+    EventGraph graph_{arena_, strings_, 1024};
+    etw::ConsumerContext ctx_;
+
+    void SetUp() override {
+        ctx_.graph = &graph_;
+        ctx_.strings = &strings_;
+        ctx_.extensions = &store_;
+        ctx_.stacks = &stacks_;
+    }
+
+    void consume(std::uint64_t timestamp, std::span<const std::uint64_t> stack = {}) {
+        etw::ParsedEvent parsed{};
+        parsed.valid = true;
+        parsed.category = Category::Thread;
+        parsed.payload.category = Category::Thread;
+        parsed.timestamp = timestamp;
+        parsed.stack = stack;
+        etw::consume_parsed(ctx_, parsed, 0, 0, 0);
+    }
+};
+
+TEST_F(StackConsumerTest, ConsumeParsed_InternsTheRecordStack) {
+    const auto stack = make_stack(5);
+    consume(100, stack);
+    consume(200, stack);
+    consume(300);
+    etw::flush_pending(ctx_);
+
+    ASSERT_EQ(graph_.count(), 3U);
+    const ExtensionId first = graph_.get(1).payload().extension;
+    EXPECT_EQ(stacks_.frames(first), stack);
+    EXPECT_EQ(graph_.get(2).payload().extension, first);
+    EXPECT_EQ(graph_.get(3).payload().extension, NO_EXTENSION);
+}
+
+TEST_F(StackConsumerTest, ConsumeStack_AttachesToTheEventWithItsTimestamp) {
+    consume(100);
+    consume(200);
+    const auto stack = make_stack(6);
+    EXPECT_TRUE(etw::consume_stack(ctx_, 100, stack));
+    EXPECT_FALSE(etw::consume_stack(ctx_, 150, stack));  // No such event
+    etw::flush_pending(ctx_);
+    EXPECT_FALSE(etw::consume_stack(ctx_, 200, stack));  // Already pushed
+
+    EXPECT_EQ(stacks_.frames(graph_.get(1).payload().extension), stack);
+    EXPECT_EQ(graph_.get(2).payload().extension, NO_EXTENSION);
+    EXPECT_EQ(stacks_.stats().orphaned, 2U);
+}
+
+TEST_F(StackConsumerTest, ConsumeStack_WithoutTableDropsStacks) {
+    ctx_.stacks = nullptr;
+    consume(100, make_stack(7));
+    EXPECT_FALSE(etw::consume_stack(ctx_, 100, make_stack(7)));
+    etw::flush_pending(ctx_);
+    EXPECT_EQ(graph_.get(1).payload().extension, NO_EXTENSION);
+}
+
+}  // namespace
+}  // namespace exeray::event
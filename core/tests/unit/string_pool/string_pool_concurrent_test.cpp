@@ -176,5 +176,58 @@ TEST_F(StringPoolTest, Intern_HighContention_StressTest) {
     EXPECT_EQ(pool_.count(), kNumStrings);
 }
 
+class GrowingStringPoolTest : public ::testing::Test {
+protected:
+    static constexpr std::size_t kArenaSize = 16 * 1024 * 1024;  // 16MB
+
+    Arena arena_{kArenaSize};
+    StringPool pool_{arena_, 8};  // Grows many times below
+};
+
+TEST_F(GrowingStringPoolTest, Intern_GrowsPastInitialCapacity) {
+    constexpr int kNumStrings = 10000;
+    std::vector<StringId> ids;
+    for (int i = 0; i < kNumStrings; ++i) {
+        ids.push_back(pool_.intern("C:\\Users\\file_" + std::to_string(i)));
+        ASSERT_NE(ids.back(), INVALID_STRING);
+    }
+    EXPECT_EQ(pool_.count(), static_cast<std::size_t>(kNumStrings));
+    for (int i = 0; i < kNumStrings; ++i) {
+        const std::string str = "C:\\Users\\file_" + std::to_string(i);
+        EXPECT_EQ(pool_.intern(str), ids[i]);
+        EXPECT_EQ(pool_.get(ids[i]), str);
+    }
+}
+
+TEST_F(GrowingStringPoolTest, Intern_ConcurrentDuringGrowth_OneIdPerString) {
+    constexpr int kNumThreads = 8;
+    constexpr int kNumStrings = 5000;
+
+    // Every thread interns the same strings, starting at different offsets
+    std::vector<std::vector<StringId>> results(kNumThreads,
+                                               std::vector<StringId>(kNumStrings));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; ++t) {
+        threads.emplace_back([this, &results, t] {
+            for (int i = 0; i < kNumStrings; ++i) {
+                const int s = (i + t * (kNumStrings / kNumThreads)) % kNumStrings;
+                results[t][s] = pool_.intern("path_" + std::to_string(s));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(pool_.count(), static_cast<std::size_t>(kNumStrings));
+    for (int s = 0; s < kNumStrings; ++s) {
+        ASSERT_NE(results[0][s], INVALID_STRING);
+        EXPECT_EQ(pool_.get(results[0][s]), "path_" + std::to_string(s));
+        for (int t = 1; t < kNumThreads; ++t) {
+            EXPECT_EQ(results[t][s], results[0][s]) << "string " << s << " thread " << t;
+        }
+    }
+}
+
 }  // namespace
 }  // namespace exeray::event
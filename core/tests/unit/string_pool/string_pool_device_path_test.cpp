@@ -0,0 +1,132 @@
+#include "string_pool_test_common.hpp"
+
+#include "exeray/event/device_paths.hpp"
+
+namespace exeray::event {
+namespace {
+
+// ============================================================================
+// 14. Device Path Normalization Tests
+// ============================================================================
+
+class DevicePathTest : public StringPoolTest {
+protected:
+    void SetUp() override {
+        devices_.set("\\Device\\HarddiskVolume3", "C:");
+        devices_.set("\\Device\\HarddiskVolume1", "D:");
+        pool_.set_device_paths(&devices_);
+    }
+
+    DevicePathMap devices_;
+};
+
+TEST_F(DevicePathTest, InternPath_DevicePath_StoredAsDos) {
+    StringId id = pool_.intern_path("\\Device\\HarddiskVolume3\\Windows\\notepad.exe");
+
+    EXPECT_EQ(pool_.get(id), "C:\\Windows\\notepad.exe");
+    EXPECT_EQ(id, pool_.intern_path("C:\\Windows\\notepad.exe"));
+}
+
+TEST_F(DevicePathTest, InternPath_VolumeNumberPrefix_NotConfused) {
+    // HarddiskVolume1 must not match HarddiskVolume10
+    StringId id = pool_.intern_path("\\Device\\HarddiskVolume10\\x.txt");
+
+    EXPECT_EQ(pool_.get(id), "\\Device\\HarddiskVolume10\\x.txt");
+    EXPECT_EQ(pool_.get(pool_.intern_path("\\Device\\HarddiskVolume1\\x.txt")), "D:\\x.txt");
+}
+
+TEST_F(DevicePathTest, InternPath_CaseInsensitiveDevice_Translated) {
+    StringId id = pool_.intern_path("\\DEVICE\\harddiskvolume3\\Temp\\");
+
+    EXPECT_EQ(pool_.get(id), "C:\\Temp\\");
+}
+
+TEST_F(DevicePathTest, InternPath_VolumeRoot_Translated) {
+    EXPECT_EQ(pool_.get(pool_.intern_path("\\Device\\HarddiskVolume3")), "C:");
+}
+
+TEST_F(DevicePathTest, InternPath_Unc_Translated) {
+    StringId id = pool_.intern_path("\\Device\\Mup\\server\\share\\file.doc");
+
+    EXPECT_EQ(pool_.get(id), "\\\\server\\share\\file.doc");
+}
+
+TEST_F(DevicePathTest, InternPath_NonDevicePaths_Untouched) {
+    constexpr std::string_view kPaths[] = {
+        "\\REGISTRY\\MACHINE\\SOFTWARE\\Microsoft",
+        "C:\\Users\\bob\\a.txt",
+        "\\Device\\Unknown\\x",
+    };
+    for (const auto path : kPaths) {
+        EXPECT_EQ(pool_.get(pool_.intern_path(path)), path);
+    }
+}
+
+TEST_F(DevicePathTest, InternPathWide_DevicePath_Translated) {
+    StringId id = pool_.intern_path_wide(L"\\Device\\HarddiskVolume3\\Windows\\System32\\");
+
+    EXPECT_EQ(pool_.get(id), "C:\\Windows\\System32\\");
+    EXPECT_TRUE(pool_.is_under(pool_.intern_path("C:\\Windows\\System32\\kernel32.dll"), id));
+}
+
+TEST_F(DevicePathTest, InternPath_LongDevicePath_Translated) {
+    std::string path = "\\Device\\HarddiskVolume3";
+    std::string expected = "C:";
+    for (int i = 0; i < 300; ++i) {
+        path += "\\dir" + std::to_string(i);
+        expected += "\\dir" + std::to_string(i);
+    }
+    EXPECT_EQ(pool_.get(pool_.intern_path(path)), expected);
+}
+
+TEST_F(DevicePathTest, Set_ReplacesMapping) {
+    const auto size = devices_.size();
+    devices_.set("\\Device\\HarddiskVolume3", "E:");
+
+    EXPECT_EQ(devices_.size(), size);
+    EXPECT_EQ(pool_.get(pool_.intern_path("\\Device\\HarddiskVolume3\\y")), "E:\\y");
+}
+
+TEST_F(DevicePathTest, Refresh_KeepsManualEntries) {
+    devices_.refresh();
+
+    std::string_view dos;
+    EXPECT_EQ(devices_.match("\\Device\\HarddiskVolume3\\z", dos), 23U);
+    EXPECT_EQ(dos, "C:");
+}
+
+TEST_F(StringPoolTest, InternPath_NoDeviceMap_KeptAsGiven) {
+    StringId id = pool_.intern_path("\\Device\\HarddiskVolume3\\x");
+
+    EXPECT_EQ(pool_.get(id), "\\Device\\HarddiskVolume3\\x");
+}
+
+TEST_F(DevicePathTest, InternPath_ConcurrentWithSet_Consistent) {
+    std::thread writer([this] {
+        for (int i = 0; i < 500; ++i) {
+            devices_.set("\\Device\\HarddiskVolume" + std::to_string(20 + i % 8),
+                         i % 2 == 0 ? "Y:" : "Z:");
+        }
+    });
+    std::vector<std::thread> readers;
+    std::atomic<int> mismatches{0};
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([this, &mismatches] {
+            for (int i = 0; i < 2000; ++i) {
+                const auto id = pool_.intern_path("\\Device\\HarddiskVolume3\\f" +
+                                                  std::to_string(i));
+                if (pool_.get(id) != "C:\\f" + std::to_string(i)) {
+                    mismatches.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    writer.join();
+    EXPECT_EQ(mismatches.load(), 0);
+}
+
+}  // namespace
+}  // namespace exeray::event
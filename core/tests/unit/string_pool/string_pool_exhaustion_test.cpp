@@ -10,7 +10,7 @@ namespace {
 class SmallArenaStringPoolTest : public ::testing::Test {
 protected:
     // Small arena: 1KB - will exhaust quickly
-    // Due to 64-byte alignment in Arena, each allocation uses at least 64 bytes
+    // Too small for a thread buffer block, so strings come straight from it
     static constexpr std::size_t kSmallArenaSize = 1024;
 
     Arena arena_{kSmallArenaSize};
@@ -0,0 +1,106 @@
+#include "string_pool_test_common.hpp"
+
+namespace exeray::event {
+namespace {
+
+// ============================================================================
+// 13. Case-Folded ID Tests
+// ============================================================================
+
+TEST_F(StringPoolTest, Folded_MixedCase_SameFoldedId) {
+    StringId upper = pool_.intern("POWERSHELL.EXE");
+    StringId mixed = pool_.intern("PowerShell.exe");
+    StringId lower = pool_.intern("powershell.exe");
+
+    EXPECT_EQ(pool_.folded(upper), lower);
+    EXPECT_EQ(pool_.folded(mixed), lower);
+    EXPECT_EQ(pool_.folded(lower), lower);
+    EXPECT_TRUE(pool_.equals_icase(upper, mixed));
+}
+
+TEST_F(StringPoolTest, Folded_AlreadyLower_NoNewString) {
+    StringId id = pool_.intern("cmd.exe /c whoami");
+    const auto count = pool_.count();
+
+    EXPECT_EQ(pool_.folded(id), id);
+    EXPECT_EQ(pool_.count(), count);
+}
+
+TEST_F(StringPoolTest, Folded_Repeated_CachedNoNewStorage) {
+    StringId id = pool_.intern("Win32_Process");
+    StringId first = pool_.folded(id);
+    const auto count = pool_.count();
+    const auto bytes = pool_.bytes_used();
+
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(pool_.folded(id), first);
+    }
+    EXPECT_EQ(pool_.count(), count);
+    EXPECT_EQ(pool_.bytes_used(), bytes);
+    EXPECT_EQ(pool_.get(first), "win32_process");
+}
+
+TEST_F(StringPoolTest, Folded_NonAscii_Unchanged) {
+    // Only ASCII letters fold; UTF-8 bytes pass through
+    StringId id = pool_.intern("\xD0\x9F\xD1\x80" "Ab");
+    EXPECT_EQ(pool_.get(pool_.folded(id)), "\xD0\x9F\xD1\x80" "ab");
+}
+
+TEST_F(StringPoolTest, Folded_DifferentText_NotEqual) {
+    EXPECT_FALSE(pool_.equals_icase(pool_.intern("HKLM"), pool_.intern("HKCU")));
+}
+
+TEST_F(StringPoolTest, Folded_Invalid_Invalid) {
+    EXPECT_EQ(pool_.folded(INVALID_STRING), INVALID_STRING);
+    EXPECT_TRUE(pool_.equals_icase(INVALID_STRING, INVALID_STRING));
+    EXPECT_FALSE(pool_.equals_icase(INVALID_STRING, pool_.intern("x")));
+}
+
+TEST_F(StringPoolTest, Folded_PathNode_FoldsToPathNode) {
+    StringId path = pool_.intern_path("C:\\Windows\\System32\\NTDLL.DLL");
+    StringId lower = pool_.intern_path("c:\\windows\\system32\\ntdll.dll");
+
+    EXPECT_EQ(pool_.folded(path), lower);
+    StringId windows = pool_.intern_path("C:\\WINDOWS\\");
+    EXPECT_TRUE(pool_.is_under(pool_.folded(path), pool_.folded(windows)));
+    EXPECT_EQ(pool_.get(pool_.folded(path)), "c:\\windows\\system32\\ntdll.dll");
+}
+
+TEST_F(StringPoolTest, Folded_ManyIds_FoldMapGrows) {
+    std::vector<StringId> ids;
+    for (int i = 0; i < 5000; ++i) {
+        ids.push_back(pool_.intern("Key_" + std::to_string(i)));
+    }
+    for (int i = 0; i < 5000; ++i) {
+        EXPECT_EQ(pool_.get(pool_.folded(ids[i])), "key_" + std::to_string(i));
+    }
+    for (int i = 0; i < 5000; ++i) {
+        ASSERT_EQ(pool_.folded(ids[i]), pool_.intern("key_" + std::to_string(i)));
+    }
+}
+
+TEST_F(StringPoolTest, Folded_Concurrent_AgreeOnId) {
+    constexpr int kThreads = 8;
+    std::vector<StringId> ids;
+    for (int i = 0; i < 300; ++i) {
+        ids.push_back(pool_.intern("Value" + std::to_string(i)));
+    }
+    std::vector<std::vector<StringId>> results(kThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([this, &ids, &results, t] {
+            for (const auto id : ids) {
+                results[t].push_back(pool_.folded(id));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int t = 1; t < kThreads; ++t) {
+        EXPECT_EQ(results[t], results[0]);
+    }
+}
+
+}  // namespace
+}  // namespace exeray::event
@@ -0,0 +1,179 @@
+#include "string_pool_test_common.hpp"
+
+#include <chrono>
+
+namespace exeray::event {
+namespace {
+
+// ============================================================================
+// 15. Generational Storage Tests
+// ============================================================================
+
+class GenerationalStringPoolTest : public ::testing::Test {
+protected:
+    Arena arena_{1024};
+    StringPool pool_{arena_, 4096, StringStorage::Generational};
+
+    /// @brief Compact with nothing marked but ids.
+    StringPool::CompactStats compact(std::initializer_list<StringId> ids = {}) {
+        StringMarks marks = pool_.marks();
+        for (const StringId id : ids) {
+            marks.mark(id);
+        }
+        return pool_.compact(marks);
+    }
+};
+
+TEST_F(GenerationalStringPoolTest, Intern_StoresOutsideArena) {
+    const StringId id = pool_.intern("hello");
+    const StringId path = pool_.intern_path("C:\\Windows\\notepad.exe");
+
+    EXPECT_EQ(pool_.storage(), StringStorage::Generational);
+    EXPECT_EQ(pool_.intern("hello"), id);
+    EXPECT_EQ(pool_.get(id), "hello");
+    EXPECT_EQ(pool_.get(path), "C:\\Windows\\notepad.exe");
+    EXPECT_TRUE(pool_.in_range(path));
+    EXPECT_FALSE(pool_.in_range(path + 100));
+    EXPECT_EQ(arena_.used(), 0U);
+}
+
+TEST_F(GenerationalStringPoolTest, Intern_LongerThanBlock_GetsOwnBlock) {
+    const std::string big(StringPool::kBlockSize + 10, 'x');
+    const StringId small = pool_.intern("small");
+    const StringId id = pool_.intern(big);
+
+    EXPECT_EQ(pool_.get(id), big);
+    EXPECT_EQ(pool_.get(small), "small");
+    EXPECT_EQ(pool_.get(pool_.intern("after")), "after");
+}
+
+TEST_F(GenerationalStringPoolTest, Compact_KeepsStringsOfClosingGeneration) {
+    const StringId id = pool_.intern("recent");
+
+    const auto stats = compact();
+
+    EXPECT_EQ(stats.generation, 2U);
+    EXPECT_EQ(stats.kept, 1U);
+    EXPECT_EQ(stats.released, 0U);
+    EXPECT_EQ(pool_.generation(), 2U);
+    EXPECT_EQ(pool_.get(id), "recent");
+    EXPECT_EQ(pool_.intern("recent"), id);
+}
+
+TEST_F(GenerationalStringPoolTest, Compact_ReleasesUnmarkedUnusedStrings) {
+    const StringId kept = pool_.intern("kept");
+    const StringId dropped = pool_.intern("dropped");
+    compact();
+
+    const auto stats = compact({kept});
+
+    EXPECT_EQ(stats.kept, 1U);
+    EXPECT_EQ(stats.released, 1U);
+    EXPECT_EQ(pool_.get(kept), "kept");
+    EXPECT_EQ(pool_.get(dropped), "");
+    EXPECT_EQ(pool_.count(), 1U);
+    EXPECT_EQ(pool_.bytes_used(), sizeof(std::uint32_t) + 4);
+
+    // A released ID is never handed out again
+    const StringId again = pool_.intern("dropped");
+    EXPECT_NE(again, dropped);
+    EXPECT_EQ(pool_.get(again), "dropped");
+}
+
+TEST_F(GenerationalStringPoolTest, Compact_LookupKeepsString) {
+    const StringId id = pool_.intern("looked up");
+    compact();
+
+    EXPECT_EQ(pool_.intern("looked up"), id);
+    const auto stats = compact();
+
+    EXPECT_EQ(stats.released, 0U);
+    EXPECT_EQ(pool_.get(id), "looked up");
+}
+
+TEST_F(GenerationalStringPoolTest, Compact_PathNodeKeepsParentsAndLeaves) {
+    const StringId file = pool_.intern_path("C:\\Users\\a\\file.txt");
+    const StringId other = pool_.intern_path("D:\\other.txt");
+    EXPECT_EQ(pool_.get(file), "C:\\Users\\a\\file.txt");
+    compact();
+
+    compact({file});
+
+    EXPECT_EQ(pool_.get(file), "C:\\Users\\a\\file.txt");
+    EXPECT_EQ(pool_.get(pool_.path_parent(file)), "C:\\Users\\a\\");
+    EXPECT_EQ(pool_.intern_path("C:\\Users\\a\\file.txt"), file);
+    EXPECT_EQ(pool_.get(other), "");
+}
+
+TEST_F(GenerationalStringPoolTest, Compact_FreesBlocksOneCompactionLater) {
+    for (int i = 0; i < 20000; ++i) {
+        pool_.intern("string_" + std::to_string(i));
+    }
+    const auto copied = compact();
+    const auto released = compact();
+    const auto emptied = compact();
+
+    EXPECT_EQ(copied.blocks_freed, 0U);
+    EXPECT_EQ(released.released, 20000U);
+    EXPECT_GT(released.blocks_freed, 0U);  // Blocks of generation 1
+    EXPECT_GT(emptied.blocks_freed, 0U);   // Copies made by the first compaction
+    EXPECT_EQ(compact().blocks_freed, 0U);
+    EXPECT_EQ(pool_.count(), 0U);
+}
+
+TEST_F(GenerationalStringPoolTest, Compact_FoldsRecomputed) {
+    const StringId upper = pool_.intern("ABC");
+    const StringId lower = pool_.folded(upper);
+    compact();
+
+    compact({upper});
+
+    const StringId folded = pool_.folded(upper);
+    EXPECT_EQ(pool_.get(folded), "abc");
+    EXPECT_NE(folded, lower);
+}
+
+TEST_F(GenerationalStringPoolTest, Compact_ConcurrentInterns_StayReadable) {
+    std::atomic<bool> stop{false};
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([this, t, &stop, &mismatches] {
+            for (int i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+                const std::string str = "t" + std::to_string(t) + "_" + std::to_string(i % 500);
+                if (pool_.get(pool_.intern(str)) != str) {
+                    mismatches.fetch_add(1, std::memory_order_relaxed);
+                }
+                const std::string path = "C:\\dir" + std::to_string(i % 50) + "\\" + str;
+                if (pool_.get(pool_.intern_path(path)) != path) {
+                    mismatches.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 20; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        compact();
+    }
+    stop.store(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(mismatches.load(), 0);
+    EXPECT_EQ(pool_.generation(), 21U);
+}
+
+TEST_F(StringPoolTest, Compact_ArenaStorage_IsNoop) {
+    const StringId id = pool_.intern("arena");
+
+    const auto stats = pool_.compact(pool_.marks());
+
+    EXPECT_EQ(pool_.storage(), StringStorage::Arena);
+    EXPECT_EQ(stats.generation, 0U);
+    EXPECT_EQ(pool_.generation(), 0U);
+    EXPECT_EQ(pool_.get(id), "arena");
+}
+
+}  // namespace
+}  // namespace exeray::event
@@ -27,6 +27,16 @@ TEST_F(StringPoolTest, Get_OutOfRangeId_DoesNotCrash) {
     EXPECT_TRUE(pool_.get(INVALID_STRING).empty());
 }
 
+TEST_F(StringPoolTest, InRange_OnlyIdsInsideStorage) {
+    EXPECT_FALSE(pool_.in_range(INVALID_STRING));
+    const StringId plain = pool_.intern("in_range");
+    const StringId path = pool_.intern_path("C:\\Windows\\notepad.exe");
+    EXPECT_TRUE(pool_.in_range(plain));
+    EXPECT_TRUE(pool_.in_range(path));
+    EXPECT_FALSE(pool_.in_range(static_cast<StringId>(arena_.used() + 1)));
+    EXPECT_FALSE(pool_.in_range(0xFFFFFFFFu));
+}
+
 TEST_F(StringPoolTest, Get_AfterManyInterns_StillValid) {
     // Intern first string
     StringId first_id = pool_.intern("first_string");
@@ -0,0 +1,50 @@
+#include "string_pool_test_common.hpp"
+
+namespace exeray::event {
+namespace {
+
+// ============================================================================
+// 10. Growable Arena Tests
+// ============================================================================
+
+class GrowableArenaStringPoolTest : public ::testing::Test {
+protected:
+    // Same 1KB initial budget as the exhaustion tests, growing to 4 MiB
+    static constexpr std::size_t kInitialSize = 1024;
+    static constexpr std::size_t kCeiling = 2 * Arena::kCommitChunk;
+
+    Arena arena_{kInitialSize, ArenaOptions{.max_capacity = kCeiling}};
+    StringPool pool_{arena_};
+
+    void SetUp() override {
+        if (arena_.backend() != ArenaBackend::Virtual) {
+            GTEST_SKIP() << "address space reservation unavailable";
+        }
+    }
+};
+
+TEST_F(GrowableArenaStringPoolTest, Intern_PastInitialSize_IdsStayValid) {
+    std::vector<std::pair<StringId, std::string>> interned;
+    for (int i = 0; i < 1000; ++i) {
+        std::string str(100, 'x');
+        str += std::to_string(i);
+        const StringId id = pool_.intern(str);
+        ASSERT_NE(id, INVALID_STRING) << "at string " << i;
+        interned.emplace_back(id, std::move(str));
+    }
+    EXPECT_GT(arena_.used(), kInitialSize);
+
+    for (const auto& [id, str] : interned) {
+        EXPECT_EQ(pool_.get(id), str);
+    }
+}
+
+TEST_F(GrowableArenaStringPoolTest, Intern_AtCeiling_GracefulFailure) {
+    const std::string big(Arena::kCommitChunk, 'y');
+    EXPECT_NE(pool_.intern(big), INVALID_STRING);
+    EXPECT_EQ(pool_.intern(big + "z"), INVALID_STRING);
+    EXPECT_NE(pool_.intern("small"), INVALID_STRING);
+}
+
+}  // namespace
+}  // namespace exeray::event
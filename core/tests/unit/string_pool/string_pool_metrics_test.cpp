@@ -52,5 +52,15 @@ TEST_F(StringPoolTest, Count_Accurate_AfterOperations) {
     EXPECT_EQ(pool_.count(), kUniqueStrings);
 }
 
+TEST_F(StringPoolTest, ArenaUsage_ShortStrings_PackedTightly) {
+    constexpr int kStrings = 1000;
+    for (int i = 0; i < kStrings; ++i) {
+        ASSERT_NE(pool_.intern("s" + std::to_string(i)), INVALID_STRING);
+    }
+    // Strings pack byte-aligned instead of one cache line each
+    EXPECT_LT(arena_.used(), static_cast<std::size_t>(kStrings) * 64);
+    EXPECT_LE(pool_.bytes_used(), arena_.used());
+}
+
 }  // namespace
 }  // namespace exeray::event
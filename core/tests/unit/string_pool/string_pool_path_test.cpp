@@ -0,0 +1,164 @@
+#include "string_pool_test_common.hpp"
+
+namespace exeray::event {
+namespace {
+
+// ============================================================================
+// 12. Hierarchical Path Interning Tests
+// ============================================================================
+
+TEST_F(StringPoolTest, InternPath_RoundTrips) {
+    constexpr std::string_view kPaths[] = {
+        "\\Device\\HarddiskVolume3\\Windows\\System32\\ntdll.dll",
+        "C:/Users/alice/file.txt",
+        "\\REGISTRY\\MACHINE\\SOFTWARE\\",
+        "a\\\\b",
+        "no-separator",
+        "\\",
+    };
+    for (const auto path : kPaths) {
+        StringId id = pool_.intern_path(path);
+        ASSERT_NE(id, INVALID_STRING) << path;
+        EXPECT_EQ(pool_.get(id), path);
+    }
+}
+
+TEST_F(StringPoolTest, InternPath_Repeated_SameId) {
+    StringId first = pool_.intern_path("C:\\Windows\\System32\\kernel32.dll");
+    StringId second = pool_.intern_path("C:\\Windows\\System32\\kernel32.dll");
+
+    EXPECT_EQ(first, second);
+}
+
+TEST_F(StringPoolTest, InternPath_SharedPrefix_StoredOnce) {
+    pool_.intern_path("\\Device\\HarddiskVolume3\\Windows\\System32\\a.dll");
+    const auto count = pool_.count();
+    const auto bytes = pool_.bytes_used();
+
+    // Sibling adds one leaf string and one node only
+    pool_.intern_path("\\Device\\HarddiskVolume3\\Windows\\System32\\b.dll");
+    EXPECT_EQ(pool_.count(), count + 2);
+    EXPECT_LT(pool_.bytes_used() - bytes, 64U);
+}
+
+TEST_F(StringPoolTest, InternPath_ParentAndLeaf_Navigate) {
+    StringId file = pool_.intern_path("C:\\Windows\\notepad.exe");
+    StringId dir = pool_.intern_path("C:\\Windows\\");
+
+    EXPECT_EQ(pool_.path_parent(file), dir);
+    EXPECT_EQ(pool_.get(pool_.path_leaf(file)), "notepad.exe");
+    EXPECT_EQ(pool_.get(pool_.path_parent(dir)), "C:\\");
+    EXPECT_EQ(pool_.path_parent(pool_.path_parent(dir)), INVALID_STRING);
+}
+
+TEST_F(StringPoolTest, InternPath_IsUnder_MatchesDirectories) {
+    StringId file = pool_.intern_path("C:\\Windows\\System32\\drivers\\etc\\hosts");
+    StringId windows = pool_.intern_path("C:\\Windows\\");
+    StringId users = pool_.intern_path("C:\\Users\\");
+
+    EXPECT_TRUE(pool_.is_under(file, windows));
+    EXPECT_TRUE(pool_.is_under(windows, windows));
+    EXPECT_FALSE(pool_.is_under(file, users));
+    EXPECT_FALSE(pool_.is_under(windows, file));
+    EXPECT_FALSE(pool_.is_under(file, pool_.intern("C:\\Windows\\")));
+}
+
+TEST_F(StringPoolTest, InternPath_PlainStringWithSameText_Distinct) {
+    StringId path = pool_.intern_path("C:\\temp\\x.txt");
+    StringId plain = pool_.intern("C:\\temp\\x.txt");
+
+    EXPECT_NE(path, plain);
+    EXPECT_EQ(pool_.get(path), pool_.get(plain));
+    EXPECT_EQ(pool_.path_leaf(plain), plain);
+    EXPECT_EQ(pool_.path_parent(plain), INVALID_STRING);
+}
+
+TEST_F(StringPoolTest, InternPath_Resolve_CachedOnce) {
+    StringId id = pool_.intern_path("C:\\Program Files\\App\\app.exe");
+    const auto before = pool_.bytes_used();
+
+    std::string_view first = pool_.get(id);
+    const auto after = pool_.bytes_used();
+    EXPECT_GT(after, before);
+
+    std::string_view second = pool_.get(id);
+    EXPECT_EQ(first.data(), second.data());
+    EXPECT_EQ(pool_.bytes_used(), after);
+}
+
+TEST_F(StringPoolTest, InternPathWide_MatchesNarrow) {
+    StringId wide = pool_.intern_path_wide(L"\\REGISTRY\\MACHINE\\SOFTWARE\\Microsoft");
+    StringId narrow = pool_.intern_path("\\REGISTRY\\MACHINE\\SOFTWARE\\Microsoft");
+
+    EXPECT_EQ(wide, narrow);
+    EXPECT_EQ(pool_.get(wide), "\\REGISTRY\\MACHINE\\SOFTWARE\\Microsoft");
+}
+
+TEST_F(StringPoolTest, InternPath_Empty_PlainEmptyString) {
+    StringId id = pool_.intern_path("");
+
+    EXPECT_EQ(id, pool_.intern(""));
+    EXPECT_TRUE(pool_.get(id).empty());
+}
+
+TEST_F(StringPoolTest, InternPath_ConcurrentSameDir_ConsistentIds) {
+    constexpr int kThreads = 8;
+    constexpr int kFiles = 200;
+    std::vector<std::vector<StringId>> ids(kThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([this, &ids, t] {
+            for (int i = 0; i < kFiles; ++i) {
+                const auto path = "C:\\Windows\\Temp\\f" + std::to_string(i) + ".tmp";
+                const StringId id = pool_.intern_path(path);
+                if (pool_.get(id) != path) {
+                    ids[t].push_back(INVALID_STRING);
+                    continue;
+                }
+                ids[t].push_back(id);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int t = 1; t < kThreads; ++t) {
+        EXPECT_EQ(ids[t], ids[0]);
+    }
+    const StringId temp = pool_.intern_path("C:\\Windows\\Temp\\");
+    for (const auto id : ids[0]) {
+        ASSERT_NE(id, INVALID_STRING);
+        EXPECT_EQ(pool_.path_parent(id), temp);
+    }
+}
+
+TEST_F(StringPoolTest, InternPathBelow_MatchesFullPath) {
+    StringId key = pool_.intern_path("\\REGISTRY\\MACHINE\\SOFTWARE");
+    StringId below = pool_.intern_path_below(key, std::string_view("Microsoft\\Windows"));
+
+    EXPECT_EQ(pool_.get(below), "\\REGISTRY\\MACHINE\\SOFTWARE\\Microsoft\\Windows");
+    EXPECT_EQ(below, pool_.intern_path("\\REGISTRY\\MACHINE\\SOFTWARE\\Microsoft\\Windows"));
+    EXPECT_TRUE(pool_.is_under(below, pool_.intern_path("\\REGISTRY\\MACHINE\\")));
+}
+
+TEST_F(StringPoolTest, InternPathBelow_DirectoryAndSeparators) {
+    StringId dir = pool_.intern_path("C:\\Windows\\");
+
+    EXPECT_EQ(pool_.intern_path_below(dir, std::string_view("\\System32")),
+              pool_.intern_path("C:\\Windows\\System32"));
+    EXPECT_EQ(pool_.intern_path_below(dir, std::wstring_view(L"notepad.exe")),
+              pool_.intern_path("C:\\Windows\\notepad.exe"));
+    EXPECT_EQ(pool_.intern_path_below(dir, std::string_view("")), dir);
+}
+
+TEST_F(StringPoolTest, InternPathBelow_NotAPath_InternsRelative) {
+    StringId plain = pool_.intern("HKLM");
+
+    EXPECT_EQ(pool_.intern_path_below(plain, std::string_view("Run\\x")),
+              pool_.intern_path("Run\\x"));
+    EXPECT_EQ(pool_.intern_path_below(INVALID_STRING, std::string_view("Run")),
+              pool_.intern_path("Run"));
+}
+
+}  // namespace
+}  // namespace exeray::event
@@ -0,0 +1,95 @@
+#include "string_pool_test_common.hpp"
+
+#include "exeray/event/trigram_index.hpp"
+
+namespace exeray::event {
+namespace {
+
+// ============================================================================
+// Trigram substring index
+// ============================================================================
+
+class StringPoolTrigramTest : public StringPoolTest {
+protected:
+    StringPoolTrigramTest() { pool_.set_trigram_index(&index_); }
+
+    std::vector<StringId> search(std::string_view needle) const {
+        std::vector<StringId> found;
+        index_.search(pool_, needle, found);
+        return found;
+    }
+
+    TrigramIndex index_;
+};
+
+TEST_F(StringPoolTrigramTest, Search_FindsPlainStringsIgnoringCase) {
+    const StringId a = pool_.intern("abc.ngrok.io");
+    const StringId b = pool_.intern("NGROK-free.app");
+    pool_.intern("example.com");
+    pool_.intern_wide(L"api.NGrok.com");
+
+    const auto found = search("ngrok");
+    ASSERT_EQ(found.size(), 3u);
+    EXPECT_NE(std::find(found.begin(), found.end(), a), found.end());
+    EXPECT_NE(std::find(found.begin(), found.end(), b), found.end());
+    EXPECT_TRUE(search("nothere").empty());
+}
+
+TEST_F(StringPoolTrigramTest, Intern_EachUniqueStringIndexedOnce) {
+    pool_.intern("powershell.exe");
+    const auto postings = index_.postings();
+    for (int i = 0; i < 10; ++i) {
+        pool_.intern("powershell.exe");
+    }
+    EXPECT_EQ(index_.size(), 1u);
+    EXPECT_EQ(index_.postings(), postings);
+}
+
+TEST_F(StringPoolTrigramTest, Search_PathNodesMatchAcrossComponents) {
+    const StringId temp = pool_.intern_path("C:\\Users\\x\\AppData\\Local\\Temp\\a.exe");
+    pool_.intern_path("C:\\Users\\x\\Documents\\temperature.xlsx");
+    const auto bytes = pool_.bytes_used();
+
+    const auto found = search("\\temp\\");
+    // The Temp directory node and every node below it
+    EXPECT_NE(std::find(found.begin(), found.end(), temp), found.end());
+    for (const StringId id : found) {
+        EXPECT_TRUE(pool_.is_under(id, pool_.path_parent(temp)));
+    }
+    EXPECT_EQ(pool_.bytes_used(), bytes);  // Verification resolved no path
+}
+
+TEST_F(StringPoolTrigramTest, Candidates_IntersectTrigramLists) {
+    pool_.intern("abcdef");
+    pool_.intern("abcxyz");
+    pool_.intern("xyzdef");
+
+    EXPECT_EQ(index_.candidates("bcd").size(), 1u);
+    EXPECT_EQ(index_.candidates("abc").size(), 2u);
+    EXPECT_EQ(index_.candidates("zzz").size(), 0u);
+    EXPECT_EQ(index_.candidates("de").size(), index_.size());  // Too short to filter
+}
+
+TEST_F(StringPoolTrigramTest, Search_ShortNeedleAndLimit) {
+    for (int i = 0; i < 20; ++i) {
+        pool_.intern("item" + std::to_string(i));
+    }
+    EXPECT_EQ(search("m1").size(), 11u);  // item1, item10..item19
+
+    std::vector<StringId> found;
+    EXPECT_EQ(index_.search(pool_, "item", found, 5), 5u);
+    EXPECT_EQ(found.size(), 5u);
+}
+
+TEST_F(StringPoolTest, TrigramIndex_NotSet_NothingIndexed) {
+    TrigramIndex index;
+    pool_.intern("before");
+    pool_.set_trigram_index(&index);
+    pool_.intern("after");
+    pool_.set_trigram_index(nullptr);
+    pool_.intern("later");
+    EXPECT_EQ(index.size(), 1u);
+}
+
+}  // namespace
+}  // namespace exeray::event
@@ -0,0 +1,160 @@
+#include "string_pool_test_common.hpp"
+
+#include <random>
+
+#include "exeray/event/utf8.hpp"
+
+namespace exeray::event {
+namespace {
+
+// ============================================================================
+// 11. UTF-8 Transcoding Kernel Tests
+// ============================================================================
+
+/// Reference transcoder: one code unit at a time.
+std::string reference_utf8(std::wstring_view wstr) {
+    std::string out;
+    for (std::size_t i = 0; i < wstr.size(); ++i) {
+        const auto wc = static_cast<std::uint32_t>(wstr[i]);
+        if (wc >= 0xD800 && wc <= 0xDBFF && i + 1 < wstr.size()) {
+            const auto low = static_cast<std::uint32_t>(wstr[i + 1]);
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                const std::uint32_t cp = 0x10000 + ((wc - 0xD800) << 10) + (low - 0xDC00);
+                out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                ++i;
+                continue;
+            }
+        }
+        if (wc >= 0xD800 && wc <= 0xDFFF) {
+            out += "\xEF\xBF\xBD";
+        } else if (wc < 0x80) {
+            out.push_back(static_cast<char>(wc));
+        } else if (wc < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (wc >> 6)));
+            out.push_back(static_cast<char>(0x80 | (wc & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xE0 | (wc >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((wc >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (wc & 0x3F)));
+        }
+    }
+    return out;
+}
+
+/// Random string, mostly ASCII, with Cyrillic, CJK and (lone) surrogates.
+std::wstring random_wide(std::mt19937& rng, std::size_t length) {
+    std::wstring out;
+    for (std::size_t i = 0; i < length; ++i) {
+        switch (rng() % 16) {
+            case 0: out.push_back(static_cast<wchar_t>(0x0410 + rng() % 32)); break;
+            case 1: out.push_back(static_cast<wchar_t>(0x4E00 + rng() % 256)); break;
+            case 2: out.push_back(static_cast<wchar_t>(0xD83D)); break;
+            case 3: out.push_back(static_cast<wchar_t>(0xDE00 + rng() % 64)); break;
+            case 4: out.push_back(static_cast<wchar_t>(0x80 + rng() % 64)); break;
+            default: out.push_back(static_cast<wchar_t>(0x20 + rng() % 95)); break;
+        }
+    }
+    return out;
+}
+
+TEST(Utf8Test, Encode_Ascii_AllBlockSizes) {
+    // Lengths around every block boundary the kernels use
+    for (std::size_t length = 0; length <= 100; ++length) {
+        std::wstring wide;
+        std::string narrow;
+        for (std::size_t i = 0; i < length; ++i) {
+            wide.push_back(static_cast<wchar_t>(L'a' + i % 26));
+            narrow.push_back(static_cast<char>('a' + i % 26));
+        }
+        EXPECT_EQ(to_utf8(wide), narrow) << "length " << length;
+        EXPECT_EQ(utf8_length(wide), length);
+    }
+}
+
+TEST(Utf8Test, Encode_NonAsciiInsideBlock_FallsBack) {
+    // One non-ASCII unit at each position of a 64-unit ASCII string
+    for (std::size_t pos = 0; pos < 64; ++pos) {
+        std::wstring wide(64, L'x');
+        wide[pos] = static_cast<wchar_t>(0x00E9);
+        EXPECT_EQ(to_utf8(wide), reference_utf8(wide)) << "position " << pos;
+        EXPECT_EQ(utf8_length(wide), 65U);
+    }
+}
+
+TEST(Utf8Test, Encode_Latin1High_NotTreatedAsAscii) {
+    // 0x80-0xFF survive a saturating pack; they must still be encoded
+    std::wstring wide(40, L'a');
+    wide[20] = static_cast<wchar_t>(0xFF);
+    EXPECT_EQ(to_utf8(wide), reference_utf8(wide));
+}
+
+TEST(Utf8Test, Encode_SurrogatePairAcrossRunBoundary_Decoded) {
+    for (std::size_t pos = 0; pos < 48; ++pos) {
+        std::wstring wide(48, L'p');
+        wide.insert(pos, L"\xD83D\xDE00");
+        const std::string utf8 = to_utf8(wide);
+        EXPECT_EQ(utf8, reference_utf8(wide)) << "position " << pos;
+        EXPECT_NE(utf8.find("\xF0\x9F\x98\x80"), std::string::npos);
+    }
+}
+
+TEST(Utf8Test, Encode_RandomMixed_MatchesReference) {
+    std::mt19937 rng(42);
+    for (int round = 0; round < 2000; ++round) {
+        const std::wstring wide = random_wide(rng, rng() % 200);
+        const std::string expected = reference_utf8(wide);
+
+        std::string out(wide.size() * kMaxUtf8PerUnit, '\0');
+        const auto written = encode_utf8(wide, out.data());
+        out.resize(written);
+        ASSERT_EQ(out, expected);
+        ASSERT_EQ(utf8_length(wide), expected.size());
+    }
+}
+
+TEST(Utf8Test, Encode_Empty_WritesNothing) {
+    EXPECT_EQ(utf8_length(L""), 0U);
+    EXPECT_TRUE(to_utf8(L"").empty());
+}
+
+TEST_F(StringPoolTest, InternWide_LongMixedString_MatchesTranscode) {
+    // Longer than one stack chunk: exercises the chunked hash and compare
+    std::mt19937 rng(7);
+    const std::wstring wide = random_wide(rng, 5000);
+    const std::string utf8 = to_utf8(wide);
+
+    StringId id = pool_.intern_wide(wide);
+    ASSERT_NE(id, INVALID_STRING);
+    EXPECT_EQ(pool_.get(id), utf8);
+    EXPECT_EQ(pool_.intern(utf8), id);
+    EXPECT_EQ(pool_.intern_wide(wide), id);
+    EXPECT_EQ(pool_.count(), 1U);
+}
+
+TEST_F(StringPoolTest, InternWide_LongStringsDifferAtEnd_DistinctIds) {
+    std::wstring a(3000, L'A');
+    std::wstring b = a;
+    b.back() = L'B';
+
+    StringId ida = pool_.intern_wide(a);
+    StringId idb = pool_.intern_wide(b);
+    EXPECT_NE(ida, idb);
+    EXPECT_EQ(pool_.get(idb).back(), 'B');
+}
+
+TEST_F(StringPoolTest, InternWide_PairOnChunkBoundary_Decoded) {
+    // Surrogate pair straddling the 512-unit stack chunk
+    std::wstring wide(511, L'c');
+    wide += L"\xD83D\xDE00";
+    wide += std::wstring(600, L'd');
+
+    StringId id = pool_.intern_wide(wide);
+    EXPECT_EQ(pool_.get(id), reference_utf8(wide));
+    EXPECT_EQ(pool_.intern(reference_utf8(wide)), id);
+}
+
+}  // namespace
+}  // namespace exeray::event
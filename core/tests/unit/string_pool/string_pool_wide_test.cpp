@@ -78,5 +78,44 @@ TEST_F(StringPoolTest, InternWide_Empty_ValidId) {
     EXPECT_TRUE(pool_.get(id).empty());
 }
 
+TEST_F(StringPoolTest, InternWide_MatchesNarrowIntern_SameId) {
+    StringId narrow = pool_.intern("C:\\Windows\\explorer.exe");
+    StringId wide = pool_.intern_wide(L"C:\\Windows\\explorer.exe");
+
+    EXPECT_EQ(narrow, wide);
+}
+
+TEST_F(StringPoolTest, InternWide_NarrowAfterWide_SameId) {
+    // "Привет" and U+1F600 as UTF-8
+    StringId wide = pool_.intern_wide(L"\u041F\u0440\u0438\u0432\u0435\u0442 \xD83D\xDE00");
+    StringId narrow = pool_.intern(
+        "\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82 \xF0\x9F\x98\x80");
+
+    EXPECT_EQ(wide, narrow);
+}
+
+TEST_F(StringPoolTest, InternWide_Repeated_NoNewStorage) {
+    StringId first = pool_.intern_wide(L"HKLM\\SOFTWARE\\Microsoft\\Windows");
+    const auto bytes = pool_.bytes_used();
+    const auto used = arena_.used();
+
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(pool_.intern_wide(L"HKLM\\SOFTWARE\\Microsoft\\Windows"), first);
+    }
+    EXPECT_EQ(pool_.bytes_used(), bytes);
+    EXPECT_EQ(arena_.used(), used);
+    EXPECT_EQ(pool_.count(), 1U);
+}
+
+TEST_F(StringPoolTest, InternWide_SharedPrefix_DistinctIds) {
+    // Same length and leading word; differ only in the UTF-8 tail
+    StringId a = pool_.intern_wide(L"prefix-\u00E9");
+    StringId b = pool_.intern_wide(L"prefix-\u00E8");
+
+    EXPECT_NE(a, b);
+    EXPECT_EQ(pool_.get(a), "prefix-\xC3\xA9");
+    EXPECT_EQ(pool_.get(b), "prefix-\xC3\xA8");
+}
+
 }  // namespace
 }  // namespace exeray::event
@@ -0,0 +1,85 @@
+/// @file async_task_test.cpp
+/// @brief Tests for the coroutine task type and resume_on().
+
+#include <gtest/gtest.h>
+
+#include "exeray/async_task.hpp"
+#include "exeray/thread_pool.hpp"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace exeray {
+namespace {
+
+AsyncTask<int> answer() {
+    co_return 42;
+}
+
+AsyncTask<std::string> describe() {
+    const int value = co_await answer();
+    co_return "value " + std::to_string(value);
+}
+
+AsyncTask<std::thread::id> worker_id(ThreadPool& pool) {
+    co_await resume_on(pool);
+    co_return std::this_thread::get_id();
+}
+
+AsyncTask<int> sum_on_pool(ThreadPool& pool, int n) {
+    int total = 0;
+    for (int i = 1; i <= n; ++i) {
+        co_await resume_on(pool);
+        total += co_await answer() - 41;  // 1 per step
+    }
+    co_return total;
+}
+
+AsyncTask<void> set_flag(std::atomic<bool>& flag) {
+    flag.store(true);
+    co_return;
+}
+
+TEST(AsyncTaskTest, Get_RunsToCompletion) {
+    EXPECT_EQ(answer().get(), 42);
+    EXPECT_EQ(describe().get(), "value 42");
+}
+
+TEST(AsyncTaskTest, Lazy_BodyRunsOnlyWhenStarted) {
+    std::atomic<bool> flag{false};
+    {
+        auto task = set_flag(flag);
+        EXPECT_FALSE(flag.load());
+    }  // Destroyed unstarted
+    EXPECT_FALSE(flag.load());
+    set_flag(flag).get();
+    EXPECT_TRUE(flag.load());
+}
+
+TEST(AsyncTaskTest, ResumeOn_MovesToPoolWorker) {
+    ThreadPool pool(2);
+    EXPECT_NE(worker_id(pool).get(), std::this_thread::get_id());
+    EXPECT_EQ(sum_on_pool(pool, 1000).get(), 1000);
+}
+
+TEST(AsyncTaskTest, MoveOnlyResult) {
+    auto make = []() -> AsyncTask<std::unique_ptr<int>> { co_return std::make_unique<int>(5); };
+    EXPECT_EQ(*make().get(), 5);
+}
+
+TEST(AsyncTaskTest, ToHandle_BridgesToTaskHandle) {
+    ThreadPool pool(2);
+    auto handle = to_handle(sum_on_pool(pool, 10));
+    auto doubled = handle.then(pool, [](int& x) { return x * 2; });
+    EXPECT_EQ(doubled.get(), 20);
+    EXPECT_EQ(handle.get(), 10);
+
+    std::atomic<bool> flag{false};
+    to_handle(set_flag(flag)).wait();
+    EXPECT_TRUE(flag.load());
+}
+
+}  // namespace
+}  // namespace exeray
@@ -0,0 +1,116 @@
+/// @file pipeline_test.cpp
+/// @brief Tests for pool stages connected by bounded queues.
+
+#include <gtest/gtest.h>
+
+#include "exeray/pipeline.hpp"
+#include "exeray/thread_pool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace exeray {
+namespace {
+
+TEST(PipelineTest, StagesRunInOrder) {
+    ThreadPool pool(4);
+    std::vector<std::string> out;
+    {
+        auto pipeline = PipelineBuilder<int>(pool, 8)
+                            .stage([](int&& x) { return x * 2; })
+                            .stage([](int&& x) -> std::optional<int> {
+                                if (x % 3 == 0) {
+                                    return std::nullopt;  // Dropped
+                                }
+                                return x;
+                            })
+                            .stage([](int&& x) { return std::to_string(x); })
+                            .sink([&out](std::string&& s) { out.push_back(std::move(s)); });
+        for (int i = 0; i < 1000; ++i) {
+            EXPECT_TRUE(pipeline.push(i));
+        }
+        pipeline.close();
+        pipeline.done().wait();
+        EXPECT_FALSE(pipeline.push(1000));  // Closed
+    }
+
+    std::vector<std::string> expected;
+    for (int i = 0; i < 1000; ++i) {
+        if ((i * 2) % 3 != 0) {
+            expected.push_back(std::to_string(i * 2));
+        }
+    }
+    EXPECT_EQ(out, expected);
+}
+
+TEST(PipelineTest, BoundedQueues_ApplyBackpressure) {
+    ThreadPool pool(2);
+    std::atomic<bool> release{false};
+    std::atomic<int> consumed{0};
+    auto pipeline = PipelineBuilder<int>(pool, 4)
+                        .stage([](int&& x) { return x; })
+                        .sink([&](int&&) {
+                            while (!release.load()) {
+                                std::this_thread::yield();
+                            }
+                            consumed.fetch_add(1);
+                        });
+
+    // The sink holds one item, each queue holds four, the stage holds one
+    // result: everything else must be refused
+    int accepted = 0;
+    for (int i = 0; i < 100; ++i) {
+        int item = i;
+        if (pipeline.try_push(item)) {
+            ++accepted;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    EXPECT_LE(accepted, 4 + 1 + 4 + 1);
+    EXPECT_GE(accepted, 4);
+
+    release.store(true);
+    pipeline.close();
+    pipeline.done().wait();
+    EXPECT_EQ(consumed.load(), accepted);
+}
+
+TEST(PipelineTest, ConcurrentProducersAndMoveOnlyItems) {
+    ThreadPool pool(4);
+    std::atomic<long> sum{0};
+    {
+        auto pipeline = PipelineBuilder<std::unique_ptr<int>>(pool, 16)
+                            .stage([](std::unique_ptr<int>&& p) { return *p; })
+                            .sink([&sum](int&& x) { sum.fetch_add(x); });
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 4; ++t) {
+            producers.emplace_back([&pipeline] {
+                for (int i = 1; i <= 500; ++i) {
+                    pipeline.push(std::make_unique<int>(i));
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+    }  // The destructor closes and drains
+    EXPECT_EQ(sum.load(), 4L * 500 * 501 / 2);
+}
+
+TEST(PipelineTest, SinkOnly_CloseWithoutItems) {
+    ThreadPool pool(1);
+    int seen = 0;
+    auto pipeline = PipelineBuilder<int>(pool, 2).sink([&seen](int&&) { ++seen; });
+    pipeline.close();
+    pipeline.done().wait();
+    EXPECT_EQ(seen, 0);
+    EXPECT_EQ(pipeline.depth(), 0u);
+}
+
+}  // namespace
+}  // namespace exeray
@@ -0,0 +1,110 @@
+/// @file task_graph_test.cpp
+/// @brief Tests for task handles, continuations and when_all().
+
+#include <gtest/gtest.h>
+
+#include "exeray/task_graph.hpp"
+#include "exeray/thread_pool.hpp"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace exeray {
+namespace {
+
+TEST(TaskGraphTest, Spawn_ReturnsResult) {
+    ThreadPool pool(2);
+    auto answer = spawn(pool, [] { return 42; });
+    EXPECT_EQ(answer.get(), 42);
+    EXPECT_TRUE(answer.ready());
+
+    std::atomic<bool> ran{false};
+    auto done = spawn(pool, [&ran] { ran.store(true); });
+    done.wait();
+    EXPECT_TRUE(ran.load());
+    EXPECT_FALSE(TaskHandle<int>{}.valid());
+}
+
+TEST(TaskGraphTest, Then_ChainsOnThePool) {
+    ThreadPool pool(2);
+    auto text = spawn(pool, [] { return 20; })
+                    .then(pool, [](int& x) { return x + 1; })
+                    .then(pool, [](int& x) { return std::to_string(x * 2); });
+    EXPECT_EQ(text.get(), "42");
+
+    std::atomic<int> steps{0};
+    auto chained = spawn(pool, [&steps] { steps.fetch_add(1); }).then(pool, [&steps] {
+        return steps.fetch_add(1) + 1;
+    });
+    EXPECT_EQ(chained.get(), 2);
+}
+
+TEST(TaskGraphTest, Then_OnFinishedHandleStillRuns) {
+    ThreadPool pool(1);
+    auto first = spawn(pool, [] { return 1; });
+    first.wait();
+    EXPECT_EQ(first.then(pool, [](int& x) { return x + 1; }).get(), 2);
+}
+
+TEST(TaskGraphTest, MoveOnlyResultsAndCaptures) {
+    ThreadPool pool(2);
+    auto owned = std::make_unique<int>(7);
+    auto handle = spawn(pool, [owned = std::move(owned)]() mutable { return std::move(owned); });
+    EXPECT_EQ(*handle.get(), 7);
+    auto moved = handle.then(pool, [](std::unique_ptr<int>& p) { return *p + 1; });
+    EXPECT_EQ(moved.get(), 8);
+}
+
+TEST(TaskGraphTest, Promise_CompletesHandleOnce) {
+    ThreadPool pool(1);
+    TaskPromise<int> promise;
+    auto handle = promise.handle();
+    auto doubled = handle.then(pool, [](int& x) { return x * 2; });
+    EXPECT_FALSE(handle.ready());
+    promise.set_value(5);
+    promise.set_value(9);  // Ignored
+    EXPECT_EQ(handle.get(), 5);
+    EXPECT_EQ(doubled.get(), 10);
+}
+
+TEST(TaskGraphTest, WhenAll_WaitsForEveryHandle) {
+    ThreadPool pool(4);
+    std::atomic<int> sum{0};
+    std::vector<TaskHandle<int>> parts;
+    for (int i = 1; i <= 100; ++i) {
+        parts.push_back(spawn(pool, [i, &sum] {
+            sum.fetch_add(i);
+            return i;
+        }));
+    }
+    auto total = when_all(parts).then(pool, [&parts] {
+        int result = 0;
+        for (auto& part : parts) {
+            result += part.get();
+        }
+        return result;
+    });
+    EXPECT_EQ(total.get(), 5050);
+    EXPECT_EQ(sum.load(), 5050);
+
+    EXPECT_TRUE(when_all(std::vector<TaskHandle<int>>{}).ready());
+}
+
+TEST(TaskGraphTest, WhenAll_MixedTypes) {
+    ThreadPool pool(2);
+    TaskPromise<std::string> late;
+    auto number = spawn(pool, [] { return 3; });
+    auto nothing = spawn(pool, [] {});
+    auto joined = when_all(number, nothing, late.handle());
+    number.wait();
+    nothing.wait();
+    EXPECT_FALSE(joined.ready());
+    late.set_value("done");
+    joined.wait();
+    EXPECT_EQ(late.handle().get(), "done");
+}
+
+}  // namespace
+}  // namespace exeray
@@ -0,0 +1,157 @@
+/// @file thread_pool_test.cpp
+/// @brief Tests for the work-stealing thread pool and its task type.
+
+#include <gtest/gtest.h>
+
+#include "exeray/thread_pool.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace exeray {
+namespace {
+
+TEST(TaskTest, StoresSmallAndLargeCallables) {
+    int calls = 0;
+    Task small([&calls] { ++calls; });
+    std::array<std::size_t, 32> big{};
+    big[31] = 5;
+    Task large([&calls, big] { calls += static_cast<int>(big[31]); });
+
+    small();
+    large();
+    EXPECT_EQ(calls, 6);
+
+    Task moved = std::move(large);
+    EXPECT_FALSE(static_cast<bool>(large));  // NOLINT(bugprone-use-after-move)
+    moved();
+    EXPECT_EQ(calls, 11);
+    EXPECT_FALSE(static_cast<bool>(Task{}));
+}
+
+TEST(TaskTest, DestroysCapturesOnce) {
+    auto shared = std::make_shared<int>(0);
+    {
+        Task task([shared] { ++*shared; });
+        Task other = std::move(task);
+        other = Task([shared] { ++*shared; });
+        EXPECT_EQ(shared.use_count(), 2);
+        other();
+    }
+    EXPECT_EQ(shared.use_count(), 1);
+    EXPECT_EQ(*shared, 1);
+}
+
+TEST(ThreadPoolTest, RunsEveryTask) {
+    std::atomic<int> done{0};
+    {
+        ThreadPool pool(4);
+        EXPECT_EQ(pool.size(), 4u);
+        for (int i = 0; i < 10000; ++i) {
+            pool.submit([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+        }
+    }  // The destructor drains what is still queued
+    EXPECT_EQ(done.load(), 10000);
+}
+
+TEST(ThreadPoolTest, AcceptsStdFunctionAndMoveOnlyCaptures) {
+    std::atomic<int> sum{0};
+    {
+        ThreadPool pool(2);
+        std::function<void()> fn = [&sum] { sum.fetch_add(1); };
+        pool.submit(fn);
+        auto value = std::make_unique<int>(41);
+        pool.submit([&sum, value = std::move(value)] { sum.fetch_add(*value); });
+        pool.submit(ThreadPool::Task{});  // Ignored
+    }
+    EXPECT_EQ(sum.load(), 42);
+}
+
+TEST(ThreadPoolTest, NestedSubmitsOverflowTheDeque) {
+    std::atomic<std::size_t> done{0};
+    constexpr std::size_t kChildren = ThreadPool::kDequeCapacity * 3;
+    {
+        ThreadPool pool(3);
+        pool.submit([&pool, &done] {
+            for (std::size_t i = 0; i < kChildren; ++i) {
+                pool.submit([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+            }
+        });
+    }
+    EXPECT_EQ(done.load(), kChildren);
+}
+
+TEST(ThreadPoolTest, IdleWorkersStealFromABusyOne) {
+    ThreadPool pool(4);
+    std::atomic<int> started{0};
+    std::atomic<bool> release{false};
+
+    // One worker fans out tasks that block until all four run at once
+    pool.submit([&] {
+        for (std::size_t i = 0; i < 4; ++i) {
+            pool.submit([&] {
+                started.fetch_add(1);
+                while (started.load() < 4 && !release.load()) {
+                    std::this_thread::yield();
+                }
+            });
+        }
+    });
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (started.load() < 4 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    release.store(true);
+    EXPECT_EQ(started.load(), 4);
+}
+
+TEST(ThreadPoolTest, ManyExternalSubmitters) {
+    std::atomic<int> done{0};
+    {
+        ThreadPool pool(4);
+        std::vector<std::thread> submitters;
+        for (int t = 0; t < 4; ++t) {
+            submitters.emplace_back([&pool, &done] {
+                for (int i = 0; i < 2000; ++i) {
+                    pool.submit([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+                    if (i % 500 == 0) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));  // Let workers sleep
+                    }
+                }
+            });
+        }
+        for (auto& submitter : submitters) {
+            submitter.join();
+        }
+    }
+    EXPECT_EQ(done.load(), 8000);
+}
+
+TEST(ThreadPoolTest, Placement_PinsEveryWorker) {
+    const auto topology = platform::cpu_topology();
+    std::atomic<int> done{0};
+    {
+        ThreadPool pool(0, platform::PoolPlacement::Compact);
+        EXPECT_EQ(pool.size(), topology.cpus.size());
+        for (std::size_t i = 0; i < pool.size(); ++i) {
+            ASSERT_EQ(pool.worker_cores(i).size(), 1u);
+            EXPECT_NE(topology.find(pool.worker_cores(i).front()), nullptr);
+        }
+        for (int i = 0; i < 1000; ++i) {
+            pool.submit([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+        }
+    }
+    EXPECT_EQ(done.load(), 1000);
+
+    const ThreadPool unpinned(3);
+    EXPECT_TRUE(unpinned.worker_cores(2).empty());
+}
+
+}  // namespace
+}  // namespace exeray
@@ -0,0 +1,121 @@
+/// @file trace_spans_test.cpp
+/// @brief Tests for the per-thread span rings and their Chrome trace dump.
+
+#include <gtest/gtest.h>
+
+#include "exeray/trace_spans.hpp"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace exeray {
+namespace {
+
+/// Resets the process-wide trace around each test.
+class SpanTraceTest : public ::testing::Test {
+protected:
+    void SetUp() override { trace_.reset(); }
+    void TearDown() override { trace_.reset(); }
+
+    SpanTrace& trace_ = SpanTrace::global();
+};
+
+std::size_t count_of(const std::string& text, const std::string& needle) {
+    std::size_t count = 0;
+    for (auto at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1)) {
+        ++count;
+    }
+    return count;
+}
+
+TEST_F(SpanTraceTest, Record_SnapshotOldestFirst) {
+    trace_.record(SpanKind::Push, 300, 7);
+    trace_.record(SpanKind::Parse, 100, 5);
+    trace_.record(SpanKind::Correlate, 200, 6);
+
+    const std::vector<SpanRecord> spans = trace_.snapshot();
+    ASSERT_EQ(spans.size(), 3U);
+    EXPECT_EQ(spans[0].kind, SpanKind::Parse);
+    EXPECT_EQ(spans[0].start, 100U);
+    EXPECT_EQ(spans[0].cycles, 5U);
+    EXPECT_EQ(spans[1].kind, SpanKind::Correlate);
+    EXPECT_EQ(spans[2].kind, SpanKind::Push);
+    EXPECT_EQ(spans[0].thread, spans[2].thread);
+    EXPECT_EQ(trace_.recorded(), 3U);
+}
+
+TEST_F(SpanTraceTest, FullRing_KeepsNewest) {
+    const std::uint64_t total = SpanTrace::kRingRecords + 10;
+    for (std::uint64_t i = 0; i < total; ++i) {
+        trace_.record(SpanKind::Intern, i, 1);
+    }
+    const std::vector<SpanRecord> spans = trace_.snapshot();
+    ASSERT_EQ(spans.size(), SpanTrace::kRingRecords - 1);
+    EXPECT_EQ(spans.front().start, 11U);
+    EXPECT_EQ(spans.back().start, total - 1);
+    EXPECT_EQ(trace_.recorded(), total);
+}
+
+TEST_F(SpanTraceTest, Threads_OwnRings) {
+    trace_.record(SpanKind::Parse, 1, 1);
+    std::thread other([this] { trace_.record(SpanKind::Detect, 2, 1); });
+    other.join();
+
+    const std::vector<SpanRecord> spans = trace_.snapshot();
+    ASSERT_EQ(spans.size(), 2U);
+    EXPECT_NE(spans[0].thread, spans[1].thread);
+}
+
+TEST_F(SpanTraceTest, Reset_DropsSpans) {
+    trace_.record(SpanKind::Parse, 1, 1);
+    trace_.reset();
+    EXPECT_TRUE(trace_.snapshot().empty());
+    EXPECT_EQ(trace_.recorded(), 0U);
+}
+
+TEST_F(SpanTraceTest, ChromeTrace_OneCompleteEventPerSpan) {
+    trace_.record(SpanKind::Parse, 1000, 10);
+    trace_.record(SpanKind::Push, 2000, 20);
+
+    std::ostringstream out;
+    ASSERT_TRUE(trace_.write_chrome_trace(out));
+    const std::string json = out.str();
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0), 0U);
+    EXPECT_EQ(count_of(json, "\"ph\":\"X\""), 2U);
+    EXPECT_EQ(count_of(json, "\"name\":\"parse\""), 1U);
+    EXPECT_EQ(count_of(json, "\"name\":\"push\""), 1U);
+    EXPECT_NE(json.find("\"ts\":0.000"), std::string::npos);  // Relative to the oldest
+    EXPECT_EQ(json.substr(json.size() - 4), "\n]}\n");
+}
+
+TEST_F(SpanTraceTest, ChromeTrace_EmptyIsValid) {
+    std::ostringstream out;
+    ASSERT_TRUE(trace_.write_chrome_trace(out));
+    EXPECT_EQ(out.str(), "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n]}\n");
+}
+
+TEST_F(SpanTraceTest, Macro_RecordsOnlyWhenCompiledIn) {
+    {
+        EXERAY_SPAN(Correlate);
+        EXERAY_SPAN(Push);  // Two in one scope get distinct names
+    }
+    const std::vector<SpanRecord> spans = trace_.snapshot();
+    ASSERT_EQ(spans.size(), kSpansEnabled ? 2U : 0U);
+    if (kSpansEnabled) {
+        EXPECT_NE(spans[0].kind, spans[1].kind);
+    }
+}
+
+TEST(SpanNameTest, Names) {
+    EXPECT_EQ(span_name(SpanKind::Parse), "parse");
+    EXPECT_EQ(span_name(SpanKind::Intern), "intern");
+    EXPECT_EQ(span_name(SpanKind::Detect), "detect");
+    EXPECT_EQ(span_name(SpanKind::Correlate), "correlate");
+    EXPECT_EQ(span_name(SpanKind::Push), "push");
+}
+
+}  // namespace
+}  // namespace exeray
@@ -0,0 +1,50 @@
+//! Events turning Suspicious, delivered apart from the bulk event stream.
+
+use cxx::{ExternType, type_id};
+
+use crate::engine::events::category_from_u8;
+use crate::ffi::Category;
+
+/// One event that turned Suspicious, popped by `Engine::pop_alerts`.
+///
+/// Mirrors `exeray::event::Alert`; the payload is one
+/// `Engine::segment_view(id - 1)` away.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct AlertRecord {
+    pub id: u64,
+    pub timestamp: u64,
+    pub pid: u32,
+    category: u8,
+    pub operation: u8,
+    late: u8,
+    reserved: u8,
+}
+
+impl AlertRecord {
+    /// Event category.
+    pub fn category(&self) -> Category {
+        category_from_u8(self.category)
+    }
+
+    /// Whether the event was flagged after it was pushed, by a detector
+    /// that looked at it later.
+    pub fn late(&self) -> bool {
+        self.late != 0
+    }
+}
+
+const _: () = {
+    assert!(std::mem::size_of::<AlertRecord>() == 24);
+    assert!(std::mem::offset_of!(AlertRecord, pid) == 16);
+    assert!(std::mem::offset_of!(AlertRecord, category) == 20);
+    assert!(std::mem::offset_of!(AlertRecord, late) == 22);
+};
+
+// SAFETY: AlertRecord has the #[repr(C)] layout of exeray::event::Alert
+// (checked on both sides), and every bit pattern is valid (the category is
+// kept as a raw u8).
+unsafe impl ExternType for AlertRecord {
+    type Id = type_id!("exeray::AlertRecord");
+    type Kind = cxx::kind::Trivial;
+}
@@ -0,0 +1,29 @@
+//! Alert channel methods for the Engine.
+
+use std::time::Duration;
+
+use super::Engine;
+use crate::alert::AlertRecord;
+
+impl Engine {
+    /// Block until an event turns Suspicious or `timeout` passes.
+    ///
+    /// Returns whether alerts are waiting; stopping monitoring wakes it early.
+    pub fn wait_for_alerts(&mut self, timeout: Duration) -> bool {
+        let timeout_ms = timeout.as_millis().min(u32::MAX as u128) as u32;
+        self.0.pin_mut().wait_for_alerts(timeout_ms)
+    }
+
+    /// Pop up to `max` queued alerts, oldest first.
+    pub fn pop_alerts(&mut self, max: usize) -> Vec<AlertRecord> {
+        let mut alerts = vec![AlertRecord::default(); max];
+        let n = self.pop_alerts_into(&mut alerts);
+        alerts.truncate(n);
+        alerts
+    }
+
+    /// Pop queued alerts into `out`; the number written.
+    pub fn pop_alerts_into(&mut self, out: &mut [AlertRecord]) -> usize {
+        self.0.pin_mut().pop_alerts(out)
+    }
+}
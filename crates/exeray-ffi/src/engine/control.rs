@@ -1,6 +1,8 @@
 //! Target process control methods for the Engine.
 
 use super::Engine;
+use crate::ffi;
+use crate::target_usage::TargetUsage;
 
 impl Engine {
     /// Freeze (suspend) the target process.
@@ -18,6 +20,22 @@ impl Engine {
         self.0.pin_mut().kill_target();
     }
 
+    /// Query the CPU time, I/O and peak memory of the launched targets.
+    pub fn target_usage(&mut self) -> TargetUsage {
+        self.0.pin_mut().refresh_target_usage();
+        let handle = &self.0;
+        TargetUsage {
+            user_ns: ffi::target_usage_user_ns(handle),
+            kernel_ns: ffi::target_usage_kernel_ns(handle),
+            read_bytes: ffi::target_usage_read_bytes(handle),
+            write_bytes: ffi::target_usage_write_bytes(handle),
+            other_bytes: ffi::target_usage_other_bytes(handle),
+            peak_process_memory: ffi::target_usage_peak_process_memory(handle),
+            peak_job_memory: ffi::target_usage_peak_job_memory(handle),
+            active_processes: ffi::target_usage_active_processes(handle),
+        }
+    }
+
     /// Get the target process ID.
     ///
     /// Returns 0 if not currently monitoring a process.
@@ -1,15 +1,18 @@
 //! Event access methods for the Engine.
 
 use super::Engine;
-use crate::event::Event;
-use crate::event_iter::EventIter;
+use crate::event::{Event, EventRecord};
+use crate::event_iter::{EventIter, ITER_BATCH};
 use crate::ffi::{self, Category, Status};
+use crate::node::{NodeSegments, SegmentView};
+use crate::wall_clock::WallClock;
+use std::time::Duration;
 
 /// Convert a raw u8 to Category using exhaustive match.
 ///
 /// This ensures compile-time safety: if the CXX enum definition changes,
 /// this function will fail to compile until updated.
-fn category_from_u8(val: u8) -> Category {
+pub(crate) fn category_from_u8(val: u8) -> Category {
     match val {
         0 => Category::FileSystem,
         1 => Category::Registry,
@@ -27,6 +30,7 @@ fn category_from_u8(val: u8) -> Category {
         13 => Category::Service,
         14 => Category::Wmi,
         15 => Category::Clr,
+        16 => Category::Manifest,
         // Unknown values default to FileSystem to avoid panics.
         // C++ side guarantees valid values; this is a safety fallback.
         _ => Category::FileSystem,
@@ -37,7 +41,7 @@ fn category_from_u8(val: u8) -> Category {
 ///
 /// This ensures compile-time safety: if the CXX enum definition changes,
 /// this function will fail to compile until updated.
-fn status_from_u8(val: u8) -> Status {
+pub(crate) fn status_from_u8(val: u8) -> Status {
     match val {
         0 => Status::Success,
         1 => Status::Denied,
@@ -50,17 +54,46 @@ fn status_from_u8(val: u8) -> Status {
     }
 }
 
+impl From<EventRecord> for Event {
+    fn from(record: EventRecord) -> Self {
+        Event {
+            id: record.id,
+            parent_id: record.parent_id,
+            timestamp: record.timestamp,
+            category: category_from_u8(record.category),
+            status: status_from_u8(record.status),
+            operation: record.operation,
+        }
+    }
+}
+
 impl Engine {
-    /// Get the current event count.
+    /// Get the current number of live events.
     pub fn event_count(&self) -> usize {
         ffi::event_count(&self.0)
     }
 
-    /// Get an event by index.
+    /// Get the absolute index of the oldest live event.
+    ///
+    /// Always 0 unless the graph runs in ring retention mode and has
+    /// recycled older events.
+    pub fn first_event_index(&self) -> usize {
+        ffi::event_first_index(&self.0)
+    }
+
+    /// Get the eviction epoch.
+    ///
+    /// Changes whenever older events are evicted, so cached indexes below
+    /// `first_event_index()` must be considered gone.
+    pub fn event_epoch(&self) -> u64 {
+        ffi::event_epoch(&self.0)
+    }
+
+    /// Get an event by absolute index (`EventId - 1`).
     ///
-    /// Returns `None` if the index is out of bounds.
+    /// Returns `None` if the index is out of bounds or has been evicted.
     pub fn get_event(&self, index: usize) -> Option<Event> {
-        if index >= self.event_count() {
+        if !ffi::event_exists(&self.0, index) {
             return None;
         }
 
@@ -74,12 +107,87 @@ impl Engine {
         })
     }
 
-    /// Iterate over all events.
+    /// Anchor mapping event timestamps to Unix-epoch nanoseconds.
+    ///
+    /// Fixed for a session; take it once and convert with
+    /// `WallClock::to_unix`. Replayed trace files map to the time they
+    /// were recorded.
+    pub fn wall_clock(&self) -> WallClock {
+        self.0.wall_clock()
+    }
+
+    /// Event time as Unix-epoch nanoseconds, or 0 if unknown.
+    pub fn event_wall_time(&self, index: usize) -> u64 {
+        ffi::event_get_wall_time(&self.0, index)
+    }
+
+    /// Copy the run of events starting at absolute index `index` into `out`.
+    ///
+    /// One FFI call for the whole slice. Stops early at the newest event
+    /// or one not yet published. An index that was evicted starts at the
+    /// oldest live event, so check the returned IDs. Returns the number of
+    /// records written.
+    pub fn copy_events(&self, index: usize, out: &mut [EventRecord]) -> usize {
+        ffi::event_copy_run(&self.0, index, out)
+    }
+
+    /// Fetch up to `max` events published after `cursor`.
+    ///
+    /// `cursor` is the ID of the last event already seen (0 for none).
+    /// Returns the new events and the cursor for the next call, so each
+    /// call only costs the delta. Events evicted before they were fetched
+    /// are skipped; a cursor past the newest event (the session was reset)
+    /// starts over at the oldest.
+    pub fn events_since(&self, cursor: u64, max: usize) -> (Vec<Event>, u64) {
+        let end = (self.first_event_index() + self.event_count()) as u64;
+        let cursor = if cursor > end { 0 } else { cursor };
+        let want = max.min((end - cursor) as usize);
+        if want == 0 {
+            return (Vec::new(), cursor);
+        }
+        let mut records = vec![EventRecord::default(); want];
+        let len = self.copy_events(cursor as usize, &mut records);
+        let next = if len > 0 { records[len - 1].id } else { cursor };
+        (records[..len].iter().copied().map(Event::from).collect(), next)
+    }
+
+    /// Block until events newer than `cursor` exist, for at most `timeout`.
+    ///
+    /// Returns true if there are, false on timeout or when the session
+    /// stopped. Lets a UI thread sleep until there is something to render
+    /// instead of polling `event_count`.
+    pub fn wait_for_events(&mut self, cursor: u64, timeout: Duration) -> bool {
+        let timeout_ms = timeout.as_millis().min(u32::MAX as u128) as u32;
+        self.0.pin_mut().wait_for_events(cursor, timeout_ms) > cursor
+    }
+
+    /// Borrow the published nodes from absolute index `index` to the end of
+    /// their segment, without copying.
+    ///
+    /// An evicted index starts at the oldest live event; the view is empty
+    /// if nothing is published there yet.
+    pub fn segment_view(&self, index: usize) -> SegmentView<'_> {
+        SegmentView::new(self, ffi::event_segment_span(&self.0, index))
+    }
+
+    /// Iterate over the live events segment by segment, in place.
+    pub fn node_segments(&self) -> NodeSegments<'_> {
+        NodeSegments { engine: self, index: self.first_event_index() }
+    }
+
+    /// Iterate over all live events.
+    ///
+    /// Events are fetched `ITER_BATCH` at a time through `copy_events`.
     pub fn iter_events(&self) -> EventIter<'_> {
+        let first = self.first_event_index();
         EventIter {
             engine: self,
-            index: 0,
-            count: self.event_count(),
+            index: first,
+            count: first + self.event_count(),
+            epoch: self.event_epoch(),
+            buffer: vec![EventRecord::default(); ITER_BATCH],
+            pos: 0,
+            len: 0,
         }
     }
 }
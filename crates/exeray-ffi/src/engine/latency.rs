@@ -0,0 +1,30 @@
+//! Ingest latency methods for the Engine.
+
+use super::Engine;
+use crate::ffi::{self, Category};
+use crate::latency::{LatencyStage, LatencySummary};
+
+/// Category selector for all categories.
+const ALL_CATEGORIES: u8 = 17;
+
+impl Engine {
+    /// Get event age percentiles of one category in the current or last session.
+    pub fn ingest_latency(&self, stage: LatencyStage, category: Category) -> LatencySummary {
+        self.latency_summary(stage as u8, category.repr)
+    }
+
+    /// Get event age percentiles over all categories.
+    pub fn ingest_latency_all(&self, stage: LatencyStage) -> LatencySummary {
+        self.latency_summary(stage as u8, ALL_CATEGORIES)
+    }
+
+    fn latency_summary(&self, stage: u8, category: u8) -> LatencySummary {
+        LatencySummary {
+            count: ffi::latency_count(&self.0, stage, category),
+            p50: ffi::latency_p50(&self.0, stage, category),
+            p99: ffi::latency_p99(&self.0, stage, category),
+            p999: ffi::latency_p999(&self.0, stage, category),
+            max: ffi::latency_max(&self.0, stage, category),
+        }
+    }
+}
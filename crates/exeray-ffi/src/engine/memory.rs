@@ -0,0 +1,36 @@
+//! Memory statistics methods for the Engine.
+
+use super::Engine;
+use crate::ffi;
+use crate::memory::{ArenaKind, ArenaUsage, MemoryStats};
+
+impl Engine {
+    /// Get the usage counters of one arena.
+    pub fn arena_usage(&self, arena: ArenaKind) -> ArenaUsage {
+        let kind = arena as u8;
+        ArenaUsage {
+            used: ffi::memory_arena_used(&self.0, kind),
+            committed: ffi::memory_arena_committed(&self.0, kind),
+            reserved: ffi::memory_arena_reserved(&self.0, kind),
+            capacity: ffi::memory_arena_capacity(&self.0, kind),
+            high_water: ffi::memory_arena_high_water(&self.0, kind),
+            padding: ffi::memory_arena_padding(&self.0, kind),
+            failures: ffi::memory_arena_failures(&self.0, kind),
+        }
+    }
+
+    /// Get memory usage of every arena and what occupies it.
+    pub fn memory_stats(&self) -> MemoryStats {
+        MemoryStats {
+            events: self.arena_usage(ArenaKind::Events),
+            strings: self.arena_usage(ArenaKind::Strings),
+            scratch: self.arena_usage(ArenaKind::Scratch),
+            strings_shared: ffi::memory_strings_shared(&self.0),
+            event_bytes: ffi::memory_event_bytes(&self.0),
+            string_bytes: ffi::memory_string_bytes(&self.0),
+            string_count: ffi::memory_string_count(&self.0),
+            event_count: self.event_count(),
+            event_capacity: ffi::event_capacity(&self.0),
+        }
+    }
+}
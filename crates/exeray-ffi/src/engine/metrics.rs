@@ -0,0 +1,41 @@
+//! Metrics registry methods for the Engine.
+
+use super::Engine;
+use crate::ffi;
+use crate::metrics::{HISTOGRAM_BUCKETS, Metric, MetricKind};
+
+impl Engine {
+    /// Get every counter, gauge and histogram of the engine, sorted by name.
+    pub fn metrics(&mut self) -> Vec<Metric> {
+        let rows = self.0.pin_mut().refresh_metrics();
+        let handle = &self.0;
+
+        (0..rows)
+            .map(|row| {
+                let kind = MetricKind::from_u8(ffi::metric_type(handle, row));
+                let buckets = if kind == MetricKind::Histogram {
+                    (0..HISTOGRAM_BUCKETS)
+                        .map(|bucket| ffi::metric_bucket(handle, row, bucket))
+                        .collect()
+                } else {
+                    Vec::new()
+                };
+                Metric {
+                    name: ffi::metric_name(handle, row),
+                    help: ffi::metric_help(handle, row),
+                    labels: ffi::metric_labels(handle, row),
+                    kind,
+                    value: ffi::metric_value(handle, row),
+                    count: ffi::metric_count(handle, row),
+                    buckets,
+                }
+            })
+            .collect()
+    }
+
+    /// The engine's metrics as Prometheus text (exposition format 0.0.4),
+    /// or as OpenMetrics 1.0 text when `open_metrics` is set.
+    pub fn metrics_text(&self, open_metrics: bool) -> String {
+        self.0.metrics_text(open_metrics)
+    }
+}
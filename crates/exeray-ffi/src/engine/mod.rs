@@ -1,8 +1,20 @@
 //! Safe wrapper around the ExeRay C++ engine.
 
+mod alerts;
 mod control;
-mod events;
+pub(crate) mod events;
+mod latency;
+mod memory;
+mod metrics;
+mod modules;
 mod monitoring;
+mod parse_metrics;
+mod process_tree;
+mod query;
+mod risk;
+mod session;
+mod stats;
+mod strings;
 
 use crate::ffi;
 use crate::view_state::ViewState;
@@ -12,6 +24,11 @@ use crate::view_state::ViewState;
 /// Safe wrapper around the ExeRay C++ engine.
 pub struct Engine(pub(crate) cxx::UniquePtr<ffi::Handle>);
 
+// SAFETY: the C++ engine has no thread affinity; its own workers already
+// call into it from other threads. Moving the owner to another thread is
+// fine, sharing it is not (Engine is not Sync).
+unsafe impl Send for Engine {}
+
 impl Engine {
     /// Create a new engine with the specified arena size (in MB) and thread count.
     pub fn new(arena_mb: usize, threads: usize) -> Self {
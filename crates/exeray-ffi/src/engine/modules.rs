@@ -0,0 +1,22 @@
+//! Loaded module methods for the Engine.
+
+use super::Engine;
+use crate::ffi;
+use crate::module::Module;
+
+impl Engine {
+    /// Get the modules loaded in `pid` during the current or last session,
+    /// sorted by base address.
+    pub fn modules(&mut self, pid: u32) -> Vec<Module> {
+        let rows = self.0.pin_mut().refresh_modules(pid);
+        let handle = &self.0;
+
+        (0..rows)
+            .map(|row| Module {
+                base: ffi::module_base(handle, row),
+                size: ffi::module_size(handle, row),
+                path: ffi::module_path(handle, row),
+            })
+            .collect()
+    }
+}
@@ -17,11 +17,33 @@ impl Engine {
         self.0.pin_mut().start_monitoring(exe_path)
     }
 
+    /// Start monitoring a process that is already running.
+    ///
+    /// Nothing is relaunched; a process rundown seeds the correlator. The
+    /// process is left running when monitoring stops.
+    ///
+    /// # Arguments
+    /// * `pid` - Process to attach to.
+    /// * `with_tree` - Also monitor the descendants it has now.
+    ///
+    /// # Returns
+    /// `true` if monitoring started successfully, `false` on failure.
+    pub fn attach(&mut self, pid: u32, with_tree: bool) -> bool {
+        self.0.pin_mut().attach(pid, with_tree)
+    }
+
     /// Stop monitoring and terminate the target process.
     ///
-    /// Stops the ETW session, joins the consumer thread, and terminates
-    /// the target process if still running.
+    /// Gives the consumers up to the engine's drain deadline to read the
+    /// events ETW still buffers, stops the ETW session, joins the consumer
+    /// thread, and terminates the target process if still running.
     pub fn stop_monitoring(&mut self) {
         self.0.pin_mut().stop_monitoring();
     }
+
+    /// Stop monitoring at once, like `stop_monitoring` but dropping the
+    /// events ETW still buffers instead of waiting for them.
+    pub fn detach_monitoring(&mut self) {
+        self.0.pin_mut().detach_monitoring();
+    }
 }
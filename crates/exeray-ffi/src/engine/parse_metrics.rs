@@ -0,0 +1,64 @@
+//! Parse metrics, span trace and stage profile methods for the Engine.
+
+use super::Engine;
+use crate::ffi;
+use crate::parse_metrics::{EventCost, PROVIDER_NAMES, ParseMetrics, ProviderCost};
+
+impl Engine {
+    /// Get parse counts and cost per provider and event ID of the current
+    /// or last session.
+    pub fn parse_metrics(&mut self) -> ParseMetrics {
+        let rows = self.0.pin_mut().refresh_parse_metrics();
+        let handle = &self.0;
+
+        let mut providers: Vec<ProviderCost> = (0..PROVIDER_NAMES.len() as u8)
+            .map(|provider| ProviderCost {
+                provider,
+                events: ffi::parse_provider_events(handle, provider),
+                failures: ffi::parse_provider_failures(handle, provider),
+                cycles: ffi::parse_provider_cycles(handle, provider),
+                histogram: std::array::from_fn(|bucket| {
+                    ffi::parse_provider_bucket(handle, provider, bucket)
+                }),
+            })
+            .filter(|cost| cost.events > 0)
+            .collect();
+        providers.sort_by(|a, b| b.cycles.cmp(&a.cycles));
+
+        let events = (0..rows)
+            .map(|row| EventCost {
+                provider: ffi::parse_event_provider(handle, row),
+                event_id: ffi::parse_event_id(handle, row),
+                events: ffi::parse_event_events(handle, row),
+                failures: ffi::parse_event_failures(handle, row),
+                cycles: ffi::parse_event_cycles(handle, row),
+            })
+            .collect();
+
+        ParseMetrics {
+            providers,
+            events,
+            untracked: ffi::parse_untracked(handle),
+        }
+    }
+
+    /// Write the most recent parse, intern, detect, correlate and push spans
+    /// of every thread to `path` as a Chrome trace (Perfetto, chrome://tracing).
+    /// The trace is empty unless the core was built with EXERAY_ENABLE_SPANS.
+    pub fn dump_spans(&self, path: &str) -> bool {
+        self.0.dump_spans(path)
+    }
+
+    /// Sample the pipeline stage of the consumer, ingest and detector threads
+    /// every `interval_us` microseconds (0 stops). Returns whether sampling
+    /// runs.
+    pub fn set_profiling(&mut self, interval_us: u32) -> bool {
+        self.0.pin_mut().set_profiling(interval_us)
+    }
+
+    /// Write the sampled stages to `path` as folded stacks (flamegraph.pl,
+    /// inferno, speedscope). Empty unless sampling was turned on.
+    pub fn dump_profile(&self, path: &str) -> bool {
+        self.0.dump_profile(path)
+    }
+}
@@ -0,0 +1,26 @@
+//! Process tree methods for the Engine.
+
+use super::Engine;
+use crate::ffi;
+use crate::process_tree::ProcessNode;
+
+impl Engine {
+    /// Get the processes below `root` (a ProcessCreate event ID, 0 for every
+    /// tree) in pre-order, parents before children, at most `max_nodes`.
+    pub fn process_tree(&mut self, root: u64, max_nodes: usize) -> Vec<ProcessNode> {
+        let rows = self.0.pin_mut().refresh_process_tree(root, max_nodes);
+        let handle = &self.0;
+
+        (0..rows)
+            .map(|row| ProcessNode {
+                create: ffi::process_create(handle, row),
+                parent: ffi::process_parent(handle, row),
+                pid: ffi::process_pid(handle, row),
+                depth: ffi::process_depth(handle, row),
+                stopped: ffi::process_stopped(handle, row),
+                events: ffi::process_events(handle, row),
+                subtree_events: ffi::process_subtree_events(handle, row),
+            })
+            .collect()
+    }
+}
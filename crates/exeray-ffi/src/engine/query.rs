@@ -0,0 +1,58 @@
+//! Query methods for the Engine.
+
+use super::Engine;
+use crate::ffi;
+use crate::query::{QueryRow, QuerySpec, ViewId, ViewSort};
+
+impl Engine {
+    /// Run `spec` inside the engine and return up to `limit` matches.
+    ///
+    /// Filtering happens in C++ over the index the planner picks, so only
+    /// the matches cross the FFI.
+    pub fn query(&self, spec: &QuerySpec, limit: usize) -> Vec<QueryRow> {
+        let mut rows = vec![QueryRow::default(); limit.min(self.event_count())];
+        let len = self.query_into(spec, &mut rows);
+        rows.truncate(len);
+        rows
+    }
+
+    /// Run `spec` into `out`, at most `out.len()` matches, without
+    /// allocating. Returns the number of rows written.
+    pub fn query_into(&self, spec: &QuerySpec, out: &mut [QueryRow]) -> usize {
+        ffi::query_rows(&self.0, spec, out)
+    }
+
+    /// Open a live view: the matches of `spec` sorted by `sort`, paged by
+    /// `page_size` (`QuerySpec::newest_first` sorts descending).
+    ///
+    /// The view lives in the engine; `refresh_view` tests only the events
+    /// that arrived since its last refresh against the filter.
+    pub fn open_view(&mut self, spec: &QuerySpec, sort: ViewSort, page_size: usize) -> ViewId {
+        let page_size = page_size.max(1);
+        let index = self.0.pin_mut().view_open(spec, sort as u8, page_size);
+        ViewId { index, page_size }
+    }
+
+    /// Bring `view` up to date; returns the number of matches.
+    pub fn refresh_view(&mut self, view: ViewId) -> usize {
+        self.0.pin_mut().view_refresh(view.index)
+    }
+
+    /// Number of pages of `view` as of its last refresh.
+    pub fn view_pages(&self, view: ViewId) -> usize {
+        self.0.view_pages(view.index)
+    }
+
+    /// Rows of page `page` of `view` (empty past the last page).
+    pub fn view_page(&self, view: ViewId, page: usize) -> Vec<QueryRow> {
+        let mut rows = vec![QueryRow::default(); view.page_size];
+        let len = self.0.view_page(view.index, page, &mut rows);
+        rows.truncate(len);
+        rows
+    }
+
+    /// Close `view`; afterwards it reads as empty.
+    pub fn close_view(&mut self, view: ViewId) {
+        self.0.pin_mut().view_close(view.index);
+    }
+}
@@ -0,0 +1,30 @@
+//! Risk score methods for the Engine.
+
+use super::Engine;
+use crate::ffi;
+use crate::risk::RiskScore;
+
+impl Engine {
+    /// Get the `k` processes with the highest risk scores, riskiest first.
+    pub fn riskiest_processes(&mut self, k: usize) -> Vec<RiskScore> {
+        self.risk(false, k)
+    }
+
+    /// Get the `k` correlation chains with the highest risk scores, riskiest first.
+    pub fn riskiest_chains(&mut self, k: usize) -> Vec<RiskScore> {
+        self.risk(true, k)
+    }
+
+    fn risk(&mut self, chains: bool, k: usize) -> Vec<RiskScore> {
+        let rows = self.0.pin_mut().refresh_risk(chains, k);
+        let handle = &self.0;
+
+        (0..rows)
+            .map(|row| RiskScore {
+                key: ffi::risk_key(handle, row),
+                score: ffi::risk_score(handle, row),
+                events: ffi::risk_events(handle, row),
+            })
+            .collect()
+    }
+}
@@ -0,0 +1,19 @@
+//! ETW session statistics methods for the Engine.
+
+use super::Engine;
+use crate::ffi;
+use crate::session::SessionStats;
+
+impl Engine {
+    /// Get the ETW loss and buffer counters of the current or last session.
+    pub fn session_stats(&self) -> SessionStats {
+        SessionStats {
+            events_lost: ffi::session_events_lost(&self.0),
+            buffers_lost: ffi::session_buffers_lost(&self.0),
+            buffers_written: ffi::session_buffers_written(&self.0),
+            buffers_read: ffi::session_buffers_read(&self.0),
+            free_buffers: ffi::session_free_buffers(&self.0),
+            buffers: ffi::session_buffer_count(&self.0),
+        }
+    }
+}
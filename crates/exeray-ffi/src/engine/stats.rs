@@ -0,0 +1,14 @@
+//! Dashboard statistics for the Engine.
+
+use super::Engine;
+use crate::stats::StatsSnapshot;
+
+impl Engine {
+    /// Take the dashboard counters in one FFI call.
+    ///
+    /// Cheap enough to poll at 10 Hz: it reads push-time counters and
+    /// session metrics, never the events themselves.
+    pub fn stats_snapshot(&self) -> StatsSnapshot {
+        self.0.stats_snapshot()
+    }
+}
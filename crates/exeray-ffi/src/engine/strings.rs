@@ -0,0 +1,30 @@
+//! Interned string methods for the Engine.
+
+use std::borrow::Cow;
+
+use super::Engine;
+use crate::ffi;
+use crate::string_ref::StringRef;
+
+impl Engine {
+    /// Resolve string IDs taken from event payloads, in one FFI call.
+    ///
+    /// The strings are borrowed from arena memory without copying and live
+    /// as long as the borrow of the engine. IDs should come from this
+    /// engine's event payloads; invalid ones and ones outside the string
+    /// storage give "". Bytes that are not valid UTF-8 are replaced, which
+    /// copies that one string.
+    pub fn resolve_strings(&self, ids: &[u32]) -> Vec<Cow<'_, str>> {
+        let mut refs = vec![StringRef::default(); ids.len()];
+        ffi::strings_resolve(&self.0, ids, &mut refs);
+        refs.iter()
+            // SAFETY: the arena is only reset under &mut Engine
+            .map(|r| String::from_utf8_lossy(unsafe { r.bytes() }))
+            .collect()
+    }
+
+    /// Resolve one string ID; `resolve_strings` for many.
+    pub fn resolve_string(&self, id: u32) -> Cow<'_, str> {
+        self.resolve_strings(&[id]).pop().unwrap_or_default()
+    }
+}
@@ -1,5 +1,7 @@
 //! Event struct representing a single event from the EventGraph.
 
+use cxx::{ExternType, type_id};
+
 use crate::ffi::{Category, Status};
 
 /// A single event from the EventGraph.
@@ -12,3 +14,25 @@ pub struct Event {
     pub status: Status,
     pub operation: u8,
 }
+
+/// Raw header fields of one event, filled in bulk by the C++ side.
+///
+/// Mirrors `exeray::EventRecord` in ffi.hpp; convert with `Event::from`.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct EventRecord {
+    pub id: u64,
+    pub parent_id: u64,
+    pub timestamp: u64,
+    pub category: u8,
+    pub status: u8,
+    pub operation: u8,
+    reserved: [u8; 5],
+}
+
+// SAFETY: EventRecord has the same #[repr(C)] layout as exeray::EventRecord
+// (statically asserted to 32 bytes on the C++ side) and no invariants.
+unsafe impl ExternType for EventRecord {
+    type Id = type_id!("exeray::EventRecord");
+    type Kind = cxx::kind::Trivial;
+}
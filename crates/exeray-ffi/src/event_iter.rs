@@ -1,31 +1,71 @@
 //! Iterator over events in the EventGraph.
 
 use crate::engine::Engine;
-use crate::event::Event;
+use crate::event::{Event, EventRecord};
+
+/// Events an iterator fetches per FFI call.
+pub const ITER_BATCH: usize = 256;
 
 /// Iterator over events in the EventGraph.
+///
+/// Walks absolute indexes from the oldest live event, copying them in
+/// batches of `ITER_BATCH`. If the graph evicts events while iterating
+/// (ring retention mode), the iterator notices the epoch change and skips
+/// ahead to the new oldest event instead of stopping.
 pub struct EventIter<'a> {
     pub(crate) engine: &'a Engine,
     pub(crate) index: usize,
     pub(crate) count: usize,
+    pub(crate) epoch: u64,
+    pub(crate) buffer: Vec<EventRecord>,
+    pub(crate) pos: usize,
+    pub(crate) len: usize,
+}
+
+impl EventIter<'_> {
+    /// Check whether events were evicted since the iterator was created.
+    pub fn evicted(&self) -> bool {
+        self.engine.event_epoch() != self.epoch
+    }
+
+    /// Fetch the next batch; false once no event is left.
+    fn refill(&mut self) -> bool {
+        while self.index < self.count {
+            let want = (self.count - self.index).min(self.buffer.len());
+            let len = self.engine.copy_events(self.index, &mut self.buffer[..want]);
+            if len > 0 {
+                // An evicted index starts at the oldest survivor: resume after the copy
+                self.pos = 0;
+                self.len = len;
+                self.index = self.buffer[len - 1].id as usize;
+                return true;
+            }
+            if !self.evicted() {
+                return false;
+            }
+            // Events were recycled under us; resume at the oldest survivor
+            self.epoch = self.engine.event_epoch();
+            self.index = self.index.max(self.engine.first_event_index());
+        }
+        false
+    }
 }
 
-impl<'a> Iterator for EventIter<'a> {
+impl Iterator for EventIter<'_> {
     type Item = Event;
 
     fn next(&mut self) -> Option<Self::Item> {
-        if self.index >= self.count {
+        if self.pos == self.len && !self.refill() {
             return None;
         }
-        let event = self.engine.get_event(self.index);
-        self.index += 1;
-        event
+        let record = self.buffer[self.pos];
+        self.pos += 1;
+        Some(Event::from(record))
     }
 
     fn size_hint(&self) -> (usize, Option<usize>) {
-        let remaining = self.count.saturating_sub(self.index);
-        (remaining, Some(remaining))
+        // Eviction can skip events, so only the upper bound is exact
+        let remaining = self.count.saturating_sub(self.index) + (self.len - self.pos);
+        (0, Some(remaining))
     }
 }
-
-impl ExactSizeIterator for EventIter<'_> {}
@@ -0,0 +1,36 @@
+//! Age of events at delivery and graph visibility.
+
+/// Point on the ingest path, matching `exeray::etw::LatencyStage`.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(u8)]
+pub enum LatencyStage {
+    /// ETW timestamp to record callback entry.
+    Delivered = 0,
+    /// ETW timestamp to the event being visible in the graph.
+    Visible = 1,
+    /// ETW timestamp to detection having checked the event.
+    Detected = 2,
+}
+
+/// Percentiles of sampled event ages, in nanoseconds.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct LatencySummary {
+    /// Events sampled.
+    pub count: u64,
+    pub p50: u64,
+    pub p99: u64,
+    pub p999: u64,
+    pub max: u64,
+}
+
+impl LatencySummary {
+    /// Whether any event was sampled.
+    pub fn is_empty(&self) -> bool {
+        self.count == 0
+    }
+
+    /// p99 in milliseconds, for display.
+    pub fn p99_ms(&self) -> f64 {
+        self.p99 as f64 / 1_000_000.0
+    }
+}
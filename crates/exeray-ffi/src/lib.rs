@@ -3,11 +3,27 @@
 //! Provides safe Rust wrappers around the C++ ExeRay engine,
 //! including access to the EventGraph for event monitoring.
 
+pub mod alert;
 pub mod engine;
 pub mod event;
 pub mod event_iter;
+pub mod latency;
+pub mod memory;
+pub mod metrics;
+pub mod module;
+pub mod node;
+pub mod parse_metrics;
+pub mod payload;
+pub mod process_tree;
+pub mod query;
+pub mod risk;
+pub mod session;
+pub mod stats;
+pub mod string_ref;
+pub mod target_usage;
 mod tests;
 pub mod view_state;
+pub mod wall_clock;
 
 // CXX bridge must be in lib.rs for cxxbridge tool to find it
 #[cxx::bridge(namespace = "exeray")]
@@ -31,6 +47,7 @@ mod ffi {
         Service = 13,
         Wmi = 14,
         Clr = 15,
+        Manifest = 16,
     }
 
     /// Operation result status.
@@ -47,28 +64,154 @@ mod ffi {
         include!("exeray/ffi.hpp");
 
         pub type Handle;
+        type EventRecord = crate::event::EventRecord;
+        type EventSpan = crate::node::EventSpan;
+        type StringRef = crate::string_ref::StringRef;
+        type StatsSnapshot = crate::stats::StatsSnapshot;
+        type QuerySpec = crate::query::QuerySpec;
+        type QueryRow = crate::query::QueryRow;
+        type AlertRecord = crate::alert::AlertRecord;
+        type WallClock = crate::wall_clock::WallClock;
 
         pub fn create(arena_mb: usize, threads: usize) -> UniquePtr<Handle>;
         pub fn submit(self: Pin<&mut Handle>);
         pub fn generation(self: &Handle) -> u64;
         pub fn timestamp_ns(self: &Handle) -> u64;
+        pub fn wall_clock(self: &Handle) -> WallClock;
         pub fn flags(self: &Handle) -> u64;
         pub fn progress(self: &Handle) -> f32;
         pub fn idle(self: &Handle) -> bool;
         pub fn threads(self: &Handle) -> usize;
+        pub fn stats_snapshot(self: &Handle) -> StatsSnapshot;
 
         // Event graph accessors
         pub fn event_count(handle: &Handle) -> usize;
+        pub fn event_first_index(handle: &Handle) -> usize;
+        pub fn event_epoch(handle: &Handle) -> u64;
+        pub fn event_exists(handle: &Handle, index: usize) -> bool;
         pub fn event_get_id(handle: &Handle, index: usize) -> u64;
         pub fn event_get_parent(handle: &Handle, index: usize) -> u64;
         pub fn event_get_timestamp(handle: &Handle, index: usize) -> u64;
+        pub fn event_get_wall_time(handle: &Handle, index: usize) -> u64;
         pub fn event_get_category(handle: &Handle, index: usize) -> u8;
         pub fn event_get_status(handle: &Handle, index: usize) -> u8;
         pub fn event_get_operation(handle: &Handle, index: usize) -> u8;
+        pub fn event_copy_run(handle: &Handle, index: usize, out: &mut [EventRecord]) -> usize;
+        pub fn event_segment_span(handle: &Handle, index: usize) -> EventSpan;
+        pub fn wait_for_events(self: Pin<&mut Handle>, seen: u64, timeout_ms: u32) -> u64;
+        pub fn wait_for_alerts(self: Pin<&mut Handle>, timeout_ms: u32) -> bool;
+        pub fn pop_alerts(self: Pin<&mut Handle>, out: &mut [AlertRecord]) -> usize;
+        pub fn query_rows(handle: &Handle, spec: &QuerySpec, out: &mut [QueryRow]) -> usize;
+        pub fn view_open(
+            self: Pin<&mut Handle>,
+            spec: &QuerySpec,
+            sort: u8,
+            page_size: usize,
+        ) -> usize;
+        pub fn view_refresh(self: Pin<&mut Handle>, view: usize) -> usize;
+        pub fn view_pages(self: &Handle, view: usize) -> usize;
+        pub fn view_page(self: &Handle, view: usize, page: usize, out: &mut [QueryRow]) -> usize;
+        pub fn view_close(self: Pin<&mut Handle>, view: usize);
+        pub fn strings_resolve(handle: &Handle, ids: &[u32], out: &mut [StringRef]);
+        pub fn event_capacity(handle: &Handle) -> usize;
+
+        // Memory statistics (arena: 0 = events, 1 = strings, 2 = scratch)
+        pub fn memory_arena_used(handle: &Handle, arena: u8) -> usize;
+        pub fn memory_arena_committed(handle: &Handle, arena: u8) -> usize;
+        pub fn memory_arena_reserved(handle: &Handle, arena: u8) -> usize;
+        pub fn memory_arena_capacity(handle: &Handle, arena: u8) -> usize;
+        pub fn memory_arena_high_water(handle: &Handle, arena: u8) -> usize;
+        pub fn memory_arena_padding(handle: &Handle, arena: u8) -> usize;
+        pub fn memory_arena_failures(handle: &Handle, arena: u8) -> u64;
+        pub fn memory_strings_shared(handle: &Handle) -> bool;
+        pub fn memory_event_bytes(handle: &Handle) -> usize;
+        pub fn memory_string_bytes(handle: &Handle) -> usize;
+        pub fn memory_string_count(handle: &Handle) -> usize;
+
+        // ETW session statistics
+        pub fn session_events_lost(handle: &Handle) -> u64;
+        pub fn session_buffers_lost(handle: &Handle) -> u64;
+        pub fn session_buffers_written(handle: &Handle) -> u64;
+        pub fn session_buffers_read(handle: &Handle) -> u64;
+        pub fn session_free_buffers(handle: &Handle) -> u32;
+        pub fn session_buffer_count(handle: &Handle) -> u32;
+
+        // Target job accounting (snapshot of refresh_target_usage)
+        pub fn refresh_target_usage(self: Pin<&mut Handle>);
+        pub fn target_usage_user_ns(handle: &Handle) -> u64;
+        pub fn target_usage_kernel_ns(handle: &Handle) -> u64;
+        pub fn target_usage_read_bytes(handle: &Handle) -> u64;
+        pub fn target_usage_write_bytes(handle: &Handle) -> u64;
+        pub fn target_usage_other_bytes(handle: &Handle) -> u64;
+        pub fn target_usage_peak_process_memory(handle: &Handle) -> u64;
+        pub fn target_usage_peak_job_memory(handle: &Handle) -> u64;
+        pub fn target_usage_active_processes(handle: &Handle) -> u32;
+
+        // Parse metrics (provider: etw::MetricProvider; row: most expensive first)
+        pub fn refresh_parse_metrics(self: Pin<&mut Handle>) -> usize;
+        pub fn parse_provider_events(handle: &Handle, provider: u8) -> u64;
+        pub fn parse_provider_failures(handle: &Handle, provider: u8) -> u64;
+        pub fn parse_provider_cycles(handle: &Handle, provider: u8) -> u64;
+        pub fn parse_provider_bucket(handle: &Handle, provider: u8, bucket: usize) -> u64;
+        pub fn parse_event_provider(handle: &Handle, row: usize) -> u8;
+        pub fn parse_event_id(handle: &Handle, row: usize) -> u16;
+        pub fn parse_event_events(handle: &Handle, row: usize) -> u64;
+        pub fn parse_event_failures(handle: &Handle, row: usize) -> u64;
+        pub fn parse_event_cycles(handle: &Handle, row: usize) -> u64;
+        pub fn parse_untracked(handle: &Handle) -> u64;
+
+        // Hot-path spans as a Chrome trace (empty unless built with EXERAY_ENABLE_SPANS)
+        pub fn dump_spans(self: &Handle, path: &str) -> bool;
+
+        // Stage sampling (interval_us 0 = off) and its folded stacks
+        pub fn set_profiling(self: Pin<&mut Handle>, interval_us: u32) -> bool;
+        pub fn dump_profile(self: &Handle, path: &str) -> bool;
+
+        // Engine metrics (row: sorted by name; type: exeray::MetricType)
+        pub fn refresh_metrics(self: Pin<&mut Handle>) -> usize;
+        pub fn metric_name(handle: &Handle, row: usize) -> String;
+        pub fn metric_help(handle: &Handle, row: usize) -> String;
+        pub fn metric_labels(handle: &Handle, row: usize) -> String;
+        pub fn metric_type(handle: &Handle, row: usize) -> u8;
+        pub fn metric_value(handle: &Handle, row: usize) -> f64;
+        pub fn metric_count(handle: &Handle, row: usize) -> u64;
+        pub fn metric_bucket(handle: &Handle, row: usize, bucket: usize) -> u64;
+        pub fn metrics_text(self: &Handle, open_metrics: bool) -> String;
+
+        // Loaded modules of one process (row: sorted by base)
+        pub fn refresh_modules(self: Pin<&mut Handle>, pid: u32) -> usize;
+        pub fn module_base(handle: &Handle, row: usize) -> u64;
+        pub fn module_size(handle: &Handle, row: usize) -> u64;
+        pub fn module_path(handle: &Handle, row: usize) -> String;
+
+        // Riskiest processes or correlation chains (row: riskiest first)
+        pub fn refresh_risk(self: Pin<&mut Handle>, chains: bool, k: usize) -> usize;
+        pub fn risk_key(handle: &Handle, row: usize) -> u32;
+        pub fn risk_score(handle: &Handle, row: usize) -> f64;
+        pub fn risk_events(handle: &Handle, row: usize) -> u64;
+
+        // Process tree in pre-order (root 0 = every tree)
+        pub fn refresh_process_tree(self: Pin<&mut Handle>, root: u64, max_nodes: usize) -> usize;
+        pub fn process_create(handle: &Handle, row: usize) -> u64;
+        pub fn process_parent(handle: &Handle, row: usize) -> u64;
+        pub fn process_pid(handle: &Handle, row: usize) -> u32;
+        pub fn process_depth(handle: &Handle, row: usize) -> u32;
+        pub fn process_stopped(handle: &Handle, row: usize) -> bool;
+        pub fn process_events(handle: &Handle, row: usize) -> u64;
+        pub fn process_subtree_events(handle: &Handle, row: usize) -> u64;
+
+        // Ingest latency in ns (stage: 0 = delivered, 1 = visible, 2 = detected; category 17 = all)
+        pub fn latency_count(handle: &Handle, stage: u8, category: u8) -> u64;
+        pub fn latency_p50(handle: &Handle, stage: u8, category: u8) -> u64;
+        pub fn latency_p99(handle: &Handle, stage: u8, category: u8) -> u64;
+        pub fn latency_p999(handle: &Handle, stage: u8, category: u8) -> u64;
+        pub fn latency_max(handle: &Handle, stage: u8, category: u8) -> u64;
 
         // Monitoring control
         pub fn start_monitoring(self: Pin<&mut Handle>, exe_path: &str) -> bool;
+        pub fn attach(self: Pin<&mut Handle>, pid: u32, with_tree: bool) -> bool;
         pub fn stop_monitoring(self: Pin<&mut Handle>);
+        pub fn detach_monitoring(self: Pin<&mut Handle>);
 
         // Target process control
         pub fn freeze_target(self: Pin<&mut Handle>);
@@ -82,9 +225,29 @@ mod ffi {
 }
 
 // Re-export public API
+pub use alert::AlertRecord;
 pub use engine::Engine;
 pub use event::Event;
 pub use event_iter::EventIter;
 pub use ffi::Category;
 pub use ffi::Status;
+pub use latency::{LatencyStage, LatencySummary};
+pub use memory::{ArenaKind, ArenaUsage, MemoryStats};
+pub use metrics::{Metric, MetricKind};
+pub use module::Module;
+pub use node::{EventNode, EventPayload, NodeSegments, SegmentView};
+pub use parse_metrics::{EventCost, ParseMetrics, ProviderCost};
+pub use payload::{
+    AmsiPayload, ClrPayload, DnsPayload, FilePayload, ImagePayload, InputPayload, MemoryPayload,
+    NetworkPayload, Payload, ProcessPayload, RegistryPayload, SchedulerPayload, ScriptPayload,
+    SecurityPayload, ServicePayload, ThreadPayload, WmiPayload, ManifestPayload,
+};
+pub use process_tree::ProcessNode;
+pub use query::{QueryRow, QuerySpec, ViewId, ViewSort};
+pub use risk::RiskScore;
+pub use session::SessionStats;
+pub use stats::StatsSnapshot;
+pub use string_ref::StringRef;
+pub use target_usage::TargetUsage;
 pub use view_state::ViewState;
+pub use wall_clock::WallClock;
@@ -0,0 +1,74 @@
+//! Memory statistics for the engine's arenas.
+
+/// Engine arena selector, matching `exeray::MemoryArena` on the C++ side.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(u8)]
+pub enum ArenaKind {
+    /// Event graph storage.
+    Events = 0,
+    /// Interned strings (reports the events arena when shared).
+    Strings = 1,
+    /// Per-session scratch memory.
+    Scratch = 2,
+}
+
+/// Usage counters of one arena, in bytes unless noted.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ArenaUsage {
+    pub used: usize,
+    pub committed: usize,
+    pub reserved: usize,
+    pub capacity: usize,
+    pub high_water: usize,
+    /// Bytes lost to alignment and thread buffer tails since the last reset.
+    pub padding: usize,
+    /// Allocations refused because the arena was full (count).
+    pub failures: u64,
+}
+
+impl ArenaUsage {
+    /// Bytes still available before allocations start failing.
+    pub fn headroom(&self) -> usize {
+        self.capacity.saturating_sub(self.used)
+    }
+
+    /// Fraction of the capacity in use, from 0.0 to 1.0.
+    pub fn fill_ratio(&self) -> f64 {
+        if self.capacity == 0 {
+            return 0.0;
+        }
+        self.used as f64 / self.capacity as f64
+    }
+}
+
+/// Memory usage of the engine, for the memory panel and low-memory alerts.
+#[derive(Debug, Clone, Copy, Default, PartialEq)]
+pub struct MemoryStats {
+    pub events: ArenaUsage,
+    pub strings: ArenaUsage,
+    pub scratch: ArenaUsage,
+    /// Strings are stored in the events arena.
+    pub strings_shared: bool,
+    /// Bytes holding event nodes, links, indexes and columns.
+    pub event_bytes: usize,
+    /// Bytes holding interned strings.
+    pub string_bytes: usize,
+    pub string_count: usize,
+    pub event_count: usize,
+    pub event_capacity: usize,
+}
+
+impl MemoryStats {
+    /// Whether event storage is close to running out (`threshold` in 0.0..=1.0).
+    ///
+    /// Checks both the events arena and the graph's event budget, the two
+    /// limits at which new events start being dropped.
+    pub fn near_exhaustion(&self, threshold: f64) -> bool {
+        let budget = if self.event_capacity == 0 {
+            0.0
+        } else {
+            self.event_count as f64 / self.event_capacity as f64
+        };
+        self.events.fill_ratio() >= threshold || budget >= threshold
+    }
+}
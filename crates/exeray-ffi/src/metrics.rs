@@ -0,0 +1,41 @@
+//! Counters, gauges and histograms of the engine's metrics registry.
+
+/// Buckets of a histogram; bucket `b` counts observations of
+/// `[2^(b-1), 2^b)` (bucket 0: zero).
+pub const HISTOGRAM_BUCKETS: usize = 48;
+
+/// Kind of a metric, by `exeray::MetricType` value.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum MetricKind {
+    Counter,
+    Gauge,
+    Histogram,
+}
+
+impl MetricKind {
+    /// Kind of an `exeray::MetricType` value (unknown values read as gauges).
+    pub fn from_u8(value: u8) -> Self {
+        match value {
+            0 => MetricKind::Counter,
+            2 => MetricKind::Histogram,
+            _ => MetricKind::Gauge,
+        }
+    }
+}
+
+/// One labelled value of a metrics snapshot.
+#[derive(Debug, Clone, PartialEq)]
+pub struct Metric {
+    /// Prometheus name; counters end in `_total`.
+    pub name: String,
+    pub help: String,
+    /// Rendered label pairs, e.g. `provider="File"` (empty = none).
+    pub labels: String,
+    pub kind: MetricKind,
+    /// Counter or gauge value; sum of observations for histograms.
+    pub value: f64,
+    /// Observations of a histogram.
+    pub count: u64,
+    /// Observations per bucket of a histogram (not cumulative); empty otherwise.
+    pub buckets: Vec<u64>,
+}
@@ -0,0 +1,17 @@
+//! Modules loaded in a monitored process.
+
+/// One loaded image, matching `exeray::etw::ModuleInfo`.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct Module {
+    pub base: u64,
+    pub size: u64,
+    /// Image path, empty if the load event carried none.
+    pub path: String,
+}
+
+impl Module {
+    /// Whether the module contains `address`.
+    pub fn contains(&self, address: u64) -> bool {
+        address >= self.base && address - self.base < self.size
+    }
+}
@@ -0,0 +1,151 @@
+//! In-place views of EventGraph nodes.
+
+use std::mem::{align_of, offset_of, size_of};
+
+use cxx::{ExternType, type_id};
+
+use crate::engine::Engine;
+use crate::engine::events::{category_from_u8, status_from_u8};
+use crate::ffi::{Category, Status};
+use crate::payload::Payload;
+
+/// Category-specific data of a node: the tag, then a 24-byte union.
+///
+/// Mirrors `exeray::event::EventPayload`; `data` holds the union words,
+/// laid out as the payload struct of `category` (see payloads/*.hpp);
+/// `decode()` reads it as that struct.
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct EventPayload {
+    pub category: u8,
+    _pad: [u8; 7],
+    pub data: [u64; 3],
+}
+
+/// One event exactly as the graph stores it (one cache line).
+///
+/// Mirrors `exeray::event::EventNode`; the layout checks below match
+/// node.hpp and payload.hpp.
+#[repr(C, align(64))]
+#[derive(Debug, Clone, Copy)]
+pub struct EventNode {
+    pub id: u64,
+    pub parent_id: u64,
+    pub timestamp: u64,
+    pub correlation_id: u32,
+    pub status: u8,
+    pub operation: u8,
+    _pad: [u8; 2],
+    pub payload: EventPayload,
+}
+
+const _: () = {
+    assert!(size_of::<EventPayload>() == 32);
+    assert!(offset_of!(EventPayload, data) == 8);
+    assert!(size_of::<EventNode>() == 64);
+    assert!(align_of::<EventNode>() == 64);
+    assert!(offset_of!(EventNode, parent_id) == 8);
+    assert!(offset_of!(EventNode, timestamp) == 16);
+    assert!(offset_of!(EventNode, correlation_id) == 24);
+    assert!(offset_of!(EventNode, status) == 28);
+    assert!(offset_of!(EventNode, operation) == 29);
+    assert!(offset_of!(EventNode, payload) == 32);
+    assert!(size_of::<EventSpan>() == 32);
+};
+
+impl EventNode {
+    /// Event category (the payload tag).
+    pub fn category(&self) -> Category {
+        category_from_u8(self.payload.category)
+    }
+
+    /// Operation result status.
+    pub fn status(&self) -> Status {
+        status_from_u8(self.status)
+    }
+
+    /// The payload, typed by the category.
+    pub fn typed_payload(&self) -> Payload {
+        self.payload.decode()
+    }
+}
+
+/// Raw span returned by the C++ side; mirrors `exeray::EventSpan`.
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct EventSpan {
+    nodes: *const EventNode,
+    first: usize,
+    length: usize,
+    epoch: u64,
+}
+
+// SAFETY: EventSpan has the #[repr(C)] layout of
+// exeray::event::EventGraph::SegmentSpan (checked on both sides) and is
+// only turned into a slice by SegmentView, which borrows the Engine.
+unsafe impl ExternType for EventSpan {
+    type Id = type_id!("exeray::EventSpan");
+    type Kind = cxx::kind::Trivial;
+}
+
+/// Published nodes of one graph segment, borrowed without copying.
+///
+/// The nodes live in the engine's arena for as long as the Engine is
+/// borrowed. In ring retention mode their segment may be recycled
+/// meanwhile: read what you need, then check `is_current()` and discard
+/// the values if it returns false. Append-mode nodes never change.
+pub struct SegmentView<'a> {
+    engine: &'a Engine,
+    nodes: &'a [EventNode],
+    first: usize,
+    epoch: u64,
+}
+
+impl<'a> SegmentView<'a> {
+    pub(crate) fn new(engine: &'a Engine, span: EventSpan) -> Self {
+        let nodes = if span.nodes.is_null() || span.length == 0 {
+            &[][..]
+        } else {
+            // SAFETY: the C++ side returns `length` published, 64-byte aligned
+            // nodes inside one arena segment, which outlives the borrow of
+            // `engine`; nothing writes them until their segment is recycled,
+            // which is_current() reports.
+            unsafe { std::slice::from_raw_parts(span.nodes, span.length) }
+        };
+        SegmentView { engine, nodes, first: span.first, epoch: span.epoch }
+    }
+
+    /// The nodes, oldest first.
+    pub fn nodes(&self) -> &'a [EventNode] {
+        self.nodes
+    }
+
+    /// Absolute index (`EventId - 1`) of the first node.
+    pub fn first_index(&self) -> usize {
+        self.first
+    }
+
+    /// Whether no segment was recycled since the view was taken.
+    pub fn is_current(&self) -> bool {
+        self.engine.event_epoch() == self.epoch
+    }
+}
+
+/// Iterator over the segments of the graph, as in-place views.
+pub struct NodeSegments<'a> {
+    pub(crate) engine: &'a Engine,
+    pub(crate) index: usize,
+}
+
+impl<'a> Iterator for NodeSegments<'a> {
+    type Item = SegmentView<'a>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        let view = self.engine.segment_view(self.index);
+        if view.nodes.is_empty() {
+            return None;
+        }
+        self.index = view.first + view.nodes.len();
+        Some(view)
+    }
+}
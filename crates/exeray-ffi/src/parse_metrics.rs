@@ -0,0 +1,107 @@
+//! Parse cost per ETW provider and event ID.
+
+/// Provider names by `exeray::etw::MetricProvider` value.
+pub const PROVIDER_NAMES: [&str; 15] = [
+    "Process",
+    "File",
+    "Registry",
+    "Network",
+    "Image",
+    "Thread",
+    "Memory",
+    "PowerShell",
+    "AMSI",
+    "DNS",
+    "Security",
+    "WMI",
+    "CLR",
+    "Manifest",
+    "Unknown",
+];
+
+/// Buckets of the parse time histogram; bucket `b` counts parses of
+/// `[2^(b-1), 2^b)` cycles.
+pub const CYCLE_BUCKETS: usize = 32;
+
+/// Name of a provider index, "Unknown" if out of range.
+pub fn provider_name(provider: u8) -> &'static str {
+    PROVIDER_NAMES
+        .get(usize::from(provider))
+        .copied()
+        .unwrap_or("Unknown")
+}
+
+/// Parse totals of one provider.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct ProviderCost {
+    /// Index into `PROVIDER_NAMES`.
+    pub provider: u8,
+    pub events: u64,
+    /// Records the parser rejected.
+    pub failures: u64,
+    /// Parse time summed (TSC cycles on x86).
+    pub cycles: u64,
+    pub histogram: [u64; CYCLE_BUCKETS],
+}
+
+impl ProviderCost {
+    pub fn name(&self) -> &'static str {
+        provider_name(self.provider)
+    }
+
+    /// Average cycles per parse.
+    pub fn mean_cycles(&self) -> u64 {
+        self.cycles.checked_div(self.events).unwrap_or(0)
+    }
+
+    /// Upper bound of the histogram bucket holding the given percentile.
+    pub fn percentile_cycles(&self, percentile: f64) -> u64 {
+        let total: u64 = self.histogram.iter().sum();
+        if total == 0 {
+            return 0;
+        }
+        let target = (total as f64 * percentile.clamp(0.0, 1.0)).ceil().max(1.0) as u64;
+        let mut seen = 0;
+        for (bucket, count) in self.histogram.iter().enumerate() {
+            seen += count;
+            if seen >= target {
+                return if bucket == 0 { 0 } else { 1u64 << bucket };
+            }
+        }
+        u64::MAX
+    }
+}
+
+/// Parse totals of one event ID of one provider.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct EventCost {
+    pub provider: u8,
+    /// EventDescriptor.Id.
+    pub event_id: u16,
+    pub events: u64,
+    pub failures: u64,
+    pub cycles: u64,
+}
+
+/// Parse cost of the current or last session.
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct ParseMetrics {
+    /// Providers with at least one record, most expensive first.
+    pub providers: Vec<ProviderCost>,
+    /// Event IDs, most expensive first.
+    pub events: Vec<EventCost>,
+    /// Records counted per provider only.
+    pub untracked: u64,
+}
+
+impl ParseMetrics {
+    /// The `n` most expensive providers.
+    pub fn top_providers(&self, n: usize) -> &[ProviderCost] {
+        &self.providers[..n.min(self.providers.len())]
+    }
+
+    /// Cycles spent parsing across all providers.
+    pub fn total_cycles(&self) -> u64 {
+        self.providers.iter().map(|p| p.cycles).sum()
+    }
+}
@@ -0,0 +1,322 @@
+//! Typed views of the category-specific data of a node.
+//!
+//! Each struct mirrors one payload of core/include/exeray/event/payloads/.
+//! Fields named like the C++ ones; `u32` string fields are StringIds, to be
+//! resolved with `Engine::resolve_strings`.
+
+use std::mem::{offset_of, size_of};
+
+use crate::node::EventPayload;
+
+/// File system operation (payloads/file.hpp).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct FilePayload {
+    pub path: u32,
+    pub size: u64,
+    pub attributes: u32,
+    pub ops: u32,
+}
+
+/// Registry operation (payloads/registry.hpp).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct RegistryPayload {
+    pub key_path: u32,
+    pub value_name: u32,
+    pub value_type: u32,
+    pub data_size: u32,
+}
+
+/// Network transfer or connection (payloads/network.hpp).
+///
+/// Addresses are IPv4 in network order unless `family` is
+/// `NetworkPayload::IPV6`, in which case they are StringIds of the text.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct NetworkPayload {
+    pub local_addr: u32,
+    pub remote_addr: u32,
+    pub local_port: u16,
+    pub remote_port: u16,
+    pub bytes: u32,
+    pub protocol: u8,
+    pub family: u8,
+    _pad: [u8; 2],
+}
+
+impl NetworkPayload {
+    /// `family` of IPv4 addresses (0 also means IPv4).
+    pub const IPV4: u8 = 2;
+    /// `family` of IPv6 addresses, stored as interned text.
+    pub const IPV6: u8 = 23;
+}
+
+/// Process lifecycle (payloads/process.hpp).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ProcessPayload {
+    pub pid: u32,
+    pub parent_pid: u32,
+    pub image_path: u32,
+    pub command_line: u32,
+}
+
+/// Scheduled task (payloads/scheduler.hpp).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct SchedulerPayload {
+    pub task_name: u32,
+    pub action: u32,
+    pub trigger_type: u32,
+    _pad: u32,
+}
+
+/// Input hook (payloads/input.hpp).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct InputPayload {
+    pub hook_type: u32,
+    pub target_tid: u32,
+    _pad: u64,
+}
+
+/// Image load or unload (payloads/image.hpp).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ImagePayload {
+    pub image_path: u32,
+    pub process_id: u32,
+    pub base_address: u64,
+    pub size: u32,
+    pub is_suspicious: u8,
+    _pad: [u8; 3],
+}
+
+/// Thread lifecycle (payloads/thread.hpp).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ThreadPayload {
+    pub thread_id: u32,
+    pub process_id: u32,
+    pub start_address: u64,
+    pub creator_pid: u32,
+    pub is_remote: u8,
+    pub start_region: u8,
+    pub start_unbacked: u8,
+    _pad: [u8; 1],
+}
+
+/// Virtual memory operation (payloads/memory.hpp).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct MemoryPayload {
+    pub base_address: u64,
+    pub region_size: u32,
+    pub process_id: u32,
+    pub protection: u32,
+    pub is_suspicious: u8,
+    _pad: [u8; 3],
+}
+
+/// Script block (payloads/script.hpp).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ScriptPayload {
+    pub script_block: u32,
+    pub context: u32,
+    pub sequence: u32,
+    pub is_suspicious: u8,
+    pub is_repeat: u8,
+    _pad: [u8; 2],
+}
+
+/// AMSI scan (payloads/amsi.hpp).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct AmsiPayload {
+    pub content: u32,
+    pub app_name: u32,
+    pub scan_result: u32,
+    pub content_size: u32,
+}
+
+/// DNS query (payloads/dns.hpp).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct DnsPayload {
+    pub domain: u32,
+    pub query_type: u32,
+    pub result_code: u32,
+    pub resolved_ip: u32,
+    pub is_suspicious: u8,
+    _pad: [u8; 3],
+}
+
+/// Security audit event (payloads/security.hpp).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct SecurityPayload {
+    pub subject_user: u32,
+    pub target_user: u32,
+    pub command_line: u32,
+    pub logon_type: u32,
+    pub process_id: u32,
+    pub is_suspicious: u8,
+    _pad: [u8; 3],
+}
+
+/// Service installation or change (payloads/service.hpp).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ServicePayload {
+    pub service_name: u32,
+    pub service_path: u32,
+    pub service_type: u32,
+    pub start_type: u32,
+    pub is_suspicious: u8,
+    _pad: [u8; 3],
+}
+
+/// WMI operation (payloads/wmi.hpp).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct WmiPayload {
+    pub wmi_namespace: u32,
+    pub query: u32,
+    pub target_host: u32,
+    pub is_remote: u8,
+    pub is_suspicious: u8,
+    _pad: [u8; 2],
+}
+
+/// .NET runtime event (payloads/clr.hpp).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ClrPayload {
+    pub assembly_name: u32,
+    pub method_name: u32,
+    pub load_address: u64,
+    pub is_dynamic: u8,
+    pub is_suspicious: u8,
+    _pad: [u8; 2],
+}
+
+/// Event of a runtime-registered manifest provider (payloads/manifest.hpp).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ManifestPayload {
+    pub text: u32,
+    pub detail: u32,
+    pub process_id: u32,
+    pub value: u32,
+    pub provider: u16,
+    pub event_id: u16,
+    pub version: u8,
+    _pad: [u8; 3],
+}
+
+// Sizes from the static_asserts in payload.hpp
+const _: () = {
+    assert!(size_of::<FilePayload>() == 24);
+    assert!(offset_of!(FilePayload, size) == 8);
+    assert!(size_of::<RegistryPayload>() == 16);
+    assert!(size_of::<NetworkPayload>() == 20);
+    assert!(offset_of!(NetworkPayload, bytes) == 12);
+    assert!(offset_of!(NetworkPayload, family) == 17);
+    assert!(size_of::<ProcessPayload>() == 16);
+    assert!(size_of::<SchedulerPayload>() == 16);
+    assert!(size_of::<InputPayload>() == 16);
+    assert!(size_of::<ImagePayload>() == 24);
+    assert!(offset_of!(ImagePayload, base_address) == 8);
+    assert!(size_of::<ThreadPayload>() == 24);
+    assert!(offset_of!(ThreadPayload, start_unbacked) == 22);
+    assert!(size_of::<MemoryPayload>() == 24);
+    assert!(offset_of!(MemoryPayload, protection) == 16);
+    assert!(size_of::<ScriptPayload>() == 16);
+    assert!(size_of::<AmsiPayload>() == 16);
+    assert!(size_of::<DnsPayload>() == 20);
+    assert!(size_of::<SecurityPayload>() == 24);
+    assert!(offset_of!(SecurityPayload, is_suspicious) == 20);
+    assert!(size_of::<ServicePayload>() == 20);
+    assert!(size_of::<WmiPayload>() == 16);
+    assert!(size_of::<ClrPayload>() == 24);
+    assert!(offset_of!(ClrPayload, is_dynamic) == 16);
+    assert!(size_of::<ManifestPayload>() == 24);
+    assert!(offset_of!(ManifestPayload, provider) == 16);
+};
+
+/// The payload of a node, typed by its category.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Payload {
+    File(FilePayload),
+    Registry(RegistryPayload),
+    Network(NetworkPayload),
+    Process(ProcessPayload),
+    Scheduler(SchedulerPayload),
+    Input(InputPayload),
+    Image(ImagePayload),
+    Thread(ThreadPayload),
+    Memory(MemoryPayload),
+    Script(ScriptPayload),
+    Amsi(AmsiPayload),
+    Dns(DnsPayload),
+    Security(SecurityPayload),
+    Service(ServicePayload),
+    Wmi(WmiPayload),
+    Clr(ClrPayload),
+    Manifest(ManifestPayload),
+    /// A category this crate does not know.
+    Unknown,
+}
+
+/// Payload structs that can be read from the union words.
+///
+/// # Safety
+///
+/// Implementors are `#[repr(C)]`, at most 24 bytes with alignment of at
+/// most 8, and made of integers only, so every bit pattern is valid.
+unsafe trait PayloadBits: Copy {}
+
+macro_rules! payload_bits {
+    ($($ty:ty),*) => { $(unsafe impl PayloadBits for $ty {})* };
+}
+
+payload_bits!(
+    FilePayload, RegistryPayload, NetworkPayload, ProcessPayload, SchedulerPayload,
+    InputPayload, ImagePayload, ThreadPayload, MemoryPayload, ScriptPayload, AmsiPayload,
+    DnsPayload, SecurityPayload, ServicePayload, WmiPayload, ClrPayload, ManifestPayload
+);
+
+fn read<T: PayloadBits>(data: &[u64; 3]) -> T {
+    const { assert!(size_of::<T>() <= size_of::<[u64; 3]>()) };
+    // SAFETY: PayloadBits guarantees the size, alignment and validity
+    unsafe { data.as_ptr().cast::<T>().read() }
+}
+
+impl EventPayload {
+    /// Decode the union as the payload of `category`.
+    pub fn decode(&self) -> Payload {
+        let data = &self.data;
+        match self.category {
+            0 => Payload::File(read(data)),
+            1 => Payload::Registry(read(data)),
+            2 => Payload::Network(read(data)),
+            3 => Payload::Process(read(data)),
+            4 => Payload::Scheduler(read(data)),
+            5 => Payload::Input(read(data)),
+            6 => Payload::Image(read(data)),
+            7 => Payload::Thread(read(data)),
+            8 => Payload::Memory(read(data)),
+            9 => Payload::Script(read(data)),
+            10 => Payload::Amsi(read(data)),
+            11 => Payload::Dns(read(data)),
+            12 => Payload::Security(read(data)),
+            13 => Payload::Service(read(data)),
+            14 => Payload::Wmi(read(data)),
+            15 => Payload::Clr(read(data)),
+            16 => Payload::Manifest(read(data)),
+            _ => Payload::Unknown,
+        }
+    }
+}
@@ -0,0 +1,18 @@
+//! Process incarnations of a session, as a tree.
+
+/// One process incarnation from `exeray::event::ProcessTreeNode`.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct ProcessNode {
+    /// ProcessCreate event ID (the node key).
+    pub create: u64,
+    /// Parent's ProcessCreate event ID, 0 for roots.
+    pub parent: u64,
+    pub pid: u32,
+    /// 0 for roots.
+    pub depth: u32,
+    pub stopped: bool,
+    /// Correlated events of this process.
+    pub events: u64,
+    /// Events of this process and all its descendants.
+    pub subtree_events: u64,
+}
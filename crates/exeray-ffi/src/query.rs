@@ -0,0 +1,177 @@
+//! Queries filtered inside the C++ engine.
+
+use cxx::{ExternType, type_id};
+
+use crate::engine::events::{category_from_u8, status_from_u8};
+use crate::ffi::{Category, Status};
+
+/// Declarative event query, run by `Engine::query`.
+///
+/// Mirrors `exeray::QuerySpec`; builders narrow the filter like those of
+/// `exeray::event::Query`, every field left untouched matches anything.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct QuerySpec {
+    from: u64,
+    to: u64,
+    categories: u32,
+    statuses: u32,
+    pid: u32,
+    correlation_id: u32,
+    operation: i16,
+    remote_port: u16,
+    newest_first: u8,
+    reserved: [u8; 3],
+}
+
+impl Default for QuerySpec {
+    fn default() -> Self {
+        Self {
+            from: 0,
+            to: u64::MAX,
+            categories: 0,
+            statuses: 0,
+            pid: 0,
+            correlation_id: 0,
+            operation: -1,
+            remote_port: 0,
+            newest_first: 0,
+            reserved: [0; 3],
+        }
+    }
+}
+
+impl QuerySpec {
+    /// Add a category to the accepted set.
+    pub fn category(mut self, category: Category) -> Self {
+        self.categories |= 1u32 << category.repr;
+        self
+    }
+
+    /// Require an operation code.
+    pub fn operation(mut self, operation: u8) -> Self {
+        self.operation = i16::from(operation);
+        self
+    }
+
+    /// Add a status to the accepted set.
+    pub fn status(mut self, status: Status) -> Self {
+        self.statuses |= 1u32 << status.repr;
+        self
+    }
+
+    /// Require a process ID (the payload's own, as the C++ event_pid()).
+    pub fn pid(mut self, pid: u32) -> Self {
+        self.pid = pid;
+        self
+    }
+
+    /// Require a network remote port.
+    pub fn remote_port(mut self, port: u16) -> Self {
+        self.remote_port = port;
+        self
+    }
+
+    /// Require a correlation ID.
+    pub fn correlation(mut self, id: u32) -> Self {
+        self.correlation_id = id;
+        self
+    }
+
+    /// Restrict timestamps to `[from, to]`.
+    pub fn between(mut self, from: u64, to: u64) -> Self {
+        self.from = from;
+        self.to = to;
+        self
+    }
+
+    /// Restrict timestamps to `[from, +inf)`.
+    pub fn since(mut self, from: u64) -> Self {
+        self.from = from;
+        self
+    }
+
+    /// Return the newest matches first.
+    pub fn newest_first(mut self) -> Self {
+        self.newest_first = 1;
+        self
+    }
+}
+
+/// Indexed fields of one matching event.
+///
+/// Mirrors `exeray::event::QueryRow`; the payload is one
+/// `Engine::segment_view(id - 1)` away.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct QueryRow {
+    pub id: u64,
+    pub timestamp: u64,
+    pub pid: u32,
+    pub correlation_id: u32,
+    pub remote_port: u16,
+    category: u8,
+    pub operation: u8,
+    status: u8,
+}
+
+impl QueryRow {
+    /// Event category.
+    pub fn category(&self) -> Category {
+        category_from_u8(self.category)
+    }
+
+    /// Operation result status.
+    pub fn status(&self) -> Status {
+        status_from_u8(self.status)
+    }
+}
+
+/// Key a live view is sorted by (ties in event ID order).
+///
+/// Mirrors `exeray::event::ViewSort`.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+#[repr(u8)]
+pub enum ViewSort {
+    /// Arrival order.
+    Id = 0,
+    /// Event time.
+    #[default]
+    Timestamp = 1,
+    /// Process ID of the payload.
+    Pid = 2,
+}
+
+/// A live view opened by `Engine::open_view`.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct ViewId {
+    pub(crate) index: usize,
+    pub(crate) page_size: usize,
+}
+
+impl ViewId {
+    /// Rows per page.
+    pub fn page_size(&self) -> usize {
+        self.page_size
+    }
+}
+
+const _: () = {
+    assert!(std::mem::size_of::<QuerySpec>() == 40);
+    assert!(std::mem::size_of::<QueryRow>() == 32);
+    assert!(std::mem::offset_of!(QueryRow, remote_port) == 24);
+    assert!(std::mem::offset_of!(QueryRow, status) == 28);
+};
+
+// SAFETY: QuerySpec and QueryRow have the #[repr(C)] layouts of
+// exeray::QuerySpec and exeray::event::QueryRow (checked on both sides),
+// and every bit pattern is valid (enums are kept as raw u8).
+unsafe impl ExternType for QuerySpec {
+    type Id = type_id!("exeray::QuerySpec");
+    type Kind = cxx::kind::Trivial;
+}
+
+unsafe impl ExternType for QueryRow {
+    type Id = type_id!("exeray::QueryRow");
+    type Kind = cxx::kind::Trivial;
+}
@@ -0,0 +1,12 @@
+//! Decaying risk scores of processes and correlation chains.
+
+/// One process or chain from `exeray::event::RiskScore`.
+#[derive(Debug, Clone, PartialEq)]
+pub struct RiskScore {
+    /// PID, or correlation ID for chains.
+    pub key: u32,
+    /// Suspicious events counted, halved every half-life.
+    pub score: f64,
+    /// Suspicious events counted without decay.
+    pub events: u64,
+}
@@ -0,0 +1,28 @@
+//! ETW session statistics.
+
+/// Cumulative counters of the current or last monitoring session.
+///
+/// Non-zero `events_lost` or `buffers_lost` means ETW dropped data; raise
+/// the session buffers or reduce the enabled providers.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct SessionStats {
+    /// Events ETW dropped because no buffer was free.
+    pub events_lost: u64,
+    /// Real-time buffers dropped before delivery.
+    pub buffers_lost: u64,
+    /// Buffers filled by the session.
+    pub buffers_written: u64,
+    /// Buffers delivered to the consumer.
+    pub buffers_read: u64,
+    /// Buffers currently unused.
+    pub free_buffers: u32,
+    /// Buffers currently allocated.
+    pub buffers: u32,
+}
+
+impl SessionStats {
+    /// Whether ETW dropped any events or buffers.
+    pub fn has_loss(&self) -> bool {
+        self.events_lost > 0 || self.buffers_lost > 0
+    }
+}
@@ -0,0 +1,135 @@
+//! Dashboard counters taken in one FFI call.
+
+use cxx::{ExternType, type_id};
+
+use crate::ffi::Category;
+
+/// Number of event categories counted per snapshot.
+pub const STATS_CATEGORIES: usize = 17;
+
+/// Most processes a snapshot ranks.
+pub const STATS_TOP_PIDS: usize = 8;
+
+/// Counters for a live dashboard, from `Engine::stats_snapshot`.
+///
+/// Mirrors `exeray::StatsSnapshot`. Read from push-time counters, not a
+/// graph scan, so polling at 10 Hz does not slow ingest. Cumulative fields
+/// never decrease; use `events_per_sec` and friends on two snapshots for
+/// rates.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct StatsSnapshot {
+    /// Steady clock when taken.
+    pub taken_ns: u64,
+    /// Events stored per category, cumulative.
+    pub pushed: [u64; STATS_CATEGORIES],
+    /// Live events per category.
+    pub live: [u64; STATS_CATEGORIES],
+    /// Events marked Suspicious, cumulative.
+    pub flagged: u64,
+    /// Live events with `Status::Suspicious`.
+    pub live_suspicious: u64,
+    /// Events ETW could not buffer in the current session.
+    pub events_lost: u64,
+    /// Real-time buffers dropped before delivery.
+    pub buffers_lost: u64,
+    /// Records dropped because the record ring was full.
+    pub ring_overflows: u64,
+    /// Events dropped by load shedding.
+    pub shed: u64,
+    top_pids: [u32; STATS_TOP_PIDS],
+    top_counts: [u64; STATS_TOP_PIDS],
+    top_len: u32,
+    reserved: u32,
+}
+
+impl Default for StatsSnapshot {
+    fn default() -> Self {
+        Self {
+            taken_ns: 0,
+            pushed: [0; STATS_CATEGORIES],
+            live: [0; STATS_CATEGORIES],
+            flagged: 0,
+            live_suspicious: 0,
+            events_lost: 0,
+            buffers_lost: 0,
+            ring_overflows: 0,
+            shed: 0,
+            top_pids: [0; STATS_TOP_PIDS],
+            top_counts: [0; STATS_TOP_PIDS],
+            top_len: 0,
+            reserved: 0,
+        }
+    }
+}
+
+const _: () = {
+    assert!(std::mem::size_of::<StatsSnapshot>() == 432);
+    assert!(std::mem::offset_of!(StatsSnapshot, top_counts) == 360);
+};
+
+// SAFETY: StatsSnapshot has the #[repr(C)] layout of exeray::StatsSnapshot
+// (checked on both sides) and every bit pattern is valid.
+unsafe impl ExternType for StatsSnapshot {
+    type Id = type_id!("exeray::StatsSnapshot");
+    type Kind = cxx::kind::Trivial;
+}
+
+impl StatsSnapshot {
+    /// Events stored overall, cumulative.
+    pub fn total_pushed(&self) -> u64 {
+        self.pushed.iter().sum()
+    }
+
+    /// Events dropped before reaching the graph, cumulative.
+    pub fn dropped(&self) -> u64 {
+        self.events_lost + self.ring_overflows + self.shed
+    }
+
+    /// Processes with the most live events, as (pid, events), most first.
+    pub fn top_processes(&self) -> impl Iterator<Item = (u32, u64)> + '_ {
+        let len = (self.top_len as usize).min(STATS_TOP_PIDS);
+        self.top_pids[..len]
+            .iter()
+            .copied()
+            .zip(self.top_counts[..len].iter().copied())
+    }
+
+    /// Seconds between `earlier` and this snapshot (0 if not later).
+    fn seconds_since(&self, earlier: &StatsSnapshot) -> f64 {
+        self.taken_ns.saturating_sub(earlier.taken_ns) as f64 / 1e9
+    }
+
+    fn rate(&self, earlier: &StatsSnapshot, now: u64, then: u64) -> f64 {
+        let seconds = self.seconds_since(earlier);
+        if seconds > 0.0 {
+            now.saturating_sub(then) as f64 / seconds
+        } else {
+            0.0
+        }
+    }
+
+    /// Events per second of `category` stored since `earlier`.
+    pub fn events_per_sec(&self, earlier: &StatsSnapshot, category: Category) -> f64 {
+        let c = usize::from(category.repr);
+        match (self.pushed.get(c), earlier.pushed.get(c)) {
+            (Some(&now), Some(&then)) => self.rate(earlier, now, then),
+            _ => 0.0,
+        }
+    }
+
+    /// Events per second of all categories stored since `earlier`.
+    pub fn total_per_sec(&self, earlier: &StatsSnapshot) -> f64 {
+        self.rate(earlier, self.total_pushed(), earlier.total_pushed())
+    }
+
+    /// Events per second marked Suspicious since `earlier`.
+    pub fn suspicious_per_sec(&self, earlier: &StatsSnapshot) -> f64 {
+        self.rate(earlier, self.flagged, earlier.flagged)
+    }
+
+    /// Events per second dropped since `earlier`.
+    pub fn dropped_per_sec(&self, earlier: &StatsSnapshot) -> f64 {
+        self.rate(earlier, self.dropped(), earlier.dropped())
+    }
+}
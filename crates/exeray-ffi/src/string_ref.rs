@@ -0,0 +1,48 @@
+//! Interned strings borrowed in place from arena memory.
+
+use cxx::{ExternType, type_id};
+
+/// UTF-8 bytes of one interned string, filled in bulk by the C++ side.
+///
+/// Mirrors `exeray::StringRef` in ffi.hpp. Only meaningful while the
+/// engine that resolved it is borrowed; use `Engine::resolve_strings`.
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct StringRef {
+    data: *const u8,
+    length: usize,
+}
+
+impl Default for StringRef {
+    fn default() -> Self {
+        Self {
+            data: std::ptr::null(),
+            length: 0,
+        }
+    }
+}
+
+impl StringRef {
+    /// The referenced bytes.
+    ///
+    /// # Safety
+    ///
+    /// The engine that filled this must still be alive and not reset.
+    pub(crate) unsafe fn bytes<'a>(&self) -> &'a [u8] {
+        if self.data.is_null() || self.length == 0 {
+            return &[];
+        }
+        // SAFETY: the C++ side points into arena memory that outlives the
+        // caller's borrow of the engine
+        unsafe { std::slice::from_raw_parts(self.data, self.length) }
+    }
+}
+
+// SAFETY: StringRef has the same #[repr(C)] layout as exeray::StringRef
+// (statically asserted to 16 bytes on the C++ side) and no invariants.
+unsafe impl ExternType for StringRef {
+    type Id = type_id!("exeray::StringRef");
+    type Kind = cxx::kind::Trivial;
+}
+
+const _: () = assert!(std::mem::size_of::<StringRef>() == 16);
@@ -0,0 +1,30 @@
+//! Resource use of the launched target processes.
+
+/// CPU time, I/O and peak memory of the targets' job objects.
+///
+/// Summed over the launched targets; attached processes have no job and
+/// are not counted.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct TargetUsage {
+    /// CPU time in user mode (ns).
+    pub user_ns: u64,
+    /// CPU time in kernel mode (ns).
+    pub kernel_ns: u64,
+    pub read_bytes: u64,
+    pub write_bytes: u64,
+    /// I/O that is neither read nor write (device control...).
+    pub other_bytes: u64,
+    /// Highest committed memory of one process (bytes).
+    pub peak_process_memory: u64,
+    /// Highest committed memory of one target's whole job (bytes).
+    pub peak_job_memory: u64,
+    /// Processes still running in the jobs.
+    pub active_processes: u32,
+}
+
+impl TargetUsage {
+    /// Total CPU time, user and kernel (ns).
+    pub fn cpu_ns(&self) -> u64 {
+        self.user_ns + self.kernel_ns
+    }
+}
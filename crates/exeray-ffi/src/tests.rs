@@ -3,7 +3,17 @@
 #![cfg(test)]
 
 use crate::engine::Engine;
+use crate::event::EventRecord;
 use crate::ffi::{Category, Status};
+use crate::latency::{LatencyStage, LatencySummary};
+use crate::memory::ArenaUsage;
+use crate::node::EventPayload;
+use crate::parse_metrics::{CYCLE_BUCKETS, ParseMetrics, ProviderCost, provider_name};
+use crate::payload::{NetworkPayload, Payload};
+use crate::query::{QuerySpec, ViewSort};
+use crate::session::SessionStats;
+use crate::stats::StatsSnapshot;
+use crate::target_usage::TargetUsage;
 
 #[test]
 fn test_event_count_initially_zero() {
@@ -24,6 +34,119 @@ fn test_iter_events_empty() {
     assert_eq!(engine.iter_events().count(), 0);
 }
 
+#[test]
+fn test_copy_events_empty() {
+    let engine = Engine::new(64, 1);
+    let mut out = [EventRecord::default(); 8];
+    assert_eq!(engine.copy_events(0, &mut out), 0);
+    assert_eq!(std::mem::size_of::<EventRecord>(), 32);
+}
+
+#[test]
+fn test_payload_decode_network_words() {
+    // SAFETY: EventPayload is plain integers
+    let mut payload: EventPayload = unsafe { std::mem::zeroed() };
+    payload.category = Category::Network.repr;
+    payload.data[0] = 0x0100_007F | (0x0808_0808 << 32);
+    payload.data[1] = 50_000 | (443 << 16) | (1500 << 32);
+    payload.data[2] = 6 | (u64::from(NetworkPayload::IPV4) << 8);
+    let Payload::Network(network) = payload.decode() else {
+        panic!("expected a network payload");
+    };
+    assert_eq!(network.local_addr, 0x0100_007F);
+    assert_eq!(network.remote_addr, 0x0808_0808);
+    assert_eq!(network.local_port, 50_000);
+    assert_eq!(network.remote_port, 443);
+    assert_eq!(network.bytes, 1500);
+    assert_eq!(network.protocol, 6);
+    assert_eq!(network.family, NetworkPayload::IPV4);
+
+    payload.category = 200;
+    assert_eq!(payload.decode(), Payload::Unknown);
+}
+
+#[test]
+fn test_query_empty_graph() {
+    let engine = Engine::new(64, 1);
+    let spec = QuerySpec::default()
+        .category(Category::Network)
+        .remote_port(443)
+        .newest_first();
+    assert!(engine.query(&spec, 100).is_empty());
+    assert_eq!(engine.query_into(&QuerySpec::default(), &mut []), 0);
+}
+
+#[test]
+fn test_live_view_empty_graph() {
+    let mut engine = Engine::new(64, 1);
+    let spec = QuerySpec::default().status(Status::Suspicious).newest_first();
+    let view = engine.open_view(&spec, ViewSort::Timestamp, 25);
+    assert_eq!(view.page_size(), 25);
+    assert_eq!(engine.refresh_view(view), 0);
+    assert_eq!(engine.view_pages(view), 0);
+    assert!(engine.view_page(view, 0).is_empty());
+    engine.close_view(view);
+    assert_eq!(engine.refresh_view(view), 0);
+}
+
+#[test]
+fn test_stats_snapshot_initially_zero() {
+    let engine = Engine::new(64, 1);
+    let first = engine.stats_snapshot();
+    assert_eq!(first.total_pushed(), 0);
+    assert_eq!(first.dropped(), 0);
+    assert_eq!(first.top_processes().count(), 0);
+    let second = engine.stats_snapshot();
+    assert!(second.taken_ns >= first.taken_ns);
+    assert_eq!(second.total_per_sec(&first), 0.0);
+}
+
+#[test]
+fn test_stats_snapshot_rates() {
+    let mut earlier = StatsSnapshot::default();
+    earlier.taken_ns = 1_000_000_000;
+    let mut later = earlier;
+    later.taken_ns = 1_500_000_000;
+    later.pushed[Category::Network.repr as usize] = 500;
+    later.flagged = 50;
+    later.shed = 10;
+    assert_eq!(later.events_per_sec(&earlier, Category::Network), 1000.0);
+    assert_eq!(later.events_per_sec(&earlier, Category::Process), 0.0);
+    assert_eq!(later.total_per_sec(&earlier), 1000.0);
+    assert_eq!(later.suspicious_per_sec(&earlier), 100.0);
+    assert_eq!(later.dropped_per_sec(&earlier), 20.0);
+    assert_eq!(earlier.total_per_sec(&later), 0.0);  // Not later
+}
+
+#[test]
+fn test_resolve_strings_invalid_is_empty() {
+    let engine = Engine::new(64, 1);
+    let strings = engine.resolve_strings(&[0, u32::MAX, 12345]);
+    assert_eq!(strings.len(), 3);
+    assert!(strings.iter().all(|s| s.is_empty()));
+    assert_eq!(engine.resolve_string(0), "");
+}
+
+#[test]
+fn test_events_since_empty_keeps_cursor() {
+    let mut engine = Engine::new(64, 1);
+    let (events, cursor) = engine.events_since(0, 64);
+    assert!(events.is_empty());
+    assert_eq!(cursor, 0);
+    // A cursor from before a reset starts over
+    assert_eq!(engine.events_since(42, 64).1, 0);
+    assert!(!engine.wait_for_events(0, std::time::Duration::from_millis(1)));
+}
+
+#[test]
+fn test_node_segments_empty() {
+    let engine = Engine::new(64, 1);
+    let view = engine.segment_view(0);
+    assert!(view.nodes().is_empty());
+    assert!(view.is_current());
+    assert_eq!(engine.node_segments().count(), 0);
+}
+
 #[test]
 fn test_category_enum_values() {
     assert_eq!(Category::FileSystem.repr, 0);
@@ -49,6 +172,21 @@ fn test_start_stop_monitoring_api_exists() {
     engine.stop_monitoring();
 }
 
+#[test]
+fn test_attach_api_exists() {
+    let mut engine = Engine::new(64, 1);
+    let _ = engine.attach(0, true);
+    engine.stop_monitoring();
+}
+
+#[test]
+fn test_target_usage_zero_without_targets() {
+    let mut engine = Engine::new(64, 1);
+    let usage = engine.target_usage();
+    assert_eq!(usage, TargetUsage::default());
+    assert_eq!(usage.cpu_ns(), 0);
+}
+
 #[test]
 fn test_freeze_unfreeze_api_exists() {
     let mut engine = Engine::new(64, 1);
@@ -68,3 +206,109 @@ fn test_target_state_api_exists() {
     assert_eq!(engine.target_pid(), 0);
     assert!(!engine.target_running());
 }
+
+#[test]
+fn test_eviction_state_initially_empty() {
+    let engine = Engine::new(64, 1);
+    assert_eq!(engine.first_event_index(), 0);
+    assert_eq!(engine.event_epoch(), 0);
+    assert!(!engine.iter_events().evicted());
+}
+
+#[test]
+fn test_memory_stats_initial() {
+    let engine = Engine::new(64, 1);
+    let stats = engine.memory_stats();
+    assert_eq!(stats.events.capacity, 64 * 1024 * 1024);
+    assert_eq!(stats.events.failures, 0);
+    assert!(stats.strings_shared);
+    assert_eq!(stats.strings, stats.events);
+    assert_eq!(stats.event_count, 0);
+    assert!(!stats.near_exhaustion(0.9));
+}
+
+#[test]
+fn test_arena_usage_headroom() {
+    let usage = ArenaUsage {
+        used: 75,
+        capacity: 100,
+        ..ArenaUsage::default()
+    };
+    assert_eq!(usage.headroom(), 25);
+    assert!((usage.fill_ratio() - 0.75).abs() < f64::EPSILON);
+}
+
+#[test]
+fn test_session_stats_initially_zero() {
+    let engine = Engine::new(64, 1);
+    let stats = engine.session_stats();
+    assert_eq!(stats, SessionStats::default());
+    assert!(!stats.has_loss());
+}
+
+#[test]
+fn test_session_stats_has_loss() {
+    let stats = SessionStats {
+        buffers_lost: 1,
+        ..SessionStats::default()
+    };
+    assert!(stats.has_loss());
+}
+
+#[test]
+fn test_parse_metrics_initially_empty() {
+    let mut engine = Engine::new(64, 1);
+    let metrics = engine.parse_metrics();
+    assert!(metrics.events.is_empty());
+    assert_eq!(metrics.untracked, 0);
+}
+
+#[test]
+fn test_provider_cost_summaries() {
+    let mut histogram = [0; CYCLE_BUCKETS];
+    histogram[4] = 9; // [8, 16) cycles
+    histogram[10] = 1; // [512, 1024) cycles
+    let cost = ProviderCost {
+        provider: 1,
+        events: 10,
+        failures: 0,
+        cycles: 1000,
+        histogram,
+    };
+    assert_eq!(cost.name(), "File");
+    assert_eq!(cost.mean_cycles(), 100);
+    assert_eq!(cost.percentile_cycles(0.5), 16);
+    assert_eq!(cost.percentile_cycles(0.99), 1024);
+
+    let metrics = ParseMetrics {
+        providers: vec![cost],
+        ..ParseMetrics::default()
+    };
+    assert_eq!(metrics.top_providers(5).len(), 1);
+    assert_eq!(metrics.total_cycles(), 1000);
+    assert_eq!(provider_name(200), "Unknown");
+}
+
+#[test]
+fn test_ingest_latency_initially_empty() {
+    let engine = Engine::new(64, 1);
+    assert!(
+        engine
+            .ingest_latency(LatencyStage::Visible, Category::Process)
+            .is_empty()
+    );
+    assert_eq!(
+        engine.ingest_latency_all(LatencyStage::Delivered),
+        LatencySummary::default()
+    );
+}
+
+#[test]
+fn test_latency_summary_p99_ms() {
+    let summary = LatencySummary {
+        count: 1,
+        p99: 2_500_000,
+        ..LatencySummary::default()
+    };
+    assert!((summary.p99_ms() - 2.5).abs() < f64::EPSILON);
+}
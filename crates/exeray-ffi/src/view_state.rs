@@ -1,6 +1,7 @@
 //! Engine view state for UI updates.
 
 /// Engine view state for UI updates.
+#[derive(Clone, Copy, Debug, PartialEq)]
 pub struct ViewState {
     pub generation: u64,
     pub timestamp_ns: u64,
@@ -0,0 +1,45 @@
+//! Conversion of event timestamps to wall-clock time.
+
+use cxx::{ExternType, type_id};
+
+/// Anchor between event timestamps (steady clock ns) and the Unix epoch.
+///
+/// Mirrors `exeray::WallClock`. Taken once per session with
+/// `Engine::wall_clock`; `to_unix` is then one add per event, with no FFI
+/// call.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct WallClock {
+    /// Event timestamp at the anchor point.
+    pub graph_anchor: u64,
+    /// Unix-epoch nanoseconds at the anchor point (0 = unknown).
+    pub unix_anchor: u64,
+}
+
+impl WallClock {
+    /// Whether the anchor was captured (a session has started).
+    pub fn is_valid(&self) -> bool {
+        self.unix_anchor != 0
+    }
+
+    /// Convert an event timestamp to Unix-epoch nanoseconds.
+    ///
+    /// Returns 0 while the anchor is unknown; clamps at 0 instead of
+    /// wrapping.
+    #[inline]
+    pub fn to_unix(&self, timestamp: u64) -> u64 {
+        if self.unix_anchor == 0 {
+            return 0;
+        }
+        if timestamp >= self.graph_anchor {
+            self.unix_anchor + (timestamp - self.graph_anchor)
+        } else {
+            self.unix_anchor.saturating_sub(self.graph_anchor - timestamp)
+        }
+    }
+}
+
+unsafe impl ExternType for WallClock {
+    type Id = type_id!("exeray::WallClock");
+    type Kind = cxx::kind::Trivial;
+}
@@ -1,38 +1,111 @@
-use exeray_ffi::{Engine, ViewState};
+use exeray_ffi::{Engine, StatsSnapshot, ViewState};
+use std::sync::Arc;
 
+use crate::poller::{Command, Poller, Snapshot};
+
+/// Render-side view of the engine.
+///
+/// All engine calls run on the poller thread; the app keeps the latest
+/// snapshot it published and forwards user actions as commands.
 pub struct App {
-    engine: Engine,
-    state: ViewState,
+    poller: Poller,
+    snapshot: Arc<Snapshot>,
+    /// Event rows on screen at the last draw.
+    event_rows: usize,
+    show_stats: bool,
 }
 
 impl App {
     pub fn new(arena_mb: usize, threads: usize) -> Self {
+        let poller = Poller::spawn(Engine::new(arena_mb, threads));
+        let snapshot = poller.latest();
         Self {
-            engine: Engine::new(arena_mb, threads),
-            state: ViewState {
-                generation: 0,
-                timestamp_ns: 0,
-                flags: 0,
-                progress: 0.0,
-            },
+            poller,
+            snapshot,
+            event_rows: 0,
+            show_stats: false,
         }
     }
 
     pub fn start(&mut self) {
-        if self.engine.idle() || self.state.is_complete() {
-            self.engine.submit();
+        self.poller.send(Command::Start);
+    }
+
+    /// Take the latest snapshot if the poller published a new one.
+    /// Returns true if there is anything new to render.
+    pub fn tick(&mut self) -> bool {
+        if self.poller.version() == self.snapshot.version {
+            return false;
         }
+        self.snapshot = self.poller.latest();
+        true
+    }
+
+    /// Switch between the event list and the dashboard.
+    pub fn toggle_stats(&mut self) {
+        self.show_stats = !self.show_stats;
+        self.poller.send(Command::ShowStats(self.show_stats));
+    }
+
+    /// Write the recent hot-path spans for Perfetto or chrome://tracing.
+    pub fn dump_spans(&mut self) {
+        self.poller.send(Command::DumpSpans);
+    }
+
+    pub fn notice(&self) -> Option<&str> {
+        self.snapshot.notice.as_deref()
+    }
+
+    pub fn showing_stats(&self) -> bool {
+        self.show_stats
+    }
+
+    /// Latest dashboard snapshot and the one before it.
+    pub fn stats(&self) -> (&StatsSnapshot, &StatsSnapshot) {
+        (&self.snapshot.stats, &self.snapshot.stats_prev)
     }
 
-    pub fn tick(&mut self) {
-        self.state = self.engine.poll();
+    /// Scroll the event list by `rows` (negative is towards older events).
+    pub fn scroll_events(&mut self, rows: isize) {
+        self.poller.send(Command::Scroll(rows));
+    }
+
+    /// Scroll the event list by whole screens.
+    pub fn page_events(&mut self, pages: isize) {
+        self.poller.send(Command::Page(pages));
+    }
+
+    pub fn events_home(&mut self) {
+        self.poller.send(Command::Home);
+    }
+
+    pub fn events_end(&mut self) {
+        self.poller.send(Command::End);
+    }
+
+    pub fn following_events(&self) -> bool {
+        self.snapshot.following
+    }
+
+    /// Formatted rows of the events on screen; a new `height` is passed
+    /// on and shows from the next snapshot.
+    pub fn visible_events(&mut self, height: usize) -> Vec<&str> {
+        if height != self.event_rows {
+            self.event_rows = height;
+            self.poller.send(Command::Rows(height));
+        }
+        self.snapshot.rows.iter().take(height).map(String::as_str).collect()
     }
 
     pub fn state(&self) -> &ViewState {
-        &self.state
+        &self.snapshot.state
+    }
+
+    pub fn events_seen(&self) -> u64 {
+        self.snapshot.events_seen
     }
 
     pub fn threads(&self) -> usize {
-        self.engine.threads()
+        self.snapshot.threads
     }
 }
@@ -0,0 +1,104 @@
+//! Virtualized event list: only the visible window is fetched and formatted.
+
+use std::collections::HashMap;
+
+use exeray_ffi::Engine;
+use exeray_ffi::event::{Event, EventRecord};
+
+/// Scrollable window over the engine's events.
+///
+/// Each frame copies just the rows on screen through one `copy_events`
+/// call and formats only the rows not formatted before, so drawing costs
+/// the same with a hundred events as with millions.
+pub struct EventList {
+    /// Absolute index of the top row, when not following.
+    top: usize,
+    /// Stick to the newest events.
+    follow: bool,
+    records: Vec<EventRecord>,
+    /// Formatted rows by event ID; only the last window is kept.
+    cache: HashMap<u64, String>,
+}
+
+impl EventList {
+    pub fn new() -> Self {
+        Self {
+            top: 0,
+            follow: true,
+            records: Vec::new(),
+            cache: HashMap::new(),
+        }
+    }
+
+    /// Move the window by `rows` (negative is towards older events).
+    ///
+    /// Scrolling to the newest event resumes following.
+    pub fn scroll(&mut self, engine: &Engine, rows: isize, height: usize) {
+        let (first, last_top) = bounds(engine, height);
+        let top = if self.follow { last_top } else { self.top };
+        self.top = top.saturating_add_signed(rows).clamp(first, last_top);
+        self.follow = self.top == last_top;
+    }
+
+    /// Jump to the oldest event and stop following.
+    pub fn home(&mut self, engine: &Engine) {
+        self.top = engine.first_event_index();
+        self.follow = false;
+    }
+
+    /// Jump to the newest event and follow it.
+    pub fn end(&mut self) {
+        self.follow = true;
+    }
+
+    /// Whether the window sticks to the newest events.
+    pub fn following(&self) -> bool {
+        self.follow
+    }
+
+    /// Fetch and format the `height` rows on screen.
+    pub fn window(&mut self, engine: &Engine, height: usize) -> impl Iterator<Item = &str> {
+        let (first, last_top) = bounds(engine, height);
+        self.top = if self.follow {
+            last_top
+        } else {
+            self.top.clamp(first, last_top)
+        };
+
+        self.records.resize(height, EventRecord::default());
+        let len = engine.copy_events(self.top, &mut self.records);
+        let records = &self.records[..len];
+
+        // The window is a run of consecutive IDs: drop what scrolled out
+        if let (Some(lo), Some(hi)) = (records.first(), records.last()) {
+            self.cache.retain(|id, _| (lo.id..=hi.id).contains(id));
+        } else {
+            self.cache.clear();
+        }
+        for record in records {
+            self.cache
+                .entry(record.id)
+                .or_insert_with(|| format_row(&Event::from(*record)));
+        }
+        records.iter().map(|record| self.cache[&record.id].as_str())
+    }
+}
+
+/// Oldest index and the top index that shows the newest event last.
+fn bounds(engine: &Engine, height: usize) -> (usize, usize) {
+    let first = engine.first_event_index();
+    let end = first + engine.event_count();
+    (first, end.saturating_sub(height).max(first))
+}
+
+fn format_row(event: &Event) -> String {
+    format!(
+        "{:>10}  {:>20}  {:<10} {:<10} op {:>3}  parent {}",
+        event.id,
+        event.timestamp,
+        format!("{:?}", event.category),
+        format!("{:?}", event.status),
+        event.operation,
+        event.parent_id,
+    )
+}
@@ -1,4 +1,6 @@
 mod app;
+mod event_list;
+mod poller;
 mod ui;
 
 use anyhow::Result;
@@ -9,7 +11,10 @@ use crossterm::{
 };
 use ratatui::prelude::*;
 use std::io::stdout;
-use std::time::Duration;
+use std::time::{Duration, Instant};
+
+/// Shortest time between two redraws.
+const FRAME: Duration = Duration::from_millis(16);
 
 fn main() -> Result<()> {
     enable_raw_mode()?;
@@ -25,22 +30,43 @@ fn main() -> Result<()> {
 
 fn run<B: Backend>(terminal: &mut Terminal<B>) -> Result<()> {
     let mut app = app::App::new(64, 0);
+    let mut dirty = true;
+    let mut next_frame = Instant::now();
 
     loop {
-        terminal.draw(|f| ui::render(&app, f))?;
-
-        if event::poll(Duration::from_millis(16))?
-            && let Event::Key(key) = event::read()?
-            && key.kind == KeyEventKind::Press
-        {
-            match key.code {
-                KeyCode::Char('q') | KeyCode::Esc => break,
-                KeyCode::Char(' ') => app.start(),
-                _ => {}
+        if dirty {
+            terminal.draw(|f| ui::render(&mut app, f))?;
+            dirty = false;
+            next_frame = Instant::now() + FRAME;
+        }
+
+        // Input until the next frame is due, then a frame at a time until
+        // the poller publishes a snapshot
+        let until_frame = next_frame.saturating_duration_since(Instant::now());
+        let wait = if until_frame.is_zero() { FRAME } else { until_frame };
+        if event::poll(wait)? {
+            if let Event::Key(key) = event::read()?
+                && key.kind == KeyEventKind::Press
+            {
+                match key.code {
+                    KeyCode::Char('q') | KeyCode::Esc => break,
+                    KeyCode::Char(' ') => app.start(),
+                    KeyCode::Tab => app.toggle_stats(),
+                    KeyCode::Char('t') => app.dump_spans(),
+                    KeyCode::Up => app.scroll_events(-1),
+                    KeyCode::Down => app.scroll_events(1),
+                    KeyCode::PageUp => app.page_events(-1),
+                    KeyCode::PageDown => app.page_events(1),
+                    KeyCode::Home => app.events_home(),
+                    KeyCode::End => app.events_end(),
+                    _ => {}
+                }
             }
+            dirty = true;
+            continue;
         }
 
-        app.tick();
+        dirty = app.tick();
     }
 
     Ok(())
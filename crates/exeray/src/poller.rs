@@ -0,0 +1,266 @@
+//! Engine polling off the render thread.
+//!
+//! Polling on the render thread made every slow FFI call delay drawing,
+//! and every draw delay polling. The poller thread owns the engine instead:
+//! it waits for events, takes the delta and the dashboard counters, formats
+//! the rows on screen and publishes them as one immutable `Snapshot`. The
+//! render loop only picks up the latest snapshot and sends what the user
+//! asked for as `Command`s.
+
+use exeray_ffi::{Engine, StatsSnapshot, ViewState};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::mpsc::{self, Receiver, Sender, TryRecvError};
+use std::sync::{Arc, Mutex};
+use std::thread::{self, JoinHandle};
+use std::time::{Duration, Instant};
+
+use crate::event_list::EventList;
+
+/// Most events taken from the engine per poll, bounding the work a burst
+/// can cause.
+const MAX_EVENTS_PER_POLL: usize = 4096;
+
+/// Longest wait for events; commands are picked up at least this often.
+const POLL_WAIT: Duration = Duration::from_millis(16);
+
+/// Time between two dashboard snapshots (10 Hz).
+const STATS_INTERVAL: Duration = Duration::from_millis(100);
+
+/// Where `DumpSpans` writes the hot-path span trace.
+const SPANS_FILE: &str = "exeray_spans.json";
+
+/// What the render thread asks of the engine.
+pub enum Command {
+    /// Submit work if the engine is idle or done.
+    Start,
+    /// Move the event list by rows (negative is towards older events).
+    Scroll(isize),
+    /// Move the event list by whole screens.
+    Page(isize),
+    Home,
+    End,
+    /// Event rows on screen.
+    Rows(usize),
+    /// Whether the dashboard is shown (its counters then cause redraws).
+    ShowStats(bool),
+    /// Write the recent hot-path spans for Perfetto or chrome://tracing.
+    DumpSpans,
+}
+
+/// Everything one frame draws, built on the poller thread.
+pub struct Snapshot {
+    /// Increases with every published snapshot.
+    pub version: u64,
+    pub state: ViewState,
+    pub events_seen: u64,
+    pub threads: usize,
+    /// Latest dashboard snapshot and the one before it, for rates.
+    pub stats: StatsSnapshot,
+    pub stats_prev: StatsSnapshot,
+    /// Formatted event rows on screen.
+    pub rows: Vec<String>,
+    pub following: bool,
+    /// Outcome of the last span dump.
+    pub notice: Option<String>,
+}
+
+/// The latest snapshot; the lock is held only to swap or clone the `Arc`.
+struct Latest {
+    snapshot: Mutex<Arc<Snapshot>>,
+    version: AtomicU64,
+}
+
+impl Latest {
+    fn publish(&self, snapshot: Snapshot) {
+        let version = snapshot.version;
+        *self.snapshot.lock().unwrap() = Arc::new(snapshot);
+        self.version.store(version, Ordering::Release);
+    }
+}
+
+/// Handle to the poller thread; dropping it stops the thread.
+pub struct Poller {
+    commands: Option<Sender<Command>>,
+    latest: Arc<Latest>,
+    thread: Option<JoinHandle<()>>,
+}
+
+impl Poller {
+    /// Move `engine` to a new poller thread.
+    pub fn spawn(engine: Engine) -> Self {
+        let (commands, receiver) = mpsc::channel();
+        let mut worker = Worker::new(engine);
+        let latest = Arc::new(Latest {
+            snapshot: Mutex::new(Arc::new(worker.snapshot())),
+            version: AtomicU64::new(0),
+        });
+        let shared = Arc::clone(&latest);
+        let thread = thread::Builder::new()
+            .name("exeray-poller".into())
+            .spawn(move || worker.run(&receiver, &shared))
+            .expect("spawn poller thread");
+        Self {
+            commands: Some(commands),
+            latest,
+            thread: Some(thread),
+        }
+    }
+
+    /// Queue a command; it shows in a later snapshot.
+    pub fn send(&self, command: Command) {
+        if let Some(commands) = &self.commands {
+            // The thread only ends once this handle is dropped
+            let _ = commands.send(command);
+        }
+    }
+
+    /// Version of the latest snapshot, without taking it.
+    pub fn version(&self) -> u64 {
+        self.latest.version.load(Ordering::Acquire)
+    }
+
+    /// The latest snapshot.
+    pub fn latest(&self) -> Arc<Snapshot> {
+        Arc::clone(&self.latest.snapshot.lock().unwrap())
+    }
+}
+
+impl Drop for Poller {
+    fn drop(&mut self) {
+        // A closed channel is the stop signal
+        self.commands = None;
+        if let Some(thread) = self.thread.take() {
+            let _ = thread.join();
+        }
+    }
+}
+
+/// State of the poller thread.
+struct Worker {
+    engine: Engine,
+    state: ViewState,
+    cursor: u64,
+    events_seen: u64,
+    events: EventList,
+    rows: usize,
+    stats: StatsSnapshot,
+    stats_prev: StatsSnapshot,
+    next_stats: Instant,
+    show_stats: bool,
+    notice: Option<String>,
+    version: u64,
+}
+
+impl Worker {
+    fn new(engine: Engine) -> Self {
+        Self {
+            state: engine.poll(),
+            engine,
+            cursor: 0,
+            events_seen: 0,
+            events: EventList::new(),
+            rows: 0,
+            stats: StatsSnapshot::default(),
+            stats_prev: StatsSnapshot::default(),
+            next_stats: Instant::now(),
+            show_stats: false,
+            notice: None,
+            version: 0,
+        }
+    }
+
+    fn run(mut self, commands: &Receiver<Command>, latest: &Latest) {
+        loop {
+            let mut changed = false;
+            loop {
+                match commands.try_recv() {
+                    Ok(command) => {
+                        self.apply(command);
+                        changed = true;
+                    }
+                    Err(TryRecvError::Empty) => break,
+                    Err(TryRecvError::Disconnected) => return,
+                }
+            }
+            changed |= self.tick(POLL_WAIT);
+            if changed {
+                self.version += 1;
+                latest.publish(self.snapshot());
+            }
+        }
+    }
+
+    fn apply(&mut self, command: Command) {
+        match command {
+            Command::Start => {
+                if self.engine.idle() || self.state.is_complete() {
+                    self.engine.submit();
+                }
+            }
+            Command::Scroll(rows) => self.events.scroll(&self.engine, rows, self.rows),
+            Command::Page(pages) => {
+                let rows = pages.saturating_mul(self.rows.max(1) as isize);
+                self.events.scroll(&self.engine, rows, self.rows);
+            }
+            Command::Home => self.events.home(&self.engine),
+            Command::End => self.events.end(),
+            Command::Rows(rows) => self.rows = rows,
+            Command::ShowStats(show) => self.show_stats = show,
+            Command::DumpSpans => {
+                self.notice = Some(if self.engine.dump_spans(SPANS_FILE) {
+                    format!("Spans written to {SPANS_FILE}")
+                } else {
+                    format!("Cannot write {SPANS_FILE}")
+                });
+            }
+        }
+    }
+
+    /// Wait up to `timeout` for new events, then take the delta since the
+    /// last tick. Returns true if there is anything new to publish.
+    fn tick(&mut self, timeout: Duration) -> bool {
+        let state = self.engine.poll();
+        let state_changed = state != self.state;
+        self.state = state;
+        let stats_changed = self.refresh_stats();
+        if !state_changed && !self.engine.wait_for_events(self.cursor, timeout) {
+            return stats_changed;
+        }
+        let (events, cursor) = self.engine.events_since(self.cursor, MAX_EVENTS_PER_POLL);
+        self.cursor = cursor;
+        self.events_seen += events.len() as u64;
+        state_changed || !events.is_empty()
+    }
+
+    /// Take a dashboard snapshot if one is due; true if it changed.
+    fn refresh_stats(&mut self) -> bool {
+        let now = Instant::now();
+        if now < self.next_stats {
+            return false;
+        }
+        self.next_stats = now + STATS_INTERVAL;
+        let stats = self.engine.stats_snapshot();
+        self.stats_prev = std::mem::replace(&mut self.stats, stats);
+        // Rates are shown only while the dashboard is
+        self.show_stats
+    }
+
+    fn snapshot(&mut self) -> Snapshot {
+        let rows = self
+            .events
+            .window(&self.engine, self.rows)
+            .map(str::to_owned)
+            .collect();
+        Snapshot {
+            version: self.version,
+            state: self.state,
+            events_seen: self.events_seen,
+            threads: self.engine.threads(),
+            stats: self.stats,
+            stats_prev: self.stats_prev,
+            rows,
+            following: self.events.following(),
+            notice: self.notice.clone(),
+        }
+    }
+}
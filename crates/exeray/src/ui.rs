@@ -1,15 +1,16 @@
 use crate::app::App;
-use exeray_ffi::ViewState;
+use exeray_ffi::{Category, ViewState};
 use ratatui::{
     prelude::*,
     widgets::{Block, Borders, Gauge, Paragraph},
 };
 
-pub fn render(app: &App, frame: &mut Frame) {
+pub fn render(app: &mut App, frame: &mut Frame) {
     let layout = Layout::vertical([
         Constraint::Length(3),
         Constraint::Length(3),
-        Constraint::Min(1),
+        Constraint::Length(3),
+        Constraint::Min(3),
         Constraint::Length(1),
     ])
     .margin(2)
@@ -18,13 +19,19 @@ pub fn render(app: &App, frame: &mut Frame) {
     header(app, frame, layout[0]);
     progress(app.state(), frame, layout[1]);
     status(app.state(), frame, layout[2]);
-    help(frame, layout[3]);
+    if app.showing_stats() {
+        dashboard(app, frame, layout[3]);
+    } else {
+        events(app, frame, layout[3]);
+    }
+    help(app, frame, layout[4]);
 }
 
 fn header(app: &App, frame: &mut Frame, area: Rect) {
     let text = format!(
-        "ExeRay │ Gen: {} │ Threads: {}",
+        "ExeRay │ Gen: {} │ Events: {} │ Threads: {}",
         app.state().generation,
+        app.events_seen(),
         app.threads()
     );
 
@@ -63,9 +70,83 @@ fn status(state: &ViewState, frame: &mut Frame, area: Rect) {
     );
 }
 
-fn help(frame: &mut Frame, area: Rect) {
+/// Only the rows that fit are fetched, whatever the number of events.
+fn events(app: &mut App, frame: &mut Frame, area: Rect) {
+    let title = if app.following_events() {
+        "Events (following)"
+    } else {
+        "Events"
+    };
+    let height = area.height.saturating_sub(2) as usize;
+    let lines: Vec<Line> = app
+        .visible_events(height)
+        .into_iter()
+        .map(Line::raw)
+        .collect();
+
+    frame.render_widget(
+        Paragraph::new(lines).block(Block::default().borders(Borders::ALL).title(title)),
+        area,
+    );
+}
+
+/// Names of the categories, indexed by `Category::repr`.
+const CATEGORY_NAMES: [&str; 17] = [
+    "FileSystem", "Registry", "Network", "Process", "Scheduler", "Input", "Image", "Thread",
+    "Memory", "Script", "Amsi", "Dns", "Security", "Service", "Wmi", "Clr", "Manifest",
+];
+
+/// Rates from the last two snapshots; nothing here scans the events.
+fn dashboard(app: &App, frame: &mut Frame, area: Rect) {
+    let (stats, prev) = app.stats();
+    let mut lines = vec![
+        Line::raw(format!(
+            "Total {:>10.0}/s │ Suspicious {:>8.0}/s │ Dropped {:>8.0}/s",
+            stats.total_per_sec(prev),
+            stats.suspicious_per_sec(prev),
+            stats.dropped_per_sec(prev)
+        )),
+        Line::raw(format!(
+            "Stored {} │ Flagged {} │ Live suspicious {} │ Lost {} │ Overflows {} │ Shed {}",
+            stats.total_pushed(),
+            stats.flagged,
+            stats.live_suspicious,
+            stats.events_lost,
+            stats.ring_overflows,
+            stats.shed
+        )),
+        Line::raw(""),
+    ];
+    for (repr, name) in CATEGORY_NAMES.iter().enumerate() {
+        if stats.pushed[repr] == 0 {
+            continue;
+        }
+        let category = Category { repr: repr as u8 };
+        lines.push(Line::raw(format!(
+            "{name:<12}{:>10.0}/s {:>12} live",
+            stats.events_per_sec(prev, category),
+            stats.live[repr]
+        )));
+    }
+    lines.push(Line::raw(""));
+    for (pid, count) in stats.top_processes() {
+        lines.push(Line::raw(format!("PID {pid:<10}{count:>12} events")));
+    }
+
+    frame.render_widget(
+        Paragraph::new(lines).block(Block::default().borders(Borders::ALL).title("Dashboard")),
+        area,
+    );
+}
+
+fn help(app: &App, frame: &mut Frame, area: Rect) {
+    let keys = "Space: Start │ Tab: Dashboard │ ↑↓ PgUp PgDn Home End: Scroll │ T: Dump spans │ Q: Quit";
+    let text = match app.notice() {
+        Some(notice) => format!("{keys} │ {notice}"),
+        None => keys.to_string(),
+    };
     frame.render_widget(
-        Paragraph::new("Space: Start │ Q: Quit").style(Style::default().fg(Color::DarkGray)),
+        Paragraph::new(text).style(Style::default().fg(Color::DarkGray)),
         area,
     );
 }